@@ -7,6 +7,10 @@
 
 using namespace anki;
 
+static const F32 MOVE_DISTANCE = 0.1f;
+static const F32 ROTATE_ANGLE = toRad(2.5f);
+static const F32 MOUSE_SENSITIVITY = 9.0f;
+
 Error SampleApp::init(int argc, char** argv, CString sampleName)
 {
 	if(!directoryExists("assets"))
@@ -36,14 +40,14 @@ Error SampleApp::init(int argc, char** argv, CString sampleName)
 
 	ANKI_CHECK(sampleExtraInit());
 
+	// The scene is loaded, create the pipelines it used the last time
+	ANKI_CHECK(warmupPipelines(sampleName));
+
 	return Error::NONE;
 }
 
 Error SampleApp::userMainLoop(Bool& quit)
 {
-	const F32 MOVE_DISTANCE = 0.1f;
-	const F32 ROTATE_ANGLE = toRad(2.5f);
-	const F32 MOUSE_SENSITIVITY = 9.0f;
 	quit = false;
 
 	SceneGraph& scene = getSceneGraph();
@@ -182,3 +186,21 @@ Error SampleApp::userMainLoop(Bool& quit)
 
 	return Error::NONE;
 }
+
+Bool SampleApp::userLateLatchCamera(Transform& cameraTransform)
+{
+	// The cursor is locked to the center so its position is the motion of this frame. The next frame will rotate the
+	// camera with it, apply it now to cut a frame of latency
+	Vec2 mousePos;
+	if(getDisplayDeveloperConsole() || !getInput().peekLatestMousePosition(mousePos) || mousePos == Vec2(0.0f))
+	{
+		return false;
+	}
+
+	Mat3x4 rotation = cameraTransform.getRotation();
+	rotation.rotateYAxis(-ROTATE_ANGLE * mousePos.x() * MOUSE_SENSITIVITY * getMainRenderer().getAspectRatio());
+	rotation.rotateXAxis(ROTATE_ANGLE * mousePos.y() * MOUSE_SENSITIVITY);
+	cameraTransform.setRotation(rotation);
+
+	return true;
+}
@@ -12,6 +12,7 @@ class SampleApp : public anki::App
 public:
 	anki::Error init(int argc, char** argv, anki::CString sampleName);
 	anki::Error userMainLoop(anki::Bool& quit) override;
+	anki::Bool userLateLatchCamera(anki::Transform& cameraTransform) override;
 
 	virtual anki::Error sampleExtraInit() = 0;
 };
\ No newline at end of file
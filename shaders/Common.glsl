@@ -31,6 +31,20 @@
 #	define DEFAULT_INT_PRECISION highp
 #endif
 
+// Half precision types. ANKI_F16 is set when the device does native FP16 math, else they are plain F32. The literals
+// and the results of the F32 functions need an explicit F16() or HVec*() conversion
+#if ANKI_F16
+#	define F16 float16_t
+#	define HVec2 f16vec2
+#	define HVec3 f16vec3
+#	define HVec4 f16vec4
+#else
+#	define F16 F32
+#	define HVec2 Vec2
+#	define HVec3 Vec3
+#	define HVec4 Vec4
+#endif
+
 // Constants
 precision DEFAULT_FLOAT_PRECISION F32;
 precision DEFAULT_INT_PRECISION I32;
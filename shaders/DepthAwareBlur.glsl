@@ -3,11 +3,11 @@
 // Code licensed under the BSD License.
 // http://www.anki3d.org/LICENSE
 
-#pragma anki mutator ORIENTATION 0 1 2 // 0: VERTICAL, 1: HORIZONTAL, 2: BOX
+#pragma anki mutator ORIENTATION 0 1 2 3 // 0: VERTICAL, 1: HORIZONTAL, 2: BOX, 3: UPSAMPLE
 #pragma anki mutator SAMPLE_COUNT 3 5 7 9 11 13 15
 #pragma anki mutator COLOR_COMPONENTS 4 3 1
 
-ANKI_SPECIALIZATION_CONSTANT_UVEC2(TEXTURE_SIZE, 0, UVec2(1));
+ANKI_SPECIALIZATION_CONSTANT_UVEC2(TEXTURE_SIZE, 0, UVec2(1)); // The output size
 
 #include <shaders/Common.glsl>
 
@@ -15,8 +15,10 @@ ANKI_SPECIALIZATION_CONSTANT_UVEC2(TEXTURE_SIZE, 0, UVec2(1));
 #	define VERTICAL 1
 #elif ORIENTATION == 1
 #	define HORIZONTAL 1
-#else
+#elif ORIENTATION == 2
 #	define BOX 1
+#else
+#	define UPSAMPLE 1
 #endif
 
 #if SAMPLE_COUNT < 3
@@ -49,7 +51,11 @@ const UVec2 WORKGROUP_SIZE = UVec2(8u, 8u);
 
 layout(set = 0, binding = 0) uniform sampler u_linearAnyClampSampler;
 layout(set = 0, binding = 1) uniform texture2D u_inTex;
-layout(set = 0, binding = 2) uniform texture2D u_depthTex;
+layout(set = 0, binding = 2) uniform texture2D u_depthTex; // Same size as the u_inTex
+
+#if defined(UPSAMPLE)
+layout(set = 0, binding = 4) uniform texture2D u_fullDepthTex; // Same size as the output
+#endif
 
 #if USE_COMPUTE
 layout(local_size_x = WORKGROUP_SIZE.x, local_size_y = WORKGROUP_SIZE.y, local_size_z = 1) in;
@@ -94,6 +100,29 @@ void main()
 	const Vec2 uv = in_uv;
 #endif
 
+#if defined(UPSAMPLE)
+	// Bilinear upsample that favors the input texels with depth close to the output pixel's
+	const F32 refDepth = textureLod(u_fullDepthTex, u_linearAnyClampSampler, uv, 0.0).r;
+	const IVec2 inSize = textureSize(u_inTex, 0);
+	const Vec2 inTexel = uv * Vec2(inSize) - 0.5;
+	const IVec2 firstTexel = IVec2(floor(inTexel));
+	const Vec2 bilinearFactor = fract(inTexel);
+
+	COL_TYPE color = COL_TYPE(0.0);
+	F32 weight = EPSILON;
+	ANKI_UNROLL for(U32 i = 0u; i < 4u; ++i)
+	{
+		const IVec2 offset = IVec2(i & 1u, i >> 1u);
+		const IVec2 texel = clamp(firstTexel + offset, IVec2(0), inSize - 1);
+
+		const Vec2 bilinearWeights = mix(1.0 - bilinearFactor, bilinearFactor, Vec2(offset));
+		const F32 depth = texelFetch(sampler2D(u_depthTex, u_linearAnyClampSampler), texel, 0).r;
+		const F32 w = bilinearWeights.x * bilinearWeights.y * computeDepthWeight(refDepth, depth);
+
+		color += texelFetch(sampler2D(u_inTex, u_linearAnyClampSampler), texel, 0).TEX_FETCH * w;
+		weight += w;
+	}
+#else
 	const Vec2 TEXEL_SIZE = 1.0 / Vec2(TEXTURE_SIZE);
 
 	// Sample
@@ -101,14 +130,14 @@ void main()
 	const F32 refDepth = readDepth(uv);
 	F32 weight = 1.0;
 
-#if !defined(BOX)
+#	if !defined(BOX)
 	// Do seperable
 
-#	if defined(HORIZONTAL)
-#		define X_OR_Y x
-#	else
-#		define X_OR_Y y
-#	endif
+#		if defined(HORIZONTAL)
+#			define X_OR_Y x
+#		else
+#			define X_OR_Y y
+#		endif
 
 	Vec2 uvOffset = Vec2(0.0);
 	uvOffset.X_OR_Y = 1.5 * TEXEL_SIZE.X_OR_Y;
@@ -120,7 +149,7 @@ void main()
 
 		uvOffset.X_OR_Y += 2.0 * TEXEL_SIZE.X_OR_Y;
 	}
-#else
+#	else
 	// Do box
 
 	const Vec2 OFFSET = 1.5 * TEXEL_SIZE;
@@ -134,6 +163,7 @@ void main()
 	sampleTex(uv + Vec2(0.0, OFFSET.y), refDepth, color, weight);
 	sampleTex(uv + Vec2(-OFFSET.x, 0.0), refDepth, color, weight);
 	sampleTex(uv + Vec2(0.0, -OFFSET.y), refDepth, color, weight);
+#	endif
 #endif
 	color = color / weight;
 
@@ -50,6 +50,8 @@ layout(location = 6) out Vec3 out_normalTangentSpace;
 #		if ANKI_VELOCITY
 layout(location = 7) out Vec2 out_velocity;
 #		endif
+
+layout(location = 8) flat out F32 out_lodFade;
 #	endif // ANKI_PASS == PASS_GB
 #endif // defined(ANKI_VERTEX_SHADER)
 
@@ -71,6 +73,8 @@ layout(location = 6) in Vec3 in_normalTangentSpace;
 #	if ANKI_VELOCITY
 layout(location = 7) in Vec2 in_velocity;
 #	endif
+
+layout(location = 8) flat in F32 in_lodFade;
 #endif
 
 //
@@ -87,6 +91,26 @@ layout(location = 3) out Vec2 out_gbuffer3;
 // Functions
 //
 
+// Discard the pixels of a LOD that is cross-fading. The fade is the m_ankiLodFade builtin: In [0, 1) for the LOD that
+// is fading in, in [-2, -1) for the one that is fading out and 1 if there is no fading. Both LODs use the same ordered
+// dither so they never write the same pixel.
+#if defined(ANKI_FRAGMENT_SHADER) && ANKI_PASS == PASS_GB
+void lodCrossFade(F32 fade)
+{
+	if(fade < 1.0)
+	{
+		const UVec2 bayerIdx = UVec2(gl_FragCoord.xy) & 3u;
+		const U32 BAYER[16] = U32[](0u, 8u, 2u, 10u, 12u, 4u, 14u, 6u, 3u, 11u, 1u, 9u, 15u, 7u, 13u, 5u);
+		const F32 dither = (F32(BAYER[bayerIdx.y * 4u + bayerIdx.x]) + 0.5) / 16.0;
+
+		if((fade >= 0.0) ? (dither >= fade) : (dither < fade + 2.0))
+		{
+			discard;
+		}
+	}
+}
+#endif
+
 // Write the data to RTs
 #if defined(ANKI_FRAGMENT_SHADER) && ANKI_PASS == PASS_GB
 void writeGBuffer(Vec3 diffColor,
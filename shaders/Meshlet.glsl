@@ -0,0 +1,60 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+// Functions for the task and mesh shaders that draw the meshlets of a mesh
+
+#pragma once
+
+#include <shaders/Common.glsl>
+
+const U32 MAX_MESHLET_VERTICES = 64u;
+const U32 MAX_MESHLET_PRIMITIVES = 124u;
+
+/// The same as MeshBinaryFile::Meshlet.
+struct Meshlet
+{
+	U32 m_firstVertex;
+	U32 m_vertexCount;
+	U32 m_firstPrimitive;
+	U32 m_primitiveCount;
+	Vec4 m_sphere; ///< Center and radius.
+	Vec4 m_cone; ///< Axis and cutoff.
+};
+
+/// Test a sphere against the side planes of the frustum. The planes are extracted from the MVP so the sphere is in
+/// model space.
+Bool sphereInsideFrustum(Mat4 mvp, Vec3 center, F32 radius)
+{
+	const Mat4 rows = transpose(mvp);
+	const Vec4 planes[4] = Vec4[](rows[3] + rows[0], rows[3] - rows[0], rows[3] + rows[1], rows[3] - rows[1]);
+
+	ANKI_UNROLL for(U32 i = 0u; i < 4u; ++i)
+	{
+		if(dot(planes[i].xyz, center) + planes[i].w < -radius * length(planes[i].xyz))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/// All the triangles of the meshlet face away from the eye. Everything is in world space.
+Bool meshletBackfacing(Vec3 center, F32 radius, Vec3 coneAxis, F32 coneCutoff, Vec3 eye)
+{
+	const Vec3 dir = center - eye;
+	return dot(dir, coneAxis) >= coneCutoff * length(dir) + radius;
+}
+
+/// Decode a value of A2B10G10R10_SNORM_PACK32.
+Vec4 unpackA2B10G10R10Snorm(U32 v)
+{
+	const I32 iv = I32(v);
+	const IVec4 c = IVec4(bitfieldExtract(iv, 0, 10),
+		bitfieldExtract(iv, 10, 10),
+		bitfieldExtract(iv, 20, 10),
+		bitfieldExtract(iv, 30, 2));
+	return max(Vec4(c) / Vec4(511.0, 511.0, 511.0, 1.0), Vec4(-1.0));
+}
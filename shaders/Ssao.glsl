@@ -7,6 +7,7 @@
 
 #pragma anki mutator USE_NORMAL 0 1
 #pragma anki mutator SOFT_BLUR 0 1
+#pragma anki mutator CHECKERBOARD 0 1
 
 ANKI_SPECIALIZATION_CONSTANT_U32(NOISE_MAP_SIZE, 0, 1);
 ANKI_SPECIALIZATION_CONSTANT_UVEC2(FB_SIZE, 1, UVec2(1));
@@ -30,8 +31,12 @@ ANKI_SPECIALIZATION_CONSTANT_U32(SAMPLE_COUNT, 6, 1);
 const UVec2 WORKGROUP_SIZE = UVec2(16, 16);
 #endif
 
-// Do a compute soft blur
-#define DO_SOFT_BLUR (USE_COMPUTE && SOFT_BLUR)
+#if CHECKERBOARD && !USE_COMPUTE
+#	error The checkerboard needs compute
+#endif
+
+// Do a compute soft blur. The checkerboard has no neighbours to blur with
+#define DO_SOFT_BLUR (USE_COMPUTE && SOFT_BLUR && !CHECKERBOARD)
 
 #if !USE_COMPUTE
 layout(location = 0) in Vec2 in_uv;
@@ -47,6 +52,10 @@ layout(push_constant, std140, row_major) uniform _pc
 	Vec4 u_unprojectionParams;
 	Vec4 u_projectionMat;
 	Mat3 u_viewRotMat;
+	F32 u_noiseOffset; // Rotates the noise every frame when the SSAO is accumulated over frames
+	U32 u_checkerboardOffset; // Which of the 2 pixels of the checkerboard the thread computes
+	U32 u_padding0;
+	U32 u_padding1;
 };
 
 layout(set = 0, binding = 0) uniform sampler u_linearAnyClampSampler;
@@ -134,7 +143,15 @@ Vec3 computeNormal(Vec2 uv, Vec3 origin, F32 depth)
 void main(void)
 {
 #if USE_COMPUTE
-	if(gl_GlobalInvocationID.x >= FB_SIZE.x || gl_GlobalInvocationID.y >= FB_SIZE.y)
+#	if CHECKERBOARD
+	// Every thread computes one of the 2 pixels of a row. The temporal pass fills the other
+	const UVec2 pixel = UVec2(gl_GlobalInvocationID.x * 2u + ((gl_GlobalInvocationID.y + u_checkerboardOffset) & 1u),
+		gl_GlobalInvocationID.y);
+#	else
+	const UVec2 pixel = gl_GlobalInvocationID.xy;
+#	endif
+
+	if(pixel.x >= FB_SIZE.x || pixel.y >= FB_SIZE.y)
 	{
 #	if DO_SOFT_BLUR
 		// Store something anyway because alive threads might read it when SOFT_BLUR is enabled
@@ -145,7 +162,7 @@ void main(void)
 		return;
 	}
 
-	const Vec2 uv = (Vec2(gl_GlobalInvocationID.xy) + 0.5) / Vec2(FB_SIZE);
+	const Vec2 uv = (Vec2(pixel) + 0.5) / Vec2(FB_SIZE);
 #else
 	const Vec2 uv = in_uv;
 #endif
@@ -166,7 +183,7 @@ void main(void)
 	const F32 projRadius = length(projSphereLimit2 - ndc);
 
 	// Loop to compute
-	const F32 randFactor = readRandom(uv, 0.0).r;
+	const F32 randFactor = readRandom(uv, 0.0).r + u_noiseOffset;
 	F32 ssao = 0.0;
 	const F32 SAMPLE_COUNTF = F32(SAMPLE_COUNT);
 	ANKI_UNROLL for(U32 i = 0; i < SAMPLE_COUNT; ++i)
@@ -176,15 +193,15 @@ void main(void)
 		const F32 fi = F32(i);
 		const F32 TURNS = F32(SAMPLE_COUNT) / 2.0; // Calculate the number of the spiral turns
 		const F32 ANG = (PI * 2.0 * TURNS) / (SAMPLE_COUNTF - 1.0); // The angle distance between samples
-		F32 ang = ANG * fi;
-		ang += randFactor * PI; // Turn the angle a bit
+		const F16 ang = F16(ANG * fi + randFactor * PI); // Turn the angle a bit
 
 		F32 radius = (1.0 / SAMPLE_COUNTF) * (fi + 1.0);
 		radius = sqrt(radius); // Move the points a bit away from the center of the spiral
 
-		const Vec2 point = Vec2(cos(ang), sin(ang)) * radius; // In NDC
+		// The point on the disk is fine in half precision, the positions that are derived from the depth are not
+		const HVec2 point = HVec2(cos(ang), sin(ang)) * F16(radius); // In NDC
 
-		const Vec2 finalDiskPoint = ndc + point * projRadius;
+		const Vec2 finalDiskPoint = ndc + Vec2(point) * projRadius;
 
 		// Compute factor
 		const Vec3 s =
@@ -229,7 +246,7 @@ void main(void)
 
 	// Store the result
 #if USE_COMPUTE
-	imageStore(out_img, IVec2(gl_GlobalInvocationID.xy), Vec4(ssao));
+	imageStore(out_img, IVec2(pixel), Vec4(ssao));
 #else
 	out_color = ssao;
 #endif
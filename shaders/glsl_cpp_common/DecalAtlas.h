@@ -0,0 +1,22 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <shaders/glsl_cpp_common/Common.h>
+
+ANKI_BEGIN_NAMESPACE
+
+// A decal that will be streamed to a page of the decal atlas
+struct DecalAtlasUpload
+{
+	UVec2 m_pageOffset; // In texels of the 1st mip of the atlas
+	U32 m_diffuseTexIndex; // Bindless index
+	U32 m_specularRoughnessTexIndex; // Bindless index
+	Vec4 m_diffuseUv; // xy: Offset, zw: Size. In the UV space of the source texture
+	Vec4 m_specularRoughnessUv; // xy: Offset, zw: Size. In the UV space of the source texture
+};
+
+ANKI_END_NAMESPACE
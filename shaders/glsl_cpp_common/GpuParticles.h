@@ -29,6 +29,10 @@ struct GpuParticleEmitterProperties
 
 	Vec3 m_maxStartingPosition;
 	U32 m_particleCount;
+
+	U32 m_collisionResponse; // 0: None, 1: bounce, 2: kill. Same as ParticleCollisionResponse
+	F32 m_restitution;
+	Vec2 m_padding1;
 };
 
 // GPU particle state
@@ -47,13 +51,45 @@ struct GpuParticle
 	F32 m_padding1;
 };
 
-struct GpuParticleSimulationState
+// The args of the indirect draw of the alive particles and the counters of the simulation. The simulation writes it
+// at the start of the buffer that holds the indices of the alive particles
+struct GpuParticleIndirectArgs
+{
+	U32 m_vertexCount; // The first 4 are the same as DrawArraysIndirectInfo
+	U32 m_instanceCount;
+	U32 m_firstVertex;
+	U32 m_baseInstance;
+
+	U32 m_emittedCount;
+	U32 m_padding2;
+	U32 m_padding3;
+	U32 m_padding4;
+};
+
+const U32 MAX_GPU_PARTICLE_EMITTERS_PER_SIMULATION = 8u; // The emitters that one dispatch simulates
+const U32 GPU_PARTICLE_RANDOM_FACTOR_COUNT = 32u;
+
+// The uniforms of a simulation dispatch. All its emitters share them
+struct GpuParticleSimulationUniforms
 {
 	Mat4 m_viewProjMat;
 
 	Vec4 m_unprojectionParams;
 
-	Vec2 m_padding0;
+#if defined(__cplusplus)
+	Mat3x4 m_invViewRotation;
+#else
+	Mat3 m_invViewRotation;
+#endif
+};
+
+// The state of the simulation of an emitter. The emitters of a dispatch read them from a storage buffer
+struct GpuParticleSimulationState
+{
+	GpuParticleEmitterProperties m_props;
+
+	U32 m_emitCount; // How many dead particles can be revived in this simulation
+	F32 m_padding0;
 	U32 m_randomIndex;
 	F32 m_dt;
 
@@ -66,11 +102,7 @@ struct GpuParticleSimulationState
 	Mat3 m_emitterRotation;
 #endif
 
-#if defined(__cplusplus)
-	Mat3x4 m_invViewRotation;
-#else
-	Mat3 m_invViewRotation;
-#endif
+	Vec4 m_randomFactors[GPU_PARTICLE_RANDOM_FACTOR_COUNT / 4u]; // Values in range [0.0, 1.0]
 };
 
 ANKI_END_NAMESPACE
\ No newline at end of file
@@ -17,4 +17,12 @@ struct LensFlareSprite
 	Vec4 m_depthPad3;
 };
 
+// Per flare input of the visibility test
+struct LensFlareVisibilityIn
+{
+	Vec4 m_worldPosition; // xyz: Position
+	Vec4 m_colorMultiplier;
+	Vec4 m_firstFlareSizePad2; // xy: Size of the 1st flare
+};
+
 ANKI_END_NAMESPACE
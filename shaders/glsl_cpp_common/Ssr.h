@@ -18,6 +18,10 @@ struct SsrUniforms
 	U32 m_depthMipCount;
 	U32 m_maxSteps;
 	U32 m_lightBufferMipCount;
+	F32 m_roughnessCutoff;
+	F32 m_historyBlendFactor;
+	U32 m_padding0;
+	U32 m_padding1;
 	Mat4 m_prevViewProjMatMulInvViewProjMat;
 	Mat4 m_projMat;
 	Mat4 m_invProjMat;
@@ -13,7 +13,11 @@
 #include <anki/collision/ConvexHullShape.h>
 #include <anki/collision/Ray.h>
 #include <anki/collision/Cone.h>
+#include <anki/collision/PlanesWide.h>
+#include <anki/collision/RayPacket.h>
+#include <anki/collision/Bvh.h>
 
 #include <anki/collision/Functions.h>
+#include <anki/collision/GjkEpa.h>
 
 /// @defgroup collision Collision detection module
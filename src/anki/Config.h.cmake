@@ -139,6 +139,27 @@
 #	define ANKI_SIMD_NEON 1
 #endif
 
+// AVX2 is opt-in (ANKI_SIMD_AVX2 CMake option) since not every x86 CPU supports it
+#if ANKI_SIMD_SSE && defined(__AVX2__)
+#	define ANKI_SIMD_AVX2 1
+#else
+#	define ANKI_SIMD_AVX2 0
+#endif
+
+// FMA comes with AVX2. MSVC doesn't define __FMA__ but /arch:AVX2 implies it
+#if ANKI_SIMD_SSE && (defined(__FMA__) || (defined(_MSC_VER) && defined(__AVX2__)))
+#	define ANKI_SIMD_FMA 1
+#else
+#	define ANKI_SIMD_FMA 0
+#endif
+
+// F16C comes with AVX2 as well
+#if ANKI_SIMD_SSE && (defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__)))
+#	define ANKI_SIMD_F16C 1
+#else
+#	define ANKI_SIMD_F16C 0
+#endif
+
 // Graphics backend
 #define ANKI_GR_BACKEND_GL 0
 #define ANKI_GR_BACKEND_VULKAN 1
@@ -185,7 +206,23 @@
 #if ANKI_COMPILER_MSVC
 #	include <intrin.h>
 #	define __builtin_popcount __popcnt
+#	define __builtin_popcountll(x) ((int)__popcnt64(x))
 #	define __builtin_clzll(x) ((int)__lzcnt64(x))
+#	define __builtin_ctz(x) ankiMsvcCtz(x)
+#	define __builtin_ctzll(x) ankiMsvcCtzll(x)
+inline int ankiMsvcCtz(unsigned int x)
+{
+	unsigned long idx;
+	_BitScanForward(&idx, x);
+	return (int)idx;
+}
+
+inline int ankiMsvcCtzll(unsigned long long x)
+{
+	unsigned long idx;
+	_BitScanForward64(&idx, x);
+	return (int)idx;
+}
 #endif
 
 // Constants
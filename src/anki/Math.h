@@ -12,6 +12,7 @@
 #include <anki/math/Axisang.h>
 #include <anki/math/Transform.h>
 #include <anki/math/F16.h>
+#include <anki/math/VecWide.h>
 
 #include <anki/math/Functions.h>
 
@@ -10,6 +10,7 @@
 #include <anki/util/Assert.h>
 #include <anki/util/Atomic.h>
 #include <anki/util/BitSet.h>
+#include <anki/util/HierarchicalBitSet.h>
 #include <anki/util/BitMask.h>
 #include <anki/util/DynamicArray.h>
 #include <anki/util/WeakArray.h>
@@ -24,10 +25,12 @@
 #include <anki/util/Memory.h>
 #include <anki/util/NonCopyable.h>
 #include <anki/util/Hierarchy.h>
+#include <anki/util/FlatHierarchy.h>
 #include <anki/util/Ptr.h>
 #include <anki/util/Singleton.h>
 #include <anki/util/StdTypes.h>
 #include <anki/util/String.h>
+#include <anki/util/StringId.h>
 #include <anki/util/StringList.h>
 #include <anki/util/System.h>
 #include <anki/util/Thread.h>
@@ -40,6 +43,7 @@
 #include <anki/util/Tracer.h>
 #include <anki/util/Serializer.h>
 #include <anki/util/Xml.h>
+#include <anki/util/RadixSort.h>
 
 /// @defgroup util Utilities (like STL)
 
@@ -0,0 +1,790 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/collision/Bvh.h>
+#include <anki/math/VecWide.h>
+
+namespace anki
+{
+
+/// A child that is a leaf has this bit set. See Bvh::Node::m_children.
+static constexpr U32 LEAF_BIT = 1u << 31u;
+static constexpr U32 LEAF_COUNT_BITS = 4;
+static constexpr U32 MAX_TRAVERSAL_STACK_SIZE = 256;
+static constexpr F32 TRIANGLE_EPSILON = 1.0e-8f;
+
+/// 4 children boxes in SoA layout.
+class Bvh::Node
+{
+public:
+	Array<F32, 4> m_minX;
+	Array<F32, 4> m_minY;
+	Array<F32, 4> m_minZ;
+	Array<F32, 4> m_maxX;
+	Array<F32, 4> m_maxY;
+	Array<F32, 4> m_maxZ;
+
+	/// MAX_U32 if there is no child. If LEAF_BIT is set it's a leaf and the bits [30:4] hold the 1st triangle and the
+	/// bits [3:0] the triangle count minus one. Otherwise it's the index of the child node.
+	Array<U32, 4> m_children;
+};
+
+/// Triangle in a layout that is good for the ray tests.
+class Bvh::Triangle
+{
+public:
+	Vec3 m_v0;
+	Vec3 m_e1; ///< v1 - v0
+	Vec3 m_e2; ///< v2 - v0
+	U32 m_index; ///< The original index.
+};
+
+/// Holds the temporary data of Bvh::build.
+class Bvh::BuildContext
+{
+public:
+	static constexpr U32 BIN_COUNT = 16;
+
+	/// A range of primitives.
+	class Range
+	{
+	public:
+		U32 m_begin = 0;
+		U32 m_end = 0;
+		Vec3 m_min = Vec3(MAX_F32);
+		Vec3 m_max = Vec3(-MAX_F32);
+
+		U32 getCount() const
+		{
+			return m_end - m_begin;
+		}
+	};
+
+	ConstWeakArray<Vec3> m_positions;
+	ConstWeakArray<U32> m_indices;
+	DynamicArrayAuto<Vec3> m_primMin;
+	DynamicArrayAuto<Vec3> m_primMax;
+	DynamicArrayAuto<Vec3> m_primCentroid;
+	DynamicArrayAuto<U32> m_prims; ///< Triangle indices that get sorted while building.
+	DynamicArrayAuto<Node> m_nodes;
+	DynamicArrayAuto<Triangle> m_triangles;
+
+	BuildContext(GenericMemoryPoolAllocator<U8> alloc)
+		: m_primMin(alloc)
+		, m_primMax(alloc)
+		, m_primCentroid(alloc)
+		, m_prims(alloc)
+		, m_nodes(alloc)
+		, m_triangles(alloc)
+	{
+	}
+
+	static F32 computeSurfaceArea(const Vec3& min, const Vec3& max)
+	{
+		const Vec3 d = max - min;
+		return 2.0f * (d.x() * d.y() + d.y() * d.z() + d.z() * d.x());
+	}
+
+	void computeBounds(Range& range) const
+	{
+		range.m_min = Vec3(MAX_F32);
+		range.m_max = Vec3(-MAX_F32);
+		for(U32 i = range.m_begin; i < range.m_end; ++i)
+		{
+			range.m_min = range.m_min.min(m_primMin[m_prims[i]]);
+			range.m_max = range.m_max.max(m_primMax[m_prims[i]]);
+		}
+	}
+
+	/// Split a range in 2 using the binned SAH.
+	/// @return False if it's better to make it a leaf.
+	Bool split(const Range& range, Range& left, Range& right);
+
+	/// Split a range in the middle. Used when the SAH can't find a split.
+	Bool splitMedian(const Range& range, Range& left, Range& right);
+
+	/// Create a leaf with the triangles of the range.
+	U32 createLeaf(const Range& range);
+
+	/// Create a node. It might create more nodes recursively.
+	/// @return The index of the node.
+	U32 createNode(const Range& range);
+};
+
+Bool Bvh::BuildContext::splitMedian(const Range& range, Range& left, Range& right)
+{
+	if(range.getCount() <= MAX_LEAF_TRIANGLE_COUNT)
+	{
+		return false;
+	}
+
+	const U32 mid = range.m_begin + range.getCount() / 2;
+	left.m_begin = range.m_begin;
+	left.m_end = mid;
+	right.m_begin = mid;
+	right.m_end = range.m_end;
+	computeBounds(left);
+	computeBounds(right);
+	return true;
+}
+
+Bool Bvh::BuildContext::split(const Range& range, Range& left, Range& right)
+{
+	const U32 count = range.getCount();
+	if(count <= 1)
+	{
+		return false;
+	}
+
+	// Find the axis with the largest centroid extent
+	Vec3 centroidMin(MAX_F32);
+	Vec3 centroidMax(-MAX_F32);
+	for(U32 i = range.m_begin; i < range.m_end; ++i)
+	{
+		centroidMin = centroidMin.min(m_primCentroid[m_prims[i]]);
+		centroidMax = centroidMax.max(m_primCentroid[m_prims[i]]);
+	}
+
+	const Vec3 extent = centroidMax - centroidMin;
+	U32 axis = 0;
+	if(extent.y() > extent[axis])
+	{
+		axis = 1;
+	}
+	if(extent.z() > extent[axis])
+	{
+		axis = 2;
+	}
+
+	if(extent[axis] <= EPSILON)
+	{
+		// All centroids in the same place, SAH can't help
+		return splitMedian(range, left, right);
+	}
+
+	// Bin the primitives
+	class Bin
+	{
+	public:
+		Vec3 m_min = Vec3(MAX_F32);
+		Vec3 m_max = Vec3(-MAX_F32);
+		U32 m_count = 0;
+	};
+
+	Array<Bin, BIN_COUNT> bins;
+	const F32 binScale = F32(BIN_COUNT) / extent[axis];
+	auto computeBinIdx = [&](U32 prim) {
+		const F32 f = (m_primCentroid[prim][axis] - centroidMin[axis]) * binScale;
+		return min<U32>(BIN_COUNT - 1, U32(f));
+	};
+
+	for(U32 i = range.m_begin; i < range.m_end; ++i)
+	{
+		const U32 prim = m_prims[i];
+		Bin& bin = bins[computeBinIdx(prim)];
+		bin.m_min = bin.m_min.min(m_primMin[prim]);
+		bin.m_max = bin.m_max.max(m_primMax[prim]);
+		++bin.m_count;
+	}
+
+	// Sweep from the right to compute the cost of the right sides
+	Array<F32, BIN_COUNT> rightArea;
+	Array<U32, BIN_COUNT> rightCount;
+	Vec3 accumMin(MAX_F32);
+	Vec3 accumMax(-MAX_F32);
+	U32 accumCount = 0;
+	for(U32 i = BIN_COUNT - 1; i > 0; --i)
+	{
+		accumMin = accumMin.min(bins[i].m_min);
+		accumMax = accumMax.max(bins[i].m_max);
+		accumCount += bins[i].m_count;
+		rightArea[i] = (accumCount) ? computeSurfaceArea(accumMin, accumMax) : 0.0f;
+		rightCount[i] = accumCount;
+	}
+
+	// Sweep from the left and find the best plane. The split is between bin i and i + 1
+	F32 bestCost = MAX_F32;
+	U32 bestSplit = MAX_U32;
+	accumMin = Vec3(MAX_F32);
+	accumMax = Vec3(-MAX_F32);
+	accumCount = 0;
+	for(U32 i = 0; i < BIN_COUNT - 1; ++i)
+	{
+		accumMin = accumMin.min(bins[i].m_min);
+		accumMax = accumMax.max(bins[i].m_max);
+		accumCount += bins[i].m_count;
+
+		if(accumCount == 0 || rightCount[i + 1] == 0)
+		{
+			continue;
+		}
+
+		const F32 cost = computeSurfaceArea(accumMin, accumMax) * F32(accumCount) + rightArea[i + 1] * F32(rightCount[i + 1]);
+		if(cost < bestCost)
+		{
+			bestCost = cost;
+			bestSplit = i;
+		}
+	}
+
+	if(bestSplit == MAX_U32)
+	{
+		return splitMedian(range, left, right);
+	}
+
+	// Compare with the cost of a leaf. The cost of a node traversal is about the same as a triangle test
+	const F32 area = computeSurfaceArea(range.m_min, range.m_max);
+	const F32 leafCost = area * F32(count);
+	const F32 splitCost = area + bestCost;
+	if(count <= MAX_LEAF_TRIANGLE_COUNT && leafCost <= splitCost)
+	{
+		return false;
+	}
+
+	// Partition
+	U32* first = &m_prims[range.m_begin];
+	U32* last = &m_prims[0] + range.m_end;
+	while(first < last)
+	{
+		if(computeBinIdx(*first) <= bestSplit)
+		{
+			++first;
+		}
+		else
+		{
+			--last;
+			std::swap(*first, *last);
+		}
+	}
+
+	const U32 mid = U32(first - &m_prims[0]);
+	ANKI_ASSERT(mid > range.m_begin && mid < range.m_end);
+	left.m_begin = range.m_begin;
+	left.m_end = mid;
+	right.m_begin = mid;
+	right.m_end = range.m_end;
+	computeBounds(left);
+	computeBounds(right);
+	return true;
+}
+
+U32 Bvh::BuildContext::createLeaf(const Range& range)
+{
+	const U32 count = range.getCount();
+	ANKI_ASSERT(count > 0 && count <= MAX_LEAF_TRIANGLE_COUNT);
+
+	const U32 first = m_triangles.getSize();
+	ANKI_ASSERT(first < (LEAF_BIT >> LEAF_COUNT_BITS) && "Too many triangles");
+
+	for(U32 i = range.m_begin; i < range.m_end; ++i)
+	{
+		const U32 idx = m_prims[i];
+		const Vec3& v0 = m_positions[m_indices[idx * 3 + 0]];
+		const Vec3& v1 = m_positions[m_indices[idx * 3 + 1]];
+		const Vec3& v2 = m_positions[m_indices[idx * 3 + 2]];
+
+		Triangle tri;
+		tri.m_v0 = v0;
+		tri.m_e1 = v1 - v0;
+		tri.m_e2 = v2 - v0;
+		tri.m_index = idx;
+		m_triangles.emplaceBack(tri);
+	}
+
+	return LEAF_BIT | (first << LEAF_COUNT_BITS) | (count - 1);
+}
+
+U32 Bvh::BuildContext::createNode(const Range& range)
+{
+	const U32 nodeIdx = m_nodes.getSize();
+	m_nodes.emplaceBack();
+
+	// Keep splitting the candidate with the biggest area until there are 4 children
+	Array<Range, 4> children;
+	Array<Bool, 4> leafs = {};
+	children[0] = range;
+	U32 childCount = 1;
+	while(childCount < 4)
+	{
+		U32 best = MAX_U32;
+		F32 bestArea = -1.0f;
+		for(U32 i = 0; i < childCount; ++i)
+		{
+			const F32 area = computeSurfaceArea(children[i].m_min, children[i].m_max);
+			if(!leafs[i] && area > bestArea)
+			{
+				best = i;
+				bestArea = area;
+			}
+		}
+
+		if(best == MAX_U32)
+		{
+			break;
+		}
+
+		Range left, right;
+		if(split(children[best], left, right))
+		{
+			children[best] = left;
+			children[childCount] = right;
+			leafs[childCount] = false;
+			++childCount;
+		}
+		else
+		{
+			leafs[best] = true;
+		}
+	}
+
+	// Create the children. Don't keep references to the node since the array might grow
+	Array<U32, 4> codes;
+	for(U32 i = 0; i < 4; ++i)
+	{
+		if(i >= childCount)
+		{
+			codes[i] = MAX_U32;
+		}
+		else if(leafs[i])
+		{
+			codes[i] = createLeaf(children[i]);
+		}
+		else
+		{
+			codes[i] = createNode(children[i]);
+		}
+	}
+
+	Node& node = m_nodes[nodeIdx];
+	for(U32 i = 0; i < 4; ++i)
+	{
+		const Vec3 min = (i < childCount) ? children[i].m_min : Vec3(MAX_F32);
+		const Vec3 max = (i < childCount) ? children[i].m_max : Vec3(-MAX_F32);
+		node.m_minX[i] = min.x();
+		node.m_minY[i] = min.y();
+		node.m_minZ[i] = min.z();
+		node.m_maxX[i] = max.x();
+		node.m_maxY[i] = max.y();
+		node.m_maxZ[i] = max.z();
+		node.m_children[i] = codes[i];
+	}
+
+	return nodeIdx;
+}
+
+/// PACKET_SIZE rays in SoA layout.
+class Bvh::RayPacket
+{
+public:
+	Vec3x4 m_origin;
+	Vec3x4 m_dir;
+	Vec3x4 m_invDir;
+	F32 m_maxT;
+	U32 m_activeMask; ///< The lanes that have a ray.
+};
+
+/// Avoid infinities in the slab tests.
+static F32 safeInverse(F32 f)
+{
+	constexpr F32 MIN = 1.0e-20f;
+	return 1.0f / ((absolute(f) < MIN) ? ((f < 0.0f) ? -MIN : MIN) : f);
+}
+
+/// Moller-Trumbore ray triangle intersection.
+static Bool intersectTriangle(
+	const Vec3& origin, const Vec3& dir, const Vec3& v0, const Vec3& e1, const Vec3& e2, F32& t, F32& u, F32& v)
+{
+	const Vec3 p = dir.cross(e2);
+	const F32 det = e1.dot(p);
+	if(absolute(det) < TRIANGLE_EPSILON)
+	{
+		return false;
+	}
+
+	const F32 invDet = 1.0f / det;
+	const Vec3 s = origin - v0;
+	u = s.dot(p) * invDet;
+	if(u < 0.0f || u > 1.0f)
+	{
+		return false;
+	}
+
+	const Vec3 q = s.cross(e1);
+	v = dir.dot(q) * invDet;
+	if(v < 0.0f || u + v > 1.0f)
+	{
+		return false;
+	}
+
+	t = e2.dot(q) * invDet;
+	return t >= 0.0f;
+}
+
+void Bvh::build(GenericMemoryPoolAllocator<U8> alloc, ConstWeakArray<Vec3> positions, ConstWeakArray<U32> indices)
+{
+	ANKI_ASSERT((indices.getSize() % 3) == 0);
+	destroy();
+	m_alloc = alloc;
+
+	const U32 triangleCount = U32(indices.getSize() / 3);
+	if(triangleCount == 0)
+	{
+		return;
+	}
+
+	BuildContext ctx(alloc);
+	ctx.m_positions = positions;
+	ctx.m_indices = indices;
+	ctx.m_primMin.create(triangleCount);
+	ctx.m_primMax.create(triangleCount);
+	ctx.m_primCentroid.create(triangleCount);
+	ctx.m_prims.create(triangleCount);
+	ctx.m_triangles.resizeStorage(triangleCount);
+
+	BuildContext::Range root;
+	root.m_begin = 0;
+	root.m_end = triangleCount;
+	for(U32 i = 0; i < triangleCount; ++i)
+	{
+		const Vec3& v0 = positions[indices[i * 3 + 0]];
+		const Vec3& v1 = positions[indices[i * 3 + 1]];
+		const Vec3& v2 = positions[indices[i * 3 + 2]];
+
+		ctx.m_primMin[i] = v0.min(v1).min(v2);
+		ctx.m_primMax[i] = v0.max(v1).max(v2);
+		ctx.m_primCentroid[i] = (ctx.m_primMin[i] + ctx.m_primMax[i]) * 0.5f;
+		ctx.m_prims[i] = i;
+
+		root.m_min = root.m_min.min(ctx.m_primMin[i]);
+		root.m_max = root.m_max.max(ctx.m_primMax[i]);
+	}
+
+	ctx.createNode(root);
+	ANKI_ASSERT(ctx.m_triangles.getSize() == triangleCount);
+
+	m_nodes = std::move(ctx.m_nodes);
+	m_triangles = std::move(ctx.m_triangles);
+	m_aabbMin = root.m_min;
+	m_aabbMax = root.m_max;
+}
+
+void Bvh::destroy()
+{
+	m_nodes.destroy(m_alloc);
+	m_triangles.destroy(m_alloc);
+	m_aabbMin = m_aabbMax = Vec3(0.0f);
+}
+
+Bool Bvh::intersectLeaf(U32 child, const Ray& ray, BvhRayQuery query, BvhHit& hit) const
+{
+	ANKI_ASSERT(child & LEAF_BIT);
+	const U32 first = (child & ~LEAF_BIT) >> LEAF_COUNT_BITS;
+	const U32 count = (child & ((1u << LEAF_COUNT_BITS) - 1u)) + 1;
+	const Vec3 origin = ray.getOrigin().xyz();
+	const Vec3 dir = ray.getDirection().xyz();
+
+	Bool found = false;
+	for(U32 i = first; i < first + count; ++i)
+	{
+		const Triangle& tri = m_triangles[i];
+		F32 t, u, v;
+		if(intersectTriangle(origin, dir, tri.m_v0, tri.m_e1, tri.m_e2, t, u, v) && t < hit.m_t)
+		{
+			hit.m_t = t;
+			hit.m_u = u;
+			hit.m_v = v;
+			hit.m_triangleIndex = tri.m_index;
+			found = true;
+
+			if(query == BvhRayQuery::ANY_HIT)
+			{
+				break;
+			}
+		}
+	}
+
+	return found;
+}
+
+Bool Bvh::castRay(const Ray& ray, F32 maxT, BvhRayQuery query, BvhHit& hit) const
+{
+	if(isEmpty())
+	{
+		return false;
+	}
+
+	const Vec3 origin = ray.getOrigin().xyz();
+	const Vec3 dir = ray.getDirection().xyz();
+	const F32x4 ox(origin.x());
+	const F32x4 oy(origin.y());
+	const F32x4 oz(origin.z());
+	const F32x4 idx(safeInverse(dir.x()));
+	const F32x4 idy(safeInverse(dir.y()));
+	const F32x4 idz(safeInverse(dir.z()));
+	const Bool posX = dir.x() >= 0.0f;
+	const Bool posY = dir.y() >= 0.0f;
+	const Bool posZ = dir.z() >= 0.0f;
+	const F32x4 zero(0.0f);
+
+	BvhHit best;
+	best.m_t = maxT;
+
+	Array<U32, MAX_TRAVERSAL_STACK_SIZE> stack;
+	Array<F32, MAX_TRAVERSAL_STACK_SIZE> stackT;
+	U32 stackSize = 1;
+	stack[0] = 0;
+	stackT[0] = 0.0f;
+
+	while(stackSize > 0)
+	{
+		--stackSize;
+		const U32 code = stack[stackSize];
+		if(stackT[stackSize] > best.m_t)
+		{
+			// The box is further than the closest hit
+			continue;
+		}
+
+		if(code & LEAF_BIT)
+		{
+			if(intersectLeaf(code, ray, query, best) && query == BvhRayQuery::ANY_HIT)
+			{
+				break;
+			}
+
+			continue;
+		}
+
+		// Test the 4 children at once. Pick the near and far planes of the slabs using the direction of the ray. That
+		// way the empty children (inverted boxes) never pass the test
+		const Node& node = m_nodes[code];
+		const F32x4 nearX = (F32x4::load(posX ? &node.m_minX[0] : &node.m_maxX[0]) - ox) * idx;
+		const F32x4 nearY = (F32x4::load(posY ? &node.m_minY[0] : &node.m_maxY[0]) - oy) * idy;
+		const F32x4 nearZ = (F32x4::load(posZ ? &node.m_minZ[0] : &node.m_maxZ[0]) - oz) * idz;
+		const F32x4 farX = (F32x4::load(posX ? &node.m_maxX[0] : &node.m_minX[0]) - ox) * idx;
+		const F32x4 farY = (F32x4::load(posY ? &node.m_maxY[0] : &node.m_minY[0]) - oy) * idy;
+		const F32x4 farZ = (F32x4::load(posZ ? &node.m_maxZ[0] : &node.m_minZ[0]) - oz) * idz;
+
+		const F32x4 tNear = F32x4::max(F32x4::max(nearX, nearY), F32x4::max(nearZ, zero));
+		const F32x4 tFar = F32x4::min(F32x4::min(farX, farY), F32x4::min(farZ, F32x4(best.m_t)));
+		const U32 mask = (tNear <= tFar).getMask();
+		if(mask == 0)
+		{
+			continue;
+		}
+
+		// Push the hit children so that the closest is on the top of the stack
+		Array<F32, 4> nearT;
+		tNear.store(&nearT[0]);
+		Array<U32, 4> order;
+		U32 orderCount = 0;
+		for(U32 i = 0; i < 4; ++i)
+		{
+			if((mask & (1u << i)) && node.m_children[i] != MAX_U32)
+			{
+				// Insertion sort, furthest first
+				U32 j = orderCount++;
+				while(j > 0 && nearT[order[j - 1]] < nearT[i])
+				{
+					order[j] = order[j - 1];
+					--j;
+				}
+				order[j] = i;
+			}
+		}
+
+		ANKI_ASSERT(stackSize + orderCount <= MAX_TRAVERSAL_STACK_SIZE);
+		for(U32 i = 0; i < orderCount; ++i)
+		{
+			stack[stackSize] = node.m_children[order[i]];
+			stackT[stackSize] = nearT[order[i]];
+			++stackSize;
+		}
+	}
+
+	if(best.isHit())
+	{
+		hit = best;
+		return true;
+	}
+
+	return false;
+}
+
+void Bvh::castPacket(const RayPacket& packet, BvhRayQuery query, Array<BvhHit, PACKET_SIZE>& hits) const
+{
+	const F32x4 zero(0.0f);
+	const F32x4 one(1.0f);
+	U32 activeMask = packet.m_activeMask;
+
+	F32x4 bestT(packet.m_maxT);
+	F32x4 bestU(0.0f);
+	F32x4 bestV(0.0f);
+	Array<U32, PACKET_SIZE> bestIdx;
+	for(U32& idx : bestIdx)
+	{
+		idx = MAX_U32;
+	}
+
+	Array<U32, MAX_TRAVERSAL_STACK_SIZE> stack;
+	U32 stackSize = 1;
+	stack[0] = 0;
+
+	while(stackSize > 0 && activeMask)
+	{
+		const U32 code = stack[--stackSize];
+
+		if(code & LEAF_BIT)
+		{
+			const U32 first = (code & ~LEAF_BIT) >> LEAF_COUNT_BITS;
+			const U32 count = (code & ((1u << LEAF_COUNT_BITS) - 1u)) + 1;
+
+			for(U32 i = first; i < first + count && activeMask; ++i)
+			{
+				// Moller-Trumbore for all the rays at once
+				const Triangle& tri = m_triangles[i];
+				const Vec3x4 e1(tri.m_e1);
+				const Vec3x4 e2(tri.m_e2);
+
+				const Vec3x4 p = packet.m_dir.cross(e2);
+				const F32x4 det = e1.dot(p);
+				const F32x4 validDet = det.getAbs() >= F32x4(TRIANGLE_EPSILON);
+				const F32x4 invDet = one / F32x4::select(validDet, det, one);
+
+				const Vec3x4 s = packet.m_origin - Vec3x4(tri.m_v0);
+				const F32x4 u = s.dot(p) * invDet;
+				const Vec3x4 q = s.cross(e1);
+				const F32x4 v = packet.m_dir.dot(q) * invDet;
+				const F32x4 t = e2.dot(q) * invDet;
+
+				const F32x4 hitMask =
+					validDet & (u >= zero) & (v >= zero) & ((u + v) <= one) & (t >= zero) & (t < bestT);
+				const U32 mask = hitMask.getMask() & activeMask;
+				if(mask == 0)
+				{
+					continue;
+				}
+
+				bestT = F32x4::select(hitMask, t, bestT);
+				bestU = F32x4::select(hitMask, u, bestU);
+				bestV = F32x4::select(hitMask, v, bestV);
+				for(U32 lane = 0; lane < PACKET_SIZE; ++lane)
+				{
+					if(mask & (1u << lane))
+					{
+						bestIdx[lane] = tri.m_index;
+					}
+				}
+
+				if(query == BvhRayQuery::ANY_HIT)
+				{
+					// These rays are done
+					activeMask &= ~mask;
+				}
+			}
+
+			continue;
+		}
+
+		// Test every child against all the rays. The directions of the rays differ so use the min/max form of the
+		// slab test
+		const Node& node = m_nodes[code];
+		Array<U32, 4> hitChildren;
+		U32 hitChildCount = 0;
+		for(U32 c = 0; c < 4; ++c)
+		{
+			if(node.m_children[c] == MAX_U32)
+			{
+				continue;
+			}
+
+			const F32x4 t1x = (F32x4(node.m_minX[c]) - packet.m_origin.m_x) * packet.m_invDir.m_x;
+			const F32x4 t2x = (F32x4(node.m_maxX[c]) - packet.m_origin.m_x) * packet.m_invDir.m_x;
+			const F32x4 t1y = (F32x4(node.m_minY[c]) - packet.m_origin.m_y) * packet.m_invDir.m_y;
+			const F32x4 t2y = (F32x4(node.m_maxY[c]) - packet.m_origin.m_y) * packet.m_invDir.m_y;
+			const F32x4 t1z = (F32x4(node.m_minZ[c]) - packet.m_origin.m_z) * packet.m_invDir.m_z;
+			const F32x4 t2z = (F32x4(node.m_maxZ[c]) - packet.m_origin.m_z) * packet.m_invDir.m_z;
+
+			const F32x4 tNear = F32x4::max(
+				F32x4::max(F32x4::min(t1x, t2x), F32x4::min(t1y, t2y)), F32x4::max(F32x4::min(t1z, t2z), zero));
+			const F32x4 tFar =
+				F32x4::min(F32x4::min(F32x4::max(t1x, t2x), F32x4::max(t1y, t2y)), F32x4::min(F32x4::max(t1z, t2z), bestT));
+
+			if((tNear <= tFar).getMask() & activeMask)
+			{
+				hitChildren[hitChildCount++] = node.m_children[c];
+			}
+		}
+
+		ANKI_ASSERT(stackSize + hitChildCount <= MAX_TRAVERSAL_STACK_SIZE);
+		for(U32 i = 0; i < hitChildCount; ++i)
+		{
+			stack[stackSize++] = hitChildren[hitChildCount - i - 1];
+		}
+	}
+
+	Array<F32, PACKET_SIZE> t, u, v;
+	bestT.store(&t[0]);
+	bestU.store(&u[0]);
+	bestV.store(&v[0]);
+	for(U32 lane = 0; lane < PACKET_SIZE; ++lane)
+	{
+		hits[lane] = BvhHit();
+		if(bestIdx[lane] != MAX_U32)
+		{
+			hits[lane].m_t = t[lane];
+			hits[lane].m_u = u[lane];
+			hits[lane].m_v = v[lane];
+			hits[lane].m_triangleIndex = bestIdx[lane];
+		}
+	}
+}
+
+void Bvh::castRays(ConstWeakArray<Ray> rays, F32 maxT, BvhRayQuery query, WeakArray<BvhHit> hits) const
+{
+	ANKI_ASSERT(hits.getSize() >= rays.getSize());
+
+	if(isEmpty())
+	{
+		for(U32 i = 0; i < rays.getSize(); ++i)
+		{
+			hits[i] = BvhHit();
+		}
+		return;
+	}
+
+	for(U32 i = 0; i < rays.getSize(); i += PACKET_SIZE)
+	{
+		const U32 count = min<U32>(PACKET_SIZE, rays.getSize() - i);
+
+		// Transpose the rays. The missing ones copy the 1st ray but they are inactive
+		Array<Vec3, PACKET_SIZE> origins, dirs, invDirs;
+		for(U32 lane = 0; lane < PACKET_SIZE; ++lane)
+		{
+			const Ray& ray = rays[i + ((lane < count) ? lane : 0)];
+			origins[lane] = ray.getOrigin().xyz();
+			dirs[lane] = ray.getDirection().xyz();
+			invDirs[lane] =
+				Vec3(safeInverse(dirs[lane].x()), safeInverse(dirs[lane].y()), safeInverse(dirs[lane].z()));
+		}
+
+		RayPacket packet;
+		packet.m_origin = Vec3x4::loadAos(&origins[0]);
+		packet.m_dir = Vec3x4::loadAos(&dirs[0]);
+		packet.m_invDir = Vec3x4::loadAos(&invDirs[0]);
+		packet.m_maxT = maxT;
+		packet.m_activeMask = (1u << count) - 1u;
+
+		Array<BvhHit, PACKET_SIZE> packetHits;
+		castPacket(packet, query, packetHits);
+
+		for(U32 lane = 0; lane < count; ++lane)
+		{
+			hits[i + lane] = packetHits[lane];
+		}
+	}
+}
+
+} // end namespace anki
@@ -0,0 +1,124 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/collision/Ray.h>
+#include <anki/collision/Aabb.h>
+#include <anki/util/DynamicArray.h>
+#include <anki/util/WeakArray.h>
+#include <anki/util/NonCopyable.h>
+
+namespace anki
+{
+
+/// @addtogroup collision
+/// @{
+
+/// The type of a ray query against a Bvh.
+enum class BvhRayQuery : U8
+{
+	CLOSEST_HIT, ///< Find the closest triangle.
+	ANY_HIT ///< Stop at the first triangle found. Faster, good for occlusion and shadow rays.
+};
+
+/// The result of a ray query against a Bvh.
+class BvhHit
+{
+public:
+	F32 m_t = MAX_F32; ///< Distance from the ray origin.
+	U32 m_triangleIndex = MAX_U32; ///< The index of the triangle as given in Bvh::build.
+	F32 m_u = 0.0f; ///< Barycentric coordinate of the 2nd vertex.
+	F32 m_v = 0.0f; ///< Barycentric coordinate of the 3rd vertex.
+
+	Bool isHit() const
+	{
+		return m_triangleIndex != MAX_U32;
+	}
+};
+
+/// A bounding volume hierarchy over static triangles. It's built using the surface area heuristic and every node has
+/// 4 children. The boxes of the children are stored in SoA layout so a ray is tested against all of them at once.
+/// The triangles are two sided.
+class Bvh : public NonCopyable
+{
+public:
+	/// Max triangles per leaf.
+	static constexpr U32 MAX_LEAF_TRIANGLE_COUNT = 16;
+
+	/// The size of a ray packet. See castRays.
+	static constexpr U32 PACKET_SIZE = 4;
+
+	Bvh() = default;
+
+	~Bvh()
+	{
+		destroy();
+	}
+
+	/// Build the hierarchy. It can be called more than once.
+	/// @param alloc The allocator that will be used for the nodes and the triangles.
+	/// @param positions The vertex positions.
+	/// @param indices 3 indices per triangle.
+	void build(GenericMemoryPoolAllocator<U8> alloc, ConstWeakArray<Vec3> positions, ConstWeakArray<U32> indices);
+
+	void destroy();
+
+	Bool isEmpty() const
+	{
+		return m_nodes.getSize() == 0;
+	}
+
+	U32 getTriangleCount() const
+	{
+		return m_triangles.getSize();
+	}
+
+	U32 getNodeCount() const
+	{
+		return m_nodes.getSize();
+	}
+
+	/// Get the bounding box of all the triangles.
+	Aabb getAabb() const
+	{
+		ANKI_ASSERT(!isEmpty());
+		return Aabb(m_aabbMin, m_aabbMax);
+	}
+
+	/// Cast a ray.
+	/// @param ray The ray.
+	/// @param maxT Ignore hits that are further than that.
+	/// @param query Search for the closest hit or stop at the first one.
+	/// @param[out] hit The hit. Untouched if there is no hit.
+	/// @return True if something was hit.
+	Bool castRay(const Ray& ray, F32 maxT, BvhRayQuery query, BvhHit& hit) const;
+
+	/// Cast many rays. The rays are traversed in packets of PACKET_SIZE so it's faster than castRay when the rays are
+	/// coherent (they start from a similar place and have similar directions).
+	/// @param rays The rays.
+	/// @param maxT Ignore hits that are further than that.
+	/// @param query Search for the closest hits or stop at the first ones.
+	/// @param[out] hits One per ray. The hits of the rays that don't hit anything have BvhHit::isHit() false.
+	void castRays(ConstWeakArray<Ray> rays, F32 maxT, BvhRayQuery query, WeakArray<BvhHit> hits) const;
+
+private:
+	class Node;
+	class Triangle;
+	class BuildContext;
+	class RayPacket;
+
+	GenericMemoryPoolAllocator<U8> m_alloc;
+	DynamicArray<Node> m_nodes; ///< The 1st is the root.
+	DynamicArray<Triangle> m_triangles; ///< In leaf order.
+	Vec3 m_aabbMin = Vec3(0.0f);
+	Vec3 m_aabbMax = Vec3(0.0f);
+
+	Bool intersectLeaf(U32 child, const Ray& ray, BvhRayQuery query, BvhHit& hit) const;
+	void castPacket(const RayPacket& packet, BvhRayQuery query, Array<BvhHit, PACKET_SIZE>& hits) const;
+};
+/// @}
+
+} // end namespace anki
@@ -16,5 +16,6 @@ class Aabb;
 class ConvexHullShape;
 class Ray;
 class Cone;
+class GjkQueryCache;
 
 } // end namespace anki
@@ -9,6 +9,7 @@
 #include <anki/collision/Plane.h>
 #include <anki/collision/Ray.h>
 #include <anki/collision/Aabb.h>
+#include <anki/util/WeakArray.h>
 
 namespace anki
 {
@@ -45,12 +46,60 @@ inline F32 testPlane(const Plane& plane, const Vec4& point)
 	return plane.getNormal().dot(point) - plane.getOffset();
 }
 
+/// Test 8 boxes in SoA layout against some planes. It's the core of testPlanesAabbs().
+/// @param planes The planes.
+/// @param aabbMin The min corners of the boxes.
+/// @param aabbMax The max corners of the boxes.
+/// @param[out] visibleMask Bit i is set if the i-th box is in front of or collides with all the planes.
+/// @param[out] insideFullyMask Bit i is set if the i-th box is completely in front of all the planes.
+void testPlanesAabbs(ConstWeakArray<Plane> planes,
+	const Vec3x8& aabbMin,
+	const Vec3x8& aabbMax,
+	U32& visibleMask,
+	U32& insideFullyMask);
+
+/// Test many boxes against some planes (the planes of a frustum for example). It gives the same results as calling
+/// testPlane() for every box and plane but it tests 8 boxes at once.
+/// @param planes The planes.
+/// @param boxes The boxes.
+/// @param[out] visible It should have (boxes.getSize() + 63) / 64 elements. Bit i is set if the i-th box is in front
+///                     of or collides with all the planes (testPlane() >= 0 for all planes).
+/// @param[out] insideFully Same size as @a visible. Bit i is set if the i-th box is completely in front of all the
+///                         planes (testPlane() > 0 for all planes). Can be nullptr.
+void testPlanesAabbs(ConstWeakArray<Plane> planes, ConstWeakArray<Aabb> boxes, U64* visible, U64* insideFully = nullptr);
+
+/// @copydoc testPlanesAabbs(ConstWeakArray<Plane>, ConstWeakArray<Aabb>, U64*, U64*)
+void testPlanesSpheres(
+	ConstWeakArray<Plane> planes, ConstWeakArray<Sphere> spheres, U64* visible, U64* insideFully = nullptr);
+
 /// @copydoc computeAabb(const ConvexHullShape&)
 Aabb computeAabb(const Sphere& sphere);
 
 /// @copydoc computeAabb(const ConvexHullShape&)
 Aabb computeAabb(const Obb& obb);
 
+/// Compute the bounding boxes of many OBBs. It's the same as calling computeAabb(const Obb&) for each one of them but
+/// it works on F32x4::LANE_COUNT OBBs at once.
+/// @param obbs The OBBs.
+/// @param[out] aabbs The results. Same size as @a obbs.
+void computeAabbs(ConstWeakArray<const Obb*> obbs, WeakArray<Aabb> aabbs);
+
+/// Compute the bounding box of an OBB after it's transformed. It's faster than transforming the OBB first.
+Aabb computeAabb(const Obb& obb, const Transform& trf);
+
+/// Compute the bounding box of an AABB after it's transformed.
+Aabb computeAabb(const Aabb& aabb, const Mat3x4& trf);
+
+/// Compute the bounding box of many transformed boxes. Useful to compute the bounds of skinned meshes using the box
+/// and the transform of every bone.
+Aabb computeAabb(ConstWeakArray<Aabb> aabbs, ConstWeakArray<Mat3x4> trfs);
+
+/// Compute the bounding box of a point cloud. The W component of the points is ignored.
+Aabb computeAabb(ConstWeakArray<Vec4> points);
+
+/// @copydoc computeAabb(ConstWeakArray<Vec4>)
+Aabb computeAabb(ConstWeakArray<Vec3> points);
+
 /// Compute a bounding box of a shape.
 Aabb computeAabb(const ConvexHullShape& hull);
 
@@ -110,6 +159,7 @@ inline Bool testCollision(const ConvexHullShape& a, const Obb& b)
 	return testCollision(b, a);
 }
 Bool testCollision(const ConvexHullShape& a, const ConvexHullShape& b);
+Bool testCollision(const ConvexHullShape& a, const ConvexHullShape& b, GjkQueryCache& cache);
 Bool testCollision(const ConvexHullShape& a, const LineSegment& b);
 Bool testCollision(const ConvexHullShape& a, const Cone& b);
 Bool testCollision(const ConvexHullShape& a, const Ray& b);
@@ -188,6 +238,32 @@ Bool testCollision(const Cone& a, const Ray& b);
 
 // Extra testCollision functions
 
+/// Compute the distance between a convex hull and many others. Good for trigger volumes and proximity queries.
+/// @param a The first hull.
+/// @param b The other hulls.
+/// @param maxDistance Stop the search as soon as it's certain that a distance is bigger than that.
+/// @param[out] distances One per hull of @a b. Zero if the hulls intersect and a value bigger than @a maxDistance (but
+///                       not necessarily the exact distance) if they are further apart than that.
+/// @param cache If not nullptr the queries start from the state of the previous queries of the same pairs.
+void computeDistances(const ConvexHullShape& a, ConstWeakArray<const ConvexHullShape*> b, F32 maxDistance,
+	WeakArray<F32> distances, GjkQueryCache* cache = nullptr);
+
+/// Test a sphere against 8 boxes in SoA layout. It gives the same results as testCollision(const Aabb&, const Sphere&)
+/// for every box.
+/// @return Bit i is set if the sphere collides with the i-th box.
+U32 testCollisionAabbsSphere(const Vec3x8& aabbMin, const Vec3x8& aabbMax, const Sphere& sphere);
+
+/// Test a cone against 8 spheres in SoA layout. It gives the same results as testCollision(const Sphere&, const Cone&)
+/// for every sphere.
+/// @param sphereCenters The centers of the spheres.
+/// @param sphereRadii The radii of the spheres.
+/// @param cone The cone.
+/// @param cosHalfAngle cos(cone.getAngle() / 2). The caller computes it once for all the spheres it tests.
+/// @param sinHalfAngle sin(cone.getAngle() / 2).
+/// @return Bit i is set if the cone collides with the i-th sphere.
+U32 testCollisionSpheresCone(
+	const Vec3x8& sphereCenters, const F32x8& sphereRadii, const Cone& cone, F32 cosHalfAngle, F32 sinHalfAngle);
+
 Bool testCollision(const Plane& plane, const Ray& ray, Vec4& intersection);
 Bool testCollision(const Plane& plane, const Vec4& vector, Vec4& intersection);
 Bool testCollision(const Sphere& sphere, const Ray& ray, Array<Vec4, 2>& intersectionPoints, U& intersectionPointCount);
@@ -220,15 +296,59 @@ inline Vec4 projectPointToPlane(const Plane& plane, const Vec4& point)
 	return point - plane.getNormal() * testPlane(plane, point);
 }
 
+/// Extract a clip plane using an MVP matrix. The plane is known at compile time so there is no branching.
+template<FrustumPlaneType PLANE>
+inline Plane extractClipPlane(const Mat4& mvp)
+{
+	constexpr U32 ROW = (PLANE == FrustumPlaneType::NEAR || PLANE == FrustumPlaneType::FAR)
+							? 2
+							: ((PLANE == FrustumPlaneType::LEFT || PLANE == FrustumPlaneType::RIGHT) ? 0 : 1);
+	constexpr F32 SIGN = (PLANE == FrustumPlaneType::NEAR || PLANE == FrustumPlaneType::LEFT
+							 || PLANE == FrustumPlaneType::BOTTOM)
+							 ? 1.0f
+							 : -1.0f;
+
+	const Vec4 planeEqationCoefs = mvp.getRow(3) + mvp.getRow(ROW) * SIGN;
+	const Vec4 n = planeEqationCoefs.xyz0();
+	const F32 len = n.getLength();
+	return Plane(n / len, -planeEqationCoefs.w() / len);
+}
+
 /// Extract the clip planes using an MVP matrix.
-void extractClipPlanes(const Mat4& mvp, Array<Plane, 6>& planes);
+inline void extractClipPlanes(const Mat4& mvp, Array<Plane, 6>& planes)
+{
+	planes[FrustumPlaneType::NEAR] = extractClipPlane<FrustumPlaneType::NEAR>(mvp);
+	planes[FrustumPlaneType::FAR] = extractClipPlane<FrustumPlaneType::FAR>(mvp);
+	planes[FrustumPlaneType::LEFT] = extractClipPlane<FrustumPlaneType::LEFT>(mvp);
+	planes[FrustumPlaneType::RIGHT] = extractClipPlane<FrustumPlaneType::RIGHT>(mvp);
+	planes[FrustumPlaneType::TOP] = extractClipPlane<FrustumPlaneType::TOP>(mvp);
+	planes[FrustumPlaneType::BOTTOM] = extractClipPlane<FrustumPlaneType::BOTTOM>(mvp);
+}
 
 /// See extractClipPlanes.
 void extractClipPlane(const Mat4& mvp, FrustumPlaneType id, Plane& plane);
 
+/// Extract the world space clip planes of many frustums that share the same projection, like the 6 faces of a cube map
+/// or an omni light. The planes are extracted once from the projection and then transformed per frustum.
+/// @param proj The common projection matrix.
+/// @param cameraTransforms The world transforms of the cameras. Not the view matrices.
+/// @param[out] planes The planes of each frustum.
+void extractClipPlanes(
+	const Mat4& proj, ConstWeakArray<Transform> cameraTransforms, WeakArray<Array<Plane, 6>> planes);
+
 /// Compute the edges of the far plane of a frustum
 void computeEdgesOfFrustum(F32 far, F32 fovX, F32 fovY, Vec4 points[4]);
 
+/// Compute the edges of the far plane of a frustum with 90 degrees FOV, like the ones of the cube map faces. It's the
+/// same as computeEdgesOfFrustum() without the trigonometry.
+inline void computeEdgesOfCubeFaceFrustum(F32 far, Vec4 points[4])
+{
+	points[0] = Vec4(far, far, -far, 0.0f); // top right
+	points[1] = Vec4(-far, far, -far, 0.0f); // top left
+	points[2] = Vec4(-far, -far, -far, 0.0f); // bot left
+	points[3] = Vec4(far, -far, -far, 0.0f); // bot right
+}
+
 /// @}
 
 } // end namespace anki
\ No newline at end of file
@@ -9,6 +9,7 @@
 #include <anki/collision/LineSegment.h>
 #include <anki/collision/Cone.h>
 #include <anki/collision/Sphere.h>
+#include <anki/math/SimdWide.h>
 
 namespace anki
 {
@@ -21,37 +22,215 @@ Aabb computeAabb(const Sphere& sphere)
 	return aabb;
 }
 
-Aabb computeAabb(const Obb& obb)
+/// Compute the AABB of a box given its center, its extend and the rotation (and scale) of its axis.
+static Aabb computeAabbOfBox(const Vec4& center, const Mat3x4& rotation, const Vec4& extend)
 {
 	Mat3x4 absM;
-	for(U i = 0; i < 12; ++i)
+	for(U32 i = 0; i < 3; ++i)
 	{
-		absM[i] = absolute(obb.getRotation()[i]);
+		absM.setRow(i, rotation.getRow(i).abs());
 	}
 
-	const Vec4 newE = Vec4(absM * obb.getExtend(), 0.0f);
+	const Vec4 newE = Vec4(absM * extend, 0.0f);
 
 	// Add a small epsilon to avoid some assertions
 	const Vec4 epsilon(Vec3(EPSILON * 100.0f), 0.0f);
 
-	return Aabb(obb.getCenter() - newE, obb.getCenter() + newE + epsilon);
+	return Aabb(center - newE, center + newE + epsilon);
 }
 
-Aabb computeAabb(const ConvexHullShape& hull)
+Aabb computeAabb(const Obb& obb)
+{
+	return computeAabbOfBox(obb.getCenter(), obb.getRotation(), obb.getExtend());
+}
+
+void computeAabbs(ConstWeakArray<const Obb*> obbs, WeakArray<Aabb> aabbs)
 {
+	ANKI_ASSERT(obbs.getSize() == aabbs.getSize());
+
+	constexpr U32 LANE_COUNT = F32x4::LANE_COUNT;
+	const F32x4 epsilon(EPSILON * 100.0f);
+
+	for(U32 first = 0; first < obbs.getSize(); first += LANE_COUNT)
+	{
+		const U32 count = min(obbs.getSize() - first, LANE_COUNT);
+
+		// Gather to SoA. Repeat the last OBB in the unused lanes
+		Array<Array<F32, LANE_COUNT>, 3> center;
+		Array<Array<F32, LANE_COUNT>, 3> extend;
+		Array<Array<F32, LANE_COUNT>, 9> rotation;
+		for(U32 lane = 0; lane < LANE_COUNT; ++lane)
+		{
+			const Obb& obb = *obbs[first + min(lane, count - 1)];
+			for(U32 i = 0; i < 3; ++i)
+			{
+				center[i][lane] = obb.getCenter()[i];
+				extend[i][lane] = obb.getExtend()[i];
+				for(U32 j = 0; j < 3; ++j)
+				{
+					rotation[i * 3 + j][lane] = obb.getRotation()(i, j);
+				}
+			}
+		}
+
+		const F32x4 ex = F32x4::load(&extend[0][0]);
+		const F32x4 ey = F32x4::load(&extend[1][0]);
+		const F32x4 ez = F32x4::load(&extend[2][0]);
+
+		// newE = abs(rotation) * extend
+		Array<Array<F32, LANE_COUNT>, 3> mins;
+		Array<Array<F32, LANE_COUNT>, 3> maxs;
+		for(U32 i = 0; i < 3; ++i)
+		{
+			F32x4 newE = F32x4::load(&rotation[i * 3 + 0][0]).getAbs() * ex;
+			newE = F32x4::mulAdd(F32x4::load(&rotation[i * 3 + 1][0]).getAbs(), ey, newE);
+			newE = F32x4::mulAdd(F32x4::load(&rotation[i * 3 + 2][0]).getAbs(), ez, newE);
+
+			const F32x4 c = F32x4::load(&center[i][0]);
+			(c - newE).store(&mins[i][0]);
+			(c + newE + epsilon).store(&maxs[i][0]);
+		}
+
+		for(U32 lane = 0; lane < count; ++lane)
+		{
+			aabbs[first + lane] = Aabb(Vec4(mins[0][lane], mins[1][lane], mins[2][lane], 0.0f),
+				Vec4(maxs[0][lane], maxs[1][lane], maxs[2][lane], 0.0f));
+		}
+	}
+}
+
+Aabb computeAabb(const Obb& obb, const Transform& trf)
+{
+	// Bake the rotation of the OBB with the one of the transform instead of creating the transformed OBB
+	const Mat3x4 rot = trf.getRotation().combineTransformations(obb.getRotation());
+	const Vec4 center = trf.transform(obb.getCenter());
+	return computeAabbOfBox(center, rot, obb.getExtend() * trf.getScale());
+}
+
+Aabb computeAabb(const Aabb& aabb, const Mat3x4& trf)
+{
+	const Vec4 center = ((aabb.getMin() + aabb.getMax()) * 0.5f).xyz1();
+	const Vec4 extend = ((aabb.getMax() - aabb.getMin()) * 0.5f).xyz0();
+	return computeAabbOfBox(Vec4(trf * center, 0.0f), trf, extend);
+}
+
+Aabb computeAabb(ConstWeakArray<Aabb> aabbs, ConstWeakArray<Mat3x4> trfs)
+{
+	ANKI_ASSERT(aabbs.getSize() > 0 && aabbs.getSize() == trfs.getSize());
+
 	Vec4 mina(MAX_F32);
 	Vec4 maxa(MIN_F32);
+	for(U32 i = 0; i < aabbs.getSize(); ++i)
+	{
+		const Aabb box = computeAabb(aabbs[i], trfs[i]);
+		mina = mina.min(box.getMin());
+		maxa = maxa.max(box.getMax());
+	}
+
+	return Aabb(mina.xyz0(), maxa.xyz0());
+}
+
+Aabb computeAabb(ConstWeakArray<Vec4> points)
+{
+	ANKI_ASSERT(points.getSize() > 0);
+
+	// Use 4 pairs of accumulators to break the dependency chains of min and max
+	Array<Vec4, 4> mins = {{Vec4(MAX_F32), Vec4(MAX_F32), Vec4(MAX_F32), Vec4(MAX_F32)}};
+	Array<Vec4, 4> maxs = {{Vec4(MIN_F32), Vec4(MIN_F32), Vec4(MIN_F32), Vec4(MIN_F32)}};
+
+	const U32 count = points.getSize();
+	U32 i = 0;
+	for(; i + 4 <= count; i += 4)
+	{
+		for(U32 j = 0; j < 4; ++j)
+		{
+			mins[j] = mins[j].min(points[i + j]);
+			maxs[j] = maxs[j].max(points[i + j]);
+		}
+	}
 
-	for(const Vec4& point : hull.getPoints())
+	for(; i < count; ++i)
 	{
-		const Vec4 o = (hull.isTransformIdentity()) ? point : hull.getTransform().transform(point);
-		mina = mina.min(o);
-		maxa = maxa.max(o);
+		mins[0] = mins[0].min(points[i]);
+		maxs[0] = maxs[0].max(points[i]);
 	}
 
+	const Vec4 mina = mins[0].min(mins[1]).min(mins[2].min(mins[3]));
+	const Vec4 maxa = maxs[0].max(maxs[1]).max(maxs[2].max(maxs[3]));
 	return Aabb(mina.xyz0(), maxa.xyz0());
 }
 
+Aabb computeAabb(ConstWeakArray<Vec3> points)
+{
+	ANKI_ASSERT(points.getSize() > 0);
+
+	// Load 4 floats starting from every point. The 4th lane is the X of the next point and it's ignored in the end. The
+	// last point can't be loaded like that because it would read past the end of the array
+	const U32 count = points.getSize();
+	const Vec3& last = points[count - 1];
+	const F32x4 lastPoint = F32x4::load(&Vec4(last, 0.0f)[0]);
+
+	Array<F32x4, 4> mins = {{lastPoint, lastPoint, lastPoint, lastPoint}};
+	Array<F32x4, 4> maxs = mins;
+
+	U32 i = 0;
+	for(; i + 4 < count; i += 4)
+	{
+		for(U32 j = 0; j < 4; ++j)
+		{
+			const F32x4 p = F32x4::load(&points[i + j][0]);
+			mins[j] = F32x4::min(mins[j], p);
+			maxs[j] = F32x4::max(maxs[j], p);
+		}
+	}
+
+	for(; i + 1 < count; ++i)
+	{
+		const F32x4 p = F32x4::load(&points[i][0]);
+		mins[0] = F32x4::min(mins[0], p);
+		maxs[0] = F32x4::max(maxs[0], p);
+	}
+
+	const F32x4 mina = F32x4::min(F32x4::min(mins[0], mins[1]), F32x4::min(mins[2], mins[3]));
+	const F32x4 maxa = F32x4::max(F32x4::max(maxs[0], maxs[1]), F32x4::max(maxs[2], maxs[3]));
+	return Aabb(Vec4(mina.getLane(0), mina.getLane(1), mina.getLane(2), 0.0f),
+		Vec4(maxa.getLane(0), maxa.getLane(1), maxa.getLane(2), 0.0f));
+}
+
+Aabb computeAabb(const ConvexHullShape& hull)
+{
+	if(hull.isTransformIdentity())
+	{
+		return computeAabb(hull.getPoints());
+	}
+
+	// Transform with a single matrix product per point
+	const Mat3x4 trf(hull.getTransform());
+	Array<Vec4, 2> mins = {{Vec4(MAX_F32), Vec4(MAX_F32)}};
+	Array<Vec4, 2> maxs = {{Vec4(MIN_F32), Vec4(MIN_F32)}};
+
+	const ConstWeakArray<Vec4> points = hull.getPoints();
+	U32 i = 0;
+	for(; i + 2 <= points.getSize(); i += 2)
+	{
+		for(U32 j = 0; j < 2; ++j)
+		{
+			const Vec4 o(trf * points[i + j].xyz1(), 0.0f);
+			mins[j] = mins[j].min(o);
+			maxs[j] = maxs[j].max(o);
+		}
+	}
+
+	if(i < points.getSize())
+	{
+		const Vec4 o(trf * points[i].xyz1(), 0.0f);
+		mins[0] = mins[0].min(o);
+		maxs[0] = maxs[0].max(o);
+	}
+
+	return Aabb(mins[0].min(mins[1]).xyz0(), maxs[0].max(maxs[1]).xyz0());
+}
+
 Aabb computeAabb(const LineSegment& ls)
 {
 	const Vec4 p0 = ls.getOrigin();
@@ -10,36 +10,45 @@ namespace anki
 
 void extractClipPlane(const Mat4& mvp, FrustumPlaneType id, Plane& plane)
 {
-#define ANKI_CASE(i, a, op, b) \
-	case i: \
-	{ \
-		const Vec4 planeEqationCoefs = mvp.getRow(a) op mvp.getRow(b); \
-		const Vec4 n = planeEqationCoefs.xyz0(); \
-		const F32 len = n.getLength(); \
-		plane = Plane(n / len, -planeEqationCoefs.w() / len); \
-		break; \
-	}
-
 	switch(id)
 	{
-		ANKI_CASE(FrustumPlaneType::NEAR, 3, +, 2)
-		ANKI_CASE(FrustumPlaneType::FAR, 3, -, 2)
-		ANKI_CASE(FrustumPlaneType::LEFT, 3, +, 0)
-		ANKI_CASE(FrustumPlaneType::RIGHT, 3, -, 0)
-		ANKI_CASE(FrustumPlaneType::TOP, 3, -, 1)
-		ANKI_CASE(FrustumPlaneType::BOTTOM, 3, +, 1)
+	case FrustumPlaneType::NEAR:
+		plane = extractClipPlane<FrustumPlaneType::NEAR>(mvp);
+		break;
+	case FrustumPlaneType::FAR:
+		plane = extractClipPlane<FrustumPlaneType::FAR>(mvp);
+		break;
+	case FrustumPlaneType::LEFT:
+		plane = extractClipPlane<FrustumPlaneType::LEFT>(mvp);
+		break;
+	case FrustumPlaneType::RIGHT:
+		plane = extractClipPlane<FrustumPlaneType::RIGHT>(mvp);
+		break;
+	case FrustumPlaneType::TOP:
+		plane = extractClipPlane<FrustumPlaneType::TOP>(mvp);
+		break;
+	case FrustumPlaneType::BOTTOM:
+		plane = extractClipPlane<FrustumPlaneType::BOTTOM>(mvp);
+		break;
 	default:
 		ANKI_ASSERT(0);
 	}
-
-#undef ANKI_CASE
 }
 
-void extractClipPlanes(const Mat4& mvp, Array<Plane, 6>& planes)
+void extractClipPlanes(const Mat4& proj, ConstWeakArray<Transform> cameraTransforms, WeakArray<Array<Plane, 6>> planes)
 {
-	for(U i = 0; i < 6; ++i)
+	ANKI_ASSERT(cameraTransforms.getSize() == planes.getSize());
+
+	// The planes in view space are common
+	Array<Plane, 6> viewPlanes;
+	extractClipPlanes(proj, viewPlanes);
+
+	for(U32 i = 0; i < cameraTransforms.getSize(); ++i)
 	{
-		extractClipPlane(mvp, static_cast<FrustumPlaneType>(i), planes[i]);
+		for(U32 p = 0; p < 6; ++p)
+		{
+			planes[i][p] = viewPlanes[p].getTransformed(cameraTransforms[i]);
+		}
 	}
 }
 
@@ -26,6 +26,11 @@ static Bool testCollisionGjk(const T& a, const Y& b)
 	return gjkIntersection(&a, callbackA, &b, callbackB);
 }
 
+static Vec4 convexHullSupport(const void* shape, const Vec4& dir)
+{
+	return static_cast<const ConvexHullShape*>(shape)->computeSupport(dir);
+}
+
 Bool testCollision(const Aabb& a, const Aabb& b)
 {
 #if ANKI_SIMD_SSE
@@ -306,6 +311,11 @@ Bool testCollision(const ConvexHullShape& a, const ConvexHullShape& b)
 	return testCollisionGjk(a, b);
 }
 
+Bool testCollision(const ConvexHullShape& a, const ConvexHullShape& b, GjkQueryCache& cache)
+{
+	return gjkIntersection(&a, convexHullSupport, &b, convexHullSupport, &cache.getEntry(&a, &b));
+}
+
 Bool testCollision(const ConvexHullShape& hull, const LineSegment& ls)
 {
 	ANKI_ASSERT(!"TODO");
@@ -416,4 +426,45 @@ Bool intersect(const Sphere& sphere, const Ray& ray, Array<Vec4, 2>& intersectio
 	}
 }
 
+U32 testCollisionAabbsSphere(const Vec3x8& aabbMin, const Vec3x8& aabbMax, const Sphere& sphere)
+{
+	// Same as the scalar version, find the closest point of every box to the sphere
+	const Vec3x8 center(sphere.getCenter().xyz());
+	const Vec3x8 closestPoint = Vec3x8::min(Vec3x8::max(center, aabbMin), aabbMax);
+	const F32x8 radiusSq(sphere.getRadius() * sphere.getRadius());
+
+	return ((center - closestPoint).getLengthSquared() <= radiusSq).getMask();
+}
+
+U32 testCollisionSpheresCone(
+	const Vec3x8& sphereCenters, const F32x8& sphereRadii, const Cone& cone, F32 cosHalfAngle, F32 sinHalfAngle)
+{
+	ANKI_ASSERT(isZero(cosHalfAngle - cos(cone.getAngle() / 2.0f), 0.001f));
+
+	// See the scalar version
+	const Vec3x8 V = sphereCenters - Vec3x8(cone.getOrigin().xyz());
+	const F32x8 VlenSq = V.getLengthSquared();
+	const F32x8 V1len = V.dot(Vec3x8(cone.getDirection().xyz()));
+	const F32x8 perpendicularLen = F32x8::max(VlenSq - V1len * V1len, F32x8(0.0f)).getSqrt();
+	const F32x8 distanceClosestPoint = F32x8(cosHalfAngle) * perpendicularLen - V1len * F32x8(sinHalfAngle);
+
+	const F32x8 angleCull = distanceClosestPoint > sphereRadii;
+	const F32x8 frontCull = V1len > sphereRadii + F32x8(cone.getLength());
+	const F32x8 backCull = V1len < -sphereRadii;
+	return ~(angleCull | frontCull | backCull).getMask() & F32x8::ALL_LANES_MASK;
+}
+
+void computeDistances(const ConvexHullShape& a, ConstWeakArray<const ConvexHullShape*> b, F32 maxDistance,
+	WeakArray<F32> distances, GjkQueryCache* cache)
+{
+	ANKI_ASSERT(distances.getSize() >= b.getSize());
+
+	for(U32 i = 0; i < b.getSize(); ++i)
+	{
+		ANKI_ASSERT(b[i]);
+		GjkCacheEntry* entry = (cache) ? &cache->getEntry(&a, b[i]) : nullptr;
+		distances[i] = gjkDistance(&a, convexHullSupport, b[i], convexHullSupport, maxDistance, entry);
+	}
+}
+
 } // end namespace anki
@@ -183,4 +183,134 @@ F32 testPlane(const Plane& plane, const LineSegment& ls)
 	}
 }
 
+void testPlanesAabbs(ConstWeakArray<Plane> planes,
+	const Vec3x8& aabbMin,
+	const Vec3x8& aabbMax,
+	U32& visibleMask,
+	U32& insideFullyMask)
+{
+	const F32x8 zero(0.0f);
+	visibleMask = F32x8::ALL_LANES_MASK;
+	insideFullyMask = F32x8::ALL_LANES_MASK;
+
+	for(const Plane& plane : planes)
+	{
+		const Vec4& n = plane.getNormal();
+		const Vec3x8 normal(n.xyz());
+		const F32x8 offset(plane.getOffset());
+
+		// The sign of the normal is the same for all boxes so pick the corners without a select
+		const Vec3x8 diagMin((n.x() >= 0.0f) ? aabbMin.m_x : aabbMax.m_x,
+			(n.y() >= 0.0f) ? aabbMin.m_y : aabbMax.m_y,
+			(n.z() >= 0.0f) ? aabbMin.m_z : aabbMax.m_z);
+		const Vec3x8 diagMax((n.x() >= 0.0f) ? aabbMax.m_x : aabbMin.m_x,
+			(n.y() >= 0.0f) ? aabbMax.m_y : aabbMin.m_y,
+			(n.z() >= 0.0f) ? aabbMax.m_z : aabbMin.m_z);
+
+		visibleMask &= (normal.dot(diagMax) - offset >= zero).getMask();
+		insideFullyMask &= (normal.dot(diagMin) - offset > zero).getMask();
+
+		if(visibleMask == 0)
+		{
+			break;
+		}
+	}
+
+	insideFullyMask &= visibleMask;
+}
+
+void testPlanesAabbs(ConstWeakArray<Plane> planes, ConstWeakArray<Aabb> boxes, U64* visible, U64* insideFully)
+{
+	constexpr U32 LANE_COUNT = F32x8::LANE_COUNT;
+	ANKI_ASSERT(visible || boxes.getSize() == 0);
+
+	for(U32 i = 0; i < boxes.getSize(); i += LANE_COUNT)
+	{
+		// Transpose to SoA. The missing boxes get zero sized boxes and their results are ignored
+		const U32 count = min<U32>(LANE_COUNT, boxes.getSize() - i);
+		Array<Vec3, LANE_COUNT> mins, maxs;
+		for(U32 j = 0; j < count; ++j)
+		{
+			mins[j] = boxes[i + j].getMin().xyz();
+			maxs[j] = boxes[i + j].getMax().xyz();
+		}
+
+		U32 visibleMask, insideFullyMask;
+		testPlanesAabbs(
+			planes, Vec3x8::loadAos(&mins[0], count), Vec3x8::loadAos(&maxs[0], count), visibleMask, insideFullyMask);
+
+		const U64 laneMask = (U64(1) << count) - 1;
+		const U64 bit = i % 64;
+		if(bit == 0)
+		{
+			visible[i / 64] = 0;
+			if(insideFully)
+			{
+				insideFully[i / 64] = 0;
+			}
+		}
+
+		visible[i / 64] |= (U64(visibleMask) & laneMask) << bit;
+		if(insideFully)
+		{
+			insideFully[i / 64] |= (U64(insideFullyMask) & laneMask) << bit;
+		}
+	}
+}
+
+void testPlanesSpheres(ConstWeakArray<Plane> planes, ConstWeakArray<Sphere> spheres, U64* visible, U64* insideFully)
+{
+	constexpr U32 LANE_COUNT = F32x8::LANE_COUNT;
+	ANKI_ASSERT(visible || spheres.getSize() == 0);
+	const F32x8 zero(0.0f);
+
+	for(U32 i = 0; i < spheres.getSize(); i += LANE_COUNT)
+	{
+		const U32 count = min<U32>(LANE_COUNT, spheres.getSize() - i);
+		Array<Vec3, LANE_COUNT> centers;
+		Array<F32, LANE_COUNT> radii;
+		for(U32 j = 0; j < LANE_COUNT; ++j)
+		{
+			centers[j] = (j < count) ? spheres[i + j].getCenter().xyz() : Vec3(0.0f);
+			radii[j] = (j < count) ? spheres[i + j].getRadius() : 0.0f;
+		}
+
+		const Vec3x8 center = Vec3x8::loadAos(&centers[0]);
+		const F32x8 radius = F32x8::load(&radii[0]);
+
+		U32 visibleMask = F32x8::ALL_LANES_MASK;
+		U32 insideFullyMask = F32x8::ALL_LANES_MASK;
+		for(const Plane& plane : planes)
+		{
+			const F32x8 dist = Vec3x8(plane.getNormal().xyz()).dot(center) - F32x8(plane.getOffset());
+			visibleMask &= (dist + radius >= zero).getMask();
+			insideFullyMask &= (dist - radius > zero).getMask();
+
+			if(visibleMask == 0)
+			{
+				break;
+			}
+		}
+
+		insideFullyMask &= visibleMask;
+
+		const U64 laneMask = (U64(1) << count) - 1;
+		const U64 bit = i % 64;
+		if(bit == 0)
+		{
+			visible[i / 64] = 0;
+			if(insideFully)
+			{
+				insideFully[i / 64] = 0;
+			}
+		}
+
+		visible[i / 64] |= (U64(visibleMask) & laneMask) << bit;
+		if(insideFully)
+		{
+			insideFully[i / 64] |= (U64(insideFullyMask) & laneMask) << bit;
+		}
+	}
+}
+
 } // end namespace anki
@@ -5,6 +5,8 @@
 // Inspired by http://vec3.ca/gjk/implementation/
 
 #include <anki/collision/GjkEpa.h>
+#include <anki/util/Hash.h>
+#include <anki/util/Functions.h>
 
 namespace anki
 {
@@ -210,8 +212,27 @@ static Bool update(GjkContext& ctx, const GjkSupport& a)
 	return true;
 }
 
-Bool gjkIntersection(
-	const void* shape0, GjkSupportCallback shape0Callback, const void* shape1, GjkSupportCallback shape1Callback)
+/// Store the search direction to the cache.
+static void storeDirection(const Vec4& dir, GjkCacheEntry* cache)
+{
+	if(cache)
+	{
+		const F32 lengthSquared = dir.getLengthSquared();
+		if(lengthSquared > EPSILON * EPSILON)
+		{
+			cache->m_dir = dir / sqrt(lengthSquared);
+		}
+	}
+}
+
+/// Get the initial search direction.
+static Vec4 loadDirection(const GjkCacheEntry* cache)
+{
+	return (cache) ? cache->m_dir : Vec4(1.0f, 0.0f, 0.0f, 0.0f);
+}
+
+Bool gjkIntersection(const void* shape0, GjkSupportCallback shape0Callback, const void* shape1,
+	GjkSupportCallback shape1Callback, GjkCacheEntry* cache)
 {
 	ANKI_ASSERT(shape0 && shape0Callback && shape1 && shape1Callback);
 
@@ -221,13 +242,14 @@ Bool gjkIntersection(
 	ctx.m_shape0Callback = shape0Callback;
 	ctx.m_shape1Callback = shape1Callback;
 
-	// Chose random direction
-	ctx.m_dir = Vec4(1.0, 0.0, 0.0, 0.0);
+	// Chose random direction or the one of the previous query
+	ctx.m_dir = loadDirection(cache);
 
 	// Do cases 1, 2
 	support(ctx, ctx.m_simplex[2]);
 	if(ctx.m_simplex[2].m_v.dot(ctx.m_dir) < 0.0)
 	{
+		storeDirection(ctx.m_dir, cache);
 		return false;
 	}
 
@@ -236,6 +258,7 @@ Bool gjkIntersection(
 
 	if(ctx.m_simplex[1].m_v.dot(ctx.m_dir) < 0.0)
 	{
+		storeDirection(ctx.m_dir, cache);
 		return false;
 	}
 
@@ -250,16 +273,360 @@ Bool gjkIntersection(
 
 		if(a.m_v.dot(ctx.m_dir) < 0.0)
 		{
+			storeDirection(ctx.m_dir, cache);
 			return false;
 		}
 
 		if(update(ctx, a))
 		{
+			storeDirection(ctx.m_dir, cache);
 			return true;
 		}
 	}
 
+	storeDirection(ctx.m_dir, cache);
+	return true;
+}
+
+/// The simplex of the GJK distance algorithm.
+class GjkDistanceSimplex
+{
+public:
+	Array<Vec4, 4> m_points;
+	U32 m_count = 0;
+
+	void keep(U32 a)
+	{
+		m_points[0] = m_points[a];
+		m_count = 1;
+	}
+
+	void keep(U32 a, U32 b)
+	{
+		const Vec4 pb = m_points[b];
+		m_points[0] = m_points[a];
+		m_points[1] = pb;
+		m_count = 2;
+	}
+
+	void keep(U32 a, U32 b, U32 c)
+	{
+		const Vec4 pb = m_points[b];
+		const Vec4 pc = m_points[c];
+		m_points[0] = m_points[a];
+		m_points[1] = pb;
+		m_points[2] = pc;
+		m_count = 3;
+	}
+};
+
+/// Closest point of a segment to the origin. Returns the vertices that define it.
+static Vec4 closestPointSegment(const Vec4& a, const Vec4& b, Array<U32, 3>& verts, U32& vertCount)
+{
+	const Vec4 ab = b - a;
+	const F32 t = -a.dot(ab);
+	if(t <= 0.0f)
+	{
+		verts[0] = 0;
+		vertCount = 1;
+		return a;
+	}
+
+	const F32 denom = ab.dot(ab);
+	if(t >= denom)
+	{
+		verts[0] = 1;
+		vertCount = 1;
+		return b;
+	}
+
+	verts[0] = 0;
+	verts[1] = 1;
+	vertCount = 2;
+	return a + ab * (t / denom);
+}
+
+/// Closest point of a triangle to the origin. Returns the vertices that define it. From Real-Time Collision Detection.
+static Vec4 closestPointTriangle(const Vec4& a, const Vec4& b, const Vec4& c, Array<U32, 3>& verts, U32& vertCount)
+{
+	const Vec4 ab = b - a;
+	const Vec4 ac = c - a;
+
+	const F32 d1 = -ab.dot(a);
+	const F32 d2 = -ac.dot(a);
+	if(d1 <= 0.0f && d2 <= 0.0f)
+	{
+		verts[0] = 0;
+		vertCount = 1;
+		return a;
+	}
+
+	const F32 d3 = -ab.dot(b);
+	const F32 d4 = -ac.dot(b);
+	if(d3 >= 0.0f && d4 <= d3)
+	{
+		verts[0] = 1;
+		vertCount = 1;
+		return b;
+	}
+
+	const F32 vc = d1 * d4 - d3 * d2;
+	if(vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+	{
+		verts[0] = 0;
+		verts[1] = 1;
+		vertCount = 2;
+		return a + ab * (d1 / (d1 - d3));
+	}
+
+	const F32 d5 = -ab.dot(c);
+	const F32 d6 = -ac.dot(c);
+	if(d6 >= 0.0f && d5 <= d6)
+	{
+		verts[0] = 2;
+		vertCount = 1;
+		return c;
+	}
+
+	const F32 vb = d5 * d2 - d1 * d6;
+	if(vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+	{
+		verts[0] = 0;
+		verts[1] = 2;
+		vertCount = 2;
+		return a + ac * (d2 / (d2 - d6));
+	}
+
+	const F32 va = d3 * d6 - d5 * d4;
+	if(va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+	{
+		verts[0] = 1;
+		verts[1] = 2;
+		vertCount = 2;
+		return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+	}
+
+	const F32 denom = 1.0f / (va + vb + vc);
+	verts[0] = 0;
+	verts[1] = 1;
+	verts[2] = 2;
+	vertCount = 3;
+	return a + ab * (vb * denom) + ac * (vc * denom);
+}
+
+/// Find the point of the simplex that is closest to the origin and drop the vertices that don't contribute to it.
+/// @return False if the origin is inside the simplex.
+static Bool reduceSimplex(GjkDistanceSimplex& simplex, Vec4& closest)
+{
+	Array<U32, 3> verts;
+	U32 vertCount;
+
+	switch(simplex.m_count)
+	{
+	case 1:
+		closest = simplex.m_points[0];
+		return true;
+	case 2:
+		closest = closestPointSegment(simplex.m_points[0], simplex.m_points[1], verts, vertCount);
+		break;
+	case 3:
+		closest = closestPointTriangle(simplex.m_points[0], simplex.m_points[1], simplex.m_points[2], verts, vertCount);
+		break;
+	default:
+	{
+		ANKI_ASSERT(simplex.m_count == 4);
+
+		// Check the faces that have the origin in front of them
+		const Array<Array<U32, 4>, 4> faces = {{{0, 1, 2, 3}, {0, 3, 1, 2}, {0, 2, 3, 1}, {1, 3, 2, 0}}};
+		F32 bestDistSquared = MAX_F32;
+		U32 bestFace = MAX_U32;
+		Array<U32, 3> bestVerts;
+		U32 bestVertCount = 0;
+		for(U32 f = 0; f < 4; ++f)
+		{
+			const Vec4& a = simplex.m_points[faces[f][0]];
+			const Vec4& b = simplex.m_points[faces[f][1]];
+			const Vec4& c = simplex.m_points[faces[f][2]];
+			const Vec4& d = simplex.m_points[faces[f][3]];
+
+			const Vec4 n = (b - a).cross(c - a);
+			const F32 signOrigin = -n.dot(a);
+			const F32 signOpposite = n.dot(d - a);
+			if(signOrigin * signOpposite >= 0.0f && absolute(signOpposite) > EPSILON * EPSILON)
+			{
+				// Origin on the same side as the opposite vertex
+				continue;
+			}
+
+			const Vec4 p = closestPointTriangle(a, b, c, verts, vertCount);
+			const F32 distSquared = p.dot(p);
+			if(distSquared < bestDistSquared)
+			{
+				bestDistSquared = distSquared;
+				bestFace = f;
+				closest = p;
+				bestVertCount = vertCount;
+				for(U32 i = 0; i < vertCount; ++i)
+				{
+					bestVerts[i] = faces[f][verts[i]];
+				}
+			}
+		}
+
+		if(bestFace == MAX_U32)
+		{
+			return false;
+		}
+
+		verts = bestVerts;
+		vertCount = bestVertCount;
+	}
+	}
+
+	if(vertCount == 1)
+	{
+		simplex.keep(verts[0]);
+	}
+	else if(vertCount == 2)
+	{
+		simplex.keep(verts[0], verts[1]);
+	}
+	else
+	{
+		simplex.keep(verts[0], verts[1], verts[2]);
+	}
+
 	return true;
 }
 
+F32 gjkDistance(const void* shape0, GjkSupportCallback shape0Callback, const void* shape1,
+	GjkSupportCallback shape1Callback, F32 maxDistance, GjkCacheEntry* cache)
+{
+	ANKI_ASSERT(shape0 && shape0Callback && shape1 && shape1Callback);
+	ANKI_ASSERT(maxDistance >= 0.0f);
+
+	constexpr U32 MAX_ITERATIONS = 32;
+	constexpr F32 TOLERANCE = 1.0e-5f;
+	constexpr F32 INTERSECTION_TOLERANCE = 1.0e-10f;
+
+	GjkContext ctx;
+	ctx.m_shape0 = shape0;
+	ctx.m_shape1 = shape1;
+	ctx.m_shape0Callback = shape0Callback;
+	ctx.m_shape1Callback = shape1Callback;
+
+	// Start from the support point along the previous direction. That point is usually the closest already
+	ctx.m_dir = loadDirection(cache);
+	GjkSupport w;
+	support(ctx, w);
+
+	GjkDistanceSimplex simplex;
+	simplex.m_points[0] = w.m_v;
+	simplex.m_count = 1;
+	Vec4 v = w.m_v;
+
+	const F32 maxDistanceSquared = (maxDistance < sqrt(MAX_F32)) ? maxDistance * maxDistance : MAX_F32;
+	F32 distance = -1.0f;
+	for(U32 iteration = 0; iteration < MAX_ITERATIONS; ++iteration)
+	{
+		const F32 vv = v.dot(v);
+		if(vv <= INTERSECTION_TOLERANCE)
+		{
+			distance = 0.0f;
+			break;
+		}
+
+		ctx.m_dir = -v;
+		support(ctx, w);
+
+		// v.w / |v| is a lower bound of the distance. If it's bigger than the max distance the shapes are separated
+		// enough
+		const F32 vw = v.dot(w.m_v);
+		if(vw > 0.0f && vw * vw > maxDistanceSquared * vv)
+		{
+			distance = vw / sqrt(vv);
+			break;
+		}
+
+		// Converged if w is not closer than v
+		if(vv - vw <= TOLERANCE * vv)
+		{
+			break;
+		}
+
+		simplex.m_points[simplex.m_count++] = w.m_v;
+
+		Vec4 closest;
+		if(!reduceSimplex(simplex, closest))
+		{
+			distance = 0.0f;
+			break;
+		}
+
+		if(closest.dot(closest) >= vv)
+		{
+			// No progress, numerical issues
+			break;
+		}
+
+		v = closest;
+	}
+
+	storeDirection(-v, cache);
+
+	if(distance < 0.0f)
+	{
+		distance = sqrt(v.dot(v));
+	}
+
+	return distance;
+}
+
+void gjkDistances(
+	ConstWeakArray<GjkDistanceQuery> queries, F32 maxDistance, WeakArray<F32> distances, GjkQueryCache* cache)
+{
+	ANKI_ASSERT(distances.getSize() >= queries.getSize());
+
+	for(U32 i = 0; i < queries.getSize(); ++i)
+	{
+		const GjkDistanceQuery& q = queries[i];
+		GjkCacheEntry* entry = (cache) ? &cache->getEntry(q.m_shape0, q.m_shape1) : nullptr;
+		distances[i] = gjkDistance(q.m_shape0, q.m_shape0Callback, q.m_shape1, q.m_shape1Callback, maxDistance, entry);
+	}
+}
+
+GjkCacheEntry& GjkQueryCache::getEntry(const void* shape0, const void* shape1)
+{
+	const Array<PtrSize, 2> pair = {{ptrToNumber(shape0), ptrToNumber(shape1)}};
+	const U64 key = computeHash(&pair[0], sizeof(pair));
+
+	auto it = m_entries.find(key);
+	if(it == m_entries.getEnd())
+	{
+		it = m_entries.emplace(m_alloc, key);
+	}
+
+	it->m_lastFrame = m_frame;
+	return *it;
+}
+
+void GjkQueryCache::endFrame()
+{
+	auto it = m_entries.getBegin();
+	while(it != m_entries.getEnd())
+	{
+		auto next = it;
+		++next;
+
+		if(it->m_lastFrame != m_frame)
+		{
+			m_entries.erase(m_alloc, it);
+		}
+
+		it = next;
+	}
+
+	++m_frame;
+}
+
 } // end namespace anki
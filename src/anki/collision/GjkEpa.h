@@ -7,6 +7,9 @@
 
 #include <anki/collision/Common.h>
 #include <anki/Math.h>
+#include <anki/util/FlatHashMap.h>
+#include <anki/util/WeakArray.h>
+#include <anki/util/NonCopyable.h>
 
 namespace anki
 {
@@ -16,9 +19,81 @@ namespace anki
 
 using GjkSupportCallback = Vec4 (*)(const void* shape, const Vec4& dir);
 
+/// The state of the GJK queries of a pair of shapes that is kept from one query to the next.
+class GjkCacheEntry
+{
+public:
+	/// The last search direction. It points from the Minkowski difference to the origin. If the shapes were separated
+	/// it's the separating axis.
+	Vec4 m_dir = Vec4(1.0f, 0.0f, 0.0f, 0.0f);
+
+	U64 m_lastFrame = 0; ///< The GjkQueryCache frame this entry was last used.
+};
+
+/// Caches the state of the GJK queries per pair of shapes. If the shapes haven't moved much since the last query the
+/// search converges in 1 or 2 iterations when it starts from the previous direction. The pairs are identified by the
+/// addresses of the shapes.
+/// @note A wrong entry (a hash collision or a shape that got replaced) makes the query slower but not wrong.
+class GjkQueryCache : public NonCopyable
+{
+public:
+	GjkQueryCache(GenericMemoryPoolAllocator<U8> alloc)
+		: m_alloc(alloc)
+	{
+	}
+
+	~GjkQueryCache()
+	{
+		m_entries.destroy(m_alloc);
+	}
+
+	/// Get the entry of a pair of shapes. It will create one if it doesn't exist. The order of the shapes matters.
+	GjkCacheEntry& getEntry(const void* shape0, const void* shape1);
+
+	/// Evict the pairs that weren't queried since the previous call. Call it once per frame.
+	void endFrame();
+
+	U32 getEntryCount() const
+	{
+		return m_entries.getSize();
+	}
+
+private:
+	GenericMemoryPoolAllocator<U8> m_alloc;
+	FlatHashMap<U64, GjkCacheEntry> m_entries;
+	U64 m_frame = 1;
+};
+
+/// A query of gjkDistances().
+class GjkDistanceQuery
+{
+public:
+	const void* m_shape0 = nullptr;
+	GjkSupportCallback m_shape0Callback = nullptr;
+	const void* m_shape1 = nullptr;
+	GjkSupportCallback m_shape1Callback = nullptr;
+};
+
 /// Return true if the two convex shapes intersect.
-Bool gjkIntersection(
-	const void* shape0, GjkSupportCallback shape0Callback, const void* shape1, GjkSupportCallback shape1Callback);
+/// @param cache If not nullptr the search starts from the direction stored in the cache and the cache is updated.
+Bool gjkIntersection(const void* shape0, GjkSupportCallback shape0Callback, const void* shape1,
+	GjkSupportCallback shape1Callback, GjkCacheEntry* cache = nullptr);
+
+/// Compute the distance between two convex shapes.
+/// @param maxDistance Stop as soon as it's certain that the distance is bigger than that.
+/// @param cache If not nullptr the search starts from the direction stored in the cache and the cache is updated.
+/// @return The distance or zero if the shapes intersect. If the distance is bigger than maxDistance the return value is
+///         bigger than maxDistance but it might not be the exact distance.
+F32 gjkDistance(const void* shape0, GjkSupportCallback shape0Callback, const void* shape1,
+	GjkSupportCallback shape1Callback, F32 maxDistance = MAX_F32, GjkCacheEntry* cache = nullptr);
+
+/// Run many gjkDistance() queries.
+/// @param queries The pairs of shapes.
+/// @param maxDistance See gjkDistance().
+/// @param[out] distances One per query.
+/// @param cache Optional cache.
+void gjkDistances(ConstWeakArray<GjkDistanceQuery> queries, F32 maxDistance, WeakArray<F32> distances,
+	GjkQueryCache* cache = nullptr);
 /// @}
 
 } // end namespace anki
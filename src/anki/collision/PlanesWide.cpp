@@ -0,0 +1,85 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/collision/PlanesWide.h>
+#include <anki/collision/Aabb.h>
+#include <anki/collision/Sphere.h>
+#include <anki/collision/Obb.h>
+
+namespace anki
+{
+
+PlanesWide::PlanesWide()
+{
+	setPlanes(ConstWeakArray<Plane>());
+}
+
+void PlanesWide::setPlanes(ConstWeakArray<Plane> planes)
+{
+	ANKI_ASSERT(planes.getSize() <= MAX_PLANE_COUNT);
+	m_planeCount = U32(planes.getSize());
+
+	// A zero normal and a negative offset gives a positive distance for every point
+	Array<F32, MAX_PLANE_COUNT> x, y, z, offsets;
+	for(U32 i = 0; i < MAX_PLANE_COUNT; ++i)
+	{
+		if(i < m_planeCount)
+		{
+			const Vec4& n = planes[i].getNormal();
+			x[i] = n.x();
+			y[i] = n.y();
+			z[i] = n.z();
+			offsets[i] = planes[i].getOffset();
+		}
+		else
+		{
+			x[i] = y[i] = z[i] = 0.0f;
+			offsets[i] = -1.0f;
+		}
+	}
+
+	m_normals = Vec3x8::load(&x[0], &y[0], &z[0]);
+	m_offsets = F32x8::load(&offsets[0]);
+}
+
+Bool PlanesWide::insideAll(const Aabb& aabb) const
+{
+	// Test the corner that is the most in front of each plane
+	const F32x8 zero(0.0f);
+	const Vec3x8 aabbMin(aabb.getMin().xyz());
+	const Vec3x8 aabbMax(aabb.getMax().xyz());
+	const Vec3x8 diagMax(F32x8::select(m_normals.m_x >= zero, aabbMax.m_x, aabbMin.m_x),
+		F32x8::select(m_normals.m_y >= zero, aabbMax.m_y, aabbMin.m_y),
+		F32x8::select(m_normals.m_z >= zero, aabbMax.m_z, aabbMin.m_z));
+
+	const F32x8 dist = m_normals.dot(diagMax) - m_offsets;
+	return (dist < zero).getMask() == 0;
+}
+
+Bool PlanesWide::insideAll(const Sphere& sphere) const
+{
+	const Vec3x8 center(sphere.getCenter().xyz());
+	const F32x8 dist = m_normals.dot(center) - m_offsets + F32x8(sphere.getRadius());
+	return (dist < F32x8(0.0f)).getMask() == 0;
+}
+
+Bool PlanesWide::insideAll(const Obb& obb) const
+{
+	// The extent of the box in the direction of the plane normal is the sum of |extent_i * dot(axis_i, normal)|
+	const Mat3x4& rot = obb.getRotation();
+	const Vec4& extend = obb.getExtend();
+	F32x8 r(0.0f);
+	for(U32 i = 0; i < 3; ++i)
+	{
+		const Vec3x8 axis(Vec3(rot(0, i), rot(1, i), rot(2, i)));
+		r = F32x8::mulAdd(m_normals.dot(axis).getAbs(), F32x8(extend[i]), r);
+	}
+
+	const Vec3x8 center(obb.getCenter().xyz());
+	const F32x8 dist = m_normals.dot(center) - m_offsets + r;
+	return (dist < F32x8(0.0f)).getMask() == 0;
+}
+
+} // end namespace anki
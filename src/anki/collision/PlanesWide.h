@@ -0,0 +1,53 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/collision/Plane.h>
+#include <anki/math/VecWide.h>
+#include <anki/util/WeakArray.h>
+
+namespace anki
+{
+
+/// @addtogroup collision
+/// @{
+
+/// A set of up to 8 planes in SoA layout. It tests a shape against all the planes at once and that makes it a good fit
+/// for frustum culling.
+class PlanesWide
+{
+public:
+	static constexpr U32 MAX_PLANE_COUNT = F32x8::LANE_COUNT;
+
+	/// Create an empty set. Every shape is inside it.
+	PlanesWide();
+
+	/// Set the planes. The lanes of the missing planes will be setup to always pass the tests.
+	void setPlanes(ConstWeakArray<Plane> planes);
+
+	U32 getPlaneCount() const
+	{
+		return m_planeCount;
+	}
+
+	/// Return true if the shape is in front of or collides with all the planes. It's the same as calling testPlane() for
+	/// every plane and checking that none of the results is negative.
+	Bool insideAll(const Aabb& aabb) const;
+
+	/// @copydoc insideAll(const Aabb&) const
+	Bool insideAll(const Sphere& sphere) const;
+
+	/// @copydoc insideAll(const Aabb&) const
+	Bool insideAll(const Obb& obb) const;
+
+private:
+	Vec3x8 m_normals;
+	F32x8 m_offsets;
+	U32 m_planeCount = 0;
+};
+/// @}
+
+} // end namespace anki
@@ -0,0 +1,188 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/collision/Ray.h>
+#include <anki/collision/LineSegment.h>
+#include <anki/collision/Aabb.h>
+#include <anki/collision/Sphere.h>
+#include <anki/collision/Obb.h>
+#include <anki/math/VecWide.h>
+#include <anki/util/WeakArray.h>
+
+namespace anki
+{
+
+/// @addtogroup collision
+/// @{
+
+/// A packet of rays or line segments in SoA layout. It tests all of them against a shape at once. Every test returns a
+/// mask with one bit per ray/segment that intersects the shape. Good for line of sight checks.
+template<typename TLane>
+class TRayPacket
+{
+public:
+	using Lane = TLane;
+	using Vec3Wide = TVec3Wide<TLane>;
+
+	static constexpr U32 LANE_COUNT = TLane::LANE_COUNT;
+
+	/// Create an empty packet. Nothing intersects with it.
+	TRayPacket()
+		: m_origin(0.0f)
+		, m_dir(1.0f)
+		, m_invDir(1.0f)
+		, m_maxT(-1.0f)
+	{
+	}
+
+	/// Set rays. They extend to infinity.
+	void setRays(ConstWeakArray<Ray> rays)
+	{
+		ANKI_ASSERT(rays.getSize() <= LANE_COUNT);
+		for(U32 i = 0; i < LANE_COUNT; ++i)
+		{
+			if(i < rays.getSize())
+			{
+				setLane(i, rays[i].getOrigin().xyz(), rays[i].getDirection().xyz(), MAX_F32);
+			}
+			else
+			{
+				setLane(i, Vec3(0.0f), Vec3(1.0f), -1.0f);
+			}
+		}
+
+		m_activeMask = (1u << rays.getSize()) - 1u;
+	}
+
+	/// Set line segments. The segments go from their origin to their origin plus their direction.
+	void setSegments(ConstWeakArray<LineSegment> segments)
+	{
+		ANKI_ASSERT(segments.getSize() <= LANE_COUNT);
+		for(U32 i = 0; i < LANE_COUNT; ++i)
+		{
+			if(i < segments.getSize())
+			{
+				setLane(i, segments[i].getOrigin().xyz(), segments[i].getDirection().xyz(), 1.0f);
+			}
+			else
+			{
+				setLane(i, Vec3(0.0f), Vec3(1.0f), -1.0f);
+			}
+		}
+
+		m_activeMask = (1u << segments.getSize()) - 1u;
+	}
+
+	/// Get a mask with the lanes that hold a ray or segment.
+	U32 getActiveMask() const
+	{
+		return m_activeMask;
+	}
+
+	/// Test against a box.
+	/// @param aabb The box.
+	/// @param mask Test only those rays. The rest will not be set in the result.
+	/// @return A mask of the rays that intersect the box.
+	U32 intersect(const Aabb& aabb, U32 mask = MAX_U32) const
+	{
+		return slabTest(m_origin, m_invDir, Vec3Wide(aabb.getMin().xyz()), Vec3Wide(aabb.getMax().xyz()))
+			   & m_activeMask & mask;
+	}
+
+	/// @copydoc intersect(const Aabb&, U32) const
+	U32 intersect(const Sphere& sphere, U32 mask = MAX_U32) const
+	{
+		const Vec3Wide m = m_origin - Vec3Wide(sphere.getCenter().xyz());
+		const TLane a = m_dir.dot(m_dir);
+		const TLane b = m.dot(m_dir);
+		const TLane c = m.dot(m) - TLane(sphere.getRadius() * sphere.getRadius());
+		const TLane discr = b * b - a * c;
+
+		// Either the origin is inside or the closest intersection is in front of the origin and not further than the
+		// max distance
+		const TLane zero(0.0f);
+		const TLane inside = c <= zero;
+		const TLane tNearTimesA = -b - TLane::max(discr, zero).getSqrt();
+		const TLane hits = (discr >= zero) & (b < zero) & (tNearTimesA <= m_maxT * a);
+		return (inside | hits).getMask() & m_activeMask & mask;
+	}
+
+	/// @copydoc intersect(const Aabb&, U32) const
+	U32 intersect(const Obb& obb, U32 mask = MAX_U32) const
+	{
+		// Move the rays to the space of the box. The columns of the rotation are the axis of the box
+		const Mat3x4& rot = obb.getRotation();
+		const Vec3Wide o = m_origin - Vec3Wide(obb.getCenter().xyz());
+		Vec3Wide localOrigin, localDir;
+		for(U32 i = 0; i < 3; ++i)
+		{
+			const Vec3Wide axis(Vec3(rot(0, i), rot(1, i), rot(2, i)));
+			getComponent(localOrigin, i) = o.dot(axis);
+			getComponent(localDir, i) = m_dir.dot(axis);
+		}
+
+		// Avoid the infinities
+		const TLane tiny(SAFE_INVERSE_MIN);
+		const TLane zero(0.0f);
+		Vec3Wide invDir;
+		for(U32 i = 0; i < 3; ++i)
+		{
+			const TLane d = getComponent(localDir, i);
+			const TLane safeD =
+				TLane::select(d.getAbs() < tiny, TLane::select(d < zero, -tiny, tiny), d);
+			getComponent(invDir, i) = TLane(1.0f) / safeD;
+		}
+
+		const Vec3Wide extend(obb.getExtend().xyz());
+		return slabTest(localOrigin, invDir, -extend, extend) & m_activeMask & mask;
+	}
+
+private:
+	static constexpr F32 SAFE_INVERSE_MIN = 1.0e-20f;
+
+	Vec3Wide m_origin;
+	Vec3Wide m_dir;
+	Vec3Wide m_invDir;
+	TLane m_maxT; ///< MAX_F32 for rays, 1.0 for segments and negative for the unused lanes.
+	U32 m_activeMask = 0;
+
+	void setLane(U32 lane, const Vec3& origin, const Vec3& dir, F32 maxT)
+	{
+		m_origin.setLane(lane, origin);
+		m_dir.setLane(lane, dir);
+		m_invDir.setLane(lane, Vec3(safeInverse(dir.x()), safeInverse(dir.y()), safeInverse(dir.z())));
+		m_maxT.setLane(lane, maxT);
+	}
+
+	static F32 safeInverse(F32 f)
+	{
+		return 1.0f / ((absolute(f) < SAFE_INVERSE_MIN) ? ((f < 0.0f) ? -SAFE_INVERSE_MIN : SAFE_INVERSE_MIN) : f);
+	}
+
+	static TLane& getComponent(Vec3Wide& v, U32 i)
+	{
+		return (i == 0) ? v.m_x : ((i == 1) ? v.m_y : v.m_z);
+	}
+
+	U32 slabTest(const Vec3Wide& origin, const Vec3Wide& invDir, const Vec3Wide& boxMin, const Vec3Wide& boxMax) const
+	{
+		const Vec3Wide t1 = (boxMin - origin) * invDir;
+		const Vec3Wide t2 = (boxMax - origin) * invDir;
+		const Vec3Wide tMin = Vec3Wide::min(t1, t2);
+		const Vec3Wide tMax = Vec3Wide::max(t1, t2);
+
+		const TLane tNear = TLane::max(TLane::max(tMin.m_x, tMin.m_y), TLane::max(tMin.m_z, TLane(0.0f)));
+		const TLane tFar = TLane::min(TLane::min(tMax.m_x, tMax.m_y), TLane::min(tMax.m_z, m_maxT));
+		return (tNear <= tFar).getMask();
+	}
+};
+
+using RayPacket4 = TRayPacket<F32x4>;
+using RayPacket8 = TRayPacket<F32x8>;
+/// @}
+
+} // end namespace anki
@@ -12,7 +12,9 @@
 #include <anki/util/ThreadHive.h>
 #include <anki/util/Tracer.h>
 #include <anki/core/CoreTracer.h>
+#include <anki/core/Benchmark.h>
 #include <anki/core/DeveloperConsole.h>
+#include <anki/core/PerformanceHud.h>
 #include <anki/core/NativeWindow.h>
 #include <anki/input/Input.h>
 #include <anki/scene/SceneGraph.h>
@@ -23,10 +25,14 @@
 #include <anki/script/ScriptManager.h>
 #include <anki/resource/ResourceFilesystem.h>
 #include <anki/resource/AsyncLoader.h>
+#include <anki/resource/TransferGpuAllocator.h>
 #include <anki/core/StagingGpuMemoryManager.h>
 #include <anki/ui/UiManager.h>
 #include <anki/ui/Canvas.h>
 #include <anki/shader_compiler/ShaderProgramCompiler.h>
+#include <anki/shader_compiler/ShaderProgramSpirvCache.h>
+#include <anki/resource/ShaderProgramVariantManifest.h>
+#include <algorithm>
 
 #if ANKI_OS_ANDROID
 #	include <android_native_app_glue.h>
@@ -40,238 +46,55 @@ namespace anki
 android_app* gAndroidApp = nullptr;
 #endif
 
-class App::StatsUi : public UiImmediateModeBuilder
+App::App()
 {
-public:
-	template<typename T>
-	class BufferedValue
-	{
-	public:
-		void set(T x)
-		{
-			m_total += x;
-			++m_count;
-		}
-
-		F64 get(Bool flush)
-		{
-			if(flush)
-			{
-				m_avg = F64(m_total) / m_count;
-				m_count = 0;
-				m_total = 0.0;
-			}
-
-			return m_avg;
-		}
-
-	private:
-		T m_total = T(0);
-		F64 m_avg = 0.0;
-		U32 m_count = 0;
-	};
-
-	BufferedValue<Second> m_frameTime;
-	BufferedValue<Second> m_renderTime;
-	BufferedValue<Second> m_lightBinTime;
-	BufferedValue<Second> m_sceneUpdateTime;
-	BufferedValue<Second> m_visTestsTime;
-	BufferedValue<Second> m_physicsTime;
-	BufferedValue<Second> m_gpuTime;
-
-	PtrSize m_allocatedCpuMem = 0;
-	U64 m_allocCount = 0;
-	U64 m_freeCount = 0;
-
-	U64 m_vkCpuMem = 0;
-	U64 m_vkGpuMem = 0;
-	U32 m_vkCmdbCount = 0;
-
-	PtrSize m_drawableCount = 0;
-
-	static const U32 BUFFERED_FRAMES = 16;
-	U32 m_bufferedFrames = 0;
+}
 
-	StatsUi(UiManager* ui)
-		: UiImmediateModeBuilder(ui)
-	{
-	}
+App::~App()
+{
+	cleanup();
+}
 
-	void build(CanvasPtr canvas) override
+void App::cleanup()
+{
+	if(!m_pipelineManifestFilename.isEmpty())
 	{
-		// Misc
-		++m_bufferedFrames;
-		Bool flush = false;
-		if(m_bufferedFrames == BUFFERED_FRAMES)
-		{
-			flush = true;
-			m_bufferedFrames = 0;
-		}
-
-		// Start drawing the UI
-		canvas->pushFont(canvas->getDefaultFont(), 16);
-
-		const Vec4 oldWindowColor = ImGui::GetStyle().Colors[ImGuiCol_WindowBg];
-		ImGui::GetStyle().Colors[ImGuiCol_WindowBg].w = 0.3f;
-
-		if(ImGui::Begin("Stats", nullptr, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_AlwaysAutoResize))
+		if(m_gr->endPipelineRecording(m_pipelineManifestFilename.toCString()))
 		{
-			ImGui::SetWindowPos(Vec2(5.0f, 5.0f));
-			ImGui::SetWindowSize(Vec2(230.0f, 450.0f));
-
-			ImGui::Text("CPU Time:");
-			labelTime(m_frameTime.get(flush), "Total frame");
-			labelTime(m_renderTime.get(flush) - m_lightBinTime.get(flush), "Renderer");
-			labelTime(m_lightBinTime.get(false), "Light bin");
-			labelTime(m_sceneUpdateTime.get(flush), "Scene update");
-			labelTime(m_visTestsTime.get(flush), "Visibility");
-			labelTime(m_physicsTime.get(flush), "Physics");
-
-			ImGui::Text("----");
-			ImGui::Text("GPU Time:");
-			labelTime(m_gpuTime.get(flush), "Total frame");
-
-			ImGui::Text("----");
-			ImGui::Text("Memory:");
-			labelBytes(m_allocatedCpuMem, "Total CPU");
-			labelUint(m_allocCount, "Total allocations");
-			labelUint(m_freeCount, "Total frees");
-			labelBytes(m_vkCpuMem, "Vulkan CPU");
-			labelBytes(m_vkGpuMem, "Vulkan GPU");
-
-			ImGui::Text("----");
-			ImGui::Text("Vulkan:");
-			labelUint(m_vkCmdbCount, "Cmd buffers");
-
-			ImGui::Text("----");
-			ImGui::Text("Other:");
-			labelUint(m_drawableCount, "Drawbles");
+			ANKI_CORE_LOGE("Failed to store the pipeline manifest. Will ignore");
 		}
 
-		ImGui::End();
-		ImGui::GetStyle().Colors[ImGuiCol_WindowBg] = oldWindowColor;
-
-		canvas->popFont();
+		m_pipelineManifestFilename.destroy(m_heapAlloc);
 	}
 
-	void labelTime(Second val, CString name)
+	// Stop the present thread before anything it uses goes away
+	if(m_pipelinedPresent)
 	{
-		ImGui::Text("%s: %fms", name.cstr(), val * 1000.0);
-	}
+		waitPresent();
 
-	void labelBytes(PtrSize val, CString name)
-	{
-		U gb, mb, kb, b;
-
-		gb = val / 1_GB;
-		val -= gb * 1_GB;
-
-		mb = val / 1_MB;
-		val -= mb * 1_MB;
-
-		kb = val / 1_KB;
-		val -= kb * 1_KB;
-
-		b = val;
-
-		StringAuto timestamp(getAllocator());
-		if(gb)
-		{
-			timestamp.sprintf("%s: %4u,%04u,%04u,%04u", name.cstr(), gb, mb, kb, b);
-		}
-		else if(mb)
 		{
-			timestamp.sprintf("%s: %4u,%04u,%04u", name.cstr(), mb, kb, b);
+			LockGuard<Mutex> lock(m_presentMtx);
+			m_presentQuit = true;
+			m_presentCondVar.notifyAll();
 		}
-		else if(kb)
-		{
-			timestamp.sprintf("%s: %4u,%04u", name.cstr(), kb, b);
-		}
-		else
-		{
-			timestamp.sprintf("%s: %4u", name.cstr(), b);
-		}
-		ImGui::TextUnformatted(timestamp.cstr());
-	}
 
-	void labelUint(U64 val, CString name)
-	{
-		ImGui::Text("%s: %lu", name.cstr(), val);
+		const Error err = m_presentThread.join();
+		(void)err;
+		m_pipelinedPresent = false;
 	}
-};
-
-void* App::MemStats::allocCallback(void* userData, void* ptr, PtrSize size, PtrSize alignment)
-{
-	ANKI_ASSERT(userData);
 
-	static const PtrSize MAX_ALIGNMENT = 64;
-
-	struct alignas(MAX_ALIGNMENT) Header
-	{
-		PtrSize m_allocatedSize;
-		Array<U8, MAX_ALIGNMENT - sizeof(PtrSize)> _m_padding;
-	};
-	static_assert(sizeof(Header) == MAX_ALIGNMENT, "See file");
-	static_assert(alignof(Header) == MAX_ALIGNMENT, "See file");
-
-	void* out = nullptr;
+	m_statsUi.reset(nullptr);
+	m_console.reset(nullptr);
+	m_heapAlloc.deleteInstance(m_benchmark);
+	m_heapAlloc.deleteInstance(m_config);
+	m_benchmark = nullptr;
 
-	if(ptr == nullptr)
-	{
-		// Need to allocate
-		ANKI_ASSERT(size > 0);
-		ANKI_ASSERT(alignment > 0 && alignment <= MAX_ALIGNMENT);
-
-		const PtrSize newAlignment = MAX_ALIGNMENT;
-		const PtrSize newSize = sizeof(Header) + size;
-
-		// Allocate
-		MemStats* self = static_cast<MemStats*>(userData);
-		Header* allocation = static_cast<Header*>(
-			self->m_originalAllocCallback(self->m_originalUserData, nullptr, newSize, newAlignment));
-		allocation->m_allocatedSize = size;
-		++allocation;
-		out = static_cast<void*>(allocation);
-
-		// Update stats
-		self->m_allocatedMem.fetchAdd(size);
-		self->m_allocCount.fetchAdd(1);
-	}
-	else
+	// Stop the physics thread before the scene destroys its physics objects
+	if(m_physics)
 	{
-		// Need to free
-
-		MemStats* self = static_cast<MemStats*>(userData);
-
-		Header* allocation = static_cast<Header*>(ptr);
-		--allocation;
-		ANKI_ASSERT(allocation->m_allocatedSize > 0);
-
-		// Update stats
-		self->m_freeCount.fetchAdd(1);
-		self->m_allocatedMem.fetchSub(allocation->m_allocatedSize);
-
-		// Free
-		self->m_originalAllocCallback(self->m_originalUserData, allocation, 0, 0);
+		m_physics->enableAsyncUpdate(false);
 	}
 
-	return out;
-}
-
-App::App()
-{
-}
-
-App::~App()
-{
-	cleanup();
-}
-
-void App::cleanup()
-{
-	m_statsUi.reset(nullptr);
-	m_console.reset(nullptr);
-
 	m_heapAlloc.deleteInstance(m_scene);
 	m_heapAlloc.deleteInstance(m_script);
 	m_heapAlloc.deleteInstance(m_renderer);
@@ -291,6 +114,9 @@ void App::cleanup()
 
 	m_settingsDir.destroy(m_heapAlloc);
 	m_cacheDir.destroy(m_heapAlloc);
+
+	// Write the pending messages before the app goes away
+	LoggerSingleton::get().enableAsync(false);
 }
 
 Error App::init(const ConfigSet& config, AllocAlignedCallback allocCb, void* allocCbUserData)
@@ -305,12 +131,46 @@ Error App::init(const ConfigSet& config, AllocAlignedCallback allocCb, void* all
 	return err;
 }
 
+Error App::warmupPipelines(CString name)
+{
+	// New content. Fit the staging memory to what the previous content needed
+	if(m_pipelinedPresent)
+	{
+		waitPresent();
+	}
+	m_stagingMem->resizeToHighWaterMarks();
+
+	if(!m_pipelineWarmup)
+	{
+		return Error::NONE;
+	}
+
+	// Store the manifest of the previous content
+	if(!m_pipelineManifestFilename.isEmpty())
+	{
+		ANKI_CHECK(m_gr->endPipelineRecording(m_pipelineManifestFilename.toCString()));
+		m_pipelineManifestFilename.destroy(m_heapAlloc);
+	}
+
+	StringAuto filename(m_heapAlloc);
+	getFilepathFilename(name, filename);
+	m_pipelineManifestFilename.sprintf(m_heapAlloc, "%s/%s.pplines", m_cacheDir.cstr(), filename.cstr());
+
+	// Record before the warmup so the manifest keeps the pipelines of the previous runs
+	m_gr->beginPipelineRecording();
+	ANKI_CHECK(m_gr->warmupPipelines(m_pipelineManifestFilename.toCString(), *m_threadHive));
+
+	return Error::NONE;
+}
+
 Error App::initInternal(const ConfigSet& config_, AllocAlignedCallback allocCb, void* allocCbUserData)
 {
 	ConfigSet config = config_;
-	m_displayStats = config.getNumberU32("core_displayStats");
+	const Bool displayStats = config.getNumberU32("core_displayStats");
+	m_pipelineWarmup = config.getBool("core_pipelineWarmup");
+	LoggerSingleton::get().enableAsync(config.getBool("core_asyncLogging"));
 
-	initMemoryCallbacks(allocCb, allocCbUserData);
+	initMemoryCallbacks(allocCb, allocCbUserData, displayStats || config.getNumberU32("core_benchmarkFrames") > 0);
 	m_heapAlloc = HeapAllocator<U8>(m_allocCb, m_allocCbData);
 
 	ANKI_CHECK(initDirs(config));
@@ -346,7 +206,8 @@ Error App::initInternal(const ConfigSet& config_, AllocAlignedCallback allocCb,
 		__DATE__,
 		ANKI_REVISION);
 
-	m_timerTick = 1.0 / F32(config.getNumberU32("core_targetFps")); // in sec. 1.0 / period
+	applyConfig(config);
+	m_smoothedFrameTime = m_timerTick;
 
 // Check SIMD support
 #if ANKI_SIMD_SSE && ANKI_COMPILER_GCC_COMPATIBLE
@@ -391,17 +252,38 @@ Error App::initInternal(const ConfigSet& config_, AllocAlignedCallback allocCb,
 	//
 	m_threadHive = m_heapAlloc.newInstance<ThreadHive>(config.getNumberU32("core_mainThreadCount"), m_heapAlloc, true);
 
+	//
+	// Physics, resource FS and script. They don't need the GrManager, init them while it initializes
+	//
+	class NonGraphicsInitContext
+	{
+	public:
+		App* m_app;
+		const ConfigSet* m_config;
+	} nonGraphicsCtx{this, &config};
+
+	Thread nonGraphicsInitThread("AppInit");
+	nonGraphicsInitThread.start(&nonGraphicsCtx, [](ThreadCallbackInfo& info) -> Error {
+		NonGraphicsInitContext& ctx = *static_cast<NonGraphicsInitContext*>(info.m_userData);
+		return ctx.m_app->initNonGraphicsSubsystems(*ctx.m_config);
+	});
+
 	//
 	// Graphics API
 	//
 	GrManagerInitInfo grInit;
 	grInit.m_allocCallback = m_allocCb;
-	grInit.m_allocCallbackUserData = m_allocCbData;
+	grInit.m_allocCallbackUserData = getTaggedAllocationCallbackData(MemoryTag::GR);
 	grInit.m_cacheDirectory = m_cacheDir.toCString();
 	grInit.m_config = &config;
 	grInit.m_window = m_window;
 
-	ANKI_CHECK(GrManager::newInstance(grInit, m_gr));
+	const Error grErr = GrManager::newInstance(grInit, m_gr);
+
+	// Join before checking anything, the thread uses the config
+	const Error nonGraphicsErr = nonGraphicsInitThread.join();
+	ANKI_CHECK(grErr);
+	ANKI_CHECK(nonGraphicsErr);
 
 	//
 	// Staging mem
@@ -409,19 +291,6 @@ Error App::initInternal(const ConfigSet& config_, AllocAlignedCallback allocCb,
 	m_stagingMem = m_heapAlloc.newInstance<StagingGpuMemoryManager>();
 	ANKI_CHECK(m_stagingMem->init(m_gr, config));
 
-	//
-	// Physics
-	//
-	m_physics = m_heapAlloc.newInstance<PhysicsWorld>();
-
-	ANKI_CHECK(m_physics->create(m_allocCb, m_allocCbData));
-
-	//
-	// Resource FS
-	//
-	m_resourceFs = m_heapAlloc.newInstance<ResourceFilesystem>(m_heapAlloc);
-	ANKI_CHECK(m_resourceFs->init(config, m_cacheDir.toCString()));
-
 	//
 	// Resources
 	//
@@ -432,17 +301,18 @@ Error App::initInternal(const ConfigSet& config_, AllocAlignedCallback allocCb,
 	rinit.m_config = &config;
 	rinit.m_cacheDir = m_cacheDir.toCString();
 	rinit.m_allocCallback = m_allocCb;
-	rinit.m_allocCallbackData = m_allocCbData;
+	rinit.m_allocCallbackData = getTaggedAllocationCallbackData(MemoryTag::RESOURCE);
 	m_resources = m_heapAlloc.newInstance<ResourceManager>();
 
 	ANKI_CHECK(m_resources->init(rinit));
-	ANKI_CHECK(compileAllShaders());
+	ANKI_CHECK(compileAllShaders(config));
 
 	//
 	// UI
 	//
 	m_ui = m_heapAlloc.newInstance<UiManager>();
-	ANKI_CHECK(m_ui->init(m_allocCb, m_allocCbData, m_resources, m_gr, m_stagingMem, m_input));
+	ANKI_CHECK(m_ui->init(
+		m_allocCb, getTaggedAllocationCallbackData(MemoryTag::UI), m_resources, m_gr, m_stagingMem, m_input));
 
 	//
 	// Renderer
@@ -455,22 +325,29 @@ Error App::initInternal(const ConfigSet& config_, AllocAlignedCallback allocCb,
 
 	m_renderer = m_heapAlloc.newInstance<MainRenderer>();
 
-	ANKI_CHECK(m_renderer->init(
-		m_threadHive, m_resources, m_gr, m_stagingMem, m_ui, m_allocCb, m_allocCbData, config, &m_globalTimestamp));
-
-	//
-	// Script
-	//
-	m_script = m_heapAlloc.newInstance<ScriptManager>();
-	ANKI_CHECK(m_script->init(m_allocCb, m_allocCbData));
+	ANKI_CHECK(m_renderer->init(m_threadHive,
+		m_resources,
+		m_gr,
+		m_stagingMem,
+		m_ui,
+		m_allocCb,
+		getTaggedAllocationCallbackData(MemoryTag::RENDERER),
+		config,
+		&m_globalTimestamp));
 
 	//
 	// Scene
 	//
 	m_scene = m_heapAlloc.newInstance<SceneGraph>();
 
-	ANKI_CHECK(m_scene->init(
-		m_allocCb, m_allocCbData, m_threadHive, m_resources, m_input, m_script, &m_globalTimestamp, config));
+	ANKI_CHECK(m_scene->init(m_allocCb,
+		getTaggedAllocationCallbackData(MemoryTag::SCENE),
+		m_threadHive,
+		m_resources,
+		m_input,
+		m_script,
+		&m_globalTimestamp,
+		config));
 
 	// Inform the script engine about some subsystems
 	m_script->setRenderer(m_renderer);
@@ -479,14 +356,74 @@ Error App::initInternal(const ConfigSet& config_, AllocAlignedCallback allocCb,
 	//
 	// Misc
 	//
-	ANKI_CHECK(m_ui->newInstance<StatsUi>(m_statsUi));
-	ANKI_CHECK(m_ui->newInstance<DeveloperConsole>(m_console, m_allocCb, m_allocCbData, m_script));
+	ANKI_CHECK(m_ui->newInstance<PerformanceHud>(m_statsUi, displayStats));
+	m_script->setPerformanceHud(static_cast<PerformanceHud*>(m_statsUi.get()));
+	ANKI_CHECK(m_ui->newInstance<DeveloperConsole>(
+		m_console, m_allocCb, getTaggedAllocationCallbackData(MemoryTag::UI), m_script));
+
+	//
+	// Benchmark
+	//
+	m_benchmark = m_heapAlloc.newInstance<Benchmark>();
+	ANKI_CHECK(m_benchmark->init(m_heapAlloc, config, m_cacheDir.toCString()));
+
+	//
+	// Present thread
+	//
+	if(config.getBool("core_pipelinedPresent"))
+	{
+		m_presentQuit = false;
+		m_presentThread.start(this, presentThreadCallback);
+		m_pipelinedPresent = true;
+	}
+
+	// Keep the config around for the runtime changes. The copy keeps the versions of the options
+	m_config = m_heapAlloc.newInstance<ConfigSet>(config);
+	m_configVersion = m_config->getVersion();
 
 	ANKI_CORE_LOGI("Application initialized");
 
 	return Error::NONE;
 }
 
+void App::applyConfig(const ConfigSet& config)
+{
+	m_timerTick = 1.0 / F64(config.getNumberU32(ConfigOption::core_targetFps)); // in sec. 1.0 / period
+	m_frameSpinTime = config.getNumberF64(ConfigOption::core_frameSpinTime) / 1000.0;
+	m_frameTimeSmoothing = config.getNumberF64(ConfigOption::core_frameTimeSmoothing);
+	m_scriptGcBudget = config.getNumberF64(ConfigOption::core_scriptGcBudget) / 1000.0;
+}
+
+Error App::initNonGraphicsSubsystems(const ConfigSet& config)
+{
+	//
+	// Physics
+	//
+	m_physics = m_heapAlloc.newInstance<PhysicsWorld>();
+
+	// The async physics can't use the hive since the hive works on the rendering at the same time
+	const Bool asyncPhysics = config.getBool("core_asyncPhysics");
+	ANKI_CHECK(m_physics->create(m_allocCb,
+		getTaggedAllocationCallbackData(MemoryTag::PHYSICS),
+		(config.getBool("core_multithreadedPhysics") && !asyncPhysics) ? m_threadHive : nullptr));
+	m_physics->enableAsyncUpdate(asyncPhysics);
+
+	//
+	// Resource FS
+	//
+	m_resourceFs = m_heapAlloc.newInstance<ResourceFilesystem>(m_heapAlloc);
+	ANKI_CHECK(m_resourceFs->init(config, m_cacheDir.toCString()));
+
+	//
+	// Script
+	//
+	m_script = m_heapAlloc.newInstance<ScriptManager>();
+	ANKI_CHECK(m_script->init(m_allocCb, getTaggedAllocationCallbackData(MemoryTag::SCRIPT)));
+	m_script->setProfiling(config.getNumberU32("core_scriptProfiling"));
+
+	return Error::NONE;
+}
+
 Error App::initDirs(const ConfigSet& cfg)
 {
 #if !ANKI_OS_ANDROID
@@ -554,6 +491,7 @@ Error App::mainLoop()
 
 	Second prevUpdateTime = HighRezTimer::getCurrentTime();
 	Second crntTime = prevUpdateTime;
+	Second frameDeadline = prevUpdateTime;
 
 	while(!quit)
 	{
@@ -562,59 +500,163 @@ Error App::mainLoop()
 			const Second startTime = HighRezTimer::getCurrentTime();
 
 			prevUpdateTime = crntTime;
-			crntTime = HighRezTimer::getCurrentTime();
+			crntTime = startTime;
+			if(m_benchmark->isEnabled())
+			{
+				// Fixed time step for repeatable runs
+				crntTime = prevUpdateTime + m_timerTick;
+			}
+			else if(m_frameTimeSmoothing > 0.0)
+			{
+				// Predict the time step from the previous frames to hide the jitter of the measured time
+				const Second measuredFrameTime = startTime - prevUpdateTime;
+				m_smoothedFrameTime = m_smoothedFrameTime * m_frameTimeSmoothing
+									  + measuredFrameTime * (1.0 - m_frameTimeSmoothing);
+				crntTime = prevUpdateTime + m_smoothedFrameTime;
+
+				// Don't drift away from the real time
+				if(absolute(startTime - crntTime) > m_timerTick)
+				{
+					crntTime = startTime;
+				}
+			}
+
+			// Update. When the present is pipelined the GPU is touched later, after the present of the previous frame
+			if(!m_pipelinedPresent)
+			{
+				m_gr->waitForPreviousFrame();
+			}
 
-			// Update
 			ANKI_CHECK(m_input->handleEvents());
+			ANKI_CHECK(m_resources->updateHotReloading(crntTime));
 
-			// User update
+			// User update. The physics of the previous frame should be done before anyone touches them
+			ANKI_CHECK(m_physics->waitUpdate());
 			ANKI_CHECK(userMainLoop(quit));
 
+			// The benchmark has the last word on the camera
+			if(m_benchmark->isEnabled() || m_benchmark->isRecording())
+			{
+				ANKI_CHECK(m_benchmark->beginFrame(*m_scene));
+			}
+
 			ANKI_CHECK(m_scene->update(prevUpdateTime, crntTime));
 
+			// The scripts of this frame are done, spend some time cleaning after them
+			m_script->stepGarbageCollection(m_scriptGcBudget);
+			m_script->flushProfiling();
+
 			RenderQueue rqueue;
 			m_scene->doVisibilityTests(rqueue);
 
 			// Inject stats UI
-			DynamicArrayAuto<UiQueueElement> newUiElementArr(m_heapAlloc);
+			DynamicArrayInline<UiQueueElement, 8> newUiElementArr(m_heapAlloc);
 			injectUiElements(newUiElementArr, rqueue);
 
 			// Render
+			if(m_pipelinedPresent)
+			{
+				// The present of the previous frame overlapped with the update of this one. It should be done before
+				// the GPU memory of the frame is recycled
+				waitPresent();
+				m_gr->waitForPreviousFrame();
+			}
+
+			// Apply the options that changed since the last frame
+			if(m_config->getVersion() != m_configVersion)
+			{
+				applyConfig(*m_config);
+				ANKI_CHECK(m_renderer->applyConfig(*m_config));
+				m_configVersion = m_config->getVersion();
+			}
+
 			TexturePtr presentableTex = m_gr->acquireNextPresentableTexture();
-			m_renderer->setStatsEnabled(m_displayStats
+			m_renderer->setStatsEnabled(getDisplayStats() || m_benchmark->isEnabled()
 #if ANKI_ENABLE_TRACE
 										|| TracerSingleton::get().getEnabled()
 #endif
 			);
+
+			// Late latch the camera with the input that arrived during the update. Not when benchmarking, the runs
+			// should be repeatable
+			Transform cameraTransform(rqueue.m_cameraTransform);
+			if(!m_benchmark->isEnabled() && userLateLatchCamera(cameraTransform))
+			{
+				rqueue.lateLatchCameraTransform(cameraTransform);
+			}
+
 			ANKI_CHECK(m_renderer->render(rqueue, presentableTex));
 
-			// Pause and sync async loader. That will force all tasks before the pause to finish in this frame.
-			m_resources->getAsyncLoader().pause();
+			// Nothing renders, the streamed textures and meshes can change. The loader keeps running, every resource
+			// publishes its uploads on its own when the GPU is done with them
+			m_resources->updateStreaming();
 
-			m_gr->swapBuffers();
-			m_stagingMem->endFrame();
+			if(m_pipelinedPresent)
+			{
+				kickPresent();
+			}
+			else
+			{
+				presentFrame();
+			}
 
 			// Update the trace info with some async loader stats
 			U64 asyncTaskCount = m_resources->getAsyncLoader().getCompletedTaskCount();
 			ANKI_TRACE_INC_COUNTER(RESOURCE_ASYNC_TASKS, asyncTaskCount - m_resourceCompletedAsyncTaskCount);
 			m_resourceCompletedAsyncTaskCount = asyncTaskCount;
 
-			// Now resume the loader
+			// Let the tasks that wait for the next frame continue
 			m_resources->getAsyncLoader().resume();
 
-			// Sleep
+			// Time spent in low priority tasks
+			ANKI_TRACE_INC_COUNTER(
+				THREAD_HIVE_LOW_PRIORITY_US, U64(m_threadHive->getTaskTime(ThreadHiveTaskPriority::LOW) * 1000000.0));
+
+#if ANKI_ENABLE_TRACE
+			// The live memory of the subsystems
+			if(m_trackMemory)
+			{
+				static const Array<const char*, U32(MemoryTag::COUNT)> counterNames = {{"MEMORY_CORE",
+					"MEMORY_GR",
+					"MEMORY_RESOURCE",
+					"MEMORY_RENDERER",
+					"MEMORY_SCENE",
+					"MEMORY_PHYSICS",
+					"MEMORY_SCRIPT",
+					"MEMORY_UI"}};
+
+				Array<MemoryTagStats, U32(MemoryTag::COUNT)> memStats;
+				m_memTracker.getSnapshot(memStats);
+				for(U32 i = 0; i < U32(MemoryTag::COUNT); ++i)
+				{
+					TracerSingleton::get().incrementCounter(counterNames[i], memStats[i].m_liveBytes);
+				}
+			}
+#endif
+
+			// Sleep. Pace against absolute deadlines so the oversleep of one frame doesn't accumulate
 			const Second endTime = HighRezTimer::getCurrentTime();
 			const Second frameTime = endTime - startTime;
-			if(frameTime < m_timerTick)
+			frameDeadline += m_timerTick;
+			if(m_benchmark->isEnabled())
+			{
+				// Run as fast as possible
+			}
+			else if(endTime < frameDeadline)
 			{
 				ANKI_TRACE_SCOPED_EVENT(TIMER_TICK_SLEEP);
-				HighRezTimer::sleep(m_timerTick - frameTime);
+				HighRezTimer::sleepUntil(frameDeadline, m_frameSpinTime);
+			}
+			else if(endTime - frameDeadline > m_timerTick)
+			{
+				// Fell behind by more than a frame, don't try to catch up
+				frameDeadline = endTime;
 			}
 
 			// Stats
-			if(m_displayStats)
+			if(getDisplayStats())
 			{
-				StatsUi& statsUi = static_cast<StatsUi&>(*m_statsUi);
+				PerformanceHud& statsUi = static_cast<PerformanceHud&>(*m_statsUi);
 				statsUi.m_frameTime.set(frameTime);
 				statsUi.m_renderTime.set(m_renderer->getStats().m_renderingCpuTime);
 				statsUi.m_lightBinTime.set(m_renderer->getStats().m_lightBinTime);
@@ -622,27 +664,75 @@ Error App::mainLoop()
 				statsUi.m_visTestsTime.set(m_scene->getStats().m_visibilityTestsTime);
 				statsUi.m_physicsTime.set(m_scene->getStats().m_physicsUpdate);
 				statsUi.m_gpuTime.set(m_renderer->getStats().m_renderingGpuTime);
-				statsUi.m_allocatedCpuMem = m_memStats.m_allocatedMem.load();
-				statsUi.m_allocCount = m_memStats.m_allocCount.load();
-				statsUi.m_freeCount = m_memStats.m_freeCount.load();
+				statsUi.m_lowPriorityTaskTime.set(m_threadHive->getTaskTime(ThreadHiveTaskPriority::LOW));
+
+				Second hiveTaskTime = 0.0;
+				for(ThreadHiveTaskPriority prio = ThreadHiveTaskPriority(0); prio < ThreadHiveTaskPriority::COUNT; ++prio)
+				{
+					hiveTaskTime += m_threadHive->getTaskTime(prio);
+				}
+				statsUi.m_threadHiveUtilization.set(
+					min(hiveTaskTime / (F64(m_threadHive->getThreadCount()) * max(frameTime, 1.0e-6)), 1.0));
+				statsUi.m_loaderQueueDepth.set(m_resources->getAsyncLoader().getQueuedTaskCount());
+				const MemoryTagStats totalMem = m_memTracker.getTotal();
+				statsUi.m_allocatedCpuMem = totalMem.m_liveBytes;
+				statsUi.m_allocCount = totalMem.m_allocationCount;
+				statsUi.m_freeCount = totalMem.m_freeCount;
+				m_memTracker.getSnapshot(statsUi.m_memoryTags);
 
 				GrManagerStats grStats = m_gr->getStats();
 				statsUi.m_vkCpuMem = grStats.m_cpuMemory;
 				statsUi.m_vkGpuMem = grStats.m_gpuMemory;
+				statsUi.m_vkGpuMemBudget = grStats.m_gpuMemoryBudget;
+				statsUi.m_vkGpuMemUsage = grStats.m_gpuMemoryUsage;
+				statsUi.m_vkFragmentedMem = grStats.m_fragmentedMemory;
+				statsUi.m_vkWastedMem = grStats.m_wastedMemory;
 				statsUi.m_vkCmdbCount = grStats.m_commandBufferCount;
+				statsUi.m_vkCmdPoolResets = grStats.m_commandPoolResets;
+				statsUi.m_vkCmdbMem = grStats.m_commandBufferMemory;
+				statsUi.m_vkDsetCacheHits = grStats.m_descriptorSetCacheHits;
+				statsUi.m_vkDsetWrites = grStats.m_descriptorSetWrites;
 
 				statsUi.m_drawableCount = rqueue.countAllRenderables();
+
+				statsUi.setPasses(m_renderer->getStats().m_passes);
+				statsUi.m_barrierCount = m_renderer->getStats().m_renderGraphBarrierCount;
+
+				for(StagingGpuMemoryType type = StagingGpuMemoryType(0); type < StagingGpuMemoryType::COUNT; ++type)
+				{
+					statsUi.m_stagingMem[U32(type)] = m_stagingMem->getStats(type);
+				}
+			}
+
+			if(m_benchmark->isEnabled())
+			{
+				const GrManagerStats grStats = m_gr->getStats();
+
+				BenchmarkFrameStats benchStats;
+				benchStats.m_cpuTime = frameTime;
+				benchStats.m_gpuTime = m_renderer->getStats().m_renderingGpuTime;
+				benchStats.m_cpuMemory = m_memTracker.getTotal().m_liveBytes;
+				benchStats.m_renderer = &m_renderer->getStats();
+				benchStats.m_gr = &grStats;
+				m_benchmark->endFrame(benchStats);
+
+				if(m_benchmark->isDone())
+				{
+					ANKI_CHECK(m_benchmark->writeReport());
+					quit = true;
+				}
 			}
 
 #if ANKI_ENABLE_TRACE
 			if(m_renderer->getStats().m_renderingGpuTime >= 0.0)
 			{
-				ANKI_TRACE_CUSTOM_EVENT(GPU_TIME,
+				ANKI_TRACE_GPU_EVENT(GPU_TIME,
 					m_renderer->getStats().m_renderingGpuSubmitTimestamp,
 					m_renderer->getStats().m_renderingGpuTime);
 			}
 #endif
 
+			m_threadHive->resetTaskTimes();
 			++m_globalTimestamp;
 		}
 
@@ -652,31 +742,103 @@ Error App::mainLoop()
 #endif
 	}
 
+	if(m_pipelinedPresent)
+	{
+		waitPresent();
+	}
+
+	return Error::NONE;
+}
+
+void App::presentFrame()
+{
+	m_gr->swapBuffers();
+	m_stagingMem->endFrame();
+	m_resources->getTransferGpuAllocator().endFrame();
+}
+
+void App::kickPresent()
+{
+	ANKI_ASSERT(m_pipelinedPresent);
+	LockGuard<Mutex> lock(m_presentMtx);
+	ANKI_ASSERT(!m_presentPending);
+	m_presentPending = true;
+	m_presentCondVar.notifyAll();
+}
+
+void App::waitPresent()
+{
+	ANKI_ASSERT(m_pipelinedPresent);
+	ANKI_TRACE_SCOPED_EVENT(WAIT_PRESENT);
+	LockGuard<Mutex> lock(m_presentMtx);
+	while(m_presentPending)
+	{
+		m_presentCondVar.wait(m_presentMtx);
+	}
+}
+
+Error App::presentThreadCallback(ThreadCallbackInfo& info)
+{
+	App& self = *static_cast<App*>(info.m_userData);
+
+	while(true)
+	{
+		{
+			LockGuard<Mutex> lock(self.m_presentMtx);
+			while(!self.m_presentPending && !self.m_presentQuit)
+			{
+				self.m_presentCondVar.wait(self.m_presentMtx);
+			}
+
+			if(self.m_presentQuit)
+			{
+				break;
+			}
+		}
+
+		self.presentFrame();
+
+		LockGuard<Mutex> lock(self.m_presentMtx);
+		self.m_presentPending = false;
+		self.m_presentCondVar.notifyAll();
+	}
+
 	return Error::NONE;
 }
 
-void App::injectUiElements(DynamicArrayAuto<UiQueueElement>& newUiElementArr, RenderQueue& rqueue)
+void App::setDisplayStats(Bool enable)
+{
+	static_cast<PerformanceHud&>(*m_statsUi).setEnabled(enable);
+}
+
+Bool App::getDisplayStats() const
+{
+	return m_statsUi.isCreated() && static_cast<const PerformanceHud&>(*m_statsUi).getEnabled();
+}
+
+void App::injectUiElements(DynamicArrayInline<UiQueueElement, 8>& newUiElementArr, RenderQueue& rqueue)
 {
 	const U32 originalCount = rqueue.m_uis.getSize();
-	if(m_displayStats || m_consoleEnabled)
+	const Bool displayStats = getDisplayStats();
+	if(displayStats || m_consoleEnabled)
 	{
-		const U32 extraElements = (m_displayStats != 0) + (m_consoleEnabled != 0);
-		newUiElementArr.create(originalCount + extraElements);
+		const U32 extraElements = (displayStats != 0) + (m_consoleEnabled != 0);
+		newUiElementArr.resize(originalCount + extraElements);
 
 		if(originalCount > 0)
 		{
 			memcpy(&newUiElementArr[0], &rqueue.m_uis[0], rqueue.m_uis.getSizeInBytes());
 		}
 
-		rqueue.m_uis = WeakArray<UiQueueElement>(newUiElementArr);
+		rqueue.m_uis = WeakArray<UiQueueElement>(&newUiElementArr[0], newUiElementArr.getSize());
 	}
 
 	U32 count = originalCount;
-	if(m_displayStats)
+	if(displayStats)
 	{
 		newUiElementArr[count].m_userData = m_statsUi.get();
 		newUiElementArr[count].m_drawCallback = [](CanvasPtr& canvas, void* userData) -> void {
-			static_cast<StatsUi*>(userData)->build(canvas);
+			static_cast<PerformanceHud*>(userData)->build(canvas);
 		};
 		++count;
 	}
@@ -691,15 +853,15 @@ void App::injectUiElements(DynamicArrayAuto<UiQueueElement>& newUiElementArr, Re
 	}
 }
 
-void App::initMemoryCallbacks(AllocAlignedCallback allocCb, void* allocCbUserData)
+void App::initMemoryCallbacks(AllocAlignedCallback allocCb, void* allocCbUserData, Bool trackMemory)
 {
-	if(m_displayStats)
+	m_trackMemory = trackMemory;
+	if(trackMemory)
 	{
-		m_memStats.m_originalAllocCallback = allocCb;
-		m_memStats.m_originalUserData = allocCbUserData;
+		m_memTracker.init(allocCb, allocCbUserData);
 
-		m_allocCb = MemStats::allocCallback;
-		m_allocCbData = &m_memStats;
+		m_allocCb = MemoryTagTracker::getAllocationCallback();
+		m_allocCbData = m_memTracker.getAllocationCallbackUserData(MemoryTag::CORE);
 	}
 	else
 	{
@@ -708,7 +870,12 @@ void App::initMemoryCallbacks(AllocAlignedCallback allocCb, void* allocCbUserDat
 	}
 }
 
-Error App::compileAllShaders()
+void* App::getTaggedAllocationCallbackData(MemoryTag tag)
+{
+	return (m_trackMemory) ? m_memTracker.getAllocationCallbackUserData(tag) : m_allocCbData;
+}
+
+Error App::compileAllShaders(const ConfigSet& config)
 {
 	ANKI_TRACE_SCOPED_EVENT(COMPILE_SHADERS);
 	ANKI_CORE_LOGI("Compiling shader programs");
@@ -717,9 +884,23 @@ Error App::compileAllShaders()
 	// Compute hash for both
 	const GpuDeviceCapabilities caps = m_gr->getDeviceCapabilities();
 	const BindlessLimits limits = m_gr->getBindlessLimits();
-	U64 gpuHash = computeHash(&caps, sizeof(caps));
-	gpuHash = appendHash(&limits, sizeof(limits), gpuHash);
-	gpuHash = appendHash(&SHADER_BINARY_VERSION, sizeof(SHADER_BINARY_VERSION), gpuHash);
+	U64 gpuHash = computeHash(HashVersion::MURMUR2, &caps, sizeof(caps));
+	gpuHash = appendHash(HashVersion::MURMUR2, &limits, sizeof(limits), gpuHash);
+	gpuHash = appendHash(HashVersion::MURMUR2, &SHADER_BINARY_VERSION, sizeof(SHADER_BINARY_VERSION), gpuHash);
+
+	// The SPIR-V of the variants doesn't depend on the GPU so a program that changed compiles only its new variants
+	StringAuto spirvCacheDir(m_heapAlloc);
+	if(config.getString("core_shaderSpirvCacheDir").isEmpty())
+	{
+		spirvCacheDir.sprintf("%s/spirv", m_cacheDir.cstr());
+	}
+	else
+	{
+		spirvCacheDir.create(config.getString("core_shaderSpirvCacheDir"));
+	}
+
+	ShaderProgramSpirvFileCache spirvCache(m_heapAlloc);
+	ANKI_CHECK(spirvCache.init(spirvCacheDir.toCString()));
 
 	ANKI_CHECK(m_resourceFs->iterateAllFilenames([&](CString fname) -> Error {
 		// Check file extension
@@ -769,12 +950,15 @@ Error App::compileAllShaders()
 			U64 m_newHash;
 			U64 m_gpuHash;
 			CString m_fname;
+			ConstWeakArray<U64> m_mutations; ///< Sorted. Empty compiles all the mutations.
 
 			Bool skipCompilation(U64 hash)
 			{
 				ANKI_ASSERT(hash != 0);
-				const Array<U64, 2> hashes = {{hash, m_gpuHash}};
-				const U64 finalHash = computeHash(hashes.getBegin(), hashes.getSizeInBytes());
+				const U64 mutationsHash =
+					(m_mutations.getSize()) ? computeHash(&m_mutations[0], m_mutations.getSizeInBytes()) : 0;
+				const Array<U64, 3> hashes = {{hash, m_gpuHash, mutationsHash}};
+				const U64 finalHash = computeHash(HashVersion::MURMUR2, hashes.getBegin(), hashes.getSizeInBytes());
 
 				m_newHash = finalHash;
 				const Bool skip = finalHash == m_metafileHash;
@@ -786,12 +970,26 @@ Error App::compileAllShaders()
 
 				return skip;
 			};
+
+			Bool skipMutation(U64 mutationHash) final
+			{
+				return m_mutations.getSize() > 0
+					   && !std::binary_search(m_mutations.getBegin(), m_mutations.getEnd(), mutationHash);
+			}
 		} skip;
 		skip.m_metafileHash = metafileHash;
 		skip.m_newHash = 0;
 		skip.m_gpuHash = gpuHash;
 		skip.m_fname = fname;
 
+		// Compile only the mutations of the manifest. The rest are compiled on demand
+		DynamicArrayAuto<U64> manifestMutations(m_heapAlloc);
+		if(m_resources->getShaderVariantManifest())
+		{
+			m_resources->getShaderVariantManifest()->getMutations(fname.computeHash(), manifestMutations);
+			skip.m_mutations = ConstWeakArray<U64>(manifestMutations.getBegin(), manifestMutations.getSize());
+		}
+
 		// Threading interface
 		class TaskManager : public ShaderProgramAsyncTaskInterface
 		{
@@ -819,7 +1017,8 @@ Error App::compileAllShaders()
 						auto alloc = ctx->m_alloc;
 						alloc.deleteInstance(ctx);
 					},
-					ctx);
+					ctx,
+					ThreadHiveTaskPriority::LOW);
 			}
 
 			Error joinTasks()
@@ -833,7 +1032,8 @@ Error App::compileAllShaders()
 
 		// Compile
 		ShaderProgramBinaryWrapper binary(m_heapAlloc);
-		ANKI_CHECK(compileShaderProgram(fname, fsystem, &skip, &taskManager, m_heapAlloc, caps, limits, binary));
+		ANKI_CHECK(compileShaderProgram(
+			fname, fsystem, &skip, &taskManager, &spirvCache, m_heapAlloc, caps, limits, binary));
 
 		const Bool cachedBinIsUpToDate = metafileHash == skip.m_newHash;
 		if(!cachedBinIsUpToDate)
@@ -860,7 +1060,10 @@ Error App::compileAllShaders()
 		return Error::NONE;
 	}));
 
-	ANKI_CORE_LOGI("Compiled %u shader programs", shadersCompileCount);
+	ANKI_CORE_LOGI("Compiled %u shader programs. SPIR-V cache hits %u, misses %u",
+		shadersCompileCount,
+		spirvCache.getHitCount(),
+		spirvCache.getMissCount());
 	return Error::NONE;
 }
 
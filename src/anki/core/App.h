@@ -6,9 +6,11 @@
 #pragma once
 
 #include <anki/core/Common.h>
+#include <anki/Math.h>
 #include <anki/util/Allocator.h>
 #include <anki/util/String.h>
 #include <anki/util/Ptr.h>
+#include <anki/util/Thread.h>
 #include <anki/ui/UiImmediateModeBuilder.h>
 #if ANKI_OS_ANDROID
 #	include <android_native_app_glue.h>
@@ -23,6 +25,7 @@ extern android_app* gAndroidApp;
 
 // Forward
 class CoreTracer;
+class Benchmark;
 class ConfigSet;
 class ThreadHive;
 class NativeWindow;
@@ -93,6 +96,11 @@ public:
 		return m_globalTimestamp;
 	}
 
+	/// Create the graphics pipelines that some content used the last time it run and record the ones it uses this time.
+	/// It also resizes the staging GPU memory to what the previous content used. Call it after the content is loaded.
+	/// @param name A unique name of the content, like the name of a level.
+	ANKI_USE_RESULT Error warmupPipelines(CString name);
+
 	/// Run the main loop.
 	ANKI_USE_RESULT Error mainLoop();
 
@@ -103,6 +111,16 @@ public:
 		return Error::NONE;
 	}
 
+	/// Late latch the camera. It's called right before the rendering with the camera transform that the scene was
+	/// updated with. The user code can change it using the input that arrived during the frame, see
+	/// Input::peekLatestMousePosition(). The visibility tests used the old transform so keep the changes small.
+	/// @return True if the transform changed.
+	virtual Bool userLateLatchCamera(Transform& cameraTransform)
+	{
+		// Do nothing
+		return false;
+	}
+
 	Input& getInput()
 	{
 		return *m_input;
@@ -138,14 +156,15 @@ public:
 		return m_heapAlloc;
 	}
 
-	void setDisplayStats(Bool enable)
-	{
-		m_displayStats = enable;
-	}
+	void setDisplayStats(Bool enable);
 
-	Bool getDisplayStats() const
+	Bool getDisplayStats() const;
+
+	/// The config of the running App. The options that change are applied at the beginning of the next render. The
+	/// renderer re-creates only the resources that depend on the changed options.
+	ConfigSet& getConfig()
 	{
-		return m_displayStats;
+		return *m_config;
 	}
 
 	void setDisplayDeveloperConsole(Bool display)
@@ -159,8 +178,6 @@ public:
 	}
 
 private:
-	class StatsUi;
-
 	// Allocation
 	AllocAlignedCallback m_allocCb;
 	void* m_allocCbData;
@@ -170,6 +187,9 @@ private:
 #if ANKI_ENABLE_TRACE
 	CoreTracer* m_coreTracer = nullptr;
 #endif
+	Benchmark* m_benchmark = nullptr;
+	ConfigSet* m_config = nullptr;
+	U64 m_configVersion = 0; ///< The version of m_config that was last applied.
 	NativeWindow* m_window = nullptr;
 	Input* m_input = nullptr;
 	GrManager* m_gr = nullptr;
@@ -183,41 +203,66 @@ private:
 	ScriptManager* m_script = nullptr;
 
 	// Misc
-	UiImmediateModeBuilderPtr m_statsUi;
-	Bool m_displayStats = false;
+	UiImmediateModeBuilderPtr m_statsUi; ///< It's a PerformanceHud.
 	UiImmediateModeBuilderPtr m_console;
 	Bool m_consoleEnabled = false;
 	Timestamp m_globalTimestamp = 1;
 	ThreadHive* m_threadHive = nullptr;
 	String m_settingsDir; ///< The path that holds the configuration
 	String m_cacheDir; ///< This is used as a cache
+	String m_pipelineManifestFilename; ///< The manifest of the content that is recording.
+	Bool m_pipelineWarmup = false;
 	Second m_timerTick;
+	Second m_frameSpinTime = 0.0;
+	F64 m_frameTimeSmoothing = 0.0;
+	Second m_smoothedFrameTime = 0.0; ///< Moving average of the frame time. Predicts the next frame's time step.
+	Second m_scriptGcBudget = 0.0;
+
+	/// @name Pipelined present. The present of a frame runs in its own thread while the next frame updates the scene
+	/// @{
+	Thread m_presentThread{"Present"};
+	Mutex m_presentMtx;
+	ConditionVariable m_presentCondVar; ///< Signals both the new presents and the finished ones.
+	Bool m_pipelinedPresent = false;
+	Bool m_presentPending = false;
+	Bool m_presentQuit = false;
+	/// @}
 	U64 m_resourceCompletedAsyncTaskCount = 0;
 
-	class MemStats
-	{
-	public:
-		Atomic<PtrSize> m_allocatedMem = {0};
-		Atomic<U64> m_allocCount = {0};
-		Atomic<U64> m_freeCount = {0};
-
-		void* m_originalUserData = nullptr;
-		AllocAlignedCallback m_originalAllocCallback = nullptr;
+	MemoryTagTracker m_memTracker;
+	Bool m_trackMemory = false;
 
-		static void* allocCallback(void* userData, void* ptr, PtrSize size, PtrSize alignment);
-	} m_memStats;
+	void initMemoryCallbacks(AllocAlignedCallback allocCb, void* allocCbUserData, Bool trackMemory);
 
-	void initMemoryCallbacks(AllocAlignedCallback allocCb, void* allocCbUserData);
+	/// The allocation callback user data of a subsystem. The memory is attributed to its tag if it's tracked.
+	void* getTaggedAllocationCallbackData(MemoryTag tag);
 
 	ANKI_USE_RESULT Error initInternal(const ConfigSet& config, AllocAlignedCallback allocCb, void* allocCbUserData);
 
 	ANKI_USE_RESULT Error initDirs(const ConfigSet& cfg);
+
+	/// Init the subsystems that don't need the GrManager. It runs in its own thread while the GrManager initializes.
+	ANKI_USE_RESULT Error initNonGraphicsSubsystems(const ConfigSet& config);
 	void cleanup();
 
+	/// Read the options of the App that can change at runtime.
+	void applyConfig(const ConfigSet& config);
+
 	/// Inject a new UI element in the render queue for displaying various stuff.
-	void injectUiElements(DynamicArrayAuto<UiQueueElement>& elements, RenderQueue& rqueue);
+	void injectUiElements(DynamicArrayInline<UiQueueElement, 8>& elements, RenderQueue& rqueue);
+
+	ANKI_USE_RESULT Error compileAllShaders(const ConfigSet& config);
+
+	/// Present the frame and end the frame of the per-frame GPU allocators.
+	void presentFrame();
+
+	/// Hand the presentFrame() to the present thread.
+	void kickPresent();
+
+	/// Wait for the present thread to finish the last presentFrame().
+	void waitPresent();
 
-	ANKI_USE_RESULT Error compileAllShaders();
+	static ANKI_USE_RESULT Error presentThreadCallback(ThreadCallbackInfo& info);
 };
 
 } // end namespace anki
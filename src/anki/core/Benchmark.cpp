@@ -0,0 +1,275 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/core/Benchmark.h>
+#include <anki/core/ConfigSet.h>
+#include <anki/scene/SceneGraph.h>
+#include <anki/scene/components/MoveComponent.h>
+#include <anki/renderer/MainRenderer.h>
+#include <anki/gr/GrManager.h>
+#include <algorithm>
+#include <cstdio>
+
+namespace anki
+{
+
+Benchmark::~Benchmark()
+{
+	m_cameraPath.destroy(m_alloc);
+	m_recordFile.close();
+	m_reportFilename.destroy(m_alloc);
+	m_cpuTimes.destroy(m_alloc);
+	m_gpuTimes.destroy(m_alloc);
+
+	for(PassTimes& pass : m_passes)
+	{
+		pass.m_name.destroy(m_alloc);
+	}
+	m_passes.destroy(m_alloc);
+}
+
+Error Benchmark::init(GenericMemoryPoolAllocator<U8> alloc, const ConfigSet& config, CString cacheDir)
+{
+	m_alloc = alloc;
+	m_frameCount = config.getNumberU32("core_benchmarkFrames");
+	m_warmupFrameCount = config.getNumberU32("core_benchmarkWarmupFrames");
+
+	const CString recordFilename = config.getString("core_benchmarkRecordCameraPath");
+	if(!recordFilename.isEmpty())
+	{
+		ANKI_CHECK(m_recordFile.open(recordFilename, FileOpenFlag::WRITE));
+		ANKI_CORE_LOGI("Recording the camera path to: %s", recordFilename.cstr());
+	}
+
+	if(!isEnabled())
+	{
+		return Error::NONE;
+	}
+
+	const CString pathFilename = config.getString("core_benchmarkCameraPath");
+	if(!pathFilename.isEmpty())
+	{
+		ANKI_CHECK(loadCameraPath(pathFilename));
+	}
+
+	const CString reportFilename = config.getString("core_benchmarkReport");
+	if(!reportFilename.isEmpty())
+	{
+		m_reportFilename.create(m_alloc, reportFilename);
+	}
+	else
+	{
+		m_reportFilename.sprintf(m_alloc, "%s/benchmark.json", cacheDir.cstr());
+	}
+
+	m_cpuTimes.create(m_alloc, m_frameCount);
+	m_gpuTimes.create(m_alloc, m_frameCount);
+
+	ANKI_CORE_LOGI("Benchmarking %u frames after %u warmup frames. Camera path frames %u",
+		m_frameCount,
+		m_warmupFrameCount,
+		m_cameraPath.getSize());
+
+	return Error::NONE;
+}
+
+Error Benchmark::loadCameraPath(CString filename)
+{
+	File file;
+	ANKI_CHECK(file.open(filename, FileOpenFlag::READ));
+	StringAuto txt(m_alloc);
+	ANKI_CHECK(file.readAllText(txt));
+
+	const char* it = txt.cstr();
+	while(*it != '\0')
+	{
+		Vec3 origin;
+		Quat rotation;
+		I32 charsRead = 0;
+		const I32 count = std::sscanf(it,
+			"%f %f %f %f %f %f %f%n",
+			&origin.x(),
+			&origin.y(),
+			&origin.z(),
+			&rotation.x(),
+			&rotation.y(),
+			&rotation.z(),
+			&rotation.w(),
+			&charsRead);
+
+		if(count == EOF)
+		{
+			break;
+		}
+		else if(count != 7)
+		{
+			ANKI_CORE_LOGE("Wrong line %u in camera path: %s", m_cameraPath.getSize() + 1, filename.cstr());
+			return Error::USER_DATA;
+		}
+
+		rotation.normalize();
+		m_cameraPath.emplaceBack(m_alloc, origin.xyz0(), Mat3x4(rotation), 1.0f);
+		it += charsRead;
+	}
+
+	if(m_cameraPath.getSize() == 0)
+	{
+		ANKI_CORE_LOGE("Empty camera path: %s", filename.cstr());
+		return Error::USER_DATA;
+	}
+
+	return Error::NONE;
+}
+
+Error Benchmark::beginFrame(SceneGraph& scene)
+{
+	MoveComponent& mover = scene.getActiveCameraNode().getComponent<MoveComponent>();
+
+	if(isEnabled() && m_cameraPath.getSize() > 0)
+	{
+		mover.setLocalTransform(m_cameraPath[min(m_currentFrame, m_cameraPath.getSize() - 1)]);
+	}
+
+	if(isRecording())
+	{
+		const Transform& trf = mover.getLocalTransform();
+		const Quat rotation(trf.getRotation());
+		ANKI_CHECK(m_recordFile.writeText("%f %f %f %f %f %f %f\n",
+			trf.getOrigin().x(),
+			trf.getOrigin().y(),
+			trf.getOrigin().z(),
+			rotation.x(),
+			rotation.y(),
+			rotation.z(),
+			rotation.w()));
+	}
+
+	return Error::NONE;
+}
+
+void Benchmark::endFrame(const BenchmarkFrameStats& stats)
+{
+	if(!isEnabled() || isDone())
+	{
+		return;
+	}
+
+	const U32 frame = m_currentFrame++;
+	if(frame < m_warmupFrameCount)
+	{
+		return;
+	}
+
+	const U32 idx = frame - m_warmupFrameCount;
+	m_cpuTimes[idx] = stats.m_cpuTime;
+	m_gpuTimes[idx] = stats.m_gpuTime;
+
+	// Passes. They are few, a linear search is fine
+	for(const RenderGraphPassStatistics& inPass : stats.m_renderer->m_passes)
+	{
+		PassTimes* pass = nullptr;
+		for(PassTimes& p : m_passes)
+		{
+			if(p.m_name.toCString() == inPass.m_name)
+			{
+				pass = &p;
+				break;
+			}
+		}
+
+		if(pass == nullptr)
+		{
+			pass = &(*m_passes.emplaceBack(m_alloc));
+			pass->m_name.create(m_alloc, inPass.m_name);
+		}
+
+		pass->m_gpuTime += inPass.m_gpuTime;
+		pass->m_cpuTime += inPass.m_cpuTime;
+		++pass->m_sampleCount;
+	}
+
+	// Memory
+	m_maxCpuMemory = max(m_maxCpuMemory, stats.m_cpuMemory);
+	m_maxGrCpuMemory = max(m_maxGrCpuMemory, stats.m_gr->m_cpuMemory);
+	m_maxGpuMemory = max(m_maxGpuMemory, stats.m_gr->m_gpuMemory);
+	m_maxGpuMemoryUsage = max(m_maxGpuMemoryUsage, stats.m_gr->m_gpuMemoryUsage);
+}
+
+Error Benchmark::writeDistribution(File& file, CString name, DynamicArray<Second>& times)
+{
+	// The GPU times of some frames might be missing, drop them
+	Second* end = std::remove_if(times.getBegin(), times.getEnd(), [](Second t) { return t < 0.0; });
+	const U32 count = U32(end - times.getBegin());
+	std::sort(times.getBegin(), end);
+
+	Second total = 0.0;
+	for(U32 i = 0; i < count; ++i)
+	{
+		total += times[i];
+	}
+
+	// Nearest rank
+	auto percentile = [&](F64 p) -> Second {
+		if(count == 0)
+		{
+			return 0.0;
+		}
+
+		const U32 rank = U32(ceil(p * F64(count)));
+		return times[clamp(rank, 1u, count) - 1];
+	};
+
+	ANKI_CHECK(file.writeText("\t\"%s\": {\"samples\": %u, \"meanMs\": %f, \"p50Ms\": %f, \"p95Ms\": %f, "
+							  "\"p99Ms\": %f, \"maxMs\": %f},\n",
+		name.cstr(),
+		count,
+		(count) ? total / F64(count) * 1000.0 : 0.0,
+		percentile(0.5) * 1000.0,
+		percentile(0.95) * 1000.0,
+		percentile(0.99) * 1000.0,
+		(count) ? times[count - 1] * 1000.0 : 0.0));
+
+	return Error::NONE;
+}
+
+Error Benchmark::writeReport()
+{
+	ANKI_ASSERT(isEnabled());
+
+	File file;
+	ANKI_CHECK(file.open(m_reportFilename.toCString(), FileOpenFlag::WRITE));
+
+	const U32 measuredFrameCount = (m_currentFrame > m_warmupFrameCount) ? m_currentFrame - m_warmupFrameCount : 0;
+	ANKI_CHECK(file.writeText("{\n\t\"frames\": %u,\n", measuredFrameCount));
+
+	m_cpuTimes.resize(m_alloc, measuredFrameCount);
+	m_gpuTimes.resize(m_alloc, measuredFrameCount);
+	ANKI_CHECK(writeDistribution(file, "cpuFrameTime", m_cpuTimes));
+	ANKI_CHECK(writeDistribution(file, "gpuFrameTime", m_gpuTimes));
+
+	ANKI_CHECK(file.writeText("\t\"passes\": [\n"));
+	for(U32 i = 0; i < m_passes.getSize(); ++i)
+	{
+		const PassTimes& pass = m_passes[i];
+		ANKI_CHECK(file.writeText("\t\t{\"name\": \"%s\", \"gpuMs\": %f, \"cpuMs\": %f}%s\n",
+			pass.m_name.cstr(),
+			pass.m_gpuTime / F64(pass.m_sampleCount) * 1000.0,
+			pass.m_cpuTime / F64(pass.m_sampleCount) * 1000.0,
+			(i + 1 < m_passes.getSize()) ? "," : ""));
+	}
+	ANKI_CHECK(file.writeText("\t],\n"));
+
+	ANKI_CHECK(file.writeText(
+		"\t\"memoryHighWater\": {\"cpu\": %zu, \"grCpu\": %zu, \"gpu\": %zu, \"gpuUsage\": %zu}\n}\n",
+		m_maxCpuMemory,
+		m_maxGrCpuMemory,
+		m_maxGpuMemory,
+		m_maxGpuMemoryUsage));
+
+	ANKI_CORE_LOGI("Benchmark report written to: %s", m_reportFilename.cstr());
+	return Error::NONE;
+}
+
+} // end namespace anki
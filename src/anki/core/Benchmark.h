@@ -0,0 +1,117 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/core/Common.h>
+#include <anki/util/DynamicArray.h>
+#include <anki/util/String.h>
+#include <anki/util/File.h>
+#include <anki/Math.h>
+
+namespace anki
+{
+
+// Forward
+class ConfigSet;
+class SceneGraph;
+class MainRendererStats;
+class GrManagerStats;
+
+/// @addtogroup core
+/// @{
+
+/// The measurements of a frame. @memberof Benchmark
+class BenchmarkFrameStats
+{
+public:
+	Second m_cpuTime = 0.0;
+	Second m_gpuTime = -1.0; ///< Negative if the GPU time is not available.
+	PtrSize m_cpuMemory = 0; ///< Of the allocation callbacks of the App.
+	const MainRendererStats* m_renderer = nullptr;
+	const GrManagerStats* m_gr = nullptr;
+};
+
+/// Runs a fixed number of frames along a recorded camera path and writes a JSON report with the frame time
+/// distribution, the per pass timings and the memory high-water marks. It can also record the camera path.
+///
+/// The camera path is a text file with one line per frame. Every line has the origin and the rotation quaternion of
+/// the camera: "x y z qx qy qz qw". The last transform is held if the benchmark runs more frames than the path has.
+class Benchmark
+{
+public:
+	Benchmark() = default;
+
+	Benchmark(const Benchmark&) = delete; // Non-copyable
+
+	~Benchmark();
+
+	Benchmark& operator=(const Benchmark&) = delete; // Non-copyable
+
+	ANKI_USE_RESULT Error init(GenericMemoryPoolAllocator<U8> alloc, const ConfigSet& config, CString cacheDir);
+
+	/// Is it measuring frames?
+	Bool isEnabled() const
+	{
+		return m_frameCount > 0;
+	}
+
+	/// Is it recording the camera?
+	Bool isRecording() const
+	{
+		return m_recordFile.isOpen();
+	}
+
+	/// Returns true if all the frames have been measured.
+	Bool isDone() const
+	{
+		return isEnabled() && m_currentFrame >= m_warmupFrameCount + m_frameCount;
+	}
+
+	/// Replay or record the camera of the frame. Call it after the user code and before the scene update.
+	ANKI_USE_RESULT Error beginFrame(SceneGraph& scene);
+
+	/// Gather the measurements of the frame.
+	void endFrame(const BenchmarkFrameStats& stats);
+
+	/// Write the JSON report.
+	ANKI_USE_RESULT Error writeReport();
+
+private:
+	class PassTimes
+	{
+	public:
+		String m_name;
+		Second m_gpuTime = 0.0;
+		Second m_cpuTime = 0.0;
+		U32 m_sampleCount = 0;
+	};
+
+	GenericMemoryPoolAllocator<U8> m_alloc;
+
+	U32 m_frameCount = 0;
+	U32 m_warmupFrameCount = 0;
+	U32 m_currentFrame = 0;
+
+	DynamicArray<Transform> m_cameraPath;
+	File m_recordFile;
+	String m_reportFilename;
+
+	DynamicArray<Second> m_cpuTimes;
+	DynamicArray<Second> m_gpuTimes;
+	DynamicArray<PassTimes> m_passes;
+
+	PtrSize m_maxCpuMemory = 0;
+	PtrSize m_maxGrCpuMemory = 0;
+	PtrSize m_maxGpuMemory = 0;
+	PtrSize m_maxGpuMemoryUsage = 0;
+
+	ANKI_USE_RESULT Error loadCameraPath(CString filename);
+
+	ANKI_USE_RESULT static Error writeDistribution(File& file, CString name, DynamicArray<Second>& times);
+};
+/// @}
+
+} // end namespace anki
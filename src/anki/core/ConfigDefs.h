@@ -7,11 +7,52 @@ ANKI_CONFIG_OPTION(core_uniformPerFrameMemorySize, 16_MB, 1_MB, 1_GB)
 ANKI_CONFIG_OPTION(core_storagePerFrameMemorySize, 16_MB, 1_MB, 1_GB)
 ANKI_CONFIG_OPTION(core_vertexPerFrameMemorySize, 10_MB, 1_MB, 1_GB)
 ANKI_CONFIG_OPTION(core_textureBufferPerFrameMemorySize, 1_MB, 1_MB, 1_GB)
+ANKI_CONFIG_OPTION(core_stagingOverflowChunkSize,
+	1_MB,
+	64_KB,
+	1_GB,
+	"The size of the chunks that are created when the per frame memory of a type is not enough")
 
 ANKI_CONFIG_OPTION(width, 1280, 16, 16 * 1024, "Width")
 ANKI_CONFIG_OPTION(height, 768, 16, 16 * 1024, "Height")
 ANKI_CONFIG_OPTION(core_targetFps, 60u, 30u, MAX_U32, "Target FPS")
+ANKI_CONFIG_OPTION(core_frameSpinTime,
+	1.5,
+	0.0,
+	100.0,
+	"The last part of the frame limiter's sleep in ms that spins instead of sleeping. Hides the OS timer granularity")
+ANKI_CONFIG_OPTION(core_frameTimeSmoothing,
+	0.0,
+	0.0,
+	0.99,
+	"Smooth the time step of the scene update with a moving average of the frame times. 0 disables it")
 ANKI_CONFIG_OPTION(core_mainThreadCount, max(2u, getCpuCoresCount() / 2u), 2u, 1024u)
+ANKI_CONFIG_OPTION(core_multithreadedPhysics, 1, 0, 1, "Step the physics in the threads of the main thread hive")
+ANKI_CONFIG_OPTION(core_asyncPhysics, 0, 0, 1, "Step the physics in their own thread while the frame renders")
+ANKI_CONFIG_OPTION(
+	core_pipelinedPresent, 0, 0, 1, "Present a frame in its own thread while the next frame updates the scene")
 ANKI_CONFIG_OPTION(core_displayStats, 0, 0, 1)
 ANKI_CONFIG_OPTION(core_clearCaches, 0, 0, 1)
+ANKI_CONFIG_OPTION(core_asyncLogging, 1, 0, 1, "Write the log from a background thread")
+ANKI_CONFIG_OPTION(
+	core_scriptGcBudget, 0.5, 0.0, 1000.0, "The time in ms the LUA garbage collectors can spend every frame")
+ANKI_CONFIG_OPTION(core_scriptProfiling,
+	0u,
+	0u,
+	MAX_U32,
+	"Sample the LUA functions every that many VM instructions and report them to the tracer. 0 disables it")
+ANKI_CONFIG_OPTION(core_pipelineWarmup, 1, 0, 1, "Record the graphics pipelines and create them at load time")
+ANKI_CONFIG_OPTION(core_shaderSpirvCacheDir,
+	"",
+	"Where to cache the SPIR-V of the shader variants. It can be shared. Empty is a dir in the cache dir")
+ANKI_CONFIG_OPTION(core_benchmarkFrames,
+	0u,
+	0u,
+	MAX_U32,
+	"Measure that many frames with a fixed time step and no frame limiter and then quit. 0 disables the benchmark")
+ANKI_CONFIG_OPTION(
+	core_benchmarkWarmupFrames, 60u, 0u, MAX_U32, "The frames to run before the benchmark starts measuring")
+ANKI_CONFIG_OPTION(core_benchmarkCameraPath, "", "A camera path file the benchmark replays. Empty keeps the camera")
+ANKI_CONFIG_OPTION(core_benchmarkReport, "", "Where to write the JSON report. Empty is a file in the cache dir")
+ANKI_CONFIG_OPTION(core_benchmarkRecordCameraPath, "", "Record the camera of every frame to a camera path file")
 ANKI_CONFIG_OPTION(window_fullscreen, 0, 0, 1)
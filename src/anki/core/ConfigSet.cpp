@@ -26,7 +26,8 @@ public:
 		STRING
 	};
 
-	String m_name;
+	StringId m_name;
+	ConfigOption m_handle = ConfigOption::COUNT;
 	String m_helpMsg;
 
 	String m_str;
@@ -39,10 +40,13 @@ public:
 
 	Type m_type = NONE;
 
+	U64 m_version = 0; ///< The version of the ConfigSet when the option last changed.
+
 	Option() = default;
 
 	Option(Option&& b)
-		: m_name(std::move(b.m_name))
+		: m_name(b.m_name)
+		, m_handle(b.m_handle)
 		, m_helpMsg(std::move(b.m_helpMsg))
 		, m_str(std::move(b.m_str))
 		, m_float(b.m_float)
@@ -52,6 +56,7 @@ public:
 		, m_minUnsigned(b.m_minUnsigned)
 		, m_maxUnsigned(b.m_maxUnsigned)
 		, m_type(b.m_type)
+		, m_version(b.m_version)
 	{
 	}
 
@@ -64,7 +69,7 @@ ConfigSet::ConfigSet()
 {
 	m_alloc = HeapAllocator<U8>(allocAligned, nullptr);
 
-#define ANKI_CONFIG_OPTION(name, ...) newOption(ANKI_STRINGIZE(name), __VA_ARGS__);
+#define ANKI_CONFIG_OPTION(name, ...) newOption(ConfigOption::name, ANKI_STRINGIZE(name), __VA_ARGS__);
 #include <anki/core/ConfigDefs.h>
 #include <anki/resource/ConfigDefs.h>
 #include <anki/renderer/ConfigDefs.h>
@@ -77,22 +82,47 @@ ConfigSet::~ConfigSet()
 {
 	for(Option& o : m_options)
 	{
-		o.m_name.destroy(m_alloc);
 		o.m_str.destroy(m_alloc);
 		o.m_helpMsg.destroy(m_alloc);
 	}
 
 	m_options.destroy(m_alloc);
+	m_optionsDict.destroy(m_alloc);
 }
 
 ConfigSet& ConfigSet::operator=(const ConfigSet& b)
 {
+	if(!m_options.isEmpty())
+	{
+		// Copy the values in place. The options that get a different value are marked as changed
+		for(const Option& o : b.m_options)
+		{
+			Option& dst = find(o.m_handle);
+			if(o.m_type == Option::STRING)
+			{
+				setInternal(dst, o.m_str.toCString());
+			}
+			else if(o.m_type == Option::FLOAT)
+			{
+				setInternal(dst, o.m_float);
+			}
+			else
+			{
+				setInternal(dst, o.m_unsigned);
+			}
+		}
+
+		return *this;
+	}
+
 	m_alloc = b.m_alloc; // Not a copy but we are fine
+	m_version = b.m_version;
 
 	for(const Option& o : b.m_options)
 	{
 		Option newO;
-		newO.m_name.create(m_alloc, o.m_name.toCString());
+		newO.m_name = o.m_name;
+		newO.m_handle = o.m_handle;
 		if(o.m_type == Option::STRING)
 		{
 			newO.m_str.create(m_alloc, o.m_str.toCString());
@@ -104,8 +134,9 @@ ConfigSet& ConfigSet::operator=(const ConfigSet& b)
 		newO.m_minUnsigned = o.m_minUnsigned;
 		newO.m_maxUnsigned = o.m_maxUnsigned;
 		newO.m_type = o.m_type;
+		newO.m_version = o.m_version;
 
-		m_options.emplaceBack(m_alloc, std::move(newO));
+		pushBackOption(std::move(newO));
 	}
 
 	return *this;
@@ -113,36 +144,43 @@ ConfigSet& ConfigSet::operator=(const ConfigSet& b)
 
 ConfigSet::Option* ConfigSet::tryFind(CString optionName)
 {
-	for(List<Option>::Iterator it = m_options.getBegin(); it != m_options.getEnd(); ++it)
-	{
-		if((*it).m_name == optionName)
-		{
-			return &(*it);
-		}
-	}
-
-	return nullptr;
+	return const_cast<Option*>(static_cast<const ConfigSet&>(*this).tryFind(optionName));
 }
 
 const ConfigSet::Option* ConfigSet::tryFind(CString optionName) const
 {
-	for(List<Option>::ConstIterator it = m_options.getBegin(); it != m_options.getEnd(); ++it)
+	// All the option names are interned so a name that is not can't be an option
+	const StringId name = StringId::tryFind(optionName);
+	if(name.isEmpty())
 	{
-		if((*it).m_name == optionName)
-		{
-			return &(*it);
-		}
+		return nullptr;
 	}
 
-	return nullptr;
+	auto it = m_optionsDict.find(name);
+	return (it == m_optionsDict.getEnd() || (*it)->m_name != name) ? nullptr : *it;
 }
 
-void ConfigSet::newOption(CString optionName, CString value, CString helpMsg)
+void ConfigSet::pushBackOption(Option&& option)
+{
+	ANKI_ASSERT(!tryFind(option.m_name));
+	ANKI_ASSERT(option.m_handle < ConfigOption::COUNT && !m_optionsByHandle[option.m_handle]);
+	auto it = m_options.emplaceBack(m_alloc, std::move(option));
+	m_optionsDict.emplace(m_alloc, (*it).m_name, &(*it));
+	m_optionsByHandle[(*it).m_handle] = &(*it);
+}
+
+void ConfigSet::markChanged(Option& option)
+{
+	option.m_version = ++m_version;
+}
+
+void ConfigSet::newOption(ConfigOption handle, CString optionName, CString value, CString helpMsg)
 {
 	ANKI_ASSERT(!tryFind(optionName));
 
 	Option o;
-	o.m_name.create(m_alloc, optionName);
+	o.m_name = StringId(optionName);
+	o.m_handle = handle;
 	o.m_str.create(m_alloc, value);
 	o.m_type = Option::STRING;
 	if(!helpMsg.isEmpty())
@@ -150,16 +188,18 @@ void ConfigSet::newOption(CString optionName, CString value, CString helpMsg)
 		o.m_helpMsg.create(m_alloc, helpMsg);
 	}
 
-	m_options.emplaceBack(m_alloc, std::move(o));
+	pushBackOption(std::move(o));
 }
 
-void ConfigSet::newOptionInternal(CString optionName, F64 value, F64 minValue, F64 maxValue, CString helpMsg)
+void ConfigSet::newOptionInternal(
+	ConfigOption handle, CString optionName, F64 value, F64 minValue, F64 maxValue, CString helpMsg)
 {
 	ANKI_ASSERT(!tryFind(optionName));
 	ANKI_ASSERT(value >= minValue && value <= maxValue && minValue <= maxValue);
 
 	Option o;
-	o.m_name.create(m_alloc, optionName);
+	o.m_name = StringId(optionName);
+	o.m_handle = handle;
 	o.m_float = value;
 	o.m_minFloat = minValue;
 	o.m_maxFloat = maxValue;
@@ -169,16 +209,18 @@ void ConfigSet::newOptionInternal(CString optionName, F64 value, F64 minValue, F
 		o.m_helpMsg.create(m_alloc, helpMsg);
 	}
 
-	m_options.emplaceBack(m_alloc, std::move(o));
+	pushBackOption(std::move(o));
 }
 
-void ConfigSet::newOptionInternal(CString optionName, U64 value, U64 minValue, U64 maxValue, CString helpMsg)
+void ConfigSet::newOptionInternal(
+	ConfigOption handle, CString optionName, U64 value, U64 minValue, U64 maxValue, CString helpMsg)
 {
 	ANKI_ASSERT(!tryFind(optionName));
 	ANKI_ASSERT(value >= minValue && value <= maxValue && minValue <= maxValue);
 
 	Option o;
-	o.m_name.create(m_alloc, optionName);
+	o.m_name = StringId(optionName);
+	o.m_handle = handle;
 	o.m_unsigned = value;
 	o.m_minUnsigned = minValue;
 	o.m_maxUnsigned = maxValue;
@@ -188,33 +230,52 @@ void ConfigSet::newOptionInternal(CString optionName, U64 value, U64 minValue, U
 		o.m_helpMsg.create(m_alloc, helpMsg);
 	}
 
-	m_options.emplaceBack(m_alloc, std::move(o));
+	pushBackOption(std::move(o));
 }
 
 void ConfigSet::set(CString optionName, CString value)
 {
-	Option& o = find(optionName);
+	setInternal(find(optionName), value);
+}
+
+void ConfigSet::set(ConfigOption option, CString value)
+{
+	setInternal(find(option), value);
+}
+
+void ConfigSet::setInternal(Option& o, CString value)
+{
 	ANKI_ASSERT(o.m_type == Option::STRING);
-	o.m_str.destroy(m_alloc);
-	o.m_str.create(m_alloc, value);
+	if(o.m_str.toCString() != value)
+	{
+		o.m_str.destroy(m_alloc);
+		o.m_str.create(m_alloc, value);
+		markChanged(o);
+	}
 }
 
-void ConfigSet::setInternal(CString optionName, F64 value)
+void ConfigSet::setInternal(Option& o, F64 value)
 {
-	Option& o = find(optionName);
 	ANKI_ASSERT(o.m_type == Option::FLOAT);
 	ANKI_ASSERT(value >= o.m_minFloat);
 	ANKI_ASSERT(value <= o.m_maxFloat);
-	o.m_float = value;
+	if(o.m_float != value)
+	{
+		o.m_float = value;
+		markChanged(o);
+	}
 }
 
-void ConfigSet::setInternal(CString optionName, U64 value)
+void ConfigSet::setInternal(Option& o, U64 value)
 {
-	Option& o = find(optionName);
 	ANKI_ASSERT(o.m_type == Option::UNSIGNED);
 	ANKI_ASSERT(value >= o.m_minUnsigned);
 	ANKI_ASSERT(value <= o.m_maxUnsigned);
-	o.m_unsigned = value;
+	if(o.m_unsigned != value)
+	{
+		o.m_unsigned = value;
+		markChanged(o);
+	}
 }
 
 F64 ConfigSet::getNumberF64(CString optionName) const
@@ -283,6 +344,91 @@ CString ConfigSet::getString(CString optionName) const
 	return o.m_str.toCString();
 }
 
+F64 ConfigSet::getNumberF64(ConfigOption option) const
+{
+	const Option& o = find(option);
+	ANKI_ASSERT(o.m_type == Option::FLOAT);
+	return o.m_float;
+}
+
+F32 ConfigSet::getNumberF32(ConfigOption option) const
+{
+	return F32(getNumberF64(option));
+}
+
+U64 ConfigSet::getNumberU64(ConfigOption option) const
+{
+	const Option& o = find(option);
+	ANKI_ASSERT(o.m_type == Option::UNSIGNED);
+	return o.m_unsigned;
+}
+
+U32 ConfigSet::getNumberU32(ConfigOption option) const
+{
+	const U64 out = getNumberU64(option);
+	if(out > MAX_U32)
+	{
+		ANKI_CORE_LOGW("Option is out of U32 range: %s", find(option).m_name.cstr());
+	}
+	return U32(out);
+}
+
+Bool ConfigSet::getBool(ConfigOption option) const
+{
+	const U64 val = getNumberU64(option);
+	if((val & ~U64(1)) != 0)
+	{
+		ANKI_CORE_LOGW(
+			"Expecting 0 or 1 for the config option \"%s\". Will mask out extra bits", find(option).m_name.cstr());
+	}
+	return val & 1;
+}
+
+CString ConfigSet::getString(ConfigOption option) const
+{
+	const Option& o = find(option);
+	ANKI_ASSERT(o.m_type == Option::STRING);
+	return o.m_str.toCString();
+}
+
+U64 ConfigSet::getVersion(ConfigOption option) const
+{
+	return find(option).m_version;
+}
+
+Error ConfigSet::setFromString(Option& option, CString value)
+{
+	if(option.m_type == Option::STRING)
+	{
+		setInternal(option, value);
+	}
+	else if(option.m_type == Option::FLOAT)
+	{
+		F64 val;
+		ANKI_CHECK(value.toNumber(val));
+		if(val < option.m_minFloat || val > option.m_maxFloat)
+		{
+			ANKI_CORE_LOGE("Value out of range for option \"%s\": %s", option.m_name.cstr(), value.cstr());
+			return Error::USER_DATA;
+		}
+		setInternal(option, val);
+	}
+	else
+	{
+		ANKI_ASSERT(option.m_type == Option::UNSIGNED);
+		U64 val;
+		ANKI_CHECK(value.toNumber(val));
+		if(val < option.m_minUnsigned || val > option.m_maxUnsigned)
+		{
+			ANKI_CORE_LOGE("Value out of range for option \"%s\": %s", option.m_name.cstr(), value.cstr());
+			return Error::USER_DATA;
+		}
+		setInternal(option, val);
+	}
+
+	return Error::NONE;
+}
+
 Error ConfigSet::loadFromFile(CString filename)
 {
 	ANKI_CORE_LOGI("Loading config file %s", filename.cstr());
@@ -299,34 +445,21 @@ Error ConfigSet::loadFromFile(CString filename)
 
 		if(el)
 		{
-			if(option.m_type == Option::FLOAT)
-			{
-				ANKI_CHECK(el.getNumber(option.m_float));
-			}
-			else if(option.m_type == Option::UNSIGNED)
-			{
-				ANKI_CHECK(el.getNumber(option.m_unsigned));
-			}
-			else
-			{
-				ANKI_ASSERT(option.m_type == Option::STRING);
-				CString txt;
-				ANKI_CHECK(el.getText(txt));
-				option.m_str.destroy(m_alloc);
-				option.m_str.create(m_alloc, txt);
-			}
+			CString txt;
+			ANKI_CHECK(el.getText(txt));
+			ANKI_CHECK(setFromString(option, txt));
 		}
 		else
 		{
 			if(option.m_type == Option::FLOAT)
 			{
 				ANKI_CORE_LOGW(
-					"Missing option for \"%s\". Will use the default value: %f", &option.m_name[0], option.m_float);
+					"Missing option for \"%s\". Will use the default value: %f", option.m_name.cstr(), option.m_float);
 			}
 			else if(option.m_type == Option::UNSIGNED)
 			{
 				ANKI_CORE_LOGW("Missing option for \"%s\". Will use the default value: %" PRIu64,
-					&option.m_name[0],
+					option.m_name.cstr(),
 					option.m_unsigned);
 			}
 			else
@@ -408,22 +541,7 @@ Error ConfigSet::setFromCommandLineArguments(U32 cmdLineArgsCount, char* cmdLine
 			++i;
 			arg = cmdLineArgs[i];
 			ANKI_ASSERT(arg);
-			if(option->m_type == Option::STRING)
-			{
-				option->m_str.destroy(m_alloc);
-				option->m_str.create(m_alloc, arg);
-			}
-			else if(option->m_type == Option::FLOAT)
-			{
-				CString val(arg);
-				ANKI_CHECK(val.toNumber(option->m_float));
-			}
-			else
-			{
-				ANKI_ASSERT(option->m_type == Option::UNSIGNED);
-				CString val(arg);
-				ANKI_CHECK(val.toNumber(option->m_unsigned));
-			}
+			ANKI_CHECK(setFromString(*option, arg));
 		}
 	}
 
@@ -8,6 +8,8 @@
 #include <anki/core/Common.h>
 #include <anki/util/List.h>
 #include <anki/util/String.h>
+#include <anki/util/StringId.h>
+#include <anki/util/HashMap.h>
 
 namespace anki
 {
@@ -15,7 +17,24 @@ namespace anki
 /// @addtogroup core
 /// @{
 
+/// The handles of the config options. The lookups with them are O(1) unlike the lookups with the names.
+enum class ConfigOption : U16
+{
+#define ANKI_CONFIG_OPTION(name, ...) name,
+#include <anki/core/ConfigDefs.h>
+#include <anki/resource/ConfigDefs.h>
+#include <anki/renderer/ConfigDefs.h>
+#include <anki/scene/ConfigDefs.h>
+#include <anki/gr/ConfigDefs.h>
+#undef ANKI_CONFIG_OPTION
+
+	COUNT
+};
+
 /// A storage of configuration variables.
+///
+/// Every change of an option gets a version from an increasing counter of the set. Whoever caches an option can keep
+/// the getVersion() of the time it read it and check hasChangedSince() later to pick up the runtime changes.
 class ConfigSet
 {
 public:
@@ -47,6 +66,20 @@ public:
 	{
 		setInternal(option, F64(value));
 	}
+
+	void set(ConfigOption option, CString value);
+
+	template<typename T, ANKI_ENABLE(std::is_integral<T>::value)>
+	void set(ConfigOption option, T value)
+	{
+		setInternal(find(option), U64(value));
+	}
+
+	template<typename T, ANKI_ENABLE(std::is_floating_point<T>::value)>
+	void set(ConfigOption option, T value)
+	{
+		setInternal(find(option), F64(value));
+	}
 	/// @}
 
 	/// @name Find an option and return its value.
@@ -61,6 +94,35 @@ public:
 	CString getString(CString option) const;
 	/// @}
 
+	/// @name Return the value of an option using its handle.
+	/// @{
+	F64 getNumberF64(ConfigOption option) const;
+	F32 getNumberF32(ConfigOption option) const;
+	U64 getNumberU64(ConfigOption option) const;
+	U32 getNumberU32(ConfigOption option) const;
+	Bool getBool(ConfigOption option) const;
+	CString getString(ConfigOption option) const;
+	/// @}
+
+	/// @name Change tracking
+	/// @{
+
+	/// The version of the latest change of any option.
+	U64 getVersion() const
+	{
+		return m_version;
+	}
+
+	/// The version of the latest change of an option.
+	U64 getVersion(ConfigOption option) const;
+
+	/// Check if an option changed after some version of the set.
+	Bool hasChangedSince(ConfigOption option, U64 version) const
+	{
+		return getVersion(option) > version;
+	}
+	/// @}
+
 	ANKI_USE_RESULT Error loadFromFile(CString filename);
 
 	ANKI_USE_RESULT Error saveToFile(CString filename) const;
@@ -72,6 +134,9 @@ private:
 
 	HeapAllocator<U8> m_alloc;
 	List<Option> m_options;
+	HashMap<StringId, Option*> m_optionsDict;
+	Array<Option*, U32(ConfigOption::COUNT)> m_optionsByHandle = {};
+	U64 m_version = 0;
 
 	Option* tryFind(CString name);
 	const Option* tryFind(CString name) const;
@@ -90,28 +155,61 @@ private:
 		return *o;
 	}
 
-	void setInternal(CString option, F64 value);
-	void setInternal(CString option, U64 value);
+	Option& find(ConfigOption option)
+	{
+		ANKI_ASSERT(option < ConfigOption::COUNT && m_optionsByHandle[option]);
+		return *m_optionsByHandle[option];
+	}
+
+	const Option& find(ConfigOption option) const
+	{
+		ANKI_ASSERT(option < ConfigOption::COUNT && m_optionsByHandle[option]);
+		return *m_optionsByHandle[option];
+	}
+
+	void pushBackOption(Option&& option);
+
+	void setInternal(CString option, F64 value)
+	{
+		setInternal(find(option), value);
+	}
+
+	void setInternal(CString option, U64 value)
+	{
+		setInternal(find(option), value);
+	}
+
+	void setInternal(Option& option, F64 value);
+	void setInternal(Option& option, U64 value);
+	void setInternal(Option& option, CString value);
+
+	/// Parse the value and set it. Used for the values that come from the user.
+	ANKI_USE_RESULT Error setFromString(Option& option, CString value);
+
+	/// Give the option a new version.
+	void markChanged(Option& option);
 
 	/// @name Create new options.
 	/// @{
-	void newOption(CString optionName, CString value, CString helpMsg);
+	void newOption(ConfigOption handle, CString optionName, CString value, CString helpMsg);
 
 	template<typename T, ANKI_ENABLE(std::is_integral<T>::value)>
-	void newOption(CString optionName, T value, T minValue, T maxValue, CString helpMsg = "")
+	void newOption(ConfigOption handle, CString optionName, T value, T minValue, T maxValue, CString helpMsg = "")
 	{
-		newOptionInternal(optionName, U64(value), U64(minValue), U64(maxValue), helpMsg);
+		newOptionInternal(handle, optionName, U64(value), U64(minValue), U64(maxValue), helpMsg);
 	}
 
 	template<typename T, ANKI_ENABLE(std::is_floating_point<T>::value)>
-	void newOption(CString optionName, T value, T minValue, T maxValue, CString helpMsg = "")
+	void newOption(ConfigOption handle, CString optionName, T value, T minValue, T maxValue, CString helpMsg = "")
 	{
-		newOptionInternal(optionName, F64(value), F64(minValue), F64(maxValue), helpMsg);
+		newOptionInternal(handle, optionName, F64(value), F64(minValue), F64(maxValue), helpMsg);
 	}
 	/// @}
 
-	void newOptionInternal(CString optionName, U64 value, U64 minValue, U64 maxValue, CString helpMsg);
-	void newOptionInternal(CString optionName, F64 value, F64 minValue, F64 maxValue, CString helpMsg);
+	void newOptionInternal(
+		ConfigOption handle, CString optionName, U64 value, U64 minValue, U64 maxValue, CString helpMsg);
+	void newOptionInternal(
+		ConfigOption handle, CString optionName, F64 value, F64 minValue, F64 maxValue, CString helpMsg);
 };
 
 /// The default config set. Copy that to your own to override.
@@ -8,6 +8,8 @@
 #include <anki/util/Tracer.h>
 #include <anki/math/Functions.h>
 #include <ctime>
+#include <cstdlib>
+#include <cstring>
 
 namespace anki
 {
@@ -80,6 +82,13 @@ CoreTracer::~CoreTracer()
 		err = m_traceJsonFile.writeText("{}\n]\n");
 	}
 
+	// Write what's left of the binary trace. The thread has written the back chunk already
+	ANKI_ASSERT(!m_backBinaryChunkPending);
+	if(m_traceBinaryFile.isOpen() && m_frontBinaryChunkSize > 0)
+	{
+		err = m_traceBinaryFile.write(&m_binaryChunks[m_frontBinaryChunk][0], m_frontBinaryChunkSize);
+	}
+
 	// Write counter file
 	err = writeCountersForReal();
 
@@ -102,6 +111,12 @@ CoreTracer::~CoreTracer()
 	}
 	m_counterNames.destroy(m_alloc);
 
+	for(DynamicArray<U8>& chunk : m_binaryChunks)
+	{
+		chunk.destroy(m_alloc);
+	}
+	m_binaryStringIds.destroy(m_alloc);
+
 	// Destroy the tracer
 	TracerSingleton::destroy();
 }
@@ -113,6 +128,13 @@ Error CoreTracer::init(GenericMemoryPoolAllocator<U8> alloc, CString directory)
 	TracerSingleton::get().setEnabled(enableTracer);
 	ANKI_CORE_LOGI("Tracing is %s from the beginning", (enableTracer) ? "enabled" : "disabled");
 
+	const char* ringBufferEvents = getenv("ANKI_CORE_TRACER_RING_BUFFER_EVENTS");
+	if(ringBufferEvents && atoi(ringBufferEvents) > 0)
+	{
+		TracerSingleton::get().setRingBufferMode(U32(atoi(ringBufferEvents)));
+		ANKI_CORE_LOGI("Tracer is in ring buffer mode with %u events per thread", U32(atoi(ringBufferEvents)));
+	}
+
 	m_alloc = alloc;
 	m_thread.start(this,
 		[](ThreadCallbackInfo& info) -> Error { return static_cast<CoreTracer*>(info.m_userData)->threadWorker(); });
@@ -128,8 +150,28 @@ Error CoreTracer::init(GenericMemoryPoolAllocator<U8> alloc, CString directory)
 		tm->tm_hour,
 		tm->tm_min);
 
-	ANKI_CHECK(m_traceJsonFile.open(StringAuto(alloc).sprintf("%strace.json", fname.cstr()), FileOpenFlag::WRITE));
-	ANKI_CHECK(m_traceJsonFile.writeText("[\n"));
+	const Bool binary = getenv("ANKI_CORE_TRACER_BINARY") && getenv("ANKI_CORE_TRACER_BINARY")[0] == '1';
+	if(binary)
+	{
+		ANKI_CHECK(m_traceBinaryFile.open(StringAuto(alloc).sprintf("%strace.ankitrace", fname.cstr()),
+			FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+		ANKI_CHECK(m_traceBinaryFile.write(CORE_TRACER_BINARY_MAGIC, strlen(CORE_TRACER_BINARY_MAGIC)));
+
+		for(DynamicArray<U8>& chunk : m_binaryChunks)
+		{
+			chunk.create(m_alloc, BINARY_CHUNK_SIZE);
+		}
+	}
+	else
+	{
+		ANKI_CHECK(m_traceJsonFile.open(StringAuto(alloc).sprintf("%strace.json", fname.cstr()), FileOpenFlag::WRITE));
+		ANKI_CHECK(m_traceJsonFile.writeText("[\n"));
+
+		// Name the track of the GPU events
+		ANKI_CHECK(m_traceJsonFile.writeText("{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %llu, "
+											 "\"args\": {\"name\": \"GPU\"}},\n",
+			TRACER_GPU_THREAD_ID));
+	}
 
 	ANKI_CHECK(m_countersCsvFile.open(StringAuto(alloc).sprintf("%scounters.csv", fname.cstr()), FileOpenFlag::WRITE));
 
@@ -144,18 +186,25 @@ Error CoreTracer::threadWorker()
 	while(!err && !quit)
 	{
 		ThreadWorkItem* item = nullptr;
+		const U8* binaryChunk = nullptr;
+		U32 binaryChunkSize = 0;
 
 		// Get some work
 		{
 			// Wait for something
 			LockGuard<Mutex> lock(m_mtx);
-			while(m_workItems.isEmpty() && !m_quit)
+			while(m_workItems.isEmpty() && !m_backBinaryChunkPending && !m_quit)
 			{
 				m_cvar.wait(m_mtx);
 			}
 
 			// Get some work
-			if(!m_workItems.isEmpty())
+			if(m_backBinaryChunkPending)
+			{
+				binaryChunk = &m_binaryChunks[m_frontBinaryChunk ^ 1][0];
+				binaryChunkSize = m_backBinaryChunkSize;
+			}
+			else if(!m_workItems.isEmpty())
 			{
 				item = m_workItems.popFront();
 			}
@@ -165,6 +214,19 @@ Error CoreTracer::threadWorker()
 			}
 		}
 
+		// Write the binary chunk and let the main thread know that it can reuse it
+		if(binaryChunk)
+		{
+			if(m_traceBinaryFile.write(binaryChunk, binaryChunkSize))
+			{
+				ANKI_CORE_LOGE("Failed to write the binary trace");
+			}
+
+			LockGuard<Mutex> lock(m_mtx);
+			m_backBinaryChunkPending = false;
+			m_binaryCvar.notifyOne();
+		}
+
 		// Do some work using the frame and delete it
 		if(item)
 		{
@@ -195,13 +257,10 @@ Error CoreTracer::writeEvents(ThreadWorkItem& item)
 		const I64 startMicroSec = I64(event.m_start * 1000000.0);
 		const I64 durMicroSec = I64(event.m_duration * 1000000.0);
 
-		// Do a hack
-		const ThreadId tid = (event.m_name == "GPU_TIME") ? 1 : item.m_tid;
-
 		ANKI_CHECK(m_traceJsonFile.writeText("{\"name\": \"%s\", \"cat\": \"PERF\", \"ph\": \"X\", "
 											 "\"pid\": 1, \"tid\": %llu, \"ts\": %lld, \"dur\": %lld},\n",
 			event.m_name.cstr(),
-			tid,
+			item.m_tid,
 			startMicroSec,
 			durMicroSec));
 	}
@@ -299,6 +358,42 @@ void CoreTracer::gatherCounters(ThreadWorkItem& item)
 	}
 }
 
+void CoreTracer::pushWorkItem(
+	U64 frame, ThreadId tid, ConstWeakArray<TracerEvent> events, ConstWeakArray<TracerCounter> counters)
+{
+	// The binary trace doesn't need the worker to encode the events
+	if(m_traceBinaryFile.isOpen())
+	{
+		writeBinaryEvents(tid, events);
+		if(counters.getSize() == 0)
+		{
+			return;
+		}
+
+		events = ConstWeakArray<TracerEvent>();
+	}
+
+	ThreadWorkItem* item = m_alloc.newInstance<ThreadWorkItem>(m_alloc);
+	item->m_tid = tid;
+	item->m_frame = frame;
+
+	if(events.getSize() > 0)
+	{
+		item->m_events.create(events.getSize());
+		memcpy(&item->m_events[0], &events[0], events.getSizeInBytes());
+	}
+
+	if(counters.getSize() > 0)
+	{
+		item->m_counters.create(counters.getSize());
+		memcpy(&item->m_counters[0], &counters[0], counters.getSizeInBytes());
+	}
+
+	LockGuard<Mutex> lock(m_mtx);
+	m_workItems.pushBack(item);
+	m_cvar.notifyOne();
+}
+
 void CoreTracer::flushFrame(U64 frame)
 {
 	struct Ctx
@@ -314,31 +409,98 @@ void CoreTracer::flushFrame(U64 frame)
 	TracerSingleton::get().flush(
 		[](void* ud, ThreadId tid, ConstWeakArray<TracerEvent> events, ConstWeakArray<TracerCounter> counters) {
 			Ctx& ctx = *static_cast<Ctx*>(ud);
-			CoreTracer& self = *ctx.m_self;
+			ctx.m_self->pushWorkItem(ctx.m_frame, tid, events, counters);
+		},
+		&ctx);
 
-			ThreadWorkItem* item = self.m_alloc.newInstance<ThreadWorkItem>(self.m_alloc);
-			item->m_tid = tid;
-			item->m_frame = ctx.m_frame;
+	// Mark the start of the next frame for the ring buffer mode
+	TracerSingleton::get().beginFrame();
+}
 
-			if(events.getSize() > 0)
-			{
-				item->m_events.create(events.getSize());
-				memcpy(&item->m_events[0], &events[0], events.getSizeInBytes());
-			}
+void CoreTracer::flushLastFrames(U64 frame, U32 lastFrameCount)
+{
+	struct Ctx
+	{
+		U64 m_frame;
+		CoreTracer* m_self;
+	};
 
-			if(counters.getSize() > 0)
-			{
-				item->m_counters.create(counters.getSize());
-				memcpy(&item->m_counters[0], &counters[0], counters.getSizeInBytes());
-			}
+	Ctx ctx;
+	ctx.m_frame = frame;
+	ctx.m_self = this;
 
-			LockGuard<Mutex> lock(self.m_mtx);
-			self.m_workItems.pushBack(item);
-			self.m_cvar.notifyOne();
+	TracerSingleton::get().snapshotRingBuffers(lastFrameCount,
+		[](void* ud, ThreadId tid, ConstWeakArray<TracerEvent> events, ConstWeakArray<TracerCounter> counters) {
+			Ctx& ctx = *static_cast<Ctx*>(ud);
+			ctx.m_self->pushWorkItem(ctx.m_frame, tid, events, counters);
 		},
 		&ctx);
 }
 
+void CoreTracer::writeBinaryEvents(ThreadId tid, ConstWeakArray<TracerEvent> events)
+{
+	for(const TracerEvent& event : events)
+	{
+		// Intern the name
+		const CString name = event.m_name;
+		const U64 hash = computeHash(name.cstr(), name.getLength());
+		auto it = m_binaryStringIds.find(hash);
+		if(it == m_binaryStringIds.getEnd())
+		{
+			const CoreTracerBinaryRecordType type = CoreTracerBinaryRecordType::STRING;
+			CoreTracerBinaryString str;
+			str.m_id = m_binaryStringCount++;
+			str.m_length = name.getLength();
+
+			writeBinaryData(&type, sizeof(type));
+			writeBinaryData(&str, sizeof(str));
+			writeBinaryData(name.cstr(), str.m_length);
+
+			it = m_binaryStringIds.emplace(m_alloc, hash, str.m_id);
+		}
+
+		const CoreTracerBinaryRecordType type = CoreTracerBinaryRecordType::EVENT;
+		CoreTracerBinaryEvent outEvent;
+		outEvent.m_tid = tid;
+		outEvent.m_nameId = *it;
+		outEvent.m_startNs = U64(event.m_start * 1000000000.0);
+		outEvent.m_durationNs = U64(event.m_duration * 1000000000.0);
+
+		writeBinaryData(&type, sizeof(type));
+		writeBinaryData(&outEvent, sizeof(outEvent));
+	}
+}
+
+void CoreTracer::writeBinaryData(const void* data, U32 size)
+{
+	ANKI_ASSERT(size <= BINARY_CHUNK_SIZE);
+	if(m_frontBinaryChunkSize + size > BINARY_CHUNK_SIZE)
+	{
+		swapBinaryChunks();
+	}
+
+	memcpy(&m_binaryChunks[m_frontBinaryChunk][m_frontBinaryChunkSize], data, size);
+	m_frontBinaryChunkSize += size;
+}
+
+void CoreTracer::swapBinaryChunks()
+{
+	LockGuard<Mutex> lock(m_mtx);
+
+	// Wait for the thread to write the previous chunk. That shouldn't happen often
+	while(m_backBinaryChunkPending)
+	{
+		m_binaryCvar.wait(m_mtx);
+	}
+
+	m_backBinaryChunkSize = m_frontBinaryChunkSize;
+	m_backBinaryChunkPending = true;
+	m_frontBinaryChunk ^= 1;
+	m_frontBinaryChunkSize = 0;
+
+	m_cvar.notifyOne();
+}
+
 Error CoreTracer::writeCountersForReal()
 {
 	if(!m_countersCsvFile.isOpen() || m_frameCounters.getSize() == 0)
@@ -397,4 +559,117 @@ Error CoreTracer::writeCountersForReal()
 	return Error::NONE;
 }
 
+CoreTracerBinaryReader::~CoreTracerBinaryReader()
+{
+	for(String& str : m_strings)
+	{
+		str.destroy(m_alloc);
+	}
+
+	m_strings.destroy(m_alloc);
+	m_chunk.destroy(m_alloc);
+}
+
+Error CoreTracerBinaryReader::open(CString filename)
+{
+	ANKI_ASSERT(!m_file.isOpen());
+	ANKI_CHECK(m_file.open(filename, FileOpenFlag::READ | FileOpenFlag::BINARY));
+	m_fileRemainingSize = m_file.getSize();
+	m_chunk.create(m_alloc, CHUNK_SIZE);
+
+	const U32 magicLen = U32(strlen(CORE_TRACER_BINARY_MAGIC));
+	Array<char, 8> magic;
+	ANKI_ASSERT(magicLen == sizeof(magic));
+	if(m_fileRemainingSize < magicLen || readBytes(&magic[0], magicLen)
+		|| memcmp(&magic[0], CORE_TRACER_BINARY_MAGIC, magicLen) != 0)
+	{
+		ANKI_CORE_LOGE("Not a binary trace: %s", filename.cstr());
+		return Error::USER_DATA;
+	}
+
+	return Error::NONE;
+}
+
+Error CoreTracerBinaryReader::readEvent(CoreTracerBinaryEvent& event, Bool& done)
+{
+	ANKI_ASSERT(m_file.isOpen());
+
+	while(true)
+	{
+		if(m_chunkOffset == m_chunkSize && m_fileRemainingSize == 0)
+		{
+			done = true;
+			return Error::NONE;
+		}
+
+		CoreTracerBinaryRecordType type;
+		ANKI_CHECK(readBytes(&type, sizeof(type)));
+
+		if(type == CoreTracerBinaryRecordType::STRING)
+		{
+			CoreTracerBinaryString str;
+			ANKI_CHECK(readBytes(&str, sizeof(str)));
+			if(str.m_id != m_strings.getSize() || str.m_length > m_chunkSize - m_chunkOffset + m_fileRemainingSize)
+			{
+				ANKI_CORE_LOGE("Corrupted string in binary trace");
+				return Error::USER_DATA;
+			}
+
+			m_strings.emplaceBack(m_alloc);
+			m_strings.getBack().create(m_alloc, ' ', str.m_length);
+			if(str.m_length > 0)
+			{
+				ANKI_CHECK(readBytes(&m_strings.getBack()[0], str.m_length));
+			}
+		}
+		else if(type == CoreTracerBinaryRecordType::EVENT)
+		{
+			ANKI_CHECK(readBytes(&event, sizeof(event)));
+			if(event.m_nameId >= m_strings.getSize())
+			{
+				ANKI_CORE_LOGE("Event refers to an unknown string");
+				return Error::USER_DATA;
+			}
+
+			done = false;
+			return Error::NONE;
+		}
+		else
+		{
+			ANKI_CORE_LOGE("Unknown record type: %u", U32(type));
+			return Error::USER_DATA;
+		}
+	}
+}
+
+Error CoreTracerBinaryReader::readBytes(void* out, PtrSize size)
+{
+	U8* outBytes = static_cast<U8*>(out);
+	while(size > 0)
+	{
+		if(m_chunkOffset == m_chunkSize)
+		{
+			// Read the next chunk
+			if(m_fileRemainingSize == 0)
+			{
+				ANKI_CORE_LOGE("Truncated binary trace");
+				return Error::USER_DATA;
+			}
+
+			m_chunkSize = U32(min<PtrSize>(PtrSize(CHUNK_SIZE), m_fileRemainingSize));
+			ANKI_CHECK(m_file.read(&m_chunk[0], m_chunkSize));
+			m_fileRemainingSize -= m_chunkSize;
+			m_chunkOffset = 0;
+		}
+
+		const U32 copySize = U32(min<PtrSize>(size, m_chunkSize - m_chunkOffset));
+		memcpy(outBytes, &m_chunk[m_chunkOffset], copySize);
+		m_chunkOffset += copySize;
+		outBytes += copySize;
+		size -= copySize;
+	}
+
+	return Error::NONE;
+}
+
 } // end namespace anki
@@ -10,6 +10,8 @@
 #include <anki/util/Allocator.h>
 #include <anki/util/List.h>
 #include <anki/util/File.h>
+#include <anki/util/Tracer.h>
+#include <anki/util/HashMap.h>
 
 namespace anki
 {
@@ -17,7 +19,83 @@ namespace anki
 /// @addtogroup core
 /// @{
 
+/// The first bytes of the binary trace files. @memberof CoreTracer
+constexpr const char* CORE_TRACER_BINARY_MAGIC = "ANKITRC1";
+
+/// The type of a record of the binary trace files. The records follow the CORE_TRACER_BINARY_MAGIC. All numbers are
+/// in the native (little) endianness. @memberof CoreTracer
+enum class CoreTracerBinaryRecordType : U8
+{
+	STRING, ///< Followed by CoreTracerBinaryString and the characters of the string without the null terminator.
+	EVENT ///< Followed by CoreTracerBinaryEvent.
+};
+
+ANKI_BEGIN_PACKED_STRUCT
+/// A string of the binary trace. The events refer to strings using the string ID. @memberof CoreTracer
+class CoreTracerBinaryString
+{
+public:
+	U32 m_id; ///< IDs start from zero and they increase by one.
+	U32 m_length;
+};
+
+/// An event of the binary trace. @memberof CoreTracer
+class CoreTracerBinaryEvent
+{
+public:
+	ThreadId m_tid;
+	U32 m_nameId;
+	U64 m_startNs;
+	U64 m_durationNs;
+};
+ANKI_END_PACKED_STRUCT
+
+/// Decodes a binary trace file. It reads the file in fixed-size chunks so the memory it needs doesn't depend on the
+/// length of the capture. @memberof CoreTracer
+class CoreTracerBinaryReader : public NonCopyable
+{
+public:
+	CoreTracerBinaryReader(GenericMemoryPoolAllocator<U8> alloc)
+		: m_alloc(alloc)
+	{
+	}
+
+	~CoreTracerBinaryReader();
+
+	ANKI_USE_RESULT Error open(CString filename);
+
+	/// Decode the next event. It also decodes the strings that come before the event.
+	/// @param[out] event The event.
+	/// @param[out] done It's true if there are no more events. The event is not valid then.
+	ANKI_USE_RESULT Error readEvent(CoreTracerBinaryEvent& event, Bool& done);
+
+	/// Get a string that readEvent() has decoded.
+	CString getString(U32 id) const
+	{
+		return m_strings[id].toCString();
+	}
+
+private:
+	static constexpr U32 CHUNK_SIZE = 64 * 1024;
+
+	GenericMemoryPoolAllocator<U8> m_alloc;
+	File m_file;
+	PtrSize m_fileRemainingSize = 0; ///< What hasn't been read from the file yet.
+	DynamicArray<U8> m_chunk;
+	U32 m_chunkSize = 0;
+	U32 m_chunkOffset = 0;
+	DynamicArray<String> m_strings;
+
+	/// Copy from the chunk. It reads the next chunk from the file when the current one ends.
+	ANKI_USE_RESULT Error readBytes(void* out, PtrSize size);
+};
+
 /// A system that sits on top of the tracer and processes the counters and events.
+///
+/// The events are written to a Chrome trace JSON file or to a compact binary file if the ANKI_CORE_TRACER_BINARY
+/// environment variable is 1. In the binary mode the events of a frame are encoded in memory and the strings are
+/// interned. A background thread writes the encoded chunks to the file while the next chunk is being filled. The
+/// tools/trace converts the binary file to JSON.
 class CoreTracer
 {
 public:
@@ -31,6 +109,12 @@ public:
 	/// It will flush everything.
 	void flushFrame(U64 frame);
 
+	/// Write the events of the last frames that are still in the ring buffers of the tracer. Use it in the ring buffer
+	/// mode of the Tracer to capture hitches without recording everything.
+	/// @param frame The current frame.
+	/// @param lastFrameCount How many frames back to go.
+	void flushLastFrames(U64 frame, U32 lastFrameCount);
+
 private:
 	class ThreadWorkItem;
 	class PerFrameCounters;
@@ -49,11 +133,36 @@ private:
 	File m_countersCsvFile;
 	Bool m_quit = false;
 
+	/// @name Binary trace
+	/// @{
+	static constexpr U32 BINARY_CHUNK_SIZE = 1024 * 1024;
+
+	File m_traceBinaryFile;
+	Array<DynamicArray<U8>, 2> m_binaryChunks; ///< Double buffered. One is filled while the other is written.
+	U32 m_frontBinaryChunk = 0; ///< The one that is being filled.
+	U32 m_frontBinaryChunkSize = 0;
+	U32 m_backBinaryChunkSize = 0;
+	Bool m_backBinaryChunkPending = false; ///< The back chunk waits to be written to the file.
+	ConditionVariable m_binaryCvar; ///< Signaled when the back chunk has been written.
+	HashMap<U64, U32> m_binaryStringIds;
+	U32 m_binaryStringCount = 0;
+	/// @}
+
 	Error threadWorker();
 
+	void pushWorkItem(
+		U64 frame, ThreadId tid, ConstWeakArray<TracerEvent> events, ConstWeakArray<TracerCounter> counters);
+
 	Error writeEvents(ThreadWorkItem& item);
 	void gatherCounters(ThreadWorkItem& item);
 	Error writeCountersForReal();
+
+	/// Encode the events to the front binary chunk.
+	void writeBinaryEvents(ThreadId tid, ConstWeakArray<TracerEvent> events);
+	void writeBinaryData(const void* data, U32 size);
+
+	/// Wait until the back chunk has been written and then swap the chunks.
+	void swapBinaryChunks();
 };
 /// @}
 
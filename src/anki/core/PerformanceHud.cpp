@@ -0,0 +1,212 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/core/PerformanceHud.h>
+#include <cfloat>
+
+namespace anki
+{
+
+template<typename T>
+void PerformanceHud::BufferedValue<T>::plot(CString name) const
+{
+	// The oldest value is the next to be written
+	ImGui::PlotLines(
+		"", &m_history[0], HISTORY_SIZE, I32(m_historyIdx), name.cstr(), 0.0f, FLT_MAX, Vec2(210.0f, 30.0f));
+}
+
+PerformanceHud::~PerformanceHud()
+{
+	m_passes.destroy(getAllocator());
+}
+
+void PerformanceHud::setPasses(ConstWeakArray<RenderGraphPassStatistics> passes)
+{
+	m_passes.resize(getAllocator(), passes.getSize());
+	m_commands = CommandBufferStatistics();
+
+	for(U32 i = 0; i < passes.getSize(); ++i)
+	{
+		m_passes[i] = passes[i];
+
+		m_commands.m_drawcallCount += passes[i].m_commands.m_drawcallCount;
+		m_commands.m_dispatchCount += passes[i].m_commands.m_dispatchCount;
+		m_commands.m_primitiveCount += passes[i].m_commands.m_primitiveCount;
+		m_commands.m_barrierCount += passes[i].m_commands.m_barrierCount;
+	}
+
+	m_drawcallCount.set(m_commands.m_drawcallCount);
+}
+
+void PerformanceHud::build(CanvasPtr canvas)
+{
+	// Misc
+	++m_bufferedFrames;
+	Bool flush = false;
+	if(m_bufferedFrames == BUFFERED_FRAMES)
+	{
+		flush = true;
+		m_bufferedFrames = 0;
+	}
+
+	// Start drawing the UI
+	canvas->pushFont(canvas->getDefaultFont(), 16);
+
+	const Vec4 oldWindowColor = ImGui::GetStyle().Colors[ImGuiCol_WindowBg];
+	ImGui::GetStyle().Colors[ImGuiCol_WindowBg].w = 0.3f;
+
+	if(ImGui::Begin("Stats", nullptr, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_AlwaysAutoResize))
+	{
+		ImGui::SetWindowPos(Vec2(5.0f, 5.0f));
+		ImGui::SetWindowSize(Vec2(230.0f, 450.0f));
+
+		ImGui::Text("CPU Time:");
+		labelTime(m_frameTime.get(flush), "Total frame");
+		labelTime(m_renderTime.get(flush) - m_lightBinTime.get(flush), "Renderer");
+		labelTime(m_lightBinTime.get(false), "Light bin");
+		labelTime(m_sceneUpdateTime.get(flush), "Scene update");
+		labelTime(m_visTestsTime.get(flush), "Visibility");
+		labelTime(m_physicsTime.get(flush), "Physics");
+		labelTime(m_lowPriorityTaskTime.get(flush), "Low prio tasks");
+		ImGui::Text("Thread hive utilization: %.1f%%", m_threadHiveUtilization.get(flush) * 100.0);
+		if(m_graphs)
+		{
+			m_frameTime.plot("Frame");
+			m_renderTime.plot("Renderer");
+			m_sceneUpdateTime.plot("Scene update");
+			m_physicsTime.plot("Physics");
+			m_threadHiveUtilization.plot("Hive utilization");
+		}
+
+		ImGui::Text("----");
+		ImGui::Text("GPU Time:");
+		labelTime(m_gpuTime.get(flush), "Total frame");
+		if(m_graphs)
+		{
+			m_gpuTime.plot("GPU frame");
+		}
+
+		if(m_passes.getSize()
+			&& ImGui::TreeNodeEx("Passes (GPU/CPU)", (m_showPasses) ? ImGuiTreeNodeFlags_DefaultOpen : 0))
+		{
+			for(const RenderGraphPassStatistics& pass : m_passes)
+			{
+				ImGui::Text("%s: %fms %fms", pass.m_name.cstr(), pass.m_gpuTime * 1000.0, pass.m_cpuTime * 1000.0);
+			}
+
+			ImGui::TreePop();
+		}
+
+		ImGui::Text("----");
+		ImGui::Text("Memory:");
+		labelBytes(m_allocatedCpuMem, "Total CPU");
+		labelUint(m_allocCount, "Total allocations");
+		labelUint(m_freeCount, "Total frees");
+		if(m_allocCount && ImGui::TreeNode("Per subsystem"))
+		{
+			for(U32 i = 0; i < U32(MemoryTag::COUNT); ++i)
+			{
+				labelBytes(m_memoryTags[i].m_liveBytes, MemoryTagTracker::getTagName(MemoryTag(i)));
+				labelBytes(m_memoryTags[i].m_peakBytes, "  peak");
+			}
+
+			ImGui::TreePop();
+		}
+		labelBytes(m_vkCpuMem, "Vulkan CPU");
+		labelBytes(m_vkGpuMem, "Vulkan GPU");
+		labelBytes(m_vkGpuMemUsage, "Vulkan GPU usage");
+		labelBytes(m_vkGpuMemBudget, "Vulkan GPU budget");
+		labelBytes(m_vkFragmentedMem, "Vulkan fragmented");
+		labelBytes(m_vkWastedMem, "Vulkan wasted");
+
+		static const Array<const char*, U32(StagingGpuMemoryType::COUNT)> stagingNames = {
+			{"Staging uniform", "Staging storage", "Staging vertex", "Staging texture"}};
+		for(U32 i = 0; i < U32(StagingGpuMemoryType::COUNT); ++i)
+		{
+			labelBytes(m_stagingMem[i].m_highWaterMark, stagingNames[i]);
+			if(m_stagingMem[i].m_overflowSize)
+			{
+				labelBytes(m_stagingMem[i].m_overflowSize, "  overflow");
+			}
+		}
+
+		ImGui::Text("----");
+		ImGui::Text("Vulkan:");
+		labelUint(m_vkCmdbCount, "Cmd buffers");
+		labelUint(m_vkCmdPoolResets, "Cmd pool resets");
+		labelBytes(m_vkCmdbMem, "Cmd buffer CPU");
+		labelUint(m_commands.m_drawcallCount, "Drawcalls");
+		labelUint(m_commands.m_dispatchCount, "Dispatches");
+		labelUint(m_commands.m_primitiveCount, "Primitives");
+		labelUint(m_barrierCount + m_commands.m_barrierCount, "Barriers");
+		labelUint(m_vkDsetCacheHits, "DS cache hits");
+		labelUint(m_vkDsetWrites, "DS writes");
+		if(m_graphs)
+		{
+			m_drawcallCount.plot("Drawcalls");
+		}
+
+		ImGui::Text("----");
+		ImGui::Text("Other:");
+		labelUint(m_drawableCount, "Drawbles");
+		labelUint(U64(m_loaderQueueDepth.get(flush)), "Loader queue");
+		if(m_graphs)
+		{
+			m_loaderQueueDepth.plot("Loader queue");
+		}
+	}
+
+	ImGui::End();
+	ImGui::GetStyle().Colors[ImGuiCol_WindowBg] = oldWindowColor;
+
+	canvas->popFont();
+}
+
+void PerformanceHud::labelTime(Second val, CString name)
+{
+	ImGui::Text("%s: %fms", name.cstr(), val * 1000.0);
+}
+
+void PerformanceHud::labelBytes(PtrSize val, CString name)
+{
+	U gb, mb, kb, b;
+
+	gb = val / 1_GB;
+	val -= gb * 1_GB;
+
+	mb = val / 1_MB;
+	val -= mb * 1_MB;
+
+	kb = val / 1_KB;
+	val -= kb * 1_KB;
+
+	b = val;
+
+	StringAuto timestamp(getAllocator());
+	if(gb)
+	{
+		timestamp.sprintf("%s: %4u,%04u,%04u,%04u", name.cstr(), gb, mb, kb, b);
+	}
+	else if(mb)
+	{
+		timestamp.sprintf("%s: %4u,%04u,%04u", name.cstr(), mb, kb, b);
+	}
+	else if(kb)
+	{
+		timestamp.sprintf("%s: %4u,%04u", name.cstr(), kb, b);
+	}
+	else
+	{
+		timestamp.sprintf("%s: %4u", name.cstr(), b);
+	}
+	ImGui::TextUnformatted(timestamp.cstr());
+}
+
+void PerformanceHud::labelUint(U64 val, CString name)
+{
+	ImGui::Text("%s: %lu", name.cstr(), val);
+}
+
+} // end namespace anki
@@ -0,0 +1,169 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/Ui.h>
+#include <anki/core/Common.h>
+#include <anki/core/StagingGpuMemoryManager.h>
+#include <anki/gr/Sampler.h>
+#include <anki/gr/RenderGraph.h>
+
+namespace anki
+{
+
+/// @addtogroup core
+/// @{
+
+/// A live performance HUD. The App feeds it every frame. It shows the CPU and GPU timings with rolling graphs, the
+/// utilization of the thread hive, the depth of the loader queue and the memory per class. The scripts can control it
+/// with getPerformanceHud().
+class PerformanceHud : public UiImmediateModeBuilder
+{
+public:
+	/// A value that is averaged over some frames. It also keeps the last frames for the graphs.
+	template<typename T>
+	class BufferedValue
+	{
+	public:
+		static constexpr U32 HISTORY_SIZE = 128;
+
+		void set(T x)
+		{
+			m_total += x;
+			++m_count;
+
+			m_history[m_historyIdx] = F32(x);
+			m_historyIdx = (m_historyIdx + 1) % HISTORY_SIZE;
+		}
+
+		F64 get(Bool flush)
+		{
+			if(flush)
+			{
+				m_avg = F64(m_total) / m_count;
+				m_count = 0;
+				m_total = T(0);
+			}
+
+			return m_avg;
+		}
+
+		/// Draw the history of the values.
+		void plot(CString name) const;
+
+	private:
+		T m_total = T(0);
+		F64 m_avg = 0.0;
+		U32 m_count = 0;
+		Array<F32, HISTORY_SIZE> m_history = {};
+		U32 m_historyIdx = 0;
+	};
+
+	/// @name The values of the frames
+	/// @{
+	BufferedValue<Second> m_frameTime;
+	BufferedValue<Second> m_renderTime;
+	BufferedValue<Second> m_lightBinTime;
+	BufferedValue<Second> m_sceneUpdateTime;
+	BufferedValue<Second> m_visTestsTime;
+	BufferedValue<Second> m_physicsTime;
+	BufferedValue<Second> m_gpuTime;
+	BufferedValue<Second> m_lowPriorityTaskTime;
+	BufferedValue<F64> m_threadHiveUtilization; ///< From 0 to 1.
+	BufferedValue<U32> m_loaderQueueDepth;
+	BufferedValue<U32> m_drawcallCount;
+
+	PtrSize m_allocatedCpuMem = 0;
+	U64 m_allocCount = 0;
+	U64 m_freeCount = 0;
+	Array<MemoryTagStats, U32(MemoryTag::COUNT)> m_memoryTags;
+
+	U64 m_vkCpuMem = 0;
+	U64 m_vkGpuMem = 0;
+	U64 m_vkGpuMemBudget = 0;
+	U64 m_vkGpuMemUsage = 0;
+	U64 m_vkFragmentedMem = 0;
+	U64 m_vkWastedMem = 0;
+	U32 m_vkCmdbCount = 0;
+	U32 m_vkCmdPoolResets = 0;
+	U64 m_vkCmdbMem = 0;
+	U32 m_vkDsetCacheHits = 0;
+	U32 m_vkDsetWrites = 0;
+
+	Array<StagingGpuMemoryStats, U32(StagingGpuMemoryType::COUNT)> m_stagingMem;
+
+	PtrSize m_drawableCount = 0;
+
+	DynamicArray<RenderGraphPassStatistics> m_passes;
+	CommandBufferStatistics m_commands; ///< Of all the passes.
+	U32 m_barrierCount = 0;
+	/// @}
+
+	PerformanceHud(UiManager* ui)
+		: UiImmediateModeBuilder(ui)
+	{
+	}
+
+	~PerformanceHud();
+
+	ANKI_USE_RESULT Error init(Bool enabled)
+	{
+		m_enabled = enabled;
+		return Error::NONE;
+	}
+
+	void build(CanvasPtr canvas) override;
+
+	void setPasses(ConstWeakArray<RenderGraphPassStatistics> passes);
+
+	/// @name Scriptable
+	/// @{
+	void setEnabled(Bool enable)
+	{
+		m_enabled = enable;
+	}
+
+	Bool getEnabled() const
+	{
+		return m_enabled;
+	}
+
+	void setGraphsEnabled(Bool enable)
+	{
+		m_graphs = enable;
+	}
+
+	Bool getGraphsEnabled() const
+	{
+		return m_graphs;
+	}
+
+	void setPassesEnabled(Bool enable)
+	{
+		m_showPasses = enable;
+	}
+
+	Bool getPassesEnabled() const
+	{
+		return m_showPasses;
+	}
+	/// @}
+
+private:
+	static const U32 BUFFERED_FRAMES = 16;
+	U32 m_bufferedFrames = 0;
+
+	Bool m_enabled = false;
+	Bool m_graphs = true;
+	Bool m_showPasses = false;
+
+	void labelTime(Second val, CString name);
+	void labelBytes(PtrSize val, CString name);
+	void labelUint(U64 val, CString name);
+};
+/// @}
+
+} // end namespace anki
@@ -15,10 +15,9 @@ StagingGpuMemoryManager::~StagingGpuMemoryManager()
 {
 	m_gr->finish();
 
-	for(auto& it : m_perFrameBuffers)
+	for(StagingGpuMemoryType type = StagingGpuMemoryType::UNIFORM; type < StagingGpuMemoryType::COUNT; ++type)
 	{
-		it.m_buff->unmap();
-		it.m_buff = {};
+		destroyBuffer(type);
 	}
 }
 
@@ -30,6 +29,7 @@ Error StagingGpuMemoryManager::init(GrManager* gr, const ConfigSet& cfg)
 	m_perFrameBuffers[StagingGpuMemoryType::STORAGE].m_size = cfg.getNumberU32("core_storagePerFrameMemorySize");
 	m_perFrameBuffers[StagingGpuMemoryType::VERTEX].m_size = cfg.getNumberU32("core_vertexPerFrameMemorySize");
 	m_perFrameBuffers[StagingGpuMemoryType::TEXTURE].m_size = cfg.getNumberU32("core_textureBufferPerFrameMemorySize");
+	m_overflowChunkSize = cfg.getNumberU32("core_stagingOverflowChunkSize");
 
 	initBuffer(StagingGpuMemoryType::UNIFORM,
 		gr->getDeviceCapabilities().m_uniformBufferBindOffsetAlignment,
@@ -58,26 +58,53 @@ void StagingGpuMemoryManager::initBuffer(
 	StagingGpuMemoryType type, U32 alignment, PtrSize maxAllocSize, BufferUsageBit usage, GrManager& gr)
 {
 	auto& perframe = m_perFrameBuffers[type];
+	perframe.m_alignment = alignment;
+	perframe.m_maxAllocSize = maxAllocSize;
+	perframe.m_usage = usage;
 
 	perframe.m_buff = gr.newBuffer(BufferInitInfo(perframe.m_size, usage, BufferMapAccessBit::WRITE, "Staging"));
 	perframe.m_alloc.init(perframe.m_size, alignment, maxAllocSize);
 	perframe.m_mappedMem = static_cast<U8*>(perframe.m_buff->map(0, perframe.m_size, BufferMapAccessBit::WRITE));
 }
 
+void StagingGpuMemoryManager::destroyBuffer(StagingGpuMemoryType type)
+{
+	PerFrameBuffer& perframe = m_perFrameBuffers[type];
+
+	if(perframe.m_buff)
+	{
+		perframe.m_buff->unmap();
+		perframe.m_buff = {};
+		perframe.m_mappedMem = nullptr;
+		perframe.m_alloc.destroy();
+	}
+
+	for(auto& chunks : perframe.m_overflowChunks)
+	{
+		for(OverflowChunk& chunk : chunks)
+		{
+			if(chunk.m_buff)
+			{
+				chunk.m_buff->unmap();
+			}
+
+			chunk = {};
+		}
+	}
+
+	perframe.m_overflowChunkCounts = {};
+	perframe.m_overflowAllocatedSize = 0;
+}
+
 void* StagingGpuMemoryManager::allocateFrame(PtrSize size, StagingGpuMemoryType usage, StagingGpuMemoryToken& token)
 {
-	PerFrameBuffer& buff = m_perFrameBuffers[usage];
-	Error err = buff.m_alloc.allocate(size, token.m_offset);
-	if(err)
+	void* out = tryAllocateFrame(size, usage, token);
+	if(out == nullptr)
 	{
 		ANKI_CORE_LOGF("Out of staging GPU memory. Usage: %u", U32(usage));
 	}
 
-	token.m_buffer = buff.m_buff;
-	token.m_range = size;
-	token.m_type = usage;
-
-	return buff.m_mappedMem + token.m_offset;
+	return out;
 }
 
 void* StagingGpuMemoryManager::tryAllocateFrame(PtrSize size, StagingGpuMemoryType usage, StagingGpuMemoryToken& token)
@@ -93,11 +120,75 @@ void* StagingGpuMemoryManager::tryAllocateFrame(PtrSize size, StagingGpuMemoryTy
 	}
 	else
 	{
-		token = {};
-		return nullptr;
+		// The fixed buffer is full, spill
+		return allocateOverflow(size, usage, token);
 	}
 }
 
+void* StagingGpuMemoryManager::allocateOverflow(PtrSize size, StagingGpuMemoryType usage, StagingGpuMemoryToken& token)
+{
+	PerFrameBuffer& buff = m_perFrameBuffers[usage];
+	const PtrSize alignedSize = getAlignedRoundUp(buff.m_alignment, size);
+	ANKI_ASSERT(alignedSize <= buff.m_maxAllocSize);
+
+	LockGuard<Mutex> lock(m_overflowMtx);
+
+	const U32 frameIdx = U32(m_frame % MAX_FRAMES_IN_FLIGHT);
+	auto& chunks = buff.m_overflowChunks[frameIdx];
+	U32& chunkCount = buff.m_overflowChunkCounts[frameIdx];
+
+	// Try the chunks the frame already has
+	OverflowChunk* chunk = nullptr;
+	for(U32 i = 0; i < chunkCount; ++i)
+	{
+		if(chunks[i].m_offset + alignedSize <= chunks[i].m_size)
+		{
+			chunk = &chunks[i];
+			break;
+		}
+	}
+
+	// Take a new one. It might be a recycled one of an older frame
+	if(chunk == nullptr)
+	{
+		if(chunkCount == MAX_OVERFLOW_CHUNKS)
+		{
+			token = {};
+			return nullptr;
+		}
+
+		chunk = &chunks[chunkCount++];
+		ANKI_ASSERT(chunk->m_offset == 0);
+
+		if(chunk->m_size < alignedSize)
+		{
+			if(chunk->m_buff)
+			{
+				chunk->m_buff->unmap();
+			}
+
+			chunk->m_size = getAlignedRoundUp(buff.m_alignment, max(m_overflowChunkSize, alignedSize));
+			chunk->m_buff = m_gr->newBuffer(
+				BufferInitInfo(chunk->m_size, buff.m_usage, BufferMapAccessBit::WRITE, "Staging overflow"));
+			chunk->m_mappedMem = static_cast<U8*>(chunk->m_buff->map(0, chunk->m_size, BufferMapAccessBit::WRITE));
+
+			ANKI_CORE_LOGW("Staging GPU memory overflowed. Creating a chunk of %zu bytes. Usage: %u",
+				chunk->m_size,
+				U32(usage));
+		}
+	}
+
+	token.m_buffer = chunk->m_buff;
+	token.m_offset = chunk->m_offset;
+	token.m_range = size;
+	token.m_type = usage;
+
+	chunk->m_offset += alignedSize;
+	buff.m_overflowAllocatedSize += alignedSize;
+
+	return chunk->m_mappedMem + token.m_offset;
+}
+
 void StagingGpuMemoryManager::endFrame()
 {
 	for(StagingGpuMemoryType usage = StagingGpuMemoryType::UNIFORM; usage < StagingGpuMemoryType::COUNT; ++usage)
@@ -119,8 +210,89 @@ void StagingGpuMemoryManager::endFrame()
 				break;
 			}
 
-			buff.m_alloc.endFrame();
+			// Track the memory of the frame
+			const PtrSize perFrameSize = buff.m_size / MAX_FRAMES_IN_FLIGHT;
+			const PtrSize bytesNotUsed = buff.m_alloc.endFrame();
+			const PtrSize bytesUsed = (perFrameSize > bytesNotUsed) ? perFrameSize - bytesNotUsed : 0;
+			buff.m_highWaterMark = max(buff.m_highWaterMark, bytesUsed + buff.m_overflowAllocatedSize);
+			if(buff.m_overflowAllocatedSize > 0)
+			{
+				++buff.m_overflowFrameCount;
+			}
+
+			// The GPU is done with the overflow chunks of the frame that comes next, recycle them
+			LockGuard<Mutex> lock(m_overflowMtx);
+			const U32 nextFrameIdx = U32((m_frame + 1) % MAX_FRAMES_IN_FLIGHT);
+			for(OverflowChunk& chunk : buff.m_overflowChunks[nextFrameIdx])
+			{
+				chunk.m_offset = 0;
+			}
+			buff.m_overflowChunkCounts[nextFrameIdx] = 0;
+			buff.m_overflowAllocatedSize = 0;
+		}
+	}
+
+	++m_frame;
+}
+
+StagingGpuMemoryStats StagingGpuMemoryManager::getStats(StagingGpuMemoryType type) const
+{
+	const PerFrameBuffer& buff = m_perFrameBuffers[type];
+
+	StagingGpuMemoryStats stats;
+	stats.m_perFrameSize = buff.m_size / MAX_FRAMES_IN_FLIGHT;
+	stats.m_highWaterMark = buff.m_highWaterMark;
+	stats.m_overflowFrameCount = buff.m_overflowFrameCount;
+
+	for(const auto& chunks : buff.m_overflowChunks)
+	{
+		for(const OverflowChunk& chunk : chunks)
+		{
+			stats.m_overflowSize += chunk.m_size;
+		}
+	}
+
+	return stats;
+}
+
+void StagingGpuMemoryManager::resizeToHighWaterMarks()
+{
+	m_gr->finish();
+
+	for(StagingGpuMemoryType type = StagingGpuMemoryType::UNIFORM; type < StagingGpuMemoryType::COUNT; ++type)
+	{
+		PerFrameBuffer& buff = m_perFrameBuffers[type];
+		if(!buff.m_buff || buff.m_highWaterMark == 0)
+		{
+			// Nothing used it, nothing to learn from
+			continue;
+		}
+
+		// Leave some room for the frames that use more than the ones so far
+		const PtrSize perFrameSize = buff.m_highWaterMark + buff.m_highWaterMark / 4;
+		const PtrSize newSize =
+			max<PtrSize>(getAlignedRoundUp(buff.m_alignment, perFrameSize) * MAX_FRAMES_IN_FLIGHT, 1_MB);
+
+		// Grow when it overflowed and shrink only when it's very oversized to avoid recreating the buffers
+		const Bool overflowed = buff.m_overflowFrameCount > 0;
+		if(overflowed || newSize < buff.m_size / 2)
+		{
+			ANKI_CORE_LOGI("Resizing the staging GPU memory from %zu to %zu bytes. Usage: %u",
+				buff.m_size,
+				newSize,
+				U32(type));
+
+			const U32 alignment = buff.m_alignment;
+			const PtrSize maxAllocSize = buff.m_maxAllocSize;
+			const BufferUsageBit usage = buff.m_usage;
+			destroyBuffer(type);
+
+			buff.m_size = newSize;
+			initBuffer(type, alignment, maxAllocSize, usage, *m_gr);
 		}
+
+		buff.m_highWaterMark = 0;
+		buff.m_overflowFrameCount = 0;
 	}
 }
 
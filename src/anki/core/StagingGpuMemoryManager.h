@@ -8,6 +8,7 @@
 #include <anki/core/Common.h>
 #include <anki/gr/Buffer.h>
 #include <anki/gr/utils/FrameGpuAllocator.h>
+#include <anki/util/Thread.h>
 
 namespace anki
 {
@@ -62,7 +63,19 @@ public:
 	}
 };
 
-/// Manages staging GPU memory.
+/// Statistics of a type of staging memory. @memberof StagingGpuMemoryManager
+class StagingGpuMemoryStats
+{
+public:
+	PtrSize m_perFrameSize = 0; ///< The size of the fixed buffer of a frame.
+	PtrSize m_highWaterMark = 0; ///< The most memory a frame used, overflow included.
+	PtrSize m_overflowSize = 0; ///< The memory of the overflow chunks of all the frames in flight.
+	U32 m_overflowFrameCount = 0; ///< The frames that needed overflow chunks.
+};
+
+/// Manages staging GPU memory. Every type has a fixed buffer that is split between the frames in flight. When a frame
+/// runs out of it the allocations spill to overflow chunks that are created on demand and recycled after
+/// MAX_FRAMES_IN_FLIGHT frames.
 class StagingGpuMemoryManager : public NonCopyable
 {
 public:
@@ -82,7 +95,24 @@ public:
 	/// N-(MAX_FRAMES_IN_FLIGHT-1) frame.
 	void* tryAllocateFrame(PtrSize size, StagingGpuMemoryType usage, StagingGpuMemoryToken& token);
 
+	StagingGpuMemoryStats getStats(StagingGpuMemoryType type) const;
+
+	/// Resize the fixed buffers to fit the high-water marks of the frames so far and reset the marks. It waits for the
+	/// GPU. Call it at level transitions, when nothing uses staging memory.
+	void resizeToHighWaterMarks();
+
 private:
+	static constexpr U32 MAX_OVERFLOW_CHUNKS = 16; ///< Per type and frame.
+
+	class OverflowChunk
+	{
+	public:
+		BufferPtr m_buff;
+		U8* m_mappedMem = nullptr;
+		PtrSize m_size = 0;
+		PtrSize m_offset = 0;
+	};
+
 	class PerFrameBuffer
 	{
 	public:
@@ -90,13 +120,34 @@ private:
 		BufferPtr m_buff;
 		U8* m_mappedMem = nullptr; ///< Cache it
 		FrameGpuAllocator m_alloc;
+
+		U32 m_alignment = 0;
+		PtrSize m_maxAllocSize = 0;
+		BufferUsageBit m_usage = BufferUsageBit::NONE;
+
+		/// @name Overflow. Protected by m_overflowMtx
+		/// @{
+		Array2d<OverflowChunk, MAX_FRAMES_IN_FLIGHT, MAX_OVERFLOW_CHUNKS> m_overflowChunks;
+		Array<U32, MAX_FRAMES_IN_FLIGHT> m_overflowChunkCounts = {};
+		PtrSize m_overflowAllocatedSize = 0; ///< Of the current frame.
+		/// @}
+
+		PtrSize m_highWaterMark = 0;
+		U32 m_overflowFrameCount = 0;
 	};
 
 	GrManager* m_gr = nullptr;
 	Array<PerFrameBuffer, U(StagingGpuMemoryType::COUNT)> m_perFrameBuffers;
+	Mutex m_overflowMtx;
+	PtrSize m_overflowChunkSize = 0;
+	U64 m_frame = 0;
 
 	void initBuffer(
 		StagingGpuMemoryType type, U32 alignment, PtrSize maxAllocSize, BufferUsageBit usage, GrManager& gr);
+
+	void destroyBuffer(StagingGpuMemoryType type);
+
+	void* allocateOverflow(PtrSize size, StagingGpuMemoryType usage, StagingGpuMemoryToken& token);
 };
 /// @}
 
@@ -8,6 +8,7 @@
 #include <anki/gr/GrObject.h>
 #include <anki/gr/Framebuffer.h>
 #include <anki/util/Functions.h>
+#include <anki/util/WeakArray.h>
 
 namespace anki
 {
@@ -83,8 +84,36 @@ public:
 	}
 };
 
+/// The draw indirect structure for the mesh shader drawing, also the parameters of a regular mesh drawcall.
+class DrawMeshTasksIndirectInfo
+{
+public:
+	U32 m_taskCount = MAX_U32;
+	U32 m_firstTask = 0;
+
+	DrawMeshTasksIndirectInfo() = default;
+
+	DrawMeshTasksIndirectInfo(const DrawMeshTasksIndirectInfo&) = default;
+
+	DrawMeshTasksIndirectInfo(U32 taskCount, U32 firstTask)
+		: m_taskCount(taskCount)
+		, m_firstTask(firstTask)
+	{
+	}
+
+	Bool operator==(const DrawMeshTasksIndirectInfo& b) const
+	{
+		return m_taskCount == b.m_taskCount && m_firstTask == b.m_firstTask;
+	}
+
+	Bool operator!=(const DrawMeshTasksIndirectInfo& b) const
+	{
+		return !(operator==(b));
+	}
+};
+
 /// Command buffer initialization flags.
-enum class CommandBufferFlag : U8
+enum class CommandBufferFlag : U16
 {
 	NONE = 0,
 
@@ -101,6 +130,15 @@ enum class CommandBufferFlag : U8
 
 	/// Will contain compute work.
 	COMPUTE_WORK = 1 << 6,
+
+	/// Will contain compute and transfer work only and it will run in the async compute queue if there is one. See
+	/// GpuDeviceCapabilities::m_asyncCompute.
+	ASYNC_COMPUTE_WORK = 1 << 7,
+
+	/// Will contain transfer work only and it will run in a transfer only queue if there is one. The barriers can name
+	/// any usage but their synchronization is limited to the transfer stage. The next submits of the other queues wait
+	/// for it.
+	ASYNC_TRANSFER_WORK = 1 << 8,
 };
 ANKI_ENUM_ALLOW_NUMERIC_OPERATIONS(CommandBufferFlag, inline)
 
@@ -120,6 +158,16 @@ public:
 	}
 };
 
+/// The commands a command buffer recorded so far.
+class CommandBufferStatistics
+{
+public:
+	U32 m_drawcallCount = 0; ///< Direct and indirect.
+	U32 m_dispatchCount = 0;
+	U64 m_primitiveCount = 0; ///< The primitives of the direct drawcalls. The indirect are not known in the CPU.
+	U32 m_barrierCount = 0;
+};
+
 /// Command buffer.
 class CommandBuffer : public GrObject
 {
@@ -132,6 +180,13 @@ public:
 	/// @param[out] fence Optionaly create fence.
 	void flush(FencePtr* fence = nullptr);
 
+	/// Same as flush() but it also synchronizes with other primary command buffers in the GPU. Use it when command
+	/// buffers of different queues depend on each other.
+	/// @param waitFences Fences of previous flushes that the GPU will wait before running this command buffer. They
+	///                   should have been created by this method.
+	/// @param[out] signalFence Create a fence that another flush can wait. It should be waited exactly once.
+	void flush(ConstWeakArray<FencePtr> waitFences, FencePtr* signalFence);
+
 	/// @name State manipulation
 	/// @{
 
@@ -222,6 +277,10 @@ public:
 	/// Set the line width. By default it's undefined.
 	void setLineWidth(F32 lineWidth);
 
+	/// Allow the drawcalls that follow to be skipped while their pipeline is created in the background. Good for
+	/// drawcalls that can be missing for a few frames. By default it's false.
+	void setAsyncPipelineCreation(Bool enable);
+
 	/// Bind texture and sample.
 	/// @param set The set to bind to.
 	/// @param binding The binding to bind to.
@@ -300,6 +359,11 @@ public:
 	/// @return The index to use to access the image.
 	U32 bindBindlessImage(TextureViewPtr img);
 
+	/// Bind a whole storage buffer as bindless. It's very lightweight and doesn't translate to a GPU operation.
+	/// @param buff The buffer to bind.
+	/// @return The index to use to access the buffer.
+	U32 bindBindlessBuffer(BufferPtr buff);
+
 	/// Set push constants.
 	void setPushConstants(const void* data, U32 dataSize);
 
@@ -336,6 +400,13 @@ public:
 
 	void drawArraysIndirect(PrimitiveTopology topology, U32 drawCount, PtrSize offset, BufferPtr indirectBuff);
 
+	/// Draw with a program that has a mesh shader. The task shader (or the mesh shader if there is no task shader)
+	/// runs taskCount workgroups. Needs GpuDeviceCapabilities::m_meshShaders.
+	void drawMeshTasks(U32 taskCount, U32 firstTask = 0);
+
+	/// Indirect version of drawMeshTasks. The buffer holds DrawMeshTasksIndirectInfo structures.
+	void drawMeshTasksIndirect(U32 drawCount, PtrSize offset, BufferPtr indirectBuff);
+
 	void dispatchCompute(U32 groupCountX, U32 groupCountY, U32 groupCountZ);
 
 	/// Generate mipmaps for non-3D textures. You have to transition all the mip levels of this face and layer to
@@ -400,8 +471,31 @@ public:
 	void setTextureVolumeBarrier(
 		TexturePtr tex, TextureUsageBit prevUsage, TextureUsageBit nextUsage, const TextureVolumeInfo& vol);
 
+	/// Barrier for the first use of a texture that shares the memory of a TextureHeap with other textures. The previous
+	/// contents are discarded.
+	/// @param prevAliasesUsage The last usage of the textures that used that memory before.
+	/// @param nextUsage The first usage of the texture.
+	void setTextureAliasingBarrier(TexturePtr tex,
+		TextureUsageBit prevAliasesUsage,
+		TextureUsageBit nextUsage,
+		const TextureSubresourceInfo& subresource);
+
 	void setBufferBarrier(
 		BufferPtr buff, BufferUsageBit prevUsage, BufferUsageBit nextUsage, PtrSize offset, PtrSize size);
+
+	/// Begin a split barrier. Record it right after the last work that uses some textures with prevUsage and end it
+	/// with setTextureSurfaceSplitBarrier right before the work that needs them. The work in between is not blocked.
+	/// @param prevUsage The usage of all the textures that the split barrier will transition.
+	/// @return The split barrier. It's valid until the command buffer is flushed.
+	U32 beginSplitBarrier(TextureUsageBit prevUsage);
+
+	/// The second half of a split barrier. It's like setTextureSurfaceBarrier.
+	/// @param splitBarrier The return value of beginSplitBarrier.
+	void setTextureSurfaceSplitBarrier(U32 splitBarrier,
+		TexturePtr tex,
+		TextureUsageBit prevUsage,
+		TextureUsageBit nextUsage,
+		const TextureSurfaceInfo& surf);
 	/// @}
 
 	/// @name Other
@@ -419,10 +513,21 @@ public:
 	/// Write a timestamp.
 	void writeTimestamp(TimestampQueryPtr query);
 
+	/// Begin a GPU breadcrumb. If the device gets lost the last breadcrumbs that the GPU started and finished are
+	/// logged. It does nothing if the breadcrumbs are disabled.
+	/// @note Not inside a render pass. The breadcrumbs can't nest.
+	void beginBreadcrumb(CString name);
+
+	/// End the breadcrumb that beginBreadcrumb() began.
+	void endBreadcrumb();
+
 	/// Append a second level command buffer.
 	void pushSecondLevelCommandBuffer(CommandBufferPtr cmdb);
 
 	Bool isEmpty() const;
+
+	/// Get the statistics of the commands recorded so far.
+	void getStatistics(CommandBufferStatistics& stats) const;
 	/// @}
 
 protected:
@@ -165,6 +165,32 @@ static void getFormatInfo(Format fmt, U& texelComponents, U& texelBytes, U& bloc
 		blockSize = 4;
 		blockBytes = 16;
 		break;
+	case Format::BC7_SRGB_BLOCK:
+	case Format::BC7_UNORM_BLOCK:
+		texelComponents = 4;
+		blockSize = 4;
+		blockBytes = 16;
+		break;
+	case Format::ETC2_R8G8B8_SRGB_BLOCK:
+	case Format::ETC2_R8G8B8_UNORM_BLOCK:
+		texelComponents = 3;
+		blockSize = 4;
+		blockBytes = 8;
+		break;
+	case Format::ETC2_R8G8B8A1_SRGB_BLOCK:
+	case Format::ETC2_R8G8B8A1_UNORM_BLOCK:
+		texelComponents = 4;
+		blockSize = 4;
+		blockBytes = 8;
+		break;
+	case Format::ETC2_R8G8B8A8_SRGB_BLOCK:
+	case Format::ETC2_R8G8B8A8_UNORM_BLOCK:
+	case Format::ASTC_4x4_SRGB_BLOCK:
+	case Format::ASTC_4x4_UNORM_BLOCK:
+		texelComponents = 4;
+		blockSize = 4;
+		blockBytes = 16;
+		break;
 	case Format::D16_UNORM:
 		texelComponents = 1;
 		texelBytes = texelComponents * 2;
@@ -20,6 +20,7 @@ class GrManager;
 class GrManagerImpl;
 class TextureInitInfo;
 class TextureViewInitInfo;
+class TextureHeapInitInfo;
 class SamplerInitInfo;
 class GrManagerInitInfo;
 class FramebufferInitInfo;
@@ -61,6 +62,7 @@ using GrObjectPtr = IntrusivePtr<T, DefaultPtrDeleter<T>>;
 ANKI_GR_CLASS(Buffer)
 ANKI_GR_CLASS(Texture)
 ANKI_GR_CLASS(TextureView)
+ANKI_GR_CLASS(TextureHeap)
 ANKI_GR_CLASS(Sampler)
 ANKI_GR_CLASS(CommandBuffer)
 ANKI_GR_CLASS(Shader)
@@ -142,10 +144,41 @@ public:
 
 	/// API version.
 	U8 m_majorApiVersion = 0;
+
+	/// The texel size of the shading rate image. Every texel of it covers that many pixels in X and Y.
+	U32 m_minShadingRateImageTexelSize = 0;
+
+	/// The number of invocations of a subgroup. Zero if unknown.
+	U32 m_subgroupSize = 0;
+
+	/// There is a compute queue that can run in parallel with the graphics one.
+	Bool m_asyncCompute = false;
+
+	/// The framebuffers can have a shading rate image that sets the shading rate of their regions.
+	Bool m_vrs = false;
+
+	/// The graphics programs can have task and mesh shaders instead of a vertex shader.
+	Bool m_meshShaders = false;
+
+	/// The BC (S3TC, BC6H and BC7) formats can be sampled.
+	Bool m_bcTextureCompression = false;
+
+	/// The ETC2 formats can be sampled.
+	Bool m_etc2TextureCompression = false;
+
+	/// The LDR ASTC formats can be sampled.
+	Bool m_astcTextureCompression = false;
+
+	/// The compute shaders can use the subgroup arithmetic operations (subgroupAdd and friends).
+	Bool m_subgroupArithmetic = false;
+
+	/// The shaders can do arithmetic in half precision floats.
+	Bool m_shaderFloat16 = false;
 };
 ANKI_END_PACKED_STRUCT
 static_assert(
-	sizeof(GpuDeviceCapabilities) == sizeof(PtrSize) * 4 + sizeof(U32) * 3 + sizeof(U8) * 3, "Should be packed");
+	sizeof(GpuDeviceCapabilities) == sizeof(PtrSize) * 4 + sizeof(U32) * 5 + sizeof(U8) * 3 + sizeof(Bool) * 8,
+	"Should be packed");
 
 /// Bindless related info.
 class BindlessLimits
@@ -153,6 +186,7 @@ class BindlessLimits
 public:
 	U32 m_bindlessTextureCount = 0;
 	U32 m_bindlessImageCount = 0;
+	U32 m_bindlessBufferCount = 0;
 };
 
 /// The type of the allocator for heap allocations
@@ -5,9 +5,52 @@
 
 ANKI_CONFIG_OPTION(gr_debugContext, 0, 0, 1)
 ANKI_CONFIG_OPTION(gr_vsync, 0, 0, 1)
+ANKI_CONFIG_OPTION(gr_presentMode,
+	0,
+	0,
+	4,
+	"0: Pick by gr_vsync, 1: FIFO, 2: FIFO relaxed, 3: mailbox, 4: immediate. Falls back to FIFO if not supported")
+ANKI_CONFIG_OPTION(gr_maxFramesInFlight,
+	2,
+	1,
+	2,
+	"The frames the CPU can submit before it waits for the GPU. Less frames lower the latency but also the throughput")
+ANKI_CONFIG_OPTION(gr_lowLatency,
+	0,
+	0,
+	1,
+	"Wait for the GPU to finish the previous frame before sampling the input. Lowers the input to photon latency")
 ANKI_CONFIG_OPTION(gr_debugMarkers, 0, 0, 1)
-ANKI_CONFIG_OPTION(gr_maxBindlessTextures, 256, 8, 1024)
-ANKI_CONFIG_OPTION(gr_maxBindlessImages, 32, 8, 1024)
+ANKI_CONFIG_OPTION(
+	gr_glSingleThreaded, 0, 0, 1, "GL only: Run the GL commands in the main thread instead of a dedicated thread")
+ANKI_CONFIG_OPTION(gr_maxBindlessTextures, 4096, 8, 65535, "Clamped to the descriptor indexing limits of the device")
+ANKI_CONFIG_OPTION(gr_maxBindlessImages, 512, 8, 65535, "Clamped to the descriptor indexing limits of the device")
+ANKI_CONFIG_OPTION(
+	gr_maxBindlessBuffers, 1024, 8, 65535, "Storage buffers. Clamped to the descriptor indexing limits of the device")
+ANKI_CONFIG_OPTION(
+	gr_asyncCompute, 1, 0, 1, "Run some compute passes in a queue that works in parallel with the graphics one")
+ANKI_CONFIG_OPTION(gr_vrs, 0, 0, 1, "Enable variable rate shading with a shading rate image if the device supports it")
+ANKI_CONFIG_OPTION(gr_asyncPipelineThreadCount,
+	2,
+	0,
+	16,
+	"Threads that create the pipelines of some draws in the background. With zero the draws wait for the pipelines")
+ANKI_CONFIG_OPTION(gr_pushDescriptors, 1, 0, 1, "Use push descriptors for one small descriptor set of every program")
+ANKI_CONFIG_OPTION(gr_asyncTransfer,
+	1,
+	0,
+	1,
+	"Upload the resources in a transfer only queue if there is one. It needs timeline semaphores")
+ANKI_CONFIG_OPTION(
+	gr_timelineSemaphores, 1, 0, 1, "Track the submissions with a timeline semaphore per queue instead of with fences")
+ANKI_CONFIG_OPTION(gr_meshShaders, 1, 0, 1, "Enable the task and mesh shaders if the device supports them")
+ANKI_CONFIG_OPTION(
+	gr_shaderFloat16, 1, 0, 1, "Let the shaders do the math of their F16 types in half precision if the device can")
+ANKI_CONFIG_OPTION(gr_breadcrumbs,
+	1,
+	0,
+	1,
+	"Mark the render graph passes in a host visible buffer and report the last ones the GPU ran if the device is lost")
 
 // Vulkan
 ANKI_CONFIG_OPTION(gr_diskShaderCacheMaxSize, 128_MB, 1_MB, 1_GB)
@@ -409,11 +409,13 @@ enum class TextureUsageBit : U16
 	GENERATE_MIPMAPS = 1 << 11,
 	CLEAR = 1 << 12, ///< Will be used in CommandBuffer::clearTextureView.
 	PRESENT = 1 << 13,
+	FRAMEBUFFER_SHADING_RATE = 1 << 14, ///< Read as the shading rate image of a framebuffer.
 
 	// Derived
 	ALL_COMPUTE = SAMPLED_COMPUTE | IMAGE_COMPUTE_READ_WRITE,
-	ALL_GRAPHICS = SAMPLED_ALL_GRAPHICS | FRAMEBUFFER_ATTACHMENT_READ_WRITE,
-	ALL_READ = SAMPLED_ALL | IMAGE_COMPUTE_READ | FRAMEBUFFER_ATTACHMENT_READ | PRESENT | GENERATE_MIPMAPS,
+	ALL_GRAPHICS = SAMPLED_ALL_GRAPHICS | FRAMEBUFFER_ATTACHMENT_READ_WRITE | FRAMEBUFFER_SHADING_RATE,
+	ALL_READ = SAMPLED_ALL | IMAGE_COMPUTE_READ | FRAMEBUFFER_ATTACHMENT_READ | PRESENT | GENERATE_MIPMAPS
+			   | FRAMEBUFFER_SHADING_RATE,
 	ALL_WRITE =
 		IMAGE_COMPUTE_WRITE | FRAMEBUFFER_ATTACHMENT_WRITE | TRANSFER_DESTINATION | GENERATE_MIPMAPS | CLEAR | PRESENT,
 };
@@ -446,6 +448,8 @@ enum class ShaderType : U8
 	GEOMETRY,
 	FRAGMENT,
 	COMPUTE,
+	TASK,
+	MESH,
 
 	COUNT,
 	FIRST = VERTEX,
@@ -463,9 +467,11 @@ enum class ShaderTypeBit : U8
 	GEOMETRY = 1 << 3,
 	FRAGMENT = 1 << 4,
 	COMPUTE = 1 << 5,
+	TASK = 1 << 6,
+	MESH = 1 << 7,
 
 	NONE = 0,
-	ALL = VERTEX | TESSELLATION_CONTROL | TESSELLATION_EVALUATION | GEOMETRY | FRAGMENT | COMPUTE,
+	ALL = VERTEX | TESSELLATION_CONTROL | TESSELLATION_EVALUATION | GEOMETRY | FRAGMENT | COMPUTE | TASK | MESH,
 };
 ANKI_ENUM_ALLOW_NUMERIC_OPERATIONS(ShaderTypeBit, inline)
 
@@ -554,7 +560,7 @@ enum class BufferUsageBit : U64
 {
 	NONE = 0,
 
-	UNIFORM_VERTEX = 1 << 0,
+	UNIFORM_VERTEX = 1 << 0, ///< The VERTEX bits cover the task and mesh shaders as well.
 	UNIFORM_TESSELLATION_EVALUATION = 1 << 1,
 	UNIFORM_TESSELLATION_CONTROL = 1 << 2,
 	UNIFORM_GEOMETRY = 1 << 3,
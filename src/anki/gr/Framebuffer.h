@@ -37,6 +37,12 @@ public:
 	U32 m_colorAttachmentCount = 0;
 	FramebufferAttachmentInfo m_depthStencilAttachment;
 
+	/// Optional shading rate image. It needs GpuDeviceCapabilities::m_vrs. Every texel of it sets the shading rate of
+	/// m_shadingRateAttachmentTexelWidth x m_shadingRateAttachmentTexelHeight pixels.
+	TextureViewPtr m_shadingRateAttachment;
+	U32 m_shadingRateAttachmentTexelWidth = 0;
+	U32 m_shadingRateAttachmentTexelHeight = 0;
+
 	FramebufferInitInfo()
 		: GrBaseInitInfo()
 	{
@@ -66,6 +72,9 @@ public:
 
 		m_colorAttachmentCount = b.m_colorAttachmentCount;
 		m_depthStencilAttachment = b.m_depthStencilAttachment;
+		m_shadingRateAttachment = b.m_shadingRateAttachment;
+		m_shadingRateAttachmentTexelWidth = b.m_shadingRateAttachmentTexelWidth;
+		m_shadingRateAttachmentTexelHeight = b.m_shadingRateAttachmentTexelHeight;
 		return *this;
 	}
 
@@ -84,6 +93,12 @@ public:
 			return false;
 		}
 
+		if(m_shadingRateAttachment.isCreated()
+			&& (m_shadingRateAttachmentTexelWidth == 0 || m_shadingRateAttachmentTexelHeight == 0))
+		{
+			return false;
+		}
+
 		return true;
 	}
 };
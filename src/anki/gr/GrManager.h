@@ -15,6 +15,7 @@ namespace anki
 // Forward
 class ConfigSet;
 class NativeWindow;
+class ThreadHive;
 
 /// @addtogroup graphics
 /// @{
@@ -38,7 +39,15 @@ class GrManagerStats
 public:
 	PtrSize m_cpuMemory = 0;
 	PtrSize m_gpuMemory = 0;
+	PtrSize m_gpuMemoryBudget = 0; ///< Zero if the driver doesn't report it.
+	PtrSize m_gpuMemoryUsage = 0; ///< Of all the processes. Zero if the driver doesn't report it.
+	PtrSize m_fragmentedMemory = 0; ///< Allocated memory that no allocation uses.
+	PtrSize m_wastedMemory = 0; ///< Memory that the allocations got but didn't ask for.
 	U32 m_commandBufferCount = 0;
+	U32 m_commandPoolResets = 0; ///< Since the beginning.
+	PtrSize m_commandBufferMemory = 0; ///< The CPU memory the command buffers use to record.
+	U32 m_descriptorSetCacheHits = 0; ///< Of the last frame.
+	U32 m_descriptorSetWrites = 0; ///< Of the last frame.
 };
 
 /// The graphics manager, owner of all graphics objects.
@@ -68,6 +77,10 @@ public:
 	/// Swap buffers
 	void swapBuffers();
 
+	/// Call it at the beginning of the frame, before sampling the input. If low latency is enabled (gr_lowLatency) it
+	/// waits for the GPU to finish the previous frame so the input is sampled as late as possible.
+	void waitForPreviousFrame();
+
 	/// Wait for all work to finish.
 	void finish();
 
@@ -76,6 +89,7 @@ public:
 	ANKI_USE_RESULT BufferPtr newBuffer(const BufferInitInfo& init);
 	ANKI_USE_RESULT TexturePtr newTexture(const TextureInitInfo& init);
 	ANKI_USE_RESULT TextureViewPtr newTextureView(const TextureViewInitInfo& init);
+	ANKI_USE_RESULT TextureHeapPtr newTextureHeap(const TextureHeapInitInfo& init);
 	ANKI_USE_RESULT SamplerPtr newSampler(const SamplerInitInfo& init);
 	ANKI_USE_RESULT ShaderPtr newShader(const ShaderInitInfo& init);
 	ANKI_USE_RESULT ShaderProgramPtr newShaderProgram(const ShaderProgramInitInfo& init);
@@ -86,8 +100,27 @@ public:
 	ANKI_USE_RESULT RenderGraphPtr newRenderGraph();
 	/// @}
 
+	/// Get the memory a texture needs when it's placed in a TextureHeap. The m_heap of the init info is ignored.
+	void getTextureMemoryRequirements(const TextureInitInfo& init, PtrSize& size, PtrSize& alignment);
+
 	GrManagerStats getStats() const;
 
+	/// @name Pipeline warmup. The graphics pipelines are created the first time some state is used and that causes
+	///       hitches. Record the pipelines that some content uses and create them ahead of time the next time it loads.
+	/// @{
+
+	/// Start recording the graphics pipelines that get created.
+	void beginPipelineRecording();
+
+	/// Stop recording and store the recorded pipelines to a manifest file.
+	ANKI_USE_RESULT Error endPipelineRecording(CString manifestFilename);
+
+	/// Create the pipelines of a manifest file using the threads of the hive. Only the pipelines of the shader programs
+	/// that exist are created so call it after the content is loaded. If recording, the pipelines of the manifest will
+	/// be stored to the new manifest as well.
+	ANKI_USE_RESULT Error warmupPipelines(CString manifestFilename, ThreadHive& hive);
+	/// @}
+
 	ANKI_INTERNAL GrAllocator<U8>& getAllocator()
 	{
 		return m_alloc;
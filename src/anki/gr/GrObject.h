@@ -27,6 +27,7 @@ enum GrObjectType : U8
 	SHADER,
 	TEXTURE,
 	TEXTURE_VIEW,
+	TEXTURE_HEAP,
 	SHADER_PROGRAM,
 	FENCE,
 	RENDER_GRAPH,
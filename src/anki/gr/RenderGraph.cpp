@@ -9,7 +9,9 @@
 #include <anki/gr/Sampler.h>
 #include <anki/gr/Framebuffer.h>
 #include <anki/gr/CommandBuffer.h>
+#include <anki/gr/Fence.h>
 #include <anki/util/Tracer.h>
+#include <anki/util/HighRezTimer.h>
 #include <anki/util/BitSet.h>
 #include <anki/util/File.h>
 #include <anki/util/StringList.h>
@@ -31,7 +33,9 @@ class RenderGraph::RT
 public:
 	DynamicArray<TextureUsageBit> m_surfOrVolUsages;
 	DynamicArray<U16> m_lastBatchThatTransitionedIt;
+	DynamicArray<U16> m_lastBatchThatUsedIt;
 	TexturePtr m_texture; ///< Hold a reference.
+	DynamicArray<U32> m_aliasedPredecessors; ///< RTs that used the same memory before this one in the frame.
 	Bool m_imported;
 };
 
@@ -53,6 +57,8 @@ public:
 		TextureUsageBit m_usageBefore;
 		TextureUsageBit m_usageAfter;
 		TextureSurfaceInfo m_surface;
+		TextureUsageBit m_prevAliasesUsage; ///< If not NONE it's the first use of an aliased RT.
+		U32 m_splitBarrierBatch; ///< If not MAX_U32 it's the 2nd half of a split barrier that begins after that batch.
 	};
 
 	struct BufferInfo
@@ -70,8 +76,12 @@ public:
 
 	Bool m_isTexture;
 
-	Barrier(U32 rtIdx, TextureUsageBit usageBefore, TextureUsageBit usageAfter, const TextureSurfaceInfo& surf)
-		: m_texture({rtIdx, usageBefore, usageAfter, surf})
+	Barrier(U32 rtIdx,
+		TextureUsageBit usageBefore,
+		TextureUsageBit usageAfter,
+		const TextureSurfaceInfo& surf,
+		TextureUsageBit prevAliasesUsage = TextureUsageBit::NONE)
+		: m_texture({rtIdx, usageBefore, usageAfter, surf, prevAliasesUsage, MAX_U32})
 		, m_isTexture(true)
 	{
 	}
@@ -104,16 +114,24 @@ public:
 
 	RenderPassWorkCallback m_callback;
 	void* m_userData;
+	const char* m_name; ///< A copy in the BakeContext's memory. For the GPU breadcrumbs.
 
 	DynamicArray<CommandBufferPtr> m_secondLevelCmdbs;
+	DynamicArray<Second> m_secondLevelCmdbCpuTimes; ///< Recording time of every m_secondLevelCmdbs.
 	/// Will reuse the m_secondLevelCmdbInitInfo.m_framebuffer to get the framebuffer.
 	CommandBufferInitInfo m_secondLevelCmdbInitInfo;
 	Array<U32, 4> m_fbRenderArea;
 	Array<TextureUsageBit, MAX_COLOR_ATTACHMENTS> m_colorUsages = {}; ///< For beginRender pass
 	TextureUsageBit m_dsUsage = TextureUsageBit::NONE; ///< For beginRender pass
 
+	TimestampQueryPtr m_beginTimestamp; ///< Optional.
+	TimestampQueryPtr m_endTimestamp; ///< Optional.
+
 	U32 m_batchIdx ANKI_DEBUG_CODE(= MAX_U32);
 	Bool m_drawsToPresentable = false;
+	Bool m_asyncCompute = false; ///< It will run in the async compute queue.
+
+	RenderGraphPassStatistics m_cpuStats; ///< Gathered only with the pass timestamps.
 
 	FramebufferPtr& fb()
 	{
@@ -126,6 +144,16 @@ public:
 	}
 };
 
+/// The timestamps of a pass for the GPU timeline of the tracer and the pass statistics.
+class RenderGraph::PassTimestamps
+{
+public:
+	TimestampQueryPtr m_begin;
+	TimestampQueryPtr m_end;
+	const char* m_name; ///< Points to a string in RenderGraph::m_statistics::m_passNames.
+	RenderGraphPassStatistics m_cpuStats; ///< All but the GPU time.
+};
+
 /// A batch of render passes. These passes can run in parallel.
 /// @warning It's POD. Destructor won't be called.
 class RenderGraph::Batch
@@ -134,6 +162,30 @@ public:
 	DynamicArray<U32> m_passIndices;
 	DynamicArray<Barrier> m_barriersBefore;
 	CommandBuffer* m_cmdb; ///< Someone else holds the ref already so have a ptr here.
+	U32 m_submitIdx;
+	TextureUsageBit m_splitBarrierUsage = TextureUsageBit::NONE; ///< If not NONE begin a split barrier after the batch.
+	Bool m_asyncCompute; ///< All passes of a batch run in the same queue.
+};
+
+/// A command buffer that will be submitted to the graphics or the async compute queue.
+class RenderGraph::Submit
+{
+public:
+	CommandBufferPtr m_cmdb;
+	FencePtr m_fence; ///< The submit of the other queue waits for that.
+	U32 m_waitSubmit = MAX_U32; ///< A submit of the other queue to wait before running. Covers its previous submits.
+	Bool m_asyncCompute = false;
+	Bool m_signal = false; ///< A submit of the other queue will wait for it.
+};
+
+/// A second level command buffer of a pass. RenderGraph::runSecondLevel records them in the order of their cost.
+/// @warning It's POD. Destructor won't be called.
+class RenderGraph::SecondLevelTask
+{
+public:
+	U32 m_passIdx;
+	U32 m_cmdbIdx;
+	U32 m_cost; ///< The work estimate of a single command buffer of the pass.
 };
 
 /// The RenderGraph build context.
@@ -147,9 +199,18 @@ public:
 	DynamicArray<RT> m_rts;
 	DynamicArray<Buffer> m_buffers;
 
-	DynamicArray<CommandBufferPtr> m_graphicsCmdbs;
+	DynamicArray<Submit> m_submits; ///< In the order they will be flushed.
+	Array<U32, 2> m_crntSubmit = {{MAX_U32, MAX_U32}}; ///< The submit that a new batch can go to, per queue.
+	Array<U32, 2> m_lastWaitedSubmit = {{MAX_U32, MAX_U32}}; ///< The last submit of the other queue waited, per queue.
+	U32 m_lastGraphicsSubmit = MAX_U32;
+
+	DynamicArray<SecondLevelTask> m_secondLevelTasks;
+	Atomic<U32> m_secondLevelTaskCounter = {0}; ///< The next task of m_secondLevelTasks to record.
 
 	Bool m_gatherStatistics = false;
+	Bool m_gatherPassTimestamps = false;
+	Bool m_renderTargetAliasing = false;
+	Bool m_splitBarriers = false;
 
 	BakeContext(const StackAllocator<U8>& alloc)
 		: m_alloc(alloc)
@@ -224,6 +285,14 @@ void FramebufferDescription::bake()
 		m_hash = (m_hash != 0) ? appendHash(&outAtt, sizeof(outAtt), m_hash) : computeHash(&outAtt, sizeof(outAtt));
 	}
 
+	// Shading rate image
+	if(m_shadingRateAttachmentTexelWidth > 0)
+	{
+		ANKI_ASSERT(m_shadingRateAttachmentTexelHeight > 0);
+		const Array<U32, 2> texelSize = {{m_shadingRateAttachmentTexelWidth, m_shadingRateAttachmentTexelHeight}};
+		m_hash = appendHash(&texelSize[0], sizeof(texelSize), m_hash);
+	}
+
 	ANKI_ASSERT(m_hash != 0 && m_hash != 1);
 }
 
@@ -246,6 +315,10 @@ RenderGraph::~RenderGraph()
 	}
 
 	m_fbCache.destroy(getAllocator());
+	m_rtMemoryRequirements.destroy(getAllocator());
+	m_compiledGraphCache.m_dependsOn.destroy(getAllocator());
+	m_compiledGraphCache.m_dependsOnOffsets.destroy(getAllocator());
+	m_compiledGraphCache.m_passWaves.destroy(getAllocator());
 
 	for(auto& it : m_importedRenderTargets)
 	{
@@ -253,6 +326,19 @@ RenderGraph::~RenderGraph()
 	}
 
 	m_importedRenderTargets.destroy(getAllocator());
+
+	for(DynamicArray<PassTimestamps>& timestamps : m_statistics.m_passTimestamps)
+	{
+		timestamps.destroy(getAllocator());
+	}
+
+	for(String& name : m_statistics.m_passNames)
+	{
+		name.destroy(getAllocator());
+	}
+
+	m_statistics.m_passNames.destroy(getAllocator());
+	m_statistics.m_passes.destroy(getAllocator());
 }
 
 RenderGraph* RenderGraph::newInstance(GrManager* manager)
@@ -324,9 +410,13 @@ void RenderGraph::reset()
 	{
 		p.fb().reset(nullptr);
 		p.m_secondLevelCmdbs.destroy(m_ctx->m_alloc);
+		p.m_secondLevelCmdbCpuTimes.destroy(m_ctx->m_alloc);
+		p.m_beginTimestamp.reset(nullptr);
+		p.m_endTimestamp.reset(nullptr);
 	}
 
-	m_ctx->m_graphicsCmdbs.destroy(m_ctx->m_alloc);
+	m_ctx->m_submits.destroy(m_ctx->m_alloc);
+	m_ctx->m_secondLevelTasks.destroy(m_ctx->m_alloc);
 
 	m_ctx->m_alloc = StackAllocator<U8>();
 	m_ctx = nullptr;
@@ -379,25 +469,18 @@ TexturePtr RenderGraph::getOrCreateRenderTarget(const TextureInitInfo& initInf,
 }
 
 FramebufferPtr RenderGraph::getOrCreateFramebuffer(
-	const FramebufferDescription& fbDescr, const RenderTargetHandle* rtHandles, CString name, Bool& drawsToPresentable)
+	const FramebufferDescription& fbDescr, const RenderTargetHandle* rtHandles, CString name)
 {
 	ANKI_ASSERT(rtHandles);
 	U64 hash = fbDescr.m_hash;
 	ANKI_ASSERT(hash > 0);
 
-	drawsToPresentable = false;
-
 	// Create a hash that includes the render targets
-	Array<U64, MAX_COLOR_ATTACHMENTS + 1> uuids;
+	Array<U64, MAX_COLOR_ATTACHMENTS + 2> uuids;
 	U count = 0;
 	for(U i = 0; i < fbDescr.m_colorAttachmentCount; ++i)
 	{
 		uuids[count++] = m_ctx->m_rts[rtHandles[i].m_idx].m_texture->getUuid();
-
-		if(!!(m_ctx->m_rts[rtHandles[i].m_idx].m_texture->getTextureUsage() & TextureUsageBit::PRESENT))
-		{
-			drawsToPresentable = true;
-		}
 	}
 
 	if(!!fbDescr.m_depthStencilAttachment.m_aspect)
@@ -405,6 +488,11 @@ FramebufferPtr RenderGraph::getOrCreateFramebuffer(
 		uuids[count++] = m_ctx->m_rts[rtHandles[MAX_COLOR_ATTACHMENTS].m_idx].m_texture->getUuid();
 	}
 
+	if(fbDescr.m_shadingRateAttachmentTexelWidth > 0)
+	{
+		uuids[count++] = m_ctx->m_rts[rtHandles[MAX_COLOR_ATTACHMENTS + 1].m_idx].m_texture->getUuid();
+	}
+
 	hash = appendHash(&uuids[0], sizeof(U64) * count, hash);
 
 	FramebufferPtr fb;
@@ -455,6 +543,17 @@ FramebufferPtr RenderGraph::getOrCreateFramebuffer(
 			outAtt.m_textureView = view;
 		}
 
+		if(fbDescr.m_shadingRateAttachmentTexelWidth > 0)
+		{
+			ANKI_ASSERT(rtHandles[MAX_COLOR_ATTACHMENTS + 1].isValid() && "Forgot to set the shading rate image");
+			TextureViewInitInfo viewInit(m_ctx->m_rts[rtHandles[MAX_COLOR_ATTACHMENTS + 1].m_idx].m_texture,
+				TextureSubresourceInfo(TextureSurfaceInfo(0, 0, 0, 0)),
+				"RenderGraph SRI");
+			fbInit.m_shadingRateAttachment = getManager().newTextureView(viewInit);
+			fbInit.m_shadingRateAttachmentTexelWidth = fbDescr.m_shadingRateAttachmentTexelWidth;
+			fbInit.m_shadingRateAttachmentTexelHeight = fbDescr.m_shadingRateAttachmentTexelHeight;
+		}
+
 		// Set FB name
 		Array<char, MAX_GR_OBJECT_NAME_LENGTH + 1> cutName;
 		const U cutNameLen = min<U>(name.getLength(), MAX_GR_OBJECT_NAME_LENGTH);
@@ -572,6 +671,16 @@ Bool RenderGraph::passADependsOnB(const RenderPassDescriptionBase& a, const Rend
 	return false;
 }
 
+Bool RenderGraph::passesShareResources(const RenderPassDescriptionBase& a, const RenderPassDescriptionBase& b)
+{
+	const BitSet<MAX_RENDER_GRAPH_RENDER_TARGETS, U64> rts =
+		(a.m_readRtMask | a.m_writeRtMask) & (b.m_readRtMask | b.m_writeRtMask);
+	const BitSet<MAX_RENDER_GRAPH_BUFFERS, U64> buffs =
+		(a.m_readBuffMask | a.m_writeBuffMask) & (b.m_readBuffMask | b.m_writeBuffMask);
+
+	return rts.getAny() || buffs.getAny();
+}
+
 Bool RenderGraph::passHasUnmetDependencies(const BakeContext& ctx, U32 passIdx)
 {
 	Bool depends = false;
@@ -613,31 +722,19 @@ RenderGraph::BakeContext* RenderGraph::newContext(const RenderGraphDescription&
 		const RenderGraphDescription::RT& inRt = descr.m_renderTargets[rtIdx];
 
 		const Bool imported = inRt.m_importedTex.isCreated();
-		if(imported)
+		outRt.m_imported = imported;
+		if(!imported)
 		{
-			// It's imported
-			outRt.m_texture = inRt.m_importedTex;
+			// Will be created when the batches are known, see initRenderTargets()
+			continue;
 		}
-		else
-		{
-			// Need to create new
-
-			// Create a new TextureInitInfo with the derived usage
-			TextureInitInfo initInf = inRt.m_initInfo;
-			initInf.m_usage = inRt.m_usageDerivedByDeps;
-			ANKI_ASSERT(initInf.m_usage != TextureUsageBit::NONE);
 
-			// Create the new hash
-			const U64 hash = appendHash(&initInf.m_usage, sizeof(initInf.m_usage), inRt.m_hash);
-
-			// Get or create the texture
-			outRt.m_texture = getOrCreateRenderTarget(initInf, hash);
-		}
+		outRt.m_texture = inRt.m_importedTex;
 
 		// Init the usage
 		const U32 surfOrVolumeCount = getTextureSurfOrVolCount(outRt.m_texture);
 		outRt.m_surfOrVolUsages.create(alloc, surfOrVolumeCount, TextureUsageBit::NONE);
-		if(imported && inRt.m_importedAndUndefinedUsage)
+		if(inRt.m_importedAndUndefinedUsage)
 		{
 			// Get the usage from previous frames
 
@@ -654,7 +751,7 @@ RenderGraph::BakeContext* RenderGraph::newContext(const RenderGraphDescription&
 				outRt.m_surfOrVolUsages[surfOrVolIdx] = it->m_surfOrVolLastUsages[surfOrVolIdx];
 			}
 		}
-		else if(imported)
+		else
 		{
 			// Set the usage that was given by the user
 			for(U32 surfOrVolIdx = 0; surfOrVolIdx < surfOrVolumeCount; ++surfOrVolIdx)
@@ -664,7 +761,7 @@ RenderGraph::BakeContext* RenderGraph::newContext(const RenderGraphDescription&
 		}
 
 		outRt.m_lastBatchThatTransitionedIt.create(alloc, surfOrVolumeCount, MAX_U16);
-		outRt.m_imported = imported;
+		outRt.m_lastBatchThatUsedIt.create(alloc, surfOrVolumeCount, MAX_U16);
 	}
 
 	// Buffers
@@ -677,11 +774,76 @@ RenderGraph::BakeContext* RenderGraph::newContext(const RenderGraphDescription&
 	}
 
 	ctx->m_gatherStatistics = descr.m_gatherStatistics;
+	ctx->m_renderTargetAliasing = descr.m_renderTargetAliasing;
+	ctx->m_splitBarriers = descr.m_splitBarriers;
+	ctx->m_gatherPassTimestamps = descr.m_gatherStatistics && descr.m_gatherPassStatistics;
+#if ANKI_ENABLE_TRACE
+	ctx->m_gatherPassTimestamps =
+		ctx->m_gatherPassTimestamps || (descr.m_gatherStatistics && TracerSingleton::get().getEnabled());
+#endif
 
 	return ctx;
 }
 
-void RenderGraph::initRenderPassesAndSetDeps(const RenderGraphDescription& descr, StackAllocator<U8>& alloc)
+U64 RenderGraph::computeTopologyHash(const RenderGraphDescription& descr)
+{
+	ANKI_BEGIN_PACKED_STRUCT
+	struct PassInfo
+	{
+		U32 m_rtDepCount;
+		U32 m_buffDepCount;
+		U32 m_asyncCompute;
+	};
+
+	struct RtDepInfo
+	{
+		U64 m_subresourceHash;
+		U32 m_idx;
+		U32 m_usage;
+	};
+
+	struct BuffDepInfo
+	{
+		U64 m_usage;
+		U32 m_idx;
+	};
+	ANKI_END_PACKED_STRUCT
+
+	const U32 passCount = descr.m_passes.getSize();
+	U64 hash = computeHash(&passCount, sizeof(passCount));
+
+	for(const RenderPassDescriptionBase* pass : descr.m_passes)
+	{
+		PassInfo passInfo;
+		passInfo.m_rtDepCount = pass->m_rtDeps.getSize();
+		passInfo.m_buffDepCount = pass->m_buffDeps.getSize();
+		passInfo.m_asyncCompute = pass->m_asyncCompute;
+		hash = appendHash(&passInfo, sizeof(passInfo), hash);
+
+		for(const RenderPassDependency& dep : pass->m_rtDeps)
+		{
+			RtDepInfo depInfo;
+			depInfo.m_subresourceHash = dep.m_texture.m_subresource.computeHash();
+			depInfo.m_idx = dep.m_texture.m_handle.m_idx;
+			depInfo.m_usage = U32(dep.m_texture.m_usage);
+			hash = appendHash(&depInfo, sizeof(depInfo), hash);
+		}
+
+		for(const RenderPassDependency& dep : pass->m_buffDeps)
+		{
+			BuffDepInfo depInfo;
+			depInfo.m_usage = U64(dep.m_buffer.m_usage);
+			depInfo.m_idx = dep.m_buffer.m_handle.m_idx;
+			hash = appendHash(&depInfo, sizeof(depInfo), hash);
+		}
+	}
+
+	// Zero means nothing is cached
+	return max<U64>(hash, 1);
+}
+
+void RenderGraph::initRenderPassesAndSetDeps(
+	const RenderGraphDescription& descr, StackAllocator<U8>& alloc, Bool cached)
 {
 	BakeContext& ctx = *m_ctx;
 	const U32 passCount = descr.m_passes.getSize();
@@ -696,6 +858,14 @@ void RenderGraph::initRenderPassesAndSetDeps(const RenderGraphDescription& descr
 		outPass.m_callback = inPass.m_callback;
 		outPass.m_userData = inPass.m_userData;
 
+		const PtrSize nameSize = inPass.m_name.getLength() + 1;
+		char* name = alloc.newArray<char>(nameSize);
+		memcpy(name, inPass.m_name.cstr(), nameSize);
+		outPass.m_name = name;
+		outPass.m_beginTimestamp = inPass.m_beginTimestamp;
+		outPass.m_endTimestamp = inPass.m_endTimestamp;
+		outPass.m_asyncCompute = inPass.m_asyncCompute && getManager().getDeviceCapabilities().m_asyncCompute;
+
 		// Create consumer info
 		outPass.m_consumedTextures.resize(alloc, inPass.m_rtDeps.getSize());
 		for(U32 depIdx = 0; depIdx < inPass.m_rtDeps.getSize(); ++depIdx)
@@ -709,106 +879,450 @@ void RenderGraph::initRenderPassesAndSetDeps(const RenderGraphDescription& descr
 			memcpy(&inf, &inDep.m_texture, sizeof(inf));
 		}
 
-		// Create command buffers and framebuffer
+		// Find if it draws to the swapchain. Only imported RTs can be presentable
 		if(inPass.m_type == RenderPassDescriptionBase::Type::GRAPHICS)
 		{
 			const GraphicsRenderPassDescription& graphicsPass =
 				static_cast<const GraphicsRenderPassDescription&>(inPass);
 
-			if(graphicsPass.hasFramebuffer())
-			{
-				Bool drawsToPresentable;
-				outPass.fb() = getOrCreateFramebuffer(
-					graphicsPass.m_fbDescr, &graphicsPass.m_rtHandles[0], inPass.m_name.cstr(), drawsToPresentable);
-
-				outPass.m_fbRenderArea = graphicsPass.m_fbRenderArea;
-				outPass.m_drawsToPresentable = drawsToPresentable;
-			}
-			else
+			for(U32 i = 0; graphicsPass.hasFramebuffer() && i < graphicsPass.m_fbDescr.m_colorAttachmentCount; ++i)
 			{
-				ANKI_ASSERT(inPass.m_secondLevelCmdbsCount == 0 && "Can't have second level cmdbs");
+				const RT& rt = ctx.m_rts[graphicsPass.m_rtHandles[i].m_idx];
+				if(rt.m_imported && !!(rt.m_texture->getTextureUsage() & TextureUsageBit::PRESENT))
+				{
+					outPass.m_drawsToPresentable = true;
+				}
 			}
 		}
-		else
+
+		// Set dependencies by checking all previous subpasses. The passes of different queues might use the same
+		// resource at the same time so be conservative with them and make them depend on every shared resource
+		if(cached)
 		{
-			ANKI_ASSERT(inPass.m_secondLevelCmdbsCount == 0 && "Can't have second level cmdbs");
+			const U32 first = m_compiledGraphCache.m_dependsOnOffsets[passIdx];
+			const U32 count = m_compiledGraphCache.m_dependsOnOffsets[passIdx + 1] - first;
+			if(count)
+			{
+				outPass.m_dependsOn.create(alloc, count);
+				memcpy(&outPass.m_dependsOn[0], &m_compiledGraphCache.m_dependsOn[first], sizeof(U32) * count);
+			}
+
+			continue;
 		}
 
-		// Set dependencies by checking all previous subpasses.
 		U32 prevPassIdx = passIdx;
 		while(prevPassIdx--)
 		{
 			const RenderPassDescriptionBase& prevPass = *descr.m_passes[prevPassIdx];
-			if(passADependsOnB(inPass, prevPass))
+			const Bool differentQueues = outPass.m_asyncCompute != ctx.m_passes[prevPassIdx].m_asyncCompute;
+			if(passADependsOnB(inPass, prevPass) || (differentQueues && passesShareResources(inPass, prevPass)))
 			{
 				outPass.m_dependsOn.emplaceBack(alloc, prevPassIdx);
 			}
 		}
 	}
+
+	// Store the dependencies for the next frames
+	if(!cached)
+	{
+		U32 depCount = 0;
+		for(const Pass& pass : ctx.m_passes)
+		{
+			depCount += pass.m_dependsOn.getSize();
+		}
+
+		m_compiledGraphCache.m_dependsOn.resize(getAllocator(), depCount);
+		m_compiledGraphCache.m_dependsOnOffsets.resize(getAllocator(), passCount + 1);
+		depCount = 0;
+		for(U32 passIdx = 0; passIdx < passCount; ++passIdx)
+		{
+			m_compiledGraphCache.m_dependsOnOffsets[passIdx] = depCount;
+			for(U32 depPassIdx : ctx.m_passes[passIdx].m_dependsOn)
+			{
+				m_compiledGraphCache.m_dependsOn[depCount++] = depPassIdx;
+			}
+		}
+		m_compiledGraphCache.m_dependsOnOffsets[passCount] = depCount;
+	}
 }
 
-void RenderGraph::initBatches()
+void RenderGraph::initBatches(Bool cached)
 {
 	ANKI_ASSERT(m_ctx);
 
 	U passesAssignedToBatchCount = 0;
 	const U passCount = m_ctx->m_passes.getSize();
 	ANKI_ASSERT(passCount > 0);
-	Bool setTimestamp = m_ctx->m_gatherStatistics;
-	while(passesAssignedToBatchCount < passCount)
-	{
-		m_ctx->m_batches.emplaceBack(m_ctx->m_alloc);
-		Batch& batch = m_ctx->m_batches.getBack();
 
-		Bool drawsToPresentable = false;
+	if(!cached)
+	{
+		m_compiledGraphCache.m_passWaves.resize(getAllocator(), U32(passCount));
+	}
 
+	U32 wave = 0;
+	while(passesAssignedToBatchCount < passCount)
+	{
+		// Gather the passes that their dependencies are met
+		DynamicArrayAuto<U32> readyPasses(m_ctx->m_alloc);
 		for(U32 i = 0; i < passCount; ++i)
 		{
-			if(!m_ctx->m_passIsInBatch.get(i) && !passHasUnmetDependencies(*m_ctx, i))
+			if(cached)
+			{
+				if(m_compiledGraphCache.m_passWaves[i] == wave)
+				{
+					readyPasses.emplaceBack(i);
+				}
+			}
+			else if(!m_ctx->m_passIsInBatch.get(i) && !passHasUnmetDependencies(*m_ctx, i))
+			{
+				readyPasses.emplaceBack(i);
+				m_compiledGraphCache.m_passWaves[i] = wave;
+			}
+		}
+		++wave;
+
+		// The ready passes don't depend on each other. Create one batch for the graphics queue and one for the async
+		// compute
+		for(Bool asyncCompute : {false, true})
+		{
+			Bool drawsToPresentable = false;
+			DynamicArray<U32> passIndices;
+			for(U32 passIdx : readyPasses)
+			{
+				const Pass& pass = m_ctx->m_passes[passIdx];
+				if(pass.m_asyncCompute == asyncCompute)
+				{
+					passIndices.emplaceBack(m_ctx->m_alloc, passIdx);
+
+					// Will batch draw to the swapchain?
+					drawsToPresentable = drawsToPresentable || pass.m_drawsToPresentable;
+				}
+			}
+
+			if(passIndices.getSize() == 0)
+			{
+				continue;
+			}
+
+			passesAssignedToBatchCount += passIndices.getSize();
+
+			m_ctx->m_batches.emplaceBack(m_ctx->m_alloc);
+			Batch& batch = m_ctx->m_batches.getBack();
+			batch.m_passIndices = std::move(passIndices);
+			batch.m_asyncCompute = asyncCompute;
+
+			// Find the latest submit of the other queue the batch depends on
+			U32 waitSubmit = MAX_U32;
+			for(U32 passIdx : batch.m_passIndices)
+			{
+				for(U32 depPassIdx : m_ctx->m_passes[passIdx].m_dependsOn)
+				{
+					const Batch& depBatch = m_ctx->m_batches[m_ctx->m_passes[depPassIdx].m_batchIdx];
+					if(depBatch.m_asyncCompute != asyncCompute
+						&& (waitSubmit == MAX_U32 || depBatch.m_submitIdx > waitSubmit))
+					{
+						waitSubmit = depBatch.m_submitIdx;
+					}
+				}
+			}
+
+			// The async work of this frame might overwrite what the graphics of the previous frame read. Make the first
+			// async submit wait for the graphics queue
+			if(asyncCompute && m_ctx->m_crntSubmit[asyncCompute] == MAX_U32
+				&& m_ctx->m_lastWaitedSubmit[asyncCompute] == MAX_U32 && waitSubmit == MAX_U32)
+			{
+				if(m_ctx->m_lastGraphicsSubmit == MAX_U32)
+				{
+					newSubmit(false, MAX_U32);
+				}
+
+				waitSubmit = m_ctx->m_lastGraphicsSubmit;
+			}
+
+			// Waiting a submit covers the submits before it
+			const U32 lastWaited = m_ctx->m_lastWaitedSubmit[asyncCompute];
+			if(waitSubmit != MAX_U32 && lastWaited != MAX_U32 && waitSubmit <= lastWaited)
+			{
+				waitSubmit = MAX_U32;
+			}
+
+			// Create a new submit if the batch needs to wait the other queue. Also create a new one if the batch is
+			// writing to swapchain. This will help Vulkan to have a dependency of the swap chain image acquire to the
+			// 2nd command buffer instead of adding it to a single big cmdb.
+			if(m_ctx->m_crntSubmit[asyncCompute] == MAX_U32 || waitSubmit != MAX_U32 || drawsToPresentable)
 			{
-				// Add to the batch
-				++passesAssignedToBatchCount;
-				batch.m_passIndices.emplaceBack(m_ctx->m_alloc, i);
+				newSubmit(asyncCompute, waitSubmit);
+			}
+
+			batch.m_submitIdx = m_ctx->m_crntSubmit[asyncCompute];
+			batch.m_cmdb = m_ctx->m_submits[batch.m_submitIdx].m_cmdb.get();
+
+			for(U32 passIdx : batch.m_passIndices)
+			{
+				m_ctx->m_passes[passIdx].m_batchIdx = m_ctx->m_batches.getSize() - 1;
+			}
+		}
+
+		// Mark batch's passes done
+		for(U32 passIdx : readyPasses)
+		{
+			m_ctx->m_passIsInBatch.set(passIdx);
+		}
+	}
+
+	// The graphics queue should wait all the async work of the frame before the next frame starts
+	const U32 lastAsyncSubmit = m_ctx->m_crntSubmit[true];
+	ANKI_ASSERT(lastAsyncSubmit == MAX_U32 || m_ctx->m_submits[lastAsyncSubmit].m_asyncCompute);
+	const U32 lastWaited = m_ctx->m_lastWaitedSubmit[false];
+	if(lastAsyncSubmit != MAX_U32 && (lastWaited == MAX_U32 || lastWaited < lastAsyncSubmit))
+	{
+		newSubmit(false, lastAsyncSubmit);
+	}
+}
+
+U32 RenderGraph::newSubmit(Bool asyncCompute, U32 waitSubmit)
+{
+	BakeContext& ctx = *m_ctx;
+
+	if(waitSubmit != MAX_U32)
+	{
+		Submit& other = ctx.m_submits[waitSubmit];
+		ANKI_ASSERT(other.m_asyncCompute != asyncCompute);
+		other.m_signal = true;
+
+		// Can't add more work to the waited submit
+		if(ctx.m_crntSubmit[other.m_asyncCompute] == waitSubmit)
+		{
+			ctx.m_crntSubmit[other.m_asyncCompute] = MAX_U32;
+		}
+
+		ctx.m_lastWaitedSubmit[asyncCompute] = waitSubmit;
+	}
+
+	CommandBufferInitInfo cmdbInit;
+	cmdbInit.m_flags = (asyncCompute) ? (CommandBufferFlag::COMPUTE_WORK | CommandBufferFlag::ASYNC_COMPUTE_WORK)
+									  : (CommandBufferFlag::COMPUTE_WORK | CommandBufferFlag::GRAPHICS_WORK);
+	CommandBufferPtr cmdb = getManager().newCommandBuffer(cmdbInit);
+
+	// Maybe write a timestamp at the beginning of the frame
+	if(ANKI_UNLIKELY(ctx.m_gatherStatistics && ctx.m_submits.getSize() == 0))
+	{
+		ANKI_ASSERT(!asyncCompute);
+		TimestampQueryPtr query = getManager().newTimestampQuery();
+		cmdb->writeTimestamp(query);
+
+		m_statistics.m_nextTimestamp = (m_statistics.m_nextTimestamp + 1) % MAX_TIMESTAMPS_BUFFERED;
+
+		// The frame that used that slot is old enough, write its pass timestamps before overwriting it
+		flushPassTimestamps(m_statistics.m_nextTimestamp);
+
+		m_statistics.m_timestamps[m_statistics.m_nextTimestamp * 2] = query;
+	}
+
+	ctx.m_submits.emplaceBack(ctx.m_alloc);
+	Submit& submit = ctx.m_submits.getBack();
+	submit.m_cmdb = cmdb;
+	submit.m_waitSubmit = waitSubmit;
+	submit.m_asyncCompute = asyncCompute;
+
+	const U32 submitIdx = ctx.m_submits.getSize() - 1;
+	ctx.m_crntSubmit[asyncCompute] = submitIdx;
+	if(!asyncCompute)
+	{
+		ctx.m_lastGraphicsSubmit = submitIdx;
+	}
+
+	return submitIdx;
+}
+
+void RenderGraph::initRenderTargets(const RenderGraphDescription& descr)
+{
+	BakeContext& ctx = *m_ctx;
+	const U32 rtCount = ctx.m_rts.getSize();
+
+	// Create the init infos of the transient RTs with the derived usage
+	DynamicArrayAuto<TextureInitInfo> initInfos(ctx.m_alloc);
+	DynamicArrayAuto<U64> hashes(ctx.m_alloc);
+	initInfos.create(rtCount);
+	hashes.create(rtCount, 0);
+	for(U32 rtIdx = 0; rtIdx < rtCount; ++rtIdx)
+	{
+		if(ctx.m_rts[rtIdx].m_imported)
+		{
+			continue;
+		}
+
+		const RenderGraphDescription::RT& inRt = descr.m_renderTargets[rtIdx];
+		initInfos[rtIdx] = inRt.m_initInfo;
+		initInfos[rtIdx].m_usage = inRt.m_usageDerivedByDeps;
+		ANKI_ASSERT(initInfos[rtIdx].m_usage != TextureUsageBit::NONE);
+
+		hashes[rtIdx] = appendHash(&initInfos[rtIdx].m_usage, sizeof(initInfos[rtIdx].m_usage), inRt.m_hash);
+	}
+
+	if(ctx.m_renderTargetAliasing)
+	{
+		aliasRenderTargets(descr, WeakArray<TextureInitInfo>(initInfos), WeakArray<U64>(hashes));
+	}
+
+	// Get or create the textures
+	for(U32 rtIdx = 0; rtIdx < rtCount; ++rtIdx)
+	{
+		RT& rt = ctx.m_rts[rtIdx];
+		if(rt.m_imported)
+		{
+			continue;
+		}
+
+		rt.m_texture = getOrCreateRenderTarget(initInfos[rtIdx], hashes[rtIdx]);
+
+		const U32 surfOrVolumeCount = getTextureSurfOrVolCount(rt.m_texture);
+		rt.m_surfOrVolUsages.create(ctx.m_alloc, surfOrVolumeCount, TextureUsageBit::NONE);
+		rt.m_lastBatchThatTransitionedIt.create(ctx.m_alloc, surfOrVolumeCount, MAX_U16);
+		rt.m_lastBatchThatUsedIt.create(ctx.m_alloc, surfOrVolumeCount, MAX_U16);
+	}
+}
+
+void RenderGraph::aliasRenderTargets(
+	const RenderGraphDescription& descr, WeakArray<TextureInitInfo> initInfos, WeakArray<U64> hashes)
+{
+	BakeContext& ctx = *m_ctx;
+	const U32 rtCount = ctx.m_rts.getSize();
 
-				// Will batch draw to the swapchain?
-				drawsToPresentable = drawsToPresentable || m_ctx->m_passes[i].m_drawsToPresentable;
+	class Lifetime
+	{
+	public:
+		U32 m_firstBatch = MAX_U32;
+		U32 m_lastBatch = 0;
+		PtrSize m_offset = 0;
+		PtrSize m_size = 0;
+		PtrSize m_alignment = 0;
+		Bool m_asyncCompute = false;
+	};
+
+	// Find the batches every RT is alive. The batches of the graphics queue run in order
+	DynamicArrayAuto<Lifetime> lifetimes(ctx.m_alloc);
+	lifetimes.create(rtCount);
+	for(U32 batchIdx = 0; batchIdx < ctx.m_batches.getSize(); ++batchIdx)
+	{
+		const Batch& batch = ctx.m_batches[batchIdx];
+		for(U32 passIdx : batch.m_passIndices)
+		{
+			for(const RenderPassDependency& dep : descr.m_passes[passIdx]->m_rtDeps)
+			{
+				Lifetime& lifetime = lifetimes[dep.m_texture.m_handle.m_idx];
+				lifetime.m_firstBatch = min(lifetime.m_firstBatch, batchIdx);
+				lifetime.m_lastBatch = max(lifetime.m_lastBatch, batchIdx);
+				lifetime.m_asyncCompute = lifetime.m_asyncCompute || batch.m_asyncCompute;
 			}
 		}
+	}
+
+	// Gather the RTs that can be aliased. The async compute runs in parallel to the graphics batches so skip the RTs
+	// it touches. Skip the mipmap generation as well since it transitions the mips on its own
+	DynamicArrayAuto<U32> aliasedRts(ctx.m_alloc);
+	for(U32 rtIdx = 0; rtIdx < rtCount; ++rtIdx)
+	{
+		Lifetime& lifetime = lifetimes[rtIdx];
+		if(ctx.m_rts[rtIdx].m_imported || lifetime.m_firstBatch == MAX_U32 || lifetime.m_asyncCompute
+			|| !!(initInfos[rtIdx].m_usage & TextureUsageBit::GENERATE_MIPMAPS))
+		{
+			continue;
+		}
 
-		// Get or create cmdb for the batch.
-		// Create a new cmdb if the batch is writing to swapchain. This will help Vulkan to have a dependency of the
-		// swap chain image acquire to the 2nd command buffer instead of adding it to a single big cmdb.
-		if(m_ctx->m_graphicsCmdbs.isEmpty() || drawsToPresentable)
+		auto it = m_rtMemoryRequirements.find(hashes[rtIdx]);
+		if(it == m_rtMemoryRequirements.getEnd())
 		{
-			CommandBufferInitInfo cmdbInit;
-			cmdbInit.m_flags = CommandBufferFlag::COMPUTE_WORK | CommandBufferFlag::GRAPHICS_WORK;
-			CommandBufferPtr cmdb = getManager().newCommandBuffer(cmdbInit);
+			RenderTargetMemoryRequirements req;
+			getManager().getTextureMemoryRequirements(initInfos[rtIdx], req.m_size, req.m_alignment);
+			it = m_rtMemoryRequirements.emplace(getAllocator(), hashes[rtIdx], req);
+		}
+
+		if(it->m_size == 0)
+		{
+			continue;
+		}
+
+		lifetime.m_size = it->m_size;
+		lifetime.m_alignment = it->m_alignment;
+		aliasedRts.emplaceBack(rtIdx);
+	}
+
+	if(aliasedRts.getSize() < 2)
+	{
+		return;
+	}
 
-			m_ctx->m_graphicsCmdbs.emplaceBack(m_ctx->m_alloc, cmdb);
+	// Place the biggest first. Every RT goes to the lowest offset that doesn't overlap the memory of the placed RTs
+	// that are alive at the same time
+	std::sort(aliasedRts.getBegin(), aliasedRts.getEnd(), [&](U32 a, U32 b) {
+		return lifetimes[a].m_size > lifetimes[b].m_size;
+	});
 
-			batch.m_cmdb = cmdb.get();
+	PtrSize heapSize = 0;
+	for(U32 i = 0; i < aliasedRts.getSize(); ++i)
+	{
+		Lifetime& crnt = lifetimes[aliasedRts[i]];
 
-			// Maybe write a timestamp
-			if(ANKI_UNLIKELY(setTimestamp))
+		Bool placed = false;
+		while(!placed)
+		{
+			placed = true;
+			for(U32 j = 0; j < i; ++j)
 			{
-				setTimestamp = false;
-				TimestampQueryPtr query = getManager().newTimestampQuery();
-				cmdb->writeTimestamp(query);
+				const Lifetime& other = lifetimes[aliasedRts[j]];
+				const Bool aliveTogether =
+					crnt.m_firstBatch <= other.m_lastBatch && other.m_firstBatch <= crnt.m_lastBatch;
+				const Bool overlapping =
+					crnt.m_offset < other.m_offset + other.m_size && other.m_offset < crnt.m_offset + crnt.m_size;
 
-				m_statistics.m_nextTimestamp = (m_statistics.m_nextTimestamp + 1) % MAX_TIMESTAMPS_BUFFERED;
-				m_statistics.m_timestamps[m_statistics.m_nextTimestamp * 2] = query;
+				if(aliveTogether && overlapping)
+				{
+					// Move after it and check again
+					crnt.m_offset = getAlignedRoundUp(crnt.m_alignment, other.m_offset + other.m_size);
+					placed = false;
+				}
 			}
 		}
-		else
+
+		heapSize = max(heapSize, crnt.m_offset + crnt.m_size);
+	}
+
+	// Grow the heap if needed. The RTs of the older heaps keep them alive until they are cleaned
+	if(!m_aliasingHeap.isCreated() || m_aliasingHeap->getSize() < heapSize)
+	{
+		TextureHeapInitInfo heapInit("RenderGraph");
+		heapInit.m_size = getAlignedRoundUp(ALIASING_HEAP_SIZE_GRANULARITY, heapSize);
+		m_aliasingHeap = getManager().newTextureHeap(heapInit);
+
+		if(!m_aliasingHeap.isCreated())
 		{
-			batch.m_cmdb = m_ctx->m_graphicsCmdbs.getBack().get();
+			ANKI_GR_LOGW("Failed to create the heap of the aliased render targets");
+			return;
 		}
+	}
 
-		// Mark batch's passes done
-		for(U32 passIdx : m_ctx->m_batches.getBack().m_passIndices)
+	// Place the RTs to the heap and find which RTs used their memory before them
+	for(U32 rtIdx : aliasedRts)
+	{
+		const Lifetime& crnt = lifetimes[rtIdx];
+
+		initInfos[rtIdx].m_heap = m_aliasingHeap;
+		initInfos[rtIdx].m_heapOffset = crnt.m_offset;
+
+		const Array<U64, 2> placement = {{m_aliasingHeap->getUuid(), crnt.m_offset}};
+		hashes[rtIdx] = appendHash(&placement[0], sizeof(placement), hashes[rtIdx]);
+
+		for(U32 otherRtIdx : aliasedRts)
 		{
-			m_ctx->m_passIsInBatch.set(passIdx);
-			m_ctx->m_passes[passIdx].m_batchIdx = m_ctx->m_batches.getSize() - 1;
+			const Lifetime& other = lifetimes[otherRtIdx];
+			const Bool overlapping =
+				crnt.m_offset < other.m_offset + other.m_size && other.m_offset < crnt.m_offset + crnt.m_size;
+
+			if(other.m_lastBatch < crnt.m_firstBatch && overlapping)
+			{
+				ctx.m_rts[rtIdx].m_aliasedPredecessors.emplaceBack(ctx.m_alloc, otherRtIdx);
+			}
 		}
 	}
 }
@@ -832,6 +1346,10 @@ void RenderGraph::initGraphicsPasses(const RenderGraphDescription& descr, StackA
 
 			if(graphicsPass.hasFramebuffer())
 			{
+				outPass.fb() =
+					getOrCreateFramebuffer(graphicsPass.m_fbDescr, &graphicsPass.m_rtHandles[0], inPass.m_name.cstr());
+				outPass.m_fbRenderArea = graphicsPass.m_fbRenderArea;
+
 				// Init the usage bits
 				TextureUsageBit usage;
 				for(U i = 0; i < graphicsPass.m_fbDescr.m_colorAttachmentCount; ++i)
@@ -857,9 +1375,17 @@ void RenderGraph::initGraphicsPasses(const RenderGraphDescription& descr, StackA
 				}
 
 				// Do some pre-work for the second level command buffers
-				if(inPass.m_secondLevelCmdbsCount)
+				U32 secondLevelCmdbCount = inPass.m_secondLevelCmdbsCount;
+				if(secondLevelCmdbCount == RenderPassDescriptionBase::AUTO_SECOND_LEVEL_CMDB_COUNT)
+				{
+					secondLevelCmdbCount = inPass.m_secondLevelWorkEstimate / descr.m_minWorkPerSecondLevelCmdb;
+					secondLevelCmdbCount = clamp(secondLevelCmdbCount, 1u, descr.m_maxSecondLevelCmdbCount);
+				}
+
+				if(secondLevelCmdbCount)
 				{
-					outPass.m_secondLevelCmdbs.create(alloc, inPass.m_secondLevelCmdbsCount);
+					outPass.m_secondLevelCmdbs.create(alloc, secondLevelCmdbCount);
+					outPass.m_secondLevelCmdbCpuTimes.create(alloc, secondLevelCmdbCount, 0.0);
 					CommandBufferInitInfo& cmdbInit = outPass.m_secondLevelCmdbInitInfo;
 					cmdbInit.m_flags = CommandBufferFlag::GRAPHICS_WORK | CommandBufferFlag::SECOND_LEVEL;
 					ANKI_ASSERT(cmdbInit.m_framebuffer.isCreated());
@@ -902,6 +1428,30 @@ void RenderGraph::iterateSurfsOrVolumes(const TexturePtr& tex, const TextureSubr
 	}
 }
 
+Bool RenderGraph::canSplitBarrier(U32 beginBatchIdx, U32 endBatchIdx) const
+{
+	ANKI_ASSERT(beginBatchIdx < endBatchIdx);
+	const BakeContext& ctx = *m_ctx;
+
+	// Events can't synchronize different command buffers
+	const U32 submitIdx = ctx.m_batches[endBatchIdx].m_submitIdx;
+	if(ctx.m_batches[beginBatchIdx].m_submitIdx != submitIdx)
+	{
+		return false;
+	}
+
+	// Worth it only if there is some work in between
+	for(U32 batchIdx = beginBatchIdx + 1; batchIdx < endBatchIdx; ++batchIdx)
+	{
+		if(ctx.m_batches[batchIdx].m_submitIdx == submitIdx)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
 void RenderGraph::setTextureBarrier(Batch& batch, const RenderPassDependency& dep)
 {
 	ANKI_ASSERT(dep.m_isTexture);
@@ -912,6 +1462,16 @@ void RenderGraph::setTextureBarrier(Batch& batch, const RenderPassDependency& de
 	const TextureUsageBit depUsage = dep.m_texture.m_usage;
 	RT& rt = ctx.m_rts[rtIdx];
 
+	// The RTs that used the same memory before have their final usage by now
+	TextureUsageBit prevAliasesUsage = TextureUsageBit::NONE;
+	for(U32 aliasRtIdx : rt.m_aliasedPredecessors)
+	{
+		for(TextureUsageBit usage : ctx.m_rts[aliasRtIdx].m_surfOrVolUsages)
+		{
+			prevAliasesUsage |= usage;
+		}
+	}
+
 	iterateSurfsOrVolumes(
 		rt.m_texture, dep.m_texture.m_subresource, [&](U32 surfOrVolIdx, const TextureSurfaceInfo& surf) {
 			TextureUsageBit& crntUsage = rt.m_surfOrVolUsages[surfOrVolIdx];
@@ -940,15 +1500,32 @@ void RenderGraph::setTextureBarrier(Batch& batch, const RenderPassDependency& de
 				}
 				else
 				{
-					// Create a new barrier for this surface
-
-					batch.m_barriersBefore.emplaceBack(ctx.m_alloc, rtIdx, crntUsage, depUsage, surf);
+					// Create a new barrier for this surface. If it's the first use wait for the aliases as well
+
+					batch.m_barriersBefore.emplaceBack(ctx.m_alloc,
+						rtIdx,
+						crntUsage,
+						depUsage,
+						surf,
+						(crntUsage == TextureUsageBit::NONE) ? prevAliasesUsage : TextureUsageBit::NONE);
+
+					// Try to begin the barrier right after the batch that used the surface last
+					const U32 lastUsedBatchIdx = rt.m_lastBatchThatUsedIt[surfOrVolIdx];
+					if(ctx.m_splitBarriers && lastUsedBatchIdx < batchIdx
+						&& canSplitBarrier(lastUsedBatchIdx, batchIdx)
+						&& !(crntUsage & (TextureUsageBit::GENERATE_MIPMAPS | TextureUsageBit::PRESENT))
+						&& !(depUsage & TextureUsageBit::GENERATE_MIPMAPS))
+					{
+						batch.m_barriersBefore.getBack().m_texture.m_splitBarrierBatch = lastUsedBatchIdx;
+						ctx.m_batches[lastUsedBatchIdx].m_splitBarrierUsage |= crntUsage;
+					}
 
 					crntUsage = depUsage;
 					rt.m_lastBatchThatTransitionedIt[surfOrVolIdx] = U16(batchIdx);
 				}
 			}
 
+			rt.m_lastBatchThatUsedIt[surfOrVolIdx] = U16(batchIdx);
 			return true;
 		});
 }
@@ -1054,23 +1631,54 @@ void RenderGraph::setBatchBarriers(const RenderGraphDescription& descr)
 void RenderGraph::compileNewGraph(const RenderGraphDescription& descr, StackAllocator<U8>& alloc)
 {
 	ANKI_TRACE_SCOPED_EVENT(GR_RENDER_GRAPH_COMPILE);
+	const Second compileStartTime = HighRezTimer::getCurrentTime();
 
 	// Init the context
 	BakeContext& ctx = *newContext(descr, alloc);
 	m_ctx = &ctx;
 
+	// If the passes and their dependencies didn't change skip finding the dependencies and the batches
+	const U64 topologyHash = computeTopologyHash(descr);
+	const Bool cached = topologyHash == m_compiledGraphCache.m_hash;
+	m_compiledGraphCache.m_hash = 0; // Invalid until the new graph is stored
+
 	// Init the passes and find the dependencies between passes
-	initRenderPassesAndSetDeps(descr, alloc);
+	initRenderPassesAndSetDeps(descr, alloc, cached);
 
 	// Walk the graph and create pass batches
-	initBatches();
+	initBatches(cached);
+	m_compiledGraphCache.m_hash = topologyHash;
+
+	// Now that the lifetimes of the render targets are known create them
+	initRenderTargets(descr);
 
 	// Now that we know the batches every pass belongs init the graphics passes
 	initGraphicsPasses(descr, alloc);
 
+	// Distribute the second level command buffers to the threads
+	initSecondLevelTasks(descr, alloc);
+
 	// Create barriers between batches
 	setBatchBarriers(descr);
 
+	// Timestamps for the GPU timeline
+	if(ANKI_UNLIKELY(ctx.m_gatherPassTimestamps))
+	{
+		initPassTimestamps(descr);
+	}
+
+	if(ANKI_UNLIKELY(ctx.m_gatherStatistics))
+	{
+		m_statistics.m_barrierCount = 0;
+		for(const Batch& batch : ctx.m_batches)
+		{
+			m_statistics.m_barrierCount += batch.m_barriersBefore.getSize();
+		}
+	}
+
+	m_statistics.m_compileTime = HighRezTimer::getCurrentTime() - compileStartTime;
+	m_statistics.m_compiledGraphReused = cached;
+
 #if ANKI_DBG_RENDER_GRAPH
 	if(dumpDependencyDotFile(descr, ctx, "./"))
 	{
@@ -1079,6 +1687,83 @@ void RenderGraph::compileNewGraph(const RenderGraphDescription& descr, StackAllo
 #endif
 }
 
+void RenderGraph::initPassTimestamps(const RenderGraphDescription& descr)
+{
+	ANKI_ASSERT(m_ctx->m_gatherStatistics);
+	const U32 passCount = descr.m_passes.getSize();
+	DynamicArray<PassTimestamps>& timestamps = m_statistics.m_passTimestamps[m_statistics.m_nextTimestamp];
+	ANKI_ASSERT(timestamps.getSize() == 0);
+	timestamps.create(getAllocator(), passCount);
+
+	for(U32 passIdx = 0; passIdx < passCount; ++passIdx)
+	{
+		// Get the name
+		const CString name = descr.m_passes[passIdx]->m_name.toCString();
+		const U64 hash = computeHash(name.cstr(), name.getLength());
+		auto it = m_statistics.m_passNames.find(hash);
+		if(it == m_statistics.m_passNames.getEnd())
+		{
+			it = m_statistics.m_passNames.emplace(getAllocator(), hash);
+			it->create(getAllocator(), name);
+		}
+
+		PassTimestamps& out = timestamps[passIdx];
+		out.m_begin = getManager().newTimestampQuery();
+		out.m_end = getManager().newTimestampQuery();
+		out.m_name = it->cstr();
+	}
+}
+
+void RenderGraph::flushPassTimestamps(U32 frameSlot)
+{
+	DynamicArray<PassTimestamps>& timestamps = m_statistics.m_passTimestamps[frameSlot];
+	if(timestamps.getSize() == 0)
+	{
+		return;
+	}
+
+	// Keep the statistics of the passes
+	m_statistics.m_passes.resize(getAllocator(), timestamps.getSize());
+	for(U32 passIdx = 0; passIdx < timestamps.getSize(); ++passIdx)
+	{
+		const PassTimestamps& pass = timestamps[passIdx];
+		RenderGraphPassStatistics& out = m_statistics.m_passes[passIdx];
+
+		out = pass.m_cpuStats;
+		out.m_name = pass.m_name;
+
+		Second begin, end;
+		if(pass.m_begin->getResult(begin) == TimestampQueryResult::AVAILABLE
+			&& pass.m_end->getResult(end) == TimestampQueryResult::AVAILABLE && end > begin)
+		{
+			out.m_gpuTime = end - begin;
+		}
+	}
+
+#if ANKI_ENABLE_TRACE
+	// Align the GPU times to the CPU time. Assume that the GPU started working when the frame got submitted. Same as
+	// getStatistics()
+	Second frameStart;
+	if(TracerSingleton::get().getEnabled() && m_statistics.m_timestamps[frameSlot * 2]
+		&& m_statistics.m_timestamps[frameSlot * 2]->getResult(frameStart) == TimestampQueryResult::AVAILABLE)
+	{
+		const Second cpuFrameStart = m_statistics.m_cpuStartTimes[frameSlot];
+
+		for(const PassTimestamps& pass : timestamps)
+		{
+			Second begin, end;
+			if(pass.m_begin->getResult(begin) == TimestampQueryResult::AVAILABLE
+				&& pass.m_end->getResult(end) == TimestampQueryResult::AVAILABLE && end > begin)
+			{
+				TracerSingleton::get().addGpuEvent(pass.m_name, cpuFrameStart + (begin - frameStart), end - begin);
+			}
+		}
+	}
+#endif
+
+	timestamps.destroy(getAllocator());
+}
+
 TexturePtr RenderGraph::getTexture(RenderTargetHandle handle) const
 {
 	ANKI_ASSERT(m_ctx->m_rts[handle.m_idx].m_texture.isCreated());
@@ -1091,38 +1776,93 @@ BufferPtr RenderGraph::getBuffer(RenderPassBufferHandle handle) const
 	return m_ctx->m_buffers[handle.m_idx].m_buffer;
 }
 
-void RenderGraph::runSecondLevel(U32 threadIdx)
+void RenderGraph::initSecondLevelTasks(const RenderGraphDescription& descr, StackAllocator<U8>& alloc)
+{
+	BakeContext& ctx = *m_ctx;
+
+	U32 taskCount = 0;
+	for(const Pass& p : ctx.m_passes)
+	{
+		taskCount += p.m_secondLevelCmdbs.getSize();
+	}
+
+	if(taskCount == 0)
+	{
+		return;
+	}
+
+	ctx.m_secondLevelTasks.create(alloc, taskCount);
+	U32 taskIdx = 0;
+	for(U32 passIdx = 0; passIdx < ctx.m_passes.getSize(); ++passIdx)
+	{
+		const U32 cmdbCount = ctx.m_passes[passIdx].m_secondLevelCmdbs.getSize();
+		if(cmdbCount == 0)
+		{
+			continue;
+		}
+
+		// The passes that picked the command buffer count themselves have their own split, record them first
+		const RenderPassDescriptionBase& inPass = *descr.m_passes[passIdx];
+		const U32 cost = (inPass.m_secondLevelCmdbsCount == RenderPassDescriptionBase::AUTO_SECOND_LEVEL_CMDB_COUNT)
+							 ? inPass.m_secondLevelWorkEstimate / cmdbCount
+							 : MAX_U32;
+
+		for(U32 cmdbIdx = 0; cmdbIdx < cmdbCount; ++cmdbIdx)
+		{
+			SecondLevelTask& task = ctx.m_secondLevelTasks[taskIdx++];
+			task.m_passIdx = passIdx;
+			task.m_cmdbIdx = cmdbIdx;
+			task.m_cost = cost;
+		}
+	}
+
+	// Heaviest first so the light tasks fill the gaps at the end
+	std::stable_sort(ctx.m_secondLevelTasks.getBegin(),
+		ctx.m_secondLevelTasks.getEnd(),
+		[](const SecondLevelTask& a, const SecondLevelTask& b) { return a.m_cost > b.m_cost; });
+}
+
+void RenderGraph::runSecondLevel()
 {
 	ANKI_TRACE_SCOPED_EVENT(GR_RENDER_GRAPH_2ND_LEVEL);
 	ANKI_ASSERT(m_ctx);
 
 	RenderPassWorkContext ctx;
 	ctx.m_rgraph = this;
-	ctx.m_currentSecondLevelCommandBufferIndex = threadIdx;
 
-	for(Pass& p : m_ctx->m_passes)
+	const U32 taskCount = m_ctx->m_secondLevelTasks.getSize();
+	U32 taskIdx;
+	while((taskIdx = m_ctx->m_secondLevelTaskCounter.fetchAdd(1)) < taskCount)
 	{
-		const U32 size = p.m_secondLevelCmdbs.getSize();
-		if(threadIdx < size)
-		{
-			ANKI_ASSERT(!p.m_secondLevelCmdbs[threadIdx].isCreated());
-			p.m_secondLevelCmdbs[threadIdx] = getManager().newCommandBuffer(p.m_secondLevelCmdbInitInfo);
+		const SecondLevelTask& task = m_ctx->m_secondLevelTasks[taskIdx];
+		Pass& p = m_ctx->m_passes[task.m_passIdx];
+		const U32 cmdbIdx = task.m_cmdbIdx;
 
-			ctx.m_commandBuffer = p.m_secondLevelCmdbs[threadIdx];
-			ctx.m_secondLevelCommandBufferCount = size;
-			ctx.m_passIdx = U32(&p - &m_ctx->m_passes[0]);
-			ctx.m_batchIdx = p.m_batchIdx;
-			ctx.m_userData = p.m_userData;
+		ANKI_ASSERT(!p.m_secondLevelCmdbs[cmdbIdx].isCreated());
+		p.m_secondLevelCmdbs[cmdbIdx] = getManager().newCommandBuffer(p.m_secondLevelCmdbInitInfo);
 
-			ANKI_ASSERT(ctx.m_commandBuffer.isCreated());
+		ctx.m_commandBuffer = p.m_secondLevelCmdbs[cmdbIdx];
+		ctx.m_currentSecondLevelCommandBufferIndex = cmdbIdx;
+		ctx.m_secondLevelCommandBufferCount = p.m_secondLevelCmdbs.getSize();
+		ctx.m_passIdx = task.m_passIdx;
+		ctx.m_batchIdx = p.m_batchIdx;
+		ctx.m_userData = p.m_userData;
 
-			{
-				ANKI_TRACE_SCOPED_EVENT(GR_RENDER_GRAPH_CALLBACK);
-				p.m_callback(ctx);
-			}
+		ANKI_ASSERT(ctx.m_commandBuffer.isCreated());
 
-			ctx.m_commandBuffer->flush();
+		const Second startTime = (m_ctx->m_gatherPassTimestamps) ? HighRezTimer::getCurrentTime() : 0.0;
+
+		{
+			ANKI_TRACE_SCOPED_EVENT(GR_RENDER_GRAPH_CALLBACK);
+			p.m_callback(ctx);
+		}
+
+		if(ANKI_UNLIKELY(m_ctx->m_gatherPassTimestamps))
+		{
+			p.m_secondLevelCmdbCpuTimes[cmdbIdx] = HighRezTimer::getCurrentTime() - startTime;
 		}
+
+		ctx.m_commandBuffer->flush();
 	}
 }
 
@@ -1136,6 +1876,10 @@ void RenderGraph::run() const
 	ctx.m_currentSecondLevelCommandBufferIndex = 0;
 	ctx.m_secondLevelCommandBufferCount = 0;
 
+	// The split barriers that begin after each batch
+	DynamicArrayAuto<U32> splitBarriers(m_ctx->m_alloc);
+	splitBarriers.create(m_ctx->m_batches.getSize(), MAX_U32);
+
 	for(const Batch& batch : m_ctx->m_batches)
 	{
 		ctx.m_commandBuffer.reset(batch.m_cmdb);
@@ -1144,7 +1888,24 @@ void RenderGraph::run() const
 		// Set the barriers
 		for(const Barrier& barrier : batch.m_barriersBefore)
 		{
-			if(barrier.m_isTexture)
+			if(barrier.m_isTexture && !!barrier.m_texture.m_prevAliasesUsage)
+			{
+				ANKI_ASSERT(barrier.m_texture.m_usageBefore == TextureUsageBit::NONE);
+				const TexturePtr& tex = m_ctx->m_rts[barrier.m_texture.m_idx].m_texture;
+				cmdb->setTextureAliasingBarrier(tex,
+					barrier.m_texture.m_prevAliasesUsage,
+					barrier.m_texture.m_usageAfter,
+					TextureSubresourceInfo(barrier.m_texture.m_surface, tex->getDepthStencilAspect()));
+			}
+			else if(barrier.m_isTexture && barrier.m_texture.m_splitBarrierBatch != MAX_U32)
+			{
+				cmdb->setTextureSurfaceSplitBarrier(splitBarriers[barrier.m_texture.m_splitBarrierBatch],
+					m_ctx->m_rts[barrier.m_texture.m_idx].m_texture,
+					barrier.m_texture.m_usageBefore,
+					barrier.m_texture.m_usageAfter,
+					barrier.m_texture.m_surface);
+			}
+			else if(barrier.m_isTexture)
 			{
 				cmdb->setTextureSurfaceBarrier(m_ctx->m_rts[barrier.m_texture.m_idx].m_texture,
 					barrier.m_texture.m_usageBefore,
@@ -1164,7 +1925,23 @@ void RenderGraph::run() const
 		// Call the passes
 		for(U32 passIdx : batch.m_passIndices)
 		{
-			const Pass& pass = m_ctx->m_passes[passIdx];
+			Pass& pass = m_ctx->m_passes[passIdx];
+
+			// Tell the GPU where it is. It's reported if the device gets lost
+			cmdb->beginBreadcrumb(pass.m_name);
+
+			// Can't write timestamps inside the render pass
+			const PassTimestamps* timestamps = nullptr;
+			if(ANKI_UNLIKELY(m_ctx->m_gatherPassTimestamps))
+			{
+				timestamps = &m_statistics.m_passTimestamps[m_statistics.m_nextTimestamp][passIdx];
+				cmdb->writeTimestamp(timestamps->m_begin);
+			}
+
+			if(pass.m_beginTimestamp)
+			{
+				cmdb->writeTimestamp(pass.m_beginTimestamp);
+			}
 
 			if(pass.fb().isCreated())
 			{
@@ -1177,15 +1954,38 @@ void RenderGraph::run() const
 					pass.m_fbRenderArea[3]);
 			}
 
-			const U size = pass.m_secondLevelCmdbs.getSize();
+			const U32 size = pass.m_secondLevelCmdbs.getSize();
 			if(size == 0)
 			{
 				ctx.m_userData = pass.m_userData;
 				ctx.m_passIdx = passIdx;
 				ctx.m_batchIdx = pass.m_batchIdx;
 
-				ANKI_TRACE_SCOPED_EVENT(GR_RENDER_GRAPH_CALLBACK);
-				pass.m_callback(ctx);
+				CommandBufferStatistics cmdbStatsBefore;
+				Second startTime = 0.0;
+				if(ANKI_UNLIKELY(timestamps != nullptr))
+				{
+					cmdb->getStatistics(cmdbStatsBefore);
+					startTime = HighRezTimer::getCurrentTime();
+				}
+
+				{
+					ANKI_TRACE_SCOPED_EVENT(GR_RENDER_GRAPH_CALLBACK);
+					pass.m_callback(ctx);
+				}
+
+				if(ANKI_UNLIKELY(timestamps != nullptr))
+				{
+					RenderGraphPassStatistics& stats = pass.m_cpuStats;
+					stats.m_cpuTime = HighRezTimer::getCurrentTime() - startTime;
+
+					CommandBufferStatistics cmdbStats;
+					cmdb->getStatistics(cmdbStats);
+					stats.m_commands.m_drawcallCount = cmdbStats.m_drawcallCount - cmdbStatsBefore.m_drawcallCount;
+					stats.m_commands.m_dispatchCount = cmdbStats.m_dispatchCount - cmdbStatsBefore.m_dispatchCount;
+					stats.m_commands.m_primitiveCount = cmdbStats.m_primitiveCount - cmdbStatsBefore.m_primitiveCount;
+					stats.m_commands.m_barrierCount = cmdbStats.m_barrierCount - cmdbStatsBefore.m_barrierCount;
+				}
 			}
 			else
 			{
@@ -1193,12 +1993,49 @@ void RenderGraph::run() const
 				{
 					cmdb->pushSecondLevelCommandBuffer(cmdb2nd);
 				}
+
+				if(ANKI_UNLIKELY(timestamps != nullptr))
+				{
+					RenderGraphPassStatistics& stats = pass.m_cpuStats;
+					stats.m_secondLevelCommandBufferCount = size;
+
+					for(U32 i = 0; i < size; ++i)
+					{
+						const Second cpuTime = pass.m_secondLevelCmdbCpuTimes[i];
+						stats.m_cpuTime += cpuTime;
+						stats.m_maxSecondLevelCpuTime = max(stats.m_maxSecondLevelCpuTime, cpuTime);
+
+						CommandBufferStatistics cmdbStats;
+						pass.m_secondLevelCmdbs[i]->getStatistics(cmdbStats);
+						stats.m_commands.m_drawcallCount += cmdbStats.m_drawcallCount;
+						stats.m_commands.m_dispatchCount += cmdbStats.m_dispatchCount;
+						stats.m_commands.m_primitiveCount += cmdbStats.m_primitiveCount;
+						stats.m_commands.m_barrierCount += cmdbStats.m_barrierCount;
+					}
+				}
 			}
 
 			if(pass.fb().isCreated())
 			{
 				cmdb->endRenderPass();
 			}
+
+			if(pass.m_endTimestamp)
+			{
+				cmdb->writeTimestamp(pass.m_endTimestamp);
+			}
+
+			if(timestamps)
+			{
+				cmdb->writeTimestamp(timestamps->m_end);
+			}
+
+			cmdb->endBreadcrumb();
+		}
+
+		if(!!batch.m_splitBarrierUsage)
+		{
+			splitBarriers[U32(&batch - &m_ctx->m_batches[0])] = cmdb->beginSplitBarrier(batch.m_splitBarrierUsage);
 		}
 	}
 }
@@ -1207,20 +2044,47 @@ void RenderGraph::flush()
 {
 	ANKI_TRACE_SCOPED_EVENT(GR_RENDER_GRAPH_FLUSH);
 
-	for(U32 i = 0; i < m_ctx->m_graphicsCmdbs.getSize(); ++i)
+	// The CPU side of the pass statistics is known by now
+	if(ANKI_UNLIKELY(m_ctx->m_gatherPassTimestamps))
 	{
+		DynamicArray<PassTimestamps>& timestamps = m_statistics.m_passTimestamps[m_statistics.m_nextTimestamp];
+		for(U32 passIdx = 0; passIdx < timestamps.getSize(); ++passIdx)
+		{
+			timestamps[passIdx].m_cpuStats = m_ctx->m_passes[passIdx].m_cpuStats;
+		}
+	}
+
+	for(U32 i = 0; i < m_ctx->m_submits.getSize(); ++i)
+	{
+		Submit& submit = m_ctx->m_submits[i];
+
 		// Maybe write a timestamp before flush
-		if(ANKI_UNLIKELY(m_ctx->m_gatherStatistics && i == m_ctx->m_graphicsCmdbs.getSize() - 1))
+		if(ANKI_UNLIKELY(m_ctx->m_gatherStatistics && i == m_ctx->m_lastGraphicsSubmit))
 		{
 			TimestampQueryPtr query = getManager().newTimestampQuery();
-			m_ctx->m_graphicsCmdbs[i]->writeTimestamp(query);
+			submit.m_cmdb->writeTimestamp(query);
 
 			m_statistics.m_timestamps[m_statistics.m_nextTimestamp * 2 + 1] = query;
 			m_statistics.m_cpuStartTimes[m_statistics.m_nextTimestamp] = HighRezTimer::getCurrentTime();
 		}
 
 		// Flush
-		m_ctx->m_graphicsCmdbs[i]->flush();
+		if(submit.m_waitSubmit == MAX_U32 && !submit.m_signal)
+		{
+			submit.m_cmdb->flush();
+		}
+		else
+		{
+			// The waited submit was flushed before this one so its fence is there
+			ConstWeakArray<FencePtr> waitFences;
+			if(submit.m_waitSubmit != MAX_U32)
+			{
+				ANKI_ASSERT(submit.m_waitSubmit < i);
+				waitFences = ConstWeakArray<FencePtr>(&m_ctx->m_submits[submit.m_waitSubmit].m_fence, 1);
+			}
+
+			submit.m_cmdb->flush(waitFences, (submit.m_signal) ? &submit.m_fence : nullptr);
+		}
 	}
 }
 
@@ -1304,6 +2168,11 @@ void RenderGraph::getStatistics(RenderGraphStatistics& statistics) const
 		statistics.m_gpuTime = -1.0;
 		statistics.m_cpuStartTime = -1.0;
 	}
+
+	statistics.m_cpuCompileTime = m_statistics.m_compileTime;
+	statistics.m_compiledGraphReused = m_statistics.m_compiledGraphReused;
+	statistics.m_barrierCount = m_statistics.m_barrierCount;
+	statistics.m_passes = ConstWeakArray<RenderGraphPassStatistics>(m_statistics.m_passes);
 }
 
 #if ANKI_DBG_RENDER_GRAPH
@@ -1331,6 +2200,7 @@ StringAuto RenderGraph::textureUsageToStr(StackAllocator<U8>& alloc, TextureUsag
 	ANKI_TEX_USAGE(GENERATE_MIPMAPS);
 	ANKI_TEX_USAGE(CLEAR);
 	ANKI_TEX_USAGE(PRESENT);
+	ANKI_TEX_USAGE(FRAMEBUFFER_SHADING_RATE);
 
 	if(!usage)
 	{
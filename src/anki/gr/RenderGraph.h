@@ -13,7 +13,7 @@
 #include <anki/gr/Framebuffer.h>
 #include <anki/gr/TimestampQuery.h>
 #include <anki/gr/CommandBuffer.h>
-#include <anki/util/HashMap.h>
+#include <anki/util/FlatHashMap.h>
 #include <anki/util/BitSet.h>
 #include <anki/util/WeakArray.h>
 
@@ -307,11 +307,34 @@ public:
 		m_callback = callback;
 		m_userData = userData;
 		m_secondLevelCmdbsCount = secondLeveCmdbCount;
+		m_secondLevelWorkEstimate = 0;
+	}
+
+	/// Same as setWork but the render graph picks the number of the second level command buffers of the pass. It
+	/// splits the work so every command buffer gets enough of it. See
+	/// RenderGraphDescription::setSecondLevelCommandBufferSplit.
+	/// @param workEstimate An estimation of the work of the pass. Usually its drawcall count.
+	void setParallelWork(RenderPassWorkCallback callback, void* userData, U32 workEstimate)
+	{
+		ANKI_ASSERT(callback);
+		ANKI_ASSERT(m_type == Type::GRAPHICS);
+		m_callback = callback;
+		m_userData = userData;
+		m_secondLevelCmdbsCount = AUTO_SECOND_LEVEL_CMDB_COUNT;
+		m_secondLevelWorkEstimate = workEstimate;
 	}
 
 	/// Add a new consumer or producer dependency.
 	void newDependency(const RenderPassDependency& dep);
 
+	/// Write a GPU timestamp right before and one right after the work of the pass. Use it to measure the pass.
+	void setTimestampQueries(TimestampQueryPtr begin, TimestampQueryPtr end)
+	{
+		ANKI_ASSERT(begin.isCreated() && end.isCreated());
+		m_beginTimestamp = begin;
+		m_endTimestamp = end;
+	}
+
 protected:
 	enum class Type : U8
 	{
@@ -319,6 +342,8 @@ protected:
 		NO_GRAPHICS
 	};
 
+	static constexpr U32 AUTO_SECOND_LEVEL_CMDB_COUNT = MAX_U32; ///< See setParallelWork.
+
 	Type m_type;
 
 	StackAllocator<U8> m_alloc;
@@ -327,6 +352,7 @@ protected:
 	RenderPassWorkCallback m_callback = nullptr;
 	void* m_userData = nullptr;
 	U32 m_secondLevelCmdbsCount = 0;
+	U32 m_secondLevelWorkEstimate = 0;
 
 	DynamicArray<RenderPassDependency> m_rtDeps;
 	DynamicArray<RenderPassDependency> m_buffDeps;
@@ -337,6 +363,11 @@ protected:
 	BitSet<MAX_RENDER_GRAPH_BUFFERS, U64> m_writeBuffMask = {false};
 	Bool m_hasBufferDeps = false; ///< Opt.
 
+	TimestampQueryPtr m_beginTimestamp;
+	TimestampQueryPtr m_endTimestamp;
+
+	Bool m_asyncCompute = false;
+
 	String m_name;
 
 	RenderPassDescriptionBase(Type t, RenderGraphDescription* descr)
@@ -382,6 +413,11 @@ public:
 	U32 m_colorAttachmentCount = 0;
 	FramebufferDescriptionAttachment m_depthStencilAttachment;
 
+	/// The texel size of the optional shading rate image. Zero means that there is none. See
+	/// GraphicsRenderPassDescription::setFramebufferShadingRateAttachment.
+	U32 m_shadingRateAttachmentTexelWidth = 0;
+	U32 m_shadingRateAttachmentTexelHeight = 0;
+
 	/// Calculate the hash for the framebuffer.
 	void bake();
 
@@ -419,8 +455,20 @@ public:
 		U32 maxx = MAX_U32,
 		U32 maxy = MAX_U32);
 
+	/// Set the shading rate image of the framebuffer. Call it after setFramebufferInfo with a FramebufferDescription
+	/// that has a shading rate texel size. The pass should also depend on the image with
+	/// TextureUsageBit::FRAMEBUFFER_SHADING_RATE.
+	void setFramebufferShadingRateAttachment(RenderTargetHandle shadingRateRenderTargetHandle)
+	{
+		ANKI_ASSERT(m_fbDescr.m_shadingRateAttachmentTexelWidth > 0);
+		ANKI_ASSERT(m_fbDescr.m_shadingRateAttachmentTexelHeight > 0);
+		ANKI_ASSERT(shadingRateRenderTargetHandle.isValid());
+		m_rtHandles[MAX_COLOR_ATTACHMENTS + 1] = shadingRateRenderTargetHandle;
+	}
+
 private:
-	Array<RenderTargetHandle, MAX_COLOR_ATTACHMENTS + 1> m_rtHandles;
+	/// The color RTs, the depth stencil RT and the shading rate image.
+	Array<RenderTargetHandle, MAX_COLOR_ATTACHMENTS + 2> m_rtHandles;
 	FramebufferDescription m_fbDescr;
 	Array<U32, 4> m_fbRenderArea = {};
 
@@ -443,6 +491,14 @@ class ComputeRenderPassDescription : public RenderPassDescriptionBase
 	template<typename, typename>
 	friend class GenericPoolAllocator;
 
+public:
+	/// Allow the pass to run in the async compute queue in parallel with the graphics work. The render graph will
+	/// synchronize it with the passes of the graphics queue it depends on. It's ignored if there is no such queue.
+	void setAsyncCompute()
+	{
+		m_asyncCompute = true;
+	}
+
 private:
 	ComputeRenderPassDescription(RenderGraphDescription* descr)
 		: RenderPassDescriptionBase(Type::NO_GRAPHICS, descr)
@@ -489,6 +545,36 @@ public:
 		m_gatherStatistics = gather;
 	}
 
+	/// Gather the GPU time, the CPU time and the commands of every pass. Needs setStatisticsEnabled as well.
+	void setPassStatisticsEnabled(Bool gather)
+	{
+		m_gatherPassStatistics = gather;
+	}
+
+	/// Place the transient render targets that are not alive at the same time in the same memory.
+	void setRenderTargetAliasingEnabled(Bool alias)
+	{
+		m_renderTargetAliasing = alias;
+	}
+
+	/// Begin the barriers right after the last batch that uses the textures and end them right before the first batch
+	/// that needs the new usage. The batches in between can overlap with the transitions.
+	void setSplitBarriersEnabled(Bool split)
+	{
+		m_splitBarriers = split;
+	}
+
+	/// Set how the work of the passes of RenderPassDescriptionBase::setParallelWork is split.
+	/// @param maxCommandBufferCount The max number of second level command buffers of a pass. Usually the number of
+	///                              the threads that call RenderGraph::runSecondLevel.
+	/// @param minWorkPerCommandBuffer Less work than that isn't worth a command buffer of its own.
+	void setSecondLevelCommandBufferSplit(U32 maxCommandBufferCount, U32 minWorkPerCommandBuffer)
+	{
+		ANKI_ASSERT(maxCommandBufferCount > 0 && minWorkPerCommandBuffer > 0);
+		m_maxSecondLevelCmdbCount = maxCommandBufferCount;
+		m_minWorkPerSecondLevelCmdb = minWorkPerCommandBuffer;
+	}
+
 private:
 	class Resource
 	{
@@ -526,6 +612,23 @@ private:
 	DynamicArray<RT> m_renderTargets;
 	DynamicArray<Buffer> m_buffers;
 	Bool m_gatherStatistics = false;
+	Bool m_gatherPassStatistics = false;
+	Bool m_renderTargetAliasing = false;
+	Bool m_splitBarriers = false;
+	U32 m_maxSecondLevelCmdbCount = 1;
+	U32 m_minWorkPerSecondLevelCmdb = 1;
+};
+
+/// Statistics of a single pass.
+class RenderGraphPassStatistics
+{
+public:
+	CString m_name;
+	Second m_gpuTime = 0.0; ///< Between the timestamps around the pass. Passes of the same batch overlap.
+	Second m_cpuTime = 0.0; ///< Time spent recording all its command buffers.
+	Second m_maxSecondLevelCpuTime = 0.0; ///< The slowest of its second level command buffers.
+	U32 m_secondLevelCommandBufferCount = 0;
+	CommandBufferStatistics m_commands; ///< The commands of all its command buffers.
 };
 
 /// Statistics.
@@ -534,6 +637,13 @@ class RenderGraphStatistics
 public:
 	Second m_gpuTime; ///< Time spent in the GPU.
 	Second m_cpuStartTime; ///< Time the work was submited from the CPU (almost)
+	Second m_cpuCompileTime; ///< Time spent in RenderGraph::compileNewGraph in the last frame.
+	Bool m_compiledGraphReused; ///< The last frame reused the dependencies and the batches of the previous.
+	U32 m_barrierCount; ///< The barriers the graph placed between the batches in the last frame.
+
+	/// The passes of the last frame their GPU timestamps are available. It's empty if the pass statistics are not
+	/// enabled. See RenderGraphDescription::setPassStatisticsEnabled. Valid until the next compileNewGraph.
+	ConstWeakArray<RenderGraphPassStatistics> m_passes;
 };
 
 /// Accepts a descriptor of the frame's render passes and sets the dependencies between them.
@@ -563,8 +673,10 @@ public:
 	/// @name 2nd step methods
 	/// @{
 
-	/// Will call a number of RenderPassWorkCallback that populate 2nd level command buffers.
-	void runSecondLevel(U32 threadIdx);
+	/// Will call a number of RenderPassWorkCallback that populate 2nd level command buffers. Call it from many threads
+	/// at the same time. Every call picks the next command buffer that is not recorded, starting from the heaviest
+	/// ones, and returns when there is none left. This way the threads get a similar amount of work.
+	void runSecondLevel();
 	/// @}
 
 	/// @name 3rd step methods
@@ -595,6 +707,7 @@ public:
 
 private:
 	static constexpr U PERIODIC_CLEANUP_EVERY = 60; ///< How many frames between cleanups.
+	static constexpr PtrSize ALIASING_HEAP_SIZE_GRANULARITY = 16_MB; ///< The aliasing heap grows in that steps.
 
 	// Forward declarations of internal classes.
 	class BakeContext;
@@ -603,6 +716,9 @@ private:
 	class RT;
 	class Buffer;
 	class Barrier;
+	class PassTimestamps;
+	class Submit;
+	class SecondLevelTask;
 
 	/// Render targets of the same type+size+format.
 	class RenderTargetCacheEntry
@@ -612,6 +728,14 @@ private:
 		U32 m_texturesInUse = 0;
 	};
 
+	/// The memory a transient render target needs when it's aliased.
+	class RenderTargetMemoryRequirements
+	{
+	public:
+		PtrSize m_size = 0;
+		PtrSize m_alignment = 0;
+	};
+
 	/// Info on imported render targets that are kept between runs.
 	class ImportedRenderTargetInfo
 	{
@@ -619,9 +743,22 @@ private:
 		DynamicArray<TextureUsageBit> m_surfOrVolLastUsages; ///< Last TextureUsageBit of the imported RT.
 	};
 
-	HashMap<U64, RenderTargetCacheEntry> m_renderTargetCache; ///< Non-imported render targets.
-	HashMap<U64, FramebufferPtr> m_fbCache; ///< Framebuffer cache.
-	HashMap<U64, ImportedRenderTargetInfo> m_importedRenderTargets;
+	FlatHashMap<U64, RenderTargetCacheEntry> m_renderTargetCache; ///< Non-imported render targets.
+	FlatHashMap<U64, FramebufferPtr> m_fbCache; ///< Framebuffer cache.
+	FlatHashMap<U64, ImportedRenderTargetInfo> m_importedRenderTargets;
+	FlatHashMap<U64, RenderTargetMemoryRequirements> m_rtMemoryRequirements; ///< Cache, the key is the RT hash.
+
+	/// The pass dependencies and the batches of the last compiled graph. They are reused while the passes and their
+	/// dependencies stay the same. The rest (resources, barriers, framebuffers) is patched every frame.
+	class
+	{
+	public:
+		U64 m_hash = 0; ///< The hash of the topology of the description. Zero if there is nothing cached.
+		DynamicArray<U32> m_dependsOn; ///< The dependencies of all passes one after the other.
+		DynamicArray<U32> m_dependsOnOffsets; ///< Where the deps of a pass begin in m_dependsOn. Pass count + 1.
+		DynamicArray<U32> m_passWaves; ///< The iteration of initBatches() that a pass became ready.
+	} m_compiledGraphCache;
+	TextureHeapPtr m_aliasingHeap; ///< The memory of the aliased render targets.
 
 	BakeContext* m_ctx = nullptr;
 	U64 m_version = 0;
@@ -633,6 +770,15 @@ private:
 		Array<TimestampQueryPtr, MAX_TIMESTAMPS_BUFFERED * 2> m_timestamps;
 		Array<Second, MAX_TIMESTAMPS_BUFFERED> m_cpuStartTimes;
 		U8 m_nextTimestamp = 0;
+
+		Second m_compileTime = 0.0;
+		Bool m_compiledGraphReused = false;
+		U32 m_barrierCount = 0;
+
+		/// The timestamps of every pass. They are written to the tracer and m_passes when they become available.
+		Array<DynamicArray<PassTimestamps>, MAX_TIMESTAMPS_BUFFERED> m_passTimestamps;
+		HashMap<U64, String> m_passNames; ///< The tracer needs pass names that live long so keep them here.
+		DynamicArray<RenderGraphPassStatistics> m_passes;
 	} m_statistics;
 
 	RenderGraph(GrManager* manager, CString name);
@@ -642,28 +788,52 @@ private:
 	static ANKI_USE_RESULT RenderGraph* newInstance(GrManager* manager);
 
 	BakeContext* newContext(const RenderGraphDescription& descr, StackAllocator<U8>& alloc);
-	void initRenderPassesAndSetDeps(const RenderGraphDescription& descr, StackAllocator<U8>& alloc);
-	void initBatches();
+	void initRenderPassesAndSetDeps(const RenderGraphDescription& descr, StackAllocator<U8>& alloc, Bool cached);
+	void initBatches(Bool cached);
+
+	/// Hash the things of the description that the pass dependencies and the batches depend on.
+	static U64 computeTopologyHash(const RenderGraphDescription& descr);
+
+	/// Create the transient render targets. It needs the batches to find their lifetimes.
+	void initRenderTargets(const RenderGraphDescription& descr);
+
+	/// Find the offsets of the transient render targets in the aliasing heap.
+	void aliasRenderTargets(
+		const RenderGraphDescription& descr, WeakArray<TextureInitInfo> initInfos, WeakArray<U64> hashes);
+
+	/// Create a new command buffer for the batches of one queue.
+	/// @param asyncCompute The queue of the command buffer.
+	/// @param waitSubmit The submit of the other queue that the new command buffer will wait. MAX_U32 for none.
+	U32 newSubmit(Bool asyncCompute, U32 waitSubmit);
 	void initGraphicsPasses(const RenderGraphDescription& descr, StackAllocator<U8>& alloc);
+	void initSecondLevelTasks(const RenderGraphDescription& descr, StackAllocator<U8>& alloc);
 	void setBatchBarriers(const RenderGraphDescription& descr);
+	void initPassTimestamps(const RenderGraphDescription& descr);
+
+	/// Write the GPU times of the passes of an old frame to the tracer.
+	void flushPassTimestamps(U32 frameSlot);
 
 	TexturePtr getOrCreateRenderTarget(const TextureInitInfo& initInf, U64 hash);
-	FramebufferPtr getOrCreateFramebuffer(const FramebufferDescription& fbDescr,
-		const RenderTargetHandle* rtHandles,
-		CString name,
-		Bool& drawsToPresentableTex);
+	FramebufferPtr getOrCreateFramebuffer(
+		const FramebufferDescription& fbDescr, const RenderTargetHandle* rtHandles, CString name);
 
 	/// Every N number of frames clean unused cached items.
 	void periodicCleanup();
 
 	ANKI_HOT static Bool passADependsOnB(const RenderPassDescriptionBase& a, const RenderPassDescriptionBase& b);
 
+	/// The passes touch at least one common resource. Even read to read. Used for passes of different queues.
+	static Bool passesShareResources(const RenderPassDescriptionBase& a, const RenderPassDescriptionBase& b);
+
 	static Bool overlappingTextureSubresource(const TextureSubresourceInfo& suba, const TextureSubresourceInfo& subb);
 
 	static Bool passHasUnmetDependencies(const BakeContext& ctx, U32 passIdx);
 
 	void setTextureBarrier(Batch& batch, const RenderPassDependency& consumer);
 
+	/// Check if a barrier can begin after a batch and end before another.
+	Bool canSplitBarrier(U32 beginBatchIdx, U32 endBatchIdx) const;
+
 	template<typename TFunc>
 	static void iterateSurfsOrVolumes(const TexturePtr& tex, const TextureSubresourceInfo& subresource, TFunc func);
 
@@ -46,11 +46,19 @@ public:
 		{
 			invalid |= m_shaders[ShaderType::VERTEX] || m_shaders[ShaderType::TESSELLATION_CONTROL]
 					   || m_shaders[ShaderType::TESSELLATION_EVALUATION] || m_shaders[ShaderType::GEOMETRY]
-					   || m_shaders[ShaderType::FRAGMENT];
+					   || m_shaders[ShaderType::FRAGMENT] || m_shaders[ShaderType::TASK] || m_shaders[ShaderType::MESH];
+		}
+		else if(m_shaders[ShaderType::MESH])
+		{
+			// The mesh pipeline replaces the whole vertex pipeline
+			invalid |= !m_shaders[ShaderType::FRAGMENT] || m_shaders[ShaderType::VERTEX]
+					   || m_shaders[ShaderType::TESSELLATION_CONTROL] || m_shaders[ShaderType::TESSELLATION_EVALUATION]
+					   || m_shaders[ShaderType::GEOMETRY];
 		}
 		else
 		{
-			invalid |= !m_shaders[ShaderType::VERTEX] || !m_shaders[ShaderType::FRAGMENT];
+			invalid |=
+				!m_shaders[ShaderType::VERTEX] || !m_shaders[ShaderType::FRAGMENT] || m_shaders[ShaderType::TASK];
 		}
 
 		for(ShaderType type = ShaderType::FIRST; type < ShaderType::COUNT; ++type)
@@ -6,6 +6,7 @@
 #pragma once
 
 #include <anki/gr/GrObject.h>
+#include <anki/gr/TextureHeap.h>
 
 namespace anki
 {
@@ -34,6 +35,11 @@ public:
 
 	U8 _m_padding[3] = {0, 0, 0};
 
+	/// If it's set the texture will be placed in that heap at m_heapOffset instead of allocating its own memory. Use
+	/// GrManager::getTextureMemoryRequirements to find the size and alignment it needs.
+	TextureHeapPtr m_heap;
+	PtrSize m_heapOffset = 0;
+
 	TextureInitInfo() = default;
 
 	TextureInitInfo(CString name)
@@ -0,0 +1,65 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/gr/GrObject.h>
+
+namespace anki
+{
+
+/// @addtogroup graphics
+/// @{
+
+/// TextureHeap initializer.
+class TextureHeapInitInfo : public GrBaseInitInfo
+{
+public:
+	PtrSize m_size = 0;
+
+	TextureHeapInitInfo() = default;
+
+	TextureHeapInitInfo(CString name)
+		: GrBaseInitInfo(name)
+	{
+	}
+};
+
+/// A block of GPU memory that textures can be placed into. Textures placed in overlapping ranges of the same heap
+/// alias each other's memory so they shouldn't be in use at the same time.
+class TextureHeap : public GrObject
+{
+	ANKI_GR_OBJECT
+
+public:
+	static const GrObjectType CLASS_TYPE = GrObjectType::TEXTURE_HEAP;
+
+	PtrSize getSize() const
+	{
+		ANKI_ASSERT(m_size);
+		return m_size;
+	}
+
+protected:
+	PtrSize m_size = 0;
+
+	/// Construct.
+	TextureHeap(GrManager* manager, CString name)
+		: GrObject(manager, CLASS_TYPE, name)
+	{
+	}
+
+	/// Destroy.
+	~TextureHeap()
+	{
+	}
+
+private:
+	/// Allocate and initialize new instance.
+	static ANKI_USE_RESULT TextureHeap* newInstance(GrManager* manager, const TextureHeapInitInfo& init);
+};
+/// @}
+
+} // end namespace anki
@@ -51,6 +51,13 @@ void CommandBuffer::flush(FencePtr* fence)
 	}
 }
 
+void CommandBuffer::flush(ConstWeakArray<FencePtr> waitFences, FencePtr* signalFence)
+{
+	// There is only one queue so the command buffers already run in order
+	(void)waitFences;
+	flush(signalFence);
+}
+
 void CommandBuffer::bindVertexBuffer(
 	U32 binding, BufferPtr buff, PtrSize offset, PtrSize stride, VertexStepRate stepRate)
 {
@@ -1035,8 +1042,24 @@ void CommandBuffer::drawElementsIndirect(
 
 	self.m_state.checkIndexedDracall();
 	self.flushDrawcall(*this);
+
+	// If nothing changed since the previous indirect drawcall and the arguments follow its own then batch them
+	const GLenum glTopology = convertPrimitiveTopology(topology);
+	if(self.m_lastDrawElementsIndirect && self.m_lastDrawElementsIndirect == self.m_lastCommand)
+	{
+		DrawElementsIndirectCommand& prev = static_cast<DrawElementsIndirectCommand&>(*self.m_lastCommand);
+		if(prev.m_topology == glTopology && prev.m_indexType == self.m_state.m_idx.m_indexType
+			&& prev.m_buff.get() == indirectBuff.get()
+			&& prev.m_offset + sizeof(DrawElementsIndirectInfo) * prev.m_drawCount == offset)
+		{
+			prev.m_drawCount += drawCount;
+			return;
+		}
+	}
+
 	self.pushBackNewCommand<DrawElementsIndirectCommand>(
-		convertPrimitiveTopology(topology), self.m_state.m_idx.m_indexType, drawCount, offset, indirectBuff);
+		glTopology, self.m_state.m_idx.m_indexType, drawCount, offset, indirectBuff);
+	self.m_lastDrawElementsIndirect = self.m_lastCommand;
 }
 
 void CommandBuffer::drawArraysIndirect(
@@ -1079,8 +1102,32 @@ void CommandBuffer::drawArraysIndirect(
 	ANKI_GL_SELF(CommandBufferImpl);
 	self.m_state.checkNonIndexedDrawcall();
 	self.flushDrawcall(*this);
-	self.pushBackNewCommand<DrawArraysIndirectCommand>(
-		convertPrimitiveTopology(topology), drawCount, offset, indirectBuff);
+
+	// Same batching as in drawElementsIndirect
+	const GLenum glTopology = convertPrimitiveTopology(topology);
+	if(self.m_lastDrawArraysIndirect && self.m_lastDrawArraysIndirect == self.m_lastCommand)
+	{
+		DrawArraysIndirectCommand& prev = static_cast<DrawArraysIndirectCommand&>(*self.m_lastCommand);
+		if(prev.m_topology == glTopology && prev.m_buff.get() == indirectBuff.get()
+			&& prev.m_offset + sizeof(DrawArraysIndirectInfo) * prev.m_drawCount == offset)
+		{
+			prev.m_drawCount += drawCount;
+			return;
+		}
+	}
+
+	self.pushBackNewCommand<DrawArraysIndirectCommand>(glTopology, drawCount, offset, indirectBuff);
+	self.m_lastDrawArraysIndirect = self.m_lastCommand;
+}
+
+void CommandBuffer::drawMeshTasks(U32 taskCount, U32 firstTask)
+{
+	ANKI_ASSERT(!"TODO");
+}
+
+void CommandBuffer::drawMeshTasksIndirect(U32 drawCount, PtrSize offset, BufferPtr indirectBuff)
+{
+	ANKI_ASSERT(!"TODO");
 }
 
 void CommandBuffer::dispatchCompute(U32 groupCountX, U32 groupCountY, U32 groupCountZ)
@@ -1268,6 +1315,16 @@ void CommandBuffer::generateMipmaps3d(TextureViewPtr tex)
 	ANKI_ASSERT(!!"TODO");
 }
 
+void CommandBuffer::beginBreadcrumb(CString name)
+{
+	// Not supported
+}
+
+void CommandBuffer::endBreadcrumb()
+{
+	// Not supported
+}
+
 void CommandBuffer::pushSecondLevelCommandBuffer(CommandBufferPtr cmdb)
 {
 	class ExecCmdbCommand final : public GlCommand
@@ -1298,6 +1355,12 @@ Bool CommandBuffer::isEmpty() const
 	return self.isEmpty();
 }
 
+void CommandBuffer::getStatistics(CommandBufferStatistics& stats) const
+{
+	// Not tracked in GL
+	stats = CommandBufferStatistics();
+}
+
 void CommandBuffer::blitTextureViews(TextureViewPtr srcView, TextureViewPtr destView)
 {
 	ANKI_ASSERT(!"TODO");
@@ -1381,6 +1444,30 @@ void CommandBuffer::setTextureVolumeBarrier(
 	setTextureBarrier(tex, prevUsage, nextUsage, subresource);
 }
 
+void CommandBuffer::setTextureAliasingBarrier(TexturePtr tex,
+	TextureUsageBit prevAliasesUsage,
+	TextureUsageBit nextUsage,
+	const TextureSubresourceInfo& subresource)
+{
+	// No texture heaps in GL. It's a plain barrier
+	setTextureBarrier(tex, prevAliasesUsage, nextUsage, subresource);
+}
+
+U32 CommandBuffer::beginSplitBarrier(TextureUsageBit)
+{
+	// No split barriers in GL. The second half does all the work
+	return 0;
+}
+
+void CommandBuffer::setTextureSurfaceSplitBarrier(U32,
+	TexturePtr tex,
+	TextureUsageBit prevUsage,
+	TextureUsageBit nextUsage,
+	const TextureSurfaceInfo& surf)
+{
+	setTextureSurfaceBarrier(tex, prevUsage, nextUsage, surf);
+}
+
 void CommandBuffer::setTextureBarrier(
 	TexturePtr tex, TextureUsageBit prevUsage, TextureUsageBit nextUsage, const TextureSubresourceInfo& subresource)
 {
@@ -52,6 +52,10 @@ public:
 
 	StateTracker m_state;
 
+	/// The last indirect drawcalls. If they are also the last command the next indirect drawcall might be merged.
+	GlCommand* m_lastDrawElementsIndirect = nullptr;
+	GlCommand* m_lastDrawArraysIndirect = nullptr;
+
 	/// Default constructor
 	CommandBufferImpl(GrManager* manager, CString name)
 		: CommandBuffer(manager, name)
@@ -81,7 +81,7 @@ void GrManager::swapBuffers()
 void GrManager::finish()
 {
 	ANKI_GL_SELF(GrManagerImpl);
-	self.getRenderingThread().syncClientServer();
+	self.getRenderingThread().waitForGpu();
 }
 
 #define ANKI_SAFE_CONSTRUCT(class_) \
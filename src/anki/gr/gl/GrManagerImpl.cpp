@@ -55,7 +55,7 @@ Error GrManagerImpl::init(GrManagerInitInfo& init, GrAllocator<U8> alloc)
 	m_thread = m_alloc.newInstance<RenderingThread>(this);
 
 	// Start it
-	m_thread->start();
+	m_thread->start(init.m_config->getBool("gr_glSingleThreaded"));
 	m_thread->syncClientServer();
 
 	// Misc
@@ -68,6 +68,7 @@ Error GrManagerImpl::init(GrManagerInitInfo& init, GrAllocator<U8> alloc)
 	m_capabilities.m_textureBufferMaxRange = m_state->m_tboMaxRange;
 	m_capabilities.m_majorApiVersion = U(init.m_config->getNumber("gr.glmajor"));
 	m_capabilities.m_minorApiVersion = U(init.m_config->getNumber("gr.glmajor"));
+	m_capabilities.m_bcTextureCompression = true;
 
 	initFakeDefaultFb(init);
 
@@ -22,17 +22,26 @@ class SyncCommand final : public GlCommand
 {
 public:
 	RenderingThread* m_renderingThread;
+	Bool m_waitGpu;
 
-	SyncCommand(RenderingThread* renderingThread)
+	SyncCommand(RenderingThread* renderingThread, Bool waitGpu)
 		: m_renderingThread(renderingThread)
+		, m_waitGpu(waitGpu)
 	{
 	}
 
 	ANKI_USE_RESULT Error operator()(GlState&)
 	{
-		// Make sure that all GPU and CPU work is done
-		glFlush();
-		glFinish();
+		// All the CPU work is done by now. Wait for the GPU only if asked because it drains the pipeline
+		if(m_waitGpu)
+		{
+			glFinish();
+		}
+		else
+		{
+			glFlush();
+		}
+
 		m_renderingThread->m_syncBarrier.wait();
 		return Error::NONE;
 	}
@@ -65,21 +74,26 @@ public:
 	}
 };
 
-/// Empty command
-class EmptyCommand final : public GlCommand
+/// Stop the server.
+class QuitCommand final : public GlCommand
 {
 public:
+	RenderingThread* m_renderingThread;
+
+	QuitCommand(RenderingThread* renderingThread)
+		: m_renderingThread(renderingThread)
+	{
+	}
+
 	ANKI_USE_RESULT Error operator()(GlState&)
 	{
+		m_renderingThread->m_quit = true;
 		return Error::NONE;
 	}
 };
 
 RenderingThread::RenderingThread(GrManagerImpl* manager)
 	: m_manager(manager)
-	, m_tail(0)
-	, m_head(0)
-	, m_renderingThreadSignal(0)
 	, m_thread("anki_gl")
 {
 	ANKI_ASSERT(m_manager);
@@ -121,32 +135,116 @@ void RenderingThread::flushCommandBuffer(CommandBufferPtr cmdb, FencePtr* fence)
 
 	static_cast<CommandBufferImpl&>(*cmdb).makeImmutable();
 
+	pushCommandBuffer(cmdb);
+
+	if(m_singleThreaded && isServerThread())
 	{
-		LockGuard<Mutex> lock(m_mtx);
+		drainQueue();
+	}
+}
 
-		// Set commands
-		U64 diff = m_tail - m_head;
+void RenderingThread::pushCommandBuffer(CommandBufferPtr cmdb)
+{
+	// Reserve a slot
+	U64 pos = m_tail.load();
+	QueueSlot* slot;
+	while(true)
+	{
+		slot = &m_queue[pos % m_queue.getSize()];
+		const U64 seq = slot->m_seq.load(AtomicMemoryOrder::ACQUIRE);
 
-		if(diff < m_queue.getSize())
+		if(seq == pos)
+		{
+			// The slot is free. It will update pos if it fails
+			if(m_tail.compareExchange(pos, pos + 1))
+			{
+				break;
+			}
+		}
+		else if(seq < pos)
 		{
-			U64 idx = m_tail % m_queue.getSize();
+			// The queue is full, wait for the server to consume something
+			if(m_singleThreaded && isServerThread())
+			{
+				drainQueue();
+			}
+			else
+			{
+				std::this_thread::yield();
+			}
 
-			m_queue[idx] = cmdb;
-			++m_tail;
+			pos = m_tail.load();
 		}
 		else
 		{
-			ANKI_GL_LOGW("Rendering queue too small");
+			// Some other producer took it
+			pos = m_tail.load();
 		}
+	}
+
+	// Publish it. The store and the load of m_serverSleeping need to be sequentially consistent to not miss a wakeup
+	slot->m_cmdb = cmdb;
+	slot->m_seq.store(pos + 1, AtomicMemoryOrder::SEQ_CST);
+
+	if(m_serverSleeping.load(AtomicMemoryOrder::SEQ_CST))
+	{
+		LockGuard<Mutex> lock(m_mtx);
+		m_condVar.notifyOne();
+	}
+}
+
+Bool RenderingThread::tryPopCommandBuffer(CommandBufferPtr& cmdb)
+{
+	QueueSlot& slot = m_queue[m_head % m_queue.getSize()];
+	if(slot.m_seq.load(AtomicMemoryOrder::SEQ_CST) != m_head + 1)
+	{
+		return false;
+	}
+
+	cmdb = std::move(slot.m_cmdb);
+	slot.m_seq.store(m_head + m_queue.getSize(), AtomicMemoryOrder::RELEASE);
+	++m_head;
+	return true;
+}
+
+void RenderingThread::executeCommandBuffer(CommandBufferPtr& cmdb)
+{
+	Error err = Error::NONE;
+	{
+		ANKI_TRACE_SCOPED_EVENT(GL_THREAD);
+		err = static_cast<CommandBufferImpl&>(*cmdb).executeAllCommands();
+	}
+
+	if(err)
+	{
+		ANKI_GL_LOGE("Error in rendering thread. Aborting");
+		abort();
+	}
+
+	cmdb.reset(nullptr);
+}
+
+void RenderingThread::drainQueue()
+{
+	ANKI_ASSERT(m_singleThreaded && isServerThread());
 
-		m_condVar.notifyOne(); // Wake the thread
+	CommandBufferPtr cmdb;
+	while(tryPopCommandBuffer(cmdb))
+	{
+		executeCommandBuffer(cmdb);
 	}
 }
 
-void RenderingThread::start()
+void RenderingThread::start(Bool singleThreaded)
 {
-	ANKI_ASSERT(m_tail == 0 && m_head == 0);
+	ANKI_ASSERT(m_tail.load() == 0 && m_head == 0);
+	m_singleThreaded = singleThreaded;
+
 	m_queue.create(m_manager->getAllocator(), QUEUE_SIZE);
+	for(U32 i = 0; i < QUEUE_SIZE; ++i)
+	{
+		m_queue[i].m_seq.store(i);
+	}
 
 	// Swap buffers stuff
 	m_swapBuffersCommands = m_manager->newCommandBuffer(CommandBufferInitInfo());
@@ -155,24 +253,41 @@ void RenderingThread::start()
 	// Just in case noone swaps
 	static_cast<CommandBufferImpl&>(*m_swapBuffersCommands).makeExecuted();
 
-	m_manager->pinContextToCurrentThread(false);
+	if(m_singleThreaded)
+	{
+		// This thread is the server
+		prepare();
+	}
+	else
+	{
+		m_manager->pinContextToCurrentThread(false);
 
-	// Start thread
-	m_thread.start(this, threadCallback);
+		// Start thread
+		m_thread.start(this, threadCallback);
+	}
 
-	// Create sync command buffer
+	// Create sync command buffers
 	m_syncCommands = m_manager->newCommandBuffer(CommandBufferInitInfo());
-	static_cast<CommandBufferImpl&>(*m_syncCommands).pushBackNewCommand<SyncCommand>(this);
+	static_cast<CommandBufferImpl&>(*m_syncCommands).pushBackNewCommand<SyncCommand>(this, false);
+
+	m_waitGpuCommands = m_manager->newCommandBuffer(CommandBufferInitInfo());
+	static_cast<CommandBufferImpl&>(*m_waitGpuCommands).pushBackNewCommand<SyncCommand>(this, true);
 
-	m_emptyCmdb = m_manager->newCommandBuffer(CommandBufferInitInfo());
-	static_cast<CommandBufferImpl&>(*m_emptyCmdb).pushBackNewCommand<EmptyCommand>();
+	m_quitCmdb = m_manager->newCommandBuffer(CommandBufferInitInfo());
+	static_cast<CommandBufferImpl&>(*m_quitCmdb).pushBackNewCommand<QuitCommand>(this);
 }
 
 void RenderingThread::stop()
 {
+	if(m_singleThreaded)
+	{
+		drainQueue();
+		finish();
+		return;
+	}
+
 	syncClientServer();
-	m_renderingThreadSignal = 1;
-	flushCommandBuffer(m_emptyCmdb, nullptr);
+	flushCommandBuffer(m_quitCmdb, nullptr);
 
 	Error err = m_thread.join();
 	(void)err;
@@ -199,15 +314,24 @@ void RenderingThread::prepare()
 void RenderingThread::finish()
 {
 	// Iterate the queue and release the refcounts
-	for(U i = 0; i < m_queue.getSize(); i++)
+	for(QueueSlot& slot : m_queue)
 	{
-		if(m_queue[i].isCreated())
+		if(slot.m_cmdb.isCreated())
 		{
 			// Fake that it's executed to avoid warnings
-			static_cast<CommandBufferImpl&>(*m_queue[i]).makeExecuted();
+			static_cast<CommandBufferImpl&>(*slot.m_cmdb).makeExecuted();
 
 			// Release
-			m_queue[i] = CommandBufferPtr();
+			slot.m_cmdb.reset(nullptr);
+		}
+	}
+
+	for(GLsync& fence : m_frameFences)
+	{
+		if(fence)
+		{
+			glDeleteSync(fence);
+			fence = 0;
 		}
 	}
 
@@ -230,59 +354,66 @@ void RenderingThread::threadLoop()
 {
 	prepare();
 
-	while(1)
+	while(!m_quit)
 	{
-		CommandBufferPtr cmd;
+		CommandBufferPtr cmdb;
 
-		// Wait for something
+		// Pop without locking and sleep only if there is nothing to do
+		if(!tryPopCommandBuffer(cmdb))
 		{
 			LockGuard<Mutex> lock(m_mtx);
-			while(m_tail == m_head)
-			{
-				m_condVar.wait(m_mtx);
-			}
+			m_serverSleeping.store(1, AtomicMemoryOrder::SEQ_CST);
 
-			// Check signals
-			if(m_renderingThreadSignal == 1)
+			while(!tryPopCommandBuffer(cmdb))
 			{
-				// Requested to stop
-				break;
+				m_condVar.wait(m_mtx);
 			}
 
-			U64 idx = m_head % m_queue.getSize();
-			// Pop a command
-			cmd = m_queue[idx];
-			m_queue[idx] = CommandBufferPtr(); // Insert empty cmd buffer
-
-			++m_head;
-		}
-
-		Error err = Error::NONE;
-		{
-			ANKI_TRACE_SCOPED_EVENT(GL_THREAD);
-			err = static_cast<CommandBufferImpl&>(*cmd).executeAllCommands();
+			m_serverSleeping.store(0);
 		}
 
-		if(err)
-		{
-			ANKI_GL_LOGE("Error in rendering thread. Aborting");
-			abort();
-		}
+		executeCommandBuffer(cmdb);
 	}
 
 	finish();
 }
 
-void RenderingThread::syncClientServer()
+void RenderingThread::sync(CommandBufferPtr& cmdb)
 {
 	// Lock because there is only one barrier. If multiple threads call
 	// syncClientServer all of them will hit the same barrier.
 	LockGuard<SpinLock> lock(m_syncLock);
 
-	flushCommandBuffer(m_syncCommands, nullptr);
+	flushCommandBuffer(cmdb, nullptr);
 	m_syncBarrier.wait();
 }
 
+void RenderingThread::syncClientServer()
+{
+	if(isServerThread())
+	{
+		// Single threaded, just run what is pending
+		drainQueue();
+	}
+	else
+	{
+		sync(m_syncCommands);
+	}
+}
+
+void RenderingThread::waitForGpu()
+{
+	if(isServerThread())
+	{
+		drainQueue();
+		glFinish();
+	}
+	else
+	{
+		sync(m_waitGpuCommands);
+	}
+}
+
 void RenderingThread::swapBuffersInternal()
 {
 	ANKI_TRACE_SCOPED_EVENT(SWAP_BUFFERS);
@@ -290,6 +421,14 @@ void RenderingThread::swapBuffersInternal()
 	// Do the swap buffers
 	m_manager->swapBuffers();
 
+	// Mark the end of the frame and wait for the GPU to finish the previous one. The client waits for this before it
+	// starts the next frame so when it starts writing the staging memory of frame N+1 the GPU is done with frame N-2
+	// that used the same memory
+	ANKI_ASSERT(!m_frameFences[m_frame % MAX_FRAMES_IN_FLIGHT]);
+	m_frameFences[m_frame % MAX_FRAMES_IN_FLIGHT] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	waitFrameFence(m_frameFences[(m_frame + MAX_FRAMES_IN_FLIGHT - 1) % MAX_FRAMES_IN_FLIGHT]);
+	++m_frame;
+
 	// Notify the main thread that we are done
 	{
 		LockGuard<Mutex> lock(m_frameMtx);
@@ -299,6 +438,31 @@ void RenderingThread::swapBuffersInternal()
 	}
 }
 
+void RenderingThread::waitFrameFence(GLsync& fence)
+{
+	if(!fence)
+	{
+		return;
+	}
+
+	ANKI_TRACE_SCOPED_EVENT(GL_WAIT_FRAME_FENCE);
+
+	GLenum res;
+	do
+	{
+		const GLuint64 TIMEOUT = 1000000000; // 1sec
+		res = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, TIMEOUT);
+	} while(res == GL_TIMEOUT_EXPIRED);
+
+	if(res == GL_WAIT_FAILED)
+	{
+		ANKI_GL_LOGE("glClientWaitSync() failed");
+	}
+
+	glDeleteSync(fence);
+	fence = 0;
+}
+
 void RenderingThread::swapBuffers()
 {
 	ANKI_TRACE_SCOPED_EVENT(SWAP_BUFFERS);
@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include <anki/gr/gl/Common.h>
 #include <anki/gr/CommandBuffer.h>
 #include <anki/util/Thread.h>
 
@@ -19,6 +20,7 @@ class RenderingThread
 {
 	friend class SyncCommand;
 	friend class SwapBuffersCommand;
+	friend class QuitCommand;
 
 public:
 	RenderingThread(GrManagerImpl* device);
@@ -26,8 +28,10 @@ public:
 	~RenderingThread();
 
 	/// Start the working thread
+	/// @param singleThreaded If true there is no working thread. The thread that calls start() becomes the server and
+	///                       runs the command buffers when it flushes them.
 	/// @note Don't free the context before calling #stop
-	void start();
+	void start(Bool singleThreaded);
 
 	/// Stop the working thread
 	void stop();
@@ -38,9 +42,12 @@ public:
 	/// Push a command buffer to the queue and wait for it
 	void finishCommandBuffer(CommandBufferPtr commands);
 
-	/// Sync the client and server
+	/// Sync the client and server. It waits for the server to run all the flushed command buffers but not for the GPU.
 	void syncClientServer();
 
+	/// Wait for the server and the GPU to finish all the flushed work.
+	void waitForGpu();
+
 	/// Return true if this is the main thread
 	Bool isServerThread() const
 	{
@@ -53,14 +60,25 @@ public:
 private:
 	WeakPtr<GrManagerImpl> m_manager;
 
+	/// A slot of the command queue. The sequence number tells if the slot is free or has a command buffer for a given
+	/// position of the queue.
+	class QueueSlot
+	{
+	public:
+		Atomic<U64> m_seq = {0};
+		CommandBufferPtr m_cmdb;
+	};
+
 	static const U QUEUE_SIZE = 1024 * 2;
-	DynamicArray<CommandBufferPtr> m_queue; ///< Command queue
-	U64 m_tail; ///< Tail of queue
-	U64 m_head; ///< Head of queue. Points to the end
-	U8 m_renderingThreadSignal; ///< Signal to the thread
+	DynamicArray<QueueSlot> m_queue; ///< Lock-free command queue. Many producers and one consumer (the server).
+	Atomic<U64> m_tail = {0}; ///< Tail of queue. The producers reserve their slots here.
+	U64 m_head = 0; ///< Head of queue. Only the server accesses it.
+	Bool m_quit = false; ///< Only the server accesses it.
+	Atomic<U32> m_serverSleeping = {0}; ///< If it's set the producers need to wake the server.
 	Mutex m_mtx; ///< Wake the thread
 	ConditionVariable m_condVar; ///< To wake up the thread
 	Thread m_thread;
+	Bool m_singleThreaded = false;
 
 	/// @name Swap_buffers_vars
 	/// @{
@@ -68,17 +86,23 @@ private:
 	ConditionVariable m_frameCondVar;
 	Mutex m_frameMtx;
 	Bool m_frameWait = false;
+
+	/// The GPU fences of the last frames. Used to know when the GPU stopped reading the persistently mapped memory
+	/// of a frame (see StagingGpuMemoryManager). Accessed only by the server thread.
+	Array<GLsync, MAX_FRAMES_IN_FLIGHT> m_frameFences = {};
+	U64 m_frame = 0;
 	/// @}
 
-	ThreadId m_serverThreadId;
+	ThreadId m_serverThreadId = 0;
 
-	/// A special command buffer that is called every time we want to wait for the server
+	/// Special command buffers that are called every time we want to wait for the server or the GPU.
 	CommandBufferPtr m_syncCommands;
+	CommandBufferPtr m_waitGpuCommands;
 	Barrier m_syncBarrier{2};
 	SpinLock m_syncLock;
 
-	/// Command buffer with an empty command.
-	CommandBufferPtr m_emptyCmdb;
+	/// Command buffer that stops the server.
+	CommandBufferPtr m_quitCmdb;
 
 	/// The function that the thread runs
 	static ANKI_USE_RESULT Error threadCallback(ThreadCallbackInfo&);
@@ -86,7 +110,18 @@ private:
 	void prepare();
 	void finish();
 
+	void pushCommandBuffer(CommandBufferPtr cmdb);
+	Bool tryPopCommandBuffer(CommandBufferPtr& cmdb);
+	void executeCommandBuffer(CommandBufferPtr& cmdb);
+
+	/// Run everything that is in the queue. Only for single threaded.
+	void drainQueue();
+
+	void sync(CommandBufferPtr& cmdb);
+
 	void swapBuffersInternal();
+
+	void waitFrameFence(GLsync& fence);
 };
 /// @}
 
@@ -78,11 +78,16 @@ public:
 	Bool bindVertexBuffer(U32 binding, BufferPtr buff, PtrSize offset, PtrSize stride, VertexStepRate stepRate)
 	{
 		VertexBuffer& b = m_vertBuffs[binding];
-		b.m_buff = static_cast<BufferImpl*>(buff.get());
-		b.m_offset = offset;
-		b.m_stride = stride;
-		b.m_stepRate = stepRate;
-		return true;
+		BufferImpl* const buffImpl = static_cast<BufferImpl*>(buff.get());
+		if(b.m_buff != buffImpl || b.m_offset != offset || b.m_stride != stride || b.m_stepRate != stepRate)
+		{
+			b.m_buff = buffImpl;
+			b.m_offset = offset;
+			b.m_stride = stride;
+			b.m_stepRate = stepRate;
+			return true;
+		}
+		return false;
 	}
 
 	class Index
@@ -95,10 +100,13 @@ public:
 
 	Bool bindIndexBuffer(BufferPtr buff, PtrSize offset, IndexType type)
 	{
-		m_idx.m_buff = static_cast<BufferImpl*>(buff.get());
+		// The offset and the type are passed to the drawcalls so only the buffer matters
+		BufferImpl* const buffImpl = static_cast<BufferImpl*>(buff.get());
+		const Bool dirty = m_idx.m_buff != buffImpl;
+		m_idx.m_buff = buffImpl;
 		m_idx.m_offset = offset;
 		m_idx.m_indexType = convertIndexType(type);
-		return true;
+		return dirty;
 	}
 	/// @}
 
@@ -478,28 +486,34 @@ public:
 		BufferImpl* m_buff = nullptr;
 		PtrSize m_offset;
 		PtrSize m_range;
+
+		/// The command buffer holds a reference to the buffer so the pointer can't be reused while recording.
+		Bool set(BufferPtr buff, PtrSize offset, PtrSize range)
+		{
+			BufferImpl* const buffImpl = static_cast<BufferImpl*>(buff.get());
+			if(m_buff != buffImpl || m_offset != offset || m_range != range)
+			{
+				m_buff = buffImpl;
+				m_offset = offset;
+				m_range = range;
+				return true;
+			}
+			return false;
+		}
 	};
 
 	Array2d<ShaderBufferBinding, MAX_DESCRIPTOR_SETS, MAX_UNIFORM_BUFFER_BINDINGS> m_ubos;
 
 	Bool bindUniformBuffer(U32 set, U32 binding, BufferPtr buff, PtrSize offset, PtrSize range)
 	{
-		ShaderBufferBinding& b = m_ubos[set][binding];
-		b.m_buff = static_cast<BufferImpl*>(buff.get());
-		b.m_offset = offset;
-		b.m_range = range;
-		return true;
+		return m_ubos[set][binding].set(buff, offset, range);
 	}
 
 	Array2d<ShaderBufferBinding, MAX_DESCRIPTOR_SETS, MAX_STORAGE_BUFFER_BINDINGS> m_ssbos;
 
 	Bool bindStorageBuffer(U32 set, U32 binding, BufferPtr buff, PtrSize offset, PtrSize range)
 	{
-		ShaderBufferBinding& b = m_ssbos[set][binding];
-		b.m_buff = static_cast<BufferImpl*>(buff.get());
-		b.m_offset = offset;
-		b.m_range = range;
-		return true;
+		return m_ssbos[set][binding].set(buff, offset, range);
 	}
 
 	class ImageBinding
@@ -513,8 +527,12 @@ public:
 	Bool bindImage(U32 set, U32 binding, const TextureViewPtr& img)
 	{
 		ImageBinding& b = m_images[set][binding];
-		b.m_texViewUuid = img->getUuid();
-		return true;
+		if(b.m_texViewUuid != img->getUuid())
+		{
+			b.m_texViewUuid = img->getUuid();
+			return true;
+		}
+		return false;
 	}
 
 	ShaderProgramImpl* m_prog = nullptr;
@@ -44,7 +44,14 @@ public:
 	/// The number of slots for a single chunk.
 	U32 m_slotsPerChunkCount = 0;
 
-	Mutex m_mtx;
+	/// Statistics.
+	/// @{
+	U32 m_chunkCount = 0;
+	U32 m_inUseSlotCount = 0;
+	PtrSize m_requestedMem = 0;
+	/// @}
+
+	mutable Mutex m_mtx;
 };
 
 ClassGpuAllocator::~ClassGpuAllocator()
@@ -132,19 +139,23 @@ ClassGpuAllocator::Class* ClassGpuAllocator::findClass(PtrSize size, U alignment
 
 ClassGpuAllocator::Chunk* ClassGpuAllocator::findChunkWithUnusedSlot(Class& cl)
 {
+	// Prefer the fullest chunk. The emptier chunks will drain and they will be freed. That keeps the fragmentation
+	// down without having to move allocations around
+	Chunk* out = nullptr;
 	auto it = cl.m_inUseChunks.getBegin();
 	const auto end = cl.m_inUseChunks.getEnd();
 	while(it != end)
 	{
-		if(it->m_inUseSlotCount < cl.m_slotsPerChunkCount)
+		if(it->m_inUseSlotCount < cl.m_slotsPerChunkCount
+			&& (out == nullptr || it->m_inUseSlotCount > out->m_inUseSlotCount))
 		{
-			return &(*it);
+			out = &(*it);
 		}
 
 		++it;
 	}
 
-	return nullptr;
+	return out;
 }
 
 Error ClassGpuAllocator::createChunk(Class& cl, Chunk*& chunk)
@@ -162,6 +173,7 @@ Error ClassGpuAllocator::createChunk(Class& cl, Chunk*& chunk)
 
 	// Update stats
 	m_allocatedMem += cl.m_chunkSize;
+	++cl.m_chunkCount;
 	return Error::NONE;
 }
 
@@ -174,6 +186,8 @@ void ClassGpuAllocator::destroyChunk(Class& cl, Chunk& chunk)
 	// Update stats
 	ANKI_ASSERT(m_allocatedMem >= cl.m_chunkSize);
 	m_allocatedMem -= cl.m_chunkSize;
+	ANKI_ASSERT(cl.m_chunkCount > 0);
+	--cl.m_chunkCount;
 }
 
 Error ClassGpuAllocator::allocate(PtrSize size, U alignment, ClassGpuAllocatorHandle& handle)
@@ -206,6 +220,10 @@ Error ClassGpuAllocator::allocate(PtrSize size, U alignment, ClassGpuAllocatorHa
 			handle.m_memory = chunk->m_mem;
 			handle.m_offset = i * cl->m_maxSlotSize;
 			handle.m_chunk = chunk;
+			handle.m_size = size;
+
+			++cl->m_inUseSlotCount;
+			cl->m_requestedMem += size;
 
 			break;
 		}
@@ -232,6 +250,10 @@ void ClassGpuAllocator::free(ClassGpuAllocatorHandle& handle)
 	chunk.m_inUseSlots.unset(slotIdx);
 	--chunk.m_inUseSlotCount;
 
+	ANKI_ASSERT(cl.m_inUseSlotCount > 0 && cl.m_requestedMem >= handle.m_size);
+	--cl.m_inUseSlotCount;
+	cl.m_requestedMem -= handle.m_size;
+
 	if(chunk.m_inUseSlotCount == 0)
 	{
 		destroyChunk(cl, chunk);
@@ -240,4 +262,16 @@ void ClassGpuAllocator::free(ClassGpuAllocatorHandle& handle)
 	handle = {};
 }
 
+void ClassGpuAllocator::getClassStats(U32 classIdx, ClassGpuAllocatorClassStats& stats) const
+{
+	const Class& cl = m_classes[classIdx];
+
+	LockGuard<Mutex> lock(cl.m_mtx);
+	stats.m_slotSize = cl.m_maxSlotSize;
+	stats.m_chunkCount = cl.m_chunkCount;
+	stats.m_allocatedMemory = cl.m_chunkCount * cl.m_chunkSize;
+	stats.m_usedMemory = cl.m_inUseSlotCount * cl.m_maxSlotSize;
+	stats.m_requestedMemory = cl.m_requestedMem;
+}
+
 } // end namespace anki
@@ -60,6 +60,7 @@ public:
 
 private:
 	ClassGpuAllocatorChunk* m_chunk = nullptr;
+	PtrSize m_size = 0; ///< The size that was asked.
 
 	Bool valid() const
 	{
@@ -67,6 +68,17 @@ private:
 	}
 };
 
+/// Statistics of a class of ClassGpuAllocator.
+class ClassGpuAllocatorClassStats
+{
+public:
+	PtrSize m_slotSize = 0;
+	U32 m_chunkCount = 0;
+	PtrSize m_allocatedMemory = 0; ///< The memory of the chunks.
+	PtrSize m_usedMemory = 0; ///< The memory of the slots in use. The rest of the allocated memory is fragmented.
+	PtrSize m_requestedMemory = 0; ///< The memory the allocations asked for. The rest of the used memory is wasted.
+};
+
 /// Class based allocator.
 class ClassGpuAllocator : public NonCopyable
 {
@@ -90,6 +102,15 @@ public:
 		return m_allocatedMem;
 	}
 
+	U32 getClassCount() const
+	{
+		return m_classes.getSize();
+	}
+
+	/// Get the statistics of a class.
+	/// @note It's thread-safe.
+	void getClassStats(U32 classIdx, ClassGpuAllocatorClassStats& stats) const;
+
 private:
 	using Class = ClassGpuAllocatorClass;
 	using Chunk = ClassGpuAllocatorChunk;
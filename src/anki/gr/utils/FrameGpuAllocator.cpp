@@ -21,6 +21,18 @@ void FrameGpuAllocator::init(PtrSize size, U32 alignment, PtrSize maxAllocationS
 	m_maxAllocationSize = maxAllocationSize;
 }
 
+void FrameGpuAllocator::destroy()
+{
+	m_size = 0;
+	m_alignment = 0;
+	m_maxAllocationSize = 0;
+	m_offset.setNonAtomically(0);
+#if ANKI_ENABLE_TRACE
+	m_lastAllocatedSize.setNonAtomically(0);
+#endif
+	m_frame = 0;
+}
+
 PtrSize FrameGpuAllocator::endFrame()
 {
 	ANKI_ASSERT(isCreated());
@@ -33,6 +33,9 @@ public:
 	/// @param maxAllocationSize The size in @a allocate cannot exceed maxAllocationSize.
 	void init(PtrSize size, U32 alignment, PtrSize maxAllocationSize = MAX_PTR_SIZE);
 
+	/// Destroy it so it can be initialized again. The GPU shouldn't use any of its memory.
+	void destroy();
+
 	/// Allocate memory for a dynamic buffer.
 	ANKI_USE_RESULT Error allocate(PtrSize size, PtrSize& outOffset);
 
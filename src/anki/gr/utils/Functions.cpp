@@ -45,6 +45,15 @@ static void writeShaderBlockMemorySimple(const ShaderVariableBlockInfo& varBlkIn
 	writeShaderBlockMemorySanityChecks<T>(varBlkInfo, elements, elementsCount, buffBegin, buffEnd);
 
 	U8* buff = static_cast<U8*>(buffBegin) + varBlkInfo.m_offset;
+
+	// The arrays of 4 component vectors have no padding so they are one copy
+	if(elementsCount == 1 || varBlkInfo.m_arrayStride == static_cast<I16>(sizeof(T)))
+	{
+		ANKI_ASSERT(buff + sizeof(T) * elementsCount <= static_cast<const U8*>(buffEnd));
+		memcpy(buff, elements, sizeof(T) * elementsCount);
+		return;
+	}
+
 	for(U i = 0; i < elementsCount; i++)
 	{
 		ANKI_ASSERT(buff + sizeof(T) <= static_cast<const U8*>(buffEnd));
@@ -69,6 +78,17 @@ static void writeShaderBlockMemoryMatrix(const ShaderVariableBlockInfo& varBlkIn
 	ANKI_ASSERT(varBlkInfo.m_matrixStride >= static_cast<I16>(sizeof(Vec)));
 
 	U8* buff = static_cast<U8*>(buffBegin) + varBlkInfo.m_offset;
+
+	// The rows of the matrices are stored one after the other. If there is no padding between them, like in the Mat4
+	// arrays, the whole array is one copy
+	if(varBlkInfo.m_matrixStride == static_cast<I16>(sizeof(Vec))
+		&& (elementsCount == 1 || varBlkInfo.m_arrayStride == static_cast<I16>(sizeof(T))))
+	{
+		ANKI_ASSERT(buff + sizeof(T) * elementsCount <= static_cast<const U8*>(buffEnd));
+		memcpy(buff, elements, sizeof(T) * elementsCount);
+		return;
+	}
+
 	for(U i = 0; i < elementsCount; i++)
 	{
 		U8* subbuff = buff;
@@ -13,6 +13,11 @@ BufferImpl::~BufferImpl()
 {
 	ANKI_ASSERT(!m_mapped);
 
+	if(m_bindlessIndex != MAX_U32)
+	{
+		getGrManagerImpl().getDescriptorSetFactory().unbindBindlessBuffer(m_bindlessIndex);
+	}
+
 	if(m_handle)
 	{
 		vkDestroyBuffer(getDevice(), m_handle, nullptr);
@@ -43,10 +48,11 @@ Error BufferImpl::init(const BufferInitInfo& inf)
 	ci.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
 	ci.size = size;
 	ci.usage = convertBufferUsageBit(usage);
-	ci.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-	ci.queueFamilyIndexCount = 1;
-	U32 queueIdx = getGrManagerImpl().getGraphicsQueueFamily();
-	ci.pQueueFamilyIndices = &queueIdx;
+	// Share it between the graphics and the async compute queues to avoid the queue family ownership transfers
+	const ConstWeakArray<U32> queueFamilies = getGrManagerImpl().getQueueFamilies();
+	ci.sharingMode = (queueFamilies.getSize() > 1) ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE;
+	ci.queueFamilyIndexCount = queueFamilies.getSize();
+	ci.pQueueFamilyIndices = &queueFamilies[0];
 	ANKI_VK_CHECK(vkCreateBuffer(getDevice(), &ci, nullptr, &m_handle));
 	getGrManagerImpl().trySetVulkanHandleName(inf.getName(), VK_DEBUG_REPORT_OBJECT_TYPE_BUFFER_EXT, m_handle);
 
@@ -184,13 +190,19 @@ void* BufferImpl::map(PtrSize offset, PtrSize range, BufferMapAccessBit access)
 	return static_cast<void*>(static_cast<U8*>(ptr) + offset);
 }
 
-VkPipelineStageFlags BufferImpl::computePplineStage(BufferUsageBit usage)
+VkPipelineStageFlags BufferImpl::computePplineStage(BufferUsageBit usage) const
 {
 	VkPipelineStageFlags stageMask = 0;
 
 	if(!!(usage & (BufferUsageBit::UNIFORM_VERTEX | BufferUsageBit::STORAGE_VERTEX_READ_WRITE)))
 	{
 		stageMask |= VK_PIPELINE_STAGE_VERTEX_SHADER_BIT;
+
+		// The mesh pipeline reads the vertex data in its shaders
+		if(getGrManagerImpl().getDeviceCapabilities().m_meshShaders)
+		{
+			stageMask |= VK_PIPELINE_STAGE_TASK_SHADER_BIT_NV | VK_PIPELINE_STAGE_MESH_SHADER_BIT_NV;
+		}
 	}
 
 	if(!!(usage
@@ -330,4 +342,18 @@ void BufferImpl::computeBarrierInfo(BufferUsageBit before,
 	dstAccesses = computeAccessMask(after);
 }
 
+U32 BufferImpl::getOrCreateBindlessIndex()
+{
+	ANKI_ASSERT(!!(m_usage & BufferUsageBit::STORAGE_ALL) && "Should be a storage buffer");
+
+	LockGuard<SpinLock> lock(m_bindlessIndexLock);
+
+	if(m_bindlessIndex == MAX_U32)
+	{
+		m_bindlessIndex = getGrManagerImpl().getDescriptorSetFactory().bindBindlessBuffer(m_handle);
+	}
+
+	return m_bindlessIndex;
+}
+
 } // end namespace anki
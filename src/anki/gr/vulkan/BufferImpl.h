@@ -65,12 +65,19 @@ public:
 		VkPipelineStageFlags& dstStages,
 		VkAccessFlags& dstAccesses) const;
 
+	/// Get the index of the whole buffer in the bindless descriptor set. It binds it the first time.
+	/// @note It's thread-safe.
+	U32 getOrCreateBindlessIndex();
+
 private:
 	VkBuffer m_handle = VK_NULL_HANDLE;
 	GpuMemoryHandle m_memHandle;
 	VkMemoryPropertyFlags m_memoryFlags = 0;
 	PtrSize m_actualSize = 0;
 
+	U32 m_bindlessIndex = MAX_U32;
+	SpinLock m_bindlessIndexLock;
+
 #if ANKI_EXTRA_CHECKS
 	Bool m_mapped = false;
 #endif
@@ -80,7 +87,7 @@ private:
 		return m_handle != VK_NULL_HANDLE;
 	}
 
-	static VkPipelineStageFlags computePplineStage(BufferUsageBit usage);
+	VkPipelineStageFlags computePplineStage(BufferUsageBit usage) const;
 	static VkAccessFlags computeAccessMask(BufferUsageBit usage);
 };
 /// @}
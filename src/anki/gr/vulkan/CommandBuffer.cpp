@@ -36,6 +36,16 @@ void CommandBuffer::flush(FencePtr* fence)
 	}
 }
 
+void CommandBuffer::flush(ConstWeakArray<FencePtr> waitFences, FencePtr* signalFence)
+{
+	ANKI_VK_SELF(CommandBufferImpl);
+	ANKI_ASSERT(!self.isSecondLevel());
+	self.endRecording();
+
+	self.getGrManagerImpl().flushCommandBuffer(
+		CommandBufferPtr(this), signalFence, false, waitFences, signalFence != nullptr);
+}
+
 void CommandBuffer::bindVertexBuffer(
 	U32 binding, BufferPtr buff, PtrSize offset, PtrSize stride, VertexStepRate stepRate)
 {
@@ -222,6 +232,12 @@ U32 CommandBuffer::bindBindlessImage(TextureViewPtr img)
 	return self.bindBindlessImageInternal(img);
 }
 
+U32 CommandBuffer::bindBindlessBuffer(BufferPtr buff)
+{
+	ANKI_VK_SELF(CommandBufferImpl);
+	return self.bindBindlessBufferInternal(buff);
+}
+
 void CommandBuffer::bindShaderProgram(ShaderProgramPtr prog)
 {
 	ANKI_VK_SELF(CommandBufferImpl);
@@ -271,6 +287,18 @@ void CommandBuffer::drawElementsIndirect(PrimitiveTopology topology, U32 drawCou
 	self.drawElementsIndirect(topology, drawCount, offset, buff);
 }
 
+void CommandBuffer::drawMeshTasks(U32 taskCount, U32 firstTask)
+{
+	ANKI_VK_SELF(CommandBufferImpl);
+	self.drawMeshTasks(taskCount, firstTask);
+}
+
+void CommandBuffer::drawMeshTasksIndirect(U32 drawCount, PtrSize offset, BufferPtr buff)
+{
+	ANKI_VK_SELF(CommandBufferImpl);
+	self.drawMeshTasksIndirect(drawCount, offset, buff);
+}
+
 void CommandBuffer::dispatchCompute(U32 groupCountX, U32 groupCountY, U32 groupCountZ)
 {
 	ANKI_VK_SELF(CommandBufferImpl);
@@ -345,6 +373,15 @@ void CommandBuffer::setTextureVolumeBarrier(
 	self.setTextureVolumeBarrier(tex, prevUsage, nextUsage, vol);
 }
 
+void CommandBuffer::setTextureAliasingBarrier(TexturePtr tex,
+	TextureUsageBit prevAliasesUsage,
+	TextureUsageBit nextUsage,
+	const TextureSubresourceInfo& subresource)
+{
+	ANKI_VK_SELF(CommandBufferImpl);
+	self.setTextureAliasingBarrier(tex, prevAliasesUsage, nextUsage, subresource);
+}
+
 void CommandBuffer::setBufferBarrier(
 	BufferPtr buff, BufferUsageBit before, BufferUsageBit after, PtrSize offset, PtrSize size)
 {
@@ -352,6 +389,22 @@ void CommandBuffer::setBufferBarrier(
 	self.setBufferBarrier(buff, before, after, offset, size);
 }
 
+U32 CommandBuffer::beginSplitBarrier(TextureUsageBit prevUsage)
+{
+	ANKI_VK_SELF(CommandBufferImpl);
+	return self.beginSplitBarrier(prevUsage);
+}
+
+void CommandBuffer::setTextureSurfaceSplitBarrier(U32 splitBarrier,
+	TexturePtr tex,
+	TextureUsageBit prevUsage,
+	TextureUsageBit nextUsage,
+	const TextureSurfaceInfo& surf)
+{
+	ANKI_VK_SELF(CommandBufferImpl);
+	self.setTextureSurfaceSplitBarrier(splitBarrier, tex, prevUsage, nextUsage, surf);
+}
+
 void CommandBuffer::resetOcclusionQuery(OcclusionQueryPtr query)
 {
 	ANKI_VK_SELF(CommandBufferImpl);
@@ -382,12 +435,30 @@ void CommandBuffer::writeTimestamp(TimestampQueryPtr query)
 	self.writeTimestampInternal(query);
 }
 
+void CommandBuffer::beginBreadcrumb(CString name)
+{
+	ANKI_VK_SELF(CommandBufferImpl);
+	self.beginBreadcrumbInternal(name);
+}
+
+void CommandBuffer::endBreadcrumb()
+{
+	ANKI_VK_SELF(CommandBufferImpl);
+	self.endBreadcrumbInternal();
+}
+
 Bool CommandBuffer::isEmpty() const
 {
 	ANKI_VK_SELF_CONST(CommandBufferImpl);
 	return self.isEmpty();
 }
 
+void CommandBuffer::getStatistics(CommandBufferStatistics& stats) const
+{
+	ANKI_VK_SELF_CONST(CommandBufferImpl);
+	stats = self.getStatistics();
+}
+
 void CommandBuffer::setPushConstants(const void* data, U32 dataSize)
 {
 	ANKI_VK_SELF(CommandBufferImpl);
@@ -406,4 +477,10 @@ void CommandBuffer::setLineWidth(F32 width)
 	self.setLineWidth(width);
 }
 
+void CommandBuffer::setAsyncPipelineCreation(Bool enable)
+{
+	ANKI_VK_SELF(CommandBufferImpl);
+	self.setAsyncPipelineCreation(enable);
+}
+
 } // end namespace anki
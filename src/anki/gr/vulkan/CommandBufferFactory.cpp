@@ -13,11 +13,21 @@ void MicroCommandBuffer::destroy()
 {
 	reset();
 
+	for(VkEvent event : m_events)
+	{
+		vkDestroyEvent(m_threadAlloc->m_factory->m_dev, event, nullptr);
+	}
+	m_events.destroy(getAllocator());
+
 	if(m_handle)
 	{
-		vkFreeCommandBuffers(m_threadAlloc->m_factory->m_dev, m_threadAlloc->m_pool, 1, &m_handle);
+		vkFreeCommandBuffers(
+			m_threadAlloc->m_factory->m_dev, m_threadAlloc->m_pools[m_poolIdx].m_handle, 1, &m_handle);
 		m_handle = {};
 	}
+
+	m_threadAlloc->m_factory->m_cpuMemory.fetchSub(m_fastAllocCapacity);
+	m_fastAllocCapacity = 0;
 }
 
 void MicroCommandBuffer::reset()
@@ -27,21 +37,70 @@ void MicroCommandBuffer::reset()
 	ANKI_ASSERT(m_refcount.load() == 0);
 	ANKI_ASSERT(!m_fence.isCreated() || m_fence->done());
 
-	m_objectRefs.destroy(m_fastAlloc);
+	// Release the objects. The memory of the chunks goes back to the arena when the pool is reset
+	StackAllocator<U8>& arena = m_threadAlloc->m_pools[m_poolIdx].m_objectRefArena;
+	while(m_objectRefs)
+	{
+		ObjectRefChunk* prev = m_objectRefs->m_prev;
+		arena.deleteInstance(m_objectRefs);
+		m_objectRefs = prev;
+	}
 
+	const PtrSize fastAllocCapacity = m_fastAlloc.getMemoryPool().getMemoryCapacity();
+	m_threadAlloc->m_factory->m_cpuMemory.fetchAdd(fastAllocCapacity - m_fastAllocCapacity);
+	m_fastAllocCapacity = fastAllocCapacity;
 	m_fastAlloc.getMemoryPool().reset();
 
 	m_fence = {};
+
+	for(U32 i = 0; i < m_eventCount; ++i)
+	{
+		ANKI_VK_CHECKF(vkResetEvent(m_threadAlloc->m_factory->m_dev, m_events[i]));
+	}
+	m_eventCount = 0;
+}
+
+void MicroCommandBuffer::newObjectRefChunk()
+{
+	ObjectRefChunk* chunk = m_threadAlloc->m_pools[m_poolIdx].m_objectRefArena.newInstance<ObjectRefChunk>();
+	chunk->m_prev = m_objectRefs;
+	m_objectRefs = chunk;
+}
+
+VkEvent MicroCommandBuffer::newEvent()
+{
+	if(m_eventCount == m_events.getSize())
+	{
+		VkEventCreateInfo ci = {};
+		ci.sType = VK_STRUCTURE_TYPE_EVENT_CREATE_INFO;
+
+		VkEvent event;
+		ANKI_VK_CHECKF(vkCreateEvent(m_threadAlloc->m_factory->m_dev, &ci, nullptr, &event));
+		m_events.emplaceBack(getAllocator(), event);
+	}
+
+	return m_events[m_eventCount++];
 }
 
 Error CommandBufferThreadAllocator::init()
 {
+	// No VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT. The command buffers are reset together with their pool
 	VkCommandPoolCreateInfo ci = {};
 	ci.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-	ci.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+	ci.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
 	ci.queueFamilyIndex = m_factory->m_queueFamily;
 
-	ANKI_VK_CHECK(vkCreateCommandPool(m_factory->m_dev, &ci, nullptr, &m_pool));
+	for(CommandPool& pool : m_pools)
+	{
+		ANKI_VK_CHECK(vkCreateCommandPool(m_factory->m_dev, &ci, nullptr, &pool.m_handle));
+
+		pool.m_objectRefArena = StackAllocator<U8>(m_factory->m_alloc.getMemoryPool().getAllocationCallback(),
+			m_factory->m_alloc.getMemoryPool().getAllocationCallbackUserData(),
+			16_KB,
+			2.0f);
+	}
+
+	m_crntPoolFrame = m_factory->m_frame.load();
 
 	return Error::NONE;
 }
@@ -69,31 +128,50 @@ void CommandBufferThreadAllocator::destroyLists()
 			CmdbType& type = m_types[i][j];
 
 			destroyList(type.m_deletedCmdbs);
-			destroyList(type.m_readyCmdbs);
 			destroyList(type.m_inUseCmdbs);
+
+			for(CommandPool& pool : m_pools)
+			{
+				destroyList(pool.m_readyCmdbs[i][j]);
+				destroyList(pool.m_recycledCmdbs[i][j]);
+			}
 		}
 	}
 }
 
 void CommandBufferThreadAllocator::destroy()
 {
-	if(m_pool)
+	for(CommandPool& pool : m_pools)
 	{
-		vkDestroyCommandPool(m_factory->m_dev, m_pool, nullptr);
-		m_pool = {};
+		if(pool.m_handle)
+		{
+			vkDestroyCommandPool(m_factory->m_dev, pool.m_handle, nullptr);
+			pool.m_handle = {};
+		}
+
+		m_factory->m_cpuMemory.fetchSub(pool.m_objectRefArenaCapacity);
+		pool.m_objectRefArenaCapacity = 0;
+		pool.m_objectRefArena = StackAllocator<U8>();
 	}
 
 	ANKI_ASSERT(m_createdCmdbs.load() == 0 && "Someone still holds references to command buffers");
 }
 
-Error CommandBufferThreadAllocator::newCommandBuffer(
-	CommandBufferFlag cmdbFlags, MicroCommandBufferPtr& outPtr, Bool& createdNew)
+void CommandBufferThreadAllocator::recycle(MicroCommandBuffer* cmdb)
 {
-	cmdbFlags = cmdbFlags & (CommandBufferFlag::SECOND_LEVEL | CommandBufferFlag::SMALL_BATCH);
-	createdNew = false;
+	cmdb->reset();
 
-	const Bool secondLevel = !!(cmdbFlags & CommandBufferFlag::SECOND_LEVEL);
-	const Bool smallBatch = !!(cmdbFlags & CommandBufferFlag::SMALL_BATCH);
+	const Bool secondLevel = !!(cmdb->m_flags & CommandBufferFlag::SECOND_LEVEL);
+	const Bool smallBatch = !!(cmdb->m_flags & CommandBufferFlag::SMALL_BATCH);
+
+	CommandPool& pool = m_pools[cmdb->m_poolIdx];
+	pool.m_recycledCmdbs[secondLevel][smallBatch].pushBack(cmdb);
+	ANKI_ASSERT(pool.m_liveCmdbCount > 0);
+	--pool.m_liveCmdbCount;
+}
+
+void CommandBufferThreadAllocator::recycleDeleted(Bool secondLevel, Bool smallBatch)
+{
 	CmdbType& type = m_types[secondLevel][smallBatch];
 
 	// Move the deleted to (possibly) in-use
@@ -105,9 +183,10 @@ Error CommandBufferThreadAllocator::newCommandBuffer(
 			MicroCommandBuffer* ptr = &type.m_deletedCmdbs.getFront();
 			type.m_deletedCmdbs.popFront();
 
+			// The 2nd level command buffers are deleted after the primaries that executed them
 			if(secondLevel)
 			{
-				type.m_readyCmdbs.pushBack(ptr);
+				recycle(ptr);
 			}
 			else
 			{
@@ -116,58 +195,111 @@ Error CommandBufferThreadAllocator::newCommandBuffer(
 		}
 	}
 
-	// Reset the in-use command buffers and try to get one available
-	MicroCommandBuffer* out = nullptr;
-	if(!secondLevel)
+	// Recycle the primaries that are done executing
+	IntrusiveList<MicroCommandBuffer> inUseCmdbs; // Push to temporary
+	while(!type.m_inUseCmdbs.isEmpty())
+	{
+		MicroCommandBuffer* mcmdb = &type.m_inUseCmdbs.getFront();
+		type.m_inUseCmdbs.popFront();
+
+		if(!mcmdb->m_fence.isCreated() || mcmdb->m_fence->done())
+		{
+			recycle(mcmdb);
+		}
+		else
+		{
+			inUseCmdbs.pushBack(mcmdb);
+		}
+	}
+
+	type.m_inUseCmdbs = std::move(inUseCmdbs);
+}
+
+void CommandBufferThreadAllocator::rotatePools()
+{
+	const U64 frame = m_factory->m_frame.load();
+	if(frame == m_crntPoolFrame)
 	{
-		// Primary
+		return;
+	}
+
+	m_crntPoolFrame = frame;
 
-		IntrusiveList<MicroCommandBuffer> inUseCmdbs; // Push to temporary
+	// Recycle everything that can be recycled so the pools have a chance to be reset
+	for(U i = 0; i < 2; ++i)
+	{
+		for(U j = 0; j < 2; ++j)
+		{
+			recycleDeleted(i, j);
+		}
+	}
 
-		while(!type.m_inUseCmdbs.isEmpty())
+	// Pick the next pool that none of its command buffers is alive. If there is none keep using the current one
+	for(U32 i = 1; i < COMMAND_POOL_COUNT; ++i)
+	{
+		const U32 poolIdx = (m_crntPool + i) % COMMAND_POOL_COUNT;
+		CommandPool& pool = m_pools[poolIdx];
+		if(pool.m_liveCmdbCount > 0)
 		{
-			MicroCommandBuffer* mcmdb = &type.m_inUseCmdbs.getFront();
-			type.m_inUseCmdbs.popFront();
+			continue;
+		}
+
+		ANKI_TRACE_SCOPED_EVENT(VK_COMMAND_POOL_RESET);
+		ANKI_VK_CHECKF(vkResetCommandPool(m_factory->m_dev, pool.m_handle, 0));
+		m_factory->m_poolResetCount.fetchAdd(1);
+
+		const PtrSize arenaCapacity = pool.m_objectRefArena.getMemoryPool().getMemoryCapacity();
+		m_factory->m_cpuMemory.fetchAdd(arenaCapacity - pool.m_objectRefArenaCapacity);
+		pool.m_objectRefArenaCapacity = arenaCapacity;
+		pool.m_objectRefArena.getMemoryPool().reset();
 
-			if(!mcmdb->m_fence.isCreated() || mcmdb->m_fence->done())
+		for(U j = 0; j < 2; ++j)
+		{
+			for(U k = 0; k < 2; ++k)
 			{
-				// Can re-use it
-				if(out)
-				{
-					inUseCmdbs.pushBack(mcmdb);
-				}
-				else
+				IntrusiveList<MicroCommandBuffer>& recycled = pool.m_recycledCmdbs[j][k];
+				while(!recycled.isEmpty())
 				{
-					out = mcmdb;
+					MicroCommandBuffer* mcmdb = &recycled.getFront();
+					recycled.popFront();
+					pool.m_readyCmdbs[j][k].pushBack(mcmdb);
 				}
 			}
-			else
-			{
-				inUseCmdbs.pushBack(mcmdb);
-			}
 		}
 
-		ANKI_ASSERT(type.m_inUseCmdbs.isEmpty());
-		type.m_inUseCmdbs = std::move(inUseCmdbs);
+		m_crntPool = poolIdx;
+		break;
 	}
-	else
-	{
-		ANKI_ASSERT(type.m_inUseCmdbs.isEmpty());
+}
 
-		if(!type.m_readyCmdbs.isEmpty())
-		{
-			out = &type.m_readyCmdbs.getFront();
-			type.m_readyCmdbs.popFront();
-		}
-	}
+Error CommandBufferThreadAllocator::newCommandBuffer(
+	CommandBufferFlag cmdbFlags, MicroCommandBufferPtr& outPtr, Bool& createdNew)
+{
+	cmdbFlags = cmdbFlags & (CommandBufferFlag::SECOND_LEVEL | CommandBufferFlag::SMALL_BATCH);
+	createdNew = false;
 
-	if(ANKI_UNLIKELY(out == nullptr))
+	const Bool secondLevel = !!(cmdbFlags & CommandBufferFlag::SECOND_LEVEL);
+	const Bool smallBatch = !!(cmdbFlags & CommandBufferFlag::SMALL_BATCH);
+
+	rotatePools();
+	recycleDeleted(secondLevel, smallBatch);
+
+	// Try to get one that is ready to record from the current pool
+	CommandPool& pool = m_pools[m_crntPool];
+	IntrusiveList<MicroCommandBuffer>& readyCmdbs = pool.m_readyCmdbs[secondLevel][smallBatch];
+	MicroCommandBuffer* out = nullptr;
+	if(!readyCmdbs.isEmpty())
+	{
+		out = &readyCmdbs.getFront();
+		readyCmdbs.popFront();
+	}
+	else
 	{
 		// Create a new one
 
 		VkCommandBufferAllocateInfo ci = {};
 		ci.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-		ci.commandPool = m_pool;
+		ci.commandPool = pool.m_handle;
 		ci.level = (secondLevel) ? VK_COMMAND_BUFFER_LEVEL_SECONDARY : VK_COMMAND_BUFFER_LEVEL_PRIMARY;
 		ci.commandBufferCount = 1;
 
@@ -188,17 +320,17 @@ Error CommandBufferThreadAllocator::newCommandBuffer(
 
 		newCmdb->m_handle = cmdb;
 		newCmdb->m_flags = cmdbFlags;
+		newCmdb->m_poolIdx = U8(m_crntPool);
 
 		out = newCmdb;
 
 		createdNew = true;
 	}
-	else
-	{
-		out->reset();
-	}
+
+	++pool.m_liveCmdbCount;
 
 	ANKI_ASSERT(out && out->m_refcount.load() == 0);
+	ANKI_ASSERT(out->m_poolIdx == m_crntPool);
 	ANKI_ASSERT(!!(out->m_flags & CommandBufferFlag::SECOND_LEVEL) == secondLevel);
 	ANKI_ASSERT(!!(out->m_flags & CommandBufferFlag::SMALL_BATCH) == smallBatch);
 	outPtr.reset(out);
@@ -49,11 +49,16 @@ public:
 		return m_handle;
 	}
 
+	/// Keep an object alive until the command buffer is recycled.
 	template<typename T>
 	void pushObjectRef(T& x)
 	{
-		GrObject* grobj = x.get();
-		m_objectRefs.emplaceBack(m_fastAlloc, IntrusivePtr<GrObject>(grobj));
+		if(ANKI_UNLIKELY(m_objectRefs == nullptr || m_objectRefs->m_count == ObjectRefChunk::SIZE))
+		{
+			newObjectRefChunk();
+		}
+
+		m_objectRefs->m_objects[m_objectRefs->m_count++].reset(x.get());
 	}
 
 	void setFence(MicroFencePtr& fence)
@@ -63,21 +68,44 @@ public:
 		m_fence = fence;
 	}
 
+	/// Get an unsignaled event. It will be reset and reused when the command buffer is recycled.
+	VkEvent newEvent();
+
 private:
+	/// A number of object references. The chunks are allocated from the arena of the command pool and they are
+	/// released all together when the pool is reset.
+	class ObjectRefChunk
+	{
+	public:
+		static constexpr U32 SIZE = 62;
+
+		Array<IntrusivePtr<GrObject>, SIZE> m_objects;
+		ObjectRefChunk* m_prev = nullptr;
+		U32 m_count = 0;
+	};
+
 	StackAllocator<U8> m_fastAlloc;
 	VkCommandBuffer m_handle = {};
 
 	MicroFencePtr m_fence;
-	DynamicArray<IntrusivePtr<GrObject>> m_objectRefs;
+	ObjectRefChunk* m_objectRefs = nullptr; ///< The last chunk.
+	DynamicArray<VkEvent> m_events; ///< Survive the recycling.
+	U32 m_eventCount = 0; ///< The events used since the last recycle.
 
 	// Cacheline boundary
 
 	CommandBufferThreadAllocator* m_threadAlloc;
 	Atomic<I32> m_refcount = {0};
 	CommandBufferFlag m_flags = CommandBufferFlag::NONE;
+	U8 m_poolIdx = 0; ///< The CommandBufferThreadAllocator::CommandPool it was allocated from.
+	PtrSize m_fastAllocCapacity = 0; ///< The capacity of m_fastAlloc reported to the stats.
 
 	void destroy();
+
+	/// Release everything the previous recording used. The handle will be reset with its pool.
 	void reset();
+
+	void newObjectRefChunk();
 };
 
 /// Deleter.
@@ -90,7 +118,9 @@ public:
 /// Micro command buffer pointer.
 using MicroCommandBufferPtr = IntrusivePtr<MicroCommandBuffer, MicroCommandBufferPtrDeleter>;
 
-/// Per-thread command buffer allocator.
+/// Per-thread command buffer allocator. The command buffers are allocated from a few command pools that are used in
+/// turns, one every frame. A pool is reset as a whole when all of its command buffers are recycled and only then its
+/// command buffers are used again.
 class alignas(ANKI_CACHE_LINE_SIZE) CommandBufferThreadAllocator
 {
 	friend class CommandBufferFactory;
@@ -121,30 +151,68 @@ public:
 	void deleteCommandBuffer(MicroCommandBuffer* ptr);
 
 private:
-	CommandBufferFactory* m_factory;
-	ThreadId m_tid;
-	VkCommandPool m_pool = VK_NULL_HANDLE;
+	static constexpr U32 COMMAND_POOL_COUNT = 3;
+
+	class CommandPool
+	{
+	public:
+		VkCommandPool m_handle = VK_NULL_HANDLE;
+		StackAllocator<U8> m_objectRefArena; ///< The object references of its command buffers.
+		PtrSize m_objectRefArenaCapacity = 0; ///< The capacity of m_objectRefArena reported to the stats.
+
+		/// Ready to record, per CmdbType.
+		Array2d<IntrusiveList<MicroCommandBuffer>, 2, 2> m_readyCmdbs;
+
+		/// Recycled but they can be recorded again only after a reset of the pool, per CmdbType.
+		Array2d<IntrusiveList<MicroCommandBuffer>, 2, 2> m_recycledCmdbs;
+
+		/// The command buffers that are not recycled yet. The pool can't be reset if it's not zero.
+		U32 m_liveCmdbCount = 0;
+	};
 
 	class CmdbType
 	{
 	public:
-		IntrusiveList<MicroCommandBuffer> m_readyCmdbs;
-		IntrusiveList<MicroCommandBuffer> m_inUseCmdbs;
+		IntrusiveList<MicroCommandBuffer> m_inUseCmdbs; ///< Deleted but they might still run on the GPU.
 
 		IntrusiveList<MicroCommandBuffer> m_deletedCmdbs;
 		Mutex m_deletedMtx; ///< Lock because the dallocations may happen anywhere.
 	};
 
+	CommandBufferFactory* m_factory;
+	ThreadId m_tid;
+
+	Array<CommandPool, COMMAND_POOL_COUNT> m_pools;
+	U32 m_crntPool = 0;
+	U64 m_crntPoolFrame = 0; ///< The frame m_crntPool was picked.
+
 #if ANKI_EXTRA_CHECKS
 	Atomic<U32> m_createdCmdbs = {0};
 #endif
 
 	Array2d<CmdbType, 2, 2> m_types;
 
+	/// Recycle the deleted command buffers that are done executing.
+	void recycleDeleted(Bool secondLevel, Bool smallBatch);
+
+	void recycle(MicroCommandBuffer* cmdb);
+
+	/// Move to the next pool that can be reset. Do it once every frame.
+	void rotatePools();
+
 	void destroyList(IntrusiveList<MicroCommandBuffer>& list);
 	void destroyLists();
 };
 
+/// Command buffer statistics.
+class CommandBufferFactoryStats
+{
+public:
+	U32 m_createdCommandBufferCount = 0;
+	U32 m_commandPoolResetCount = 0; ///< Since the beginning.
+	PtrSize m_cpuMemory = 0; ///< The memory of the fast allocators and the object reference arenas.
+};
+
 /// Command bufffer object recycler.
 class CommandBufferFactory : public NonCopyable
 {
@@ -163,10 +231,18 @@ public:
 	/// Request a new command buffer.
 	ANKI_USE_RESULT Error newCommandBuffer(ThreadId tid, CommandBufferFlag cmdbFlags, MicroCommandBufferPtr& ptr);
 
+	/// The thread allocators will move to their next command pool.
+	void endFrame()
+	{
+		m_frame.fetchAdd(1);
+	}
+
 	/// Stats.
-	U32 getCreatedCommandBufferCount() const
+	void getStats(CommandBufferFactoryStats& stats) const
 	{
-		return m_createdCmdBufferCount.load();
+		stats.m_createdCommandBufferCount = m_createdCmdBufferCount.load();
+		stats.m_commandPoolResetCount = m_poolResetCount.load();
+		stats.m_cpuMemory = m_cpuMemory.load();
 	}
 
 private:
@@ -177,7 +253,11 @@ private:
 	DynamicArray<CommandBufferThreadAllocator*> m_threadAllocs;
 	SpinLock m_threadAllocMtx;
 
+	Atomic<U64> m_frame = {0};
+
 	Atomic<U32> m_createdCmdBufferCount = {0};
+	Atomic<U32> m_poolResetCount = {0};
+	Atomic<PtrSize> m_cpuMemory = {0};
 };
 /// @}
 
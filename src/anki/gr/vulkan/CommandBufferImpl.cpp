@@ -29,6 +29,9 @@ CommandBufferImpl::~CommandBufferImpl()
 
 	m_imgBarriers.destroy(m_alloc);
 	m_buffBarriers.destroy(m_alloc);
+	m_splitImgBarriers.destroy(m_alloc);
+	m_splitEvents.destroy(m_alloc);
+	m_splitBarriers.destroy(m_alloc);
 	m_queryResetAtoms.destroy(m_alloc);
 	m_writeQueryAtoms.destroy(m_alloc);
 	m_secondLevelAtoms.destroy(m_alloc);
@@ -38,8 +41,30 @@ Error CommandBufferImpl::init(const CommandBufferInitInfo& init)
 {
 	m_tid = Thread::getCurrentThreadId();
 	m_flags = init.m_flags;
-
-	ANKI_CHECK(getGrManagerImpl().getCommandBufferFactory().newCommandBuffer(m_tid, m_flags, m_microCmdb));
+	m_asyncCompute =
+		!!(m_flags & CommandBufferFlag::ASYNC_COMPUTE_WORK) && getGrManagerImpl().getAsyncComputeEnabled();
+	ANKI_ASSERT(!m_asyncCompute || !(m_flags & (CommandBufferFlag::SECOND_LEVEL | CommandBufferFlag::GRAPHICS_WORK)));
+	m_asyncTransfer =
+		!!(m_flags & CommandBufferFlag::ASYNC_TRANSFER_WORK) && getGrManagerImpl().getAsyncTransferEnabled();
+	ANKI_ASSERT(!m_asyncTransfer
+				|| !(m_flags
+					   & (CommandBufferFlag::SECOND_LEVEL | CommandBufferFlag::GRAPHICS_WORK
+						   | CommandBufferFlag::COMPUTE_WORK | CommandBufferFlag::ASYNC_COMPUTE_WORK)));
+
+	CommandBufferFactory* factory;
+	if(m_asyncCompute)
+	{
+		factory = &getGrManagerImpl().getAsyncComputeCommandBufferFactory();
+	}
+	else if(m_asyncTransfer)
+	{
+		factory = &getGrManagerImpl().getTransferCommandBufferFactory();
+	}
+	else
+	{
+		factory = &getGrManagerImpl().getCommandBufferFactory();
+	}
+	ANKI_CHECK(factory->newCommandBuffer(m_tid, m_flags, m_microCmdb));
 	m_handle = m_microCmdb->getHandle();
 
 	m_alloc = m_microCmdb->getFastAllocator();
@@ -109,6 +134,7 @@ void CommandBufferImpl::beginRenderPass(FramebufferPtr fb,
 	U32 width,
 	U32 height)
 {
+	ANKI_ASSERT(!m_asyncCompute && !m_asyncTransfer && "Only the general queue can do graphics work");
 	commandCommon();
 	ANKI_ASSERT(!insideRenderPass());
 
@@ -147,6 +173,53 @@ void CommandBufferImpl::beginRenderPass(FramebufferPtr fb,
 	m_scissorDirty = true;
 }
 
+void CommandBufferImpl::clampBarrierToQueue(VkPipelineStageFlags& srcStage,
+	VkAccessFlags& srcAccess,
+	VkPipelineStageFlags& dstStage,
+	VkAccessFlags& dstAccess) const
+{
+	if(!m_asyncCompute && !m_asyncTransfer)
+	{
+		return;
+	}
+
+	VkPipelineStageFlags supportedStages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT
+										   | VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT | VK_PIPELINE_STAGE_HOST_BIT
+										   | VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+	VkAccessFlags unsupportedAccesses =
+		VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INPUT_ATTACHMENT_READ_BIT
+		| VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT
+		| VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+	if(m_asyncCompute)
+	{
+		supportedStages |= VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	}
+	else
+	{
+		// The transfer queue can't touch the shader resources either. The other queues wait for its submits so the
+		// data will be visible to them
+		unsupportedAccesses |= VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT
+							| VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+	}
+
+	srcStage &= supportedStages;
+	srcAccess &= ~unsupportedAccesses;
+	if(srcStage == 0)
+	{
+		srcStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+		srcAccess = 0;
+	}
+
+	dstStage &= supportedStages;
+	dstAccess &= ~unsupportedAccesses;
+	if(dstStage == 0)
+	{
+		dstStage = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+		dstAccess = 0;
+	}
+}
+
 void CommandBufferImpl::beginRenderPassInternal()
 {
 	m_state.beginRenderPass(m_activeFb);
@@ -353,6 +426,29 @@ void CommandBufferImpl::generateMipmaps2d(TextureViewPtr texView)
 
 void CommandBufferImpl::flushBarriers()
 {
+	// The second halves of the split barriers. All of them go to a single wait
+	if(m_splitImgBarrierCount > 0)
+	{
+		vkCmdWaitEvents(m_handle,
+			m_splitEventCount,
+			&m_splitEvents[0],
+			m_splitSrcStageMask,
+			m_splitDstStageMask,
+			0,
+			nullptr,
+			0,
+			nullptr,
+			m_splitImgBarrierCount,
+			&m_splitImgBarriers[0]);
+
+		ANKI_TRACE_INC_COUNTER(VK_PIPELINE_BARRIERS, 1);
+
+		m_splitImgBarrierCount = 0;
+		m_splitEventCount = 0;
+		m_splitSrcStageMask = 0;
+		m_splitDstStageMask = 0;
+	}
+
 	if(m_imgBarrierCount == 0 && m_buffBarrierCount == 0)
 	{
 		return;
@@ -78,11 +78,28 @@ public:
 		return m_empty;
 	}
 
+	const CommandBufferStatistics& getStatistics() const
+	{
+		return m_stats;
+	}
+
 	Bool isSecondLevel() const
 	{
 		return !!(m_flags & CommandBufferFlag::SECOND_LEVEL);
 	}
 
+	/// It will be submitted to the async compute queue.
+	Bool isAsyncCompute() const
+	{
+		return m_asyncCompute;
+	}
+
+	VulkanQueueType getQueueType() const
+	{
+		return (m_asyncCompute) ? VulkanQueueType::ASYNC_COMPUTE
+								: ((m_asyncTransfer) ? VulkanQueueType::TRANSFER : VulkanQueueType::GENERAL);
+	}
+
 	void bindVertexBuffer(U32 binding, BufferPtr buff, PtrSize offset, PtrSize stride, VertexStepRate stepRate)
 	{
 		commandCommon();
@@ -285,6 +302,13 @@ public:
 		return idx;
 	}
 
+	U32 bindBindlessBufferInternal(BufferPtr buff)
+	{
+		const U32 idx = static_cast<BufferImpl&>(*buff).getOrCreateBindlessIndex();
+		m_microCmdb->pushObjectRef(buff);
+		return idx;
+	}
+
 	void beginRenderPass(FramebufferPtr fb,
 		const Array<TextureUsageBit, MAX_COLOR_ATTACHMENTS>& colorAttachmentUsages,
 		TextureUsageBit depthStencilAttachmentUsage,
@@ -304,6 +328,10 @@ public:
 
 	void drawElementsIndirect(PrimitiveTopology topology, U32 drawCount, PtrSize offset, BufferPtr& buff);
 
+	void drawMeshTasks(U32 taskCount, U32 firstTask);
+
+	void drawMeshTasksIndirect(U32 drawCount, PtrSize offset, BufferPtr& buff);
+
 	void dispatchCompute(U32 groupCountX, U32 groupCountY, U32 groupCountZ);
 
 	void resetOcclusionQuery(OcclusionQueryPtr query);
@@ -314,6 +342,10 @@ public:
 
 	void writeTimestampInternal(TimestampQueryPtr& query);
 
+	void beginBreadcrumbInternal(CString name);
+
+	void endBreadcrumbInternal();
+
 	void generateMipmaps2d(TextureViewPtr texView);
 
 	void clearTextureView(TextureViewPtr texView, const ClearValue& clearValue);
@@ -333,6 +365,11 @@ public:
 	void setTextureVolumeBarrier(
 		TexturePtr tex, TextureUsageBit prevUsage, TextureUsageBit nextUsage, const TextureVolumeInfo& vol);
 
+	void setTextureAliasingBarrier(TexturePtr tex,
+		TextureUsageBit prevAliasesUsage,
+		TextureUsageBit nextUsage,
+		const TextureSubresourceInfo& subresource);
+
 	void setTextureBarrierRange(
 		TexturePtr tex, TextureUsageBit prevUsage, TextureUsageBit nextUsage, const VkImageSubresourceRange& range);
 
@@ -346,6 +383,14 @@ public:
 
 	void setBufferBarrier(BufferPtr buff, BufferUsageBit before, BufferUsageBit after, PtrSize offset, PtrSize size);
 
+	U32 beginSplitBarrier(TextureUsageBit prevUsage);
+
+	void setTextureSurfaceSplitBarrier(U32 splitBarrier,
+		TexturePtr tex,
+		TextureUsageBit prevUsage,
+		TextureUsageBit nextUsage,
+		const TextureSurfaceInfo& surf);
+
 	void fillBuffer(BufferPtr buff, PtrSize offset, PtrSize size, U32 value);
 
 	void writeOcclusionQueryResultToBuffer(OcclusionQueryPtr query, PtrSize offset, BufferPtr buff);
@@ -376,6 +421,8 @@ public:
 
 	void setLineWidth(F32 width);
 
+	void setAsyncPipelineCreation(Bool enable);
+
 private:
 	StackAllocator<U8> m_alloc;
 
@@ -387,6 +434,11 @@ private:
 	Bool m_finalized = false;
 	Bool m_empty = true;
 	Bool m_beganRecording = false;
+	Bool m_asyncCompute = false;
+	Bool m_asyncTransfer = false;
+	U32 m_breadcrumb = 0; ///< The value of the breadcrumb that begun. Zero if none.
+	Bool m_asyncPipelineCreation = false;
+	CommandBufferStatistics m_stats;
 #if ANKI_EXTRA_CHECKS
 	U32 m_commandCount = 0;
 	U32 m_setPushConstantsSize = 0;
@@ -438,6 +490,26 @@ private:
 	U16 m_buffBarrierCount = 0;
 	VkPipelineStageFlags m_srcStageMask = 0;
 	VkPipelineStageFlags m_dstStageMask = 0;
+
+	DynamicArray<VkImageMemoryBarrier> m_splitImgBarriers; ///< The second halves of the split barriers.
+	DynamicArray<VkEvent> m_splitEvents; ///< The events the m_splitImgBarriers wait.
+	U16 m_splitImgBarrierCount = 0;
+	U16 m_splitEventCount = 0;
+	VkPipelineStageFlags m_splitSrcStageMask = 0;
+	VkPipelineStageFlags m_splitDstStageMask = 0;
+	/// @}
+
+	/// @name split_barriers
+	/// @{
+	class SplitBarrier
+	{
+	public:
+		VkEvent m_event;
+		VkPipelineStageFlags m_srcStage;
+		VkAccessFlags m_srcAccess;
+	};
+
+	DynamicArray<SplitBarrier> m_splitBarriers;
 	/// @}
 
 	/// @name reset_query_batch
@@ -480,7 +552,14 @@ private:
 	/// batch.
 	void flushBatches(CommandBufferCommandType type);
 
-	void drawcallCommon();
+	/// @return False if the drawcall should be skipped.
+	Bool drawcallCommon();
+
+	/// Push the descriptors of a set that has push descriptors if they changed.
+	void pushDescriptorSet(VkPipelineBindPoint bindPoint, VkPipelineLayout layout, U32 set);
+
+	/// The primitives of a number of vertices. Patches are not counted.
+	static U32 computePrimitiveCount(PrimitiveTopology topology, U32 vertCount);
 
 	Bool insideRenderPass() const
 	{
@@ -494,13 +573,20 @@ private:
 		return !!(m_flags & CommandBufferFlag::SECOND_LEVEL);
 	}
 
-	/// Flush batched image and buffer barriers.
+	/// Flush batched image and buffer barriers and the second halves of the split barriers.
 	void flushBarriers();
 
 	void flushQueryResets();
 
 	void flushWriteQueryResults();
 
+	/// Remove the stages and the accesses that the async compute queue doesn't support. The work of the other queue
+	/// those refer to is already synchronized with a semaphore.
+	void clampBarrierToQueue(VkPipelineStageFlags& srcStage,
+		VkAccessFlags& srcAccess,
+		VkPipelineStageFlags& dstStage,
+		VkAccessFlags& dstAccess) const;
+
 	void setImageBarrier(VkPipelineStageFlags srcStage,
 		VkAccessFlags srcAccess,
 		VkImageLayout prevLayout,
@@ -97,6 +97,7 @@ inline void CommandBufferImpl::setImageBarrier(VkPipelineStageFlags srcStage,
 {
 	ANKI_ASSERT(img);
 	commandCommon();
+	clampBarrierToQueue(srcStage, srcAccess, dstStage, dstAccess);
 
 	VkImageMemoryBarrier inf = {};
 	inf.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
@@ -108,6 +109,7 @@ inline void CommandBufferImpl::setImageBarrier(VkPipelineStageFlags srcStage,
 	inf.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
 	inf.image = img;
 	inf.subresourceRange = range;
+	++m_stats.m_barrierCount;
 
 #if ANKI_BATCH_COMMANDS
 	flushBatches(CommandBufferCommandType::SET_BARRIER);
@@ -204,6 +206,35 @@ inline void CommandBufferImpl::setTextureVolumeBarrier(
 	setTextureBarrierRange(tex, prevUsage, nextUsage, range);
 }
 
+inline void CommandBufferImpl::setTextureAliasingBarrier(TexturePtr tex,
+	TextureUsageBit prevAliasesUsage,
+	TextureUsageBit nextUsage,
+	const TextureSubresourceInfo& subresource)
+{
+	const TextureImpl& impl = static_cast<const TextureImpl&>(*tex);
+	ANKI_ASSERT(tex->isSubresourceValid(subresource));
+	ANKI_ASSERT(impl.usageValid(nextUsage));
+	ANKI_ASSERT(!(nextUsage & TextureUsageBit::GENERATE_MIPMAPS) && "Not supported");
+
+	VkImageSubresourceRange range;
+	impl.computeVkImageSubresourceRange(subresource, range);
+
+	// The destination is like the one of a texture that is used for the first time. The source waits the aliases
+	VkPipelineStageFlags srcStage;
+	VkAccessFlags srcAccess;
+	VkPipelineStageFlags dstStage;
+	VkAccessFlags dstAccess;
+	impl.computeBarrierInfo(
+		TextureUsageBit::NONE, nextUsage, range.baseMipLevel, srcStage, srcAccess, dstStage, dstAccess);
+	TextureImpl::computeConservativeSrcBarrierInfo(prevAliasesUsage, srcStage, srcAccess);
+	const VkImageLayout newLayout = impl.computeLayout(nextUsage, range.baseMipLevel);
+
+	setImageBarrier(
+		srcStage, srcAccess, VK_IMAGE_LAYOUT_UNDEFINED, dstStage, dstAccess, newLayout, impl.m_imageHandle, range);
+
+	m_microCmdb->pushObjectRef(tex);
+}
+
 inline void CommandBufferImpl::setBufferBarrier(VkPipelineStageFlags srcStage,
 	VkAccessFlags srcAccess,
 	VkPipelineStageFlags dstStage,
@@ -214,6 +245,7 @@ inline void CommandBufferImpl::setBufferBarrier(VkPipelineStageFlags srcStage,
 {
 	ANKI_ASSERT(buff);
 	commandCommon();
+	clampBarrierToQueue(srcStage, srcAccess, dstStage, dstAccess);
 
 	VkBufferMemoryBarrier b = {};
 	b.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
@@ -224,6 +256,7 @@ inline void CommandBufferImpl::setBufferBarrier(VkPipelineStageFlags srcStage,
 	b.buffer = buff;
 	b.offset = offset;
 	b.size = size;
+	++m_stats.m_barrierCount;
 
 #if ANKI_BATCH_COMMANDS
 	flushBatches(CommandBufferCommandType::SET_BARRIER);
@@ -259,11 +292,116 @@ inline void CommandBufferImpl::setBufferBarrier(
 	m_microCmdb->pushObjectRef(buff);
 }
 
+inline U32 CommandBufferImpl::beginSplitBarrier(TextureUsageBit prevUsage)
+{
+	commandCommon();
+	ANKI_ASSERT(!insideRenderPass());
+
+	// The textures are not known yet so be conservative
+	VkPipelineStageFlags srcStage;
+	VkAccessFlags srcAccess;
+	TextureImpl::computeConservativeSrcBarrierInfo(prevUsage, srcStage, srcAccess);
+	VkPipelineStageFlags dstStage = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+	VkAccessFlags dstAccess = 0;
+	clampBarrierToQueue(srcStage, srcAccess, dstStage, dstAccess);
+
+	const VkEvent event = m_microCmdb->newEvent();
+	m_splitBarriers.emplaceBack(m_alloc, SplitBarrier{event, srcStage, srcAccess});
+
+	ANKI_CMD(vkCmdSetEvent(m_handle, event, srcStage), ANY_OTHER_COMMAND);
+
+	return m_splitBarriers.getSize() - 1;
+}
+
+inline void CommandBufferImpl::setTextureSurfaceSplitBarrier(U32 splitBarrierIdx,
+	TexturePtr tex,
+	TextureUsageBit prevUsage,
+	TextureUsageBit nextUsage,
+	const TextureSurfaceInfo& surf)
+{
+	ANKI_ASSERT(!(nextUsage & TextureUsageBit::GENERATE_MIPMAPS) && "Not supported");
+	commandCommon();
+	ANKI_ASSERT(!insideRenderPass());
+
+	const SplitBarrier& splitBarrier = m_splitBarriers[splitBarrierIdx];
+	const TextureImpl& impl = static_cast<const TextureImpl&>(*tex);
+	ANKI_ASSERT(impl.usageValid(prevUsage));
+	ANKI_ASSERT(impl.usageValid(nextUsage));
+
+	VkImageSubresourceRange range;
+	impl.computeVkImageSubresourceRange(TextureSubresourceInfo(surf, impl.getDepthStencilAspect()), range);
+
+	// The source has to be the one of the event
+	VkPipelineStageFlags srcStage;
+	VkAccessFlags srcAccess;
+	VkPipelineStageFlags dstStage;
+	VkAccessFlags dstAccess;
+	impl.computeBarrierInfo(prevUsage, nextUsage, range.baseMipLevel, srcStage, srcAccess, dstStage, dstAccess);
+	clampBarrierToQueue(srcStage, srcAccess, dstStage, dstAccess);
+	srcStage = splitBarrier.m_srcStage;
+	srcAccess = splitBarrier.m_srcAccess;
+
+	VkImageMemoryBarrier inf = {};
+	inf.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	inf.srcAccessMask = srcAccess;
+	inf.dstAccessMask = dstAccess;
+	inf.oldLayout = impl.computeLayout(prevUsage, range.baseMipLevel);
+	inf.newLayout = impl.computeLayout(nextUsage, range.baseMipLevel);
+	inf.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	inf.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	inf.image = impl.m_imageHandle;
+	inf.subresourceRange = range;
+	++m_stats.m_barrierCount;
+
+#if ANKI_BATCH_COMMANDS
+	flushBatches(CommandBufferCommandType::SET_BARRIER);
+
+	if(m_splitImgBarriers.getSize() <= m_splitImgBarrierCount)
+	{
+		m_splitImgBarriers.resize(m_alloc, max<U32>(2, m_splitImgBarrierCount * 2));
+	}
+
+	m_splitImgBarriers[m_splitImgBarrierCount++] = inf;
+
+	// Many barriers wait the same event
+	Bool eventFound = false;
+	for(U32 i = 0; i < m_splitEventCount && !eventFound; ++i)
+	{
+		eventFound = m_splitEvents[i] == splitBarrier.m_event;
+	}
+
+	if(!eventFound)
+	{
+		if(m_splitEvents.getSize() <= m_splitEventCount)
+		{
+			m_splitEvents.resize(m_alloc, max<U32>(2, m_splitEventCount * 2));
+		}
+
+		m_splitEvents[m_splitEventCount++] = splitBarrier.m_event;
+	}
+
+	m_splitSrcStageMask |= srcStage;
+	m_splitDstStageMask |= dstStage;
+#else
+	ANKI_CMD(vkCmdWaitEvents(
+				 m_handle, 1, &splitBarrier.m_event, srcStage, dstStage, 0, nullptr, 0, nullptr, 1, &inf),
+		ANY_OTHER_COMMAND);
+	ANKI_TRACE_INC_COUNTER(VK_PIPELINE_BARRIERS, 1);
+#endif
+
+	m_microCmdb->pushObjectRef(tex);
+}
+
 inline void CommandBufferImpl::drawArrays(
 	PrimitiveTopology topology, U32 count, U32 instanceCount, U32 first, U32 baseInstance)
 {
 	m_state.setPrimitiveTopology(topology);
-	drawcallCommon();
+	if(ANKI_UNLIKELY(!drawcallCommon()))
+	{
+		return;
+	}
+
+	m_stats.m_primitiveCount += U64(computePrimitiveCount(topology, count)) * instanceCount;
 	ANKI_CMD(vkCmdDraw(m_handle, count, instanceCount, first, baseInstance), ANY_OTHER_COMMAND);
 }
 
@@ -271,7 +409,12 @@ inline void CommandBufferImpl::drawElements(
 	PrimitiveTopology topology, U32 count, U32 instanceCount, U32 firstIndex, U32 baseVertex, U32 baseInstance)
 {
 	m_state.setPrimitiveTopology(topology);
-	drawcallCommon();
+	if(ANKI_UNLIKELY(!drawcallCommon()))
+	{
+		return;
+	}
+
+	m_stats.m_primitiveCount += U64(computePrimitiveCount(topology, count)) * instanceCount;
 	ANKI_CMD(vkCmdDrawIndexed(m_handle, count, instanceCount, firstIndex, baseVertex, baseInstance), ANY_OTHER_COMMAND);
 }
 
@@ -279,7 +422,11 @@ inline void CommandBufferImpl::drawArraysIndirect(
 	PrimitiveTopology topology, U32 drawCount, PtrSize offset, BufferPtr& buff)
 {
 	m_state.setPrimitiveTopology(topology);
-	drawcallCommon();
+	if(ANKI_UNLIKELY(!drawcallCommon()))
+	{
+		return;
+	}
+
 	const BufferImpl& impl = static_cast<const BufferImpl&>(*buff);
 	ANKI_ASSERT(impl.usageValid(BufferUsageBit::INDIRECT_GRAPHICS));
 	ANKI_ASSERT((offset % 4) == 0);
@@ -293,7 +440,11 @@ inline void CommandBufferImpl::drawElementsIndirect(
 	PrimitiveTopology topology, U32 drawCount, PtrSize offset, BufferPtr& buff)
 {
 	m_state.setPrimitiveTopology(topology);
-	drawcallCommon();
+	if(ANKI_UNLIKELY(!drawcallCommon()))
+	{
+		return;
+	}
+
 	const BufferImpl& impl = static_cast<const BufferImpl&>(*buff);
 	ANKI_ASSERT(impl.usageValid(BufferUsageBit::INDIRECT_ALL));
 	ANKI_ASSERT((offset % 4) == 0);
@@ -303,6 +454,35 @@ inline void CommandBufferImpl::drawElementsIndirect(
 		ANY_OTHER_COMMAND);
 }
 
+inline void CommandBufferImpl::drawMeshTasks(U32 taskCount, U32 firstTask)
+{
+	ANKI_ASSERT(!!(m_graphicsProg->getStages() & ShaderTypeBit::MESH));
+	if(ANKI_UNLIKELY(!drawcallCommon()))
+	{
+		return;
+	}
+
+	ANKI_CMD(getGrManagerImpl().getCmdDrawMeshTasksFunction()(m_handle, taskCount, firstTask), ANY_OTHER_COMMAND);
+}
+
+inline void CommandBufferImpl::drawMeshTasksIndirect(U32 drawCount, PtrSize offset, BufferPtr& buff)
+{
+	ANKI_ASSERT(!!(m_graphicsProg->getStages() & ShaderTypeBit::MESH));
+	if(ANKI_UNLIKELY(!drawcallCommon()))
+	{
+		return;
+	}
+
+	const BufferImpl& impl = static_cast<const BufferImpl&>(*buff);
+	ANKI_ASSERT(impl.usageValid(BufferUsageBit::INDIRECT_GRAPHICS));
+	ANKI_ASSERT((offset % 4) == 0);
+	ANKI_ASSERT((offset + sizeof(DrawMeshTasksIndirectInfo) * drawCount) <= impl.getSize());
+
+	ANKI_CMD(getGrManagerImpl().getCmdDrawMeshTasksIndirectFunction()(
+				 m_handle, impl.getHandle(), offset, drawCount, sizeof(DrawMeshTasksIndirectInfo)),
+		ANY_OTHER_COMMAND);
+}
+
 inline void CommandBufferImpl::dispatchCompute(U32 groupCountX, U32 groupCountY, U32 groupCountZ)
 {
 	ANKI_ASSERT(m_computeProg);
@@ -311,11 +491,16 @@ inline void CommandBufferImpl::dispatchCompute(U32 groupCountX, U32 groupCountY,
 				&& "Forgot to set pushConstants");
 
 	commandCommon();
+	++m_stats.m_dispatchCount;
 
 	// Bind descriptors
 	for(U32 i = 0; i < MAX_DESCRIPTOR_SETS; ++i)
 	{
-		if(m_computeProg->getReflectionInfo().m_descriptorSetMask.get(i))
+		if(m_computeProg->getReflectionInfo().m_descriptorSetMask.get(i) && m_dsetState[i].isPushDescriptorSet())
+		{
+			pushDescriptorSet(VK_PIPELINE_BIND_POINT_COMPUTE, m_computeProg->getPipelineLayout().getHandle(), i);
+		}
+		else if(m_computeProg->getReflectionInfo().m_descriptorSetMask.get(i))
 		{
 			DescriptorSet dset;
 			Bool dirty;
@@ -420,6 +605,34 @@ inline void CommandBufferImpl::writeTimestampInternal(TimestampQueryPtr& query)
 	m_microCmdb->pushObjectRef(query);
 }
 
+inline void CommandBufferImpl::beginBreadcrumbInternal(CString name)
+{
+	GpuBreadcrumbs& breadcrumbs = getGrManagerImpl().getBreadcrumbs();
+	if(!breadcrumbs.isEnabled())
+	{
+		return;
+	}
+
+	ANKI_ASSERT(!insideRenderPass() && "The fill fallback can't be inside a render pass");
+	ANKI_ASSERT(m_breadcrumb == 0 && "Breadcrumbs can't nest");
+	commandCommon();
+	ANKI_CMD(m_breadcrumb = breadcrumbs.begin(m_handle, getQueueType(), name), ANY_OTHER_COMMAND);
+}
+
+inline void CommandBufferImpl::endBreadcrumbInternal()
+{
+	GpuBreadcrumbs& breadcrumbs = getGrManagerImpl().getBreadcrumbs();
+	if(!breadcrumbs.isEnabled())
+	{
+		return;
+	}
+
+	ANKI_ASSERT(m_breadcrumb != 0);
+	commandCommon();
+	ANKI_CMD(breadcrumbs.end(m_handle, getQueueType(), m_breadcrumb), ANY_OTHER_COMMAND);
+	m_breadcrumb = 0;
+}
+
 inline void CommandBufferImpl::clearTextureView(TextureViewPtr texView, const ClearValue& clearValue)
 {
 	commandCommon();
@@ -480,7 +693,26 @@ inline void CommandBufferImpl::pushSecondLevelCommandBuffer(CommandBufferPtr cmd
 	m_microCmdb->pushObjectRef(cmdb);
 }
 
-inline void CommandBufferImpl::drawcallCommon()
+inline U32 CommandBufferImpl::computePrimitiveCount(PrimitiveTopology topology, U32 vertCount)
+{
+	switch(topology)
+	{
+	case POINTS:
+		return vertCount;
+	case LINES:
+		return vertCount / 2;
+	case LINE_STRIP:
+		return (vertCount > 1) ? vertCount - 1 : 0;
+	case TRIANGLES:
+		return vertCount / 3;
+	case TRIANGLE_STRIP:
+		return (vertCount > 2) ? vertCount - 2 : 0;
+	default:
+		return 0;
+	}
+}
+
+inline Bool CommandBufferImpl::drawcallCommon()
 {
 	// Preconditions
 	commandCommon();
@@ -490,6 +722,7 @@ inline void CommandBufferImpl::drawcallCommon()
 				&& "Forgot to set pushConstants");
 
 	m_subpassContents = VK_SUBPASS_CONTENTS_INLINE;
+	++m_stats.m_drawcallCount;
 
 	if(ANKI_UNLIKELY(m_rpCommandCount == 0) && !secondLevel())
 	{
@@ -502,7 +735,11 @@ inline void CommandBufferImpl::drawcallCommon()
 	ANKI_ASSERT(m_graphicsProg);
 	Pipeline ppline;
 	Bool stateDirty;
-	m_graphicsProg->getPipelineFactory().newPipeline(m_state, ppline, stateDirty);
+	if(!m_graphicsProg->getPipelineFactory().newPipeline(m_state, ppline, stateDirty, m_asyncPipelineCreation))
+	{
+		// The pipeline is created in the background, skip the drawcall
+		return false;
+	}
 
 	if(stateDirty)
 	{
@@ -512,7 +749,11 @@ inline void CommandBufferImpl::drawcallCommon()
 	// Bind dsets
 	for(U32 i = 0; i < MAX_DESCRIPTOR_SETS; ++i)
 	{
-		if(m_graphicsProg->getReflectionInfo().m_descriptorSetMask.get(i))
+		if(m_graphicsProg->getReflectionInfo().m_descriptorSetMask.get(i) && m_dsetState[i].isPushDescriptorSet())
+		{
+			pushDescriptorSet(VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsProg->getPipelineLayout().getHandle(), i);
+		}
+		else if(m_graphicsProg->getReflectionInfo().m_descriptorSetMask.get(i))
 		{
 			DescriptorSet dset;
 			Bool dirty;
@@ -598,6 +839,7 @@ inline void CommandBufferImpl::drawcallCommon()
 #endif
 
 	ANKI_TRACE_INC_COUNTER(GR_DRAWCALLS, 1);
+	return true;
 }
 
 inline void CommandBufferImpl::commandCommon()
@@ -810,6 +1052,26 @@ inline void CommandBufferImpl::setRasterizationOrder(RasterizationOrder order)
 	}
 }
 
+inline void CommandBufferImpl::pushDescriptorSet(VkPipelineBindPoint bindPoint, VkPipelineLayout layout, U32 set)
+{
+	Bool dirty;
+	WeakArray<VkWriteDescriptorSet> writes;
+	getGrManagerImpl().getDescriptorSetFactory().newPushDescriptorSet(m_alloc, m_dsetState[set], dirty, writes);
+
+	if(dirty && writes.getSize() > 0)
+	{
+		ANKI_CMD(getGrManagerImpl().getCmdPushDescriptorSetFunction()(
+					 m_handle, bindPoint, layout, set, writes.getSize(), writes.getBegin()),
+			ANY_OTHER_COMMAND);
+	}
+}
+
+inline void CommandBufferImpl::setAsyncPipelineCreation(Bool enable)
+{
+	commandCommon();
+	m_asyncPipelineCreation = enable && getGrManagerImpl().getPipelineCompiler().isEnabled();
+}
+
 inline void CommandBufferImpl::setLineWidth(F32 width)
 {
 	commandCommon();
@@ -402,6 +402,11 @@ VkImageUsageFlags convertTextureUsage(const TextureUsageBit ak, const Format for
 		out |= VK_IMAGE_USAGE_TRANSFER_DST_BIT;
 	}
 
+	if(!!(ak & TextureUsageBit::FRAMEBUFFER_SHADING_RATE))
+	{
+		out |= VK_IMAGE_USAGE_FRAGMENT_SHADING_RATE_ATTACHMENT_BIT_KHR;
+	}
+
 	ANKI_ASSERT(out);
 	return out;
 }
@@ -54,7 +54,17 @@ enum class DescriptorType : U8
 	COUNT
 };
 
-enum class VulkanExtensions : U16
+/// The queues that the command buffers are submitted to.
+enum class VulkanQueueType : U8
+{
+	GENERAL, ///< Graphics, compute and transfer.
+	ASYNC_COMPUTE, ///< Compute and transfer only.
+	TRANSFER, ///< Transfer only.
+
+	COUNT
+};
+
+enum class VulkanExtensions : U32
 {
 	NONE = 0,
 	KHR_MAINENANCE1 = 1 << 0,
@@ -70,6 +80,14 @@ enum class VulkanExtensions : U16
 	AMD_SHADER_INFO = 1 << 10,
 	AMD_RASTERIZATION_ORDER = 1 << 11,
 	EXT_DESCRIPTOR_INDEXING = 1 << 12,
+	KHR_CREATE_RENDERPASS_2 = 1 << 13,
+	KHR_FRAGMENT_SHADING_RATE = 1 << 14,
+	KHR_PUSH_DESCRIPTOR = 1 << 15,
+	EXT_MEMORY_BUDGET = 1 << 16,
+	KHR_TIMELINE_SEMAPHORE = 1 << 17,
+	NV_MESH_SHADER = 1 << 18,
+	AMD_BUFFER_MARKER = 1 << 19,
+	KHR_SHADER_FLOAT16_INT8 = 1 << 20,
 };
 ANKI_ENUM_ALLOW_NUMERIC_OPERATIONS(VulkanExtensions, inline)
 
@@ -80,6 +98,9 @@ const F32 DESCRIPTOR_POOL_SIZE_SCALE = 2.0;
 const U DESCRIPTOR_FRAME_BUFFERING = 60 * 5; ///< How many frames worth of descriptors to buffer.
 /// @}
 
+/// Report the GPU breadcrumbs. The checks call it when the device is lost.
+void onVulkanDeviceLost();
+
 /// Check if a vulkan function failed. It will abort on failure.
 #define ANKI_VK_CHECKF(x) \
 	do \
@@ -87,6 +108,10 @@ const U DESCRIPTOR_FRAME_BUFFERING = 60 * 5; ///< How many frames worth of descr
 		VkResult rez; \
 		if((rez = (x)) < 0) \
 		{ \
+			if(rez == VK_ERROR_DEVICE_LOST) \
+			{ \
+				onVulkanDeviceLost(); \
+			} \
 			ANKI_VK_LOGF("Vulkan function failed (VkResult: %s): %s", vkResultToString(rez), #x); \
 		} \
 	} while(0)
@@ -98,6 +123,10 @@ const U DESCRIPTOR_FRAME_BUFFERING = 60 * 5; ///< How many frames worth of descr
 		VkResult rez; \
 		if((rez = (x)) < 0) \
 		{ \
+			if(rez == VK_ERROR_DEVICE_LOST) \
+			{ \
+				onVulkanDeviceLost(); \
+			} \
 			ANKI_VK_LOGE("Vulkan function failed (VkResult: %s): %s", vkResultToString(rez), #x); \
 			return Error::FUNCTION_FAILED; \
 		} \
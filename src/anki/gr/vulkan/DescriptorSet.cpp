@@ -7,6 +7,7 @@
 #include <anki/gr/Buffer.h>
 #include <anki/gr/vulkan/BufferImpl.h>
 #include <anki/util/List.h>
+#include <anki/util/FlatHashMap.h>
 #include <anki/util/HashMap.h>
 #include <anki/util/Tracer.h>
 #include <algorithm>
@@ -14,7 +15,7 @@
 namespace anki
 {
 
-/// Wraps a global descriptor set that is used to store bindless textures.
+/// Wraps a global descriptor set that is used to store bindless textures, images and storage buffers.
 class DescriptorSetFactory::BindlessDescriptorSet
 {
 public:
@@ -30,6 +31,10 @@ public:
 	/// @note It's thread-safe.
 	U32 bindImage(const VkImageView view);
 
+	/// Bind a whole storage buffer.
+	/// @note It's thread-safe.
+	U32 bindBuffer(const VkBuffer buff);
+
 	/// @note It's thread-safe.
 	void unbindTexture(U32 idx)
 	{
@@ -42,6 +47,12 @@ public:
 		unbindCommon(idx, m_freeImgIndices, m_freeImgIndexCount);
 	}
 
+	/// @note It's thread-safe.
+	void unbindBuffer(U32 idx)
+	{
+		unbindCommon(idx, m_freeBufIndices, m_freeBufIndexCount);
+	}
+
 	DescriptorSet getDescriptorSet() const
 	{
 		ANKI_ASSERT(m_dset);
@@ -66,9 +77,11 @@ private:
 
 	DynamicArray<U16> m_freeTexIndices;
 	DynamicArray<U16> m_freeImgIndices;
+	DynamicArray<U16> m_freeBufIndices;
 
 	U16 m_freeTexIndexCount ANKI_DEBUG_CODE(= MAX_U16);
 	U16 m_freeImgIndexCount ANKI_DEBUG_CODE(= MAX_U16);
+	U16 m_freeBufIndexCount ANKI_DEBUG_CODE(= MAX_U16);
 
 	void unbindCommon(U32 idx, DynamicArray<U16>& freeIndices, U16& freeIndexCount);
 };
@@ -77,6 +90,7 @@ DescriptorSetFactory::BindlessDescriptorSet::~BindlessDescriptorSet()
 {
 	ANKI_ASSERT(m_freeTexIndexCount == m_freeTexIndices.getSize() && "Forgot to unbind some textures");
 	ANKI_ASSERT(m_freeImgIndexCount == m_freeImgIndices.getSize() && "Forgot to unbind some images");
+	ANKI_ASSERT(m_freeBufIndexCount == m_freeBufIndices.getSize() && "Forgot to unbind some buffers");
 
 	if(m_pool)
 	{
@@ -91,6 +105,7 @@ DescriptorSetFactory::BindlessDescriptorSet::~BindlessDescriptorSet()
 		m_layout = VK_NULL_HANDLE;
 	}
 
+	m_freeBufIndices.destroy(m_alloc);
 	m_freeImgIndices.destroy(m_alloc);
 	m_freeTexIndices.destroy(m_alloc);
 }
@@ -101,12 +116,13 @@ Error DescriptorSetFactory::BindlessDescriptorSet::init(
 	ANKI_ASSERT(dev);
 	ANKI_ASSERT(bindlessLimits.m_bindlessTextureCount <= MAX_U16);
 	ANKI_ASSERT(bindlessLimits.m_bindlessImageCount <= MAX_U16);
+	ANKI_ASSERT(bindlessLimits.m_bindlessBufferCount <= MAX_U16);
 	m_alloc = alloc;
 	m_dev = dev;
 
 	// Create the layout
 	{
-		Array<VkDescriptorSetLayoutBinding, 2> bindings = {};
+		Array<VkDescriptorSetLayoutBinding, 3> bindings = {};
 		bindings[0].binding = 0;
 		bindings[0].stageFlags = VK_SHADER_STAGE_ALL;
 		bindings[0].descriptorCount = bindlessLimits.m_bindlessTextureCount;
@@ -115,12 +131,17 @@ Error DescriptorSetFactory::BindlessDescriptorSet::init(
 		bindings[1].stageFlags = VK_SHADER_STAGE_ALL;
 		bindings[1].descriptorCount = bindlessLimits.m_bindlessImageCount;
 		bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+		bindings[2].binding = 2;
+		bindings[2].stageFlags = VK_SHADER_STAGE_ALL;
+		bindings[2].descriptorCount = bindlessLimits.m_bindlessBufferCount;
+		bindings[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
 
-		Array<VkDescriptorBindingFlagsEXT, 2> bindingFlags = {};
+		Array<VkDescriptorBindingFlagsEXT, 3> bindingFlags = {};
 		bindingFlags[0] = VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT
 						  | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT_EXT
 						  | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT;
 		bindingFlags[1] = bindingFlags[0];
+		bindingFlags[2] = bindingFlags[0];
 
 		VkDescriptorSetLayoutBindingFlagsCreateInfoEXT extraInfos = {};
 		extraInfos.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT;
@@ -139,11 +160,13 @@ Error DescriptorSetFactory::BindlessDescriptorSet::init(
 
 	// Create the pool
 	{
-		Array<VkDescriptorPoolSize, 2> sizes = {};
+		Array<VkDescriptorPoolSize, 3> sizes = {};
 		sizes[0].type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
 		sizes[0].descriptorCount = bindlessLimits.m_bindlessTextureCount;
 		sizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
 		sizes[1].descriptorCount = bindlessLimits.m_bindlessImageCount;
+		sizes[2].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		sizes[2].descriptorCount = bindlessLimits.m_bindlessBufferCount;
 
 		VkDescriptorPoolCreateInfo ci = {};
 		ci.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
@@ -183,6 +206,14 @@ Error DescriptorSetFactory::BindlessDescriptorSet::init(
 		{
 			m_freeImgIndices[i] = U16(m_freeImgIndices.getSize() - i - 1);
 		}
+
+		m_freeBufIndices.create(m_alloc, bindlessLimits.m_bindlessBufferCount);
+		m_freeBufIndexCount = U16(m_freeBufIndices.getSize());
+
+		for(U32 i = 0; i < m_freeBufIndices.getSize(); ++i)
+		{
+			m_freeBufIndices[i] = U16(m_freeBufIndices.getSize() - i - 1);
+		}
 	}
 
 	return Error::NONE;
@@ -252,6 +283,38 @@ U32 DescriptorSetFactory::BindlessDescriptorSet::bindImage(const VkImageView vie
 	return idx;
 }
 
+U32 DescriptorSetFactory::BindlessDescriptorSet::bindBuffer(const VkBuffer buff)
+{
+	ANKI_ASSERT(buff);
+	LockGuard<Mutex> lock(m_mtx);
+	ANKI_ASSERT(m_freeBufIndexCount > 0 && "Out of indices");
+
+	// Get the index
+	--m_freeBufIndexCount;
+	const U32 idx = m_freeBufIndices[m_freeBufIndexCount];
+	ANKI_ASSERT(idx < m_freeBufIndices.getSize());
+
+	// Update the set. Bind the whole buffer, the shaders do the offsetting
+	VkDescriptorBufferInfo buffInf = {};
+	buffInf.buffer = buff;
+	buffInf.offset = 0;
+	buffInf.range = VK_WHOLE_SIZE;
+
+	VkWriteDescriptorSet write = {};
+	write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	write.pNext = nullptr;
+	write.dstSet = m_dset;
+	write.dstBinding = 2;
+	write.descriptorCount = 1;
+	write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	write.dstArrayElement = idx;
+	write.pBufferInfo = &buffInf;
+
+	vkUpdateDescriptorSets(m_dev, 1, &write, 0, nullptr);
+
+	return idx;
+}
+
 void DescriptorSetFactory::BindlessDescriptorSet::unbindCommon(
 	U32 idx, DynamicArray<U16>& freeIndices, U16& freeIndexCount)
 {
@@ -273,12 +336,12 @@ void DescriptorSetFactory::BindlessDescriptorSet::unbindCommon(
 	}
 }
 
-/// Descriptor set internal class.
+/// Descriptor set internal class. After it's written it doesn't change so it can be used by other threads as well.
 class DS : public IntrusiveListEnabled<DS>
 {
 public:
 	VkDescriptorSet m_handle = {};
-	U64 m_lastFrameUsed = MAX_U64;
+	Atomic<U64> m_lastFrameUsed = {MAX_U64}; ///< Other threads might touch it if the set is shared.
 	U64 m_hash;
 };
 
@@ -286,7 +349,7 @@ public:
 class alignas(ANKI_CACHE_LINE_SIZE) DSThreadAllocator : public NonCopyable
 {
 public:
-	const DSLayoutCacheEntry* m_layoutEntry; ///< Know your father.
+	DSLayoutCacheEntry* m_layoutEntry; ///< Know your father.
 
 	ThreadId m_tid;
 	DynamicArray<VkDescriptorPool> m_pools;
@@ -294,9 +357,14 @@ public:
 	U32 m_lastPoolFreeDSCount = 0;
 
 	IntrusiveList<DS> m_list; ///< At the left of the list are the least used sets.
-	HashMap<U64, DS*> m_hashmap;
+	FlatHashMap<U64, DS*> m_hashmap;
+
+	// Statistics since the last DescriptorSetFactory::endFrame()
+	U32 m_threadCacheHits = 0;
+	U32 m_sharedCacheHits = 0;
+	U32 m_writeCount = 0;
 
-	DSThreadAllocator(const DSLayoutCacheEntry* layout, ThreadId tid)
+	DSThreadAllocator(DSLayoutCacheEntry* layout, ThreadId tid)
 		: m_layoutEntry(layout)
 		, m_tid(tid)
 	{
@@ -314,9 +382,22 @@ public:
 		const DS*& out)
 	{
 		out = tryFindSet(hash);
-		if(out == nullptr)
+		if(out)
+		{
+			++m_threadCacheHits;
+		}
+		else
 		{
-			ANKI_CHECK(newSet(hash, bindings, tmpAlloc, out));
+			out = tryFindSharedSet(hash);
+			if(out)
+			{
+				++m_sharedCacheHits;
+			}
+			else
+			{
+				ANKI_CHECK(newSet(hash, bindings, tmpAlloc, out));
+				++m_writeCount;
+			}
 		}
 
 		return Error::NONE;
@@ -324,6 +405,10 @@ public:
 
 private:
 	ANKI_USE_RESULT const DS* tryFindSet(U64 hash);
+
+	/// Search the sets that some other thread wrote.
+	ANKI_USE_RESULT const DS* tryFindSharedSet(U64 hash);
+
 	ANKI_USE_RESULT Error newSet(U64 hash,
 		const Array<AnyBindingExtended, MAX_BINDINGS_PER_DESCRIPTOR_SET>& bindings,
 		StackAllocator<U8>& tmpAlloc,
@@ -346,6 +431,8 @@ public:
 	Array<DescriptorType, MAX_BINDINGS_PER_DESCRIPTOR_SET> m_bindingType = {};
 	U32 m_minBinding = MAX_U32;
 	U32 m_maxBinding = 0;
+	U32 m_descriptorCount = 0; ///< All the descriptors of all the bindings.
+	Bool m_pushDescriptors = false;
 
 	// Cache the create info
 	Array<VkDescriptorPoolSize, U(DescriptorType::COUNT)> m_poolSizesCreateInf = {};
@@ -354,6 +441,10 @@ public:
 	DynamicArray<DSThreadAllocator*> m_threadAllocs;
 	RWMutex m_threadAllocsMtx;
 
+	/// The sets of all the thread allocators. The thread allocators own them, this is only for sharing.
+	HashMap<U64, DS*> m_sharedSets;
+	RWMutex m_sharedSetsMtx;
+
 	DSLayoutCacheEntry(DescriptorSetFactory* factory)
 		: m_factory(factory)
 	{
@@ -361,10 +452,42 @@ public:
 
 	~DSLayoutCacheEntry();
 
-	ANKI_USE_RESULT Error init(const DescriptorBinding* bindings, U32 bindingCount, U64 hash);
+	ANKI_USE_RESULT Error init(const DescriptorBinding* bindings, U32 bindingCount, U64 hash, Bool pushDescriptors);
+
+	/// The push descriptors can't have dynamic buffers, their offsets are written in the descriptors.
+	VkDescriptorType convertType(DescriptorType type) const
+	{
+		const VkDescriptorType out = convertDescriptorType(type);
+		if(m_pushDescriptors && out == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC)
+		{
+			return VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		}
+		else if(m_pushDescriptors && out == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC)
+		{
+			return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		}
+
+		return out;
+	}
+
+	/// Populate the writes of all the descriptors of a set. The arrays should have m_descriptorCount elements.
+	void populateWrites(const Array<AnyBindingExtended, MAX_BINDINGS_PER_DESCRIPTOR_SET>& bindings,
+		VkDescriptorSet set,
+		VkWriteDescriptorSet* writeInfos,
+		VkDescriptorImageInfo* texInfos,
+		VkDescriptorBufferInfo* buffInfos) const;
 
 	/// @note Thread-safe.
 	ANKI_USE_RESULT Error getOrCreateThreadAllocator(ThreadId tid, DSThreadAllocator*& alloc);
+
+	/// Make a set that was just written visible to the other threads.
+	/// @note Thread-safe.
+	void shareSet(DS& set);
+
+	/// Stop sharing a set that its owner wants to recycle.
+	/// @return False if some other thread used the set in the meantime and it can't be recycled.
+	/// @note Thread-safe.
+	Bool unshareSet(DS& set);
 };
 
 DSThreadAllocator::~DSThreadAllocator()
@@ -444,12 +567,29 @@ const DS* DSThreadAllocator::tryFindSet(U64 hash)
 		// Remove from the list and place at the end of the list
 		m_list.erase(ds);
 		m_list.pushBack(ds);
-		ds->m_lastFrameUsed = m_layoutEntry->m_factory->m_frameCount;
+		ds->m_lastFrameUsed.store(m_layoutEntry->m_factory->m_frameCount);
 
 		return ds;
 	}
 }
 
+const DS* DSThreadAllocator::tryFindSharedSet(U64 hash)
+{
+	DSLayoutCacheEntry& entry = *m_layoutEntry;
+	RLockGuard<RWMutex> lock(entry.m_sharedSetsMtx);
+
+	auto it = entry.m_sharedSets.find(hash);
+	if(it == entry.m_sharedSets.getEnd())
+	{
+		return nullptr;
+	}
+
+	// Update it while holding the lock so the owner won't recycle it
+	DS* ds = *it;
+	ds->m_lastFrameUsed.store(m_layoutEntry->m_factory->m_frameCount);
+	return ds;
+}
+
 Error DSThreadAllocator::newSet(U64 hash,
 	const Array<AnyBindingExtended, MAX_BINDINGS_PER_DESCRIPTOR_SET>& bindings,
 	StackAllocator<U8>& tmpAlloc,
@@ -464,8 +604,8 @@ Error DSThreadAllocator::newSet(U64 hash,
 	while(it != end)
 	{
 		DS* set = &(*it);
-		U64 frameDiff = crntFrame - set->m_lastFrameUsed;
-		if(frameDiff > DESCRIPTOR_FRAME_BUFFERING)
+		const U64 frameDiff = crntFrame - set->m_lastFrameUsed.load();
+		if(frameDiff > DESCRIPTOR_FRAME_BUFFERING && m_layoutEntry->unshareSet(*set))
 		{
 			// Found something, recycle
 			auto it2 = m_hashmap.find(set->m_hash);
@@ -514,11 +654,12 @@ Error DSThreadAllocator::newSet(U64 hash,
 	}
 
 	ANKI_ASSERT(out);
-	out->m_lastFrameUsed = crntFrame;
+	out->m_lastFrameUsed.store(crntFrame);
 	out->m_hash = hash;
 
-	// Finally, write it
+	// Finally, write it and let the other threads use it
 	writeSet(bindings, *out, tmpAlloc);
+	m_layoutEntry->shareSet(*out);
 
 	out_ = out;
 	return Error::NONE;
@@ -528,120 +669,21 @@ void DSThreadAllocator::writeSet(const Array<AnyBindingExtended, MAX_BINDINGS_PE
 	const DS& set,
 	StackAllocator<U8>& tmpAlloc)
 {
-	DynamicArrayAuto<VkWriteDescriptorSet> writeInfos(tmpAlloc);
-	DynamicArrayAuto<VkDescriptorImageInfo> texInfos(tmpAlloc);
-	DynamicArrayAuto<VkDescriptorBufferInfo> buffInfos(tmpAlloc);
-
-	// First pass: Populate the VkDescriptorImageInfo and VkDescriptorBufferInfo
-	for(U bindingIdx = m_layoutEntry->m_minBinding; bindingIdx <= m_layoutEntry->m_maxBinding; ++bindingIdx)
+	const U32 descriptorCount = m_layoutEntry->m_descriptorCount;
+	if(descriptorCount == 0)
 	{
-		if(m_layoutEntry->m_activeBindings.get(bindingIdx))
-		{
-			for(U arrIdx = 0; arrIdx < m_layoutEntry->m_bindingArraySize[bindingIdx]; ++arrIdx)
-			{
-				ANKI_ASSERT(bindings[bindingIdx].m_arraySize >= m_layoutEntry->m_bindingArraySize[bindingIdx]);
-				const AnyBinding& b = (bindings[bindingIdx].m_arraySize == 1) ? bindings[bindingIdx].m_single
-																			  : bindings[bindingIdx].m_array[arrIdx];
-
-				switch(b.m_type)
-				{
-				case DescriptorType::COMBINED_TEXTURE_SAMPLER:
-				{
-					VkDescriptorImageInfo& info = *texInfos.emplaceBack();
-					info.sampler = b.m_texAndSampler.m_samplerHandle;
-					info.imageView = b.m_texAndSampler.m_imgViewHandle;
-					info.imageLayout = b.m_texAndSampler.m_layout;
-					break;
-				}
-				case DescriptorType::TEXTURE:
-				{
-					VkDescriptorImageInfo& info = *texInfos.emplaceBack();
-					info.sampler = VK_NULL_HANDLE;
-					info.imageView = b.m_tex.m_imgViewHandle;
-					info.imageLayout = b.m_tex.m_layout;
-					break;
-				}
-				case DescriptorType::SAMPLER:
-				{
-					VkDescriptorImageInfo& info = *texInfos.emplaceBack();
-					info.sampler = b.m_sampler.m_samplerHandle;
-					info.imageView = VK_NULL_HANDLE;
-					info.imageLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-					break;
-				}
-				case DescriptorType::UNIFORM_BUFFER:
-				case DescriptorType::STORAGE_BUFFER:
-				{
-					VkDescriptorBufferInfo& info = *buffInfos.emplaceBack();
-					info.buffer = b.m_buff.m_buffHandle;
-					info.offset = 0;
-					info.range = (b.m_buff.m_range == MAX_PTR_SIZE) ? VK_WHOLE_SIZE : b.m_buff.m_range;
-					break;
-				}
-				case DescriptorType::IMAGE:
-				{
-					VkDescriptorImageInfo& info = *texInfos.emplaceBack();
-					info.sampler = VK_NULL_HANDLE;
-					info.imageView = b.m_image.m_imgViewHandle;
-					info.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
-					break;
-				}
-				default:
-					ANKI_ASSERT(0);
-				}
-			}
-		}
+		return;
 	}
 
-	// Second pass: Populate the VkWriteDescriptorSet with VkDescriptorImageInfo and VkDescriptorBufferInfo
-	U32 texCounter = 0;
-	U32 buffCounter = 0;
+	DynamicArrayAuto<VkWriteDescriptorSet> writeInfos(tmpAlloc, descriptorCount);
+	DynamicArrayAuto<VkDescriptorImageInfo> texInfos(tmpAlloc, descriptorCount);
+	DynamicArrayAuto<VkDescriptorBufferInfo> buffInfos(tmpAlloc, descriptorCount);
 
-	VkWriteDescriptorSet writeTemplate = {};
-	writeTemplate.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-	writeTemplate.pNext = nullptr;
-	writeTemplate.dstSet = set.m_handle;
-	writeTemplate.descriptorCount = 1;
-
-	for(U32 bindingIdx = m_layoutEntry->m_minBinding; bindingIdx <= m_layoutEntry->m_maxBinding; ++bindingIdx)
-	{
-		if(m_layoutEntry->m_activeBindings.get(bindingIdx))
-		{
-			for(U32 arrIdx = 0; arrIdx < m_layoutEntry->m_bindingArraySize[bindingIdx]; ++arrIdx)
-			{
-				const AnyBinding& b = (bindings[bindingIdx].m_arraySize == 1) ? bindings[bindingIdx].m_single
-																			  : bindings[bindingIdx].m_array[arrIdx];
-
-				VkWriteDescriptorSet& writeInfo = *writeInfos.emplaceBack(writeTemplate);
-				writeInfo.descriptorType = convertDescriptorType(b.m_type);
-				writeInfo.dstArrayElement = arrIdx;
-				writeInfo.dstBinding = bindingIdx;
-
-				switch(b.m_type)
-				{
-				case DescriptorType::COMBINED_TEXTURE_SAMPLER:
-				case DescriptorType::TEXTURE:
-				case DescriptorType::SAMPLER:
-				case DescriptorType::IMAGE:
-					writeInfo.pImageInfo = &texInfos[texCounter++];
-					break;
-				case DescriptorType::UNIFORM_BUFFER:
-				case DescriptorType::STORAGE_BUFFER:
-					writeInfo.pBufferInfo = &buffInfos[buffCounter++];
-					break;
-				default:
-					ANKI_ASSERT(0);
-				}
-			}
-		}
-	}
+	m_layoutEntry->populateWrites(bindings, set.m_handle, &writeInfos[0], &texInfos[0], &buffInfos[0]);
 
 	// Write
-	vkUpdateDescriptorSets(m_layoutEntry->m_factory->m_dev,
-		writeInfos.getSize(),
-		(writeInfos.getSize() > 0) ? &writeInfos[0] : nullptr,
-		0,
-		nullptr);
+	ANKI_TRACE_INC_COUNTER(VK_DESCRIPTOR_SET_WRITE, 1);
+	vkUpdateDescriptorSets(m_layoutEntry->m_factory->m_dev, descriptorCount, &writeInfos[0], 0, nullptr);
 }
 
 DSLayoutCacheEntry::~DSLayoutCacheEntry()
@@ -654,6 +696,7 @@ DSLayoutCacheEntry::~DSLayoutCacheEntry()
 	}
 
 	m_threadAllocs.destroy(alloc);
+	m_sharedSets.destroy(alloc);
 
 	if(m_layoutHandle)
 	{
@@ -661,17 +704,19 @@ DSLayoutCacheEntry::~DSLayoutCacheEntry()
 	}
 }
 
-Error DSLayoutCacheEntry::init(const DescriptorBinding* bindings, U32 bindingCount, U64 hash)
+Error DSLayoutCacheEntry::init(const DescriptorBinding* bindings, U32 bindingCount, U64 hash, Bool pushDescriptors)
 {
 	ANKI_ASSERT(bindings);
 	ANKI_ASSERT(hash > 0);
 
 	m_hash = hash;
+	m_pushDescriptors = pushDescriptors;
 
 	// Create the VK layout
 	Array<VkDescriptorSetLayoutBinding, MAX_BINDINGS_PER_DESCRIPTOR_SET> vkBindings;
 	VkDescriptorSetLayoutCreateInfo ci = {};
 	ci.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	ci.flags = (pushDescriptors) ? VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR : 0;
 
 	for(U i = 0; i < bindingCount; ++i)
 	{
@@ -680,7 +725,7 @@ Error DSLayoutCacheEntry::init(const DescriptorBinding* bindings, U32 bindingCou
 
 		vk.binding = ak.m_binding;
 		vk.descriptorCount = ak.m_arraySizeMinusOne + 1;
-		vk.descriptorType = convertDescriptorType(ak.m_type);
+		vk.descriptorType = convertType(ak.m_type);
 		vk.pImmutableSamplers = nullptr;
 		vk.stageFlags = convertShaderTypeBit(ak.m_stageMask);
 
@@ -690,8 +735,11 @@ Error DSLayoutCacheEntry::init(const DescriptorBinding* bindings, U32 bindingCou
 		m_bindingArraySize[ak.m_binding] = ak.m_arraySizeMinusOne + 1;
 		m_minBinding = min<U32>(m_minBinding, ak.m_binding);
 		m_maxBinding = max<U32>(m_maxBinding, ak.m_binding);
+		m_descriptorCount += ak.m_arraySizeMinusOne + 1;
 	}
 
+	ANKI_ASSERT(!pushDescriptors || m_descriptorCount <= m_factory->m_maxPushDescriptors);
+
 	ci.bindingCount = bindingCount;
 	ci.pBindings = &vkBindings[0];
 
@@ -736,6 +784,97 @@ Error DSLayoutCacheEntry::init(const DescriptorBinding* bindings, U32 bindingCou
 	return Error::NONE;
 }
 
+void DSLayoutCacheEntry::populateWrites(const Array<AnyBindingExtended, MAX_BINDINGS_PER_DESCRIPTOR_SET>& bindings,
+	VkDescriptorSet set,
+	VkWriteDescriptorSet* writeInfos,
+	VkDescriptorImageInfo* texInfos,
+	VkDescriptorBufferInfo* buffInfos) const
+{
+	VkWriteDescriptorSet writeTemplate = {};
+	writeTemplate.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	writeTemplate.pNext = nullptr;
+	writeTemplate.dstSet = set;
+	writeTemplate.descriptorCount = 1;
+
+	U32 writeCount = 0;
+	U32 texCount = 0;
+	U32 buffCount = 0;
+	for(U32 bindingIdx = m_minBinding; bindingIdx <= m_maxBinding; ++bindingIdx)
+	{
+		if(!m_activeBindings.get(bindingIdx))
+		{
+			continue;
+		}
+
+		for(U32 arrIdx = 0; arrIdx < m_bindingArraySize[bindingIdx]; ++arrIdx)
+		{
+			ANKI_ASSERT(bindings[bindingIdx].m_arraySize >= m_bindingArraySize[bindingIdx]);
+			const AnyBinding& b = (bindings[bindingIdx].m_arraySize == 1) ? bindings[bindingIdx].m_single
+																		  : bindings[bindingIdx].m_array[arrIdx];
+
+			VkWriteDescriptorSet& writeInfo = writeInfos[writeCount++];
+			writeInfo = writeTemplate;
+			writeInfo.descriptorType = convertType(b.m_type);
+			writeInfo.dstArrayElement = arrIdx;
+			writeInfo.dstBinding = bindingIdx;
+
+			switch(b.m_type)
+			{
+			case DescriptorType::COMBINED_TEXTURE_SAMPLER:
+			{
+				VkDescriptorImageInfo& info = texInfos[texCount++];
+				info.sampler = b.m_texAndSampler.m_samplerHandle;
+				info.imageView = b.m_texAndSampler.m_imgViewHandle;
+				info.imageLayout = b.m_texAndSampler.m_layout;
+				writeInfo.pImageInfo = &info;
+				break;
+			}
+			case DescriptorType::TEXTURE:
+			{
+				VkDescriptorImageInfo& info = texInfos[texCount++];
+				info.sampler = VK_NULL_HANDLE;
+				info.imageView = b.m_tex.m_imgViewHandle;
+				info.imageLayout = b.m_tex.m_layout;
+				writeInfo.pImageInfo = &info;
+				break;
+			}
+			case DescriptorType::SAMPLER:
+			{
+				VkDescriptorImageInfo& info = texInfos[texCount++];
+				info.sampler = b.m_sampler.m_samplerHandle;
+				info.imageView = VK_NULL_HANDLE;
+				info.imageLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+				writeInfo.pImageInfo = &info;
+				break;
+			}
+			case DescriptorType::UNIFORM_BUFFER:
+			case DescriptorType::STORAGE_BUFFER:
+			{
+				VkDescriptorBufferInfo& info = buffInfos[buffCount++];
+				info.buffer = b.m_buff.m_buffHandle;
+				info.offset = (m_pushDescriptors) ? b.m_buff.m_offset : 0; // Else it's a dynamic offset
+				info.range = (b.m_buff.m_range == MAX_PTR_SIZE) ? VK_WHOLE_SIZE : b.m_buff.m_range;
+				writeInfo.pBufferInfo = &info;
+				break;
+			}
+			case DescriptorType::IMAGE:
+			{
+				VkDescriptorImageInfo& info = texInfos[texCount++];
+				info.sampler = VK_NULL_HANDLE;
+				info.imageView = b.m_image.m_imgViewHandle;
+				info.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+				writeInfo.pImageInfo = &info;
+				break;
+			}
+			default:
+				ANKI_ASSERT(0);
+			}
+		}
+	}
+
+	ANKI_ASSERT(writeCount == m_descriptorCount);
+}
+
 Error DSLayoutCacheEntry::getOrCreateThreadAllocator(ThreadId tid, DSThreadAllocator*& alloc)
 {
 	alloc = nullptr;
@@ -791,6 +930,36 @@ Error DSLayoutCacheEntry::getOrCreateThreadAllocator(ThreadId tid, DSThreadAlloc
 	return Error::NONE;
 }
 
+void DSLayoutCacheEntry::shareSet(DS& set)
+{
+	WLockGuard<RWMutex> lock(m_sharedSetsMtx);
+
+	// Some other thread might have written an identical set in the meantime. Keep the older
+	if(m_sharedSets.find(set.m_hash) == m_sharedSets.getEnd())
+	{
+		m_sharedSets.emplace(m_factory->m_alloc, set.m_hash, &set);
+	}
+}
+
+Bool DSLayoutCacheEntry::unshareSet(DS& set)
+{
+	WLockGuard<RWMutex> lock(m_sharedSetsMtx);
+
+	// Check again, some thread might have found it before the lock
+	if(m_factory->m_frameCount - set.m_lastFrameUsed.load() <= DESCRIPTOR_FRAME_BUFFERING)
+	{
+		return false;
+	}
+
+	auto it = m_sharedSets.find(set.m_hash);
+	if(it != m_sharedSets.getEnd() && *it == &set)
+	{
+		m_sharedSets.erase(m_factory->m_alloc, it);
+	}
+
+	return true;
+}
+
 void DescriptorSetState::flush(U64& hash,
 	Array<PtrSize, MAX_BINDINGS_PER_DESCRIPTOR_SET>& dynamicOffsets,
 	U32& dynamicOffsetCount,
@@ -919,10 +1088,12 @@ DescriptorSetFactory::~DescriptorSetFactory()
 {
 }
 
-Error DescriptorSetFactory::init(const GrAllocator<U8>& alloc, VkDevice dev, const BindlessLimits& bindlessLimits)
+Error DescriptorSetFactory::init(
+	const GrAllocator<U8>& alloc, VkDevice dev, const BindlessLimits& bindlessLimits, U32 maxPushDescriptors)
 {
 	m_alloc = alloc;
 	m_dev = dev;
+	m_maxPushDescriptors = maxPushDescriptors;
 
 	m_bindless = m_alloc.newInstance<BindlessDescriptorSet>();
 	ANKI_CHECK(m_bindless->init(alloc, dev, bindlessLimits));
@@ -931,6 +1102,32 @@ Error DescriptorSetFactory::init(const GrAllocator<U8>& alloc, VkDevice dev, con
 	return Error::NONE;
 }
 
+void DescriptorSetFactory::endFrame()
+{
+	// Gather the statistics of the frame. No thread should be creating sets at this point
+	DescriptorSetFactoryStats stats;
+	{
+		LockGuard<SpinLock> lock(m_cachesMtx);
+		for(DSLayoutCacheEntry* entry : m_caches)
+		{
+			RLockGuard<RWMutex> lock2(entry->m_threadAllocsMtx);
+			for(DSThreadAllocator* alloc : entry->m_threadAllocs)
+			{
+				stats.m_threadCacheHits += alloc->m_threadCacheHits;
+				stats.m_sharedCacheHits += alloc->m_sharedCacheHits;
+				stats.m_writeCount += alloc->m_writeCount;
+
+				alloc->m_threadCacheHits = 0;
+				alloc->m_sharedCacheHits = 0;
+				alloc->m_writeCount = 0;
+			}
+		}
+	}
+
+	m_lastFrameStats = stats;
+	++m_frameCount;
+}
+
 void DescriptorSetFactory::destroy()
 {
 	for(DSLayoutCacheEntry* l : m_caches)
@@ -968,6 +1165,12 @@ Error DescriptorSetFactory::newDescriptorSetLayout(const DescriptorSetLayoutInit
 		hash = 1;
 	}
 
+	ANKI_ASSERT(!init.m_pushDescriptors || m_maxPushDescriptors > 0);
+	if(init.m_pushDescriptors)
+	{
+		hash = appendHash(&init.m_pushDescriptors, sizeof(init.m_pushDescriptors), hash);
+	}
+
 	// Identify if the DS is the bindless one. It is if there is at least one binding that matches the criteria
 	Bool isBindless = false;
 	if(bindingCount > 0)
@@ -986,6 +1189,11 @@ Error DescriptorSetFactory::newDescriptorSetLayout(const DescriptorSetLayoutInit
 			{
 				// All good
 			}
+			else if(binding.m_binding == 2 && binding.m_type == DescriptorType::STORAGE_BUFFER
+					&& binding.m_arraySizeMinusOne == m_bindlessLimits.m_bindlessBufferCount - 1)
+			{
+				// All good
+			}
 			else
 			{
 				isBindless = false;
@@ -1018,7 +1226,7 @@ Error DescriptorSetFactory::newDescriptorSetLayout(const DescriptorSetLayoutInit
 		if(cache == nullptr)
 		{
 			cache = m_alloc.newInstance<DSLayoutCacheEntry>(this);
-			ANKI_CHECK(cache->init(bindings.getBegin(), bindingCount, hash));
+			ANKI_CHECK(cache->init(bindings.getBegin(), bindingCount, hash, init.m_pushDescriptors));
 
 			m_caches.resize(m_alloc, m_caches.getSize() + 1);
 			m_caches[m_caches.getSize() - 1] = cache;
@@ -1027,6 +1235,7 @@ Error DescriptorSetFactory::newDescriptorSetLayout(const DescriptorSetLayoutInit
 		// Set the layout
 		layout.m_handle = cache->m_layoutHandle;
 		layout.m_entry = cache;
+		layout.m_pushDescriptors = cache->m_pushDescriptors;
 	}
 
 	return Error::NONE;
@@ -1057,6 +1266,7 @@ Error DescriptorSetFactory::newDescriptorSet(ThreadId tid,
 
 		if(!bindlessDSet)
 		{
+			ANKI_ASSERT(!state.isPushDescriptorSet() && "Use newPushDescriptorSet()");
 			DescriptorSetLayout layout = state.m_layout;
 			DSLayoutCacheEntry& entry = *layout.m_entry;
 
@@ -1079,6 +1289,41 @@ Error DescriptorSetFactory::newDescriptorSet(ThreadId tid,
 	return Error::NONE;
 }
 
+void DescriptorSetFactory::newPushDescriptorSet(StackAllocator<U8>& tmpAlloc,
+	DescriptorSetState& state,
+	Bool& dirty,
+	WeakArray<VkWriteDescriptorSet>& writes)
+{
+	ANKI_TRACE_SCOPED_EVENT(VK_DESCRIPTOR_SET_GET_OR_CREATE);
+	ANKI_ASSERT(state.isPushDescriptorSet());
+
+	// The offsets are part of the descriptors, ignore the dynamic ones
+	U64 hash;
+	Bool bindlessDSet;
+	Array<PtrSize, MAX_BINDINGS_PER_DESCRIPTOR_SET> dynamicOffsets;
+	U32 dynamicOffsetCount;
+	state.flush(hash, dynamicOffsets, dynamicOffsetCount, bindlessDSet);
+	ANKI_ASSERT(!bindlessDSet);
+
+	dirty = hash != 0;
+	const DSLayoutCacheEntry& entry = *state.m_layout.m_entry;
+	if(!dirty || entry.m_descriptorCount == 0)
+	{
+		writes = {};
+		return;
+	}
+
+	// The writes are consumed by the command buffer so allocate them from its allocator
+	VkWriteDescriptorSet* writeInfos = tmpAlloc.newArray<VkWriteDescriptorSet>(entry.m_descriptorCount);
+	VkDescriptorImageInfo* texInfos = tmpAlloc.newArray<VkDescriptorImageInfo>(entry.m_descriptorCount);
+	VkDescriptorBufferInfo* buffInfos = tmpAlloc.newArray<VkDescriptorBufferInfo>(entry.m_descriptorCount);
+
+	entry.populateWrites(state.m_bindings, VK_NULL_HANDLE, writeInfos, texInfos, buffInfos);
+	writes = WeakArray<VkWriteDescriptorSet>(writeInfos, entry.m_descriptorCount);
+
+	ANKI_TRACE_INC_COUNTER(VK_DESCRIPTOR_SET_PUSH, 1);
+}
+
 U32 DescriptorSetFactory::bindBindlessTexture(const VkImageView view, const VkImageLayout layout)
 {
 	ANKI_ASSERT(m_bindless);
@@ -1091,6 +1336,12 @@ U32 DescriptorSetFactory::bindBindlessImage(const VkImageView view)
 	return m_bindless->bindImage(view);
 }
 
+U32 DescriptorSetFactory::bindBindlessBuffer(const VkBuffer buff)
+{
+	ANKI_ASSERT(m_bindless);
+	return m_bindless->bindBuffer(buff);
+}
+
 void DescriptorSetFactory::unbindBindlessTexture(U32 idx)
 {
 	ANKI_ASSERT(m_bindless);
@@ -1103,4 +1354,10 @@ void DescriptorSetFactory::unbindBindlessImage(U32 idx)
 	m_bindless->unbindImage(idx);
 }
 
+void DescriptorSetFactory::unbindBindlessBuffer(U32 idx)
+{
+	ANKI_ASSERT(m_bindless);
+	m_bindless->unbindBuffer(idx);
+}
+
 } // end namespace anki
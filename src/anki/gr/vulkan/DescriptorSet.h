@@ -26,17 +26,19 @@ class DSLayoutCacheEntry;
 class alignas(4) DescriptorBinding
 {
 public:
+	U16 m_arraySizeMinusOne = 0; ///< The bindless arrays can be big.
 	DescriptorType m_type = DescriptorType::COUNT;
 	ShaderTypeBit m_stageMask = ShaderTypeBit::NONE;
 	U8 m_binding = MAX_U8;
-	U8 m_arraySizeMinusOne = 0;
+	Array<U8, 3> m_padding = {}; ///< Zero it because it will be hashed.
 };
-static_assert(sizeof(DescriptorBinding) == 4, "Should be packed because it will be hashed");
+static_assert(sizeof(DescriptorBinding) == 8, "Should be packed because it will be hashed");
 
 class DescriptorSetLayoutInitInfo
 {
 public:
 	WeakArray<DescriptorBinding> m_bindings;
+	Bool m_pushDescriptors = false; ///< Push the descriptors instead of allocating sets. See VK_KHR_push_descriptor.
 };
 
 class DescriptorSetLayout
@@ -56,6 +58,11 @@ public:
 		return m_handle != VK_NULL_HANDLE;
 	}
 
+	Bool isPushDescriptor() const
+	{
+		return m_pushDescriptors;
+	}
+
 	Bool operator==(const DescriptorSetLayout& b) const
 	{
 		return m_entry == b.m_entry;
@@ -69,6 +76,7 @@ public:
 private:
 	VkDescriptorSetLayout m_handle = VK_NULL_HANDLE;
 	DSLayoutCacheEntry* m_entry = nullptr;
+	Bool m_pushDescriptors = false;
 };
 
 class TextureSamplerBinding
@@ -283,6 +291,12 @@ public:
 		m_bindlessDSetDirty = true;
 	}
 
+	/// If true use DescriptorSetFactory::newPushDescriptorSet() instead of DescriptorSetFactory::newDescriptorSet().
+	Bool isPushDescriptorSet() const
+	{
+		return m_layout.isPushDescriptor();
+	}
+
 private:
 	StackAllocator<U8> m_alloc;
 	DescriptorSetLayout m_layout;
@@ -360,6 +374,15 @@ private:
 	}
 };
 
+/// The descriptor set statistics of a frame.
+class DescriptorSetFactoryStats
+{
+public:
+	U32 m_threadCacheHits = 0; ///< Sets found in the cache of the thread.
+	U32 m_sharedCacheHits = 0; ///< Sets that other threads wrote.
+	U32 m_writeCount = 0; ///< vkUpdateDescriptorSets calls.
+};
+
 /// Creates new descriptor set layouts and descriptor sets.
 class DescriptorSetFactory
 {
@@ -370,7 +393,9 @@ public:
 	DescriptorSetFactory() = default;
 	~DescriptorSetFactory();
 
-	ANKI_USE_RESULT Error init(const GrAllocator<U8>& alloc, VkDevice dev, const BindlessLimits& bindlessLimits);
+	/// @param maxPushDescriptors The max descriptors of a push descriptor set. Zero if they are not supported.
+	ANKI_USE_RESULT Error init(
+		const GrAllocator<U8>& alloc, VkDevice dev, const BindlessLimits& bindlessLimits, U32 maxPushDescriptors);
 
 	void destroy();
 
@@ -386,9 +411,26 @@ public:
 		Array<PtrSize, MAX_BINDINGS_PER_DESCRIPTOR_SET>& dynamicOffsets,
 		U32& dynamicOffsetCount);
 
-	void endFrame()
+	/// Get the descriptor writes of a set that has a push descriptor layout. They are allocated from @a tmpAlloc and
+	/// they should be passed to vkCmdPushDescriptorSetKHR.
+	/// @note It's thread-safe.
+	void newPushDescriptorSet(StackAllocator<U8>& tmpAlloc,
+		DescriptorSetState& state,
+		Bool& dirty,
+		WeakArray<VkWriteDescriptorSet>& writes);
+
+	/// The max descriptors of a layout with DescriptorSetLayoutInitInfo::m_pushDescriptors. Zero if not supported.
+	U32 getMaxPushDescriptorCount() const
+	{
+		return m_maxPushDescriptors;
+	}
+
+	void endFrame();
+
+	/// Get the statistics of the last frame.
+	const DescriptorSetFactoryStats& getStats() const
 	{
-		++m_frameCount;
+		return m_lastFrameStats;
 	}
 
 	/// Bind a sampled image.
@@ -399,24 +441,34 @@ public:
 	/// @note It's thread-safe.
 	U32 bindBindlessImage(const VkImageView view);
 
+	/// Bind a whole storage buffer.
+	/// @note It's thread-safe.
+	U32 bindBindlessBuffer(const VkBuffer buff);
+
 	/// @note It's thread-safe.
 	void unbindBindlessTexture(U32 idx);
 
 	/// @note It's thread-safe.
 	void unbindBindlessImage(U32 idx);
 
+	/// @note It's thread-safe.
+	void unbindBindlessBuffer(U32 idx);
+
 private:
 	class BindlessDescriptorSet;
 
 	GrAllocator<U8> m_alloc;
 	VkDevice m_dev = VK_NULL_HANDLE;
 	U64 m_frameCount = 0;
+	DescriptorSetFactoryStats m_lastFrameStats;
 
 	DynamicArray<DSLayoutCacheEntry*> m_caches;
 	SpinLock m_cachesMtx; ///< Not a mutex because after a while there will be no reason to lock
 
 	BindlessDescriptorSet* m_bindless = nullptr;
 	BindlessLimits m_bindlessLimits;
+
+	U32 m_maxPushDescriptors = 0;
 };
 /// @}
 
@@ -64,6 +64,13 @@ void FenceFactory::deleteFence(MicroFence* fence)
 {
 	ANKI_ASSERT(fence);
 
+	if(fence->isTimeline())
+	{
+		// Nothing to recycle
+		m_alloc.deleteInstance(fence);
+		return;
+	}
+
 	LockGuard<Mutex> lock(m_mtx);
 
 	if(m_fences.getSize() <= m_fenceCount)
@@ -16,7 +16,7 @@ class FenceFactory;
 /// @addtogroup vulkan
 /// @{
 
-/// Fence wrapper over VkFence.
+/// Fence wrapper over VkFence or over a value of a timeline semaphore.
 class MicroFence : public NonCopyable
 {
 	friend class FenceFactory;
@@ -25,6 +25,9 @@ class MicroFence : public NonCopyable
 public:
 	MicroFence(FenceFactory* f);
 
+	/// Create a fence that is signaled when the timeline semaphore reaches a value.
+	MicroFence(FenceFactory* f, VkSemaphore timelineSemaphore, U64 timelineValue);
+
 	~MicroFence();
 
 	const VkFence& getHandle() const
@@ -33,6 +36,23 @@ public:
 		return m_handle;
 	}
 
+	Bool isTimeline() const
+	{
+		return m_timelineSemaphore != VK_NULL_HANDLE;
+	}
+
+	VkSemaphore getTimelineSemaphore() const
+	{
+		ANKI_ASSERT(isTimeline());
+		return m_timelineSemaphore;
+	}
+
+	U64 getTimelineValue() const
+	{
+		ANKI_ASSERT(isTimeline());
+		return m_timelineValue;
+	}
+
 	Atomic<U32>& getRefcount()
 	{
 		return m_refcount;
@@ -48,6 +68,8 @@ public:
 
 private:
 	VkFence m_handle = VK_NULL_HANDLE;
+	VkSemaphore m_timelineSemaphore = VK_NULL_HANDLE;
+	U64 m_timelineValue = 0;
 	Atomic<U32> m_refcount = {0};
 	FenceFactory* m_factory = nullptr;
 };
@@ -84,6 +106,15 @@ public:
 		m_dev = dev;
 	}
 
+	/// Set the entry points of VK_KHR_timeline_semaphore.
+	void initTimelineSemaphores(
+		PFN_vkGetSemaphoreCounterValueKHR pfnGetSemaphoreCounterValue, PFN_vkWaitSemaphoresKHR pfnWaitSemaphores)
+	{
+		ANKI_ASSERT(pfnGetSemaphoreCounterValue && pfnWaitSemaphores);
+		m_pfnGetSemaphoreCounterValueKHR = pfnGetSemaphoreCounterValue;
+		m_pfnWaitSemaphoresKHR = pfnWaitSemaphores;
+	}
+
 	void destroy();
 
 	/// Create a new fence pointer.
@@ -92,9 +123,18 @@ public:
 		return MicroFencePtr(newFence());
 	}
 
+	/// Create a fence that is signaled when a timeline semaphore reaches a value. There is no VkFence behind it.
+	MicroFencePtr newTimelineInstance(VkSemaphore timelineSemaphore, U64 timelineValue)
+	{
+		ANKI_ASSERT(m_pfnGetSemaphoreCounterValueKHR && "Timeline semaphores are not enabled");
+		return MicroFencePtr(m_alloc.newInstance<MicroFence>(this, timelineSemaphore, timelineValue));
+	}
+
 private:
 	GrAllocator<U8> m_alloc;
 	VkDevice m_dev = VK_NULL_HANDLE;
+	PFN_vkGetSemaphoreCounterValueKHR m_pfnGetSemaphoreCounterValueKHR = nullptr;
+	PFN_vkWaitSemaphoresKHR m_pfnWaitSemaphoresKHR = nullptr;
 	DynamicArray<MicroFence*> m_fences;
 	U32 m_fenceCount = 0;
 	Mutex m_mtx;
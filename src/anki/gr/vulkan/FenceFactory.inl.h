@@ -20,6 +20,15 @@ inline MicroFence::MicroFence(FenceFactory* f)
 	ANKI_VK_CHECKF(vkCreateFence(m_factory->m_dev, &ci, nullptr, &m_handle));
 }
 
+inline MicroFence::MicroFence(FenceFactory* f, VkSemaphore timelineSemaphore, U64 timelineValue)
+	: m_timelineSemaphore(timelineSemaphore)
+	, m_timelineValue(timelineValue)
+	, m_factory(f)
+{
+	ANKI_ASSERT(f);
+	ANKI_ASSERT(timelineSemaphore);
+}
+
 inline MicroFence::~MicroFence()
 {
 	if(m_handle)
@@ -35,12 +44,25 @@ inline GrAllocator<U8> MicroFence::getAllocator() const
 
 inline void MicroFence::wait()
 {
+	if(isTimeline())
+	{
+		clientWait(MAX_SECOND);
+		return;
+	}
+
 	ANKI_ASSERT(m_handle);
 	ANKI_VK_CHECKF(vkWaitForFences(m_factory->m_dev, 1, &m_handle, true, ~0U));
 }
 
 inline Bool MicroFence::done() const
 {
+	if(isTimeline())
+	{
+		U64 value;
+		ANKI_VK_CHECKF(m_factory->m_pfnGetSemaphoreCounterValueKHR(m_factory->m_dev, m_timelineSemaphore, &value));
+		return value >= m_timelineValue;
+	}
+
 	ANKI_ASSERT(m_handle);
 	VkResult status = vkGetFenceStatus(m_factory->m_dev, m_handle);
 	if(status == VK_SUCCESS)
@@ -49,6 +71,10 @@ inline Bool MicroFence::done() const
 	}
 	else if(status != VK_NOT_READY)
 	{
+		if(status == VK_ERROR_DEVICE_LOST)
+		{
+			onVulkanDeviceLost();
+		}
 		ANKI_VK_LOGF("vkGetFenceStatus() failed");
 	}
 
@@ -65,8 +91,21 @@ inline Bool MicroFence::clientWait(Second seconds)
 	{
 		VkResult res;
 		F64 nsf = 1e+9 * seconds;
-		U64 ns = U64(nsf);
-		ANKI_VK_CHECKF(res = vkWaitForFences(m_factory->m_dev, 1, &m_handle, true, ns));
+		U64 ns = (seconds < MAX_SECOND) ? U64(nsf) : MAX_U64;
+
+		if(isTimeline())
+		{
+			VkSemaphoreWaitInfoKHR waitInfo = {};
+			waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR;
+			waitInfo.semaphoreCount = 1;
+			waitInfo.pSemaphores = &m_timelineSemaphore;
+			waitInfo.pValues = &m_timelineValue;
+			ANKI_VK_CHECKF(res = m_factory->m_pfnWaitSemaphoresKHR(m_factory->m_dev, &waitInfo, ns));
+		}
+		else
+		{
+			ANKI_VK_CHECKF(res = vkWaitForFences(m_factory->m_dev, 1, &m_handle, true, ns));
+		}
 
 		return res != VK_TIMEOUT;
 	}
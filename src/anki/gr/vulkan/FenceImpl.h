@@ -8,6 +8,7 @@
 #include <anki/gr/Fence.h>
 #include <anki/gr/vulkan/VulkanObject.h>
 #include <anki/gr/vulkan/FenceFactory.h>
+#include <anki/gr/vulkan/SemaphoreFactory.h>
 
 namespace anki
 {
@@ -20,6 +21,9 @@ class FenceImpl final : public Fence, public VulkanObject<Fence, FenceImpl>
 {
 public:
 	MicroFencePtr m_fence;
+	/// Optional. It's signaled with the fence and it can be waited in the GPU once. Not used with timeline semaphores
+	/// because then m_fence can be waited in the GPU any number of times.
+	MicroSemaphorePtr m_semaphore;
 
 	FenceImpl(GrManager* manager, CString name)
 		: Fence(manager, name)
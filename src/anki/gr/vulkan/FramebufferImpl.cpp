@@ -49,11 +49,19 @@ Error FramebufferImpl::init(const FramebufferInitInfo& init)
 		m_aspect = init.m_depthStencilAttachment.m_textureView->getSubresource().m_depthStencilAspect;
 	}
 
+	if(init.m_shadingRateAttachment)
+	{
+		ANKI_ASSERT(getGrManagerImpl().getDeviceCapabilities().m_vrs);
+		m_refs[MAX_COLOR_ATTACHMENTS + 1] = init.m_shadingRateAttachment;
+		m_shadingRateTexelSize[0] = init.m_shadingRateAttachmentTexelWidth;
+		m_shadingRateTexelSize[1] = init.m_shadingRateAttachmentTexelHeight;
+	}
+
 	initClearValues(init);
 
 	// Create a renderpass.
 	initRpassCreateInfo(init);
-	ANKI_VK_CHECK(vkCreateRenderPass(getDevice(), &m_rpassCi, nullptr, &m_compatibleRpass));
+	ANKI_VK_CHECK(createRenderPass(m_rpassCi, m_compatibleRpass));
 	getGrManagerImpl().trySetVulkanHandleName(
 		init.getName(), VK_DEBUG_REPORT_OBJECT_TYPE_RENDER_PASS_EXT, m_compatibleRpass);
 
@@ -104,10 +112,11 @@ Error FramebufferImpl::initFbs(const FramebufferInitInfo& init)
 	VkFramebufferCreateInfo ci = {};
 	ci.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
 	ci.renderPass = m_compatibleRpass;
-	ci.attachmentCount = init.m_colorAttachmentCount + ((hasDepthStencil()) ? 1 : 0);
+	ci.attachmentCount =
+		init.m_colorAttachmentCount + ((hasDepthStencil()) ? 1 : 0) + ((hasShadingRateAttachment()) ? 1 : 0);
 	ci.layers = 1;
 
-	Array<VkImageView, MAX_COLOR_ATTACHMENTS + 1> imgViews;
+	Array<VkImageView, MAX_COLOR_ATTACHMENTS + 2> imgViews;
 	U count = 0;
 
 	for(U i = 0; i < init.m_colorAttachmentCount; ++i)
@@ -151,6 +160,12 @@ Error FramebufferImpl::initFbs(const FramebufferInitInfo& init)
 		m_refs[MAX_COLOR_ATTACHMENTS] = att.m_textureView;
 	}
 
+	if(hasShadingRateAttachment())
+	{
+		const TextureViewImpl& view = static_cast<const TextureViewImpl&>(*init.m_shadingRateAttachment);
+		imgViews[count++] = view.getHandle();
+	}
+
 	ci.width = m_width;
 	ci.height = m_height;
 
@@ -215,6 +230,94 @@ void FramebufferImpl::initRpassCreateInfo(const FramebufferInitInfo& init)
 	m_rpassCi.pSubpasses = &m_subpassDescr;
 }
 
+VkResult FramebufferImpl::createRenderPass(const VkRenderPassCreateInfo& ci, VkRenderPass& rpass) const
+{
+	if(!hasShadingRateAttachment())
+	{
+		return vkCreateRenderPass(getDevice(), &ci, nullptr, &rpass);
+	}
+
+	ANKI_ASSERT(ci.subpassCount == 1);
+
+	// Attachments
+	Array<VkAttachmentDescription2KHR, MAX_COLOR_ATTACHMENTS + 2> attachmentDescriptions = {};
+	for(U32 i = 0; i < ci.attachmentCount; ++i)
+	{
+		const VkAttachmentDescription& in = ci.pAttachments[i];
+		VkAttachmentDescription2KHR& out = attachmentDescriptions[i];
+
+		out.sType = VK_STRUCTURE_TYPE_ATTACHMENT_DESCRIPTION_2_KHR;
+		out.format = in.format;
+		out.samples = in.samples;
+		out.loadOp = in.loadOp;
+		out.storeOp = in.storeOp;
+		out.stencilLoadOp = in.stencilLoadOp;
+		out.stencilStoreOp = in.stencilStoreOp;
+		out.initialLayout = in.initialLayout;
+		out.finalLayout = in.finalLayout;
+	}
+
+	const U32 sriIdx = ci.attachmentCount;
+	VkAttachmentDescription2KHR& sriDescr = attachmentDescriptions[sriIdx];
+	sriDescr.sType = VK_STRUCTURE_TYPE_ATTACHMENT_DESCRIPTION_2_KHR;
+	sriDescr.format = convertFormat(
+		static_cast<const TextureViewImpl&>(*m_refs[MAX_COLOR_ATTACHMENTS + 1]).getTextureImpl().getFormat());
+	sriDescr.samples = VK_SAMPLE_COUNT_1_BIT;
+	sriDescr.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+	sriDescr.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+	sriDescr.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	sriDescr.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	sriDescr.initialLayout = VK_IMAGE_LAYOUT_FRAGMENT_SHADING_RATE_ATTACHMENT_OPTIMAL_KHR;
+	sriDescr.finalLayout = VK_IMAGE_LAYOUT_FRAGMENT_SHADING_RATE_ATTACHMENT_OPTIMAL_KHR;
+
+	// References
+	const VkSubpassDescription& inSubpass = ci.pSubpasses[0];
+	Array<VkAttachmentReference2KHR, MAX_COLOR_ATTACHMENTS + 2> references = {};
+	for(U32 i = 0; i < inSubpass.colorAttachmentCount; ++i)
+	{
+		references[i].sType = VK_STRUCTURE_TYPE_ATTACHMENT_REFERENCE_2_KHR;
+		references[i].attachment = inSubpass.pColorAttachments[i].attachment;
+		references[i].layout = inSubpass.pColorAttachments[i].layout;
+	}
+
+	VkAttachmentReference2KHR& dsReference = references[inSubpass.colorAttachmentCount];
+	if(inSubpass.pDepthStencilAttachment)
+	{
+		dsReference.sType = VK_STRUCTURE_TYPE_ATTACHMENT_REFERENCE_2_KHR;
+		dsReference.attachment = inSubpass.pDepthStencilAttachment->attachment;
+		dsReference.layout = inSubpass.pDepthStencilAttachment->layout;
+	}
+
+	VkAttachmentReference2KHR& sriReference = references[inSubpass.colorAttachmentCount + 1];
+	sriReference.sType = VK_STRUCTURE_TYPE_ATTACHMENT_REFERENCE_2_KHR;
+	sriReference.attachment = sriIdx;
+	sriReference.layout = VK_IMAGE_LAYOUT_FRAGMENT_SHADING_RATE_ATTACHMENT_OPTIMAL_KHR;
+
+	VkFragmentShadingRateAttachmentInfoKHR sriInfo = {};
+	sriInfo.sType = VK_STRUCTURE_TYPE_FRAGMENT_SHADING_RATE_ATTACHMENT_INFO_KHR;
+	sriInfo.pFragmentShadingRateAttachment = &sriReference;
+	sriInfo.shadingRateAttachmentTexelSize.width = m_shadingRateTexelSize[0];
+	sriInfo.shadingRateAttachmentTexelSize.height = m_shadingRateTexelSize[1];
+
+	// Subpass
+	VkSubpassDescription2KHR subpassDescr = {};
+	subpassDescr.sType = VK_STRUCTURE_TYPE_SUBPASS_DESCRIPTION_2_KHR;
+	subpassDescr.pNext = &sriInfo;
+	subpassDescr.pipelineBindPoint = inSubpass.pipelineBindPoint;
+	subpassDescr.colorAttachmentCount = inSubpass.colorAttachmentCount;
+	subpassDescr.pColorAttachments = (inSubpass.colorAttachmentCount) ? &references[0] : nullptr;
+	subpassDescr.pDepthStencilAttachment = (inSubpass.pDepthStencilAttachment) ? &dsReference : nullptr;
+
+	VkRenderPassCreateInfo2KHR ci2 = {};
+	ci2.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO_2_KHR;
+	ci2.attachmentCount = ci.attachmentCount + 1;
+	ci2.pAttachments = &attachmentDescriptions[0];
+	ci2.subpassCount = 1;
+	ci2.pSubpasses = &subpassDescr;
+
+	return getGrManagerImpl().getCreateRenderPass2Function()(getDevice(), &ci2, nullptr, &rpass);
+}
+
 VkRenderPass FramebufferImpl::getRenderPassHandle(
 	const Array<VkImageLayout, MAX_COLOR_ATTACHMENTS>& colorLayouts, VkImageLayout dsLayout)
 {
@@ -282,7 +385,7 @@ VkRenderPass FramebufferImpl::getRenderPassHandle(
 			subpassDescr.pDepthStencilAttachment = &references[subpassDescr.colorAttachmentCount];
 		}
 
-		ANKI_VK_CHECKF(vkCreateRenderPass(getDevice(), &ci, nullptr, &out));
+		ANKI_VK_CHECKF(createRenderPass(ci, out));
 		getGrManagerImpl().trySetVulkanHandleName(getName(), VK_DEBUG_REPORT_OBJECT_TYPE_RENDER_PASS_EXT, out);
 
 		m_rpasses.emplace(getAllocator(), hash, out);
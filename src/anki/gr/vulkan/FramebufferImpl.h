@@ -57,6 +57,17 @@ public:
 		stencil = !!(m_aspect & DepthStencilAspectBit::STENCIL);
 	}
 
+	void getAttachmentFormats(Array<VkFormat, MAX_COLOR_ATTACHMENTS>& colorFormats, VkFormat& depthStencilFormat) const
+	{
+		for(U32 i = 0; i < m_colorAttCount; ++i)
+		{
+			colorFormats[i] = m_attachmentDescriptions[i].format;
+		}
+
+		depthStencilFormat =
+			(hasDepthStencil()) ? m_attachmentDescriptions[m_colorAttCount].format : VK_FORMAT_UNDEFINED;
+	}
+
 	U32 getColorAttachmentCount() const
 	{
 		return m_colorAttCount;
@@ -84,6 +95,11 @@ public:
 		return m_refs[MAX_COLOR_ATTACHMENTS];
 	}
 
+	Bool hasShadingRateAttachment() const
+	{
+		return m_refs[MAX_COLOR_ATTACHMENTS + 1].isCreated();
+	}
+
 	const VkClearValue* getClearValues() const
 	{
 		return &m_clearVals[0];
@@ -112,7 +128,9 @@ private:
 	U32 m_height = 0;
 	Bool m_presentableTex = false;
 
-	Array<TextureViewPtr, MAX_COLOR_ATTACHMENTS + 1> m_refs; ///< @note The pos of every attachment is fixed.
+	/// @note The pos of every attachment is fixed. The last is the shading rate image.
+	Array<TextureViewPtr, MAX_COLOR_ATTACHMENTS + 2> m_refs;
+	Array<U32, 2> m_shadingRateTexelSize = {};
 
 	// RenderPass create info
 	VkRenderPassCreateInfo m_rpassCi = {};
@@ -132,6 +150,10 @@ private:
 	void initClearValues(const FramebufferInitInfo& init);
 	void setupAttachmentDescriptor(
 		const FramebufferAttachmentInfo& att, VkAttachmentDescription& desc, VkImageLayout layout) const;
+
+	/// Create a renderpass. If there is a shading rate image it translates the create info to the renderpass2 one and
+	/// appends the shading rate attachment.
+	VkResult createRenderPass(const VkRenderPassCreateInfo& ci, VkRenderPass& rpass) const;
 };
 /// @}
 
@@ -0,0 +1,189 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/gr/vulkan/GpuBreadcrumbs.h>
+#include <anki/gr/vulkan/GpuMemoryManager.h>
+
+namespace anki
+{
+
+GpuBreadcrumbs* GpuBreadcrumbs::m_instance = nullptr;
+
+void onVulkanDeviceLost()
+{
+	GpuBreadcrumbs::reportDeviceLost();
+}
+
+GpuBreadcrumbs::~GpuBreadcrumbs()
+{
+	ANKI_ASSERT(m_buffer == VK_NULL_HANDLE && "Forgot to call destroy()");
+}
+
+Error GpuBreadcrumbs::init(GrAllocator<U8> alloc,
+	VkDevice dev,
+	const GpuMemoryManager& memManager,
+	PFN_vkCmdWriteBufferMarkerAMD pfnWriteBufferMarker)
+{
+	m_alloc = alloc;
+	m_dev = dev;
+	m_pfnWriteBufferMarker = pfnWriteBufferMarker;
+
+	// Create the buffer. Use a dedicated allocation that stays mapped so it can be read after the device is lost
+	VkBufferCreateInfo ci = {};
+	ci.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	ci.size = sizeof(QueueMarkers) * U32(VulkanQueueType::COUNT);
+	ci.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+	ci.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	ANKI_VK_CHECK(vkCreateBuffer(m_dev, &ci, nullptr, &m_buffer));
+
+	VkMemoryRequirements req;
+	vkGetBufferMemoryRequirements(m_dev, m_buffer, &req);
+
+	const U32 memIdx = memManager.findMemoryType(
+		req.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 0);
+	if(memIdx == MAX_U32)
+	{
+		ANKI_VK_LOGE("Can't find a host coherent memory type for the breadcrumbs");
+		return Error::FUNCTION_FAILED;
+	}
+
+	VkMemoryAllocateInfo memInf = {};
+	memInf.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	memInf.allocationSize = req.size;
+	memInf.memoryTypeIndex = memIdx;
+	ANKI_VK_CHECK(vkAllocateMemory(m_dev, &memInf, nullptr, &m_memory));
+	ANKI_VK_CHECK(vkBindBufferMemory(m_dev, m_buffer, m_memory, 0));
+
+	void* mapped;
+	ANKI_VK_CHECK(vkMapMemory(m_dev, m_memory, 0, VK_WHOLE_SIZE, 0, &mapped));
+	memset(mapped, 0, ci.size);
+	m_mappedMarkers = static_cast<const QueueMarkers*>(mapped);
+
+	m_names = m_alloc.newArray<Name>(MAX_NAMES);
+
+	ANKI_ASSERT(m_instance == nullptr);
+	m_instance = this;
+
+	ANKI_VK_LOGI("GPU breadcrumbs enabled (%s)", (m_pfnWriteBufferMarker) ? "buffer markers" : "buffer fills");
+	return Error::NONE;
+}
+
+void GpuBreadcrumbs::destroy()
+{
+	if(m_instance == this)
+	{
+		m_instance = nullptr;
+	}
+
+	if(m_names)
+	{
+		m_alloc.deleteArray(m_names, MAX_NAMES);
+		m_names = nullptr;
+	}
+
+	if(m_buffer)
+	{
+		vkDestroyBuffer(m_dev, m_buffer, nullptr);
+		m_buffer = VK_NULL_HANDLE;
+	}
+
+	if(m_memory)
+	{
+		vkUnmapMemory(m_dev, m_memory);
+		vkFreeMemory(m_dev, m_memory, nullptr);
+		m_memory = VK_NULL_HANDLE;
+		m_mappedMarkers = nullptr;
+	}
+}
+
+U32 GpuBreadcrumbs::begin(VkCommandBuffer cmdb, VulkanQueueType queue, CString name)
+{
+	ANKI_ASSERT(isEnabled());
+
+	U32 value = m_nextValue.fetchAdd(1);
+	if(ANKI_UNLIKELY(value == 0))
+	{
+		// Zero means no marker, skip it
+		value = m_nextValue.fetchAdd(1);
+	}
+
+	Name& n = m_names[value % MAX_NAMES];
+	const U32 len = (!name.isEmpty()) ? min<U32>(name.getLength(), MAX_NAME_LENGTH) : 0;
+	if(len)
+	{
+		memcpy(&n.m_name[0], name.cstr(), len);
+	}
+	n.m_name[len] = '\0';
+	n.m_value = value;
+
+	write(cmdb, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, sizeof(QueueMarkers) * U32(queue), value);
+	return value;
+}
+
+void GpuBreadcrumbs::end(VkCommandBuffer cmdb, VulkanQueueType queue, U32 value)
+{
+	ANKI_ASSERT(isEnabled() && value != 0);
+	write(cmdb, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, sizeof(QueueMarkers) * U32(queue) + sizeof(U32), value);
+}
+
+void GpuBreadcrumbs::write(VkCommandBuffer cmdb, VkPipelineStageFlagBits stage, PtrSize offset, U32 value) const
+{
+	if(m_pfnWriteBufferMarker)
+	{
+		// It's written when all the previous commands reach the stage
+		m_pfnWriteBufferMarker(cmdb, stage, m_buffer, offset, value);
+	}
+	else
+	{
+		// A transfer that is not ordered with the rest of the commands. It's less accurate but good enough
+		vkCmdFillBuffer(cmdb, m_buffer, offset, sizeof(U32), value);
+	}
+}
+
+CString GpuBreadcrumbs::getName(U32 value) const
+{
+	if(value == 0)
+	{
+		return "<none>";
+	}
+
+	const Name& n = m_names[value % MAX_NAMES];
+	return (n.m_value == value) ? CString(&n.m_name[0]) : CString("<too old>");
+}
+
+void GpuBreadcrumbs::reportDeviceLost()
+{
+	const GpuBreadcrumbs* self = m_instance;
+	if(!self || !self->isEnabled())
+	{
+		ANKI_VK_LOGE("Device lost. Enable gr_breadcrumbs to see where the GPU stopped");
+		return;
+	}
+
+	static const Array<const char*, U32(VulkanQueueType::COUNT)> QUEUE_NAMES = {
+		{"general", "async compute", "transfer"}};
+
+	ANKI_VK_LOGE("Device lost. The last GPU breadcrumbs:");
+	for(U32 q = 0; q < U32(VulkanQueueType::COUNT); ++q)
+	{
+		const QueueMarkers& markers = self->m_mappedMarkers[q];
+		const U32 begin = markers.m_begin;
+		const U32 end = markers.m_end;
+		if(begin == 0 && end == 0)
+		{
+			continue;
+		}
+
+		ANKI_VK_LOGE("\t%s queue: Last started \"%s\" (%u), last finished \"%s\" (%u)%s",
+			QUEUE_NAMES[q],
+			self->getName(begin).cstr(),
+			begin,
+			self->getName(end).cstr(),
+			end,
+			(begin != end) ? ". The GPU probably hung in the started one" : "");
+	}
+}
+
+} // end namespace anki
@@ -0,0 +1,93 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/gr/vulkan/Common.h>
+#include <anki/util/Atomic.h>
+
+namespace anki
+{
+
+// Forward
+class GpuMemoryManager;
+
+/// @addtogroup vulkan
+/// @{
+
+/// Markers that the command buffers write to a host visible buffer while the GPU executes them. If the device is lost
+/// the buffer tells what every queue was doing. It costs a couple of tiny writes per marked region so it can stay on in
+/// release builds.
+class GpuBreadcrumbs
+{
+public:
+	GpuBreadcrumbs() = default;
+
+	~GpuBreadcrumbs();
+
+	/// @param pfnWriteBufferMarker vkCmdWriteBufferMarkerAMD. If it's null the markers are written with buffer fills.
+	ANKI_USE_RESULT Error init(GrAllocator<U8> alloc,
+		VkDevice dev,
+		const GpuMemoryManager& memManager,
+		PFN_vkCmdWriteBufferMarkerAMD pfnWriteBufferMarker);
+
+	void destroy();
+
+	Bool isEnabled() const
+	{
+		return m_buffer != VK_NULL_HANDLE;
+	}
+
+	/// Mark the beginning of a region.
+	/// @note Thread-safe.
+	/// @return The value to pass to end().
+	U32 begin(VkCommandBuffer cmdb, VulkanQueueType queue, CString name);
+
+	/// Mark the end of a region.
+	/// @note Thread-safe.
+	void end(VkCommandBuffer cmdb, VulkanQueueType queue, U32 value);
+
+	/// Log the last regions the GPU started and finished. Called when the device is lost.
+	static void reportDeviceLost();
+
+private:
+	static constexpr U32 MAX_NAME_LENGTH = 63;
+	static constexpr U32 MAX_NAMES = 1024; ///< The names of the last breadcrumbs.
+
+	class Name
+	{
+	public:
+		U32 m_value = 0;
+		Array<char, MAX_NAME_LENGTH + 1> m_name = {};
+	};
+
+	/// What it's in the buffer.
+	class QueueMarkers
+	{
+	public:
+		U32 m_begin;
+		U32 m_end;
+	};
+
+	static GpuBreadcrumbs* m_instance; ///< The one that the reportDeviceLost() will use.
+
+	GrAllocator<U8> m_alloc;
+	VkDevice m_dev = VK_NULL_HANDLE;
+	PFN_vkCmdWriteBufferMarkerAMD m_pfnWriteBufferMarker = nullptr;
+
+	VkBuffer m_buffer = VK_NULL_HANDLE;
+	VkDeviceMemory m_memory = VK_NULL_HANDLE;
+	const QueueMarkers* m_mappedMarkers = nullptr;
+
+	Atomic<U32> m_nextValue = {1};
+	Name* m_names = nullptr;
+
+	void write(VkCommandBuffer cmdb, VkPipelineStageFlagBits stage, PtrSize offset, U32 value) const;
+
+	CString getName(U32 value) const;
+};
+/// @}
+
+} // end namespace anki
@@ -9,7 +9,7 @@
 namespace anki
 {
 
-constexpr U32 CLASS_COUNT = 7;
+constexpr U32 CLASS_COUNT = GPU_MEMORY_CLASS_COUNT;
 
 class ClassInf
 {
@@ -43,9 +43,11 @@ class GpuMemoryManager::Interface final : public ClassGpuAllocatorInterface
 public:
 	GrAllocator<U8> m_alloc;
 	Array<IntrusiveList<Memory>, CLASS_COUNT> m_vacantMemory;
-	Mutex m_mtx;
+	PtrSize m_cachedMemory = 0; ///< The memory of m_vacantMemory.
+	mutable Mutex m_mtx;
 	VkDevice m_dev = VK_NULL_HANDLE;
 	U8 m_memTypeIdx = MAX_U8;
+	U8 m_heapIdx = MAX_U8;
 
 	Error allocate(U32 classIdx, ClassGpuAllocatorMemory*& cmem) override
 	{
@@ -58,18 +60,37 @@ public:
 			// Recycle
 			mem = &m_vacantMemory[classIdx].getFront();
 			m_vacantMemory[classIdx].popFront();
+
+			ANKI_ASSERT(m_cachedMemory >= CLASSES[classIdx].m_chunkSize);
+			m_cachedMemory -= CLASSES[classIdx].m_chunkSize;
 		}
 		else
 		{
 			// Create new
-			mem = m_alloc.newInstance<Memory>();
-
 			VkMemoryAllocateInfo ci = {};
 			ci.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
 			ci.allocationSize = CLASSES[classIdx].m_chunkSize;
 			ci.memoryTypeIndex = m_memTypeIdx;
-			ANKI_VK_CHECKF(vkAllocateMemory(m_dev, &ci, nullptr, &mem->m_handle));
 
+			VkDeviceMemory handle;
+			VkResult res = vkAllocateMemory(m_dev, &ci, nullptr, &handle);
+			if(res == VK_ERROR_OUT_OF_DEVICE_MEMORY || res == VK_ERROR_OUT_OF_HOST_MEMORY)
+			{
+				// The memory of the other classes might be enough, release it and try again
+				ANKI_VK_LOGW("Out of memory in memory type %u. Will release the cached memory and retry",
+					U32(m_memTypeIdx));
+				freeVacantMemory();
+				res = vkAllocateMemory(m_dev, &ci, nullptr, &handle);
+			}
+
+			if(res == VK_ERROR_OUT_OF_DEVICE_MEMORY || res == VK_ERROR_OUT_OF_HOST_MEMORY)
+			{
+				return Error::OUT_OF_MEMORY;
+			}
+			ANKI_VK_CHECKF(res);
+
+			mem = m_alloc.newInstance<Memory>();
+			mem->m_handle = handle;
 			mem->m_classIdx = U8(classIdx);
 		}
 
@@ -91,6 +112,7 @@ public:
 
 		LockGuard<Mutex> lock(m_mtx);
 		m_vacantMemory[mem->m_classIdx].pushBack(mem);
+		m_cachedMemory += CLASSES[mem->m_classIdx].m_chunkSize;
 
 		// Unmap
 		if(mem->m_mappedAddress)
@@ -114,7 +136,18 @@ public:
 	void collectGarbage()
 	{
 		LockGuard<Mutex> lock(m_mtx);
+		freeVacantMemory();
+	}
+
+	PtrSize getCachedMemory() const
+	{
+		LockGuard<Mutex> lock(m_mtx);
+		return m_cachedMemory;
+	}
 
+	/// Free the memory that is not used by any chunk. It should be called with m_mtx locked.
+	void freeVacantMemory()
+	{
 		for(U classIdx = 0; classIdx < CLASS_COUNT; ++classIdx)
 		{
 			while(!m_vacantMemory[classIdx].isEmpty())
@@ -132,6 +165,8 @@ public:
 				m_alloc.deleteInstance(mem);
 			}
 		}
+
+		m_cachedMemory = 0;
 	}
 
 	// Mapp memory
@@ -178,7 +213,7 @@ void GpuMemoryManager::destroy()
 	m_callocs.destroy(m_alloc);
 }
 
-void GpuMemoryManager::init(VkPhysicalDevice pdev, VkDevice dev, GrAllocator<U8> alloc)
+void GpuMemoryManager::init(VkPhysicalDevice pdev, VkDevice dev, GrAllocator<U8> alloc, Bool memoryBudget)
 {
 	ANKI_ASSERT(pdev);
 	ANKI_ASSERT(dev);
@@ -196,6 +231,8 @@ void GpuMemoryManager::init(VkPhysicalDevice pdev, VkDevice dev, GrAllocator<U8>
 	vkGetPhysicalDeviceMemoryProperties(pdev, &m_memoryProperties);
 
 	m_alloc = alloc;
+	m_pdev = pdev;
+	m_memoryBudget = memoryBudget;
 
 	m_ifaces.create(alloc, m_memoryProperties.memoryTypeCount);
 	for(U32 i = 0; i < m_ifaces.getSize(); ++i)
@@ -205,6 +242,7 @@ void GpuMemoryManager::init(VkPhysicalDevice pdev, VkDevice dev, GrAllocator<U8>
 		iface.m_alloc = alloc;
 		iface.m_dev = dev;
 		iface.m_memTypeIdx = U8(i);
+		iface.m_heapIdx = U8(m_memoryProperties.memoryTypes[i].heapIndex);
 	}
 
 	// One allocator per type per linear/non-linear resources
@@ -224,8 +262,11 @@ void GpuMemoryManager::allocateMemory(
 	U32 memTypeIdx, PtrSize size, U32 alignment, Bool linearResource, GpuMemoryHandle& handle)
 {
 	ClassGpuAllocator& calloc = m_callocs[memTypeIdx * 2 + ((linearResource) ? 0 : 1)];
-	Error err = calloc.allocate(size, alignment, handle.m_classHandle);
-	(void)err;
+	const Error err = calloc.allocate(size, alignment, handle.m_classHandle);
+	if(err)
+	{
+		ANKI_VK_LOGF("Out of GPU memory. Memory type %u, size %lu", memTypeIdx, size);
+	}
 
 	handle.m_memory = static_cast<Memory*>(handle.m_classHandle.m_memory)->m_handle;
 	handle.m_offset = handle.m_classHandle.m_offset;
@@ -233,6 +274,47 @@ void GpuMemoryManager::allocateMemory(
 	handle.m_memTypeIdx = U8(memTypeIdx);
 }
 
+void GpuMemoryManager::endFrame()
+{
+	if(!m_memoryBudget)
+	{
+		return;
+	}
+
+	VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProps = {};
+	budgetProps.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+	VkPhysicalDeviceMemoryProperties2 props = {};
+	props.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+	props.pNext = &budgetProps;
+	vkGetPhysicalDeviceMemoryProperties2(m_pdev, &props);
+
+	{
+		LockGuard<SpinLock> lock(m_heapBudgetsMtx);
+		for(U32 heapIdx = 0; heapIdx < m_memoryProperties.memoryHeapCount; ++heapIdx)
+		{
+			m_heapBudgets[heapIdx] = budgetProps.heapBudget[heapIdx];
+			m_heapUsages[heapIdx] = budgetProps.heapUsage[heapIdx];
+		}
+	}
+
+	// Give the cached memory back if a heap is over budget
+	for(U32 heapIdx = 0; heapIdx < m_memoryProperties.memoryHeapCount; ++heapIdx)
+	{
+		if(budgetProps.heapUsage[heapIdx] <= budgetProps.heapBudget[heapIdx])
+		{
+			continue;
+		}
+
+		for(Interface& iface : m_ifaces)
+		{
+			if(iface.m_heapIdx == heapIdx)
+			{
+				iface.collectGarbage();
+			}
+		}
+	}
+}
+
 void GpuMemoryManager::freeMemory(GpuMemoryHandle& handle)
 {
 	ANKI_ASSERT(handle);
@@ -312,4 +394,52 @@ void GpuMemoryManager::getAllocatedMemory(PtrSize& gpuMemory, PtrSize& cpuMemory
 	}
 }
 
+void GpuMemoryManager::getStats(GpuMemoryManagerStats& stats) const
+{
+	stats = {};
+
+	for(const ClassAllocator& calloc : m_callocs)
+	{
+		if(calloc.m_isDeviceMemory)
+		{
+			stats.m_gpuMemory += calloc.getAllocatedMemory();
+		}
+		else
+		{
+			stats.m_cpuMemory += calloc.getAllocatedMemory();
+		}
+
+		for(U32 classIdx = 0; classIdx < CLASS_COUNT; ++classIdx)
+		{
+			ClassGpuAllocatorClassStats classStats;
+			calloc.getClassStats(classIdx, classStats);
+
+			ClassGpuAllocatorClassStats& out = stats.m_classes[classIdx];
+			out.m_slotSize = classStats.m_slotSize;
+			out.m_chunkCount += classStats.m_chunkCount;
+			out.m_allocatedMemory += classStats.m_allocatedMemory;
+			out.m_usedMemory += classStats.m_usedMemory;
+			out.m_requestedMemory += classStats.m_requestedMemory;
+
+			stats.m_fragmentedMemory += classStats.m_allocatedMemory - classStats.m_usedMemory;
+			stats.m_wastedMemory += classStats.m_usedMemory - classStats.m_requestedMemory;
+		}
+	}
+
+	for(const Interface& iface : m_ifaces)
+	{
+		stats.m_cachedMemory += iface.getCachedMemory();
+	}
+
+	LockGuard<SpinLock> lock(m_heapBudgetsMtx);
+	for(U32 heapIdx = 0; heapIdx < m_memoryProperties.memoryHeapCount; ++heapIdx)
+	{
+		if(!!(m_memoryProperties.memoryHeaps[heapIdx].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT))
+		{
+			stats.m_gpuBudget += m_heapBudgets[heapIdx];
+			stats.m_gpuUsage += m_heapUsages[heapIdx];
+		}
+	}
+}
+
 } // end namespace anki
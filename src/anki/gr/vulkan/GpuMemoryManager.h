@@ -34,6 +34,29 @@ private:
 	Bool m_linear = false;
 };
 
+/// The number of allocation classes of GpuMemoryManager.
+const U32 GPU_MEMORY_CLASS_COUNT = 7;
+
+/// GPU memory statistics.
+class GpuMemoryManagerStats
+{
+public:
+	PtrSize m_gpuMemory = 0; ///< The memory of the chunks in the device local heaps.
+	PtrSize m_cpuMemory = 0; ///< The memory of the chunks in the rest of the heaps.
+	PtrSize m_cachedMemory = 0; ///< Memory of empty chunks that is kept around for recycling.
+	PtrSize m_fragmentedMemory = 0; ///< Chunk memory that is not covered by allocations.
+	PtrSize m_wastedMemory = 0; ///< Slot memory that the allocations didn't ask for.
+
+	/// The budget and usage of all the device local heaps as reported by the driver. Zero if VK_EXT_memory_budget is
+	/// not supported.
+	/// @{
+	PtrSize m_gpuBudget = 0;
+	PtrSize m_gpuUsage = 0;
+	/// @}
+
+	Array<ClassGpuAllocatorClassStats, GPU_MEMORY_CLASS_COUNT> m_classes; ///< Of all memory types.
+};
+
 /// Dynamic GPU memory allocator for all types.
 class GpuMemoryManager : public NonCopyable
 {
@@ -42,10 +65,14 @@ public:
 
 	~GpuMemoryManager();
 
-	void init(VkPhysicalDevice pdev, VkDevice dev, GrAllocator<U8> alloc);
+	/// @param memoryBudget If true VK_EXT_memory_budget is enabled.
+	void init(VkPhysicalDevice pdev, VkDevice dev, GrAllocator<U8> alloc, Bool memoryBudget);
 
 	void destroy();
 
+	/// Query the memory budget and release the cached memory of the heaps that are over budget.
+	void endFrame();
+
 	/// Allocate memory.
 	void allocateMemory(U32 memTypeIdx, PtrSize size, U32 alignment, Bool linearResource, GpuMemoryHandle& handle);
 
@@ -62,6 +89,10 @@ public:
 	/// Get some statistics.
 	void getAllocatedMemory(PtrSize& gpuMemory, PtrSize& cpuMemory) const;
 
+	/// Get detailed statistics.
+	/// @note It's thread-safe.
+	void getStats(GpuMemoryManagerStats& stats) const;
+
 private:
 	class Memory;
 	class Interface;
@@ -71,6 +102,12 @@ private:
 	DynamicArray<Interface> m_ifaces;
 	DynamicArray<ClassAllocator> m_callocs;
 	VkPhysicalDeviceMemoryProperties m_memoryProperties;
+	VkPhysicalDevice m_pdev = VK_NULL_HANDLE;
+
+	Bool m_memoryBudget = false;
+	Array<PtrSize, VK_MAX_MEMORY_HEAPS> m_heapBudgets = {};
+	Array<PtrSize, VK_MAX_MEMORY_HEAPS> m_heapUsages = {};
+	mutable SpinLock m_heapBudgetsMtx;
 };
 /// @}
 
@@ -5,10 +5,12 @@
 
 #include <anki/gr/GrManager.h>
 #include <anki/gr/vulkan/GrManagerImpl.h>
+#include <anki/gr/vulkan/TextureImpl.h>
 
 #include <anki/gr/Buffer.h>
 #include <anki/gr/Texture.h>
 #include <anki/gr/TextureView.h>
+#include <anki/gr/TextureHeap.h>
 #include <anki/gr/Sampler.h>
 #include <anki/gr/Shader.h>
 #include <anki/gr/ShaderProgram.h>
@@ -79,6 +81,12 @@ void GrManager::swapBuffers()
 	self.endFrame();
 }
 
+void GrManager::waitForPreviousFrame()
+{
+	ANKI_VK_SELF(GrManagerImpl);
+	self.waitForPreviousFrame();
+}
+
 void GrManager::finish()
 {
 	ANKI_VK_SELF(GrManagerImpl);
@@ -90,12 +98,62 @@ GrManagerStats GrManager::getStats() const
 	ANKI_VK_SELF_CONST(GrManagerImpl);
 	GrManagerStats out;
 
-	self.getGpuMemoryManager().getAllocatedMemory(out.m_gpuMemory, out.m_cpuMemory);
-	out.m_commandBufferCount = self.getCommandBufferFactory().getCreatedCommandBufferCount();
+	GpuMemoryManagerStats memStats;
+	self.getGpuMemoryManager().getStats(memStats);
+	out.m_gpuMemory = memStats.m_gpuMemory;
+	out.m_cpuMemory = memStats.m_cpuMemory;
+	out.m_gpuMemoryBudget = memStats.m_gpuBudget;
+	out.m_gpuMemoryUsage = memStats.m_gpuUsage;
+	out.m_fragmentedMemory = memStats.m_fragmentedMemory;
+	out.m_wastedMemory = memStats.m_wastedMemory;
+
+	// The factories of the queues that don't exist report zeros
+	for(const CommandBufferFactory* factory : self.getCommandBufferFactories())
+	{
+		CommandBufferFactoryStats cmdbStats;
+		factory->getStats(cmdbStats);
+		out.m_commandBufferCount += cmdbStats.m_createdCommandBufferCount;
+		out.m_commandPoolResets += cmdbStats.m_commandPoolResetCount;
+		out.m_commandBufferMemory += cmdbStats.m_cpuMemory;
+	}
+
+	const DescriptorSetFactoryStats& dsStats = self.getDescriptorSetFactory().getStats();
+	out.m_descriptorSetCacheHits = dsStats.m_threadCacheHits + dsStats.m_sharedCacheHits;
+	out.m_descriptorSetWrites = dsStats.m_writeCount;
 
 	return out;
 }
 
+void GrManager::beginPipelineRecording()
+{
+	ANKI_VK_SELF(GrManagerImpl);
+	self.getPipelineManifest().beginRecording();
+}
+
+Error GrManager::endPipelineRecording(CString manifestFilename)
+{
+	ANKI_VK_SELF(GrManagerImpl);
+	return self.getPipelineManifest().endRecording(manifestFilename);
+}
+
+Error GrManager::warmupPipelines(CString manifestFilename, ThreadHive& hive)
+{
+	ANKI_VK_SELF(GrManagerImpl);
+	return self.getPipelineManifest().warmup(manifestFilename, hive);
+}
+
+void GrManager::getTextureMemoryRequirements(const TextureInitInfo& init, PtrSize& size, PtrSize& alignment)
+{
+	TextureImpl* impl = m_alloc.newInstance<TextureImpl>(this, init.getName());
+	const Error err = impl->initMemoryRequirements(init, size, alignment);
+	if(err)
+	{
+		size = 0;
+		alignment = 0;
+	}
+	m_alloc.deleteInstance(impl);
+}
+
 BufferPtr GrManager::newBuffer(const BufferInitInfo& init)
 {
 	return BufferPtr(Buffer::newInstance(this, init));
@@ -111,6 +169,11 @@ TextureViewPtr GrManager::newTextureView(const TextureViewInitInfo& init)
 	return TextureViewPtr(TextureView::newInstance(this, init));
 }
 
+TextureHeapPtr GrManager::newTextureHeap(const TextureHeapInitInfo& init)
+{
+	return TextureHeapPtr(TextureHeap::newInstance(this, init));
+}
+
 SamplerPtr GrManager::newSampler(const SamplerInitInfo& init)
 {
 	return SamplerPtr(Sampler::newInstance(this, init));
@@ -24,11 +24,27 @@ GrManagerImpl::~GrManagerImpl()
 		LockGuard<Mutex> lock(m_globalMtx);
 		vkQueueWaitIdle(m_queue);
 		m_queue = VK_NULL_HANDLE;
+
+		if(m_asyncComputeQueue)
+		{
+			vkQueueWaitIdle(m_asyncComputeQueue);
+			m_asyncComputeQueue = VK_NULL_HANDLE;
+		}
+
+		if(m_transferQueue)
+		{
+			vkQueueWaitIdle(m_transferQueue);
+			m_transferQueue = VK_NULL_HANDLE;
+		}
 	}
 
 	m_cmdbFactory.destroy();
+	m_asyncComputeCmdbFactory.destroy();
+	m_transferCmdbFactory.destroy();
 
 	// SECOND THING: The destroy everything that has a reference to GrObjects.
+	m_pplineCompiler.destroy();
+
 	for(auto& x : m_perFrame)
 	{
 		x.m_presentFence.reset(nullptr);
@@ -39,6 +55,7 @@ GrManagerImpl::~GrManagerImpl()
 	m_crntSwapchain.reset(nullptr);
 
 	// THIRD THING: Continue with the rest
+	m_breadcrumbs.destroy();
 	m_gpuMemManager.destroy();
 
 	m_barrierFactory.destroy(); // Destroy before fences
@@ -49,9 +66,22 @@ GrManagerImpl::~GrManagerImpl()
 	m_descrFactory.destroy();
 
 	m_pplineCache.destroy(m_device, m_physicalDevice, getAllocator());
+	m_pplineManifest.destroy();
 
 	m_fences.destroy();
 
+	m_occlusionQueryFactory.destroy();
+	m_timestampQueryFactory.destroy();
+
+	for(VkSemaphore& sem : m_timelineSemaphores)
+	{
+		if(sem)
+		{
+			vkDestroySemaphore(m_device, sem, nullptr);
+			sem = VK_NULL_HANDLE;
+		}
+	}
+
 	m_samplerFactory.destroy();
 
 	if(m_device)
@@ -106,16 +136,47 @@ Error GrManagerImpl::initInternal(const GrManagerInitInfo& init)
 	ANKI_CHECK(initSurface(init));
 	ANKI_CHECK(initDevice(init));
 	vkGetDeviceQueue(m_device, m_queueIdx, 0, &m_queue);
+	m_queueFamilies[m_queueFamilyCount++] = m_queueIdx;
+	if(m_asyncComputeQueueIdx != MAX_U32)
+	{
+		vkGetDeviceQueue(m_device, m_asyncComputeQueueIdx, 0, &m_asyncComputeQueue);
+		m_queueFamilies[m_queueFamilyCount++] = m_asyncComputeQueueIdx;
+	}
+	if(m_transferQueueIdx != MAX_U32)
+	{
+		vkGetDeviceQueue(m_device, m_transferQueueIdx, 0, &m_transferQueue);
+		m_queueFamilies[m_queueFamilyCount++] = m_transferQueueIdx;
+	}
+	m_capabilities.m_asyncCompute = m_asyncComputeQueue != VK_NULL_HANDLE;
 
-	m_swapchainFactory.init(this, init.m_config->getBool("gr_vsync"));
+	m_swapchainFactory.init(this,
+		init.m_config->getBool("gr_vsync"),
+		SwapchainPresentMode(init.m_config->getNumberU8("gr_presentMode")));
+	m_maxFramesInFlight = init.m_config->getNumberU8("gr_maxFramesInFlight");
+	m_lowLatency = init.m_config->getBool("gr_lowLatency");
 
 	m_crntSwapchain = m_swapchainFactory.newInstance();
 
 	ANKI_CHECK(m_pplineCache.init(m_device, m_physicalDevice, init.m_cacheDirectory, *init.m_config, getAllocator()));
+	m_pplineManifest.init(getAllocator(), m_device);
+	m_pplineCompiler.init(getAllocator(), init.m_config->getNumberU32("gr_asyncPipelineThreadCount"));
 
 	ANKI_CHECK(initMemory(*init.m_config));
 
+	if(init.m_config->getBool("gr_breadcrumbs"))
+	{
+		ANKI_CHECK(m_breadcrumbs.init(getAllocator(), m_device, m_gpuMemManager, m_pfnCmdWriteBufferMarkerAMD));
+	}
+
 	ANKI_CHECK(m_cmdbFactory.init(getAllocator(), m_device, m_queueIdx));
+	if(m_asyncComputeQueue)
+	{
+		ANKI_CHECK(m_asyncComputeCmdbFactory.init(getAllocator(), m_device, m_asyncComputeQueueIdx));
+	}
+	if(m_transferQueue)
+	{
+		ANKI_CHECK(m_transferCmdbFactory.init(getAllocator(), m_device, m_transferQueueIdx));
+	}
 
 	for(PerFrame& f : m_perFrame)
 	{
@@ -124,6 +185,7 @@ Error GrManagerImpl::initInternal(const GrManagerInitInfo& init)
 
 	glslang::InitializeProcess();
 	m_fences.init(getAllocator(), m_device);
+	ANKI_CHECK(initTimelineSemaphores());
 	m_semaphores.init(getAllocator(), m_device);
 	m_samplerFactory.init(this);
 	m_barrierFactory.init(getAllocator(), m_device);
@@ -202,9 +264,36 @@ Error GrManagerImpl::initInternal(const GrManagerInitInfo& init)
 		}
 	}
 
-	m_bindlessLimits.m_bindlessTextureCount = init.m_config->getNumberU32("gr_maxBindlessTextures");
-	m_bindlessLimits.m_bindlessImageCount = init.m_config->getNumberU32("gr_maxBindlessImages");
-	ANKI_CHECK(m_descrFactory.init(getAllocator(), m_device, m_bindlessLimits));
+	// Bindless limits. Clamp them to what the device can do
+	{
+		VkPhysicalDeviceDescriptorIndexingPropertiesEXT indexingProps = {};
+		indexingProps.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES_EXT;
+
+		VkPhysicalDeviceProperties2 props = {};
+		props.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+		props.pNext = &indexingProps;
+
+		vkGetPhysicalDeviceProperties2(m_physicalDevice, &props);
+
+		U32 deviceMax = min(indexingProps.maxPerStageDescriptorUpdateAfterBindSampledImages,
+			indexingProps.maxDescriptorSetUpdateAfterBindSampledImages);
+		m_bindlessLimits.m_bindlessTextureCount = min(init.m_config->getNumberU32("gr_maxBindlessTextures"), deviceMax);
+
+		deviceMax = min(indexingProps.maxPerStageDescriptorUpdateAfterBindStorageImages,
+			indexingProps.maxDescriptorSetUpdateAfterBindStorageImages);
+		m_bindlessLimits.m_bindlessImageCount = min(init.m_config->getNumberU32("gr_maxBindlessImages"), deviceMax);
+
+		deviceMax = min(indexingProps.maxPerStageDescriptorUpdateAfterBindStorageBuffers,
+			indexingProps.maxDescriptorSetUpdateAfterBindStorageBuffers);
+		m_bindlessLimits.m_bindlessBufferCount = min(init.m_config->getNumberU32("gr_maxBindlessBuffers"), deviceMax);
+
+		ANKI_VK_LOGI("Bindless limits: %u textures, %u images, %u buffers",
+			m_bindlessLimits.m_bindlessTextureCount,
+			m_bindlessLimits.m_bindlessImageCount,
+			m_bindlessLimits.m_bindlessBufferCount);
+	}
+
+	ANKI_CHECK(m_descrFactory.init(getAllocator(), m_device, m_bindlessLimits, m_maxPushDescriptors));
 	m_pplineLayoutFactory.init(getAllocator(), m_device);
 
 	return Error::NONE;
@@ -435,6 +524,29 @@ Error GrManagerImpl::initInstance(const GrManagerInitInfo& init)
 	m_capabilities.m_majorApiVersion = vulkanMajor;
 	m_capabilities.m_minorApiVersion = vulkanMinor;
 
+	m_capabilities.m_bcTextureCompression = m_devFeatures.textureCompressionBC;
+	m_capabilities.m_etc2TextureCompression = m_devFeatures.textureCompressionETC2;
+	m_capabilities.m_astcTextureCompression = m_devFeatures.textureCompressionASTC_LDR;
+
+	// Subgroups
+	{
+		VkPhysicalDeviceSubgroupProperties subgroupProps = {};
+		subgroupProps.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_PROPERTIES;
+
+		VkPhysicalDeviceProperties2 props = {};
+		props.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+		props.pNext = &subgroupProps;
+
+		vkGetPhysicalDeviceProperties2(m_physicalDevice, &props);
+
+		m_capabilities.m_subgroupSize = subgroupProps.subgroupSize;
+		m_capabilities.m_subgroupArithmetic = !!(subgroupProps.supportedOperations & VK_SUBGROUP_FEATURE_ARITHMETIC_BIT)
+											  && !!(subgroupProps.supportedStages & VK_SHADER_STAGE_COMPUTE_BIT);
+		ANKI_VK_LOGI("Subgroup size %u, arithmetic operations %s",
+			m_capabilities.m_subgroupSize,
+			(m_capabilities.m_subgroupArithmetic) ? "supported" : "not supported");
+	}
+
 	return Error::NONE;
 }
 
@@ -474,17 +586,74 @@ Error GrManagerImpl::initDevice(const GrManagerInitInfo& init)
 
 	m_queueIdx = desiredFamilyIdx;
 
+	// Find a compute family without graphics. Its queue will run compute work in parallel with the graphics queue. The
+	// timestamps should work there as well since the render graph writes them to every command buffer
+	if(init.m_config->getBool("gr_asyncCompute"))
+	{
+		for(U32 i = 0; i < count; ++i)
+		{
+			if((queueInfos[i].queueFlags & VK_QUEUE_COMPUTE_BIT) && !(queueInfos[i].queueFlags & VK_QUEUE_GRAPHICS_BIT)
+				&& queueInfos[i].timestampValidBits > 0)
+			{
+				m_asyncComputeQueueIdx = i;
+				break;
+			}
+		}
+
+		if(m_asyncComputeQueueIdx != MAX_U32)
+		{
+			ANKI_VK_LOGI("Async compute will use queue family %u", m_asyncComputeQueueIdx);
+		}
+		else
+		{
+			ANKI_VK_LOGI("Couldn't find a compute only queue family. Async compute will be disabled");
+		}
+	}
+
+	// Find a transfer only family for the uploads. Its image copies should work on any texel
+	if(init.m_config->getBool("gr_asyncTransfer"))
+	{
+		for(U32 i = 0; i < count; ++i)
+		{
+			const VkExtent3D& granularity = queueInfos[i].minImageTransferGranularity;
+			if((queueInfos[i].queueFlags & VK_QUEUE_TRANSFER_BIT)
+				&& !(queueInfos[i].queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT))
+				&& granularity.width == 1 && granularity.height == 1 && granularity.depth == 1)
+			{
+				m_transferQueueIdx = i;
+				break;
+			}
+		}
+
+		if(m_transferQueueIdx != MAX_U32)
+		{
+			ANKI_VK_LOGI("The uploads will use queue family %u", m_transferQueueIdx);
+		}
+		else
+		{
+			ANKI_VK_LOGI("Couldn't find a transfer only queue family. The uploads will use the graphics queue");
+		}
+	}
+
 	F32 priority = 1.0;
-	VkDeviceQueueCreateInfo q = {};
-	q.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-	q.queueFamilyIndex = desiredFamilyIdx;
-	q.queueCount = 1;
-	q.pQueuePriorities = &priority;
+	Array<VkDeviceQueueCreateInfo, U32(VulkanQueueType::COUNT)> q = {};
+	U32 queueCreateInfoCount = 0;
+	for(U32 familyIdx : {desiredFamilyIdx, m_asyncComputeQueueIdx, m_transferQueueIdx})
+	{
+		if(familyIdx != MAX_U32)
+		{
+			VkDeviceQueueCreateInfo& qci = q[queueCreateInfoCount++];
+			qci.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+			qci.queueFamilyIndex = familyIdx;
+			qci.queueCount = 1;
+			qci.pQueuePriorities = &priority;
+		}
+	}
 
 	VkDeviceCreateInfo ci = {};
 	ci.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-	ci.queueCreateInfoCount = 1;
-	ci.pQueueCreateInfos = &q;
+	ci.queueCreateInfoCount = queueCreateInfoCount;
+	ci.pQueueCreateInfos = &q[0];
 	ci.pEnabledFeatures = &m_devFeatures;
 
 	// Extensions
@@ -550,6 +719,53 @@ Error GrManagerImpl::initDevice(const GrManagerInitInfo& init)
 				m_extensions |= VulkanExtensions::EXT_DESCRIPTOR_INDEXING;
 				extensionsToEnable[extensionsToEnableCount++] = VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME;
 			}
+			else if(CString(extensionInfos[extCount].extensionName) == VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME
+					&& init.m_config->getBool("gr_vrs"))
+			{
+				m_extensions |= VulkanExtensions::KHR_CREATE_RENDERPASS_2;
+				extensionsToEnable[extensionsToEnableCount++] = VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME;
+			}
+			else if(CString(extensionInfos[extCount].extensionName) == VK_KHR_FRAGMENT_SHADING_RATE_EXTENSION_NAME
+					&& init.m_config->getBool("gr_vrs"))
+			{
+				m_extensions |= VulkanExtensions::KHR_FRAGMENT_SHADING_RATE;
+				extensionsToEnable[extensionsToEnableCount++] = VK_KHR_FRAGMENT_SHADING_RATE_EXTENSION_NAME;
+			}
+			else if(CString(extensionInfos[extCount].extensionName) == VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME
+					&& init.m_config->getBool("gr_pushDescriptors"))
+			{
+				m_extensions |= VulkanExtensions::KHR_PUSH_DESCRIPTOR;
+				extensionsToEnable[extensionsToEnableCount++] = VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME;
+			}
+			else if(CString(extensionInfos[extCount].extensionName) == VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME
+					&& init.m_config->getBool("gr_timelineSemaphores"))
+			{
+				m_extensions |= VulkanExtensions::KHR_TIMELINE_SEMAPHORE;
+				extensionsToEnable[extensionsToEnableCount++] = VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME;
+			}
+			else if(CString(extensionInfos[extCount].extensionName) == VK_NV_MESH_SHADER_EXTENSION_NAME
+					&& init.m_config->getBool("gr_meshShaders"))
+			{
+				m_extensions |= VulkanExtensions::NV_MESH_SHADER;
+				extensionsToEnable[extensionsToEnableCount++] = VK_NV_MESH_SHADER_EXTENSION_NAME;
+			}
+			else if(CString(extensionInfos[extCount].extensionName) == VK_AMD_BUFFER_MARKER_EXTENSION_NAME
+					&& init.m_config->getBool("gr_breadcrumbs"))
+			{
+				m_extensions |= VulkanExtensions::AMD_BUFFER_MARKER;
+				extensionsToEnable[extensionsToEnableCount++] = VK_AMD_BUFFER_MARKER_EXTENSION_NAME;
+			}
+			else if(CString(extensionInfos[extCount].extensionName) == VK_KHR_SHADER_FLOAT16_INT8_EXTENSION_NAME
+					&& init.m_config->getBool("gr_shaderFloat16"))
+			{
+				m_extensions |= VulkanExtensions::KHR_SHADER_FLOAT16_INT8;
+				extensionsToEnable[extensionsToEnableCount++] = VK_KHR_SHADER_FLOAT16_INT8_EXTENSION_NAME;
+			}
+			else if(CString(extensionInfos[extCount].extensionName) == VK_EXT_MEMORY_BUDGET_EXTENSION_NAME)
+			{
+				m_extensions |= VulkanExtensions::EXT_MEMORY_BUDGET;
+				extensionsToEnable[extensionsToEnableCount++] = VK_EXT_MEMORY_BUDGET_EXTENSION_NAME;
+			}
 		}
 
 		// Check required extensions.
@@ -584,7 +800,8 @@ Error GrManagerImpl::initDevice(const GrManagerInitInfo& init)
 			}
 
 			if(!m_descriptorIndexingFeatures.descriptorBindingSampledImageUpdateAfterBind
-				|| !m_descriptorIndexingFeatures.descriptorBindingStorageImageUpdateAfterBind)
+				|| !m_descriptorIndexingFeatures.descriptorBindingStorageImageUpdateAfterBind
+				|| !m_descriptorIndexingFeatures.descriptorBindingStorageBufferUpdateAfterBind)
 			{
 				ANKI_VK_LOGE("Update descriptors after bind is not supported by the device");
 				return Error::FUNCTION_FAILED;
@@ -599,6 +816,119 @@ Error GrManagerImpl::initDevice(const GrManagerInitInfo& init)
 			ci.pNext = &m_descriptorIndexingFeatures;
 		}
 
+		// The shading rate image needs the 2nd version of the renderpass creation
+		if(!!(m_extensions & VulkanExtensions::KHR_FRAGMENT_SHADING_RATE)
+			&& !!(m_extensions & VulkanExtensions::KHR_CREATE_RENDERPASS_2))
+		{
+			m_fragmentShadingRateFeatures = {};
+			m_fragmentShadingRateFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FRAGMENT_SHADING_RATE_FEATURES_KHR;
+
+			VkPhysicalDeviceFeatures2 features = {};
+			features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+			features.pNext = &m_fragmentShadingRateFeatures;
+
+			vkGetPhysicalDeviceFeatures2(m_physicalDevice, &features);
+
+			if(m_fragmentShadingRateFeatures.attachmentFragmentShadingRate
+				&& m_fragmentShadingRateFeatures.pipelineFragmentShadingRate)
+			{
+				VkPhysicalDeviceFragmentShadingRatePropertiesKHR vrsProps = {};
+				vrsProps.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FRAGMENT_SHADING_RATE_PROPERTIES_KHR;
+
+				VkPhysicalDeviceProperties2 props = {};
+				props.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+				props.pNext = &vrsProps;
+
+				vkGetPhysicalDeviceProperties2(m_physicalDevice, &props);
+
+				// Only the primitive rate is not used
+				m_fragmentShadingRateFeatures.primitiveFragmentShadingRate = false;
+				m_fragmentShadingRateFeatures.pNext = const_cast<void*>(ci.pNext);
+				ci.pNext = &m_fragmentShadingRateFeatures;
+
+				m_capabilities.m_vrs = true;
+				m_capabilities.m_minShadingRateImageTexelSize =
+					max(vrsProps.minFragmentShadingRateAttachmentTexelSize.width,
+						vrsProps.minFragmentShadingRateAttachmentTexelSize.height);
+			}
+			else
+			{
+				ANKI_VK_LOGW("VK_KHR_fragment_shading_rate is present but the shading rate image is not supported");
+			}
+		}
+
+		if(!!(m_extensions & VulkanExtensions::KHR_TIMELINE_SEMAPHORE))
+		{
+			m_timelineSemaphoreFeatures = {};
+			m_timelineSemaphoreFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+
+			VkPhysicalDeviceFeatures2 features = {};
+			features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+			features.pNext = &m_timelineSemaphoreFeatures;
+
+			vkGetPhysicalDeviceFeatures2(m_physicalDevice, &features);
+
+			if(m_timelineSemaphoreFeatures.timelineSemaphore)
+			{
+				m_timelineSemaphoreFeatures.pNext = const_cast<void*>(ci.pNext);
+				ci.pNext = &m_timelineSemaphoreFeatures;
+			}
+			else
+			{
+				ANKI_VK_LOGW("VK_KHR_timeline_semaphore is present but timeline semaphores are not supported");
+				m_extensions &= ~VulkanExtensions::KHR_TIMELINE_SEMAPHORE;
+			}
+		}
+
+		if(!!(m_extensions & VulkanExtensions::NV_MESH_SHADER))
+		{
+			m_meshShaderFeatures = {};
+			m_meshShaderFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_FEATURES_NV;
+
+			VkPhysicalDeviceFeatures2 features = {};
+			features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+			features.pNext = &m_meshShaderFeatures;
+
+			vkGetPhysicalDeviceFeatures2(m_physicalDevice, &features);
+
+			if(m_meshShaderFeatures.taskShader && m_meshShaderFeatures.meshShader)
+			{
+				m_meshShaderFeatures.pNext = const_cast<void*>(ci.pNext);
+				ci.pNext = &m_meshShaderFeatures;
+			}
+			else
+			{
+				ANKI_VK_LOGW("VK_NV_mesh_shader is present but task and mesh shaders are not supported");
+				m_extensions &= ~VulkanExtensions::NV_MESH_SHADER;
+			}
+		}
+
+		if(!!(m_extensions & VulkanExtensions::KHR_SHADER_FLOAT16_INT8))
+		{
+			m_float16Int8Features = {};
+			m_float16Int8Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_FLOAT16_INT8_FEATURES_KHR;
+
+			VkPhysicalDeviceFeatures2 features = {};
+			features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+			features.pNext = &m_float16Int8Features;
+
+			vkGetPhysicalDeviceFeatures2(m_physicalDevice, &features);
+
+			if(m_float16Int8Features.shaderFloat16)
+			{
+				// Only the FP16 math is used
+				m_float16Int8Features.shaderInt8 = false;
+				m_float16Int8Features.pNext = const_cast<void*>(ci.pNext);
+				ci.pNext = &m_float16Int8Features;
+				m_capabilities.m_shaderFloat16 = true;
+			}
+			else
+			{
+				ANKI_VK_LOGW("VK_KHR_shader_float16_int8 is present but FP16 shader arithmetic is not supported");
+				m_extensions &= ~VulkanExtensions::KHR_SHADER_FLOAT16_INT8;
+			}
+		}
+
 		ANKI_VK_LOGI("Will enable the following device extensions:");
 		for(U32 i = 0; i < extensionsToEnableCount; ++i)
 		{
@@ -609,6 +939,14 @@ Error GrManagerImpl::initDevice(const GrManagerInitInfo& init)
 		ci.ppEnabledExtensionNames = &extensionsToEnable[0];
 	}
 
+	// The other queues can't find out when the uploads are done without timeline semaphores
+	if(m_transferQueueIdx != MAX_U32 && !(m_extensions & VulkanExtensions::KHR_TIMELINE_SEMAPHORE))
+	{
+		ANKI_VK_LOGI("Timeline semaphores are not available. The uploads will use the graphics queue");
+		m_transferQueueIdx = MAX_U32;
+		--ci.queueCreateInfoCount; // It's the last
+	}
+
 	ANKI_VK_CHECK(vkCreateDevice(m_physicalDevice, &ci, nullptr, &m_device));
 
 	// Get debug marker
@@ -636,6 +974,85 @@ Error GrManagerImpl::initDevice(const GrManagerInitInfo& init)
 		}
 	}
 
+	// Get VK_KHR_create_renderpass2 entry points
+	if(m_capabilities.m_vrs)
+	{
+		m_pfnCreateRenderPass2KHR =
+			reinterpret_cast<PFN_vkCreateRenderPass2KHR>(vkGetDeviceProcAddr(m_device, "vkCreateRenderPass2KHR"));
+		if(!m_pfnCreateRenderPass2KHR)
+		{
+			ANKI_VK_LOGW("VK_KHR_create_renderpass2 is present but vkCreateRenderPass2KHR is not there");
+			m_capabilities.m_vrs = false;
+		}
+	}
+
+	// Get VK_KHR_push_descriptor entry points and limits
+	if(!!(m_extensions & VulkanExtensions::KHR_PUSH_DESCRIPTOR))
+	{
+		m_pfnCmdPushDescriptorSetKHR =
+			reinterpret_cast<PFN_vkCmdPushDescriptorSetKHR>(vkGetDeviceProcAddr(m_device, "vkCmdPushDescriptorSetKHR"));
+		if(!m_pfnCmdPushDescriptorSetKHR)
+		{
+			ANKI_VK_LOGW("VK_KHR_push_descriptor is present but vkCmdPushDescriptorSetKHR is not there");
+		}
+		else
+		{
+			VkPhysicalDevicePushDescriptorPropertiesKHR pushProps = {};
+			pushProps.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PUSH_DESCRIPTOR_PROPERTIES_KHR;
+
+			VkPhysicalDeviceProperties2 props = {};
+			props.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+			props.pNext = &pushProps;
+
+			vkGetPhysicalDeviceProperties2(m_physicalDevice, &props);
+			m_maxPushDescriptors = pushProps.maxPushDescriptors;
+		}
+	}
+
+	// Get VK_KHR_timeline_semaphore entry points
+	if(!!(m_extensions & VulkanExtensions::KHR_TIMELINE_SEMAPHORE))
+	{
+		m_pfnGetSemaphoreCounterValueKHR = reinterpret_cast<PFN_vkGetSemaphoreCounterValueKHR>(
+			vkGetDeviceProcAddr(m_device, "vkGetSemaphoreCounterValueKHR"));
+		m_pfnWaitSemaphoresKHR =
+			reinterpret_cast<PFN_vkWaitSemaphoresKHR>(vkGetDeviceProcAddr(m_device, "vkWaitSemaphoresKHR"));
+		if(!m_pfnGetSemaphoreCounterValueKHR || !m_pfnWaitSemaphoresKHR)
+		{
+			ANKI_VK_LOGW("VK_KHR_timeline_semaphore is present but its entry points are not there");
+			m_extensions &= ~VulkanExtensions::KHR_TIMELINE_SEMAPHORE;
+		}
+	}
+
+	// Get VK_NV_mesh_shader entry points
+	if(!!(m_extensions & VulkanExtensions::NV_MESH_SHADER))
+	{
+		m_pfnCmdDrawMeshTasksNV =
+			reinterpret_cast<PFN_vkCmdDrawMeshTasksNV>(vkGetDeviceProcAddr(m_device, "vkCmdDrawMeshTasksNV"));
+		m_pfnCmdDrawMeshTasksIndirectNV = reinterpret_cast<PFN_vkCmdDrawMeshTasksIndirectNV>(
+			vkGetDeviceProcAddr(m_device, "vkCmdDrawMeshTasksIndirectNV"));
+		if(!m_pfnCmdDrawMeshTasksNV || !m_pfnCmdDrawMeshTasksIndirectNV)
+		{
+			ANKI_VK_LOGW("VK_NV_mesh_shader is present but its entry points are not there");
+			m_extensions &= ~VulkanExtensions::NV_MESH_SHADER;
+		}
+		else
+		{
+			m_capabilities.m_meshShaders = true;
+		}
+	}
+
+	// Get VK_AMD_buffer_marker entry points
+	if(!!(m_extensions & VulkanExtensions::AMD_BUFFER_MARKER))
+	{
+		m_pfnCmdWriteBufferMarkerAMD = reinterpret_cast<PFN_vkCmdWriteBufferMarkerAMD>(
+			vkGetDeviceProcAddr(m_device, "vkCmdWriteBufferMarkerAMD"));
+		if(!m_pfnCmdWriteBufferMarkerAMD)
+		{
+			ANKI_VK_LOGW("VK_AMD_buffer_marker is present but vkCmdWriteBufferMarkerAMD is not there");
+			m_extensions &= ~VulkanExtensions::AMD_BUFFER_MARKER;
+		}
+	}
+
 	// Get VK_AMD_shader_info entry points
 	if(!!(m_extensions & VulkanExtensions::AMD_SHADER_INFO))
 	{
@@ -650,6 +1067,37 @@ Error GrManagerImpl::initDevice(const GrManagerInitInfo& init)
 	return Error::NONE;
 }
 
+Error GrManagerImpl::initTimelineSemaphores()
+{
+	if(!(m_extensions & VulkanExtensions::KHR_TIMELINE_SEMAPHORE))
+	{
+		return Error::NONE;
+	}
+
+	m_fences.initTimelineSemaphores(m_pfnGetSemaphoreCounterValueKHR, m_pfnWaitSemaphoresKHR);
+
+	VkSemaphoreTypeCreateInfoKHR typeCi = {};
+	typeCi.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR;
+	typeCi.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR;
+	typeCi.initialValue = 0;
+
+	VkSemaphoreCreateInfo ci = {};
+	ci.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+	ci.pNext = &typeCi;
+
+	for(VulkanQueueType qtype : {VulkanQueueType::GENERAL, VulkanQueueType::ASYNC_COMPUTE, VulkanQueueType::TRANSFER})
+	{
+		if(getQueue(qtype))
+		{
+			ANKI_VK_CHECK(vkCreateSemaphore(m_device, &ci, nullptr, &m_timelineSemaphores[qtype]));
+			m_timelineValues[qtype] = 0;
+		}
+	}
+
+	ANKI_VK_LOGI("Submissions will be tracked with timeline semaphores");
+	return Error::NONE;
+}
+
 Error GrManagerImpl::initMemory(const ConfigSet& cfg)
 {
 	vkGetPhysicalDeviceMemoryProperties(m_physicalDevice, &m_memoryProperties);
@@ -668,7 +1116,8 @@ Error GrManagerImpl::initMemory(const ConfigSet& cfg)
 			ANKI_FORMAT_U32(m_memoryProperties.memoryTypes[i].propertyFlags));
 	}
 
-	m_gpuMemManager.init(m_physicalDevice, m_device, getAllocator());
+	m_gpuMemManager.init(
+		m_physicalDevice, m_device, getAllocator(), !!(m_extensions & VulkanExtensions::EXT_MEMORY_BUDGET));
 
 	return Error::NONE;
 }
@@ -831,11 +1280,46 @@ void GrManagerImpl::endFrame()
 	}
 
 	m_descrFactory.endFrame();
+	m_gpuMemManager.endFrame();
+	m_cmdbFactory.endFrame();
+	m_asyncComputeCmdbFactory.endFrame();
+	m_transferCmdbFactory.endFrame();
+	m_occlusionQueryFactory.endFrame();
+	m_timestampQueryFactory.endFrame();
+
+	// With fewer frames in flight wait for a more recent frame
+	if(m_maxFramesInFlight < MAX_FRAMES_IN_FLIGHT - 1)
+	{
+		ANKI_TRACE_SCOPED_EVENT(VK_WAIT_FRAMES_IN_FLIGHT);
+		PerFrame& limitFrame =
+			m_perFrame[(m_frame + MAX_FRAMES_IN_FLIGHT + 1 - m_maxFramesInFlight) % MAX_FRAMES_IN_FLIGHT];
+		if(limitFrame.m_presentFence)
+		{
+			limitFrame.m_presentFence->wait();
+		}
+	}
 
 	// Finalize
 	++m_frame;
 }
 
+void GrManagerImpl::waitForPreviousFrame()
+{
+	if(!m_lowLatency)
+	{
+		return;
+	}
+
+	ANKI_TRACE_SCOPED_EVENT(VK_WAIT_PREVIOUS_FRAME);
+
+	LockGuard<Mutex> lock(m_globalMtx);
+	PerFrame& prevFrame = m_perFrame[(m_frame + MAX_FRAMES_IN_FLIGHT - 1) % MAX_FRAMES_IN_FLIGHT];
+	if(prevFrame.m_presentFence)
+	{
+		prevFrame.m_presentFence->wait();
+	}
+}
+
 void GrManagerImpl::resetFrame(PerFrame& frame)
 {
 	frame.m_presentFence.reset(nullptr);
@@ -843,43 +1327,76 @@ void GrManagerImpl::resetFrame(PerFrame& frame)
 	frame.m_renderSemaphore.reset(nullptr);
 }
 
-void GrManagerImpl::flushCommandBuffer(CommandBufferPtr cmdb, FencePtr* outFence, Bool wait)
+void GrManagerImpl::flushCommandBuffer(
+	CommandBufferPtr cmdb, FencePtr* outFence, Bool wait, ConstWeakArray<FencePtr> gpuWaitFences, Bool gpuWaitableFence)
 {
 	CommandBufferImpl& impl = static_cast<CommandBufferImpl&>(*cmdb);
 	VkCommandBuffer handle = impl.getHandle();
+	const VulkanQueueType queueType = impl.getQueueType();
+	const VkQueue queue = getQueue(queueType);
+	const VkSemaphore timelineSemaphore = m_timelineSemaphores[queueType];
 
 	VkSubmitInfo submit = {};
 	submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
-	MicroFencePtr fence = newFence();
+	MicroFencePtr fence;
+	if(!timelineSemaphore)
+	{
+		fence = newFence();
+	}
 
 	// Create fence
+	FenceImpl* fenceImpl = nullptr;
 	if(outFence)
 	{
-		outFence->reset(getAllocator().newInstance<FenceImpl>(this, "Flush"));
-		static_cast<FenceImpl&>(**outFence).m_fence = fence;
+		fenceImpl = getAllocator().newInstance<FenceImpl>(this, "Flush");
+		outFence->reset(fenceImpl);
+	}
+	else
+	{
+		ANKI_ASSERT(!gpuWaitableFence && "Need a fence to wait in the GPU");
 	}
 
 	LockGuard<Mutex> lock(m_globalMtx);
 
+	if(timelineSemaphore)
+	{
+		// The fence is the next value of the queue's semaphore. Get it while locked so the values increase in the order
+		// of the submits
+		fence = m_fences.newTimelineInstance(timelineSemaphore, ++m_timelineValues[queueType]);
+	}
+
+	if(fenceImpl)
+	{
+		fenceImpl->m_fence = fence;
+	}
+
 	PerFrame& frame = m_perFrame[m_frame % MAX_FRAMES_IN_FLIGHT];
 
+	Array<VkSemaphore, 8> waitSemaphores;
+	Array<VkPipelineStageFlags, 8> waitStages;
+	Array<U64, 8> waitValues; ///< The values of the timeline semaphores. Ignored for the binary ones.
+	Array<VkSemaphore, 3> signalSemaphores;
+	Array<U64, 3> signalValues;
+
 	// Do some special stuff for the last command buffer
-	VkPipelineStageFlags waitFlags;
 	if(impl.renderedToDefaultFramebuffer())
 	{
-		submit.pWaitSemaphores = &frame.m_acquireSemaphore->getHandle();
-		waitFlags = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT
-					| VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT; // TODO That depends on how we use the swapchain img
-		submit.pWaitDstStageMask = &waitFlags;
-		submit.waitSemaphoreCount = 1;
+		ANKI_ASSERT(!impl.isAsyncCompute());
+
+		waitSemaphores[submit.waitSemaphoreCount] = frame.m_acquireSemaphore->getHandle();
+		waitValues[submit.waitSemaphoreCount] = 0;
+		waitStages[submit.waitSemaphoreCount] =
+			VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT
+			| VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT; // TODO That depends on how we use the swapchain img
+		++submit.waitSemaphoreCount;
 
 		// Create the semaphore to signal
 		ANKI_ASSERT(!frame.m_renderSemaphore && "Only one begin/end render pass is allowed with the default fb");
 		frame.m_renderSemaphore = m_semaphores.newInstance(fence);
 
-		submit.signalSemaphoreCount = 1;
-		submit.pSignalSemaphores = &frame.m_renderSemaphore->getHandle();
+		signalValues[submit.signalSemaphoreCount] = 0;
+		signalSemaphores[submit.signalSemaphoreCount++] = frame.m_renderSemaphore->getHandle();
 
 		frame.m_presentFence = fence;
 
@@ -887,6 +1404,77 @@ void GrManagerImpl::flushCommandBuffer(CommandBufferPtr cmdb, FencePtr* outFence
 		m_crntSwapchain->setFence(fence);
 	}
 
+	// Wait for the work of other submits
+	for(const FencePtr& waitFence : gpuWaitFences)
+	{
+		FenceImpl& waitFenceImpl = static_cast<FenceImpl&>(*waitFence);
+		ANKI_ASSERT(submit.waitSemaphoreCount < waitSemaphores.getSize());
+
+		if(waitFenceImpl.m_fence->isTimeline())
+		{
+			// Wait for the value of the other submit. No need for an extra semaphore
+			waitSemaphores[submit.waitSemaphoreCount] = waitFenceImpl.m_fence->getTimelineSemaphore();
+			waitValues[submit.waitSemaphoreCount] = waitFenceImpl.m_fence->getTimelineValue();
+		}
+		else
+		{
+			ANKI_ASSERT(waitFenceImpl.m_semaphore && "Fence can't be waited in the GPU or it was already waited");
+			waitSemaphores[submit.waitSemaphoreCount] = waitFenceImpl.m_semaphore->getHandle();
+			waitValues[submit.waitSemaphoreCount] = 0;
+
+			// The semaphore can be recycled when this submit is done
+			waitFenceImpl.m_semaphore->getFence() = fence;
+			waitFenceImpl.m_semaphore.reset(nullptr);
+		}
+
+		waitStages[submit.waitSemaphoreCount] = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+		++submit.waitSemaphoreCount;
+	}
+
+	// Order the uploads with the rest of the work. An upload waits for the general queue work that was submitted
+	// before it (the resource creation might have touched the same memory) and the other queues wait for the uploads
+	if(m_transferQueue)
+	{
+		const VulkanQueueType otherQueueType =
+			(queueType == VulkanQueueType::TRANSFER) ? VulkanQueueType::GENERAL : VulkanQueueType::TRANSFER;
+		const U64 otherValue = m_timelineValues[otherQueueType];
+
+		if(m_crossQueueWaitedValues[queueType] < otherValue)
+		{
+			ANKI_ASSERT(submit.waitSemaphoreCount < waitSemaphores.getSize());
+			waitSemaphores[submit.waitSemaphoreCount] = m_timelineSemaphores[otherQueueType];
+			waitValues[submit.waitSemaphoreCount] = otherValue;
+			waitStages[submit.waitSemaphoreCount] = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+			++submit.waitSemaphoreCount;
+
+			m_crossQueueWaitedValues[queueType] = otherValue;
+		}
+	}
+
+	if(gpuWaitableFence && !timelineSemaphore)
+	{
+		fenceImpl->m_semaphore = m_semaphores.newInstance(fence);
+		signalValues[submit.signalSemaphoreCount] = 0;
+		signalSemaphores[submit.signalSemaphoreCount++] = fenceImpl->m_semaphore->getHandle();
+	}
+
+	VkTimelineSemaphoreSubmitInfoKHR timelineSubmit = {};
+	if(timelineSemaphore)
+	{
+		signalValues[submit.signalSemaphoreCount] = fence->getTimelineValue();
+		signalSemaphores[submit.signalSemaphoreCount++] = timelineSemaphore;
+
+		timelineSubmit.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+		timelineSubmit.waitSemaphoreValueCount = submit.waitSemaphoreCount;
+		timelineSubmit.pWaitSemaphoreValues = (submit.waitSemaphoreCount) ? &waitValues[0] : nullptr;
+		timelineSubmit.signalSemaphoreValueCount = submit.signalSemaphoreCount;
+		timelineSubmit.pSignalSemaphoreValues = &signalValues[0];
+		submit.pNext = &timelineSubmit;
+	}
+
+	submit.pWaitSemaphores = (submit.waitSemaphoreCount) ? &waitSemaphores[0] : nullptr;
+	submit.pWaitDstStageMask = (submit.waitSemaphoreCount) ? &waitStages[0] : nullptr;
+	submit.pSignalSemaphores = (submit.signalSemaphoreCount) ? &signalSemaphores[0] : nullptr;
 	submit.commandBufferCount = 1;
 	submit.pCommandBuffers = &handle;
 
@@ -894,12 +1482,13 @@ void GrManagerImpl::flushCommandBuffer(CommandBufferPtr cmdb, FencePtr* outFence
 
 	{
 		ANKI_TRACE_SCOPED_EVENT(VK_QUEUE_SUBMIT);
-		ANKI_VK_CHECKF(vkQueueSubmit(m_queue, 1, &submit, fence->getHandle()));
+		ANKI_VK_CHECKF(
+			vkQueueSubmit(queue, 1, &submit, (timelineSemaphore) ? VK_NULL_HANDLE : fence->getHandle()));
 	}
 
 	if(wait)
 	{
-		vkQueueWaitIdle(m_queue);
+		vkQueueWaitIdle(queue);
 	}
 }
 
@@ -907,6 +1496,16 @@ void GrManagerImpl::finish()
 {
 	LockGuard<Mutex> lock(m_globalMtx);
 	vkQueueWaitIdle(m_queue);
+
+	if(m_asyncComputeQueue)
+	{
+		vkQueueWaitIdle(m_asyncComputeQueue);
+	}
+
+	if(m_transferQueue)
+	{
+		vkQueueWaitIdle(m_transferQueue);
+	}
 }
 
 void GrManagerImpl::trySetVulkanHandleName(CString name, VkDebugReportObjectTypeEXT type, U64 handle) const
@@ -1013,7 +1612,9 @@ Error GrManagerImpl::printPipelineShaderInfoInternal(
 												   "stage 2 VGPR,stage 2 SGPR,"
 												   "stage 3 VGPR,stage 3 SGPR,"
 												   "stage 4 VGPR,stage 4 SGPR,"
-												   "stage 5 VGPR,stage 5 SGPR\n"));
+												   "stage 5 VGPR,stage 5 SGPR,"
+												   "stage 6 VGPR,stage 6 SGPR,"
+												   "stage 7 VGPR,stage 7 SGPR\n"));
 		}
 
 		ANKI_CHECK(m_shaderStatsFile.writeText("%s,0x%" PRIx64 ",", name.cstr(), hash));
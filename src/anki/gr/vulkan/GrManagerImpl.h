@@ -18,6 +18,9 @@
 #include <anki/gr/vulkan/SwapchainFactory.h>
 #include <anki/gr/vulkan/PipelineLayout.h>
 #include <anki/gr/vulkan/PipelineCache.h>
+#include <anki/gr/vulkan/PipelineManifest.h>
+#include <anki/gr/vulkan/PipelineCompiler.h>
+#include <anki/gr/vulkan/GpuBreadcrumbs.h>
 #include <anki/gr/vulkan/DescriptorSet.h>
 #include <anki/util/HashMap.h>
 #include <anki/util/File.h>
@@ -52,6 +55,40 @@ public:
 		return m_queueIdx;
 	}
 
+	/// The queue families that share the resources. It's the graphics, the async compute and the transfer family if
+	/// there are such.
+	ConstWeakArray<U32> getQueueFamilies() const
+	{
+		return ConstWeakArray<U32>(&m_queueFamilies[0], m_queueFamilyCount);
+	}
+
+	Bool getAsyncComputeEnabled() const
+	{
+		return m_asyncComputeQueue != VK_NULL_HANDLE;
+	}
+
+	Bool getAsyncTransferEnabled() const
+	{
+		return m_transferQueue != VK_NULL_HANDLE;
+	}
+
+	/// Get the queue of a type. It's null if the device doesn't have such.
+	VkQueue getQueue(VulkanQueueType type) const
+	{
+		switch(type)
+		{
+		case VulkanQueueType::GENERAL:
+			return m_queue;
+		case VulkanQueueType::ASYNC_COMPUTE:
+			return m_asyncComputeQueue;
+		case VulkanQueueType::TRANSFER:
+			return m_transferQueue;
+		default:
+			ANKI_ASSERT(0);
+			return VK_NULL_HANDLE;
+		}
+	}
+
 	const VkPhysicalDeviceProperties& getPhysicalDeviceProperties() const
 	{
 		return m_devProps;
@@ -61,6 +98,9 @@ public:
 
 	void endFrame();
 
+	/// Wait for the GPU to finish the previous frame if low latency is enabled.
+	void waitForPreviousFrame();
+
 	void finish();
 
 	VkDevice getDevice() const
@@ -88,6 +128,24 @@ public:
 		return m_cmdbFactory;
 	}
 
+	/// The factories of all the queues. Good for stats.
+	Array<const CommandBufferFactory*, U32(VulkanQueueType::COUNT)> getCommandBufferFactories() const
+	{
+		return {{&m_cmdbFactory, &m_asyncComputeCmdbFactory, &m_transferCmdbFactory}};
+	}
+
+	CommandBufferFactory& getAsyncComputeCommandBufferFactory()
+	{
+		ANKI_ASSERT(getAsyncComputeEnabled());
+		return m_asyncComputeCmdbFactory;
+	}
+
+	CommandBufferFactory& getTransferCommandBufferFactory()
+	{
+		ANKI_ASSERT(getAsyncTransferEnabled());
+		return m_transferCmdbFactory;
+	}
+
 	MicroFencePtr newFence()
 	{
 		return m_fences.newInstance();
@@ -99,7 +157,17 @@ public:
 	}
 	/// @}
 
-	void flushCommandBuffer(CommandBufferPtr ptr, FencePtr* fence, Bool wait = false);
+	/// Submit a command buffer.
+	/// @param ptr The command buffer.
+	/// @param[out] fence Optionaly create a fence.
+	/// @param wait Wait for the queue to become idle.
+	/// @param gpuWaitFences Fences that the GPU will wait before running the command buffer.
+	/// @param gpuWaitableFence The fence will have a semaphore so that a later submit can wait for it in the GPU.
+	void flushCommandBuffer(CommandBufferPtr ptr,
+		FencePtr* fence,
+		Bool wait = false,
+		ConstWeakArray<FencePtr> gpuWaitFences = ConstWeakArray<FencePtr>(),
+		Bool gpuWaitableFence = false);
 
 	/// @name Memory
 	/// @{
@@ -124,11 +192,21 @@ public:
 		return m_occlusionQueryFactory;
 	}
 
+	const QueryFactory& getOcclusionQueryFactory() const
+	{
+		return m_occlusionQueryFactory;
+	}
+
 	QueryFactory& getTimestampQueryFactory()
 	{
 		return m_timestampQueryFactory;
 	}
 
+	const QueryFactory& getTimestampQueryFactory() const
+	{
+		return m_timestampQueryFactory;
+	}
+
 	Bool getR8g8b8ImagesSupported() const
 	{
 		return m_r8g8b8ImagesSupported;
@@ -149,12 +227,27 @@ public:
 		return m_descrFactory;
 	}
 
+	const DescriptorSetFactory& getDescriptorSetFactory() const
+	{
+		return m_descrFactory;
+	}
+
 	VkPipelineCache getPipelineCache() const
 	{
 		ANKI_ASSERT(m_pplineCache.m_cacheHandle);
 		return m_pplineCache.m_cacheHandle;
 	}
 
+	PipelineManifest& getPipelineManifest()
+	{
+		return m_pplineManifest;
+	}
+
+	PipelineCompiler& getPipelineCompiler()
+	{
+		return m_pplineCompiler;
+	}
+
 	PipelineLayoutFactory& getPipelineLayoutFactory()
 	{
 		return m_pplineLayoutFactory;
@@ -165,6 +258,40 @@ public:
 		return m_extensions;
 	}
 
+	/// Create a renderpass with VK_KHR_create_renderpass2. It's there only if GpuDeviceCapabilities::m_vrs is true.
+	PFN_vkCreateRenderPass2KHR getCreateRenderPass2Function() const
+	{
+		ANKI_ASSERT(m_pfnCreateRenderPass2KHR);
+		return m_pfnCreateRenderPass2KHR;
+	}
+
+	/// Push descriptors with VK_KHR_push_descriptor. It's there only if there are descriptor set layouts with push
+	/// descriptors.
+	PFN_vkCmdPushDescriptorSetKHR getCmdPushDescriptorSetFunction() const
+	{
+		ANKI_ASSERT(m_pfnCmdPushDescriptorSetKHR);
+		return m_pfnCmdPushDescriptorSetKHR;
+	}
+
+	/// Draw with the task and mesh shaders. It's there only if GpuDeviceCapabilities::m_meshShaders is true.
+	PFN_vkCmdDrawMeshTasksNV getCmdDrawMeshTasksFunction() const
+	{
+		ANKI_ASSERT(m_pfnCmdDrawMeshTasksNV);
+		return m_pfnCmdDrawMeshTasksNV;
+	}
+
+	/// @copydoc getCmdDrawMeshTasksFunction
+	PFN_vkCmdDrawMeshTasksIndirectNV getCmdDrawMeshTasksIndirectFunction() const
+	{
+		ANKI_ASSERT(m_pfnCmdDrawMeshTasksIndirectNV);
+		return m_pfnCmdDrawMeshTasksIndirectNV;
+	}
+
+	GpuBreadcrumbs& getBreadcrumbs()
+	{
+		return m_breadcrumbs;
+	}
+
 	MicroSwapchainPtr getSwapchain() const
 	{
 		return m_crntSwapchain;
@@ -224,6 +351,8 @@ public:
 
 private:
 	U64 m_frame = 0;
+	U8 m_maxFramesInFlight = MAX_FRAMES_IN_FLIGHT - 1;
+	Bool m_lowLatency = false;
 
 #if ANKI_GR_MANAGER_DEBUG_MEMMORY
 	VkAllocationCallbacks m_debugAllocCbs;
@@ -244,16 +373,34 @@ private:
 	VkDevice m_device = VK_NULL_HANDLE;
 	U32 m_queueIdx = MAX_U32;
 	VkQueue m_queue = VK_NULL_HANDLE;
+	U32 m_asyncComputeQueueIdx = MAX_U32;
+	VkQueue m_asyncComputeQueue = VK_NULL_HANDLE; ///< A compute only queue. It's null if async compute is disabled.
+	U32 m_transferQueueIdx = MAX_U32;
+	VkQueue m_transferQueue = VK_NULL_HANDLE; ///< A transfer only queue for the uploads. It might be null.
+	Array<U32, U32(VulkanQueueType::COUNT)> m_queueFamilies = {{MAX_U32, MAX_U32, MAX_U32}};
+	U8 m_queueFamilyCount = 0;
 	Mutex m_globalMtx;
 
 	VkPhysicalDeviceProperties m_devProps = {};
 	VkPhysicalDeviceFeatures m_devFeatures = {};
 	VkPhysicalDeviceDescriptorIndexingFeaturesEXT m_descriptorIndexingFeatures = {};
+	VkPhysicalDeviceFragmentShadingRateFeaturesKHR m_fragmentShadingRateFeatures = {};
+	VkPhysicalDeviceTimelineSemaphoreFeaturesKHR m_timelineSemaphoreFeatures = {};
+	VkPhysicalDeviceMeshShaderFeaturesNV m_meshShaderFeatures = {};
+	VkPhysicalDeviceShaderFloat16Int8FeaturesKHR m_float16Int8Features = {};
 
 	PFN_vkDebugMarkerSetObjectNameEXT m_pfnDebugMarkerSetObjectNameEXT = nullptr;
 	PFN_vkCmdDebugMarkerBeginEXT m_pfnCmdDebugMarkerBeginEXT = nullptr;
 	PFN_vkCmdDebugMarkerEndEXT m_pfnCmdDebugMarkerEndEXT = nullptr;
 	PFN_vkGetShaderInfoAMD m_pfnGetShaderInfoAMD = nullptr;
+	PFN_vkCreateRenderPass2KHR m_pfnCreateRenderPass2KHR = nullptr;
+	PFN_vkCmdPushDescriptorSetKHR m_pfnCmdPushDescriptorSetKHR = nullptr;
+	PFN_vkGetSemaphoreCounterValueKHR m_pfnGetSemaphoreCounterValueKHR = nullptr;
+	PFN_vkWaitSemaphoresKHR m_pfnWaitSemaphoresKHR = nullptr;
+	PFN_vkCmdDrawMeshTasksNV m_pfnCmdDrawMeshTasksNV = nullptr;
+	PFN_vkCmdDrawMeshTasksIndirectNV m_pfnCmdDrawMeshTasksIndirectNV = nullptr;
+	PFN_vkCmdWriteBufferMarkerAMD m_pfnCmdWriteBufferMarkerAMD = nullptr;
+	U32 m_maxPushDescriptors = 0; ///< Zero if VK_KHR_push_descriptor is not used.
 	mutable File m_shaderStatsFile;
 	mutable SpinLock m_shaderStatsFileMtx;
 
@@ -285,9 +432,20 @@ private:
 	/// @}
 
 	CommandBufferFactory m_cmdbFactory;
+	CommandBufferFactory m_asyncComputeCmdbFactory;
+	CommandBufferFactory m_transferCmdbFactory;
 
 	FenceFactory m_fences;
 	SemaphoreFactory m_semaphores;
+
+	/// One timeline semaphore per VulkanQueueType. They replace the fences of the submits. They are null if
+	/// VK_KHR_timeline_semaphore is not used.
+	Array<VkSemaphore, U32(VulkanQueueType::COUNT)> m_timelineSemaphores = {};
+	/// The last value that was signaled by a submit. Protected by m_globalMtx.
+	Array<U64, U32(VulkanQueueType::COUNT)> m_timelineValues = {};
+	/// The value that a queue waited last. The transfer queue waits for the general and the rest wait for the transfer.
+	/// Protected by m_globalMtx.
+	Array<U64, U32(VulkanQueueType::COUNT)> m_crossQueueWaitedValues = {};
 	DeferredBarrierFactory m_barrierFactory;
 	SamplerFactory m_samplerFactory;
 	/// @}
@@ -301,7 +459,11 @@ private:
 	QueryFactory m_occlusionQueryFactory;
 	QueryFactory m_timestampQueryFactory;
 
+	GpuBreadcrumbs m_breadcrumbs;
+
 	PipelineCache m_pplineCache;
+	PipelineManifest m_pplineManifest;
+	PipelineCompiler m_pplineCompiler;
 
 	Bool m_r8g8b8ImagesSupported = false;
 	Bool m_s8ImagesSupported = false;
@@ -316,6 +478,7 @@ private:
 	ANKI_USE_RESULT Error initDevice(const GrManagerInitInfo& init);
 	ANKI_USE_RESULT Error initFramebuffers(const GrManagerInitInfo& init);
 	ANKI_USE_RESULT Error initMemory(const ConfigSet& cfg);
+	ANKI_USE_RESULT Error initTimelineSemaphores();
 
 #if ANKI_GR_MANAGER_DEBUG_MEMMORY
 	static void* allocateCallback(
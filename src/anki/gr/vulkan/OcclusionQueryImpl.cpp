@@ -28,29 +28,11 @@ OcclusionQueryResult OcclusionQueryImpl::getResultInternal() const
 	ANKI_ASSERT(m_handle);
 	U64 out = 0;
 
-	VkResult res;
-	ANKI_VK_CHECKF(res = vkGetQueryPoolResults(getDevice(),
-					   m_handle.getQueryPool(),
-					   m_handle.getQueryIndex(),
-					   1,
-					   sizeof(out),
-					   &out,
-					   sizeof(out),
-					   VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT | VK_QUERY_RESULT_PARTIAL_BIT));
-
 	OcclusionQueryResult qout = OcclusionQueryResult::NOT_AVAILABLE;
-	if(res == VK_SUCCESS)
+	if(getGrManagerImpl().getOcclusionQueryFactory().getResult(m_handle, out))
 	{
 		qout = (out) ? OcclusionQueryResult::VISIBLE : OcclusionQueryResult::NOT_VISIBLE;
 	}
-	else if(res == VK_NOT_READY)
-	{
-		qout = OcclusionQueryResult::NOT_AVAILABLE;
-	}
-	else
-	{
-		ANKI_ASSERT(0);
-	}
 
 	return qout;
 }
@@ -22,6 +22,7 @@ void PipelineStateTracker::reset()
 	m_fbDepth = false;
 	m_fbStencil = false;
 	m_defaultFb = false;
+	m_fbShadingRate = false;
 	m_fbColorAttachmentMask.unsetAll();
 	m_rpass = VK_NULL_HANDLE;
 	m_fb.reset(nullptr);
@@ -191,6 +192,12 @@ void PipelineStateTracker::updateSuperHash()
 		}
 	}
 
+	// The pipelines of FBs with a shading rate image are different
+	if(m_fbShadingRate)
+	{
+		buff[count++] = 1;
+	}
+
 	// Super hash
 	m_hashes.m_superHash = computeHash(&buff[0], count * sizeof(buff[0]));
 }
@@ -246,6 +253,13 @@ const VkGraphicsPipelineCreateInfo& PipelineStateTracker::updatePipelineCreateIn
 	iaCi.topology = convertTopology(m_state.m_inputAssembler.m_topology);
 	ci.pInputAssemblyState = &iaCi;
 
+	// The mesh shaders have no vertex input and no input assembly
+	if(!!(static_cast<const ShaderProgramImpl&>(*m_state.m_prog).getStages() & ShaderTypeBit::MESH))
+	{
+		ci.pVertexInputState = nullptr;
+		ci.pInputAssemblyState = nullptr;
+	}
+
 	// Viewport
 	VkPipelineViewportStateCreateInfo& vpCi = m_ci.m_vp;
 	vpCi = {};
@@ -382,6 +396,21 @@ const VkGraphicsPipelineCreateInfo& PipelineStateTracker::updatePipelineCreateIn
 	dynCi.pDynamicStates = &DYN[0];
 	ci.pDynamicState = &dynCi;
 
+	// Shading rate. The rate of the pipeline is 1x1 and the shading rate image replaces it
+	if(m_fbShadingRate)
+	{
+		VkPipelineFragmentShadingRateStateCreateInfoKHR& shadingRateCi = m_ci.m_shadingRate;
+		shadingRateCi = {};
+		shadingRateCi.sType = VK_STRUCTURE_TYPE_PIPELINE_FRAGMENT_SHADING_RATE_STATE_CREATE_INFO_KHR;
+		shadingRateCi.fragmentSize.width = 1;
+		shadingRateCi.fragmentSize.height = 1;
+		shadingRateCi.combinerOps[0] = VK_FRAGMENT_SHADING_RATE_COMBINER_OP_KEEP_KHR;
+		shadingRateCi.combinerOps[1] = VK_FRAGMENT_SHADING_RATE_COMBINER_OP_REPLACE_KHR;
+
+		ANKI_ASSERT(ci.pNext == nullptr);
+		ci.pNext = &shadingRateCi;
+	}
+
 	// The rest
 	ci.layout = static_cast<const ShaderProgramImpl&>(*m_state.m_prog).getPipelineLayout().getHandle();
 	ci.renderPass = m_rpass;
@@ -390,6 +419,30 @@ const VkGraphicsPipelineCreateInfo& PipelineStateTracker::updatePipelineCreateIn
 	return ci;
 }
 
+void PipelineStateTracker::copyCreationState(const PipelineStateTracker& b)
+{
+	m_state.m_prog = b.m_state.m_prog;
+	memcpy(&m_state.m_vertex, &b.m_state.m_vertex, sizeof(m_state.m_vertex));
+	memcpy(&m_state.m_inputAssembler, &b.m_state.m_inputAssembler, sizeof(m_state.m_inputAssembler));
+	memcpy(&m_state.m_tessellation, &b.m_state.m_tessellation, sizeof(m_state.m_tessellation));
+	memcpy(&m_state.m_viewport, &b.m_state.m_viewport, sizeof(m_state.m_viewport));
+	memcpy(&m_state.m_rasterizer, &b.m_state.m_rasterizer, sizeof(m_state.m_rasterizer));
+	memcpy(&m_state.m_depth, &b.m_state.m_depth, sizeof(m_state.m_depth));
+	memcpy(&m_state.m_stencil, &b.m_state.m_stencil, sizeof(m_state.m_stencil));
+	memcpy(&m_state.m_color, &b.m_state.m_color, sizeof(m_state.m_color));
+
+	m_shaderAttributeMask = b.m_shaderAttributeMask;
+	m_shaderColorAttachmentWritemask = b.m_shaderColorAttachmentWritemask;
+
+	m_rpass = b.m_rpass;
+	m_fb = b.m_fb;
+	m_fbDepth = b.m_fbDepth;
+	m_fbStencil = b.m_fbStencil;
+	m_defaultFb = b.m_defaultFb;
+	m_fbShadingRate = b.m_fbShadingRate;
+	m_fbColorAttachmentMask = b.m_fbColorAttachmentMask;
+}
+
 class PipelineFactory::PipelineInternal
 {
 public:
@@ -398,6 +451,8 @@ public:
 	/// The pipeline needs a render pass and the framebuffers are the owners of that. So the internal pipeline will
 	/// hold a ref to the FB in order to hold a ref to the render pass.
 	FramebufferPtr m_fb;
+
+	Bool m_pending = false; ///< It's being created in the background.
 };
 
 class PipelineFactory::Hasher
@@ -409,6 +464,70 @@ public:
 	}
 };
 
+/// An open addressing hash table that is only appended to. The readers don't lock. When it gets full a bigger copy
+/// replaces it and the old one stays alive until the factory is destroyed because some reader might still use it.
+class PipelineFactory::LookupTable
+{
+public:
+	class Slot
+	{
+	public:
+		Atomic<U64> m_hash; ///< Zero if the slot is empty. It's written after the m_handle.
+		Atomic<VkPipeline> m_handle;
+	};
+
+	DynamicArray<Slot> m_slots;
+	U32 m_count = 0; ///< Only the writer touches it.
+	LookupTable* m_prev = nullptr; ///< The table it replaced.
+
+	LookupTable(GrAllocator<U8> alloc, U32 slotCount)
+	{
+		ANKI_ASSERT(isPowerOfTwo(slotCount));
+		m_slots.create(alloc, slotCount);
+		for(Slot& slot : m_slots)
+		{
+			slot.m_hash.setNonAtomically(0);
+			slot.m_handle.setNonAtomically(VK_NULL_HANDLE);
+		}
+	}
+
+	VkPipeline find(U64 hash) const
+	{
+		const U32 mask = m_slots.getSize() - 1;
+		for(U32 i = U32(hash) & mask;; i = (i + 1) & mask)
+		{
+			const U64 slotHash = m_slots[i].m_hash.load(AtomicMemoryOrder::ACQUIRE);
+			if(slotHash == hash)
+			{
+				return m_slots[i].m_handle.load(AtomicMemoryOrder::RELAXED);
+			}
+			else if(slotHash == 0)
+			{
+				return VK_NULL_HANDLE;
+			}
+		}
+	}
+
+	/// The hash shouldn't exist.
+	void insert(U64 hash, VkPipeline handle)
+	{
+		ANKI_ASSERT(hash != 0 && handle);
+		ANKI_ASSERT(m_count < m_slots.getSize() / 2);
+
+		const U32 mask = m_slots.getSize() - 1;
+		U32 i = U32(hash) & mask;
+		while(m_slots[i].m_hash.load(AtomicMemoryOrder::RELAXED) != 0)
+		{
+			ANKI_ASSERT(m_slots[i].m_hash.load(AtomicMemoryOrder::RELAXED) != hash);
+			i = (i + 1) & mask;
+		}
+
+		m_slots[i].m_handle.store(handle, AtomicMemoryOrder::RELAXED);
+		m_slots[i].m_hash.store(hash, AtomicMemoryOrder::RELEASE);
+		++m_count;
+	}
+};
+
 void PipelineFactory::destroy()
 {
 	for(auto it : m_pplines)
@@ -421,9 +540,55 @@ void PipelineFactory::destroy()
 	}
 
 	m_pplines.destroy(m_alloc);
+
+	LookupTable* table = numberToPtr<LookupTable*>(m_lookupTable.load());
+	while(table)
+	{
+		LookupTable* prev = table->m_prev;
+		table->m_slots.destroy(m_alloc);
+		m_alloc.deleteInstance(table);
+		table = prev;
+	}
+	m_lookupTable.store(0);
 }
 
-void PipelineFactory::newPipeline(PipelineStateTracker& state, Pipeline& ppline, Bool& stateDirty)
+VkPipeline PipelineFactory::lookupPipeline(U64 hash) const
+{
+	const LookupTable* table = numberToPtr<const LookupTable*>(m_lookupTable.load(AtomicMemoryOrder::ACQUIRE));
+	return (table) ? table->find(hash) : VK_NULL_HANDLE;
+}
+
+void PipelineFactory::publishPipeline(U64 hash, VkPipeline handle)
+{
+	LookupTable* table = numberToPtr<LookupTable*>(m_lookupTable.load(AtomicMemoryOrder::RELAXED));
+
+	if(!table || table->m_count + 1 > table->m_slots.getSize() / 2)
+	{
+		// Grow. Copy everything to a new table and then make it visible to the readers
+		const U32 slotCount = (table) ? table->m_slots.getSize() * 2 : 64;
+		LookupTable* newTable = m_alloc.newInstance<LookupTable>(m_alloc, slotCount);
+
+		if(table)
+		{
+			for(const LookupTable::Slot& slot : table->m_slots)
+			{
+				const U64 slotHash = slot.m_hash.load(AtomicMemoryOrder::RELAXED);
+				if(slotHash)
+				{
+					newTable->insert(slotHash, slot.m_handle.load(AtomicMemoryOrder::RELAXED));
+				}
+			}
+		}
+
+		newTable->m_prev = table;
+		table = newTable;
+		m_lookupTable.store(ptrToNumber(newTable), AtomicMemoryOrder::RELEASE);
+	}
+
+	table->insert(hash, handle);
+}
+
+Bool PipelineFactory::newPipeline(PipelineStateTracker& state, Pipeline& ppline, Bool& stateDirty, Bool async)
 {
 	U64 hash;
 	state.flush(hash, stateDirty);
@@ -431,37 +596,163 @@ void PipelineFactory::newPipeline(PipelineStateTracker& state, Pipeline& ppline,
 	if(ANKI_UNLIKELY(!stateDirty))
 	{
 		ppline.m_handle = VK_NULL_HANDLE;
-		return;
+		return true;
 	}
 
-	LockGuard<SpinLock> lock(m_pplinesMtx);
+	// Fast path, the pipeline exists
+	ppline.m_handle = lookupPipeline(hash);
+	if(ANKI_LIKELY(ppline.m_handle))
+	{
+		return true;
+	}
+
+	ShaderProgramImpl& shaderImpl = static_cast<ShaderProgramImpl&>(*state.m_state.m_prog);
+	PipelineCompiler& compiler = shaderImpl.getGrManagerImpl().getPipelineCompiler();
+	async = async && compiler.isEnabled();
+
+	Bool create = false;
+	Bool submit = false;
+	{
+		LockGuard<SpinLock> lock(m_pplinesMtx);
+
+		auto it = m_pplines.find(hash);
+		if(it != m_pplines.getEnd() && !(*it).m_pending)
+		{
+			// Got created after the lookup
+			ppline.m_handle = (*it).m_handle;
+		}
+		else if(async)
+		{
+			if(it == m_pplines.getEnd())
+			{
+				PipelineInternal pp;
+				pp.m_pending = true;
+				m_pplines.emplace(m_alloc, hash, pp);
+				submit = true;
+			}
+		}
+		else
+		{
+			create = true;
+		}
+	}
 
-	auto it = m_pplines.find(hash);
-	if(it != m_pplines.getEnd())
+	if(submit)
 	{
-		ppline.m_handle = (*it).m_handle;
+		compiler.submit(*this, state, hash);
 	}
-	else
+
+	Bool created = false;
+	if(create)
 	{
-		PipelineInternal pp;
-		const VkGraphicsPipelineCreateInfo& ci = state.updatePipelineCreateInfo();
-		pp.m_fb = state.getFb();
+		// Don't wait for the background creation and don't block the other threads, create it here without locking
+		ppline.m_handle = createPipeline(state, hash);
+		created = storePipeline(state, hash, ppline.m_handle);
+	}
 
+	if(!ppline.m_handle)
+	{
+		// Not ready, the next drawcall should try again
+		state.invalidateLastPipeline();
+		return false;
+	}
+
+	// Remember it so it can be created ahead of time the next time
+	if(created)
+	{
+		shaderImpl.getGrManagerImpl().getPipelineManifest().recordPipeline(state);
+	}
+
+	return true;
+}
+
+void PipelineFactory::warmupPipeline(PipelineStateTracker& state)
+{
+	U64 hash;
+	Bool stateDirty;
+	state.flush(hash, stateDirty);
+
+	{
+		LockGuard<SpinLock> lock(m_pplinesMtx);
+		if(m_pplines.find(hash) != m_pplines.getEnd())
 		{
-			ANKI_TRACE_SCOPED_EVENT(VK_PIPELINE_CREATE);
-			ANKI_VK_CHECKF(vkCreateGraphicsPipelines(m_dev, m_pplineCache, 1, &ci, nullptr, &pp.m_handle));
+			return;
 		}
+	}
 
-		ANKI_TRACE_INC_COUNTER(VK_PIPELINE_CREATE, 1);
+	// The warmup has no FB to hold, its renderpass is only needed during the creation
+	VkPipeline handle = createPipeline(state, hash);
+	storePipeline(state, hash, handle);
+}
 
-		m_pplines.emplace(m_alloc, hash, pp);
-		ppline.m_handle = pp.m_handle;
+void PipelineFactory::createAsyncPipeline(PipelineStateTracker& state, U64 hash)
+{
+	VkPipeline handle = createPipeline(state, hash);
+	if(storePipeline(state, hash, handle))
+	{
+		ShaderProgramImpl& shaderImpl = static_cast<ShaderProgramImpl&>(*state.m_state.m_prog);
+		shaderImpl.getGrManagerImpl().getPipelineManifest().recordPipeline(state);
+	}
+}
+
+Bool PipelineFactory::storePipeline(PipelineStateTracker& state, U64 hash, VkPipeline& handle)
+{
+	Bool stored = false;
+	const VkPipeline newHandle = handle;
+	{
+		LockGuard<SpinLock> lock(m_pplinesMtx);
+
+		auto it = m_pplines.find(hash);
+		if(it != m_pplines.getEnd() && !(*it).m_pending)
+		{
+			// Some other thread created it in the meantime
+			handle = (*it).m_handle;
+		}
+		else
+		{
+			PipelineInternal pp;
+			pp.m_handle = handle;
+			pp.m_fb = state.m_fb;
+
+			if(it != m_pplines.getEnd())
+			{
+				*it = pp;
+			}
+			else
+			{
+				m_pplines.emplace(m_alloc, hash, pp);
+			}
+
+			publishPipeline(hash, handle);
+			stored = true;
+		}
+	}
 
-		// Print shader info
-		const ShaderProgramImpl& shaderImpl = static_cast<const ShaderProgramImpl&>(*state.m_state.m_prog);
-		shaderImpl.getGrManagerImpl().printPipelineShaderInfo(
-			pp.m_handle, shaderImpl.getName(), shaderImpl.getStages(), hash);
+	if(!stored)
+	{
+		vkDestroyPipeline(m_dev, newHandle, nullptr);
 	}
+
+	return stored;
+}
+
+VkPipeline PipelineFactory::createPipeline(PipelineStateTracker& state, U64 hash)
+{
+	VkPipeline handle;
+	const VkGraphicsPipelineCreateInfo& ci = state.updatePipelineCreateInfo();
+
+	{
+		ANKI_TRACE_SCOPED_EVENT(VK_PIPELINE_CREATE);
+		ANKI_VK_CHECKF(vkCreateGraphicsPipelines(m_dev, m_pplineCache, 1, &ci, nullptr, &handle));
+	}
+
+	ANKI_TRACE_INC_COUNTER(VK_PIPELINE_CREATE, 1);
+
+	// Print shader info
+	const ShaderProgramImpl& shaderImpl = static_cast<const ShaderProgramImpl&>(*state.m_state.m_prog);
+	shaderImpl.getGrManagerImpl().printPipelineShaderInfo(handle, shaderImpl.getName(), shaderImpl.getStages(), hash);
+
+	return handle;
 }
 
 } // end namespace anki
@@ -11,6 +11,7 @@
 #include <anki/gr/Framebuffer.h>
 #include <anki/gr/vulkan/FramebufferImpl.h>
 #include <anki/util/HashMap.h>
+#include <anki/util/Atomic.h>
 
 namespace anki
 {
@@ -177,6 +178,7 @@ public:
 class PipelineStateTracker : public NonCopyable
 {
 	friend class PipelineFactory;
+	friend class PipelineManifest;
 
 public:
 	PipelineStateTracker()
@@ -386,9 +388,27 @@ public:
 		m_fbStencil = s;
 		m_rpass = fbimpl.getCompatibleRenderPass();
 		m_defaultFb = fbimpl.hasPresentableTexture();
+		m_fbShadingRate = fbimpl.hasShadingRateAttachment();
 		m_fb = fb;
 	}
 
+	/// Begin a renderpass that has no framebuffer. It's used to create pipelines ahead of time.
+	/// @param rpass A renderpass that is compatible with the renderpasses the pipeline will be used with.
+	void beginRenderPass(VkRenderPass rpass,
+		BitSet<MAX_COLOR_ATTACHMENTS, U8> colorAttachmentMask,
+		Bool depth,
+		Bool stencil,
+		Bool defaultFb)
+	{
+		ANKI_ASSERT(m_rpass == VK_NULL_HANDLE && rpass);
+		m_fbColorAttachmentMask = colorAttachmentMask;
+		m_fbDepth = depth;
+		m_fbStencil = stencil;
+		m_rpass = rpass;
+		m_defaultFb = defaultFb;
+		m_fbShadingRate = false;
+	}
+
 	void endRenderPass()
 	{
 		ANKI_ASSERT(m_rpass);
@@ -433,9 +453,18 @@ public:
 		ANKI_ASSERT(pipelineHash);
 	}
 
+	/// Forget the pipeline of the last flush. Call it if that pipeline couldn't be bound.
+	void invalidateLastPipeline()
+	{
+		m_hashes.m_lastSuperHash = 0;
+	}
+
 	/// Populate the internal pipeline create info structure.
 	const VkGraphicsPipelineCreateInfo& updatePipelineCreateInfo();
 
+	/// Copy the state that updatePipelineCreateInfo() needs.
+	void copyCreationState(const PipelineStateTracker& b);
+
 	FramebufferPtr getFb() const
 	{
 		ANKI_ASSERT(m_fb.isCreated());
@@ -489,6 +518,7 @@ private:
 	Bool m_fbDepth = false;
 	Bool m_fbStencil = false;
 	Bool m_defaultFb = false;
+	Bool m_fbShadingRate = false; ///< The FB has a shading rate image.
 	BitSet<MAX_COLOR_ATTACHMENTS, U8> m_fbColorAttachmentMask = {false};
 
 	class Hashes
@@ -530,6 +560,7 @@ private:
 		VkPipelineDynamicStateCreateInfo m_dyn;
 		VkGraphicsPipelineCreateInfo m_ppline;
 		VkPipelineRasterizationStateRasterizationOrderAMD m_rasterOrder;
+		VkPipelineFragmentShadingRateStateCreateInfoKHR m_shadingRate;
 	} m_ci;
 
 	Bool updateHashes();
@@ -573,19 +604,48 @@ public:
 
 	void destroy();
 
+	/// Get or create the pipeline of some state.
+	/// @param async If the pipeline doesn't exist create it in the background. Only when there is a PipelineCompiler.
+	/// @return False if the pipeline is still being created in the background. Skip the drawcall in that case.
+	/// @note Thread-safe.
+	Bool newPipeline(PipelineStateTracker& state, Pipeline& ppline, Bool& stateDirty, Bool async);
+
+	/// Create the pipeline of some state if it doesn't exist. Used to create pipelines before they are needed.
+	/// @note Thread-safe.
+	void warmupPipeline(PipelineStateTracker& state);
+
+	/// Create a pipeline that newPipeline() requested to be created in the background. Called by the PipelineCompiler.
 	/// @note Thread-safe.
-	void newPipeline(PipelineStateTracker& state, Pipeline& ppline, Bool& stateDirty);
+	void createAsyncPipeline(PipelineStateTracker& state, U64 hash);
 
 private:
 	class PipelineInternal;
 	class Hasher;
+	class LookupTable;
 
 	GrAllocator<U8> m_alloc;
 	VkDevice m_dev = VK_NULL_HANDLE;
 	VkPipelineCache m_pplineCache = VK_NULL_HANDLE;
 
-	HashMap<U64, PipelineInternal, Hasher> m_pplines;
+	HashMap<U64, PipelineInternal, Hasher> m_pplines; ///< Owns the pipelines. Protected by m_pplinesMtx.
 	SpinLock m_pplinesMtx;
+
+	/// A copy of the created pipelines of m_pplines that can be searched without locking. It's a LookupTable*.
+	Atomic<PtrSize> m_lookupTable = {0};
+
+	/// Search for a created pipeline without locking.
+	VkPipeline lookupPipeline(U64 hash) const;
+
+	/// Make a created pipeline visible to lookupPipeline(). It should be called with m_pplinesMtx locked.
+	void publishPipeline(U64 hash, VkPipeline handle);
+
+	/// Create a pipeline. It doesn't store it.
+	VkPipeline createPipeline(PipelineStateTracker& state, U64 hash);
+
+	/// Store a pipeline that got created without holding the lock. If some other thread stored the same pipeline in
+	/// the meantime the new one is destroyed and @a handle is set to the stored one.
+	/// @return True if it got stored.
+	Bool storePipeline(PipelineStateTracker& state, U64 hash, VkPipeline& handle);
 };
 /// @}
 
@@ -0,0 +1,111 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/gr/vulkan/PipelineCompiler.h>
+#include <anki/util/Tracer.h>
+
+namespace anki
+{
+
+PipelineCompiler::~PipelineCompiler()
+{
+	ANKI_ASSERT(m_threads.getSize() == 0 && "Forgot to call destroy()");
+}
+
+void PipelineCompiler::init(GrAllocator<U8> alloc, U32 threadCount)
+{
+	m_alloc = alloc;
+
+	if(threadCount == 0)
+	{
+		return;
+	}
+
+	m_threads.create(m_alloc, threadCount);
+	for(Thread*& thread : m_threads)
+	{
+		thread = m_alloc.newInstance<Thread>("anki_pplcomp");
+		thread->start(this, threadCallback);
+	}
+}
+
+void PipelineCompiler::destroy()
+{
+	{
+		LockGuard<Mutex> lock(m_mtx);
+		m_quit = true;
+		m_condVar.notifyAll();
+	}
+
+	for(Thread* thread : m_threads)
+	{
+		const Error err = thread->join();
+		(void)err;
+		m_alloc.deleteInstance(thread);
+	}
+
+	m_threads.destroy(m_alloc);
+
+	// The pipelines of the dropped jobs stay pending but nobody will draw with them any more
+	while(!m_jobs.isEmpty())
+	{
+		m_alloc.deleteInstance(m_jobs.popFront());
+	}
+}
+
+void PipelineCompiler::submit(PipelineFactory& factory, const PipelineStateTracker& state, U64 hash)
+{
+	ANKI_ASSERT(isEnabled());
+
+	Job* job = m_alloc.newInstance<Job>();
+	job->m_factory = &factory;
+	job->m_state.copyCreationState(state);
+	job->m_hash = hash;
+
+	LockGuard<Mutex> lock(m_mtx);
+	m_jobs.pushBack(job);
+	m_condVar.notifyOne();
+}
+
+Error PipelineCompiler::threadCallback(ThreadCallbackInfo& info)
+{
+	PipelineCompiler& self = *static_cast<PipelineCompiler*>(info.m_userData);
+	self.threadWorker();
+	return Error::NONE;
+}
+
+void PipelineCompiler::threadWorker()
+{
+	while(true)
+	{
+		Job* job = nullptr;
+
+		{
+			// Wait for something
+			LockGuard<Mutex> lock(m_mtx);
+			while(m_jobs.isEmpty() && !m_quit)
+			{
+				m_condVar.wait(m_mtx);
+			}
+
+			if(m_quit)
+			{
+				break;
+			}
+
+			job = m_jobs.popFront();
+		}
+
+		{
+			ANKI_TRACE_SCOPED_EVENT(VK_PIPELINE_ASYNC_CREATE);
+			job->m_factory->createAsyncPipeline(job->m_state, job->m_hash);
+		}
+
+		// This might release the last reference of the program
+		m_alloc.deleteInstance(job);
+	}
+}
+
+} // end namespace anki
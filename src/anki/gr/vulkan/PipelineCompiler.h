@@ -0,0 +1,65 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/gr/vulkan/Pipeline.h>
+#include <anki/util/Thread.h>
+#include <anki/util/List.h>
+
+namespace anki
+{
+
+/// @addtogroup vulkan
+/// @{
+
+/// Threads that create graphics pipelines in the background. The threads that record command buffers don't have to wait
+/// for the driver to compile the shaders of a new pipeline.
+class PipelineCompiler
+{
+public:
+	PipelineCompiler() = default;
+
+	~PipelineCompiler();
+
+	/// @param threadCount The number of threads. If zero the pipelines are not created in the background.
+	void init(GrAllocator<U8> alloc, U32 threadCount);
+
+	/// Stop the threads. The jobs that didn't run are dropped.
+	void destroy();
+
+	Bool isEnabled() const
+	{
+		return m_threads.getSize() > 0;
+	}
+
+	/// Create the pipeline of some state in the background. The state is copied.
+	/// @note Thread-safe.
+	void submit(PipelineFactory& factory, const PipelineStateTracker& state, U64 hash);
+
+private:
+	class Job : public IntrusiveListEnabled<Job>
+	{
+	public:
+		PipelineFactory* m_factory = nullptr;
+		PipelineStateTracker m_state; ///< It holds a reference to the program so the factory stays alive.
+		U64 m_hash = 0;
+	};
+
+	GrAllocator<U8> m_alloc;
+	DynamicArray<Thread*> m_threads;
+
+	Mutex m_mtx;
+	ConditionVariable m_condVar;
+	IntrusiveList<Job> m_jobs;
+	Bool m_quit = false;
+
+	static ANKI_USE_RESULT Error threadCallback(ThreadCallbackInfo& info);
+
+	void threadWorker();
+};
+/// @}
+
+} // end namespace anki
@@ -0,0 +1,341 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/gr/vulkan/PipelineManifest.h>
+#include <anki/gr/vulkan/GrManagerImpl.h>
+#include <anki/util/ThreadHive.h>
+#include <anki/util/HighRezTimer.h>
+#include <anki/util/Filesystem.h>
+#include <anki/util/File.h>
+
+namespace anki
+{
+
+class PipelineManifest::Header
+{
+public:
+	Array<U8, 8> m_magic;
+	U32 m_entrySize; ///< Guards against changes in the layout of the entries.
+	U32 m_entryCount;
+};
+
+static const Array<U8, 8> MANIFEST_MAGIC = {{'A', 'N', 'K', 'I', 'P', 'P', 'L', '1'}};
+
+PipelineManifest::~PipelineManifest()
+{
+	ANKI_ASSERT(m_programs.isEmpty() && m_entries.isEmpty() && "Forgot to call destroy()");
+}
+
+void PipelineManifest::destroy()
+{
+	m_programs.destroy(m_alloc);
+	m_entries.destroy(m_alloc);
+}
+
+void PipelineManifest::registerProgram(ShaderProgramImpl& prog)
+{
+	// If there are identical programs the last one will be used for the warmup
+	LockGuard<Mutex> lock(m_mtx);
+	m_programs.emplace(m_alloc, prog.getBinaryHash(), &prog);
+}
+
+void PipelineManifest::unregisterProgram(ShaderProgramImpl& prog)
+{
+	LockGuard<Mutex> lock(m_mtx);
+	auto it = m_programs.find(prog.getBinaryHash());
+	if(it != m_programs.getEnd() && *it == &prog)
+	{
+		m_programs.erase(m_alloc, it);
+	}
+}
+
+void PipelineManifest::beginRecording()
+{
+	LockGuard<Mutex> lock(m_mtx);
+	m_recording = true;
+}
+
+Error PipelineManifest::endRecording(CString filename)
+{
+	LockGuard<Mutex> lock(m_mtx);
+	ANKI_ASSERT(m_recording);
+	m_recording = false;
+
+	Header header;
+	header.m_magic = MANIFEST_MAGIC;
+	header.m_entrySize = sizeof(Entry);
+	header.m_entryCount = 0;
+	for(const Entry& entry : m_entries)
+	{
+		(void)entry;
+		++header.m_entryCount;
+	}
+
+	File file;
+	ANKI_CHECK(file.open(filename, FileOpenFlag::BINARY | FileOpenFlag::WRITE));
+	ANKI_CHECK(file.write(&header, sizeof(header)));
+	for(const Entry& entry : m_entries)
+	{
+		ANKI_CHECK(file.write(&entry, sizeof(entry)));
+	}
+
+	ANKI_VK_LOGI("Stored %u pipelines to the manifest: %s", header.m_entryCount, filename.cstr());
+	m_entries.destroy(m_alloc);
+
+	return Error::NONE;
+}
+
+void PipelineManifest::recordPipeline(const PipelineStateTracker& state)
+{
+	// The warmup can't recreate the shading rate attachment, skip those
+	if(state.m_fbShadingRate)
+	{
+		return;
+	}
+
+	LockGuard<Mutex> lock(m_mtx);
+	if(!m_recording)
+	{
+		return;
+	}
+
+	Entry entry;
+	entry.m_programHash = static_cast<const ShaderProgramImpl&>(*state.m_state.m_prog).getBinaryHash();
+
+	memcpy(&entry.m_vertex, &state.m_state.m_vertex, sizeof(entry.m_vertex));
+	memcpy(&entry.m_inputAssembler, &state.m_state.m_inputAssembler, sizeof(entry.m_inputAssembler));
+	memcpy(&entry.m_tessellation, &state.m_state.m_tessellation, sizeof(entry.m_tessellation));
+	memcpy(&entry.m_viewport, &state.m_state.m_viewport, sizeof(entry.m_viewport));
+	memcpy(&entry.m_rasterizer, &state.m_state.m_rasterizer, sizeof(entry.m_rasterizer));
+	memcpy(&entry.m_depth, &state.m_state.m_depth, sizeof(entry.m_depth));
+	memcpy(&entry.m_stencil, &state.m_state.m_stencil, sizeof(entry.m_stencil));
+	memcpy(&entry.m_color, &state.m_state.m_color, sizeof(entry.m_color));
+
+	static_cast<const FramebufferImpl&>(*state.m_fb)
+		.getAttachmentFormats(entry.m_colorFormats, entry.m_depthStencilFormat);
+	entry.m_colorAttachmentMask = state.m_fbColorAttachmentMask;
+	entry.m_depthAttachment = state.m_fbDepth;
+	entry.m_stencilAttachment = state.m_fbStencil;
+	entry.m_defaultFb = state.m_defaultFb;
+
+	recordEntry(entry);
+}
+
+void PipelineManifest::recordEntry(const Entry& entry)
+{
+	const U64 hash = computeHash(&entry, sizeof(entry));
+	if(m_entries.find(hash) == m_entries.getEnd())
+	{
+		m_entries.emplace(m_alloc, hash, entry);
+	}
+}
+
+void PipelineManifest::loadState(const Entry& entry, PipelineStateTracker& state)
+{
+	memcpy(&state.m_state.m_vertex, &entry.m_vertex, sizeof(entry.m_vertex));
+	memcpy(&state.m_state.m_inputAssembler, &entry.m_inputAssembler, sizeof(entry.m_inputAssembler));
+	memcpy(&state.m_state.m_tessellation, &entry.m_tessellation, sizeof(entry.m_tessellation));
+	memcpy(&state.m_state.m_viewport, &entry.m_viewport, sizeof(entry.m_viewport));
+	memcpy(&state.m_state.m_rasterizer, &entry.m_rasterizer, sizeof(entry.m_rasterizer));
+	memcpy(&state.m_state.m_depth, &entry.m_depth, sizeof(entry.m_depth));
+	memcpy(&state.m_state.m_stencil, &entry.m_stencil, sizeof(entry.m_stencil));
+	memcpy(&state.m_state.m_color, &entry.m_color, sizeof(entry.m_color));
+
+	// The attributes the shader uses were set when the entry was recorded
+	state.m_set.m_attribs.setAll();
+	state.m_set.m_vertBindings.setAll();
+}
+
+Error PipelineManifest::newCompatibleRenderPass(const Entry& entry, VkRenderPass& rpass) const
+{
+	// Only the formats and the sample counts matter for the compatibility
+	Array<VkAttachmentDescription, MAX_COLOR_ATTACHMENTS + 1> attachments = {};
+	Array<VkAttachmentReference, MAX_COLOR_ATTACHMENTS + 1> references = {};
+	const U32 colorAttachmentCount = entry.m_colorAttachmentMask.getEnabledBitCount();
+	for(U32 i = 0; i < colorAttachmentCount; ++i)
+	{
+		attachments[i].format = entry.m_colorFormats[i];
+		attachments[i].samples = VK_SAMPLE_COUNT_1_BIT;
+		attachments[i].loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		attachments[i].storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		attachments[i].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		attachments[i].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		attachments[i].initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		attachments[i].finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+		references[i].attachment = i;
+		references[i].layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+	}
+
+	const Bool hasDepthStencil = entry.m_depthStencilFormat != VK_FORMAT_UNDEFINED;
+	if(hasDepthStencil)
+	{
+		VkAttachmentDescription& att = attachments[colorAttachmentCount];
+		att.format = entry.m_depthStencilFormat;
+		att.samples = VK_SAMPLE_COUNT_1_BIT;
+		att.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		att.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		att.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		att.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		att.initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+		att.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+		references[colorAttachmentCount].attachment = colorAttachmentCount;
+		references[colorAttachmentCount].layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+	}
+
+	VkSubpassDescription subpass = {};
+	subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+	subpass.colorAttachmentCount = colorAttachmentCount;
+	subpass.pColorAttachments = (colorAttachmentCount) ? &references[0] : nullptr;
+	subpass.pDepthStencilAttachment = (hasDepthStencil) ? &references[colorAttachmentCount] : nullptr;
+
+	VkRenderPassCreateInfo ci = {};
+	ci.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+	ci.attachmentCount = colorAttachmentCount + ((hasDepthStencil) ? 1 : 0);
+	ci.pAttachments = &attachments[0];
+	ci.subpassCount = 1;
+	ci.pSubpasses = &subpass;
+
+	ANKI_VK_CHECK(vkCreateRenderPass(m_dev, &ci, nullptr, &rpass));
+
+	return Error::NONE;
+}
+
+Error PipelineManifest::warmup(CString filename, ThreadHive& hive)
+{
+	if(!fileExists(filename))
+	{
+		ANKI_VK_LOGI("Pipeline manifest not found, will skip the warmup: %s", filename.cstr());
+		return Error::NONE;
+	}
+
+	const Second startTime = HighRezTimer::getCurrentTime();
+
+	// Read the manifest
+	File file;
+	ANKI_CHECK(file.open(filename, FileOpenFlag::BINARY | FileOpenFlag::READ));
+
+	Header header;
+	ANKI_CHECK(file.read(&header, sizeof(header)));
+	if(memcmp(&header.m_magic[0], &MANIFEST_MAGIC[0], sizeof(MANIFEST_MAGIC)) != 0
+		|| header.m_entrySize != sizeof(Entry))
+	{
+		ANKI_VK_LOGI("Pipeline manifest is not compatible, will skip the warmup: %s", filename.cstr());
+		return Error::NONE;
+	}
+
+	DynamicArrayAuto<Entry> entries(m_alloc);
+	if(header.m_entryCount > 0)
+	{
+		entries.create(header.m_entryCount);
+		ANKI_CHECK(file.read(&entries[0], sizeof(Entry) * header.m_entryCount));
+	}
+
+	// Gather the entries of the live programs and create the renderpasses
+	class Job
+	{
+	public:
+		const Entry* m_entry;
+		ShaderProgramImpl* m_prog;
+		VkRenderPass m_rpass;
+	};
+
+	DynamicArrayAuto<Job> jobs(m_alloc);
+	HashMapAuto<U64, VkRenderPass> rpasses(m_alloc);
+	Error err = Error::NONE;
+	{
+		LockGuard<Mutex> lock(m_mtx);
+
+		for(const Entry& entry : entries)
+		{
+			// Keep the entries of the manifest in the next one
+			if(m_recording)
+			{
+				recordEntry(entry);
+			}
+
+			auto progIt = m_programs.find(entry.m_programHash);
+			if(progIt == m_programs.getEnd())
+			{
+				continue;
+			}
+
+			Array<VkFormat, MAX_COLOR_ATTACHMENTS + 1> formats = {};
+			for(U32 i = 0; i < entry.m_colorAttachmentMask.getEnabledBitCount(); ++i)
+			{
+				formats[i] = entry.m_colorFormats[i];
+			}
+			formats[MAX_COLOR_ATTACHMENTS] = entry.m_depthStencilFormat;
+			const U64 rpassHash = computeHash(&formats[0], sizeof(formats));
+
+			VkRenderPass rpass;
+			auto rpassIt = rpasses.find(rpassHash);
+			if(rpassIt != rpasses.getEnd())
+			{
+				rpass = *rpassIt;
+			}
+			else
+			{
+				err = newCompatibleRenderPass(entry, rpass);
+				if(err)
+				{
+					break;
+				}
+
+				rpasses.emplace(rpassHash, rpass);
+			}
+
+			Job& job = *jobs.emplaceBack();
+			job.m_entry = &entry;
+			job.m_prog = *progIt;
+			job.m_rpass = rpass;
+		}
+	}
+
+	// Create the pipelines
+	if(!err)
+	{
+		hive.parallelFor(jobs.getSize(), 1, [&](U32 begin, U32 end, U32 threadId) {
+			PipelineStateTracker state;
+			for(U32 i = begin; i < end; ++i)
+			{
+				const Job& job = jobs[i];
+				const Entry& entry = *job.m_entry;
+
+				state.reset();
+				loadState(entry, state);
+				state.bindShaderProgram(ShaderProgramPtr(job.m_prog));
+				state.beginRenderPass(job.m_rpass,
+					entry.m_colorAttachmentMask,
+					entry.m_depthAttachment,
+					entry.m_stencilAttachment,
+					entry.m_defaultFb);
+
+				job.m_prog->getPipelineFactory().warmupPipeline(state);
+
+				state.endRenderPass();
+			}
+		});
+	}
+
+	// The pipelines don't need the renderpasses after their creation
+	for(VkRenderPass rpass : rpasses)
+	{
+		vkDestroyRenderPass(m_dev, rpass, nullptr);
+	}
+
+	if(!err)
+	{
+		ANKI_VK_LOGI("Warmed up %u pipelines out of %u in %f sec",
+			jobs.getSize(),
+			header.m_entryCount,
+			HighRezTimer::getCurrentTime() - startTime);
+	}
+
+	return err;
+}
+
+} // end namespace anki
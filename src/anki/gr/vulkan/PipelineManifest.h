@@ -0,0 +1,120 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/gr/vulkan/Pipeline.h>
+#include <anki/util/HashMap.h>
+
+namespace anki
+{
+
+// Forward
+class ThreadHive;
+
+/// @addtogroup vulkan
+/// @{
+
+/// A list of the graphics pipelines that got created. It's stored to a file and the next time the same content is
+/// loaded the pipelines of the list are created ahead of time. This avoids the hitches of the first use of some
+/// material/state combination.
+class PipelineManifest
+{
+public:
+	PipelineManifest() = default;
+
+	~PipelineManifest();
+
+	void init(GrAllocator<U8> alloc, VkDevice dev)
+	{
+		m_alloc = alloc;
+		m_dev = dev;
+	}
+
+	void destroy();
+
+	/// Make a graphics program visible to the warmup.
+	/// @note Thread-safe.
+	void registerProgram(ShaderProgramImpl& prog);
+
+	/// @note Thread-safe.
+	void unregisterProgram(ShaderProgramImpl& prog);
+
+	void beginRecording();
+
+	/// Stop recording and store the recorded pipelines to a file.
+	ANKI_USE_RESULT Error endRecording(CString filename);
+
+	/// Record the state of a pipeline that got created. It does nothing if not recording.
+	/// @note Thread-safe.
+	void recordPipeline(const PipelineStateTracker& state);
+
+	/// Create the pipelines of a manifest file using the threads of the hive. Only the pipelines of the registered
+	/// programs are created. The programs should stay alive while it runs.
+	ANKI_USE_RESULT Error warmup(CString filename, ThreadHive& hive);
+
+private:
+	class Header;
+
+	/// The static state of a pipeline and the attachments it was used with. It's stored to the file as is so keep it
+	/// plain.
+	class Entry
+	{
+	public:
+		U64 m_programHash; ///< ShaderProgramImpl::getBinaryHash()
+
+		PPVertexStateInfo m_vertex;
+		PPInputAssemblerStateInfo m_inputAssembler;
+		PPTessellationStateInfo m_tessellation;
+		PPViewportStateInfo m_viewport;
+		PPRasterizerStateInfo m_rasterizer;
+		PPDepthStateInfo m_depth;
+		PPStencilStateInfo m_stencil;
+		PPColorStateInfo m_color;
+
+		Array<VkFormat, MAX_COLOR_ATTACHMENTS> m_colorFormats;
+		VkFormat m_depthStencilFormat;
+		BitSet<MAX_COLOR_ATTACHMENTS, U8> m_colorAttachmentMask;
+		Bool m_depthAttachment;
+		Bool m_stencilAttachment;
+		Bool m_defaultFb;
+
+		/// Zero the padding because the entries are hashed.
+		Entry()
+		{
+			zeroMemory(*this);
+		}
+
+		Entry(const Entry& b)
+		{
+			*this = b;
+		}
+
+		Entry& operator=(const Entry& b)
+		{
+			memcpy(this, &b, sizeof(*this));
+			return *this;
+		}
+	};
+
+	GrAllocator<U8> m_alloc;
+	VkDevice m_dev = VK_NULL_HANDLE;
+
+	HashMap<U64, ShaderProgramImpl*> m_programs; ///< The live programs indexed by their binary hash.
+	HashMap<U64, Entry> m_entries; ///< The recorded entries indexed by their hash.
+	Bool m_recording = false;
+	Mutex m_mtx;
+
+	/// It should be called with m_mtx locked.
+	void recordEntry(const Entry& entry);
+
+	static void loadState(const Entry& entry, PipelineStateTracker& state);
+
+	/// Create a renderpass that is compatible with the renderpasses the pipeline of an entry was used with.
+	ANKI_USE_RESULT Error newCompatibleRenderPass(const Entry& entry, VkRenderPass& rpass) const;
+};
+/// @}
+
+} // end namespace anki
@@ -4,76 +4,91 @@
 // http://www.anki3d.org/LICENSE
 
 #include <anki/gr/vulkan/QueryFactory.h>
+#include <anki/util/Tracer.h>
 
 namespace anki
 {
 
 QueryFactory::~QueryFactory()
 {
-	if(!m_chunks.isEmpty())
+	ANKI_ASSERT(m_chunks.load() == nullptr && "Forgot to call destroy()");
+}
+
+void QueryFactory::destroy()
+{
+	Chunk* chunk = m_chunks.exchange(nullptr);
+	while(chunk)
 	{
-		ANKI_VK_LOGW("Forgot the delete some queries");
+		if(chunk->m_allocatedMask.load() != 0)
+		{
+			ANKI_VK_LOGW("Forgot the delete some queries");
+		}
+
+		Chunk* next = chunk->m_next;
+		vkDestroyQueryPool(m_dev, chunk->m_pool, nullptr);
+		m_alloc.deleteInstance(chunk);
+		chunk = next;
 	}
 }
 
+Bool QueryFactory::tryAllocate(Chunk& chunk, MicroQuery& handle)
+{
+	U64 mask = chunk.m_allocatedMask.load();
+	while(mask != MAX_U64)
+	{
+		const U32 idx = U32(__builtin_ctzll(~mask));
+		if(chunk.m_allocatedMask.compareExchange(mask, mask | (U64(1) << idx)))
+		{
+			handle.m_pool = chunk.m_pool;
+			handle.m_queryIndex = idx;
+			handle.m_chunk = &chunk;
+			return true;
+		}
+
+		// Someone else got a query of the chunk, compareExchange() reloaded the mask
+	}
+
+	return false;
+}
+
 Error QueryFactory::newQuery(MicroQuery& handle)
 {
 	ANKI_ASSERT(!handle);
 
-	LockGuard<Mutex> lock(m_mtx);
-
-	// Find a not-full chunk
-	Chunk* chunk = nullptr;
-	for(Chunk& c : m_chunks)
+	// Try the existing chunks
+	for(Chunk* chunk = m_chunks.load(AtomicMemoryOrder::ACQUIRE); chunk; chunk = chunk->m_next)
 	{
-		if(c.m_subAllocationCount < MAX_SUB_ALLOCATIONS_PER_QUERY_CHUNK)
+		if(tryAllocate(*chunk, handle))
 		{
-			// Found one
-
-			if(chunk == nullptr)
-			{
-				chunk = &c;
-			}
-			else if(c.m_subAllocationCount > chunk->m_subAllocationCount)
-			{
-				// To decrease fragmentation use the most full chunk
-				chunk = &c;
-			}
+			return Error::NONE;
 		}
 	}
 
-	if(chunk == nullptr)
-	{
-		// Create new chunk
-		chunk = m_alloc.newInstance<Chunk>();
+	// All are full, create new chunk. Another thread might have created one in the meantime but it's harmless
+	Chunk* chunk = m_alloc.newInstance<Chunk>();
 
-		VkQueryPoolCreateInfo ci = {};
-		ci.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
-		ci.queryType = m_poolType;
-		ci.queryCount = MAX_SUB_ALLOCATIONS_PER_QUERY_CHUNK;
+	VkQueryPoolCreateInfo ci = {};
+	ci.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	ci.queryType = m_poolType;
+	ci.queryCount = MAX_SUB_ALLOCATIONS_PER_QUERY_CHUNK;
 
-		ANKI_VK_CHECK(vkCreateQueryPool(m_dev, &ci, nullptr, &chunk->m_pool));
-		m_chunks.pushBack(chunk);
+	const VkResult res = vkCreateQueryPool(m_dev, &ci, nullptr, &chunk->m_pool);
+	if(res != VK_SUCCESS)
+	{
+		m_alloc.deleteInstance(chunk);
+		ANKI_VK_CHECK(res);
 	}
 
-	ANKI_ASSERT(chunk);
+	const Bool allocated = tryAllocate(*chunk, handle);
+	ANKI_ASSERT(allocated);
+	(void)allocated;
 
-	// Allocate from chunk
-	for(U32 i = 0; i < MAX_SUB_ALLOCATIONS_PER_QUERY_CHUNK; ++i)
 	{
-		if(chunk->m_allocatedMask.get(i) == 0)
-		{
-			chunk->m_allocatedMask.set(i);
-			++chunk->m_subAllocationCount;
-
-			handle.m_pool = chunk->m_pool;
-			handle.m_queryIndex = i;
-			handle.m_chunk = chunk;
-			break;
-		}
+		LockGuard<Mutex> lock(m_newChunkMtx);
+		chunk->m_next = m_chunks.load();
+		m_chunks.store(chunk, AtomicMemoryOrder::RELEASE);
 	}
 
-	ANKI_ASSERT(handle == true);
 	return Error::NONE;
 }
 
@@ -81,29 +96,59 @@ void QueryFactory::deleteQuery(MicroQuery& handle)
 {
 	ANKI_ASSERT(handle.m_pool && handle.m_queryIndex != MAX_U32 && handle.m_chunk);
 
-	LockGuard<Mutex> lock(m_mtx);
+	const U64 bit = U64(1) << handle.m_queryIndex;
+	const U64 prevMask = handle.m_chunk->m_allocatedMask.fetchAnd(~bit);
+	ANKI_ASSERT((prevMask & bit) && "Deleting a query twice");
+	(void)prevMask;
 
-	Chunk* chunk = handle.m_chunk;
-	ANKI_ASSERT(chunk->m_subAllocationCount > 0);
-	--chunk->m_subAllocationCount;
+	handle = {};
+}
+
+void QueryFactory::readResults(Chunk& chunk, U64 frame) const
+{
+	ANKI_TRACE_SCOPED_EVENT(VK_QUERY_RESULTS_READ);
 
-	if(chunk->m_subAllocationCount == 0)
+	// Read the runs of the allocated queries. The rest haven't been used
+	U64 mask = chunk.m_allocatedMask.load();
+	while(mask)
 	{
-		// Delete the chunk
+		const U32 first = U32(__builtin_ctzll(mask));
+		const U64 run = ~mask >> first;
+		const U32 count = (run) ? U32(__builtin_ctzll(run)) : MAX_SUB_ALLOCATIONS_PER_QUERY_CHUNK - first;
+
+		const VkResult res = vkGetQueryPoolResults(m_dev,
+			chunk.m_pool,
+			first,
+			count,
+			count * sizeof(U64) * 2,
+			&chunk.m_results[first * 2],
+			sizeof(U64) * 2,
+			VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+		ANKI_ASSERT(res == VK_SUCCESS || res == VK_NOT_READY);
+		(void)res;
+
+		mask = (first + count < 64) ? (mask & ~((U64(1) << (first + count)) - 1)) : 0;
+	}
 
-		ANKI_ASSERT(chunk->m_allocatedMask.getAny());
-		vkDestroyQueryPool(m_dev, chunk->m_pool, nullptr);
+	chunk.m_resultsFrame = frame;
+}
 
-		m_chunks.erase(chunk);
-		m_alloc.deleteInstance(chunk);
-	}
-	else
+Bool QueryFactory::getResult(const MicroQuery& handle, U64& result) const
+{
+	ANKI_ASSERT(handle);
+	Chunk& chunk = *handle.m_chunk;
+	const U64 frame = m_frame.load();
+
+	LockGuard<SpinLock> lock(chunk.m_resultsMtx);
+
+	if(chunk.m_resultsFrame != frame)
 	{
-		ANKI_ASSERT(chunk->m_allocatedMask.get(handle.m_queryIndex));
-		chunk->m_allocatedMask.unset(handle.m_queryIndex);
+		readResults(chunk, frame);
 	}
 
-	handle = {};
+	const U32 idx = handle.m_queryIndex;
+	result = chunk.m_results[idx * 2];
+	return chunk.m_results[idx * 2 + 1] != 0;
 }
 
 } // end namespace anki
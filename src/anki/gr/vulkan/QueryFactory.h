@@ -6,8 +6,8 @@
 #pragma once
 
 #include <anki/gr/vulkan/Common.h>
-#include <anki/util/BitSet.h>
-#include <anki/util/List.h>
+#include <anki/util/Atomic.h>
+#include <anki/util/Thread.h>
 
 namespace anki
 {
@@ -50,18 +50,25 @@ private:
 	QueryFactoryChunk* m_chunk = nullptr;
 };
 
-/// An allocation chunk.
-class QueryFactoryChunk : public IntrusiveListEnabled<QueryFactoryChunk>
+/// An allocation chunk. It's never deleted before the factory so it can be walked without locking.
+class QueryFactoryChunk
 {
 	friend class QueryFactory;
 
 private:
 	VkQueryPool m_pool = VK_NULL_HANDLE;
-	BitSet<MAX_SUB_ALLOCATIONS_PER_QUERY_CHUNK> m_allocatedMask = {false};
-	U32 m_subAllocationCount = 0;
+	QueryFactoryChunk* m_next = nullptr;
+	Atomic<U64> m_allocatedMask = {0};
+	static_assert(MAX_SUB_ALLOCATIONS_PER_QUERY_CHUNK == 64, "The mask should be able to hold the chunk");
+
+	/// The results of all the queries of the pool. Every query gets the value and the availability.
+	Array<U64, MAX_SUB_ALLOCATIONS_PER_QUERY_CHUNK * 2> m_results = {};
+	U64 m_resultsFrame = MAX_U64; ///< The frame the m_results got read.
+	SpinLock m_resultsMtx;
 };
 
-/// Batch allocator of queries.
+/// Batch allocator of queries. The allocation is lock-free. The results of the queries of a chunk are read all
+/// together once per frame.
 class QueryFactory : public NonCopyable
 {
 public:
@@ -78,20 +85,39 @@ public:
 		m_poolType = poolType;
 	}
 
+	void destroy();
+
 	/// @note It's thread-safe.
 	ANKI_USE_RESULT Error newQuery(MicroQuery& handle);
 
 	/// @note It's thread-safe.
 	void deleteQuery(MicroQuery& handle);
 
+	/// Get the result of a query. The results are cached so the ones that became available after the first call of
+	/// the frame for the same chunk will be seen in the next frame.
+	/// @return True if the result is available.
+	/// @note It's thread-safe.
+	Bool getResult(const MicroQuery& handle, U64& result) const;
+
+	/// Start a new frame. The next getResult() calls will read the results again.
+	void endFrame()
+	{
+		m_frame.fetchAdd(1);
+	}
+
 private:
 	using Chunk = QueryFactoryChunk;
 
 	GrAllocator<U8> m_alloc;
 	VkDevice m_dev;
-	IntrusiveList<Chunk> m_chunks;
-	Mutex m_mtx;
+	Atomic<Chunk*> m_chunks = {nullptr}; ///< The head of a list of chunks. New chunks are pushed in the front.
+	Mutex m_newChunkMtx;
 	VkQueryType m_poolType = VK_QUERY_TYPE_MAX_ENUM;
+	Atomic<U64> m_frame = {0};
+
+	static Bool tryAllocate(Chunk& chunk, MicroQuery& handle);
+
+	void readResults(Chunk& chunk, U64 frame) const;
 };
 /// @}
 
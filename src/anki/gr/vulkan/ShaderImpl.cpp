@@ -118,6 +118,12 @@ Error ShaderImpl::init(const ShaderInitInfo& inf)
 		}
 	}
 
+	m_binaryHash = computeHash(&inf.m_binary[0], inf.m_binary.getSize());
+	if(m_specConstInfo.dataSize)
+	{
+		m_binaryHash = appendHash(m_specConstInfo.pData, m_specConstInfo.dataSize, m_binaryHash);
+	}
+
 	return Error::NONE;
 }
 
@@ -147,7 +153,7 @@ void ShaderImpl::doReflection(ConstWeakArray<U8> spirv, SpecConstsVector& specCo
 			{
 				ANKI_ASSERT(typeInfo.array.size() == 1 && "Only 1D arrays are supported");
 				arraySize = typeInfo.array[0];
-				ANKI_ASSERT(arraySize > 0 && (arraySize - 1) <= MAX_U8);
+				ANKI_ASSERT(arraySize > 0 && (arraySize - 1) <= MAX_U16);
 			}
 
 			m_descriptorSetMask.set(set);
@@ -171,7 +177,7 @@ void ShaderImpl::doReflection(ConstWeakArray<U8> spirv, SpecConstsVector& specCo
 				descriptor.m_binding = U8(binding);
 				descriptor.m_type = type;
 				descriptor.m_stageMask = static_cast<ShaderTypeBit>(1 << m_shaderType);
-				descriptor.m_arraySizeMinusOne = U8(arraySize - 1);
+				descriptor.m_arraySizeMinusOne = U16(arraySize - 1);
 			}
 			else
 			{
@@ -28,6 +28,7 @@ public:
 	BitSet<MAX_DESCRIPTOR_SETS, U8> m_descriptorSetMask = {false};
 	Array<BitSet<MAX_BINDINGS_PER_DESCRIPTOR_SET, U8>, MAX_DESCRIPTOR_SETS> m_activeBindingMask = {{{false}, {false}}};
 	U32 m_pushConstantsSize = 0;
+	U64 m_binaryHash = 0; ///< Hash of the SPIR-V and the values of the spec constants. It's the same across runs.
 
 	ShaderImpl(GrManager* manager, CString name)
 		: Shader(manager, name)
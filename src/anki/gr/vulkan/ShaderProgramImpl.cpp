@@ -16,6 +16,7 @@ ShaderProgramImpl::~ShaderProgramImpl()
 {
 	if(m_pplineFactory)
 	{
+		getGrManagerImpl().getPipelineManifest().unregisterProgram(*this);
 		m_pplineFactory->destroy();
 		getAllocator().deleteInstance(m_pplineFactory);
 	}
@@ -97,13 +98,28 @@ Error ShaderProgramImpl::init(const ShaderProgramInitInfo& inf)
 
 	// Create the descriptor set layouts
 	//
+	DescriptorSetFactory& dsetFactory = getGrManagerImpl().getDescriptorSetFactory();
+	Bool pushDescriptorSetFound = false;
 	for(U32 set = 0; set < descriptorSetCount; ++set)
 	{
 		DescriptorSetLayoutInitInfo inf;
 		inf.m_bindings = WeakArray<DescriptorBinding>((counts[set]) ? &bindings[set][0] : nullptr, counts[set]);
 
-		ANKI_CHECK(
-			getGrManagerImpl().getDescriptorSetFactory().newDescriptorSetLayout(inf, m_descriptorSetLayouts[set]));
+		// Only one set can have push descriptors, use it for the first one that fits
+		U32 descriptorCount = 0;
+		for(const DescriptorBinding& binding : inf.m_bindings)
+		{
+			descriptorCount += binding.m_arraySizeMinusOne + 1;
+		}
+
+		if(!pushDescriptorSetFound && descriptorCount > 0
+			&& descriptorCount <= dsetFactory.getMaxPushDescriptorCount())
+		{
+			inf.m_pushDescriptors = true;
+			pushDescriptorSetFound = true;
+		}
+
+		ANKI_CHECK(dsetFactory.newDescriptorSetLayout(inf, m_descriptorSetLayouts[set]));
 
 		// Even if the dslayout is empty we will have to list it because we'll have to bind a DS for it.
 		m_refl.m_descriptorSetMask.set(set);
@@ -118,10 +134,16 @@ Error ShaderProgramImpl::init(const ShaderProgramInitInfo& inf)
 
 	// Get some masks
 	//
-	const Bool graphicsProg = !!(m_stages & ShaderTypeBit::VERTEX);
+	const Bool graphicsProg = !!(m_stages & (ShaderTypeBit::VERTEX | ShaderTypeBit::MESH));
 	if(graphicsProg)
 	{
-		m_refl.m_attributeMask = static_cast<const ShaderImpl*>(m_shaders[ShaderType::VERTEX].get())->m_attributeMask;
+		// The mesh shaders fetch the vertices on their own
+		if(m_shaders[ShaderType::VERTEX].isCreated())
+		{
+			m_refl.m_attributeMask =
+				static_cast<const ShaderImpl*>(m_shaders[ShaderType::VERTEX].get())->m_attributeMask;
+		}
+
 		m_refl.m_colorAttachmentWritemask =
 			static_cast<const ShaderImpl*>(m_shaders[ShaderType::FRAGMENT].get())->m_colorAttachmentWritemask;
 
@@ -136,9 +158,9 @@ Error ShaderProgramImpl::init(const ShaderProgramInitInfo& inf)
 	//
 	if(graphicsProg)
 	{
-		for(ShaderType stype = ShaderType::VERTEX; stype <= ShaderType::FRAGMENT; ++stype)
+		for(ShaderType stype = ShaderType::FIRST; stype < ShaderType::COUNT; ++stype)
 		{
-			if(!m_shaders[stype].isCreated())
+			if(!m_shaders[stype].isCreated() || stype == ShaderType::COMPUTE)
 			{
 				continue;
 			}
@@ -152,6 +174,8 @@ Error ShaderProgramImpl::init(const ShaderProgramInitInfo& inf)
 			inf.pName = "main";
 			inf.module = shaderImpl.m_handle;
 			inf.pSpecializationInfo = shaderImpl.getSpecConstInfo();
+
+			m_binaryHash = appendHash(&shaderImpl.m_binaryHash, sizeof(shaderImpl.m_binaryHash), m_binaryHash);
 		}
 	}
 
@@ -162,6 +186,9 @@ Error ShaderProgramImpl::init(const ShaderProgramInitInfo& inf)
 		m_pplineFactory = getAllocator().newInstance<PipelineFactory>();
 		m_pplineFactory->init(
 			getGrManagerImpl().getAllocator(), getGrManagerImpl().getDevice(), getGrManagerImpl().getPipelineCache());
+
+		// Make it visible to the pipeline warmup
+		getGrManagerImpl().getPipelineManifest().registerProgram(*this);
 	}
 
 	// Create the pipeline if compute
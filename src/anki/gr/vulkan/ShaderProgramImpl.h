@@ -88,6 +88,13 @@ public:
 		return m_stages;
 	}
 
+	/// A hash of the shader binaries that is the same across runs. Only for graphics programs.
+	U64 getBinaryHash() const
+	{
+		ANKI_ASSERT(m_binaryHash);
+		return m_binaryHash;
+	}
+
 private:
 	Array<ShaderPtr, U(ShaderType::COUNT)> m_shaders;
 	ShaderTypeBit m_stages = ShaderTypeBit::NONE;
@@ -101,6 +108,7 @@ private:
 	ShaderProgramReflectionInfo m_refl;
 
 	PipelineFactory* m_pplineFactory = nullptr; ///< Only for graphics programs.
+	U64 m_binaryHash = 0; ///< Only for graphics programs.
 
 	VkPipeline m_computePpline = VK_NULL_HANDLE;
 };
@@ -88,51 +88,67 @@ Error MicroSwapchain::initInternal()
 
 	// Chose present mode
 	VkPresentModeKHR presentMode = VK_PRESENT_MODE_MAX_ENUM_KHR;
-	VkPresentModeKHR presentModeSecondChoice = VK_PRESENT_MODE_MAX_ENUM_KHR;
 	{
 		uint32_t presentModeCount;
-		vkGetPhysicalDeviceSurfacePresentModesKHR(
-			m_factory->m_gr->getPhysicalDevice(), m_factory->m_gr->getSurface(), &presentModeCount, nullptr);
-		presentModeCount = min(presentModeCount, 4u);
-		Array<VkPresentModeKHR, 4> presentModes;
-		vkGetPhysicalDeviceSurfacePresentModesKHR(
-			m_factory->m_gr->getPhysicalDevice(), m_factory->m_gr->getSurface(), &presentModeCount, &presentModes[0]);
-
-		if(m_factory->m_vsync)
+		ANKI_VK_CHECK(vkGetPhysicalDeviceSurfacePresentModesKHR(
+			m_factory->m_gr->getPhysicalDevice(), m_factory->m_gr->getSurface(), &presentModeCount, nullptr));
+		DynamicArrayAuto<VkPresentModeKHR> presentModes(getAllocator());
+		presentModes.create(presentModeCount);
+		ANKI_VK_CHECK(vkGetPhysicalDeviceSurfacePresentModesKHR(
+			m_factory->m_gr->getPhysicalDevice(), m_factory->m_gr->getSurface(), &presentModeCount, &presentModes[0]));
+
+		// The modes to try in order. FIFO is the last resort because it's always supported
+		Array<VkPresentModeKHR, 3> candidates;
+		U32 candidateCount = 0;
+		const Bool vsync = m_factory->m_vsync;
+		switch(m_factory->m_presentMode)
 		{
-			for(U i = 0; i < presentModeCount; ++i)
+		case SwapchainPresentMode::AUTO:
+			candidates[candidateCount++] = (vsync) ? VK_PRESENT_MODE_FIFO_RELAXED_KHR : VK_PRESENT_MODE_IMMEDIATE_KHR;
+			if(!vsync)
 			{
-				if(presentModes[i] == VK_PRESENT_MODE_FIFO_RELAXED_KHR)
-				{
-					presentMode = presentModes[i];
-				}
-				else if(presentModes[i] == VK_PRESENT_MODE_FIFO_KHR)
-				{
-					presentModeSecondChoice = presentModes[i];
-				}
+				candidates[candidateCount++] = VK_PRESENT_MODE_MAILBOX_KHR;
 			}
+			break;
+		case SwapchainPresentMode::FIFO:
+			break;
+		case SwapchainPresentMode::FIFO_RELAXED:
+			candidates[candidateCount++] = VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+			break;
+		case SwapchainPresentMode::MAILBOX:
+			candidates[candidateCount++] = VK_PRESENT_MODE_MAILBOX_KHR;
+			break;
+		case SwapchainPresentMode::IMMEDIATE:
+			candidates[candidateCount++] = VK_PRESENT_MODE_IMMEDIATE_KHR;
+			candidates[candidateCount++] = VK_PRESENT_MODE_MAILBOX_KHR;
+			break;
+		default:
+			ANKI_ASSERT(0);
 		}
-		else
+		candidates[candidateCount++] = VK_PRESENT_MODE_FIFO_KHR;
+
+		for(U32 i = 0; i < candidateCount && presentMode == VK_PRESENT_MODE_MAX_ENUM_KHR; ++i)
 		{
-			for(U i = 0; i < presentModeCount; ++i)
+			for(VkPresentModeKHR mode : presentModes)
 			{
-				if(presentModes[i] == VK_PRESENT_MODE_IMMEDIATE_KHR)
+				if(mode == candidates[i])
 				{
-					presentMode = presentModes[i];
-				}
-				else if(presentModes[i] == VK_PRESENT_MODE_MAILBOX_KHR)
-				{
-					presentModeSecondChoice = presentModes[i];
+					presentMode = mode;
+					break;
 				}
 			}
 		}
 
-		presentMode = (presentMode != VK_PRESENT_MODE_MAX_ENUM_KHR) ? presentMode : presentModeSecondChoice;
 		if(presentMode == VK_PRESENT_MODE_MAX_ENUM_KHR)
 		{
 			ANKI_VK_LOGE("Couldn't find a present mode");
 			return Error::FUNCTION_FAILED;
 		}
+
+		if(presentMode != candidates[0])
+		{
+			ANKI_VK_LOGW("The requested present mode is not supported. Will use %u", U32(presentMode));
+		}
 	}
 
 	// Create swapchain
@@ -217,11 +233,13 @@ MicroSwapchainPtr SwapchainFactory::newInstance()
 	return MicroSwapchainPtr(out);
 }
 
-void SwapchainFactory::init(GrManagerImpl* manager, Bool vsync)
+void SwapchainFactory::init(GrManagerImpl* manager, Bool vsync, SwapchainPresentMode presentMode)
 {
 	ANKI_ASSERT(manager);
+	ANKI_ASSERT(presentMode < SwapchainPresentMode::COUNT);
 	m_gr = manager;
 	m_vsync = vsync;
+	m_presentMode = presentMode;
 	m_recycler.init(m_gr->getAllocator());
 }
 
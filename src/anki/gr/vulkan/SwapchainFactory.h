@@ -84,6 +84,18 @@ public:
 /// MicroSwapchain smart pointer.
 using MicroSwapchainPtr = IntrusivePtr<MicroSwapchain, MicroSwapchainPtrDeleter>;
 
+/// The present mode of the swapchain. See the gr_presentMode config option.
+enum class SwapchainPresentMode : U8
+{
+	AUTO, ///< FIFO relaxed or FIFO with vsync, immediate or mailbox without.
+	FIFO,
+	FIFO_RELAXED,
+	MAILBOX,
+	IMMEDIATE,
+
+	COUNT
+};
+
 /// Swapchain factory.
 class SwapchainFactory
 {
@@ -91,7 +103,7 @@ class SwapchainFactory
 	friend class MicroSwapchain;
 
 public:
-	void init(GrManagerImpl* manager, Bool vsync);
+	void init(GrManagerImpl* manager, Bool vsync, SwapchainPresentMode presentMode);
 
 	void destroy()
 	{
@@ -103,6 +115,7 @@ public:
 private:
 	GrManagerImpl* m_gr = nullptr;
 	Bool m_vsync = false;
+	SwapchainPresentMode m_presentMode = SwapchainPresentMode::AUTO;
 	MicroObjectRecycler<MicroSwapchain> m_recycler;
 };
 /// @}
@@ -0,0 +1,46 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/gr/vulkan/TextureHeapImpl.h>
+#include <anki/gr/vulkan/GrManagerImpl.h>
+
+namespace anki
+{
+
+TextureHeapImpl::~TextureHeapImpl()
+{
+	if(m_memHandle)
+	{
+		vkFreeMemory(getDevice(), m_memHandle, nullptr);
+	}
+}
+
+Error TextureHeapImpl::init(const TextureHeapInitInfo& init)
+{
+	ANKI_ASSERT(init.m_size > 0);
+	m_size = init.m_size;
+
+	// Pick the same memory type the textures prefer
+	const GpuMemoryManager& gpuMem = getGrManagerImpl().getGpuMemoryManager();
+	m_memTypeIdx =
+		gpuMem.findMemoryType(MAX_U32, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+	if(m_memTypeIdx == MAX_U32)
+	{
+		m_memTypeIdx = gpuMem.findMemoryType(MAX_U32, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0);
+	}
+	ANKI_ASSERT(m_memTypeIdx != MAX_U32);
+
+	VkMemoryAllocateInfo ci = {};
+	ci.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	ci.allocationSize = m_size;
+	ci.memoryTypeIndex = m_memTypeIdx;
+	ANKI_VK_CHECK(vkAllocateMemory(getDevice(), &ci, nullptr, &m_memHandle));
+	getGrManagerImpl().trySetVulkanHandleName(
+		init.getName(), VK_DEBUG_REPORT_OBJECT_TYPE_DEVICE_MEMORY_EXT, ptrToNumber(m_memHandle));
+
+	return Error::NONE;
+}
+
+} // end namespace anki
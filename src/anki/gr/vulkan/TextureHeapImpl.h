@@ -0,0 +1,35 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/gr/TextureHeap.h>
+#include <anki/gr/vulkan/VulkanObject.h>
+
+namespace anki
+{
+
+/// @addtogroup vulkan
+/// @{
+
+/// Texture heap implementation.
+class TextureHeapImpl final : public TextureHeap, public VulkanObject<TextureHeap, TextureHeapImpl>
+{
+public:
+	VkDeviceMemory m_memHandle = VK_NULL_HANDLE;
+	U32 m_memTypeIdx = MAX_U32;
+
+	TextureHeapImpl(GrManager* manager, CString name)
+		: TextureHeap(manager, name)
+	{
+	}
+
+	~TextureHeapImpl();
+
+	ANKI_USE_RESULT Error init(const TextureHeapInitInfo& init);
+};
+/// @}
+
+} // end namespace anki
@@ -4,6 +4,7 @@
 // http://www.anki3d.org/LICENSE
 
 #include <anki/gr/vulkan/TextureImpl.h>
+#include <anki/gr/vulkan/TextureHeapImpl.h>
 #include <anki/gr/Sampler.h>
 #include <anki/gr/GrManager.h>
 #include <anki/gr/vulkan/GrManagerImpl.h>
@@ -67,16 +68,8 @@ TextureImpl::~TextureImpl()
 	}
 }
 
-Error TextureImpl::initInternal(VkImage externalImage, const TextureInitInfo& init_)
+void TextureImpl::setProperties(TextureInitInfo& init)
 {
-	TextureInitInfo init = init_;
-	ANKI_ASSERT(init.isValid());
-	if(externalImage)
-	{
-		ANKI_ASSERT(!!(init.m_usage & TextureUsageBit::PRESENT));
-	}
-
-	// Set some stuff
 	m_width = init.m_width;
 	m_height = init.m_height;
 	m_depth = init.m_depth;
@@ -98,6 +91,19 @@ Error TextureImpl::initInternal(VkImage externalImage, const TextureInitInfo& in
 	m_vkFormat = convertFormat(m_format);
 	m_aspect = getImageAspectFromFormat(m_format);
 	m_usage = init.m_usage;
+}
+
+Error TextureImpl::initInternal(VkImage externalImage, const TextureInitInfo& init_)
+{
+	TextureInitInfo init = init_;
+	ANKI_ASSERT(init.isValid());
+	if(externalImage)
+	{
+		ANKI_ASSERT(!!(init.m_usage & TextureUsageBit::PRESENT));
+	}
+
+	// Set some stuff
+	setProperties(init);
 
 	if(externalImage)
 	{
@@ -216,12 +222,103 @@ Bool TextureImpl::imageSupported(const TextureInitInfo& init)
 	}
 }
 
+Error TextureImpl::initMemoryRequirements(const TextureInitInfo& init_, PtrSize& size, PtrSize& alignment)
+{
+	TextureInitInfo init = init_;
+	ANKI_ASSERT(init.isValid());
+	setProperties(init);
+#if ANKI_ASSERTS_ENABLED
+	m_usedFor = m_usage; // It will never be used
+#endif
+
+	ANKI_CHECK(createImage(init, false));
+
+	VkMemoryRequirements req = {};
+	vkGetImageMemoryRequirements(getDevice(), m_imageHandle, &req);
+	size = req.size;
+	alignment = req.alignment;
+
+	return Error::NONE;
+}
+
 Error TextureImpl::initImage(const TextureInitInfo& init_)
 {
 	TextureInitInfo init = init_;
-	Bool useDedicatedMemory = !!(init.m_usage & TextureUsageBit::FRAMEBUFFER_ATTACHMENT_READ_WRITE)
-							  && !!(getGrManagerImpl().getExtensions() & VulkanExtensions::KHR_DEDICATED_ALLOCATION);
+	const TextureHeapImpl* heap = static_cast<const TextureHeapImpl*>(init.m_heap.get());
+	const Bool useDedicatedMemory =
+		!heap && !!(init.m_usage & TextureUsageBit::FRAMEBUFFER_ATTACHMENT_READ_WRITE)
+		&& !!(getGrManagerImpl().getExtensions() & VulkanExtensions::KHR_DEDICATED_ALLOCATION);
+
+	ANKI_CHECK(createImage(init, useDedicatedMemory));
 
+	// Allocate memory
+	//
+	VkMemoryRequirements req = {};
+	vkGetImageMemoryRequirements(getDevice(), m_imageHandle, &req);
+
+	// Place it in the heap if it fits
+	if(heap)
+	{
+		if((req.memoryTypeBits & (1u << heap->m_memTypeIdx)) && (init.m_heapOffset % req.alignment) == 0
+			&& init.m_heapOffset + req.size <= heap->getSize())
+		{
+			m_heap = init.m_heap;
+
+			ANKI_TRACE_SCOPED_EVENT(VK_BIND_OBJECT);
+			ANKI_VK_CHECK(vkBindImageMemory(getDevice(), m_imageHandle, heap->m_memHandle, init.m_heapOffset));
+			return Error::NONE;
+		}
+
+		ANKI_VK_LOGW("Texture %s can't be placed in its heap. It will allocate its own memory", getName().cstr());
+	}
+
+	U32 memIdx = getGrManagerImpl().getGpuMemoryManager().findMemoryType(
+		req.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+
+	// Fallback
+	if(memIdx == MAX_U32)
+	{
+		memIdx = getGrManagerImpl().getGpuMemoryManager().findMemoryType(
+			req.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0);
+	}
+
+	ANKI_ASSERT(memIdx != MAX_U32);
+
+	if(!useDedicatedMemory)
+	{
+		// Allocate
+		getGrManagerImpl().getGpuMemoryManager().allocateMemory(
+			memIdx, req.size, U32(req.alignment), false, m_memHandle);
+
+		// Bind mem to image
+		ANKI_TRACE_SCOPED_EVENT(VK_BIND_OBJECT);
+		ANKI_VK_CHECK(vkBindImageMemory(getDevice(), m_imageHandle, m_memHandle.m_memory, m_memHandle.m_offset));
+	}
+	else
+	{
+		VkDedicatedAllocationMemoryAllocateInfoNV dedicatedInfo = {};
+		dedicatedInfo.sType = VK_STRUCTURE_TYPE_DEDICATED_ALLOCATION_MEMORY_ALLOCATE_INFO_NV;
+		dedicatedInfo.image = m_imageHandle;
+
+		VkMemoryAllocateInfo memAllocCi = {};
+		memAllocCi.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		memAllocCi.pNext = &dedicatedInfo;
+		memAllocCi.allocationSize = req.size;
+		memAllocCi.memoryTypeIndex = memIdx;
+
+		ANKI_VK_CHECK(vkAllocateMemory(getDevice(), &memAllocCi, nullptr, &m_dedicatedMem));
+		getGrManagerImpl().trySetVulkanHandleName(
+			init.getName(), VK_DEBUG_REPORT_OBJECT_TYPE_DEVICE_MEMORY_EXT, ptrToNumber(m_dedicatedMem));
+
+		ANKI_TRACE_SCOPED_EVENT(VK_BIND_OBJECT);
+		ANKI_VK_CHECK(vkBindImageMemory(getDevice(), m_imageHandle, m_dedicatedMem, 0));
+	}
+
+	return Error::NONE;
+}
+
+Error TextureImpl::createImage(TextureInitInfo& init, Bool useDedicatedMemory)
+{
 	// Check if format is supported
 	Bool supported;
 	while(!(supported = imageSupported(init)))
@@ -308,10 +405,11 @@ Error TextureImpl::initImage(const TextureInitInfo& init_)
 	ci.samples = VK_SAMPLE_COUNT_1_BIT;
 	ci.tiling = VK_IMAGE_TILING_OPTIMAL;
 	ci.usage = convertTextureUsage(init.m_usage, init.m_format);
-	ci.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-	ci.queueFamilyIndexCount = 1;
-	U32 queueIdx = getGrManagerImpl().getGraphicsQueueFamily();
-	ci.pQueueFamilyIndices = &queueIdx;
+	// Share it between the graphics and the async compute queues to avoid the queue family ownership transfers
+	const ConstWeakArray<U32> queueFamilies = getGrManagerImpl().getQueueFamilies();
+	ci.sharingMode = (queueFamilies.getSize() > 1) ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE;
+	ci.queueFamilyIndexCount = queueFamilies.getSize();
+	ci.pQueueFamilyIndices = &queueFamilies[0];
 	ci.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 
 	VkDedicatedAllocationImageCreateInfoNV dedicatedMemCi = {};
@@ -330,53 +428,6 @@ Error TextureImpl::initImage(const TextureInitInfo& init_)
 		init.getName() ? init.getName().cstr() : "Unnamed");
 #endif
 
-	// Allocate memory
-	//
-	VkMemoryRequirements req = {};
-	vkGetImageMemoryRequirements(getDevice(), m_imageHandle, &req);
-
-	U32 memIdx = getGrManagerImpl().getGpuMemoryManager().findMemoryType(
-		req.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
-
-	// Fallback
-	if(memIdx == MAX_U32)
-	{
-		memIdx = getGrManagerImpl().getGpuMemoryManager().findMemoryType(
-			req.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0);
-	}
-
-	ANKI_ASSERT(memIdx != MAX_U32);
-
-	if(!useDedicatedMemory)
-	{
-		// Allocate
-		getGrManagerImpl().getGpuMemoryManager().allocateMemory(
-			memIdx, req.size, U32(req.alignment), false, m_memHandle);
-
-		// Bind mem to image
-		ANKI_TRACE_SCOPED_EVENT(VK_BIND_OBJECT);
-		ANKI_VK_CHECK(vkBindImageMemory(getDevice(), m_imageHandle, m_memHandle.m_memory, m_memHandle.m_offset));
-	}
-	else
-	{
-		VkDedicatedAllocationMemoryAllocateInfoNV dedicatedInfo = {};
-		dedicatedInfo.sType = VK_STRUCTURE_TYPE_DEDICATED_ALLOCATION_MEMORY_ALLOCATE_INFO_NV;
-		dedicatedInfo.image = m_imageHandle;
-
-		VkMemoryAllocateInfo memAllocCi = {};
-		memAllocCi.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-		memAllocCi.pNext = &dedicatedInfo;
-		memAllocCi.allocationSize = req.size;
-		memAllocCi.memoryTypeIndex = memIdx;
-
-		ANKI_VK_CHECK(vkAllocateMemory(getDevice(), &memAllocCi, nullptr, &m_dedicatedMem));
-		getGrManagerImpl().trySetVulkanHandleName(
-			init.getName(), VK_DEBUG_REPORT_OBJECT_TYPE_DEVICE_MEMORY_EXT, ptrToNumber(m_dedicatedMem));
-
-		ANKI_TRACE_SCOPED_EVENT(VK_BIND_OBJECT);
-		ANKI_VK_CHECK(vkBindImageMemory(getDevice(), m_imageHandle, m_dedicatedMem, 0));
-	}
-
 	return Error::NONE;
 }
 
@@ -496,6 +547,12 @@ void TextureImpl::computeBarrierInfo(TextureUsageBit before,
 		srcAccesses |= VK_ACCESS_TRANSFER_WRITE_BIT;
 	}
 
+	if(!!(before & TextureUsageBit::FRAMEBUFFER_SHADING_RATE))
+	{
+		srcStages |= VK_PIPELINE_STAGE_FRAGMENT_SHADING_RATE_ATTACHMENT_BIT_KHR;
+		srcAccesses |= VK_ACCESS_FRAGMENT_SHADING_RATE_ATTACHMENT_READ_BIT_KHR;
+	}
+
 	if(srcStages == 0)
 	{
 		srcStages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
@@ -606,9 +663,87 @@ void TextureImpl::computeBarrierInfo(TextureUsageBit before,
 		dstAccesses |= VK_ACCESS_MEMORY_READ_BIT;
 	}
 
+	if(!!(after & TextureUsageBit::FRAMEBUFFER_SHADING_RATE))
+	{
+		dstStages |= VK_PIPELINE_STAGE_FRAGMENT_SHADING_RATE_ATTACHMENT_BIT_KHR;
+		dstAccesses |= VK_ACCESS_FRAGMENT_SHADING_RATE_ATTACHMENT_READ_BIT_KHR;
+	}
+
 	ANKI_ASSERT(dstStages);
 }
 
+void TextureImpl::computeConservativeSrcBarrierInfo(
+	TextureUsageBit prevUsage, VkPipelineStageFlags& srcStages, VkAccessFlags& srcAccesses)
+{
+	srcStages = 0;
+	srcAccesses = 0;
+
+	// The reads need only an execution dependency
+	if(!!(prevUsage & TextureUsageBit::SAMPLED_VERTEX))
+	{
+		srcStages |= VK_PIPELINE_STAGE_VERTEX_SHADER_BIT;
+	}
+
+	if(!!(prevUsage & TextureUsageBit::SAMPLED_TESSELLATION_CONTROL))
+	{
+		srcStages |= VK_PIPELINE_STAGE_TESSELLATION_CONTROL_SHADER_BIT;
+	}
+
+	if(!!(prevUsage & TextureUsageBit::SAMPLED_TESSELLATION_EVALUATION))
+	{
+		srcStages |= VK_PIPELINE_STAGE_TESSELLATION_EVALUATION_SHADER_BIT;
+	}
+
+	if(!!(prevUsage & TextureUsageBit::SAMPLED_GEOMETRY))
+	{
+		srcStages |= VK_PIPELINE_STAGE_GEOMETRY_SHADER_BIT;
+	}
+
+	if(!!(prevUsage & TextureUsageBit::SAMPLED_FRAGMENT))
+	{
+		srcStages |= VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+	}
+
+	if(!!(prevUsage & (TextureUsageBit::SAMPLED_COMPUTE | TextureUsageBit::IMAGE_COMPUTE_READ)))
+	{
+		srcStages |= VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	}
+
+	if(!!(prevUsage & TextureUsageBit::IMAGE_COMPUTE_WRITE))
+	{
+		srcStages |= VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+		srcAccesses |= VK_ACCESS_SHADER_WRITE_BIT;
+	}
+
+	if(!!(prevUsage & TextureUsageBit::FRAMEBUFFER_SHADING_RATE))
+	{
+		srcStages |= VK_PIPELINE_STAGE_FRAGMENT_SHADING_RATE_ATTACHMENT_BIT_KHR;
+	}
+
+	if(!!(prevUsage & TextureUsageBit::FRAMEBUFFER_ATTACHMENT_READ_WRITE))
+	{
+		srcStages |= VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT
+					 | VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	}
+
+	if(!!(prevUsage & TextureUsageBit::FRAMEBUFFER_ATTACHMENT_WRITE))
+	{
+		srcAccesses |= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	}
+
+	if(!!(prevUsage
+		   & (TextureUsageBit::GENERATE_MIPMAPS | TextureUsageBit::TRANSFER_DESTINATION | TextureUsageBit::CLEAR)))
+	{
+		srcStages |= VK_PIPELINE_STAGE_TRANSFER_BIT;
+		srcAccesses |= VK_ACCESS_TRANSFER_WRITE_BIT;
+	}
+
+	if(srcStages == 0)
+	{
+		srcStages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+	}
+}
+
 VkImageLayout TextureImpl::computeLayout(TextureUsageBit usage, U level) const
 {
 	ANKI_ASSERT(level < m_mipCount);
@@ -678,6 +813,10 @@ VkImageLayout TextureImpl::computeLayout(TextureUsageBit usage, U level) const
 	{
 		out = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 	}
+	else if(usage == TextureUsageBit::FRAMEBUFFER_SHADING_RATE)
+	{
+		out = VK_IMAGE_LAYOUT_FRAGMENT_SHADING_RATE_ATTACHMENT_OPTIMAL_KHR;
+	}
 	else
 	{
 		// Can't set it to something, chose general
@@ -101,6 +101,9 @@ public:
 		return initInternal(image, init);
 	}
 
+	/// Create only the VkImage and get the memory it needs if it's placed in a TextureHeap.
+	ANKI_USE_RESULT Error initMemoryRequirements(const TextureInitInfo& init, PtrSize& size, PtrSize& alignment);
+
 	Bool aspectValid(DepthStencilAspectBit aspect) const
 	{
 		return m_aspect == aspect || !!(aspect & m_aspect);
@@ -155,6 +158,11 @@ public:
 		VkPipelineStageFlags& dstStages,
 		VkAccessFlags& dstAccesses) const;
 
+	/// Compute the source of a barrier that doesn't know the format of the textures it waits, like the aliasing
+	/// barriers or the first half of the split barriers. It's conservative with the attachments.
+	static void computeConservativeSrcBarrierInfo(
+		TextureUsageBit prevUsage, VkPipelineStageFlags& srcStages, VkAccessFlags& srcAccesses);
+
 	/// Predict the image layout.
 	VkImageLayout computeLayout(TextureUsageBit usage, U level) const;
 
@@ -192,6 +200,9 @@ private:
 
 	VkDeviceMemory m_dedicatedMem = VK_NULL_HANDLE;
 
+	/// Hold a reference to the heap if the image is placed in one.
+	TextureHeapPtr m_heap;
+
 #if ANKI_ASSERTS_ENABLED
 	mutable TextureUsageBit m_usedFor = TextureUsageBit::NONE;
 	mutable SpinLock m_usedForMtx;
@@ -205,6 +216,10 @@ private:
 
 	ANKI_USE_RESULT Error initImage(const TextureInitInfo& init);
 
+	ANKI_USE_RESULT Error createImage(TextureInitInfo& init, Bool useDedicatedMemory);
+
+	void setProperties(TextureInitInfo& init);
+
 	template<typename TextureInfo>
 	void updateUsageState(
 		const TextureInfo& surfOrVol, TextureUsageBit usage, StackAllocator<U8>& alloc, TextureUsageState& state) const;
@@ -31,32 +31,14 @@ TimestampQueryResult TimestampQueryImpl::getResultInternal(Second& timestamp) co
 	ANKI_ASSERT(m_handle);
 	timestamp = -1.0;
 
-	VkResult res;
 	U64 value;
-	ANKI_VK_CHECKF(res = vkGetQueryPoolResults(getDevice(),
-					   m_handle.getQueryPool(),
-					   m_handle.getQueryIndex(),
-					   1,
-					   sizeof(value),
-					   &value,
-					   sizeof(value),
-					   VK_QUERY_RESULT_64_BIT));
-
 	TimestampQueryResult qout = TimestampQueryResult::NOT_AVAILABLE;
-	if(res == VK_SUCCESS)
+	if(getGrManagerImpl().getTimestampQueryFactory().getResult(m_handle, value))
 	{
 		value *= m_timestampPeriod;
 		timestamp = Second(value) / Second(1000000000);
 		qout = TimestampQueryResult::AVAILABLE;
 	}
-	else if(res == VK_NOT_READY)
-	{
-		qout = TimestampQueryResult::NOT_AVAILABLE;
-	}
-	else
-	{
-		ANKI_ASSERT(0);
-	}
 
 	return qout;
 }
@@ -9,6 +9,7 @@
 
 #include <anki/gr/vulkan/BufferImpl.h>
 #include <anki/gr/vulkan/TextureImpl.h>
+#include <anki/gr/vulkan/TextureHeapImpl.h>
 #include <anki/gr/vulkan/SamplerImpl.h>
 #include <anki/gr/vulkan/ShaderImpl.h>
 #include <anki/gr/vulkan/ShaderProgramImpl.h>
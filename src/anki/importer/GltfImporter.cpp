@@ -7,6 +7,7 @@
 #include <anki/util/System.h>
 #include <anki/util/ThreadHive.h>
 #include <anki/util/StringList.h>
+#include <anki/util/Filesystem.h>
 
 #if ANKI_COMPILER_GCC_COMPATIBLE
 #	pragma GCC diagnostic push
@@ -160,35 +161,53 @@ Error GltfImporter::init(CString inputFname,
 	CString texrpath,
 	Bool optimizeMeshes,
 	F32 lodFactor,
+	F32 lodError,
 	U32 lodCount,
 	F32 lightIntensityScale,
 	U32 threadCount,
+	Bool incremental,
+	Bool processTextures,
+	U32 collisionHullCount,
+	U32 collisionHullVertexCount,
 	CString comment)
 {
 	m_inputFname.create(inputFname);
 	m_outDir.create(outDir);
 	m_rpath.create(rpath);
-	m_texrpath.create(texrpath);
+	m_texrpath.create((processTextures) ? rpath : texrpath); // The processed textures go next to the other resources
 	m_optimizeMeshes = optimizeMeshes;
+	m_incremental = incremental;
+	m_processTextures = processTextures;
+	m_collisionHullCount = collisionHullCount;
+	m_collisionHullVertexCount = clamp(collisionHullVertexCount, 4u, 256u);
 	m_comment.create(comment);
 
 	m_lightIntensityScale = clamp(lightIntensityScale, 0.1f, 1.0f);
 
-	m_lodCount = clamp(lodCount, 1u, 3u);
+	m_lodCount = clamp(lodCount, 1u, 4u);
 	m_lodFactor = clamp(lodFactor, 0.0f, 1.0f);
-	if(m_lodFactor * F32(m_lodCount - 1) > 0.7f)
+	m_lodError = clamp(lodError, 0.0f, 1.0f);
+	if(m_lodError > 0.0f)
 	{
-		ANKI_GLTF_LOGE("LOD factor is too high %f", m_lodFactor);
-		return Error::USER_DATA;
-	}
-
-	if(m_lodFactor < EPSILON || lodCount == 1)
-	{
-		m_lodCount = 1;
 		m_lodFactor = 0.0f;
+		ANKI_GLTF_LOGI("Having %u LODs with screen space error %f", m_lodCount, m_lodError);
 	}
+	else
+	{
+		if(m_lodFactor * F32(m_lodCount - 1) > 0.7f)
+		{
+			ANKI_GLTF_LOGE("LOD factor is too high %f", m_lodFactor);
+			return Error::USER_DATA;
+		}
+
+		if(m_lodFactor < EPSILON || lodCount == 1)
+		{
+			m_lodCount = 1;
+			m_lodFactor = 0.0f;
+		}
 
-	ANKI_GLTF_LOGI("Having %u LODs with LOD factor %f", m_lodCount, m_lodFactor);
+		ANKI_GLTF_LOGI("Having %u LODs with LOD factor %f", m_lodCount, m_lodFactor);
+	}
 
 	cgltf_options options = {};
 	cgltf_result res = cgltf_parse_file(&options, inputFname.cstr(), &m_gltf);
@@ -211,6 +230,14 @@ Error GltfImporter::init(CString inputFname,
 		m_hive = m_alloc.newInstance<ThreadHive>(threadCount, m_alloc, true);
 	}
 
+	const U32 importerVersion = IMPORTER_VERSION;
+	m_optionsHash = computeHash(MANIFEST_HASH_VERSION, &importerVersion, sizeof(importerVersion));
+	m_optionsHash = appendHash(MANIFEST_HASH_VERSION, &m_optimizeMeshes, sizeof(m_optimizeMeshes), m_optionsHash);
+	m_optionsHash =
+		appendHash(MANIFEST_HASH_VERSION, &m_normalsMergeAngle, sizeof(m_normalsMergeAngle), m_optionsHash);
+
+	ANKI_CHECK(loadManifest());
+
 	return Error::NONE;
 }
 
@@ -229,8 +256,14 @@ Error GltfImporter::writeAll()
 	ANKI_CHECK(m_sceneFile.writeText("-- Generated by: %s\n", m_comment.cstr()));
 	ANKI_CHECK(m_sceneFile.writeText("local scene = getSceneGraph()\nlocal events = getEventManager()\n"));
 
-	// Nodes
+	// Textures. They are slow so they go to the threads first
 	Error err = Error::NONE;
+	if(m_processTextures)
+	{
+		err = writeTextures();
+	}
+
+	// Nodes
 	for(const cgltf_scene* scene = m_gltf->scenes; scene < m_gltf->scenes + m_gltf->scenes_count && !err; ++scene)
 	{
 		for(cgltf_node* const* node = scene->nodes; node < scene->nodes + scene->nodes_count && !err; ++node)
@@ -258,9 +291,94 @@ Error GltfImporter::writeAll()
 		return threadErr;
 	}
 
+	// Only a successful import updates the manifest
+	ANKI_CHECK(saveManifest());
+
 	return err;
 }
 
+Error GltfImporter::loadManifest()
+{
+	StringAuto fname(m_alloc);
+	fname.sprintf("%s%s", m_outDir.cstr(), MANIFEST_FILENAME);
+	if(!fileExists(fname.toCString()))
+	{
+		return Error::NONE;
+	}
+
+	File file;
+	ANKI_CHECK(file.open(fname.toCString(), FileOpenFlag::READ | FileOpenFlag::BINARY));
+
+	Array<char, 8> magic;
+	U32 entryCount;
+	ANKI_CHECK(file.read(&magic[0], sizeof(magic)));
+	ANKI_CHECK(file.read(&entryCount, sizeof(entryCount)));
+	if(memcmp(&magic[0], MANIFEST_MAGIC, sizeof(magic)) != 0
+		|| file.getSize() != sizeof(magic) + sizeof(entryCount) + entryCount * sizeof(ManifestEntry))
+	{
+		ANKI_GLTF_LOGW("Ignoring the corrupted import manifest: %s", fname.cstr());
+		return Error::NONE;
+	}
+
+	for(U32 i = 0; i < entryCount; ++i)
+	{
+		ManifestEntry entry;
+		ANKI_CHECK(file.read(&entry, sizeof(entry)));
+		m_manifest.emplace(entry.m_outputHash, entry);
+	}
+
+	return Error::NONE;
+}
+
+Error GltfImporter::saveManifest()
+{
+	StringAuto fname(m_alloc);
+	fname.sprintf("%s%s", m_outDir.cstr(), MANIFEST_FILENAME);
+
+	File file;
+	ANKI_CHECK(file.open(fname.toCString(), FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+
+	U32 entryCount = 0;
+	for(const ManifestEntry& entry : m_manifest)
+	{
+		(void)entry;
+		++entryCount;
+	}
+
+	ANKI_CHECK(file.write(MANIFEST_MAGIC, 8));
+	ANKI_CHECK(file.write(&entryCount, sizeof(entryCount)));
+	for(const ManifestEntry& entry : m_manifest)
+	{
+		ANKI_CHECK(file.write(&entry, sizeof(entry)));
+	}
+
+	return Error::NONE;
+}
+
+Bool GltfImporter::outputChanged(CString fname, U64 inputHash)
+{
+	ManifestEntry newEntry;
+	newEntry.m_outputHash = computeHash(MANIFEST_HASH_VERSION, fname.cstr(), fname.getLength());
+	newEntry.m_inputHash = inputHash;
+
+	LockGuard<Mutex> lock(m_manifestMtx);
+
+	auto it = m_manifest.find(newEntry.m_outputHash);
+	if(it == m_manifest.getEnd())
+	{
+		m_manifest.emplace(newEntry.m_outputHash, newEntry);
+		return true;
+	}
+
+	if(m_incremental && it->m_inputHash == inputHash && fileExists(fname))
+	{
+		return false;
+	}
+
+	it->m_inputHash = inputHash;
+	return true;
+}
+
 Error GltfImporter::getExtras(const cgltf_extras& extras, HashMapAuto<CString, StringAuto>& out)
 {
 	cgltf_size extrasSize;
@@ -632,7 +750,6 @@ Error GltfImporter::visitNode(
 				cgltf_skin* m_skin;
 				Bool m_selfCollision;
 				U32 m_lodCount;
-				F32 m_lodFactor;
 			};
 			Ctx* ctx = m_alloc.newInstance<Ctx>();
 			ctx->m_importer = this;
@@ -640,7 +757,6 @@ Error GltfImporter::visitNode(
 			ctx->m_mtl = node.mesh->primitives[0].material;
 			ctx->m_skin = node.skin;
 			ctx->m_lodCount = m_lodCount;
-			ctx->m_lodFactor = m_lodFactor;
 
 			HashMapAuto<CString, StringAuto>::Iterator it2;
 			const Bool selfCollision = (it2 = extras.find("collision_mesh")) != extras.getEnd() && *it2 == "self";
@@ -651,25 +767,19 @@ Error GltfImporter::visitNode(
 				Ctx& self = *static_cast<Ctx*>(userData);
 
 				// LOD 0
-				Error err = self.m_importer->writeMesh(*self.m_mesh, CString(), 1.0f);
+				Error err = self.m_importer->writeMesh(*self.m_mesh, CString(), 1.0f, 0.0f);
 				U32 maxLod = 0;
 
-				// LOD 1
-				if(!err && self.m_lodCount > 1)
+				// The rest of the LODs
+				for(U32 lod = 1; lod < self.m_lodCount && !err; ++lod)
 				{
-					StringAuto name(self.m_importer->m_alloc);
-					name.sprintf("%s_lod1", self.m_mesh->name);
-					err = self.m_importer->writeMesh(*self.m_mesh, name, 1.0f - self.m_lodFactor);
-					maxLod = 1;
-				}
+					F32 decimateFactor, maxError;
+					self.m_importer->getLodSimplification(lod, decimateFactor, maxError);
 
-				// LOD 2
-				if(!err && self.m_lodCount > 2)
-				{
 					StringAuto name(self.m_importer->m_alloc);
-					name.sprintf("%s_lod2", self.m_mesh->name);
-					err = self.m_importer->writeMesh(*self.m_mesh, name, 1.0f - self.m_lodFactor * 2.0f);
-					maxLod = 2;
+					name.sprintf("%s_lod%u", self.m_mesh->name, lod);
+					err = self.m_importer->writeMesh(*self.m_mesh, name, decimateFactor, maxError);
+					maxLod = lod;
 				}
 
 				if(!err)
@@ -808,6 +918,13 @@ Error GltfImporter::writeModel(const cgltf_mesh& mesh, CString skinName)
 		ANKI_CHECK(file.writeText("\t\t\t<mesh2>%s%s.ankimesh</mesh2>\n", m_rpath.cstr(), name.cstr()));
 	}
 
+	if(m_lodCount > 3)
+	{
+		StringAuto name(m_alloc);
+		name.sprintf("%s_lod3", mesh.name);
+		ANKI_CHECK(file.writeText("\t\t\t<mesh3>%s%s.ankimesh</mesh3>\n", m_rpath.cstr(), name.cstr()));
+	}
+
 	HashMapAuto<CString, StringAuto> materialExtras(m_alloc);
 	ANKI_CHECK(getExtras(mesh.primitives[0].material->extras, materialExtras));
 	auto mtlOverride = materialExtras.find("material_override");
@@ -825,6 +942,16 @@ Error GltfImporter::writeModel(const cgltf_mesh& mesh, CString skinName)
 
 	ANKI_CHECK(file.writeText("\t</modelPatches>\n"));
 
+	if(m_lodError > 0.0f && m_lodCount > 1)
+	{
+		ANKI_CHECK(file.writeText("\t<lodScreenSizes>"));
+		for(U32 lod = 1; lod < m_lodCount; ++lod)
+		{
+			ANKI_CHECK(file.writeText((lod + 1 < m_lodCount) ? "%f " : "%f", computeLodScreenSize(lod)));
+		}
+		ANKI_CHECK(file.writeText("</lodScreenSizes>\n"));
+	}
+
 	if(skinName)
 	{
 		ANKI_CHECK(file.writeText("\t<skeleton>%s%s.ankiskel</skeleton>\n", m_rpath.cstr(), skinName.cstr()));
@@ -1050,6 +1177,12 @@ Error GltfImporter::writeCollisionMesh(const cgltf_mesh& mesh, U32 maxLod)
 {
 	StringAuto fname(m_alloc);
 	fname.sprintf("%s%s.ankicl", m_outDir.cstr(), mesh.name);
+
+	if(m_collisionHullCount > 0)
+	{
+		return writeCollisionHulls(mesh, fname.toCString());
+	}
+
 	ANKI_GLTF_LOGI("Importing collision mesh %s", fname.cstr());
 
 	// Write file
@@ -8,6 +8,7 @@
 #include <anki/util/String.h>
 #include <anki/util/File.h>
 #include <anki/util/HashMap.h>
+#include <anki/util/Thread.h>
 #include <anki/Math.h>
 #include <cgltf/cgltf.h>
 
@@ -36,9 +37,14 @@ public:
 		CString texrpath,
 		Bool optimizeMeshes,
 		F32 lodFactor,
+		F32 lodError,
 		U32 lodCount,
 		F32 lightIntensityScale,
 		U32 threadCount,
+		Bool incremental,
+		Bool processTextures,
+		U32 collisionHullCount,
+		U32 collisionHullVertexCount,
 		CString comment);
 
 	ANKI_USE_RESULT Error writeAll();
@@ -53,8 +59,30 @@ private:
 		}
 	};
 
+	/// An output of the last import.
+	class ManifestEntry
+	{
+	public:
+		U64 m_outputHash; ///< The hash of the filename.
+		U64 m_inputHash; ///< The hash of everything that went into the file.
+	};
+
 	// Data
 	static const char* XML_HEADER;
+	static constexpr const char* MANIFEST_FILENAME = "gltf_import_manifest.bin";
+	static constexpr const char* MANIFEST_MAGIC = "ANKIGIM1";
+
+	/// Bump it when the importer writes different files for the same input so the incremental imports redo everything.
+	static constexpr U32 IMPORTER_VERSION = 2;
+
+	/// The manifest is stored so its hashes need to be stable.
+	static constexpr HashVersion MANIFEST_HASH_VERSION = HashVersion::XXH3;
+
+	/// The max simplification error of the LODs that have a decimate factor, relative to the size of the mesh.
+	static constexpr F32 DECIMATE_MAX_ERROR = 1e-2f;
+
+	/// The max simplification error of LOD 1 when the LODs come from the screen space error.
+	static constexpr F32 LOD_BASE_ERROR = 1e-2f;
 
 	GenericMemoryPoolAllocator<U8> m_alloc;
 
@@ -76,11 +104,24 @@ private:
 	HashMapAuto<const void*, U32, PtrHasher> m_nodePtrToIdx{m_alloc}; ///< Need an index for the unnamed nodes.
 
 	F32 m_lodFactor = 1.0f;
+	F32 m_lodError = 0.0f; ///< The screen space error of the LODs. Zero if they use m_lodFactor.
 	U32 m_lodCount = 1;
 	F32 m_lightIntensityScale = 1.0f;
 	Bool m_optimizeMeshes = false;
 	StringAuto m_comment{m_alloc};
 
+	/// The inputs of the meshes and the materials the last import wrote. The key is ManifestEntry::m_outputHash.
+	HashMapAuto<U64, ManifestEntry> m_manifest{m_alloc};
+	Mutex m_manifestMtx; ///< Protect m_manifest.
+	U64 m_optionsHash = 0; ///< The importer version and the options that change the outputs.
+	Bool m_incremental = true;
+
+	/// Convert the textures to .ankitex in the output dir. Otherwise the materials expect them converted in texrpath.
+	Bool m_processTextures = false;
+
+	U32 m_collisionHullCount = 0; ///< The max convex hulls of the collision meshes. Zero to keep the triangles.
+	U32 m_collisionHullVertexCount = 32; ///< The max vertices of a convex hull.
+
 	// Misc
 	ANKI_USE_RESULT Error getExtras(const cgltf_extras& extras, HashMapAuto<CString, StringAuto>& out);
 	ANKI_USE_RESULT Error parseArrayOfNumbers(
@@ -89,6 +130,18 @@ private:
 	void populateNodePtrToIdxInternal(const cgltf_node& node, U32& idx);
 	StringAuto getNodeName(const cgltf_node& node);
 
+	// Incremental import
+	ANKI_USE_RESULT Error loadManifest();
+	ANKI_USE_RESULT Error saveManifest();
+
+	/// Check if an output needs to be written and record its new input hash.
+	/// @note Thread-safe.
+	Bool outputChanged(CString fname, U64 inputHash);
+
+	U64 computeMeshHash(const cgltf_mesh& mesh, F32 decimateFactor, F32 maxError) const;
+	ANKI_USE_RESULT Error computeMaterialHash(const cgltf_material& mtl, U64& hash);
+	static U64 appendAccessorHash(const cgltf_accessor& accessor, U64 hash);
+
 	template<typename T, typename TFunc>
 	static void visitAccessor(const cgltf_accessor& accessor, TFunc func);
 
@@ -98,13 +151,25 @@ private:
 		visitAccessor<T>(accessor, [&](const T& val) { out.emplaceBack(val); });
 	}
 
+	// LODs
+	/// Get how much to simplify a LOD.
+	/// @param[out] decimateFactor The fraction of the triangles to keep. Zero to remove as many as maxError allows.
+	/// @param[out] maxError The max distance the surface can move, relative to the size of the mesh.
+	void getLodSimplification(U32 lod, F32& decimateFactor, F32& maxError) const;
+
+	/// The screen size below which the renderables switch to a LOD. Only for the LODs of the screen space error.
+	F32 computeLodScreenSize(U32 lod) const;
+
 	// Resources
-	ANKI_USE_RESULT Error writeMesh(const cgltf_mesh& mesh, CString nameOverride, F32 decimateFactor);
+	ANKI_USE_RESULT Error writeMesh(const cgltf_mesh& mesh, CString nameOverride, F32 decimateFactor, F32 maxError);
 	ANKI_USE_RESULT Error writeMaterial(const cgltf_material& mtl);
+	ANKI_USE_RESULT Error writeTextures();
+	ANKI_USE_RESULT Error writeTexture(CString uri, Bool normal);
 	ANKI_USE_RESULT Error writeModel(const cgltf_mesh& mesh, CString skinName);
 	ANKI_USE_RESULT Error writeAnimation(const cgltf_animation& anim);
 	ANKI_USE_RESULT Error writeSkeleton(const cgltf_skin& skin);
 	ANKI_USE_RESULT Error writeCollisionMesh(const cgltf_mesh& mesh, U32 maxLod);
+	ANKI_USE_RESULT Error writeCollisionHulls(const cgltf_mesh& mesh, CString fname);
 
 	// Scene
 	ANKI_USE_RESULT Error writeTransform(const Transform& trf);
@@ -0,0 +1,322 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/importer/GltfImporter.h>
+
+#if ANKI_COMPILER_GCC_COMPATIBLE
+#	pragma GCC diagnostic push
+#	pragma GCC diagnostic ignored "-Wall"
+#	pragma GCC diagnostic ignored "-Wconversion"
+#	pragma GCC diagnostic ignored "-Wfloat-conversion"
+#endif
+#include <LinearMath/btConvexHullComputer.h>
+#if ANKI_COMPILER_GCC_COMPATIBLE
+#	pragma GCC diagnostic pop
+#endif
+
+namespace anki
+{
+
+/// The max distance of the surface of a part from its convex hull, relative to the size of the mesh. The parts that are
+/// more concave are split further.
+constexpr F32 MAX_HULL_CONCAVITY = 0.02f;
+
+/// The concavity is measured on that many of the points of a part at most.
+constexpr U32 MAX_CONCAVITY_SAMPLES = 4096;
+
+/// A part of the mesh that the convex decomposition approximates with a convex hull.
+class ConvexPart
+{
+public:
+	DynamicArrayAuto<U32> m_triangles;
+	DynamicArrayAuto<Vec3> m_hull;
+	F32 m_concavity = 0.0f;
+
+	ConvexPart(GenericMemoryPoolAllocator<U8>& alloc)
+		: m_triangles(alloc)
+		, m_hull(alloc)
+	{
+	}
+};
+
+/// Compute the convex hull of the triangles of a part and how far their points are from its surface.
+static void computePartHull(ConstWeakArray<Vec3> positions,
+	ConstWeakArray<U32> indices,
+	GenericMemoryPoolAllocator<U8> alloc,
+	ConvexPart& part)
+{
+	DynamicArrayAuto<Vec3> points(alloc);
+	for(U32 tri : part.m_triangles)
+	{
+		for(U32 i = 0; i < 3; ++i)
+		{
+			points.emplaceBack(positions[indices[tri * 3 + i]]);
+		}
+
+		// The centers of the triangles too since the triangles can cut through the hull
+		points.emplaceBack(
+			(positions[indices[tri * 3]] + positions[indices[tri * 3 + 1]] + positions[indices[tri * 3 + 2]]) / 3.0f);
+	}
+
+	btConvexHullComputer computer;
+	computer.compute(&points[0][0], sizeof(Vec3), I32(points.getSize()), 0.0f, 0.0f);
+
+	part.m_hull.destroy();
+	Vec3 center(0.0f);
+	for(I32 i = 0; i < computer.vertices.size(); ++i)
+	{
+		const btVector3& v = computer.vertices[i];
+		part.m_hull.emplaceBack(v.x(), v.y(), v.z());
+		center += part.m_hull.getBack();
+	}
+	center /= F32(max(1u, part.m_hull.getSize()));
+
+	// The planes of the faces, facing out
+	DynamicArrayAuto<Vec4> planes(alloc);
+	for(I32 f = 0; f < computer.faces.size(); ++f)
+	{
+		const btConvexHullComputer::Edge* edge = &computer.edges[computer.faces[f]];
+		const Vec3 a = part.m_hull[edge->getSourceVertex()];
+		const Vec3 b = part.m_hull[edge->getTargetVertex()];
+		const Vec3 c = part.m_hull[edge->getNextEdgeOfFace()->getTargetVertex()];
+
+		Vec3 normal = (b - a).cross(c - a);
+		const F32 length = normal.getLength();
+		if(length < EPSILON)
+		{
+			continue;
+		}
+
+		normal /= length;
+		if(normal.dot(center - a) > 0.0f)
+		{
+			normal = -normal;
+		}
+
+		planes.emplaceBack(normal, normal.dot(a));
+	}
+
+	// The concavity is the max distance of the points from the surface of the hull. The points are inside
+	part.m_concavity = 0.0f;
+	const U32 sampleStep = max(1u, points.getSize() / MAX_CONCAVITY_SAMPLES);
+	for(U32 i = 0; i < points.getSize() && planes.getSize() > 0; i += sampleStep)
+	{
+		F32 dist = MAX_F32;
+		for(const Vec4& plane : planes)
+		{
+			dist = min(dist, plane.w() - plane.xyz().dot(points[i]));
+		}
+
+		part.m_concavity = max(part.m_concavity, dist);
+	}
+}
+
+/// Split a part in two with a plane that is perpendicular to the longest axis of the part.
+/// @return False if all the triangles end up on the one side.
+static Bool splitPart(ConstWeakArray<Vec3> positions,
+	ConstWeakArray<U32> indices,
+	const ConvexPart& part,
+	ConvexPart& left,
+	ConvexPart& right)
+{
+	auto getCenter = [&](U32 tri) -> Vec3 {
+		return (positions[indices[tri * 3]] + positions[indices[tri * 3 + 1]] + positions[indices[tri * 3 + 2]]) / 3.0f;
+	};
+
+	Vec3 aabbMin(MAX_F32);
+	Vec3 aabbMax(MIN_F32);
+	Vec3 mean(0.0f);
+	for(U32 tri : part.m_triangles)
+	{
+		const Vec3 center = getCenter(tri);
+		aabbMin = aabbMin.min(center);
+		aabbMax = aabbMax.max(center);
+		mean += center;
+	}
+	mean /= F32(part.m_triangles.getSize());
+
+	const Vec3 size = aabbMax - aabbMin;
+	const U32 axis = (size.x() > size.y()) ? ((size.x() > size.z()) ? 0 : 2) : ((size.y() > size.z()) ? 1 : 2);
+
+	for(U32 tri : part.m_triangles)
+	{
+		ConvexPart& side = (getCenter(tri)[axis] < mean[axis]) ? left : right;
+		side.m_triangles.emplaceBack(tri);
+	}
+
+	return left.m_triangles.getSize() > 0 && right.m_triangles.getSize() > 0;
+}
+
+/// Keep the vertices of the hull that are the furthest along a number of directions.
+static void reduceHull(U32 maxVertexCount, GenericMemoryPoolAllocator<U8> alloc, DynamicArrayAuto<Vec3>& hull)
+{
+	if(hull.getSize() <= maxVertexCount)
+	{
+		return;
+	}
+
+	DynamicArrayAuto<Vec3> reduced(alloc);
+	DynamicArrayAuto<Bool> picked(alloc, hull.getSize(), false);
+	for(U32 d = 0; d < maxVertexCount; ++d)
+	{
+		// The directions are evenly spread on the sphere
+		const F32 y = 1.0f - 2.0f * (F32(d) + 0.5f) / F32(maxVertexCount);
+		const F32 radius = sqrt(max(0.0f, 1.0f - y * y));
+		const F32 theta = F32(d) * PI * (3.0f - sqrt(5.0f));
+		const Vec3 dir(cos(theta) * radius, y, sin(theta) * radius);
+
+		U32 best = 0;
+		for(U32 v = 1; v < hull.getSize(); ++v)
+		{
+			if(hull[v].dot(dir) > hull[best].dot(dir))
+			{
+				best = v;
+			}
+		}
+
+		if(!picked[best])
+		{
+			picked[best] = true;
+			reduced.emplaceBack(hull[best]);
+		}
+	}
+
+	hull = std::move(reduced);
+}
+
+Error GltfImporter::writeCollisionHulls(const cgltf_mesh& mesh, CString fname)
+{
+	U64 hash = computeMeshHash(mesh, 1.0f, 0.0f);
+	const Array<U32, 2> budgets = {{m_collisionHullCount, m_collisionHullVertexCount}};
+	hash = appendHash(MANIFEST_HASH_VERSION, &budgets[0], sizeof(budgets), hash);
+	if(!outputChanged(fname, hash))
+	{
+		ANKI_GLTF_LOGI("Skipping unchanged collision hulls %s", fname.cstr());
+		return Error::NONE;
+	}
+
+	// Gather the triangles of all the primitives
+	DynamicArrayAuto<Vec3> positions(m_alloc);
+	DynamicArrayAuto<U32> indices(m_alloc);
+	for(const cgltf_primitive* primitive = mesh.primitives; primitive < mesh.primitives + mesh.primitives_count;
+		++primitive)
+	{
+		const U32 firstVertex = positions.getSize();
+		for(const cgltf_attribute* attrib = primitive->attributes;
+			attrib < primitive->attributes + primitive->attributes_count;
+			++attrib)
+		{
+			if(attrib->type == cgltf_attribute_type_position)
+			{
+				readAccessor<Vec3>(*attrib->data, positions);
+			}
+		}
+
+		ANKI_ASSERT(primitive->indices);
+		const U8* base = static_cast<const U8*>(primitive->indices->buffer_view->buffer->data)
+						 + primitive->indices->offset + primitive->indices->buffer_view->offset;
+		for(U32 i = 0; i < primitive->indices->count; ++i)
+		{
+			U32 idx;
+			if(primitive->indices->component_type == cgltf_component_type_r_32u)
+			{
+				idx = *reinterpret_cast<const U32*>(base + sizeof(U32) * i);
+			}
+			else
+			{
+				ANKI_ASSERT(primitive->indices->component_type == cgltf_component_type_r_16u);
+				idx = *reinterpret_cast<const U16*>(base + sizeof(U16) * i);
+			}
+
+			indices.emplaceBack(idx + firstVertex);
+		}
+	}
+
+	if(indices.getSize() == 0 || (indices.getSize() % 3) != 0)
+	{
+		ANKI_GLTF_LOGE("Incorect index count: %u", indices.getSize());
+		return Error::USER_DATA;
+	}
+
+	Vec3 aabbMin(MAX_F32);
+	Vec3 aabbMax(MIN_F32);
+	for(const Vec3& pos : positions)
+	{
+		aabbMin = aabbMin.min(pos);
+		aabbMax = aabbMax.max(pos);
+	}
+	const F32 maxConcavity = (aabbMax - aabbMin).getLength() * MAX_HULL_CONCAVITY;
+
+	// Start with one part and split the most concave part until all are convex enough or the budget is spent
+	ListAuto<ConvexPart> parts(m_alloc);
+	ConvexPart& firstPart = *parts.emplaceBack(m_alloc);
+	for(U32 tri = 0; tri < indices.getSize() / 3; ++tri)
+	{
+		firstPart.m_triangles.emplaceBack(tri);
+	}
+	computePartHull(positions, indices, m_alloc, firstPart);
+
+	U32 partCount = 1;
+	while(partCount < m_collisionHullCount)
+	{
+		auto worst = parts.getEnd();
+		for(auto it = parts.getBegin(); it != parts.getEnd(); ++it)
+		{
+			if(it->m_concavity > maxConcavity && (worst == parts.getEnd() || it->m_concavity > worst->m_concavity))
+			{
+				worst = it;
+			}
+		}
+
+		if(worst == parts.getEnd())
+		{
+			break;
+		}
+
+		ConvexPart& left = *parts.emplaceBack(m_alloc);
+		ConvexPart& right = *parts.emplaceBack(m_alloc);
+		if(!splitPart(positions, indices, *worst, left, right))
+		{
+			// Can't split it, keep it as it is
+			parts.popBack();
+			parts.popBack();
+			worst->m_concavity = 0.0f;
+			continue;
+		}
+
+		computePartHull(positions, indices, m_alloc, left);
+		computePartHull(positions, indices, m_alloc, right);
+		parts.erase(worst);
+		++partCount;
+	}
+
+	ANKI_GLTF_LOGI("Importing collision mesh %s as %u convex hulls", fname.cstr(), partCount);
+
+	// Write file
+	File file;
+	ANKI_CHECK(file.open(fname, FileOpenFlag::WRITE));
+	ANKI_CHECK(file.writeText("%s\n", XML_HEADER));
+	ANKI_CHECK(file.writeText("<collisionShape>\n\t<type>convexHulls</type>\n\t<value>\n"));
+
+	for(ConvexPart& part : parts)
+	{
+		reduceHull(m_collisionHullVertexCount, m_alloc, part.m_hull);
+
+		ANKI_CHECK(file.writeText("\t\t<convexHull>"));
+		for(U32 v = 0; v < part.m_hull.getSize(); ++v)
+		{
+			const Vec3& pos = part.m_hull[v];
+			ANKI_CHECK(file.writeText(
+				(v + 1 < part.m_hull.getSize()) ? "%f %f %f " : "%f %f %f", pos.x(), pos.y(), pos.z()));
+		}
+		ANKI_CHECK(file.writeText("</convexHull>\n"));
+	}
+
+	ANKI_CHECK(file.writeText("\t</value>\n</collisionShape>\n"));
+
+	return Error::NONE;
+}
+
+} // end namespace anki
@@ -5,6 +5,7 @@
 
 #include <anki/importer/GltfImporter.h>
 #include <anki/resource/ImageLoader.h>
+#include <anki/util/Filesystem.h>
 
 namespace anki
 {
@@ -88,10 +89,70 @@ static Error identifyMetallicRoughnessTexture(
 	return Error::NONE;
 }
 
+Error GltfImporter::computeMaterialHash(const cgltf_material& mtl, U64& hash)
+{
+	hash = appendHash(MANIFEST_HASH_VERSION, m_texrpath.cstr(), m_texrpath.getLength(), m_optionsHash);
+
+	const cgltf_pbr_metallic_roughness& pbr = mtl.pbr_metallic_roughness;
+	const Array<F32, 9> factors = {{pbr.base_color_factor[0],
+		pbr.base_color_factor[1],
+		pbr.base_color_factor[2],
+		pbr.metallic_factor,
+		pbr.roughness_factor,
+		mtl.emissive_factor[0],
+		mtl.emissive_factor[1],
+		mtl.emissive_factor[2],
+		F32(mtl.has_pbr_metallic_roughness)}};
+	hash = appendHash(MANIFEST_HASH_VERSION, &factors[0], sizeof(factors), hash);
+
+	const Array<const cgltf_texture_view*, 4> views = {
+		{&pbr.base_color_texture, &pbr.metallic_roughness_texture, &mtl.normal_texture, &mtl.emissive_texture}};
+	for(const cgltf_texture_view* view : views)
+	{
+		const CString uri = (view->texture) ? getTextureUri(*view) : "-";
+		hash = appendHash(MANIFEST_HASH_VERSION, uri.cstr(), uri.getLength() + 1, hash);
+	}
+
+	// The importer reads the metallic roughness texture so the material changes with it
+	if(pbr.metallic_roughness_texture.texture)
+	{
+		Array<U32, 6> time;
+		ANKI_CHECK(getFileModificationTime(
+			getTextureUri(pbr.metallic_roughness_texture), time[0], time[1], time[2], time[3], time[4], time[5]));
+		hash = appendHash(MANIFEST_HASH_VERSION, &time[0], sizeof(time), hash);
+	}
+
+	cgltf_size extrasSize;
+	cgltf_copy_extras_json(m_gltf, &mtl.extras, nullptr, &extrasSize);
+	if(extrasSize > 0)
+	{
+		DynamicArrayAuto<char, PtrSize> json(m_alloc);
+		json.create(extrasSize);
+		if(cgltf_copy_extras_json(m_gltf, &mtl.extras, &json[0], &extrasSize) != cgltf_result_success)
+		{
+			ANKI_GLTF_LOGE("cgltf_copy_extras_json failed");
+			return Error::FUNCTION_FAILED;
+		}
+
+		hash = appendHash(MANIFEST_HASH_VERSION, &json[0], json.getSize(), hash);
+	}
+
+	return Error::NONE;
+}
+
 Error GltfImporter::writeMaterial(const cgltf_material& mtl)
 {
 	StringAuto fname(m_alloc);
 	fname.sprintf("%s%s.ankimtl", m_outDir.cstr(), mtl.name);
+
+	U64 inputHash;
+	ANKI_CHECK(computeMaterialHash(mtl, inputHash));
+	if(!outputChanged(fname.toCString(), inputHash))
+	{
+		ANKI_GLTF_LOGI("Skipping unchanged material %s", fname.cstr());
+		return Error::NONE;
+	}
+
 	ANKI_GLTF_LOGI("Importing material %s", fname.cstr());
 
 	if(!mtl.has_pbr_metallic_roughness)
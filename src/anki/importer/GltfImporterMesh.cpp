@@ -8,6 +8,7 @@
 #include <anki/collision/Plane.h>
 #include <anki/collision/Functions.h>
 #include <anki/resource/MeshLoader.h>
+#include <anki/resource/MeshCompression.h>
 #include <meshoptimizer/meshoptimizer.h>
 
 namespace anki
@@ -215,11 +216,13 @@ static void optimizeSubmesh(SubMesh& submesh, GenericMemoryPoolAllocator<U8> all
 }
 
 /// Decimate a submesh using meshoptimizer.
-static void decimateSubmesh(F32 factor, SubMesh& submesh, GenericMemoryPoolAllocator<U8> alloc)
+/// @param factor The fraction of the triangles to keep. Zero to remove as many as maxError allows.
+/// @param maxError The max distance the surface can move, relative to the size of the submesh.
+static void decimateSubmesh(F32 factor, F32 maxError, SubMesh& submesh, GenericMemoryPoolAllocator<U8> alloc)
 {
-	ANKI_ASSERT(factor > 0.0f && factor < 1.0f);
+	ANKI_ASSERT(factor >= 0.0f && factor < 1.0f && maxError > 0.0f);
 	const PtrSize targetIndexCount = PtrSize(F32(submesh.m_indices.getSize() / 3) * factor) * 3;
-	if(targetIndexCount == 0)
+	if(targetIndexCount == 0 && factor > 0.0f)
 	{
 		return;
 	}
@@ -233,7 +236,7 @@ static void decimateSubmesh(F32 factor, SubMesh& submesh, GenericMemoryPoolAlloc
 		submesh.m_verts.getSize(),
 		sizeof(TempVertex),
 		targetIndexCount,
-		1e-2f)));
+		maxError)));
 
 	// Re-pack
 	DynamicArrayAuto<U32> reindexedIndices(alloc);
@@ -265,13 +268,293 @@ static void decimateSubmesh(F32 factor, SubMesh& submesh, GenericMemoryPoolAlloc
 	submesh.m_verts = std::move(newVerts);
 }
 
-Error GltfImporter::writeMesh(const cgltf_mesh& mesh, CString nameOverride, F32 decimateFactor)
+static void computeMeshletBounds(const SubMesh& submesh,
+	U32 firstVertex,
+	ConstWeakArray<U32> meshletVertices,
+	ConstWeakArray<U32> meshletPrimitives,
+	GenericMemoryPoolAllocator<U8> alloc,
+	MeshBinaryFile::Meshlet& meshlet)
+{
+	auto getPosition = [&](U32 localIdx) -> Vec3 {
+		return submesh.m_verts[meshletVertices[meshlet.m_firstVertex + localIdx] - firstVertex].m_position;
+	};
+
+	// Bounding sphere around the center of the AABB
+	Vec3 aabbMin(MAX_F32);
+	Vec3 aabbMax(MIN_F32);
+	for(U32 i = 0; i < meshlet.m_vertexCount; ++i)
+	{
+		aabbMin = aabbMin.min(getPosition(i));
+		aabbMax = aabbMax.max(getPosition(i));
+	}
+
+	meshlet.m_sphereCenter = (aabbMin + aabbMax) / 2.0f;
+	meshlet.m_sphereRadius = 0.0f;
+	for(U32 i = 0; i < meshlet.m_vertexCount; ++i)
+	{
+		meshlet.m_sphereRadius = max(meshlet.m_sphereRadius, (getPosition(i) - meshlet.m_sphereCenter).getLength());
+	}
+
+	// Normal cone. The axis is the average of the triangle normals and the cutoff the sine of the cone's angle
+	Vec3 axis(0.0f);
+	DynamicArrayAuto<Vec3> normals(alloc);
+	normals.create(meshlet.m_primitiveCount);
+	for(U32 i = 0; i < meshlet.m_primitiveCount; ++i)
+	{
+		const U32 prim = meshletPrimitives[meshlet.m_firstPrimitive + i];
+		const Vec3 v0 = getPosition(prim & 0xFF);
+		const Vec3 v1 = getPosition((prim >> 8) & 0xFF);
+		const Vec3 v2 = getPosition((prim >> 16) & 0xFF);
+
+		const Vec3 n = (v1 - v0).cross(v2 - v0);
+		const F32 length = n.getLength();
+		normals[i] = (length > EPSILON) ? n / length : Vec3(0.0f);
+		axis += normals[i];
+	}
+
+	meshlet.m_coneCutoff = 1.0f; // Never cull
+	meshlet.m_coneAxis = Vec3(0.0f, 0.0f, 1.0f);
+	const F32 axisLength = axis.getLength();
+	if(axisLength > EPSILON)
+	{
+		meshlet.m_coneAxis = axis / axisLength;
+
+		F32 minDot = 1.0f;
+		for(const Vec3& n : normals)
+		{
+			minDot = min(minDot, n.dot(meshlet.m_coneAxis));
+		}
+
+		// Wider than a hemisphere can't be culled
+		if(minDot > 0.0f)
+		{
+			meshlet.m_coneCutoff = sqrt(1.0f - minDot * minDot);
+		}
+	}
+}
+
+/// Split the triangles of a submesh into meshlets. A meshlet grows with the neighbouring triangle that adds the fewest
+/// vertices to it so the meshlets are compact and their bounds tight. The meshlet vertices point to the vertices of all
+/// the submeshes so firstVertex is the offset of the submesh's vertices.
+static void generateMeshlets(const SubMesh& submesh,
+	U32 firstVertex,
+	DynamicArrayAuto<MeshBinaryFile::Meshlet>& meshlets,
+	DynamicArrayAuto<U32>& meshletVertices,
+	DynamicArrayAuto<U32>& meshletPrimitives,
+	GenericMemoryPoolAllocator<U8> alloc)
+{
+	const U32 firstMeshlet = meshlets.getSize();
+	const U32 triCount = submesh.m_indices.getSize() / 3;
+	const U32 vertCount = submesh.m_verts.getSize();
+
+	// Gather the triangles of every vertex
+	DynamicArrayAuto<U32> vertTriOffsets(alloc, vertCount + 1, 0);
+	for(U32 idx : submesh.m_indices)
+	{
+		++vertTriOffsets[idx + 1];
+	}
+
+	for(U32 v = 0; v < vertCount; ++v)
+	{
+		vertTriOffsets[v + 1] += vertTriOffsets[v];
+	}
+
+	DynamicArrayAuto<U32> vertTris(alloc, submesh.m_indices.getSize(), 0);
+	DynamicArrayAuto<U32> vertTriCounts(alloc, vertCount, 0);
+	for(U32 i = 0; i < submesh.m_indices.getSize(); ++i)
+	{
+		const U32 idx = submesh.m_indices[i];
+		vertTris[vertTriOffsets[idx] + vertTriCounts[idx]++] = i / 3;
+	}
+
+	DynamicArrayAuto<Bool> emitted(alloc, triCount, false);
+	DynamicArrayAuto<U32> localIndices(alloc, vertCount, MAX_U32); // The index in the current meshlet
+	MeshBinaryFile::Meshlet* crntMeshlet = nullptr;
+	U32 nextTri = 0; // All the triangles before it are emitted
+
+	// Degenerate triangles count their vertices twice but that's only conservative
+	auto getNewVertexCount = [&](U32 tri) -> U32 {
+		U32 count = 0;
+		for(U32 i = 0; i < 3; ++i)
+		{
+			count += (localIndices[submesh.m_indices[tri * 3 + i]] == MAX_U32) ? 1 : 0;
+		}
+		return count;
+	};
+
+	auto fits = [&](U32 newVertexCount) -> Bool {
+		const Bool verticesFit = crntMeshlet->m_vertexCount + newVertexCount <= MeshBinaryFile::MAX_MESHLET_VERTICES;
+		return verticesFit && crntMeshlet->m_primitiveCount < MeshBinaryFile::MAX_MESHLET_PRIMITIVES;
+	};
+
+	for(U32 emittedCount = 0; emittedCount < triCount; ++emittedCount)
+	{
+		// Find the neighbour that adds the fewest vertices
+		U32 bestTri = MAX_U32;
+		U32 bestNewVertexCount = MAX_U32;
+		for(U32 v = 0; crntMeshlet && v < crntMeshlet->m_vertexCount && bestNewVertexCount > 0; ++v)
+		{
+			const U32 idx = meshletVertices[crntMeshlet->m_firstVertex + v] - firstVertex;
+			for(U32 t = vertTriOffsets[idx]; t < vertTriOffsets[idx + 1]; ++t)
+			{
+				const U32 tri = vertTris[t];
+				const U32 newVertexCount = (emitted[tri]) ? MAX_U32 : getNewVertexCount(tri);
+				if(newVertexCount < bestNewVertexCount && fits(newVertexCount))
+				{
+					bestTri = tri;
+					bestNewVertexCount = newVertexCount;
+				}
+			}
+		}
+
+		// No neighbour fits, continue with the triangles in the order they are
+		if(bestTri == MAX_U32)
+		{
+			while(emitted[nextTri])
+			{
+				++nextTri;
+			}
+
+			bestTri = nextTri;
+		}
+
+		// Start a new meshlet if the triangle doesn't fit
+		if(!crntMeshlet || !fits(getNewVertexCount(bestTri)))
+		{
+			for(U32 v = 0; crntMeshlet && v < crntMeshlet->m_vertexCount; ++v)
+			{
+				localIndices[meshletVertices[crntMeshlet->m_firstVertex + v] - firstVertex] = MAX_U32;
+			}
+
+			MeshBinaryFile::Meshlet meshlet = {};
+			meshlet.m_firstVertex = meshletVertices.getSize();
+			meshlet.m_firstPrimitive = meshletPrimitives.getSize();
+			meshlets.emplaceBack(meshlet);
+			crntMeshlet = &meshlets.getBack();
+		}
+
+		// Add the triangle
+		U32 packed = 0;
+		for(U32 i = 0; i < 3; ++i)
+		{
+			const U32 idx = submesh.m_indices[bestTri * 3 + i];
+			if(localIndices[idx] == MAX_U32)
+			{
+				localIndices[idx] = crntMeshlet->m_vertexCount++;
+				meshletVertices.emplaceBack(idx + firstVertex);
+			}
+
+			packed |= localIndices[idx] << (i * 8);
+		}
+
+		meshletPrimitives.emplaceBack(packed);
+		++crntMeshlet->m_primitiveCount;
+		emitted[bestTri] = true;
+	}
+
+	for(U32 i = firstMeshlet; i < meshlets.getSize(); ++i)
+	{
+		computeMeshletBounds(submesh, firstVertex, meshletVertices, meshletPrimitives, alloc, meshlets[i]);
+	}
+}
+
+U64 GltfImporter::appendAccessorHash(const cgltf_accessor& accessor, U64 hash)
+{
+	const Array<U64, 3> desc = {{U64(accessor.component_type), U64(accessor.type), U64(accessor.count)}};
+	hash = appendHash(MANIFEST_HASH_VERSION, &desc[0], sizeof(desc), hash);
+	if(accessor.count == 0 || accessor.buffer_view == nullptr)
+	{
+		return hash;
+	}
+
+	const U8* base =
+		static_cast<const U8*>(accessor.buffer_view->buffer->data) + accessor.offset + accessor.buffer_view->offset;
+
+	PtrSize stride = accessor.buffer_view->stride;
+	if(stride == 0)
+	{
+		stride = accessor.stride;
+	}
+
+	// Hash the bytes between the elements as well. They are few and it's faster than hashing each element
+	const PtrSize size = stride * (accessor.count - 1) + accessor.stride;
+	return appendHash(MANIFEST_HASH_VERSION, base, size, hash);
+}
+
+U64 GltfImporter::computeMeshHash(const cgltf_mesh& mesh, F32 decimateFactor, F32 maxError) const
+{
+	const Array<F32, 2> simplification = {{decimateFactor, maxError}};
+	U64 hash = appendHash(MANIFEST_HASH_VERSION, &simplification[0], sizeof(simplification), m_optionsHash);
+
+	for(const cgltf_primitive* primitive = mesh.primitives; primitive < mesh.primitives + mesh.primitives_count;
+		++primitive)
+	{
+		hash = appendHash(MANIFEST_HASH_VERSION, &primitive->type, sizeof(primitive->type), hash);
+
+		for(const cgltf_attribute* attrib = primitive->attributes;
+			attrib < primitive->attributes + primitive->attributes_count;
+			++attrib)
+		{
+			hash = appendHash(MANIFEST_HASH_VERSION, &attrib->type, sizeof(attrib->type), hash);
+			if(attrib->name)
+			{
+				hash = appendHash(MANIFEST_HASH_VERSION, attrib->name, strlen(attrib->name), hash);
+			}
+
+			hash = appendAccessorHash(*attrib->data, hash);
+		}
+
+		if(primitive->indices)
+		{
+			hash = appendAccessorHash(*primitive->indices, hash);
+		}
+	}
+
+	return hash;
+}
+
+void GltfImporter::getLodSimplification(U32 lod, F32& decimateFactor, F32& maxError) const
+{
+	ANKI_ASSERT(lod > 0 && lod < m_lodCount);
+	if(m_lodError > 0.0f)
+	{
+		// Remove as many triangles as the error allows. Every LOD allows 4 times the error of the previous
+		decimateFactor = 0.0f;
+		maxError = LOD_BASE_ERROR * F32(1u << (2u * (lod - 1u)));
+	}
+	else
+	{
+		decimateFactor = 1.0f - m_lodFactor * F32(lod);
+		maxError = DECIMATE_MAX_ERROR;
+	}
+}
+
+F32 GltfImporter::computeLodScreenSize(U32 lod) const
+{
+	ANKI_ASSERT(m_lodError > 0.0f);
+
+	// The surface of the LOD is less than maxError times the size of the mesh away from the original. Switch to the LOD
+	// when that distance is less than m_lodError of the screen height
+	F32 decimateFactor, maxError;
+	getLodSimplification(lod, decimateFactor, maxError);
+	return min(1.0f, m_lodError / maxError);
+}
+
+Error GltfImporter::writeMesh(const cgltf_mesh& mesh, CString nameOverride, F32 decimateFactor, F32 maxError)
 {
 	StringAuto fname(m_alloc);
 	fname.sprintf("%s%s.ankimesh", m_outDir.cstr(), (nameOverride.isEmpty()) ? mesh.name : nameOverride.cstr());
-	ANKI_GLTF_LOGI("Importing mesh (%s, decimate factor %f): %s",
+
+	if(!outputChanged(fname.toCString(), computeMeshHash(mesh, decimateFactor, maxError)))
+	{
+		ANKI_GLTF_LOGI("Skipping unchanged mesh %s", fname.cstr());
+		return Error::NONE;
+	}
+
+	ANKI_GLTF_LOGI("Importing mesh (%s, decimate factor %f, max error %f): %s",
 		(m_optimizeMeshes) ? "optimze" : "WON'T optimize",
 		decimateFactor,
+		maxError,
 		fname.cstr());
 
 	ListAuto<SubMesh> submeshes(m_alloc);
@@ -544,7 +827,7 @@ Error GltfImporter::writeMesh(const cgltf_mesh& mesh, CString nameOverride, F32
 		// Simplify
 		if(decimateFactor < 1.0f)
 		{
-			decimateSubmesh(decimateFactor, submesh, m_alloc);
+			decimateSubmesh(decimateFactor, maxError, submesh, m_alloc);
 		}
 
 		// Finalize
@@ -703,10 +986,23 @@ Error GltfImporter::writeMesh(const cgltf_mesh& mesh, CString nameOverride, F32
 		}
 	}
 
+	// Split the triangles into meshlets for the mesh shaders
+	DynamicArrayAuto<MeshBinaryFile::Meshlet> meshlets(m_alloc);
+	DynamicArrayAuto<U32> meshletVertices(m_alloc);
+	DynamicArrayAuto<U32> meshletPrimitives(m_alloc);
+	{
+		U32 firstVertex = 0;
+		for(const SubMesh& submesh : submeshes)
+		{
+			generateMeshlets(submesh, firstVertex, meshlets, meshletVertices, meshletPrimitives, m_alloc);
+			firstVertex += submesh.m_verts.getSize();
+		}
+	}
+
 	// Write some other header stuff
 	{
 		memcpy(&header.m_magic[0], MeshBinaryFile::MAGIC, 8);
-		header.m_flags = MeshBinaryFile::Flag::NONE;
+		header.m_flags = MeshBinaryFile::Flag::MESHLETS | MeshBinaryFile::Flag::COMPRESSED;
 		if(convex)
 		{
 			header.m_flags |= MeshBinaryFile::Flag::CONVEX;
@@ -717,152 +1013,166 @@ Error GltfImporter::writeMesh(const cgltf_mesh& mesh, CString nameOverride, F32
 		header.m_subMeshCount = U32(submeshes.getSize());
 		header.m_aabbMin = aabbMin;
 		header.m_aabbMax = aabbMax;
-	}
-
-	// Open file
-	File file;
-	ANKI_CHECK(file.open(fname.toCString(), FileOpenFlag::WRITE | FileOpenFlag::BINARY));
-
-	// Write header
-	ANKI_CHECK(file.write(&header, sizeof(header)));
-
-	// Write sub meshes
-	for(const SubMesh& in : submeshes)
-	{
-		MeshBinaryFile::SubMesh out;
-		out.m_firstIndex = in.m_firstIdx;
-		out.m_indexCount = in.m_idxCount;
-		out.m_aabbMin = in.m_aabbMin;
-		out.m_aabbMax = in.m_aabbMax;
 
-		ANKI_CHECK(file.write(&out, sizeof(out)));
+		header.m_vertexEncodings[VertexAttributeLocation::POSITION] =
+			MeshBinaryFile::VertexEncoding::QUANTIZED_POSITION;
+		header.m_vertexEncodings[VertexAttributeLocation::NORMAL] = MeshBinaryFile::VertexEncoding::OCTAHEDRAL;
+		header.m_vertexEncodings[VertexAttributeLocation::TANGENT] = MeshBinaryFile::VertexEncoding::OCTAHEDRAL_SIGNED;
 	}
 
-	// Write indices
-	for(const SubMesh& submesh : submeshes)
+	// Compress the indices
+	DynamicArrayAuto<U8, PtrSize> compressedIndices(m_alloc);
 	{
-		DynamicArrayAuto<U16> indices(m_alloc);
-		indices.create(submesh.m_indices.getSize());
+		DynamicArrayAuto<U32> indices(m_alloc);
+		indices.create(totalIndexCount);
+		U32 idxCount = 0;
 		U32 vertCount = 0;
-		for(U32 i = 0; i < indices.getSize(); ++i)
+		for(const SubMesh& submesh : submeshes)
 		{
-			const U32 idx = submesh.m_indices[i] + vertCount;
-			if(idx > MAX_U16)
+			for(U32 i = 0; i < submesh.m_indices.getSize(); ++i)
 			{
-				ANKI_GLTF_LOGE("Only supports 16bit indices for now");
-				return Error::USER_DATA;
+				const U32 idx = submesh.m_indices[i] + vertCount;
+				if(idx > MAX_U16)
+				{
+					ANKI_GLTF_LOGE("Only supports 16bit indices for now");
+					return Error::USER_DATA;
+				}
+
+				indices[idxCount++] = idx;
 			}
 
-			indices[i] = U16(idx);
+			vertCount += submesh.m_verts.getSize();
 		}
 
-		ANKI_CHECK(file.write(&indices[0], indices.getSizeInBytes()));
-		vertCount += submesh.m_verts.getSize();
+		ANKI_CHECK(compressMeshIndices(ConstWeakArray<U32>(indices), m_alloc, compressedIndices));
+		header.m_compressedIndexBufferSize = U32(compressedIndices.getSize());
 	}
 
-	// Write first vert buffer
-	for(const SubMesh& submesh : submeshes)
+	// Encode the vertex buffers. The attributes of a vertex are in VertexAttributeLocation order
+	Array<DynamicArrayAuto<U8, PtrSize>, 3> encodedVertBuffers = {{{m_alloc}, {m_alloc}, {m_alloc}}};
+	for(U32 i = 0; i < header.m_vertexBufferCount; ++i)
 	{
-		const MeshBinaryFile::VertexAttribute& posa = header.m_vertexAttributes[VertexAttributeLocation::POSITION];
-		if(posa.m_format == Format::R32G32B32_SFLOAT)
-		{
-			DynamicArrayAuto<Vec3> positions(m_alloc);
-			positions.create(submesh.m_verts.getSize());
-			for(U32 v = 0; v < submesh.m_verts.getSize(); ++v)
-			{
-				positions[v] = submesh.m_verts[v].m_position;
-			}
-			ANKI_CHECK(file.write(&positions[0], positions.getSizeInBytes()));
-		}
-		else if(posa.m_format == Format::R16G16B16A16_SFLOAT)
-		{
-			DynamicArrayAuto<HVec4> pos16(m_alloc);
-			pos16.create(submesh.m_verts.getSize());
-
-			for(U32 v = 0; v < submesh.m_verts.getSize(); ++v)
-			{
-				pos16[v] = HVec4(F16(submesh.m_verts[v].m_position.x()),
-					F16(submesh.m_verts[v].m_position.y()),
-					F16(submesh.m_verts[v].m_position.z()),
-					F16(0.0f));
-			}
-
-			ANKI_CHECK(file.write(&pos16[0], pos16.getSizeInBytes()));
-		}
-		else
-		{
-			ANKI_ASSERT(0);
-		}
+		encodedVertBuffers[i].create(PtrSize(MeshLoader::getEncodedVertexStride(header, i)) * totalVertexCount);
 	}
 
-	// Write the 2nd vert buffer
-	for(const SubMesh& submesh : submeshes)
 	{
-		struct Vert
+		const Vec3 aabbSize = aabbMax - aabbMin;
+		U8* positions = &encodedVertBuffers[0][0];
+		U8* attribs = &encodedVertBuffers[1][0];
+		U8* weights = (hasBoneWeights) ? &encodedVertBuffers[2][0] : nullptr;
+
+		for(const SubMesh& submesh : submeshes)
 		{
-			U32 m_n;
-			U32 m_t;
-			U16 m_uv[2];
-		};
+			for(const TempVertex& vert : submesh.m_verts)
+			{
+				// Position
+				const Vec3 normPos = ((vert.m_position - aabbMin) / aabbSize).max(Vec3(0.0f)).min(Vec3(1.0f));
+				const Array<U16, 3> qpos = {{U16(round(normPos.x() * F32(MAX_U16))),
+					U16(round(normPos.y() * F32(MAX_U16))),
+					U16(round(normPos.z() * F32(MAX_U16)))}};
+				memcpy(positions, &qpos[0], sizeof(qpos));
+				positions += sizeof(qpos);
+
+				// UV
+				U16 uv[2];
+				const Format uvfmt = header.m_vertexAttributes[VertexAttributeLocation::UV].m_format;
+				if(uvfmt == Format::R16G16_UNORM)
+				{
+					assert(vert.m_uv[0] <= 1.0 && vert.m_uv[0] >= 0.0 && vert.m_uv[1] <= 1.0 && vert.m_uv[1] >= 0.0);
+					uv[0] = U16(vert.m_uv[0] * 0xFFFF);
+					uv[1] = U16(vert.m_uv[1] * 0xFFFF);
+				}
+				else
+				{
+					ANKI_ASSERT(uvfmt == Format::R16G16_SFLOAT);
+					uv[0] = F16(vert.m_uv[0]).toU16();
+					uv[1] = F16(vert.m_uv[1]).toU16();
+				}
+				memcpy(attribs, &uv[0], sizeof(uv));
+				attribs += sizeof(uv);
 
-		DynamicArrayAuto<Vert> verts(m_alloc);
-		verts.create(submesh.m_verts.getSize());
+				// Normal
+				const Vec2 octNormal = octahedralEncode(vert.m_normal);
+				*attribs++ = U8(I8(round(octNormal.x() * 127.0f)));
+				*attribs++ = U8(I8(round(octNormal.y() * 127.0f)));
 
-		for(U32 i = 0; i < verts.getSize(); ++i)
-		{
-			const Vec3& normal = submesh.m_verts[i].m_normal;
-			const Vec4& tangent = submesh.m_verts[i].m_tangent;
-			const Vec2& uv = submesh.m_verts[i].m_uv;
+				// Tangent. The 2nd component has 7 bits and the sign of w
+				const Vec2 octTangent = octahedralEncode(vert.m_tangent.xyz());
+				*attribs++ = U8(I8(round(octTangent.x() * 127.0f)));
+				*attribs++ = U8((I32(round(octTangent.y() * 63.0f)) * 2) | ((vert.m_tangent.w() < 0.0f) ? 1 : 0));
 
-			verts[i].m_n = packColorToR10G10B10A2SNorm(normal.x(), normal.y(), normal.z(), 0.0f);
-			verts[i].m_t = packColorToR10G10B10A2SNorm(tangent.x(), tangent.y(), tangent.z(), tangent.w());
+				// Bone weights and then bone indices
+				if(weights)
+				{
+					for(U32 c = 0; c < 4; ++c)
+					{
+						*weights++ = U8(vert.m_boneWeights[c] * F32(MAX_U8));
+					}
 
-			const Format uvfmt = header.m_vertexAttributes[VertexAttributeLocation::UV].m_format;
-			if(uvfmt == Format::R16G16_UNORM)
-			{
-				assert(uv[0] <= 1.0 && uv[0] >= 0.0 && uv[1] <= 1.0 && uv[1] >= 0.0);
-				verts[i].m_uv[0] = U16(uv[0] * 0xFFFF);
-				verts[i].m_uv[1] = U16(uv[1] * 0xFFFF);
-			}
-			else if(uvfmt == Format::R16G16_SFLOAT)
-			{
-				verts[i].m_uv[0] = F16(uv[0]).toU16();
-				verts[i].m_uv[1] = F16(uv[1]).toU16();
-			}
-			else
-			{
-				ANKI_ASSERT(0);
+					for(U32 c = 0; c < 4; ++c)
+					{
+						const U16 boneIdx = U16(vert.m_boneIds[c]);
+						memcpy(weights, &boneIdx, sizeof(boneIdx));
+						weights += sizeof(boneIdx);
+					}
+				}
 			}
 		}
+	}
 
-		ANKI_CHECK(file.write(&verts[0], verts.getSizeInBytes()));
+	// Compress the vertex buffers
+	Array<DynamicArrayAuto<U8, PtrSize>, 3> compressedVertBuffers = {{{m_alloc}, {m_alloc}, {m_alloc}}};
+	for(U32 i = 0; i < header.m_vertexBufferCount; ++i)
+	{
+		ANKI_CHECK(compressMeshVertices(
+			ConstWeakArray<U8, PtrSize>(&encodedVertBuffers[i][0], encodedVertBuffers[i].getSize()),
+			MeshLoader::getEncodedVertexStride(header, i),
+			m_alloc,
+			compressedVertBuffers[i]));
+		header.m_compressedVertexBufferSizes[i] = U32(compressedVertBuffers[i].getSize());
 	}
 
-	// Write 3rd vert buffer
-	if(hasBoneWeights)
+	// Open file
+	File file;
+	ANKI_CHECK(file.open(fname.toCString(), FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+
+	// Write header
+	ANKI_CHECK(file.write(&header, sizeof(header)));
+
+	// Write sub meshes
+	for(const SubMesh& in : submeshes)
 	{
-		for(const SubMesh& submesh : submeshes)
-		{
-			DynamicArrayAuto<WeightVertex> verts(m_alloc);
-			verts.create(submesh.m_verts.getSize());
+		MeshBinaryFile::SubMesh out;
+		out.m_firstIndex = in.m_firstIdx;
+		out.m_indexCount = in.m_idxCount;
+		out.m_aabbMin = in.m_aabbMin;
+		out.m_aabbMax = in.m_aabbMax;
 
-			for(U32 i = 0; i < verts.getSize(); ++i)
-			{
-				WeightVertex vert;
+		ANKI_CHECK(file.write(&out, sizeof(out)));
+	}
 
-				for(U32 c = 0; c < 4; ++c)
-				{
-					vert.m_boneIndices[c] = submesh.m_verts[i].m_boneIds[c];
-					vert.m_weights[c] = U8(submesh.m_verts[i].m_boneWeights[c] * F32(MAX_U8));
-				}
+	// Write the meshlet counts
+	{
+		MeshBinaryFile::MeshletsHeader meshletsHeader;
+		meshletsHeader.m_meshletCount = meshlets.getSize();
+		meshletsHeader.m_meshletVertexCount = meshletVertices.getSize();
+		meshletsHeader.m_meshletPrimitiveCount = meshletPrimitives.getSize();
 
-				verts[i] = vert;
-			}
+		ANKI_CHECK(file.write(&meshletsHeader, sizeof(meshletsHeader)));
+	}
 
-			ANKI_CHECK(file.write(&verts[0], verts.getSizeInBytes()));
-		}
+	// Write indices and vertices
+	ANKI_CHECK(file.write(&compressedIndices[0], compressedIndices.getSize()));
+	for(U32 i = 0; i < header.m_vertexBufferCount; ++i)
+	{
+		ANKI_CHECK(file.write(&compressedVertBuffers[i][0], compressedVertBuffers[i].getSize()));
 	}
 
+	// Write the meshlets
+	ANKI_CHECK(file.write(&meshlets[0], meshlets.getSizeInBytes()));
+	ANKI_CHECK(file.write(&meshletVertices[0], meshletVertices.getSizeInBytes()));
+	ANKI_CHECK(file.write(&meshletPrimitives[0], meshletPrimitives.getSizeInBytes()));
+
 	return Error::NONE;
 }
 
@@ -0,0 +1,410 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/importer/GltfImporter.h>
+#include <anki/resource/ImageLoader.h>
+#include <anki/util/Filesystem.h>
+
+namespace anki
+{
+
+/// The biggest texture that ImageLoader accepts.
+constexpr U32 MAX_TEXTURE_SIZE = 4096;
+
+static U16 packRgb565(const Array<I32, 3>& color)
+{
+	return U16(((color[0] >> 3) << 11) | ((color[1] >> 2) << 5) | (color[2] >> 3));
+}
+
+static Array<I32, 3> unpackRgb565(U16 color)
+{
+	const I32 r = (color >> 11) & 31;
+	const I32 g = (color >> 5) & 63;
+	const I32 b = color & 31;
+	return {{(r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2)}};
+}
+
+/// Compress the color of a 4x4 block to BC1. The endpoints are the corners of the bounding box of the colors, inset a
+/// bit since the extremes are rarely hit.
+static void compressBc1Block(const Array<U8Vec4, 16>& pixels, U8* out)
+{
+	Array<I32, 3> minColor = {{255, 255, 255}};
+	Array<I32, 3> maxColor = {{0, 0, 0}};
+	for(const U8Vec4& pixel : pixels)
+	{
+		for(U32 c = 0; c < 3; ++c)
+		{
+			minColor[c] = min<I32>(minColor[c], pixel[c]);
+			maxColor[c] = max<I32>(maxColor[c], pixel[c]);
+		}
+	}
+
+	for(U32 c = 0; c < 3; ++c)
+	{
+		const I32 inset = (maxColor[c] - minColor[c]) >> 4;
+		minColor[c] += inset;
+		maxColor[c] -= inset;
+	}
+
+	// The first endpoint has to be the bigger for the mode with the 4 colors
+	U16 endpoint0 = packRgb565(maxColor);
+	U16 endpoint1 = packRgb565(minColor);
+	if(endpoint0 < endpoint1)
+	{
+		std::swap(endpoint0, endpoint1);
+	}
+
+	Array<Array<I32, 3>, 4> palette;
+	palette[0] = unpackRgb565(endpoint0);
+	palette[1] = unpackRgb565(endpoint1);
+	for(U32 c = 0; c < 3; ++c)
+	{
+		palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+		palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+	}
+
+	U32 indices = 0;
+	for(U32 i = 0; i < 16 && endpoint0 != endpoint1; ++i)
+	{
+		U32 bestIdx = 0;
+		I32 bestDist = MAX_I32;
+		for(U32 p = 0; p < 4; ++p)
+		{
+			I32 dist = 0;
+			for(U32 c = 0; c < 3; ++c)
+			{
+				const I32 diff = I32(pixels[i][c]) - palette[p][c];
+				dist += diff * diff;
+			}
+
+			if(dist < bestDist)
+			{
+				bestIdx = p;
+				bestDist = dist;
+			}
+		}
+
+		indices |= bestIdx << (i * 2);
+	}
+
+	memcpy(out, &endpoint0, sizeof(endpoint0));
+	memcpy(out + 2, &endpoint1, sizeof(endpoint1));
+	memcpy(out + 4, &indices, sizeof(indices));
+}
+
+/// Compress the alpha of a 4x4 block to the alpha part of BC3. It uses the mode with the 6 interpolated values.
+static void compressBc3AlphaBlock(const Array<U8Vec4, 16>& pixels, U8* out)
+{
+	U32 minAlpha = 255;
+	U32 maxAlpha = 0;
+	for(const U8Vec4& pixel : pixels)
+	{
+		minAlpha = min<U32>(minAlpha, pixel.w());
+		maxAlpha = max<U32>(maxAlpha, pixel.w());
+	}
+
+	Array<U32, 8> palette;
+	palette[0] = maxAlpha;
+	palette[1] = minAlpha;
+	for(U32 i = 2; i < 8; ++i)
+	{
+		palette[i] = ((8 - i) * maxAlpha + (i - 1) * minAlpha) / 7;
+	}
+
+	U64 indices = 0;
+	for(U32 i = 0; i < 16 && maxAlpha != minAlpha; ++i)
+	{
+		U32 bestIdx = 0;
+		for(U32 p = 1; p < 8; ++p)
+		{
+			if(absolute(I32(pixels[i].w()) - I32(palette[p])) < absolute(I32(pixels[i].w()) - I32(palette[bestIdx])))
+			{
+				bestIdx = p;
+			}
+		}
+
+		indices |= U64(bestIdx) << (i * 3);
+	}
+
+	out[0] = U8(maxAlpha);
+	out[1] = U8(minAlpha);
+	for(U32 i = 0; i < 6; ++i)
+	{
+		out[2 + i] = U8(indices >> (i * 8));
+	}
+}
+
+/// Compress an image to BC1 if it's RGB8 or to BC3 if it's RGBA8.
+static void compressS3tc(ConstWeakArray<U8Vec4> pixels,
+	U32 width,
+	U32 height,
+	ImageLoaderColorFormat colorFormat,
+	DynamicArrayAuto<U8, PtrSize>& out)
+{
+	const U32 blockSize = (colorFormat == ImageLoaderColorFormat::RGB8) ? 8 : 16;
+	out.resize(PtrSize(width / 4) * (height / 4) * blockSize);
+
+	U8* block = &out[0];
+	for(U32 blockY = 0; blockY < height / 4; ++blockY)
+	{
+		for(U32 blockX = 0; blockX < width / 4; ++blockX)
+		{
+			Array<U8Vec4, 16> blockPixels;
+			for(U32 i = 0; i < 16; ++i)
+			{
+				blockPixels[i] = pixels[(blockY * 4 + i / 4) * width + blockX * 4 + i % 4];
+			}
+
+			if(colorFormat == ImageLoaderColorFormat::RGBA8)
+			{
+				compressBc3AlphaBlock(blockPixels, block);
+				block += 8;
+			}
+
+			compressBc1Block(blockPixels, block);
+			block += 8;
+		}
+	}
+}
+
+/// Downscale an image to the half with a box filter. The normals are normalized again.
+static void generateMip(
+	ConstWeakArray<U8Vec4> src, U32 srcWidth, U32 srcHeight, Bool normal, DynamicArrayAuto<U8Vec4>& dst)
+{
+	const U32 width = srcWidth / 2;
+	const U32 height = srcHeight / 2;
+	dst.resize(width * height);
+
+	for(U32 y = 0; y < height; ++y)
+	{
+		for(U32 x = 0; x < width; ++x)
+		{
+			const U32 srcIdx = y * 2 * srcWidth + x * 2;
+			U8Vec4& pixel = dst[y * width + x];
+			for(U32 c = 0; c < 4; ++c)
+			{
+				const U32 sum = src[srcIdx][c] + src[srcIdx + 1][c] + src[srcIdx + srcWidth][c]
+								+ src[srcIdx + srcWidth + 1][c];
+				pixel[c] = U8((sum + 2) / 4);
+			}
+
+			if(normal)
+			{
+				Vec3 n(F32(pixel.x()), F32(pixel.y()), F32(pixel.z()));
+				n = n * (2.0f / 255.0f) - Vec3(1.0f);
+				const F32 length = n.getLength();
+				if(length > EPSILON)
+				{
+					n = (n / length + Vec3(1.0f)) * 127.5f;
+					for(U32 c = 0; c < 3; ++c)
+					{
+						pixel[c] = U8(clamp(n[c] + 0.5f, 0.0f, 255.0f));
+					}
+				}
+			}
+		}
+	}
+}
+
+/// The file of a processed texture. It's what the materials reference.
+static void getTextureFilename(CString outDir, CString uri, StringAuto& fname)
+{
+	fname.sprintf("%s%s", outDir.cstr(), uri.cstr());
+	fname.replaceAll(".tga", ".ankitex");
+	fname.replaceAll(".png", ".ankitex");
+	fname.replaceAll(".jpg", ".ankitex");
+	fname.replaceAll(".jpeg", ".ankitex");
+}
+
+Error GltfImporter::writeTextures()
+{
+	// Gather the textures of the materials. The normal maps are processed a bit differently
+	class Texture
+	{
+	public:
+		CString m_uri;
+		Bool m_normal;
+	};
+	DynamicArrayAuto<Texture> textures(m_alloc);
+
+	for(const cgltf_material* mtl = m_gltf->materials; mtl < m_gltf->materials + m_gltf->materials_count; ++mtl)
+	{
+		const Array<const cgltf_texture_view*, 4> views = {{&mtl->pbr_metallic_roughness.base_color_texture,
+			&mtl->pbr_metallic_roughness.metallic_roughness_texture,
+			&mtl->normal_texture,
+			&mtl->emissive_texture}};
+		for(const cgltf_texture_view* view : views)
+		{
+			if(!view->texture || !view->texture->image)
+			{
+				continue;
+			}
+
+			const CString uri = view->texture->image->uri;
+			if(uri.isEmpty())
+			{
+				ANKI_GLTF_LOGW("Skipping a texture embedded in the glTF file of material %s", mtl->name);
+				continue;
+			}
+
+			Bool found = false;
+			for(const Texture& tex : textures)
+			{
+				found = found || tex.m_uri == uri;
+			}
+
+			if(!found)
+			{
+				textures.emplaceBack(Texture{uri, view == &mtl->normal_texture});
+			}
+		}
+	}
+
+	for(const Texture& tex : textures)
+	{
+		// Create the directories of the texture here since the threads would race
+		for(PtrSize pos = tex.m_uri.find("/"); pos != CString::NPOS; pos = tex.m_uri.find("/", pos + 1))
+		{
+			StringAuto dir(m_alloc);
+			dir.sprintf("%s%.*s", m_outDir.cstr(), I32(pos), tex.m_uri.cstr());
+			if(!directoryExists(dir.toCString()))
+			{
+				ANKI_CHECK(createDirectory(dir.toCString()));
+			}
+		}
+
+		// Thread task
+		struct Ctx
+		{
+			GltfImporter* m_importer;
+			CString m_uri;
+			Bool m_normal;
+		};
+		Ctx* ctx = m_alloc.newInstance<Ctx>();
+		ctx->m_importer = this;
+		ctx->m_uri = tex.m_uri;
+		ctx->m_normal = tex.m_normal;
+
+		auto callback = [](void* userData, U32 threadId, ThreadHive& hive, ThreadHiveSemaphore* signalSemaphore) {
+			Ctx& self = *static_cast<Ctx*>(userData);
+
+			const Error err = self.m_importer->writeTexture(self.m_uri, self.m_normal);
+			if(err)
+			{
+				self.m_importer->m_errorInThread.store(err._getCode());
+			}
+
+			self.m_importer->m_alloc.deleteInstance(&self);
+		};
+
+		if(m_hive)
+		{
+			m_hive->submitTask(callback, ctx);
+		}
+		else
+		{
+			callback(ctx, 0, *m_hive, nullptr);
+		}
+	}
+
+	return Error::NONE;
+}
+
+Error GltfImporter::writeTexture(CString uri, Bool normal)
+{
+	StringAuto fname(m_alloc);
+	getTextureFilename(m_outDir.toCString(), uri, fname);
+
+	ImageLoader iloader(m_alloc);
+	ANKI_CHECK(iloader.load(uri));
+
+	const U32 width = iloader.getWidth();
+	const U32 height = iloader.getHeight();
+	if(!isPowerOfTwo(width) || !isPowerOfTwo(height) || min(width, height) < 4
+		|| max(width, height) > MAX_TEXTURE_SIZE)
+	{
+		ANKI_GLTF_LOGE(
+			"The size of the textures should be a power of two from 4 to %u: %s", MAX_TEXTURE_SIZE, uri.cstr());
+		return Error::USER_DATA;
+	}
+
+	// Convert to RGBA8 with the top row first. The rows of the TGAs are bottom up
+	StringAuto ext(m_alloc);
+	getFilepathExtension(uri, ext);
+	const Bool bottomUp = ext == "tga";
+	const Bool srcAlpha = iloader.getColorFormat() == ImageLoaderColorFormat::RGBA8;
+	const U32 srcPixelSize = (srcAlpha) ? 4 : 3;
+	const ConstWeakArray<U8> srcData = iloader.getSurface(0, 0, 0).getData();
+
+	DynamicArrayAuto<U8Vec4> pixels(m_alloc);
+	pixels.create(width * height);
+	Bool alpha = false;
+	for(U32 y = 0; y < height; ++y)
+	{
+		for(U32 x = 0; x < width; ++x)
+		{
+			const U8* src = &srcData[(((bottomUp) ? height - 1 - y : y) * width + x) * srcPixelSize];
+			U8Vec4& pixel = pixels[y * width + x];
+			pixel = U8Vec4(src[0], src[1], src[2], U8((srcAlpha) ? src[3] : 255));
+			alpha = alpha || pixel.w() < 255;
+		}
+	}
+
+	const ImageLoaderColorFormat colorFormat =
+		(alpha && !normal) ? ImageLoaderColorFormat::RGBA8 : ImageLoaderColorFormat::RGB8;
+
+	U64 hash = appendHash(MANIFEST_HASH_VERSION, &pixels[0], pixels.getSizeInBytes(), m_optionsHash);
+	const Array<U32, 4> desc = {{width, height, U32(colorFormat), U32(normal)}};
+	hash = appendHash(MANIFEST_HASH_VERSION, &desc[0], sizeof(desc), hash);
+	if(!outputChanged(fname.toCString(), hash))
+	{
+		ANKI_GLTF_LOGI("Skipping unchanged texture %s", fname.cstr());
+		return Error::NONE;
+	}
+
+	ANKI_GLTF_LOGI("Importing texture %s", fname.cstr());
+
+	// The mips go down to 4x4 like convert_image.py
+	U32 mipCount = 1;
+	while((width >> mipCount) >= 4 && (height >> mipCount) >= 4)
+	{
+		++mipCount;
+	}
+
+	AnkiTextureHeader header = {};
+	memcpy(&header.m_magic[0], "ANKITEX1", sizeof(header.m_magic));
+	header.m_width = width;
+	header.m_height = height;
+	header.m_depthOrLayerCount = 1;
+	header.m_type = ImageLoaderTextureType::_2D;
+	header.m_colorFormat = colorFormat;
+	header.m_compressionFormats = ImageLoaderDataCompression::S3TC;
+	header.m_normal = normal;
+	header.m_mipCount = mipCount;
+
+	File file;
+	ANKI_CHECK(file.open(fname.toCString(), FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+	ANKI_CHECK(file.write(&header, sizeof(header)));
+
+	DynamicArrayAuto<U8Vec4> mipPixels(m_alloc);
+	DynamicArrayAuto<U8, PtrSize> blocks(m_alloc);
+	for(U32 mip = 0; mip < mipCount; ++mip)
+	{
+		const U32 mipWidth = width >> mip;
+		const U32 mipHeight = height >> mip;
+		if(mip > 0)
+		{
+			generateMip(pixels, mipWidth * 2, mipHeight * 2, normal, mipPixels);
+			std::swap(pixels, mipPixels);
+		}
+
+		compressS3tc(pixels, mipWidth, mipHeight, colorFormat, blocks);
+		ANKI_CHECK(file.write(&blocks[0], blocks.getSizeInBytes()));
+	}
+
+	return Error::NONE;
+}
+
+} // end namespace anki
@@ -80,6 +80,12 @@ public:
 	/// Populate the key and button with the new state
 	ANKI_USE_RESULT Error handleEvents();
 
+	/// Get the latest position of the mouse without handling the events. The events stay in the queue and the next
+	/// handleEvents() will process them as usual. It's used to late latch the camera right before the rendering.
+	/// @param[out] posNdc The position in NDC space.
+	/// @return False if it's not supported.
+	Bool peekLatestMousePosition(Vec2& posNdc);
+
 	/// Move the mouse cursor to a position inside the window. Useful for locking the cursor into a fixed location (eg
 	/// in the center of the screen)
 	void moveCursor(const Vec2& posNdc);
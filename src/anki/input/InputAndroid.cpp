@@ -54,6 +54,11 @@ void Input::init(NativeWindow* /*nativeWindow*/)
 	gAndroidApp->onAppCmd = handleAndroidEvents;
 }
 
+Bool Input::peekLatestMousePosition(Vec2& posNdc)
+{
+	return false;
+}
+
 void Input::moveCursor(const Vec2& posNdc)
 {
 	// do nothing
@@ -18,6 +18,11 @@ void Input::init(NativeWindow* nativeWindow)
 	// You are dummy... do nothing
 }
 
+Bool Input::peekLatestMousePosition(Vec2& posNdc)
+{
+	return false;
+}
+
 void Input::moveCursor(const Vec2& posNdc)
 {
 	// You are dummy... do nothing
@@ -380,6 +380,20 @@ Error Input::handleEvents()
 	return Error::NONE;
 }
 
+Bool Input::peekLatestMousePosition(Vec2& posNdc)
+{
+	ANKI_ASSERT(m_nativeWindow != nullptr);
+
+	// Pumping updates the state of the mouse and leaves the events in the queue
+	SDL_PumpEvents();
+	I32 x, y;
+	SDL_GetMouseState(&x, &y);
+
+	posNdc.x() = F32(x) / F32(m_nativeWindow->getWidth()) * 2.0f - 1.0f;
+	posNdc.y() = -(F32(y) / F32(m_nativeWindow->getHeight()) * 2.0f - 1.0f);
+	return true;
+}
+
 void Input::moveCursor(const Vec2& pos)
 {
 	if(pos != m_mousePosNdc)
@@ -15,71 +15,53 @@ union Val32
 	U32 u;
 };
 
+// NEON has F16 conversions on ARMv8 and on ARMv7 with the half precision extension
+#if ANKI_SIMD_NEON && (defined(__aarch64__) || (defined(__ARM_FP) && (__ARM_FP & 2)))
+#	define ANKI_NEON_F16 1
+#else
+#	define ANKI_NEON_F16 0
+#endif
+
 F16 F16::toF16(F32 f)
 {
-	F16 out;
+	// Same as what the hardware does: round to nearest even, overflow to infinity and keep the NaN payload
+	constexpr U32 F32_INFINITY = 255u << 23;
+	constexpr U32 F16_MAX_PLUS_HALF_ULP = (127u + 16u) << 23; // The smallest value that rounds to infinity
+	constexpr U32 F16_MIN_NORMAL = 113u << 23;
+	constexpr U32 DENORM_MAGIC = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+
 	Val32 v32;
 	v32.f = f;
-	I32 i = v32.i;
-	I32 s = (i >> 16) & 0x00008000;
-	I32 e = ((i >> 23) & 0x000000ff) - (127 - 15);
-	I32 m = i & 0x007fffff;
+	const U32 sign = v32.u & 0x80000000u;
+	U32 u = v32.u ^ sign;
 
-	if(e <= 0)
+	U32 out;
+	if(u >= F16_MAX_PLUS_HALF_ULP)
 	{
-		if(e < -10)
-		{
-			out.m_data = 0;
-		}
-		else
-		{
-			m = (m | 0x00800000) >> (1 - e);
-
-			if(m & 0x00001000)
-			{
-				m += 0x00002000;
-			}
-
-			out.m_data = U16(s | (m >> 13));
-		}
+		// Overflow, infinity or NaN
+		out = (u > F32_INFINITY) ? (0x7e00u | ((u >> 13) & 0x3ffu)) : 0x7c00u;
 	}
-	else if(e == 0xff - (127 - 15))
+	else if(u < F16_MIN_NORMAL)
 	{
-		if(m == 0)
-		{
-			out.m_data = U16(s | 0x7c00);
-		}
-		else
-		{
-			m >>= 13;
-			out.m_data = U16(s | 0x7c00 | m | (m == 0));
-		}
+		// Denormal or zero. Let the FPU do the rounding by adding a number that aligns the mantissa bits
+		Val32 magic;
+		magic.u = DENORM_MAGIC;
+		v32.u = u;
+		v32.f += magic.f;
+		out = v32.u - DENORM_MAGIC;
 	}
 	else
 	{
-		if(m & 0x00001000)
-		{
-			m += 0x00002000;
-
-			if(m & 0x00800000)
-			{
-				m = 0;
-				e += 1;
-			}
-		}
-
-		if(e > 30)
-		{
-			ANKI_ASSERT(0 && "Overflow");
-			out.m_data = U16(s | 0x7c00);
-		}
-		else
-		{
-			out.m_data = U16(s | (e << 10) | (m >> 13));
-		}
+		// Normal. Rebias the exponent and round
+		const U32 mantissaOdd = (u >> 13) & 1u;
+		u += (U32(15 - 127) << 23) + 0xfffu;
+		u += mantissaOdd;
+		out = u >> 13;
 	}
 
-	return out;
+	F16 h;
+	h.m_data = U16(out | (sign >> 16));
+	return h;
 }
 
 F32 F16::toF32(F16 h)
@@ -118,8 +100,9 @@ F32 F16::toF32(F16 h)
 		}
 		else
 		{
+			// NaN. Make it quiet like the hardware does
 			Val32 v32;
-			v32.i = (s << 31) | 0x7f800000 | (m << 13);
+			v32.i = (s << 31) | 0x7fc00000 | (m << 13);
 			return v32.f;
 		}
 	}
@@ -132,4 +115,66 @@ F32 F16::toF32(F16 h)
 	return v32.f;
 }
 
+void F16::convertArray(const F32* in, F16* out, PtrSize count)
+{
+	ANKI_ASSERT((in && out) || count == 0);
+	PtrSize i = 0;
+
+#if ANKI_SIMD_F16C
+	for(; i + 8 <= count; i += 8)
+	{
+		const __m256 f = _mm256_loadu_ps(in + i);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm256_cvtps_ph(f, _MM_FROUND_TO_NEAREST_INT));
+	}
+
+	for(; i + 4 <= count; i += 4)
+	{
+		const __m128 f = _mm_loadu_ps(in + i);
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(out + i), _mm_cvtps_ph(f, _MM_FROUND_TO_NEAREST_INT));
+	}
+#elif ANKI_NEON_F16
+	for(; i + 4 <= count; i += 4)
+	{
+		const float32x4_t f = vld1q_f32(in + i);
+		vst1_u16(reinterpret_cast<U16*>(out + i), vreinterpret_u16_f16(vcvt_f16_f32(f)));
+	}
+#endif
+
+	for(; i < count; ++i)
+	{
+		out[i] = toF16(in[i]);
+	}
+}
+
+void F16::convertArray(const F16* in, F32* out, PtrSize count)
+{
+	ANKI_ASSERT((in && out) || count == 0);
+	PtrSize i = 0;
+
+#if ANKI_SIMD_F16C
+	for(; i + 8 <= count; i += 8)
+	{
+		const __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+		_mm256_storeu_ps(out + i, _mm256_cvtph_ps(h));
+	}
+
+	for(; i + 4 <= count; i += 4)
+	{
+		const __m128i h = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(in + i));
+		_mm_storeu_ps(out + i, _mm_cvtph_ps(h));
+	}
+#elif ANKI_NEON_F16
+	for(; i + 4 <= count; i += 4)
+	{
+		const float16x4_t h = vreinterpret_f16_u16(vld1_u16(reinterpret_cast<const U16*>(in + i)));
+		vst1q_f32(out + i, vcvt_f32_f16(h));
+	}
+#endif
+
+	for(; i < count; ++i)
+	{
+		out[i] = toF32(in[i]);
+	}
+}
+
 } // end namespace anki
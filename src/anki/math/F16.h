@@ -185,6 +185,13 @@ public:
 	{
 		return m_data;
 	}
+
+	/// Convert an array of F32 to F16. It uses F16C or NEON if available. The rounding is round to nearest even and
+	/// the values that don't fit become infinity.
+	static void convertArray(const F32* in, F16* out, PtrSize count);
+
+	/// Convert an array of F16 to F32. It uses F16C or NEON if available.
+	static void convertArray(const F16* in, F32* out, PtrSize count);
 	/// @}
 
 private:
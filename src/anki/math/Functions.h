@@ -8,6 +8,7 @@
 #include <anki/util/Functions.h>
 #include <cmath>
 #include <cstdlib>
+#include <cstring>
 
 namespace anki
 {
@@ -188,6 +189,142 @@ inline Type cubicInterpolate(const Type& a, const Type& b, const Type& c, const
 	return (a0 * u * u2 + a1 * u2 + a2 * u + a3);
 }
 
+/// The precision of the fast math functions.
+enum class MathPrecision : U8
+{
+	FAST, ///< Cheapest. The error is in the order of 1e-3 to 1e-4.
+	MEDIUM, ///< Close to the F32 precision.
+	EXACT ///< Uses the standard library.
+};
+
+/// @name Fast math functions
+/// They are branchless polynomial approximations so loops that use them can be vectorized by the compiler. Their
+/// worst error per precision is tested in the tests.
+/// @{
+
+/// Fast reciprocal square root. FAST has 2e-3 relative error and MEDIUM 5e-6.
+template<MathPrecision PRECISION = MathPrecision::MEDIUM>
+inline F32 fastRsqrt(const F32 x)
+{
+	ANKI_ASSERT(x > 0.0f);
+	if(PRECISION == MathPrecision::EXACT)
+	{
+		return 1.0f / std::sqrt(x);
+	}
+
+	U32 i;
+	std::memcpy(&i, &x, sizeof(i));
+	i = 0x5F375A86u - (i >> 1u);
+	F32 y;
+	std::memcpy(&y, &i, sizeof(y));
+
+	// Newton-Raphson steps
+	const F32 halfX = 0.5f * x;
+	y = y * (1.5f - halfX * y * y);
+	if(PRECISION == MathPrecision::MEDIUM)
+	{
+		y = y * (1.5f - halfX * y * y);
+	}
+
+	return y;
+}
+
+/// Fast sine and cosine. FAST has 4e-4 absolute error and MEDIUM 2e-6 for angles in [-100, 100].
+template<MathPrecision PRECISION = MathPrecision::MEDIUM>
+inline void fastSinCos(const F32 rad, F32& sina, F32& cosa)
+{
+	if(PRECISION == MathPrecision::EXACT)
+	{
+		sina = std::sin(rad);
+		cosa = std::cos(rad);
+		return;
+	}
+
+	// Reduce to [-PI/4, PI/4] and find the quadrant. PI/2 is split in 3 parts to keep the precision
+	const F32 quadrantf = std::floor(rad * (2.0f / PI) + 0.5f);
+	const I32 quadrant = I32(quadrantf);
+	const F32 r = ((rad - quadrantf * 1.5703125f) - quadrantf * 4.837512969970703125e-4f)
+				  - quadrantf * 7.54978995489188216e-8f;
+	const F32 r2 = r * r;
+
+	F32 s, c;
+	if(PRECISION == MathPrecision::FAST)
+	{
+		s = r + r * r2 * (-1.0f / 6.0f + r2 * (1.0f / 120.0f));
+		c = 1.0f + r2 * (-0.5f + r2 * (1.0f / 24.0f));
+	}
+	else
+	{
+		s = r + r * r2 * (-1.6666654611e-1f + r2 * (8.3321608736e-3f + r2 * -1.9515295891e-4f));
+		c = 1.0f
+			+ r2 * (-0.5f + r2 * (4.166664568298827e-2f + r2 * (-1.388731625493765e-3f + r2 * 2.443315711809948e-5f)));
+	}
+
+	// Pick the right polynomial and sign per quadrant
+	const Bool swap = (quadrant & 1) != 0;
+	sina = swap ? c : s;
+	cosa = swap ? s : c;
+	sina = (quadrant & 2) ? -sina : sina;
+	cosa = ((quadrant + 1) & 2) ? -cosa : cosa;
+}
+
+/// Fast sine. See fastSinCos().
+template<MathPrecision PRECISION = MathPrecision::MEDIUM>
+inline F32 fastSin(const F32 rad)
+{
+	F32 s, c;
+	fastSinCos<PRECISION>(rad, s, c);
+	return s;
+}
+
+/// Fast cosine. See fastSinCos().
+template<MathPrecision PRECISION = MathPrecision::MEDIUM>
+inline F32 fastCos(const F32 rad)
+{
+	F32 s, c;
+	fastSinCos<PRECISION>(rad, s, c);
+	return c;
+}
+
+/// Fast e^x. FAST has 1e-4 relative error and MEDIUM 1e-6. The input of FAST and MEDIUM is clamped to [-87, 88] so it
+/// will never return zero or infinity.
+template<MathPrecision PRECISION = MathPrecision::MEDIUM>
+inline F32 fastExp(const F32 x)
+{
+	if(PRECISION == MathPrecision::EXACT)
+	{
+		return std::exp(x);
+	}
+
+	// e^x = 2^n * e^r where r is in [-ln(2)/2, ln(2)/2]. ln(2) is split in 2 parts to keep the precision
+	const F32 clamped = min(max(x, -87.0f), 88.0f);
+	const F32 nf = std::floor(clamped * 1.44269504088896341f + 0.5f);
+	const F32 r = (clamped - nf * 0.693359375f) + nf * 2.12194440e-4f;
+
+	F32 expR;
+	if(PRECISION == MathPrecision::FAST)
+	{
+		expR = 1.0f + r * (1.0f + r * (0.5f + r * (1.0f / 6.0f + r * (1.0f / 24.0f))));
+	}
+	else
+	{
+		F32 p = 1.9875691500e-4f;
+		p = p * r + 1.3981999507e-3f;
+		p = p * r + 8.3334519073e-3f;
+		p = p * r + 4.1665795894e-2f;
+		p = p * r + 1.6666665459e-1f;
+		p = p * r + 5.0000001201e-1f;
+		expR = 1.0f + r + r * r * p;
+	}
+
+	// Build 2^n from the exponent bits
+	const U32 bits = U32(I32(nf) + 127) << 23u;
+	F32 pow2n;
+	std::memcpy(&pow2n, &bits, sizeof(pow2n));
+	return expR * pow2n;
+}
+/// @}
+
 /// Pack 4 color components to R10G10B10A2 SNORM format.
 inline U32 packColorToR10G10B10A2SNorm(F32 r, F32 g, F32 b, F32 a)
 {
@@ -347,7 +347,7 @@ public:
 	ANKI_ENABLE_METHOD(J == 3 && I == 4)
 	explicit TMat(const TTransform<T>& t)
 	{
-		(*this) = TMat(t.getOrigin(), t.getRotation(), t.getScale());
+		(*this) = TMat(t.getOrigin().xyz(), t.getRotation().getRotationPart(), t.getScale());
 	}
 	/// @}
 
@@ -504,23 +504,46 @@ public:
 	TMat operator*(const TMat& b) const
 	{
 		TMat out;
+#if ANKI_SIMD_AVX2
+		// Compute 2 rows at a time. Every 128bit half of a 256bit register holds a row
+		const __m256 b0 = _mm256_broadcast_ps(&b.m_simd[0]);
+		const __m256 b1 = _mm256_broadcast_ps(&b.m_simd[1]);
+		const __m256 b2 = _mm256_broadcast_ps(&b.m_simd[2]);
+		const __m256 b3 = _mm256_broadcast_ps(&b.m_simd[3]);
+
+		for(U i = 0; i < 4; i += 2)
+		{
+			const __m256 a = _mm256_insertf128_ps(_mm256_castps128_ps256(m_simd[i]), m_simd[i + 1], 1);
+
+			__m256 t = _mm256_mul_ps(_mm256_shuffle_ps(a, a, 0x00), b0);
+#	if ANKI_SIMD_FMA
+			t = _mm256_fmadd_ps(_mm256_shuffle_ps(a, a, 0x55), b1, t);
+			t = _mm256_fmadd_ps(_mm256_shuffle_ps(a, a, 0xAA), b2, t);
+			t = _mm256_fmadd_ps(_mm256_shuffle_ps(a, a, 0xFF), b3, t);
+#	else
+			t = _mm256_add_ps(_mm256_mul_ps(_mm256_shuffle_ps(a, a, 0x55), b1), t);
+			t = _mm256_add_ps(_mm256_mul_ps(_mm256_shuffle_ps(a, a, 0xAA), b2), t);
+			t = _mm256_add_ps(_mm256_mul_ps(_mm256_shuffle_ps(a, a, 0xFF), b3), t);
+#	endif
+
+			out.m_simd[i] = _mm256_castps256_ps128(t);
+			out.m_simd[i + 1] = _mm256_extractf128_ps(t, 1);
+		}
+#else
 		const auto& m = *this;
 
 		for(U i = 0; i < 4; i++)
 		{
-			__m128 t1, t2;
-
-			t1 = _mm_set1_ps(m(i, 0));
-			t2 = _mm_mul_ps(b.m_simd[0], t1);
-			t1 = _mm_set1_ps(m(i, 1));
-			t2 = _mm_add_ps(_mm_mul_ps(b.m_simd[1], t1), t2);
-			t1 = _mm_set1_ps(m(i, 2));
-			t2 = _mm_add_ps(_mm_mul_ps(b.m_simd[2], t1), t2);
-			t1 = _mm_set1_ps(m(i, 3));
-			t2 = _mm_add_ps(_mm_mul_ps(b.m_simd[3], t1), t2);
-
-			out.m_simd[i] = t2;
+			__m128 t;
+
+			t = _mm_mul_ps(b.m_simd[0], _mm_set1_ps(m(i, 0)));
+			t = simdMulAdd(b.m_simd[1], _mm_set1_ps(m(i, 1)), t);
+			t = simdMulAdd(b.m_simd[2], _mm_set1_ps(m(i, 2)), t);
+			t = simdMulAdd(b.m_simd[3], _mm_set1_ps(m(i, 3)), t);
+
+			out.m_simd[i] = t;
 		}
+#endif
 
 		return out;
 	}
@@ -639,7 +662,7 @@ public:
 
 	/// @name Operators with other types
 	/// @{
-	ANKI_ENABLE_METHOD(!HAS_MAT3X4_SIMD)
+	ANKI_ENABLE_METHOD(!HAS_SIMD)
 	ColumnVec operator*(const RowVec& v) const
 	{
 		const TMat& m = *this;
@@ -666,6 +689,16 @@ public:
 		}
 		return out;
 	}
+
+	ANKI_ENABLE_METHOD(HAS_MAT4_SIMD)
+	ColumnVec operator*(const RowVec& v) const
+	{
+		// Multiply every row and then sum the products of every row with 2 horizontal adds
+		const __m128 v4 = v.getSimd();
+		const __m128 r01 = _mm_hadd_ps(_mm_mul_ps(m_simd[0], v4), _mm_mul_ps(m_simd[1], v4));
+		const __m128 r23 = _mm_hadd_ps(_mm_mul_ps(m_simd[2], v4), _mm_mul_ps(m_simd[3], v4));
+		return ColumnVec(_mm_hadd_ps(r01, r23));
+	}
 	/// @}
 
 	/// @name Other
@@ -1186,7 +1219,7 @@ public:
 	}
 
 	/// Invert using Cramer's rule
-	ANKI_ENABLE_METHOD(I == 4 && J == 4)
+	ANKI_ENABLE_METHOD(I == 4 && J == 4 && !HAS_MAT4_SIMD)
 	TMat getInverse() const
 	{
 		Array<T, 12> tmp;
@@ -1261,6 +1294,60 @@ public:
 		return m4;
 	}
 
+	/// Invert using the 2x2 block matrices method. The matrix is seen as [A B; C D] and the inverse is computed with the
+	/// adjugates of the sub matrices.
+	ANKI_ENABLE_METHOD(HAS_MAT4_SIMD)
+	TMat getInverse() const
+	{
+		// Sub matrices in row major order
+		const __m128 a = _mm_movelh_ps(m_simd[0], m_simd[1]);
+		const __m128 b = _mm_movehl_ps(m_simd[1], m_simd[0]);
+		const __m128 c = _mm_movelh_ps(m_simd[2], m_simd[3]);
+		const __m128 d = _mm_movehl_ps(m_simd[3], m_simd[2]);
+
+		// The determinants of the sub matrices (|A| |B| |C| |D|)
+		const __m128 detSub = _mm_sub_ps(
+			_mm_mul_ps(_mm_shuffle_ps(m_simd[0], m_simd[2], _MM_SHUFFLE(2, 0, 2, 0)),
+				_mm_shuffle_ps(m_simd[1], m_simd[3], _MM_SHUFFLE(3, 1, 3, 1))),
+			_mm_mul_ps(_mm_shuffle_ps(m_simd[0], m_simd[2], _MM_SHUFFLE(3, 1, 3, 1)),
+				_mm_shuffle_ps(m_simd[1], m_simd[3], _MM_SHUFFLE(2, 0, 2, 0))));
+		const __m128 detA = simdSwizzle<0, 0, 0, 0>(detSub);
+		const __m128 detB = simdSwizzle<1, 1, 1, 1>(detSub);
+		const __m128 detC = simdSwizzle<2, 2, 2, 2>(detSub);
+		const __m128 detD = simdSwizzle<3, 3, 3, 3>(detSub);
+
+		// Adj(D)*C and Adj(A)*B
+		const __m128 dc = mat2AdjMul(d, c);
+		const __m128 ab = mat2AdjMul(a, b);
+
+		// Adj(X) = |D|A - B(Adj(D)C) etc
+		__m128 x = _mm_sub_ps(_mm_mul_ps(detD, a), mat2Mul(b, dc));
+		__m128 w = _mm_sub_ps(_mm_mul_ps(detA, d), mat2Mul(c, ab));
+		__m128 y = _mm_sub_ps(_mm_mul_ps(detB, c), mat2MulAdj(d, ab));
+		__m128 z = _mm_sub_ps(_mm_mul_ps(detC, b), mat2MulAdj(a, dc));
+
+		// |M| = |A|*|D| + |B|*|C| - tr(Adj(A)B * Adj(D)C)
+		__m128 tr = _mm_mul_ps(ab, simdSwizzle<0, 2, 1, 3>(dc));
+		tr = _mm_hadd_ps(tr, tr);
+		tr = _mm_hadd_ps(tr, tr);
+		const __m128 detM = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), tr);
+
+		ANKI_ASSERT(!isZero<T>(_mm_cvtss_f32(detM))); // Cannot invert, det == 0
+		const __m128 invDetM = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), detM);
+		x = _mm_mul_ps(x, invDetM);
+		y = _mm_mul_ps(y, invDetM);
+		z = _mm_mul_ps(z, invDetM);
+		w = _mm_mul_ps(w, invDetM);
+
+		// Apply the adjugate and put the sub matrices back in place
+		TMat out;
+		out.m_simd[0] = _mm_shuffle_ps(x, y, _MM_SHUFFLE(1, 3, 1, 3));
+		out.m_simd[1] = _mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 2, 0, 2));
+		out.m_simd[2] = _mm_shuffle_ps(z, w, _MM_SHUFFLE(1, 3, 1, 3));
+		out.m_simd[3] = _mm_shuffle_ps(z, w, _MM_SHUFFLE(0, 2, 0, 2));
+		return out;
+	}
+
 	/// See getInverse
 	ANKI_ENABLE_METHOD((I == 4 && J == 4) || (I == 3 && J == 3))
 	void invert()
@@ -1336,24 +1423,117 @@ public:
 
 		for(U i = 0; i < 3; i++)
 		{
-			__m128 t1, t2;
-
-			t1 = _mm_set1_ps(a(i, 0));
-			t2 = _mm_mul_ps(b.m_simd[0], t1);
-			t1 = _mm_set1_ps(a(i, 1));
-			t2 = _mm_add_ps(_mm_mul_ps(b.m_simd[1], t1), t2);
-			t1 = _mm_set1_ps(a(i, 2));
-			t2 = _mm_add_ps(_mm_mul_ps(b.m_simd[2], t1), t2);
+			__m128 t;
 
-			TVec<T, 4> v4(0.0, 0.0, 0.0, a(i, 3));
-			t2 = _mm_add_ps(v4.getSimd(), t2);
+			t = _mm_setr_ps(0.0f, 0.0f, 0.0f, a(i, 3));
+			t = simdMulAdd(b.m_simd[0], _mm_set1_ps(a(i, 0)), t);
+			t = simdMulAdd(b.m_simd[1], _mm_set1_ps(a(i, 1)), t);
+			t = simdMulAdd(b.m_simd[2], _mm_set1_ps(a(i, 2)), t);
 
-			c.m_simd[i] = t2;
+			c.m_simd[i] = t;
 		}
 
 		return c;
 	}
 
+	/// Batched version of combineTransformations. It's the same as out[i] = a[i].combineTransformations(b[i]). The
+	/// output can alias one of the inputs.
+	ANKI_ENABLE_METHOD(J == 3 && I == 4 && !HAS_SIMD)
+	static void combineTransformations(const TMat* a, const TMat* b, TMat* out, PtrSize count)
+	{
+		for(PtrSize i = 0; i < count; ++i)
+		{
+			out[i] = a[i].combineTransformations(b[i]);
+		}
+	}
+
+	ANKI_ENABLE_METHOD(J == 3 && I == 4 && HAS_SIMD)
+	static void combineTransformations(const TMat* a, const TMat* b, TMat* out, PtrSize count)
+	{
+		PtrSize i = 0;
+#if ANKI_SIMD_AVX2
+		// 2 matrices at a time. The lower 128bits work on the 1st pair and the upper on the 2nd
+		for(; i + 2 <= count; i += 2)
+		{
+			const TMat& a0 = a[i];
+			const TMat& a1 = a[i + 1];
+
+			Array<__m256, 3> bRows;
+			for(U k = 0; k < 3; ++k)
+			{
+				bRows[k] = _mm256_insertf128_ps(_mm256_castps128_ps256(b[i].m_simd[k]), b[i + 1].m_simd[k], 1);
+			}
+
+			for(U r = 0; r < 3; ++r)
+			{
+				__m256 t = _mm256_setr_ps(0.0f, 0.0f, 0.0f, a0(r, 3), 0.0f, 0.0f, 0.0f, a1(r, 3));
+				for(U k = 0; k < 3; ++k)
+				{
+					const __m256 f = _mm256_insertf128_ps(
+						_mm256_castps128_ps256(_mm_set1_ps(a0(r, k))), _mm_set1_ps(a1(r, k)), 1);
+#	if ANKI_SIMD_FMA
+					t = _mm256_fmadd_ps(bRows[k], f, t);
+#	else
+					t = _mm256_add_ps(_mm256_mul_ps(bRows[k], f), t);
+#	endif
+				}
+
+				// Row r of a0 and a1 is not needed any more so it's safe to write it even if the output aliases a
+				out[i].m_simd[r] = _mm256_castps256_ps128(t);
+				out[i + 1].m_simd[r] = _mm256_extractf128_ps(t, 1);
+			}
+		}
+#endif
+
+		for(; i < count; ++i)
+		{
+			out[i] = a[i].combineTransformations(b[i]);
+		}
+	}
+
+	/// Batched version of combineTransformations that uses the same parent. It's the same as
+	/// out[i] = parent.combineTransformations(b[i]). The output can alias @a b.
+	ANKI_ENABLE_METHOD(J == 3 && I == 4 && !HAS_SIMD)
+	static void combineTransformations(const TMat& parent, const TMat* b, TMat* out, PtrSize count)
+	{
+		for(PtrSize i = 0; i < count; ++i)
+		{
+			out[i] = parent.combineTransformations(b[i]);
+		}
+	}
+
+	ANKI_ENABLE_METHOD(J == 3 && I == 4 && HAS_SIMD)
+	static void combineTransformations(const TMat& parent, const TMat* b, TMat* out, PtrSize count)
+	{
+		// Splat the parent once
+		Array2d<__m128, 3, 3> p;
+		Array<__m128, 3> translation;
+		for(U r = 0; r < 3; ++r)
+		{
+			for(U k = 0; k < 3; ++k)
+			{
+				p[r][k] = _mm_set1_ps(parent(r, k));
+			}
+
+			translation[r] = _mm_setr_ps(0.0f, 0.0f, 0.0f, parent(r, 3));
+		}
+
+		for(PtrSize i = 0; i < count; ++i)
+		{
+			const __m128 b0 = b[i].m_simd[0];
+			const __m128 b1 = b[i].m_simd[1];
+			const __m128 b2 = b[i].m_simd[2];
+
+			for(U r = 0; r < 3; ++r)
+			{
+				__m128 t = simdMulAdd(b0, p[r][0], translation[r]);
+				t = simdMulAdd(b1, p[r][1], t);
+				t = simdMulAdd(b2, p[r][2], t);
+				out[i].m_simd[r] = t;
+			}
+		}
+	}
+
 	/// Calculate a perspective projection matrix. The z is mapped in [0, 1] range just like DX and Vulkan.
 	ANKI_ENABLE_METHOD(I == 4 && J == 4)
 	static ANKI_USE_RESULT TMat calculatePerspectiveProjectionMatrix(T fovX, T fovY, T near, T far)
@@ -1565,6 +1745,35 @@ public:
 protected:
 	static constexpr U N = I * J;
 
+#if ANKI_SIMD_SSE
+	template<U X, U Y, U Z, U W>
+	static __m128 simdSwizzle(__m128 v)
+	{
+		return _mm_shuffle_ps(v, v, _MM_SHUFFLE(W, Z, Y, X));
+	}
+
+	/// 2x2 row major matrix multiply A*B.
+	static __m128 mat2Mul(__m128 a, __m128 b)
+	{
+		return _mm_add_ps(
+			_mm_mul_ps(a, simdSwizzle<0, 3, 0, 3>(b)), _mm_mul_ps(simdSwizzle<1, 0, 3, 2>(a), simdSwizzle<2, 1, 2, 1>(b)));
+	}
+
+	/// 2x2 row major matrix adjugate multiply Adj(A)*B.
+	static __m128 mat2AdjMul(__m128 a, __m128 b)
+	{
+		return _mm_sub_ps(
+			_mm_mul_ps(simdSwizzle<3, 3, 0, 0>(a), b), _mm_mul_ps(simdSwizzle<1, 1, 2, 2>(a), simdSwizzle<2, 3, 0, 1>(b)));
+	}
+
+	/// 2x2 row major matrix multiply adjugate A*Adj(B).
+	static __m128 mat2MulAdj(__m128 a, __m128 b)
+	{
+		return _mm_sub_ps(
+			_mm_mul_ps(a, simdSwizzle<3, 0, 3, 0>(b)), _mm_mul_ps(simdSwizzle<1, 0, 3, 2>(a), simdSwizzle<2, 1, 2, 1>(b)));
+	}
+#endif
+
 	/// @name Data members
 	/// @{
 	union
@@ -264,6 +264,16 @@ public:
 		return TQuat(sum);
 	}
 
+	/// Normalized linear interpolation between this and q1. It takes the shortest path like slerp() and it's a lot
+	/// cheaper but the angular speed is not constant. The difference from slerp() is negligible for close quaternions.
+	TQuat nlerp(const TQuat& q1, const T t) const
+	{
+		const T t1 = (this->dot(q1) < T(0)) ? -t : t;
+		TQuat out((*this) * (T(1) - t) + q1 * t1);
+		out.normalize();
+		return out;
+	}
+
 	/// @note 16 muls, 12 adds
 	TQuat combineRotations(const TQuat& b) const
 	{
@@ -9,6 +9,9 @@
 
 #if ANKI_SIMD_SSE
 #	include <smmintrin.h>
+#	if ANKI_SIMD_AVX2 || ANKI_SIMD_FMA || ANKI_SIMD_F16C
+#		include <immintrin.h>
+#	endif
 #elif ANKI_SIMD_NEON
 #	include <arm_neon.h>
 #elif !ANKI_SIMD_NONE
@@ -47,4 +50,16 @@ public:
 };
 #endif
 
+#if ANKI_SIMD_SSE
+/// Compute a * b + c. It's fused if ANKI_SIMD_FMA is enabled.
+inline __m128 simdMulAdd(__m128 a, __m128 b, __m128 c)
+{
+#	if ANKI_SIMD_FMA
+	return _mm_fmadd_ps(a, b, c);
+#	else
+	return _mm_add_ps(_mm_mul_ps(a, b), c);
+#	endif
+}
+#endif
+
 } // end namespace anki
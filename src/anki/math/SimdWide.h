@@ -0,0 +1,697 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/math/Simd.h>
+#include <anki/util/Array.h>
+#include <cmath>
+#include <cstring>
+
+namespace anki
+{
+
+/// @addtogroup math
+/// @{
+
+/// 4 F32 lanes that are processed in parallel. It's the building block of the SoA math types (see Vec3x4 etc). The
+/// comparison operators return masks (a lane with all bits set or all bits clear) that can be used with select() and
+/// getMask().
+class alignas(16) F32x4
+{
+public:
+	static constexpr U32 LANE_COUNT = 4;
+	static constexpr U32 ALL_LANES_MASK = 0xF;
+
+	/// Defaut constructor. IT WILL NOT INITIALIZE ANYTHING.
+	F32x4()
+	{
+	}
+
+	/// Set all lanes to the same value.
+	explicit F32x4(F32 f)
+	{
+#if ANKI_SIMD_SSE
+		m_simd = _mm_set1_ps(f);
+#elif ANKI_SIMD_NEON
+		m_simd = vdupq_n_f32(f);
+#else
+		m_arr = {{f, f, f, f}};
+#endif
+	}
+
+	F32x4(F32 a, F32 b, F32 c, F32 d)
+	{
+#if ANKI_SIMD_SSE
+		m_simd = _mm_set_ps(d, c, b, a);
+#elif ANKI_SIMD_NEON
+		const Array<F32, 4> arr = {{a, b, c, d}};
+		m_simd = vld1q_f32(&arr[0]);
+#else
+		m_arr = {{a, b, c, d}};
+#endif
+	}
+
+	/// Load from memory. It doesn't have to be aligned.
+	static F32x4 load(const F32* mem)
+	{
+		F32x4 out;
+#if ANKI_SIMD_SSE
+		out.m_simd = _mm_loadu_ps(mem);
+#elif ANKI_SIMD_NEON
+		out.m_simd = vld1q_f32(mem);
+#else
+		memcpy(&out.m_arr[0], mem, sizeof(out.m_arr));
+#endif
+		return out;
+	}
+
+	/// Store to memory. It doesn't have to be aligned.
+	void store(F32* mem) const
+	{
+#if ANKI_SIMD_SSE
+		_mm_storeu_ps(mem, m_simd);
+#elif ANKI_SIMD_NEON
+		vst1q_f32(mem, m_simd);
+#else
+		memcpy(mem, &m_arr[0], sizeof(m_arr));
+#endif
+	}
+
+	/// Get a single lane. It's slow, don't use it in hot loops.
+	F32 getLane(U32 lane) const
+	{
+		ANKI_ASSERT(lane < LANE_COUNT);
+		Array<F32, LANE_COUNT> arr;
+		store(&arr[0]);
+		return arr[lane];
+	}
+
+	/// Set a single lane. It's slow, don't use it in hot loops.
+	void setLane(U32 lane, F32 f)
+	{
+		ANKI_ASSERT(lane < LANE_COUNT);
+		Array<F32, LANE_COUNT> arr;
+		store(&arr[0]);
+		arr[lane] = f;
+		*this = load(&arr[0]);
+	}
+
+	/// @name Arithmetic
+	/// @{
+	F32x4 operator+(const F32x4& b) const
+	{
+#if ANKI_SIMD_SSE
+		return F32x4(_mm_add_ps(m_simd, b.m_simd));
+#elif ANKI_SIMD_NEON
+		return F32x4(vaddq_f32(m_simd, b.m_simd));
+#else
+		return perLane(b, [](F32 x, F32 y) { return x + y; });
+#endif
+	}
+
+	F32x4 operator-(const F32x4& b) const
+	{
+#if ANKI_SIMD_SSE
+		return F32x4(_mm_sub_ps(m_simd, b.m_simd));
+#elif ANKI_SIMD_NEON
+		return F32x4(vsubq_f32(m_simd, b.m_simd));
+#else
+		return perLane(b, [](F32 x, F32 y) { return x - y; });
+#endif
+	}
+
+	F32x4 operator*(const F32x4& b) const
+	{
+#if ANKI_SIMD_SSE
+		return F32x4(_mm_mul_ps(m_simd, b.m_simd));
+#elif ANKI_SIMD_NEON
+		return F32x4(vmulq_f32(m_simd, b.m_simd));
+#else
+		return perLane(b, [](F32 x, F32 y) { return x * y; });
+#endif
+	}
+
+	F32x4 operator/(const F32x4& b) const
+	{
+#if ANKI_SIMD_SSE
+		return F32x4(_mm_div_ps(m_simd, b.m_simd));
+#elif ANKI_SIMD_NEON
+		return F32x4(vdivq_f32(m_simd, b.m_simd));
+#else
+		return perLane(b, [](F32 x, F32 y) { return x / y; });
+#endif
+	}
+
+	F32x4 operator-() const
+	{
+		return F32x4(0.0f) - *this;
+	}
+
+	F32x4& operator+=(const F32x4& b)
+	{
+		*this = *this + b;
+		return *this;
+	}
+
+	F32x4& operator-=(const F32x4& b)
+	{
+		*this = *this - b;
+		return *this;
+	}
+
+	F32x4& operator*=(const F32x4& b)
+	{
+		*this = *this * b;
+		return *this;
+	}
+
+	F32x4& operator/=(const F32x4& b)
+	{
+		*this = *this / b;
+		return *this;
+	}
+	/// @}
+
+	/// @name Comparison. They return masks
+	/// @{
+	F32x4 operator<(const F32x4& b) const
+	{
+#if ANKI_SIMD_SSE
+		return F32x4(_mm_cmplt_ps(m_simd, b.m_simd));
+#elif ANKI_SIMD_NEON
+		return F32x4(vreinterpretq_f32_u32(vcltq_f32(m_simd, b.m_simd)));
+#else
+		return perLaneMask(b, [](F32 x, F32 y) { return x < y; });
+#endif
+	}
+
+	F32x4 operator<=(const F32x4& b) const
+	{
+#if ANKI_SIMD_SSE
+		return F32x4(_mm_cmple_ps(m_simd, b.m_simd));
+#elif ANKI_SIMD_NEON
+		return F32x4(vreinterpretq_f32_u32(vcleq_f32(m_simd, b.m_simd)));
+#else
+		return perLaneMask(b, [](F32 x, F32 y) { return x <= y; });
+#endif
+	}
+
+	F32x4 operator>(const F32x4& b) const
+	{
+		return b < *this;
+	}
+
+	F32x4 operator>=(const F32x4& b) const
+	{
+		return b <= *this;
+	}
+
+	F32x4 operator==(const F32x4& b) const
+	{
+#if ANKI_SIMD_SSE
+		return F32x4(_mm_cmpeq_ps(m_simd, b.m_simd));
+#elif ANKI_SIMD_NEON
+		return F32x4(vreinterpretq_f32_u32(vceqq_f32(m_simd, b.m_simd)));
+#else
+		return perLaneMask(b, [](F32 x, F32 y) { return x == y; });
+#endif
+	}
+	/// @}
+
+	/// @name Bitwise. Mostly useful for masks
+	/// @{
+	F32x4 operator&(const F32x4& b) const
+	{
+#if ANKI_SIMD_SSE
+		return F32x4(_mm_and_ps(m_simd, b.m_simd));
+#elif ANKI_SIMD_NEON
+		return F32x4(vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(m_simd), vreinterpretq_u32_f32(b.m_simd))));
+#else
+		return perLaneBits(b, [](U32 x, U32 y) { return x & y; });
+#endif
+	}
+
+	F32x4 operator|(const F32x4& b) const
+	{
+#if ANKI_SIMD_SSE
+		return F32x4(_mm_or_ps(m_simd, b.m_simd));
+#elif ANKI_SIMD_NEON
+		return F32x4(vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(m_simd), vreinterpretq_u32_f32(b.m_simd))));
+#else
+		return perLaneBits(b, [](U32 x, U32 y) { return x | y; });
+#endif
+	}
+	/// @}
+
+	/// Get one bit per lane. The bit is set if the lane's sign bit is set. Used with the masks.
+	U32 getMask() const
+	{
+#if ANKI_SIMD_SSE
+		return U32(_mm_movemask_ps(m_simd));
+#elif ANKI_SIMD_NEON
+		const uint32x4_t signs = vshrq_n_u32(vreinterpretq_u32_f32(m_simd), 31);
+		return vgetq_lane_u32(signs, 0) | (vgetq_lane_u32(signs, 1) << 1u) | (vgetq_lane_u32(signs, 2) << 2u)
+			   | (vgetq_lane_u32(signs, 3) << 3u);
+#else
+		U32 out = 0;
+		for(U32 i = 0; i < LANE_COUNT; ++i)
+		{
+			U32 bits;
+			memcpy(&bits, &m_arr[i], sizeof(bits));
+			out |= (bits >> 31u) << i;
+		}
+		return out;
+#endif
+	}
+
+	/// Pick lanes from @a a where the @a mask is set and from @a b where it's not.
+	static F32x4 select(const F32x4& mask, const F32x4& a, const F32x4& b)
+	{
+#if ANKI_SIMD_SSE
+		return F32x4(_mm_blendv_ps(b.m_simd, a.m_simd, mask.m_simd));
+#elif ANKI_SIMD_NEON
+		return F32x4(vbslq_f32(vreinterpretq_u32_f32(mask.m_simd), a.m_simd, b.m_simd));
+#else
+		F32x4 out;
+		for(U32 i = 0; i < LANE_COUNT; ++i)
+		{
+			out.m_arr[i] = (mask.getMask() & (1u << i)) ? a.m_arr[i] : b.m_arr[i];
+		}
+		return out;
+#endif
+	}
+
+	static F32x4 min(const F32x4& a, const F32x4& b)
+	{
+#if ANKI_SIMD_SSE
+		return F32x4(_mm_min_ps(a.m_simd, b.m_simd));
+#elif ANKI_SIMD_NEON
+		return F32x4(vminq_f32(a.m_simd, b.m_simd));
+#else
+		return a.perLane(b, [](F32 x, F32 y) { return (x < y) ? x : y; });
+#endif
+	}
+
+	static F32x4 max(const F32x4& a, const F32x4& b)
+	{
+#if ANKI_SIMD_SSE
+		return F32x4(_mm_max_ps(a.m_simd, b.m_simd));
+#elif ANKI_SIMD_NEON
+		return F32x4(vmaxq_f32(a.m_simd, b.m_simd));
+#else
+		return a.perLane(b, [](F32 x, F32 y) { return (x > y) ? x : y; });
+#endif
+	}
+
+	/// Compute a * b + c. It's fused if the CPU supports it.
+	static F32x4 mulAdd(const F32x4& a, const F32x4& b, const F32x4& c)
+	{
+#if ANKI_SIMD_FMA
+		return F32x4(_mm_fmadd_ps(a.m_simd, b.m_simd, c.m_simd));
+#elif ANKI_SIMD_NEON
+		return F32x4(vfmaq_f32(c.m_simd, a.m_simd, b.m_simd));
+#else
+		return a * b + c;
+#endif
+	}
+
+	F32x4 getAbs() const
+	{
+#if ANKI_SIMD_SSE
+		return F32x4(_mm_andnot_ps(_mm_set1_ps(-0.0f), m_simd));
+#elif ANKI_SIMD_NEON
+		return F32x4(vabsq_f32(m_simd));
+#else
+		F32x4 out;
+		for(U32 i = 0; i < LANE_COUNT; ++i)
+		{
+			out.m_arr[i] = std::fabs(m_arr[i]);
+		}
+		return out;
+#endif
+	}
+
+	F32x4 getSqrt() const
+	{
+#if ANKI_SIMD_SSE
+		return F32x4(_mm_sqrt_ps(m_simd));
+#elif ANKI_SIMD_NEON
+		return F32x4(vsqrtq_f32(m_simd));
+#else
+		F32x4 out;
+		for(U32 i = 0; i < LANE_COUNT; ++i)
+		{
+			out.m_arr[i] = std::sqrt(m_arr[i]);
+		}
+		return out;
+#endif
+	}
+
+private:
+#if ANKI_SIMD_SSE
+	__m128 m_simd;
+
+	explicit F32x4(__m128 simd)
+		: m_simd(simd)
+	{
+	}
+#elif ANKI_SIMD_NEON
+	float32x4_t m_simd;
+
+	explicit F32x4(float32x4_t simd)
+		: m_simd(simd)
+	{
+	}
+#else
+	Array<F32, 4> m_arr;
+
+	template<typename TFunc>
+	F32x4 perLane(const F32x4& b, TFunc func) const
+	{
+		F32x4 out;
+		for(U32 i = 0; i < LANE_COUNT; ++i)
+		{
+			out.m_arr[i] = func(m_arr[i], b.m_arr[i]);
+		}
+		return out;
+	}
+
+	template<typename TFunc>
+	F32x4 perLaneBits(const F32x4& b, TFunc func) const
+	{
+		F32x4 out;
+		for(U32 i = 0; i < LANE_COUNT; ++i)
+		{
+			U32 x, y;
+			memcpy(&x, &m_arr[i], sizeof(x));
+			memcpy(&y, &b.m_arr[i], sizeof(y));
+			const U32 bits = func(x, y);
+			memcpy(&out.m_arr[i], &bits, sizeof(bits));
+		}
+		return out;
+	}
+
+	template<typename TFunc>
+	F32x4 perLaneMask(const F32x4& b, TFunc func) const
+	{
+		F32x4 out;
+		for(U32 i = 0; i < LANE_COUNT; ++i)
+		{
+			const U32 bits = func(m_arr[i], b.m_arr[i]) ? MAX_U32 : 0;
+			memcpy(&out.m_arr[i], &bits, sizeof(bits));
+		}
+		return out;
+	}
+#endif
+};
+
+/// 8 F32 lanes. One AVX register if ANKI_SIMD_AVX2 is enabled or else a pair of F32x4 (SSE, NEON or scalar). It has
+/// the same interface as F32x4.
+class alignas(32) F32x8
+{
+public:
+	static constexpr U32 LANE_COUNT = 8;
+	static constexpr U32 ALL_LANES_MASK = 0xFF;
+
+	/// Defaut constructor. IT WILL NOT INITIALIZE ANYTHING.
+	F32x8()
+	{
+	}
+
+	/// Set all lanes to the same value.
+	explicit F32x8(F32 f)
+	{
+#if ANKI_SIMD_AVX2
+		m_simd = _mm256_set1_ps(f);
+#else
+		m_halves[0] = F32x4(f);
+		m_halves[1] = m_halves[0];
+#endif
+	}
+
+	/// Load from memory. It doesn't have to be aligned.
+	static F32x8 load(const F32* mem)
+	{
+		F32x8 out;
+#if ANKI_SIMD_AVX2
+		out.m_simd = _mm256_loadu_ps(mem);
+#else
+		out.m_halves[0] = F32x4::load(mem);
+		out.m_halves[1] = F32x4::load(mem + 4);
+#endif
+		return out;
+	}
+
+	/// Store to memory. It doesn't have to be aligned.
+	void store(F32* mem) const
+	{
+#if ANKI_SIMD_AVX2
+		_mm256_storeu_ps(mem, m_simd);
+#else
+		m_halves[0].store(mem);
+		m_halves[1].store(mem + 4);
+#endif
+	}
+
+	/// Get a single lane. It's slow, don't use it in hot loops.
+	F32 getLane(U32 lane) const
+	{
+		ANKI_ASSERT(lane < LANE_COUNT);
+		Array<F32, LANE_COUNT> arr;
+		store(&arr[0]);
+		return arr[lane];
+	}
+
+	/// Set a single lane. It's slow, don't use it in hot loops.
+	void setLane(U32 lane, F32 f)
+	{
+		ANKI_ASSERT(lane < LANE_COUNT);
+		Array<F32, LANE_COUNT> arr;
+		store(&arr[0]);
+		arr[lane] = f;
+		*this = load(&arr[0]);
+	}
+
+	/// @name Arithmetic
+	/// @{
+	F32x8 operator+(const F32x8& b) const
+	{
+#if ANKI_SIMD_AVX2
+		return F32x8(_mm256_add_ps(m_simd, b.m_simd));
+#else
+		return F32x8(m_halves[0] + b.m_halves[0], m_halves[1] + b.m_halves[1]);
+#endif
+	}
+
+	F32x8 operator-(const F32x8& b) const
+	{
+#if ANKI_SIMD_AVX2
+		return F32x8(_mm256_sub_ps(m_simd, b.m_simd));
+#else
+		return F32x8(m_halves[0] - b.m_halves[0], m_halves[1] - b.m_halves[1]);
+#endif
+	}
+
+	F32x8 operator*(const F32x8& b) const
+	{
+#if ANKI_SIMD_AVX2
+		return F32x8(_mm256_mul_ps(m_simd, b.m_simd));
+#else
+		return F32x8(m_halves[0] * b.m_halves[0], m_halves[1] * b.m_halves[1]);
+#endif
+	}
+
+	F32x8 operator/(const F32x8& b) const
+	{
+#if ANKI_SIMD_AVX2
+		return F32x8(_mm256_div_ps(m_simd, b.m_simd));
+#else
+		return F32x8(m_halves[0] / b.m_halves[0], m_halves[1] / b.m_halves[1]);
+#endif
+	}
+
+	F32x8 operator-() const
+	{
+		return F32x8(0.0f) - *this;
+	}
+
+	F32x8& operator+=(const F32x8& b)
+	{
+		*this = *this + b;
+		return *this;
+	}
+
+	F32x8& operator-=(const F32x8& b)
+	{
+		*this = *this - b;
+		return *this;
+	}
+
+	F32x8& operator*=(const F32x8& b)
+	{
+		*this = *this * b;
+		return *this;
+	}
+
+	F32x8& operator/=(const F32x8& b)
+	{
+		*this = *this / b;
+		return *this;
+	}
+	/// @}
+
+	/// @name Comparison. They return masks
+	/// @{
+	F32x8 operator<(const F32x8& b) const
+	{
+#if ANKI_SIMD_AVX2
+		return F32x8(_mm256_cmp_ps(m_simd, b.m_simd, _CMP_LT_OQ));
+#else
+		return F32x8(m_halves[0] < b.m_halves[0], m_halves[1] < b.m_halves[1]);
+#endif
+	}
+
+	F32x8 operator<=(const F32x8& b) const
+	{
+#if ANKI_SIMD_AVX2
+		return F32x8(_mm256_cmp_ps(m_simd, b.m_simd, _CMP_LE_OQ));
+#else
+		return F32x8(m_halves[0] <= b.m_halves[0], m_halves[1] <= b.m_halves[1]);
+#endif
+	}
+
+	F32x8 operator>(const F32x8& b) const
+	{
+		return b < *this;
+	}
+
+	F32x8 operator>=(const F32x8& b) const
+	{
+		return b <= *this;
+	}
+
+	F32x8 operator==(const F32x8& b) const
+	{
+#if ANKI_SIMD_AVX2
+		return F32x8(_mm256_cmp_ps(m_simd, b.m_simd, _CMP_EQ_OQ));
+#else
+		return F32x8(m_halves[0] == b.m_halves[0], m_halves[1] == b.m_halves[1]);
+#endif
+	}
+	/// @}
+
+	/// @name Bitwise. Mostly useful for masks
+	/// @{
+	F32x8 operator&(const F32x8& b) const
+	{
+#if ANKI_SIMD_AVX2
+		return F32x8(_mm256_and_ps(m_simd, b.m_simd));
+#else
+		return F32x8(m_halves[0] & b.m_halves[0], m_halves[1] & b.m_halves[1]);
+#endif
+	}
+
+	F32x8 operator|(const F32x8& b) const
+	{
+#if ANKI_SIMD_AVX2
+		return F32x8(_mm256_or_ps(m_simd, b.m_simd));
+#else
+		return F32x8(m_halves[0] | b.m_halves[0], m_halves[1] | b.m_halves[1]);
+#endif
+	}
+	/// @}
+
+	/// Get one bit per lane. The bit is set if the lane's sign bit is set. Used with the masks.
+	U32 getMask() const
+	{
+#if ANKI_SIMD_AVX2
+		return U32(_mm256_movemask_ps(m_simd));
+#else
+		return m_halves[0].getMask() | (m_halves[1].getMask() << 4u);
+#endif
+	}
+
+	/// Pick lanes from @a a where the @a mask is set and from @a b where it's not.
+	static F32x8 select(const F32x8& mask, const F32x8& a, const F32x8& b)
+	{
+#if ANKI_SIMD_AVX2
+		return F32x8(_mm256_blendv_ps(b.m_simd, a.m_simd, mask.m_simd));
+#else
+		return F32x8(F32x4::select(mask.m_halves[0], a.m_halves[0], b.m_halves[0]),
+			F32x4::select(mask.m_halves[1], a.m_halves[1], b.m_halves[1]));
+#endif
+	}
+
+	static F32x8 min(const F32x8& a, const F32x8& b)
+	{
+#if ANKI_SIMD_AVX2
+		return F32x8(_mm256_min_ps(a.m_simd, b.m_simd));
+#else
+		return F32x8(F32x4::min(a.m_halves[0], b.m_halves[0]), F32x4::min(a.m_halves[1], b.m_halves[1]));
+#endif
+	}
+
+	static F32x8 max(const F32x8& a, const F32x8& b)
+	{
+#if ANKI_SIMD_AVX2
+		return F32x8(_mm256_max_ps(a.m_simd, b.m_simd));
+#else
+		return F32x8(F32x4::max(a.m_halves[0], b.m_halves[0]), F32x4::max(a.m_halves[1], b.m_halves[1]));
+#endif
+	}
+
+	/// Compute a * b + c. It's fused if the CPU supports it.
+	static F32x8 mulAdd(const F32x8& a, const F32x8& b, const F32x8& c)
+	{
+#if ANKI_SIMD_AVX2 && ANKI_SIMD_FMA
+		return F32x8(_mm256_fmadd_ps(a.m_simd, b.m_simd, c.m_simd));
+#elif ANKI_SIMD_AVX2
+		return a * b + c;
+#else
+		return F32x8(F32x4::mulAdd(a.m_halves[0], b.m_halves[0], c.m_halves[0]),
+			F32x4::mulAdd(a.m_halves[1], b.m_halves[1], c.m_halves[1]));
+#endif
+	}
+
+	F32x8 getAbs() const
+	{
+#if ANKI_SIMD_AVX2
+		return F32x8(_mm256_andnot_ps(_mm256_set1_ps(-0.0f), m_simd));
+#else
+		return F32x8(m_halves[0].getAbs(), m_halves[1].getAbs());
+#endif
+	}
+
+	F32x8 getSqrt() const
+	{
+#if ANKI_SIMD_AVX2
+		return F32x8(_mm256_sqrt_ps(m_simd));
+#else
+		return F32x8(m_halves[0].getSqrt(), m_halves[1].getSqrt());
+#endif
+	}
+
+private:
+#if ANKI_SIMD_AVX2
+	__m256 m_simd;
+
+	explicit F32x8(__m256 simd)
+		: m_simd(simd)
+	{
+	}
+#else
+	Array<F32x4, 2> m_halves;
+
+	F32x8(const F32x4& a, const F32x4& b)
+	{
+		m_halves[0] = a;
+		m_halves[1] = b;
+	}
+#endif
+};
+/// @}
+
+} // end namespace anki
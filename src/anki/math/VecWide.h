@@ -0,0 +1,458 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/math/SimdWide.h>
+#include <anki/math/Vec.h>
+#include <anki/math/Quat.h>
+
+namespace anki
+{
+
+/// @addtogroup math
+/// @{
+
+/// N 3D vectors in SoA layout. Every component is a lane type (F32x4 or F32x8) so the operations work on all the
+/// vectors at once. Use it in batch kernels, the AoS types (Vec3) are still the way to go for single vectors.
+/// @tparam TLane F32x4 or F32x8.
+template<typename TLane>
+class TVec3Wide
+{
+public:
+	using Lane = TLane;
+	static constexpr U32 LANE_COUNT = TLane::LANE_COUNT;
+
+	TLane m_x;
+	TLane m_y;
+	TLane m_z;
+
+	/// Defaut constructor. IT WILL NOT INITIALIZE ANYTHING.
+	TVec3Wide()
+	{
+	}
+
+	TVec3Wide(const TLane& x, const TLane& y, const TLane& z)
+		: m_x(x)
+		, m_y(y)
+		, m_z(z)
+	{
+	}
+
+	/// Set all lanes to the same vector.
+	explicit TVec3Wide(const Vec3& v)
+		: m_x(v.x())
+		, m_y(v.y())
+		, m_z(v.z())
+	{
+	}
+
+	/// Set all lanes to the same value.
+	explicit TVec3Wide(F32 f)
+		: m_x(f)
+		, m_y(f)
+		, m_z(f)
+	{
+	}
+
+	/// Load from SoA memory, one array per component.
+	static TVec3Wide load(const F32* x, const F32* y, const F32* z)
+	{
+		return TVec3Wide(TLane::load(x), TLane::load(y), TLane::load(z));
+	}
+
+	/// Store to SoA memory, one array per component.
+	void store(F32* x, F32* y, F32* z) const
+	{
+		m_x.store(x);
+		m_y.store(y);
+		m_z.store(z);
+	}
+
+	/// Gather from AoS memory. @a count can be less than LANE_COUNT and the rest of the lanes will be zero.
+	static TVec3Wide loadAos(const Vec3* vecs, U32 count = LANE_COUNT)
+	{
+		ANKI_ASSERT(count <= LANE_COUNT);
+		Array<F32, LANE_COUNT> x, y, z;
+		for(U32 i = 0; i < LANE_COUNT; ++i)
+		{
+			const Vec3 v = (i < count) ? vecs[i] : Vec3(0.0f);
+			x[i] = v.x();
+			y[i] = v.y();
+			z[i] = v.z();
+		}
+		return load(&x[0], &y[0], &z[0]);
+	}
+
+	/// Scatter to AoS memory. Only the first @a count lanes will be written.
+	void storeAos(Vec3* vecs, U32 count = LANE_COUNT) const
+	{
+		ANKI_ASSERT(count <= LANE_COUNT);
+		Array<F32, LANE_COUNT> x, y, z;
+		store(&x[0], &y[0], &z[0]);
+		for(U32 i = 0; i < count; ++i)
+		{
+			vecs[i] = Vec3(x[i], y[i], z[i]);
+		}
+	}
+
+	/// Get a single vector. It's slow, don't use it in hot loops.
+	Vec3 getLane(U32 lane) const
+	{
+		return Vec3(m_x.getLane(lane), m_y.getLane(lane), m_z.getLane(lane));
+	}
+
+	/// Set a single vector. It's slow, don't use it in hot loops.
+	void setLane(U32 lane, const Vec3& v)
+	{
+		m_x.setLane(lane, v.x());
+		m_y.setLane(lane, v.y());
+		m_z.setLane(lane, v.z());
+	}
+
+	/// @name Arithmetic
+	/// @{
+	TVec3Wide operator+(const TVec3Wide& b) const
+	{
+		return TVec3Wide(m_x + b.m_x, m_y + b.m_y, m_z + b.m_z);
+	}
+
+	TVec3Wide operator-(const TVec3Wide& b) const
+	{
+		return TVec3Wide(m_x - b.m_x, m_y - b.m_y, m_z - b.m_z);
+	}
+
+	TVec3Wide operator*(const TVec3Wide& b) const
+	{
+		return TVec3Wide(m_x * b.m_x, m_y * b.m_y, m_z * b.m_z);
+	}
+
+	TVec3Wide operator*(const TLane& f) const
+	{
+		return TVec3Wide(m_x * f, m_y * f, m_z * f);
+	}
+
+	TVec3Wide operator/(const TLane& f) const
+	{
+		return TVec3Wide(m_x / f, m_y / f, m_z / f);
+	}
+
+	TVec3Wide operator-() const
+	{
+		return TVec3Wide(-m_x, -m_y, -m_z);
+	}
+
+	TVec3Wide& operator+=(const TVec3Wide& b)
+	{
+		*this = *this + b;
+		return *this;
+	}
+
+	TVec3Wide& operator-=(const TVec3Wide& b)
+	{
+		*this = *this - b;
+		return *this;
+	}
+	/// @}
+
+	/// Compute a * b + c per component.
+	static TVec3Wide mulAdd(const TVec3Wide& a, const TLane& b, const TVec3Wide& c)
+	{
+		return TVec3Wide(TLane::mulAdd(a.m_x, b, c.m_x), TLane::mulAdd(a.m_y, b, c.m_y), TLane::mulAdd(a.m_z, b, c.m_z));
+	}
+
+	TLane dot(const TVec3Wide& b) const
+	{
+		return TLane::mulAdd(m_x, b.m_x, TLane::mulAdd(m_y, b.m_y, m_z * b.m_z));
+	}
+
+	TVec3Wide cross(const TVec3Wide& b) const
+	{
+		return TVec3Wide(
+			m_y * b.m_z - m_z * b.m_y, m_z * b.m_x - m_x * b.m_z, m_x * b.m_y - m_y * b.m_x);
+	}
+
+	TLane getLengthSquared() const
+	{
+		return dot(*this);
+	}
+
+	TLane getLength() const
+	{
+		return getLengthSquared().getSqrt();
+	}
+
+	TVec3Wide getNormalized() const
+	{
+		return *this / getLength();
+	}
+
+	TVec3Wide getAbs() const
+	{
+		return TVec3Wide(m_x.getAbs(), m_y.getAbs(), m_z.getAbs());
+	}
+
+	static TVec3Wide min(const TVec3Wide& a, const TVec3Wide& b)
+	{
+		return TVec3Wide(TLane::min(a.m_x, b.m_x), TLane::min(a.m_y, b.m_y), TLane::min(a.m_z, b.m_z));
+	}
+
+	static TVec3Wide max(const TVec3Wide& a, const TVec3Wide& b)
+	{
+		return TVec3Wide(TLane::max(a.m_x, b.m_x), TLane::max(a.m_y, b.m_y), TLane::max(a.m_z, b.m_z));
+	}
+
+	/// Pick vectors from @a a where the @a mask is set and from @a b where it's not.
+	static TVec3Wide select(const TLane& mask, const TVec3Wide& a, const TVec3Wide& b)
+	{
+		return TVec3Wide(
+			TLane::select(mask, a.m_x, b.m_x), TLane::select(mask, a.m_y, b.m_y), TLane::select(mask, a.m_z, b.m_z));
+	}
+};
+
+/// N 4D vectors in SoA layout. See TVec3Wide.
+/// @tparam TLane F32x4 or F32x8.
+template<typename TLane>
+class TVec4Wide
+{
+public:
+	using Lane = TLane;
+	static constexpr U32 LANE_COUNT = TLane::LANE_COUNT;
+
+	TLane m_x;
+	TLane m_y;
+	TLane m_z;
+	TLane m_w;
+
+	/// Defaut constructor. IT WILL NOT INITIALIZE ANYTHING.
+	TVec4Wide()
+	{
+	}
+
+	TVec4Wide(const TLane& x, const TLane& y, const TLane& z, const TLane& w)
+		: m_x(x)
+		, m_y(y)
+		, m_z(z)
+		, m_w(w)
+	{
+	}
+
+	TVec4Wide(const TVec3Wide<TLane>& v, const TLane& w)
+		: m_x(v.m_x)
+		, m_y(v.m_y)
+		, m_z(v.m_z)
+		, m_w(w)
+	{
+	}
+
+	/// Set all lanes to the same vector.
+	explicit TVec4Wide(const Vec4& v)
+		: m_x(v.x())
+		, m_y(v.y())
+		, m_z(v.z())
+		, m_w(v.w())
+	{
+	}
+
+	/// Set all lanes to the same value.
+	explicit TVec4Wide(F32 f)
+		: m_x(f)
+		, m_y(f)
+		, m_z(f)
+		, m_w(f)
+	{
+	}
+
+	/// Gather from AoS memory. @a count can be less than LANE_COUNT and the rest of the lanes will be zero.
+	static TVec4Wide loadAos(const Vec4* vecs, U32 count = LANE_COUNT)
+	{
+		ANKI_ASSERT(count <= LANE_COUNT);
+		Array<F32, LANE_COUNT> x, y, z, w;
+		for(U32 i = 0; i < LANE_COUNT; ++i)
+		{
+			const Vec4 v = (i < count) ? vecs[i] : Vec4(0.0f);
+			x[i] = v.x();
+			y[i] = v.y();
+			z[i] = v.z();
+			w[i] = v.w();
+		}
+		return TVec4Wide(TLane::load(&x[0]), TLane::load(&y[0]), TLane::load(&z[0]), TLane::load(&w[0]));
+	}
+
+	/// Scatter to AoS memory. Only the first @a count lanes will be written.
+	void storeAos(Vec4* vecs, U32 count = LANE_COUNT) const
+	{
+		ANKI_ASSERT(count <= LANE_COUNT);
+		Array<F32, LANE_COUNT> x, y, z, w;
+		m_x.store(&x[0]);
+		m_y.store(&y[0]);
+		m_z.store(&z[0]);
+		m_w.store(&w[0]);
+		for(U32 i = 0; i < count; ++i)
+		{
+			vecs[i] = Vec4(x[i], y[i], z[i], w[i]);
+		}
+	}
+
+	/// Get a single vector. It's slow, don't use it in hot loops.
+	Vec4 getLane(U32 lane) const
+	{
+		return Vec4(m_x.getLane(lane), m_y.getLane(lane), m_z.getLane(lane), m_w.getLane(lane));
+	}
+
+	/// Set a single vector. It's slow, don't use it in hot loops.
+	void setLane(U32 lane, const Vec4& v)
+	{
+		m_x.setLane(lane, v.x());
+		m_y.setLane(lane, v.y());
+		m_z.setLane(lane, v.z());
+		m_w.setLane(lane, v.w());
+	}
+
+	TVec3Wide<TLane> xyz() const
+	{
+		return TVec3Wide<TLane>(m_x, m_y, m_z);
+	}
+
+	/// @name Arithmetic
+	/// @{
+	TVec4Wide operator+(const TVec4Wide& b) const
+	{
+		return TVec4Wide(m_x + b.m_x, m_y + b.m_y, m_z + b.m_z, m_w + b.m_w);
+	}
+
+	TVec4Wide operator-(const TVec4Wide& b) const
+	{
+		return TVec4Wide(m_x - b.m_x, m_y - b.m_y, m_z - b.m_z, m_w - b.m_w);
+	}
+
+	TVec4Wide operator*(const TVec4Wide& b) const
+	{
+		return TVec4Wide(m_x * b.m_x, m_y * b.m_y, m_z * b.m_z, m_w * b.m_w);
+	}
+
+	TVec4Wide operator*(const TLane& f) const
+	{
+		return TVec4Wide(m_x * f, m_y * f, m_z * f, m_w * f);
+	}
+
+	TVec4Wide operator/(const TLane& f) const
+	{
+		return TVec4Wide(m_x / f, m_y / f, m_z / f, m_w / f);
+	}
+	/// @}
+
+	TLane dot(const TVec4Wide& b) const
+	{
+		return TLane::mulAdd(m_x, b.m_x, TLane::mulAdd(m_y, b.m_y, TLane::mulAdd(m_z, b.m_z, m_w * b.m_w)));
+	}
+
+	TLane getLengthSquared() const
+	{
+		return dot(*this);
+	}
+
+	TLane getLength() const
+	{
+		return getLengthSquared().getSqrt();
+	}
+
+	TVec4Wide getNormalized() const
+	{
+		return *this / getLength();
+	}
+};
+
+/// N quaternions in SoA layout. See TVec3Wide.
+/// @tparam TLane F32x4 or F32x8.
+template<typename TLane>
+class TQuatWide
+{
+public:
+	using Lane = TLane;
+	static constexpr U32 LANE_COUNT = TLane::LANE_COUNT;
+
+	TLane m_x;
+	TLane m_y;
+	TLane m_z;
+	TLane m_w;
+
+	/// Defaut constructor. IT WILL NOT INITIALIZE ANYTHING.
+	TQuatWide()
+	{
+	}
+
+	TQuatWide(const TLane& x, const TLane& y, const TLane& z, const TLane& w)
+		: m_x(x)
+		, m_y(y)
+		, m_z(z)
+		, m_w(w)
+	{
+	}
+
+	/// Set all lanes to the same quaternion.
+	explicit TQuatWide(const Quat& q)
+		: m_x(q.x())
+		, m_y(q.y())
+		, m_z(q.z())
+		, m_w(q.w())
+	{
+	}
+
+	/// Get a single quaternion. It's slow, don't use it in hot loops.
+	Quat getLane(U32 lane) const
+	{
+		return Quat(m_x.getLane(lane), m_y.getLane(lane), m_z.getLane(lane), m_w.getLane(lane));
+	}
+
+	/// Set a single quaternion. It's slow, don't use it in hot loops.
+	void setLane(U32 lane, const Quat& q)
+	{
+		m_x.setLane(lane, q.x());
+		m_y.setLane(lane, q.y());
+		m_z.setLane(lane, q.z());
+		m_w.setLane(lane, q.w());
+	}
+
+	/// Same as Quat::combineRotations.
+	TQuatWide combineRotations(const TQuatWide& b) const
+	{
+		return TQuatWide(m_x * b.m_w + m_y * b.m_z - m_z * b.m_y + m_w * b.m_x,
+			-m_x * b.m_z + m_y * b.m_w + m_z * b.m_x + m_w * b.m_y,
+			m_x * b.m_y - m_y * b.m_x + m_z * b.m_w + m_w * b.m_z,
+			-m_x * b.m_x - m_y * b.m_y - m_z * b.m_z + m_w * b.m_w);
+	}
+
+	TQuatWide getConjugated() const
+	{
+		return TQuatWide(-m_x, -m_y, -m_z, m_w);
+	}
+
+	TQuatWide getNormalized() const
+	{
+		const TLane len =
+			TLane::mulAdd(m_x, m_x, TLane::mulAdd(m_y, m_y, TLane::mulAdd(m_z, m_z, m_w * m_w))).getSqrt();
+		return TQuatWide(m_x / len, m_y / len, m_z / len, m_w / len);
+	}
+
+	/// Same as Quat::rotate. The quaternions should be normalized.
+	TVec3Wide<TLane> rotate(const TVec3Wide<TLane>& v) const
+	{
+		// v + 2 * cross(q.xyz, cross(q.xyz, v) + q.w * v)
+		const TVec3Wide<TLane> qv(m_x, m_y, m_z);
+		const TVec3Wide<TLane> t = TVec3Wide<TLane>::mulAdd(v, m_w, qv.cross(v));
+		return TVec3Wide<TLane>::mulAdd(qv.cross(t), TLane(2.0f), v);
+	}
+};
+
+using Vec3x4 = TVec3Wide<F32x4>;
+using Vec3x8 = TVec3Wide<F32x8>;
+using Vec4x4 = TVec4Wide<F32x4>;
+using Vec4x8 = TVec4Wide<F32x8>;
+using Quatx4 = TQuatWide<F32x4>;
+using Quatx8 = TQuatWide<F32x8>;
+/// @}
+
+} // end namespace anki
@@ -64,6 +64,20 @@ public:
 		}
 	}
 
+	/// Put a dynamic body to sleep or wake it up. A sleeping body wakes up if something hits it.
+	void setSleeping(Bool sleep)
+	{
+		ANKI_ASSERT(m_mass > 0.0f && "Only relevant for dynamic bodies");
+		if(sleep)
+		{
+			m_body->setActivationState(ISLAND_SLEEPING);
+		}
+		else
+		{
+			m_body->activate(true);
+		}
+	}
+
 	void clearForces()
 	{
 		m_body->clearForces();
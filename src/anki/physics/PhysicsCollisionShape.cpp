@@ -5,10 +5,24 @@
 
 #include <anki/physics/PhysicsCollisionShape.h>
 #include <anki/physics/PhysicsWorld.h>
+#include <anki/util/File.h>
+#include <anki/util/Hash.h>
 
 namespace anki
 {
 
+/// The header of the files that cache the BVHs of the triangle meshes.
+class BvhCacheHeader
+{
+public:
+	Array<char, 8> m_magic;
+	U64 m_hash; ///< The hash of the triangles.
+	U32 m_dataSize;
+	U32 m_padding;
+};
+
+static constexpr const char* BVH_CACHE_MAGIC = "ANKIBVH1";
+
 PhysicsSphere::PhysicsSphere(PhysicsWorld* world, F32 radius)
 	: PhysicsCollisionShape(world, ShapeType::SPHERE)
 {
@@ -35,8 +49,46 @@ PhysicsBox::~PhysicsBox()
 	m_box.destroy();
 }
 
-PhysicsTriangleSoup::PhysicsTriangleSoup(
-	PhysicsWorld* world, ConstWeakArray<Vec3> positions, ConstWeakArray<U32> indices, Bool convex)
+PhysicsConvexHulls::PhysicsConvexHulls(
+	PhysicsWorld* world, ConstWeakArray<Vec3> positions, ConstWeakArray<U32> hullVertexCounts)
+	: PhysicsCollisionShape(world, ShapeType::COMPOUND)
+{
+	ANKI_ASSERT(hullVertexCounts.getSize() > 0);
+
+	m_compound.init(true, I32(hullVertexCounts.getSize()));
+	m_compound->setMargin(getWorld().getCollisionMargin());
+	m_compound->setUserPointer(static_cast<PhysicsObject*>(this));
+
+	m_hulls.create(getAllocator(), hullVertexCounts.getSize());
+	U32 firstVertex = 0;
+	for(U32 i = 0; i < hullVertexCounts.getSize(); ++i)
+	{
+		ANKI_ASSERT(firstVertex + hullVertexCounts[i] <= positions.getSize());
+
+		m_hulls[i].init(&positions[firstVertex][0], I32(hullVertexCounts[i]), sizeof(Vec3));
+		m_hulls[i]->setMargin(getWorld().getCollisionMargin());
+		m_compound->addChildShape(btTransform::getIdentity(), m_hulls[i].get());
+
+		firstVertex += hullVertexCounts[i];
+	}
+}
+
+PhysicsConvexHulls::~PhysicsConvexHulls()
+{
+	m_compound.destroy();
+
+	for(ClassWrapper<btConvexHullShape>& hull : m_hulls)
+	{
+		hull.destroy();
+	}
+	m_hulls.destroy(getAllocator());
+}
+
+PhysicsTriangleSoup::PhysicsTriangleSoup(PhysicsWorld* world,
+	ConstWeakArray<Vec3> positions,
+	ConstWeakArray<U32> indices,
+	Bool convex,
+	CString bvhCacheFilename)
 	: PhysicsCollisionShape(world, ShapeType::TRI_MESH)
 {
 	if(!convex)
@@ -57,8 +109,29 @@ PhysicsTriangleSoup::PhysicsTriangleSoup(
 		m_triMesh.m_dynamic->updateBound();
 		m_triMesh.m_dynamic->setUserPointer(static_cast<PhysicsObject*>(this));
 
-		// And the static one
-		m_triMesh.m_static.init(m_mesh.get(), true);
+		// And the static one. Building its BVH is the expensive part so it can be loaded from a file
+		U64 hash = 0;
+		if(!bvhCacheFilename.isEmpty())
+		{
+			hash = computeHash(HashVersion::XXH3, &positions[0], positions.getSizeInBytes());
+			hash = appendHash(HashVersion::XXH3, &indices[0], indices.getSizeInBytes(), hash);
+		}
+
+		if(!bvhCacheFilename.isEmpty() && loadBvh(bvhCacheFilename, hash))
+		{
+			m_triMesh.m_static.init(m_mesh.get(), true, false);
+			m_triMesh.m_static->setOptimizedBvh(static_cast<btOptimizedBvh*>(
+				btOptimizedBvh::deSerializeInPlace(m_bvhData, m_bvhDataSize, false)));
+		}
+		else
+		{
+			m_triMesh.m_static.init(m_mesh.get(), true);
+			if(!bvhCacheFilename.isEmpty())
+			{
+				saveBvh(bvhCacheFilename, hash);
+			}
+		}
+
 		m_triMesh.m_static->setMargin(getWorld().getCollisionMargin());
 		m_triMesh.m_static->setUserPointer(static_cast<PhysicsObject*>(this));
 	}
@@ -79,6 +152,11 @@ PhysicsTriangleSoup::~PhysicsTriangleSoup()
 		m_triMesh.m_dynamic.destroy();
 		m_triMesh.m_static.destroy();
 		m_mesh.destroy();
+
+		if(m_bvhData)
+		{
+			getAllocator().getMemoryPool().free(m_bvhData);
+		}
 	}
 	else
 	{
@@ -87,4 +165,118 @@ PhysicsTriangleSoup::~PhysicsTriangleSoup()
 	}
 }
 
+Bool PhysicsTriangleSoup::loadBvh(CString filename, U64 hash)
+{
+	File file;
+	if(file.open(filename, FileOpenFlag::READ | FileOpenFlag::BINARY))
+	{
+		return false;
+	}
+
+	BvhCacheHeader header;
+	if(file.read(&header, sizeof(header)) || memcmp(&header.m_magic[0], BVH_CACHE_MAGIC, sizeof(header.m_magic)) != 0
+		|| header.m_hash != hash || file.getSize() != sizeof(header) + header.m_dataSize)
+	{
+		ANKI_PHYS_LOGW("Ignoring stale or corrupted BVH cache: %s", filename.cstr());
+		return false;
+	}
+
+	// The data are used in place and they need to be aligned
+	m_bvhData = getAllocator().getMemoryPool().allocate(header.m_dataSize, 16);
+	if(file.read(m_bvhData, header.m_dataSize))
+	{
+		getAllocator().getMemoryPool().free(m_bvhData);
+		m_bvhData = nullptr;
+		return false;
+	}
+
+	m_bvhDataSize = header.m_dataSize;
+	return true;
+}
+
+void PhysicsTriangleSoup::saveBvh(CString filename, U64 hash)
+{
+	const btOptimizedBvh* bvh = m_triMesh.m_static->getOptimizedBvh();
+	ANKI_ASSERT(bvh);
+
+	BvhCacheHeader header = {};
+	memcpy(&header.m_magic[0], BVH_CACHE_MAGIC, sizeof(header.m_magic));
+	header.m_hash = hash;
+	header.m_dataSize = bvh->calculateSerializeBufferSize();
+
+	void* data = getAllocator().getMemoryPool().allocate(header.m_dataSize, 16);
+	File file;
+	const Bool failed = !bvh->serializeInPlace(data, header.m_dataSize, false)
+						|| file.open(filename, FileOpenFlag::WRITE | FileOpenFlag::BINARY)
+						|| file.write(&header, sizeof(header)) || file.write(data, header.m_dataSize);
+	getAllocator().getMemoryPool().free(data);
+
+	if(failed)
+	{
+		ANKI_PHYS_LOGW("Failed to write the BVH cache: %s", filename.cstr());
+	}
+}
+
+PhysicsScaledShape::PhysicsScaledShape(PhysicsWorld* world, PhysicsCollisionShapePtr shape, F32 scale)
+	: PhysicsCollisionShape(world, ShapeType::SCALED_CONVEX)
+	, m_shape(shape)
+{
+	ANKI_ASSERT(scale > 0.0f);
+
+	switch(shape->m_type)
+	{
+	case ShapeType::BOX:
+	case ShapeType::SPHERE:
+	case ShapeType::CONVEX:
+		m_scaledConvex.init(static_cast<btConvexShape*>(shape->getBtShape()), scale);
+		break;
+	case ShapeType::TRI_MESH:
+		m_type = ShapeType::SCALED_TRI_MESH;
+		m_scaledTriMesh.init(shape->m_triMesh.m_static.get(), btVector3(scale, scale, scale));
+		break;
+	case ShapeType::COMPOUND:
+	{
+		// The children of the compounds are convex hulls
+		m_type = ShapeType::COMPOUND;
+		btCompoundShape& compound = *shape->m_compound;
+		m_compound.init(true, compound.getNumChildShapes());
+		m_scaledChildren.create(getAllocator(), U32(compound.getNumChildShapes()));
+		for(I32 i = 0; i < compound.getNumChildShapes(); ++i)
+		{
+			m_scaledChildren[i].init(static_cast<btConvexShape*>(compound.getChildShape(i)), scale);
+
+			btTransform trf = compound.getChildTransform(i);
+			trf.setOrigin(trf.getOrigin() * scale);
+			m_compound->addChildShape(trf, m_scaledChildren[i].get());
+		}
+		break;
+	}
+	default:
+		ANKI_ASSERT(!"Can't scale a scaled shape");
+	}
+
+	getBtShape()->setUserPointer(static_cast<PhysicsObject*>(this));
+}
+
+PhysicsScaledShape::~PhysicsScaledShape()
+{
+	switch(m_type)
+	{
+	case ShapeType::SCALED_CONVEX:
+		m_scaledConvex.destroy();
+		break;
+	case ShapeType::SCALED_TRI_MESH:
+		m_scaledTriMesh.destroy();
+		break;
+	default:
+		ANKI_ASSERT(m_type == ShapeType::COMPOUND);
+		m_compound.destroy();
+		for(ClassWrapper<btUniformScalingShape>& child : m_scaledChildren)
+		{
+			child.destroy();
+		}
+		m_scaledChildren.destroy(getAllocator());
+	}
+}
+
 } // end namespace anki
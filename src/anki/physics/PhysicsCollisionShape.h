@@ -18,6 +18,8 @@ namespace anki
 /// The base of all collision shapes.
 class PhysicsCollisionShape : public PhysicsObject
 {
+	friend class PhysicsScaledShape;
+
 public:
 	static const PhysicsObjectType CLASS_TYPE = PhysicsObjectType::COLLISION_SHAPE;
 
@@ -37,7 +39,10 @@ protected:
 		BOX,
 		SPHERE,
 		CONVEX,
-		TRI_MESH
+		TRI_MESH,
+		COMPOUND,
+		SCALED_CONVEX,
+		SCALED_TRI_MESH
 	};
 
 	class TriMesh
@@ -54,6 +59,9 @@ protected:
 		ClassWrapper<btSphereShape> m_sphere;
 		ClassWrapper<btConvexHullShape> m_convex;
 		TriMesh m_triMesh;
+		ClassWrapper<btCompoundShape> m_compound;
+		ClassWrapper<btUniformScalingShape> m_scaledConvex;
+		ClassWrapper<btScaledBvhTriangleMeshShape> m_scaledTriMesh;
 	};
 
 	ShapeType m_type;
@@ -74,6 +82,13 @@ protected:
 			return m_sphere.get();
 		case ShapeType::CONVEX:
 			return m_convex.get();
+		case ShapeType::COMPOUND:
+			return m_compound.get();
+		case ShapeType::SCALED_CONVEX:
+			return m_scaledConvex.get();
+		case ShapeType::SCALED_TRI_MESH:
+			ANKI_ASSERT(!forDynamicBodies && "The scaled triangle meshes are only for static bodies");
+			return m_scaledTriMesh.get();
 		case ShapeType::TRI_MESH:
 			if(forDynamicBodies)
 			{
@@ -123,6 +138,21 @@ private:
 	~PhysicsConvexHull();
 };
 
+/// A number of convex hulls that approximate a concave shape. It's way cheaper than a triangle mesh.
+class PhysicsConvexHulls final : public PhysicsCollisionShape
+{
+	ANKI_PHYSICS_OBJECT
+
+private:
+	DynamicArray<ClassWrapper<btConvexHullShape>> m_hulls;
+
+	/// @param positions The vertices of all the hulls, the ones of the first hull first.
+	/// @param hullVertexCounts The number of vertices of each hull.
+	PhysicsConvexHulls(PhysicsWorld* world, ConstWeakArray<Vec3> positions, ConstWeakArray<U32> hullVertexCounts);
+
+	~PhysicsConvexHulls();
+};
+
 /// Static triangle mesh shape.
 class PhysicsTriangleSoup final : public PhysicsCollisionShape
 {
@@ -130,11 +160,37 @@ class PhysicsTriangleSoup final : public PhysicsCollisionShape
 
 private:
 	ClassWrapper<btTriangleMesh> m_mesh;
+	void* m_bvhData = nullptr; ///< The memory of a BVH that was loaded from a file. The static shape uses it in place.
+	U32 m_bvhDataSize = 0;
 
-	PhysicsTriangleSoup(
-		PhysicsWorld* world, ConstWeakArray<Vec3> positions, ConstWeakArray<U32> indices, Bool convex = false);
+	/// @param bvhCacheFilename If it's not empty the BVH of the static shape is loaded from that file. If the file is
+	///                         missing or stale the BVH is built and written there.
+	PhysicsTriangleSoup(PhysicsWorld* world,
+		ConstWeakArray<Vec3> positions,
+		ConstWeakArray<U32> indices,
+		Bool convex = false,
+		CString bvhCacheFilename = CString());
 
 	~PhysicsTriangleSoup();
+
+	Bool loadBvh(CString filename, U64 hash);
+
+	void saveBvh(CString filename, U64 hash);
+};
+
+/// A scaled instance of another shape. The instances share the data of the original, like the BVH of the triangle
+/// meshes.
+class PhysicsScaledShape final : public PhysicsCollisionShape
+{
+	ANKI_PHYSICS_OBJECT
+
+private:
+	PhysicsCollisionShapePtr m_shape;
+	DynamicArray<ClassWrapper<btUniformScalingShape>> m_scaledChildren; ///< The children if it's a compound.
+
+	PhysicsScaledShape(PhysicsWorld* world, PhysicsCollisionShapePtr shape, F32 scale);
+
+	~PhysicsScaledShape();
 };
 /// @}
 
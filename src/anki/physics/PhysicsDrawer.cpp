@@ -5,13 +5,14 @@
 
 #include <anki/physics/PhysicsDrawer.h>
 #include <anki/physics/PhysicsWorld.h>
+#include <anki/util/Hash.h>
 
 namespace anki
 {
 
 void PhysicsDrawer::drawWorld(const PhysicsWorld& world)
 {
-	auto lock = world.lockBtWorld();
+	auto lock = world.lockBtWorldForReading();
 
 	btDynamicsWorld& btWorld = *const_cast<btDynamicsWorld*>(world.getBtWorld());
 
@@ -19,4 +20,74 @@ void PhysicsDrawer::drawWorld(const PhysicsWorld& world)
 	btWorld.debugDrawWorld();
 }
 
+void PhysicsDrawer::drawWorldObjects(const PhysicsWorld& world, Bool staticObjects)
+{
+	auto lock = world.lockBtWorldForReading();
+
+	btDynamicsWorld& btWorld = *const_cast<btDynamicsWorld*>(world.getBtWorld());
+	btWorld.setDebugDrawer(&m_debugDraw);
+
+	// Same as btCollisionWorld::debugDrawWorld() but filter the objects
+	const btIDebugDraw::DefaultColors defaultColors = m_debugDraw.getDefaultColors();
+	const btCollisionObjectArray& objects = btWorld.getCollisionObjectArray();
+	for(I32 i = 0; i < objects.size(); ++i)
+	{
+		const btCollisionObject* obj = objects[i];
+		if(obj->isStaticObject() != staticObjects)
+		{
+			continue;
+		}
+
+		btVector3 color;
+		switch(obj->getActivationState())
+		{
+		case ACTIVE_TAG:
+			color = defaultColors.m_activeObject;
+			break;
+		case ISLAND_SLEEPING:
+			color = defaultColors.m_deactivatedObject;
+			break;
+		case WANTS_DEACTIVATION:
+			color = defaultColors.m_wantsDeactivationObject;
+			break;
+		case DISABLE_DEACTIVATION:
+			color = defaultColors.m_disabledDeactivationObject;
+			break;
+		case DISABLE_SIMULATION:
+			color = defaultColors.m_disabledSimulationObject;
+			break;
+		default:
+			color = btVector3(1.0f, 0.0f, 0.0f);
+		}
+
+		btWorld.debugDrawObject(obj->getWorldTransform(), obj->getCollisionShape(), color);
+
+		btVector3 aabbMin, aabbMax;
+		obj->getCollisionShape()->getAabb(obj->getWorldTransform(), aabbMin, aabbMax);
+		m_debugDraw.drawAabb(aabbMin, aabbMax, defaultColors.m_aabb);
+	}
+}
+
+U64 PhysicsDrawer::computeStaticObjectsHash(const PhysicsWorld& world) const
+{
+	auto lock = world.lockBtWorldForReading();
+
+	const btCollisionObjectArray& objects = world.getBtWorld()->getCollisionObjectArray();
+	U64 hash = 1;
+	for(I32 i = 0; i < objects.size(); ++i)
+	{
+		const btCollisionObject* obj = objects[i];
+		if(!obj->isStaticObject())
+		{
+			continue;
+		}
+
+		const btTransform& trf = obj->getWorldTransform();
+		hash = appendHash(&obj, sizeof(obj), hash);
+		hash = appendHash(&trf, sizeof(trf), hash);
+	}
+
+	return hash;
+}
+
 } // end namespace anki
@@ -27,6 +27,13 @@ public:
 
 	void drawWorld(const PhysicsWorld& world);
 
+	/// Draw only the static or only the non-static objects of the world.
+	void drawWorldObjects(const PhysicsWorld& world, Bool staticObjects);
+
+	/// Compute a hash of the static objects of the world and their transforms. It changes when the static part of the
+	/// world changes.
+	U64 computeStaticObjectsHash(const PhysicsWorld& world) const;
+
 private:
 	class DebugDraw : public btIDebugDraw
 	{
@@ -7,6 +7,7 @@
 
 #include <anki/physics/Common.h>
 #include <anki/util/List.h>
+#include <anki/util/ObjectAllocator.h>
 
 namespace anki
 {
@@ -89,7 +90,9 @@ private:
 
 #define ANKI_PHYSICS_OBJECT \
 	friend class PhysicsWorld; \
-	friend class PhysicsPtrDeleter;
+	friend class PhysicsPtrDeleter; \
+	template<U32> \
+	friend class TypedObjectAllocator;
 
 /// This is a factor that will decide if two filtered objects will be checked for collision.
 /// @memberof PhysicsFilteredObject
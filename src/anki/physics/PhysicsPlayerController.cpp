@@ -24,6 +24,7 @@ PhysicsPlayerController::PhysicsPlayerController(PhysicsWorld* world, const Phys
 	setMaterialMask(PhysicsMaterialBit::ALL);
 
 	m_controller.init(m_ghostObject.get(), m_convexShape.get(), init.m_stepHeight, btVector3(0, 1, 0));
+	m_action.m_player = this;
 
 	{
 		auto lock = getWorld().lockBtWorld();
@@ -32,7 +33,7 @@ PhysicsPlayerController::PhysicsPlayerController(PhysicsWorld* world, const Phys
 		btworld->addCollisionObject(m_ghostObject.get(),
 			btBroadphaseProxy::CharacterFilter,
 			btBroadphaseProxy::StaticFilter | btBroadphaseProxy::DefaultFilter);
-		btworld->addAction(m_controller.get());
+		btworld->addAction(&m_action);
 	}
 
 	// Need to call this else the player is upside down
@@ -43,7 +44,7 @@ PhysicsPlayerController::~PhysicsPlayerController()
 {
 	{
 		auto lock = getWorld().lockBtWorld();
-		getWorld().getBtWorld()->removeAction(m_controller.get());
+		getWorld().getBtWorld()->removeAction(&m_action);
 		getWorld().getBtWorld()->removeCollisionObject(m_ghostObject.get());
 	}
 
@@ -63,4 +64,20 @@ void PhysicsPlayerController::moveToPosition(const Vec4& position)
 	m_controller->warp(toBt(position.xyz()));
 }
 
+void PhysicsPlayerController::MyAction::updateAction(btCollisionWorld* world, btScalar dt)
+{
+	m_skippedTime += dt;
+	if(++m_skippedStepCount < m_updateInterval)
+	{
+		return;
+	}
+
+	// Catch up with the skipped steps. The walk direction is per step
+	m_player->m_controller->setWalkDirection(toBt(m_player->m_walkDirection * F32(m_skippedStepCount)));
+	m_player->m_controller->updateAction(world, m_skippedTime);
+
+	m_skippedStepCount = 0;
+	m_skippedTime = 0.0f;
+}
+
 } // end namespace anki
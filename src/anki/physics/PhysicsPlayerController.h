@@ -37,7 +37,14 @@ public:
 	// Update the state machine
 	void setVelocity(F32 forwardSpeed, F32 strafeSpeed, F32 jumpSpeed, const Vec4& forwardDir)
 	{
-		m_controller->setWalkDirection(toBt((forwardDir * forwardSpeed).xyz()));
+		m_walkDirection = (forwardDir * forwardSpeed).xyz();
+	}
+
+	/// Update the controller every that many simulation steps. The far away controllers don't need every step.
+	void setUpdateInterval(U32 stepCount)
+	{
+		ANKI_ASSERT(stepCount > 0);
+		m_action.m_updateInterval = stepCount;
 	}
 
 	void moveToPosition(const Vec4& position);
@@ -50,11 +57,30 @@ public:
 	}
 
 private:
+	/// Runs the controller in a subset of the simulation steps.
+	class MyAction : public btActionInterface
+	{
+	public:
+		PhysicsPlayerController* m_player = nullptr;
+		U32 m_updateInterval = 1;
+		U32 m_skippedStepCount = 0;
+		F32 m_skippedTime = 0.0f;
+
+		void updateAction(btCollisionWorld* world, btScalar dt) override;
+
+		void debugDraw(btIDebugDraw* debugDrawer) override
+		{
+			m_player->m_controller->debugDraw(debugDrawer);
+		}
+	};
+
 	ClassWrapper<btPairCachingGhostObject> m_ghostObject;
 	ClassWrapper<btCapsuleShape> m_convexShape;
 	ClassWrapper<btKinematicCharacterController> m_controller;
 
 	Transform m_prevTrf = Transform::getIdentity();
+	Vec3 m_walkDirection = Vec3(0.0f); ///< The distance to walk in a simulation step.
+	MyAction m_action;
 
 	PhysicsPlayerController(PhysicsWorld* world, const PhysicsPlayerControllerInitInfo& init);
 
@@ -11,32 +11,82 @@
 namespace anki
 {
 
+/// Gathers the objects of the broadphase that touch the trigger.
+class PhysicsTrigger::MyAabbCallback : public btBroadphaseAabbCallback
+{
+public:
+	PhysicsTrigger* m_trigger = nullptr;
+	DynamicArrayAuto<PhysicsFilteredObject*>* m_contacts = nullptr;
+
+	bool process(const btBroadphaseProxy* proxy) override
+	{
+		const btCollisionObject* cobj = static_cast<const btCollisionObject*>(proxy->m_clientObject);
+		PhysicsObject* pobj = static_cast<PhysicsObject*>(cobj->getUserPointer());
+		if(pobj)
+		{
+			PhysicsFilteredObject& fobj = dcast<PhysicsFilteredObject&>(*pobj);
+			if(PhysicsWorld::needsCollision(*m_trigger, fobj))
+			{
+				m_contacts->emplaceBack(&fobj);
+			}
+		}
+
+		return true;
+	}
+};
+
 PhysicsTrigger::PhysicsTrigger(PhysicsWorld* world, PhysicsCollisionShapePtr shape)
 	: PhysicsFilteredObject(CLASS_TYPE, world)
 {
 	m_shape = shape;
 
-	m_ghostShape.init();
-	m_ghostShape->setWorldTransform(btTransform::getIdentity());
-	m_ghostShape->setCollisionShape(shape->getBtShape(true));
-
-	m_ghostShape->setUserPointer(static_cast<PhysicsObject*>(this));
-
 	setMaterialGroup(PhysicsMaterialBit::TRIGGER);
 	setMaterialMask(PhysicsMaterialBit::ALL);
-
-	auto lock = getWorld().lockBtWorld();
-	getWorld().getBtWorld()->addCollisionObject(m_ghostShape.get());
 }
 
 PhysicsTrigger::~PhysicsTrigger()
 {
+	m_contacts.destroy(getAllocator());
+	m_prevContacts.destroy(getAllocator());
+}
+
+void PhysicsTrigger::gatherContacts()
+{
+	if(m_contactCallback == nullptr)
 	{
-		auto lock = getWorld().lockBtWorld();
-		getWorld().getBtWorld()->removeCollisionObject(m_ghostShape.get());
+		return;
 	}
 
-	m_ghostShape.destroy();
+	// The contacts of the last update become the previous
+	std::swap(m_contacts, m_prevContacts);
+	std::swap(m_contactCount, m_prevContactCount);
+
+	// Gather the objects
+	DynamicArrayAuto<PhysicsFilteredObject*> contacts(getWorld().getTempAllocator());
+	MyAabbCallback callback;
+	callback.m_trigger = this;
+	callback.m_contacts = &contacts;
+
+	btVector3 aabbMin, aabbMax;
+	m_shape->getBtShape(true)->getAabb(m_trf, aabbMin, aabbMax);
+	getWorld().getBtWorld()->getBroadphase()->aabbTest(aabbMin, aabbMax, callback);
+
+	const U32 pairCount = contacts.getSize();
+	if(pairCount > m_contacts.getSize())
+	{
+		const U32 newStorage = max(pairCount, m_contacts.getSize() * 2);
+		m_contacts.destroy(getAllocator());
+		m_contacts.create(getAllocator(), newStorage);
+	}
+
+	for(U32 i = 0; i < pairCount; ++i)
+	{
+		m_contacts[i] = contacts[i];
+	}
+
+	// Sort them and remove the duplicates so they can be diffed against the previous
+	std::sort(m_contacts.getBegin(), m_contacts.getBegin() + pairCount);
+	m_contactCount = U32(std::unique(m_contacts.getBegin(), m_contacts.getBegin() + pairCount) - m_contacts.getBegin());
 }
 
 void PhysicsTrigger::processContacts()
@@ -46,23 +96,62 @@ void PhysicsTrigger::processContacts()
 		return;
 	}
 
-	if(m_ghostShape->getOverlappingPairs().size() < 0)
+	// Find the objects that entered and exited. Both lists are sorted so walk them together
+	StackAllocator<U8> tmpAlloc = getWorld().getTempAllocator();
+	PhysicsFilteredObject** entered =
+		(m_contactCount) ? tmpAlloc.newArray<PhysicsFilteredObject*>(m_contactCount) : nullptr;
+	PhysicsFilteredObject** exited =
+		(m_prevContactCount) ? tmpAlloc.newArray<PhysicsFilteredObject*>(m_prevContactCount) : nullptr;
+	U32 enteredCount = 0;
+	U32 exitedCount = 0;
+
+	U32 crnt = 0;
+	U32 prev = 0;
+	while(crnt < m_contactCount || prev < m_prevContactCount)
 	{
-		return;
+		if(prev == m_prevContactCount || (crnt < m_contactCount && m_contacts[crnt] < m_prevContacts[prev]))
+		{
+			entered[enteredCount++] = m_contacts[crnt++];
+		}
+		else if(crnt == m_contactCount || m_prevContacts[prev] < m_contacts[crnt])
+		{
+			exited[exitedCount++] = m_prevContacts[prev++];
+		}
+		else
+		{
+			++crnt;
+			++prev;
+		}
 	}
 
-	// Process contacts
-	for(U32 i = 0; i < U32(m_ghostShape->getOverlappingPairs().size()); ++i)
+	// Steady overlaps don't need any work
+	if(enteredCount == 0 && exitedCount == 0 && !m_contactsForgotten)
 	{
-		btCollisionObject* obj = m_ghostShape->getOverlappingPairs()[i];
-
-		ANKI_ASSERT(obj);
+		return;
+	}
 
-		PhysicsObject* aobj = static_cast<PhysicsObject*>(obj->getUserPointer());
-		ANKI_ASSERT(aobj);
+	m_contactsForgotten = false;
+	m_contactCallback->processContacts(*this,
+		ConstWeakArray<PhysicsFilteredObject*>((m_contactCount) ? &m_contacts[0] : nullptr, m_contactCount),
+		ConstWeakArray<PhysicsFilteredObject*>(entered, enteredCount),
+		ConstWeakArray<PhysicsFilteredObject*>(exited, exitedCount));
+}
 
-		PhysicsFilteredObject* fobj = dcast<PhysicsFilteredObject*>(aobj);
-		m_contactCallback->processContact(*this, *fobj);
+void PhysicsTrigger::forgetContact(const PhysicsFilteredObject& obj)
+{
+	PhysicsFilteredObject* const* begin = m_contacts.getBegin();
+	PhysicsFilteredObject* const* end = begin + m_contactCount;
+	PhysicsFilteredObject* const* it = std::lower_bound(begin, end, &obj);
+	if(it != end && *it == &obj)
+	{
+		const U32 idx = U32(it - begin);
+		for(U32 i = idx + 1; i < m_contactCount; ++i)
+		{
+			m_contacts[i - 1] = m_contacts[i];
+		}
+
+		--m_contactCount;
+		m_contactsForgotten = true;
 	}
 }
 
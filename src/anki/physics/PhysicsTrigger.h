@@ -7,6 +7,7 @@
 
 #include <anki/physics/PhysicsObject.h>
 #include <anki/util/WeakArray.h>
+#include <anki/util/DynamicArray.h>
 #include <anki/util/ClassWrapper.h>
 
 namespace anki
@@ -24,10 +25,21 @@ public:
 	{
 	}
 
-	virtual void processContact(PhysicsTrigger& trigger, PhysicsFilteredObject& obj) = 0;
+	/// Process the contacts of a trigger. It's called once per update and only if the contacts changed.
+	/// @param trigger The trigger.
+	/// @param contacts All the objects that overlap with the trigger. Sorted and without duplicates.
+	/// @param entered The objects that started overlapping with the trigger in this update.
+	/// @param exited The objects that stopped overlapping with the trigger in this update. The objects that were
+	///               destroyed are not included.
+	virtual void processContacts(PhysicsTrigger& trigger,
+		ConstWeakArray<PhysicsFilteredObject*> contacts,
+		ConstWeakArray<PhysicsFilteredObject*> entered,
+		ConstWeakArray<PhysicsFilteredObject*> exited) = 0;
 };
 
-/// A trigger that uses a PhysicsShape and its purpose is to collect collision events.
+/// A trigger that uses a PhysicsShape and its purpose is to collect collision events. The triggers are not part of the
+/// simulation. Every update they query the broadphase of the world with their bounding box so they cost nothing to the
+/// objects they don't touch and the overlaps are filtered like the pairs of the broadphase.
 class PhysicsTrigger : public PhysicsFilteredObject
 {
 	ANKI_PHYSICS_OBJECT
@@ -37,7 +49,7 @@ public:
 
 	void setTransform(const Transform& trf)
 	{
-		m_ghostShape->setWorldTransform(toBt(trf));
+		m_trf = toBt(trf);
 	}
 
 	void setContactProcessCallback(PhysicsTriggerProcessContactCallback* cb)
@@ -46,16 +58,32 @@ public:
 	}
 
 private:
+	class MyAabbCallback;
+
 	PhysicsCollisionShapePtr m_shape;
-	ClassWrapper<btGhostObject> m_ghostShape;
+	btTransform m_trf = btTransform::getIdentity();
 
 	PhysicsTriggerProcessContactCallback* m_contactCallback = nullptr;
 
+	/// The contacts of this and the previous update. The sizes of the arrays are the storage, the counts are the sizes.
+	DynamicArray<PhysicsFilteredObject*> m_contacts;
+	DynamicArray<PhysicsFilteredObject*> m_prevContacts;
+	U32 m_contactCount = 0;
+	U32 m_prevContactCount = 0;
+	Bool m_contactsForgotten = false; ///< Some contacts were destroyed since the last update.
+
 	PhysicsTrigger(PhysicsWorld* world, PhysicsCollisionShapePtr shape);
 
 	~PhysicsTrigger();
 
+	/// Collect the objects that overlap with the bounding box of the trigger. The world should be locked.
+	void gatherContacts();
+
+	/// Call the callback if the contacts changed since the last update.
 	void processContacts();
+
+	/// Remove an object that is about to be destroyed from the contacts.
+	void forgetContact(const PhysicsFilteredObject& obj);
 };
 /// @}
 
@@ -8,7 +8,10 @@
 #include <anki/physics/PhysicsBody.h>
 #include <anki/physics/PhysicsTrigger.h>
 #include <anki/util/Rtti.h>
+#include <anki/util/ThreadHive.h>
 #include <BulletCollision/Gimpact/btGImpactCollisionAlgorithm.h>
+#include <BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h>
+#include <BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h>
 
 namespace anki
 {
@@ -48,44 +51,8 @@ public:
 			return false;
 		}
 
-		const PhysicsFilteredObject* fobj0 = dcast<const PhysicsFilteredObject*>(aobj0);
-		const PhysicsFilteredObject* fobj1 = dcast<const PhysicsFilteredObject*>(aobj1);
-
-		// First check the masks
-		Bool collide = !!(fobj0->getMaterialGroup() & fobj1->getMaterialMask());
-		collide = collide && !!(fobj1->getMaterialGroup() & fobj0->getMaterialMask());
-		if(!collide)
-		{
-			return false;
-		}
-
-		// Reject if they are both static
-		if(ANKI_UNLIKELY(fobj0->getMaterialGroup() == PhysicsMaterialBit::STATIC_GEOMETRY
-						 && fobj1->getMaterialGroup() == PhysicsMaterialBit::STATIC_GEOMETRY))
-		{
-			return false;
-		}
-
-		// Detailed tests using callbacks
-		if(fobj0->getPhysicsBroadPhaseFilterCallback())
-		{
-			collide = fobj0->getPhysicsBroadPhaseFilterCallback()->needsCollision(*fobj0, *fobj1);
-			if(!collide)
-			{
-				return false;
-			}
-		}
-
-		if(fobj1->getPhysicsBroadPhaseFilterCallback())
-		{
-			collide = fobj1->getPhysicsBroadPhaseFilterCallback()->needsCollision(*fobj1, *fobj0);
-			if(!collide)
-			{
-				return false;
-			}
-		}
-
-		return true;
+		return PhysicsWorld::needsCollision(
+			dcast<const PhysicsFilteredObject&>(*aobj0), dcast<const PhysicsFilteredObject&>(*aobj1));
 	}
 };
 
@@ -139,7 +106,131 @@ public:
 	}
 };
 
+/// Bullet's task scheduler that runs the parallel loops of the simulation in the ThreadHive.
+class PhysicsWorld::MyTaskScheduler : public btITaskScheduler
+{
+public:
+	ThreadHive* m_hive;
+
+	MyTaskScheduler(ThreadHive& hive)
+		: btITaskScheduler("ThreadHive")
+		, m_hive(&hive)
+	{
+	}
+
+	int getMaxNumThreads() const override
+	{
+		return I32(m_hive->getThreadCount());
+	}
+
+	int getNumThreads() const override
+	{
+		return I32(m_hive->getThreadCount());
+	}
+
+	void setNumThreads(int numThreads) override
+	{
+		// The hive decides
+	}
+
+	void parallelFor(int iBegin, int iEnd, int grainSize, const btIParallelForBody& body) override
+	{
+		m_hive->parallelFor(U32(iEnd - iBegin), U32(max(1, grainSize)), [&](U32 begin, U32 end, U32 threadId) {
+			body.forLoop(iBegin + I32(begin), iBegin + I32(end));
+		});
+	}
+
+	btScalar parallelSum(int iBegin, int iEnd, int grainSize, const btIParallelSumBody& body) override
+	{
+		return m_hive->parallelReduce(U32(iEnd - iBegin),
+			U32(max(1, grainSize)),
+			btScalar(0),
+			[&](U32 begin, U32 end, U32 threadId, btScalar& sum) {
+				sum += body.sumLoop(iBegin + I32(begin), iBegin + I32(end));
+			},
+			[](btScalar a, btScalar b) { return a + b; });
+	}
+};
+
+/// The queries of PhysicsWorld::query() that a hive task runs.
+constexpr U32 QUERIES_PER_TASK = 32;
+
+static Bool materialMaskMatches(const btBroadphaseProxy* proxy, PhysicsMaterialBit materialMask)
+{
+	const btCollisionObject* cobj = static_cast<const btCollisionObject*>(proxy->m_clientObject);
+	const PhysicsObject* pobj = static_cast<const PhysicsObject*>(cobj->getUserPointer());
+	if(pobj == nullptr)
+	{
+		return false;
+	}
+
+	return !!(dcast<const PhysicsFilteredObject*>(pobj)->getMaterialGroup() & materialMask);
+}
+
+static PhysicsFilteredObject* getFilteredObject(const btCollisionObject* cobj)
+{
+	PhysicsObject* pobj = static_cast<PhysicsObject*>(cobj->getUserPointer());
+	ANKI_ASSERT(pobj);
+	return &dcast<PhysicsFilteredObject&>(*pobj);
+}
+
+/// Adds the filtering of the materials to one of the query callbacks of Bullet.
+template<typename TCallback>
+class MaterialFilteredCallback : public TCallback
+{
+public:
+	PhysicsMaterialBit m_materialMask;
+
+	template<typename... TArgs>
+	MaterialFilteredCallback(PhysicsMaterialBit materialMask, TArgs&&... args)
+		: TCallback(std::forward<TArgs>(args)...)
+		, m_materialMask(materialMask)
+	{
+	}
+
+	Bool needsCollision(btBroadphaseProxy* proxy) const override
+	{
+		return materialMaskMatches(proxy, m_materialMask);
+	}
+};
+
+/// Keeps the first contact of an overlap.
+class OverlapCallback : public MaterialFilteredCallback<btCollisionWorld::ContactResultCallback>
+{
+public:
+	const btCollisionObject* m_self = nullptr;
+	PhysicsWorldQueryResult* m_result = nullptr;
+
+	OverlapCallback(PhysicsMaterialBit materialMask)
+		: MaterialFilteredCallback(materialMask)
+	{
+	}
+
+	btScalar addSingleResult(btManifoldPoint& cp,
+		const btCollisionObjectWrapper* colObj0Wrap,
+		int partId0,
+		int index0,
+		const btCollisionObjectWrapper* colObj1Wrap,
+		int partId1,
+		int index1) override
+	{
+		if(m_result->m_object)
+		{
+			return 0.0f;
+		}
+
+		const Bool selfIsA = colObj0Wrap->getCollisionObject() == m_self;
+		const btCollisionObjectWrapper* other = (selfIsA) ? colObj1Wrap : colObj0Wrap;
+		m_result->m_object = getFilteredObject(other->getCollisionObject());
+		m_result->m_worldPosition = toAnki((selfIsA) ? cp.getPositionWorldOnB() : cp.getPositionWorldOnA());
+		m_result->m_worldNormal = toAnki((selfIsA) ? cp.m_normalWorldOnB : -cp.m_normalWorldOnB);
+		m_result->m_hitFraction = 0.0f;
+		return 0.0f;
+	}
+};
+
 PhysicsWorld::PhysicsWorld()
+	: m_asyncThread("Physics")
 {
 }
 
@@ -152,18 +243,26 @@ PhysicsWorld::~PhysicsWorld()
 	}
 #endif
 
-	m_world.destroy();
-	m_solver.destroy();
-	m_dispatcher.destroy();
+	enableAsyncUpdate(false);
+
+	m_alloc.deleteInstance(m_world);
+	m_alloc.deleteInstance(m_solver);
+	m_alloc.deleteInstance(m_dispatcher);
+	if(m_taskScheduler)
+	{
+		btSetTaskScheduler(nullptr);
+		m_alloc.deleteInstance(m_taskScheduler);
+	}
 	m_collisionConfig.destroy();
 	m_broadphase.destroy();
 	m_gpc.destroy();
 	m_alloc.deleteInstance(m_filterCallback);
+	m_objectAlloc.destroy(m_alloc);
 
 	gAlloc = nullptr;
 }
 
-Error PhysicsWorld::create(AllocAlignedCallback allocCb, void* allocCbData)
+Error PhysicsWorld::create(AllocAlignedCallback allocCb, void* allocCbData, ThreadHive* hive)
 {
 	m_alloc = HeapAllocator<U8>(allocCb, allocCbData);
 	m_tmpAlloc = StackAllocator<U8>(allocCb, allocCbData, 1_KB, 2.0f);
@@ -181,29 +280,165 @@ Error PhysicsWorld::create(AllocAlignedCallback allocCb, void* allocCbData)
 
 	m_collisionConfig.init();
 
-	m_dispatcher.init(m_collisionConfig.get());
-	btGImpactCollisionAlgorithm::registerAlgorithm(m_dispatcher.get());
+	// Bullet indexes its per thread data with the thread index so the threads can't be more than it supports
+	if(hive && hive->getThreadCount() > 1 && hive->getThreadCount() < BT_MAX_THREAD_COUNT)
+	{
+		m_taskScheduler = m_alloc.newInstance<MyTaskScheduler>(*hive);
+		btSetTaskScheduler(m_taskScheduler);
 
-	m_solver.init();
+		m_dispatcher = m_alloc.newInstance<btCollisionDispatcherMt>(m_collisionConfig.get());
+		btGImpactCollisionAlgorithm::registerAlgorithm(m_dispatcher);
+
+		// A pool of sequential solvers that solve the islands in parallel
+		btConstraintSolverPoolMt* solverPool =
+			m_alloc.newInstance<btConstraintSolverPoolMt>(I32(hive->getThreadCount()));
+		m_solver = solverPool;
+
+		m_world = m_alloc.newInstance<btDiscreteDynamicsWorldMt>(
+			m_dispatcher, m_broadphase.get(), solverPool, nullptr, m_collisionConfig.get());
+
+		ANKI_PHYS_LOGI("Stepping the physics in %u threads", hive->getThreadCount());
+	}
+	else
+	{
+		m_dispatcher = m_alloc.newInstance<btCollisionDispatcher>(m_collisionConfig.get());
+		btGImpactCollisionAlgorithm::registerAlgorithm(m_dispatcher);
+
+		m_solver = m_alloc.newInstance<btSequentialImpulseConstraintSolver>();
+
+		m_world = m_alloc.newInstance<btDiscreteDynamicsWorld>(
+			m_dispatcher, m_broadphase.get(), m_solver, m_collisionConfig.get());
+	}
 
-	m_world.init(m_dispatcher.get(), m_broadphase.get(), m_solver.get(), m_collisionConfig.get());
 	m_world->setGravity(btVector3(0.0f, -9.8f, 0.0f));
 
 	return Error::NONE;
 }
 
 Error PhysicsWorld::update(Second dt)
+{
+	if(!m_asyncEnabled)
+	{
+		return updateInternal(dt);
+	}
+
+	ANKI_CHECK(waitUpdate());
+
+	LockGuard<Mutex> lock(m_asyncMtx);
+	m_asyncDt = dt;
+	m_asyncPending = true;
+	m_asyncCondVar.notifyAll();
+	return Error::NONE;
+}
+
+Error PhysicsWorld::waitUpdate()
+{
+	if(!m_asyncEnabled)
+	{
+		return Error::NONE;
+	}
+
+	LockGuard<Mutex> lock(m_asyncMtx);
+	while(m_asyncPending)
+	{
+		m_asyncCondVar.wait(m_asyncMtx);
+	}
+
+	const Error err = m_asyncErr;
+	m_asyncErr = Error::NONE;
+	return err;
+}
+
+void PhysicsWorld::enableAsyncUpdate(Bool enable)
+{
+	ANKI_ASSERT(!(enable && m_taskScheduler) && "The physics thread can't wait on the hive");
+	if(enable == m_asyncEnabled)
+	{
+		return;
+	}
+
+	if(enable)
+	{
+		m_asyncQuit = false;
+		m_asyncThread.start(this, asyncThreadCallback);
+		m_asyncEnabled = true;
+	}
+	else
+	{
+		Error err = waitUpdate();
+		(void)err;
+
+		{
+			LockGuard<Mutex> lock(m_asyncMtx);
+			m_asyncQuit = true;
+			m_asyncCondVar.notifyAll();
+		}
+
+		err = m_asyncThread.join();
+		(void)err;
+		m_asyncEnabled = false;
+	}
+}
+
+Error PhysicsWorld::asyncThreadCallback(ThreadCallbackInfo& info)
+{
+	PhysicsWorld& self = *static_cast<PhysicsWorld*>(info.m_userData);
+
+	while(true)
+	{
+		Second dt;
+		{
+			LockGuard<Mutex> lock(self.m_asyncMtx);
+			while(!self.m_asyncPending && !self.m_asyncQuit)
+			{
+				self.m_asyncCondVar.wait(self.m_asyncMtx);
+			}
+
+			if(self.m_asyncQuit)
+			{
+				break;
+			}
+
+			dt = self.m_asyncDt;
+		}
+
+		const Error err = self.updateInternal(dt);
+
+		LockGuard<Mutex> lock(self.m_asyncMtx);
+		self.m_asyncErr = err;
+		self.m_asyncPending = false;
+		self.m_asyncCondVar.notifyAll();
+	}
+
+	return Error::NONE;
+}
+
+Error PhysicsWorld::updateInternal(Second dt)
 {
 	// Update world
 	{
 		auto lock = lockBtWorld();
+#if ANKI_ASSERTS_ENABLED
+		m_stepping.store(true);
+#endif
 		m_world->stepSimulation(F32(dt), 1, 1.0f / 60.0f);
+#if ANKI_ASSERTS_ENABLED
+		m_stepping.store(false);
+#endif
 	}
 
-	// Process trigger contacts
+	// Process trigger contacts. Gather all of them first since the callbacks might change the world
 	{
 		LockGuard<Mutex> lock(m_objectListsMtx);
 
+		{
+			auto worldLock = lockBtWorldForReading();
+			for(PhysicsObject& trigger : m_objectLists[PhysicsObjectType::TRIGGER])
+			{
+				static_cast<PhysicsTrigger&>(trigger).gatherContacts();
+			}
+		}
+
 		for(PhysicsObject& trigger : m_objectLists[PhysicsObjectType::TRIGGER])
 		{
 			static_cast<PhysicsTrigger&>(trigger).processContacts();
@@ -216,6 +451,45 @@ Error PhysicsWorld::update(Second dt)
 	return Error::NONE;
 }
 
+Bool PhysicsWorld::needsCollision(const PhysicsFilteredObject& fobj0, const PhysicsFilteredObject& fobj1)
+{
+	// First check the masks
+	Bool collide = !!(fobj0.getMaterialGroup() & fobj1.getMaterialMask());
+	collide = collide && !!(fobj1.getMaterialGroup() & fobj0.getMaterialMask());
+	if(!collide)
+	{
+		return false;
+	}
+
+	// Reject if they are both static
+	if(ANKI_UNLIKELY(fobj0.getMaterialGroup() == PhysicsMaterialBit::STATIC_GEOMETRY
+					 && fobj1.getMaterialGroup() == PhysicsMaterialBit::STATIC_GEOMETRY))
+	{
+		return false;
+	}
+
+	// Detailed tests using callbacks
+	if(fobj0.getPhysicsBroadPhaseFilterCallback())
+	{
+		collide = fobj0.getPhysicsBroadPhaseFilterCallback()->needsCollision(fobj0, fobj1);
+		if(!collide)
+		{
+			return false;
+		}
+	}
+
+	if(fobj1.getPhysicsBroadPhaseFilterCallback())
+	{
+		collide = fobj1.getPhysicsBroadPhaseFilterCallback()->needsCollision(fobj1, fobj0);
+		if(!collide)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
 void PhysicsWorld::destroyObject(PhysicsObject* obj)
 {
 	ANKI_ASSERT(obj);
@@ -223,10 +497,104 @@ void PhysicsWorld::destroyObject(PhysicsObject* obj)
 	{
 		LockGuard<Mutex> lock(m_objectListsMtx);
 		m_objectLists[obj->getType()].erase(obj);
+
+		// Don't let the triggers hold it
+		if(obj->getType() >= PhysicsObjectType::FIRST_FILTERED && obj->getType() <= PhysicsObjectType::LAST_FILTERED)
+		{
+			for(PhysicsObject& trigger : m_objectLists[PhysicsObjectType::TRIGGER])
+			{
+				static_cast<PhysicsTrigger&>(trigger).forgetContact(static_cast<PhysicsFilteredObject&>(*obj));
+			}
+		}
+	}
+
+	m_objectAlloc.deleteInstance(m_alloc, obj);
+}
+
+void PhysicsWorld::query(ConstWeakArray<PhysicsWorldQuery> queries,
+	WeakArray<PhysicsWorldQueryResult> results,
+	ThreadHive* hive) const
+{
+	ANKI_ASSERT(queries.getSize() == results.getSize());
+	ANKI_ASSERT(!m_stepping.load() && "The world can't be queried while it steps");
+
+	// Bullet has per thread data for the casts and it supports a limited number of threads. The hive tasks can't wait
+	// on other tasks
+	if(hive && queries.getSize() > QUERIES_PER_TASK && hive->getThreadCount() < BT_MAX_THREAD_COUNT
+		&& !hive->isHiveThread())
+	{
+		hive->parallelFor(queries.getSize(), QUERIES_PER_TASK, [&](U32 begin, U32 end, U32 threadId) {
+			for(U32 i = begin; i < end; ++i)
+			{
+				runQuery(queries[i], results[i]);
+			}
+		});
 	}
+	else
+	{
+		for(U32 i = 0; i < queries.getSize(); ++i)
+		{
+			runQuery(queries[i], results[i]);
+		}
+	}
+}
+
+void PhysicsWorld::runQuery(const PhysicsWorldQuery& query, PhysicsWorldQueryResult& result) const
+{
+	result = PhysicsWorldQueryResult();
+	const btVector3 from = toBt(query.m_from);
+	const btVector3 to = toBt(query.m_to);
 
-	obj->~PhysicsObject();
-	m_alloc.getMemoryPool().free(obj);
+	switch(query.m_type)
+	{
+	case PhysicsWorldQueryType::RAY_CAST:
+	{
+		MaterialFilteredCallback<btCollisionWorld::ClosestRayResultCallback> callback(query.m_materialMask, from, to);
+		m_world->rayTest(from, to, callback);
+		if(callback.hasHit())
+		{
+			result.m_object = getFilteredObject(callback.m_collisionObject);
+			result.m_worldPosition = toAnki(callback.m_hitPointWorld);
+			result.m_worldNormal = toAnki(callback.m_hitNormalWorld);
+			result.m_hitFraction = callback.m_closestHitFraction;
+		}
+		break;
+	}
+	case PhysicsWorldQueryType::SPHERE_CAST:
+	{
+		ANKI_ASSERT(query.m_radius > 0.0f);
+		btSphereShape sphere(query.m_radius);
+		MaterialFilteredCallback<btCollisionWorld::ClosestConvexResultCallback> callback(
+			query.m_materialMask, from, to);
+		const btTransform fromTrf(btQuaternion::getIdentity(), from);
+		const btTransform toTrf(btQuaternion::getIdentity(), to);
+		m_world->convexSweepTest(&sphere, fromTrf, toTrf, callback);
+		if(callback.hasHit())
+		{
+			result.m_object = getFilteredObject(callback.m_hitCollisionObject);
+			result.m_worldPosition = toAnki(callback.m_hitPointWorld);
+			result.m_worldNormal = toAnki(callback.m_hitNormalWorld);
+			result.m_hitFraction = callback.m_closestHitFraction;
+		}
+		break;
+	}
+	case PhysicsWorldQueryType::SPHERE_OVERLAP:
+	{
+		ANKI_ASSERT(query.m_radius > 0.0f);
+		btSphereShape sphere(query.m_radius);
+		btCollisionObject obj;
+		obj.setCollisionShape(&sphere);
+		obj.setWorldTransform(btTransform(btQuaternion::getIdentity(), from));
+
+		OverlapCallback callback(query.m_materialMask);
+		callback.m_self = &obj;
+		callback.m_result = &result;
+		m_world->contactTest(&obj, callback);
+		break;
+	}
+	default:
+		ANKI_ASSERT(0);
+	}
 }
 
 void PhysicsWorld::rayCast(WeakArray<PhysicsWorldRayCastCallback*> rayCasts)
@@ -10,6 +10,8 @@
 #include <anki/util/List.h>
 #include <anki/util/WeakArray.h>
 #include <anki/util/ClassWrapper.h>
+#include <anki/util/ObjectAllocator.h>
+#include <anki/util/Thread.h>
 
 namespace anki
 {
@@ -37,6 +39,36 @@ public:
 	virtual void processResult(PhysicsFilteredObject& obj, const Vec3& worldNormal, const Vec3& worldPosition) = 0;
 };
 
+/// The type of a PhysicsWorldQuery.
+enum class PhysicsWorldQueryType : U8
+{
+	RAY_CAST,
+	SPHERE_CAST,
+	SPHERE_OVERLAP
+};
+
+/// A read-only query of the world. See PhysicsWorld::query().
+class PhysicsWorldQuery
+{
+public:
+	Vec3 m_from = Vec3(0.0f); ///< The start of the cast or the center of the overlap.
+	Vec3 m_to = Vec3(0.0f); ///< The end of the cast. Not used by the overlaps.
+	F32 m_radius = 0.0f; ///< The radius of the sphere of the sphere queries.
+	PhysicsMaterialBit m_materialMask = PhysicsMaterialBit::ALL; ///< Materials to check.
+	PhysicsWorldQueryType m_type = PhysicsWorldQueryType::RAY_CAST;
+};
+
+/// The result of a PhysicsWorldQuery.
+class PhysicsWorldQueryResult
+{
+public:
+	/// The closest object the cast hit or an object the overlap touches. It's nullptr if nothing was hit.
+	PhysicsFilteredObject* m_object = nullptr;
+	Vec3 m_worldPosition = Vec3(0.0f);
+	Vec3 m_worldNormal = Vec3(0.0f);
+	F32 m_hitFraction = 1.0f; ///< Where the hit is between the m_from and m_to of the cast.
+};
+
 /// The master container for all physics related stuff.
 class PhysicsWorld
 {
@@ -44,13 +76,14 @@ public:
 	PhysicsWorld();
 	~PhysicsWorld();
 
-	ANKI_USE_RESULT Error create(AllocAlignedCallback allocCb, void* allocCbData);
+	/// @param hive If it's not nullptr the collision detection and the constraint solving of the update() are spread to
+	///             the threads of the hive. The hive should be idle during the update().
+	ANKI_USE_RESULT Error create(AllocAlignedCallback allocCb, void* allocCbData, ThreadHive* hive = nullptr);
 
 	template<typename T, typename... TArgs>
 	PhysicsPtr<T> newInstance(TArgs&&... args)
 	{
-		T* obj = static_cast<T*>(m_alloc.getMemoryPool().allocate(sizeof(T), alignof(T)));
-		::new(obj) T(this, std::forward<TArgs>(args)...);
+		T* obj = m_objectAlloc.newInstance<T>(m_alloc, this, std::forward<TArgs>(args)...);
 
 		LockGuard<Mutex> lock(m_objectListsMtx);
 		m_objectLists[obj->getType()].pushBack(obj);
@@ -58,9 +91,22 @@ public:
 		return PhysicsPtr<T>(obj);
 	}
 
-	/// Do the update.
+	/// Do the update. If the async update is enabled it starts the update in the physics thread and returns.
 	Error update(Second dt);
 
+	/// Run the update() in a thread of its own so it can overlap with other work, like the rendering. The results of an
+	/// update() are visible after the waitUpdate() that follows it and no physics object should be modified in between.
+	/// It can't be combined with the ThreadHive of create().
+	void enableAsyncUpdate(Bool enable);
+
+	Bool getAsyncUpdateEnabled() const
+	{
+		return m_asyncEnabled;
+	}
+
+	/// Wait for the update() that runs in the physics thread. It does nothing if the async update is disabled.
+	Error waitUpdate();
+
 	HeapAllocator<U8> getAllocator() const
 	{
 		return m_alloc;
@@ -71,6 +117,12 @@ public:
 		return m_alloc;
 	}
 
+	/// The allocator of the physics objects. Use it to get the per type statistics.
+	const TypedObjectAllocator<64>& getObjectAllocator() const
+	{
+		return m_objectAlloc;
+	}
+
 	void rayCast(WeakArray<PhysicsWorldRayCastCallback*> rayCasts);
 
 	void rayCast(PhysicsWorldRayCastCallback& raycast)
@@ -80,14 +132,25 @@ public:
 		rayCast(arr);
 	}
 
+	/// Run a batch of read-only queries. It doesn't lock the world so it never waits. The world shouldn't change while
+	/// the queries run: call it when no update() is running (after the waitUpdate() if the async update is enabled) and
+	/// don't create, destroy or move physics objects at the same time. Many threads can run batches at the same time.
+	/// @param queries The queries.
+	/// @param[out] results One result per query.
+	/// @param hive If it's not nullptr the queries are spread to the threads of the hive. If it's called from a task of
+	///             the hive the queries run in the calling thread.
+	void query(ConstWeakArray<PhysicsWorldQuery> queries,
+		WeakArray<PhysicsWorldQueryResult> results,
+		ThreadHive* hive = nullptr) const;
+
 	ANKI_INTERNAL btDynamicsWorld* getBtWorld()
 	{
-		return m_world.get();
+		return m_world;
 	}
 
 	ANKI_INTERNAL const btDynamicsWorld* getBtWorld() const
 	{
-		return m_world.get();
+		return m_world;
 	}
 
 	ANKI_INTERNAL F32 getCollisionMargin() const
@@ -95,32 +158,72 @@ public:
 		return 0.04f;
 	}
 
-	ANKI_INTERNAL ANKI_USE_RESULT LockGuard<Mutex> lockBtWorld() const
+	ANKI_INTERNAL ANKI_USE_RESULT WLockGuard<RWMutex> lockBtWorld() const
+	{
+		return WLockGuard<RWMutex>(m_btWorldMtx);
+	}
+
+	/// Lock the world for the operations that don't change it.
+	ANKI_INTERNAL ANKI_USE_RESULT RLockGuard<RWMutex> lockBtWorldForReading() const
+	{
+		return RLockGuard<RWMutex>(m_btWorldMtx);
+	}
+
+	/// An allocator for temporary memory. It's reset at the end of the update.
+	ANKI_INTERNAL StackAllocator<U8> getTempAllocator() const
 	{
-		return LockGuard<Mutex>(m_btWorldMtx);
+		return m_tmpAlloc;
 	}
 
 	ANKI_INTERNAL void destroyObject(PhysicsObject* obj);
 
+	/// The filtering of the pairs of the broadphase. The triggers use it too.
+	ANKI_INTERNAL static Bool needsCollision(const PhysicsFilteredObject& a, const PhysicsFilteredObject& b);
+
 private:
 	class MyOverlapFilterCallback;
 	class MyRaycastCallback;
+	class MyTaskScheduler;
 
 	HeapAllocator<U8> m_alloc;
 	StackAllocator<U8> m_tmpAlloc;
+	TypedObjectAllocator<64> m_objectAlloc;
 
 	ClassWrapper<btDbvtBroadphase> m_broadphase;
 	ClassWrapper<btGhostPairCallback> m_gpc;
 	MyOverlapFilterCallback* m_filterCallback = nullptr;
 
 	ClassWrapper<btDefaultCollisionConfiguration> m_collisionConfig;
-	ClassWrapper<btCollisionDispatcher> m_dispatcher;
-	ClassWrapper<btSequentialImpulseConstraintSolver> m_solver;
-	ClassWrapper<btDiscreteDynamicsWorld> m_world;
-	mutable Mutex m_btWorldMtx;
+	MyTaskScheduler* m_taskScheduler = nullptr; ///< If it's not nullptr the objects below are the multithreaded ones.
+	btCollisionDispatcher* m_dispatcher = nullptr;
+	btConstraintSolver* m_solver = nullptr;
+	btDiscreteDynamicsWorld* m_world = nullptr;
+	mutable RWMutex m_btWorldMtx;
 
 	Array<IntrusiveList<PhysicsObject>, U(PhysicsObjectType::COUNT)> m_objectLists;
 	mutable Mutex m_objectListsMtx;
+
+	/// @name Async update
+	/// @{
+	Thread m_asyncThread;
+	Mutex m_asyncMtx;
+	ConditionVariable m_asyncCondVar; ///< Signals both the new updates and the finished ones.
+	Second m_asyncDt = 0.0;
+	Error m_asyncErr = Error::NONE;
+	Bool m_asyncEnabled = false;
+	Bool m_asyncPending = false;
+	Bool m_asyncQuit = false;
+
+#if ANKI_ASSERTS_ENABLED
+	Atomic<Bool> m_stepping = {false}; ///< The query() can't run while the world steps.
+#endif
+	/// @}
+
+	Error updateInternal(Second dt);
+
+	void runQuery(const PhysicsWorldQuery& query, PhysicsWorldQueryResult& result) const;
+
+	static Error asyncThreadCallback(ThreadCallbackInfo& info);
 };
 /// @}
 
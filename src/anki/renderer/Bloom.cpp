@@ -53,8 +53,9 @@ Error Bloom::initExposure(const ConfigSet& config)
 
 Error Bloom::initUpscale(const ConfigSet& config)
 {
-	m_upscale.m_width = m_r->getWidth() / BLOOM_FRACTION;
-	m_upscale.m_height = m_r->getHeight() / BLOOM_FRACTION;
+	const U32 divisor = config.getNumberU32("r_bloomResolutionDivisor");
+	m_upscale.m_width = m_r->getWidth() / divisor;
+	m_upscale.m_height = m_r->getHeight() / divisor;
 
 	// Create RT descr
 	m_upscale.m_rtDescr =
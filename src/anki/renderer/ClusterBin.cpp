@@ -39,6 +39,29 @@ static Bool insideClusterFrustum(const Array<Plane, 4>& planeArr, const TShape&
 	return true;
 }
 
+/// Test spheres in SoA layout against the planes of a tile.
+/// @return Bit i is set if the i-th sphere is inside the tile.
+static U32 insideClusterFrustum(const Array<Plane, 4>& planeArr, const Vec3x8& centers, const F32x8& radii)
+{
+	U32 mask = F32x8::ALL_LANES_MASK;
+	for(const Plane& plane : planeArr)
+	{
+		const F32x8 dist = Vec3x8(plane.getNormal().xyz()).dot(centers) - F32x8(plane.getOffset());
+		mask &= (dist + radii >= F32x8(0.0f)).getMask();
+	}
+
+	return mask;
+}
+
+/// Get a mask with the bits of the lanes between first and last (inclusive) set. The lanes start from groupFirst.
+static U32 computeLaneMask(U32 groupFirst, U32 first, U32 last)
+{
+	ANKI_ASSERT(last >= groupFirst);
+	const U32 begin = (first > groupFirst) ? first - groupFirst : 0;
+	const U32 end = min(last - groupFirst + 1, F32x8::LANE_COUNT);
+	return ((1u << end) - 1u) & ~((1u << begin) - 1u);
+}
+
 /// Bin context.
 class ClusterBin::BinCtx
 {
@@ -55,12 +78,41 @@ public:
 	WeakArray<U32> m_lightIds;
 	WeakArray<U32> m_clusters;
 
-	Atomic<U32> m_tileIdxToProcess = {0};
 	Atomic<U32> m_allocatedIndexCount = {TYPED_OBJECT_COUNT};
 
 	Vec4 m_unprojParams;
 
 	Bool m_clusterEdgesDirty;
+
+	/// The slices of the clusters that an object touches. It's empty if m_first > m_last.
+	class ZRange
+	{
+	public:
+		U32 m_first;
+		U32 m_last;
+	};
+
+	/// A spot light in the form the tiles test it.
+	class SpotLightCone
+	{
+	public:
+		Cone m_cone;
+		F32 m_cosHalfAngle;
+		F32 m_sinHalfAngle;
+	};
+
+	/// @name The bounds of the point and spot lights. The spheres are in SoA layout, F32x8::LANE_COUNT lights per
+	///       element. They are computed once and shared by all the tiles.
+	/// @{
+	WeakArray<Vec3x8> m_pointLightCenters;
+	WeakArray<F32x8> m_pointLightRadii;
+	WeakArray<ZRange> m_pointLightZRanges;
+
+	WeakArray<Vec3x8> m_spotLightCenters; ///< The bounding spheres of the cones.
+	WeakArray<F32x8> m_spotLightRadii;
+	WeakArray<ZRange> m_spotLightZRanges;
+	WeakArray<SpotLightCone> m_spotLightCones;
+	/// @}
 };
 
 class ClusterBin::TileCtx
@@ -76,6 +128,14 @@ public:
 	DynamicArrayAuto<Aabb> m_clusterBoxes;
 	DynamicArrayAuto<Sphere> m_clusterSpheres;
 
+	/// @name The same boxes and spheres in SoA layout. F32x8::LANE_COUNT clusters per element
+	/// @{
+	DynamicArrayAuto<Vec3x8> m_clusterBoxMins;
+	DynamicArrayAuto<Vec3x8> m_clusterBoxMaxs;
+	DynamicArrayAuto<Vec3x8> m_clusterSphereCenters;
+	DynamicArrayAuto<F32x8> m_clusterSphereRadii;
+	/// @}
+
 	DynamicArrayAuto<ClusterMetaInfo> m_clusterInfos;
 	DynamicArrayAuto<U32> m_indices;
 
@@ -85,6 +145,10 @@ public:
 		: m_clusterEdgesWSpace(alloc)
 		, m_clusterBoxes(alloc)
 		, m_clusterSpheres(alloc)
+		, m_clusterBoxMins(alloc)
+		, m_clusterBoxMaxs(alloc)
+		, m_clusterSphereCenters(alloc)
+		, m_clusterSphereRadii(alloc)
 		, m_clusterInfos(alloc)
 		, m_indices(alloc)
 	{
@@ -115,6 +179,7 @@ void ClusterBin::init(
 	m_totalClusterCount = clusterCountX * clusterCountY * clusterCountZ;
 
 	m_avgObjectsPerCluster = cfg.getNumberU32("r_avgObjectsPerCluster");
+	m_binsOnGpu = cfg.getBool("r_gpuClusterBinning");
 
 	// The actual indices per cluster are
 	// - the object indices per cluster
@@ -136,6 +201,13 @@ void ClusterBin::bin(ClusterBinIn& in, ClusterBinOut& out)
 
 	prepare(ctx);
 
+	if(m_binsOnGpu)
+	{
+		ANKI_TRACE_SCOPED_EVENT(R_WRITE_LIGHT_BUFFERS);
+		writeTypedObjectsToGpuBuffers(ctx);
+		return;
+	}
+
 	if(ctx.m_unprojParams != m_prevUnprojParams)
 	{
 		ctx.m_clusterEdgesDirty = true;
@@ -162,9 +234,8 @@ void ClusterBin::bin(ClusterBinIn& in, ClusterBinOut& out)
 		sizeof(U32) * m_totalClusterCount, StagingGpuMemoryType::STORAGE, ctx.m_out->m_clustersToken));
 	ctx.m_clusters = WeakArray<U32>(clusters, m_totalClusterCount);
 
-	// Create task for writing GPU buffers
-	Array<ThreadHiveTask, ThreadHive::MAX_THREADS + 1> tasks;
-	tasks[0] = ANKI_THREAD_HIVE_TASK(
+	// Create task for writing GPU buffers. It will run in parallel with the binning
+	ThreadHiveTask writeTask = ANKI_THREAD_HIVE_TASK(
 		{
 			ANKI_TRACE_SCOPED_EVENT(R_WRITE_LIGHT_BUFFERS);
 			self->m_bin->writeTypedObjectsToGpuBuffers(*self);
@@ -172,41 +243,50 @@ void ClusterBin::bin(ClusterBinIn& in, ClusterBinOut& out)
 		&ctx,
 		nullptr,
 		nullptr);
+	in.m_threadHive->submitTasks(&writeTask, 1);
+
+	computeLightBounds(ctx);
 
-	// Create tasks for binning
-	tasks[1] = ANKI_THREAD_HIVE_TASK(
+	// Bin the tiles. Every thread gets its own TileCtx that is created on first use
+	DynamicArrayAuto<TileCtx*> tileCtxs(in.m_tempAlloc);
+	tileCtxs.create(in.m_threadHive->getThreadCount(), nullptr);
+
+	const U32 tileCount = m_clusterCounts[0] * m_clusterCounts[1];
+	in.m_threadHive->parallelFor(tileCount, 1, [&](U32 begin, U32 end, U32 threadId) {
+		ANKI_TRACE_SCOPED_EVENT(R_BIN_TO_CLUSTERS);
+
+		TileCtx*& tileCtx = tileCtxs[threadId];
+		if(tileCtx == nullptr)
 		{
-			ANKI_TRACE_SCOPED_EVENT(R_BIN_TO_CLUSTERS);
-			BinCtx& ctx = *self;
-
-			TileCtx tileCtx(ctx.m_in->m_tempAlloc);
-			const U32 clusterCountZ = ctx.m_bin->m_clusterCounts[2];
-			tileCtx.m_clusterEdgesWSpace.create((clusterCountZ + 1) * 4);
-			tileCtx.m_clusterBoxes.create(clusterCountZ);
-			tileCtx.m_clusterSpheres.create(clusterCountZ);
-			tileCtx.m_indices.create(clusterCountZ * ctx.m_bin->m_avgObjectsPerCluster);
-			tileCtx.m_clusterInfos.create(clusterCountZ);
-			tileCtx.m_clusterCountZ = clusterCountZ;
-
-			const U32 tileCount = ctx.m_bin->m_clusterCounts[0] * ctx.m_bin->m_clusterCounts[1];
-			U32 tileIdx;
-			while((tileIdx = ctx.m_tileIdxToProcess.fetchAdd(1)) < tileCount)
-			{
-				ctx.m_bin->binTile(tileIdx, ctx, tileCtx);
-			}
-		},
-		&ctx,
-		nullptr,
-		nullptr);
+			tileCtx = in.m_tempAlloc.newInstance<TileCtx>(in.m_tempAlloc);
+
+			const U32 clusterCountZ = m_clusterCounts[2];
+			tileCtx->m_clusterEdgesWSpace.create((clusterCountZ + 1) * 4);
+			tileCtx->m_clusterBoxes.create(clusterCountZ);
+			tileCtx->m_clusterSpheres.create(clusterCountZ);
+			const U32 clusterGroupCountZ = (clusterCountZ + F32x8::LANE_COUNT - 1) / F32x8::LANE_COUNT;
+			tileCtx->m_clusterBoxMins.create(clusterGroupCountZ);
+			tileCtx->m_clusterBoxMaxs.create(clusterGroupCountZ);
+			tileCtx->m_clusterSphereCenters.create(clusterGroupCountZ);
+			tileCtx->m_clusterSphereRadii.create(clusterGroupCountZ);
+			tileCtx->m_indices.create(clusterCountZ * m_avgObjectsPerCluster);
+			tileCtx->m_clusterInfos.create(clusterCountZ);
+			tileCtx->m_clusterCountZ = clusterCountZ;
+		}
 
-	for(U threadIdx = 1; threadIdx < in.m_threadHive->getThreadCount(); ++threadIdx)
+		for(U32 tileIdx = begin; tileIdx < end; ++tileIdx)
+		{
+			binTile(tileIdx, ctx, *tileCtx);
+		}
+	});
+
+	for(TileCtx* tileCtx : tileCtxs)
 	{
-		tasks[threadIdx + 1] = tasks[1];
+		if(tileCtx)
+		{
+			in.m_tempAlloc.deleteInstance(tileCtx);
+		}
 	}
-
-	// Submit and wait
-	in.m_threadHive->submitTasks(&tasks[0], in.m_threadHive->getThreadCount() + 1);
-	in.m_threadHive->waitAllTasks();
 }
 
 void ClusterBin::prepare(BinCtx& ctx)
@@ -236,9 +316,7 @@ void ClusterBin::prepare(BinCtx& ctx)
 		// Then:
 		// k = sqrt(dot(A, W) - B)
 
-		const Mat4& vp = ctx.m_in->m_renderQueue->m_viewProjectionMatrix;
-		Plane nearPlane;
-		extractClipPlane(vp, FrustumPlaneType::NEAR, nearPlane);
+		const Plane& nearPlane = ctx.m_in->m_renderQueue->m_frustumData.m_nearPlane;
 
 		Vec3 A = nearPlane.getNormal().xyz() * F32(m_clusterCounts[2] * m_clusterCounts[2]) / (far - near);
 		F32 B = nearPlane.getOffset() * F32(m_clusterCounts[2] * m_clusterCounts[2]) / (far - near);
@@ -253,7 +331,7 @@ void ClusterBin::prepare(BinCtx& ctx)
 	}
 
 	// Unproj params
-	ctx.m_unprojParams = ctx.m_in->m_renderQueue->m_projectionMatrix.extractPerspectiveUnprojectionParams();
+	ctx.m_unprojParams = ctx.m_in->m_renderQueue->m_frustumData.m_unprojectionParameters;
 }
 
 void ClusterBin::binTile(U32 tileIdx, BinCtx& ctx, TileCtx& tileCtx)
@@ -332,6 +410,28 @@ void ClusterBin::binTile(U32 tileIdx, BinCtx& ctx, TileCtx& tileCtx)
 		clusterSpheres[clusterZ] = Sphere(sphereCenter, (aabbMin - sphereCenter).getLength());
 	}
 
+	// Transpose them to SoA for the wide tests of the lights
+	constexpr U32 LANE_COUNT = F32x8::LANE_COUNT;
+	for(U32 group = 0; group < tileCtx.m_clusterBoxMins.getSize(); ++group)
+	{
+		const U32 firstCluster = group * LANE_COUNT;
+		const U32 count = min<U32>(LANE_COUNT, m_clusterCounts[2] - firstCluster);
+		Array<Vec3, LANE_COUNT> mins, maxs, centers;
+		Array<F32, LANE_COUNT> radii = {};
+		for(U32 i = 0; i < count; ++i)
+		{
+			mins[i] = clusterBoxes[firstCluster + i].getMin().xyz();
+			maxs[i] = clusterBoxes[firstCluster + i].getMax().xyz();
+			centers[i] = clusterSpheres[firstCluster + i].getCenter().xyz();
+			radii[i] = clusterSpheres[firstCluster + i].getRadius();
+		}
+
+		tileCtx.m_clusterBoxMins[group] = Vec3x8::loadAos(&mins[0], count);
+		tileCtx.m_clusterBoxMaxs[group] = Vec3x8::loadAos(&maxs[0], count);
+		tileCtx.m_clusterSphereCenters[group] = Vec3x8::loadAos(&centers[0], count);
+		tileCtx.m_clusterSphereRadii[group] = F32x8::load(&radii[0]);
+	}
+
 	// Zero the infos
 	memset(&tileCtx.m_clusterInfos[0], 0, tileCtx.m_clusterInfos.getSizeInBytes());
 
@@ -346,62 +446,86 @@ void ClusterBin::binTile(U32 tileIdx, BinCtx& ctx, TileCtx& tileCtx)
 	++inf.m_counts[typeIdx]; \
 	ANKI_ASSERT(inf.m_counts[typeIdx] <= m_avgObjectsPerCluster)
 
-	// Point lights
+	// Point lights. Test 8 lights against the tile at once and then every light against 8 clusters at once. The lights
+	// are tested only against the slices they touch
 	{
-		Sphere lightSphere;
-		for(U32 i = 0; i < ctx.m_in->m_renderQueue->m_pointLights.getSize(); ++i)
+		const U32 pointLightCount = ctx.m_in->m_renderQueue->m_pointLights.getSize();
+		for(U32 group = 0; group < ctx.m_pointLightCenters.getSize(); ++group)
 		{
-			const PointLightQueueElement& plight = ctx.m_in->m_renderQueue->m_pointLights[i];
-			lightSphere.setCenter(plight.m_worldPosition.xyz0());
-			lightSphere.setRadius(plight.m_radius);
+			const U32 firstLight = group * LANE_COUNT;
+			const U32 validLanes = (1u << min<U32>(LANE_COUNT, pointLightCount - firstLight)) - 1u;
+			U32 lightMask =
+				insideClusterFrustum(frustumPlanes, ctx.m_pointLightCenters[group], ctx.m_pointLightRadii[group])
+				& validLanes;
 
-			if(!insideClusterFrustum(frustumPlanes, lightSphere))
+			for(; lightMask; lightMask &= lightMask - 1u)
 			{
-				continue;
-			}
+				const U32 i = firstLight + U32(__builtin_ctz(lightMask));
+				const PointLightQueueElement& plight = ctx.m_in->m_renderQueue->m_pointLights[i];
+				const Sphere lightSphere(plight.m_worldPosition.xyz0(), plight.m_radius);
 
-			for(U32 clusterZ = 0; clusterZ < m_clusterCounts[2]; ++clusterZ)
-			{
-				if(!testCollision(lightSphere, clusterBoxes[clusterZ]))
+				const BinCtx::ZRange& zRange = ctx.m_pointLightZRanges[i];
+				if(zRange.m_first > zRange.m_last)
 				{
 					continue;
 				}
 
-				ANKI_SET_IDX(0);
+				for(U32 clusterGroup = zRange.m_first / LANE_COUNT; clusterGroup <= zRange.m_last / LANE_COUNT;
+					++clusterGroup)
+				{
+					U32 clusterMask = testCollisionAabbsSphere(tileCtx.m_clusterBoxMins[clusterGroup],
+										  tileCtx.m_clusterBoxMaxs[clusterGroup],
+										  lightSphere)
+									  & computeLaneMask(clusterGroup * LANE_COUNT, zRange.m_first, zRange.m_last);
+
+					for(; clusterMask; clusterMask &= clusterMask - 1u)
+					{
+						const U32 clusterZ = clusterGroup * LANE_COUNT + U32(__builtin_ctz(clusterMask));
+						ANKI_SET_IDX(0);
+					}
+				}
 			}
 		}
 	}
 
-	// Spot lights
+	// Spot lights. Same as the point lights but the tile test uses the bounding spheres of the cones
 	{
-		Array<Vec4, 5> lightEdges;
-		lightEdges[0] = Vec4(0.0f); // Eye
-		ConvexHullShape spotLightShape(&lightEdges[0], lightEdges.getSize());
-
-		for(U32 i = 0; i < ctx.m_in->m_renderQueue->m_spotLights.getSize(); ++i)
+		const U32 spotLightCount = ctx.m_in->m_renderQueue->m_spotLights.getSize();
+		for(U32 group = 0; group < ctx.m_spotLightCenters.getSize(); ++group)
 		{
-			const SpotLightQueueElement& slight = ctx.m_in->m_renderQueue->m_spotLights[i];
-
-			computeEdgesOfFrustum(slight.m_distance, slight.m_outerAngle, slight.m_outerAngle, &lightEdges[1]);
-			spotLightShape.setTransform(Transform(slight.m_worldTransform));
+			const U32 firstLight = group * LANE_COUNT;
+			const U32 validLanes = (1u << min<U32>(LANE_COUNT, spotLightCount - firstLight)) - 1u;
+			U32 lightMask =
+				insideClusterFrustum(frustumPlanes, ctx.m_spotLightCenters[group], ctx.m_spotLightRadii[group])
+				& validLanes;
 
-			if(!insideClusterFrustum(frustumPlanes, spotLightShape))
+			for(; lightMask; lightMask &= lightMask - 1u)
 			{
-				continue;
-			}
+				const U32 i = firstLight + U32(__builtin_ctz(lightMask));
+				const BinCtx::SpotLightCone& cone = ctx.m_spotLightCones[i];
 
-			for(U32 clusterZ = 0; clusterZ < m_clusterCounts[2]; ++clusterZ)
-			{
-				if(!testCollision(clusterSpheres[clusterZ],
-					   Cone(slight.m_worldTransform.getTranslationPart().xyz0(),
-						   -slight.m_worldTransform.getZAxis(),
-						   slight.m_distance,
-						   slight.m_outerAngle)))
+				const BinCtx::ZRange& zRange = ctx.m_spotLightZRanges[i];
+				if(zRange.m_first > zRange.m_last)
 				{
 					continue;
 				}
 
-				ANKI_SET_IDX(1);
+				for(U32 clusterGroup = zRange.m_first / LANE_COUNT; clusterGroup <= zRange.m_last / LANE_COUNT;
+					++clusterGroup)
+				{
+					U32 clusterMask = testCollisionSpheresCone(tileCtx.m_clusterSphereCenters[clusterGroup],
+										  tileCtx.m_clusterSphereRadii[clusterGroup],
+										  cone.m_cone,
+										  cone.m_cosHalfAngle,
+										  cone.m_sinHalfAngle)
+									  & computeLaneMask(clusterGroup * LANE_COUNT, zRange.m_first, zRange.m_last);
+
+					for(; clusterMask; clusterMask &= clusterMask - 1u)
+					{
+						const U32 clusterZ = clusterGroup * LANE_COUNT + U32(__builtin_ctz(clusterMask));
+						ANKI_SET_IDX(1);
+					}
+				}
 			}
 		}
 	}
@@ -583,6 +707,110 @@ void ClusterBin::binTile(U32 tileIdx, BinCtx& ctx, TileCtx& tileCtx)
 	}
 }
 
+void ClusterBin::computeLightBounds(BinCtx& ctx) const
+{
+	constexpr U32 LANE_COUNT = F32x8::LANE_COUNT;
+	const RenderQueue& rqueue = *ctx.m_in->m_renderQueue;
+	StackAllocator<U8>& alloc = ctx.m_in->m_tempAlloc;
+
+	// The k of a point is sqrt(dot(A, P) - B) (see prepare()). A is the normal of the near plane times a scale so the
+	// value under the root of a sphere spans its radius times the length of A around the value of its center
+	const Vec4 magic = ctx.m_out->m_shaderMagicValues.m_val0;
+	const F32 scale = magic.xyz().getLength();
+	const F32 clusterCountZ = F32(m_clusterCounts[2]);
+	auto computeZRange = [&](const Vec3& center, F32 radius) {
+		const F32 k = magic.xyz().dot(center) - magic.w();
+		BinCtx::ZRange range;
+		range.m_first = U32(min(sqrt(max(k - radius * scale, 0.0f)), clusterCountZ));
+		range.m_last = U32(min(sqrt(max(k + radius * scale, 0.0f)), clusterCountZ - 1.0f));
+		return range;
+	};
+
+	// Point lights
+	const U32 pointLightCount = rqueue.m_pointLights.getSize();
+	if(pointLightCount)
+	{
+		const U32 groupCount = (pointLightCount + LANE_COUNT - 1) / LANE_COUNT;
+		ctx.m_pointLightCenters = WeakArray<Vec3x8>(alloc.newArray<Vec3x8>(groupCount), groupCount);
+		ctx.m_pointLightRadii = WeakArray<F32x8>(alloc.newArray<F32x8>(groupCount), groupCount);
+		ctx.m_pointLightZRanges =
+			WeakArray<BinCtx::ZRange>(alloc.newArray<BinCtx::ZRange>(pointLightCount), pointLightCount);
+
+		for(U32 group = 0; group < groupCount; ++group)
+		{
+			const U32 firstLight = group * LANE_COUNT;
+			const U32 count = min<U32>(LANE_COUNT, pointLightCount - firstLight);
+			Array<Vec3, LANE_COUNT> centers;
+			Array<F32, LANE_COUNT> radii = {};
+			for(U32 i = 0; i < count; ++i)
+			{
+				const PointLightQueueElement& light = rqueue.m_pointLights[firstLight + i];
+				centers[i] = light.m_worldPosition;
+				radii[i] = light.m_radius;
+				ctx.m_pointLightZRanges[firstLight + i] = computeZRange(light.m_worldPosition, light.m_radius);
+			}
+
+			ctx.m_pointLightCenters[group] = Vec3x8::loadAos(&centers[0], count);
+			ctx.m_pointLightRadii[group] = F32x8::load(&radii[0]);
+		}
+	}
+
+	// Spot lights
+	const U32 spotLightCount = rqueue.m_spotLights.getSize();
+	if(spotLightCount)
+	{
+		const U32 groupCount = (spotLightCount + LANE_COUNT - 1) / LANE_COUNT;
+		ctx.m_spotLightCenters = WeakArray<Vec3x8>(alloc.newArray<Vec3x8>(groupCount), groupCount);
+		ctx.m_spotLightRadii = WeakArray<F32x8>(alloc.newArray<F32x8>(groupCount), groupCount);
+		ctx.m_spotLightZRanges =
+			WeakArray<BinCtx::ZRange>(alloc.newArray<BinCtx::ZRange>(spotLightCount), spotLightCount);
+		ctx.m_spotLightCones =
+			WeakArray<BinCtx::SpotLightCone>(alloc.newArray<BinCtx::SpotLightCone>(spotLightCount), spotLightCount);
+
+		for(U32 group = 0; group < groupCount; ++group)
+		{
+			const U32 firstLight = group * LANE_COUNT;
+			const U32 count = min<U32>(LANE_COUNT, spotLightCount - firstLight);
+			Array<Vec3, LANE_COUNT> centers;
+			Array<F32, LANE_COUNT> radii = {};
+			for(U32 i = 0; i < count; ++i)
+			{
+				const SpotLightQueueElement& light = rqueue.m_spotLights[firstLight + i];
+				BinCtx::SpotLightCone& cone = ctx.m_spotLightCones[firstLight + i];
+
+				const Vec4 origin = light.m_worldTransform.getTranslationPart().xyz0();
+				const Vec4 dir = -light.m_worldTransform.getZAxis();
+				const F32 halfAngle = light.m_outerAngle / 2.0f;
+				cone.m_cone = Cone(origin, dir, light.m_distance, light.m_outerAngle);
+				cone.m_cosHalfAngle = cos(halfAngle);
+				cone.m_sinHalfAngle = sin(halfAngle);
+
+				// The bounding sphere of a cone with a flat cap. Wide cones are bounded by the circle of the cap and
+				// narrow ones by the sphere that passes from the origin and the circle of the cap
+				Vec4 center;
+				F32 radius;
+				if(halfAngle >= PI / 4.0f)
+				{
+					center = origin + dir * light.m_distance;
+					radius = light.m_distance * cone.m_sinHalfAngle / cone.m_cosHalfAngle;
+				}
+				else
+				{
+					radius = light.m_distance / (2.0f * cone.m_cosHalfAngle * cone.m_cosHalfAngle);
+					center = origin + dir * radius;
+				}
+
+				centers[i] = center.xyz();
+				radii[i] = radius;
+				ctx.m_spotLightZRanges[firstLight + i] = computeZRange(center.xyz(), radius);
+			}
+
+			ctx.m_spotLightCenters[group] = Vec3x8::loadAos(&centers[0], count);
+			ctx.m_spotLightRadii[group] = F32x8::load(&radii[0]);
+		}
+	}
+}
+
 void ClusterBin::writeTypedObjectsToGpuBuffers(BinCtx& ctx) const
 {
 	const RenderQueue& rqueue = *ctx.m_in->m_renderQueue;
@@ -664,8 +892,8 @@ void ClusterBin::writeTypedObjectsToGpuBuffers(BinCtx& ctx) const
 			out.m_radius = in.m_distance;
 
 			// Angles
-			out.m_outerCos = cos(in.m_outerAngle / 2.0f);
-			out.m_innerCos = cos(in.m_innerAngle / 2.0f);
+			out.m_outerCos = fastCos(in.m_outerAngle / 2.0f);
+			out.m_innerCos = fastCos(in.m_innerAngle / 2.0f);
 		}
 	}
 	else
@@ -689,6 +917,19 @@ void ClusterBin::writeTypedObjectsToGpuBuffers(BinCtx& ctx) const
 			const DecalQueueElement& in = rqueue.m_decals[i];
 			Decal& out = gpuDecals[i];
 
+			if(ctx.m_in->m_decalAtlasUvs.getSize())
+			{
+				// Both layers are in the same page of the DecalAtlas. Skip the decals that are not streamed yet
+				const Vec4 uv = ctx.m_in->m_decalAtlasUvs[i];
+				const Bool streamed = uv.z() > 0.0f;
+				out.m_diffUv = uv;
+				out.m_normRoughnessUv = uv;
+				out.m_blendFactors[0] = (streamed) ? in.m_diffuseAtlasBlendFactor : 0.0f;
+				out.m_blendFactors[1] = (streamed) ? in.m_specularRoughnessAtlasBlendFactor : 0.0f;
+				out.m_texProjectionMat = in.m_textureMatrix;
+				continue;
+			}
+
 			if((diffuseAtlas != nullptr && diffuseAtlas != in.m_diffuseAtlas)
 				|| (specularRoughnessAtlas != nullptr && specularRoughnessAtlas != in.m_specularRoughnessAtlas))
 			{
@@ -712,7 +953,7 @@ void ClusterBin::writeTypedObjectsToGpuBuffers(BinCtx& ctx) const
 			out.m_texProjectionMat = in.m_textureMatrix;
 		}
 
-		ANKI_ASSERT(diffuseAtlas || specularRoughnessAtlas);
+		ANKI_ASSERT(diffuseAtlas || specularRoughnessAtlas || ctx.m_in->m_decalAtlasUvs.getSize());
 		ctx.m_out->m_diffDecalTexView.reset(diffuseAtlas);
 		ctx.m_out->m_specularRoughnessDecalTexView.reset(specularRoughnessAtlas);
 	}
@@ -30,6 +30,9 @@ public:
 	StagingGpuMemoryManager* m_stagingMem ANKI_DEBUG_CODE(= nullptr);
 
 	Bool m_shadowsEnabled ANKI_DEBUG_CODE(= false);
+
+	/// The UVs of the decals in the DecalAtlas. If it's empty the decals sample their own texture atlas.
+	ConstWeakArray<Vec4> m_decalAtlasUvs;
 };
 
 /// @memberof ClusterBin
@@ -59,8 +62,16 @@ public:
 
 	void init(HeapAllocator<U8> alloc, U32 clusterCountX, U32 clusterCountY, U32 clusterCountZ, const ConfigSet& cfg);
 
+	/// Bin the objects. If the GPU does the binning (see GpuClusterBin) it only writes the typed objects and the magic
+	/// values. The ClusterBinOut::m_clustersToken and ClusterBinOut::m_indicesToken are left untouched then.
 	void bin(ClusterBinIn& in, ClusterBinOut& out);
 
+	/// The clusters and their indices are computed by the GpuClusterBin.
+	Bool getBinsOnGpu() const
+	{
+		return m_binsOnGpu;
+	}
+
 private:
 	class BinCtx;
 	class TileCtx;
@@ -71,12 +82,16 @@ private:
 	U32 m_totalClusterCount = 0;
 	U32 m_indexCount = 0;
 	U32 m_avgObjectsPerCluster = 0;
+	Bool m_binsOnGpu = false;
 
 	DynamicArray<Vec4> m_clusterEdges; ///< Cache those for opt. [tileCount][K+1][4]
 	Vec4 m_prevUnprojParams = Vec4(0.0f); ///< To check if m_tiles is dirty.
 
 	void prepare(BinCtx& ctx);
 
+	/// Compute the bounds of the lights in the form that the binTile() tests them.
+	void computeLightBounds(BinCtx& ctx) const;
+
 	void binTile(U32 tileIdx, BinCtx& ctx, TileCtx& tileCtx);
 
 	void writeTypedObjectsToGpuBuffers(BinCtx& ctx) const;
@@ -41,6 +41,11 @@ class Ssr;
 class VolumetricLightingAccumulation;
 class GlobalIllumination;
 class GenericCompute;
+class GpuOcclusionCulling;
+class GpuSkinning;
+class GpuClusterBin;
+class VrsSriGeneration;
+class DecalAtlas;
 
 class RenderingContext;
 class DebugDrawer;
@@ -52,6 +57,9 @@ class DirectionalLightQueueElement;
 class SpotLightQueueElement;
 class ReflectionProbeQueueElement;
 class DecalQueueElement;
+class GpuSkinningQueueElement;
+
+class AnimationGpuKeyframes;
 
 class ShaderProgramResourceVariant;
 class ClusterBin;
@@ -65,12 +73,6 @@ constexpr U32 MIN_DRAWCALLS_PER_2ND_LEVEL_COMMAND_BUFFER = 16;
 /// FS size is rendererSize/FS_FRACTION.
 constexpr U32 FS_FRACTION = 2;
 
-/// SSAO size is rendererSize/SSAO_FRACTION.
-constexpr U32 SSAO_FRACTION = 2;
-
-/// Bloom size is rendererSize/BLOOM_FRACTION.
-constexpr U32 BLOOM_FRACTION = 4;
-
 /// Volumetric size is rendererSize/VOLUMETRIC_FRACTION.
 constexpr U32 VOLUMETRIC_FRACTION = 4;
 
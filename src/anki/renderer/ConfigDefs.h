@@ -5,19 +5,70 @@
 
 ANKI_CONFIG_OPTION(r_lodDistance0, 20.0, 1.0, MAX_F64, "Distance that will be used to calculate the LOD 0")
 ANKI_CONFIG_OPTION(r_lodDistance1, 40.0, 2.0, MAX_F64, "Distance that will be used to calculate the LOD 1")
+ANKI_CONFIG_OPTION(r_lodDistance2, 80.0, 3.0, MAX_F64, "Distance that will be used to calculate the LOD 2")
 ANKI_CONFIG_OPTION(r_clusterSizeX, 32, 1, 256)
 ANKI_CONFIG_OPTION(r_clusterSizeY, 26, 1, 256)
 ANKI_CONFIG_OPTION(r_clusterSizeZ, 32, 1, 256)
 ANKI_CONFIG_OPTION(r_textureAnisotropy, 8, 1, 16)
 
 ANKI_CONFIG_OPTION(r_renderingQuality, 1.0, 0.5, 1.0, "A factor over the requested renderingresolution")
+ANKI_CONFIG_OPTION(r_dynamicResolution, 0, 0, 1, "Scale the rendering resolution to keep the GPU frame time low")
+ANKI_CONFIG_OPTION(
+	r_dynamicResolutionGpuTimeTarget, 16.0, 1.0, MAX_F64, "The GPU frame time in ms that the dynamic resolution aims for")
+ANKI_CONFIG_OPTION(r_dynamicResolutionMinScale, 0.5, 0.25, 1.0, "The minimum factor of the dynamic resolution")
+ANKI_CONFIG_OPTION(r_renderTargetAliasing,
+	0,
+	0,
+	1,
+	"The render graph places the render targets that are not alive at the same time in the same memory")
+ANKI_CONFIG_OPTION(r_splitBarriers,
+	1,
+	0,
+	1,
+	"The render graph begins the barriers after the last pass that uses a render target and ends them before the next")
+ANKI_CONFIG_OPTION(r_temporalUpscaling,
+	0,
+	0,
+	1,
+	"TAA reconstructs the image at the output resolution when the rendering resolution is lower")
 
 ANKI_CONFIG_OPTION(r_volumetricLightingAccumulationClusterFractionXY, 4, 1, 16)
 ANKI_CONFIG_OPTION(r_volumetricLightingAccumulationClusterFractionZ, 4, 1, 16)
 ANKI_CONFIG_OPTION(r_volumetricLightingAccumulationFinalClusterInZ, 26, 1, 256)
+ANKI_CONFIG_OPTION(r_volumetricLightingAccumulationHistoryBlendFactor,
+	1.0 / 16.0,
+	0.0,
+	1.0,
+	"How much of the new lighting is blended with the reprojected history every frame")
+ANKI_CONFIG_OPTION(r_volumetricLightingAccumulationUpdateInterval,
+	1,
+	1,
+	16,
+	"Every froxel is lit once every that many frames. In the rest it only reprojects the history")
 
 ANKI_CONFIG_OPTION(r_ssrMaxSteps, 64, 1, 2048)
 ANKI_CONFIG_OPTION(r_ssrHistoryBlendFactor, 0.3, 0.0, MAX_F64)
+ANKI_CONFIG_OPTION(r_ssrHiZ, 0, 0, 1, "Trace the reflections through the min depth of the HiZ mips to skip empty space")
+ANKI_CONFIG_OPTION(
+	r_ssrRoughnessCutoff, 0.7, 0.0, 1.0, "Surfaces rougher than that don't trace rays and use the probe reflections")
+
+ANKI_CONFIG_OPTION(r_ssaoResolutionDivisor,
+	2,
+	1,
+	4,
+	"The SSAO is computed at the rendering resolution divided by that. It should be 1, 2 or 4")
+ANKI_CONFIG_OPTION(
+	r_ssaoCheckerboard, 0, 0, 1, "Compute half of the SSAO pixels every frame and reproject the rest from the history")
+ANKI_CONFIG_OPTION(r_ssaoHistoryBlendFactor,
+	1.0,
+	0.0,
+	1.0,
+	"How much of the new SSAO is blended with the reprojected history. 1.0 disables the temporal accumulation")
+ANKI_CONFIG_OPTION(r_ssaoBilateralUpsample,
+	0,
+	0,
+	1,
+	"Upsample the SSAO to the rendering resolution with a depth aware filter instead of a bilinear")
 
 ANKI_CONFIG_OPTION(r_shadowMappingTileResolution, 128, 16, 2048)
 ANKI_CONFIG_OPTION(r_shadowMappingTileCountPerRowOrColumn, 16, 1, 256)
@@ -29,19 +80,126 @@ ANKI_CONFIG_OPTION(r_shadowMappingScratchTileCountX,
 ANKI_CONFIG_OPTION(r_shadowMappingScratchTileCountY, 4, 1, 256, "Number of tiles of the scratch buffer in Y")
 ANKI_CONFIG_OPTION(r_shadowMappingLightLodDistance0, 10.0, 1.0, MAX_F64)
 ANKI_CONFIG_OPTION(r_shadowMappingLightLodDistance1, 20.0, 2.0, MAX_F64)
+ANKI_CONFIG_OPTION(r_shadowMappingScreenSpaceLod,
+	0,
+	0,
+	1,
+	"Pick the tile size of the point and spot lights from the pixels their volume covers on the screen instead of "
+	"r_shadowMappingLightLodDistance0/1")
+ANKI_CONFIG_OPTION(r_shadowMappingStaticCasterCaching,
+	0,
+	0,
+	1,
+	"Cache the depth of the static casters of the point and spot lights and render only the dynamic every frame")
+ANKI_CONFIG_OPTION(r_shadowMappingFarCascadeBudget,
+	0.0,
+	0.0,
+	MAX_F64,
+	"GPU time in ms the far cascades can use every frame. The rest are reprojected. Zero renders all every frame")
+ANKI_CONFIG_OPTION(r_shadowMappingFullRateCascadeCount,
+	2u,
+	1u,
+	MAX_SHADOW_CASCADES,
+	"The near cascades that are rendered every frame when r_shadowMappingFarCascadeBudget is not zero")
+ANKI_CONFIG_OPTION(r_shadowMappingFarCascadeMaxStaleFrames,
+	8,
+	1,
+	256,
+	"A far cascade is rendered at least that often regardless of r_shadowMappingFarCascadeBudget")
 
 ANKI_CONFIG_OPTION(r_probeReflectionResolution, 128, 4, 2048)
 ANKI_CONFIG_OPTION(r_probeReflectionIrradianceResolution, 16, 4, 2048)
 ANKI_CONFIG_OPTION(r_probeRefectionlMaxSimultaneousProbeCount, 32, 4, 256)
 ANKI_CONFIG_OPTION(r_probeReflectionShadowMapResolution, 64, 4, 2048)
+ANKI_CONFIG_OPTION(r_probeReflectionUpdateBudget,
+	0.0,
+	0.0,
+	MAX_F64,
+	"GPU time in ms the probe updates can use every frame. The faces of a probe are spread in more than one frames. "
+	"Zero renders all the faces of a probe in one frame")
+ANKI_CONFIG_OPTION(r_probeReflectionCompression,
+	1,
+	0,
+	1,
+	"Compress the reflection probes to BC6H after they are rendered. They take 4 times less memory")
 
 ANKI_CONFIG_OPTION(r_lensFlareMaxSpritesPerFlare, 8, 4, 256)
 ANKI_CONFIG_OPTION(r_lensFlareMaxFlares, 16, 8, 256)
 
+ANKI_CONFIG_OPTION(r_gpuOcclusionCulling,
+	0,
+	0,
+	1,
+	"Cull the G-buffer drawcalls on the GPU against the HiZ of the previous frame instead of the CPU coverage buffer")
+
+ANKI_CONFIG_OPTION(r_gpuSkinning,
+	0,
+	0,
+	1,
+	"Evaluate the skeletal animations and the bone transforms in a compute shader instead of the CPU")
+
+ANKI_CONFIG_OPTION(r_genericComputeAsync,
+	1,
+	0,
+	1,
+	"Run the generic GPU compute jobs that allow it, like the GPU particle simulations, on the async compute queue")
+
+ANKI_CONFIG_OPTION(r_gpuClusterBinning,
+	0,
+	0,
+	1,
+	"Bin the lights, probes, decals and fog volumes to the clusters in a compute shader instead of the CPU")
+
+ANKI_CONFIG_OPTION(r_lightShadingTileClassification,
+	0,
+	0,
+	1,
+	"Classify the screen tiles by the lights that touch them and light every tile with a shader that skips the rest")
+
+ANKI_CONFIG_OPTION(r_vrs,
+	0,
+	0,
+	1,
+	"Shade the G-buffer and forward shading at a lower rate where the contrast is low or the motion fast. Needs gr_vrs")
+ANKI_CONFIG_OPTION(r_vrsLumaThreshold,
+	0.1,
+	0.0,
+	MAX_F64,
+	"Tiles with luminance contrast (standard deviation over mean) lower than that are shaded at a lower rate")
+ANKI_CONFIG_OPTION(r_vrsMotionThreshold,
+	16.0,
+	0.0,
+	MAX_F64,
+	"Tiles that move more pixels per frame than that are shaded at a lower rate")
+
+ANKI_CONFIG_OPTION(r_tonemappingHistogram,
+	0,
+	0,
+	1,
+	"Expose for the middle of the luminance histogram instead of the average luminance. Outliers won't skew it")
+ANKI_CONFIG_OPTION(r_tonemappingAdaptationSpeed,
+	3.0,
+	0.0,
+	MAX_F64,
+	"How fast the exposure adapts to a new luminance. Higher is faster")
+
+ANKI_CONFIG_OPTION(r_decalAtlas,
+	0,
+	0,
+	1,
+	"Stream the decal textures to pages of an atlas on demand instead of sampling a texture atlas all decals share")
+ANKI_CONFIG_OPTION(r_decalAtlasPageSize, 128, 16, 1024, "The size of a page of the decal atlas. Power of two")
+ANKI_CONFIG_OPTION(
+	r_decalAtlasPageCountPerRow, 16, 1, 64, "The decal atlas has that many pages in X and Y. It can hold that squared")
+ANKI_CONFIG_OPTION(
+	r_decalAtlasMaxUploadsPerFrame, 8, 1, 256, "How many decals can be streamed to the atlas every frame")
+
 ANKI_CONFIG_OPTION(r_giTileResolution, 32, 4, 2048)
 ANKI_CONFIG_OPTION(r_giShadowMapResolution, 128, 4, 2048)
 ANKI_CONFIG_OPTION(r_giMaxCachedProbes, 16, 4, 2048)
 ANKI_CONFIG_OPTION(r_giMaxVisibleProbes, 8, 1, 256)
+ANKI_CONFIG_OPTION(r_giRelight, 0, 0, 1, "Re-render the cells of the GI probes when the directional light changes")
+ANKI_CONFIG_OPTION(r_giCacheDirectory, "", "Save the GI volumes there and load them instead of rendering. Empty disables it")
 
 ANKI_CONFIG_OPTION(r_motionBlurSamples, 32, 1, 2048)
 
@@ -51,3 +209,5 @@ ANKI_CONFIG_OPTION(r_avgObjectsPerCluster, 16, 16, 256)
 
 ANKI_CONFIG_OPTION(r_bloomThreshold, 2.5, 0.0, 256.0)
 ANKI_CONFIG_OPTION(r_bloomScale, 2.5, 0.0, 256.0)
+ANKI_CONFIG_OPTION(
+	r_bloomResolutionDivisor, 4, 1, 16, "The bloom is computed at the rendering resolution divided by that")
@@ -30,6 +30,13 @@ Dbg::~Dbg()
 Error Dbg::init(const ConfigSet& initializer)
 {
 	m_enabled = initializer.getBool("r_dbgEnabled");
+
+	// All categories are drawn by default
+	for(U32 i = U32(RenderQueueDebugDrawFlag::FIRST_CATEGORY); i < U32(RenderQueueDebugDrawFlag::COUNT); ++i)
+	{
+		m_debugDrawFlags.set(RenderQueueDebugDrawFlag(i));
+	}
+
 	return Error::NONE;
 }
 
@@ -73,7 +80,7 @@ void Dbg::run(RenderPassWorkContext& rgraphCtx, const RenderingContext& ctx)
 	dctx.m_viewMatrix = ctx.m_renderQueue->m_viewMatrix;
 	dctx.m_viewProjectionMatrix = ctx.m_renderQueue->m_viewProjectionMatrix;
 	dctx.m_projectionMatrix = ctx.m_renderQueue->m_projectionMatrix;
-	dctx.m_cameraTransform = ctx.m_renderQueue->m_viewMatrix.getInverse();
+	dctx.m_cameraTransform = ctx.m_renderQueue->m_cameraTransform;
 	dctx.m_stagingGpuAllocator = &m_r->getStagingGpuMemoryManager();
 	dctx.m_frameAllocator = ctx.m_tempAllocator;
 	dctx.m_commandBuffer = cmdb;
@@ -96,18 +103,8 @@ void Dbg::run(RenderPassWorkContext& rgraphCtx, const RenderingContext& ctx)
 		el.m_callback(dctx, a);
 	}
 
-	// Draw probes
-	if(threadId == 0)
-	{
-		for(const GlobalIlluminationProbeQueueElement& el : ctx.m_renderQueue->m_giProbes)
-		{
-			Array<void*, 1> a = {{const_cast<void*>(el.m_debugDrawCallbackUserData)}};
-			el.m_debugDrawCallback(dctx, a);
-		}
-	}
-
 	// Draw lights
-	if(threadId == 0)
+	if(threadId == 0 && m_debugDrawFlags.get(RenderQueueDebugDrawFlag::LIGHTS))
 	{
 		U32 count = ctx.m_renderQueue->m_pointLights.getSize();
 		while(count--)
@@ -125,7 +122,7 @@ void Dbg::run(RenderPassWorkContext& rgraphCtx, const RenderingContext& ctx)
 	}
 
 	// Decals
-	if(threadId == 0)
+	if(threadId == 0 && m_debugDrawFlags.get(RenderQueueDebugDrawFlag::DECALS))
 	{
 		for(const DecalQueueElement& el : ctx.m_renderQueue->m_decals)
 		{
@@ -135,7 +132,7 @@ void Dbg::run(RenderPassWorkContext& rgraphCtx, const RenderingContext& ctx)
 	}
 
 	// Reflection probes
-	if(threadId == 0)
+	if(threadId == 0 && m_debugDrawFlags.get(RenderQueueDebugDrawFlag::PROBES))
 	{
 		for(const ReflectionProbeQueueElement& el : ctx.m_renderQueue->m_reflectionProbes)
 		{
@@ -145,7 +142,7 @@ void Dbg::run(RenderPassWorkContext& rgraphCtx, const RenderingContext& ctx)
 	}
 
 	// GI probes
-	if(threadId == 0)
+	if(threadId == 0 && m_debugDrawFlags.get(RenderQueueDebugDrawFlag::PROBES))
 	{
 		for(const GlobalIlluminationProbeQueueElement& el : ctx.m_renderQueue->m_giProbes)
 		{
@@ -175,13 +172,13 @@ void Dbg::populateRenderGraph(RenderingContext& ctx)
 	// Create pass
 	GraphicsRenderPassDescription& pass = rgraph.newGraphicsRenderPass("DBG");
 
-	pass.setWork(
+	pass.setParallelWork(
 		[](RenderPassWorkContext& rgraphCtx) {
 			Dbg* self = static_cast<Dbg*>(rgraphCtx.m_userData);
 			self->run(rgraphCtx, *self->m_runCtx.m_ctx);
 		},
 		this,
-		computeNumberOfSecondLevelCommandBuffers(ctx.m_renderQueue->m_renderables.getSize()));
+		ctx.m_renderQueue->m_renderables.getSize());
 
 	pass.setFramebufferInfo(m_fbDescr, {m_runCtx.m_rt}, m_r->getGBuffer().getDepthRt());
 
@@ -74,6 +74,20 @@ public:
 		m_debugDrawFlags.flip(RenderQueueDebugDrawFlag::DITHERED_DEPTH_TEST_ON);
 	}
 
+	/// @param category A RenderQueueDebugDrawFlag after RenderQueueDebugDrawFlag::FIRST_CATEGORY.
+	Bool getCategoryEnabled(RenderQueueDebugDrawFlag category) const
+	{
+		ANKI_ASSERT(category >= RenderQueueDebugDrawFlag::FIRST_CATEGORY);
+		return m_debugDrawFlags.get(category);
+	}
+
+	/// @param category A RenderQueueDebugDrawFlag after RenderQueueDebugDrawFlag::FIRST_CATEGORY.
+	void setCategoryEnabled(RenderQueueDebugDrawFlag category, Bool enable)
+	{
+		ANKI_ASSERT(category >= RenderQueueDebugDrawFlag::FIRST_CATEGORY);
+		m_debugDrawFlags.set(category, enable);
+	}
+
 private:
 	Bool m_enabled = false;
 	Bool m_initialized = false; ///< Lazily initialize.
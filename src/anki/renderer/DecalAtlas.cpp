@@ -0,0 +1,250 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/renderer/DecalAtlas.h>
+#include <anki/renderer/Renderer.h>
+#include <anki/renderer/RenderQueue.h>
+#include <anki/core/ConfigSet.h>
+#include <shaders/glsl_cpp_common/DecalAtlas.h>
+
+namespace anki
+{
+
+DecalAtlas::~DecalAtlas()
+{
+	m_pages.destroy(getAllocator());
+	m_uuidToPageIdx.destroy(getAllocator());
+}
+
+Error DecalAtlas::init(const ConfigSet& cfg)
+{
+	m_enabled = cfg.getBool("r_decalAtlas");
+	if(!m_enabled)
+	{
+		return Error::NONE;
+	}
+
+	ANKI_R_LOGI("Initializing decal atlas");
+
+	m_pageSize = cfg.getNumberU32("r_decalAtlasPageSize");
+	m_pageCountPerRow = cfg.getNumberU32("r_decalAtlasPageCountPerRow");
+	m_maxUploadsPerFrame = cfg.getNumberU32("r_decalAtlasMaxUploadsPerFrame");
+	if(!isPowerOfTwo(m_pageSize))
+	{
+		ANKI_R_LOGE("r_decalAtlasPageSize should be a power of two");
+		return Error::USER_DATA;
+	}
+
+	// The last mip of a page is not smaller than 4x4 to limit the bleeding to the neighbour pages
+	m_mipCount = computeMaxMipmapCount2d(m_pageSize, m_pageSize, 4);
+
+	m_pages.create(getAllocator(), m_pageCountPerRow * m_pageCountPerRow);
+
+	// Create the atlas textures. Not cleared, a page is not sampled before it's streamed
+	const U32 atlasSize = m_pageSize * m_pageCountPerRow;
+	TextureInitInfo texInit = m_r->create2DRenderTargetInitInfo(atlasSize,
+		atlasSize,
+		Format::R8G8B8A8_UNORM,
+		TextureUsageBit::IMAGE_COMPUTE_WRITE | TextureUsageBit::SAMPLED_FRAGMENT,
+		"DecalAtlasDiffuse");
+	texInit.m_mipmapCount = m_mipCount;
+	m_diffuseTex = getGrManager().newTexture(texInit);
+
+	texInit.setName("DecalAtlasSpecularRoughness");
+	m_specularRoughnessTex = getGrManager().newTexture(texInit);
+
+	// Load the program
+	ANKI_CHECK(getResourceManager().loadResource("shaders/DecalAtlasUpload.ankiprog", m_prog));
+
+	ShaderProgramResourceVariantInitInfo variantInitInfo(m_prog);
+	variantInitInfo.addConstant("PAGE_SIZE", m_pageSize);
+	const ShaderProgramResourceVariant* variant;
+	m_prog->getOrCreateVariant(variantInitInfo, variant);
+	m_grProg = variant->getProgram();
+
+	return Error::NONE;
+}
+
+U64 DecalAtlas::computeDecalUuid(const DecalQueueElement& decal) const
+{
+	class
+	{
+	public:
+		U64 m_diffuseUuid;
+		U64 m_specularRoughnessUuid;
+		Vec4 m_diffuseUv;
+		Vec4 m_specularRoughnessUv;
+	} key;
+
+	key.m_diffuseUuid = (decal.m_diffuseAtlas) ? decal.m_diffuseAtlas->getUuid() : 0;
+	key.m_specularRoughnessUuid = (decal.m_specularRoughnessAtlas) ? decal.m_specularRoughnessAtlas->getUuid() : 0;
+	key.m_diffuseUv = decal.m_diffuseAtlasUv;
+	key.m_specularRoughnessUv = decal.m_specularRoughnessAtlasUv;
+
+	const U64 uuid = computeHash(&key, sizeof(key));
+	return (uuid != 0) ? uuid : 1; // Zero marks the free pages
+}
+
+void DecalAtlas::populateRenderGraph(RenderingContext& ctx)
+{
+	m_runCtx.m_decalUvs = {};
+	if(!m_enabled)
+	{
+		return;
+	}
+
+	m_runCtx.m_ctx = &ctx;
+	const ConstWeakArray<DecalQueueElement> decals = ctx.m_renderQueue->m_decals;
+
+	// When resources get loaded the decal textures may have changed since they were streamed
+	if(m_r->resourcesLoaded())
+	{
+		for(Page& page : m_pages)
+		{
+			page.m_streamed = false;
+		}
+	}
+
+	// Find a page for every decal
+	const U32 decalCount = decals.getSize();
+	m_runCtx.m_decalUvs = WeakArray<Vec4>(ctx.m_tempAllocator.newArray<Vec4>(decalCount), decalCount);
+	const U32 maxUploadCount = min(decalCount, m_maxUploadsPerFrame);
+	m_runCtx.m_uploadDecals = WeakArray<U32>(ctx.m_tempAllocator.newArray<U32>(maxUploadCount), maxUploadCount);
+	m_runCtx.m_uploadPages = WeakArray<U32>(ctx.m_tempAllocator.newArray<U32>(maxUploadCount), maxUploadCount);
+	U32 uploadCount = 0;
+
+	const Timestamp crntTimestamp = m_r->getGlobalTimestamp();
+	const F32 atlasSize = F32(m_pageSize * m_pageCountPerRow);
+	for(U32 i = 0; i < decalCount; ++i)
+	{
+		m_runCtx.m_decalUvs[i] = Vec4(0.0f);
+
+		const U64 uuid = computeDecalUuid(decals[i]);
+		const U32 pageIdx = findBestCacheEntry(uuid, crntTimestamp, m_pages, m_uuidToPageIdx, getAllocator());
+		if(ANKI_UNLIKELY(pageIdx == MAX_U32))
+		{
+			// All the pages are used by decals of this frame
+			continue;
+		}
+
+		Page& page = m_pages[pageIdx];
+		if(page.m_uuid != uuid)
+		{
+			page.m_uuid = uuid;
+			page.m_streamed = false;
+			m_uuidToPageIdx.emplace(getAllocator(), uuid, pageIdx);
+		}
+		page.m_lastUsedTimestamp = crntTimestamp;
+
+		if(!page.m_streamed)
+		{
+			if(uploadCount == maxUploadCount)
+			{
+				// Out of budget, it will be streamed in a later frame
+				continue;
+			}
+
+			m_runCtx.m_uploadDecals[uploadCount] = i;
+			m_runCtx.m_uploadPages[uploadCount] = pageIdx;
+			++uploadCount;
+			page.m_streamed = true;
+		}
+
+		// Shrink the UVs by half a texel to avoid sampling the neighbour pages
+		const Vec2 pageOffset(F32(pageIdx % m_pageCountPerRow), F32(pageIdx / m_pageCountPerRow));
+		m_runCtx.m_decalUvs[i] = Vec4((pageOffset * F32(m_pageSize) + 0.5f) / atlasSize,
+			Vec2((F32(m_pageSize) - 1.0f) / atlasSize));
+	}
+
+	m_runCtx.m_uploadDecals = WeakArray<U32>(m_runCtx.m_uploadDecals.getBegin(), uploadCount);
+	m_runCtx.m_uploadPages = WeakArray<U32>(m_runCtx.m_uploadPages.getBegin(), uploadCount);
+
+	// Import the atlas
+	RenderGraphDescription& rgraph = ctx.m_renderGraphDescr;
+	if(m_texsImportedOnce)
+	{
+		m_runCtx.m_diffuseRt = rgraph.importRenderTarget(m_diffuseTex);
+		m_runCtx.m_specularRoughnessRt = rgraph.importRenderTarget(m_specularRoughnessTex);
+	}
+	else
+	{
+		m_runCtx.m_diffuseRt = rgraph.importRenderTarget(m_diffuseTex, TextureUsageBit::NONE);
+		m_runCtx.m_specularRoughnessRt = rgraph.importRenderTarget(m_specularRoughnessTex, TextureUsageBit::NONE);
+		m_texsImportedOnce = true;
+	}
+
+	// Stream
+	if(uploadCount > 0)
+	{
+		ComputeRenderPassDescription& pass = rgraph.newComputeRenderPass("Decal atlas upload");
+
+		pass.setWork(
+			[](RenderPassWorkContext& rgraphCtx) { static_cast<DecalAtlas*>(rgraphCtx.m_userData)->run(rgraphCtx); },
+			this,
+			0);
+
+		pass.newDependency({m_runCtx.m_diffuseRt, TextureUsageBit::IMAGE_COMPUTE_WRITE});
+		pass.newDependency({m_runCtx.m_specularRoughnessRt, TextureUsageBit::IMAGE_COMPUTE_WRITE});
+	}
+}
+
+void DecalAtlas::run(RenderPassWorkContext& rgraphCtx)
+{
+	const RenderingContext& ctx = *m_runCtx.m_ctx;
+	CommandBufferPtr& cmdb = rgraphCtx.m_commandBuffer;
+	const U32 uploadCount = m_runCtx.m_uploadDecals.getSize();
+	ANKI_ASSERT(uploadCount > 0);
+
+	cmdb->bindShaderProgram(m_grProg);
+
+	cmdb->bindSampler(0, 0, m_r->getSamplers().m_trilinearClamp);
+
+	// Write the uploads. The decal textures are bound as bindless
+	DecalAtlasUpload* uploads =
+		allocateAndBindStorage<DecalAtlasUpload*>(sizeof(DecalAtlasUpload) * uploadCount, cmdb, 0, 1);
+	for(U32 i = 0; i < uploadCount; ++i)
+	{
+		const DecalQueueElement& decal = ctx.m_renderQueue->m_decals[m_runCtx.m_uploadDecals[i]];
+		const U32 pageIdx = m_runCtx.m_uploadPages[i];
+		DecalAtlasUpload& upload = uploads[i];
+
+		upload.m_pageOffset =
+			UVec2(pageIdx % m_pageCountPerRow, pageIdx / m_pageCountPerRow) * UVec2(m_pageSize, m_pageSize);
+
+		const TextureViewPtr diffuseView =
+			(decal.m_diffuseAtlas) ? TextureViewPtr(decal.m_diffuseAtlas) : m_r->getDummyTextureView2d();
+		upload.m_diffuseTexIndex = cmdb->bindBindlessTexture(diffuseView, TextureUsageBit::SAMPLED_COMPUTE);
+
+		const TextureViewPtr specularRoughnessView = (decal.m_specularRoughnessAtlas)
+														 ? TextureViewPtr(decal.m_specularRoughnessAtlas)
+														 : m_r->getDummyTextureView2d();
+		upload.m_specularRoughnessTexIndex =
+			cmdb->bindBindlessTexture(specularRoughnessView, TextureUsageBit::SAMPLED_COMPUTE);
+
+		Vec4 uv = decal.m_diffuseAtlasUv;
+		upload.m_diffuseUv = Vec4(uv.x(), uv.y(), uv.z() - uv.x(), uv.w() - uv.y());
+		uv = decal.m_specularRoughnessAtlasUv;
+		upload.m_specularRoughnessUv = Vec4(uv.x(), uv.y(), uv.z() - uv.x(), uv.w() - uv.y());
+	}
+
+	cmdb->bindAllBindless(1);
+
+	// One dispatch per mip
+	for(U32 mip = 0; mip < m_mipCount; ++mip)
+	{
+		const TextureSubresourceInfo subresource(TextureSurfaceInfo(mip, 0, 0, 0));
+		rgraphCtx.bindImage(0, 2, m_runCtx.m_diffuseRt, subresource);
+		rgraphCtx.bindImage(0, 3, m_runCtx.m_specularRoughnessRt, subresource);
+
+		const UVec4 pconsts(mip, 0, 0, 0);
+		cmdb->setPushConstants(&pconsts, sizeof(pconsts));
+
+		const U32 pageMipSize = m_pageSize >> mip;
+		const U32 groupCount = (pageMipSize + 8 - 1) / 8;
+		cmdb->dispatchCompute(groupCount, groupCount, uploadCount);
+	}
+}
+
+} // end namespace anki
@@ -0,0 +1,110 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/renderer/RendererObject.h>
+#include <anki/Gr.h>
+#include <anki/resource/ShaderProgramResource.h>
+
+namespace anki
+{
+
+/// @addtogroup renderer
+/// @{
+
+/// A cache of fixed size pages for the decal textures. The visible decals are streamed to pages on demand and the least
+/// recently used pages are evicted. The pages are filled by a compute pass that reads the decal textures through
+/// bindless, so the decals don't need to share a texture atlas and the atlas is never rebuilt or re-bound.
+class DecalAtlas : public RendererObject
+{
+public:
+	DecalAtlas(Renderer* r)
+		: RendererObject(r)
+	{
+	}
+
+	~DecalAtlas();
+
+	ANKI_USE_RESULT Error init(const ConfigSet& cfg);
+
+	/// Assign pages to the visible decals and populate the rendergraph with the uploads.
+	void populateRenderGraph(RenderingContext& ctx);
+
+	Bool getEnabled() const
+	{
+		return m_enabled;
+	}
+
+	/// The UVs (xy: offset, zw: size) in the atlas of every visible decal. The decals that are not streamed yet have
+	/// zero size. Call it after populateRenderGraph.
+	ConstWeakArray<Vec4> getDecalUvs() const
+	{
+		return m_runCtx.m_decalUvs;
+	}
+
+	RenderTargetHandle getDiffuseRt() const
+	{
+		return m_runCtx.m_diffuseRt;
+	}
+
+	RenderTargetHandle getSpecularRoughnessRt() const
+	{
+		return m_runCtx.m_specularRoughnessRt;
+	}
+
+	/// Set the dependencies of a pass that samples the atlas.
+	void setDependencies(RenderPassDescriptionBase& pass, TextureUsageBit usage) const
+	{
+		ANKI_ASSERT(m_enabled);
+		pass.newDependency({m_runCtx.m_diffuseRt, usage});
+		pass.newDependency({m_runCtx.m_specularRoughnessRt, usage});
+	}
+
+private:
+	class Page
+	{
+	public:
+		U64 m_uuid = 0; ///< Hash of the decal textures and their UVs.
+		Timestamp m_lastUsedTimestamp = 0;
+		Bool m_streamed = false;
+	};
+
+	Bool m_enabled = false;
+	Bool m_texsImportedOnce = false;
+	U32 m_pageSize = 0;
+	U32 m_pageCountPerRow = 0;
+	U32 m_mipCount = 0;
+	U32 m_maxUploadsPerFrame = 0;
+
+	TexturePtr m_diffuseTex;
+	TexturePtr m_specularRoughnessTex;
+
+	DynamicArray<Page> m_pages;
+	HashMap<U64, U32> m_uuidToPageIdx;
+
+	ShaderProgramResourcePtr m_prog;
+	ShaderProgramPtr m_grProg;
+
+	class
+	{
+	public:
+		RenderingContext* m_ctx = nullptr;
+		RenderTargetHandle m_diffuseRt;
+		RenderTargetHandle m_specularRoughnessRt;
+		WeakArray<Vec4> m_decalUvs;
+
+		/// The decals to stream this frame and the pages they go to.
+		WeakArray<U32> m_uploadDecals;
+		WeakArray<U32> m_uploadPages;
+	} m_runCtx;
+
+	U64 computeDecalUuid(const DecalQueueElement& decal) const;
+
+	void run(RenderPassWorkContext& rgraphCtx);
+};
+/// @}
+
+} // end namespace anki
@@ -33,7 +33,7 @@ Error DepthDownscale::initInternal(const ConfigSet&)
 	// Create RT descr
 	TextureInitInfo texInit = m_r->create2DRenderTargetInitInfo(width,
 		height,
-		Format::R32_SFLOAT,
+		Format::R32G32_SFLOAT,
 		TextureUsageBit::SAMPLED_FRAGMENT | TextureUsageBit::SAMPLED_COMPUTE | TextureUsageBit::IMAGE_COMPUTE_WRITE,
 		"HiZ");
 	texInit.m_mipmapCount = U8(m_mipCount);
@@ -110,10 +110,10 @@ void DepthDownscale::populateRenderGraph(RenderingContext& ctx)
 
 	static const Array<CString, 5> passNames = {{"HiZ #0", "HiZ #1", "HiZ #2", "HiZ #3", "HiZ #4"}};
 
-	// Every pass can do MIPS_WRITTEN_PER_PASS mips
+	// Every pass can do MIPS_WRITTEN_PER_PASS mips. At the usual resolutions the whole chain fits in one pass
 	for(U32 i = 0; i < m_mipCount; i += MIPS_WRITTEN_PER_PASS)
 	{
-		const U mipsToFill = (i + 1 < m_mipCount) ? MIPS_WRITTEN_PER_PASS : 1;
+		const U32 mipsToFill = min(MIPS_WRITTEN_PER_PASS, m_mipCount - i);
 
 		ComputeRenderPassDescription& pass = rgraph.newComputeRenderPass(passNames[i / MIPS_WRITTEN_PER_PASS]);
 
@@ -133,14 +133,9 @@ void DepthDownscale::populateRenderGraph(RenderingContext& ctx)
 
 		TextureSubresourceInfo subresource;
 		subresource.m_firstMipmap = i;
+		subresource.m_mipmapCount = mipsToFill;
 		pass.newDependency({m_runCtx.m_hizRt, TextureUsageBit::IMAGE_COMPUTE_WRITE, subresource});
 
-		if(mipsToFill == MIPS_WRITTEN_PER_PASS)
-		{
-			subresource.m_firstMipmap = i + 1;
-			pass.newDependency({m_runCtx.m_hizRt, TextureUsageBit::IMAGE_COMPUTE_WRITE, subresource});
-		}
-
 		auto callback = [](RenderPassWorkContext& rgraphCtx) {
 			DepthDownscale* const self = static_cast<DepthDownscale*>(rgraphCtx.m_userData);
 			self->run(rgraphCtx);
@@ -155,13 +150,11 @@ void DepthDownscale::run(RenderPassWorkContext& rgraphCtx)
 
 	const U32 level = m_runCtx.m_mip;
 	m_runCtx.m_mip += MIPS_WRITTEN_PER_PASS;
-	const U32 mipsToFill = (level + 1 < m_mipCount) ? MIPS_WRITTEN_PER_PASS : 1;
+	const U32 mipsToFill = min(MIPS_WRITTEN_PER_PASS, m_mipCount - level);
 	const U32 copyToClientLevel = (level + mipsToFill == m_mipCount) ? mipsToFill - 1 : MAX_U32;
 
 	const U32 level0Width = m_r->getWidth() >> (level + 1);
 	const U32 level0Height = m_r->getHeight() >> (level + 1);
-	const U32 level1Width = level0Width >> 1;
-	const U32 level1Height = level0Height >> 1;
 
 	cmdb->bindShaderProgram(m_grProg);
 
@@ -169,17 +162,18 @@ void DepthDownscale::run(RenderPassWorkContext& rgraphCtx)
 	struct PushConsts
 	{
 		UVec2 m_level0WriteImgSize;
-		UVec2 m_level1WriteImgSize;
+		U32 m_levelsToWrite;
 		U32 m_copyToClientLevel;
-		U32 m_writeLevel1;
+		U32 m_readDepthBuffer;
 		U32 m_padding0;
 		U32 m_padding1;
+		U32 m_padding2;
 	} regs;
 
 	regs.m_level0WriteImgSize = UVec2(level0Width, level0Height);
-	regs.m_level1WriteImgSize = UVec2(level1Width, level1Height);
+	regs.m_levelsToWrite = mipsToFill;
 	regs.m_copyToClientLevel = copyToClientLevel;
-	regs.m_writeLevel1 = mipsToFill == MIPS_WRITTEN_PER_PASS;
+	regs.m_readDepthBuffer = level == 0;
 	cmdb->setPushConstants(&regs, sizeof(regs));
 
 	cmdb->bindSampler(0, 0, m_r->getSamplers().m_nearestNearestClamp);
@@ -197,20 +191,19 @@ void DepthDownscale::run(RenderPassWorkContext& rgraphCtx)
 		rgraphCtx.bindTexture(0, 1, m_runCtx.m_hizRt, subresource);
 	}
 
-	// 1st level
-	TextureSubresourceInfo subresource;
-	subresource.m_firstMipmap = level;
-	rgraphCtx.bindImage(0, 2, m_runCtx.m_hizRt, subresource);
-
-	// 2nd level
-	subresource.m_firstMipmap = (mipsToFill == MIPS_WRITTEN_PER_PASS) ? level + 1 : level; // Bind the next or the same
-	rgraphCtx.bindImage(0, 3, m_runCtx.m_hizRt, subresource);
+	// The mips to write. The shader doesn't touch the unused bindings, bind the last mip there
+	for(U32 i = 0; i < MIPS_WRITTEN_PER_PASS; ++i)
+	{
+		TextureSubresourceInfo subresource;
+		subresource.m_firstMipmap = level + min(i, mipsToFill - 1);
+		rgraphCtx.bindImage(0, 2, m_runCtx.m_hizRt, subresource, i);
+	}
 
 	// Client buffer
-	cmdb->bindStorageBuffer(0, 4, m_copyToBuff.m_buff, 0, m_copyToBuff.m_buff->getSize());
+	cmdb->bindStorageBuffer(0, 3, m_copyToBuff.m_buff, 0, m_copyToBuff.m_buff->getSize());
 
 	// Done
-	dispatchPPCompute(cmdb, 8, 8, level0Width, level0Height);
+	dispatchPPCompute(cmdb, TILE_SIZE, TILE_SIZE, level0Width, level0Height);
 }
 
 } // end namespace anki
@@ -15,7 +15,7 @@ namespace anki
 /// @addtogroup renderer
 /// @{
 
-/// Downscales the depth buffer a few times.
+/// Downscales the depth buffer a few times. A single dispatch writes up to MIPS_WRITTEN_PER_PASS mips.
 class DepthDownscale : public RendererObject
 {
 public:
@@ -34,7 +34,8 @@ public:
 	/// Populate the rendergraph.
 	void populateRenderGraph(RenderingContext& ctx);
 
-	/// Return a FP color render target with hierarchical Z (min Z) in it's mips.
+	/// Return a FP color render target with hierarchical Z in it's mips. The red channel holds the max Z and the green
+	/// the min Z.
 	RenderTargetHandle getHiZRt() const
 	{
 		return m_runCtx.m_hizRt;
@@ -54,7 +55,9 @@ public:
 	}
 
 private:
-	static const U32 MIPS_WRITTEN_PER_PASS = 2;
+	/// A workgroup reduces a 32x32 tile of the 1st mip to a single texel.
+	static const U32 MIPS_WRITTEN_PER_PASS = 6;
+	static const U32 TILE_SIZE = 32;
 
 	TexturePtr m_hizTex;
 	Bool m_hizTexImportedOnce = false;
@@ -20,11 +20,14 @@ public:
 	RenderQueueDrawContext m_queueCtx;
 
 	const RenderableQueueElement* m_renderableElement = nullptr;
+	const RenderableDrawerIndirectInfo* m_indirectInfo = nullptr;
 
-	Array<RenderableQueueElement, MAX_INSTANCES> m_cachedRenderElements;
-	Array<U8, MAX_INSTANCES> m_cachedRenderElementLods;
-	Array<const void*, MAX_INSTANCES> m_userData;
+	/// The merged elements are consecutive in the queue so the drawcall references them as a range.
+	const RenderableQueueElement* m_firstCachedRenderElement = nullptr;
 	U32 m_cachedRenderElementCount = 0;
+	U8 m_cachedRenderElementLod = 0;
+
+	Array<const void*, MAX_INSTANCES> m_userData;
 	U32 m_minLod = 0;
 };
 
@@ -46,7 +49,8 @@ void RenderableDrawer::drawRange(Pass pass,
 	SamplerPtr sampler,
 	const RenderableQueueElement* begin,
 	const RenderableQueueElement* end,
-	U32 minLod)
+	U32 minLod,
+	const RenderableDrawerIndirectInfo* indirectInfo)
 {
 	ANKI_ASSERT(begin && end && begin < end);
 
@@ -65,6 +69,10 @@ void RenderableDrawer::drawRange(Pass pass,
 	ANKI_ASSERT(minLod < MAX_LOD_COUNT);
 	ctx.m_minLod = minLod;
 
+	ANKI_ASSERT(!indirectInfo
+				|| (indirectInfo->m_args && indirectInfo->m_buffer && indirectInfo->m_firstElement <= begin));
+	ctx.m_indirectInfo = indirectInfo;
+
 	for(; begin != end; ++begin)
 	{
 		ctx.m_renderableElement = begin;
@@ -78,10 +86,38 @@ void RenderableDrawer::drawRange(Pass pass,
 
 void RenderableDrawer::flushDrawcall(DrawContext& ctx)
 {
-	ctx.m_queueCtx.m_key.setLod(ctx.m_cachedRenderElementLods[0]);
+	if(ctx.m_cachedRenderElementCount == 0)
+	{
+		return;
+	}
+
+	const RenderableQueueElement& first = *ctx.m_firstCachedRenderElement;
+
+	ctx.m_queueCtx.m_key.setLod(ctx.m_cachedRenderElementLod);
 	ctx.m_queueCtx.m_key.setInstanceCount(ctx.m_cachedRenderElementCount);
+	ctx.m_queueCtx.m_lodCrossFade = first.m_lod == ctx.m_cachedRenderElementLod;
+
+	// Gather the user data of the range
+	for(U32 i = 0; i < ctx.m_cachedRenderElementCount; ++i)
+	{
+		ctx.m_userData[i] = ctx.m_firstCachedRenderElement[i].m_userData;
+	}
+
+	if(ctx.m_indirectInfo)
+	{
+		// Zero the instances of all the elements. The callback will write the real args to the first
+		const PtrSize firstIdx = PtrSize(ctx.m_firstCachedRenderElement - ctx.m_indirectInfo->m_firstElement);
+		for(U32 i = 0; i < ctx.m_cachedRenderElementCount; ++i)
+		{
+			ctx.m_indirectInfo->m_args[firstIdx + i] = DrawElementsIndirectInfo(0, 0, 0, 0, 0);
+		}
+
+		ctx.m_queueCtx.m_indirectArgs = &ctx.m_indirectInfo->m_args[firstIdx];
+		ctx.m_queueCtx.m_indirectArgsBuffer = ctx.m_indirectInfo->m_buffer;
+		ctx.m_queueCtx.m_indirectArgsBufferOffset = firstIdx * sizeof(DrawElementsIndirectInfo);
+	}
 
-	ctx.m_cachedRenderElements[0].m_callback(
+	first.m_callback(
 		ctx.m_queueCtx, ConstWeakArray<void*>(const_cast<void**>(&ctx.m_userData[0]), ctx.m_cachedRenderElementCount));
 
 	// Rendered something, reset the cached transforms
@@ -101,13 +137,20 @@ void RenderableDrawer::drawSingle(DrawContext& ctx)
 
 	const RenderableQueueElement& rqel = *ctx.m_renderableElement;
 
-	U32 lod = min(m_r->calculateLod(rqel.m_distanceFromCamera), MAX_LOD_COUNT - 1);
+	U32 lod = rqel.m_lod;
+	if(lod == MAX_U8)
+	{
+		lod = min(m_r->calculateLod(rqel.m_distanceFromCamera), MAX_LOD_COUNT - 1);
+	}
 	lod = max(lod, ctx.m_minLod);
 
+	// The elements are visited in order so the new one extends the range if it can be merged with it
+	ANKI_ASSERT(ctx.m_cachedRenderElementCount == 0
+				|| ctx.m_firstCachedRenderElement + ctx.m_cachedRenderElementCount == &rqel);
 	const Bool shouldFlush =
 		ctx.m_cachedRenderElementCount > 0
-		&& (!canMergeRenderableQueueElements(ctx.m_cachedRenderElements[ctx.m_cachedRenderElementCount - 1], rqel)
-			   || ctx.m_cachedRenderElementLods[ctx.m_cachedRenderElementCount - 1] != lod);
+		&& (!canMergeRenderableQueueElements(*ctx.m_firstCachedRenderElement, rqel)
+			   || ctx.m_cachedRenderElementLod != lod);
 
 	if(shouldFlush)
 	{
@@ -115,9 +158,11 @@ void RenderableDrawer::drawSingle(DrawContext& ctx)
 	}
 
 	// Cache the new one
-	ctx.m_cachedRenderElements[ctx.m_cachedRenderElementCount] = rqel;
-	ctx.m_cachedRenderElementLods[ctx.m_cachedRenderElementCount] = U8(lod);
-	ctx.m_userData[ctx.m_cachedRenderElementCount] = rqel.m_userData;
+	if(ctx.m_cachedRenderElementCount == 0)
+	{
+		ctx.m_firstCachedRenderElement = &rqel;
+		ctx.m_cachedRenderElementLod = U8(lod);
+	}
 	++ctx.m_cachedRenderElementCount;
 }
 
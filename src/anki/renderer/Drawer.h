@@ -19,6 +19,16 @@ class DrawContext;
 /// @addtogroup renderer
 /// @{
 
+/// Makes RenderableDrawer::drawRange() emit indirect drawcalls that can be culled on the GPU. Every drawcall owns the
+/// DrawElementsIndirectInfo of its first element. The args of the rest of the elements have zero instances.
+class RenderableDrawerIndirectInfo
+{
+public:
+	const RenderableQueueElement* m_firstElement = nullptr; ///< The elements are indexed relative to this one.
+	DrawElementsIndirectInfo* m_args = nullptr; ///< The args the callbacks will write. One per element.
+	BufferPtr m_buffer; ///< The buffer the drawcalls will read their args from. One per element as well.
+};
+
 /// It uses the render queue to batch and render.
 class RenderableDrawer
 {
@@ -40,7 +50,8 @@ public:
 		SamplerPtr sampler,
 		const RenderableQueueElement* begin,
 		const RenderableQueueElement* end,
-		U32 minLod = 0);
+		U32 minLod = 0,
+		const RenderableDrawerIndirectInfo* indirectInfo = nullptr);
 
 private:
 	Renderer* m_r;
@@ -12,6 +12,8 @@
 #include <anki/renderer/DepthDownscale.h>
 #include <anki/renderer/LensFlare.h>
 #include <anki/renderer/VolumetricLightingAccumulation.h>
+#include <anki/renderer/GpuSkinning.h>
+#include <anki/renderer/GenericCompute.h>
 
 namespace anki
 {
@@ -54,16 +56,18 @@ void ForwardShading::run(const RenderingContext& ctx, RenderPassWorkContext& rgr
 		bindStorage(cmdb, 0, 8, rsrc.m_indicesToken);
 
 		// Start drawing
+		cmdb->setAsyncPipelineCreation(true);
 		m_r->getSceneDrawer().drawRange(Pass::FS,
 			ctx.m_matrices.m_view,
 			ctx.m_matrices.m_viewProjectionJitter,
 			ctx.m_prevMatrices.m_viewProjectionJitter,
 			cmdb,
-			m_r->getSamplers().m_trilinearRepeatAniso,
+			m_r->getSamplers().m_trilinearRepeatAnisoResolutionScalingBias,
 			ctx.m_renderQueue->m_forwardShadingRenderables.getBegin() + start,
 			ctx.m_renderQueue->m_forwardShadingRenderables.getBegin() + end);
 
 		// Restore state
+		cmdb->setAsyncPipelineCreation(false);
 		cmdb->setDepthWrite(true);
 		cmdb->setBlendFactors(0, BlendFactor::ONE, BlendFactor::ZERO);
 	}
@@ -79,10 +83,12 @@ void ForwardShading::setDependencies(const RenderingContext& ctx, GraphicsRender
 	pass.newDependency({m_r->getDepthDownscale().getHiZRt(), TextureUsageBit::SAMPLED_FRAGMENT, HIZ_HALF_DEPTH});
 	pass.newDependency({m_r->getDepthDownscale().getHiZRt(), TextureUsageBit::SAMPLED_FRAGMENT, HIZ_QUARTER_DEPTH});
 	pass.newDependency({m_r->getVolumetricLightingAccumulation().getRt(), TextureUsageBit::SAMPLED_FRAGMENT});
+	m_r->getGpuSkinning().setDependencies(pass);
+	m_r->getGenericCompute().setDependencies(pass);
 
 	if(ctx.m_renderQueue->m_lensFlares.getSize())
 	{
-		pass.newDependency({m_r->getLensFlare().getIndirectDrawBuffer(), BufferUsageBit::INDIRECT_GRAPHICS});
+		pass.newDependency({m_r->getLensFlare().getSpritesBuffer(), BufferUsageBit::STORAGE_VERTEX_READ});
 	}
 }
 
@@ -7,6 +7,10 @@
 #include <anki/renderer/Renderer.h>
 #include <anki/renderer/RenderQueue.h>
 #include <anki/renderer/LensFlare.h>
+#include <anki/renderer/GpuOcclusionCulling.h>
+#include <anki/renderer/GpuSkinning.h>
+#include <anki/renderer/GenericCompute.h>
+#include <anki/renderer/VrsSriGeneration.h>
 #include <anki/util/Logger.h>
 #include <anki/util/Tracer.h>
 #include <anki/core/ConfigSet.h>
@@ -62,6 +66,16 @@ Error GBuffer::initInternal(const ConfigSet& initializer)
 	m_fbDescr.m_depthStencilAttachment.m_loadOperation = AttachmentLoadOperation::CLEAR;
 	m_fbDescr.m_depthStencilAttachment.m_clearValue.m_depthStencil.m_depth = 1.0f;
 	m_fbDescr.m_depthStencilAttachment.m_aspect = DepthStencilAspectBit::DEPTH;
+
+	const U32 sriTexelSize = m_r->getVrsSriGeneration().getSriTexelSize();
+	if(sriTexelSize)
+	{
+		m_vrsFbDescr = m_fbDescr;
+		m_vrsFbDescr.m_shadingRateAttachmentTexelWidth = sriTexelSize;
+		m_vrsFbDescr.m_shadingRateAttachmentTexelHeight = sriTexelSize;
+		m_vrsFbDescr.bake();
+	}
+
 	m_fbDescr.bake();
 
 	return Error::NONE;
@@ -92,6 +106,9 @@ void GBuffer::runInThread(const RenderingContext& ctx, RenderPassWorkContext& rg
 
 	cmdb->setRasterizationOrder(RasterizationOrder::RELAXED);
 
+	// A missing object for a few frames is better than a hitch
+	cmdb->setAsyncPipelineCreation(true);
+
 	// First do early Z (if needed)
 	if(earlyZStart < earlyZEnd)
 	{
@@ -106,7 +123,7 @@ void GBuffer::runInThread(const RenderingContext& ctx, RenderPassWorkContext& rg
 			ctx.m_matrices.m_viewProjectionJitter,
 			ctx.m_matrices.m_jitter * ctx.m_prevMatrices.m_viewProjection,
 			cmdb,
-			m_r->getSamplers().m_trilinearRepeatAniso,
+			m_r->getSamplers().m_trilinearRepeatAnisoResolutionScalingBias,
 			ctx.m_renderQueue->m_earlyZRenderables.getBegin() + earlyZStart,
 			ctx.m_renderQueue->m_earlyZRenderables.getBegin() + earlyZEnd);
 
@@ -131,10 +148,14 @@ void GBuffer::runInThread(const RenderingContext& ctx, RenderPassWorkContext& rg
 			ctx.m_matrices.m_viewProjectionJitter,
 			ctx.m_matrices.m_jitter * ctx.m_prevMatrices.m_viewProjection,
 			cmdb,
-			m_r->getSamplers().m_trilinearRepeatAniso,
+			m_r->getSamplers().m_trilinearRepeatAnisoResolutionScalingBias,
 			ctx.m_renderQueue->m_renderables.getBegin() + colorStart,
-			ctx.m_renderQueue->m_renderables.getBegin() + colorEnd);
+			ctx.m_renderQueue->m_renderables.getBegin() + colorEnd,
+			0,
+			m_r->getGpuOcclusionCulling().getDrawerIndirectInfo());
 	}
+
+	cmdb->setAsyncPipelineCreation(false);
 }
 
 void GBuffer::populateRenderGraph(RenderingContext& ctx)
@@ -156,16 +177,17 @@ void GBuffer::populateRenderGraph(RenderingContext& ctx)
 	// Create pass
 	GraphicsRenderPassDescription& pass = rgraph.newGraphicsRenderPass("GBuffer");
 
-	pass.setFramebufferInfo(
-		m_fbDescr, ConstWeakArray<RenderTargetHandle>(&rts[0], GBUFFER_COLOR_ATTACHMENT_COUNT), m_depthRt);
-	pass.setWork(
+	const Bool vrs = m_r->getVrsSriGeneration().getSriAvailable();
+	pass.setFramebufferInfo((vrs) ? m_vrsFbDescr : m_fbDescr,
+		ConstWeakArray<RenderTargetHandle>(&rts[0], GBUFFER_COLOR_ATTACHMENT_COUNT),
+		m_depthRt);
+	pass.setParallelWork(
 		[](RenderPassWorkContext& rgraphCtx) {
 			GBuffer* self = static_cast<GBuffer*>(rgraphCtx.m_userData);
 			self->runInThread(*self->m_ctx, rgraphCtx);
 		},
 		this,
-		computeNumberOfSecondLevelCommandBuffers(
-			ctx.m_renderQueue->m_earlyZRenderables.getSize() + ctx.m_renderQueue->m_renderables.getSize()));
+		ctx.m_renderQueue->m_earlyZRenderables.getSize() + ctx.m_renderQueue->m_renderables.getSize());
 
 	for(U i = 0; i < GBUFFER_COLOR_ATTACHMENT_COUNT; ++i)
 	{
@@ -174,6 +196,18 @@ void GBuffer::populateRenderGraph(RenderingContext& ctx)
 
 	TextureSubresourceInfo subresource(DepthStencilAspectBit::DEPTH);
 	pass.newDependency({m_depthRt, TextureUsageBit::FRAMEBUFFER_ATTACHMENT_READ_WRITE, subresource});
+	m_r->getGpuSkinning().setDependencies(pass);
+	m_r->getGenericCompute().setDependencies(pass);
+
+	if(vrs)
+	{
+		m_r->getVrsSriGeneration().setDependencies(pass);
+	}
+
+	if(m_r->getGpuOcclusionCulling().getDrawerIndirectInfo())
+	{
+		pass.newDependency({m_r->getGpuOcclusionCulling().getIndirectArgsBuffer(), BufferUsageBit::INDIRECT_GRAPHICS});
+	}
 }
 
 } // end namespace anki
@@ -44,6 +44,7 @@ private:
 	Array<RenderTargetDescription, GBUFFER_COLOR_ATTACHMENT_COUNT> m_colorRtDescrs;
 	RenderTargetDescription m_depthRtDescr;
 	FramebufferDescription m_fbDescr;
+	FramebufferDescription m_vrsFbDescr; ///< Same as m_fbDescr plus the shading rate image.
 
 	RenderingContext* m_ctx = nullptr;
 	Array<RenderTargetHandle, GBUFFER_COLOR_ATTACHMENT_COUNT> m_colorRts;
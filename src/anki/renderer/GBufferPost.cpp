@@ -7,6 +7,8 @@
 #include <anki/renderer/Renderer.h>
 #include <anki/renderer/GBuffer.h>
 #include <anki/renderer/LightShading.h>
+#include <anki/renderer/GpuClusterBin.h>
+#include <anki/renderer/DecalAtlas.h>
 #include <anki/core/ConfigSet.h>
 
 namespace anki
@@ -70,6 +72,12 @@ void GBufferPost::populateRenderGraph(RenderingContext& ctx)
 	rpass.newDependency({m_r->getGBuffer().getDepthRt(),
 		TextureUsageBit::SAMPLED_FRAGMENT,
 		TextureSubresourceInfo(DepthStencilAspectBit::DEPTH)});
+	m_r->getGpuClusterBin().setDependencies(rpass, BufferUsageBit::STORAGE_FRAGMENT_READ);
+
+	if(m_r->getDecalAtlas().getEnabled())
+	{
+		m_r->getDecalAtlas().setDependencies(rpass, TextureUsageBit::SAMPLED_FRAGMENT);
+	}
 }
 
 void GBufferPost::run(RenderPassWorkContext& rgraphCtx)
@@ -94,14 +102,23 @@ void GBufferPost::run(RenderPassWorkContext& rgraphCtx)
 	bindUniforms(cmdb, 0, 3, ctx.m_lightShadingUniformsToken);
 	bindUniforms(cmdb, 0, 4, rsrc.m_decalsToken);
 
-	cmdb->bindTexture(0,
-		5,
-		(rsrc.m_diffDecalTexView) ? rsrc.m_diffDecalTexView : m_r->getDummyTextureView2d(),
-		TextureUsageBit::SAMPLED_FRAGMENT);
-	cmdb->bindTexture(0,
-		6,
-		(rsrc.m_specularRoughnessDecalTexView) ? rsrc.m_specularRoughnessDecalTexView : m_r->getDummyTextureView2d(),
-		TextureUsageBit::SAMPLED_FRAGMENT);
+	if(m_r->getDecalAtlas().getEnabled())
+	{
+		rgraphCtx.bindColorTexture(0, 5, m_r->getDecalAtlas().getDiffuseRt());
+		rgraphCtx.bindColorTexture(0, 6, m_r->getDecalAtlas().getSpecularRoughnessRt());
+	}
+	else
+	{
+		cmdb->bindTexture(0,
+			5,
+			(rsrc.m_diffDecalTexView) ? rsrc.m_diffDecalTexView : m_r->getDummyTextureView2d(),
+			TextureUsageBit::SAMPLED_FRAGMENT);
+		cmdb->bindTexture(0,
+			6,
+			(rsrc.m_specularRoughnessDecalTexView) ? rsrc.m_specularRoughnessDecalTexView
+												   : m_r->getDummyTextureView2d(),
+			TextureUsageBit::SAMPLED_FRAGMENT);
+	}
 
 	bindStorage(cmdb, 0, 7, rsrc.m_clustersToken);
 	bindStorage(cmdb, 0, 8, rsrc.m_indicesToken);
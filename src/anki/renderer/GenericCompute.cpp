@@ -7,39 +7,118 @@
 #include <anki/renderer/Renderer.h>
 #include <anki/renderer/DepthDownscale.h>
 #include <anki/renderer/RenderQueue.h>
+#include <anki/core/ConfigSet.h>
+#include <algorithm>
 
 namespace anki
 {
 
+static Bool canMergeGenericGpuComputeJobQueueElements(
+	const GenericGpuComputeJobQueueElement& a, const GenericGpuComputeJobQueueElement& b)
+{
+	return a.m_callback == b.m_callback && a.m_mergeKey != 0 && a.m_mergeKey == b.m_mergeKey;
+}
+
 GenericCompute::~GenericCompute()
 {
 }
 
+Error GenericCompute::init(const ConfigSet& cfg)
+{
+	m_async = cfg.getBool("r_genericComputeAsync") && getGrManager().getDeviceCapabilities().m_asyncCompute;
+
+	if(m_async)
+	{
+		m_asyncFenceBuff = getGrManager().newBuffer(BufferInitInfo(
+			sizeof(U32), BufferUsageBit::STORAGE_ALL, BufferMapAccessBit::NONE, "GenericComputeAsyncFence"));
+	}
+
+	return Error::NONE;
+}
+
 void GenericCompute::populateRenderGraph(RenderingContext& ctx)
 {
-	if(ctx.m_renderQueue->m_genericGpuComputeJobs.getSize() == 0)
+	m_runCtx.m_asyncJobCount = 0;
+
+	WeakArray<GenericGpuComputeJobQueueElement> jobs = ctx.m_renderQueue->m_genericGpuComputeJobs;
+	if(jobs.getSize() == 0)
 	{
 		return;
 	}
 
 	m_runCtx.m_ctx = &ctx;
 
-	ComputeRenderPassDescription& pass = ctx.m_renderGraphDescr.newComputeRenderPass("Generic compute");
+	// Sort the jobs so the ones that can be merged are next to each other. The async ones go last
+	std::sort(jobs.getBegin(),
+		jobs.getEnd(),
+		[async = m_async](const GenericGpuComputeJobQueueElement& a, const GenericGpuComputeJobQueueElement& b) {
+			const Bool aAsync = async && a.m_asyncCompute;
+			const Bool bAsync = async && b.m_asyncCompute;
+			if(aAsync != bAsync)
+			{
+				return !aAsync;
+			}
+
+			if(a.m_callback != b.m_callback)
+			{
+				return ptrToNumber(a.m_callback) < ptrToNumber(b.m_callback);
+			}
+
+			return a.m_mergeKey < b.m_mergeKey;
+		});
+
+	if(m_async)
+	{
+		for(const GenericGpuComputeJobQueueElement& job : jobs)
+		{
+			m_runCtx.m_asyncJobCount += job.m_asyncCompute;
+		}
+	}
+
+	RenderGraphDescription& rgraph = ctx.m_renderGraphDescr;
+
+	if(m_runCtx.m_asyncJobCount < jobs.getSize())
+	{
+		ComputeRenderPassDescription& pass = rgraph.newComputeRenderPass("Generic compute");
+
+		pass.setWork(
+			[](RenderPassWorkContext& rgraphCtx) {
+				GenericCompute* const self = static_cast<GenericCompute*>(rgraphCtx.m_userData);
+				self->run(rgraphCtx, false);
+			},
+			this,
+			0);
+
+		pass.newDependency({m_r->getDepthDownscale().getHiZRt(), TextureUsageBit::SAMPLED_COMPUTE});
+	}
+
+	if(m_runCtx.m_asyncJobCount > 0)
+	{
+		m_runCtx.m_asyncFenceBuffHandle = rgraph.importBuffer(m_asyncFenceBuff, BufferUsageBit::NONE);
+
+		ComputeRenderPassDescription& pass = rgraph.newComputeRenderPass("Generic compute async");
+		pass.setAsyncCompute();
 
-	pass.setWork(
-		[](RenderPassWorkContext& rgraphCtx) {
-			GenericCompute* const self = static_cast<GenericCompute*>(rgraphCtx.m_userData);
-			self->run(rgraphCtx);
-		},
-		this,
-		0);
+		pass.setWork(
+			[](RenderPassWorkContext& rgraphCtx) {
+				GenericCompute* const self = static_cast<GenericCompute*>(rgraphCtx.m_userData);
+				self->run(rgraphCtx, true);
+			},
+			this,
+			0);
 
-	pass.newDependency({m_r->getDepthDownscale().getHiZRt(), TextureUsageBit::SAMPLED_COMPUTE});
+		pass.newDependency({m_r->getDepthDownscale().getHiZRt(), TextureUsageBit::SAMPLED_COMPUTE});
+		pass.newDependency({m_runCtx.m_asyncFenceBuffHandle, BufferUsageBit::STORAGE_COMPUTE_WRITE});
+	}
 }
 
-void GenericCompute::run(RenderPassWorkContext& rgraphCtx)
+void GenericCompute::run(RenderPassWorkContext& rgraphCtx, Bool async)
 {
-	ANKI_ASSERT(m_runCtx.m_ctx->m_renderQueue->m_genericGpuComputeJobs.getSize() > 0);
+	ConstWeakArray<GenericGpuComputeJobQueueElement> jobs = m_runCtx.m_ctx->m_renderQueue->m_genericGpuComputeJobs;
+	const U32 syncJobCount = jobs.getSize() - m_runCtx.m_asyncJobCount;
+	const U32 firstJob = (async) ? syncJobCount : 0;
+	const U32 endJob = (async) ? jobs.getSize() : syncJobCount;
+	ANKI_ASSERT(firstJob < endJob);
 
 	GenericGpuComputeJobQueueElementContext elementCtx;
 	elementCtx.m_commandBuffer = rgraphCtx.m_commandBuffer;
@@ -49,15 +128,27 @@ void GenericCompute::run(RenderPassWorkContext& rgraphCtx)
 	elementCtx.m_projectionMatrix = m_runCtx.m_ctx->m_matrices.m_projection;
 	elementCtx.m_previousViewProjectionMatrix = m_runCtx.m_ctx->m_prevMatrices.m_viewProjection;
 	elementCtx.m_cameraTransform = m_runCtx.m_ctx->m_matrices.m_cameraTransform;
+	elementCtx.m_asyncCompute = async;
 
 	// Bind some state
 	rgraphCtx.bindTexture(0, 0, m_r->getDepthDownscale().getHiZRt(), TextureSubresourceInfo());
 
-	for(const GenericGpuComputeJobQueueElement& element : m_runCtx.m_ctx->m_renderQueue->m_genericGpuComputeJobs)
+	// Call the callback once for every group of jobs that can be merged
+	Array<const void*, MAX_MERGED_JOBS> userData;
+	U32 i = firstJob;
+	while(i < endJob)
 	{
-		ANKI_ASSERT(element.m_callback);
-		element.m_callback(elementCtx, element.m_userData);
+		const GenericGpuComputeJobQueueElement& first = jobs[i];
+		ANKI_ASSERT(first.m_callback);
+
+		U32 count = 0;
+		do
+		{
+			userData[count++] = jobs[i++].m_userData;
+		} while(i < endJob && count < MAX_MERGED_JOBS && canMergeGenericGpuComputeJobQueueElements(first, jobs[i]));
+
+		first.m_callback(elementCtx, ConstWeakArray<void*>(const_cast<void**>(&userData[0]), count));
 	}
 }
 
-} // end namespace anki
\ No newline at end of file
+} // end namespace anki
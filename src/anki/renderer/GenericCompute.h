@@ -14,7 +14,8 @@ namespace anki
 /// @{
 
 /// Executes various compute jobs required by the render queue. It's guaranteed to run before light shading and nothing
-/// more. It can access the previous frame's depth buffer.
+/// more. It can access the previous frame's depth buffer. The jobs with the same callback and merge key are merged and
+/// their callback is called once for all of them.
 class GenericCompute : public RendererObject
 {
 public:
@@ -25,22 +26,38 @@ public:
 
 	~GenericCompute();
 
-	ANKI_USE_RESULT Error init(const ConfigSet& cfg)
-	{
-		return Error::NONE;
-	}
+	ANKI_USE_RESULT Error init(const ConfigSet& cfg);
 
 	/// Populate the rendergraph.
 	void populateRenderGraph(RenderingContext& ctx);
 
+	/// Set the dependency of a pass that consumes the results of the jobs.
+	void setDependencies(RenderPassDescriptionBase& pass) const
+	{
+		if(m_runCtx.m_asyncJobCount > 0)
+		{
+			pass.newDependency({m_runCtx.m_asyncFenceBuffHandle, BufferUsageBit::STORAGE_VERTEX_READ});
+		}
+	}
+
 private:
+	/// The max number of jobs that are merged in one call of their callback.
+	static constexpr U32 MAX_MERGED_JOBS = 64;
+
+	/// The async jobs write buffers that the render graph doesn't know about. This buffer stands for them in the
+	/// graph so the consumers wait for the async queue. Nothing accesses it.
+	BufferPtr m_asyncFenceBuff;
+	Bool m_async = false;
+
 	class
 	{
 	public:
 		const RenderingContext* m_ctx = nullptr;
+		U32 m_asyncJobCount = 0; ///< The async jobs are the last ones.
+		RenderPassBufferHandle m_asyncFenceBuffHandle;
 	} m_runCtx;
 
-	void run(RenderPassWorkContext& rgraphCtx);
+	void run(RenderPassWorkContext& rgraphCtx, Bool async);
 };
 /// @}
 
@@ -6,14 +6,34 @@
 #include <anki/renderer/GlobalIllumination.h>
 #include <anki/renderer/Renderer.h>
 #include <anki/renderer/RenderQueue.h>
+#include <anki/renderer/GpuSkinning.h>
 #include <anki/core/ConfigSet.h>
 #include <anki/util/Tracer.h>
 #include <anki/collision/Aabb.h>
 #include <anki/collision/Functions.h>
+#include <anki/util/File.h>
+#include <anki/util/Filesystem.h>
 
 namespace anki
 {
 
+/// The directional light needs to change that much for the cells to get re-rendered.
+static const F32 LIGHT_DIRECTION_CHANGE_COS = 0.995f;
+static const F32 LIGHT_COLOR_CHANGE_FACTOR = 0.05f;
+
+/// The header of the GI volumes that are stored on disk. It's followed by 6 Vec4s per cell.
+class GiVolumeFileHeader
+{
+public:
+	Array<U8, 8> m_magic;
+	U32 m_cellCountX;
+	U32 m_cellCountY;
+	U32 m_cellCountZ;
+	U32 m_padding;
+};
+
+static const Array<U8, 8> GI_VOLUME_FILE_MAGIC = {{'A', 'N', 'K', 'I', 'G', 'I', 'V', '1'}};
+
 /// Given a cell index compute its world position.
 static Vec3 computeProbeCellPosition(U32 cellIdx, const GlobalIlluminationProbeQueueElement& probe)
 {
@@ -35,6 +55,24 @@ static Vec3 computeProbeCellPosition(U32 cellIdx, const GlobalIlluminationProbeQ
 	return cellPos;
 }
 
+/// Compute a hash that identifies a volume on disk. The probes that don't move get the same hash across runs.
+static U64 computeVolumeHash(const GlobalIlluminationProbeQueueElement& probe)
+{
+	class
+	{
+	public:
+		Vec3 m_aabbMin;
+		Vec3 m_aabbMax;
+		UVec3 m_cellCounts;
+	} key;
+	key.m_aabbMin = probe.m_aabbMin;
+	key.m_aabbMax = probe.m_aabbMax;
+	key.m_cellCounts = probe.m_cellCounts;
+
+	// Use a fixed version since the hash ends up in filenames
+	return computeHash(HashVersion::XXH3, &key, sizeof(key));
+}
+
 class GlobalIllumination::InternalContext
 {
 public:
@@ -45,6 +83,10 @@ public:
 		= numberToPtr<GlobalIlluminationProbeQueueElement*>(1));
 	UVec3 m_cellOfTheProbeToUpdateThisFrame ANKI_DEBUG_CODE(= UVec3(MAX_U32));
 
+	U32 m_probeToLoadThisFrameIdx ANKI_DEBUG_CODE(= MAX_U32); ///< Index in the probe list.
+	U32 m_probeToLoadThisFrameCacheEntryIdx ANKI_DEBUG_CODE(= MAX_U32);
+	U32 m_pendingSaveIdx ANKI_DEBUG_CODE(= MAX_U32); ///< Save the probe that got updated this frame.
+
 	Array<RenderTargetHandle, GBUFFER_COLOR_ATTACHMENT_COUNT> m_gbufferColorRts;
 	RenderTargetHandle m_gbufferDepthRt;
 	RenderTargetHandle m_shadowsRt;
@@ -62,8 +104,15 @@ public:
 
 GlobalIllumination::~GlobalIllumination()
 {
+	for(CacheEntry& entry : m_cacheEntries)
+	{
+		entry.m_cellTimestamps.destroy(getAllocator());
+	}
+
 	m_cacheEntries.destroy(getAllocator());
 	m_probeUuidToCacheEntryIdx.destroy(getAllocator());
+	m_cacheDirectory.destroy(getAllocator());
+	m_pendingSaves.destroy(getAllocator());
 }
 
 const RenderTargetHandle& GlobalIllumination::getVolumeRenderTarget(
@@ -122,11 +171,24 @@ Error GlobalIllumination::initInternal(const ConfigSet& cfg)
 	m_maxVisibleProbes = cfg.getNumberU32("r_giMaxVisibleProbes");
 	ANKI_ASSERT(m_maxVisibleProbes <= MAX_VISIBLE_GLOBAL_ILLUMINATION_PROBES);
 	ANKI_ASSERT(m_cacheEntries.getSize() >= m_maxVisibleProbes);
+	m_relight = cfg.getBool("r_giRelight");
+
+	const CString cacheDir = cfg.getString("r_giCacheDirectory");
+	if(!cacheDir.isEmpty())
+	{
+		if(!directoryExists(cacheDir))
+		{
+			ANKI_CHECK(createDirectory(cacheDir));
+		}
+
+		m_cacheDirectory.create(getAllocator(), cacheDir);
+	}
 
 	ANKI_CHECK(initGBuffer(cfg));
 	ANKI_CHECK(initLightShading(cfg));
 	ANKI_CHECK(initShadowMapping(cfg));
 	ANKI_CHECK(initIrradiance(cfg));
+	ANKI_CHECK(initVolumeTransfer(cfg));
 
 	return Error::NONE;
 }
@@ -242,6 +304,36 @@ Error GlobalIllumination::initIrradiance(const ConfigSet& cfg)
 	return Error::NONE;
 }
 
+Error GlobalIllumination::initVolumeTransfer(const ConfigSet& cfg)
+{
+	if(m_cacheDirectory.isEmpty())
+	{
+		return Error::NONE;
+	}
+
+	ANKI_CHECK(m_r->getResourceManager().loadResource("shaders/GiVolumeTransfer.ankiprog", m_volumeTransfer.m_prog));
+
+	for(U32 load = 0; load < 2; ++load)
+	{
+		ShaderProgramResourceVariantInitInfo variantInitInfo(m_volumeTransfer.m_prog);
+		variantInitInfo.addMutation("LOAD", load);
+
+		const ShaderProgramResourceVariant* variant;
+		m_volumeTransfer.m_prog->getOrCreateVariant(variantInitInfo, variant);
+
+		if(load)
+		{
+			m_volumeTransfer.m_loadGrProg = variant->getProgram();
+		}
+		else
+		{
+			m_volumeTransfer.m_saveGrProg = variant->getProgram();
+		}
+	}
+
+	return Error::NONE;
+}
+
 void GlobalIllumination::populateRenderGraph(RenderingContext& rctx)
 {
 	ANKI_TRACE_SCOPED_EVENT(R_GI);
@@ -252,8 +344,32 @@ void GlobalIllumination::populateRenderGraph(RenderingContext& rctx)
 	RenderGraphDescription& rgraph = rctx.m_renderGraphDescr;
 	m_giCtx = giCtx;
 
+	// Write the volumes that reached the CPU
+	if(m_pendingSaves.getSize() > 0)
+	{
+		flushPendingSaves();
+	}
+
 	// Prepare the probes
 	prepareProbes(*giCtx);
+
+	// Copy a volume that was loaded from disk
+	if(giCtx->m_probeToLoadThisFrameIdx != MAX_U32)
+	{
+		ComputeRenderPassDescription& pass = rgraph.newComputeRenderPass("GI load");
+
+		pass.setWork(
+			[](RenderPassWorkContext& rgraphCtx) {
+				InternalContext* giCtx = static_cast<InternalContext*>(rgraphCtx.m_userData);
+				giCtx->m_gi->runVolumeTransfer(rgraphCtx, *giCtx, true);
+			},
+			giCtx,
+			0);
+
+		pass.newDependency(
+			{giCtx->m_irradianceProbeRts[giCtx->m_probeToLoadThisFrameIdx], TextureUsageBit::IMAGE_COMPUTE_WRITE});
+	}
+
 	const Bool haveProbeToRender = giCtx->m_probeToUpdateThisFrame != nullptr;
 	if(!haveProbeToRender)
 	{
@@ -261,8 +377,7 @@ void GlobalIllumination::populateRenderGraph(RenderingContext& rctx)
 		return;
 	}
 
-	// Compute task counts for some of the passes
-	U32 gbufferTaskCount, smTaskCount;
+	// Count the drawcalls of some of the passes. The render graph splits them to second level command buffers
 	{
 		giCtx->m_gbufferDrawcallCount = 0;
 		giCtx->m_smDrawcallCount = 0;
@@ -276,9 +391,6 @@ void GlobalIllumination::populateRenderGraph(RenderingContext& rctx)
 				giCtx->m_smDrawcallCount += rq->m_directionalLight.m_shadowRenderQueues[0]->m_renderables.getSize();
 			}
 		}
-
-		gbufferTaskCount = computeNumberOfSecondLevelCommandBuffers(giCtx->m_gbufferDrawcallCount);
-		smTaskCount = computeNumberOfSecondLevelCommandBuffers(giCtx->m_smDrawcallCount);
 	}
 
 	// GBuffer
@@ -293,13 +405,13 @@ void GlobalIllumination::populateRenderGraph(RenderingContext& rctx)
 		// Pass
 		GraphicsRenderPassDescription& pass = rgraph.newGraphicsRenderPass("GI gbuff");
 		pass.setFramebufferInfo(m_gbuffer.m_fbDescr, giCtx->m_gbufferColorRts, giCtx->m_gbufferDepthRt);
-		pass.setWork(
+		pass.setParallelWork(
 			[](RenderPassWorkContext& rgraphCtx) {
 				InternalContext* giCtx = static_cast<InternalContext*>(rgraphCtx.m_userData);
 				giCtx->m_gi->runGBufferInThread(rgraphCtx, *giCtx);
 			},
 			giCtx,
-			gbufferTaskCount);
+			giCtx->m_gbufferDrawcallCount);
 
 		for(U i = 0; i < GBUFFER_COLOR_ATTACHMENT_COUNT; ++i)
 		{
@@ -308,6 +420,7 @@ void GlobalIllumination::populateRenderGraph(RenderingContext& rctx)
 
 		TextureSubresourceInfo subresource(DepthStencilAspectBit::DEPTH);
 		pass.newDependency({giCtx->m_gbufferDepthRt, TextureUsageBit::FRAMEBUFFER_ATTACHMENT_READ_WRITE, subresource});
+		m_r->getGpuSkinning().setDependencies(pass);
 	}
 
 	// Shadow pass. Optional
@@ -353,16 +466,17 @@ void GlobalIllumination::populateRenderGraph(RenderingContext& rctx)
 		// Pass
 		GraphicsRenderPassDescription& pass = rgraph.newGraphicsRenderPass("GI SM");
 		pass.setFramebufferInfo(m_shadowMapping.m_fbDescr, {}, giCtx->m_shadowsRt);
-		pass.setWork(
+		pass.setParallelWork(
 			[](RenderPassWorkContext& rgraphCtx) {
 				InternalContext* giCtx = static_cast<InternalContext*>(rgraphCtx.m_userData);
 				giCtx->m_gi->runShadowmappingInThread(rgraphCtx, *giCtx);
 			},
 			giCtx,
-			smTaskCount);
+			giCtx->m_smDrawcallCount);
 
 		TextureSubresourceInfo subresource(DepthStencilAspectBit::DEPTH);
 		pass.newDependency({giCtx->m_shadowsRt, TextureUsageBit::FRAMEBUFFER_ATTACHMENT_READ_WRITE, subresource});
+		m_r->getGpuSkinning().setDependencies(pass);
 	}
 	else
 	{
@@ -404,6 +518,7 @@ void GlobalIllumination::populateRenderGraph(RenderingContext& rctx)
 	// Irradiance pass. First & 2nd bounce
 	{
 		ComputeRenderPassDescription& pass = rgraph.newComputeRenderPass("GI IR");
+		pass.setAsyncCompute();
 
 		pass.setWork(
 			[](RenderPassWorkContext& rgraphCtx) {
@@ -423,28 +538,60 @@ void GlobalIllumination::populateRenderGraph(RenderingContext& rctx)
 		const U32 probeIdx = U32(giCtx->m_probeToUpdateThisFrame - &giCtx->m_ctx->m_renderQueue->m_giProbes.getFront());
 		pass.newDependency({giCtx->m_irradianceProbeRts[probeIdx], TextureUsageBit::IMAGE_COMPUTE_WRITE});
 	}
+
+	// Copy the volume to the CPU if it got complete
+	if(giCtx->m_pendingSaveIdx != MAX_U32)
+	{
+		ComputeRenderPassDescription& pass = rgraph.newComputeRenderPass("GI save");
+
+		pass.setWork(
+			[](RenderPassWorkContext& rgraphCtx) {
+				InternalContext* giCtx = static_cast<InternalContext*>(rgraphCtx.m_userData);
+				giCtx->m_gi->runVolumeTransfer(rgraphCtx, *giCtx, false);
+			},
+			giCtx,
+			0);
+
+		const U32 probeIdx = U32(giCtx->m_probeToUpdateThisFrame - &giCtx->m_ctx->m_renderQueue->m_giProbes.getFront());
+		pass.newDependency({giCtx->m_irradianceProbeRts[probeIdx], TextureUsageBit::SAMPLED_COMPUTE});
+	}
 }
 
 void GlobalIllumination::prepareProbes(InternalContext& giCtx)
 {
 	RenderingContext& ctx = *giCtx.m_ctx;
 	giCtx.m_probeToUpdateThisFrame = nullptr;
+	giCtx.m_probeToLoadThisFrameIdx = MAX_U32;
+	giCtx.m_probeToLoadThisFrameCacheEntryIdx = MAX_U32;
+	giCtx.m_pendingSaveIdx = MAX_U32;
 
 	if(ANKI_UNLIKELY(ctx.m_renderQueue->m_giProbes.getSize() == 0))
 	{
 		return;
 	}
 
+	if(m_relight)
+	{
+		detectLightingChanges(*ctx.m_renderQueue);
+	}
+
+	const Timestamp crntTimestamp = m_r->getGlobalTimestamp();
+	const Vec3 cameraPos = ctx.m_renderQueue->m_cameraTransform.getTranslationPart().xyz();
+
 	// Iterate the probes and:
-	// - Find a probe to update this frame
-	// - Find a probe to update next frame
 	// - Find the cache entries for each probe
+	// - Load the volume of a probe from disk
+	// - Find a probe to update this frame
+	// - Find the probe with the closest cell to update next frame
 	DynamicArray<GlobalIlluminationProbeQueueElement> newListOfProbes;
 	newListOfProbes.create(ctx.m_tempAllocator, ctx.m_renderQueue->m_giProbes.getSize());
 	DynamicArray<RenderTargetHandle> volumeRts;
 	volumeRts.create(ctx.m_tempAllocator, ctx.m_renderQueue->m_giProbes.getSize());
 	U32 newListOfProbeCount = 0;
-	Bool foundProbeToUpdateNextFrame = false;
+	GlobalIlluminationProbeQueueElement* probeToUpdateNextFrame = nullptr;
+	U32 probeToUpdateNextFrameCacheEntryIdx = MAX_U32;
+	U32 cellToRenderNextFrame = MAX_U32;
+	F32 cellToRenderNextFrameDistance = MAX_F32;
 	for(U32 probeIdx = 0; probeIdx < ctx.m_renderQueue->m_giProbes.getSize(); ++probeIdx)
 	{
 		if(newListOfProbeCount + 1 >= m_maxVisibleProbes)
@@ -459,7 +606,7 @@ void GlobalIllumination::prepareProbes(InternalContext& giCtx)
 
 		// Find cache entry
 		const U32 cacheEntryIdx = findBestCacheEntry(
-			probe.m_uuid, m_r->getGlobalTimestamp(), m_cacheEntries, m_probeUuidToCacheEntryIdx, getAllocator());
+			probe.m_uuid, crntTimestamp, m_cacheEntries, m_probeUuidToCacheEntryIdx, getAllocator());
 		if(ANKI_UNLIKELY(cacheEntryIdx == MAX_U32))
 		{
 			// Failed
@@ -473,105 +620,167 @@ void GlobalIllumination::prepareProbes(InternalContext& giCtx)
 		const Bool cacheEntryDirty = entry.m_uuid != probe.m_uuid || entry.m_volumeSize != probe.m_cellCounts
 									 || entry.m_probeAabbMin != probe.m_aabbMin
 									 || entry.m_probeAabbMax != probe.m_aabbMax;
-		const Bool needsUpdate = cacheEntryDirty || entry.m_renderedCells < probe.m_totalCellCount;
-
-		if(ANKI_LIKELY(!needsUpdate))
-		{
-			// It's updated, early exit
-
-			entry.m_lastUsedTimestamp = m_r->getGlobalTimestamp();
-			volumeRts[newListOfProbeCount] =
-				ctx.m_renderGraphDescr.importRenderTarget(entry.m_volumeTex, TextureUsageBit::SAMPLED_FRAGMENT);
-			newListOfProbes[newListOfProbeCount++] = probe;
-			continue;
-		}
-
-		// It needs update
 
-		const Bool canUpdateThisFrame = giCtx.m_probeToUpdateThisFrame == nullptr && probe.m_renderQueues[0] != nullptr;
-		const Bool canUpdateNextFrame = !foundProbeToUpdateNextFrame;
-
-		if(!canUpdateThisFrame && canUpdateNextFrame)
+		// Maybe there is a volume on disk
+		BufferPtr loadBuff;
+		if(cacheEntryDirty && !m_cacheDirectory.isEmpty())
 		{
-			// Probe will (possibly) be updated next frame, inform the probe
-
-			foundProbeToUpdateNextFrame = true;
+			StringAuto filename(getAllocator());
+			getVolumeFilename(computeVolumeHash(probe), filename);
 
-			const U32 cellToRender = (cacheEntryDirty) ? 0 : entry.m_renderedCells;
-			const Vec3 cellPos = computeProbeCellPosition(cellToRender, probe);
-			probe.m_feedbackCallback(true, probe.m_feedbackCallbackUserData, cellPos.xyz0());
-			continue;
-		}
-		else if(!canUpdateThisFrame)
-		{
-			// Can't be updated this frame so remove it from the list
-			continue;
+			if(fileExists(filename.toCString()))
+			{
+				if(giCtx.m_probeToLoadThisFrameIdx != MAX_U32)
+				{
+					// Load one per frame, try again next frame
+					continue;
+				}
+
+				if(loadVolume(filename.toCString(), probe.m_cellCounts, loadBuff))
+				{
+					ANKI_R_LOGW("Failed to load GI volume. Will render it: %s", filename.cstr());
+					loadBuff.reset(nullptr);
+				}
+			}
 		}
 
-		// All good, can use this probe in this frame
-
 		if(cacheEntryDirty)
 		{
-			entry.m_renderedCells = 0;
 			entry.m_uuid = probe.m_uuid;
 			entry.m_probeAabbMin = probe.m_aabbMin;
 			entry.m_probeAabbMax = probe.m_aabbMax;
-			entry.m_volumeSize = probe.m_cellCounts;
+			entry.m_cleanTimestamp = 0;
+			entry.m_cellToRenderNextFrame = MAX_U32;
+			entry.m_loadBuff = loadBuff;
 			m_probeUuidToCacheEntryIdx.emplace(getAllocator(), probe.m_uuid, cacheEntryIdx);
+
+			// Init the cache entry textures
+			const Bool shouldInitTextures = !entry.m_volumeTex.isCreated() || entry.m_volumeSize != probe.m_cellCounts;
+			if(shouldInitTextures)
+			{
+				TextureInitInfo texInit;
+				texInit.m_type = TextureType::_3D;
+				texInit.m_format = Format::B10G11R11_UFLOAT_PACK32;
+				texInit.m_width = probe.m_cellCounts.x() * 6;
+				texInit.m_height = probe.m_cellCounts.y();
+				texInit.m_depth = probe.m_cellCounts.z();
+				texInit.m_usage = TextureUsageBit::ALL_COMPUTE | TextureUsageBit::SAMPLED_ALL;
+				texInit.m_initialUsage = TextureUsageBit::SAMPLED_FRAGMENT;
+
+				entry.m_volumeTex = m_r->createAndClearRenderTarget(texInit);
+			}
+			entry.m_volumeSize = probe.m_cellCounts;
+
+			// A loaded volume is complete
+			const Timestamp cellTimestamp = (loadBuff) ? crntTimestamp : 0;
+			entry.m_renderedCells = (loadBuff) ? probe.m_totalCellCount : 0;
+			entry.m_cellTimestamps.destroy(getAllocator());
+			entry.m_cellTimestamps.create(getAllocator(), probe.m_totalCellCount, cellTimestamp);
 		}
 
-		// Update the cache entry
-		entry.m_lastUsedTimestamp = m_r->getGlobalTimestamp();
+		entry.m_lastUsedTimestamp = crntTimestamp;
 
-		// Init the cache entry textures
-		const Bool shouldInitTextures = !entry.m_volumeTex.isCreated() || entry.m_volumeSize != probe.m_cellCounts;
-		if(shouldInitTextures)
+		// Render the cell that the scene gathered the renderables for
+		const Bool updateThisFrame = giCtx.m_probeToUpdateThisFrame == nullptr && probe.m_renderQueues[0] != nullptr
+									 && entry.m_cellToRenderNextFrame != MAX_U32;
+		if(updateThisFrame)
 		{
-			TextureInitInfo texInit;
-			texInit.m_type = TextureType::_3D;
-			texInit.m_format = Format::B10G11R11_UFLOAT_PACK32;
-			texInit.m_width = probe.m_cellCounts.x() * 6;
-			texInit.m_height = probe.m_cellCounts.y();
-			texInit.m_depth = probe.m_cellCounts.z();
-			texInit.m_usage = TextureUsageBit::ALL_COMPUTE | TextureUsageBit::SAMPLED_ALL;
-			texInit.m_initialUsage = TextureUsageBit::SAMPLED_FRAGMENT;
+			const U32 cellToRender = entry.m_cellToRenderNextFrame;
+			ANKI_ASSERT(cellToRender < probe.m_totalCellCount);
+			unflatten3dArrayIndex(probe.m_cellCounts.z(),
+				probe.m_cellCounts.y(),
+				probe.m_cellCounts.x(),
+				cellToRender,
+				giCtx.m_cellOfTheProbeToUpdateThisFrame.z(),
+				giCtx.m_cellOfTheProbeToUpdateThisFrame.y(),
+				giCtx.m_cellOfTheProbeToUpdateThisFrame.x());
+
+			if(entry.m_cellTimestamps[cellToRender] == 0)
+			{
+				++entry.m_renderedCells;
+
+				// Save the volume when it's complete for the first time
+				if(entry.m_renderedCells == probe.m_totalCellCount && !m_cacheDirectory.isEmpty())
+				{
+					PendingSave save;
+					BufferInitInfo buffInit("GI save");
+					buffInit.m_access = BufferMapAccessBit::READ;
+					buffInit.m_size = sizeof(Vec4) * 6 * probe.m_totalCellCount;
+					buffInit.m_usage = BufferUsageBit::STORAGE_COMPUTE_WRITE;
+					save.m_buff = getGrManager().newBuffer(buffInit);
+					save.m_frame = m_r->getFrameCount();
+					save.m_volumeHash = computeVolumeHash(probe);
+					save.m_cellCounts = probe.m_cellCounts;
+
+					giCtx.m_pendingSaveIdx = m_pendingSaves.getSize();
+					m_pendingSaves.emplaceBack(getAllocator(), save);
+				}
+			}
 
-			entry.m_volumeTex = m_r->createAndClearRenderTarget(texInit);
+			entry.m_cellTimestamps[cellToRender] = crntTimestamp;
 		}
 
-		// Compute the render position
-		const U32 cellToRender = entry.m_renderedCells++;
-		ANKI_ASSERT(cellToRender < probe.m_totalCellCount);
-		unflatten3dArrayIndex(probe.m_cellCounts.z(),
-			probe.m_cellCounts.y(),
-			probe.m_cellCounts.x(),
-			cellToRender,
-			giCtx.m_cellOfTheProbeToUpdateThisFrame.z(),
-			giCtx.m_cellOfTheProbeToUpdateThisFrame.y(),
-			giCtx.m_cellOfTheProbeToUpdateThisFrame.x());
-
-		// Inform probe about its next frame
-		if(entry.m_renderedCells == probe.m_totalCellCount)
+		// Stop gathering renderables. The probe with the closest cell will be asked again bellow
+		if(probe.m_renderQueues[0] != nullptr)
 		{
-			// Don't gather renderables next frame if it's done
+			entry.m_cellToRenderNextFrame = MAX_U32;
 			probe.m_feedbackCallback(false, probe.m_feedbackCallbackUserData, Vec4(0.0f));
 		}
-		else if(!foundProbeToUpdateNextFrame)
+
+		// Find the next cell to render
+		const Bool mayHaveStaleCells = entry.m_renderedCells < probe.m_totalCellCount
+									   || (m_relight && entry.m_cleanTimestamp < m_lightingChangeTimestamp);
+		if(mayHaveStaleCells)
+		{
+			F32 cellDistance;
+			const U32 cellIdx = findCellToRender(probe, entry, cameraPos, cellDistance);
+			if(cellIdx == MAX_U32)
+			{
+				entry.m_cleanTimestamp = crntTimestamp;
+			}
+			else if(cellDistance < cellToRenderNextFrameDistance)
+			{
+				cellToRenderNextFrameDistance = cellDistance;
+				cellToRenderNextFrame = cellIdx;
+				probeToUpdateNextFrame = &probe;
+				probeToUpdateNextFrameCacheEntryIdx = cacheEntryIdx;
+			}
+		}
+
+		// Skip the probes that are not complete, unless they are updated this frame
+		if(entry.m_renderedCells < probe.m_totalCellCount && !updateThisFrame)
 		{
-			// Gather rendederables from the same probe next frame
-			foundProbeToUpdateNextFrame = true;
-			const Vec3 cellPos = computeProbeCellPosition(entry.m_renderedCells, probe);
-			probe.m_feedbackCallback(true, probe.m_feedbackCallbackUserData, cellPos.xyz0());
+			continue;
 		}
 
 		// Push the probe to the new list
-		giCtx.m_probeToUpdateThisFrame = &newListOfProbes[newListOfProbeCount];
+		if(updateThisFrame)
+		{
+			giCtx.m_probeToUpdateThisFrame = &newListOfProbes[newListOfProbeCount];
+		}
+
+		if(loadBuff)
+		{
+			giCtx.m_probeToLoadThisFrameIdx = newListOfProbeCount;
+			giCtx.m_probeToLoadThisFrameCacheEntryIdx = cacheEntryIdx;
+		}
+
 		newListOfProbes[newListOfProbeCount] = probe;
 		volumeRts[newListOfProbeCount] =
 			ctx.m_renderGraphDescr.importRenderTarget(entry.m_volumeTex, TextureUsageBit::SAMPLED_FRAGMENT);
 		++newListOfProbeCount;
 	}
 
+	// Inform the probe about its next frame
+	if(probeToUpdateNextFrame)
+	{
+		m_cacheEntries[probeToUpdateNextFrameCacheEntryIdx].m_cellToRenderNextFrame = cellToRenderNextFrame;
+
+		const Vec3 cellPos = computeProbeCellPosition(cellToRenderNextFrame, *probeToUpdateNextFrame);
+		probeToUpdateNextFrame->m_feedbackCallback(
+			true, probeToUpdateNextFrame->m_feedbackCallbackUserData, cellPos.xyz0());
+	}
+
 	// Replace the probe list in the queue
 	if(newListOfProbeCount > 0)
 	{
@@ -592,6 +801,156 @@ void GlobalIllumination::prepareProbes(InternalContext& giCtx)
 	}
 }
 
+void GlobalIllumination::detectLightingChanges(const RenderQueue& rqueue)
+{
+	const DirectionalLightQueueElement& light = rqueue.m_directionalLight;
+
+	Bool changed = light.m_uuid != m_dirLightUuid;
+	if(!changed && light.m_uuid)
+	{
+		const F32 colorChange = (light.m_diffuseColor - m_dirLightColor).getLength();
+		changed = light.m_direction.dot(m_dirLightDirection) < LIGHT_DIRECTION_CHANGE_COS
+				  || colorChange > LIGHT_COLOR_CHANGE_FACTOR * max(m_dirLightColor.getLength(), EPSILON);
+	}
+
+	if(changed)
+	{
+		// Compare with the light of the last change so slow changes add up
+		m_lightingChangeTimestamp = m_r->getGlobalTimestamp();
+		m_dirLightUuid = light.m_uuid;
+		m_dirLightDirection = light.m_direction;
+		m_dirLightColor = light.m_diffuseColor;
+	}
+}
+
+U32 GlobalIllumination::findCellToRender(const GlobalIlluminationProbeQueueElement& probe,
+	const CacheEntry& entry,
+	const Vec3& cameraPos,
+	F32& cellDistance) const
+{
+	ANKI_ASSERT(entry.m_cellTimestamps.getSize() == probe.m_totalCellCount);
+
+	const Timestamp staleTimestamp = (m_relight) ? m_lightingChangeTimestamp : 1;
+	U32 outCellIdx = MAX_U32;
+	cellDistance = MAX_F32;
+	for(U32 cellIdx = 0; cellIdx < probe.m_totalCellCount; ++cellIdx)
+	{
+		if(entry.m_cellTimestamps[cellIdx] >= staleTimestamp && entry.m_cellTimestamps[cellIdx] != 0)
+		{
+			continue;
+		}
+
+		const F32 dist = (computeProbeCellPosition(cellIdx, probe) - cameraPos).getLengthSquared();
+		if(dist < cellDistance)
+		{
+			cellDistance = dist;
+			outCellIdx = cellIdx;
+		}
+	}
+
+	if(outCellIdx != MAX_U32)
+	{
+		cellDistance = sqrt(cellDistance);
+	}
+
+	return outCellIdx;
+}
+
+void GlobalIllumination::getVolumeFilename(U64 volumeHash, StringAuto& filename) const
+{
+	ANKI_ASSERT(!m_cacheDirectory.isEmpty());
+	filename.sprintf("%s/%016" PRIx64 ".ankigi", m_cacheDirectory.cstr(), volumeHash);
+}
+
+Error GlobalIllumination::loadVolume(CString filename, const UVec3& cellCounts, BufferPtr& buff)
+{
+	File file;
+	ANKI_CHECK(file.open(filename, FileOpenFlag::READ | FileOpenFlag::BINARY));
+
+	GiVolumeFileHeader header;
+	ANKI_CHECK(file.read(&header, sizeof(header)));
+	if(memcmp(&header.m_magic[0], &GI_VOLUME_FILE_MAGIC[0], sizeof(GI_VOLUME_FILE_MAGIC)) != 0
+		|| header.m_cellCountX != cellCounts.x()
+		|| header.m_cellCountY != cellCounts.y() || header.m_cellCountZ != cellCounts.z())
+	{
+		ANKI_R_LOGE("Wrong GI volume header");
+		return Error::USER_DATA;
+	}
+
+	const PtrSize size = sizeof(Vec4) * 6 * cellCounts.x() * cellCounts.y() * cellCounts.z();
+
+	BufferInitInfo buffInit("GI load");
+	buffInit.m_access = BufferMapAccessBit::WRITE;
+	buffInit.m_size = size;
+	buffInit.m_usage = BufferUsageBit::STORAGE_COMPUTE_READ;
+	buff = getGrManager().newBuffer(buffInit);
+
+	void* mapped = buff->map(0, size, BufferMapAccessBit::WRITE);
+	const Error err = file.read(mapped, size);
+	buff->unmap();
+
+	return err;
+}
+
+void GlobalIllumination::flushPendingSaves()
+{
+	U32 pendingCount = 0;
+	for(PendingSave& save : m_pendingSaves)
+	{
+		// The GPU is done with the frames that are MAX_FRAMES_IN_FLIGHT old
+		if(save.m_frame + MAX_FRAMES_IN_FLIGHT > m_r->getFrameCount())
+		{
+			m_pendingSaves[pendingCount++] = save;
+			continue;
+		}
+
+		StringAuto filename(getAllocator());
+		getVolumeFilename(save.m_volumeHash, filename);
+
+		GiVolumeFileHeader header;
+		header.m_magic = GI_VOLUME_FILE_MAGIC;
+		header.m_cellCountX = save.m_cellCounts.x();
+		header.m_cellCountY = save.m_cellCounts.y();
+		header.m_cellCountZ = save.m_cellCounts.z();
+		header.m_padding = 0;
+
+		const PtrSize size = save.m_buff->getSize();
+		const void* mapped = save.m_buff->map(0, size, BufferMapAccessBit::READ);
+
+		File file;
+		Error err = file.open(filename.toCString(), FileOpenFlag::WRITE | FileOpenFlag::BINARY);
+		if(!err)
+		{
+			err = file.write(&header, sizeof(header));
+		}
+
+		if(!err)
+		{
+			err = file.write(mapped, size);
+		}
+
+		save.m_buff->unmap();
+
+		if(err)
+		{
+			ANKI_R_LOGE("Failed to save GI volume: %s", filename.cstr());
+		}
+		else
+		{
+			ANKI_R_LOGI("GI volume saved: %s", filename.cstr());
+		}
+	}
+
+	if(pendingCount == 0)
+	{
+		m_pendingSaves.destroy(getAllocator());
+	}
+	else
+	{
+		m_pendingSaves.resize(getAllocator(), pendingCount);
+	}
+}
+
 void GlobalIllumination::runGBufferInThread(RenderPassWorkContext& rgraphCtx, InternalContext& giCtx) const
 {
 	ANKI_ASSERT(giCtx.m_probeToUpdateThisFrame);
@@ -694,7 +1053,10 @@ void GlobalIllumination::runShadowmappingInThread(RenderPassWorkContext& rgraphC
 				cascadeRenderQueue.m_renderables.getBegin() + localEnd,
 				MAX_LOD_COUNT - 1);
 		}
+
+		drawcallCount += faceDrawcallCount;
 	}
+	ANKI_ASSERT(giCtx.m_smDrawcallCount == U32(drawcallCount));
 
 	// It's secondary, no need to restore the state
 }
@@ -740,7 +1102,7 @@ void GlobalIllumination::runLightShading(RenderPassWorkContext& rgraphCtx, Inter
 
 		TraditionalDeferredLightShadingDrawInfo dsInfo;
 		dsInfo.m_viewProjectionMatrix = rqueue.m_viewProjectionMatrix;
-		dsInfo.m_invViewProjectionMatrix = rqueue.m_viewProjectionMatrix.getInverse();
+		dsInfo.m_invViewProjectionMatrix = rqueue.m_frustumData.m_invViewProjectionMatrix;
 		dsInfo.m_cameraPosWSpace = rqueue.m_cameraTransform.getTranslationPart();
 		dsInfo.m_viewport = UVec4(faceIdx * m_tileSize, 0, m_tileSize, m_tileSize);
 		dsInfo.m_gbufferTexCoordsScale = Vec2(1.0f / F32(m_tileSize * 6), 1.0f / F32(m_tileSize));
@@ -800,4 +1162,46 @@ void GlobalIllumination::runIrradiance(RenderPassWorkContext& rgraphCtx, Interna
 	cmdb->dispatchCompute(1, 1, 1);
 }
 
+void GlobalIllumination::runVolumeTransfer(RenderPassWorkContext& rgraphCtx, InternalContext& giCtx, Bool load)
+{
+	ANKI_TRACE_SCOPED_EVENT(R_GI);
+
+	CommandBufferPtr& cmdb = rgraphCtx.m_commandBuffer;
+
+	U32 probeIdx;
+	BufferPtr buff;
+	if(load)
+	{
+		probeIdx = giCtx.m_probeToLoadThisFrameIdx;
+		buff = m_cacheEntries[giCtx.m_probeToLoadThisFrameCacheEntryIdx].m_loadBuff;
+	}
+	else
+	{
+		ANKI_ASSERT(giCtx.m_probeToUpdateThisFrame);
+		probeIdx = U32(giCtx.m_probeToUpdateThisFrame - &giCtx.m_ctx->m_renderQueue->m_giProbes.getFront());
+		buff = m_pendingSaves[giCtx.m_pendingSaveIdx].m_buff;
+	}
+
+	const GlobalIlluminationProbeQueueElement& probe = giCtx.m_ctx->m_renderQueue->m_giProbes[probeIdx];
+	const RenderTargetHandle& volumeRt = giCtx.m_irradianceProbeRts[probeIdx];
+
+	if(load)
+	{
+		cmdb->bindShaderProgram(m_volumeTransfer.m_loadGrProg);
+		rgraphCtx.bindImage(0, 0, volumeRt, TextureSubresourceInfo());
+	}
+	else
+	{
+		cmdb->bindShaderProgram(m_volumeTransfer.m_saveGrProg);
+		rgraphCtx.bindColorTexture(0, 0, volumeRt);
+	}
+
+	cmdb->bindStorageBuffer(0, 1, buff, 0, buff->getSize());
+
+	const U32 workgroupSize = 4;
+	cmdb->dispatchCompute((probe.m_cellCounts.x() * 6 + workgroupSize - 1) / workgroupSize,
+		(probe.m_cellCounts.y() + workgroupSize - 1) / workgroupSize,
+		(probe.m_cellCounts.z() + workgroupSize - 1) / workgroupSize);
+}
+
 } // end namespace anki
@@ -57,7 +57,21 @@ private:
 		UVec3 m_volumeSize = UVec3(0u);
 		Vec3 m_probeAabbMin = Vec3(0.0f);
 		Vec3 m_probeAabbMax = Vec3(0.0f);
-		U32 m_renderedCells = 0;
+		U32 m_renderedCells = 0; ///< The cells that got rendered at least once.
+		DynamicArray<Timestamp> m_cellTimestamps; ///< When each cell got rendered. Zero if never.
+		Timestamp m_cleanTimestamp = 0; ///< When all the cells were found up to date.
+		U32 m_cellToRenderNextFrame = MAX_U32; ///< The cell that the scene gathers renderables for.
+		BufferPtr m_loadBuff; ///< Holds the volume that was loaded from disk.
+	};
+
+	/// A volume on its way to the disk.
+	class PendingSave
+	{
+	public:
+		BufferPtr m_buff;
+		U64 m_frame = 0; ///< The frame the GPU copied the volume to the buffer.
+		U64 m_volumeHash = 0;
+		UVec3 m_cellCounts = UVec3(0u);
 	};
 
 	class
@@ -96,6 +110,29 @@ private:
 		ShaderProgramPtr m_grProg;
 	} m_irradiance; ///< Irradiance.
 
+	class
+	{
+	public:
+		ShaderProgramResourcePtr m_prog;
+		ShaderProgramPtr m_loadGrProg;
+		ShaderProgramPtr m_saveGrProg;
+	} m_volumeTransfer; ///< Save and load the volumes.
+
+	/// @name Relighting
+	/// @{
+	Bool m_relight = false;
+	Timestamp m_lightingChangeTimestamp = 0; ///< The cells that got rendered before that are stale.
+	U64 m_dirLightUuid = 0;
+	Vec3 m_dirLightDirection = Vec3(0.0f);
+	Vec3 m_dirLightColor = Vec3(0.0f);
+	/// @}
+
+	/// @name Volumes on disk
+	/// @{
+	String m_cacheDirectory; ///< Empty if the volumes are not saved.
+	DynamicArray<PendingSave> m_pendingSaves;
+	/// @}
+
 	InternalContext* m_giCtx = nullptr;
 	DynamicArray<CacheEntry> m_cacheEntries;
 	HashMap<U64, U32> m_probeUuidToCacheEntryIdx;
@@ -107,13 +144,33 @@ private:
 	ANKI_USE_RESULT Error initShadowMapping(const ConfigSet& cfg);
 	ANKI_USE_RESULT Error initLightShading(const ConfigSet& cfg);
 	ANKI_USE_RESULT Error initIrradiance(const ConfigSet& cfg);
+	ANKI_USE_RESULT Error initVolumeTransfer(const ConfigSet& cfg);
 
 	void runGBufferInThread(RenderPassWorkContext& rgraphCtx, InternalContext& giCtx) const;
 	void runShadowmappingInThread(RenderPassWorkContext& rgraphCtx, InternalContext& giCtx) const;
 	void runLightShading(RenderPassWorkContext& rgraphCtx, InternalContext& giCtx);
 	void runIrradiance(RenderPassWorkContext& rgraphCtx, InternalContext& giCtx);
+	void runVolumeTransfer(RenderPassWorkContext& rgraphCtx, InternalContext& giCtx, Bool load);
 
 	void prepareProbes(InternalContext& giCtx);
+
+	/// Restart the timer of the cells if the directional light changed enough.
+	void detectLightingChanges(const RenderQueue& rqueue);
+
+	/// Find the cell closest to the camera that was never rendered or it's stale.
+	U32 findCellToRender(const GlobalIlluminationProbeQueueElement& probe,
+		const CacheEntry& entry,
+		const Vec3& cameraPos,
+		F32& cellDistance) const;
+
+	/// Get the file that a probe with a specific shape is saved to.
+	void getVolumeFilename(U64 volumeHash, StringAuto& filename) const;
+
+	/// Load a volume from disk into a new buffer.
+	ANKI_USE_RESULT Error loadVolume(CString filename, const UVec3& cellCounts, BufferPtr& buff);
+
+	/// Write the volumes that the GPU finished copying.
+	void flushPendingSaves();
 };
 /// @}
 
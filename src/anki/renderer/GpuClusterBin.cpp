@@ -0,0 +1,191 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/renderer/GpuClusterBin.h>
+#include <anki/renderer/Renderer.h>
+#include <anki/renderer/RenderQueue.h>
+#include <anki/Collision.h>
+#include <anki/core/ConfigSet.h>
+#include <anki/util/Tracer.h>
+
+namespace anki
+{
+
+GpuClusterBin::~GpuClusterBin()
+{
+}
+
+Error GpuClusterBin::init(const ConfigSet& cfg)
+{
+	m_enabled = cfg.getBool("r_gpuClusterBinning");
+	if(!m_enabled)
+	{
+		return Error::NONE;
+	}
+
+	ANKI_R_LOGI("Initializing GPU cluster binning");
+
+	const U32 avgObjectsPerCluster = cfg.getNumberU32("r_avgObjectsPerCluster");
+	const UVec3 clusterCount(m_r->getClusterCount()[0], m_r->getClusterCount()[1], m_r->getClusterCount()[2]);
+
+	ANKI_CHECK(getResourceManager().loadResource("shaders/GpuClusterBin.ankiprog", m_prog));
+
+	ShaderProgramResourceVariantInitInfo variantInitInfo(m_prog);
+	variantInitInfo.addConstant("CLUSTER_COUNT", clusterCount);
+	variantInitInfo.addConstant("AVG_OBJECTS_PER_CLUSTER", avgObjectsPerCluster);
+	const ShaderProgramResourceVariant* variant;
+	m_prog->getOrCreateVariant(variantInitInfo, variant);
+	m_grProg = variant->getProgram();
+
+	// Same size as the ones of the ClusterBin
+	const U32 totalClusterCount = m_r->getClusterCount()[3];
+	const U32 indicesPerCluster = avgObjectsPerCluster + TYPED_OBJECT_COUNT - 1 + TYPED_OBJECT_COUNT;
+	const BufferUsageBit usage =
+		BufferUsageBit::STORAGE_COMPUTE_READ_WRITE | BufferUsageBit::STORAGE_FRAGMENT_READ;
+
+	m_clustersBuff = getGrManager().newBuffer(
+		BufferInitInfo(totalClusterCount * sizeof(U32), usage, BufferMapAccessBit::NONE, "GpuClusterBinClusters"));
+	m_indicesBuff = getGrManager().newBuffer(BufferInitInfo(
+		totalClusterCount * indicesPerCluster * sizeof(U32), usage, BufferMapAccessBit::NONE, "GpuClusterBinIndices"));
+
+	return Error::NONE;
+}
+
+void GpuClusterBin::populateRenderGraph(RenderingContext& ctx)
+{
+	if(!m_enabled)
+	{
+		return;
+	}
+
+	ANKI_TRACE_SCOPED_EVENT(R_BIN_TO_CLUSTERS);
+
+	m_runCtx.m_ctx = &ctx;
+
+	// The passes bind the output like the staging memory of the ClusterBin
+	ClusterBinOut& out = ctx.m_clusterBinOut;
+	out.m_clustersToken.m_buffer = m_clustersBuff;
+	out.m_clustersToken.m_offset = 0;
+	out.m_clustersToken.m_range = m_clustersBuff->getSize();
+	out.m_clustersToken.m_type = StagingGpuMemoryType::STORAGE;
+
+	out.m_indicesToken.m_buffer = m_indicesBuff;
+	out.m_indicesToken.m_offset = 0;
+	out.m_indicesToken.m_range = m_indicesBuff->getSize();
+	out.m_indicesToken.m_type = StagingGpuMemoryType::STORAGE;
+
+	// Create the pass. It should be before the passes that read the clusters
+	RenderGraphDescription& rgraph = ctx.m_renderGraphDescr;
+	m_runCtx.m_clustersBuffHandle = rgraph.importBuffer(m_clustersBuff, BufferUsageBit::NONE);
+	m_runCtx.m_indicesBuffHandle = rgraph.importBuffer(m_indicesBuff, BufferUsageBit::NONE);
+
+	ComputeRenderPassDescription& pass = rgraph.newComputeRenderPass("GPU cluster bin");
+
+	pass.setWork(
+		[](RenderPassWorkContext& rgraphCtx) {
+			GpuClusterBin* const self = static_cast<GpuClusterBin*>(rgraphCtx.m_userData);
+			self->run(rgraphCtx);
+		},
+		this,
+		0);
+
+	pass.newDependency({m_runCtx.m_clustersBuffHandle, BufferUsageBit::STORAGE_COMPUTE_WRITE});
+	pass.newDependency({m_runCtx.m_indicesBuffHandle, BufferUsageBit::STORAGE_COMPUTE_WRITE});
+}
+
+void GpuClusterBin::run(RenderPassWorkContext& rgraphCtx)
+{
+	CommandBufferPtr& cmdb = rgraphCtx.m_commandBuffer;
+	const RenderingContext& ctx = *m_runCtx.m_ctx;
+	const RenderQueue& rqueue = *ctx.m_renderQueue;
+
+	// The offsets of the object types. The order is the same as the one of the ClusterBin
+	Array<U32, TYPED_OBJECT_COUNT + 1> offsets;
+	offsets[0] = 0;
+	offsets[1] = offsets[0] + rqueue.m_pointLights.getSize();
+	offsets[2] = offsets[1] + rqueue.m_spotLights.getSize();
+	offsets[3] = offsets[2] + rqueue.m_reflectionProbes.getSize();
+	offsets[4] = offsets[3] + rqueue.m_giProbes.getSize();
+	offsets[5] = offsets[4] + rqueue.m_decals.getSize();
+	offsets[6] = offsets[5] + rqueue.m_fogDensityVolumes.getSize();
+
+	// Write the bounding volumes of the objects. See the shader for their format
+	const U32 objectCount = offsets[TYPED_OBJECT_COUNT];
+	StagingGpuMemoryToken objectsToken;
+	Vec4* objects = allocateStorage<Vec4*>(max(objectCount, 1u) * 2 * sizeof(Vec4), objectsToken);
+
+	for(const PointLightQueueElement& light : rqueue.m_pointLights)
+	{
+		*objects++ = Vec4(light.m_worldPosition, light.m_radius);
+		*objects++ = Vec4(0.0f);
+	}
+
+	for(const SpotLightQueueElement& light : rqueue.m_spotLights)
+	{
+		*objects++ = Vec4(light.m_worldTransform.getTranslationPart().xyz(), light.m_distance);
+		*objects++ = Vec4(-light.m_worldTransform.getZAxis().xyz(), light.m_outerAngle / 2.0f);
+	}
+
+	for(const ReflectionProbeQueueElement& probe : rqueue.m_reflectionProbes)
+	{
+		*objects++ = Vec4(probe.m_aabbMin, 0.0f);
+		*objects++ = Vec4(probe.m_aabbMax, 0.0f);
+	}
+
+	for(const GlobalIlluminationProbeQueueElement& probe : rqueue.m_giProbes)
+	{
+		*objects++ = Vec4(probe.m_aabbMin, 0.0f);
+		*objects++ = Vec4(probe.m_aabbMax, 0.0f);
+	}
+
+	for(const DecalQueueElement& decal : rqueue.m_decals)
+	{
+		// The shader tests the AABB of the OBB. It's a bit more conservative than the CPU test
+		const Aabb box = computeAabb(
+			Obb(decal.m_obbCenter.xyz0(), Mat3x4(decal.m_obbRotation), decal.m_obbExtend.xyz0()));
+		*objects++ = box.getMin().xyz0();
+		*objects++ = box.getMax().xyz0();
+	}
+
+	for(const FogDensityQueueElement& fogVol : rqueue.m_fogDensityVolumes)
+	{
+		if(fogVol.m_isBox)
+		{
+			*objects++ = Vec4(fogVol.m_aabbMin, 0.0f);
+			*objects++ = Vec4(fogVol.m_aabbMax, 0.0f);
+		}
+		else
+		{
+			*objects++ = Vec4(fogVol.m_sphereCenter, fogVol.m_sphereRadius);
+			*objects++ = Vec4(0.0f, 0.0f, 0.0f, 1.0f);
+		}
+	}
+
+	// Bind and dispatch
+	cmdb->bindShaderProgram(m_grProg);
+
+	struct Uniforms
+	{
+		Mat4 m_cameraTransform;
+		Vec4 m_unprojectionParams;
+		ClustererMagicValues m_clustererMagic;
+		Array<UVec4, 2> m_objectOffsets;
+	};
+	Uniforms* unis = allocateAndBindUniforms<Uniforms*>(sizeof(Uniforms), cmdb, 0, 0);
+	unis->m_cameraTransform = ctx.m_matrices.m_cameraTransform;
+	unis->m_unprojectionParams = ctx.m_unprojParams;
+	unis->m_clustererMagic = ctx.m_clusterBinOut.m_shaderMagicValues;
+	unis->m_objectOffsets[0] = UVec4(offsets[0], offsets[1], offsets[2], offsets[3]);
+	unis->m_objectOffsets[1] = UVec4(offsets[4], offsets[5], offsets[6], 0);
+
+	bindStorage(cmdb, 0, 1, objectsToken);
+	rgraphCtx.bindStorageBuffer(0, 2, m_runCtx.m_clustersBuffHandle);
+	rgraphCtx.bindStorageBuffer(0, 3, m_runCtx.m_indicesBuffHandle);
+
+	const U32 totalClusterCount = m_r->getClusterCount()[3];
+	cmdb->dispatchCompute((totalClusterCount + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+}
+
+} // end namespace anki
@@ -0,0 +1,68 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/renderer/RendererObject.h>
+#include <anki/Gr.h>
+#include <anki/resource/ShaderProgramResource.h>
+
+namespace anki
+{
+
+/// @addtogroup renderer
+/// @{
+
+/// Bins the lights, probes, decals and fog volumes to the clusters in compute. It's an alternative to the CPU binning
+/// of the ClusterBin that still writes the typed objects. The output is read by the passes exactly like the one of the
+/// ClusterBin but every cluster gets a fixed range of r_avgObjectsPerCluster indices.
+class GpuClusterBin : public RendererObject
+{
+public:
+	GpuClusterBin(Renderer* r)
+		: RendererObject(r)
+	{
+	}
+
+	~GpuClusterBin();
+
+	ANKI_USE_RESULT Error init(const ConfigSet& cfg);
+
+	/// Populate the rendergraph. It sets the ClusterBinOut::m_clustersToken and ClusterBinOut::m_indicesToken of the
+	/// context.
+	void populateRenderGraph(RenderingContext& ctx);
+
+	/// Set the dependencies of a pass that reads the clusters.
+	void setDependencies(RenderPassDescriptionBase& pass, BufferUsageBit usage) const
+	{
+		if(m_enabled)
+		{
+			pass.newDependency({m_runCtx.m_clustersBuffHandle, usage});
+			pass.newDependency({m_runCtx.m_indicesBuffHandle, usage});
+		}
+	}
+
+private:
+	static constexpr U32 WORKGROUP_SIZE = 64;
+
+	ShaderProgramResourcePtr m_prog;
+	ShaderProgramPtr m_grProg;
+	BufferPtr m_clustersBuff;
+	BufferPtr m_indicesBuff;
+	Bool m_enabled = false;
+
+	class
+	{
+	public:
+		const RenderingContext* m_ctx = nullptr;
+		RenderPassBufferHandle m_clustersBuffHandle;
+		RenderPassBufferHandle m_indicesBuffHandle;
+	} m_runCtx;
+
+	void run(RenderPassWorkContext& rgraphCtx);
+};
+/// @}
+
+} // end namespace anki
@@ -0,0 +1,130 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/renderer/GpuOcclusionCulling.h>
+#include <anki/renderer/Renderer.h>
+#include <anki/renderer/DepthDownscale.h>
+#include <anki/renderer/RenderQueue.h>
+#include <anki/core/ConfigSet.h>
+#include <anki/util/Tracer.h>
+
+namespace anki
+{
+
+GpuOcclusionCulling::~GpuOcclusionCulling()
+{
+}
+
+Error GpuOcclusionCulling::init(const ConfigSet& cfg)
+{
+	m_enabled = cfg.getBool("r_gpuOcclusionCulling");
+	if(!m_enabled)
+	{
+		return Error::NONE;
+	}
+
+	ANKI_R_LOGI("Initializing GPU occlusion culling");
+
+	ANKI_CHECK(getResourceManager().loadResource("shaders/GpuOcclusionCulling.ankiprog", m_prog));
+
+	ShaderProgramResourceVariantInitInfo variantInitInfo(m_prog);
+	variantInitInfo.addConstant("HIZ_SIZE", UVec2(m_r->getWidth() / 2, m_r->getHeight() / 2));
+	variantInitInfo.addConstant("HIZ_MIP_COUNT", m_r->getDepthDownscale().getMipmapCount());
+	const ShaderProgramResourceVariant* variant;
+	m_prog->getOrCreateVariant(variantInitInfo, variant);
+	m_grProg = variant->getProgram();
+
+	return Error::NONE;
+}
+
+void GpuOcclusionCulling::populateRenderGraph(RenderingContext& ctx)
+{
+	m_runCtx.m_enabled = false;
+
+	// The HiZ has nothing useful in the first frame
+	const U32 elementCount = ctx.m_renderQueue->m_renderables.getSize();
+	if(!m_enabled || elementCount == 0 || m_r->getFrameCount() == 0)
+	{
+		return;
+	}
+
+	ANKI_TRACE_SCOPED_EVENT(R_GPU_OCCLUSION_CULLING);
+
+	m_runCtx.m_ctx = &ctx;
+	m_runCtx.m_enabled = true;
+
+	// Grow the buffer if needed. The old one will be kept alive by the command buffers that use it
+	const PtrSize indirectBuffSize = elementCount * sizeof(DrawElementsIndirectInfo);
+	if(!m_indirectBuff || m_indirectBuff->getSize() < indirectBuffSize)
+	{
+		m_indirectBuff = getGrManager().newBuffer(
+			BufferInitInfo(nextPowerOfTwo(elementCount) * sizeof(DrawElementsIndirectInfo),
+				BufferUsageBit::INDIRECT_GRAPHICS | BufferUsageBit::STORAGE_COMPUTE_WRITE,
+				BufferMapAccessBit::NONE,
+				"GpuOcclusionCulling"));
+	}
+
+	// Write the bounds now. The args will be written by the RenderableDrawer when the G-buffer is recorded. That's
+	// still before the GPU will read them
+	Vec4* bounds = allocateStorage<Vec4*>(elementCount * 2 * sizeof(Vec4), m_runCtx.m_boundsToken);
+	for(const RenderableQueueElement& el : ctx.m_renderQueue->m_renderables)
+	{
+		*bounds++ = Vec4(el.m_aabbMin, 0.0f);
+		*bounds++ = Vec4(el.m_aabbMax, 0.0f);
+	}
+
+	m_runCtx.m_drawerInfo.m_firstElement = ctx.m_renderQueue->m_renderables.getBegin();
+	m_runCtx.m_drawerInfo.m_args = allocateStorage<DrawElementsIndirectInfo*>(indirectBuffSize, m_runCtx.m_argsToken);
+	m_runCtx.m_drawerInfo.m_buffer = m_indirectBuff;
+
+	// Create the pass
+	RenderGraphDescription& rgraph = ctx.m_renderGraphDescr;
+	m_runCtx.m_indirectBuffHandle = rgraph.importBuffer(m_indirectBuff, BufferUsageBit::NONE);
+
+	ComputeRenderPassDescription& pass = rgraph.newComputeRenderPass("GPU occlusion culling");
+
+	pass.setWork(
+		[](RenderPassWorkContext& rgraphCtx) {
+			GpuOcclusionCulling* const self = static_cast<GpuOcclusionCulling*>(rgraphCtx.m_userData);
+			self->run(rgraphCtx);
+		},
+		this,
+		0);
+
+	pass.newDependency({m_runCtx.m_indirectBuffHandle, BufferUsageBit::STORAGE_COMPUTE_WRITE});
+	pass.newDependency({m_r->getDepthDownscale().getHiZRt(), TextureUsageBit::SAMPLED_COMPUTE});
+}
+
+void GpuOcclusionCulling::run(RenderPassWorkContext& rgraphCtx)
+{
+	CommandBufferPtr& cmdb = rgraphCtx.m_commandBuffer;
+	const RenderingContext& ctx = *m_runCtx.m_ctx;
+	const U32 elementCount = ctx.m_renderQueue->m_renderables.getSize();
+
+	cmdb->bindShaderProgram(m_grProg);
+
+	// The HiZ holds the depth of the previous frame so test with the previous matrices
+	struct Uniforms
+	{
+		Mat4 m_prevViewProjMat;
+		UVec4 m_elementCount;
+	};
+	Uniforms* unis = allocateAndBindUniforms<Uniforms*>(sizeof(Uniforms), cmdb, 0, 0);
+	unis->m_prevViewProjMat = ctx.m_prevMatrices.m_viewProjectionJitter;
+	unis->m_elementCount = UVec4(elementCount);
+
+	bindStorage(cmdb, 0, 1, m_runCtx.m_boundsToken);
+	bindStorage(cmdb, 0, 2, m_runCtx.m_argsToken);
+	rgraphCtx.bindStorageBuffer(0, 3, m_runCtx.m_indirectBuffHandle);
+
+	cmdb->bindSampler(0, 4, m_r->getSamplers().m_nearestNearestClamp);
+	TextureSubresourceInfo hizSubresource;
+	hizSubresource.m_mipmapCount = m_r->getDepthDownscale().getMipmapCount();
+	rgraphCtx.bindTexture(0, 5, m_r->getDepthDownscale().getHiZRt(), hizSubresource);
+
+	cmdb->dispatchCompute((elementCount + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+}
+
+} // end namespace anki
@@ -0,0 +1,73 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/renderer/RendererObject.h>
+#include <anki/renderer/Drawer.h>
+#include <anki/Gr.h>
+#include <anki/resource/ShaderProgramResource.h>
+
+namespace anki
+{
+
+/// @addtogroup renderer
+/// @{
+
+/// Culls the drawcalls of the G-buffer against the HiZ of the previous frame. The G-buffer draws indirectly and a
+/// compute job zeroes the instance count of the drawcalls whose bounds are behind the previous frame's depth. It runs
+/// before the G-buffer and the DepthDownscale so the HiZ still holds the previous frame.
+class GpuOcclusionCulling : public RendererObject
+{
+public:
+	GpuOcclusionCulling(Renderer* r)
+		: RendererObject(r)
+	{
+	}
+
+	~GpuOcclusionCulling();
+
+	ANKI_USE_RESULT Error init(const ConfigSet& cfg);
+
+	/// Populate the rendergraph.
+	void populateRenderGraph(RenderingContext& ctx);
+
+	/// Get the info for the RenderableDrawer. It's nullptr if nothing is culled this frame.
+	const RenderableDrawerIndirectInfo* getDrawerIndirectInfo() const
+	{
+		return (m_runCtx.m_enabled) ? &m_runCtx.m_drawerInfo : nullptr;
+	}
+
+	/// Get it to set a dependency. Valid only if getDrawerIndirectInfo() is not nullptr.
+	RenderPassBufferHandle getIndirectArgsBuffer() const
+	{
+		ANKI_ASSERT(m_runCtx.m_enabled);
+		return m_runCtx.m_indirectBuffHandle;
+	}
+
+private:
+	static constexpr U32 WORKGROUP_SIZE = 64;
+
+	ShaderProgramResourcePtr m_prog;
+	ShaderProgramPtr m_grProg;
+	BufferPtr m_indirectBuff; ///< The args of the drawcalls after the culling. It grows when needed.
+	Bool m_enabled = false;
+
+	class
+	{
+	public:
+		const RenderingContext* m_ctx = nullptr;
+		Bool m_enabled = false;
+		RenderableDrawerIndirectInfo m_drawerInfo;
+		RenderPassBufferHandle m_indirectBuffHandle;
+		StagingGpuMemoryToken m_boundsToken;
+		StagingGpuMemoryToken m_argsToken;
+	} m_runCtx;
+
+	void run(RenderPassWorkContext& rgraphCtx);
+};
+/// @}
+
+} // end namespace anki
@@ -0,0 +1,128 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/renderer/GpuSkinning.h>
+#include <anki/renderer/Renderer.h>
+#include <anki/renderer/RenderQueue.h>
+#include <anki/resource/AnimationResource.h>
+#include <anki/core/ConfigSet.h>
+#include <anki/util/Tracer.h>
+
+namespace anki
+{
+
+GpuSkinning::~GpuSkinning()
+{
+}
+
+Error GpuSkinning::init(const ConfigSet& cfg)
+{
+	m_enabled = cfg.getBool("r_gpuSkinning");
+	if(!m_enabled)
+	{
+		return Error::NONE;
+	}
+
+	ANKI_R_LOGI("Initializing GPU skinning");
+
+	ANKI_CHECK(getResourceManager().loadResource("shaders/GpuSkinning.ankiprog", m_prog));
+
+	const ShaderProgramResourceVariant* variant;
+	m_prog->getOrCreateVariant(variant);
+	m_grProg = variant->getProgram();
+
+	return Error::NONE;
+}
+
+void GpuSkinning::populateRenderGraph(RenderingContext& ctx)
+{
+	m_runCtx.m_enabled = false;
+
+	if(!m_enabled || ctx.m_renderQueue->m_gpuSkinningJobs.getSize() == 0)
+	{
+		return;
+	}
+
+	ANKI_TRACE_SCOPED_EVENT(R_GPU_SKINNING);
+
+	m_runCtx.m_ctx = &ctx;
+	m_runCtx.m_enabled = true;
+
+	// Allocate the bone transforms now. The passes that draw the skins may be recorded before this one
+	for(const GpuSkinningQueueElement& job : ctx.m_renderQueue->m_gpuSkinningJobs)
+	{
+		ANKI_ASSERT(job.m_boneCount > 0 && job.m_boneTransformsToken);
+		allocateStorage<void*>(job.m_boneCount * sizeof(Mat4), *job.m_boneTransformsToken);
+	}
+
+	// All the jobs write to the same staging buffer
+	RenderGraphDescription& rgraph = ctx.m_renderGraphDescr;
+	m_runCtx.m_boneTransformsHandle = rgraph.importBuffer(
+		ctx.m_renderQueue->m_gpuSkinningJobs[0].m_boneTransformsToken->m_buffer, BufferUsageBit::NONE);
+
+	// Create the pass
+	ComputeRenderPassDescription& pass = rgraph.newComputeRenderPass("GPU skinning");
+
+	pass.setWork(
+		[](RenderPassWorkContext& rgraphCtx) {
+			GpuSkinning* const self = static_cast<GpuSkinning*>(rgraphCtx.m_userData);
+			self->run(rgraphCtx);
+		},
+		this,
+		0);
+
+	pass.newDependency({m_runCtx.m_boneTransformsHandle, BufferUsageBit::STORAGE_COMPUTE_WRITE});
+}
+
+void GpuSkinning::run(RenderPassWorkContext& rgraphCtx)
+{
+	CommandBufferPtr& cmdb = rgraphCtx.m_commandBuffer;
+
+	cmdb->bindShaderProgram(m_grProg);
+
+	struct Uniforms
+	{
+		F32 m_time;
+		U32 m_boneCount;
+		U32 m_animated;
+		U32 m_padding0;
+	};
+
+	for(const GpuSkinningQueueElement& job : m_runCtx.m_ctx->m_renderQueue->m_gpuSkinningJobs)
+	{
+		const AnimationGpuKeyframes* keyframes = job.m_keyframes;
+
+		Uniforms* unis = allocateAndBindUniforms<Uniforms*>(sizeof(Uniforms), cmdb, 0, 0);
+		unis->m_time = job.m_animationTime;
+		unis->m_boneCount = job.m_boneCount;
+		unis->m_animated = keyframes != nullptr;
+
+		BufferPtr bones(const_cast<Buffer*>(job.m_bonesBuffer));
+		cmdb->bindStorageBuffer(0, 1, bones, 0, MAX_PTR_SIZE);
+
+		U32* boneChannels = allocateAndBindStorage<U32*>(job.m_boneCount * sizeof(U32), cmdb, 0, 2);
+		memcpy(boneChannels, job.m_boneChannels, job.m_boneCount * sizeof(U32));
+
+		if(keyframes)
+		{
+			cmdb->bindStorageBuffer(0, 3, keyframes->m_buffer, keyframes->m_channelsOffset, keyframes->m_channelsRange);
+			cmdb->bindStorageBuffer(0, 4, keyframes->m_buffer, keyframes->m_timesOffset, keyframes->m_timesRange);
+			cmdb->bindStorageBuffer(0, 5, keyframes->m_buffer, keyframes->m_valuesOffset, keyframes->m_valuesRange);
+		}
+		else
+		{
+			// Not read but they have to be bound
+			cmdb->bindStorageBuffer(0, 3, bones, 0, MAX_PTR_SIZE);
+			cmdb->bindStorageBuffer(0, 4, bones, 0, MAX_PTR_SIZE);
+			cmdb->bindStorageBuffer(0, 5, bones, 0, MAX_PTR_SIZE);
+		}
+
+		bindStorage(cmdb, 0, 6, *job.m_boneTransformsToken);
+
+		cmdb->dispatchCompute((job.m_boneCount + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+	}
+}
+
+} // end namespace anki
@@ -0,0 +1,63 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/renderer/RendererObject.h>
+#include <anki/Gr.h>
+#include <anki/resource/ShaderProgramResource.h>
+
+namespace anki
+{
+
+/// @addtogroup renderer
+/// @{
+
+/// Evaluates the animations of the skins in compute. The bone transforms are written in the staging storage memory
+/// and the vertex shaders of all the passes that draw the skins read them. It runs before everything else.
+class GpuSkinning : public RendererObject
+{
+public:
+	GpuSkinning(Renderer* r)
+		: RendererObject(r)
+	{
+	}
+
+	~GpuSkinning();
+
+	ANKI_USE_RESULT Error init(const ConfigSet& cfg);
+
+	/// Populate the rendergraph.
+	void populateRenderGraph(RenderingContext& ctx);
+
+	/// Set the dependency of a pass that draws the skins.
+	void setDependencies(RenderPassDescriptionBase& pass) const
+	{
+		if(m_runCtx.m_enabled)
+		{
+			pass.newDependency({m_runCtx.m_boneTransformsHandle, BufferUsageBit::STORAGE_VERTEX_READ});
+		}
+	}
+
+private:
+	static constexpr U32 WORKGROUP_SIZE = 64;
+
+	ShaderProgramResourcePtr m_prog;
+	ShaderProgramPtr m_grProg;
+	Bool m_enabled = false;
+
+	class
+	{
+	public:
+		const RenderingContext* m_ctx = nullptr;
+		Bool m_enabled = false;
+		RenderPassBufferHandle m_boneTransformsHandle;
+	} m_runCtx;
+
+	void run(RenderPassWorkContext& rgraphCtx);
+};
+/// @}
+
+} // end namespace anki
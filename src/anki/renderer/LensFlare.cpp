@@ -9,6 +9,7 @@
 #include <anki/renderer/Renderer.h>
 #include <anki/core/ConfigSet.h>
 #include <anki/util/Functions.h>
+#include <algorithm>
 #include <shaders/glsl_cpp_common/LensFlareSprite.h>
 
 namespace anki
@@ -34,7 +35,7 @@ Error LensFlare::init(const ConfigSet& config)
 Error LensFlare::initInternal(const ConfigSet& config)
 {
 	ANKI_CHECK(initSprite(config));
-	ANKI_CHECK(initOcclusion(config));
+	ANKI_CHECK(initVisibility(config));
 
 	return Error::NONE;
 }
@@ -61,48 +62,53 @@ Error LensFlare::initSprite(const ConfigSet& config)
 	return Error::NONE;
 }
 
-Error LensFlare::initOcclusion(const ConfigSet& config)
+Error LensFlare::initVisibility(const ConfigSet& config)
 {
 	GrManager& gr = getGrManager();
 
-	m_indirectBuff = gr.newBuffer(BufferInitInfo(m_maxFlares * sizeof(DrawArraysIndirectInfo),
-		BufferUsageBit::INDIRECT_GRAPHICS | BufferUsageBit::STORAGE_COMPUTE_WRITE,
+	m_spritesBuff = gr.newBuffer(BufferInitInfo(m_maxFlares * sizeof(LensFlareSprite),
+		BufferUsageBit::STORAGE_VERTEX_READ | BufferUsageBit::STORAGE_COMPUTE_WRITE,
 		BufferMapAccessBit::NONE,
 		"LensFlares"));
 
-	ANKI_CHECK(
-		getResourceManager().loadResource("shaders/LensFlareUpdateIndirectInfo.ankiprog", m_updateIndirectBuffProg));
+	ANKI_CHECK(getResourceManager().loadResource("shaders/LensFlareVisibility.ankiprog", m_visibilityProg));
 
-	ShaderProgramResourceVariantInitInfo variantInitInfo(m_updateIndirectBuffProg);
+	ShaderProgramResourceVariantInitInfo variantInitInfo(m_visibilityProg);
 	variantInitInfo.addConstant("IN_DEPTH_MAP_SIZE", UVec2(m_r->getWidth() / 2 / 2, m_r->getHeight() / 2 / 2));
 	const ShaderProgramResourceVariant* variant;
-	m_updateIndirectBuffProg->getOrCreateVariant(variantInitInfo, variant);
-	m_updateIndirectBuffGrProg = variant->getProgram();
+	m_visibilityProg->getOrCreateVariant(variantInitInfo, variant);
+	m_visibilityGrProg = variant->getProgram();
 
 	return Error::NONE;
 }
 
-void LensFlare::updateIndirectInfo(const RenderingContext& ctx, RenderPassWorkContext& rgraphCtx)
+void LensFlare::runVisibility(const RenderingContext& ctx, RenderPassWorkContext& rgraphCtx)
 {
 	CommandBufferPtr& cmdb = rgraphCtx.m_commandBuffer;
-	U32 count = min<U32>(ctx.m_renderQueue->m_lensFlares.getSize(), m_maxFlares);
+	const U32 count = m_runCtx.m_sortedFlares.getSize();
 	ANKI_ASSERT(count > 0);
 
-	cmdb->bindShaderProgram(m_updateIndirectBuffGrProg);
+	cmdb->bindShaderProgram(m_visibilityGrProg);
 
 	// Write flare info
-	Vec4* flarePositions = allocateAndBindStorage<Vec4*>(sizeof(Mat4) + count * sizeof(Vec4), cmdb, 0, 0);
-	*reinterpret_cast<Mat4*>(flarePositions) = ctx.m_matrices.m_viewProjectionJitter;
-	flarePositions += 4;
-
+	const PtrSize size = sizeof(Mat4) + sizeof(Vec4) + count * sizeof(LensFlareVisibilityIn);
+	U8* mem = allocateAndBindStorage<U8*>(size, cmdb, 0, 0);
+	*reinterpret_cast<Mat4*>(mem) = ctx.m_matrices.m_viewProjectionJitter;
+	mem += sizeof(Mat4);
+	*reinterpret_cast<Vec4*>(mem) = Vec4(m_r->getAspectRatio(), 0.0f, 0.0f, 0.0f);
+	mem += sizeof(Vec4);
+
+	WeakArray<LensFlareVisibilityIn> flares(reinterpret_cast<LensFlareVisibilityIn*>(mem), count);
 	for(U32 i = 0; i < count; ++i)
 	{
-		*flarePositions = Vec4(ctx.m_renderQueue->m_lensFlares[i].m_worldPosition, 1.0f);
-		++flarePositions;
+		const LensFlareQueueElement& flareEl = ctx.m_renderQueue->m_lensFlares[m_runCtx.m_sortedFlares[i]];
+		flares[i].m_worldPosition = Vec4(flareEl.m_worldPosition, 1.0f);
+		flares[i].m_colorMultiplier = flareEl.m_colorMultiplier;
+		flares[i].m_firstFlareSizePad2 = Vec4(flareEl.m_firstFlareSize, 0.0f, 0.0f);
 	}
 
-	rgraphCtx.bindStorageBuffer(0, 1, m_runCtx.m_indirectBuffHandle);
-	// Bind neareset because you don't need high quality
+	rgraphCtx.bindStorageBuffer(0, 1, m_runCtx.m_spritesBuffHandle);
+	// Bind nearest because you don't need high quality
 	cmdb->bindSampler(0, 2, m_r->getSamplers().m_nearestNearestClamp);
 	rgraphCtx.bindTexture(0, 3, m_r->getDepthDownscale().getHiZRt(), HIZ_QUARTER_DEPTH);
 	cmdb->dispatchCompute(count, 1, 1);
@@ -118,22 +124,37 @@ void LensFlare::populateRenderGraph(RenderingContext& ctx)
 	m_runCtx.m_ctx = &ctx;
 	RenderGraphDescription& rgraph = ctx.m_renderGraphDescr;
 
+	// Sort the flares by texture to draw the ones that share a texture with one drawcall
+	const U32 count = min<U32>(ctx.m_renderQueue->m_lensFlares.getSize(), m_maxFlares);
+	m_runCtx.m_sortedFlares = WeakArray<U32>(ctx.m_tempAllocator.newArray<U32>(count), count);
+	for(U32 i = 0; i < count; ++i)
+	{
+		m_runCtx.m_sortedFlares[i] = i;
+	}
+
+	const LensFlareQueueElement* flareEls = ctx.m_renderQueue->m_lensFlares.getBegin();
+	std::sort(m_runCtx.m_sortedFlares.getBegin(), m_runCtx.m_sortedFlares.getEnd(), [flareEls](U32 a, U32 b) {
+		return (flareEls[a].m_textureView != flareEls[b].m_textureView)
+				   ? flareEls[a].m_textureView < flareEls[b].m_textureView
+				   : a < b;
+	});
+
 	// Import buffer
-	m_runCtx.m_indirectBuffHandle = rgraph.importBuffer(m_indirectBuff, BufferUsageBit::NONE);
+	m_runCtx.m_spritesBuffHandle = rgraph.importBuffer(m_spritesBuff, BufferUsageBit::NONE);
 
-	// Update the indirect buffer
+	// Test the visibility of all flares and write their sprites
 	{
-		ComputeRenderPassDescription& rpass = rgraph.newComputeRenderPass("LF Upd Ind/ct");
+		ComputeRenderPassDescription& rpass = rgraph.newComputeRenderPass("LF Visibility");
 
 		rpass.setWork(
 			[](RenderPassWorkContext& rgraphCtx) {
 				LensFlare* const self = static_cast<LensFlare*>(rgraphCtx.m_userData);
-				self->updateIndirectInfo(*self->m_runCtx.m_ctx, rgraphCtx);
+				self->runVisibility(*self->m_runCtx.m_ctx, rgraphCtx);
 			},
 			this,
 			0);
 
-		rpass.newDependency({m_runCtx.m_indirectBuffHandle, BufferUsageBit::STORAGE_COMPUTE_WRITE});
+		rpass.newDependency({m_runCtx.m_spritesBuffHandle, BufferUsageBit::STORAGE_COMPUTE_WRITE});
 		rpass.newDependency({m_r->getDepthDownscale().getHiZRt(), TextureUsageBit::SAMPLED_COMPUTE, HIZ_QUARTER_DEPTH});
 	}
 }
@@ -145,54 +166,32 @@ void LensFlare::runDrawFlares(const RenderingContext& ctx, CommandBufferPtr& cmd
 		return;
 	}
 
-	const U32 count = min<U32>(ctx.m_renderQueue->m_lensFlares.getSize(), m_maxFlares);
+	const U32 count = m_runCtx.m_sortedFlares.getSize();
 
 	cmdb->bindShaderProgram(m_realGrProg);
 	cmdb->setBlendFactors(0, BlendFactor::SRC_ALPHA, BlendFactor::ONE_MINUS_SRC_ALPHA);
 	cmdb->setDepthWrite(false);
 
-	for(U32 i = 0; i < count; ++i)
-	{
-		const LensFlareQueueElement& flareEl = ctx.m_renderQueue->m_lensFlares[i];
+	cmdb->bindStorageBuffer(0, 0, m_spritesBuff, 0, MAX_PTR_SIZE);
+	cmdb->bindSampler(0, 1, m_r->getSamplers().m_trilinearRepeat);
 
-		// Compute position
-		Vec4 lfPos = Vec4(flareEl.m_worldPosition, 1.0);
-		Vec4 posClip = ctx.m_renderQueue->m_viewProjectionMatrix * lfPos;
+	// One drawcall for every run of flares with the same texture. The occluded flares have zero sized sprites
+	U32 first = 0;
+	while(first < count)
+	{
+		const TextureView* texView = ctx.m_renderQueue->m_lensFlares[m_runCtx.m_sortedFlares[first]].m_textureView;
+		ANKI_ASSERT(texView);
 
-		/*if(posClip.x() > posClip.w() || posClip.x() < -posClip.w() || posClip.y() > posClip.w()
-			|| posClip.y() < -posClip.w())
+		U32 end = first + 1;
+		while(end < count && ctx.m_renderQueue->m_lensFlares[m_runCtx.m_sortedFlares[end]].m_textureView == texView)
 		{
-			// Outside clip
-			ANKI_ASSERT(0 && "Check that before");
-		}*/
-
-		U32 c = 0;
-		U32 spritesCount = max<U32>(1, m_maxSpritesPerFlare);
-
-		// Get uniform memory
-		LensFlareSprite* tmpSprites =
-			allocateAndBindStorage<LensFlareSprite*>(spritesCount * sizeof(LensFlareSprite), cmdb, 0, 0);
-		WeakArray<LensFlareSprite> sprites(tmpSprites, spritesCount);
-
-		// misc
-		Vec2 posNdc = posClip.xy() / posClip.w();
-
-		// First flare
-		sprites[c].m_posScale = Vec4(posNdc, flareEl.m_firstFlareSize * Vec2(1.0f, m_r->getAspectRatio()));
-		sprites[c].m_depthPad3 = Vec4(0.0f);
-		const F32 alpha = flareEl.m_colorMultiplier.w() * (1.0f - pow(absolute(posNdc.x()), 6.0f))
-						  * (1.0f - pow(absolute(posNdc.y()), 6.0f)); // Fade the flare on the edges
-		sprites[c].m_color = Vec4(flareEl.m_colorMultiplier.xyz(), alpha);
-		++c;
-
-		// Render
-		ANKI_ASSERT(flareEl.m_textureView);
-		cmdb->bindSampler(0, 1, m_r->getSamplers().m_trilinearRepeat);
-		cmdb->bindTexture(
-			0, 2, TextureViewPtr(const_cast<TextureView*>(flareEl.m_textureView)), TextureUsageBit::SAMPLED_FRAGMENT);
-
-		cmdb->drawArraysIndirect(
-			PrimitiveTopology::TRIANGLE_STRIP, 1, i * sizeof(DrawArraysIndirectInfo), m_indirectBuff);
+			++end;
+		}
+
+		cmdb->bindTexture(0, 2, TextureViewPtr(const_cast<TextureView*>(texView)), TextureUsageBit::SAMPLED_FRAGMENT);
+		cmdb->drawArrays(PrimitiveTopology::TRIANGLE_STRIP, 4, end - first, 0, first);
+
+		first = end;
 	}
 
 	// Restore state
@@ -33,16 +33,16 @@ public:
 	void populateRenderGraph(RenderingContext& ctx);
 
 	/// Get it to set a dependency.
-	RenderPassBufferHandle getIndirectDrawBuffer() const
+	RenderPassBufferHandle getSpritesBuffer() const
 	{
-		return m_runCtx.m_indirectBuffHandle;
+		return m_runCtx.m_spritesBuffHandle;
 	}
 
 private:
-	// Occlusion test
-	BufferPtr m_indirectBuff;
-	ShaderProgramResourcePtr m_updateIndirectBuffProg;
-	ShaderProgramPtr m_updateIndirectBuffGrProg;
+	// Visibility test
+	BufferPtr m_spritesBuff;
+	ShaderProgramResourcePtr m_visibilityProg;
+	ShaderProgramPtr m_visibilityGrProg;
 
 	// Sprite billboards
 	ShaderProgramResourcePtr m_realProg;
@@ -55,15 +55,16 @@ private:
 	{
 	public:
 		RenderingContext* m_ctx = nullptr;
-		RenderPassBufferHandle m_indirectBuffHandle;
+		RenderPassBufferHandle m_spritesBuffHandle;
+		WeakArray<U32> m_sortedFlares; ///< The flares sorted by texture. The sprites are in the same order.
 	} m_runCtx;
 
 	ANKI_USE_RESULT Error initSprite(const ConfigSet& config);
-	ANKI_USE_RESULT Error initOcclusion(const ConfigSet& config);
+	ANKI_USE_RESULT Error initVisibility(const ConfigSet& config);
 
 	ANKI_USE_RESULT Error initInternal(const ConfigSet& initializer);
 
-	void updateIndirectInfo(const RenderingContext& ctx, RenderPassWorkContext& rgraphCtx);
+	void runVisibility(const RenderingContext& ctx, RenderPassWorkContext& rgraphCtx);
 };
 /// @}
 
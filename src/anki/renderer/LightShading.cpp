@@ -15,6 +15,8 @@
 #include <anki/renderer/Ssao.h>
 #include <anki/renderer/Ssr.h>
 #include <anki/renderer/GlobalIllumination.h>
+#include <anki/renderer/GpuClusterBin.h>
+#include <anki/renderer/VrsSriGeneration.h>
 #include <anki/core/ConfigSet.h>
 #include <anki/util/HighRezTimer.h>
 
@@ -40,6 +42,11 @@ Error LightShading::init(const ConfigSet& config)
 		err = initApplyFog(config);
 	}
 
+	if(!err)
+	{
+		err = initTileClassification(config);
+	}
+
 	if(err)
 	{
 		ANKI_R_LOGE("Failed to init light stage");
@@ -59,6 +66,10 @@ Error LightShading::initLightShading(const ConfigSet& config)
 	variantInitInfo.addConstant("CLUSTER_COUNT_Z", U32(m_r->getClusterCount()[2]));
 	variantInitInfo.addConstant("CLUSTER_COUNT", U32(m_r->getClusterCount()[3]));
 	variantInitInfo.addConstant("IR_MIPMAP_COUNT", U32(m_r->getProbeReflections().getReflectionTextureMipmapCount()));
+	variantInitInfo.addMutation("TILED", 0);
+	variantInitInfo.addMutation("POINT_LIGHTS", 1);
+	variantInitInfo.addMutation("SPOT_LIGHTS", 1);
+	variantInitInfo.addMutation("SHADOWS", 1);
 
 	const ShaderProgramResourceVariant* variant;
 	m_lightShading.m_prog->getOrCreateVariant(variantInitInfo, variant);
@@ -75,6 +86,16 @@ Error LightShading::initLightShading(const ConfigSet& config)
 	m_lightShading.m_fbDescr.m_depthStencilAttachment.m_loadOperation = AttachmentLoadOperation::LOAD;
 	m_lightShading.m_fbDescr.m_depthStencilAttachment.m_stencilLoadOperation = AttachmentLoadOperation::DONT_CARE;
 	m_lightShading.m_fbDescr.m_depthStencilAttachment.m_aspect = DepthStencilAspectBit::DEPTH;
+
+	const U32 sriTexelSize = m_r->getVrsSriGeneration().getSriTexelSize();
+	if(sriTexelSize)
+	{
+		m_lightShading.m_vrsFbDescr = m_lightShading.m_fbDescr;
+		m_lightShading.m_vrsFbDescr.m_shadingRateAttachmentTexelWidth = sriTexelSize;
+		m_lightShading.m_vrsFbDescr.m_shadingRateAttachmentTexelHeight = sriTexelSize;
+		m_lightShading.m_vrsFbDescr.bake();
+	}
+
 	m_lightShading.m_fbDescr.bake();
 
 	return Error::NONE;
@@ -95,6 +116,114 @@ Error LightShading::initApplyFog(const ConfigSet& config)
 	return Error::NONE;
 }
 
+Error LightShading::initTileClassification(const ConfigSet& config)
+{
+	m_tileClassification.m_enabled = config.getBool("r_lightShadingTileClassification");
+	if(!m_tileClassification.m_enabled)
+	{
+		return Error::NONE;
+	}
+
+	ANKI_R_LOGI("Initializing light shading tile classification");
+
+	const U32 tileCount = m_r->getClusterCount()[0] * m_r->getClusterCount()[1];
+
+	// Classification progs
+	ANKI_CHECK(getResourceManager().loadResource(
+		"shaders/LightShadingTileClassification.ankiprog", m_tileClassification.m_prog));
+
+	ShaderProgramResourceVariantInitInfo variantInitInfo(m_tileClassification.m_prog);
+	variantInitInfo.addConstant("CLUSTER_COUNT_X", U32(m_r->getClusterCount()[0]));
+	variantInitInfo.addConstant("CLUSTER_COUNT_Y", U32(m_r->getClusterCount()[1]));
+	variantInitInfo.addConstant("CLUSTER_COUNT_Z", U32(m_r->getClusterCount()[2]));
+	variantInitInfo.addConstant("FB_SIZE", UVec2(m_r->getWidth(), m_r->getHeight()));
+
+	const ShaderProgramResourceVariant* variant;
+	variantInitInfo.addMutation("PASS", 0);
+	m_tileClassification.m_prog->getOrCreateVariant(variantInitInfo, variant);
+	m_tileClassification.m_classifyGrProg = variant->getProgram();
+
+	variantInitInfo.addMutation("PASS", 1);
+	m_tileClassification.m_prog->getOrCreateVariant(variantInitInfo, variant);
+	m_tileClassification.m_compactGrProg = variant->getProgram();
+
+	// Light shading progs, one for every combination of light types
+	for(U32 i = 0; i < TILE_VARIANT_COUNT; ++i)
+	{
+		ShaderProgramResourceVariantInitInfo lightVariantInitInfo(m_lightShading.m_prog);
+		lightVariantInitInfo.addConstant("CLUSTER_COUNT_X", U32(m_r->getClusterCount()[0]));
+		lightVariantInitInfo.addConstant("CLUSTER_COUNT_Y", U32(m_r->getClusterCount()[1]));
+		lightVariantInitInfo.addConstant("CLUSTER_COUNT_Z", U32(m_r->getClusterCount()[2]));
+		lightVariantInitInfo.addConstant("CLUSTER_COUNT", U32(m_r->getClusterCount()[3]));
+		lightVariantInitInfo.addConstant(
+			"IR_MIPMAP_COUNT", U32(m_r->getProbeReflections().getReflectionTextureMipmapCount()));
+		lightVariantInitInfo.addMutation("TILED", 1);
+		lightVariantInitInfo.addMutation("POINT_LIGHTS", (i & TILE_POINT_LIGHTS_BIT) != 0);
+		lightVariantInitInfo.addMutation("SPOT_LIGHTS", (i & TILE_SPOT_LIGHTS_BIT) != 0);
+		lightVariantInitInfo.addMutation("SHADOWS", (i & TILE_SHADOWS_BIT) != 0);
+
+		m_lightShading.m_prog->getOrCreateVariant(lightVariantInitInfo, variant);
+		m_tileClassification.m_lightShadingGrProgs[i] = variant->getProgram();
+	}
+
+	// Buffers
+	m_tileClassification.m_tileVariantsBuff = getGrManager().newBuffer(BufferInitInfo(tileCount * sizeof(U32),
+		BufferUsageBit::STORAGE_COMPUTE_READ_WRITE,
+		BufferMapAccessBit::NONE,
+		"LightShadingTileVariants"));
+
+	m_tileClassification.m_tilesBuff =
+		getGrManager().newBuffer(BufferInitInfo(TILE_VARIANT_COUNT * tileCount * sizeof(U32),
+			BufferUsageBit::STORAGE_COMPUTE_WRITE | BufferUsageBit::STORAGE_VERTEX_READ,
+			BufferMapAccessBit::NONE,
+			"LightShadingTiles"));
+
+	m_tileClassification.m_argsBuff =
+		getGrManager().newBuffer(BufferInitInfo(TILE_VARIANT_COUNT * sizeof(DrawArraysIndirectInfo),
+			BufferUsageBit::STORAGE_COMPUTE_WRITE | BufferUsageBit::INDIRECT_GRAPHICS,
+			BufferMapAccessBit::NONE,
+			"LightShadingTileArgs"));
+
+	return Error::NONE;
+}
+
+void LightShading::runTileClassification(RenderPassWorkContext& rgraphCtx)
+{
+	const RenderingContext& ctx = *m_runCtx.m_ctx;
+	CommandBufferPtr& cmdb = rgraphCtx.m_commandBuffer;
+	const ClusterBinOut& rsrc = ctx.m_clusterBinOut;
+
+	cmdb->bindShaderProgram(m_tileClassification.m_classifyGrProg);
+
+	bindUniforms(cmdb, 0, 0, ctx.m_lightShadingUniformsToken);
+	bindUniforms(cmdb, 0, 1, rsrc.m_pointLightsToken);
+	bindUniforms(cmdb, 0, 2, rsrc.m_spotLightsToken);
+	bindStorage(cmdb, 0, 3, rsrc.m_clustersToken);
+	bindStorage(cmdb, 0, 4, rsrc.m_indicesToken);
+
+	cmdb->bindSampler(0, 5, m_r->getSamplers().m_nearestNearestClamp);
+	rgraphCtx.bindTexture(0, 6, m_r->getGBuffer().getDepthRt(), TextureSubresourceInfo(DepthStencilAspectBit::DEPTH));
+
+	rgraphCtx.bindStorageBuffer(0, 7, m_runCtx.m_tileVariantsBuffHandle);
+
+	// One workgroup per tile
+	cmdb->dispatchCompute(m_r->getClusterCount()[0], m_r->getClusterCount()[1], 1);
+}
+
+void LightShading::runTileCompaction(RenderPassWorkContext& rgraphCtx)
+{
+	CommandBufferPtr& cmdb = rgraphCtx.m_commandBuffer;
+
+	cmdb->bindShaderProgram(m_tileClassification.m_compactGrProg);
+
+	rgraphCtx.bindStorageBuffer(0, 0, m_runCtx.m_tileVariantsBuffHandle);
+	rgraphCtx.bindStorageBuffer(0, 1, m_runCtx.m_argsBuffHandle);
+	rgraphCtx.bindStorageBuffer(0, 2, m_runCtx.m_tilesBuffHandle);
+
+	// A single workgroup gathers all the tiles
+	cmdb->dispatchCompute(1, 1, 1);
+}
+
 void LightShading::run(RenderPassWorkContext& rgraphCtx)
 {
 	const RenderingContext& ctx = *m_runCtx.m_ctx;
@@ -137,7 +266,23 @@ void LightShading::run(RenderPassWorkContext& rgraphCtx)
 		rgraphCtx.bindColorTexture(0, 18, m_r->getSsao().getRt());
 
 		// Draw
-		drawQuad(cmdb);
+		if(m_tileClassification.m_enabled)
+		{
+			rgraphCtx.bindStorageBuffer(0, 19, m_runCtx.m_tilesBuffHandle);
+
+			for(U32 i = 0; i < TILE_VARIANT_COUNT; ++i)
+			{
+				cmdb->bindShaderProgram(m_tileClassification.m_lightShadingGrProgs[i]);
+				cmdb->drawArraysIndirect(PrimitiveTopology::TRIANGLE_STRIP,
+					1,
+					i * sizeof(DrawArraysIndirectInfo),
+					m_tileClassification.m_argsBuff);
+			}
+		}
+		else
+		{
+			drawQuad(cmdb);
+		}
 	}
 
 	// Do the fog apply
@@ -184,14 +329,50 @@ void LightShading::populateRenderGraph(RenderingContext& ctx)
 	// Create RT
 	m_runCtx.m_rt = rgraph.newRenderTarget(m_lightShading.m_rtDescr);
 
+	// Classify the tiles
+	if(m_tileClassification.m_enabled)
+	{
+		m_runCtx.m_tileVariantsBuffHandle =
+			rgraph.importBuffer(m_tileClassification.m_tileVariantsBuff, BufferUsageBit::NONE);
+		m_runCtx.m_tilesBuffHandle = rgraph.importBuffer(m_tileClassification.m_tilesBuff, BufferUsageBit::NONE);
+		m_runCtx.m_argsBuffHandle = rgraph.importBuffer(m_tileClassification.m_argsBuff, BufferUsageBit::NONE);
+
+		ComputeRenderPassDescription& classifyPass = rgraph.newComputeRenderPass("Light tile classif.");
+		classifyPass.setWork(
+			[](RenderPassWorkContext& rgraphCtx) {
+				static_cast<LightShading*>(rgraphCtx.m_userData)->runTileClassification(rgraphCtx);
+			},
+			this,
+			0);
+		classifyPass.newDependency({m_r->getGBuffer().getDepthRt(),
+			TextureUsageBit::SAMPLED_COMPUTE,
+			TextureSubresourceInfo(DepthStencilAspectBit::DEPTH)});
+		m_r->getGpuClusterBin().setDependencies(classifyPass, BufferUsageBit::STORAGE_COMPUTE_READ);
+		classifyPass.newDependency({m_runCtx.m_tileVariantsBuffHandle, BufferUsageBit::STORAGE_COMPUTE_WRITE});
+
+		ComputeRenderPassDescription& compactPass = rgraph.newComputeRenderPass("Light tile compact");
+		compactPass.setWork(
+			[](RenderPassWorkContext& rgraphCtx) {
+				static_cast<LightShading*>(rgraphCtx.m_userData)->runTileCompaction(rgraphCtx);
+			},
+			this,
+			0);
+		compactPass.newDependency({m_runCtx.m_tileVariantsBuffHandle, BufferUsageBit::STORAGE_COMPUTE_READ});
+		compactPass.newDependency({m_runCtx.m_tilesBuffHandle, BufferUsageBit::STORAGE_COMPUTE_WRITE});
+		compactPass.newDependency({m_runCtx.m_argsBuffHandle, BufferUsageBit::STORAGE_COMPUTE_WRITE});
+	}
+
 	// Create pass
 	GraphicsRenderPassDescription& pass = rgraph.newGraphicsRenderPass("Light&FW Shad.");
 
-	pass.setWork(
+	pass.setParallelWork(
 		[](RenderPassWorkContext& rgraphCtx) { static_cast<LightShading*>(rgraphCtx.m_userData)->run(rgraphCtx); },
 		this,
-		computeNumberOfSecondLevelCommandBuffers(ctx.m_renderQueue->m_forwardShadingRenderables.getSize()));
-	pass.setFramebufferInfo(m_lightShading.m_fbDescr, {{m_runCtx.m_rt}}, {m_r->getGBuffer().getDepthRt()});
+		ctx.m_renderQueue->m_forwardShadingRenderables.getSize());
+	const Bool vrs = m_r->getVrsSriGeneration().getSriAvailable();
+	pass.setFramebufferInfo((vrs) ? m_lightShading.m_vrsFbDescr : m_lightShading.m_fbDescr,
+		{{m_runCtx.m_rt}},
+		{m_r->getGBuffer().getDepthRt()});
 
 	// Light shading
 	pass.newDependency({m_runCtx.m_rt, TextureUsageBit::FRAMEBUFFER_ATTACHMENT_WRITE});
@@ -213,8 +394,24 @@ void LightShading::populateRenderGraph(RenderingContext& ctx)
 	// Fog
 	pass.newDependency({m_r->getVolumetricFog().getRt(), TextureUsageBit::SAMPLED_FRAGMENT});
 
+	// Clusters
+	m_r->getGpuClusterBin().setDependencies(pass, BufferUsageBit::STORAGE_FRAGMENT_READ);
+
+	// Tiles
+	if(m_tileClassification.m_enabled)
+	{
+		pass.newDependency({m_runCtx.m_tilesBuffHandle, BufferUsageBit::STORAGE_VERTEX_READ});
+		pass.newDependency({m_runCtx.m_argsBuffHandle, BufferUsageBit::INDIRECT_GRAPHICS});
+	}
+
 	// For forward shading
 	m_r->getForwardShading().setDependencies(ctx, pass);
+
+	// Shading rate of the light shading and the forward shading
+	if(vrs)
+	{
+		m_r->getVrsSriGeneration().setDependencies(pass);
+	}
 }
 
 } // end namespace anki
@@ -32,11 +32,18 @@ public:
 	}
 
 private:
+	/// The variants of the tiled light shading. Keep it in sync with the shaders.
+	static constexpr U32 TILE_POINT_LIGHTS_BIT = 1u << 0u;
+	static constexpr U32 TILE_SPOT_LIGHTS_BIT = 1u << 1u;
+	static constexpr U32 TILE_SHADOWS_BIT = 1u << 2u;
+	static constexpr U32 TILE_VARIANT_COUNT = 8;
+
 	class
 	{
 	public:
 		RenderTargetDescription m_rtDescr;
 		FramebufferDescription m_fbDescr;
+		FramebufferDescription m_vrsFbDescr; ///< Same as m_fbDescr plus the shading rate image.
 
 		// Light shaders
 		ShaderProgramResourcePtr m_prog;
@@ -50,17 +57,40 @@ private:
 		ShaderProgramPtr m_grProg;
 	} m_applyFog;
 
+	/// Classifies the screen tiles by the light types that affect them and shades every tile with a variant that
+	/// skips the rest.
+	class
+	{
+	public:
+		ShaderProgramResourcePtr m_prog;
+		ShaderProgramPtr m_classifyGrProg;
+		ShaderProgramPtr m_compactGrProg;
+		Array<ShaderProgramPtr, TILE_VARIANT_COUNT> m_lightShadingGrProgs;
+
+		BufferPtr m_tileVariantsBuff; ///< The variant of every tile.
+		BufferPtr m_tilesBuff; ///< The tiles of every variant.
+		BufferPtr m_argsBuff; ///< The drawcall of every variant.
+
+		Bool m_enabled = false;
+	} m_tileClassification;
+
 	class
 	{
 	public:
 		RenderTargetHandle m_rt;
 		RenderingContext* m_ctx;
+		RenderPassBufferHandle m_tileVariantsBuffHandle;
+		RenderPassBufferHandle m_tilesBuffHandle;
+		RenderPassBufferHandle m_argsBuffHandle;
 	} m_runCtx; ///< Run context.
 
 	ANKI_USE_RESULT Error initLightShading(const ConfigSet& config);
 	ANKI_USE_RESULT Error initApplyFog(const ConfigSet& config);
+	ANKI_USE_RESULT Error initTileClassification(const ConfigSet& config);
 
 	void run(RenderPassWorkContext& rgraphCtx);
+	void runTileClassification(RenderPassWorkContext& rgraphCtx);
+	void runTileCompaction(RenderPassWorkContext& rgraphCtx);
 };
 /// @}
 
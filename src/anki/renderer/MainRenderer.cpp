@@ -54,10 +54,19 @@ Error MainRenderer::init(ThreadHive* hive,
 	config2.set("width", size.x());
 	config2.set("height", size.y());
 
-	m_rDrawToDefaultFb = m_renderingQuality == 1.0;
+	m_renderTargetAliasing = config.getBool("r_renderTargetAliasing");
+	m_splitBarriers = config.getBool("r_splitBarriers");
+	m_dynamicResolution = config.getBool("r_dynamicResolution");
+	m_gpuTimeTarget = config.getNumberF64("r_dynamicResolutionGpuTimeTarget") / 1000.0;
+	m_minResolutionScale = config.getNumberF32("r_dynamicResolutionMinScale");
+	m_rendererConfig = config2;
+	m_configVersion = config.getVersion();
+
+	// With dynamic resolution the size of the offscreen renderer changes so always blit
+	m_rDrawToDefaultFb = m_renderingQuality == 1.0 && !m_dynamicResolution;
 
 	m_r.reset(m_alloc.newInstance<Renderer>());
-	ANKI_CHECK(m_r->init(hive, resources, gr, stagingMem, ui, m_alloc, config2, globTimestamp));
+	ANKI_CHECK(m_r->init(hive, resources, gr, stagingMem, ui, m_alloc, m_rendererConfig, globTimestamp));
 
 	// Init other
 	if(!m_rDrawToDefaultFb)
@@ -81,6 +90,31 @@ Error MainRenderer::init(ThreadHive* hive,
 	return Error::NONE;
 }
 
+Error MainRenderer::applyConfig(const ConfigSet& config)
+{
+	if(config.getVersion() == m_configVersion)
+	{
+		return Error::NONE;
+	}
+
+	m_renderTargetAliasing = config.getBool(ConfigOption::r_renderTargetAliasing);
+	m_splitBarriers = config.getBool(ConfigOption::r_splitBarriers);
+	m_gpuTimeTarget = config.getNumberF64(ConfigOption::r_dynamicResolutionGpuTimeTarget) / 1000.0;
+	m_minResolutionScale = config.getNumberF32(ConfigOption::r_dynamicResolutionMinScale);
+
+	// The size of the offscreen renderer is managed here, keep it
+	const U32 width = m_rendererConfig.getNumberU32(ConfigOption::width);
+	const U32 height = m_rendererConfig.getNumberU32(ConfigOption::height);
+	m_rendererConfig = config;
+	m_rendererConfig.set(ConfigOption::width, width);
+	m_rendererConfig.set(ConfigOption::height, height);
+
+	ANKI_CHECK(m_r->applyConfig(m_rendererConfig));
+
+	m_configVersion = config.getVersion();
+	return Error::NONE;
+}
+
 Error MainRenderer::render(RenderQueue& rqueue, TexturePtr presentTex)
 {
 	ANKI_TRACE_SCOPED_EVENT(RENDER);
@@ -89,13 +123,19 @@ Error MainRenderer::render(RenderQueue& rqueue, TexturePtr presentTex)
 	m_stats.m_renderingCpuTime = (m_statsEnabled) ? HighRezTimer::getCurrentTime() : -1.0;
 
 	// First thing, reset the temp mem pool
+	const U32 growFrameCount = m_frameAlloc.getMemoryPool().getGrowFrameCount();
 	m_frameAlloc.getMemoryPool().reset();
+	ANKI_TRACE_INC_COUNTER(R_FRAME_ALLOC_GROWS, m_frameAlloc.getMemoryPool().getGrowFrameCount() - growFrameCount);
 
 	// Run renderer
 	RenderingContext ctx(m_frameAlloc);
 	m_runCtx.m_ctx = &ctx;
-	m_runCtx.m_secondaryTaskId.setNonAtomically(0);
-	ctx.m_renderGraphDescr.setStatisticsEnabled(m_statsEnabled);
+	ctx.m_renderGraphDescr.setStatisticsEnabled(m_statsEnabled || m_dynamicResolution);
+	ctx.m_renderGraphDescr.setPassStatisticsEnabled(m_statsEnabled);
+	ctx.m_renderGraphDescr.setRenderTargetAliasingEnabled(m_renderTargetAliasing);
+	ctx.m_renderGraphDescr.setSplitBarriersEnabled(m_splitBarriers);
+	ctx.m_renderGraphDescr.setSecondLevelCommandBufferSplit(
+		m_r->getThreadHive().getThreadCount(), MIN_DRAWCALLS_PER_2ND_LEVEL_COMMAND_BUFFER);
 
 	RenderTargetHandle presentRt = ctx.m_renderGraphDescr.importRenderTarget(presentTex, TextureUsageBit::NONE);
 
@@ -159,19 +199,8 @@ Error MainRenderer::render(RenderQueue& rqueue, TexturePtr presentTex)
 	m_rgraph->compileNewGraph(ctx.m_renderGraphDescr, m_frameAlloc);
 
 	// Populate the 2nd level command buffers
-	Array<ThreadHiveTask, ThreadHive::MAX_THREADS> tasks;
-	for(U i = 0; i < m_r->getThreadHive().getThreadCount(); ++i)
-	{
-		tasks[i].m_argument = this;
-		tasks[i].m_callback = [](void* userData, U32 threadId, ThreadHive& hive, ThreadHiveSemaphore* signalSemaphore) {
-			MainRenderer& self = *static_cast<MainRenderer*>(userData);
-
-			const U32 taskId = self.m_runCtx.m_secondaryTaskId.fetchAdd(1);
-			self.m_rgraph->runSecondLevel(taskId);
-		};
-	}
-	m_r->getThreadHive().submitTasks(&tasks[0], m_r->getThreadHive().getThreadCount());
-	m_r->getThreadHive().waitAllTasks();
+	ThreadHive& hive = m_r->getThreadHive();
+	hive.parallelFor(hive.getThreadCount(), 1, [&](U32 begin, U32 end, U32 threadId) { m_rgraph->runSecondLevel(); });
 
 	// Populate 1st level command buffers
 	m_rgraph->run();
@@ -184,20 +213,86 @@ Error MainRenderer::render(RenderQueue& rqueue, TexturePtr presentTex)
 	m_r->finalize(ctx);
 
 	// Stats
-	if(m_statsEnabled)
+	if(m_statsEnabled || m_dynamicResolution)
 	{
-		static_cast<RendererStats&>(m_stats) = m_r->getStats();
-		m_stats.m_renderingCpuTime = HighRezTimer::getCurrentTime() - m_stats.m_renderingCpuTime;
-
 		RenderGraphStatistics rgraphStats;
 		m_rgraph->getStatistics(rgraphStats);
-		m_stats.m_renderingGpuTime = rgraphStats.m_gpuTime;
-		m_stats.m_renderingGpuSubmitTimestamp = rgraphStats.m_cpuStartTime;
+
+		if(m_statsEnabled)
+		{
+			static_cast<RendererStats&>(m_stats) = m_r->getStats();
+			m_stats.m_renderingCpuTime = HighRezTimer::getCurrentTime() - m_stats.m_renderingCpuTime;
+			m_stats.m_renderingGpuTime = rgraphStats.m_gpuTime;
+			m_stats.m_renderingGpuSubmitTimestamp = rgraphStats.m_cpuStartTime;
+			m_stats.m_renderGraphBarrierCount = rgraphStats.m_barrierCount;
+			m_stats.m_passes = rgraphStats.m_passes;
+		}
+
+		if(m_dynamicResolution)
+		{
+			ANKI_CHECK(updateResolutionScale(rgraphStats.m_gpuTime));
+		}
 	}
 
 	return Error::NONE;
 }
 
+Error MainRenderer::updateResolutionScale(Second gpuTime)
+{
+	// The statistics are a few frames old. Skip the frames that were rendered with the previous size
+	++m_framesSinceResize;
+	if(gpuTime < 0.0 || m_framesSinceResize <= MAX_FRAMES_IN_FLIGHT + 1)
+	{
+		return Error::NONE;
+	}
+
+	m_avgGpuTime = (m_framesSinceResize == MAX_FRAMES_IN_FLIGHT + 2) ? gpuTime : mix(m_avgGpuTime, gpuTime, 0.1);
+
+	// Wait a bit before changing again to avoid oscillating between two sizes
+	const U32 cooldownFrameCount = 30;
+	if(m_framesSinceResize < cooldownFrameCount)
+	{
+		return Error::NONE;
+	}
+
+	// Change the scale in steps. The GPU time is roughly proportional to the pixel count
+	const F32 scaleStep = 0.1f;
+	F32 newScale = m_resolutionScale;
+	if(m_avgGpuTime > m_gpuTimeTarget)
+	{
+		newScale = max(m_minResolutionScale, m_resolutionScale - scaleStep);
+	}
+	else
+	{
+		const F32 upScale = min(1.0f, m_resolutionScale + scaleStep);
+		const F32 pixelFactor = (upScale * upScale) / (m_resolutionScale * m_resolutionScale);
+
+		// Leave some headroom so it won't go back down immediately
+		if(m_avgGpuTime * pixelFactor < m_gpuTimeTarget * 0.9)
+		{
+			newScale = upScale;
+		}
+	}
+
+	if(absolute(newScale - m_resolutionScale) < EPSILON)
+	{
+		return Error::NONE;
+	}
+
+	m_resolutionScale = newScale;
+	m_framesSinceResize = 0;
+
+	const F32 scale = m_resolutionScale * m_renderingQuality;
+	const U32 width = max(10u, U32(scale * F32(m_width)) & ~1u);
+	const U32 height = max(10u, U32(scale * F32(m_height)) & ~1u);
+	m_rendererConfig.set(ConfigOption::width, width);
+	m_rendererConfig.set(ConfigOption::height, height);
+
+	ANKI_CHECK(m_r->resize(m_rendererConfig));
+
+	return Error::NONE;
+}
+
 void MainRenderer::runBlit(RenderPassWorkContext& rgraphCtx)
 {
 	CommandBufferPtr& cmdb = rgraphCtx.m_commandBuffer;
@@ -8,6 +8,7 @@
 #include <anki/renderer/Common.h>
 #include <anki/resource/Forward.h>
 #include <anki/renderer/Renderer.h>
+#include <anki/core/ConfigSet.h>
 
 namespace anki
 {
@@ -28,6 +29,8 @@ public:
 	Second m_renderingCpuTime ANKI_DEBUG_CODE(= -1.0);
 	Second m_renderingGpuTime ANKI_DEBUG_CODE(= -1.0);
 	Second m_renderingGpuSubmitTimestamp ANKI_DEBUG_CODE(= -1.0);
+	U32 m_renderGraphBarrierCount = 0;
+	ConstWeakArray<RenderGraphPassStatistics> m_passes; ///< Per render pass. Valid until the next render().
 };
 
 /// Main onscreen renderer
@@ -50,6 +53,10 @@ public:
 
 	ANKI_USE_RESULT Error render(RenderQueue& rqueue, TexturePtr presentTex);
 
+	/// Apply the options that changed at runtime. The rendering quality and the dynamic resolution toggle are only
+	/// read at init.
+	ANKI_USE_RESULT Error applyConfig(const ConfigSet& config);
+
 	Dbg& getDbg();
 
 	F32 getAspectRatio() const;
@@ -94,14 +101,30 @@ private:
 
 	MainRendererStats m_stats;
 	Bool m_statsEnabled = false;
+	Bool m_renderTargetAliasing = false;
+	Bool m_splitBarriers = true;
+
+	/// @name Dynamic resolution
+	/// @{
+	Bool m_dynamicResolution = false;
+	ConfigSet m_rendererConfig; ///< Used to resize the offscreen renderer.
+	U64 m_configVersion = 0; ///< The version of the last applied config.
+	Second m_gpuTimeTarget = 0.0;
+	F32 m_minResolutionScale = 1.0f;
+	F32 m_resolutionScale = 1.0f; ///< Over the size that the rendering quality gives.
+	Second m_avgGpuTime = 0.0; ///< Running average of the GPU frame time with the current scale.
+	U32 m_framesSinceResize = 0;
+	/// @}
 
 	class
 	{
 	public:
 		const RenderingContext* m_ctx = nullptr;
-		Atomic<U32> m_secondaryTaskId = {0};
 	} m_runCtx;
 
+	/// Pick a new resolution scale given the GPU time of an old frame and resize the offscreen renderer if needed.
+	ANKI_USE_RESULT Error updateResolutionScale(Second gpuTime);
+
 	void runBlit(RenderPassWorkContext& rgraphCtx);
 	void present(RenderPassWorkContext& rgraphCtx);
 };
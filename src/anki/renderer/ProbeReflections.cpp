@@ -8,6 +8,7 @@
 #include <anki/renderer/FinalComposite.h>
 #include <anki/renderer/GBuffer.h>
 #include <anki/renderer/RenderQueue.h>
+#include <anki/renderer/GpuSkinning.h>
 #include <anki/core/ConfigSet.h>
 #include <anki/util/Tracer.h>
 #include <anki/resource/MeshResource.h>
@@ -46,11 +47,14 @@ Error ProbeReflections::initInternal(const ConfigSet& config)
 	// Init cache entries
 	m_cacheEntries.create(getAllocator(), config.getNumberU32("r_probeRefectionlMaxSimultaneousProbeCount"));
 
+	m_updateBudget = config.getNumberF64("r_probeReflectionUpdateBudget") / 1000.0;
+
 	ANKI_CHECK(initGBuffer(config));
 	ANKI_CHECK(initLightShading(config));
 	ANKI_CHECK(initIrradiance(config));
 	ANKI_CHECK(initIrradianceToRefl(config));
 	ANKI_CHECK(initShadowMapping(config));
+	ANKI_CHECK(initCompression(config));
 
 	// Load split sum integration LUT
 	ANKI_CHECK(getResourceManager().loadResource("engine_data/SplitSumIntegration.ankitex", m_integrationLut));
@@ -70,28 +74,29 @@ Error ProbeReflections::initGBuffer(const ConfigSet& config)
 {
 	m_gbuffer.m_tileSize = config.getNumberU32("r_probeReflectionResolution");
 
-	// Create RT descriptions
+	// Create the textures
 	{
-		RenderTargetDescription texinit = m_r->create2DRenderTargetDescription(m_gbuffer.m_tileSize * 6,
+		TextureInitInfo texinit = m_r->create2DRenderTargetInitInfo(m_gbuffer.m_tileSize * 6,
 			m_gbuffer.m_tileSize,
 			GBUFFER_COLOR_ATTACHMENT_PIXEL_FORMATS[0],
+			TextureUsageBit::FRAMEBUFFER_ATTACHMENT_READ_WRITE | TextureUsageBit::SAMPLED_FRAGMENT
+				| TextureUsageBit::SAMPLED_COMPUTE,
 			"CubeRefl GBuffer");
+		texinit.m_initialUsage = TextureUsageBit::SAMPLED_FRAGMENT;
 
-		// Create color RT descriptions
+		// Create color textures
 		for(U i = 0; i < GBUFFER_COLOR_ATTACHMENT_COUNT; ++i)
 		{
 			texinit.m_format = GBUFFER_COLOR_ATTACHMENT_PIXEL_FORMATS[i];
-			m_gbuffer.m_colorRtDescrs[i] = texinit;
-			m_gbuffer.m_colorRtDescrs[i].setName(
-				StringAuto(getAllocator()).sprintf("CubeRefl GBuff Col #%u", i).toCString());
-			m_gbuffer.m_colorRtDescrs[i].bake();
+			texinit.setName(StringAuto(getAllocator()).sprintf("CubeRefl GBuff Col #%u", i).toCString());
+			m_gbuffer.m_colorTexs[i] = getGrManager().newTexture(texinit);
 		}
 
-		// Create depth RT
+		// Create depth texture
 		texinit.m_format = GBUFFER_DEPTH_ATTACHMENT_PIXEL_FORMAT;
+		texinit.m_usage = TextureUsageBit::FRAMEBUFFER_ATTACHMENT_READ_WRITE | TextureUsageBit::SAMPLED_FRAGMENT;
 		texinit.setName("CubeRefl GBuff Depth");
-		m_gbuffer.m_depthRtDescr = texinit;
-		m_gbuffer.m_depthRtDescr.bake();
+		m_gbuffer.m_depthTex = getGrManager().newTexture(texinit);
 	}
 
 	// Create FB descr
@@ -118,6 +123,19 @@ Error ProbeReflections::initLightShading(const ConfigSet& config)
 	m_lightShading.m_tileSize = config.getNumberU32("r_probeReflectionResolution");
 	m_lightShading.m_mipCount = computeMaxMipmapCount2d(m_lightShading.m_tileSize, m_lightShading.m_tileSize, 8);
 
+	// All the mips need to be made of whole BC6H blocks
+	m_compression.m_enabled = config.getBool("r_probeReflectionCompression");
+	if(m_compression.m_enabled && !getGrManager().getDeviceCapabilities().m_bcTextureCompression)
+	{
+		ANKI_R_LOGW("BC6H is not supported. The reflection probes won't be compressed");
+		m_compression.m_enabled = false;
+	}
+	else if(m_compression.m_enabled && (m_lightShading.m_tileSize % (4u << (m_lightShading.m_mipCount - 1))) != 0)
+	{
+		ANKI_R_LOGW("The r_probeReflectionResolution is not a power of two. The reflection probes won't be compressed");
+		m_compression.m_enabled = false;
+	}
+
 	// Init cube arr
 	{
 		TextureInitInfo texinit = m_r->create2DRenderTargetInitInfo(m_lightShading.m_tileSize,
@@ -132,7 +150,26 @@ Error ProbeReflections::initLightShading(const ConfigSet& config)
 		texinit.m_layerCount = m_cacheEntries.getSize();
 		texinit.m_initialUsage = TextureUsageBit::SAMPLED_FRAGMENT;
 
-		m_lightShading.m_cubeArr = m_r->createAndClearRenderTarget(texinit);
+		if(!m_compression.m_enabled)
+		{
+			m_lightShading.m_cubeArr = m_r->createAndClearRenderTarget(texinit);
+		}
+		else
+		{
+			// Only the probe that is updated is uncompressed
+			texinit.m_type = TextureType::CUBE;
+			texinit.m_layerCount = 1;
+			texinit.setName("CubeRefl work");
+			m_compression.m_workCube = m_r->createAndClearRenderTarget(texinit);
+
+			// The probes are written with copies. No need to clear them, a probe is not used before it's written
+			texinit.m_format = Format::BC6H_UFLOAT_BLOCK;
+			texinit.m_usage = TextureUsageBit::SAMPLED_FRAGMENT | TextureUsageBit::TRANSFER_DESTINATION;
+			texinit.m_type = TextureType::CUBE_ARRAY;
+			texinit.m_layerCount = m_cacheEntries.getSize();
+			texinit.setName("CubeRefl refl");
+			m_lightShading.m_cubeArr = getGrManager().newTexture(texinit);
+		}
 	}
 
 	// Init deferred
@@ -216,6 +253,35 @@ Error ProbeReflections::initShadowMapping(const ConfigSet& cfg)
 	return Error::NONE;
 }
 
+Error ProbeReflections::initCompression(const ConfigSet& cfg)
+{
+	if(!m_compression.m_enabled)
+	{
+		return Error::NONE;
+	}
+
+	ANKI_CHECK(getResourceManager().loadResource("shaders/Bc6hCompression.ankiprog", m_compression.m_prog));
+
+	const ShaderProgramResourceVariant* variant;
+	m_compression.m_prog->getOrCreateVariant(ShaderProgramResourceVariantInitInfo(m_compression.m_prog), variant);
+	m_compression.m_grProg = variant->getProgram();
+
+	// The blocks of the faces of a mip are one after the other, same as the copies read them
+	PtrSize buffSize = 0;
+	for(U32 mip = 0; mip < m_lightShading.m_mipCount; ++mip)
+	{
+		const U32 mipSize = m_lightShading.m_tileSize >> mip;
+		buffSize += computeSurfaceSize(mipSize, mipSize, Format::BC6H_UFLOAT_BLOCK) * 6;
+	}
+
+	BufferInitInfo buffInit("CubeRefl BC6H");
+	buffInit.m_usage = BufferUsageBit::STORAGE_COMPUTE_WRITE | BufferUsageBit::TEXTURE_UPLOAD_SOURCE;
+	buffInit.m_size = buffSize;
+	m_compression.m_blocksBuff = getGrManager().newBuffer(buffInit);
+
+	return Error::NONE;
+}
+
 void ProbeReflections::initCacheEntry(U32 cacheEntryIdx)
 {
 	CacheEntry& cacheEntry = m_cacheEntries[cacheEntryIdx];
@@ -226,7 +292,7 @@ void ProbeReflections::initCacheEntry(U32 cacheEntryIdx)
 		FramebufferDescription& fbDescr = cacheEntry.m_lightShadingFbDescrs[faceIdx];
 		ANKI_ASSERT(!fbDescr.isBacked());
 		fbDescr.m_colorAttachmentCount = 1;
-		fbDescr.m_colorAttachments[0].m_surface.m_layer = cacheEntryIdx;
+		fbDescr.m_colorAttachments[0].m_surface.m_layer = getLightShadingLayer(cacheEntryIdx);
 		fbDescr.m_colorAttachments[0].m_surface.m_face = faceIdx;
 		fbDescr.m_colorAttachments[0].m_loadOperation = AttachmentLoadOperation::CLEAR;
 		fbDescr.bake();
@@ -235,31 +301,40 @@ void ProbeReflections::initCacheEntry(U32 cacheEntryIdx)
 
 void ProbeReflections::prepareProbes(RenderingContext& ctx,
 	ReflectionProbeQueueElement*& probeToUpdateThisFrame,
-	U32& probeToUpdateThisFrameCacheEntryIdx)
+	U32& probeToUpdateThisFrameCacheEntryIdx,
+	U32& firstFace,
+	U32& faceCount)
 {
 	probeToUpdateThisFrame = nullptr;
 	probeToUpdateThisFrameCacheEntryIdx = MAX_U32;
+	firstFace = 0;
+	faceCount = 0;
 
 	if(ANKI_UNLIKELY(ctx.m_renderQueue->m_reflectionProbes.getSize() == 0))
 	{
+		m_probeToUpdateUuid = 0;
 		return;
 	}
 
+	const Timestamp crntTimestamp = m_r->getGlobalTimestamp();
+	const Vec4 cameraPos = ctx.m_renderQueue->m_cameraTransform.getTranslationPart();
+
 	// Iterate the probes and:
-	// - Find a probe to update this frame
-	// - Find a probe to update next frame
 	// - Find the cache entries for each probe
+	// - Render some faces of the probe that got its renderables gathered
+	// - Find the most important probe to update next
 	DynamicArray<ReflectionProbeQueueElement> newListOfProbes;
 	newListOfProbes.create(ctx.m_tempAllocator, ctx.m_renderQueue->m_reflectionProbes.getSize());
 	U32 newListOfProbeCount = 0;
-	Bool foundProbeToUpdateNextFrame = false;
+	ReflectionProbeQueueElement* probeToUpdateNextFrame = nullptr;
+	F32 probeToUpdateNextFramePriority = -1.0f;
 	for(U32 probeIdx = 0; probeIdx < ctx.m_renderQueue->m_reflectionProbes.getSize(); ++probeIdx)
 	{
 		ReflectionProbeQueueElement& probe = ctx.m_renderQueue->m_reflectionProbes[probeIdx];
 
 		// Find cache entry
 		const U32 cacheEntryIdx = findBestCacheEntry(
-			probe.m_uuid, m_r->getGlobalTimestamp(), m_cacheEntries, m_probeUuidToCacheEntryIdx, getAllocator());
+			probe.m_uuid, crntTimestamp, m_cacheEntries, m_probeUuidToCacheEntryIdx, getAllocator());
 		if(ANKI_UNLIKELY(cacheEntryIdx == MAX_U32))
 		{
 			// Failed
@@ -268,58 +343,87 @@ void ProbeReflections::prepareProbes(RenderingContext& ctx,
 			continue;
 		}
 
-		const Bool probeFoundInCache = m_cacheEntries[cacheEntryIdx].m_uuid == probe.m_uuid;
+		// Update the cache entry. A new probe reserves the entry but it's not used until all of its faces are rendered
+		CacheEntry& entry = m_cacheEntries[cacheEntryIdx];
+		if(entry.m_uuid != probe.m_uuid)
+		{
+			entry.m_uuid = probe.m_uuid;
+			entry.m_requestTimestamp = crntTimestamp;
+			entry.m_renderedFaceCount = 0;
+			m_probeUuidToCacheEntryIdx.emplace(getAllocator(), probe.m_uuid, cacheEntryIdx);
+		}
+		entry.m_lastUsedTimestamp = crntTimestamp;
 
-		// Check if we _should_ and _can_ update the probe
-		const Bool needsUpdate = !probeFoundInCache;
-		if(ANKI_UNLIKELY(needsUpdate))
+		// Update the probe
+		probe.m_textureArrayIndex = cacheEntryIdx;
+
+		if(ANKI_LIKELY(entry.m_renderedFaceCount == 6))
 		{
-			const Bool canUpdateThisFrame = probeToUpdateThisFrame == nullptr && probe.m_renderQueues[0] != nullptr;
-			const Bool canUpdateNextFrame = !foundProbeToUpdateNextFrame;
+			// All good, can use this probe in this frame
+			newListOfProbes[newListOfProbeCount++] = probe;
 
-			if(!canUpdateThisFrame && canUpdateNextFrame)
+			// Don't gather renderables next frame
+			if(probe.m_renderQueues[0] != nullptr)
 			{
-				// Probe will be updated next frame
-				foundProbeToUpdateNextFrame = true;
-				probe.m_feedbackCallback(true, probe.m_feedbackCallbackUserData);
-				continue;
-			}
-			else if(!canUpdateThisFrame)
-			{
-				// Can't be updated this frame so remove it from the list
-				continue;
-			}
-			else
-			{
-				// Can be updated this frame so continue with it
-				probeToUpdateThisFrameCacheEntryIdx = cacheEntryIdx;
-				probeToUpdateThisFrame = &newListOfProbes[newListOfProbeCount];
+				probe.m_feedbackCallback(false, probe.m_feedbackCallbackUserData);
 			}
+			continue;
 		}
 
-		// All good, can use this probe in this frame
+		// The faces rendered in previous frames are lost if another probe used the G-buffer since then
+		if(m_gbuffer.m_probeUuid != probe.m_uuid)
+		{
+			entry.m_renderedFaceCount = 0;
+		}
 
-		// Update the cache entry
-		m_cacheEntries[cacheEntryIdx].m_uuid = probe.m_uuid;
-		m_cacheEntries[cacheEntryIdx].m_lastUsedTimestamp = m_r->getGlobalTimestamp();
+		if(probe.m_uuid == m_probeToUpdateUuid && probe.m_renderQueues[0] != nullptr)
+		{
+			// The renderables are there, render as many faces as the budget allows
+			ANKI_ASSERT(probeToUpdateThisFrame == nullptr);
+			probeToUpdateThisFrame = &probe;
+			probeToUpdateThisFrameCacheEntryIdx = cacheEntryIdx;
+			firstFace = entry.m_renderedFaceCount;
+			faceCount = computeFaceCountToRender(probe, firstFace);
 
-		// Update the probe
-		probe.m_textureArrayIndex = cacheEntryIdx;
+			entry.m_renderedFaceCount += faceCount;
+			m_gbuffer.m_probeUuid = probe.m_uuid;
 
-		// Push the probe to the new list
-		newListOfProbes[newListOfProbeCount++] = probe;
+			if(entry.m_renderedFaceCount == 6)
+			{
+				// Done, can use it in this frame
+				newListOfProbes[newListOfProbeCount++] = probe;
+				probe.m_feedbackCallback(false, probe.m_feedbackCallbackUserData);
+			}
 
-		// Update cache map
-		if(!probeFoundInCache)
-		{
-			m_probeUuidToCacheEntryIdx.emplace(getAllocator(), probe.m_uuid, cacheEntryIdx);
+			continue;
 		}
 
-		// Don't gather renderables next frame
+		// The probe waits for an update
 		if(probe.m_renderQueues[0] != nullptr)
 		{
 			probe.m_feedbackCallback(false, probe.m_feedbackCallbackUserData);
 		}
+
+		const F32 priority = computeUpdatePriority(probe, entry, cameraPos);
+		if(priority > probeToUpdateNextFramePriority)
+		{
+			probeToUpdateNextFramePriority = priority;
+			probeToUpdateNextFrame = &probe;
+		}
+	}
+
+	// Continue with the same probe if it's not done, else ask the scene for the renderables of the most important one.
+	// A probe that goes out of view stops getting updated but it keeps its rendered faces until another probe starts
+	const Bool continueUpdate = probeToUpdateThisFrame
+								&& m_cacheEntries[probeToUpdateThisFrameCacheEntryIdx].m_renderedFaceCount < 6;
+	if(!continueUpdate && probeToUpdateNextFrame)
+	{
+		probeToUpdateNextFrame->m_feedbackCallback(true, probeToUpdateNextFrame->m_feedbackCallbackUserData);
+		m_probeToUpdateUuid = probeToUpdateNextFrame->m_uuid;
+	}
+	else if(!continueUpdate)
+	{
+		m_probeToUpdateUuid = 0;
 	}
 
 	// Replace the probe list in the queue
@@ -337,6 +441,80 @@ void ProbeReflections::prepareProbes(RenderingContext& ctx,
 	}
 }
 
+F32 ProbeReflections::computeUpdatePriority(
+	const ReflectionProbeQueueElement& probe, const CacheEntry& entry, const Vec4& cameraPos) const
+{
+	// Approximate the screen coverage with the solid angle of the bounding sphere. It's 1 when the camera is inside
+	const Vec3 center = (probe.m_aabbMin + probe.m_aabbMax) / 2.0f;
+	const F32 radius = (probe.m_aabbMax - probe.m_aabbMin).getLength() / 2.0f;
+	const F32 distance = max((cameraPos.xyz() - center).getLength(), radius);
+	const F32 coverage = (distance > EPSILON) ? (radius / distance) * (radius / distance) : 1.0f;
+
+	// Don't let far probes starve
+	const F32 waitingFrameCount = F32(m_r->getGlobalTimestamp() - entry.m_requestTimestamp);
+	const F32 staleness = 1.0f + waitingFrameCount * 0.1f;
+
+	// Prefer to finish the probe that was interrupted
+	const F32 progress = F32(1 + entry.m_renderedFaceCount);
+
+	return coverage * staleness * progress;
+}
+
+U32 ProbeReflections::computeFaceCountToRender(const ReflectionProbeQueueElement& probe, U32 firstFace) const
+{
+	ANKI_ASSERT(firstFace < 6);
+
+	if(m_updateBudget == 0.0 || m_gpuTimePerDrawcall == 0.0)
+	{
+		// No budget or nothing measured yet, render them all
+		return 6 - firstFace;
+	}
+
+	// Add faces while they fit in the budget. Always render one face to make progress
+	Second cost = 0.0;
+	U32 faceCount = 0;
+	for(U32 faceIdx = firstFace; faceIdx < 6; ++faceIdx)
+	{
+		const RenderQueue& rqueue = *probe.m_renderQueues[faceIdx];
+
+		U32 drawcallCount = rqueue.m_renderables.getSize();
+		if(rqueue.m_directionalLight.m_uuid && rqueue.m_directionalLight.m_shadowCascadeCount > 0)
+		{
+			drawcallCount += rqueue.m_directionalLight.m_shadowRenderQueues[0]->m_renderables.getSize();
+		}
+
+		cost += F64(drawcallCount) * m_gpuTimePerDrawcall;
+		if(faceCount > 0 && cost > m_updateBudget)
+		{
+			break;
+		}
+
+		++faceCount;
+	}
+
+	return faceCount;
+}
+
+void ProbeReflections::gatherGBufferPassTiming()
+{
+	// The slot of this frame was written MAX_FRAMES_IN_FLIGHT frames ago so the GPU is done with it
+	GBufferPassTiming& timing = m_gbufferPassTimings[m_r->getFrameCount() % m_gbufferPassTimings.getSize()];
+
+	Second begin, end;
+	if(timing.m_begin && timing.m_drawcallCount > 0
+		&& timing.m_begin->getResult(begin) == TimestampQueryResult::AVAILABLE
+		&& timing.m_end->getResult(end) == TimestampQueryResult::AVAILABLE && end > begin)
+	{
+		const Second timePerDrawcall = (end - begin) / F64(timing.m_drawcallCount);
+		m_gpuTimePerDrawcall =
+			(m_gpuTimePerDrawcall > 0.0) ? mix(m_gpuTimePerDrawcall, timePerDrawcall, 0.1) : timePerDrawcall;
+	}
+
+	timing.m_begin.reset(nullptr);
+	timing.m_end.reset(nullptr);
+	timing.m_drawcallCount = 0;
+}
+
 void ProbeReflections::runGBuffer(RenderPassWorkContext& rgraphCtx)
 {
 	ANKI_ASSERT(m_ctx.m_probe);
@@ -355,7 +533,7 @@ void ProbeReflections::runGBuffer(RenderPassWorkContext& rgraphCtx)
 	end = I32(endu);
 
 	I32 drawcallCount = 0;
-	for(U32 faceIdx = 0; faceIdx < 6; ++faceIdx)
+	for(U32 faceIdx = m_ctx.m_firstFace; faceIdx < m_ctx.m_firstFace + m_ctx.m_faceCount; ++faceIdx)
 	{
 		const I32 faceDrawcallCount = I32(probe.m_renderQueues[faceIdx]->m_renderables.getSize());
 		const I32 localStart = max(I32(0), start - drawcallCount);
@@ -379,6 +557,8 @@ void ProbeReflections::runGBuffer(RenderPassWorkContext& rgraphCtx)
 				rqueue.m_renderables.getBegin() + localEnd,
 				MAX_LOD_COUNT - 1);
 		}
+
+		drawcallCount += faceDrawcallCount;
 	}
 
 	// Restore state
@@ -419,7 +599,7 @@ void ProbeReflections::runLightShading(U32 faceIdx, RenderPassWorkContext& rgrap
 
 	TraditionalDeferredLightShadingDrawInfo dsInfo;
 	dsInfo.m_viewProjectionMatrix = rqueue.m_viewProjectionMatrix;
-	dsInfo.m_invViewProjectionMatrix = rqueue.m_viewProjectionMatrix.getInverse();
+	dsInfo.m_invViewProjectionMatrix = rqueue.m_frustumData.m_invViewProjectionMatrix;
 	dsInfo.m_cameraPosWSpace = rqueue.m_cameraTransform.getTranslationPart();
 	dsInfo.m_viewport = UVec4(0, 0, m_lightShading.m_tileSize, m_lightShading.m_tileSize);
 	dsInfo.m_gbufferTexCoordsScale =
@@ -444,7 +624,7 @@ void ProbeReflections::runMipmappingOfLightShading(U32 faceIdx, RenderPassWorkCo
 
 	ANKI_TRACE_SCOPED_EVENT(R_CUBE_REFL);
 
-	TextureSubresourceInfo subresource(TextureSurfaceInfo(0, 0, faceIdx, m_ctx.m_cacheEntryIdx));
+	TextureSubresourceInfo subresource(TextureSurfaceInfo(0, 0, faceIdx, getLightShadingLayer(m_ctx.m_cacheEntryIdx)));
 	subresource.m_mipmapCount = m_lightShading.m_mipCount;
 
 	TexturePtr texToBind;
@@ -470,7 +650,7 @@ void ProbeReflections::runIrradiance(RenderPassWorkContext& rgraphCtx)
 
 	TextureSubresourceInfo subresource;
 	subresource.m_faceCount = 6;
-	subresource.m_firstLayer = cacheEntryIdx;
+	subresource.m_firstLayer = getLightShadingLayer(cacheEntryIdx);
 	rgraphCtx.bindTexture(0, 1, m_ctx.m_lightShadingRt, subresource);
 
 	allocateAndBindStorage<void*>(
@@ -504,12 +684,65 @@ void ProbeReflections::runIrradianceToRefl(RenderPassWorkContext& rgraphCtx)
 
 	TextureSubresourceInfo subresource;
 	subresource.m_faceCount = 6;
-	subresource.m_firstLayer = cacheEntryIdx;
+	subresource.m_firstLayer = getLightShadingLayer(cacheEntryIdx);
 	rgraphCtx.bindImage(0, 3, m_ctx.m_lightShadingRt, subresource);
 
 	dispatchPPCompute(cmdb, 8, 8, m_lightShading.m_tileSize, m_lightShading.m_tileSize);
 }
 
+void ProbeReflections::runCompression(RenderPassWorkContext& rgraphCtx)
+{
+	ANKI_TRACE_SCOPED_EVENT(R_CUBE_REFL);
+	ANKI_ASSERT(m_compression.m_enabled);
+
+	CommandBufferPtr& cmdb = rgraphCtx.m_commandBuffer;
+
+	cmdb->bindShaderProgram(m_compression.m_grProg);
+	rgraphCtx.bindStorageBuffer(0, 1, m_ctx.m_compressedBlocksBuffHandle);
+
+	U32 firstBlock = 0;
+	for(U32 mip = 0; mip < m_lightShading.m_mipCount; ++mip)
+	{
+		TextureSubresourceInfo subresource;
+		subresource.m_faceCount = 6;
+		subresource.m_firstMipmap = mip;
+		rgraphCtx.bindImage(0, 0, m_ctx.m_lightShadingRt, subresource);
+
+		const U32 blockCount = (m_lightShading.m_tileSize >> mip) / 4;
+		const UVec4 pc(blockCount, blockCount, firstBlock, 0u);
+		cmdb->setPushConstants(&pc, sizeof(pc));
+
+		cmdb->dispatchCompute((blockCount + 7) / 8, (blockCount + 7) / 8, 6);
+
+		firstBlock += blockCount * blockCount * 6;
+	}
+}
+
+void ProbeReflections::runCompressionCopy(RenderPassWorkContext& rgraphCtx)
+{
+	ANKI_TRACE_SCOPED_EVENT(R_CUBE_REFL);
+	ANKI_ASSERT(m_compression.m_enabled);
+
+	CommandBufferPtr& cmdb = rgraphCtx.m_commandBuffer;
+
+	PtrSize offset = 0;
+	for(U32 mip = 0; mip < m_lightShading.m_mipCount; ++mip)
+	{
+		const U32 mipSize = m_lightShading.m_tileSize >> mip;
+		const PtrSize faceSize = computeSurfaceSize(mipSize, mipSize, Format::BC6H_UFLOAT_BLOCK);
+
+		for(U32 faceIdx = 0; faceIdx < 6; ++faceIdx)
+		{
+			const TextureSubresourceInfo subresource(TextureSurfaceInfo(mip, 0, faceIdx, m_ctx.m_cacheEntryIdx));
+			TextureViewInitInfo viewInit(m_lightShading.m_cubeArr, subresource);
+			cmdb->copyBufferToTextureView(
+				m_compression.m_blocksBuff, offset, faceSize, getGrManager().newTextureView(viewInit));
+
+			offset += faceSize;
+		}
+	}
+}
+
 void ProbeReflections::populateRenderGraph(RenderingContext& rctx)
 {
 	ANKI_TRACE_SCOPED_EVENT(R_CUBE_REFL);
@@ -519,22 +752,35 @@ void ProbeReflections::populateRenderGraph(RenderingContext& rctx)
 #endif
 	RenderGraphDescription& rgraph = rctx.m_renderGraphDescr;
 
+	if(m_updateBudget > 0.0)
+	{
+		gatherGBufferPassTiming();
+	}
+
 	// Prepare the probes and maybe get one to render this frame
 	ReflectionProbeQueueElement* probeToUpdate;
 	U32 probeToUpdateCacheEntryIdx;
-	prepareProbes(rctx, probeToUpdate, probeToUpdateCacheEntryIdx);
+	U32 firstFace, faceCount;
+	prepareProbes(rctx, probeToUpdate, probeToUpdateCacheEntryIdx, firstFace, faceCount);
+
+	// The probes
+	m_ctx.m_reflectionRt = rgraph.importRenderTarget(m_lightShading.m_cubeArr, TextureUsageBit::SAMPLED_FRAGMENT);
 
 	// Render a probe if needed
 	if(!probeToUpdate)
 	{
-		// Just import and exit
-
-		m_ctx.m_lightShadingRt = rgraph.importRenderTarget(m_lightShading.m_cubeArr, TextureUsageBit::SAMPLED_FRAGMENT);
+		// Just exit
+		m_ctx.m_lightShadingRt = m_ctx.m_reflectionRt;
 		return;
 	}
 
 	m_ctx.m_cacheEntryIdx = probeToUpdateCacheEntryIdx;
+	const U32 lightShadingLayer = getLightShadingLayer(probeToUpdateCacheEntryIdx);
 	m_ctx.m_probe = probeToUpdate;
+	m_ctx.m_firstFace = firstFace;
+	m_ctx.m_faceCount = faceCount;
+	m_ctx.m_lastFaces = firstFace + faceCount == 6;
+	ANKI_ASSERT(faceCount > 0 && firstFace + faceCount <= 6);
 
 	if(!m_cacheEntries[probeToUpdateCacheEntryIdx].m_lightShadingFbDescrs[0].isBacked())
 	{
@@ -543,32 +789,43 @@ void ProbeReflections::populateRenderGraph(RenderingContext& rctx)
 
 	// G-buffer pass
 	{
-		// RTs
+		// RTs. The faces of previous frames are kept so the usage is known after the first import
+		auto importRt = [&](TexturePtr tex) {
+			return (m_gbuffer.m_texsImportedOnce) ? rgraph.importRenderTarget(tex)
+												  : rgraph.importRenderTarget(tex, TextureUsageBit::SAMPLED_FRAGMENT);
+		};
+
 		Array<RenderTargetHandle, MAX_COLOR_ATTACHMENTS> rts;
 		for(U i = 0; i < GBUFFER_COLOR_ATTACHMENT_COUNT; ++i)
 		{
-			m_ctx.m_gbufferColorRts[i] = rgraph.newRenderTarget(m_gbuffer.m_colorRtDescrs[i]);
+			m_ctx.m_gbufferColorRts[i] = importRt(m_gbuffer.m_colorTexs[i]);
 			rts[i] = m_ctx.m_gbufferColorRts[i];
 		}
-		m_ctx.m_gbufferDepthRt = rgraph.newRenderTarget(m_gbuffer.m_depthRtDescr);
+		m_ctx.m_gbufferDepthRt = importRt(m_gbuffer.m_depthTex);
+		m_gbuffer.m_texsImportedOnce = true;
 
-		// Compute task count
+		// Count the drawcalls. The render graph splits them to second level command buffers
 		m_ctx.m_gbufferRenderableCount = 0;
-		for(U32 i = 0; i < 6; ++i)
+		for(U32 i = firstFace; i < firstFace + faceCount; ++i)
 		{
 			m_ctx.m_gbufferRenderableCount += probeToUpdate->m_renderQueues[i]->m_renderables.getSize();
 		}
-		const U32 taskCount = computeNumberOfSecondLevelCommandBuffers(m_ctx.m_gbufferRenderableCount);
 
-		// Pass
+		// Pass. Clear and render only the faces of this frame
 		GraphicsRenderPassDescription& pass = rgraph.newGraphicsRenderPass("CubeRefl gbuff");
-		pass.setFramebufferInfo(m_gbuffer.m_fbDescr, rts, m_ctx.m_gbufferDepthRt);
-		pass.setWork(
+		pass.setFramebufferInfo(m_gbuffer.m_fbDescr,
+			rts,
+			m_ctx.m_gbufferDepthRt,
+			firstFace * m_gbuffer.m_tileSize,
+			0,
+			faceCount * m_gbuffer.m_tileSize,
+			m_gbuffer.m_tileSize);
+		pass.setParallelWork(
 			[](RenderPassWorkContext& rgraphCtx) {
 				static_cast<ProbeReflections*>(rgraphCtx.m_userData)->runGBuffer(rgraphCtx);
 			},
 			this,
-			taskCount);
+			m_ctx.m_gbufferRenderableCount);
 
 		for(U i = 0; i < GBUFFER_COLOR_ATTACHMENT_COUNT; ++i)
 		{
@@ -577,6 +834,18 @@ void ProbeReflections::populateRenderGraph(RenderingContext& rctx)
 
 		TextureSubresourceInfo subresource(DepthStencilAspectBit::DEPTH);
 		pass.newDependency({m_ctx.m_gbufferDepthRt, TextureUsageBit::FRAMEBUFFER_ATTACHMENT_READ_WRITE, subresource});
+		m_r->getGpuSkinning().setDependencies(pass);
+
+		// Measure the pass to estimate the cost of the faces
+		if(m_updateBudget > 0.0)
+		{
+			GBufferPassTiming& timing = m_gbufferPassTimings[m_r->getFrameCount() % m_gbufferPassTimings.getSize()];
+			timing.m_begin = getGrManager().newTimestampQuery();
+			timing.m_end = getGrManager().newTimestampQuery();
+			timing.m_drawcallCount = m_ctx.m_gbufferRenderableCount;
+
+			pass.setTimestampQueries(timing.m_begin, timing.m_end);
+		}
 	}
 
 	// Shadow pass. Optional
@@ -584,7 +853,7 @@ void ProbeReflections::populateRenderGraph(RenderingContext& rctx)
 		&& probeToUpdate->m_renderQueues[0]->m_directionalLight.m_shadowCascadeCount > 0)
 	{
 		// Update light matrices
-		for(U i = 0; i < 6; ++i)
+		for(U32 i = firstFace; i < firstFace + faceCount; ++i)
 		{
 			ANKI_ASSERT(probeToUpdate->m_renderQueues[i]->m_directionalLight.m_uuid
 						&& probeToUpdate->m_renderQueues[i]->m_directionalLight.m_shadowCascadeCount == 1);
@@ -614,14 +883,13 @@ void ProbeReflections::populateRenderGraph(RenderingContext& rctx)
 			lightMat = atlasMtx * lightMat;
 		}
 
-		// Compute task count
+		// Count the drawcalls
 		m_ctx.m_shadowRenderableCount = 0;
-		for(U32 i = 0; i < 6; ++i)
+		for(U32 i = firstFace; i < firstFace + faceCount; ++i)
 		{
 			m_ctx.m_shadowRenderableCount +=
 				probeToUpdate->m_renderQueues[i]->m_directionalLight.m_shadowRenderQueues[0]->m_renderables.getSize();
 		}
-		const U32 taskCount = computeNumberOfSecondLevelCommandBuffers(m_ctx.m_shadowRenderableCount);
 
 		// RT
 		m_ctx.m_shadowMapRt = rgraph.newRenderTarget(m_shadowMapping.m_rtDescr);
@@ -629,15 +897,16 @@ void ProbeReflections::populateRenderGraph(RenderingContext& rctx)
 		// Pass
 		GraphicsRenderPassDescription& pass = rgraph.newGraphicsRenderPass("CubeRefl SM");
 		pass.setFramebufferInfo(m_shadowMapping.m_fbDescr, {}, m_ctx.m_shadowMapRt);
-		pass.setWork(
+		pass.setParallelWork(
 			[](RenderPassWorkContext& rgraphCtx) {
 				static_cast<ProbeReflections*>(rgraphCtx.m_userData)->runShadowMapping(rgraphCtx);
 			},
 			this,
-			taskCount);
+			m_ctx.m_shadowRenderableCount);
 
 		TextureSubresourceInfo subresource(DepthStencilAspectBit::DEPTH);
 		pass.newDependency({m_ctx.m_shadowMapRt, TextureUsageBit::FRAMEBUFFER_ATTACHMENT_READ_WRITE, subresource});
+		m_r->getGpuSkinning().setDependencies(pass);
 	}
 	else
 	{
@@ -653,8 +922,21 @@ void ProbeReflections::populateRenderGraph(RenderingContext& rctx)
 			runLightShadingCallback<4>,
 			runLightShadingCallback<5>}};
 
-		// RT
-		m_ctx.m_lightShadingRt = rgraph.importRenderTarget(m_lightShading.m_cubeArr, TextureUsageBit::SAMPLED_FRAGMENT);
+		// RT. The work cube keeps the faces of previous frames so the usage is known after the first import
+		if(!m_compression.m_enabled)
+		{
+			m_ctx.m_lightShadingRt = m_ctx.m_reflectionRt;
+		}
+		else if(m_compression.m_workCubeImportedOnce)
+		{
+			m_ctx.m_lightShadingRt = rgraph.importRenderTarget(m_compression.m_workCube);
+		}
+		else
+		{
+			m_ctx.m_lightShadingRt =
+				rgraph.importRenderTarget(m_compression.m_workCube, TextureUsageBit::SAMPLED_FRAGMENT);
+			m_compression.m_workCubeImportedOnce = true;
+		}
 
 		// Passes
 		static const Array<CString, 6> passNames = {{"CubeRefl LightShad #0",
@@ -663,7 +945,7 @@ void ProbeReflections::populateRenderGraph(RenderingContext& rctx)
 			"CubeRefl LightShad #3",
 			"CubeRefl LightShad #4",
 			"CubeRefl LightShad #5"}};
-		for(U32 faceIdx = 0; faceIdx < 6; ++faceIdx)
+		for(U32 faceIdx = firstFace; faceIdx < firstFace + faceCount; ++faceIdx)
 		{
 			GraphicsRenderPassDescription& pass = rgraph.newGraphicsRenderPass(passNames[faceIdx]);
 			pass.setFramebufferInfo(m_cacheEntries[probeToUpdateCacheEntryIdx].m_lightShadingFbDescrs[faceIdx],
@@ -671,7 +953,7 @@ void ProbeReflections::populateRenderGraph(RenderingContext& rctx)
 				{});
 			pass.setWork(callbacks[faceIdx], this, 0);
 
-			TextureSubresourceInfo subresource(TextureSurfaceInfo(0, 0, faceIdx, probeToUpdateCacheEntryIdx));
+			TextureSubresourceInfo subresource(TextureSurfaceInfo(0, 0, faceIdx, lightShadingLayer));
 			pass.newDependency({m_ctx.m_lightShadingRt, TextureUsageBit::FRAMEBUFFER_ATTACHMENT_WRITE, subresource});
 
 			for(U i = 0; i < GBUFFER_COLOR_ATTACHMENT_COUNT; ++i)
@@ -689,6 +971,12 @@ void ProbeReflections::populateRenderGraph(RenderingContext& rctx)
 		}
 	}
 
+	// The rest need all the faces
+	if(!m_ctx.m_lastFaces)
+	{
+		return;
+	}
+
 	// Irradiance passes
 	{
 		m_ctx.m_irradianceDiceValuesBuffHandle =
@@ -706,7 +994,7 @@ void ProbeReflections::populateRenderGraph(RenderingContext& rctx)
 		// Read a cube but only one layer and level
 		TextureSubresourceInfo readSubresource;
 		readSubresource.m_faceCount = 6;
-		readSubresource.m_firstLayer = probeToUpdateCacheEntryIdx;
+		readSubresource.m_firstLayer = lightShadingLayer;
 		pass.newDependency({m_ctx.m_lightShadingRt, TextureUsageBit::SAMPLED_COMPUTE, readSubresource});
 
 		pass.newDependency({m_ctx.m_irradianceDiceValuesBuffHandle, BufferUsageBit::STORAGE_COMPUTE_WRITE});
@@ -730,7 +1018,7 @@ void ProbeReflections::populateRenderGraph(RenderingContext& rctx)
 
 		TextureSubresourceInfo subresource;
 		subresource.m_faceCount = 6;
-		subresource.m_firstLayer = probeToUpdateCacheEntryIdx;
+		subresource.m_firstLayer = lightShadingLayer;
 		pass.newDependency({m_ctx.m_lightShadingRt, TextureUsageBit::IMAGE_COMPUTE_READ_WRITE, subresource});
 
 		pass.newDependency({m_ctx.m_irradianceDiceValuesBuffHandle, BufferUsageBit::STORAGE_COMPUTE_READ});
@@ -756,12 +1044,55 @@ void ProbeReflections::populateRenderGraph(RenderingContext& rctx)
 			GraphicsRenderPassDescription& pass = rgraph.newGraphicsRenderPass(passNames[faceIdx]);
 			pass.setWork(callbacks[faceIdx], this, 0);
 
-			TextureSubresourceInfo subresource(TextureSurfaceInfo(0, 0, faceIdx, probeToUpdateCacheEntryIdx));
+			TextureSubresourceInfo subresource(TextureSurfaceInfo(0, 0, faceIdx, lightShadingLayer));
 			subresource.m_mipmapCount = m_lightShading.m_mipCount;
 
 			pass.newDependency({m_ctx.m_lightShadingRt, TextureUsageBit::GENERATE_MIPMAPS, subresource});
 		}
 	}
+
+	// Compress the probe and copy it to its layer
+	if(m_compression.m_enabled)
+	{
+		m_ctx.m_compressedBlocksBuffHandle = rgraph.importBuffer(m_compression.m_blocksBuff, BufferUsageBit::NONE);
+
+		// Compress
+		{
+			ComputeRenderPassDescription& pass = rgraph.newComputeRenderPass("CubeRefl BC6H");
+			pass.setWork(
+				[](RenderPassWorkContext& rgraphCtx) {
+					static_cast<ProbeReflections*>(rgraphCtx.m_userData)->runCompression(rgraphCtx);
+				},
+				this,
+				0);
+
+			TextureSubresourceInfo subresource;
+			subresource.m_faceCount = 6;
+			subresource.m_mipmapCount = m_lightShading.m_mipCount;
+			pass.newDependency({m_ctx.m_lightShadingRt, TextureUsageBit::IMAGE_COMPUTE_READ, subresource});
+
+			pass.newDependency({m_ctx.m_compressedBlocksBuffHandle, BufferUsageBit::STORAGE_COMPUTE_WRITE});
+		}
+
+		// Copy
+		{
+			GraphicsRenderPassDescription& pass = rgraph.newGraphicsRenderPass("CubeRefl BC6H copy");
+			pass.setWork(
+				[](RenderPassWorkContext& rgraphCtx) {
+					static_cast<ProbeReflections*>(rgraphCtx.m_userData)->runCompressionCopy(rgraphCtx);
+				},
+				this,
+				0);
+
+			TextureSubresourceInfo subresource;
+			subresource.m_faceCount = 6;
+			subresource.m_firstLayer = probeToUpdateCacheEntryIdx;
+			subresource.m_mipmapCount = m_lightShading.m_mipCount;
+			pass.newDependency({m_ctx.m_reflectionRt, TextureUsageBit::TRANSFER_DESTINATION, subresource});
+
+			pass.newDependency({m_ctx.m_compressedBlocksBuffHandle, BufferUsageBit::TEXTURE_UPLOAD_SOURCE});
+		}
+	}
 }
 
 void ProbeReflections::runShadowMapping(RenderPassWorkContext& rgraphCtx)
@@ -783,7 +1114,7 @@ void ProbeReflections::runShadowMapping(RenderPassWorkContext& rgraphCtx)
 	cmdb->setPolygonOffset(1.0f, 1.0f);
 
 	I32 drawcallCount = 0;
-	for(U32 faceIdx = 0; faceIdx < 6; ++faceIdx)
+	for(U32 faceIdx = m_ctx.m_firstFace; faceIdx < m_ctx.m_firstFace + m_ctx.m_faceCount; ++faceIdx)
 	{
 		ANKI_ASSERT(m_ctx.m_probe->m_renderQueues[faceIdx]);
 		const RenderQueue& faceRenderQueue = *m_ctx.m_probe->m_renderQueues[faceIdx];
@@ -813,6 +1144,8 @@ void ProbeReflections::runShadowMapping(RenderPassWorkContext& rgraphCtx)
 				cascadeRenderQueue.m_renderables.getBegin() + localEnd,
 				MAX_LOD_COUNT - 1);
 		}
+
+		drawcallCount += faceDrawcallCount;
 	}
 }
 
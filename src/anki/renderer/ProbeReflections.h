@@ -47,9 +47,10 @@ public:
 		return m_integrationLutSampler;
 	}
 
+	/// The cube array of the probes. It's BC6H if the compression is enabled.
 	RenderTargetHandle getReflectionRt() const
 	{
-		return m_ctx.m_lightShadingRt;
+		return m_ctx.m_reflectionRt;
 	}
 
 private:
@@ -57,8 +58,13 @@ private:
 	{
 	public:
 		U32 m_tileSize = 0;
-		Array<RenderTargetDescription, GBUFFER_COLOR_ATTACHMENT_COUNT> m_colorRtDescrs;
-		RenderTargetDescription m_depthRtDescr;
+
+		/// The G-buffer of a probe may be built in more than one frames so the textures are persistent.
+		Array<TexturePtr, GBUFFER_COLOR_ATTACHMENT_COUNT> m_colorTexs;
+		TexturePtr m_depthTex;
+		Bool m_texsImportedOnce = false;
+		U64 m_probeUuid = 0; ///< The probe whose faces live in the textures.
+
 		FramebufferDescription m_fbDescr;
 	} m_gbuffer; ///< G-buffer pass.
 
@@ -67,7 +73,7 @@ private:
 	public:
 		U32 m_tileSize = 0;
 		U32 m_mipCount = 0;
-		TexturePtr m_cubeArr;
+		TexturePtr m_cubeArr; ///< The probes. If the compression is enabled it's BC6H.
 
 		TraditionalDeferredLightShading m_deferred;
 
@@ -93,6 +99,20 @@ private:
 		ShaderProgramPtr m_grProg;
 	} m_irradianceToRefl; ///< Apply irradiance back to the reflection.
 
+	class
+	{
+	public:
+		/// The probe that is updated is rendered here and then it's compressed to m_lightShading.m_cubeArr.
+		TexturePtr m_workCube;
+		Bool m_workCubeImportedOnce = false;
+
+		ShaderProgramResourcePtr m_prog;
+		ShaderProgramPtr m_grProg;
+		BufferPtr m_blocksBuff; ///< The BC6H blocks of all the mips of the 6 faces.
+
+		Bool m_enabled = false;
+	} m_compression; ///< BC6H compression of the probes.
+
 	class
 	{
 	public:
@@ -106,6 +126,8 @@ private:
 	public:
 		U64 m_uuid; ///< Probe UUID.
 		Timestamp m_lastUsedTimestamp = 0; ///< When it was last seen by the renderer.
+		Timestamp m_requestTimestamp = 0; ///< When the probe asked for an update.
+		U32 m_renderedFaceCount = 0; ///< The probe is ready to be used when all 6 faces got rendered.
 
 		Array<FramebufferDescription, 6> m_lightShadingFbDescrs;
 	};
@@ -113,6 +135,34 @@ private:
 	DynamicArray<CacheEntry> m_cacheEntries;
 	HashMap<U64, U32> m_probeUuidToCacheEntryIdx;
 
+	/// @name Update scheduling
+	/// @{
+
+	/// The GPU time of the G-buffer pass of a past frame.
+	class GBufferPassTiming
+	{
+	public:
+		TimestampQueryPtr m_begin;
+		TimestampQueryPtr m_end;
+		U32 m_drawcallCount = 0;
+	};
+
+	U64 m_probeToUpdateUuid = 0; ///< The probe the scene gathers renderables for.
+	Second m_updateBudget = 0.0; ///< The GPU time of the probe updates per frame. Zero renders all faces at once.
+	Array<GBufferPassTiming, MAX_FRAMES_IN_FLIGHT + 1> m_gbufferPassTimings;
+	Second m_gpuTimePerDrawcall = 0.0; ///< Running average. Used to estimate the cost of a face.
+
+	/// Probes that cover more of the screen and waited longer are updated first.
+	F32 computeUpdatePriority(
+		const ReflectionProbeQueueElement& probe, const CacheEntry& entry, const Vec4& cameraPos) const;
+
+	/// Chose the faces of the probe that fit in the budget of this frame.
+	U32 computeFaceCountToRender(const ReflectionProbeQueueElement& probe, U32 firstFace) const;
+
+	/// Read the GPU time of the G-buffer pass of an old frame and update the running average.
+	void gatherGBufferPassTiming();
+	/// @}
+
 	// Other
 	TextureResourcePtr m_integrationLut;
 	SamplerPtr m_integrationLutSampler;
@@ -122,10 +172,15 @@ private:
 	public:
 		const ReflectionProbeQueueElement* m_probe = nullptr;
 		U32 m_cacheEntryIdx = MAX_U32;
+		U32 m_firstFace = 0; ///< The first face to render this frame.
+		U32 m_faceCount = 0; ///< The faces to render this frame.
+		Bool m_lastFaces = false; ///< This frame completes the probe.
 
 		Array<RenderTargetHandle, GBUFFER_COLOR_ATTACHMENT_COUNT> m_gbufferColorRts;
 		RenderTargetHandle m_gbufferDepthRt;
 		RenderTargetHandle m_lightShadingRt;
+		RenderTargetHandle m_reflectionRt; ///< Same as m_lightShadingRt if the compression is disabled.
+		RenderPassBufferHandle m_compressedBlocksBuffHandle;
 		RenderPassBufferHandle m_irradianceDiceValuesBuffHandle;
 		RenderTargetHandle m_shadowMapRt;
 
@@ -139,12 +194,22 @@ private:
 	ANKI_USE_RESULT Error initIrradiance(const ConfigSet& cfg);
 	ANKI_USE_RESULT Error initIrradianceToRefl(const ConfigSet& cfg);
 	ANKI_USE_RESULT Error initShadowMapping(const ConfigSet& cfg);
+	ANKI_USE_RESULT Error initCompression(const ConfigSet& cfg);
+
+	/// The layer of the light shading RT that the probe that is updated renders to.
+	U32 getLightShadingLayer(U32 cacheEntryIdx) const
+	{
+		return (m_compression.m_enabled) ? 0 : cacheEntryIdx;
+	}
 
 	/// Lazily init the cache entry
 	void initCacheEntry(U32 cacheEntryIdx);
 
-	void prepareProbes(
-		RenderingContext& ctx, ReflectionProbeQueueElement*& probeToUpdate, U32& probeToUpdateCacheEntryIdx);
+	void prepareProbes(RenderingContext& ctx,
+		ReflectionProbeQueueElement*& probeToUpdate,
+		U32& probeToUpdateCacheEntryIdx,
+		U32& firstFace,
+		U32& faceCount);
 
 	void runGBuffer(RenderPassWorkContext& rgraphCtx);
 	void runShadowMapping(RenderPassWorkContext& rgraphCtx);
@@ -152,6 +217,8 @@ private:
 	void runMipmappingOfLightShading(U32 faceIdx, RenderPassWorkContext& rgraphCtx);
 	void runIrradiance(RenderPassWorkContext& rgraphCtx);
 	void runIrradianceToRefl(RenderPassWorkContext& rgraphCtx);
+	void runCompression(RenderPassWorkContext& rgraphCtx);
+	void runCompressionCopy(RenderPassWorkContext& rgraphCtx);
 
 	// A RenderPassWorkCallback for the light shading pass into a single face.
 	template<U faceIdx>
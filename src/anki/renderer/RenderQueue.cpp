@@ -4,6 +4,7 @@
 // http://www.anki3d.org/LICENSE
 
 #include <anki/renderer/RenderQueue.h>
+#include <anki/collision/Functions.h>
 
 namespace anki
 {
@@ -48,4 +49,15 @@ PtrSize RenderQueue::countAllRenderables() const
 	return drawableCount;
 }
 
+void RenderQueue::lateLatchCameraTransform(const Transform& cameraTransform)
+{
+	m_cameraTransform = Mat4(cameraTransform);
+	m_viewMatrix = Mat4(cameraTransform.getInverse());
+	m_viewProjectionMatrix = m_projectionMatrix * m_viewMatrix;
+
+	// The projection didn't change so the unprojection parameters stay the same
+	m_frustumData.m_invViewProjectionMatrix = m_viewProjectionMatrix.getInverse();
+	extractClipPlane(m_viewProjectionMatrix, FrustumPlaneType::NEAR, m_frustumData.m_nearPlane);
+}
+
 } // end namespace anki
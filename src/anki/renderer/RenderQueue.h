@@ -8,6 +8,7 @@
 #include <anki/renderer/Common.h>
 #include <anki/resource/RenderingKey.h>
 #include <anki/ui/Canvas.h>
+#include <anki/collision/Plane.h>
 #include <shaders/glsl_cpp_common/ClusteredShading.h>
 
 namespace anki
@@ -26,12 +27,31 @@ public:
 	Mat4 m_previousViewProjectionMatrix;
 };
 
+/// Values derived from the matrices of a frustum. The FrustumComponent computes them when the frustum changes so the
+/// renderer stages that need them don't have to.
+class RenderQueueFrustumData
+{
+public:
+	Mat4 m_invViewProjectionMatrix;
+	Vec4 m_unprojectionParameters; ///< See Mat4::extractPerspectiveUnprojectionParams. Zero if it's not perspective.
+	Plane m_nearPlane; ///< The near plane in world space.
+};
+
 /// Some options that can be used as hints in debug drawcalls.
 enum class RenderQueueDebugDrawFlag : U32
 {
 	DEPTH_TEST_ON,
 	DITHERED_DEPTH_TEST_ON,
-	COUNT
+
+	// The categories of the debug primitives. The debug drawcalls of a disabled category draw nothing.
+	RENDERABLES, ///< The bounding volumes of the renderables.
+	LIGHTS,
+	DECALS,
+	PROBES, ///< Reflection and GI probes.
+	PHYSICS, ///< The physics world.
+
+	COUNT,
+	FIRST_CATEGORY = RENDERABLES
 };
 
 /// Context that contains variables for drawing and will be passed to RenderQueueDrawCallback.
@@ -45,6 +65,17 @@ public:
 	StackAllocator<U8> m_frameAllocator;
 	Bool m_debugDraw; ///< If true the drawcall should be drawing some kind of debug mesh.
 	BitSet<U(RenderQueueDebugDrawFlag::COUNT), U32> m_debugDrawFlags = {false};
+
+	/// If it's not nullptr the callback should write the arguments of its drawcall there and draw with
+	/// CommandBuffer::drawElementsIndirect() using m_indirectArgsBuffer at m_indirectArgsBufferOffset. The GPU might
+	/// cull the drawcall by zeroing its instance count.
+	DrawElementsIndirectInfo* m_indirectArgs = nullptr;
+	BufferPtr m_indirectArgsBuffer;
+	PtrSize m_indirectArgsBufferOffset = 0;
+
+	/// If true the LODs of the elements were picked by the visibility of the main camera and the callback should
+	/// cross-fade the instances that are changing LOD.
+	Bool m_lodCrossFade = false;
 };
 
 /// Draw callback for drawing.
@@ -63,6 +94,16 @@ public:
 
 	F32 m_distanceFromCamera; ///< Don't set this
 
+	/// The world space bounds. Used by the GPU occlusion culling. Don't set this
+	Vec3 m_aabbMin;
+	Vec3 m_aabbMax;
+
+	/// The LOD picked by the visibility tests. If it's MAX_U8 the renderer picks it from the distance. Don't set this
+	U8 m_lod;
+
+	/// The node hasn't been updated for a few frames. The shadows cache the static casters. Don't set this
+	Bool m_staticShadowCaster;
+
 	RenderableQueueElement()
 	{
 	}
@@ -77,11 +118,15 @@ class GenericGpuComputeJobQueueElementContext final : public RenderingMatrices
 public:
 	CommandBufferPtr m_commandBuffer;
 	StagingGpuMemoryManager* m_stagingGpuAllocator ANKI_DEBUG_CODE(= nullptr);
+
+	/// The jobs run on the async compute queue. They can't set barriers for the graphics stages. The render graph
+	/// syncs them with the passes that consume their results.
+	Bool m_asyncCompute = false;
 };
 
 /// Callback for GenericGpuComputeJobQueueElement.
 using GenericGpuComputeJobQueueElementCallback = void (*)(
-	GenericGpuComputeJobQueueElementContext& ctx, const void* userData);
+	GenericGpuComputeJobQueueElementContext& ctx, ConstWeakArray<void*> userData);
 
 /// It has enough info to execute generic compute on the GPU.
 class GenericGpuComputeJobQueueElement final
@@ -90,6 +135,13 @@ public:
 	GenericGpuComputeJobQueueElementCallback m_callback;
 	const void* m_userData;
 
+	/// Elements with the same m_mergeKey and same m_callback will be merged and the m_callback will be called once for
+	/// all of them. Unless m_mergeKey is zero.
+	U64 m_mergeKey;
+
+	/// The job can run on the async compute queue. See GenericGpuComputeJobQueueElementContext::m_asyncCompute.
+	Bool m_asyncCompute;
+
 	GenericGpuComputeJobQueueElement()
 	{
 	}
@@ -98,6 +150,27 @@ public:
 static_assert(std::is_trivially_destructible<GenericGpuComputeJobQueueElement>::value == true,
 	"Should be trivially destructible");
 
+/// It has enough info to evaluate the animation and the bone transforms of a skeleton on the GPU.
+class GpuSkinningQueueElement final
+{
+public:
+	const Buffer* m_bonesBuffer; ///< See SkeletonResource::getGpuBonesBuffer.
+	const AnimationGpuKeyframes* m_keyframes; ///< It's nullptr if there is no animation playing.
+	const U32* m_boneChannels; ///< The animation channel of every bone. It's MAX_U32 for the bones not animated.
+	U32 m_boneCount;
+	F32 m_animationTime;
+
+	/// The renderer will set it to the location of the bone transforms that the vertex shaders will read.
+	StagingGpuMemoryToken* m_boneTransformsToken;
+
+	GpuSkinningQueueElement()
+	{
+	}
+};
+
+static_assert(
+	std::is_trivially_destructible<GpuSkinningQueueElement>::value == true, "Should be trivially destructible");
+
 /// Point light render queue element.
 class PointLightQueueElement final
 {
@@ -364,16 +437,25 @@ public:
 	WeakArray<FogDensityQueueElement> m_fogDensityVolumes;
 	WeakArray<UiQueueElement> m_uis;
 	WeakArray<GenericGpuComputeJobQueueElement> m_genericGpuComputeJobs;
+	WeakArray<GpuSkinningQueueElement> m_gpuSkinningJobs; ///< All the GPU skins of the scene, not only the visible.
 
-	/// Applies only if the RenderQueue holds shadow casters. It's the max timesamp of all shadow casters
+	/// Applies only if the RenderQueue holds shadow casters. It's the max timesamp of all shadow casters and of the
+	/// last time the list of casters changed.
 	Timestamp m_shadowRenderablesLastUpdateTimestamp = 0;
 
+	/// Applies only if the RenderQueue holds shadow casters. The first m_staticShadowRenderableCount of the
+	/// m_renderables are the static casters and m_staticShadowRenderablesLastUpdateTimestamp is their max timestamp.
+	U32 m_staticShadowRenderableCount = 0;
+	Timestamp m_staticShadowRenderablesLastUpdateTimestamp = 0;
+
 	F32 m_cameraNear;
 	F32 m_cameraFar;
 	F32 m_cameraFovX;
 	F32 m_cameraFovY;
 	F32 m_effectiveShadowDistance;
 
+	RenderQueueFrustumData m_frustumData;
+
 	FillCoverageBufferCallback m_fillCoverageBufferCallback = nullptr;
 	void* m_fillCoverageBufferCallbackUserData = nullptr;
 
@@ -383,6 +465,10 @@ public:
 	}
 
 	PtrSize countAllRenderables() const;
+
+	/// Move the camera after the visibility tests. The view matrices and the m_frustumData follow it. The visibility
+	/// tests used the old camera so only small changes are safe.
+	void lateLatchCameraTransform(const Transform& cameraTransform);
 };
 
 static_assert(std::is_trivially_destructible<RenderQueue>::value == true, "Should be trivially destructible");
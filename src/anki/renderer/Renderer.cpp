@@ -8,6 +8,7 @@
 #include <anki/util/Tracer.h>
 #include <anki/core/ConfigSet.h>
 #include <anki/util/HighRezTimer.h>
+#include <anki/util/ThreadHive.h>
 #include <anki/collision/Aabb.h>
 
 #include <anki/renderer/ProbeReflections.h>
@@ -31,11 +32,55 @@
 #include <anki/renderer/VolumetricLightingAccumulation.h>
 #include <anki/renderer/GlobalIllumination.h>
 #include <anki/renderer/GenericCompute.h>
+#include <anki/renderer/GpuOcclusionCulling.h>
+#include <anki/renderer/GpuSkinning.h>
+#include <anki/renderer/GpuClusterBin.h>
+#include <anki/renderer/VrsSriGeneration.h>
+#include <anki/renderer/DecalAtlas.h>
 #include <shaders/glsl_cpp_common/ClusteredShading.h>
 
 namespace anki
 {
 
+/// The shader programs the stages load in their init. Some are alternatives picked by the config, the unused ones are
+/// released after the init.
+static const Array<CString, 34> PRELOADED_SHADER_PROGRAMS = {{
+	"shaders/ApplyIrradianceToReflection.ankiprog",
+	"shaders/Bloom.ankiprog",
+	"shaders/BloomUpscale.ankiprog",
+	"shaders/ClearTextureCompute.ankiprog",
+	"shaders/DecalAtlasUpload.ankiprog",
+	"shaders/DepthAwareBlurCompute.ankiprog",
+	"shaders/DepthDownscale.ankiprog",
+	"shaders/DownscaleBlur.ankiprog",
+	"shaders/DownscaleBlurCompute.ankiprog",
+	"shaders/ExponentialShadowmappingResolve.ankiprog",
+	"shaders/FinalComposite.ankiprog",
+	"shaders/GBufferPost.ankiprog",
+	"shaders/GaussianBlur.ankiprog",
+	"shaders/GaussianBlurCompute.ankiprog",
+	"shaders/GiVolumeTransfer.ankiprog",
+	"shaders/GpuClusterBin.ankiprog",
+	"shaders/GpuOcclusionCulling.ankiprog",
+	"shaders/GpuSkinning.ankiprog",
+	"shaders/IrradianceDice.ankiprog",
+	"shaders/LensFlareSprite.ankiprog",
+	"shaders/LensFlareVisibility.ankiprog",
+	"shaders/LightShading.ankiprog",
+	"shaders/LightShadingApplyFog.ankiprog",
+	"shaders/LightShadingTileClassification.ankiprog",
+	"shaders/Ssao.ankiprog",
+	"shaders/SsaoCompute.ankiprog",
+	"shaders/SsaoTemporal.ankiprog",
+	"shaders/Ssr.ankiprog",
+	"shaders/TemporalAAResolve.ankiprog",
+	"shaders/TonemappingAverageLuminance.ankiprog",
+	"shaders/TraditionalDeferredShading.ankiprog",
+	"shaders/VolumetricFogAccumulation.ankiprog",
+	"shaders/VolumetricLightingAccumulation.ankiprog",
+	"shaders/VrsSriGeneration.ankiprog",
+}};
+
 Renderer::Renderer()
 	: m_sceneDrawer(this)
 {
@@ -76,13 +121,15 @@ Error Renderer::init(ThreadHive* hive,
 Error Renderer::initInternal(const ConfigSet& config)
 {
 	// Set from the config
+	m_configVersion = config.getVersion();
 	m_width = config.getNumberU32("width");
 	m_height = config.getNumberU32("height");
 	ANKI_R_LOGI("Initializing offscreen renderer. Size %ux%u", m_width, m_height);
 
-	ANKI_ASSERT(m_lodDistances.getSize() == 2);
+	ANKI_ASSERT(m_lodDistances.getSize() == 3);
 	m_lodDistances[0] = config.getNumberF32("r_lodDistance0");
 	m_lodDistances[1] = config.getNumberF32("r_lodDistance1");
+	m_lodDistances[2] = config.getNumberF32("r_lodDistance2");
 	m_frameCount = 0;
 
 	m_clusterCount[0] = config.getNumberU32("r_clusterSizeX");
@@ -92,6 +139,8 @@ Error Renderer::initInternal(const ConfigSet& config)
 
 	m_clusterBin.init(m_alloc, m_clusterCount[0], m_clusterCount[1], m_clusterCount[2], config);
 
+	m_temporalUpscaling = config.getBool("r_temporalUpscaling");
+
 	// A few sanity checks
 	if(m_width < 10 || m_height < 10)
 	{
@@ -120,6 +169,10 @@ Error Renderer::initInternal(const ConfigSet& config)
 	m_dummyBuff = getGrManager().newBuffer(BufferInitInfo(
 		1024, BufferUsageBit::UNIFORM_ALL | BufferUsageBit::STORAGE_ALL, BufferMapAccessBit::NONE, "Dummy"));
 
+	// Load the programs of the stages in parallel, the stages will only take a reference
+	DynamicArrayAuto<ShaderProgramResourcePtr> preloadedProgs(m_alloc);
+	preloadShaderPrograms(preloadedProgs);
+
 	ANKI_CHECK(m_resources->loadResource("shaders/ClearTextureCompute.ankiprog", m_clearTexComputeProg));
 
 	// Init the stages. Careful with the order!!!!!!!!!!
@@ -135,24 +188,85 @@ Error Renderer::initInternal(const ConfigSet& config)
 	m_probeReflections.reset(m_alloc.newInstance<ProbeReflections>(this));
 	ANKI_CHECK(m_probeReflections->init(config));
 
-	m_gbuffer.reset(m_alloc.newInstance<GBuffer>(this));
-	ANKI_CHECK(m_gbuffer->init(config));
-
-	m_gbufferPost.reset(m_alloc.newInstance<GBufferPost>(this));
-	ANKI_CHECK(m_gbufferPost->init(config));
-
 	m_shadowMapping.reset(m_alloc.newInstance<ShadowMapping>(this));
 	ANKI_CHECK(m_shadowMapping->init(config));
 
 	m_volFog.reset(m_alloc.newInstance<VolumetricFog>(this));
 	ANKI_CHECK(m_volFog->init(config));
 
+	m_gpuSkinning.reset(m_alloc.newInstance<GpuSkinning>(this));
+	ANKI_CHECK(m_gpuSkinning->init(config));
+
+	m_gpuClusterBin.reset(m_alloc.newInstance<GpuClusterBin>(this));
+	ANKI_CHECK(m_gpuClusterBin->init(config));
+
+	m_decalAtlas.reset(m_alloc.newInstance<DecalAtlas>(this));
+	ANKI_CHECK(m_decalAtlas->init(config));
+
+	ANKI_CHECK(initSizeDependentStages(config));
+
+	// Init samplers
+	{
+		SamplerInitInfo sinit("Renderer");
+		sinit.m_addressing = SamplingAddressing::CLAMP;
+		sinit.m_mipmapFilter = SamplingFilter::NEAREST;
+		sinit.m_minMagFilter = SamplingFilter::NEAREST;
+		m_samplers.m_nearestNearestClamp = m_gr->newSampler(sinit);
+
+		sinit.m_minMagFilter = SamplingFilter::LINEAR;
+		sinit.m_mipmapFilter = SamplingFilter::LINEAR;
+		m_samplers.m_trilinearClamp = m_gr->newSampler(sinit);
+
+		sinit.m_addressing = SamplingAddressing::REPEAT;
+		m_samplers.m_trilinearRepeat = m_gr->newSampler(sinit);
+
+		m_textureAnisotropy = U8(config.getNumberU32("r_textureAnisotropy"));
+		sinit.m_anisotropyLevel = m_textureAnisotropy;
+		m_samplers.m_trilinearRepeatAniso = m_gr->newSampler(sinit);
+		m_samplers.m_trilinearRepeatAnisoResolutionScalingBias = m_samplers.m_trilinearRepeatAniso;
+	}
+
+	initJitteredMats();
+
+	return Error::NONE;
+}
+
+void Renderer::preloadShaderPrograms(DynamicArrayAuto<ShaderProgramResourcePtr>& progs)
+{
+	ANKI_TRACE_SCOPED_EVENT(R_PRELOAD_PROGRAMS);
+
+	progs.create(PRELOADED_SHADER_PROGRAMS.getSize());
+	m_threadHive->parallelFor(PRELOADED_SHADER_PROGRAMS.getSize(), 1, [&](U32 begin, U32 end, U32 threadId) {
+		for(U32 i = begin; i < end; ++i)
+		{
+			// Ignore the errors. The stage that loads it again will report them
+			const Error err = m_resources->loadResource(PRELOADED_SHADER_PROGRAMS[i], progs[i]);
+			(void)err;
+		}
+	});
+}
+
+Error Renderer::initSizeDependentStages(const ConfigSet& config)
+{
+	// Careful with the order!!!!!!!!!!
+	m_vrsSriGeneration.reset(m_alloc.newInstance<VrsSriGeneration>(this));
+	ANKI_CHECK(m_vrsSriGeneration->init(config));
+
+	m_gbuffer.reset(m_alloc.newInstance<GBuffer>(this));
+	ANKI_CHECK(m_gbuffer->init(config));
+
+	m_gbufferPost.reset(m_alloc.newInstance<GBufferPost>(this));
+	ANKI_CHECK(m_gbufferPost->init(config));
+
 	m_lightShading.reset(m_alloc.newInstance<LightShading>(this));
 	ANKI_CHECK(m_lightShading->init(config));
 
 	m_depth.reset(m_alloc.newInstance<DepthDownscale>(this));
 	ANKI_CHECK(m_depth->init(config));
 
+	m_gpuOcclusionCulling.reset(m_alloc.newInstance<GpuOcclusionCulling>(this));
+	ANKI_CHECK(m_gpuOcclusionCulling->init(config));
+
 	m_forwardShading.reset(m_alloc.newInstance<ForwardShading>(this));
 	ANKI_CHECK(m_forwardShading->init(config));
 
@@ -186,30 +300,90 @@ Error Renderer::initInternal(const ConfigSet& config)
 	m_uiStage.reset(m_alloc.newInstance<UiStage>(this));
 	ANKI_CHECK(m_uiStage->init(config));
 
-	// Init samplers
-	{
-		SamplerInitInfo sinit("Renderer");
-		sinit.m_addressing = SamplingAddressing::CLAMP;
-		sinit.m_mipmapFilter = SamplingFilter::NEAREST;
-		sinit.m_minMagFilter = SamplingFilter::NEAREST;
-		m_samplers.m_nearestNearestClamp = m_gr->newSampler(sinit);
+	return Error::NONE;
+}
 
-		sinit.m_minMagFilter = SamplingFilter::LINEAR;
-		sinit.m_mipmapFilter = SamplingFilter::LINEAR;
-		m_samplers.m_trilinearClamp = m_gr->newSampler(sinit);
+Error Renderer::resize(const ConfigSet& config)
+{
+	ANKI_TRACE_SCOPED_EVENT(R_INIT);
 
-		sinit.m_addressing = SamplingAddressing::REPEAT;
-		m_samplers.m_trilinearRepeat = m_gr->newSampler(sinit);
+	const U32 width = config.getNumberU32("width");
+	const U32 height = config.getNumberU32("height");
+	if(width < 10 || height < 10)
+	{
+		ANKI_R_LOGE("Incorrect sizes");
+		return Error::USER_DATA;
+	}
 
-		sinit.m_anisotropyLevel = U8(config.getNumberU32("r_textureAnisotropy"));
-		m_samplers.m_trilinearRepeatAniso = m_gr->newSampler(sinit);
+	if(width == m_width && height == m_height)
+	{
+		return Error::NONE;
 	}
 
+	ANKI_R_LOGI("Resizing offscreen renderer. Size %ux%u", width, height);
+	m_width = width;
+	m_height = height;
+
+	// The debug stage holds some user state. Carry it over
+	const Bool dbgEnabled = m_dbg->getEnabled();
+	const Bool dbgDepthTest = m_dbg->getDepthTestEnabled();
+	const Bool dbgDitheredDepthTest = m_dbg->getDitheredDepthTestEnabled();
+
+	// The old render targets are referenced by the command buffers in flight so they will live long enough
+	ANKI_CHECK(initSizeDependentStages(config));
+
+	m_dbg->setEnabled(dbgEnabled);
+	m_dbg->setDepthTestEnabled(dbgDepthTest);
+	m_dbg->setDitheredDepthTestEnabled(dbgDitheredDepthTest);
+
+	// The jitter is in NDC so it depends on the size
 	initJitteredMats();
 
 	return Error::NONE;
 }
 
+Error Renderer::applyConfig(const ConfigSet& config)
+{
+	auto changed = [&](ConfigOption option) { return config.hasChangedSince(option, m_configVersion); };
+
+	m_lodDistances[0] = config.getNumberF32(ConfigOption::r_lodDistance0);
+	m_lodDistances[1] = config.getNumberF32(ConfigOption::r_lodDistance1);
+	m_lodDistances[2] = config.getNumberF32(ConfigOption::r_lodDistance2);
+
+	// The atlas and the scratch buffer need new textures
+	if(changed(ConfigOption::r_shadowMappingTileResolution)
+		|| changed(ConfigOption::r_shadowMappingTileCountPerRowOrColumn)
+		|| changed(ConfigOption::r_shadowMappingScratchTileCountX)
+		|| changed(ConfigOption::r_shadowMappingScratchTileCountY)
+		|| changed(ConfigOption::r_shadowMappingStaticCasterCaching))
+	{
+		ANKI_R_LOGI("Re-creating the shadowmapping because its options changed");
+		m_shadowMapping.reset(m_alloc.newInstance<ShadowMapping>(this));
+		ANKI_CHECK(m_shadowMapping->init(config));
+	}
+	else
+	{
+		m_shadowMapping->applyConfig(config);
+	}
+
+	// The HiZ tracing is a different program, the rest are uniforms
+	if(changed(ConfigOption::r_ssrHiZ))
+	{
+		ANKI_R_LOGI("Re-creating the SSR because its options changed");
+		m_ssr.reset(m_alloc.newInstance<Ssr>(this));
+		ANKI_CHECK(m_ssr->init(config));
+	}
+	else
+	{
+		m_ssr->applyConfig(config);
+	}
+
+	m_tonemapping->applyConfig(config);
+
+	m_configVersion = config.getVersion();
+	return Error::NONE;
+}
+
 void Renderer::initJitteredMats()
 {
 	static const Array<Vec2, 16> SAMPLE_LOCS_16 = {{Vec2(-8.0, 0.0),
@@ -267,6 +441,31 @@ void Renderer::initJitteredMats()
 	}
 }
 
+void Renderer::updateSceneTextureSampler(const RenderingContext& ctx)
+{
+	// Sample the scene textures at the mip level of the output resolution else the upscaled image will be blurry
+	F32 lodBias = 0.0f;
+	if(m_temporalUpscaling && ctx.m_outRenderTargetWidth > m_width)
+	{
+		lodBias = log2(F32(m_width) / F32(ctx.m_outRenderTargetWidth));
+	}
+
+	if(lodBias == m_sceneTextureLodBias)
+	{
+		return;
+	}
+
+	m_sceneTextureLodBias = lodBias;
+
+	SamplerInitInfo sinit("RendererScene");
+	sinit.m_minMagFilter = SamplingFilter::LINEAR;
+	sinit.m_mipmapFilter = SamplingFilter::LINEAR;
+	sinit.m_addressing = SamplingAddressing::REPEAT;
+	sinit.m_anisotropyLevel = m_textureAnisotropy;
+	sinit.m_lodBias = lodBias;
+	m_samplers.m_trilinearRepeatAnisoResolutionScalingBias = m_gr->newSampler(sinit);
+}
+
 Error Renderer::populateRenderGraph(RenderingContext& ctx)
 {
 	ctx.m_matrices.m_cameraTransform = ctx.m_renderQueue->m_cameraTransform;
@@ -280,7 +479,7 @@ Error Renderer::populateRenderGraph(RenderingContext& ctx)
 
 	ctx.m_prevMatrices = m_prevMatrices;
 
-	ctx.m_unprojParams = ctx.m_renderQueue->m_projectionMatrix.extractPerspectiveUnprojectionParams();
+	ctx.m_unprojParams = ctx.m_renderQueue->m_frustumData.m_unprojectionParameters;
 
 	// Check if resources got loaded
 	if(m_prevLoadRequestCount != m_resources->getLoadingRequestCount()
@@ -295,18 +494,25 @@ Error Renderer::populateRenderGraph(RenderingContext& ctx)
 		m_resourcesDirty = false;
 	}
 
+	updateSceneTextureSampler(ctx);
+
 	// Import RTs first
 	m_downscale->importRenderTargets(ctx);
 	m_tonemapping->importRenderTargets(ctx);
 	m_depth->importRenderTargets(ctx);
+	m_vrsSriGeneration->importRenderTargets(ctx);
 
 	// Populate render graph. WARNING Watch the order
+	m_gpuSkinning->populateRenderGraph(ctx);
+	m_gpuClusterBin->populateRenderGraph(ctx);
 	m_genericCompute->populateRenderGraph(ctx);
 	m_shadowMapping->populateRenderGraph(ctx);
 	m_gi->populateRenderGraph(ctx);
 	m_probeReflections->populateRenderGraph(ctx);
 	m_volLighting->populateRenderGraph(ctx);
+	m_gpuOcclusionCulling->populateRenderGraph(ctx);
 	m_gbuffer->populateRenderGraph(ctx);
+	m_decalAtlas->populateRenderGraph(ctx);
 	m_gbufferPost->populateRenderGraph(ctx);
 	m_depth->populateRenderGraph(ctx);
 	m_volFog->populateRenderGraph(ctx);
@@ -315,6 +521,7 @@ Error Renderer::populateRenderGraph(RenderingContext& ctx)
 	m_ssr->populateRenderGraph(ctx);
 	m_lightShading->populateRenderGraph(ctx);
 	m_temporalAA->populateRenderGraph(ctx);
+	m_vrsSriGeneration->populateRenderGraph(ctx);
 	m_downscale->populateRenderGraph(ctx);
 	m_tonemapping->populateRenderGraph(ctx);
 	m_bloom->populateRenderGraph(ctx);
@@ -334,6 +541,7 @@ Error Renderer::populateRenderGraph(RenderingContext& ctx)
 	cin.m_shadowsEnabled = true; // TODO
 	cin.m_stagingMem = m_stagingMem;
 	cin.m_threadHive = m_threadHive;
+	cin.m_decalAtlasUvs = m_decalAtlas->getDecalUvs();
 	m_clusterBin.bin(cin, ctx.m_clusterBinOut);
 
 	ctx.m_prevClustererMagicValues =
@@ -559,7 +767,7 @@ void Renderer::updateLightShadingUniforms(RenderingContext& ctx) const
 
 	// Matrices
 	blk->m_viewMat = ctx.m_renderQueue->m_viewMatrix;
-	blk->m_invViewMat = ctx.m_renderQueue->m_viewMatrix.getInverse();
+	blk->m_invViewMat = ctx.m_renderQueue->m_cameraTransform;
 
 	blk->m_projMat = ctx.m_matrices.m_projectionJitter;
 	blk->m_invProjMat = ctx.m_matrices.m_projectionJitter.getInverse();
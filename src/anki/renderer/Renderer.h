@@ -85,6 +85,9 @@ public:
 	SamplerPtr m_trilinearClamp;
 	SamplerPtr m_trilinearRepeat;
 	SamplerPtr m_trilinearRepeatAniso;
+	/// Same as m_trilinearRepeatAniso but with a negative LOD bias when the scene is rendered at a lower resolution and
+	/// TAA upscales it. For the textures of the scene.
+	SamplerPtr m_trilinearRepeatAnisoResolutionScalingBias;
 };
 
 /// Offscreen renderer.
@@ -170,6 +173,36 @@ public:
 		return *m_downscale;
 	}
 
+	GpuOcclusionCulling& getGpuOcclusionCulling()
+	{
+		return *m_gpuOcclusionCulling;
+	}
+
+	GpuSkinning& getGpuSkinning()
+	{
+		return *m_gpuSkinning;
+	}
+
+	GenericCompute& getGenericCompute()
+	{
+		return *m_genericCompute;
+	}
+
+	GpuClusterBin& getGpuClusterBin()
+	{
+		return *m_gpuClusterBin;
+	}
+
+	VrsSriGeneration& getVrsSriGeneration()
+	{
+		return *m_vrsSriGeneration;
+	}
+
+	DecalAtlas& getDecalAtlas()
+	{
+		return *m_decalAtlas;
+	}
+
 	LensFlare& getLensFlare()
 	{
 		return *m_lensFlare;
@@ -220,6 +253,14 @@ public:
 		const ConfigSet& config,
 		Timestamp* globTimestamp);
 
+	/// Change the rendering size. It re-creates the stages that depend on it. The rest keep their state.
+	/// @param config Holds the new "width" and "height".
+	ANKI_USE_RESULT Error resize(const ConfigSet& config);
+
+	/// Apply the options that changed since the last call. Only the resources that depend on them are re-created.
+	/// @note The size-related options are ignored, use resize() for them.
+	ANKI_USE_RESULT Error applyConfig(const ConfigSet& config);
+
 	/// This function does all the rendering stages and produces a final result.
 	ANKI_USE_RESULT Error populateRenderGraph(RenderingContext& ctx);
 
@@ -240,6 +281,12 @@ public:
 		return m_frameCount;
 	}
 
+	/// If true TAA reconstructs the image at the size of the output render target.
+	Bool getTemporalUpscalingEnabled() const
+	{
+		return m_temporalUpscaling;
+	}
+
 	const RenderableDrawer& getSceneDrawer() const
 	{
 		return m_sceneDrawer;
@@ -256,22 +303,17 @@ public:
 		return *m_ui;
 	}
 
-	/// Get the LOD given the distance of an object from the camera
+	/// Get the LOD given the distance of an object from the camera. The visibility of the main camera picks the LODs of
+	/// its renderables from their projected size, this is for the rest.
 	U32 calculateLod(F32 distance) const
 	{
-		ANKI_ASSERT(m_lodDistances.getSize() == 2);
-		if(distance < m_lodDistances[0])
-		{
-			return 0;
-		}
-		else if(distance < m_lodDistances[1])
-		{
-			return 1;
-		}
-		else
+		U32 lod = 0;
+		while(lod < m_lodDistances.getSize() && distance >= m_lodDistances[lod])
 		{
-			return 2;
+			++lod;
 		}
+
+		return lod;
 	}
 
 	/// Create the init info for a 2D texture that will be used as a render target.
@@ -391,6 +433,11 @@ private:
 	UniquePtr<Dbg> m_dbg; ///< Debug stage.
 	UniquePtr<UiStage> m_uiStage;
 	UniquePtr<GenericCompute> m_genericCompute;
+	UniquePtr<GpuOcclusionCulling> m_gpuOcclusionCulling;
+	UniquePtr<GpuSkinning> m_gpuSkinning;
+	UniquePtr<GpuClusterBin> m_gpuClusterBin;
+	UniquePtr<VrsSriGeneration> m_vrsSriGeneration;
+	UniquePtr<DecalAtlas> m_decalAtlas;
 	/// @}
 
 	Array<U32, 4> m_clusterCount;
@@ -399,6 +446,8 @@ private:
 	U32 m_width;
 	U32 m_height;
 
+	U64 m_configVersion = 0; ///< The version of the config that was last applied.
+
 	Array<F32, MAX_LOD_COUNT - 1> m_lodDistances; ///< Distance that used to calculate the LOD
 
 	RenderableDrawer m_sceneDrawer;
@@ -420,6 +469,10 @@ private:
 	BufferPtr m_dummyBuff;
 
 	RendererPrecreatedSamplers m_samplers;
+	U8 m_textureAnisotropy = 0;
+	F32 m_sceneTextureLodBias = 0.0f; ///< The LOD bias of m_trilinearRepeatAnisoResolutionScalingBias.
+
+	Bool m_temporalUpscaling = false;
 
 	ShaderProgramResourcePtr m_clearTexComputeProg;
 
@@ -427,9 +480,16 @@ private:
 	Bool m_statsEnabled = false;
 
 	ANKI_USE_RESULT Error initInternal(const ConfigSet& initializer);
+	ANKI_USE_RESULT Error initSizeDependentStages(const ConfigSet& config);
+
+	/// Load the shader programs of the stages in parallel. The stages will find them loaded.
+	void preloadShaderPrograms(DynamicArrayAuto<ShaderProgramResourcePtr>& progs);
 
 	void initJitteredMats();
 
+	/// Re-create the sampler of the scene textures if the LOD bias changed.
+	void updateSceneTextureSampler(const RenderingContext& ctx);
+
 	void updateLightShadingUniforms(RenderingContext& ctx) const;
 };
 /// @}
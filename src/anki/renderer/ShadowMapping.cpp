@@ -6,6 +6,7 @@
 #include <anki/renderer/ShadowMapping.h>
 #include <anki/renderer/Renderer.h>
 #include <anki/renderer/RenderQueue.h>
+#include <anki/renderer/GpuSkinning.h>
 #include <anki/core/ConfigSet.h>
 #include <anki/util/ThreadHive.h>
 #include <anki/util/Tracer.h>
@@ -13,6 +14,10 @@
 namespace anki
 {
 
+/// If the center of a cascade moved more than that from the center of its cached tile (in the UV space of the tile) the
+/// cascade is rendered again. Because the reprojected cascade covers less and less of the view.
+static const F32 CASCADE_MAX_DRIFT = 0.1f;
+
 class ShadowMapping::Scratch::WorkItem
 {
 public:
@@ -28,15 +33,27 @@ class ShadowMapping::Scratch::LightToRenderToScratchInfo
 public:
 	Array<U32, 4> m_viewport;
 	RenderQueue* m_renderQueue;
+	U32 m_firstRenderableElement;
 	U32 m_drawcallCount;
 };
 
+/// What the atlas resolve does with the depth of the static casters. Keep it in sync with the shader.
+enum class StaticDepthMode : U32
+{
+	NONE, ///< The scratch tile has all the casters.
+	READ, ///< The scratch tile has the dynamic casters. Combine it with the cached depth of the static.
+	WRITE ///< The scratch tile has the static casters, cache it. The 2nd scratch tile has the dynamic casters.
+};
+
 class ShadowMapping::Atlas::ResolveWorkItem
 {
 public:
 	Vec4 m_uvIn; ///< UV + size that point to the scratch buffer.
+	Vec4 m_uvIn2; ///< UV + size that point to a 2nd tile of the scratch buffer. Optional.
 	Array<U32, 4> m_viewportOut; ///< Viewport in the atlas RT.
 	Bool m_blur;
+	Bool m_hasSecondInput;
+	StaticDepthMode m_staticDepthMode;
 };
 
 ShadowMapping::~ShadowMapping()
@@ -107,6 +124,17 @@ Error ShadowMapping::initAtlas(const ConfigSet& cfg)
 		ClearValue clearVal;
 		clearVal.m_colorf[0] = 1.0f;
 		m_atlas.m_tex = m_r->createAndClearRenderTarget(texinit, clearVal);
+
+		if(m_staticCasterCaching)
+		{
+			texinit = m_r->create2DRenderTargetInitInfo(m_atlas.m_tileResolution * m_atlas.m_tileCountBothAxis,
+				m_atlas.m_tileResolution * m_atlas.m_tileCountBothAxis,
+				Format::R32_SFLOAT,
+				TextureUsageBit::IMAGE_COMPUTE_READ_WRITE,
+				"SM static depth");
+			texinit.m_initialUsage = TextureUsageBit::IMAGE_COMPUTE_READ_WRITE;
+			m_atlas.m_staticDepthTex = m_r->createAndClearRenderTarget(texinit, clearVal);
+		}
 	}
 
 	// Tiles
@@ -122,6 +150,7 @@ Error ShadowMapping::initAtlas(const ConfigSet& cfg)
 		variantInitInfo.addConstant("INPUT_TEXTURE_SIZE",
 			UVec2(m_scratch.m_tileCountX * m_scratch.m_tileResolution,
 				m_scratch.m_tileCountY * m_scratch.m_tileResolution));
+		variantInitInfo.addMutation("STATIC_CASTER_CACHING", m_staticCasterCaching);
 
 		const ShaderProgramResourceVariant* variant;
 		m_atlas.m_resolveProg->getOrCreateVariant(variantInitInfo, variant);
@@ -133,15 +162,27 @@ Error ShadowMapping::initAtlas(const ConfigSet& cfg)
 
 Error ShadowMapping::initInternal(const ConfigSet& cfg)
 {
+	m_staticCasterCaching = cfg.getBool("r_shadowMappingStaticCasterCaching");
+
 	ANKI_CHECK(initScratch(cfg));
 	ANKI_CHECK(initAtlas(cfg));
 
-	m_lodDistances[0] = cfg.getNumberF32("r_shadowMappingLightLodDistance0");
-	m_lodDistances[1] = cfg.getNumberF32("r_shadowMappingLightLodDistance1");
+	applyConfig(cfg);
 
 	return Error::NONE;
 }
 
+void ShadowMapping::applyConfig(const ConfigSet& cfg)
+{
+	m_lodDistances[0] = cfg.getNumberF32(ConfigOption::r_shadowMappingLightLodDistance0);
+	m_lodDistances[1] = cfg.getNumberF32(ConfigOption::r_shadowMappingLightLodDistance1);
+	m_screenSpaceLod = cfg.getBool(ConfigOption::r_shadowMappingScreenSpaceLod);
+
+	m_farCascadeBudget = cfg.getNumberF64(ConfigOption::r_shadowMappingFarCascadeBudget) / 1000.0;
+	m_fullRateCascadeCount = cfg.getNumberU32(ConfigOption::r_shadowMappingFullRateCascadeCount);
+	m_farCascadeMaxStaleFrames = cfg.getNumberU32(ConfigOption::r_shadowMappingFarCascadeMaxStaleFrames);
+}
+
 void ShadowMapping::runAtlas(RenderPassWorkContext& rgraphCtx)
 {
 	ANKI_ASSERT(m_atlas.m_resolveWorkItems.getSize());
@@ -154,31 +195,55 @@ void ShadowMapping::runAtlas(RenderPassWorkContext& rgraphCtx)
 	cmdb->bindSampler(0, 0, m_r->getSamplers().m_trilinearClamp);
 	rgraphCtx.bindTexture(0, 1, m_scratch.m_rt, TextureSubresourceInfo(DepthStencilAspectBit::DEPTH));
 	rgraphCtx.bindImage(0, 2, m_atlas.m_rt, {});
+	if(m_staticCasterCaching)
+	{
+		rgraphCtx.bindImage(0, 4, m_atlas.m_staticDepthRt, {});
+	}
 
+	// Keep it in sync with the shader
+	struct WorkItem
+	{
+		UVec4 m_viewport;
+		Vec2 m_uvScale;
+		Vec2 m_uvTranslation;
+		Vec2 m_uvScale2;
+		Vec2 m_uvTranslation2;
+		U32 m_blur;
+		U32 m_staticDepthMode;
+		U32 m_hasSecondInput;
+		U32 m_padding0;
+	};
+
+	// Write all the work items to a buffer and resolve them with a single dispatch. The Z of the workgroup is the work
+	// item and the X and Y cover the largest tile
+	const U32 workItemCount = m_atlas.m_resolveWorkItems.getSize();
+	WorkItem* outWorkItems = allocateAndBindStorage<WorkItem*>(sizeof(WorkItem) * workItemCount, cmdb, 0, 3);
+
+	U32 maxWidth = 0;
+	U32 maxHeight = 0;
 	for(const Atlas::ResolveWorkItem& workItem : m_atlas.m_resolveWorkItems)
 	{
-		ANKI_TRACE_INC_COUNTER(R_SHADOW_PASSES, 1);
-
-		struct Uniforms
-		{
-			UVec4 m_viewport;
-			Vec2 m_uvScale;
-			Vec2 m_uvTranslation;
-			U32 m_blur;
-			U32 m_padding0;
-			U32 m_padding1;
-			U32 m_padding2;
-		} unis;
-		unis.m_uvScale = workItem.m_uvIn.zw();
-		unis.m_uvTranslation = workItem.m_uvIn.xy();
-		unis.m_viewport = UVec4(
+		WorkItem& out = *outWorkItems;
+		++outWorkItems;
+
+		out.m_uvScale = workItem.m_uvIn.zw();
+		out.m_uvTranslation = workItem.m_uvIn.xy();
+		out.m_uvScale2 = workItem.m_uvIn2.zw();
+		out.m_uvTranslation2 = workItem.m_uvIn2.xy();
+		out.m_viewport = UVec4(
 			workItem.m_viewportOut[0], workItem.m_viewportOut[1], workItem.m_viewportOut[2], workItem.m_viewportOut[3]);
-		unis.m_blur = workItem.m_blur;
-
-		cmdb->setPushConstants(&unis, sizeof(unis));
+		out.m_blur = workItem.m_blur;
+		out.m_staticDepthMode = U32(workItem.m_staticDepthMode);
+		out.m_hasSecondInput = workItem.m_hasSecondInput;
+		out.m_padding0 = 0;
 
-		dispatchPPCompute(cmdb, 8, 8, workItem.m_viewportOut[2], workItem.m_viewportOut[3]);
+		maxWidth = max(maxWidth, workItem.m_viewportOut[2]);
+		maxHeight = max(maxHeight, workItem.m_viewportOut[3]);
 	}
+
+	ANKI_TRACE_INC_COUNTER(R_SHADOW_PASSES, workItemCount);
+
+	cmdb->dispatchCompute((maxWidth + 8 - 1) / 8, (maxHeight + 8 - 1) / 8, workItemCount);
 }
 
 void ShadowMapping::runShadowMapping(RenderPassWorkContext& rgraphCtx)
@@ -217,6 +282,11 @@ void ShadowMapping::populateRenderGraph(RenderingContext& ctx)
 {
 	ANKI_TRACE_SCOPED_EVENT(R_SM);
 
+	if(m_farCascadeBudget > 0.0)
+	{
+		gatherScratchPassTiming();
+	}
+
 	// First process the lights
 	U32 threadCountForScratchPass = 0;
 	processLights(ctx, threadCountForScratchPass);
@@ -249,6 +319,23 @@ void ShadowMapping::populateRenderGraph(RenderingContext& ctx)
 
 			TextureSubresourceInfo subresource = TextureSubresourceInfo(DepthStencilAspectBit::DEPTH);
 			pass.newDependency({m_scratch.m_rt, TextureUsageBit::FRAMEBUFFER_ATTACHMENT_READ_WRITE, subresource});
+			m_r->getGpuSkinning().setDependencies(pass);
+
+			// Measure the pass to estimate the cost of the cascades
+			if(m_farCascadeBudget > 0.0)
+			{
+				ScratchPassTiming& timing =
+					m_scratchPassTimings[m_r->getFrameCount() % m_scratchPassTimings.getSize()];
+				timing.m_begin = getGrManager().newTimestampQuery();
+				timing.m_end = getGrManager().newTimestampQuery();
+				timing.m_drawcallCount = 0;
+				for(const Scratch::WorkItem& workItem : m_scratch.m_workItems)
+				{
+					timing.m_drawcallCount += workItem.m_renderableElementCount;
+				}
+
+				pass.setTimestampQueries(timing.m_begin, timing.m_end);
+			}
 		}
 
 		// Atlas pass
@@ -267,6 +354,13 @@ void ShadowMapping::populateRenderGraph(RenderingContext& ctx)
 				TextureUsageBit::SAMPLED_COMPUTE,
 				TextureSubresourceInfo(DepthStencilAspectBit::DEPTH)});
 			pass.newDependency({m_atlas.m_rt, TextureUsageBit::IMAGE_COMPUTE_WRITE});
+
+			if(m_staticCasterCaching)
+			{
+				m_atlas.m_staticDepthRt =
+					rgraph.importRenderTarget(m_atlas.m_staticDepthTex, TextureUsageBit::IMAGE_COMPUTE_READ_WRITE);
+				pass.newDependency({m_atlas.m_staticDepthRt, TextureUsageBit::IMAGE_COMPUTE_READ_WRITE});
+			}
 		}
 	}
 	else
@@ -310,8 +404,34 @@ Mat4 ShadowMapping::createSpotLightTextureMatrix(const Viewport& viewport) const
 		1.0f);
 }
 
+U32 ShadowMapping::choseLodFromScreenSize(F32 radius, F32 distFromTheCamera, U32 maxLod) const
+{
+	if(distFromTheCamera <= radius)
+	{
+		// Inside the light volume
+		return maxLod;
+	}
+
+	const F32 pixels = 2.0f * radius * m_lodPixelsPerUnit / distFromTheCamera;
+	U32 lod = 0;
+	while(lod < maxLod && F32(m_atlas.m_tileResolution << lod) < pixels)
+	{
+		++lod;
+	}
+
+	return lod;
+}
+
 U32 ShadowMapping::choseLod(const Vec4& cameraOrigin, const PointLightQueueElement& light, Bool& blurAtlas) const
 {
+	if(m_screenSpaceLod)
+	{
+		const F32 distFromTheCamera = (cameraOrigin - light.m_worldPosition.xyz0()).getLength();
+		const U32 lod = choseLodFromScreenSize(light.m_radius, distFromTheCamera, m_pointLightsMaxLod);
+		blurAtlas = lod == m_pointLightsMaxLod;
+		return lod;
+	}
+
 	const F32 distFromTheCamera = (cameraOrigin - light.m_worldPosition.xyz0()).getLength() - light.m_radius;
 	if(distFromTheCamera < m_lodDistances[0])
 	{
@@ -333,6 +453,28 @@ U32 ShadowMapping::choseLod(const Vec4& cameraOrigin, const SpotLightQueueElemen
 	const Vec4 coneDir = -light.m_worldTransform.getZAxis().xyz0();
 	const F32 coneAngle = light.m_outerAngle;
 
+	if(m_screenSpaceLod)
+	{
+		// Use the bounding sphere of the cone
+		const F32 halfAngle = coneAngle / 2.0f;
+		Vec4 center;
+		F32 radius;
+		if(halfAngle >= PI / 4.0f)
+		{
+			center = coneOrigin + coneDir * light.m_distance;
+			radius = light.m_distance * tan(halfAngle);
+		}
+		else
+		{
+			radius = light.m_distance / (2.0f * cos(halfAngle) * cos(halfAngle));
+			center = coneOrigin + coneDir * radius;
+		}
+
+		const U32 lod = choseLodFromScreenSize(radius, (cameraOrigin - center).getLength(), m_lodCount - 1);
+		blurAtlas = lod == m_lodCount - 1;
+		return lod;
+	}
+
 	// Compute the distance from the camera to the light cone
 	const Vec4 V = cameraOrigin - coneOrigin;
 	const F32 VlenSq = V.dot(V);
@@ -364,9 +506,11 @@ TileAllocatorResult ShadowMapping::allocateTilesAndScratchTiles(U64 lightUuid,
 	const U64* faceTimestamps,
 	const U32* faceIndices,
 	const U32* drawcallsCount,
+	const U32* dynamicDrawcallsCount,
 	const U32* lods,
 	Viewport* atlasTileViewports,
 	Viewport* scratchTileViewports,
+	Viewport* dynamicScratchTileViewports,
 	TileAllocatorResult* subResults)
 {
 	ANKI_ASSERT(lightUuid > 0);
@@ -375,6 +519,7 @@ TileAllocatorResult ShadowMapping::allocateTilesAndScratchTiles(U64 lightUuid,
 	ANKI_ASSERT(faceIndices);
 	ANKI_ASSERT(drawcallsCount);
 	ANKI_ASSERT(lods);
+	ANKI_ASSERT(!dynamicDrawcallsCount || dynamicScratchTileViewports);
 
 	TileAllocatorResult res = TileAllocatorResult::ALLOCATION_FAILED;
 
@@ -413,24 +558,16 @@ TileAllocatorResult ShadowMapping::allocateTilesAndScratchTiles(U64 lightUuid,
 	}
 
 	// Allocate scratch tiles
-	for(U i = 0; i < faceCount; ++i)
-	{
-		if(subResults[i] == TileAllocatorResult::CACHED)
-		{
-			continue;
-		}
-
-		ANKI_ASSERT(subResults[i] == TileAllocatorResult::ALLOCATION_SUCCEEDED);
-
-		res = m_scratch.m_tileAlloc.allocate(m_r->getGlobalTimestamp(),
+	auto allocateScratchTile = [&](U32 i, Viewport& scratchTileViewport) -> TileAllocatorResult {
+		const TileAllocatorResult scratchRes = m_scratch.m_tileAlloc.allocate(m_r->getGlobalTimestamp(),
 			faceTimestamps[i],
 			lightUuid,
 			faceIndices[i],
 			drawcallsCount[i],
 			lods[i],
-			scratchTileViewports[i]);
+			scratchTileViewport);
 
-		if(res == TileAllocatorResult::ALLOCATION_FAILED)
+		if(scratchRes == TileAllocatorResult::ALLOCATION_FAILED)
 		{
 			ANKI_R_LOGW("Don't have enough space in the scratch shadow mapping buffer. "
 						"If you see this message too often increase r_shadowMappingScratchTileCountX/Y");
@@ -441,20 +578,47 @@ TileAllocatorResult ShadowMapping::allocateTilesAndScratchTiles(U64 lightUuid,
 				m_atlas.m_tileAlloc.invalidateCache(lightUuid, faceIndices[j]);
 			}
 
-			return res;
+			return scratchRes;
 		}
 
 		// Fix viewport
-		scratchTileViewports[i][0] *= m_scratch.m_tileResolution;
-		scratchTileViewports[i][1] *= m_scratch.m_tileResolution;
-		scratchTileViewports[i][2] *= m_scratch.m_tileResolution;
-		scratchTileViewports[i][3] *= m_scratch.m_tileResolution;
+		scratchTileViewport[0] *= m_scratch.m_tileResolution;
+		scratchTileViewport[1] *= m_scratch.m_tileResolution;
+		scratchTileViewport[2] *= m_scratch.m_tileResolution;
+		scratchTileViewport[3] *= m_scratch.m_tileResolution;
 
 		// Update the max view width
 		m_scratch.m_maxViewportWidth =
-			max(m_scratch.m_maxViewportWidth, scratchTileViewports[i][0] + scratchTileViewports[i][2]);
+			max(m_scratch.m_maxViewportWidth, scratchTileViewport[0] + scratchTileViewport[2]);
 		m_scratch.m_maxViewportHeight =
-			max(m_scratch.m_maxViewportHeight, scratchTileViewports[i][1] + scratchTileViewports[i][3]);
+			max(m_scratch.m_maxViewportHeight, scratchTileViewport[1] + scratchTileViewport[3]);
+
+		return scratchRes;
+	};
+
+	for(U i = 0; i < faceCount; ++i)
+	{
+		// The cached part of the face needs a scratch tile only if it's not cached
+		if(subResults[i] != TileAllocatorResult::CACHED && drawcallsCount[i] > 0)
+		{
+			ANKI_ASSERT(subResults[i] == TileAllocatorResult::ALLOCATION_SUCCEEDED);
+
+			res = allocateScratchTile(i, scratchTileViewports[i]);
+			if(res == TileAllocatorResult::ALLOCATION_FAILED)
+			{
+				return res;
+			}
+		}
+
+		// The dynamic part of the face is rendered every frame
+		if(dynamicDrawcallsCount && dynamicDrawcallsCount[i] > 0)
+		{
+			res = allocateScratchTile(i, dynamicScratchTileViewports[i]);
+			if(res == TileAllocatorResult::ALLOCATION_FAILED)
+			{
+				return res;
+			}
+		}
 	}
 
 	return res;
@@ -468,6 +632,7 @@ void ShadowMapping::processLights(RenderingContext& ctx, U32& threadCountForScra
 
 	// Vars
 	const Vec4 cameraOrigin = ctx.m_renderQueue->m_cameraTransform.getTranslationPart().xyz0();
+	m_lodPixelsPerUnit = F32(m_r->getHeight()) / (2.0f * tan(ctx.m_renderQueue->m_cameraFovY / 2.0f));
 	DynamicArrayAuto<Scratch::LightToRenderToScratchInfo> lightsToRender(ctx.m_tempAllocator);
 	U32 drawcallCount = 0;
 	DynamicArrayAuto<Atlas::ResolveWorkItem> atlasWorkItems(ctx.m_tempAllocator);
@@ -507,6 +672,9 @@ void ShadowMapping::processLights(RenderingContext& ctx, U32& threadCountForScra
 		Array<U32, MAX_SHADOW_CASCADES> lods;
 		Array<Bool, MAX_SHADOW_CASCADES> blurAtlass;
 
+		Array<Bool, MAX_SHADOW_CASCADES> updateCascades;
+		scheduleCascades(light, updateCascades);
+
 		U32 activeCascades = 0;
 
 		for(U32 cascade = 0; cascade < light.m_shadowCascadeCount; ++cascade)
@@ -516,7 +684,10 @@ void ShadowMapping::processLights(RenderingContext& ctx, U32& threadCountForScra
 			{
 				// Cascade with drawcalls, will need tiles
 
-				timestamps[activeCascades] = m_r->getGlobalTimestamp(); // This light is always updated
+				// A cascade that is not updated keeps the tile of its last update, if it's still in the atlas
+				timestamps[activeCascades] = (updateCascades[cascade])
+												 ? m_r->getGlobalTimestamp()
+												 : m_cascadeCache[cascade].m_lastUpdateTimestamp;
 				cascadeIndices[activeCascades] = cascade;
 				drawcallCounts[activeCascades] = 1; // Doesn't matter
 
@@ -534,9 +705,11 @@ void ShadowMapping::processLights(RenderingContext& ctx, U32& threadCountForScra
 											 &timestamps[0],
 											 &cascadeIndices[0],
 											 &drawcallCounts[0],
+											 nullptr,
 											 &lods[0],
 											 &atlasViewports[0],
 											 &scratchViewports[0],
+											 nullptr,
 											 &subResults[0])
 											 == TileAllocatorResult::ALLOCATION_FAILED;
 
@@ -550,18 +723,34 @@ void ShadowMapping::processLights(RenderingContext& ctx, U32& threadCountForScra
 				{
 					// Cascade with drawcalls, push some work for it
 
+					CascadeCache& cache = m_cascadeCache[cascade];
+					const Bool render = subResults[activeCascades] != TileAllocatorResult::CACHED;
+					if(render)
+					{
+						cache.m_textureMatrix = light.m_textureMatrices[cascade];
+						cache.m_lastUpdateTimestamp = m_r->getGlobalTimestamp();
+					}
+					else
+					{
+						// Reproject to the tile of a previous frame
+						light.m_textureMatrices[cascade] = cache.m_textureMatrix;
+					}
+
 					// Update the texture matrix to point to the correct region in the atlas
 					light.m_textureMatrices[cascade] =
 						createSpotLightTextureMatrix(atlasViewports[activeCascades]) * light.m_textureMatrices[cascade];
 
 					// Push work
-					newScratchAndAtlasResloveRenderWorkItems(atlasViewports[activeCascades],
-						scratchViewports[activeCascades],
-						blurAtlass[activeCascades],
-						light.m_shadowRenderQueues[cascade],
-						lightsToRender,
-						atlasWorkItems,
-						drawcallCount);
+					if(render)
+					{
+						newScratchAndAtlasResloveRenderWorkItems(atlasViewports[activeCascades],
+							scratchViewports[activeCascades],
+							blurAtlass[activeCascades],
+							light.m_shadowRenderQueues[cascade],
+							lightsToRender,
+							atlasWorkItems,
+							drawcallCount);
+					}
 
 					++activeCascades;
 				}
@@ -569,6 +758,7 @@ void ShadowMapping::processLights(RenderingContext& ctx, U32& threadCountForScra
 				{
 					// Empty cascade, point it to the empty tile
 
+					m_cascadeCache[cascade].m_lastUpdateTimestamp = 0;
 					light.m_textureMatrices[cascade] =
 						createSpotLightTextureMatrix(emptyTileViewport) * light.m_textureMatrices[cascade];
 				}
@@ -579,6 +769,11 @@ void ShadowMapping::processLights(RenderingContext& ctx, U32& threadCountForScra
 			// Light can't be a caster this frame
 			light.m_shadowCascadeCount = 0;
 			zeroMemory(light.m_shadowRenderQueues);
+
+			for(CascadeCache& cache : m_cascadeCache)
+			{
+				cache.m_lastUpdateTimestamp = 0;
+			}
 		}
 	}
 
@@ -589,8 +784,10 @@ void ShadowMapping::processLights(RenderingContext& ctx, U32& threadCountForScra
 		Array<U64, 6> timestamps;
 		Array<U32, 6> faceIndices;
 		Array<U32, 6> drawcallCounts;
+		Array<U32, 6> dynamicDrawcallCounts;
 		Array<Viewport, 6> atlasViewports;
 		Array<Viewport, 6> scratchViewports;
+		Array<Viewport, 6> dynamicScratchViewports;
 		Array<TileAllocatorResult, 6> subResults;
 		Array<U32, 6> lods;
 		U32 numOfFacesThatHaveDrawcalls = 0;
@@ -607,10 +804,13 @@ void ShadowMapping::processLights(RenderingContext& ctx, U32& threadCountForScra
 
 				faceIndices[numOfFacesThatHaveDrawcalls] = face;
 				timestamps[numOfFacesThatHaveDrawcalls] =
-					light->m_shadowRenderQueues[face]->m_shadowRenderablesLastUpdateTimestamp;
+					(m_staticCasterCaching)
+						? light->m_shadowRenderQueues[face]->m_staticShadowRenderablesLastUpdateTimestamp
+						: light->m_shadowRenderQueues[face]->m_shadowRenderablesLastUpdateTimestamp;
 
-				drawcallCounts[numOfFacesThatHaveDrawcalls] =
-					light->m_shadowRenderQueues[face]->m_renderables.getSize();
+				getFaceDrawcallCounts(*light->m_shadowRenderQueues[face],
+					drawcallCounts[numOfFacesThatHaveDrawcalls],
+					dynamicDrawcallCounts[numOfFacesThatHaveDrawcalls]);
 
 				lods[numOfFacesThatHaveDrawcalls] = lod;
 
@@ -624,9 +824,11 @@ void ShadowMapping::processLights(RenderingContext& ctx, U32& threadCountForScra
 											 &timestamps[0],
 											 &faceIndices[0],
 											 &drawcallCounts[0],
+											 &dynamicDrawcallCounts[0],
 											 &lods[0],
 											 &atlasViewports[0],
 											 &scratchViewports[0],
+											 &dynamicScratchViewports[0],
 											 &subResults[0])
 											 == TileAllocatorResult::ALLOCATION_FAILED;
 
@@ -654,7 +856,19 @@ void ShadowMapping::processLights(RenderingContext& ctx, U32& threadCountForScra
 					light->m_shadowAtlasTileOffsets[face].x() = (F32(atlasViewport[0]) + 0.5f) / atlasResolution;
 					light->m_shadowAtlasTileOffsets[face].y() = (F32(atlasViewport[1]) + 0.5f) / atlasResolution;
 
-					if(subResults[numOfFacesThatHaveDrawcalls] != TileAllocatorResult::CACHED)
+					if(m_staticCasterCaching)
+					{
+						newCachedFaceRenderWorkItems(atlasViewport,
+							scratchViewport,
+							dynamicScratchViewports[numOfFacesThatHaveDrawcalls],
+							subResults[numOfFacesThatHaveDrawcalls],
+							blurAtlas,
+							light->m_shadowRenderQueues[face],
+							lightsToRender,
+							atlasWorkItems,
+							drawcallCount);
+					}
+					else if(subResults[numOfFacesThatHaveDrawcalls] != TileAllocatorResult::CACHED)
 					{
 						newScratchAndAtlasResloveRenderWorkItems(atlasViewport,
 							scratchViewport,
@@ -697,19 +911,26 @@ void ShadowMapping::processLights(RenderingContext& ctx, U32& threadCountForScra
 		TileAllocatorResult subResult;
 		Viewport atlasViewport;
 		Viewport scratchViewport;
-		const U32 localDrawcallCount = light->m_shadowRenderQueue->m_renderables.getSize();
+		Viewport dynamicScratchViewport;
+		U32 localDrawcallCount, localDynamicDrawcallCount;
+		getFaceDrawcallCounts(*light->m_shadowRenderQueue, localDrawcallCount, localDynamicDrawcallCount);
+		const Timestamp timestamp = (m_staticCasterCaching)
+										? light->m_shadowRenderQueue->m_staticShadowRenderablesLastUpdateTimestamp
+										: light->m_shadowRenderQueue->m_shadowRenderablesLastUpdateTimestamp;
 
 		Bool blurAtlas;
 		const U32 lod = choseLod(cameraOrigin, *light, blurAtlas);
-		const Bool allocationFailed = localDrawcallCount == 0
+		const Bool allocationFailed = light->m_shadowRenderQueue->m_renderables.getSize() == 0
 									  || allocateTilesAndScratchTiles(light->m_uuid,
 											 1,
-											 &light->m_shadowRenderQueue->m_shadowRenderablesLastUpdateTimestamp,
+											 &timestamp,
 											 &faceIdx,
 											 &localDrawcallCount,
+											 &localDynamicDrawcallCount,
 											 &lod,
 											 &atlasViewport,
 											 &scratchViewport,
+											 &dynamicScratchViewport,
 											 &subResult)
 											 == TileAllocatorResult::ALLOCATION_FAILED;
 
@@ -720,7 +941,19 @@ void ShadowMapping::processLights(RenderingContext& ctx, U32& threadCountForScra
 			// Update the texture matrix to point to the correct region in the atlas
 			light->m_textureMatrix = createSpotLightTextureMatrix(atlasViewport) * light->m_textureMatrix;
 
-			if(subResult != TileAllocatorResult::CACHED)
+			if(m_staticCasterCaching)
+			{
+				newCachedFaceRenderWorkItems(atlasViewport,
+					scratchViewport,
+					dynamicScratchViewport,
+					subResult,
+					blurAtlas,
+					light->m_shadowRenderQueue,
+					lightsToRender,
+					atlasWorkItems,
+					drawcallCount);
+			}
+			else if(subResult != TileAllocatorResult::CACHED)
 			{
 				newScratchAndAtlasResloveRenderWorkItems(atlasViewport,
 					scratchViewport,
@@ -765,7 +998,8 @@ void ShadowMapping::processLights(RenderingContext& ctx, U32& threadCountForScra
 				Scratch::WorkItem workItem;
 				workItem.m_viewport = lightToRender->m_viewport;
 				workItem.m_renderQueue = lightToRender->m_renderQueue;
-				workItem.m_firstRenderableElement = lightToRender->m_drawcallCount - lightToRenderDrawcallCount;
+				workItem.m_firstRenderableElement = lightToRender->m_firstRenderableElement
+													+ lightToRender->m_drawcallCount - lightToRenderDrawcallCount;
 				workItem.m_renderableElementCount = workItemDrawcallCount;
 				workItem.m_threadPoolTaskIdx = taskId;
 				workItems.emplaceBack(workItem);
@@ -823,7 +1057,7 @@ void ShadowMapping::newScratchAndAtlasResloveRenderWorkItems(const Viewport& atl
 	// Scratch work item
 	{
 		Scratch::LightToRenderToScratchInfo toRender = {
-			scratchVewport, lightRenderQueue, lightRenderQueue->m_renderables.getSize()};
+			scratchVewport, lightRenderQueue, 0, lightRenderQueue->m_renderables.getSize()};
 		scratchWorkItem.emplaceBack(toRender);
 		drawcallCount += lightRenderQueue->m_renderables.getSize();
 	}
@@ -839,11 +1073,207 @@ void ShadowMapping::newScratchAndAtlasResloveRenderWorkItems(const Viewport& atl
 		atlasItem.m_uvIn[2] = F32(scratchVewport[2]) / scratchAtlasWidth;
 		atlasItem.m_uvIn[3] = F32(scratchVewport[3]) / scratchAtlasHeight;
 
+		atlasItem.m_uvIn2 = Vec4(0.0f);
+
+		atlasItem.m_viewportOut = atlasViewport;
+		atlasItem.m_blur = blurAtlas;
+		atlasItem.m_hasSecondInput = false;
+		atlasItem.m_staticDepthMode = StaticDepthMode::NONE;
+
+		atlasResolveWorkItem.emplaceBack(atlasItem);
+	}
+}
+
+void ShadowMapping::newCachedFaceRenderWorkItems(const Viewport& atlasViewport,
+	const Viewport& scratchVewport,
+	const Viewport& dynamicScratchVewport,
+	TileAllocatorResult atlasResult,
+	Bool blurAtlas,
+	RenderQueue* lightRenderQueue,
+	DynamicArrayAuto<Scratch::LightToRenderToScratchInfo>& scratchWorkItem,
+	DynamicArrayAuto<Atlas::ResolveWorkItem>& atlasResolveWorkItem,
+	U32& drawcallCount) const
+{
+	ANKI_ASSERT(m_staticCasterCaching);
+	ANKI_ASSERT(atlasResult != TileAllocatorResult::ALLOCATION_FAILED);
+
+	U32 staticCount, dynamicCount;
+	getFaceDrawcallCounts(*lightRenderQueue, staticCount, dynamicCount);
+
+	const Bool renderStatic = atlasResult != TileAllocatorResult::CACHED && staticCount > 0;
+	const Bool renderDynamic = dynamicCount > 0;
+	if(!renderStatic && !renderDynamic)
+	{
+		// The static casters are cached and there are no dynamic, the tile is up to date
+		return;
+	}
+
+	// Scratch work items. The static casters are first in the render queue
+	if(renderStatic)
+	{
+		Scratch::LightToRenderToScratchInfo toRender = {scratchVewport, lightRenderQueue, 0, staticCount};
+		scratchWorkItem.emplaceBack(toRender);
+		drawcallCount += staticCount;
+	}
+
+	if(renderDynamic)
+	{
+		Scratch::LightToRenderToScratchInfo toRender = {
+			dynamicScratchVewport, lightRenderQueue, staticCount, dynamicCount};
+		scratchWorkItem.emplaceBack(toRender);
+		drawcallCount += dynamicCount;
+	}
+
+	// Atlas resolve work item
+	{
+		const F32 scratchAtlasWidth = F32(m_scratch.m_tileCountX * m_scratch.m_tileResolution);
+		const F32 scratchAtlasHeight = F32(m_scratch.m_tileCountY * m_scratch.m_tileResolution);
+		auto computeUv = [&](const Viewport& vp) {
+			return Vec4(F32(vp[0]) / scratchAtlasWidth,
+				F32(vp[1]) / scratchAtlasHeight,
+				F32(vp[2]) / scratchAtlasWidth,
+				F32(vp[3]) / scratchAtlasHeight);
+		};
+
+		Atlas::ResolveWorkItem atlasItem;
 		atlasItem.m_viewportOut = atlasViewport;
 		atlasItem.m_blur = blurAtlas;
 
+		if(renderStatic)
+		{
+			// Re-cache the static depth and combine it with the dynamic
+			atlasItem.m_uvIn = computeUv(scratchVewport);
+			atlasItem.m_uvIn2 = (renderDynamic) ? computeUv(dynamicScratchVewport) : Vec4(0.0f);
+			atlasItem.m_hasSecondInput = renderDynamic;
+			atlasItem.m_staticDepthMode = StaticDepthMode::WRITE;
+		}
+		else
+		{
+			// Only the dynamic casters, use the cached static depth if there are static casters
+			atlasItem.m_uvIn = computeUv(dynamicScratchVewport);
+			atlasItem.m_uvIn2 = Vec4(0.0f);
+			atlasItem.m_hasSecondInput = false;
+			atlasItem.m_staticDepthMode = (staticCount > 0) ? StaticDepthMode::READ : StaticDepthMode::NONE;
+		}
+
 		atlasResolveWorkItem.emplaceBack(atlasItem);
 	}
 }
 
+void ShadowMapping::getFaceDrawcallCounts(const RenderQueue& lightRenderQueue, U32& cachedCount, U32& dynamicCount) const
+{
+	if(m_staticCasterCaching)
+	{
+		ANKI_ASSERT(lightRenderQueue.m_staticShadowRenderableCount <= lightRenderQueue.m_renderables.getSize());
+		cachedCount = lightRenderQueue.m_staticShadowRenderableCount;
+		dynamicCount = lightRenderQueue.m_renderables.getSize() - cachedCount;
+	}
+	else
+	{
+		cachedCount = lightRenderQueue.m_renderables.getSize();
+		dynamicCount = 0;
+	}
+}
+
+void ShadowMapping::scheduleCascades(
+	const DirectionalLightQueueElement& light, Array<Bool, MAX_SHADOW_CASCADES>& updateCascades)
+{
+	const Timestamp crntTimestamp = m_r->getGlobalTimestamp();
+
+	// Forget the cached cascades if there is no scheduling or if the light changed
+	if(m_farCascadeBudget <= 0.0 || light.m_uuid != m_cascadeCacheLightUuid || light.m_direction != m_cascadeCacheLightDir)
+	{
+		for(CascadeCache& cache : m_cascadeCache)
+		{
+			cache.m_lastUpdateTimestamp = 0;
+		}
+
+		m_cascadeCacheLightUuid = light.m_uuid;
+		m_cascadeCacheLightDir = light.m_direction;
+	}
+
+	// Find the cascades that need to be rendered no matter what
+	Second budget = m_farCascadeBudget;
+	Array<U32, MAX_SHADOW_CASCADES> candidates;
+	U32 candidateCount = 0;
+	for(U32 cascade = 0; cascade < light.m_shadowCascadeCount; ++cascade)
+	{
+		const CascadeCache& cache = m_cascadeCache[cascade];
+
+		Bool update = cascade < m_fullRateCascadeCount || cache.m_lastUpdateTimestamp == 0
+					  || crntTimestamp - cache.m_lastUpdateTimestamp >= m_farCascadeMaxStaleFrames;
+
+		if(!update)
+		{
+			// Project the center of the cascade to the cached tile to see how much the camera moved. It's orthographic,
+			// no need to divide with w
+			const Vec4 center = light.m_textureMatrices[cascade].getInverse() * Vec4(0.5f, 0.5f, 0.5f, 1.0f);
+			const Vec4 cachedUv = cache.m_textureMatrix * center;
+			update = (cachedUv.xy() - Vec2(0.5f)).getLength() > CASCADE_MAX_DRIFT;
+		}
+
+		if(update)
+		{
+			updateCascades[cascade] = true;
+
+			if(cascade >= m_fullRateCascadeCount)
+			{
+				budget -= F64(light.m_shadowRenderQueues[cascade]->m_renderables.getSize())
+						  * m_scratchGpuTimePerDrawcall;
+			}
+		}
+		else
+		{
+			updateCascades[cascade] = false;
+			candidates[candidateCount++] = cascade;
+		}
+	}
+
+	// Spend what is left of the budget. The stalest cascades go first and that makes it a round-robin
+	while(candidateCount > 0 && budget > 0.0)
+	{
+		U32 stalest = 0;
+		for(U32 i = 1; i < candidateCount; ++i)
+		{
+			if(m_cascadeCache[candidates[i]].m_lastUpdateTimestamp
+				< m_cascadeCache[candidates[stalest]].m_lastUpdateTimestamp)
+			{
+				stalest = i;
+			}
+		}
+
+		const U32 cascade = candidates[stalest];
+		candidates[stalest] = candidates[--candidateCount];
+
+		const Second cost =
+			F64(light.m_shadowRenderQueues[cascade]->m_renderables.getSize()) * m_scratchGpuTimePerDrawcall;
+		if(cost <= budget)
+		{
+			updateCascades[cascade] = true;
+			budget -= cost;
+		}
+	}
+}
+
+void ShadowMapping::gatherScratchPassTiming()
+{
+	// The slot of this frame was written MAX_FRAMES_IN_FLIGHT frames ago so the GPU is done with it
+	ScratchPassTiming& timing = m_scratchPassTimings[m_r->getFrameCount() % m_scratchPassTimings.getSize()];
+
+	Second begin, end;
+	if(timing.m_begin && timing.m_drawcallCount > 0
+		&& timing.m_begin->getResult(begin) == TimestampQueryResult::AVAILABLE
+		&& timing.m_end->getResult(end) == TimestampQueryResult::AVAILABLE && end > begin)
+	{
+		const Second timePerDrawcall = (end - begin) / F64(timing.m_drawcallCount);
+		m_scratchGpuTimePerDrawcall = (m_scratchGpuTimePerDrawcall > 0.0)
+										  ? mix(m_scratchGpuTimePerDrawcall, timePerDrawcall, 0.1)
+										  : timePerDrawcall;
+	}
+
+	timing.m_begin.reset(nullptr);
+	timing.m_end.reset(nullptr);
+	timing.m_drawcallCount = 0;
+}
+
 } // end namespace anki
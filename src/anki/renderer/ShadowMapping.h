@@ -9,6 +9,7 @@
 #include <anki/Gr.h>
 #include <anki/resource/TextureResource.h>
 #include <anki/renderer/TileAllocator.h>
+#include <shaders/glsl_cpp_common/ClusteredShading.h>
 
 namespace anki
 {
@@ -29,6 +30,9 @@ public:
 
 	ANKI_USE_RESULT Error init(const ConfigSet& initializer);
 
+	/// Read the options that don't need new resources.
+	void applyConfig(const ConfigSet& cfg);
+
 	/// Populate the rendergraph.
 	void populateRenderGraph(RenderingContext& ctx);
 
@@ -53,6 +57,10 @@ private:
 		TexturePtr m_tex; ///<  Size (m_tileResolution*m_tileCountBothAxis)^2
 		RenderTargetHandle m_rt;
 
+		/// The depth of the static casters of the cached tiles. Same size and layout as m_tex. Optional.
+		TexturePtr m_staticDepthTex;
+		RenderTargetHandle m_staticDepthRt;
+
 		U32 m_tileResolution = 0; ///< Tile resolution.
 		U32 m_tileCountBothAxis = 0;
 
@@ -98,6 +106,44 @@ private:
 	void runShadowMapping(RenderPassWorkContext& rgraphCtx);
 	/// @}
 
+	/// @name Cascade scheduling
+	/// @{
+
+	/// A cascade that is not rendered this frame uses the tile of a previous frame and the matrix it got rendered with.
+	class CascadeCache
+	{
+	public:
+		Mat4 m_textureMatrix = Mat4::getIdentity(); ///< The texture matrix of the tile. Before pointing to the atlas.
+		Timestamp m_lastUpdateTimestamp = 0; ///< Zero means that there is nothing cached.
+	};
+
+	/// The GPU time of the scratch pass of a past frame.
+	class ScratchPassTiming
+	{
+	public:
+		TimestampQueryPtr m_begin;
+		TimestampQueryPtr m_end;
+		U32 m_drawcallCount = 0;
+	};
+
+	Array<CascadeCache, MAX_SHADOW_CASCADES> m_cascadeCache;
+	U64 m_cascadeCacheLightUuid = 0;
+	Vec3 m_cascadeCacheLightDir = Vec3(0.0f);
+
+	Second m_farCascadeBudget = 0.0; ///< The GPU time of the far cascades per frame. Zero renders all every frame.
+	U32 m_fullRateCascadeCount = 0; ///< The near cascades that are rendered every frame.
+	U32 m_farCascadeMaxStaleFrames = 0;
+
+	Array<ScratchPassTiming, MAX_FRAMES_IN_FLIGHT + 1> m_scratchPassTimings;
+	Second m_scratchGpuTimePerDrawcall = 0.0; ///< Running average. Used to estimate the cost of a cascade.
+
+	/// Chose the cascades of the directional light that will be rendered this frame.
+	void scheduleCascades(const DirectionalLightQueueElement& light, Array<Bool, MAX_SHADOW_CASCADES>& updateCascades);
+
+	/// Read the GPU time of the scratch pass of an old frame and update the running average.
+	void gatherScratchPassTiming();
+	/// @}
+
 	/// @name Misc & common
 	/// @{
 
@@ -106,20 +152,34 @@ private:
 
 	Array<F32, m_lodCount - 1> m_lodDistances;
 
+	/// Pick the LODs from the screen size of the lights. The tile of a light is the smallest that has at least as many
+	/// texels as the pixels the light covers, so the resolution of the shadows follows what is on the screen.
+	Bool m_screenSpaceLod = false;
+	F32 m_lodPixelsPerUnit = 0.0f; ///< The pixels a unit covers at distance one from the camera.
+
+	/// Find the smallest LOD that has enough texels for a light volume.
+	U32 choseLodFromScreenSize(F32 radius, F32 distFromTheCamera, U32 maxLod) const;
+
 	/// Find the lod of the light
 	U32 choseLod(const Vec4& cameraOrigin, const PointLightQueueElement& light, Bool& blurAtlas) const;
 	/// Find the lod of the light
 	U32 choseLod(const Vec4& cameraOrigin, const SpotLightQueueElement& light, Bool& blurAtlas) const;
 
+	Bool m_staticCasterCaching = false;
+
 	/// Try to allocate a number of scratch tiles and regular tiles.
+	/// @param drawcallsCount The drawcalls that can be cached. All of them if there is no static caster caching.
+	/// @param dynamicDrawcallsCount The drawcalls that need to be rendered every frame. Can be nullptr.
 	TileAllocatorResult allocateTilesAndScratchTiles(U64 lightUuid,
 		U32 faceCount,
 		const U64* faceTimestamps,
 		const U32* faceIndices,
 		const U32* drawcallsCount,
+		const U32* dynamicDrawcallsCount,
 		const U32* lods,
 		Viewport* atlasTileViewports,
 		Viewport* scratchTileViewports,
+		Viewport* dynamicScratchTileViewports,
 		TileAllocatorResult* subResults);
 
 	/// Add new work to render to scratch buffer and atlas buffer.
@@ -131,6 +191,21 @@ private:
 		DynamicArrayAuto<Atlas::ResolveWorkItem>& atlasResolveWorkItem,
 		U32& drawcallCount) const;
 
+	/// Add the work of a light face of a point or spot light. The static casters are rendered only if they are not
+	/// cached and the dynamic casters are rendered every frame.
+	void newCachedFaceRenderWorkItems(const Viewport& atlasViewport,
+		const Viewport& scratchVewport,
+		const Viewport& dynamicScratchVewport,
+		TileAllocatorResult atlasResult,
+		Bool blurAtlas,
+		RenderQueue* lightRenderQueue,
+		DynamicArrayAuto<Scratch::LightToRenderToScratchInfo>& scratchWorkItem,
+		DynamicArrayAuto<Atlas::ResolveWorkItem>& atlasResolveWorkItem,
+		U32& drawcallCount) const;
+
+	/// Get the drawcalls of a light face that can be cached and the ones that need to be rendered every frame.
+	void getFaceDrawcallCounts(const RenderQueue& lightRenderQueue, U32& cachedCount, U32& dynamicCount) const;
+
 	/// Iterate lights and create work items.
 	void processLights(RenderingContext& ctx, U32& threadCountForScratchPass);
 
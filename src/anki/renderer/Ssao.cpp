@@ -35,7 +35,8 @@ Error Ssao::initMain(const ConfigSet& config)
 
 	ShaderProgramResourceVariantInitInfo variantInitInfo(m_main.m_prog);
 	variantInitInfo.addMutation("USE_NORMAL", (m_useNormal) ? 1u : 0u);
-	variantInitInfo.addMutation("SOFT_BLUR", (m_useSoftBlur) ? 1u : 0u);
+	variantInitInfo.addMutation("SOFT_BLUR", (m_useSoftBlur && !m_temporal.m_checkerboard) ? 1u : 0u);
+	variantInitInfo.addMutation("CHECKERBOARD", (m_temporal.m_checkerboard) ? 1u : 0u);
 	variantInitInfo.addConstant("NOISE_MAP_SIZE", U32(m_main.m_noiseTex->getWidth()));
 	variantInitInfo.addConstant("FB_SIZE", UVec2(m_width, m_height));
 	variantInitInfo.addConstant("RADIUS", 2.5f);
@@ -91,12 +92,84 @@ Error Ssao::initBlur(const ConfigSet& config)
 	return Error::NONE;
 }
 
+Error Ssao::initTemporal(const ConfigSet& config)
+{
+	ANKI_CHECK(getResourceManager().loadResource("shaders/SsaoTemporal.ankiprog", m_temporal.m_prog));
+
+	ShaderProgramResourceVariantInitInfo variantInitInfo(m_temporal.m_prog);
+	variantInitInfo.addMutation("CHECKERBOARD", (m_temporal.m_checkerboard) ? 1u : 0u);
+	variantInitInfo.addConstant("FB_SIZE", UVec2(m_width, m_height));
+
+	const ShaderProgramResourceVariant* variant;
+	m_temporal.m_prog->getOrCreateVariant(variantInitInfo, variant);
+	m_temporal.m_workgroupSize[0] = variant->getWorkgroupSizes()[0];
+	m_temporal.m_workgroupSize[1] = variant->getWorkgroupSizes()[1];
+	m_temporal.m_grProg = variant->getProgram();
+
+	// History RTs. Clear them to no occlusion
+	TextureInitInfo texInit = m_r->create2DRenderTargetInitInfo(m_width,
+		m_height,
+		RT_PIXEL_FORMAT,
+		TextureUsageBit::IMAGE_COMPUTE_WRITE | TextureUsageBit::SAMPLED_COMPUTE,
+		"SSAOTemporal");
+	texInit.m_initialUsage = TextureUsageBit::SAMPLED_COMPUTE;
+
+	ClearValue clearVal;
+	clearVal.m_colorf[0] = 1.0f;
+	m_temporal.m_rtTextures[0] = m_r->createAndClearRenderTarget(texInit, clearVal);
+	m_temporal.m_rtTextures[1] = m_r->createAndClearRenderTarget(texInit, clearVal);
+
+	return Error::NONE;
+}
+
+Error Ssao::initUpsample(const ConfigSet& config)
+{
+	const U32 width = m_r->getWidth();
+	const U32 height = m_r->getHeight();
+
+	ANKI_CHECK(getResourceManager().loadResource("shaders/DepthAwareBlurCompute.ankiprog", m_upsample.m_prog));
+
+	ShaderProgramResourceVariantInitInfo variantInitInfo(m_upsample.m_prog);
+	variantInitInfo.addMutation("ORIENTATION", 3);
+	variantInitInfo.addMutation("SAMPLE_COUNT", 3);
+	variantInitInfo.addMutation("COLOR_COMPONENTS", 1);
+	variantInitInfo.addConstant("TEXTURE_SIZE", UVec2(width, height));
+
+	const ShaderProgramResourceVariant* variant;
+	m_upsample.m_prog->getOrCreateVariant(variantInitInfo, variant);
+	m_upsample.m_workgroupSize[0] = variant->getWorkgroupSizes()[0];
+	m_upsample.m_workgroupSize[1] = variant->getWorkgroupSizes()[1];
+	m_upsample.m_grProg = variant->getProgram();
+
+	m_upsample.m_rtDescr = m_r->create2DRenderTargetDescription(width, height, RT_PIXEL_FORMAT, "SSAOUpsample");
+	m_upsample.m_rtDescr.bake();
+
+	return Error::NONE;
+}
+
 Error Ssao::init(const ConfigSet& config)
 {
-	m_width = m_r->getWidth() / SSAO_FRACTION;
-	m_height = m_r->getHeight() / SSAO_FRACTION;
+	m_resolutionDivisor = config.getNumberU32("r_ssaoResolutionDivisor");
+	if(m_resolutionDivisor != 1 && m_resolutionDivisor != 2 && m_resolutionDivisor != 4)
+	{
+		ANKI_R_LOGE("r_ssaoResolutionDivisor should be 1, 2 or 4 because the SSAO reads the matching depth buffer");
+		return Error::USER_DATA;
+	}
+
+	m_width = m_r->getWidth() / m_resolutionDivisor;
+	m_height = m_r->getHeight() / m_resolutionDivisor;
+
+	m_temporal.m_checkerboard = config.getBool("r_ssaoCheckerboard");
+	m_temporal.m_historyBlendFactor = config.getNumberF32("r_ssaoHistoryBlendFactor");
+	m_temporal.m_enabled = m_temporal.m_checkerboard || m_temporal.m_historyBlendFactor < 1.0f;
+	m_upsample.m_enabled = config.getBool("r_ssaoBilateralUpsample") && m_resolutionDivisor > 1;
 
-	ANKI_R_LOGI("Initializing SSAO. Size %ux%u", m_width, m_height);
+	ANKI_R_LOGI("Initializing SSAO. Size %ux%u, checkerboard %u, temporal %u, bilateral upsample %u",
+		m_width,
+		m_height,
+		U32(m_temporal.m_checkerboard),
+		U32(m_temporal.m_enabled),
+		U32(m_upsample.m_enabled));
 
 	// RT
 	m_rtDescrs[0] = m_r->create2DRenderTargetDescription(m_width, m_height, RT_PIXEL_FORMAT, "SSAOMain");
@@ -117,6 +190,16 @@ Error Ssao::init(const ConfigSet& config)
 		err = initBlur(config);
 	}
 
+	if(!err && m_temporal.m_enabled)
+	{
+		err = initTemporal(config);
+	}
+
+	if(!err && m_upsample.m_enabled)
+	{
+		err = initUpsample(config);
+	}
+
 	if(err)
 	{
 		ANKI_R_LOGE("Failed to init PPS SSAO");
@@ -135,7 +218,10 @@ void Ssao::runMain(const RenderingContext& ctx, RenderPassWorkContext& rgraphCtx
 	cmdb->bindSampler(0, 0, m_r->getSamplers().m_trilinearClamp);
 	cmdb->bindSampler(0, 1, m_r->getSamplers().m_trilinearRepeat);
 
-	rgraphCtx.bindTexture(0, 2, m_r->getDepthDownscale().getHiZRt(), HIZ_HALF_DEPTH);
+	RenderTargetHandle depthRt;
+	TextureSubresourceInfo depthSubresource;
+	getDepthRt(depthRt, depthSubresource);
+	rgraphCtx.bindTexture(0, 2, depthRt, depthSubresource);
 	cmdb->bindTexture(0, 3, m_main.m_noiseTex->getGrTextureView(), TextureUsageBit::SAMPLED_FRAGMENT);
 
 	if(m_useNormal)
@@ -148,18 +234,28 @@ void Ssao::runMain(const RenderingContext& ctx, RenderPassWorkContext& rgraphCtx
 		Vec4 m_unprojectionParams;
 		Vec4 m_projectionMat;
 		Mat3x4 m_viewRotMat;
+		F32 m_noiseOffset;
+		U32 m_checkerboardOffset;
+		U32 m_padding0;
+		U32 m_padding1;
 	} unis;
 
 	const Mat4& pmat = ctx.m_renderQueue->m_projectionMatrix;
 	unis.m_unprojectionParams = ctx.m_unprojParams;
 	unis.m_projectionMat = Vec4(pmat(0, 0), pmat(1, 1), pmat(2, 2), pmat(2, 3));
 	unis.m_viewRotMat = Mat3x4(ctx.m_renderQueue->m_viewMatrix.getRotationPart());
+	unis.m_noiseOffset = (m_temporal.m_enabled) ? F32(m_r->getFrameCount() % 8) / 8.0f : 0.0f;
+	unis.m_checkerboardOffset = m_r->getFrameCount() & 1;
+	unis.m_padding0 = 0;
+	unis.m_padding1 = 0;
 	cmdb->setPushConstants(&unis, sizeof(unis));
 
 	if(m_useCompute)
 	{
 		rgraphCtx.bindImage(0, 5, m_runCtx.m_rts[0], TextureSubresourceInfo());
-		dispatchPPCompute(cmdb, m_main.m_workgroupSize[0], m_main.m_workgroupSize[1], m_width, m_height);
+
+		const U32 dispatchWidth = (m_temporal.m_checkerboard) ? (m_width + 1) / 2 : m_width;
+		dispatchPPCompute(cmdb, m_main.m_workgroupSize[0], m_main.m_workgroupSize[1], dispatchWidth, m_height);
 	}
 	else
 	{
@@ -175,7 +271,7 @@ void Ssao::runBlur(RenderPassWorkContext& rgraphCtx)
 	cmdb->bindShaderProgram(m_blur.m_grProg);
 
 	cmdb->bindSampler(0, 0, m_r->getSamplers().m_trilinearClamp);
-	rgraphCtx.bindColorTexture(0, 1, m_runCtx.m_rts[0]);
+	rgraphCtx.bindColorTexture(0, 1, (m_temporal.m_enabled) ? m_runCtx.m_temporalRt : m_runCtx.m_rts[0]);
 
 	if(m_blurUseCompute)
 	{
@@ -189,6 +285,78 @@ void Ssao::runBlur(RenderPassWorkContext& rgraphCtx)
 	}
 }
 
+void Ssao::runTemporal(const RenderingContext& ctx, RenderPassWorkContext& rgraphCtx)
+{
+	CommandBufferPtr& cmdb = rgraphCtx.m_commandBuffer;
+
+	cmdb->bindShaderProgram(m_temporal.m_grProg);
+
+	cmdb->bindSampler(0, 0, m_r->getSamplers().m_trilinearClamp);
+	rgraphCtx.bindColorTexture(0, 1, m_runCtx.m_rts[0]);
+	rgraphCtx.bindColorTexture(0, 2, m_runCtx.m_historyRt);
+
+	RenderTargetHandle depthRt;
+	TextureSubresourceInfo depthSubresource;
+	getDepthRt(depthRt, depthSubresource);
+	rgraphCtx.bindTexture(0, 3, depthRt, depthSubresource);
+
+	rgraphCtx.bindImage(0, 4, m_runCtx.m_temporalRt, TextureSubresourceInfo());
+
+	struct PushConsts
+	{
+		Mat4 m_prevViewProjMatMulInvViewProjMat;
+		F32 m_historyBlendFactor;
+		U32 m_checkerboardOffset;
+		U32 m_historyValid;
+		U32 m_padding0;
+	} regs;
+	regs.m_prevViewProjMatMulInvViewProjMat =
+		ctx.m_prevMatrices.m_viewProjection * ctx.m_matrices.m_viewProjectionJitter.getInverse();
+	regs.m_historyBlendFactor = m_temporal.m_historyBlendFactor;
+	regs.m_checkerboardOffset = m_r->getFrameCount() & 1;
+	regs.m_historyValid = m_r->getFrameCount() > 0;
+	regs.m_padding0 = 0;
+	cmdb->setPushConstants(&regs, sizeof(regs));
+
+	dispatchPPCompute(cmdb, m_temporal.m_workgroupSize[0], m_temporal.m_workgroupSize[1], m_width, m_height);
+}
+
+void Ssao::runUpsample(RenderPassWorkContext& rgraphCtx)
+{
+	CommandBufferPtr& cmdb = rgraphCtx.m_commandBuffer;
+
+	cmdb->bindShaderProgram(m_upsample.m_grProg);
+
+	cmdb->bindSampler(0, 0, m_r->getSamplers().m_trilinearClamp);
+	rgraphCtx.bindColorTexture(0, 1, m_runCtx.m_rts[1]);
+
+	RenderTargetHandle depthRt;
+	TextureSubresourceInfo depthSubresource;
+	getDepthRt(depthRt, depthSubresource);
+	rgraphCtx.bindTexture(0, 2, depthRt, depthSubresource);
+
+	rgraphCtx.bindImage(0, 3, m_runCtx.m_upsampleRt, TextureSubresourceInfo());
+	rgraphCtx.bindTexture(
+		0, 4, m_r->getGBuffer().getDepthRt(), TextureSubresourceInfo(DepthStencilAspectBit::DEPTH));
+
+	dispatchPPCompute(
+		cmdb, m_upsample.m_workgroupSize[0], m_upsample.m_workgroupSize[1], m_r->getWidth(), m_r->getHeight());
+}
+
+void Ssao::getDepthRt(RenderTargetHandle& rt, TextureSubresourceInfo& subresource) const
+{
+	if(m_resolutionDivisor == 1)
+	{
+		rt = m_r->getGBuffer().getDepthRt();
+		subresource = TextureSubresourceInfo(DepthStencilAspectBit::DEPTH);
+	}
+	else
+	{
+		rt = m_r->getDepthDownscale().getHiZRt();
+		subresource = (m_resolutionDivisor == 2) ? HIZ_HALF_DEPTH : HIZ_QUARTER_DEPTH;
+	}
+}
+
 void Ssao::populateRenderGraph(RenderingContext& ctx)
 {
 	m_runCtx.m_ctx = &ctx;
@@ -198,18 +366,23 @@ void Ssao::populateRenderGraph(RenderingContext& ctx)
 	m_runCtx.m_rts[0] = rgraph.newRenderTarget(m_rtDescrs[0]);
 	m_runCtx.m_rts[1] = rgraph.newRenderTarget(m_rtDescrs[1]);
 
+	RenderTargetHandle depthRt;
+	TextureSubresourceInfo depthSubresource;
+	getDepthRt(depthRt, depthSubresource);
+
 	// Create main render pass
 	{
 		if(m_useCompute)
 		{
 			ComputeRenderPassDescription& pass = rgraph.newComputeRenderPass("SSAO main");
+			pass.setAsyncCompute();
 
 			if(m_useNormal)
 			{
 				pass.newDependency({m_r->getGBuffer().getColorRt(2), TextureUsageBit::SAMPLED_COMPUTE});
 			}
 
-			pass.newDependency({m_r->getDepthDownscale().getHiZRt(), TextureUsageBit::SAMPLED_COMPUTE, HIZ_HALF_DEPTH});
+			pass.newDependency({depthRt, TextureUsageBit::SAMPLED_COMPUTE, depthSubresource});
 			pass.newDependency({m_runCtx.m_rts[0], TextureUsageBit::IMAGE_COMPUTE_WRITE});
 
 			pass.setWork(
@@ -231,8 +404,7 @@ void Ssao::populateRenderGraph(RenderingContext& ctx)
 				pass.newDependency({m_r->getGBuffer().getColorRt(2), TextureUsageBit::SAMPLED_FRAGMENT});
 			}
 
-			pass.newDependency(
-				{m_r->getDepthDownscale().getHiZRt(), TextureUsageBit::SAMPLED_FRAGMENT, HIZ_HALF_DEPTH});
+			pass.newDependency({depthRt, TextureUsageBit::SAMPLED_FRAGMENT, depthSubresource});
 			pass.newDependency({m_runCtx.m_rts[0], TextureUsageBit::FRAMEBUFFER_ATTACHMENT_WRITE});
 
 			pass.setWork(
@@ -245,11 +417,41 @@ void Ssao::populateRenderGraph(RenderingContext& ctx)
 		}
 	}
 
+	// Create temporal pass
+	if(m_temporal.m_enabled)
+	{
+		// Last frame's result is the history
+		const U32 crntRtIdx = m_r->getFrameCount() & 1;
+		m_runCtx.m_temporalRt =
+			rgraph.importRenderTarget(m_temporal.m_rtTextures[crntRtIdx], TextureUsageBit::SAMPLED_COMPUTE);
+		m_runCtx.m_historyRt =
+			rgraph.importRenderTarget(m_temporal.m_rtTextures[!crntRtIdx], TextureUsageBit::SAMPLED_COMPUTE);
+
+		ComputeRenderPassDescription& pass = rgraph.newComputeRenderPass("SSAO temporal");
+		pass.setAsyncCompute();
+
+		pass.setWork(
+			[](RenderPassWorkContext& rgraphCtx) {
+				Ssao* const self = static_cast<Ssao*>(rgraphCtx.m_userData);
+				self->runTemporal(*self->m_runCtx.m_ctx, rgraphCtx);
+			},
+			this,
+			0);
+
+		pass.newDependency({m_runCtx.m_temporalRt, TextureUsageBit::IMAGE_COMPUTE_WRITE});
+		pass.newDependency({m_runCtx.m_historyRt, TextureUsageBit::SAMPLED_COMPUTE});
+		pass.newDependency({m_runCtx.m_rts[0], TextureUsageBit::SAMPLED_COMPUTE});
+		pass.newDependency({depthRt, TextureUsageBit::SAMPLED_COMPUTE, depthSubresource});
+	}
+
+	const RenderTargetHandle blurInRt = (m_temporal.m_enabled) ? m_runCtx.m_temporalRt : m_runCtx.m_rts[0];
+
 	// Create Blur pass
 	{
 		if(m_blurUseCompute)
 		{
 			ComputeRenderPassDescription& pass = rgraph.newComputeRenderPass("SSAO blur");
+			pass.setAsyncCompute();
 
 			pass.setWork(
 				[](RenderPassWorkContext& rgraphCtx) {
@@ -260,7 +462,7 @@ void Ssao::populateRenderGraph(RenderingContext& ctx)
 				0);
 
 			pass.newDependency({m_runCtx.m_rts[1], TextureUsageBit::IMAGE_COMPUTE_WRITE});
-			pass.newDependency({m_runCtx.m_rts[0], TextureUsageBit::SAMPLED_COMPUTE});
+			pass.newDependency({blurInRt, TextureUsageBit::SAMPLED_COMPUTE});
 		}
 		else
 		{
@@ -276,9 +478,33 @@ void Ssao::populateRenderGraph(RenderingContext& ctx)
 			pass.setFramebufferInfo(m_fbDescr, {{m_runCtx.m_rts[1]}}, {});
 
 			pass.newDependency({m_runCtx.m_rts[1], TextureUsageBit::FRAMEBUFFER_ATTACHMENT_WRITE});
-			pass.newDependency({m_runCtx.m_rts[0], TextureUsageBit::SAMPLED_FRAGMENT});
+			pass.newDependency({blurInRt, TextureUsageBit::SAMPLED_FRAGMENT});
 		}
 	}
+
+	// Create upsample pass
+	if(m_upsample.m_enabled)
+	{
+		m_runCtx.m_upsampleRt = rgraph.newRenderTarget(m_upsample.m_rtDescr);
+
+		ComputeRenderPassDescription& pass = rgraph.newComputeRenderPass("SSAO upsample");
+		pass.setAsyncCompute();
+
+		pass.setWork(
+			[](RenderPassWorkContext& rgraphCtx) {
+				Ssao* const self = static_cast<Ssao*>(rgraphCtx.m_userData);
+				self->runUpsample(rgraphCtx);
+			},
+			this,
+			0);
+
+		pass.newDependency({m_runCtx.m_upsampleRt, TextureUsageBit::IMAGE_COMPUTE_WRITE});
+		pass.newDependency({m_runCtx.m_rts[1], TextureUsageBit::SAMPLED_COMPUTE});
+		pass.newDependency({depthRt, TextureUsageBit::SAMPLED_COMPUTE, depthSubresource});
+		pass.newDependency({m_r->getGBuffer().getDepthRt(),
+			TextureUsageBit::SAMPLED_COMPUTE,
+			TextureSubresourceInfo(DepthStencilAspectBit::DEPTH)});
+	}
 }
 
 } // end namespace anki
@@ -33,9 +33,10 @@ public:
 	/// Populate the rendergraph.
 	void populateRenderGraph(RenderingContext& ctx);
 
+	/// Get the final SSAO. It's at the rendering resolution if the bilateral upsample is enabled.
 	RenderTargetHandle getRt() const
 	{
-		return m_runCtx.m_rts[1];
+		return (m_upsample.m_enabled) ? m_runCtx.m_upsampleRt : m_runCtx.m_rts[1];
 	}
 
 private:
@@ -44,6 +45,7 @@ private:
 	static const Bool m_useSoftBlur = true;
 	static const Bool m_blurUseCompute = true;
 	U32 m_width, m_height;
+	U32 m_resolutionDivisor = 2; ///< The SSAO is that many times smaller than the rendering resolution.
 
 	class
 	{
@@ -62,10 +64,35 @@ private:
 		Array<U32, 2> m_workgroupSize = {};
 	} m_blur; ///< Box blur.
 
+	class
+	{
+	public:
+		ShaderProgramResourcePtr m_prog;
+		ShaderProgramPtr m_grProg;
+		Array<U32, 2> m_workgroupSize = {};
+		Array<TexturePtr, 2> m_rtTextures; ///< Ping-pong. One is the history of the other.
+		F32 m_historyBlendFactor = 1.0f;
+		Bool m_checkerboard = false; ///< The main pass computes half of the pixels every frame.
+		Bool m_enabled = false;
+	} m_temporal; ///< Accumulates the SSAO over the frames.
+
+	class
+	{
+	public:
+		ShaderProgramResourcePtr m_prog;
+		ShaderProgramPtr m_grProg;
+		Array<U32, 2> m_workgroupSize = {};
+		RenderTargetDescription m_rtDescr;
+		Bool m_enabled = false;
+	} m_upsample; ///< Depth aware upsample to the rendering resolution.
+
 	class
 	{
 	public:
 		Array<RenderTargetHandle, 2> m_rts;
+		RenderTargetHandle m_temporalRt;
+		RenderTargetHandle m_historyRt;
+		RenderTargetHandle m_upsampleRt;
 		const RenderingContext* m_ctx = nullptr;
 	} m_runCtx; ///< Runtime context.
 
@@ -74,9 +101,16 @@ private:
 
 	ANKI_USE_RESULT Error initMain(const ConfigSet& set);
 	ANKI_USE_RESULT Error initBlur(const ConfigSet& set);
+	ANKI_USE_RESULT Error initTemporal(const ConfigSet& set);
+	ANKI_USE_RESULT Error initUpsample(const ConfigSet& set);
 
 	void runMain(const RenderingContext& ctx, RenderPassWorkContext& rgraphCtx);
 	void runBlur(RenderPassWorkContext& rgraphCtx);
+	void runTemporal(const RenderingContext& ctx, RenderPassWorkContext& rgraphCtx);
+	void runUpsample(RenderPassWorkContext& rgraphCtx);
+
+	/// Get the depth buffer that has the size of the SSAO.
+	void getDepthRt(RenderTargetHandle& rt, TextureSubresourceInfo& subresource) const;
 };
 /// @}
 
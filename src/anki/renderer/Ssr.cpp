@@ -34,7 +34,8 @@ Error Ssr::initInternal(const ConfigSet& cfg)
 	const U32 width = m_r->getWidth();
 	const U32 height = m_r->getHeight();
 	ANKI_R_LOGI("Initializing SSR pass (%ux%u)", width, height);
-	m_maxSteps = cfg.getNumberU32("r_ssrMaxSteps");
+	applyConfig(cfg);
+	const Bool hiz = cfg.getBool(ConfigOption::r_ssrHiZ);
 
 	ANKI_CHECK(getResourceManager().loadResource("engine_data/BlueNoiseRgb816x16.png", m_noiseTex));
 
@@ -42,16 +43,18 @@ Error Ssr::initInternal(const ConfigSet& cfg)
 	TextureInitInfo texinit = m_r->create2DRenderTargetInitInfo(width,
 		height,
 		Format::R16G16B16A16_SFLOAT,
-		TextureUsageBit::IMAGE_COMPUTE_READ_WRITE | TextureUsageBit::SAMPLED_FRAGMENT,
+		TextureUsageBit::IMAGE_COMPUTE_WRITE | TextureUsageBit::SAMPLED_COMPUTE | TextureUsageBit::SAMPLED_FRAGMENT,
 		"SSR");
 	texinit.m_initialUsage = TextureUsageBit::SAMPLED_FRAGMENT;
-	m_rt = m_r->createAndClearRenderTarget(texinit);
+	m_rts[0] = m_r->createAndClearRenderTarget(texinit);
+	m_rts[1] = m_r->createAndClearRenderTarget(texinit);
 
 	// Create shader
 	ANKI_CHECK(getResourceManager().loadResource("shaders/Ssr.ankiprog", m_prog));
 
 	ShaderProgramResourceVariantInitInfo variantInitInfo(m_prog);
 	variantInitInfo.addMutation("VARIANT", 0);
+	variantInitInfo.addMutation("HIZ", hiz);
 
 	const ShaderProgramResourceVariant* variant;
 	m_prog->getOrCreateVariant(variantInitInfo, variant);
@@ -66,20 +69,30 @@ Error Ssr::initInternal(const ConfigSet& cfg)
 	return Error::NONE;
 }
 
+void Ssr::applyConfig(const ConfigSet& cfg)
+{
+	m_maxSteps = cfg.getNumberU32(ConfigOption::r_ssrMaxSteps);
+	m_roughnessCutoff = cfg.getNumberF32(ConfigOption::r_ssrRoughnessCutoff);
+	m_historyBlendFactor = cfg.getNumberF32(ConfigOption::r_ssrHistoryBlendFactor);
+}
+
 void Ssr::populateRenderGraph(RenderingContext& ctx)
 {
 	RenderGraphDescription& rgraph = ctx.m_renderGraphDescr;
 	m_runCtx.m_ctx = &ctx;
 
-	// Create RTs
-	m_runCtx.m_rt = rgraph.importRenderTarget(m_rt, TextureUsageBit::SAMPLED_FRAGMENT);
+	// Import RTs. Last frame's result is the history
+	const U32 crntRtIdx = m_r->getFrameCount() & 1;
+	m_runCtx.m_rt = rgraph.importRenderTarget(m_rts[crntRtIdx], TextureUsageBit::SAMPLED_FRAGMENT);
+	m_runCtx.m_historyRt = rgraph.importRenderTarget(m_rts[!crntRtIdx], TextureUsageBit::SAMPLED_FRAGMENT);
 
 	// Create pass
 	ComputeRenderPassDescription& rpass = rgraph.newComputeRenderPass("SSR");
 	rpass.setWork(
 		[](RenderPassWorkContext& rgraphCtx) { static_cast<Ssr*>(rgraphCtx.m_userData)->run(rgraphCtx); }, this, 0);
 
-	rpass.newDependency({m_runCtx.m_rt, TextureUsageBit::IMAGE_COMPUTE_READ_WRITE});
+	rpass.newDependency({m_runCtx.m_rt, TextureUsageBit::IMAGE_COMPUTE_WRITE});
+	rpass.newDependency({m_runCtx.m_historyRt, TextureUsageBit::SAMPLED_COMPUTE});
 	rpass.newDependency({m_r->getGBuffer().getColorRt(1), TextureUsageBit::SAMPLED_COMPUTE});
 	rpass.newDependency({m_r->getGBuffer().getColorRt(2), TextureUsageBit::SAMPLED_COMPUTE});
 
@@ -106,6 +119,8 @@ void Ssr::run(RenderPassWorkContext& rgraphCtx)
 	unis->m_depthMipCount = m_r->getDepthDownscale().getMipmapCount();
 	unis->m_maxSteps = m_maxSteps;
 	unis->m_lightBufferMipCount = m_r->getDownscaleBlur().getMipmapCount();
+	unis->m_roughnessCutoff = m_roughnessCutoff;
+	unis->m_historyBlendFactor = m_historyBlendFactor;
 	unis->m_prevViewProjMatMulInvViewProjMat =
 		ctx.m_prevMatrices.m_viewProjection * ctx.m_matrices.m_viewProjectionJitter.getInverse();
 	unis->m_projMat = ctx.m_matrices.m_projectionJitter;
@@ -127,6 +142,8 @@ void Ssr::run(RenderPassWorkContext& rgraphCtx)
 	cmdb->bindSampler(0, 7, m_r->getSamplers().m_trilinearRepeat);
 	cmdb->bindTexture(0, 8, m_noiseTex->getGrTextureView(), TextureUsageBit::SAMPLED_ALL);
 
+	rgraphCtx.bindColorTexture(0, 9, m_runCtx.m_historyRt);
+
 	// Dispatch
 	dispatchPPCompute(cmdb, m_workgroupSize[0], m_workgroupSize[1], m_r->getWidth() / 2, m_r->getHeight());
 }
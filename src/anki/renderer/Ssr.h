@@ -26,6 +26,9 @@ public:
 
 	ANKI_USE_RESULT Error init(const ConfigSet& cfg);
 
+	/// Read the options that don't need new resources.
+	void applyConfig(const ConfigSet& cfg);
+
 	/// Populate the rendergraph.
 	void populateRenderGraph(RenderingContext& ctx);
 
@@ -38,16 +41,19 @@ private:
 	ShaderProgramResourcePtr m_prog;
 	Array<ShaderProgramPtr, 2> m_grProg;
 
-	TexturePtr m_rt;
+	Array<TexturePtr, 2> m_rts; ///< Ping-pong. One is the history of the other.
 	TextureResourcePtr m_noiseTex;
 
 	Array<U32, 2> m_workgroupSize = {};
 	U32 m_maxSteps = 32;
+	F32 m_roughnessCutoff = 1.0f;
+	F32 m_historyBlendFactor = 1.0f;
 
 	class
 	{
 	public:
 		RenderTargetHandle m_rt;
+		RenderTargetHandle m_historyRt;
 		RenderingContext* m_ctx ANKI_DEBUG_CODE(= nullptr);
 	} m_runCtx;
 
@@ -38,16 +38,34 @@ Error TemporalAA::initInternal(const ConfigSet& config)
 {
 	ANKI_CHECK(m_r->getResourceManager().loadResource("shaders/TemporalAAResolve.ankiprog", m_prog));
 
+	// When upscaling the output size is known later
+	initOutput(UVec2(m_r->getWidth(), m_r->getHeight()));
+
+	return Error::NONE;
+}
+
+void TemporalAA::initOutput(const UVec2& outSize)
+{
+	m_outSize = outSize;
+	m_upscale = m_outSize != UVec2(m_r->getWidth(), m_r->getHeight());
+
+	if(m_upscale)
+	{
+		ANKI_R_LOGI("TAA will upscale from %ux%u to %ux%u", m_r->getWidth(), m_r->getHeight(), outSize.x(), outSize.y());
+	}
+
 	for(U32 i = 0; i < 2; ++i)
 	{
 		ShaderProgramResourceVariantInitInfo variantInitInfo(m_prog);
 		variantInitInfo.addConstant("VARIANCE_CLIPPING_GAMMA", 1.7f);
 		variantInitInfo.addConstant("BLEND_FACTOR", 1.0f / 16.0f);
-		variantInitInfo.addConstant("FB_SIZE", UVec2(m_r->getWidth(), m_r->getHeight()));
+		variantInitInfo.addConstant("FB_SIZE", m_outSize);
+		variantInitInfo.addConstant("INPUT_SIZE", UVec2(m_r->getWidth(), m_r->getHeight()));
 		variantInitInfo.addMutation("SHARPEN", i + 1);
 		variantInitInfo.addMutation("VARIANCE_CLIPPING", 1);
 		variantInitInfo.addMutation("TONEMAP_FIX", 1);
 		variantInitInfo.addMutation("YCBCR", 0);
+		variantInitInfo.addMutation("UPSCALE", m_upscale);
 
 		const ShaderProgramResourceVariant* variant;
 		m_prog->getOrCreateVariant(variantInitInfo, variant);
@@ -59,8 +77,8 @@ Error TemporalAA::initInternal(const ConfigSet& config)
 
 	for(U i = 0; i < 2; ++i)
 	{
-		TextureInitInfo texinit = m_r->create2DRenderTargetInitInfo(m_r->getWidth(),
-			m_r->getHeight(),
+		TextureInitInfo texinit = m_r->create2DRenderTargetInitInfo(m_outSize.x(),
+			m_outSize.y(),
 			LIGHT_SHADING_COLOR_ATTACHMENT_PIXEL_FORMAT,
 			TextureUsageBit::SAMPLED_FRAGMENT | TextureUsageBit::SAMPLED_COMPUTE | TextureUsageBit::IMAGE_COMPUTE_WRITE,
 			"TemporalAA");
@@ -69,8 +87,6 @@ Error TemporalAA::initInternal(const ConfigSet& config)
 
 		m_rtTextures[i] = m_r->createAndClearRenderTarget(texinit);
 	}
-
-	return Error::NONE;
 }
 
 void TemporalAA::run(const RenderingContext& ctx, RenderPassWorkContext& rgraphCtx)
@@ -87,11 +103,30 @@ void TemporalAA::run(const RenderingContext& ctx, RenderPassWorkContext& rgraphC
 	rgraphCtx.bindImage(0, 5, m_runCtx.m_renderRt, TextureSubresourceInfo());
 	rgraphCtx.bindUniformBuffer(0, 6, m_r->getTonemapping().getAverageLuminanceBuffer());
 
-	const Mat4 mat = ctx.m_matrices.m_jitter * ctx.m_prevMatrices.m_viewProjection
-					 * ctx.m_matrices.m_viewProjectionJitter.getInverse();
-	cmdb->setPushConstants(&mat, sizeof(mat));
+	struct PushConsts
+	{
+		Mat4 m_prevViewProjMatMulInvViewProjMat;
+		Vec2 m_jitterUv;
+		Vec2 m_padding;
+	} pconsts;
+
+	if(m_upscale)
+	{
+		// The history is not jittered when upscaling. The jitter moves the samples of the input inside the output pixels
+		pconsts.m_prevViewProjMatMulInvViewProjMat =
+			ctx.m_prevMatrices.m_viewProjection * ctx.m_matrices.m_viewProjection.getInverse();
+		pconsts.m_jitterUv = Vec2(ctx.m_matrices.m_jitter(0, 3), ctx.m_matrices.m_jitter(1, 3)) * 0.5f;
+	}
+	else
+	{
+		pconsts.m_prevViewProjMatMulInvViewProjMat = ctx.m_matrices.m_jitter * ctx.m_prevMatrices.m_viewProjection
+													 * ctx.m_matrices.m_viewProjectionJitter.getInverse();
+		pconsts.m_jitterUv = Vec2(0.0f);
+	}
+	pconsts.m_padding = Vec2(0.0f);
+	cmdb->setPushConstants(&pconsts, sizeof(pconsts));
 
-	dispatchPPCompute(cmdb, m_workgroupSize[0], m_workgroupSize[1], m_r->getWidth(), m_r->getHeight());
+	dispatchPPCompute(cmdb, m_workgroupSize[0], m_workgroupSize[1], m_outSize.x(), m_outSize.y());
 }
 
 void TemporalAA::populateRenderGraph(RenderingContext& ctx)
@@ -99,6 +134,17 @@ void TemporalAA::populateRenderGraph(RenderingContext& ctx)
 	m_runCtx.m_ctx = &ctx;
 	RenderGraphDescription& rgraph = ctx.m_renderGraphDescr;
 
+	// Reconstruct at the size of the output
+	if(m_r->getTemporalUpscalingEnabled())
+	{
+		const UVec2 outSize(max(m_r->getWidth(), ctx.m_outRenderTargetWidth),
+			max(m_r->getHeight(), ctx.m_outRenderTargetHeight));
+		if(outSize != m_outSize)
+		{
+			initOutput(outSize);
+		}
+	}
+
 	// Import RTs
 	m_runCtx.m_historyRt =
 		rgraph.importRenderTarget(m_rtTextures[(m_r->getFrameCount() + 1) & 1], TextureUsageBit::SAMPLED_FRAGMENT);
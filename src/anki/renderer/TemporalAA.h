@@ -38,6 +38,9 @@ private:
 
 	Array<U32, 2> m_workgroupSize = {};
 
+	UVec2 m_outSize = UVec2(0u); ///< The size of the RTs. Bigger than the renderer's when upscaling.
+	Bool m_upscale = false;
+
 	class
 	{
 	public:
@@ -48,6 +51,9 @@ private:
 
 	ANKI_USE_RESULT Error initInternal(const ConfigSet& cfg);
 
+	/// Create the RTs and the programs for a specific output size.
+	void initOutput(const UVec2& outSize);
+
 	void run(const RenderingContext& ctx, RenderPassWorkContext& rgraphCtx);
 };
 /// @}
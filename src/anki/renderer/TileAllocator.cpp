@@ -18,6 +18,7 @@ public:
 	Array<U32, 4> m_viewport = {};
 	Array<U32, 4> m_subTiles = {{MAX_U32, MAX_U32, MAX_U32, MAX_U32}};
 	U32 m_superTile = MAX_U32;
+	U32 m_lruLeaf = MAX_U32; ///< The leaf of the tile in the LRU tree of its LOD.
 	U8 m_lightLod = 0;
 	U8 m_lightFace = 0;
 };
@@ -34,11 +35,29 @@ public:
 	}
 };
 
+/// Interleave the bits of x and y.
+static U32 computeMortonCode(U32 x, U32 y)
+{
+	auto spreadBits = [](U32 v) {
+		v &= 0xFFFF;
+		v = (v | (v << 8)) & 0x00FF00FF;
+		v = (v | (v << 4)) & 0x0F0F0F0F;
+		v = (v | (v << 2)) & 0x33333333;
+		v = (v | (v << 1)) & 0x55555555;
+		return v;
+	};
+
+	return spreadBits(x) | (spreadBits(y) << 1);
+}
+
 TileAllocator::~TileAllocator()
 {
 	m_lightInfoToTileIdx.destroy(m_alloc);
 	m_allTiles.destroy(m_alloc);
 	m_lodFirstTileIndex.destroy(m_alloc);
+	m_lruNodes.destroy(m_alloc);
+	m_lodFirstLruNode.destroy(m_alloc);
+	m_lodLruLeafCount.destroy(m_alloc);
 }
 
 void TileAllocator::init(HeapAllocator<U8> alloc, U32 tileCountX, U32 tileCountY, U32 lodCount, Bool enableCaching)
@@ -115,6 +134,63 @@ void TileAllocator::init(HeapAllocator<U8> alloc, U32 tileCountX, U32 tileCountY
 			}
 		}
 	}
+
+	// Create the LRU trees. The leafs are the Morton codes of the tiles so the leaf count is the square of the
+	// smallest power of two that covers both axis
+	m_lodFirstLruNode.create(m_alloc, lodCount);
+	m_lodLruLeafCount.create(m_alloc, lodCount);
+	U32 lruNodeCount = 0;
+	for(U32 lod = 0; lod < lodCount; ++lod)
+	{
+		const U32 side = nextPowerOfTwo(max(tileCountX >> lod, tileCountY >> lod));
+		m_lodFirstLruNode[lod] = lruNodeCount;
+		m_lodLruLeafCount[lod] = side * side;
+		lruNodeCount += side * side * 2;
+	}
+
+	m_lruNodes.create(m_alloc, lruNodeCount, LruNode{MAX_TIMESTAMP, MAX_U32});
+
+	for(U32 lod = 0; lod < lodCount; ++lod)
+	{
+		LruNode* nodes = &m_lruNodes[m_lodFirstLruNode[lod]];
+		const U32 leafCount = m_lodLruLeafCount[lod];
+
+		const U32 lodTileCount = (tileCountX >> lod) * (tileCountY >> lod);
+		for(U32 idx = m_lodFirstTileIndex[lod]; idx < m_lodFirstTileIndex[lod] + lodTileCount; ++idx)
+		{
+			Tile& tile = m_allTiles[idx];
+			tile.m_lruLeaf = computeMortonCode(tile.m_viewport[0] >> lod, tile.m_viewport[1] >> lod);
+			ANKI_ASSERT(tile.m_lruLeaf < leafCount);
+			nodes[leafCount + tile.m_lruLeaf] = LruNode{0, idx};
+		}
+
+		// Build the rest of the tree. On equal timestamps the left child wins so the tiles are allocated in Morton order
+		for(U32 node = leafCount - 1; node > 0; --node)
+		{
+			const LruNode& left = nodes[node * 2];
+			const LruNode& right = nodes[node * 2 + 1];
+			nodes[node] = (right.m_lastUsedTimestamp < left.m_lastUsedTimestamp) ? right : left;
+		}
+	}
+}
+
+void TileAllocator::setLastUsedTimestamp(U32 tileIdx, Timestamp timestamp)
+{
+	Tile& tile = m_allTiles[tileIdx];
+	tile.m_lastUsedTimestamp = timestamp;
+
+	const U32 lod = U32(__builtin_ctz(tile.m_viewport[2]));
+	LruNode* nodes = &m_lruNodes[m_lodFirstLruNode[lod]];
+	U32 node = m_lodLruLeafCount[lod] + tile.m_lruLeaf;
+	nodes[node].m_lastUsedTimestamp = timestamp;
+
+	// Walk up the tree
+	for(node /= 2; node > 0; node /= 2)
+	{
+		const LruNode& left = nodes[node * 2];
+		const LruNode& right = nodes[node * 2 + 1];
+		nodes[node] = (right.m_lastUsedTimestamp < left.m_lastUsedTimestamp) ? right : left;
+	}
 }
 
 void TileAllocator::updateSubTiles(const Tile& updateFrom)
@@ -127,7 +203,7 @@ void TileAllocator::updateSubTiles(const Tile& updateFrom)
 	for(U32 idx : updateFrom.m_subTiles)
 	{
 		m_allTiles[idx].m_lightTimestamp = updateFrom.m_lightTimestamp;
-		m_allTiles[idx].m_lastUsedTimestamp = updateFrom.m_lastUsedTimestamp;
+		setLastUsedTimestamp(idx, updateFrom.m_lastUsedTimestamp);
 		m_allTiles[idx].m_lightUuid = updateFrom.m_lightUuid;
 		m_allTiles[idx].m_lightDrawcallCount = updateFrom.m_lightDrawcallCount;
 		m_allTiles[idx].m_lightLod = updateFrom.m_lightLod;
@@ -142,94 +218,11 @@ void TileAllocator::updateSuperTiles(const Tile& updateFrom)
 	if(updateFrom.m_superTile != MAX_U32)
 	{
 		m_allTiles[updateFrom.m_superTile].m_lightUuid = 0;
-		m_allTiles[updateFrom.m_superTile].m_lastUsedTimestamp = updateFrom.m_lastUsedTimestamp;
+		setLastUsedTimestamp(updateFrom.m_superTile, updateFrom.m_lastUsedTimestamp);
 		updateSuperTiles(m_allTiles[updateFrom.m_superTile]);
 	}
 }
 
-Bool TileAllocator::searchTileRecursively(U32 crntTileIdx,
-	U32 crntTileLod,
-	U32 allocationLod,
-	Timestamp crntTimestamp,
-	U32& emptyTileIdx,
-	U32& toKickTileIdx,
-	Timestamp& tileToKickMinTimestamp) const
-{
-	const Tile& tile = m_allTiles[crntTileIdx];
-
-	if(crntTileLod == allocationLod)
-	{
-		// We may have a candidate
-
-		const Bool done =
-			evaluateCandidate(crntTileIdx, crntTimestamp, emptyTileIdx, toKickTileIdx, tileToKickMinTimestamp);
-
-		if(done)
-		{
-			return true;
-		}
-	}
-	else if(tile.m_subTiles[0] != MAX_U32)
-	{
-		// Move down the hierarchy
-
-		ANKI_ASSERT(allocationLod < crntTileLod);
-
-		for(const U32 idx : tile.m_subTiles)
-		{
-			const Bool done = searchTileRecursively(idx,
-				crntTileLod >> 1,
-				allocationLod,
-				crntTimestamp,
-				emptyTileIdx,
-				toKickTileIdx,
-				tileToKickMinTimestamp);
-
-			if(done)
-			{
-				return true;
-			}
-		}
-	}
-
-	return false;
-}
-
-Bool TileAllocator::evaluateCandidate(U32 tileIdx,
-	Timestamp crntTimestamp,
-	U32& emptyTileIdx,
-	U32& toKickTileIdx,
-	Timestamp& tileToKickMinTimestamp) const
-{
-	const Tile& tile = m_allTiles[tileIdx];
-
-	if(m_cachingEnabled)
-	{
-		if(tile.m_lastUsedTimestamp == 0)
-		{
-			// Found empty
-			emptyTileIdx = tileIdx;
-			return true;
-		}
-		else if(tile.m_lastUsedTimestamp != crntTimestamp && tile.m_lastUsedTimestamp < tileToKickMinTimestamp)
-		{
-			// Found one with low timestamp
-			toKickTileIdx = tileIdx;
-			tileToKickMinTimestamp = tile.m_lightTimestamp;
-		}
-	}
-	else
-	{
-		if(tile.m_lastUsedTimestamp != crntTimestamp)
-		{
-			emptyTileIdx = tileIdx;
-			return true;
-		}
-	}
-
-	return false;
-}
-
 TileAllocatorResult TileAllocator::allocate(Timestamp crntTimestamp,
 	Timestamp lightTimestamp,
 	U64 lightUuid,
@@ -277,7 +270,7 @@ TileAllocatorResult TileAllocator::allocate(Timestamp crntTimestamp,
 					tile.m_lightDrawcallCount != drawcallCount || tile.m_lightTimestamp != lightTimestamp;
 
 				tile.m_lightTimestamp = lightTimestamp;
-				tile.m_lastUsedTimestamp = crntTimestamp;
+				setLastUsedTimestamp(*it, crntTimestamp);
 				tile.m_lightDrawcallCount = drawcallCount;
 
 				updateTileHierarchy(tile);
@@ -287,64 +280,23 @@ TileAllocatorResult TileAllocator::allocate(Timestamp crntTimestamp,
 		}
 	}
 
-	// Start searching for a suitable tile. Do a hieratchical search to end up with better locality and not better
-	// utilization of the atlas' space
-	U32 emptyTileIdx = MAX_U32;
-	U32 toKickTileIdx = MAX_U32;
-	Timestamp tileToKickMinTimestamp = MAX_TIMESTAMP;
-	const U32 maxLod = m_lodCount - 1;
-	if(lod == maxLod)
-	{
-		// This search is simple, iterate the tiles of the max LOD
-
-		for(U32 tileIdx = m_lodFirstTileIndex[maxLod]; tileIdx <= m_lodFirstTileIndex[maxLod + 1]; ++tileIdx)
-		{
-			const Bool done =
-				evaluateCandidate(tileIdx, crntTimestamp, emptyTileIdx, toKickTileIdx, tileToKickMinTimestamp);
-
-			if(done)
-			{
-				break;
-			}
-		}
-	}
-	else
-	{
-		// Need to do a recursive search
-
-		for(U32 tileIdx = m_lodFirstTileIndex[maxLod]; tileIdx <= m_lodFirstTileIndex[maxLod + 1]; ++tileIdx)
-		{
-			const Bool done = searchTileRecursively(
-				tileIdx, maxLod, lod, crntTimestamp, emptyTileIdx, toKickTileIdx, tileToKickMinTimestamp);
-
-			if(done)
-			{
-				break;
-			}
-		}
-	}
-
-	U32 allocatedTileIdx;
-	if(emptyTileIdx != MAX_U32)
-	{
-		allocatedTileIdx = emptyTileIdx;
-	}
-	else if(toKickTileIdx != MAX_U32)
-	{
-		allocatedTileIdx = toKickTileIdx;
-	}
-	else
+	// The root of the LRU tree of the LOD is the least recently used tile. The empty tiles have zero timestamp so they
+	// come first. A tile that was used in this timestamp means that all the tiles of the LOD are in use
+	const LruNode& root = m_lruNodes[m_lodFirstLruNode[lod] + 1];
+	if(root.m_lastUsedTimestamp == crntTimestamp || root.m_tileIdx == MAX_U32)
 	{
 		// Out of tiles
 		return TileAllocatorResult::ALLOCATION_FAILED;
 	}
 
+	const U32 allocatedTileIdx = root.m_tileIdx;
+
 	// Allocation succedded, need to do some bookkeeping
 
 	// Mark the allocated tile
 	Tile& allocatedTile = m_allTiles[allocatedTileIdx];
 	allocatedTile.m_lightTimestamp = lightTimestamp;
-	allocatedTile.m_lastUsedTimestamp = crntTimestamp;
+	setLastUsedTimestamp(allocatedTileIdx, crntTimestamp);
 	allocatedTile.m_lightUuid = lightUuid;
 	allocatedTile.m_lightDrawcallCount = drawcallCount;
 	allocatedTile.m_lightLod = U8(lod);
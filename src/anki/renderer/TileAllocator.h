@@ -6,6 +6,7 @@
 #pragma once
 
 #include <anki/renderer/Common.h>
+#include <anki/util/FlatHashMap.h>
 
 namespace anki
 {
@@ -21,7 +22,8 @@ enum class TileAllocatorResult : U32
 	ALLOCATION_SUCCEEDED ///< Allocation succeded but the tile needs update.
 };
 
-/// Allocates tiles out of a tilemap suitable for shadow mapping.
+/// Allocates tiles out of a tilemap suitable for shadow mapping. The tiles of every LOD are the leafs of a tree that
+/// keeps the least recently used tile of its sub-trees, so the allocation and the eviction are O(log n).
 class TileAllocator : public NonCopyable
 {
 public:
@@ -48,11 +50,25 @@ private:
 	/// A HashMap key.
 	class HashMapKey;
 
+	/// A node of the LRU tree of a LOD.
+	class LruNode
+	{
+	public:
+		Timestamp m_lastUsedTimestamp; ///< The min of the sub-tree.
+		U32 m_tileIdx; ///< The tile with the min timestamp.
+	};
+
 	HeapAllocator<U8> m_alloc;
 	DynamicArray<Tile> m_allTiles;
 	DynamicArray<U32> m_lodFirstTileIndex;
 
-	HashMap<HashMapKey, U32> m_lightInfoToTileIdx;
+	/// The LRU trees of all LODs. Every tree is a binary heap with the tiles of the LOD as leafs in Morton order. The
+	/// Morton order keeps the tiles that are close in the atlas close in the tree.
+	DynamicArray<LruNode> m_lruNodes;
+	DynamicArray<U32> m_lodFirstLruNode;
+	DynamicArray<U32> m_lodLruLeafCount;
+
+	FlatHashMap<HashMapKey, U32> m_lightInfoToTileIdx;
 
 	U16 m_tileCountX = 0; ///< Tile count for LOD 0
 	U16 m_tileCountY = 0; ///< Tile count for LOD 0
@@ -67,6 +83,9 @@ private:
 		return idx;
 	}
 
+	/// Set the timestamp of a tile and update the LRU tree of its LOD.
+	void setLastUsedTimestamp(U32 tileIdx, Timestamp timestamp);
+
 	void updateSubTiles(const Tile& updateFrom);
 
 	void updateSuperTiles(const Tile& updateFrom);
@@ -77,21 +96,6 @@ private:
 		updateSubTiles(updateFrom);
 		updateSuperTiles(updateFrom);
 	}
-
-	/// Search for a tile recursively.
-	Bool searchTileRecursively(U32 crntTileIdx,
-		U32 crntTileLod,
-		U32 allocationLod,
-		Timestamp crntTimestamp,
-		U32& emptyTileIdx,
-		U32& toKickTileIdx,
-		Timestamp& tileToKickMinTimestamp) const;
-
-	Bool evaluateCandidate(U32 tileIdx,
-		Timestamp crntTimestamp,
-		U32& emptyTileIdx,
-		U32& toKickTileIdx,
-		Timestamp& tileToKickMinTimestamp) const;
 };
 /// @}
 
@@ -6,6 +6,8 @@
 #include <anki/renderer/Tonemapping.h>
 #include <anki/renderer/DownscaleBlur.h>
 #include <anki/renderer/Renderer.h>
+#include <anki/core/ConfigSet.h>
+#include <anki/util/HighRezTimer.h>
 
 namespace anki
 {
@@ -31,12 +33,23 @@ Error Tonemapping::initInternal(const ConfigSet& initializer)
 	// Create program
 	ANKI_CHECK(getResourceManager().loadResource("shaders/TonemappingAverageLuminance.ankiprog", m_prog));
 
-	ShaderProgramResourceVariantInitInfo variantInitInfo(m_prog);
-	variantInitInfo.addConstant("INPUT_TEX_SIZE", UVec2(width, height));
+	// The subgroups reduce the workgroup in 2 steps so the number of subgroups can't be more than the subgroup size
+	const GpuDeviceCapabilities& caps = getGrManager().getDeviceCapabilities();
+	const Bool subgroupReduction = caps.m_subgroupArithmetic && caps.m_subgroupSize >= 32;
 
-	const ShaderProgramResourceVariant* variant;
-	m_prog->getOrCreateVariant(variantInitInfo, variant);
-	m_grProg = variant->getProgram();
+	for(U32 histogram = 0; histogram < 2; ++histogram)
+	{
+		ShaderProgramResourceVariantInitInfo variantInitInfo(m_prog);
+		variantInitInfo.addConstant("INPUT_TEX_SIZE", UVec2(width, height));
+		variantInitInfo.addMutation("SUBGROUP_REDUCTION", subgroupReduction ? 1 : 0);
+		variantInitInfo.addMutation("HISTOGRAM", I32(histogram));
+
+		const ShaderProgramResourceVariant* variant;
+		m_prog->getOrCreateVariant(variantInitInfo, variant);
+		m_grProgs[histogram] = variant->getProgram();
+	}
+
+	applyConfig(initializer);
 
 	// Create buffer
 	m_luminanceBuff = getGrManager().newBuffer(BufferInitInfo(sizeof(Vec4),
@@ -63,6 +76,12 @@ Error Tonemapping::initInternal(const ConfigSet& initializer)
 	return Error::NONE;
 }
 
+void Tonemapping::applyConfig(const ConfigSet& cfg)
+{
+	m_histogram = cfg.getBool(ConfigOption::r_tonemappingHistogram);
+	m_adaptationSpeed = cfg.getNumberF32(ConfigOption::r_tonemappingAdaptationSpeed);
+}
+
 void Tonemapping::importRenderTargets(RenderingContext& ctx)
 {
 	// Computation of the AVG luminance will run first in the frame and it will use the m_luminanceBuff as storage
@@ -75,8 +94,15 @@ void Tonemapping::populateRenderGraph(RenderingContext& ctx)
 {
 	RenderGraphDescription& rgraph = ctx.m_renderGraphDescr;
 
+	// Adapt to the new luminance at the same speed no matter the frame rate. Don't jump after long pauses
+	const Second now = HighRezTimer::getCurrentTime();
+	const Second dt = (m_prevRunTime < 0.0) ? 0.0 : min(now - m_prevRunTime, 0.1);
+	m_prevRunTime = now;
+	m_runCtx.m_adaptationFactor = 1.0f - F32(exp(-dt * m_adaptationSpeed));
+
 	// Create the pass
 	ComputeRenderPassDescription& pass = rgraph.newComputeRenderPass("Avg lum");
+	pass.setAsyncCompute();
 
 	pass.setWork(
 		[](RenderPassWorkContext& rgraphCtx) {
@@ -97,9 +123,12 @@ void Tonemapping::run(RenderPassWorkContext& rgraphCtx)
 {
 	CommandBufferPtr& cmdb = rgraphCtx.m_commandBuffer;
 
-	cmdb->bindShaderProgram(m_grProg);
+	cmdb->bindShaderProgram(m_grProgs[(m_histogram) ? 1 : 0]);
 	rgraphCtx.bindStorageBuffer(0, 1, m_runCtx.m_buffHandle);
 
+	const Vec4 pc(m_runCtx.m_adaptationFactor, 0.0f, 0.0f, 0.0f);
+	cmdb->setPushConstants(&pc, sizeof(pc));
+
 	TextureSubresourceInfo inputTexSubresource;
 	inputTexSubresource.m_firstMipmap = m_inputTexMip;
 	rgraphCtx.bindTexture(0, 0, m_r->getDownscaleBlur().getRt(), inputTexSubresource);
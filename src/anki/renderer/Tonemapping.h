@@ -24,6 +24,9 @@ public:
 
 	ANKI_USE_RESULT Error init(const ConfigSet& cfg);
 
+	/// Read the options that don't need new resources.
+	void applyConfig(const ConfigSet& cfg);
+
 	void importRenderTargets(RenderingContext& ctx);
 
 	/// Populate the rendergraph.
@@ -36,15 +39,20 @@ public:
 
 private:
 	ShaderProgramResourcePtr m_prog;
-	ShaderProgramPtr m_grProg;
+	Array<ShaderProgramPtr, 2> m_grProgs; ///< One that averages the luminance and one that uses a histogram.
 	U32 m_inputTexMip;
 
+	Bool m_histogram = false;
+	F32 m_adaptationSpeed = 0.0f; ///< Per second.
+	Second m_prevRunTime = -1.0;
+
 	BufferPtr m_luminanceBuff;
 
 	class
 	{
 	public:
 		RenderPassBufferHandle m_buffHandle;
+		F32 m_adaptationFactor;
 	} m_runCtx;
 
 	ANKI_USE_RESULT Error initInternal(const ConfigSet& cfg);
@@ -51,6 +51,8 @@ void UiStage::draw(U32 width, U32 height, RenderingContext& ctx, CommandBufferPt
 	}
 
 	m_canvas->appendToCommandBuffer(cmdb);
+	ANKI_TRACE_INC_COUNTER(UI_DRAWCALLS, m_canvas->getStatistics().m_drawcallCount);
+	ANKI_TRACE_INC_COUNTER(UI_GEOMETRY_UPLOADS, m_canvas->getStatistics().m_geometryUploaded);
 
 	// UI messes with the state, restore it
 	cmdb->setBlendFactors(0, BlendFactor::ONE, BlendFactor::ZERO);
@@ -95,6 +95,7 @@ void VolumetricFog::populateRenderGraph(RenderingContext& ctx)
 	m_runCtx.m_rt = rgraph.newRenderTarget(m_rtDescr);
 
 	ComputeRenderPassDescription& pass = rgraph.newComputeRenderPass("Vol fog");
+	pass.setAsyncCompute();
 
 	auto callback = [](RenderPassWorkContext& rgraphCtx) -> void {
 		static_cast<VolumetricFog*>(rgraphCtx.m_userData)->run(rgraphCtx);
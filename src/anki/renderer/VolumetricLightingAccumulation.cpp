@@ -6,6 +6,7 @@
 #include <anki/renderer/VolumetricLightingAccumulation.h>
 #include <anki/renderer/ShadowMapping.h>
 #include <anki/renderer/GlobalIllumination.h>
+#include <anki/renderer/GpuClusterBin.h>
 #include <anki/renderer/Renderer.h>
 #include <anki/resource/TextureResource.h>
 #include <anki/core/ConfigSet.h>
@@ -31,14 +32,20 @@ Error VolumetricLightingAccumulation::init(const ConfigSet& config)
 	ANKI_ASSERT(fractionZ >= 1);
 	m_finalClusterZ = config.getNumberU32("r_volumetricLightingAccumulationFinalClusterInZ");
 	ANKI_ASSERT(m_finalClusterZ > 0 && m_finalClusterZ < m_r->getClusterCount()[2]);
+	m_updateInterval = config.getNumberU32("r_volumetricLightingAccumulationUpdateInterval");
+
+	// The froxels are lit less often so give more weight to the new lighting to keep the same response time
+	m_historyBlendFactor = min(
+		1.0f, config.getNumberF32("r_volumetricLightingAccumulationHistoryBlendFactor") * F32(m_updateInterval));
 
 	m_volumeSize[0] = m_r->getClusterCount()[0] * fractionXY;
 	m_volumeSize[1] = m_r->getClusterCount()[1] * fractionXY;
 	m_volumeSize[2] = (m_finalClusterZ + 1) * fractionZ;
-	ANKI_R_LOGI("Initializing volumetric lighting accumulation. Size %ux%ux%u",
+	ANKI_R_LOGI("Initializing volumetric lighting accumulation. Size %ux%ux%u, update interval %u",
 		m_volumeSize[0],
 		m_volumeSize[1],
-		m_volumeSize[2]);
+		m_volumeSize[2],
+		m_updateInterval);
 
 	ANKI_CHECK(getResourceManager().loadResource("engine_data/blue_noise_rgb8_16x16x16_3d.ankitex", m_noiseTex));
 
@@ -54,6 +61,7 @@ Error VolumetricLightingAccumulation::init(const ConfigSet& config)
 	variantInitInfo.addConstant("FRACTION", UVec3(fractionXY, fractionXY, fractionZ));
 	variantInitInfo.addConstant(
 		"NOISE_TEX_SIZE", UVec3(m_noiseTex->getWidth(), m_noiseTex->getHeight(), m_noiseTex->getDepth()));
+	variantInitInfo.addConstant("UPDATE_INTERVAL", m_updateInterval);
 
 	const ShaderProgramResourceVariant* variant;
 	m_prog->getOrCreateVariant(variantInitInfo, variant);
@@ -87,6 +95,7 @@ void VolumetricLightingAccumulation::populateRenderGraph(RenderingContext& ctx)
 	m_runCtx.m_rts[1] = rgraph.importRenderTarget(m_rtTextures[!readRtIdx], TextureUsageBit::NONE);
 
 	ComputeRenderPassDescription& pass = rgraph.newComputeRenderPass("Vol light");
+	pass.setAsyncCompute();
 
 	auto callback = [](RenderPassWorkContext& rgraphCtx) -> void {
 		static_cast<VolumetricLightingAccumulation*>(rgraphCtx.m_userData)->run(rgraphCtx);
@@ -98,6 +107,7 @@ void VolumetricLightingAccumulation::populateRenderGraph(RenderingContext& ctx)
 	pass.newDependency({m_r->getShadowMapping().getShadowmapRt(), TextureUsageBit::SAMPLED_COMPUTE});
 
 	m_r->getGlobalIllumination().setRenderGraphDependencies(ctx, pass, TextureUsageBit::SAMPLED_COMPUTE);
+	m_r->getGpuClusterBin().setDependencies(pass, BufferUsageBit::STORAGE_COMPUTE_READ);
 }
 
 void VolumetricLightingAccumulation::run(RenderPassWorkContext& rgraphCtx)
@@ -132,9 +142,14 @@ void VolumetricLightingAccumulation::run(RenderPassWorkContext& rgraphCtx)
 
 	struct PushConsts
 	{
-		Vec3 m_padding;
+		F32 m_historyBlendFactor;
+		U32 m_updateIdx;
+		F32 m_padding;
 		F32 m_noiseOffset;
 	} regs;
+	regs.m_historyBlendFactor = m_historyBlendFactor;
+	regs.m_updateIdx = U32(m_r->getFrameCount() % m_updateInterval);
+	regs.m_padding = 0.0f;
 	const F32 texelSize = 1.0f / F32(m_noiseTex->getDepth());
 	regs.m_noiseOffset = texelSize * F32(m_r->getFrameCount() % m_noiseTex->getDepth()) + texelSize / 2.0f;
 
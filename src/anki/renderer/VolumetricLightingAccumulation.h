@@ -44,6 +44,8 @@ private:
 	TextureResourcePtr m_noiseTex;
 
 	U32 m_finalClusterZ = 0;
+	U32 m_updateInterval = 1;
+	F32 m_historyBlendFactor = 1.0f;
 
 	Array<U32, 3> m_workgroupSize = {};
 	Array<U32, 3> m_volumeSize;
@@ -0,0 +1,138 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/renderer/VrsSriGeneration.h>
+#include <anki/renderer/Renderer.h>
+#include <anki/renderer/GBuffer.h>
+#include <anki/renderer/TemporalAA.h>
+#include <anki/core/ConfigSet.h>
+
+namespace anki
+{
+
+VrsSriGeneration::~VrsSriGeneration()
+{
+}
+
+Error VrsSriGeneration::init(const ConfigSet& cfg)
+{
+	m_enabled = cfg.getBool("r_vrs");
+	if(!m_enabled)
+	{
+		return Error::NONE;
+	}
+
+	if(!getGrManager().getDeviceCapabilities().m_vrs)
+	{
+		ANKI_R_LOGW("Variable rate shading is not supported by the device or gr_vrs is off. Will not use it");
+		m_enabled = false;
+		return Error::NONE;
+	}
+
+	ANKI_R_LOGI("Initializing VRS SRI generation");
+
+	m_sriTexelSize = getGrManager().getDeviceCapabilities().m_minShadingRateImageTexelSize;
+	m_sriSize.x() = (m_r->getWidth() + m_sriTexelSize - 1) / m_sriTexelSize;
+	m_sriSize.y() = (m_r->getHeight() + m_sriTexelSize - 1) / m_sriTexelSize;
+	m_lumaContrastThreshold = cfg.getNumberF32("r_vrsLumaThreshold");
+	m_motionThreshold = cfg.getNumberF32("r_vrsMotionThreshold");
+
+	ANKI_CHECK(getResourceManager().loadResource("shaders/VrsSriGeneration.ankiprog", m_prog));
+
+	ShaderProgramResourceVariantInitInfo variantInitInfo(m_prog);
+	variantInitInfo.addConstant("FB_SIZE", UVec2(m_r->getWidth(), m_r->getHeight()));
+	variantInitInfo.addConstant("SRI_TEXEL_SIZE", m_sriTexelSize);
+	const ShaderProgramResourceVariant* variant;
+	m_prog->getOrCreateVariant(variantInitInfo, variant);
+	m_grProg = variant->getProgram();
+
+	// Not cleared. The passes use it after it's written once
+	const TextureInitInfo texInit = m_r->create2DRenderTargetInitInfo(m_sriSize.x(),
+		m_sriSize.y(),
+		Format::R8_UINT,
+		TextureUsageBit::IMAGE_COMPUTE_WRITE | TextureUsageBit::FRAMEBUFFER_SHADING_RATE,
+		"VrsSri");
+	m_sriTex = getGrManager().newTexture(texInit);
+
+	return Error::NONE;
+}
+
+void VrsSriGeneration::importRenderTargets(RenderingContext& ctx)
+{
+	m_runCtx.m_sriAvailable = m_enabled && m_sriWrittenOnce;
+	if(!m_enabled)
+	{
+		return;
+	}
+
+	RenderGraphDescription& rgraph = ctx.m_renderGraphDescr;
+	if(m_sriWrittenOnce)
+	{
+		m_runCtx.m_sriRt = rgraph.importRenderTarget(m_sriTex);
+	}
+	else
+	{
+		m_runCtx.m_sriRt = rgraph.importRenderTarget(m_sriTex, TextureUsageBit::NONE);
+	}
+}
+
+void VrsSriGeneration::populateRenderGraph(RenderingContext& ctx)
+{
+	if(!m_enabled)
+	{
+		return;
+	}
+
+	m_runCtx.m_ctx = &ctx;
+	m_sriWrittenOnce = true;
+
+	RenderGraphDescription& rgraph = ctx.m_renderGraphDescr;
+	ComputeRenderPassDescription& pass = rgraph.newComputeRenderPass("VRS SRI");
+
+	pass.setWork(
+		[](RenderPassWorkContext& rgraphCtx) { static_cast<VrsSriGeneration*>(rgraphCtx.m_userData)->run(rgraphCtx); },
+		this,
+		0);
+
+	pass.newDependency({m_runCtx.m_sriRt, TextureUsageBit::IMAGE_COMPUTE_WRITE});
+	pass.newDependency({m_r->getTemporalAA().getRt(), TextureUsageBit::SAMPLED_COMPUTE});
+	pass.newDependency({m_r->getGBuffer().getColorRt(3), TextureUsageBit::SAMPLED_COMPUTE});
+	pass.newDependency({m_r->getGBuffer().getDepthRt(),
+		TextureUsageBit::SAMPLED_COMPUTE,
+		TextureSubresourceInfo(DepthStencilAspectBit::DEPTH)});
+}
+
+void VrsSriGeneration::run(RenderPassWorkContext& rgraphCtx)
+{
+	const RenderingContext& ctx = *m_runCtx.m_ctx;
+	CommandBufferPtr& cmdb = rgraphCtx.m_commandBuffer;
+
+	cmdb->bindShaderProgram(m_grProg);
+
+	cmdb->bindSampler(0, 0, m_r->getSamplers().m_trilinearClamp);
+	rgraphCtx.bindColorTexture(0, 1, m_r->getTemporalAA().getRt());
+	rgraphCtx.bindColorTexture(0, 2, m_r->getGBuffer().getColorRt(3));
+	rgraphCtx.bindTexture(0, 3, m_r->getGBuffer().getDepthRt(), TextureSubresourceInfo(DepthStencilAspectBit::DEPTH));
+	rgraphCtx.bindImage(0, 4, m_runCtx.m_sriRt, TextureSubresourceInfo());
+
+	struct PushConsts
+	{
+		Mat4 m_prevViewProjMatMulInvViewProjMat;
+		F32 m_lumaContrastThreshold;
+		F32 m_motionThreshold;
+		Vec2 m_padding;
+	} pconsts;
+	pconsts.m_prevViewProjMatMulInvViewProjMat =
+		ctx.m_prevMatrices.m_viewProjection * ctx.m_matrices.m_viewProjection.getInverse();
+	pconsts.m_lumaContrastThreshold = m_lumaContrastThreshold;
+	pconsts.m_motionThreshold = m_motionThreshold;
+	pconsts.m_padding = Vec2(0.0f);
+	cmdb->setPushConstants(&pconsts, sizeof(pconsts));
+
+	// One workgroup per SRI texel
+	cmdb->dispatchCompute(m_sriSize.x(), m_sriSize.y(), 1);
+}
+
+} // end namespace anki
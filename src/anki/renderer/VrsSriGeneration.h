@@ -0,0 +1,80 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/renderer/RendererObject.h>
+
+namespace anki
+{
+
+/// @addtogroup renderer
+/// @{
+
+/// Builds the shading rate image (SRI) that the G-buffer and the light & forward shading passes use for variable rate
+/// shading. It's built at the end of a frame and it's used by the next.
+class VrsSriGeneration : public RendererObject
+{
+public:
+	VrsSriGeneration(Renderer* r)
+		: RendererObject(r)
+	{
+	}
+
+	~VrsSriGeneration();
+
+	ANKI_USE_RESULT Error init(const ConfigSet& cfg);
+
+	/// Import the SRI. Call it before the passes that use it.
+	void importRenderTargets(RenderingContext& ctx);
+
+	void populateRenderGraph(RenderingContext& ctx);
+
+	/// The passes of this frame can use the SRI.
+	Bool getSriAvailable() const
+	{
+		return m_runCtx.m_sriAvailable;
+	}
+
+	/// Every texel of the SRI covers that many pixels in X and Y.
+	U32 getSriTexelSize() const
+	{
+		return m_sriTexelSize;
+	}
+
+	/// Set a graphics pass to use the SRI. Its FramebufferDescription should have a shading rate texel size.
+	void setDependencies(GraphicsRenderPassDescription& pass) const
+	{
+		ANKI_ASSERT(m_runCtx.m_sriAvailable);
+		pass.setFramebufferShadingRateAttachment(m_runCtx.m_sriRt);
+		pass.newDependency({m_runCtx.m_sriRt, TextureUsageBit::FRAMEBUFFER_SHADING_RATE});
+	}
+
+private:
+	Bool m_enabled = false;
+	Bool m_sriWrittenOnce = false;
+	U32 m_sriTexelSize = 0;
+	UVec2 m_sriSize = UVec2(0u);
+	F32 m_lumaContrastThreshold = 0.0f;
+	F32 m_motionThreshold = 0.0f;
+
+	TexturePtr m_sriTex;
+
+	ShaderProgramResourcePtr m_prog;
+	ShaderProgramPtr m_grProg;
+
+	class
+	{
+	public:
+		RenderingContext* m_ctx = nullptr;
+		RenderTargetHandle m_sriRt;
+		Bool m_sriAvailable = false;
+	} m_runCtx;
+
+	void run(RenderPassWorkContext& rgraphCtx);
+};
+/// @}
+
+} // end namespace anki
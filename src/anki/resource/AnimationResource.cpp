@@ -4,11 +4,17 @@
 // http://www.anki3d.org/LICENSE
 
 #include <anki/resource/AnimationResource.h>
+#include <anki/resource/ResourceManager.h>
+#include <anki/resource/ResourceDescriptor.h>
 #include <anki/util/Xml.h>
 
 namespace anki
 {
 
+/// Use nlerp instead of slerp for the rotation keyframes that are closer than 2*acos(0.99) (about 16 degrees). The
+/// angular error of nlerp is less than 0.01 degrees there.
+constexpr F32 NLERP_MIN_COS_HALF_ANGLE = 0.99f;
+
 AnimationResource::AnimationResource(ResourceManager* manager)
 	: ResourceObject(manager)
 {
@@ -26,168 +32,248 @@ AnimationResource::~AnimationResource()
 
 Error AnimationResource::load(const ResourceFilename& filename, Bool async)
 {
-	XmlElement el;
-	Second ftmp;
+	StringAuto text(getTempAllocator());
+	CookedDescriptorData cookedData(getTempAllocator());
+	AnimationDescriptor* cooked;
+	ANKI_CHECK(openFileLoadCookedDescriptor(filename, ANIMATION_DESCRIPTOR_MAGIC, text, cookedData, cooked));
+	if(cooked && validateDescriptor(*cooked))
+	{
+		return init(*cooked);
+	}
 
-	m_startTime = MAX_SECOND;
-	Second maxTime = MIN_SECOND;
+	// Parse the XML and cook it for the next time
+	DynamicArrayAuto<AnimationDescriptorChannel> channels(getTempAllocator());
+	DynamicArrayAuto<AnimationDescriptorKey> keys(getTempAllocator());
+	DynamicArrayAuto<char> strings(getTempAllocator());
+	ANKI_CHECK(parseXml(text.toCString(), channels, keys, strings));
 
+	AnimationDescriptor desc;
+	desc.m_channels = WeakArray<AnimationDescriptorChannel>(channels);
+	desc.m_strings = WeakArray<char>(strings);
+	ANKI_CHECK(init(desc));
+
+	saveCookedDescriptor(filename, ANIMATION_DESCRIPTOR_MAGIC, text.toCString(), desc);
+	return Error::NONE;
+}
+
+Error AnimationResource::parseXml(CString text,
+	DynamicArrayAuto<AnimationDescriptorChannel>& channels,
+	DynamicArrayAuto<AnimationDescriptorKey>& keys,
+	DynamicArrayAuto<char>& strings) const
+{
 	// Document
 	XmlDocument doc;
-	ANKI_CHECK(openFileParseXml(filename, doc));
+	ANKI_CHECK(doc.parse(text, getTempAllocator()));
 	XmlElement rootel;
 	ANKI_CHECK(doc.getChildElement("animation", rootel));
 
-	// Count the number of identity keys. If all of the keys are identities drop a vector
-	U identPosCount = 0;
-	U identRotCount = 0;
-	U identScaleCount = 0;
-
 	// <channels>
 	XmlElement channelsEl;
 	ANKI_CHECK(rootel.getChildElement("channels", channelsEl));
 	XmlElement chEl;
 	ANKI_CHECK(channelsEl.getChildElement("channel", chEl));
 
-	U32 channelCount = 0;
-	ANKI_CHECK(chEl.getSiblingElementsCount(channelCount));
-	++channelCount;
-	if(channelCount == 0)
+	// The keys of every channel are appended to the same array. The channels point to it after it stops growing
+	class KeyRange
 	{
-		ANKI_RESOURCE_LOGE("Didn't found any channels");
-		return Error::USER_DATA;
-	}
-	m_channels.create(getAllocator(), channelCount);
+	public:
+		U32 m_first;
+		U32 m_count;
+	};
+	DynamicArrayAuto<Array<KeyRange, 3>> keyRanges(getTempAllocator());
+
+	auto parseKeys = [&](XmlElement keysEl, U32 componentCount, KeyRange& range) -> Error {
+		range.m_first = keys.getSize();
+		range.m_count = 0;
+		if(!keysEl)
+		{
+			return Error::NONE;
+		}
+
+		XmlElement keyEl;
+		ANKI_CHECK(keysEl.getChildElement("key", keyEl));
+		do
+		{
+			AnimationDescriptorKey& key = *keys.emplaceBack();
+
+			// <time>
+			XmlElement el;
+			ANKI_CHECK(keyEl.getChildElement("time", el));
+			ANKI_CHECK(el.getNumber(key.m_time));
+
+			// <value>
+			ANKI_CHECK(keyEl.getChildElement("value", el));
+			if(componentCount == 1)
+			{
+				ANKI_CHECK(el.getNumber(key.m_value[0]));
+			}
+			else
+			{
+				WeakArray<F32> value(&key.m_value[0], componentCount);
+				ANKI_CHECK(el.getNumbers(value));
+			}
+
+			++range.m_count;
+
+			// Move to next
+			ANKI_CHECK(keyEl.getNextSiblingElement("key", keyEl));
+		} while(keyEl);
+
+		return Error::NONE;
+	};
 
 	// For all channels
-	channelCount = 0;
 	do
 	{
-		AnimationChannel& ch = m_channels[channelCount];
+		AnimationDescriptorChannel& ch = *channels.emplaceBack();
+		Array<KeyRange, 3>& ranges = *keyRanges.emplaceBack();
 
 		// <name>
+		XmlElement el;
 		ANKI_CHECK(chEl.getChildElement("name", el));
 		CString strtmp;
 		ANKI_CHECK(el.getText(strtmp));
-		ch.m_name.create(getAllocator(), strtmp);
+		ch.m_name = pushBackDescriptorString(strtmp, strings);
 
-		XmlElement keysEl, keyEl;
+		XmlElement keysEl;
 
 		// <positionKeys>
 		ANKI_CHECK(chEl.getChildElementOptional("positionKeys", keysEl));
-		if(keysEl)
+		ANKI_CHECK(parseKeys(keysEl, 3, ranges[0]));
+
+		// <rotationKeys>
+		ANKI_CHECK(chEl.getChildElement("rotationKeys", keysEl));
+		ANKI_CHECK(parseKeys(keysEl, 4, ranges[1]));
+
+		// <scalingKeys>
+		ANKI_CHECK(chEl.getChildElementOptional("scalingKeys", keysEl));
+		ANKI_CHECK(parseKeys(keysEl, 1, ranges[2]));
+
+		// Move to next channel
+		ANKI_CHECK(chEl.getNextSiblingElement("channel", chEl));
+	} while(chEl);
+
+	for(U32 i = 0; i < channels.getSize(); ++i)
+	{
+		const Array<KeyRange, 3>& ranges = keyRanges[i];
+		auto getKeys = [&](const KeyRange& range) {
+			return (range.m_count) ? WeakArray<AnimationDescriptorKey>(&keys[range.m_first], range.m_count)
+								   : WeakArray<AnimationDescriptorKey>();
+		};
+
+		channels[i].m_positionKeys = getKeys(ranges[0]);
+		channels[i].m_rotationKeys = getKeys(ranges[1]);
+		channels[i].m_scaleKeys = getKeys(ranges[2]);
+	}
+
+	return Error::NONE;
+}
+
+Bool AnimationResource::validateDescriptor(const AnimationDescriptor& desc)
+{
+	for(const AnimationDescriptorChannel& ch : desc.m_channels)
+	{
+		if(!isValidDescriptorString(desc.m_strings, ch.m_name))
 		{
-			ANKI_CHECK(keysEl.getChildElement("key", keyEl));
+			return false;
+		}
+	}
 
-			U32 count = 0;
-			ANKI_CHECK(keyEl.getSiblingElementsCount(count));
-			++count;
-			ch.m_positions.create(getAllocator(), count);
+	return true;
+}
 
-			count = 0;
-			do
-			{
-				AnimationKeyframe<Vec3>& key = ch.m_positions[count++];
-
-				// <time>
-				ANKI_CHECK(keyEl.getChildElement("time", el));
-				ANKI_CHECK(el.getNumber(ftmp));
-				key.m_time = ftmp;
-				m_startTime = std::min(m_startTime, key.m_time);
-				maxTime = std::max(maxTime, key.m_time);
-
-				// <value>
-				ANKI_CHECK(keyEl.getChildElement("value", el));
-				ANKI_CHECK(el.getNumbers(key.m_value));
-
-				// Check ident
-				if(key.m_value == Vec3(0.0))
-				{
-					++identPosCount;
-				}
-
-				// Move to next
-				ANKI_CHECK(keyEl.getNextSiblingElement("key", keyEl));
-			} while(keyEl);
+Error AnimationResource::init(const AnimationDescriptor& desc)
+{
+	m_startTime = MAX_SECOND;
+	Second maxTime = MIN_SECOND;
+
+	// Count the number of identity keys. If all of the keys are identities drop a vector
+	U identPosCount = 0;
+	U identRotCount = 0;
+	U identScaleCount = 0;
+
+	const U32 channelCount = desc.m_channels.getSize();
+	if(channelCount == 0)
+	{
+		ANKI_RESOURCE_LOGE("Didn't found any channels");
+		return Error::USER_DATA;
+	}
+	m_channels.create(getAllocator(), channelCount);
+
+	// For all channels
+	for(U32 i = 0; i < channelCount; ++i)
+	{
+		const AnimationDescriptorChannel& inCh = desc.m_channels[i];
+		AnimationChannel& ch = m_channels[i];
+
+		ch.m_name.create(getAllocator(), getDescriptorString(desc.m_strings, inCh.m_name));
+
+		auto updateTimes = [&](Second time) {
+			m_startTime = std::min(m_startTime, time);
+			maxTime = std::max(maxTime, time);
+		};
+
+		// Positions
+		if(inCh.m_positionKeys.getSize())
+		{
+			ch.m_positions.create(getAllocator(), inCh.m_positionKeys.getSize());
 		}
 
-		// <rotationKeys>
-		ANKI_CHECK(chEl.getChildElement("rotationKeys", keysEl));
-		if(keysEl)
+		for(U32 k = 0; k < ch.m_positions.getSize(); ++k)
 		{
-			ANKI_CHECK(keysEl.getChildElement("key", keyEl));
+			const AnimationDescriptorKey& inKey = inCh.m_positionKeys[k];
+			AnimationKeyframe<Vec3>& key = ch.m_positions[k];
+			key.m_time = inKey.m_time;
+			key.m_value = Vec3(inKey.m_value[0], inKey.m_value[1], inKey.m_value[2]);
+			updateTimes(key.m_time);
+
+			// Check ident
+			if(key.m_value == Vec3(0.0))
+			{
+				++identPosCount;
+			}
+		}
 
-			U32 count = 0;
-			ANKI_CHECK(keyEl.getSiblingElementsCount(count));
-			++count;
-			ch.m_rotations.create(getAllocator(), count);
+		// Rotations
+		if(inCh.m_rotationKeys.getSize())
+		{
+			ch.m_rotations.create(getAllocator(), inCh.m_rotationKeys.getSize());
+		}
 
-			count = 0;
-			do
+		for(U32 k = 0; k < ch.m_rotations.getSize(); ++k)
+		{
+			const AnimationDescriptorKey& inKey = inCh.m_rotationKeys[k];
+			AnimationKeyframe<Quat>& key = ch.m_rotations[k];
+			key.m_time = inKey.m_time;
+			key.m_value = Quat(Vec4(inKey.m_value[0], inKey.m_value[1], inKey.m_value[2], inKey.m_value[3]));
+			updateTimes(key.m_time);
+
+			// Check ident
+			if(key.m_value == Quat::getIdentity())
 			{
-				AnimationKeyframe<Quat>& key = ch.m_rotations[count++];
-
-				// <time>
-				ANKI_CHECK(keyEl.getChildElement("time", el));
-				ANKI_CHECK(el.getNumber(ftmp));
-				key.m_time = ftmp;
-				m_startTime = std::min(m_startTime, key.m_time);
-				maxTime = std::max(maxTime, key.m_time);
-
-				// <value>
-				Vec4 tmp2;
-				ANKI_CHECK(keyEl.getChildElement("value", el));
-				ANKI_CHECK(el.getNumbers(tmp2));
-				key.m_value = Quat(tmp2);
-
-				// Check ident
-				if(key.m_value == Quat::getIdentity())
-				{
-					++identRotCount;
-				}
-
-				// Move to next
-				ANKI_CHECK(keyEl.getNextSiblingElement("key", keyEl));
-			} while(keyEl);
+				++identRotCount;
+			}
 		}
 
-		// <scalingKeys>
-		ANKI_CHECK(chEl.getChildElementOptional("scalingKeys", keysEl));
-		if(keysEl)
+		// Scales
+		if(inCh.m_scaleKeys.getSize())
 		{
-			ANKI_CHECK(keysEl.getChildElement("key", keyEl));
-
-			U32 count = 0;
-			ANKI_CHECK(keyEl.getSiblingElementsCount(count));
-			++count;
-			ch.m_scales.create(getAllocator(), count);
+			ch.m_scales.create(getAllocator(), inCh.m_scaleKeys.getSize());
+		}
 
-			count = 0;
-			do
+		for(U32 k = 0; k < ch.m_scales.getSize(); ++k)
+		{
+			const AnimationDescriptorKey& inKey = inCh.m_scaleKeys[k];
+			AnimationKeyframe<F32>& key = ch.m_scales[k];
+			key.m_time = inKey.m_time;
+			key.m_value = inKey.m_value[0];
+			updateTimes(key.m_time);
+
+			// Check ident
+			if(isZero(key.m_value - 1.0))
 			{
-				AnimationKeyframe<F32>& key = ch.m_scales[count++];
-
-				// <time>
-				ANKI_CHECK(keyEl.getChildElement("time", el));
-				ANKI_CHECK(el.getNumber(ftmp));
-				key.m_time = ftmp;
-				m_startTime = std::min(m_startTime, key.m_time);
-				maxTime = std::max(maxTime, key.m_time);
-
-				// <value>
-				ANKI_CHECK(keyEl.getChildElement("value", el));
-				ANKI_CHECK(el.getNumber(ftmp));
-				key.m_value = F32(ftmp);
-
-				// Check ident
-				if(isZero(key.m_value - 1.0))
-				{
-					++identScaleCount;
-				}
-
-				// Move to next
-				ANKI_CHECK(keyEl.getNextSiblingElement("key", keyEl));
-			} while(keyEl);
+				++identScaleCount;
+			}
 		}
 
 		// Remove identity vectors
@@ -205,25 +291,119 @@ Error AnimationResource::load(const ResourceFilename& filename, Bool async)
 		{
 			ch.m_scales.destroy(getAllocator());
 		}
-
-		// Move to next channel
-		++channelCount;
-		ANKI_CHECK(chEl.getNextSiblingElement("channel", chEl));
-	} while(chEl);
+	}
 
 	m_duration = maxTime - m_startTime;
 
+	if(getManager().getGpuSkinningEnabled())
+	{
+		createGpuKeyframes();
+	}
+
 	return Error::NONE;
 }
 
-void AnimationResource::interpolate(U32 channelIndex, Second time, Vec3& pos, Quat& rot, F32& scale) const
+void AnimationResource::createGpuKeyframes()
 {
-	// Audjust time
-	if(time > m_startTime + m_duration)
+	U32 keyCount = 0;
+	for(const AnimationChannel& ch : m_channels)
 	{
-		time = mod(time - m_startTime, m_duration) + m_startTime;
+		keyCount += ch.m_positions.getSize() + ch.m_rotations.getSize();
 	}
 
+	// Compute the layout of the sections
+	const PtrSize alignment = getManager().getGrManager().getDeviceCapabilities().m_storageBufferBindOffsetAlignment;
+	AnimationGpuKeyframes& gpu = m_gpuKeyframes;
+
+	gpu.m_channelsOffset = 0;
+	gpu.m_channelsRange = m_channels.getSize() * sizeof(UVec4);
+
+	gpu.m_timesOffset = getAlignedRoundUp(alignment, gpu.m_channelsOffset + gpu.m_channelsRange);
+	gpu.m_timesRange = max<PtrSize>(keyCount, 1) * sizeof(F32);
+
+	gpu.m_valuesOffset = getAlignedRoundUp(alignment, gpu.m_timesOffset + gpu.m_timesRange);
+	gpu.m_valuesRange = max<PtrSize>(keyCount, 1) * sizeof(Vec4);
+
+	const PtrSize buffSize = gpu.m_valuesOffset + gpu.m_valuesRange;
+	gpu.m_buffer = getManager().getGrManager().newBuffer(
+		BufferInitInfo(buffSize, BufferUsageBit::STORAGE_COMPUTE_READ, BufferMapAccessBit::WRITE, "AnimKeyframes"));
+
+	// Write the keyframes once. They never change
+	U8* mapped = static_cast<U8*>(gpu.m_buffer->map(0, buffSize, BufferMapAccessBit::WRITE));
+	UVec4* channels = reinterpret_cast<UVec4*>(mapped + gpu.m_channelsOffset);
+	F32* times = reinterpret_cast<F32*>(mapped + gpu.m_timesOffset);
+	Vec4* values = reinterpret_cast<Vec4*>(mapped + gpu.m_valuesOffset);
+
+	U32 key = 0;
+	for(const AnimationChannel& ch : m_channels)
+	{
+		*channels++ = UVec4(key, ch.m_positions.getSize(), key + ch.m_positions.getSize(), ch.m_rotations.getSize());
+
+		for(const AnimationKeyframe<Vec3>& kf : ch.m_positions)
+		{
+			times[key] = F32(kf.m_time);
+			values[key] = Vec4(kf.m_value, 0.0f);
+			++key;
+		}
+
+		for(const AnimationKeyframe<Quat>& kf : ch.m_rotations)
+		{
+			times[key] = F32(kf.m_time);
+			values[key] = Vec4(kf.m_value.x(), kf.m_value.y(), kf.m_value.z(), kf.m_value.w());
+			++key;
+		}
+	}
+	ANKI_ASSERT(key == keyCount);
+
+	gpu.m_buffer->unmap();
+}
+
+/// Find the left keyframe of the span that contains the time. Try the cached span and the next one first and fall back
+/// to binary search.
+template<typename T>
+static U32 findKeyframeSpan(const DynamicArray<AnimationKeyframe<T>>& keys, Second time, U32 cursor)
+{
+	ANKI_ASSERT(keys.getSize() > 1);
+	const U32 lastSpan = keys.getSize() - 2;
+
+	if(cursor <= lastSpan && time >= keys[cursor].getTime())
+	{
+		if(time <= keys[cursor + 1].getTime())
+		{
+			return cursor;
+		}
+
+		if(cursor < lastSpan && time <= keys[cursor + 2].getTime())
+		{
+			return cursor + 1;
+		}
+	}
+
+	// The first key with time greater than the time
+	U32 low = 0;
+	U32 high = keys.getSize();
+	while(low < high)
+	{
+		const U32 mid = (low + high) / 2;
+		if(keys[mid].getTime() <= time)
+		{
+			low = mid + 1;
+		}
+		else
+		{
+			high = mid;
+		}
+	}
+
+	return min(max(low, 1u) - 1, lastSpan);
+}
+
+void AnimationResource::interpolate(
+	U32 channelIndex, Second time, Vec3& pos, Quat& rot, F32& scale, AnimationChannelCursor& cursor) const
+{
+	// Audjust time
+	time = wrapTime(time);
+
 	ANKI_ASSERT(time >= m_startTime && time <= m_startTime + m_duration);
 	ANKI_ASSERT(channelIndex < m_channels.getSize());
 
@@ -232,33 +412,26 @@ void AnimationResource::interpolate(U32 channelIndex, Second time, Vec3& pos, Qu
 	// Position
 	if(channel.m_positions.getSize() > 1)
 	{
-		for(U32 i = 0; i < channel.m_positions.getSize() - 1; ++i)
-		{
-			const AnimationKeyframe<Vec3>& left = channel.m_positions[i];
-			const AnimationKeyframe<Vec3>& right = channel.m_positions[i + 1];
-			if(time >= left.m_time && time <= right.m_time)
-			{
-				const Second u = (time - left.m_time) / (right.m_time - left.m_time);
-				pos = linearInterpolate(left.m_value, right.m_value, F32(u));
-				break;
-			}
-		}
+		cursor.m_positionKey = findKeyframeSpan(channel.m_positions, time, cursor.m_positionKey);
+		const AnimationKeyframe<Vec3>& left = channel.m_positions[cursor.m_positionKey];
+		const AnimationKeyframe<Vec3>& right = channel.m_positions[cursor.m_positionKey + 1];
+
+		const Second u = clamp((time - left.m_time) / (right.m_time - left.m_time), 0.0, 1.0);
+		pos = linearInterpolate(left.m_value, right.m_value, F32(u));
 	}
 
 	// Rotation
 	if(channel.m_rotations.getSize() > 1)
 	{
-		for(U32 i = 0; i < channel.m_rotations.getSize() - 1; ++i)
-		{
-			const AnimationKeyframe<Quat>& left = channel.m_rotations[i];
-			const AnimationKeyframe<Quat>& right = channel.m_rotations[i + 1];
-			if(time >= left.m_time && time <= right.m_time)
-			{
-				const Second u = (time - left.m_time) / (right.m_time - left.m_time);
-				rot = left.m_value.slerp(right.m_value, F32(u));
-				break;
-			}
-		}
+		cursor.m_rotationKey = findKeyframeSpan(channel.m_rotations, time, cursor.m_rotationKey);
+		const AnimationKeyframe<Quat>& left = channel.m_rotations[cursor.m_rotationKey];
+		const AnimationKeyframe<Quat>& right = channel.m_rotations[cursor.m_rotationKey + 1];
+
+		const Second u = clamp((time - left.m_time) / (right.m_time - left.m_time), 0.0, 1.0);
+		// The keyframes are usually close so nlerp is good enough
+		const F32 cosHalfTheta = absolute(left.m_value.dot(right.m_value));
+		rot = (cosHalfTheta > NLERP_MIN_COS_HALF_ANGLE) ? left.m_value.nlerp(right.m_value, F32(u))
+														: left.m_value.slerp(right.m_value, F32(u));
 	}
 }
 
@@ -7,6 +7,7 @@
 
 #include <anki/resource/ResourceObject.h>
 #include <anki/Math.h>
+#include <anki/Gr.h>
 #include <anki/util/String.h>
 
 namespace anki
@@ -14,6 +15,9 @@ namespace anki
 
 // Forward
 class XmlElement;
+class AnimationDescriptor;
+class AnimationDescriptorChannel;
+class AnimationDescriptorKey;
 
 /// @addtogroup resource
 /// @{
@@ -63,7 +67,37 @@ public:
 	}
 };
 
-/// Animation consists of keyframe data.
+/// Caches the keyframe spans of a channel between AnimationResource::interpolate calls. With monotonic playback the
+/// span is the same or the next one most of the time so the search is skipped.
+class AnimationChannelCursor
+{
+public:
+	U32 m_positionKey = 0;
+	U32 m_rotationKey = 0;
+};
+
+/// The keyframes of an AnimationResource for the GPU skinning. All the sections live in the same buffer.
+class AnimationGpuKeyframes
+{
+public:
+	BufferPtr m_buffer;
+
+	/// An UVec4 per channel. It's the first position key, the position key count, the first rotation key and the
+	/// rotation key count.
+	PtrSize m_channelsOffset = 0;
+	PtrSize m_channelsRange = 0;
+
+	/// A F32 per key.
+	PtrSize m_timesOffset = 0;
+	PtrSize m_timesRange = 0;
+
+	/// A Vec4 per key. The positions have zero in w and the rotations are quaternions.
+	PtrSize m_valuesOffset = 0;
+	PtrSize m_valuesRange = 0;
+};
+
+/// Animation consists of keyframe data. The XML is cooked to an AnimationDescriptor the first time it's loaded, see
+/// rsrc_cookedDescriptors.
 class AnimationResource : public ResourceObject
 {
 public:
@@ -91,13 +125,55 @@ public:
 		return m_startTime;
 	}
 
+	/// Wrap the time to the animation's duration the same way interpolate() does.
+	Second wrapTime(Second time) const
+	{
+		if(time > m_startTime + m_duration)
+		{
+			time = mod(time - m_startTime, m_duration) + m_startTime;
+		}
+
+		return time;
+	}
+
 	/// Get the interpolated data
-	void interpolate(U32 channelIndex, Second time, Vec3& position, Quat& rotation, F32& scale) const;
+	void interpolate(U32 channelIndex, Second time, Vec3& position, Quat& rotation, F32& scale) const
+	{
+		AnimationChannelCursor cursor;
+		interpolate(channelIndex, time, position, rotation, scale, cursor);
+	}
+
+	/// Get the interpolated data. It starts the search of the keyframes from the cursor and it updates it.
+	void interpolate(U32 channelIndex,
+		Second time,
+		Vec3& position,
+		Quat& rotation,
+		F32& scale,
+		AnimationChannelCursor& cursor) const;
+
+	/// Get the keyframes for the GPU skinning. The buffer is not created if the GPU skinning is disabled.
+	const AnimationGpuKeyframes& getGpuKeyframes() const
+	{
+		return m_gpuKeyframes;
+	}
 
 private:
 	DynamicArray<AnimationChannel> m_channels;
 	Second m_duration;
 	Second m_startTime;
+	AnimationGpuKeyframes m_gpuKeyframes;
+
+	ANKI_USE_RESULT Error parseXml(CString text,
+		DynamicArrayAuto<AnimationDescriptorChannel>& channels,
+		DynamicArrayAuto<AnimationDescriptorKey>& keys,
+		DynamicArrayAuto<char>& strings) const;
+
+	/// Check a cooked descriptor that was read from the cache.
+	static Bool validateDescriptor(const AnimationDescriptor& desc);
+
+	ANKI_USE_RESULT Error init(const AnimationDescriptor& desc);
+
+	void createGpuKeyframes();
 };
 /// @}
 
@@ -6,12 +6,12 @@
 #include <anki/resource/AsyncLoader.h>
 #include <anki/util/Logger.h>
 #include <anki/util/Tracer.h>
+#include <anki/util/HighRezTimer.h>
 
 namespace anki
 {
 
 AsyncLoader::AsyncLoader()
-	: m_thread("anki_asyload")
 {
 }
 
@@ -19,23 +19,35 @@ AsyncLoader::~AsyncLoader()
 {
 	stop();
 
-	if(!m_taskQueue.isEmpty())
+	ANKI_ASSERT(!m_batching && "Forgot to end the batch");
+
+	AsyncLoaderTaskPriority priority;
+	AsyncLoaderTask* task = popTask(priority);
+	if(task)
 	{
 		ANKI_RESOURCE_LOGW("Stoping loading thread while there is work to do");
 
-		while(!m_taskQueue.isEmpty())
+		while(task)
 		{
-			AsyncLoaderTask* task = &m_taskQueue.getFront();
-			m_taskQueue.popFront();
 			m_alloc.deleteInstance(task);
+			task = popTask(priority);
 		}
 	}
 }
 
-void AsyncLoader::init(const HeapAllocator<U8>& alloc)
+void AsyncLoader::init(const HeapAllocator<U8>& alloc, U32 threadCount)
 {
+	ANKI_ASSERT(threadCount > 0);
 	m_alloc = alloc;
-	m_thread.start(this, threadCallback);
+
+	m_workers.create(m_alloc, threadCount);
+	for(U32 i = 0; i < threadCount; ++i)
+	{
+		Array<char, 32> name;
+		snprintf(&name[0], name.getSize(), "anki_asyload%u", i);
+		m_workers[i] = m_alloc.newInstance<Worker>(this, &name[0]);
+		m_workers[i]->m_thread.start(m_workers[i], threadCallback);
+	}
 }
 
 void AsyncLoader::stop()
@@ -43,137 +55,288 @@ void AsyncLoader::stop()
 	{
 		LockGuard<Mutex> lock(m_mtx);
 		m_quit = true;
-		m_condVar.notifyOne();
+		m_condVar.notifyAll();
 	}
 
-	Error err = m_thread.join();
-	(void)err;
+	for(Worker* worker : m_workers)
+	{
+		Error err = worker->m_thread.join();
+		(void)err;
+		m_alloc.deleteInstance(worker);
+	}
+
+	m_workers.destroy(m_alloc);
 }
 
 void AsyncLoader::pause()
 {
+	LockGuard<Mutex> lock(m_mtx);
+	m_paused = true;
+
+	while(isRunningTask(nullptr))
 	{
-		LockGuard<Mutex> lock(m_mtx);
-		m_paused = true;
-		m_sync = true;
-		m_condVar.notifyOne();
+		m_taskDoneCondVar.wait(m_mtx);
 	}
-
-	m_barrier.wait();
 }
 
 void AsyncLoader::resume()
 {
 	LockGuard<Mutex> lock(m_mtx);
 	m_paused = false;
-	m_condVar.notifyOne();
+	m_condVar.notifyAll();
+}
+
+U32 AsyncLoader::getQueuedTaskCount()
+{
+	LockGuard<Mutex> lock(m_mtx);
+	PtrSize count = m_batch.getSize();
+	for(const IntrusiveList<AsyncLoaderTask>& queue : m_taskQueues)
+	{
+		count += queue.getSize();
+	}
+
+	return U32(count);
+}
+
+AsyncLoaderStats AsyncLoader::getStats()
+{
+	LockGuard<Mutex> lock(m_mtx);
+	return m_stats;
+}
+
+void AsyncLoader::cancelTasks(const void* owner)
+{
+	ANKI_ASSERT(owner);
+	LockGuard<Mutex> lock(m_mtx);
+
+	while(true)
+	{
+		for(IntrusiveList<AsyncLoaderTask>& queue : m_taskQueues)
+		{
+			removeTasks(queue, owner);
+		}
+		removeTasks(m_batch, owner);
+
+		if(!isRunningTask(owner))
+		{
+			break;
+		}
+
+		// Wait for it. Check the queues again since the task might resubmit itself
+		m_taskDoneCondVar.wait(m_mtx);
+	}
+}
+
+void AsyncLoader::removeTasks(IntrusiveList<AsyncLoaderTask>& queue, const void* owner)
+{
+	IntrusiveList<AsyncLoaderTask> keep;
+	while(!queue.isEmpty())
+	{
+		AsyncLoaderTask* task = queue.popFront();
+		if(task->getOwner() == owner)
+		{
+			m_alloc.deleteInstance(task);
+		}
+		else
+		{
+			keep.pushBack(task);
+		}
+	}
+
+	queue = std::move(keep);
+}
+
+Bool AsyncLoader::isRunningTask(const void* owner) const
+{
+	for(const Worker* worker : m_workers)
+	{
+		if(worker->m_runningTask && (owner == nullptr || worker->m_runningTask->getOwner() == owner))
+		{
+			return true;
+		}
+	}
+
+	return false;
 }
 
 Error AsyncLoader::threadCallback(ThreadCallbackInfo& info)
 {
-	AsyncLoader& self = *reinterpret_cast<AsyncLoader*>(info.m_userData);
-	return self.threadWorker();
+	Worker& worker = *static_cast<Worker*>(info.m_userData);
+	return worker.m_loader->threadWorker(worker);
 }
 
-Error AsyncLoader::threadWorker()
+Error AsyncLoader::threadWorker(Worker& worker)
 {
-	Error err = Error::NONE;
+	// The queue belongs to this thread
+	FileIoQueue ioQueue;
+	Error err = ioQueue.init(m_alloc, MAX_READS_IN_FLIGHT);
 
 	while(!err)
 	{
 		AsyncLoaderTask* task = nullptr;
-		Bool quit = false;
-		Bool sync = false;
+		AsyncLoaderTaskPriority priority = AsyncLoaderTaskPriority::NORMAL;
 
 		{
 			// Wait for something
 			LockGuard<Mutex> lock(m_mtx);
-			while((m_taskQueue.isEmpty() || m_paused) && !m_quit && !m_sync)
+			while((!hasTasks() || m_paused) && !m_quit)
 			{
 				m_condVar.wait(m_mtx);
 			}
 
-			// Do some work
 			if(m_quit)
 			{
-				quit = true;
-			}
-			else if(m_sync)
-			{
-				sync = true;
-				m_sync = false;
-			}
-			else
-			{
-				task = &m_taskQueue.getFront();
-				m_taskQueue.popFront();
+				break;
 			}
+
+			task = popTask(priority);
+			worker.m_runningTask = task;
+
+			const Second queueWaitTime = HighRezTimer::getCurrentTime() - task->m_queueTime;
+			m_stats.m_queueWaitTime += queueWaitTime;
+			m_stats.m_maxQueueWaitTime = max(m_stats.m_maxQueueWaitTime, queueWaitTime);
 		}
 
-		if(quit)
+		// Exec the task
+		ANKI_ASSERT(task);
+		AsyncLoaderTaskContext ctx;
+		ctx.m_ioQueue = &ioQueue;
+
+		const Second runBegin = HighRezTimer::getCurrentTime();
 		{
-			break;
+			ANKI_TRACE_SCOPED_EVENT(RSRC_ASYNC_TASK);
+			err = (*task)(ctx);
 		}
-		else if(sync)
+		const Second runTime = HighRezTimer::getCurrentTime() - runBegin;
+
+		// A failed task might have left reads in flight and they point to the task's memory
+		if(ioQueue.getInFlightCount() > 0)
 		{
-			m_barrier.wait();
+			ANKI_ASSERT(err && "The task should wait for its reads");
+			const Error waitErr = ioQueue.waitAll();
+			(void)waitErr;
+		}
+
+		if(!err)
+		{
+			m_completedTaskCount.fetchAdd(1);
 		}
 		else
 		{
-			// Exec the task
-			ANKI_ASSERT(task);
-			AsyncLoaderTaskContext ctx;
+			ANKI_RESOURCE_LOGE("Async loader task failed");
+		}
 
-			{
-				ANKI_TRACE_SCOPED_EVENT(RSRC_ASYNC_TASK);
-				err = (*task)(ctx);
-			}
+		// Do other stuff
+		LockGuard<Mutex> lock(m_mtx);
 
-			if(!err)
-			{
-				m_completedTaskCount.fetchAdd(1);
-			}
-			else
-			{
-				ANKI_RESOURCE_LOGE("Async loader task failed");
-			}
+		++m_stats.m_taskCount;
+		m_stats.m_runTime += runTime;
 
-			// Do other stuff
-			if(ctx.m_resubmitTask)
-			{
-				LockGuard<Mutex> lock(m_mtx);
-				m_taskQueue.pushBack(task);
-			}
-			else
-			{
-				// Delete the task
-				m_alloc.deleteInstance(task);
-			}
+		if(ctx.m_resubmitTask)
+		{
+			task->m_queueTime = HighRezTimer::getCurrentTime();
+			m_taskQueues[priority].pushBack(task);
+		}
+		else
+		{
+			// Delete the task. Do it under the lock so cancelTasks() won't return while the task is still around
+			m_alloc.deleteInstance(task);
+		}
 
-			if(ctx.m_pause)
-			{
-				LockGuard<Mutex> lock(m_mtx);
-				m_paused = true;
-			}
+		if(ctx.m_pause)
+		{
+			m_paused = true;
 		}
+		else if(ctx.m_resubmitTask && !m_paused)
+		{
+			m_condVar.notifyOne();
+		}
+
+		worker.m_runningTask = nullptr;
+		m_taskDoneCondVar.notifyAll();
 	}
 
 	return err;
 }
 
-void AsyncLoader::submitTask(AsyncLoaderTask* task)
+void AsyncLoader::submitTask(AsyncLoaderTask* task, AsyncLoaderTaskPriority priority)
 {
 	ANKI_ASSERT(task);
 
-	// Append task to the list
 	LockGuard<Mutex> lock(m_mtx);
-	m_taskQueue.pushBack(task);
+
+	task->m_queueTime = HighRezTimer::getCurrentTime();
+
+	if(m_batching)
+	{
+		// Hold it until the batch ends
+		m_batch.pushBack(task);
+		return;
+	}
+
+	// Append task to the list
+	m_taskQueues[priority].pushBack(task);
 
 	if(!m_paused)
 	{
-		// Wake up the thread if it's not paused
+		// Wake up a worker if it's not paused
 		m_condVar.notifyOne();
 	}
 }
 
+void AsyncLoader::beginBatch()
+{
+	LockGuard<Mutex> lock(m_mtx);
+	ANKI_ASSERT(!m_batching && "Batches can't nest");
+	m_batching = true;
+}
+
+void AsyncLoader::endBatch(AsyncLoaderTaskPriority priority)
+{
+	LockGuard<Mutex> lock(m_mtx);
+	ANKI_ASSERT(m_batching);
+	m_batching = false;
+
+	const Bool wakeUp = !m_batch.isEmpty() && !m_paused;
+	const Second now = HighRezTimer::getCurrentTime();
+	while(!m_batch.isEmpty())
+	{
+		AsyncLoaderTask* task = m_batch.popFront();
+		task->m_queueTime = now;
+		m_taskQueues[priority].pushBack(task);
+	}
+
+	if(wakeUp)
+	{
+		m_condVar.notifyAll();
+	}
+}
+
+Bool AsyncLoader::hasTasks() const
+{
+	for(const IntrusiveList<AsyncLoaderTask>& queue : m_taskQueues)
+	{
+		if(!queue.isEmpty())
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+AsyncLoaderTask* AsyncLoader::popTask(AsyncLoaderTaskPriority& priority)
+{
+	for(I32 i = I32(AsyncLoaderTaskPriority::COUNT) - 1; i >= 0; --i)
+	{
+		if(!m_taskQueues[i].isEmpty())
+		{
+			priority = AsyncLoaderTaskPriority(i);
+			return m_taskQueues[i].popFront();
+		}
+	}
+
+	return nullptr;
+}
+
 } // end namespace anki
@@ -8,6 +8,8 @@
 #include <anki/resource/Common.h>
 #include <anki/util/Thread.h>
 #include <anki/util/List.h>
+#include <anki/util/DynamicArray.h>
+#include <anki/util/File.h>
 
 namespace anki
 {
@@ -18,6 +20,15 @@ class AsyncLoader;
 /// @addtogroup resource
 /// @{
 
+/// The priority of an AsyncLoaderTask. The tasks with higher priority run first.
+enum class AsyncLoaderTaskPriority : U8
+{
+	NORMAL,
+	HIGH,
+
+	COUNT
+};
+
 class AsyncLoaderTaskContext
 {
 public:
@@ -26,20 +37,51 @@ public:
 
 	/// Resubmit the same task at the end of the queue.
 	Bool m_resubmitTask = false;
+
+	/// A queue for asynchronous file reads. Use it to have many reads in flight. The task should wait for its reads
+	/// before it returns.
+	FileIoQueue* m_ioQueue = nullptr;
 };
 
 /// Interface for tasks for the AsyncLoader.
 class AsyncLoaderTask : public IntrusiveListEnabled<AsyncLoaderTask>
 {
+	friend class AsyncLoader;
+
 public:
 	virtual ~AsyncLoaderTask()
 	{
 	}
 
 	virtual ANKI_USE_RESULT Error operator()(AsyncLoaderTaskContext& ctx) = 0;
+
+	/// Set the object that the task works for. Use it with AsyncLoader::cancelTasks().
+	void setOwner(const void* owner)
+	{
+		m_owner = owner;
+	}
+
+	const void* getOwner() const
+	{
+		return m_owner;
+	}
+
+private:
+	const void* m_owner = nullptr;
+	Second m_queueTime = 0.0; ///< When it entered a queue.
+};
+
+/// The statistics of an AsyncLoader. @memberof AsyncLoader
+class AsyncLoaderStats
+{
+public:
+	U64 m_taskCount = 0; ///< The tasks that run. A resubmitted task counts every time it runs.
+	Second m_queueWaitTime = 0.0; ///< The time the tasks waited in the queues. Summed.
+	Second m_maxQueueWaitTime = 0.0;
+	Second m_runTime = 0.0; ///< The time the tasks run. Summed.
 };
 
-/// Asynchronous resource loader.
+/// Asynchronous resource loader. It runs the tasks in a number of worker threads.
 class AsyncLoader
 {
 public:
@@ -47,10 +89,18 @@ public:
 
 	~AsyncLoader();
 
-	void init(const HeapAllocator<U8>& alloc);
+	/// @param threadCount The number of worker threads. With more than one the tasks of the same priority start in
+	///                    submission order but they may finish in any order.
+	void init(const HeapAllocator<U8>& alloc, U32 threadCount = 1);
 
 	/// Submit a task.
-	void submitTask(AsyncLoaderTask* task);
+	void submitTask(AsyncLoaderTask* task, AsyncLoaderTaskPriority priority = AsyncLoaderTaskPriority::NORMAL);
+
+	/// Start gathering the submitted tasks into a batch. The tasks of the batch won't run before endBatch().
+	void beginBatch();
+
+	/// Submit the gathered tasks all at once. They keep their submission order.
+	void endBatch(AsyncLoaderTaskPriority priority = AsyncLoaderTaskPriority::NORMAL);
 
 	/// Create a new asynchronous loading task.
 	template<typename TTask, typename... TArgs>
@@ -66,7 +116,12 @@ public:
 		submitTask(newTask<TTask>(std::forward<TArgs>(args)...));
 	}
 
-	/// Pause the loader. This method will block the main thread for the current async task to finish. The rest of the
+	/// Remove the tasks of an owner that didn't run yet and wait for the ones that run. Call it when the owner dies
+	/// before its loading is done.
+	/// @see AsyncLoaderTask::setOwner
+	void cancelTasks(const void* owner);
+
+	/// Pause the loader. This method will block the main thread for the running async tasks to finish. The rest of the
 	/// tasks in the queue will not be executed until resume is called.
 	void pause();
 
@@ -84,26 +139,61 @@ public:
 		return m_completedTaskCount.load();
 	}
 
+	/// Get the number of tasks that wait in the queues.
+	U32 getQueuedTaskCount();
+
+	/// Get the statistics since the loader was created.
+	AsyncLoaderStats getStats();
+
 private:
+	class Worker
+	{
+	public:
+		AsyncLoader* m_loader;
+		Thread m_thread;
+		AsyncLoaderTask* m_runningTask = nullptr;
+
+		Worker(AsyncLoader* loader, const char* name)
+			: m_loader(loader)
+			, m_thread(name)
+		{
+		}
+	};
+
 	HeapAllocator<U8> m_alloc;
-	Thread m_thread;
-	Barrier m_barrier = {2};
+	DynamicArray<Worker*> m_workers;
 
 	Mutex m_mtx;
-	ConditionVariable m_condVar;
-	IntrusiveList<AsyncLoaderTask> m_taskQueue;
+	ConditionVariable m_condVar; ///< Wakes up the workers.
+	ConditionVariable m_taskDoneCondVar; ///< Signaled when a worker is done with a task.
+	Array<IntrusiveList<AsyncLoaderTask>, U32(AsyncLoaderTaskPriority::COUNT)> m_taskQueues;
+	IntrusiveList<AsyncLoaderTask> m_batch;
+	Bool m_batching = false;
 	Bool m_quit = false;
 	Bool m_paused = false;
-	Bool m_sync = false;
+	AsyncLoaderStats m_stats;
 
 	Atomic<U64> m_completedTaskCount = {0};
 
+	static constexpr U32 MAX_READS_IN_FLIGHT = 32;
+
 	/// Thread callback
 	static ANKI_USE_RESULT Error threadCallback(ThreadCallbackInfo& info);
 
-	Error threadWorker();
+	Error threadWorker(Worker& worker);
 
 	void stop();
+
+	Bool hasTasks() const;
+
+	/// Check if some worker runs a task of an owner. If the owner is nullptr check for any task.
+	Bool isRunningTask(const void* owner) const;
+
+	/// Remove the tasks of an owner from a queue and delete them.
+	void removeTasks(IntrusiveList<AsyncLoaderTask>& queue, const void* owner);
+
+	/// Pop the task with the highest priority. Return nullptr if there are no tasks.
+	AsyncLoaderTask* popTask(AsyncLoaderTaskPriority& priority);
 };
 /// @}
 
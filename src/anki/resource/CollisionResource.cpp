@@ -12,6 +12,11 @@
 namespace anki
 {
 
+CollisionResource::~CollisionResource()
+{
+	m_scaledShapes.destroy(getAllocator());
+}
+
 Error CollisionResource::load(const ResourceFilename& filename, Bool async)
 {
 	XmlElement el;
@@ -56,7 +61,47 @@ Error CollisionResource::load(const ResourceFilename& filename, Bool async)
 
 		const Bool convex = !!(loader.getHeader().m_flags & MeshBinaryFile::Flag::CONVEX);
 
-		m_physicsShape = physics.newInstance<PhysicsTriangleSoup>(positions, indices, convex);
+		// Building the BVH of big meshes takes time so cache it
+		StringAuto bvhFilename(getTempAllocator());
+		if(!convex && getManager().getCollisionBvhCacheEnabled())
+		{
+			bvhFilename.sprintf("%s/%016" PRIx64 ".ankibvh",
+				getManager().getCacheDirectory().cstr(),
+				computeHash(filename.cstr(), filename.getLength()));
+		}
+
+		m_physicsShape = physics.newInstance<PhysicsTriangleSoup>(
+			positions, indices, convex, (bvhFilename.isEmpty()) ? CString() : bvhFilename.toCString());
+
+		m_bvh.build(getAllocator(), positions, indices);
+	}
+	else if(type == "convexHulls")
+	{
+		DynamicArrayAuto<Vec3> positions(getTempAllocator());
+		DynamicArrayAuto<U32> hullVertexCounts(getTempAllocator());
+
+		XmlElement hullEl;
+		ANKI_CHECK(valEl.getChildElement("convexHull", hullEl));
+		do
+		{
+			DynamicArrayAuto<F32> coords(getTempAllocator());
+			ANKI_CHECK(hullEl.getNumbers(coords));
+			if(coords.getSize() == 0 || (coords.getSize() % 3) != 0)
+			{
+				ANKI_RESOURCE_LOGE("Wrong number of coordinates in a convex hull: %u", coords.getSize());
+				return Error::USER_DATA;
+			}
+
+			for(U32 i = 0; i < coords.getSize(); i += 3)
+			{
+				positions.emplaceBack(coords[i], coords[i + 1], coords[i + 2]);
+			}
+			hullVertexCounts.emplaceBack(coords.getSize() / 3);
+
+			ANKI_CHECK(hullEl.getNextSiblingElement("convexHull", hullEl));
+		} while(hullEl);
+
+		m_physicsShape = physics.newInstance<PhysicsConvexHulls>(positions, hullVertexCounts);
 	}
 	else
 	{
@@ -67,4 +112,28 @@ Error CollisionResource::load(const ResourceFilename& filename, Bool async)
 	return Error::NONE;
 }
 
+PhysicsCollisionShapePtr CollisionResource::getShape(F32 scale)
+{
+	ANKI_ASSERT(scale > 0.0f);
+	if(absolute(scale - 1.0f) < EPSILON)
+	{
+		return m_physicsShape;
+	}
+
+	LockGuard<Mutex> lock(m_scaledShapesMtx);
+
+	for(const ScaledShape& scaled : m_scaledShapes)
+	{
+		if(absolute(scaled.m_scale - scale) < EPSILON)
+		{
+			return scaled.m_shape;
+		}
+	}
+
+	ScaledShape& scaled = *m_scaledShapes.emplaceBack(getAllocator());
+	scaled.m_scale = scale;
+	scaled.m_shape = getManager().getPhysicsWorld().newInstance<PhysicsScaledShape>(m_physicsShape, scale);
+	return scaled.m_shape;
+}
+
 } // end namespace anki
@@ -7,6 +7,8 @@
 
 #include <anki/resource/ResourceObject.h>
 #include <anki/physics/PhysicsCollisionShape.h>
+#include <anki/collision/Bvh.h>
+#include <anki/util/Thread.h>
 
 namespace anki
 {
@@ -19,10 +21,12 @@ namespace anki
 /// XML file format:
 /// @code
 /// <collisionShape>
-/// 	<type>sphere | box | mesh</type>
-/// 	<value>radius | extend | path/to/mesh</value>
+/// 	<type>sphere | box | staticMesh | convexHulls</type>
+/// 	<value>radius | extend | path/to/mesh | <convexHull>x0 y0 z0 x1 y1 z1 ...</convexHull>...</value>
 /// </collisionShape>
 /// @endcode
+///
+/// All the users of a resource share its shape. The scaled instances share the scaled shapes, see getShape().
 class CollisionResource : public ResourceObject
 {
 public:
@@ -31,9 +35,7 @@ public:
 	{
 	}
 
-	~CollisionResource()
-	{
-	}
+	~CollisionResource();
 
 	ANKI_USE_RESULT Error load(const ResourceFilename& filename, Bool async);
 
@@ -42,8 +44,29 @@ public:
 		return m_physicsShape;
 	}
 
+	/// Get a scaled instance of the shape. The instances with the same scale share it and they share the data of the
+	/// original shape, like the BVH of the static meshes. Put the scale only here, not in the transform of the body.
+	/// @note It's thread-safe.
+	PhysicsCollisionShapePtr getShape(F32 scale);
+
+	/// Get a BVH of the triangles. It's empty if the shape is not a static mesh. Good for ray queries.
+	const Bvh& getBvh() const
+	{
+		return m_bvh;
+	}
+
 private:
+	class ScaledShape
+	{
+	public:
+		F32 m_scale;
+		PhysicsCollisionShapePtr m_shape;
+	};
+
 	PhysicsCollisionShapePtr m_physicsShape;
+	Bvh m_bvh;
+	DynamicArray<ScaledShape> m_scaledShapes;
+	Mutex m_scaledShapesMtx;
 };
 /// @}
 
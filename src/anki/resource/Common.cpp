@@ -14,9 +14,17 @@ namespace anki
 template<typename T>
 void ResourcePtrDeleter<T>::operator()(T* ptr)
 {
+	T* replacement = static_cast<T*>(ptr->getReplacement());
+
 	ptr->getManager().unregisterResource(ptr);
 	auto alloc = ptr->getAllocator();
 	alloc.deleteInstance(ptr);
+
+	// Drop the reference to the newer version
+	if(replacement && replacement->getRefcount().fetchSub(1) == 1)
+	{
+		(*this)(replacement);
+	}
 }
 
 #define ANKI_INSTANTIATE_RESOURCE(rsrc_, ptr_) template void ResourcePtrDeleter<rsrc_>::operator()(rsrc_* ptr);
@@ -30,7 +38,7 @@ void ResourcePtrDeleter<T>::operator()(T* ptr)
 const CString& shaderTypeToFileExtension(ShaderType type)
 {
 	static const Array<CString, U(ShaderType::COUNT)> mapping = {
-		{".vert.glsl", ".tc.glsl", ".te.glsl", ".geom.glsl", ".frag.glsl", ".comp.glsl"}};
+		{".vert.glsl", ".tc.glsl", ".te.glsl", ".geom.glsl", ".frag.glsl", ".comp.glsl", ".task.glsl", ".mesh.glsl"}};
 
 	return mapping[type];
 }
@@ -65,6 +73,14 @@ Error fileExtensionToShaderType(const CString& filename, ShaderType& type)
 	{
 		type = ShaderType::COMPUTE;
 	}
+	else if(filename.find(".task.glsl") != ResourceFilename::NPOS)
+	{
+		type = ShaderType::TASK;
+	}
+	else if(filename.find(".mesh.glsl") != ResourceFilename::NPOS)
+	{
+		type = ShaderType::MESH;
+	}
 	else
 	{
 		ANKI_RESOURCE_LOGE("Wrong shader file format: %s", &filename[0]);
@@ -32,7 +32,7 @@ class TransferGpuAllocatorHandle;
 
 /// @name Constants
 /// @{
-constexpr U32 MAX_LOD_COUNT = 3;
+constexpr U32 MAX_LOD_COUNT = 4;
 constexpr U32 MAX_INSTANCES = 64;
 constexpr U32 MAX_SUB_DRAWCALLS = 64; ///< @warning If changed don't forget to change MAX_INSTANCE_GROUPS
 constexpr U32 MAX_INSTANCE_GROUPS = 7; ///< It's log2(MAX_INSTANCES) + 1
@@ -7,3 +7,50 @@ ANKI_CONFIG_OPTION(rsrc_maxTextureSize, 1024u * 1024u, 4u, MAX_U32)
 ANKI_CONFIG_OPTION(rsrc_dumpShaderSources, 0, 0, 1)
 ANKI_CONFIG_OPTION(rsrc_dataPaths, ".", "The engine loads assets only in from these paths. Separate them with :")
 ANKI_CONFIG_OPTION(rsrc_transferScratchMemorySize, 256_MB, 1_MB, 4_GB)
+ANKI_CONFIG_OPTION(rsrc_transferBudgetPerFrame,
+	64_MB,
+	0_MB,
+	4_GB,
+	"The uploads of a frame stop after that many bytes and the rest continue in the next frames. 0 is no limit")
+ANKI_CONFIG_OPTION(rsrc_asyncLoaderThreadCount, 2, 1, 32, "The threads that load the resources in the background")
+ANKI_CONFIG_OPTION(rsrc_textureStreaming, 1, 0, 1, "Stream the mips of the material textures")
+ANKI_CONFIG_OPTION(rsrc_textureStreamingBudget, 1_GB, 0_GB, 64_GB, "The GPU memory of the streamed textures")
+ANKI_CONFIG_OPTION(
+	rsrc_textureStreamingTailSize, 128, 1, 16 * 1024, "The size of the mips the streamed textures always have")
+ANKI_CONFIG_OPTION(rsrc_meshLodStreaming, 1, 0, 1, "Load only the coarsest LOD of the models and stream the finer")
+ANKI_CONFIG_OPTION(
+	rsrc_collisionBvhCache, 1, 0, 1, "Store the BVHs of the static collision meshes in the cache dir and load them")
+ANKI_CONFIG_OPTION(rsrc_cookedDescriptors,
+	1,
+	0,
+	1,
+	"Load the materials, skeletons and animations from binary versions of their XML that are kept in the cache dir")
+ANKI_CONFIG_OPTION(rsrc_geometryPoolChunkSize, 64_MB, 1_MB, 4_GB, "The size of the buffers that hold the meshes")
+ANKI_CONFIG_OPTION(rsrc_hotReload, 0, 0, 1, "Watch the data paths and reload the resources whose files change")
+ANKI_CONFIG_OPTION(rsrc_hotReloadCoalescingTime, 0.3, 0.0, 10.0, "Seconds without file changes before a reload")
+ANKI_CONFIG_OPTION(rsrc_materialVariantCache,
+	"",
+	"A file with the material variants a level uses. The materials create them when they load. Empty is off")
+ANKI_CONFIG_OPTION(rsrc_recordMaterialVariants,
+	0,
+	0,
+	1,
+	"Add the material variants that get created to rsrc_materialVariantCache and write it at exit")
+ANKI_CONFIG_OPTION(rsrc_shaderVariantManifest,
+	"",
+	"A file with the shader program mutations in use. Only those are compiled and the rest on demand. Empty is off")
+ANKI_CONFIG_OPTION(rsrc_recordShaderVariants,
+	0,
+	0,
+	1,
+	"Add the shader program mutations that get created to rsrc_shaderVariantManifest and write it at exit")
+ANKI_CONFIG_OPTION(rsrc_ioTraceFile,
+	"",
+	"Record the resource files the run opens and write them to this file at exit. Replay it with resource_bench")
+ANKI_CONFIG_OPTION(rsrc_asyncShaderCompilation,
+	0,
+	0,
+	1,
+	"Compile the missing shader program mutations in the background. The materials draw with other variants until then")
+ANKI_CONFIG_OPTION(
+	rsrc_shaderCompilationThreadCount, 2, 1, 32, "The threads that compile the missing shader program mutations")
@@ -0,0 +1,204 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/resource/GeometryMemoryPool.h>
+#include <anki/gr/GrManager.h>
+#include <anki/util/Functions.h>
+
+namespace anki
+{
+
+GeometryMemoryPool::~GeometryMemoryPool()
+{
+	for(Chunk& chunk : m_chunks)
+	{
+		chunk.m_freeRanges.destroy(m_alloc);
+	}
+
+	m_chunks.destroy(m_alloc);
+	m_pendingFrees.destroy(m_alloc);
+}
+
+void GeometryMemoryPool::init(GrManager* gr, ResourceAllocator<U8> alloc, PtrSize chunkSize, U32 alignment)
+{
+	ANKI_ASSERT(gr && chunkSize > 0 && alignment > 0);
+	m_gr = gr;
+	m_alloc = alloc;
+	m_alignment = alignment;
+	m_chunkSize = getAlignedRoundUp(m_alignment, chunkSize);
+}
+
+void GeometryMemoryPool::allocate(PtrSize size, GeometryAllocation& out)
+{
+	ANKI_ASSERT(size > 0 && !out.isValid());
+	size = getAlignedRoundUp(m_alignment, size);
+
+	LockGuard<Mutex> lock(m_mtx);
+
+	// First fit in the existing chunks
+	for(U32 i = 0; i < m_chunks.getSize(); ++i)
+	{
+		if(m_chunks[i].m_buffer.isCreated() && allocateFromChunk(i, size, out))
+		{
+			return;
+		}
+	}
+
+	// Create a new chunk. Re-use the slot of a released one if there is any
+	U32 chunkIdx = MAX_U32;
+	for(U32 i = 0; i < m_chunks.getSize(); ++i)
+	{
+		if(!m_chunks[i].m_buffer.isCreated())
+		{
+			chunkIdx = i;
+			break;
+		}
+	}
+
+	if(chunkIdx == MAX_U32)
+	{
+		chunkIdx = m_chunks.getSize();
+		m_chunks.emplaceBack(m_alloc);
+	}
+
+	Chunk& chunk = m_chunks[chunkIdx];
+	const PtrSize chunkSize = max(size, m_chunkSize);
+	chunk.m_buffer = m_gr->newBuffer(BufferInitInfo(chunkSize,
+		USAGE | BufferUsageBit::BUFFER_UPLOAD_DESTINATION | BufferUsageBit::FILL,
+		BufferMapAccessBit::NONE,
+		"GeometryPool"));
+	chunk.m_freeRanges.emplaceBack(m_alloc, Range{0, chunkSize});
+	m_totalMemory += chunkSize;
+
+	const Bool success = allocateFromChunk(chunkIdx, size, out);
+	ANKI_ASSERT(success);
+	(void)success;
+}
+
+Bool GeometryMemoryPool::allocateFromChunk(U32 chunkIdx, PtrSize size, GeometryAllocation& out)
+{
+	Chunk& chunk = m_chunks[chunkIdx];
+
+	for(U32 i = 0; i < chunk.m_freeRanges.getSize(); ++i)
+	{
+		Range& range = chunk.m_freeRanges[i];
+		if(range.m_size < size)
+		{
+			continue;
+		}
+
+		out.m_buffer = chunk.m_buffer;
+		out.m_offset = range.m_offset;
+		out.m_size = size;
+		out.m_chunk = chunkIdx;
+
+		range.m_offset += size;
+		range.m_size -= size;
+		if(range.m_size == 0)
+		{
+			for(U32 j = i + 1; j < chunk.m_freeRanges.getSize(); ++j)
+			{
+				chunk.m_freeRanges[j - 1] = chunk.m_freeRanges[j];
+			}
+			chunk.m_freeRanges.popBack(m_alloc);
+		}
+
+		m_allocatedMemory += size;
+		return true;
+	}
+
+	return false;
+}
+
+void GeometryMemoryPool::free(GeometryAllocation& alloc)
+{
+	if(!alloc.isValid())
+	{
+		return;
+	}
+
+	{
+		LockGuard<Mutex> lock(m_mtx);
+		m_pendingFrees.emplaceBack(m_alloc, PendingFree{alloc.m_chunk, Range{alloc.m_offset, alloc.m_size}, m_frame});
+	}
+
+	alloc = GeometryAllocation();
+}
+
+void GeometryMemoryPool::endFrame()
+{
+	LockGuard<Mutex> lock(m_mtx);
+	++m_frame;
+
+	U32 keepCount = 0;
+	for(U32 i = 0; i < m_pendingFrees.getSize(); ++i)
+	{
+		const PendingFree& pending = m_pendingFrees[i];
+		if(m_frame - pending.m_frame >= FREE_DELAY_FRAMES)
+		{
+			freeRange(pending.m_chunk, pending.m_range);
+		}
+		else
+		{
+			m_pendingFrees[keepCount++] = pending;
+		}
+	}
+
+	while(m_pendingFrees.getSize() > keepCount)
+	{
+		m_pendingFrees.popBack(m_alloc);
+	}
+}
+
+void GeometryMemoryPool::freeRange(U32 chunkIdx, const Range& range)
+{
+	Chunk& chunk = m_chunks[chunkIdx];
+	DynamicArray<Range>& ranges = chunk.m_freeRanges;
+	m_allocatedMemory -= range.m_size;
+
+	// Find where it goes
+	U32 idx = 0;
+	while(idx < ranges.getSize() && ranges[idx].m_offset < range.m_offset)
+	{
+		++idx;
+	}
+
+	// Merge it with the neighbours
+	const Bool mergeLeft = idx > 0 && ranges[idx - 1].m_offset + ranges[idx - 1].m_size == range.m_offset;
+	const Bool mergeRight = idx < ranges.getSize() && range.m_offset + range.m_size == ranges[idx].m_offset;
+	if(mergeLeft && mergeRight)
+	{
+		ranges[idx - 1].m_size += range.m_size + ranges[idx].m_size;
+		for(U32 j = idx + 1; j < ranges.getSize(); ++j)
+		{
+			ranges[j - 1] = ranges[j];
+		}
+		ranges.popBack(m_alloc);
+	}
+	else if(mergeLeft)
+	{
+		ranges[idx - 1].m_size += range.m_size;
+	}
+	else if(mergeRight)
+	{
+		ranges[idx].m_offset = range.m_offset;
+		ranges[idx].m_size += range.m_size;
+	}
+	else
+	{
+		ranges.emplaceAt(m_alloc, ranges.getBegin() + idx, range);
+	}
+
+	// Release the oversized chunks once they are empty. The regular ones stay for the next allocations
+	const PtrSize chunkSize = chunk.m_buffer->getSize();
+	if(chunkSize > m_chunkSize && ranges.getSize() == 1 && ranges[0].m_size == chunkSize)
+	{
+		ranges.destroy(m_alloc);
+		chunk.m_buffer.reset(nullptr);
+		m_totalMemory -= chunkSize;
+	}
+}
+
+} // end namespace anki
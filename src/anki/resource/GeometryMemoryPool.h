@@ -0,0 +1,143 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/resource/Common.h>
+#include <anki/gr/Buffer.h>
+#include <anki/util/DynamicArray.h>
+#include <anki/util/Thread.h>
+
+namespace anki
+{
+
+/// @addtogroup resource
+/// @{
+
+/// A part of a GeometryMemoryPool buffer.
+class GeometryAllocation
+{
+	friend class GeometryMemoryPool;
+
+public:
+	BufferPtr getBuffer() const
+	{
+		ANKI_ASSERT(isValid());
+		return m_buffer;
+	}
+
+	/// Offset from the start of getBuffer().
+	PtrSize getOffset() const
+	{
+		ANKI_ASSERT(isValid());
+		return m_offset;
+	}
+
+	PtrSize getSize() const
+	{
+		ANKI_ASSERT(isValid());
+		return m_size;
+	}
+
+	Bool isValid() const
+	{
+		return m_buffer.isCreated();
+	}
+
+private:
+	BufferPtr m_buffer;
+	PtrSize m_offset = 0;
+	PtrSize m_size = 0;
+	U32 m_chunk = MAX_U32;
+};
+
+/// Sub-allocates the vertex, index and meshlet data of the meshes from a few big GPU buffers. It keeps the meshes from
+/// fragmenting the GPU memory with many small buffers and it makes the geometry of many meshes share one buffer.
+class GeometryMemoryPool : public NonCopyable
+{
+public:
+	/// The usage of all the pool buffers.
+	static constexpr BufferUsageBit USAGE = BufferUsageBit::VERTEX | BufferUsageBit::INDEX
+											| BufferUsageBit::STORAGE_VERTEX_READ;
+
+	GeometryMemoryPool() = default;
+
+	~GeometryMemoryPool();
+
+	/// @param chunkSize The size of the buffers. Bigger allocations get a buffer of their own.
+	/// @param alignment The alignment of all the allocations.
+	void init(GrManager* gr, ResourceAllocator<U8> alloc, PtrSize chunkSize, U32 alignment);
+
+	/// Allocate memory. The buffer can also be an upload destination and it can be filled.
+	/// @note Thread-safe.
+	void allocate(PtrSize size, GeometryAllocation& out);
+
+	/// Free the memory. It won't be recycled before the GPU stops using it.
+	/// @note Thread-safe.
+	void free(GeometryAllocation& alloc);
+
+	/// Recycle the memory of the old frees. Call it once every frame.
+	/// @note Thread-safe.
+	void endFrame();
+
+	/// The memory of the buffers the pool created.
+	PtrSize getTotalMemory() const
+	{
+		LockGuard<Mutex> lock(m_mtx);
+		return m_totalMemory;
+	}
+
+	/// The memory the allocations use.
+	PtrSize getAllocatedMemory() const
+	{
+		LockGuard<Mutex> lock(m_mtx);
+		return m_allocatedMemory;
+	}
+
+private:
+	/// The frames before a free becomes available again. The GPU might still use the memory until then.
+	static constexpr U32 FREE_DELAY_FRAMES = MAX_FRAMES_IN_FLIGHT + 1;
+
+	class Range
+	{
+	public:
+		PtrSize m_offset;
+		PtrSize m_size;
+	};
+
+	class Chunk
+	{
+	public:
+		BufferPtr m_buffer;
+		DynamicArray<Range> m_freeRanges; ///< Sorted by offset.
+	};
+
+	class PendingFree
+	{
+	public:
+		U32 m_chunk;
+		Range m_range;
+		U64 m_frame;
+	};
+
+	GrManager* m_gr = nullptr;
+	ResourceAllocator<U8> m_alloc;
+	PtrSize m_chunkSize = 0;
+	U32 m_alignment = 0;
+
+	mutable Mutex m_mtx; ///< Protect the members below.
+	DynamicArray<Chunk> m_chunks;
+	DynamicArray<PendingFree> m_pendingFrees;
+	U64 m_frame = 0;
+	PtrSize m_totalMemory = 0;
+	PtrSize m_allocatedMemory = 0;
+
+	Bool allocateFromChunk(U32 chunkIdx, PtrSize size, GeometryAllocation& out);
+
+	void freeRange(U32 chunkIdx, const Range& range);
+};
+/// @}
+
+} // end namespace anki
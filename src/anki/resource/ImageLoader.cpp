@@ -20,6 +20,11 @@
 #if ANKI_COMPILER_GCC_COMPATIBLE
 #	pragma GCC diagnostic pop
 #endif
+#if ANKI_SIMD_SSE
+#	include <emmintrin.h>
+#elif ANKI_SIMD_NEON
+#	include <arm_neon.h>
+#endif
 
 namespace anki
 {
@@ -27,22 +32,6 @@ namespace anki
 static const U8 tgaHeaderUncompressed[12] = {0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0};
 static const U8 tgaHeaderCompressed[12] = {0, 0, 10, 0, 0, 0, 0, 0, 0, 0, 0, 0};
 
-class AnkiTextureHeader
-{
-public:
-	Array<U8, 8> m_magic;
-	U32 m_width;
-	U32 m_height;
-	U32 m_depthOrLayerCount;
-	ImageLoaderTextureType m_type;
-	ImageLoaderColorFormat m_colorFormat;
-	ImageLoaderDataCompression m_compressionFormats;
-	U32 m_normal;
-	U32 m_mipCount;
-	U8 m_padding[88];
-};
-static_assert(sizeof(AnkiTextureHeader) == 128, "Check sizeof AnkiTextureHeader");
-
 /// Get the size in bytes of a single surface
 static PtrSize calcSurfaceSize(
 	const U32 width, const U32 height, const ImageLoaderDataCompression comp, const ImageLoaderColorFormat cf)
@@ -62,6 +51,10 @@ static PtrSize calcSurfaceSize(
 	case ImageLoaderDataCompression::ETC:
 		out = (width / 4) * (height / 4) * 8;
 		break;
+	case ImageLoaderDataCompression::BC7:
+	case ImageLoaderDataCompression::ASTC:
+		out = (width / 4) * (height / 4) * 16;
+		break;
 	default:
 		ANKI_ASSERT(0);
 	}
@@ -150,6 +143,61 @@ static PtrSize calcSizeOfSegment(const AnkiTextureHeader& header, ImageLoaderDat
 	return out;
 }
 
+/// Swap the red and the blue of BGR8 or BGRA8 pixels.
+static void swapRedBlue(U8* data, U32 pixelCount, U32 bytesPerPixel)
+{
+	ANKI_ASSERT(bytesPerPixel == 3 || bytesPerPixel == 4);
+	U32 i = 0;
+
+#if ANKI_SIMD_SSE
+	if(bytesPerPixel == 4)
+	{
+		// 4 pixels at a time. Swap the bytes 0 and 2 of every 32bit lane
+		const __m128i redBlueMask = _mm_set1_epi32(0x00FF00FF);
+		for(; i + 4 <= pixelCount; i += 4)
+		{
+			__m128i* ptr = reinterpret_cast<__m128i*>(data + i * 4);
+			const __m128i pixels = _mm_loadu_si128(ptr);
+			const __m128i redBlue = _mm_and_si128(pixels, redBlueMask);
+			const __m128i swapped = _mm_or_si128(_mm_slli_epi32(redBlue, 16), _mm_srli_epi32(redBlue, 16));
+			_mm_storeu_si128(ptr, _mm_or_si128(_mm_andnot_si128(redBlueMask, pixels), swapped));
+		}
+	}
+#elif ANKI_SIMD_NEON
+	// 16 pixels at a time. The loads de-interleave the channels
+	if(bytesPerPixel == 4)
+	{
+		for(; i + 16 <= pixelCount; i += 16)
+		{
+			uint8x16x4_t pixels = vld4q_u8(data + i * 4);
+			const uint8x16_t tmp = pixels.val[0];
+			pixels.val[0] = pixels.val[2];
+			pixels.val[2] = tmp;
+			vst4q_u8(data + i * 4, pixels);
+		}
+	}
+	else
+	{
+		for(; i + 16 <= pixelCount; i += 16)
+		{
+			uint8x16x3_t pixels = vld3q_u8(data + i * 3);
+			const uint8x16_t tmp = pixels.val[0];
+			pixels.val[0] = pixels.val[2];
+			pixels.val[2] = tmp;
+			vst3q_u8(data + i * 3, pixels);
+		}
+	}
+#endif
+
+	for(; i < pixelCount; ++i)
+	{
+		U8* pixel = data + i * bytesPerPixel;
+		const U8 tmp = pixel[0];
+		pixel[0] = pixel[2];
+		pixel[2] = tmp;
+	}
+}
+
 class ImageLoader::FileInterface
 {
 public:
@@ -162,6 +210,17 @@ public:
 		ANKI_ASSERT(!"Not Implemented");
 		return MAX_PTR_SIZE;
 	}
+
+	virtual Bool isMapped() const
+	{
+		return false;
+	}
+
+	virtual ANKI_USE_RESULT Error readMapped(PtrSize size, ConstWeakArray<U8>& view)
+	{
+		ANKI_ASSERT(!"Not Implemented");
+		return Error::FUNCTION_FAILED;
+	}
 };
 
 class ImageLoader::RsrcFile : public FileInterface
@@ -183,6 +242,16 @@ public:
 	{
 		return m_rfile->getSize();
 	}
+
+	Bool isMapped() const final
+	{
+		return m_rfile->isMapped();
+	}
+
+	ANKI_USE_RESULT Error readMapped(PtrSize size, ConstWeakArray<U8>& view) final
+	{
+		return m_rfile->readMapped(size, view);
+	}
 };
 
 class ImageLoader::SystemFile : public FileInterface
@@ -231,13 +300,7 @@ Error ImageLoader::loadUncompressedTga(
 
 	ANKI_CHECK(fs.read(reinterpret_cast<char*>(&data[0]), imageSize));
 
-	// swap red with blue
-	for(U32 i = 0; i < imageSize; i += bytesPerPxl)
-	{
-		U8 temp = data[i];
-		data[i] = data[i + 2];
-		data[i + 2] = temp;
-	}
+	swapRedBlue(&data[0], width * height, bytesPerPxl);
 
 	return Error::NONE;
 }
@@ -262,11 +325,12 @@ Error ImageLoader::loadCompressedTga(
 	U32 imageSize = bytesPerPxl * width * height;
 	data.create(alloc, imageSize);
 
-	U32 pixelcount = height * width;
+	const U32 pixelcount = height * width;
 	U32 currentpixel = 0;
 	U32 currentbyte = 0;
-	U8 colorbuffer[4];
+	Array<U8, 4> colorbuffer;
 
+	// Decode in BGR and swap the channels of all the pixels at the end
 	do
 	{
 		U8 chunkheader = 0;
@@ -275,59 +339,43 @@ Error ImageLoader::loadCompressedTga(
 
 		if(chunkheader < 128)
 		{
-			chunkheader++;
-			for(int counter = 0; counter < chunkheader; counter++)
+			// Raw packet, read all the pixels at once
+			const U32 count = chunkheader + 1u;
+			if(currentpixel + count > pixelcount)
 			{
-				ANKI_CHECK(fs.read((char*)&colorbuffer[0], bytesPerPxl));
-
-				data[currentbyte] = colorbuffer[2];
-				data[currentbyte + 1] = colorbuffer[1];
-				data[currentbyte + 2] = colorbuffer[0];
-
-				if(bytesPerPxl == 4)
-				{
-					data[currentbyte + 3] = colorbuffer[3];
-				}
+				ANKI_RESOURCE_LOGE("Too many pixels read");
+				return Error::USER_DATA;
+			}
 
-				currentbyte += bytesPerPxl;
-				currentpixel++;
+			ANKI_CHECK(fs.read(&data[currentbyte], count * bytesPerPxl));
 
-				if(currentpixel > pixelcount)
-				{
-					ANKI_RESOURCE_LOGE("Too many pixels read");
-					return Error::USER_DATA;
-				}
-			}
+			currentbyte += count * bytesPerPxl;
+			currentpixel += count;
 		}
 		else
 		{
-			chunkheader = U8(chunkheader - 127);
-			ANKI_CHECK(fs.read(&colorbuffer[0], bytesPerPxl));
-
-			for(U32 counter = 0; counter < chunkheader; counter++)
+			// Run-length packet
+			const U32 count = chunkheader - 127u;
+			if(currentpixel + count > pixelcount)
 			{
-				data[currentbyte] = colorbuffer[2];
-				data[currentbyte + 1] = colorbuffer[1];
-				data[currentbyte + 2] = colorbuffer[0];
+				ANKI_RESOURCE_LOGE("Too many pixels read");
+				return Error::USER_DATA;
+			}
 
-				if(bytesPerPxl == 4)
-				{
-					data[currentbyte + 3] = colorbuffer[3];
-				}
+			ANKI_CHECK(fs.read(&colorbuffer[0], bytesPerPxl));
 
+			for(U32 counter = 0; counter < count; counter++)
+			{
+				memcpy(&data[currentbyte], &colorbuffer[0], bytesPerPxl);
 				currentbyte += bytesPerPxl;
-				currentpixel++;
-
-				if(currentpixel > pixelcount)
-				{
-					ANKI_RESOURCE_LOGE("Too many pixels read");
-					data.destroy(alloc);
-					return Error::USER_DATA;
-				}
 			}
+
+			currentpixel += count;
 		}
 	} while(currentpixel < pixelcount);
 
+	swapRedBlue(&data[0], pixelcount, bytesPerPxl);
+
 	return Error::NONE;
 }
 
@@ -363,7 +411,7 @@ Error ImageLoader::loadTga(
 
 Error ImageLoader::loadAnkiTexture(FileInterface& file,
 	U32 maxTextureSize,
-	ImageLoaderDataCompression& preferredCompression,
+	ImageLoaderDataCompression& compression,
 	DynamicArray<ImageLoaderSurface>& surfaces,
 	DynamicArray<ImageLoaderVolume>& volumes,
 	GenericMemoryPoolAllocator<U8>& alloc,
@@ -372,8 +420,10 @@ Error ImageLoader::loadAnkiTexture(FileInterface& file,
 	U32& depth,
 	U32& layerCount,
 	U32& mipCount,
+	U32& skippedMipCount,
 	ImageLoaderTextureType& textureType,
-	ImageLoaderColorFormat& colorFormat)
+	ImageLoaderColorFormat& colorFormat,
+	Bool deferDataReads)
 {
 	//
 	// Read and check the header
@@ -412,20 +462,37 @@ Error ImageLoader::loadAnkiTexture(FileInterface& file,
 		return Error::USER_DATA;
 	}
 
-	if((header.m_compressionFormats & preferredCompression) == ImageLoaderDataCompression::NONE)
+	if(header.m_compressionFormats == ImageLoaderDataCompression::NONE
+		|| (header.m_compressionFormats & ~ImageLoaderDataCompression::ALL) != ImageLoaderDataCompression::NONE)
 	{
-		ANKI_RESOURCE_LOGW("File does not contain the requested compression");
+		ANKI_RESOURCE_LOGE("Incorrect header: compression formats");
+		return Error::USER_DATA;
+	}
 
-		// Fallback
-		preferredCompression = ImageLoaderDataCompression::RAW;
+	// Pick the best of the stored compressions. The block compressions before the older ones and the raw data last
+	static const Array<ImageLoaderDataCompression, 5> compressionsByQuality = {{ImageLoaderDataCompression::ASTC,
+		ImageLoaderDataCompression::BC7,
+		ImageLoaderDataCompression::S3TC,
+		ImageLoaderDataCompression::ETC,
+		ImageLoaderDataCompression::RAW}};
 
-		if((header.m_compressionFormats & preferredCompression) == ImageLoaderDataCompression::NONE)
+	const ImageLoaderDataCompression allowedCompressions = compression;
+	compression = ImageLoaderDataCompression::NONE;
+	for(ImageLoaderDataCompression c : compressionsByQuality)
+	{
+		if(!!(header.m_compressionFormats & allowedCompressions & c))
 		{
-			ANKI_RESOURCE_LOGE("File does not contain raw compression");
-			return Error::USER_DATA;
+			compression = c;
+			break;
 		}
 	}
 
+	if(compression == ImageLoaderDataCompression::NONE)
+	{
+		ANKI_RESOURCE_LOGE("File does not contain any of the requested compressions");
+		return Error::USER_DATA;
+	}
+
 	if(header.m_normal != 0 && header.m_normal != 1)
 	{
 		ANKI_RESOURCE_LOGE("Incorrect header: normal");
@@ -464,32 +531,20 @@ Error ImageLoader::loadAnkiTexture(FileInterface& file,
 	// Move file pointer
 	//
 
-	if(preferredCompression == ImageLoaderDataCompression::RAW)
+	// Skip the segments of the compressions that are stored before the one we want
+	PtrSize fileOffset = sizeof(AnkiTextureHeader);
+	for(ImageLoaderDataCompression c = ImageLoaderDataCompression::RAW; c < compression; c <<= 1u)
 	{
-		// Do nothing
-	}
-	else if(preferredCompression == ImageLoaderDataCompression::S3TC)
-	{
-		if((header.m_compressionFormats & ImageLoaderDataCompression::RAW) != ImageLoaderDataCompression::NONE)
+		if(!!(header.m_compressionFormats & c))
 		{
-			// If raw compression is present then skip it
-			ANKI_CHECK(file.seek(calcSizeOfSegment(header, ImageLoaderDataCompression::RAW), FileSeekOrigin::CURRENT));
+			const PtrSize segmentSize = calcSizeOfSegment(header, c);
+			ANKI_CHECK(file.seek(segmentSize, FileSeekOrigin::CURRENT));
+			fileOffset += segmentSize;
 		}
 	}
-	else if(preferredCompression == ImageLoaderDataCompression::ETC)
-	{
-		if((header.m_compressionFormats & ImageLoaderDataCompression::RAW) != ImageLoaderDataCompression::NONE)
-		{
-			// If raw compression is present then skip it
-			ANKI_CHECK(file.seek(calcSizeOfSegment(header, ImageLoaderDataCompression::RAW), FileSeekOrigin::CURRENT));
-		}
 
-		if((header.m_compressionFormats & ImageLoaderDataCompression::S3TC) != ImageLoaderDataCompression::NONE)
-		{
-			// If s3tc compression is present then skip it
-			ANKI_CHECK(file.seek(calcSizeOfSegment(header, ImageLoaderDataCompression::S3TC), FileSeekOrigin::CURRENT));
-		}
-	}
+	// The mapped files don't need a copy anyway
+	deferDataReads = deferDataReads && !file.isMapped();
 
 	//
 	// It's time to read
@@ -509,7 +564,7 @@ Error ImageLoader::loadAnkiTexture(FileInterface& file,
 				for(U32 f = 0; f < faceCount; ++f)
 				{
 					const U32 dataSize =
-						U32(calcSurfaceSize(mipWidth, mipHeight, preferredCompression, header.m_colorFormat));
+						U32(calcSurfaceSize(mipWidth, mipHeight, compression, header.m_colorFormat));
 
 					// Check if this mipmap can be skipped because of size
 					if(max(mipWidth, mipHeight) <= maxTextureSize || mip == header.m_mipCount - 1)
@@ -517,9 +572,22 @@ Error ImageLoader::loadAnkiTexture(FileInterface& file,
 						ImageLoaderSurface& surf = *surfaces.emplaceBack(alloc);
 						surf.m_width = mipWidth;
 						surf.m_height = mipHeight;
-
-						surf.m_data.create(alloc, dataSize);
-						ANKI_CHECK(file.read(&surf.m_data[0], dataSize));
+						surf.m_dataSize = dataSize;
+
+						if(file.isMapped())
+						{
+							ANKI_CHECK(file.readMapped(dataSize, surf.m_mappedData));
+						}
+						else if(deferDataReads)
+						{
+							surf.m_fileOffset = fileOffset;
+							ANKI_CHECK(file.seek(dataSize, FileSeekOrigin::CURRENT));
+						}
+						else
+						{
+							surf.m_data.create(alloc, dataSize);
+							ANKI_CHECK(file.read(&surf.m_data[0], dataSize));
+						}
 
 						mipCount = max(header.m_mipCount - mip, mipCount);
 					}
@@ -527,6 +595,8 @@ Error ImageLoader::loadAnkiTexture(FileInterface& file,
 					{
 						ANKI_CHECK(file.seek(dataSize, FileSeekOrigin::CURRENT));
 					}
+
+					fileOffset += dataSize;
 				}
 			}
 
@@ -546,7 +616,7 @@ Error ImageLoader::loadAnkiTexture(FileInterface& file,
 		for(U32 mip = 0; mip < header.m_mipCount; mip++)
 		{
 			const U32 dataSize =
-				U32(calcVolumeSize(mipWidth, mipHeight, mipDepth, preferredCompression, header.m_colorFormat));
+				U32(calcVolumeSize(mipWidth, mipHeight, mipDepth, compression, header.m_colorFormat));
 
 			// Check if this mipmap can be skipped because of size
 			if(max(max(mipWidth, mipHeight), mipDepth) <= maxTextureSize || mip == header.m_mipCount - 1)
@@ -555,9 +625,22 @@ Error ImageLoader::loadAnkiTexture(FileInterface& file,
 				vol.m_width = mipWidth;
 				vol.m_height = mipHeight;
 				vol.m_depth = mipDepth;
+				vol.m_dataSize = dataSize;
 
-				vol.m_data.create(alloc, dataSize);
-				ANKI_CHECK(file.read(&vol.m_data[0], dataSize));
+				if(file.isMapped())
+				{
+					ANKI_CHECK(file.readMapped(dataSize, vol.m_mappedData));
+				}
+				else if(deferDataReads)
+				{
+					vol.m_fileOffset = fileOffset;
+					ANKI_CHECK(file.seek(dataSize, FileSeekOrigin::CURRENT));
+				}
+				else
+				{
+					vol.m_data.create(alloc, dataSize);
+					ANKI_CHECK(file.read(&vol.m_data[0], dataSize));
+				}
 
 				mipCount = max(header.m_mipCount - mip, mipCount);
 			}
@@ -566,6 +649,8 @@ Error ImageLoader::loadAnkiTexture(FileInterface& file,
 				ANKI_CHECK(file.seek(dataSize, FileSeekOrigin::CURRENT));
 			}
 
+			fileOffset += dataSize;
+
 			mipWidth /= 2;
 			mipHeight /= 2;
 			mipDepth /= 2;
@@ -576,21 +661,32 @@ Error ImageLoader::loadAnkiTexture(FileInterface& file,
 		depth = volumes[0].m_depth;
 	}
 
+	skippedMipCount = header.m_mipCount - mipCount;
+
 	return Error::NONE;
 }
 
 Error ImageLoader::loadStb(
 	FileInterface& fs, U32& width, U32& height, DynamicArray<U8>& data, GenericMemoryPoolAllocator<U8>& alloc)
 {
-	// Read the file
+	// Read the file. No need to copy it if it's mapped
 	DynamicArrayAuto<U8> fileData = {alloc};
+	ConstWeakArray<U8> fileView;
 	const PtrSize fileSize = fs.getSize();
-	fileData.create(U32(fileSize));
-	ANKI_CHECK(fs.read(&fileData[0], fileSize));
+	if(fs.isMapped())
+	{
+		ANKI_CHECK(fs.readMapped(fileSize, fileView));
+	}
+	else
+	{
+		fileData.create(U32(fileSize));
+		ANKI_CHECK(fs.read(&fileData[0], fileSize));
+		fileView = fileData;
+	}
 
 	// Use STB to read the image
 	int stbw, stbh, comp;
-	U8* stbdata = reinterpret_cast<U8*>(stbi_load_from_memory(&fileData[0], I32(fileSize), &stbw, &stbh, &comp, 4));
+	U8* stbdata = reinterpret_cast<U8*>(stbi_load_from_memory(&fileView[0], I32(fileSize), &stbw, &stbh, &comp, 4));
 	if(!stbdata)
 	{
 		ANKI_RESOURCE_LOGE("STB failed to read image");
@@ -609,26 +705,31 @@ Error ImageLoader::loadStb(
 	return Error::NONE;
 }
 
-Error ImageLoader::load(ResourceFilePtr rfile, const CString& filename, U32 maxTextureSize)
+Error ImageLoader::load(
+	ResourceFilePtr rfile, const CString& filename, U32 maxTextureSize, ImageLoaderDataCompression compressions)
 {
 	RsrcFile file;
 	file.m_rfile = rfile;
 
-	const Error err = loadInternal(file, filename, maxTextureSize);
+	const Error err = loadInternal(file, filename, maxTextureSize, compressions, m_deferDataReads);
 	if(err)
 	{
 		ANKI_RESOURCE_LOGE("Failed to read image: %s", filename.cstr());
 	}
+	else if(rfile->isMapped() || m_deferDataReads)
+	{
+		m_file = rfile;
+	}
 
 	return err;
 }
 
-Error ImageLoader::load(const CString& filename, U32 maxTextureSize)
+Error ImageLoader::load(const CString& filename, U32 maxTextureSize, ImageLoaderDataCompression compressions)
 {
 	SystemFile file;
 	ANKI_CHECK(file.m_file.open(filename, FileOpenFlag::READ | FileOpenFlag::BINARY));
 
-	const Error err = loadInternal(file, filename, maxTextureSize);
+	const Error err = loadInternal(file, filename, maxTextureSize, compressions, false);
 	if(err)
 	{
 		ANKI_RESOURCE_LOGE("Failed to read image: %s", filename.cstr());
@@ -637,7 +738,11 @@ Error ImageLoader::load(const CString& filename, U32 maxTextureSize)
 	return err;
 }
 
-Error ImageLoader::loadInternal(FileInterface& file, const CString& filename, U32 maxTextureSize)
+Error ImageLoader::loadInternal(FileInterface& file,
+	const CString& filename,
+	U32 maxTextureSize,
+	ImageLoaderDataCompression compressions,
+	Bool deferDataReads)
 {
 	// get the extension
 	StringAuto ext(m_alloc);
@@ -662,6 +767,7 @@ Error ImageLoader::loadInternal(FileInterface& file, const CString& filename, U3
 		m_layerCount = 1;
 		U32 bpp = 0;
 		ANKI_CHECK(loadTga(file, m_surfaces[0].m_width, m_surfaces[0].m_height, bpp, m_surfaces[0].m_data, m_alloc));
+		m_surfaces[0].m_dataSize = m_surfaces[0].m_data.getSize();
 
 		m_width = m_surfaces[0].m_width;
 		m_height = m_surfaces[0].m_height;
@@ -681,12 +787,7 @@ Error ImageLoader::loadInternal(FileInterface& file, const CString& filename, U3
 	}
 	else if(ext == "ankitex")
 	{
-#if 0
-		compression = ImageLoaderDataCompression::RAW;
-#else
-		m_compression = ImageLoaderDataCompression::S3TC;
-#endif
-
+		m_compression = compressions;
 		ANKI_CHECK(loadAnkiTexture(file,
 			maxTextureSize,
 			m_compression,
@@ -698,10 +799,12 @@ Error ImageLoader::loadInternal(FileInterface& file, const CString& filename, U3
 			m_depth,
 			m_layerCount,
 			m_mipCount,
+			m_skippedMipCount,
 			m_textureType,
-			m_colorFormat));
+			m_colorFormat,
+			deferDataReads));
 	}
-	else if(ext == "png")
+	else if(ext == "png" || ext == "jpg" || ext == "jpeg")
 	{
 		m_surfaces.create(m_alloc, 1);
 
@@ -711,6 +814,7 @@ Error ImageLoader::loadInternal(FileInterface& file, const CString& filename, U3
 		m_colorFormat = ImageLoaderColorFormat::RGBA8;
 
 		ANKI_CHECK(loadStb(file, m_surfaces[0].m_width, m_surfaces[0].m_height, m_surfaces[0].m_data, m_alloc));
+		m_surfaces[0].m_dataSize = m_surfaces[0].m_data.getSize();
 
 		m_width = m_surfaces[0].m_width;
 		m_height = m_surfaces[0].m_height;
@@ -758,6 +862,68 @@ const ImageLoaderVolume& ImageLoader::getVolume(U32 level) const
 	return m_volumes[level];
 }
 
+Error ImageLoader::storeSurface(U32 level, U32 face, U32 layer, WeakArray<U8> dst, FileIoQueue* queue)
+{
+	const ImageLoaderSurface& surf = getSurface(level, face, layer);
+	const ConstWeakArray<U8> data =
+		(surf.m_fileOffset == MAX_PTR_SIZE) ? surf.getData() : ConstWeakArray<U8>(nullptr, 0);
+	return storeData(data, surf.m_fileOffset, surf.m_dataSize, dst, queue);
+}
+
+Error ImageLoader::storeVolume(U32 level, WeakArray<U8> dst, FileIoQueue* queue)
+{
+	const ImageLoaderVolume& vol = getVolume(level);
+	const ConstWeakArray<U8> data =
+		(vol.m_fileOffset == MAX_PTR_SIZE) ? vol.getData() : ConstWeakArray<U8>(nullptr, 0);
+	return storeData(data, vol.m_fileOffset, vol.m_dataSize, dst, queue);
+}
+
+Error ImageLoader::storeData(
+	ConstWeakArray<U8> data, PtrSize fileOffset, U32 dataSize, WeakArray<U8> dst, FileIoQueue* queue)
+{
+	ANKI_ASSERT(dst.getSize() == dataSize);
+
+	if(fileOffset == MAX_PTR_SIZE)
+	{
+		// Already in memory
+		ANKI_ASSERT(data.getSize() == dataSize);
+		memcpy(&dst[0], &data[0], dataSize);
+		return Error::NONE;
+	}
+
+	// Read straight to the destination
+	ANKI_ASSERT(m_file.isCreated());
+	ANKI_CHECK(m_file->seek(fileOffset, FileSeekOrigin::BEGINNING));
+	if(queue)
+	{
+		ANKI_CHECK(m_file->readAsync(*queue,
+			&dst[0],
+			dataSize,
+			[](void* userData, Error err) {
+				if(err)
+				{
+					static_cast<ImageLoader*>(userData)->m_asyncReadErr = err;
+				}
+			},
+			this));
+	}
+	else
+	{
+		ANKI_CHECK(m_file->read(&dst[0], dataSize));
+	}
+
+	return Error::NONE;
+}
+
+Error ImageLoader::waitAsyncReads(FileIoQueue& queue)
+{
+	ANKI_CHECK(queue.waitAll());
+
+	const Error err = m_asyncReadErr;
+	m_asyncReadErr = Error::NONE;
+	return err;
+}
+
 void ImageLoader::destroy()
 {
 	for(ImageLoaderSurface& surf : m_surfaces)
@@ -773,6 +939,8 @@ void ImageLoader::destroy()
 	}
 
 	m_volumes.destroy(m_alloc);
+
+	m_file.reset(nullptr);
 }
 
 } // end namespace anki
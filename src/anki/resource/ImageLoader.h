@@ -31,17 +31,45 @@ enum class ImageLoaderColorFormat : U32
 	RGBA8 ///< RGB plus alpha
 };
 
-/// The data compression
+/// The data compression. An AnKi texture can store the same image with many compressions. They are in the order of
+/// the bits in the file.
 /// @memberof ImageLoader
 enum class ImageLoaderDataCompression : U32
 {
 	NONE,
 	RAW = 1 << 0,
-	S3TC = 1 << 1,
-	ETC = 1 << 2
+	S3TC = 1 << 1, ///< BC1 for RGB8 and BC3 for RGBA8.
+	ETC = 1 << 2, ///< ETC2 with 1 bit alpha.
+	BC7 = 1 << 3,
+	ASTC = 1 << 4, ///< ASTC LDR with 4x4 blocks.
+
+	ALL = RAW | S3TC | ETC | BC7 | ASTC
 };
 ANKI_ENUM_ALLOW_NUMERIC_OPERATIONS(ImageLoaderDataCompression, inline)
 
+/// The compressions that ImageLoader picks from by default.
+constexpr ImageLoaderDataCompression IMAGE_LOADER_DEFAULT_COMPRESSIONS =
+	ImageLoaderDataCompression::RAW | ImageLoaderDataCompression::S3TC;
+
+/// The header of the .ankitex files. After it there are the data of every stored compression in the order of the
+/// ImageLoaderDataCompression bits. The data of a compression are all the mips, the biggest first.
+/// @memberof ImageLoader
+class AnkiTextureHeader
+{
+public:
+	Array<U8, 8> m_magic; ///< ANKITEX1
+	U32 m_width;
+	U32 m_height;
+	U32 m_depthOrLayerCount;
+	ImageLoaderTextureType m_type;
+	ImageLoaderColorFormat m_colorFormat;
+	ImageLoaderDataCompression m_compressionFormats;
+	U32 m_normal;
+	U32 m_mipCount;
+	U8 m_padding[88];
+};
+static_assert(sizeof(AnkiTextureHeader) == 128, "Check sizeof AnkiTextureHeader");
+
 /// An image surface
 /// @memberof ImageLoader
 class ImageLoaderSurface
@@ -49,7 +77,17 @@ class ImageLoaderSurface
 public:
 	U32 m_width;
 	U32 m_height;
-	DynamicArray<U8> m_data;
+	DynamicArray<U8> m_data; ///< It's empty if the data are in a mapped file or their read is deferred.
+	ConstWeakArray<U8> m_mappedData;
+	PtrSize m_fileOffset = MAX_PTR_SIZE; ///< Where the data are in the file if their read is deferred.
+	U32 m_dataSize = 0;
+
+	/// @note Not for the deferred reads. Use ImageLoader::storeSurface() for those.
+	ConstWeakArray<U8> getData() const
+	{
+		ANKI_ASSERT(m_fileOffset == MAX_PTR_SIZE);
+		return (m_data.getSize()) ? ConstWeakArray<U8>(m_data) : m_mappedData;
+	}
 };
 
 /// An image volume
@@ -60,10 +98,20 @@ public:
 	U32 m_width;
 	U32 m_height;
 	U32 m_depth;
-	DynamicArray<U8> m_data;
+	DynamicArray<U8> m_data; ///< It's empty if the data are in a mapped file or their read is deferred.
+	ConstWeakArray<U8> m_mappedData;
+	PtrSize m_fileOffset = MAX_PTR_SIZE; ///< Where the data are in the file if their read is deferred.
+	U32 m_dataSize = 0;
+
+	/// @note Not for the deferred reads. Use ImageLoader::storeVolume() for those.
+	ConstWeakArray<U8> getData() const
+	{
+		ANKI_ASSERT(m_fileOffset == MAX_PTR_SIZE);
+		return (m_data.getSize()) ? ConstWeakArray<U8>(m_data) : m_mappedData;
+	}
 };
 
-/// Loads bitmaps from regular system files or resource files. Supported formats are .tga and .ankitex.
+/// Loads bitmaps from regular system files or resource files. Supported formats are .tga, .png, .jpg and .ankitex.
 class ImageLoader
 {
 public:
@@ -95,6 +143,12 @@ public:
 		return m_mipCount;
 	}
 
+	/// Get the number of the top mips that the maxTextureSize of load() skipped.
+	U32 getSkippedMipmapCount() const
+	{
+		return m_skippedMipCount;
+	}
+
 	U32 getWidth() const
 	{
 		return m_width;
@@ -127,11 +181,37 @@ public:
 
 	const ImageLoaderVolume& getVolume(U32 level) const;
 
+	/// Don't read the data of the AnKi textures in load(). They are read later straight to their destination with
+	/// storeSurface() and storeVolume(). It works only for the resource files that are not mapped.
+	void setDeferDataReads(Bool defer)
+	{
+		m_deferDataReads = defer;
+	}
+
+	/// Copy or read the data of a surface.
+	/// @param[out] dst Where to write the data. Its size is ImageLoaderSurface::m_dataSize.
+	/// @param queue If it's not nullptr the deferred reads are asynchronous. Call waitAsyncReads() before using dst.
+	ANKI_USE_RESULT Error storeSurface(U32 level, U32 face, U32 layer, WeakArray<U8> dst, FileIoQueue* queue = nullptr);
+
+	/// Copy or read the data of a volume.
+	/// @see storeSurface
+	ANKI_USE_RESULT Error storeVolume(U32 level, WeakArray<U8> dst, FileIoQueue* queue = nullptr);
+
+	/// Wait for the reads of the store methods that were given a FileIoQueue.
+	ANKI_USE_RESULT Error waitAsyncReads(FileIoQueue& queue);
+
 	/// Load a resource image file.
-	ANKI_USE_RESULT Error load(ResourceFilePtr file, const CString& filename, U32 maxTextureSize = MAX_U32);
+	/// @param compressions The compressions that can be loaded. If an AnKi texture contains many of them it will pick
+	///                     the one with the best quality per bit.
+	ANKI_USE_RESULT Error load(ResourceFilePtr file,
+		const CString& filename,
+		U32 maxTextureSize = MAX_U32,
+		ImageLoaderDataCompression compressions = IMAGE_LOADER_DEFAULT_COMPRESSIONS);
 
 	/// Load a system image file.
-	ANKI_USE_RESULT Error load(const CString& filename, U32 maxTextureSize = MAX_U32);
+	ANKI_USE_RESULT Error load(const CString& filename,
+		U32 maxTextureSize = MAX_U32,
+		ImageLoaderDataCompression compressions = IMAGE_LOADER_DEFAULT_COMPRESSIONS);
 
 private:
 	class FileInterface;
@@ -140,6 +220,9 @@ private:
 
 	GenericMemoryPoolAllocator<U8> m_alloc;
 
+	/// Keep it alive because the surfaces might point to its memory or their data might be read later.
+	ResourceFilePtr m_file;
+
 	/// [mip][depth or face or layer]. Loader doesn't support cube arrays ATM so face and layer won't be used at the
 	/// same time.
 	DynamicArray<ImageLoaderSurface> m_surfaces;
@@ -147,6 +230,7 @@ private:
 	DynamicArray<ImageLoaderVolume> m_volumes;
 
 	U32 m_mipCount = 0;
+	U32 m_skippedMipCount = 0;
 	U32 m_width = 0;
 	U32 m_height = 0;
 	U32 m_depth = 0;
@@ -154,6 +238,8 @@ private:
 	ImageLoaderDataCompression m_compression = ImageLoaderDataCompression::NONE;
 	ImageLoaderColorFormat m_colorFormat = ImageLoaderColorFormat::NONE;
 	ImageLoaderTextureType m_textureType = ImageLoaderTextureType::NONE;
+	Bool m_deferDataReads = false;
+	Error m_asyncReadErr = Error::NONE;
 
 	void destroy();
 
@@ -183,7 +269,7 @@ private:
 
 	static ANKI_USE_RESULT Error loadAnkiTexture(FileInterface& file,
 		U32 maxTextureSize,
-		ImageLoaderDataCompression& preferredCompression,
+		ImageLoaderDataCompression& compression,
 		DynamicArray<ImageLoaderSurface>& surfaces,
 		DynamicArray<ImageLoaderVolume>& volumes,
 		GenericMemoryPoolAllocator<U8>& alloc,
@@ -192,10 +278,19 @@ private:
 		U32& depth,
 		U32& layerCount,
 		U32& mipCount,
+		U32& skippedMipCount,
 		ImageLoaderTextureType& textureType,
-		ImageLoaderColorFormat& colorFormat);
+		ImageLoaderColorFormat& colorFormat,
+		Bool deferDataReads);
+
+	ANKI_USE_RESULT Error loadInternal(FileInterface& file,
+		const CString& filename,
+		U32 maxTextureSize,
+		ImageLoaderDataCompression compressions,
+		Bool deferDataReads);
 
-	ANKI_USE_RESULT Error loadInternal(FileInterface& file, const CString& filename, U32 maxTextureSize);
+	ANKI_USE_RESULT Error storeData(
+		ConstWeakArray<U8> data, PtrSize fileOffset, U32 dataSize, WeakArray<U8> dst, FileIoQueue* queue);
 };
 
 } // end namespace anki
@@ -6,7 +6,11 @@
 #include <anki/resource/MaterialResource.h>
 #include <anki/resource/ResourceManager.h>
 #include <anki/resource/TextureResource.h>
+#include <anki/resource/TextureStreamer.h>
+#include <anki/resource/MaterialVariantCache.h>
+#include <anki/resource/ResourceDescriptor.h>
 #include <anki/util/Xml.h>
+#include <algorithm>
 
 namespace anki
 {
@@ -35,7 +39,8 @@ static const Array<BuiltinVarInfo, U(BuiltinMaterialVariableId::COUNT)> BUILTIN_
 		{"m_ankiRotationMatrix", ShaderVariableDataType::MAT3, true},
 		{"m_ankiCameraRotationMatrix", ShaderVariableDataType::MAT3, false},
 		{"m_ankiCameraPosition", ShaderVariableDataType::VEC3, false},
-		{"u_ankiGlobalSampler", ShaderVariableDataType::SAMPLER, false}}};
+		{"u_ankiGlobalSampler", ShaderVariableDataType::SAMPLER, false},
+		{"m_ankiLodFade", ShaderVariableDataType::FLOAT, true}}};
 
 static ANKI_USE_RESULT Error checkBuiltin(
 	CString name, ShaderVariableDataType dataType, Bool instanced, BuiltinMaterialVariableId& outId)
@@ -90,6 +95,31 @@ MaterialVariable::~MaterialVariable()
 {
 }
 
+/// The bytes that a variable that is not an array covers in a shader block.
+static U32 getShaderBlockVariableSize(ShaderVariableDataType type, const ShaderVariableBlockInfo& blockInfo)
+{
+	if(type == ShaderVariableDataType::MAT3)
+	{
+		return 2 * U32(blockInfo.m_matrixStride) + sizeof(Vec3);
+	}
+	else if(type == ShaderVariableDataType::MAT4)
+	{
+		return 3 * U32(blockInfo.m_matrixStride) + sizeof(Vec4);
+	}
+
+	switch(type)
+	{
+#define ANKI_SVDT_MACRO(svdt, akType) \
+	case ShaderVariableDataType::svdt: \
+		return sizeof(akType);
+#include <anki/gr/ShaderVariableDataTypeDefs.h>
+#undef ANKI_SVDT_MACRO
+	default:
+		ANKI_ASSERT(0);
+		return 0;
+	}
+}
+
 MaterialResource::MaterialResource(ResourceManager* manager)
 	: ResourceObject(manager)
 {
@@ -110,27 +140,94 @@ MaterialResource::~MaterialResource()
 						MaterialVariant& variant = m_variantMatrix[p][l][inst][skinned][vel];
 						variant.m_blockInfos.destroy(getAllocator());
 						variant.m_opaqueBindings.destroy(getAllocator());
+						variant.m_constantBlockMemory.destroy(getAllocator());
+						variant.m_constantBlockCopies.destroy(getAllocator());
 					}
 				}
 			}
 		}
 	}
 
-	for(MaterialVariable& var : m_vars)
-	{
-		var.m_name.destroy(getAllocator());
-	}
 	m_vars.destroy(getAllocator());
 
 	m_nonBuiltinsMutation.destroy(getAllocator());
 }
 
 Error MaterialResource::load(const ResourceFilename& filename, Bool async)
+{
+	StringAuto text(getTempAllocator());
+	CookedDescriptorData cookedData(getTempAllocator());
+	MaterialDescriptor* cooked;
+	ANKI_CHECK(openFileLoadCookedDescriptor(filename, MATERIAL_DESCRIPTOR_MAGIC, text, cookedData, cooked));
+	if(cooked && validateDescriptor(*cooked))
+	{
+		ANKI_CHECK(loadProgram(getDescriptorString(cooked->m_strings, cooked->m_shaderProgram), async));
+
+		// The program might have changed since the descriptor was cooked
+		if(!descriptorMatchesProgram(*cooked))
+		{
+			cooked = nullptr;
+		}
+	}
+	else
+	{
+		cooked = nullptr;
+	}
+
+	if(cooked)
+	{
+		ANKI_CHECK(init(*cooked, async));
+	}
+	else
+	{
+		// Parse the XML and cook it for the next time
+		DynamicArrayAuto<MaterialDescriptorMutator> mutators(getTempAllocator());
+		DynamicArrayAuto<MaterialDescriptorInput> inputs(getTempAllocator());
+		DynamicArrayAuto<char> strings(getTempAllocator());
+		MaterialDescriptor desc;
+		ANKI_CHECK(parseXml(text.toCString(), async, desc, mutators, inputs, strings));
+
+		desc.m_mutators = WeakArray<MaterialDescriptorMutator>(mutators);
+		desc.m_inputs = WeakArray<MaterialDescriptorInput>(inputs);
+		desc.m_strings = WeakArray<char>(strings);
+		ANKI_CHECK(init(desc, async));
+
+		saveCookedDescriptor(filename, MATERIAL_DESCRIPTOR_MAGIC, text.toCString(), desc);
+	}
+
+	// Create the variants the level uses now instead of the first time a draw needs them
+	m_variantCacheKey = filename.computeHash();
+	createCachedVariants();
+
+	return Error::NONE;
+}
+
+Error MaterialResource::loadProgram(CString fname, Bool async)
+{
+	if(m_prog.isCreated())
+	{
+		return Error::NONE;
+	}
+
+	ANKI_CHECK(getManager().loadResource(fname, m_prog, async));
+
+	// Good time to create the vars
+	ANKI_CHECK(createVars());
+
+	return Error::NONE;
+}
+
+Error MaterialResource::parseXml(CString text,
+	Bool async,
+	MaterialDescriptor& desc,
+	DynamicArrayAuto<MaterialDescriptorMutator>& mutators,
+	DynamicArrayAuto<MaterialDescriptorInput>& inputs,
+	DynamicArrayAuto<char>& strings)
 {
 	XmlDocument doc;
 	XmlElement el;
 	Bool present = false;
-	ANKI_CHECK(openFileParseXml(filename, doc));
+	ANKI_CHECK(doc.parse(text, getTempAllocator()));
 
 	// <material>
 	XmlElement rootEl;
@@ -139,41 +236,182 @@ Error MaterialResource::load(const ResourceFilename& filename, Bool async)
 	// shaderProgram
 	CString fname;
 	ANKI_CHECK(rootEl.getAttributeText("shaderProgram", fname));
-	ANKI_CHECK(getManager().loadResource(fname, m_prog, async));
-
-	// Good time to create the vars
-	ANKI_CHECK(createVars());
+	desc.m_shaderProgram = pushBackDescriptorString(fname, strings);
+	ANKI_CHECK(loadProgram(fname, async));
 
 	// shadow
-	ANKI_CHECK(rootEl.getAttributeNumberOptional("shadow", m_shadow, present));
-	m_shadow = m_shadow != 0;
+	ANKI_CHECK(rootEl.getAttributeNumberOptional("shadow", desc.m_shadow, present));
+	desc.m_shadow = desc.m_shadow != 0;
 
 	// forwardShading
-	ANKI_CHECK(rootEl.getAttributeNumberOptional("forwardShading", m_forwardShading, present));
-	m_forwardShading = m_forwardShading != 0;
+	ANKI_CHECK(rootEl.getAttributeNumberOptional("forwardShading", desc.m_forwardShading, present));
+	desc.m_forwardShading = desc.m_forwardShading != 0;
+
+	// bindless
+	ANKI_CHECK(rootEl.getAttributeNumberOptional("bindless", desc.m_bindless, present));
+	desc.m_bindless = desc.m_bindless != 0;
 
 	// <mutation>
 	XmlElement mutatorsEl;
 	ANKI_CHECK(rootEl.getChildElementOptional("mutation", mutatorsEl));
 	if(mutatorsEl)
 	{
-		ANKI_CHECK(parseMutators(mutatorsEl));
+		ANKI_CHECK(parseMutators(mutatorsEl, mutators, strings));
 	}
 
-	// The rest of the mutators
-	ANKI_CHECK(findBuiltinMutators());
-
 	// <inputs>
 	ANKI_CHECK(rootEl.getChildElementOptional("inputs", el));
 	if(el)
 	{
-		ANKI_CHECK(parseInputs(el, async));
+		ANKI_CHECK(parseInputs(el, desc.m_bindless, inputs, strings));
+	}
+
+	return Error::NONE;
+}
+
+Bool MaterialResource::validateDescriptor(const MaterialDescriptor& desc)
+{
+	if(!isValidDescriptorString(desc.m_strings, desc.m_shaderProgram))
+	{
+		return false;
+	}
+
+	for(const MaterialDescriptorMutator& mutator : desc.m_mutators)
+	{
+		if(!isValidDescriptorString(desc.m_strings, mutator.m_name))
+		{
+			return false;
+		}
+	}
+
+	for(const MaterialDescriptorInput& input : desc.m_inputs)
+	{
+		if(!isValidDescriptorString(desc.m_strings, input.m_name)
+			|| (input.m_texture != MAX_U32 && !isValidDescriptorString(desc.m_strings, input.m_texture)))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+Bool MaterialResource::descriptorMatchesProgram(const MaterialDescriptor& desc) const
+{
+	for(const MaterialDescriptorInput& input : desc.m_inputs)
+	{
+		const MaterialVariable* var = tryFindVariable(getDescriptorString(desc.m_strings, input.m_name));
+		if(var == nullptr || var->m_builtin != BuiltinMaterialVariableId::NONE || var->m_dataType != input.m_dataType
+			|| (!var->isConstant() && var->isInstanced() && !desc.m_bindless))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+Error MaterialResource::init(const MaterialDescriptor& desc, Bool async)
+{
+	m_shadow = desc.m_shadow != 0;
+	m_forwardShading = desc.m_forwardShading != 0;
+	m_bindless = desc.m_bindless != 0;
+
+	// The non-builtin mutators
+	if(desc.m_mutators.getSize())
+	{
+		m_nonBuiltinsMutation.create(getAllocator(), desc.m_mutators.getSize());
+	}
+
+	for(U32 i = 0; i < desc.m_mutators.getSize(); ++i)
+	{
+		const CString mutatorName = getDescriptorString(desc.m_strings, desc.m_mutators[i].m_name);
+		SubMutation& smutation = m_nonBuiltinsMutation[i];
+		smutation.m_value = desc.m_mutators[i].m_value;
+
+		// Find mutator
+		smutation.m_mutator = m_prog->tryFindMutator(mutatorName);
+
+		if(!smutation.m_mutator)
+		{
+			ANKI_RESOURCE_LOGE("Mutator not found in program %s", &mutatorName[0]);
+			return Error::USER_DATA;
+		}
+
+		if(!smutation.m_mutator->valueExists(smutation.m_value))
+		{
+			ANKI_RESOURCE_LOGE("Value %d is not part of the mutator %s", smutation.m_value, &mutatorName[0]);
+			return Error::USER_DATA;
+		}
+	}
+
+	// The rest of the mutators
+	ANKI_CHECK(findBuiltinMutators());
+
+	if(usesMeshShaders())
+	{
+		ANKI_CHECK(findMeshletStorageBlocks());
+	}
+
+	// The inputs
+	static_assert(sizeof(MaterialDescriptorInput::m_value) == sizeof(Mat4), "The value should cover the whole union");
+	for(const MaterialDescriptorInput& input : desc.m_inputs)
+	{
+		MaterialVariable* var = tryFindVariable(getDescriptorString(desc.m_strings, input.m_name));
+		ANKI_ASSERT(var && var->m_dataType == input.m_dataType);
+		memcpy(&var->m_mat4, &input.m_value[0], sizeof(Mat4));
+
+		if(input.m_texture != MAX_U32)
+		{
+			const CString texfname = getDescriptorString(desc.m_strings, input.m_texture);
+			ANKI_CHECK(getManager().loadStreamedTexture(texfname, var->m_tex, async));
+		}
+	}
+
+	if(m_bindless)
+	{
+		ANKI_CHECK(initBindless());
 	}
 
 	return Error::NONE;
 }
 
-Error MaterialResource::parseMutators(XmlElement mutatorsEl)
+void MaterialResource::createCachedVariants() const
+{
+	const MaterialVariantCache* cache = getManager().getMaterialVariantCache();
+	if(!cache)
+	{
+		return;
+	}
+
+	const MaterialVariantCache::VariantMask variants = cache->getVariants(m_variantCacheKey);
+	for(U32 idx = 0; idx < MaterialVariantCache::MAX_VARIANTS; ++idx)
+	{
+		if(!variants.get(idx))
+		{
+			continue;
+		}
+
+		const Bool velocity = idx % 2;
+		const Bool skinned = (idx / 2) % 2;
+		const U32 instanceGroup = (idx / 4) % MAX_INSTANCE_GROUPS;
+		const U32 lod = (idx / (4 * MAX_INSTANCE_GROUPS)) % MAX_LOD_COUNT;
+		const Pass pass = Pass(idx / (4 * MAX_INSTANCE_GROUPS * MAX_LOD_COUNT));
+
+		// The material might have changed since the cache was written
+		if(lod >= m_lodCount || (instanceGroup > 0 && !isInstanced())
+			|| (skinned && !m_builtinMutators[BuiltinMutatorId::BONES])
+			|| (velocity && !m_builtinMutators[BuiltinMutatorId::VELOCITY]))
+		{
+			continue;
+		}
+
+		getOrCreateVariant(RenderingKey(pass, lod, 1u << instanceGroup, skinned, velocity));
+	}
+}
+
+Error MaterialResource::parseMutators(
+	XmlElement mutatorsEl, DynamicArrayAuto<MaterialDescriptorMutator>& mutators, DynamicArrayAuto<char>& strings)
 {
 	XmlElement mutatorEl;
 	ANKI_CHECK(mutatorsEl.getChildElement("mutator", mutatorEl));
@@ -181,16 +419,9 @@ Error MaterialResource::parseMutators(XmlElement mutatorsEl)
 	//
 	// Process the non-builtin mutators
 	//
-	U32 mutatorCount = 0;
-	ANKI_CHECK(mutatorEl.getSiblingElementsCount(mutatorCount));
-	++mutatorCount;
-	ANKI_ASSERT(mutatorCount > 0);
-	m_nonBuiltinsMutation.create(getAllocator(), mutatorCount);
-	mutatorCount = 0;
-
 	do
 	{
-		SubMutation& smutation = m_nonBuiltinsMutation[mutatorCount];
+		MaterialDescriptorMutator& mutator = *mutators.emplaceBack();
 
 		// name
 		CString mutatorName;
@@ -221,31 +452,15 @@ Error MaterialResource::parseMutators(XmlElement mutatorsEl)
 			return Error::USER_DATA;
 		}
 
-		// value
-		ANKI_CHECK(mutatorEl.getAttributeNumber("value", smutation.m_value));
-
-		// Find mutator
-		smutation.m_mutator = m_prog->tryFindMutator(mutatorName);
-
-		if(!smutation.m_mutator)
-		{
-			ANKI_RESOURCE_LOGE("Mutator not found in program %s", &mutatorName[0]);
-			return Error::USER_DATA;
-		}
+		mutator.m_name = pushBackDescriptorString(mutatorName, strings);
 
-		if(!smutation.m_mutator->valueExists(smutation.m_value))
-		{
-			ANKI_RESOURCE_LOGE("Value %d is not part of the mutator %s", smutation.m_value, &mutatorName[0]);
-			return Error::USER_DATA;
-		}
+		// value
+		ANKI_CHECK(mutatorEl.getAttributeNumber("value", mutator.m_value));
 
 		// Advance
-		++mutatorCount;
 		ANKI_CHECK(mutatorEl.getNextSiblingElement("mutator", mutatorEl));
 	} while(mutatorEl);
 
-	ANKI_ASSERT(mutatorCount == m_nonBuiltinsMutation.getSize());
-
 	return Error::NONE;
 }
 
@@ -437,6 +652,52 @@ Error MaterialResource::findBuiltinMutators()
 	return Error::NONE;
 }
 
+Error MaterialResource::findMeshletStorageBlocks()
+{
+	static const Array<CString, U32(MeshletStorageBlock::COUNT)> BLOCK_NAMES = {{"b_ankiMeshlets",
+		"b_ankiMeshletVertices",
+		"b_ankiMeshletPrimitives",
+		"b_ankiPositions",
+		"b_ankiNormalsTangentsUvs"}};
+
+	if(m_builtinMutators[BuiltinMutatorId::BONES] || m_bindless)
+	{
+		ANKI_RESOURCE_LOGE("Skinning and bindless are not supported with mesh shaders");
+		return Error::USER_DATA;
+	}
+
+	const ShaderProgramBinary& binary = m_prog->getBinary();
+	for(const ShaderProgramBinaryBlock& block : binary.m_storageBlocks)
+	{
+		for(MeshletStorageBlock b = MeshletStorageBlock::FIRST; b < MeshletStorageBlock::COUNT; ++b)
+		{
+			if(CString(block.m_name.getBegin()) != BLOCK_NAMES[b])
+			{
+				continue;
+			}
+
+			if(block.m_set != m_descriptorSetIdx)
+			{
+				ANKI_RESOURCE_LOGE("The set of %s should be %u", BLOCK_NAMES[b].cstr(), m_descriptorSetIdx);
+				return Error::USER_DATA;
+			}
+
+			m_meshletBindings[b] = block.m_binding;
+		}
+	}
+
+	for(MeshletStorageBlock b = MeshletStorageBlock::FIRST; b < MeshletStorageBlock::NORMALS_TANGENTS_UVS; ++b)
+	{
+		if(m_meshletBindings[b] == MAX_U32)
+		{
+			ANKI_RESOURCE_LOGE("The program has a mesh shader but %s was not found", BLOCK_NAMES[b].cstr());
+			return Error::USER_DATA;
+		}
+	}
+
+	return Error::NONE;
+}
+
 Error MaterialResource::parseVariable(CString fullVarName, Bool& instanced, U32& idx, CString& name)
 {
 	idx = 0;
@@ -562,7 +823,7 @@ Error MaterialResource::createVars()
 			}
 
 			MaterialVariable& in = *m_vars.emplaceBack(getAllocator());
-			in.m_name.create(getAllocator(), name);
+			in.m_name = StringId(name);
 			in.m_index = m_vars.getSize() - 1;
 			in.m_indexInBinary = U32(&var - block.m_variables.getBegin());
 			in.m_constant = false;
@@ -583,6 +844,13 @@ Error MaterialResource::createVars()
 	// Continue with the opaque if it's a material shader program
 	for(const ShaderProgramBinaryOpaque& o : binary.m_opaques)
 	{
+		// The arrays of the ANKI_BINDLESS_SET are not part of the material
+		if(CString(o.m_name.getBegin()).find("u_bindless") == 0)
+		{
+			m_bindlessDescriptorSetIdx = U8(o.m_set);
+			continue;
+		}
+
 		maxDescriptorSet = max(maxDescriptorSet, o.m_set);
 
 		if(o.m_set != descriptorSet)
@@ -591,7 +859,7 @@ Error MaterialResource::createVars()
 		}
 
 		MaterialVariable& in = *m_vars.emplaceBack(getAllocator());
-		in.m_name.create(getAllocator(), o.m_name.getBegin());
+		in.m_name = StringId(o.m_name.getBegin());
 		in.m_index = m_vars.getSize() - 1;
 		in.m_indexInBinary = U32(&o - binary.m_opaques.getBegin());
 		in.m_constant = false;
@@ -614,7 +882,7 @@ Error MaterialResource::createVars()
 	for(const ShaderProgramResourceConstant& c : m_prog->getConstants())
 	{
 		MaterialVariable& in = *m_vars.emplaceBack(getAllocator());
-		in.m_name.create(getAllocator(), c.m_name);
+		in.m_name = StringId(c.m_name);
 		in.m_index = m_vars.getSize() - 1;
 		in.m_constant = true;
 		in.m_instanced = false;
@@ -624,7 +892,10 @@ Error MaterialResource::createVars()
 	return Error::NONE;
 }
 
-Error MaterialResource::parseInputs(XmlElement inputsEl, Bool async)
+Error MaterialResource::parseInputs(XmlElement inputsEl,
+	Bool bindless,
+	DynamicArrayAuto<MaterialDescriptorInput>& inputs,
+	DynamicArrayAuto<char>& strings)
 {
 	// Connect the input variables
 	XmlElement inputEl;
@@ -650,6 +921,10 @@ Error MaterialResource::parseInputs(XmlElement inputsEl, Bool async)
 			return Error::USER_DATA;
 		}
 
+		MaterialDescriptorInput& input = *inputs.emplaceBack();
+		input.m_name = pushBackDescriptorString(varName, strings);
+		input.m_dataType = foundVar->getDataType();
+
 		// A value will be set
 		foundVar->m_mat4(3, 3) = 0.0f;
 
@@ -705,7 +980,7 @@ Error MaterialResource::parseInputs(XmlElement inputsEl, Bool async)
 		{
 			// Not built-in
 
-			if(foundVar->isInstanced())
+			if(foundVar->isInstanced() && !bindless)
 			{
 				ANKI_RESOURCE_LOGE("Only some builtin variables can be instanced: %s", foundVar->getName().cstr());
 				return Error::USER_DATA;
@@ -726,8 +1001,25 @@ Error MaterialResource::parseInputs(XmlElement inputsEl, Bool async)
 				ANKI_CHECK(inputEl.getAttributeNumbers("value", foundVar->m_ivec4));
 				break;
 			case ShaderVariableDataType::UINT:
-				ANKI_CHECK(inputEl.getAttributeNumber("value", foundVar->m_uint));
+			{
+				CString texfname;
+				Bool texPresent;
+				ANKI_CHECK(inputEl.getAttributeTextOptional("texture", texfname, texPresent));
+				if(!texPresent)
+				{
+					ANKI_CHECK(inputEl.getAttributeNumber("value", foundVar->m_uint));
+				}
+				else if(bindless)
+				{
+					input.m_texture = pushBackDescriptorString(texfname, strings);
+				}
+				else
+				{
+					ANKI_RESOURCE_LOGE("Only bindless materials can have bindless textures: %s", varName.cstr());
+					return Error::USER_DATA;
+				}
 				break;
+			}
 			case ShaderVariableDataType::UVEC2:
 				ANKI_CHECK(inputEl.getAttributeNumbers("value", foundVar->m_uvec2));
 				break;
@@ -762,7 +1054,7 @@ Error MaterialResource::parseInputs(XmlElement inputsEl, Bool async)
 			{
 				CString texfname;
 				ANKI_CHECK(inputEl.getAttributeText("value", texfname));
-				ANKI_CHECK(getManager().loadResource(texfname, foundVar->m_tex, async));
+				input.m_texture = pushBackDescriptorString(texfname, strings);
 				break;
 			}
 
@@ -772,6 +1064,9 @@ Error MaterialResource::parseInputs(XmlElement inputsEl, Bool async)
 			}
 		}
 
+		// Keep the value the way the var holds it. The textures are loaded by init()
+		memcpy(&input.m_value[0], &foundVar->m_mat4, sizeof(Mat4));
+
 		// Advance
 		ANKI_CHECK(inputEl.getNextSiblingElement("input", inputEl));
 	}
@@ -779,6 +1074,62 @@ Error MaterialResource::parseInputs(XmlElement inputsEl, Bool async)
 	return Error::NONE;
 }
 
+Error MaterialResource::initBindless()
+{
+	ANKI_ASSERT(m_bindless);
+
+	if(!isInstanced())
+	{
+		ANKI_RESOURCE_LOGE("Bindless materials should be instanced");
+		return Error::USER_DATA;
+	}
+
+	// Materials with the same program, the same mutation and the same constants end up with the same variants
+	U64 hash = m_prog->getUuid();
+	hash = appendHash(&m_shadow, sizeof(m_shadow), hash);
+	hash = appendHash(&m_forwardShading, sizeof(m_forwardShading), hash);
+	for(const SubMutation& m : m_nonBuiltinsMutation)
+	{
+		hash = appendHash(&m.m_value, sizeof(m.m_value), hash);
+	}
+
+	for(const MaterialVariable& var : m_vars)
+	{
+		if(var.isBuildin())
+		{
+			continue;
+		}
+
+		if(var.isTexture())
+		{
+			ANKI_RESOURCE_LOGE("Bindless materials can only have bindless textures: %s", var.getName().cstr());
+			return Error::USER_DATA;
+		}
+
+		if(var.inBlock() && !var.isInstanced())
+		{
+			ANKI_RESOURCE_LOGE("The variables of bindless materials should be per instance: %s", var.getName().cstr());
+			return Error::USER_DATA;
+		}
+
+		if(var.isBindlessTexture() && m_bindlessDescriptorSetIdx == MAX_U8)
+		{
+			ANKI_RESOURCE_LOGE("The program should use the ANKI_BINDLESS_SET for bindless textures: %s",
+				var.getName().cstr());
+			return Error::USER_DATA;
+		}
+
+		if(var.isConstant())
+		{
+			hash = appendHash(&var.m_mat4, sizeof(var.m_mat4), hash);
+		}
+	}
+
+	m_mergeKey = (hash != 0) ? hash : 1;
+
+	return Error::NONE;
+}
+
 const MaterialVariant& MaterialResource::getOrCreateVariant(const RenderingKey& key_) const
 {
 	RenderingKey key = key_;
@@ -794,23 +1145,21 @@ const MaterialVariant& MaterialResource::getOrCreateVariant(const RenderingKey&
 
 	key.setInstanceCount(1 << getInstanceGroupIdx(key.getInstanceCount()));
 
-	MaterialVariant& variant = m_variantMatrix[key.getPass()][key.getLod()][getInstanceGroupIdx(key.getInstanceCount())]
-											  [key.isSkinned()][key.hasVelocity()];
+	const U32 instanceGroup = getInstanceGroupIdx(key.getInstanceCount());
+	MaterialVariant& variant =
+		m_variantMatrix[key.getPass()][key.getLod()][instanceGroup][key.isSkinned()][key.hasVelocity()];
 
-	// Check if it's initialized
+	// Check if it's initialized. The variants don't change after that so no lock is needed
+	if(variant.m_initialized.load(AtomicMemoryOrder::ACQUIRE))
 	{
-		RLockGuard<RWMutex> lock(m_variantMatrixMtx);
-		if(variant.m_prog.isCreated())
-		{
-			return variant;
-		}
+		return variant;
 	}
 
 	// Not initialized, init it
-	WLockGuard<RWMutex> lock(m_variantMatrixMtx);
+	LockGuard<Mutex> lock(m_variantMatrixMtx);
 
 	// Check again
-	if(variant.m_prog.isCreated())
+	if(variant.m_initialized.load())
 	{
 		return variant;
 	}
@@ -891,14 +1240,64 @@ const MaterialVariant& MaterialResource::getOrCreateVariant(const RenderingKey&
 	}
 
 	const ShaderProgramResourceVariant* progVariant;
-	m_prog->getOrCreateVariant(initInfo, progVariant);
+	m_prog->tryGetOrCreateVariant(initInfo, progVariant);
+	if(progVariant == nullptr)
+	{
+		// The program compiles in the background. Draw with a similar variant until it's done
+		const MaterialVariant* fallback = tryFindFallbackVariant(key, instanceGroup);
+		if(fallback)
+		{
+			return *fallback;
+		}
+
+		// Nothing to draw with, have to wait
+		m_prog->getOrCreateVariant(initInfo, progVariant);
+	}
 
 	// Init the variant
 	initVariant(*progVariant, variant, key.getInstanceCount());
+	variant.m_initialized.store(true, AtomicMemoryOrder::RELEASE);
+
+	MaterialVariantCache* cache = getManager().getMaterialVariantCache();
+	if(cache)
+	{
+		cache->addVariant(m_variantCacheKey,
+			getVariantCacheIndex(key.getPass(), key.getLod(), instanceGroup, key.isSkinned(), key.hasVelocity()));
+	}
 
 	return variant;
 }
 
+const MaterialVariant* MaterialResource::tryFindFallbackVariant(const RenderingKey& key, U32 instanceGroup) const
+{
+	// The pass, the skinning and the velocity change the inputs and the outputs of the program so they have to match.
+	// The bigger instance groups have room for less instances so they can replace the smaller
+	const MaterialVariant* fallback = nullptr;
+	U32 fallbackLodDistance = MAX_U32;
+	for(U32 lod = 0; lod < m_lodCount; ++lod)
+	{
+		const U32 lodDistance = U32(absolute(I32(lod) - I32(key.getLod())));
+		if(lodDistance >= fallbackLodDistance)
+		{
+			continue;
+		}
+
+		for(U32 group = instanceGroup; group < MAX_INSTANCE_GROUPS; ++group)
+		{
+			const MaterialVariant& variant =
+				m_variantMatrix[key.getPass()][lod][group][key.isSkinned()][key.hasVelocity()];
+			if(variant.m_initialized.load(AtomicMemoryOrder::ACQUIRE))
+			{
+				fallback = &variant;
+				fallbackLodDistance = lodDistance;
+				break;
+			}
+		}
+	}
+
+	return fallback;
+}
+
 void MaterialResource::initVariant(
 	const ShaderProgramResourceVariant& progVariant, MaterialVariant& variant, U32 instanceCount) const
 {
@@ -998,6 +1397,8 @@ void MaterialResource::initVariant(
 		ANKI_ASSERT(!(var.m_instanced && var.m_indexInBinary2ndElement == MAX_U32));
 	}
 
+	initConstantBlockCopies(variant);
+
 // Debug print
 #if 0
 	ANKI_RESOURCE_LOGI("binary variant idx %u\n", U32(&binaryVariant - binary.m_variants.getBegin()));
@@ -1016,6 +1417,18 @@ void MaterialResource::initVariant(
 #endif
 }
 
+void MaterialResource::requestTextureResidency(F32 screenSize) const
+{
+	const U32 size = getManager().getTextureStreamer().computeRequestedSize(screenSize);
+	for(const MaterialVariable& var : m_vars)
+	{
+		if(var.m_tex.isCreated())
+		{
+			var.m_tex->requestResidency(size);
+		}
+	}
+}
+
 U32 MaterialResource::getInstanceGroupIdx(U32 instanceCount)
 {
 	ANKI_ASSERT(instanceCount > 0);
@@ -1024,4 +1437,69 @@ U32 MaterialResource::getInstanceGroupIdx(U32 instanceCount)
 	return U32(std::log2(F32(instanceCount)));
 }
 
+void MaterialResource::initConstantBlockCopies(MaterialVariant& variant) const
+{
+	// Write the constant variables to a temp block and gather the ranges they cover
+	DynamicArrayAuto<U8> block(getTempAllocator(), variant.m_uniBlockSize, 0);
+	DynamicArrayAuto<MaterialVariant::ConstantBlockCopy> ranges(getTempAllocator());
+	for(const MaterialVariable& var : m_vars)
+	{
+		if(!var.inBlock() || var.isBuildin() || var.m_instanced || !variant.isVariableActive(var))
+		{
+			continue;
+		}
+
+		// All the values of the union start at the same address
+		const ShaderVariableBlockInfo& blockInfo = variant.m_blockInfos[var.m_index];
+		writeShaderBlockMemory(var.m_dataType, blockInfo, &var.m_mat4, 1, block.getBegin(), block.getEnd());
+
+		MaterialVariant::ConstantBlockCopy range;
+		range.m_offset = U32(blockInfo.m_offset);
+		range.m_size = getShaderBlockVariableSize(var.m_dataType, blockInfo);
+		ranges.emplaceBack(range);
+	}
+
+	if(ranges.getSize() == 0)
+	{
+		return;
+	}
+
+	// Merge the ranges. Copy the small gaps between them, the draws write them after the copies if they use them
+	std::sort(ranges.getBegin(),
+		ranges.getEnd(),
+		[](const MaterialVariant::ConstantBlockCopy& a, const MaterialVariant::ConstantBlockCopy& b) {
+			return a.m_offset < b.m_offset;
+		});
+
+	DynamicArrayAuto<MaterialVariant::ConstantBlockCopy> copies(getTempAllocator());
+	copies.emplaceBack(ranges[0]);
+	U32 totalSize = 0;
+	for(U32 i = 1; i < ranges.getSize(); ++i)
+	{
+		MaterialVariant::ConstantBlockCopy& last = copies.getBack();
+		const U32 lastEnd = last.m_offset + last.m_size;
+		if(ranges[i].m_offset <= lastEnd + MAX_CONSTANT_BLOCK_COPY_GAP)
+		{
+			last.m_size = max(lastEnd, ranges[i].m_offset + ranges[i].m_size) - last.m_offset;
+		}
+		else
+		{
+			totalSize += last.m_size;
+			copies.emplaceBack(ranges[i]);
+		}
+	}
+	totalSize += copies.getBack().m_size;
+
+	// Store them
+	variant.m_constantBlockMemory.create(getAllocator(), totalSize);
+	variant.m_constantBlockCopies.create(getAllocator(), copies.getSize());
+	U8* dst = variant.m_constantBlockMemory.getBegin();
+	for(U32 i = 0; i < copies.getSize(); ++i)
+	{
+		variant.m_constantBlockCopies[i] = copies[i];
+		memcpy(dst, &block[copies[i].m_offset], copies[i].m_size);
+		dst += copies[i].m_size;
+	}
+}
+
 } // end namespace anki
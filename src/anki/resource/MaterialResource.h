@@ -11,12 +11,16 @@
 #include <anki/resource/TextureResource.h>
 #include <anki/Math.h>
 #include <anki/util/Enum.h>
+#include <anki/util/StringId.h>
 
 namespace anki
 {
 
 // Forward
 class XmlElement;
+class MaterialDescriptor;
+class MaterialDescriptorMutator;
+class MaterialDescriptorInput;
 
 /// @addtogroup resource
 /// @{
@@ -37,6 +41,7 @@ enum class BuiltinMaterialVariableId : U8
 	CAMERA_ROTATION_MATRIX,
 	CAMERA_POSITION,
 	GLOBAL_SAMPLER,
+	LOD_FADE,
 
 	COUNT,
 	FIRST = 0,
@@ -58,6 +63,20 @@ enum class BuiltinMutatorId : U8
 };
 ANKI_ENUM_ALLOW_NUMERIC_OPERATIONS(BuiltinMutatorId, inline)
 
+/// The storage blocks of the programs that draw with mesh shaders. They hold the meshlets and the vertices of the mesh.
+enum class MeshletStorageBlock : U8
+{
+	MESHLETS,
+	MESHLET_VERTICES,
+	MESHLET_PRIMITIVES,
+	POSITIONS,
+	NORMALS_TANGENTS_UVS, ///< Optional.
+
+	COUNT,
+	FIRST = 0
+};
+ANKI_ENUM_ALLOW_NUMERIC_OPERATIONS(MeshletStorageBlock, inline)
+
 /// Holds the shader variables. It's a container for shader program variables that share the same name.
 class MaterialVariable : public NonCopyable
 {
@@ -76,7 +95,7 @@ public:
 
 	MaterialVariable& operator=(MaterialVariable&& b)
 	{
-		m_name = std::move(b.m_name);
+		m_name = b.m_name;
 		m_index = b.m_index;
 		m_indexInBinary = b.m_indexInBinary;
 		m_indexInBinary2ndElement = b.m_indexInBinary2ndElement;
@@ -114,6 +133,12 @@ public:
 		return m_dataType == ShaderVariableDataType::SAMPLER;
 	}
 
+	/// A U32 that holds the bindless index of a texture. Only bindless materials have them.
+	Bool isBindlessTexture() const
+	{
+		return m_dataType == ShaderVariableDataType::UINT && m_tex.isCreated();
+	}
+
 	Bool inBlock() const
 	{
 		return !m_constant && !isTexture() && !isSampler();
@@ -143,7 +168,7 @@ public:
 protected:
 	static constexpr F32 NO_VALUE = 1234.5678f;
 
-	String m_name;
+	StringId m_name;
 	U32 m_index = MAX_U32;
 	U32 m_indexInBinary = MAX_U32;
 	U32 m_indexInBinary2ndElement = MAX_U32;
@@ -209,7 +234,7 @@ ANKI_SPECIALIZE_GET_VALUE(Mat4, m_mat4, MAT4)
 template<>
 inline const TextureResourcePtr& MaterialVariable::getValue() const
 {
-	ANKI_ASSERT(isTexture());
+	ANKI_ASSERT(isTexture() || isBindlessTexture());
 	ANKI_ASSERT(m_builtin == BuiltinMaterialVariableId::NONE);
 	return m_tex;
 }
@@ -262,12 +287,37 @@ public:
 		anki::writeShaderBlockMemory(var.getDataType(), blockInfo, elements, elementsCount, buffBegin, buffEnd);
 	}
 
+	/// Write the variables that have the same value in all draws. Those are the variables of the uniform block that are
+	/// not builtins and not instanced. They are written in a few copies that are prepared when the variant is created.
+	/// Write it before the rest of the variables because the copies might cover some of them.
+	void writeConstantShaderBlockMemory(void* buffBegin, const void* buffEnd) const
+	{
+		const U8* src = m_constantBlockMemory.getBegin();
+		for(const ConstantBlockCopy& copy : m_constantBlockCopies)
+		{
+			ANKI_ASSERT(static_cast<U8*>(buffBegin) + copy.m_offset + copy.m_size <= buffEnd);
+			memcpy(static_cast<U8*>(buffBegin) + copy.m_offset, src, copy.m_size);
+			src += copy.m_size;
+		}
+	}
+
 private:
+	/// A contiguous range of the uniform block that holds variables that don't change between draws.
+	class ConstantBlockCopy
+	{
+	public:
+		U32 m_offset; ///< Offset in the uniform block.
+		U32 m_size;
+	};
+
 	ShaderProgramPtr m_prog;
 	DynamicArray<ShaderVariableBlockInfo> m_blockInfos;
 	DynamicArray<I16> m_opaqueBindings;
+	DynamicArray<U8> m_constantBlockMemory; ///< The memory of all the m_constantBlockCopies one after the other.
+	DynamicArray<ConstantBlockCopy> m_constantBlockCopies;
 	BitSet<128, U32> m_activeVars = {false};
 	U32 m_uniBlockSize = 0;
+	Atomic<Bool> m_initialized = {false}; ///< Set last so the lookups can skip the lock.
 };
 
 /// Material resource.
@@ -277,6 +327,7 @@ private:
 /// <material
 ///		[shadow="0 | 1"]
 ///		[forwardShading="0 | 1"]
+///		[bindless="0 | 1"] (1)
 ///		<shaderProgram="path"/>
 ///
 ///		[<mutation>
@@ -284,11 +335,18 @@ private:
 ///		</mutation>]
 ///
 ///		[<inputs>
-///			<input shaderVar="name to shaderProg var" value="values"/> (1)
+///			<input shaderVar="name to shaderProg var" value="values"/> (2)
+///			<input shaderVar="name to a U32 per instance var" texture="path"/> (3)
 ///		</inputs>]
 /// </material>
 /// @endcode
-/// (1): Only for non-builtins.
+/// (1): A fully bindless material. All its non-builtin variables are per instance and its textures are bindless so
+///      draws with different bindless materials of the same program can be merged into one instanced draw.
+/// (2): Only for non-builtins.
+/// (3): Only for bindless materials. The variable holds the bindless index of the texture.
+///
+/// The XML is cooked to a MaterialDescriptor the first time it's loaded, see rsrc_cookedDescriptors. The cooked version
+/// is ignored if the variables of the program changed since.
 class MaterialResource : public ResourceObject
 {
 public:
@@ -324,11 +382,27 @@ public:
 		return m_builtinMutators[BuiltinMutatorId::INSTANCE_COUNT] != nullptr;
 	}
 
+	Bool isBindless() const
+	{
+		return m_bindless;
+	}
+
+	/// Bindless materials with the same merge key have the same variants. Zero if the material is not bindless.
+	U64 getMergeKey() const
+	{
+		return m_mergeKey;
+	}
+
 	ConstWeakArray<MaterialVariable> getVariables() const
 	{
 		return m_vars;
 	}
 
+	/// Ask the streamed textures for the mips that show a renderable of that size.
+	/// @param screenSize The diameter of the renderable as a fraction of the screen height.
+	/// @note Thread-safe.
+	void requestTextureResidency(F32 screenSize) const;
+
 	U32 getDescriptorSetIndex() const
 	{
 		ANKI_ASSERT(m_descriptorSetIdx != MAX_U8);
@@ -340,12 +414,34 @@ public:
 		return m_boneTrfsBinding;
 	}
 
+	/// The program draws with task and mesh shaders instead of the vertex shader.
+	Bool usesMeshShaders() const
+	{
+		return !!(m_prog->getStages() & ShaderTypeBit::MESH);
+	}
+
+	/// MAX_U32 if the program doesn't use that block.
+	U32 getMeshletStorageBlockBinding(MeshletStorageBlock block) const
+	{
+		return m_meshletBindings[block];
+	}
+
 	U32 getUniformsBinding() const
 	{
 		ANKI_ASSERT(m_uboBinding != MAX_U32);
 		return m_uboBinding;
 	}
 
+	/// The set of the ANKI_BINDLESS_SET. MAX_U32 if the program doesn't use it.
+	U32 getBindlessDescriptorSetIndex() const
+	{
+		return (m_bindlessDescriptorSetIdx != MAX_U8) ? m_bindlessDescriptorSetIdx : MAX_U32;
+	}
+
+	/// Get a variant. It's created the first time it's asked unless the rsrc_materialVariantCache created it when the
+	/// material loaded. If its program compiles in the background (rsrc_asyncShaderCompilation) it returns another
+	/// variant of the same pass that can draw the same things until the program is ready.
+	/// @note Thread-safe. It doesn't lock if the variant is created.
 	const MaterialVariant& getOrCreateVariant(const RenderingKey& key) const;
 
 private:
@@ -362,15 +458,20 @@ private:
 
 	Bool m_shadow = true;
 	Bool m_forwardShading = false;
+	Bool m_bindless = false;
 	U8 m_lodCount = 1;
 	U8 m_descriptorSetIdx = MAX_U8; ///< The material set.
+	U8 m_bindlessDescriptorSetIdx = MAX_U8;
+	U64 m_mergeKey = 0;
 	U32 m_uboIdx = MAX_U32; ///< The b_ankiMaterial UBO inside the binary.
 	U32 m_uboBinding = MAX_U32;
 	U32 m_boneTrfsBinding = MAX_U32;
+	Array<U32, U32(MeshletStorageBlock::COUNT)> m_meshletBindings = {{MAX_U32, MAX_U32, MAX_U32, MAX_U32, MAX_U32}};
 
 	/// Matrix of variants.
 	mutable Array5d<MaterialVariant, U(Pass::COUNT), MAX_LOD_COUNT, MAX_INSTANCE_GROUPS, 2, 2> m_variantMatrix;
-	mutable RWMutex m_variantMatrixMtx;
+	mutable Mutex m_variantMatrixMtx; ///< Protects the creation of the variants.
+	U64 m_variantCacheKey = 0; ///< The key of the material in the MaterialVariantCache.
 
 	DynamicArray<MaterialVariable> m_vars;
 
@@ -378,24 +479,71 @@ private:
 
 	ANKI_USE_RESULT Error createVars();
 
+	/// Load the program and create the vars. Does nothing if it's already loaded.
+	ANKI_USE_RESULT Error loadProgram(CString fname, Bool async);
+
 	static ANKI_USE_RESULT Error parseVariable(CString fullVarName, Bool& instanced, U32& idx, CString& name);
 
+	ANKI_USE_RESULT Error parseXml(CString text,
+		Bool async,
+		MaterialDescriptor& desc,
+		DynamicArrayAuto<MaterialDescriptorMutator>& mutators,
+		DynamicArrayAuto<MaterialDescriptorInput>& inputs,
+		DynamicArrayAuto<char>& strings);
+
 	/// Parse whatever is inside the <inputs> tag.
-	ANKI_USE_RESULT Error parseInputs(XmlElement inputsEl, Bool async);
+	ANKI_USE_RESULT Error parseInputs(XmlElement inputsEl,
+		Bool bindless,
+		DynamicArrayAuto<MaterialDescriptorInput>& inputs,
+		DynamicArrayAuto<char>& strings);
+
+	ANKI_USE_RESULT Error parseMutators(
+		XmlElement mutatorsEl, DynamicArrayAuto<MaterialDescriptorMutator>& mutators, DynamicArrayAuto<char>& strings);
+
+	/// Check a cooked descriptor that was read from the cache.
+	static Bool validateDescriptor(const MaterialDescriptor& desc);
+
+	/// Check that the inputs of a cooked descriptor have the types the program has now.
+	Bool descriptorMatchesProgram(const MaterialDescriptor& desc) const;
+
+	/// Init using the XML or its cooked version. The program should be loaded.
+	ANKI_USE_RESULT Error init(const MaterialDescriptor& desc, Bool async);
 
-	ANKI_USE_RESULT Error parseMutators(XmlElement mutatorsEl);
 	ANKI_USE_RESULT Error findBuiltinMutators();
+	ANKI_USE_RESULT Error findMeshletStorageBlocks();
+
+	/// Check that the material can be fully bindless and compute the merge key.
+	ANKI_USE_RESULT Error initBindless();
 
 	static U32 getInstanceGroupIdx(U32 instanceCount);
 
+	/// The index of the variant in the MaterialVariantCache::VariantMask.
+	static U32 getVariantCacheIndex(Pass pass, U32 lod, U32 instanceGroup, Bool skinned, Bool velocity)
+	{
+		return (((U32(pass) * MAX_LOD_COUNT + lod) * MAX_INSTANCE_GROUPS + instanceGroup) * 2 + skinned) * 2 + velocity;
+	}
+
+	/// Create the variants that the MaterialVariantCache has for this material.
+	void createCachedVariants() const;
+
 	void initVariant(
 		const ShaderProgramResourceVariant& progVariant, MaterialVariant& variant, U32 instanceCount) const;
 
+	/// Find a variant that can draw instead of a variant whose program compiles in the background.
+	const MaterialVariant* tryFindFallbackVariant(const RenderingKey& key, U32 instanceGroup) const;
+
+	/// Two constant variables that are closer than that in the uniform block are written by the same copy.
+	static constexpr U32 MAX_CONSTANT_BLOCK_COPY_GAP = 64;
+
+	/// Prepare the MaterialVariant::writeConstantShaderBlockMemory() copies.
+	void initConstantBlockCopies(MaterialVariant& variant) const;
+
 	const MaterialVariable* tryFindVariableInternal(CString name) const
 	{
+		const StringId id(name);
 		for(const MaterialVariable& v : m_vars)
 		{
-			if(v.m_name == name)
+			if(v.m_name == id)
 			{
 				return &v;
 			}
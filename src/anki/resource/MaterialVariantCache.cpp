@@ -0,0 +1,121 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/resource/MaterialVariantCache.h>
+#include <anki/util/File.h>
+#include <anki/util/Filesystem.h>
+
+namespace anki
+{
+
+MaterialVariantCache::~MaterialVariantCache()
+{
+	m_materials.destroy(m_alloc);
+	m_filename.destroy(m_alloc);
+}
+
+Error MaterialVariantCache::init(const CString& filename, Bool record)
+{
+	ANKI_ASSERT(!filename.isEmpty());
+	m_filename.create(m_alloc, filename);
+	m_record = record;
+
+	if(!fileExists(filename))
+	{
+		if(!record)
+		{
+			ANKI_RESOURCE_LOGW("The material variant cache is missing: %s", filename.cstr());
+		}
+
+		return Error::NONE;
+	}
+
+	File file;
+	ANKI_CHECK(file.open(filename, FileOpenFlag::READ | FileOpenFlag::BINARY));
+
+	Array<char, 8> magic;
+	U32 materialCount;
+	ANKI_CHECK(file.read(&magic[0], sizeof(magic)));
+	ANKI_CHECK(file.read(&materialCount, sizeof(materialCount)));
+	if(memcmp(&magic[0], MAGIC, sizeof(magic)) != 0
+		|| file.getSize() != sizeof(magic) + sizeof(materialCount) + materialCount * sizeof(Material))
+	{
+		ANKI_RESOURCE_LOGE("Corrupted material variant cache: %s", filename.cstr());
+		return Error::USER_DATA;
+	}
+
+	for(U32 i = 0; i < materialCount; ++i)
+	{
+		Material mtl;
+		ANKI_CHECK(file.read(&mtl, sizeof(mtl)));
+		m_materials.emplace(m_alloc, mtl.m_hash, mtl);
+	}
+
+	ANKI_RESOURCE_LOGI("Loaded the variants of %u materials from %s", materialCount, filename.cstr());
+	return Error::NONE;
+}
+
+MaterialVariantCache::VariantMask MaterialVariantCache::getVariants(U64 materialHash) const
+{
+	LockGuard<Mutex> lock(m_mtx);
+	auto it = m_materials.find(materialHash);
+	return (it != m_materials.getEnd()) ? it->m_variants : VariantMask(false);
+}
+
+void MaterialVariantCache::addVariant(U64 materialHash, U32 variantIdx)
+{
+	ANKI_ASSERT(variantIdx < MAX_VARIANTS);
+	if(!m_record)
+	{
+		return;
+	}
+
+	LockGuard<Mutex> lock(m_mtx);
+	auto it = m_materials.find(materialHash);
+	if(it == m_materials.getEnd())
+	{
+		Material mtl;
+		mtl.m_hash = materialHash;
+		it = m_materials.emplace(m_alloc, materialHash, mtl);
+	}
+
+	if(!it->m_variants.get(variantIdx))
+	{
+		it->m_variants.set(variantIdx);
+		m_dirty = true;
+	}
+}
+
+Error MaterialVariantCache::save()
+{
+	LockGuard<Mutex> lock(m_mtx);
+	if(!m_dirty)
+	{
+		return Error::NONE;
+	}
+
+	File file;
+	ANKI_CHECK(file.open(m_filename.toCString(), FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+
+	U32 materialCount = 0;
+	for(const Material& mtl : m_materials)
+	{
+		(void)mtl;
+		++materialCount;
+	}
+
+	ANKI_CHECK(file.write(MAGIC, 8));
+	ANKI_CHECK(file.write(&materialCount, sizeof(materialCount)));
+	for(const Material& mtl : m_materials)
+	{
+		ANKI_CHECK(file.write(&mtl, sizeof(mtl)));
+	}
+
+	m_dirty = false;
+	ANKI_RESOURCE_LOGI("Wrote the variants of %u materials to %s", materialCount, m_filename.cstr());
+	return Error::NONE;
+}
+
+} // end namespace anki
@@ -0,0 +1,72 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/resource/RenderingKey.h>
+#include <anki/util/HashMap.h>
+#include <anki/util/BitSet.h>
+#include <anki/util/Thread.h>
+
+namespace anki
+{
+
+/// @addtogroup resource
+/// @{
+
+/// The variants that the materials of a level use. The materials create them when they load so the draws don't create
+/// them the first time they need them. The cache is a file that a run of the level writes when it records the variants
+/// that the materials created.
+class MaterialVariantCache : public NonCopyable
+{
+public:
+	/// All the variants of a material. It's the size of the variant matrix of the MaterialResource.
+	static constexpr U32 MAX_VARIANTS = U32(Pass::COUNT) * MAX_LOD_COUNT * MAX_INSTANCE_GROUPS * 2 * 2;
+
+	using VariantMask = BitSet<MAX_VARIANTS, U64>;
+
+	MaterialVariantCache(ResourceAllocator<U8> alloc)
+		: m_alloc(alloc)
+	{
+	}
+
+	~MaterialVariantCache();
+
+	/// @param filename The cache file. If it's not there the cache starts empty.
+	/// @param record Add the variants the materials create and write them to the file with save().
+	ANKI_USE_RESULT Error init(const CString& filename, Bool record);
+
+	/// Get the variants of a material.
+	/// @param materialHash The hash of the filename of the material.
+	/// @note Thread-safe.
+	VariantMask getVariants(U64 materialHash) const;
+
+	/// Add a variant a material created. It does nothing if it doesn't record.
+	/// @note Thread-safe.
+	void addVariant(U64 materialHash, U32 variantIdx);
+
+	/// Write the file if it recorded new variants.
+	ANKI_USE_RESULT Error save();
+
+private:
+	static constexpr const char* MAGIC = "ANKIMVC1";
+
+	class Material
+	{
+	public:
+		U64 m_hash;
+		VariantMask m_variants = {false};
+	};
+
+	ResourceAllocator<U8> m_alloc;
+	String m_filename;
+	HashMap<U64, Material> m_materials;
+	mutable Mutex m_mtx; ///< Protect m_materials.
+	Bool m_record = false;
+	Bool m_dirty = false;
+};
+/// @}
+
+} // end namespace anki
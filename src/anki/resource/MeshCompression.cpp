@@ -0,0 +1,188 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/resource/MeshCompression.h>
+#include <zlib.h>
+
+namespace anki
+{
+
+/// The max bytes of a U32 stored as a variable length integer.
+constexpr U32 MAX_VARINT_SIZE = 5;
+
+static Error deflateData(ConstWeakArray<U8, PtrSize> in, DynamicArrayAuto<U8, PtrSize>& out)
+{
+	uLongf outSize = compressBound(uLong(in.getSize()));
+	out.create(outSize);
+	if(compress2(&out[0], &outSize, &in[0], uLong(in.getSize()), 9) != Z_OK)
+	{
+		ANKI_RESOURCE_LOGE("Failed to compress the mesh data");
+		return Error::FUNCTION_FAILED;
+	}
+
+	out.resize(outSize);
+	return Error::NONE;
+}
+
+/// @param[in,out] outSize The size of out and then the size of the decompressed data.
+static Error inflateData(ConstWeakArray<U8, PtrSize> in, U8* out, PtrSize& outSize)
+{
+	uLongf size = uLongf(outSize);
+	if(in.getSize() == 0 || uncompress(out, &size, &in[0], uLong(in.getSize())) != Z_OK)
+	{
+		ANKI_RESOURCE_LOGE("Failed to decompress the mesh data");
+		return Error::FUNCTION_FAILED;
+	}
+
+	outSize = size;
+	return Error::NONE;
+}
+
+Error compressMeshIndices(
+	ConstWeakArray<U32> indices, GenericMemoryPoolAllocator<U8> alloc, DynamicArrayAuto<U8, PtrSize>& out)
+{
+	ANKI_ASSERT(indices.getSize() > 0);
+
+	DynamicArrayAuto<U8, PtrSize> varints(alloc);
+	varints.create(PtrSize(indices.getSize()) * MAX_VARINT_SIZE);
+	PtrSize size = 0;
+
+	U32 prev = 0;
+	for(U32 idx : indices)
+	{
+		const I32 delta = I32(idx - prev);
+		U32 zigzag = (U32(delta) << 1u) ^ U32(delta >> 31);
+		prev = idx;
+
+		while(zigzag >= 0x80)
+		{
+			varints[size++] = U8(zigzag | 0x80);
+			zigzag >>= 7u;
+		}
+		varints[size++] = U8(zigzag);
+	}
+
+	return deflateData(ConstWeakArray<U8, PtrSize>(&varints[0], size), out);
+}
+
+Error decompressMeshIndices(ConstWeakArray<U8, PtrSize> in,
+	IndexType indexType,
+	U32 indexCount,
+	GenericMemoryPoolAllocator<U8> alloc,
+	void* out)
+{
+	ANKI_ASSERT(indexCount > 0 && out);
+
+	DynamicArrayAuto<U8, PtrSize> varints(alloc);
+	varints.create(PtrSize(indexCount) * MAX_VARINT_SIZE);
+	PtrSize size = varints.getSize();
+	ANKI_CHECK(inflateData(in, &varints[0], size));
+
+	PtrSize offset = 0;
+	U32 prev = 0;
+	for(U32 i = 0; i < indexCount; ++i)
+	{
+		U32 zigzag = 0;
+		U32 shift = 0;
+		U8 byte;
+		do
+		{
+			if(offset >= size || shift > 28)
+			{
+				ANKI_RESOURCE_LOGE("Corrupted mesh indices");
+				return Error::USER_DATA;
+			}
+
+			byte = varints[offset++];
+			zigzag |= U32(byte & 0x7F) << shift;
+			shift += 7;
+		} while(byte & 0x80);
+
+		const U32 idx = prev + ((zigzag >> 1u) ^ (0u - (zigzag & 1u)));
+		prev = idx;
+
+		if(indexType == IndexType::U16)
+		{
+			if(idx > MAX_U16)
+			{
+				ANKI_RESOURCE_LOGE("Corrupted mesh indices");
+				return Error::USER_DATA;
+			}
+
+			static_cast<U16*>(out)[i] = U16(idx);
+		}
+		else
+		{
+			static_cast<U32*>(out)[i] = idx;
+		}
+	}
+
+	if(offset != size)
+	{
+		ANKI_RESOURCE_LOGE("Corrupted mesh indices");
+		return Error::USER_DATA;
+	}
+
+	return Error::NONE;
+}
+
+Error compressMeshVertices(ConstWeakArray<U8, PtrSize> vertices,
+	U32 vertexStride,
+	GenericMemoryPoolAllocator<U8> alloc,
+	DynamicArrayAuto<U8, PtrSize>& out)
+{
+	ANKI_ASSERT(vertexStride > 0 && vertices.getSize() > 0 && (vertices.getSize() % vertexStride) == 0);
+	const PtrSize vertexCount = vertices.getSize() / vertexStride;
+
+	DynamicArrayAuto<U8, PtrSize> streams(alloc);
+	streams.create(vertices.getSize());
+	for(U32 b = 0; b < vertexStride; ++b)
+	{
+		U8* stream = &streams[b * vertexCount];
+		U8 prev = 0;
+		for(PtrSize v = 0; v < vertexCount; ++v)
+		{
+			const U8 byte = vertices[v * vertexStride + b];
+			stream[v] = U8(byte - prev);
+			prev = byte;
+		}
+	}
+
+	return deflateData(ConstWeakArray<U8, PtrSize>(&streams[0], streams.getSize()), out);
+}
+
+Error decompressMeshVertices(ConstWeakArray<U8, PtrSize> in,
+	U32 vertexStride,
+	GenericMemoryPoolAllocator<U8> alloc,
+	WeakArray<U8, PtrSize> out)
+{
+	ANKI_ASSERT(vertexStride > 0 && out.getSize() > 0 && (out.getSize() % vertexStride) == 0);
+	const PtrSize vertexCount = out.getSize() / vertexStride;
+
+	DynamicArrayAuto<U8, PtrSize> streams(alloc);
+	streams.create(out.getSize());
+	PtrSize size = streams.getSize();
+	ANKI_CHECK(inflateData(in, &streams[0], size));
+	if(size != streams.getSize())
+	{
+		ANKI_RESOURCE_LOGE("Corrupted mesh vertices");
+		return Error::USER_DATA;
+	}
+
+	for(U32 b = 0; b < vertexStride; ++b)
+	{
+		const U8* stream = &streams[b * vertexCount];
+		U8 prev = 0;
+		for(PtrSize v = 0; v < vertexCount; ++v)
+		{
+			prev = U8(prev + stream[v]);
+			out[v * vertexStride + b] = prev;
+		}
+	}
+
+	return Error::NONE;
+}
+
+} // end namespace anki
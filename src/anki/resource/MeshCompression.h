@@ -0,0 +1,70 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/resource/Common.h>
+#include <anki/Math.h>
+#include <anki/util/WeakArray.h>
+
+namespace anki
+{
+
+/// @addtogroup resource
+/// @{
+
+/// Map a unit vector to 2 components in [-1, 1] using the octahedral mapping.
+inline Vec2 octahedralEncode(const Vec3& n)
+{
+	const Vec3 p = n / (absolute(n.x()) + absolute(n.y()) + absolute(n.z()));
+	Vec2 out(p.x(), p.y());
+	if(p.z() < 0.0f)
+	{
+		out.x() = (1.0f - absolute(p.y())) * ((p.x() >= 0.0f) ? 1.0f : -1.0f);
+		out.y() = (1.0f - absolute(p.x())) * ((p.y() >= 0.0f) ? 1.0f : -1.0f);
+	}
+
+	return out;
+}
+
+/// The opposite of octahedralEncode.
+inline Vec3 octahedralDecode(const Vec2& e)
+{
+	Vec3 n(e.x(), e.y(), 1.0f - absolute(e.x()) - absolute(e.y()));
+	const F32 t = max(-n.z(), 0.0f);
+	n.x() += (n.x() >= 0.0f) ? -t : t;
+	n.y() += (n.y() >= 0.0f) ? -t : t;
+	return n.getNormalized();
+}
+
+/// Compress the indices of a mesh. The deltas between consecutive indices are small so they are stored as zigzag
+/// variable length integers and then they are deflated.
+ANKI_USE_RESULT Error compressMeshIndices(
+	ConstWeakArray<U32> indices, GenericMemoryPoolAllocator<U8> alloc, DynamicArrayAuto<U8, PtrSize>& out);
+
+/// The opposite of compressMeshIndices.
+/// @param[out] out Where to write the indices. Its size is indexCount times the size of indexType.
+ANKI_USE_RESULT Error decompressMeshIndices(ConstWeakArray<U8, PtrSize> in,
+	IndexType indexType,
+	U32 indexCount,
+	GenericMemoryPoolAllocator<U8> alloc,
+	void* out);
+
+/// Compress a vertex buffer. The bytes of the vertices are split in one stream per byte of the stride, the streams are
+/// delta encoded because neighbour vertices are similar and then everything is deflated.
+ANKI_USE_RESULT Error compressMeshVertices(ConstWeakArray<U8, PtrSize> vertices,
+	U32 vertexStride,
+	GenericMemoryPoolAllocator<U8> alloc,
+	DynamicArrayAuto<U8, PtrSize>& out);
+
+/// The opposite of compressMeshVertices.
+/// @param[out] out Where to write the vertices. Its size is the vertex count times vertexStride.
+ANKI_USE_RESULT Error decompressMeshVertices(ConstWeakArray<U8, PtrSize> in,
+	U32 vertexStride,
+	GenericMemoryPoolAllocator<U8> alloc,
+	WeakArray<U8, PtrSize> out);
+/// @}
+
+} // end namespace anki
@@ -6,10 +6,45 @@
 #include <anki/resource/MeshLoader.h>
 #include <anki/resource/ResourceManager.h>
 #include <anki/resource/ResourceFilesystem.h>
+#include <anki/resource/MeshCompression.h>
 
 namespace anki
 {
 
+static U32 getVertexFormatSize(Format fmt)
+{
+	switch(fmt)
+	{
+	case Format::R32G32B32_SFLOAT:
+		return sizeof(F32) * 3;
+	case Format::R16G16B16A16_SFLOAT:
+	case Format::R16G16B16A16_UINT:
+		return sizeof(U16) * 4;
+	case Format::A2B10G10R10_SNORM_PACK32:
+	case Format::R16G16_UNORM:
+	case Format::R16G16_SFLOAT:
+	case Format::R8G8B8A8_UNORM:
+		return sizeof(U32);
+	default:
+		ANKI_ASSERT(!"Unsupported vertex format");
+		return 0;
+	}
+}
+
+static U32 getVertexEncodingSize(MeshBinaryFile::VertexEncoding encoding, Format fmt)
+{
+	switch(encoding)
+	{
+	case MeshBinaryFile::VertexEncoding::QUANTIZED_POSITION:
+		return sizeof(U16) * 3;
+	case MeshBinaryFile::VertexEncoding::OCTAHEDRAL:
+	case MeshBinaryFile::VertexEncoding::OCTAHEDRAL_SIGNED:
+		return sizeof(I8) * 2;
+	default:
+		return getVertexFormatSize(fmt);
+	}
+}
+
 MeshLoader::MeshLoader(ResourceManager* manager)
 	: MeshLoader(manager, manager->getTempAllocator())
 {
@@ -26,7 +61,17 @@ Error MeshLoader::load(const ResourceFilename& filename)
 
 	// Load header
 	ANKI_CHECK(m_manager->getFilesystem().openFile(filename, m_file));
-	ANKI_CHECK(m_file->read(&m_header, sizeof(m_header)));
+	m_headerSize = offsetof(MeshBinaryFile::Header, m_vertexEncodings);
+	ANKI_CHECK(m_file->read(&m_header, m_headerSize));
+	if(memcmp(&m_header.m_magic[0], MeshBinaryFile::MAGIC_V4, 8) != 0)
+	{
+		ANKI_CHECK(m_file->read(reinterpret_cast<U8*>(&m_header) + m_headerSize, sizeof(m_header) - m_headerSize));
+		m_headerSize = sizeof(m_header);
+	}
+	else
+	{
+		memset(reinterpret_cast<U8*>(&m_header) + m_headerSize, 0, sizeof(m_header) - m_headerSize);
+	}
 	ANKI_CHECK(checkHeader());
 
 	// Read submesh info
@@ -65,6 +110,13 @@ Error MeshLoader::load(const ResourceFilename& filename)
 		}
 	}
 
+	// Read the meshlet counts
+	if(hasMeshlets())
+	{
+		ANKI_CHECK(m_file->read(&m_meshletsHeader, sizeof(m_meshletsHeader)));
+		ANKI_CHECK(checkMeshletsHeader());
+	}
+
 	// Read vert buffer info
 	{
 		U32 vertBufferMask = 0;
@@ -95,14 +147,23 @@ Error MeshLoader::load(const ResourceFilename& filename)
 
 	// Count and check the file size
 	{
-		U32 totalSize = sizeof(m_header);
+		PtrSize totalSize = m_headerSize;
 
 		totalSize += sizeof(MeshBinaryFile::SubMesh) * m_header.m_subMeshCount;
-		totalSize += U32(getIndexBufferSize());
+		totalSize += (isCompressed()) ? m_header.m_compressedIndexBufferSize : getIndexBufferSize();
 
 		for(U i = 0; i < m_header.m_vertexBufferCount; ++i)
 		{
-			totalSize += m_header.m_vertexBuffers[i].m_vertexStride * m_header.m_totalVertexCount;
+			totalSize += (isCompressed()) ? m_header.m_compressedVertexBufferSizes[i]
+										  : m_header.m_vertexBuffers[i].m_vertexStride * m_header.m_totalVertexCount;
+		}
+
+		if(hasMeshlets())
+		{
+			totalSize += sizeof(m_meshletsHeader);
+			totalSize += sizeof(MeshBinaryFile::Meshlet) * m_meshletsHeader.m_meshletCount;
+			totalSize += sizeof(U32) * m_meshletsHeader.m_meshletVertexCount;
+			totalSize += sizeof(U32) * m_meshletsHeader.m_meshletPrimitiveCount;
 		}
 
 		if(totalSize != m_file->getSize())
@@ -154,19 +215,45 @@ Error MeshLoader::checkFormat(VertexAttributeLocation type, ConstWeakArray<Forma
 	return Error::NONE;
 }
 
+Error MeshLoader::checkEncoding(
+	VertexAttributeLocation type, ConstWeakArray<MeshBinaryFile::VertexEncoding> supportedEncodings) const
+{
+	const MeshBinaryFile::VertexEncoding encoding = m_header.m_vertexEncodings[type];
+	if(encoding == MeshBinaryFile::VertexEncoding::NONE)
+	{
+		return Error::NONE;
+	}
+
+	Bool found = false;
+	for(MeshBinaryFile::VertexEncoding e : supportedEncodings)
+	{
+		found = found || e == encoding;
+	}
+
+	if(!found || m_header.m_vertexAttributes[type].m_format == Format::NONE)
+	{
+		ANKI_RESOURCE_LOGE("Vertex attribute %u has unsupported encoding %u", U32(type), U32(encoding));
+		return Error::USER_DATA;
+	}
+
+	return Error::NONE;
+}
+
 Error MeshLoader::checkHeader() const
 {
 	const MeshBinaryFile::Header& h = m_header;
 
 	// Header
-	if(memcmp(&h.m_magic[0], MeshBinaryFile::MAGIC, 8) != 0)
+	const Bool v4 = memcmp(&h.m_magic[0], MeshBinaryFile::MAGIC_V4, 8) == 0;
+	if(memcmp(&h.m_magic[0], MeshBinaryFile::MAGIC, 8) != 0 && !v4)
 	{
 		ANKI_RESOURCE_LOGE("Wrong magic word");
 		return Error::USER_DATA;
 	}
 
 	// Flags
-	if((h.m_flags & ~MeshBinaryFile::Flag::ALL) != MeshBinaryFile::Flag::NONE)
+	if((h.m_flags & ~MeshBinaryFile::Flag::ALL) != MeshBinaryFile::Flag::NONE
+		|| (v4 && !!(h.m_flags & MeshBinaryFile::Flag::COMPRESSED)))
 	{
 		ANKI_RESOURCE_LOGE("Wrong header flags");
 		return Error::USER_DATA;
@@ -184,6 +271,23 @@ Error MeshLoader::checkHeader() const
 	ANKI_CHECK(
 		checkFormat(VertexAttributeLocation::BONE_WEIGHTS, Array<Format, 2>{{Format::NONE, Format::R8G8B8A8_UNORM}}));
 
+	// Encodings
+	if(!!(h.m_flags & MeshBinaryFile::Flag::COMPRESSED))
+	{
+		using VE = MeshBinaryFile::VertexEncoding;
+		ANKI_CHECK(checkEncoding(VertexAttributeLocation::POSITION, Array<VE, 1>{{VE::QUANTIZED_POSITION}}));
+		ANKI_CHECK(checkEncoding(VertexAttributeLocation::NORMAL, Array<VE, 1>{{VE::OCTAHEDRAL}}));
+		ANKI_CHECK(checkEncoding(VertexAttributeLocation::TANGENT, Array<VE, 1>{{VE::OCTAHEDRAL_SIGNED}}));
+		for(VertexAttributeLocation loc = VertexAttributeLocation::FIRST; loc < VertexAttributeLocation::COUNT; ++loc)
+		{
+			if(loc != VertexAttributeLocation::POSITION && loc != VertexAttributeLocation::NORMAL
+				&& loc != VertexAttributeLocation::TANGENT)
+			{
+				ANKI_CHECK(checkEncoding(loc, ConstWeakArray<VE>()));
+			}
+		}
+	}
+
 	// Indices format
 	if(h.m_indexType != IndexType::U16 && h.m_indexType != IndexType::U32)
 	{
@@ -226,13 +330,48 @@ Error MeshLoader::checkHeader() const
 	return Error::NONE;
 }
 
-Error MeshLoader::storeIndexBuffer(void* ptr, PtrSize size)
+Error MeshLoader::checkMeshletsHeader() const
 {
-	ANKI_ASSERT(isLoaded());
-	ANKI_ASSERT(size == getIndexBufferSize());
-	ANKI_ASSERT(m_loadedChunk == 0);
+	const MeshBinaryFile::MeshletsHeader& h = m_meshletsHeader;
+
+	if(!!(m_header.m_flags & MeshBinaryFile::Flag::QUAD))
+	{
+		ANKI_RESOURCE_LOGE("Meshlets need triangles");
+		return Error::USER_DATA;
+	}
+
+	if(h.m_meshletCount == 0 || h.m_meshletVertexCount == 0
+		|| h.m_meshletVertexCount > h.m_meshletCount * MeshBinaryFile::MAX_MESHLET_VERTICES)
+	{
+		ANKI_RESOURCE_LOGE("Wrong meshlet vertex count");
+		return Error::USER_DATA;
+	}
 
-	if(ptr)
+	if(h.m_meshletPrimitiveCount != m_header.m_totalIndexCount / 3)
+	{
+		ANKI_RESOURCE_LOGE("Wrong meshlet primitive count");
+		return Error::USER_DATA;
+	}
+
+	return Error::NONE;
+}
+
+Error MeshLoader::readNextChunk(void* ptr, PtrSize size, FileIoQueue* queue)
+{
+	if(ptr && queue)
+	{
+		ANKI_CHECK(m_file->readAsync(*queue,
+			ptr,
+			size,
+			[](void* userData, Error err) {
+				if(err)
+				{
+					static_cast<MeshLoader*>(userData)->m_asyncReadErr = err;
+				}
+			},
+			this));
+	}
+	else if(ptr)
 	{
 		ANKI_CHECK(m_file->read(ptr, size));
 	}
@@ -245,50 +384,205 @@ Error MeshLoader::storeIndexBuffer(void* ptr, PtrSize size)
 	return Error::NONE;
 }
 
-Error MeshLoader::storeVertexBuffer(U32 bufferIdx, void* ptr, PtrSize size)
+Error MeshLoader::storeIndexBuffer(void* ptr, PtrSize size, FileIoQueue* queue)
+{
+	ANKI_ASSERT(isLoaded());
+	ANKI_ASSERT(size == getIndexBufferSize());
+	ANKI_ASSERT(m_loadedChunk == 0);
+
+	if(!isCompressed())
+	{
+		return readNextChunk(ptr, size, queue);
+	}
+
+	if(!ptr)
+	{
+		return readNextChunk(nullptr, m_header.m_compressedIndexBufferSize, nullptr);
+	}
+
+	DynamicArrayAuto<U8, PtrSize> staging(m_alloc);
+	ConstWeakArray<U8> data;
+	ANKI_CHECK(getNextChunk(m_header.m_compressedIndexBufferSize, staging, data));
+	return decompressMeshIndices(ConstWeakArray<U8, PtrSize>(&data[0], data.getSize()),
+		m_header.m_indexType,
+		m_header.m_totalIndexCount,
+		m_alloc,
+		ptr);
+}
+
+Error MeshLoader::storeVertexBuffer(U32 bufferIdx, void* ptr, PtrSize size, FileIoQueue* queue)
 {
 	ANKI_ASSERT(isLoaded());
 	ANKI_ASSERT(bufferIdx < m_header.m_vertexBufferCount);
 	ANKI_ASSERT(size == m_header.m_vertexBuffers[bufferIdx].m_vertexStride * m_header.m_totalVertexCount);
 	ANKI_ASSERT(m_loadedChunk == bufferIdx + 1);
 
-	if(ptr)
+	if(!isCompressed())
 	{
-		ANKI_CHECK(m_file->read(ptr, size));
+		return readNextChunk(ptr, size, queue);
 	}
-	else
+
+	const U32 compressedSize = m_header.m_compressedVertexBufferSizes[bufferIdx];
+	if(!ptr)
 	{
-		ANKI_CHECK(m_file->seek(size, FileSeekOrigin::CURRENT));
+		return readNextChunk(nullptr, compressedSize, nullptr);
 	}
 
-	++m_loadedChunk;
+	DynamicArrayAuto<U8, PtrSize> staging(m_alloc);
+	ConstWeakArray<U8> data;
+	ANKI_CHECK(getNextChunk(compressedSize, staging, data));
+
+	DynamicArrayAuto<U8, PtrSize> encoded(m_alloc);
+	encoded.create(PtrSize(getEncodedVertexStride(m_header, bufferIdx)) * m_header.m_totalVertexCount);
+	ANKI_CHECK(decompressMeshVertices(ConstWeakArray<U8, PtrSize>(&data[0], data.getSize()),
+		getEncodedVertexStride(m_header, bufferIdx),
+		m_alloc,
+		WeakArray<U8, PtrSize>(&encoded[0], encoded.getSize())));
+
+	decodeVertices(bufferIdx, &encoded[0], static_cast<U8*>(ptr));
 	return Error::NONE;
 }
 
+U32 MeshLoader::getEncodedVertexStride(const MeshBinaryFile::Header& header, U32 bufferIdx)
+{
+	U32 stride = 0;
+	for(VertexAttributeLocation loc = VertexAttributeLocation::FIRST; loc < VertexAttributeLocation::COUNT; ++loc)
+	{
+		const MeshBinaryFile::VertexAttribute& attrib = header.m_vertexAttributes[loc];
+		if(attrib.m_format != Format::NONE && attrib.m_bufferBinding == bufferIdx)
+		{
+			stride += getVertexEncodingSize(header.m_vertexEncodings[loc], attrib.m_format);
+		}
+	}
+
+	return stride;
+}
+
+void MeshLoader::decodeVertices(U32 bufferIdx, const U8* in, U8* out) const
+{
+	const U32 outStride = m_header.m_vertexBuffers[bufferIdx].m_vertexStride;
+	memset(out, 0, PtrSize(outStride) * m_header.m_totalVertexCount);
+
+	const Vec3 aabbSize = m_header.m_aabbMax - m_header.m_aabbMin;
+
+	for(U32 v = 0; v < m_header.m_totalVertexCount; ++v)
+	{
+		U8* vert = out + PtrSize(v) * outStride;
+
+		for(VertexAttributeLocation loc = VertexAttributeLocation::FIRST; loc < VertexAttributeLocation::COUNT; ++loc)
+		{
+			const MeshBinaryFile::VertexAttribute& attrib = m_header.m_vertexAttributes[loc];
+			if(attrib.m_format == Format::NONE || attrib.m_bufferBinding != bufferIdx)
+			{
+				continue;
+			}
+
+			U8* dst = vert + attrib.m_relativeOffset;
+			const MeshBinaryFile::VertexEncoding encoding = m_header.m_vertexEncodings[loc];
+			switch(encoding)
+			{
+			case MeshBinaryFile::VertexEncoding::QUANTIZED_POSITION:
+			{
+				Array<U16, 3> q;
+				memcpy(&q[0], in, sizeof(q));
+				const Vec3 pos = m_header.m_aabbMin + aabbSize * Vec3(F32(q[0]), F32(q[1]), F32(q[2])) / F32(MAX_U16);
+
+				if(attrib.m_format == Format::R32G32B32_SFLOAT)
+				{
+					memcpy(dst, &pos, sizeof(pos));
+				}
+				else
+				{
+					ANKI_ASSERT(attrib.m_format == Format::R16G16B16A16_SFLOAT);
+					const Array<F16, 4> pos16 = {{F16(pos.x()), F16(pos.y()), F16(pos.z()), F16(0.0f)}};
+					memcpy(dst, &pos16[0], sizeof(pos16));
+				}
+				break;
+			}
+			case MeshBinaryFile::VertexEncoding::OCTAHEDRAL:
+			case MeshBinaryFile::VertexEncoding::OCTAHEDRAL_SIGNED:
+			{
+				ANKI_ASSERT(attrib.m_format == Format::A2B10G10R10_SNORM_PACK32);
+				const I8 x = I8(in[0]);
+				const I8 y = I8(in[1]);
+
+				Vec3 n;
+				F32 w = 0.0f;
+				if(encoding == MeshBinaryFile::VertexEncoding::OCTAHEDRAL)
+				{
+					n = octahedralDecode(Vec2(F32(x), F32(y)) / 127.0f);
+				}
+				else
+				{
+					n = octahedralDecode(Vec2(F32(x) / 127.0f, F32(y >> 1) / 63.0f));
+					w = (y & 1) ? -1.0f : 1.0f;
+				}
+
+				const U32 packed = packColorToR10G10B10A2SNorm(n.x(), n.y(), n.z(), w);
+				memcpy(dst, &packed, sizeof(packed));
+				break;
+			}
+			default:
+				memcpy(dst, in, getVertexFormatSize(attrib.m_format));
+			}
+
+			in += getVertexEncodingSize(encoding, attrib.m_format);
+		}
+	}
+}
+
+Error MeshLoader::storeMeshlets(void* meshlets, void* meshletVertices, void* meshletPrimitives, FileIoQueue* queue)
+{
+	ANKI_ASSERT(isLoaded() && hasMeshlets());
+	ANKI_ASSERT(m_loadedChunk == m_header.m_vertexBufferCount + 1);
+
+	ANKI_CHECK(readNextChunk(meshlets, sizeof(MeshBinaryFile::Meshlet) * m_meshletsHeader.m_meshletCount, queue));
+	ANKI_CHECK(readNextChunk(meshletVertices, sizeof(U32) * m_meshletsHeader.m_meshletVertexCount, queue));
+	ANKI_CHECK(readNextChunk(meshletPrimitives, sizeof(U32) * m_meshletsHeader.m_meshletPrimitiveCount, queue));
+
+	return Error::NONE;
+}
+
+Error MeshLoader::waitAsyncReads(FileIoQueue& queue)
+{
+	ANKI_CHECK(queue.waitAll());
+
+	const Error err = m_asyncReadErr;
+	m_asyncReadErr = Error::NONE;
+	return err;
+}
+
 Error MeshLoader::storeIndicesAndPosition(DynamicArrayAuto<U32>& indices, DynamicArrayAuto<Vec3>& positions)
 {
 	// Store indices
 	{
 		indices.resize(m_header.m_totalIndexCount);
 
-		// Create staging buff
-		const PtrSize idxBufferSize = getIndexBufferSize();
+		// Get the data
+		ANKI_ASSERT(m_loadedChunk == 0);
 		DynamicArrayAuto<U8, PtrSize> staging(m_alloc);
-		staging.create(idxBufferSize);
-
-		// Store to staging buff
-		ANKI_CHECK(storeIndexBuffer(&staging[0], staging.getSizeInBytes()));
+		ConstWeakArray<U8> data;
+		if(isCompressed())
+		{
+			staging.create(getIndexBufferSize());
+			ANKI_CHECK(storeIndexBuffer(&staging[0], staging.getSize()));
+			data = ConstWeakArray<U8>(&staging[0], U32(staging.getSize()));
+		}
+		else
+		{
+			ANKI_CHECK(getNextChunk(getIndexBufferSize(), staging, data));
+		}
 
 		// Copy
 		for(U32 i = 0; i < m_header.m_totalIndexCount; ++i)
 		{
 			if(m_header.m_indexType == IndexType::U32)
 			{
-				indices[i] = *reinterpret_cast<U32*>(&staging[i * 4]);
+				indices[i] = *reinterpret_cast<const U32*>(&data[i * 4]);
 			}
 			else
 			{
-				indices[i] = *reinterpret_cast<U16*>(&staging[i * 2]);
+				indices[i] = *reinterpret_cast<const U16*>(&data[i * 2]);
 			}
 		}
 	}
@@ -300,13 +594,21 @@ Error MeshLoader::storeIndicesAndPosition(DynamicArrayAuto<U32>& indices, Dynami
 		const MeshBinaryFile::VertexAttribute& attrib = m_header.m_vertexAttributes[VertexAttributeLocation::POSITION];
 		const MeshBinaryFile::VertexBuffer& buffInfo = m_header.m_vertexBuffers[attrib.m_bufferBinding];
 
-		// Create staging buff
+		// Get the data
+		ANKI_ASSERT(m_loadedChunk == attrib.m_bufferBinding + 1);
 		const PtrSize vertBuffSize = m_header.m_totalVertexCount * buffInfo.m_vertexStride;
 		DynamicArrayAuto<U8, PtrSize> staging(m_alloc);
-		staging.create(vertBuffSize);
-
-		// Store to staging buff
-		ANKI_CHECK(storeVertexBuffer(attrib.m_bufferBinding, &staging[0], staging.getSizeInBytes()));
+		ConstWeakArray<U8> data;
+		if(isCompressed())
+		{
+			staging.create(vertBuffSize);
+			ANKI_CHECK(storeVertexBuffer(attrib.m_bufferBinding, &staging[0], vertBuffSize));
+			data = ConstWeakArray<U8>(&staging[0], U32(vertBuffSize));
+		}
+		else
+		{
+			ANKI_CHECK(getNextChunk(vertBuffSize, staging, data));
+		}
 
 		// Copy
 		for(U32 i = 0; i < m_header.m_totalVertexCount; ++i)
@@ -314,11 +616,12 @@ Error MeshLoader::storeIndicesAndPosition(DynamicArrayAuto<U32>& indices, Dynami
 			Vec3 vert(0.0f);
 			if(attrib.m_format == Format::R32G32B32_SFLOAT)
 			{
-				vert = *reinterpret_cast<Vec3*>(&staging[i * buffInfo.m_vertexStride + attrib.m_relativeOffset]);
+				vert = *reinterpret_cast<const Vec3*>(&data[i * buffInfo.m_vertexStride + attrib.m_relativeOffset]);
 			}
 			else if(attrib.m_format == Format::R16G16B16A16_SFLOAT)
 			{
-				F16* f16 = reinterpret_cast<F16*>(&staging[i * buffInfo.m_vertexStride + attrib.m_relativeOffset]);
+				const F16* f16 =
+					reinterpret_cast<const F16*>(&data[i * buffInfo.m_vertexStride + attrib.m_relativeOffset]);
 
 				vert[0] = f16[0].toF32();
 				vert[1] = f16[1].toF32();
@@ -336,4 +639,21 @@ Error MeshLoader::storeIndicesAndPosition(DynamicArrayAuto<U32>& indices, Dynami
 	return Error::NONE;
 }
 
+Error MeshLoader::getNextChunk(PtrSize size, DynamicArrayAuto<U8, PtrSize>& staging, ConstWeakArray<U8>& data)
+{
+	if(m_file->isMapped())
+	{
+		ANKI_CHECK(m_file->readMapped(size, data));
+	}
+	else
+	{
+		staging.create(size);
+		ANKI_CHECK(m_file->read(&staging[0], size));
+		data = ConstWeakArray<U8>(&staging[0], U32(size));
+	}
+
+	++m_loadedChunk;
+	return Error::NONE;
+}
+
 } // end namespace anki
@@ -21,18 +21,35 @@ namespace anki
 class MeshBinaryFile
 {
 public:
-	static constexpr const char* MAGIC = "ANKIMES4";
+	static constexpr const char* MAGIC = "ANKIMES5";
+	static constexpr const char* MAGIC_V4 = "ANKIMES4"; ///< The previous version. No m_vertexEncodings and after.
+
+	static constexpr U32 MAX_MESHLET_VERTICES = 64;
+	static constexpr U32 MAX_MESHLET_PRIMITIVES = 124;
 
 	enum class Flag : U32
 	{
 		NONE = 0,
 		QUAD = 1 << 0,
 		CONVEX = 1 << 1,
+		MESHLETS = 1 << 2, ///< There is a MeshletsHeader after the sub meshes and the meshlet data after the vertices.
+		COMPRESSED = 1 << 3, ///< The index and vertex buffers are compressed. See Header::m_vertexEncodings.
 
-		ALL = QUAD | CONVEX,
+		ALL = QUAD | CONVEX | MESHLETS | COMPRESSED,
 	};
 	ANKI_ENUM_ALLOW_NUMERIC_OPERATIONS(Flag, friend)
 
+	/// How a vertex attribute is stored in a compressed file. The loader decodes it to the format of the attribute.
+	enum class VertexEncoding : U8
+	{
+		NONE, ///< Stored in the format of the attribute.
+		QUANTIZED_POSITION, ///< 3 x U16 normalized to the bounding box of the mesh.
+		OCTAHEDRAL, ///< 2 x I8 SNORM octahedral mapping. The w is zero.
+		OCTAHEDRAL_SIGNED, ///< Like OCTAHEDRAL but the lowest bit of the 2nd component is the sign of w.
+
+		COUNT
+	};
+
 	struct VertexBuffer
 	{
 		U32 m_vertexStride;
@@ -54,6 +71,28 @@ public:
 		Vec3 m_aabbMax; ///< Bounding box max.
 	};
 
+	/// A small cluster of triangles that the mesh shaders process at once.
+	struct Meshlet
+	{
+		U32 m_firstVertex; ///< Offset in the meshlet vertices.
+		U32 m_vertexCount;
+		U32 m_firstPrimitive; ///< Offset in the meshlet primitives.
+		U32 m_primitiveCount;
+		Vec3 m_sphereCenter; ///< Bounding sphere.
+		F32 m_sphereRadius;
+		Vec3 m_coneAxis; ///< The average direction of the triangles.
+		F32 m_coneCutoff; ///< All triangles face away if dot(normalize(center - eye), axis) >= cutoff.
+	};
+
+	/// The meshlet data follow the vertex buffers: The meshlets, the meshlet vertices (U32 indices to the vertex
+	/// buffers) and the meshlet primitives (3 U8 indices to the meshlet vertices packed in a U32).
+	struct MeshletsHeader
+	{
+		U32 m_meshletCount;
+		U32 m_meshletVertexCount;
+		U32 m_meshletPrimitiveCount;
+	};
+
 	struct Header
 	{
 		char m_magic[8]; ///< Magic word.
@@ -73,6 +112,20 @@ public:
 
 		Vec3 m_aabbMin; ///< Bounding box min.
 		Vec3 m_aabbMax; ///< Bounding box max.
+
+		/// @name Flag::COMPRESSED only
+		/// @{
+
+		/// In a compressed vertex buffer a vertex is its attributes in VertexAttributeLocation order without padding.
+		/// The buffer is compressed with compressMeshVertices.
+		Array<VertexEncoding, U32(VertexAttributeLocation::COUNT)> m_vertexEncodings;
+
+		/// The size of the index buffer in the file. It's compressed with compressMeshIndices.
+		U32 m_compressedIndexBufferSize;
+
+		/// The sizes of the vertex buffers in the file.
+		Array<U32, U32(VertexAttributeLocation::COUNT)> m_compressedVertexBufferSizes;
+		/// @}
 	};
 };
 
@@ -92,9 +145,23 @@ public:
 
 	ANKI_USE_RESULT Error load(const ResourceFilename& filename);
 
-	ANKI_USE_RESULT Error storeIndexBuffer(void* ptr, PtrSize size);
+	/// Read the index buffer.
+	/// @param ptr Where to read. If it's nullptr the index buffer is skipped.
+	/// @param size The size of the index buffer.
+	/// @param queue If it's not nullptr the read is asynchronous and it's done after waitAsyncReads(). The compressed
+	///              files are always read and decoded synchronously.
+	ANKI_USE_RESULT Error storeIndexBuffer(void* ptr, PtrSize size, FileIoQueue* queue = nullptr);
+
+	/// Read a vertex buffer. @see storeIndexBuffer
+	ANKI_USE_RESULT Error storeVertexBuffer(U32 bufferIdx, void* ptr, PtrSize size, FileIoQueue* queue = nullptr);
 
-	ANKI_USE_RESULT Error storeVertexBuffer(U32 bufferIdx, void* ptr, PtrSize size);
+	/// Read the meshlets, the meshlet vertices and the meshlet primitives. Call it after the vertex buffers and only if
+	/// hasMeshlets() is true. @see storeIndexBuffer
+	ANKI_USE_RESULT Error storeMeshlets(
+		void* meshlets, void* meshletVertices, void* meshletPrimitives, FileIoQueue* queue = nullptr);
+
+	/// Wait for the reads of the store methods that were given a FileIoQueue.
+	ANKI_USE_RESULT Error waitAsyncReads(FileIoQueue& queue);
 
 	/// Instead of calling storeIndexBuffer and storeVertexBuffer use this method to get those buffers into the CPU.
 	ANKI_USE_RESULT Error storeIndicesAndPosition(DynamicArrayAuto<U32>& indices, DynamicArrayAuto<Vec3>& positions);
@@ -116,6 +183,28 @@ public:
 		return ConstWeakArray<MeshBinaryFile::SubMesh>(m_subMeshes);
 	}
 
+	Bool hasMeshlets() const
+	{
+		ANKI_ASSERT(isLoaded());
+		return !!(m_header.m_flags & MeshBinaryFile::Flag::MESHLETS);
+	}
+
+	Bool isCompressed() const
+	{
+		ANKI_ASSERT(isLoaded());
+		return !!(m_header.m_flags & MeshBinaryFile::Flag::COMPRESSED);
+	}
+
+	/// The size of a vertex of a compressed vertex buffer after the decompression and before the decoding.
+	static U32 getEncodedVertexStride(const MeshBinaryFile::Header& header, U32 bufferIdx);
+
+	/// Zero counts if there are no meshlets.
+	const MeshBinaryFile::MeshletsHeader& getMeshletsHeader() const
+	{
+		ANKI_ASSERT(isLoaded());
+		return m_meshletsHeader;
+	}
+
 private:
 	ResourceManager* m_manager;
 	GenericMemoryPoolAllocator<U8> m_alloc;
@@ -123,22 +212,40 @@ private:
 	ResourceFilePtr m_file;
 
 	MeshBinaryFile::Header m_header;
+	U32 m_headerSize = 0; ///< The size of the header in the file. The old versions have a smaller header.
 
 	DynamicArray<MeshBinaryFile::SubMesh> m_subMeshes;
 
+	MeshBinaryFile::MeshletsHeader m_meshletsHeader = {};
+
 	U32 m_loadedChunk = 0; ///< Because the store methods need to be called in sequence.
 
+	Error m_asyncReadErr = Error::NONE;
+
 	Bool isLoaded() const
 	{
 		return m_file.get() != nullptr;
 	}
 
+	/// Get the next chunk of the file. If the file is mapped the data point to the file's memory, else they are read to
+	/// the staging buffer.
+	ANKI_USE_RESULT Error getNextChunk(PtrSize size, DynamicArrayAuto<U8, PtrSize>& staging, ConstWeakArray<U8>& data);
+
+	/// Read or skip the next chunk of the file.
+	ANKI_USE_RESULT Error readNextChunk(void* ptr, PtrSize size, FileIoQueue* queue);
+
 	PtrSize getIndexBufferSize() const
 	{
 		return m_header.m_totalIndexCount * ((m_header.m_indexType == IndexType::U16) ? 2 : 4);
 	}
 
+	/// Convert the encoded attributes of a decompressed vertex buffer to their formats.
+	void decodeVertices(U32 bufferIdx, const U8* in, U8* out) const;
+
 	ANKI_USE_RESULT Error checkHeader() const;
+	ANKI_USE_RESULT Error checkEncoding(
+		VertexAttributeLocation type, ConstWeakArray<MeshBinaryFile::VertexEncoding> supportedEncodings) const;
+	ANKI_USE_RESULT Error checkMeshletsHeader() const;
 	ANKI_USE_RESULT Error checkFormat(VertexAttributeLocation type, ConstWeakArray<Format> supportedFormats) const;
 };
 /// @}
@@ -39,7 +39,15 @@ public:
 
 	Error operator()(AsyncLoaderTaskContext& ctx) final
 	{
-		return m_ctx.m_mesh->loadAsync(m_ctx.m_loader);
+		// Spread the uploads over many frames
+		if(m_ctx.m_mesh->getManager().getTransferGpuAllocator().frameBudgetExhausted())
+		{
+			ctx.m_resubmitTask = true;
+			ctx.m_pause = true;
+			return Error::NONE;
+		}
+
+		return m_ctx.m_mesh->loadAsync(m_ctx.m_loader, ctx.m_ioQueue);
 	}
 };
 
@@ -50,8 +58,16 @@ MeshResource::MeshResource(ResourceManager* manager)
 
 MeshResource::~MeshResource()
 {
+	// The task points to this
+	getManager().getAsyncLoader().cancelTasks(this);
+
 	m_subMeshes.destroy(getAllocator());
 	m_vertBufferInfos.destroy(getAllocator());
+
+	if(m_geometry.isValid())
+	{
+		getManager().getGeometryMemoryPool().free(m_geometry);
+	}
 }
 
 Bool MeshResource::isCompatible(const MeshResource& other) const
@@ -69,6 +85,7 @@ Error MeshResource::load(const ResourceFilename& filename, Bool async)
 	if(async)
 	{
 		task = getManager().getAsyncLoader().newTask<LoadTask>(this);
+		task->setOwner(this);
 		ctx = &task->m_ctx;
 	}
 	else
@@ -101,30 +118,53 @@ Error MeshResource::load(const ResourceFilename& filename, Bool async)
 
 	const PtrSize indexBuffSize = m_indexCount * ((m_indexType == IndexType::U32) ? 4 : 2);
 
-	m_indexBuff = getManager().getGrManager().newBuffer(BufferInitInfo(indexBuffSize,
-		BufferUsageBit::INDEX | BufferUsageBit::BUFFER_UPLOAD_DESTINATION | BufferUsageBit::FILL,
-		BufferMapAccessBit::NONE,
-		"MeshIdx"));
+	// The meshlets are useful only if the mesh shaders are there. The mesh shaders read the vertex buffers as storage
+	// buffers so those should be aligned accordingly
+	const GpuDeviceCapabilities& caps = getManager().getGrManager().getDeviceCapabilities();
+	const Bool meshlets = loader.hasMeshlets() && caps.m_meshShaders;
+	const U32 vertBuffAlignment = (meshlets)
+									  ? max<U32>(VERTEX_BUFFER_ALIGNMENT, caps.m_storageBufferBindOffsetAlignment)
+									  : VERTEX_BUFFER_ALIGNMENT;
 
 	// Vertex stuff
 	m_vertCount = header.m_totalVertexCount;
 	m_vertBufferInfos.create(getAllocator(), header.m_vertexBufferCount);
 
-	U32 totalVertexBuffSize = 0;
+	PtrSize totalBuffSize = 0;
 	for(U32 i = 0; i < header.m_vertexBufferCount; ++i)
 	{
-		alignRoundUp(VERTEX_BUFFER_ALIGNMENT, totalVertexBuffSize);
+		alignRoundUp(vertBuffAlignment, totalBuffSize);
 
-		m_vertBufferInfos[i].m_offset = totalVertexBuffSize;
+		m_vertBufferInfos[i].m_offset = U32(totalBuffSize);
 		m_vertBufferInfos[i].m_stride = header.m_vertexBuffers[i].m_vertexStride;
 
-		totalVertexBuffSize += m_vertCount * m_vertBufferInfos[i].m_stride;
+		totalBuffSize += m_vertCount * m_vertBufferInfos[i].m_stride;
 	}
 
-	m_vertBuff = getManager().getGrManager().newBuffer(BufferInitInfo(totalVertexBuffSize,
-		BufferUsageBit::VERTEX | BufferUsageBit::BUFFER_UPLOAD_DESTINATION | BufferUsageBit::FILL,
-		BufferMapAccessBit::NONE,
-		"MeshVert"));
+	// The indices go after the vertices
+	alignRoundUp(VERTEX_BUFFER_ALIGNMENT, totalBuffSize);
+	m_indexBufferOffset = totalBuffSize;
+	totalBuffSize += indexBuffSize;
+
+	// Meshlet stuff
+	if(meshlets)
+	{
+		const MeshBinaryFile::MeshletsHeader& meshletsHeader = loader.getMeshletsHeader();
+		m_meshletCount = meshletsHeader.m_meshletCount;
+
+		m_meshletBufferRanges[MeshletBufferPart::MESHLETS] = sizeof(MeshBinaryFile::Meshlet) * m_meshletCount;
+		m_meshletBufferRanges[MeshletBufferPart::VERTICES] = sizeof(U32) * meshletsHeader.m_meshletVertexCount;
+		m_meshletBufferRanges[MeshletBufferPart::PRIMITIVES] = sizeof(U32) * meshletsHeader.m_meshletPrimitiveCount;
+
+		for(MeshletBufferPart part = MeshletBufferPart(0); part < MeshletBufferPart::COUNT; ++part)
+		{
+			alignRoundUp(caps.m_storageBufferBindOffsetAlignment, totalBuffSize);
+			m_meshletBufferOffsets[part] = totalBuffSize;
+			totalBuffSize += m_meshletBufferRanges[part];
+		}
+	}
+
+	getManager().getGeometryMemoryPool().allocate(totalBuffSize, m_geometry);
 
 	m_texChannelCount = !!header.m_vertexAttributes[VertexAttributeLocation::UV2].m_format ? 2 : 1;
 
@@ -148,16 +188,17 @@ Error MeshResource::load(const ResourceFilename& filename, Bool async)
 	const Vec3 obbExtend = header.m_aabbMax - obbCenter;
 	m_obb = Obb(obbCenter.xyz0(), Mat3x4::getIdentity(), obbExtend.xyz0());
 
-	// Clear the buffers
+	// Clear the geometry. The memory might have been used by another mesh
 	CommandBufferInitInfo cmdbinit;
 	cmdbinit.m_flags = CommandBufferFlag::SMALL_BATCH;
 	CommandBufferPtr cmdb = getManager().getGrManager().newCommandBuffer(cmdbinit);
 
-	cmdb->fillBuffer(m_vertBuff, 0, MAX_PTR_SIZE, 0);
-	cmdb->fillBuffer(m_indexBuff, 0, MAX_PTR_SIZE, 0);
-
-	cmdb->setBufferBarrier(m_vertBuff, BufferUsageBit::FILL, BufferUsageBit::VERTEX, 0, MAX_PTR_SIZE);
-	cmdb->setBufferBarrier(m_indexBuff, BufferUsageBit::FILL, BufferUsageBit::INDEX, 0, MAX_PTR_SIZE);
+	const BufferPtr& buff = m_geometry.getBuffer();
+	cmdb->setBufferBarrier(
+		buff, GeometryMemoryPool::USAGE, BufferUsageBit::FILL, m_geometry.getOffset(), m_geometry.getSize());
+	cmdb->fillBuffer(buff, m_geometry.getOffset(), m_geometry.getSize(), 0);
+	cmdb->setBufferBarrier(
+		buff, BufferUsageBit::FILL, GeometryMemoryPool::USAGE, m_geometry.getOffset(), m_geometry.getSize());
 
 	cmdb->flush();
 
@@ -168,73 +209,74 @@ Error MeshResource::load(const ResourceFilename& filename, Bool async)
 	}
 	else
 	{
-		ANKI_CHECK(loadAsync(loader));
+		ANKI_CHECK(loadAsync(loader, nullptr));
 	}
 
 	return Error::NONE;
 }
 
-Error MeshResource::loadAsync(MeshLoader& loader) const
+Error MeshResource::loadAsync(MeshLoader& loader, FileIoQueue* ioQueue) const
 {
 	GrManager& gr = getManager().getGrManager();
 	TransferGpuAllocator& transferAlloc = getManager().getTransferGpuAllocator();
-	Array<TransferGpuAllocatorHandle, 2> handles;
+	const BufferPtr& buff = m_geometry.getBuffer();
+	const PtrSize offset = m_geometry.getOffset();
+	const PtrSize size = m_geometry.getSize();
 
 	CommandBufferInitInfo cmdbinit;
-	cmdbinit.m_flags = CommandBufferFlag::SMALL_BATCH | CommandBufferFlag::TRANSFER_WORK;
+	cmdbinit.m_flags =
+		CommandBufferFlag::SMALL_BATCH | CommandBufferFlag::TRANSFER_WORK | CommandBufferFlag::ASYNC_TRANSFER_WORK;
 	CommandBufferPtr cmdb = gr.newCommandBuffer(cmdbinit);
 
 	// Set barriers
-	cmdb->setBufferBarrier(
-		m_vertBuff, BufferUsageBit::VERTEX, BufferUsageBit::BUFFER_UPLOAD_DESTINATION, 0, MAX_PTR_SIZE);
-	cmdb->setBufferBarrier(
-		m_indexBuff, BufferUsageBit::INDEX, BufferUsageBit::BUFFER_UPLOAD_DESTINATION, 0, MAX_PTR_SIZE);
+	cmdb->setBufferBarrier(buff, GeometryMemoryPool::USAGE, BufferUsageBit::BUFFER_UPLOAD_DESTINATION, offset, size);
 
-	// Write index buffer
-	{
-		ANKI_CHECK(transferAlloc.allocate(m_indexBuff->getSize(), handles[1]));
-		void* data = handles[1].getMappedMemory();
-		ANKI_ASSERT(data);
+	// Load everything to staging with the same layout
+	TransferGpuAllocatorHandle handle;
+	ANKI_CHECK(transferAlloc.allocate(size, handle));
+	U8* data = static_cast<U8*>(handle.getMappedMemory());
+	ANKI_ASSERT(data);
 
-		ANKI_CHECK(loader.storeIndexBuffer(data, m_indexBuff->getSize()));
+	// Index buffer
+	ANKI_CHECK(loader.storeIndexBuffer(
+		data + m_indexBufferOffset, m_indexCount * ((m_indexType == IndexType::U32) ? 4 : 2), ioQueue));
 
-		cmdb->copyBufferToBuffer(handles[1].getBuffer(), handles[1].getOffset(), m_indexBuff, 0, handles[1].getRange());
+	// Vertex buffers
+	for(U32 i = 0; i < m_vertBufferInfos.getSize(); ++i)
+	{
+		ANKI_CHECK(loader.storeVertexBuffer(
+			i, data + m_vertBufferInfos[i].m_offset, m_vertBufferInfos[i].m_stride * m_vertCount, ioQueue));
 	}
 
-	// Write vert buff
+	// Meshlets
+	if(m_meshletCount)
 	{
-		ANKI_CHECK(transferAlloc.allocate(m_vertBuff->getSize(), handles[0]));
-		U8* data = static_cast<U8*>(handles[0].getMappedMemory());
-		ANKI_ASSERT(data);
-
-		// Load to staging
-		PtrSize offset = 0;
-		for(U32 i = 0; i < m_vertBufferInfos.getSize(); ++i)
-		{
-			alignRoundUp(VERTEX_BUFFER_ALIGNMENT, offset);
-			ANKI_CHECK(loader.storeVertexBuffer(i, data + offset, m_vertBufferInfos[i].m_stride * m_vertCount));
-
-			offset += m_vertBufferInfos[i].m_stride * m_vertCount;
-		}
-
-		ANKI_ASSERT(offset == m_vertBuff->getSize());
+		ANKI_CHECK(loader.storeMeshlets(data + m_meshletBufferOffsets[MeshletBufferPart::MESHLETS],
+			data + m_meshletBufferOffsets[MeshletBufferPart::VERTICES],
+			data + m_meshletBufferOffsets[MeshletBufferPart::PRIMITIVES],
+			ioQueue));
+	}
 
-		// Copy
-		cmdb->copyBufferToBuffer(handles[0].getBuffer(), handles[0].getOffset(), m_vertBuff, 0, handles[0].getRange());
+	// Wait for the reads before the data are used
+	if(ioQueue)
+	{
+		ANKI_CHECK(loader.waitAsyncReads(*ioQueue));
 	}
 
+	cmdb->copyBufferToBuffer(handle.getBuffer(), handle.getOffset(), buff, offset, size);
+
 	// Set barriers
-	cmdb->setBufferBarrier(
-		m_vertBuff, BufferUsageBit::BUFFER_UPLOAD_DESTINATION, BufferUsageBit::VERTEX, 0, MAX_PTR_SIZE);
-	cmdb->setBufferBarrier(
-		m_indexBuff, BufferUsageBit::BUFFER_UPLOAD_DESTINATION, BufferUsageBit::INDEX, 0, MAX_PTR_SIZE);
+	cmdb->setBufferBarrier(buff, BufferUsageBit::BUFFER_UPLOAD_DESTINATION, GeometryMemoryPool::USAGE, offset, size);
 
 	// Finalize
 	FencePtr fence;
 	cmdb->flush(&fence);
 
-	transferAlloc.release(handles[0], fence);
-	transferAlloc.release(handles[1], fence);
+	transferAlloc.release(handle, fence);
+
+	// Publish. isUploaded() will return true once the GPU is done
+	m_uploadFence = fence;
+	m_uploadSubmitted.store(true);
 
 	return Error::NONE;
 }
@@ -6,6 +6,7 @@
 #pragma once
 
 #include <anki/resource/ResourceObject.h>
+#include <anki/resource/GeometryMemoryPool.h>
 #include <anki/Math.h>
 #include <anki/Gr.h>
 #include <anki/collision/Obb.h>
@@ -19,10 +20,24 @@ class MeshLoader;
 /// @addtogroup resource
 /// @{
 
-/// Mesh Resource. It contains the geometry packed in GPU buffers.
+/// Mesh Resource. It contains the geometry packed in a part of a GeometryMemoryPool buffer.
 class MeshResource : public ResourceObject
 {
 public:
+	/// The parts of the buffer with the meshlet data.
+	enum class MeshletBufferPart : U8
+	{
+		MESHLETS, ///< MeshBinaryFile::Meshlet array.
+		VERTICES, ///< Indices to the vertex buffers.
+		PRIMITIVES, ///< 3 U8 indices to the meshlet vertices per primitive.
+
+		COUNT
+	};
+	ANKI_ENUM_ALLOW_NUMERIC_OPERATIONS(MeshletBufferPart, friend)
+
+	/// The alignment of the vertex buffers.
+	static constexpr U32 VERTEX_BUFFER_ALIGNMENT = 64;
+
 	/// Default constructor
 	MeshResource(ResourceManager* manager);
 
@@ -57,12 +72,17 @@ public:
 	/// Get all info around vertex indices.
 	void getIndexBufferInfo(BufferPtr& buff, PtrSize& buffOffset, U32& indexCount, IndexType& indexType) const
 	{
-		buff = m_indexBuff;
-		buffOffset = 0;
+		buff = m_geometry.getBuffer();
+		buffOffset = m_geometry.getOffset() + m_indexBufferOffset;
 		indexCount = m_indexCount;
 		indexType = m_indexType;
 	}
 
+	U32 getVertexCount() const
+	{
+		return m_vertCount;
+	}
+
 	/// Get the number of logical vertex buffers.
 	U32 getVertexBufferCount() const
 	{
@@ -72,8 +92,8 @@ public:
 	/// Get vertex buffer info.
 	void getVertexBufferInfo(const U32 buffIdx, BufferPtr& buff, PtrSize& offset, PtrSize& stride) const
 	{
-		buff = m_vertBuff;
-		offset = m_vertBufferInfos[buffIdx].m_offset;
+		buff = m_geometry.getBuffer();
+		offset = m_geometry.getOffset() + m_vertBufferInfos[buffIdx].m_offset;
 		stride = m_vertBufferInfos[buffIdx].m_stride;
 	}
 
@@ -105,12 +125,44 @@ public:
 		return isVertexAttributePresent(VertexAttributeLocation::BONE_WEIGHTS);
 	}
 
+	/// The number of meshlets. It's zero if the file has no meshlets or if the device has no mesh shaders.
+	U32 getMeshletCount() const
+	{
+		return m_meshletCount;
+	}
+
+	/// Get a part of the meshlet data. The vertex buffers can also be bound as storage buffers if there are meshlets.
+	void getMeshletBufferInfo(MeshletBufferPart part, BufferPtr& buff, PtrSize& offset, PtrSize& range) const
+	{
+		ANKI_ASSERT(m_meshletCount > 0);
+		buff = m_geometry.getBuffer();
+		offset = m_geometry.getOffset() + m_meshletBufferOffsets[part];
+		range = m_meshletBufferRanges[part];
+	}
+
+	/// The geometry finished uploading on the GPU. Before that the buffers are zero.
+	/// @note Thread-safe.
+	Bool isUploaded() const
+	{
+		if(m_uploaded.load())
+		{
+			return true;
+		}
+
+		// The upload runs in the async transfer queue. It's done when its fence is signaled
+		if(m_uploadSubmitted.load() && m_uploadFence->clientWait(0.0))
+		{
+			m_uploaded.store(true);
+			return true;
+		}
+
+		return false;
+	}
+
 protected:
 	class LoadTask;
 	class LoadContext;
 
-	static constexpr U VERTEX_BUFFER_ALIGNMENT = 64;
-
 	/// Sub-mesh data
 	struct SubMesh
 	{
@@ -120,9 +172,12 @@ protected:
 	};
 	DynamicArray<SubMesh> m_subMeshes;
 
+	/// All the buffers of the mesh. The vertex buffers first, then the index buffer and then the meshlet data.
+	GeometryAllocation m_geometry;
+
 	// Index stuff
 	U32 m_indexCount = 0;
-	BufferPtr m_indexBuff;
+	PtrSize m_indexBufferOffset = 0; ///< Offset from the base of m_geometry.
 	IndexType m_indexType = IndexType::COUNT;
 
 	// Vertex stuff
@@ -130,7 +185,7 @@ protected:
 
 	struct VertBuffInfo
 	{
-		U32 m_offset; ///< Offset from the base of m_vertBuff.
+		U32 m_offset; ///< Offset from the base of m_geometry.
 		U32 m_stride;
 	};
 	DynamicArray<VertBuffInfo> m_vertBufferInfos;
@@ -143,13 +198,23 @@ protected:
 	};
 	Array<AttribInfo, U(VertexAttributeLocation::COUNT)> m_attribs;
 
-	BufferPtr m_vertBuff;
 	U8 m_texChannelCount = 0;
 
+	// Meshlet stuff
+	U32 m_meshletCount = 0;
+	Array<PtrSize, U32(MeshletBufferPart::COUNT)> m_meshletBufferOffsets = {}; ///< Offsets from the base of m_geometry.
+	Array<PtrSize, U32(MeshletBufferPart::COUNT)> m_meshletBufferRanges = {};
+
 	// Other
 	Obb m_obb;
-
-	ANKI_USE_RESULT Error loadAsync(MeshLoader& loader) const;
+	mutable FencePtr m_uploadFence; ///< Set by the loading thread before m_uploadSubmitted.
+	mutable Atomic<Bool> m_uploadSubmitted = {false};
+	mutable Atomic<Bool> m_uploaded = {false};
+
+	/// Upload the buffers.
+	/// @param loader The loader.
+	/// @param ioQueue If it's not nullptr all the buffers are read at the same time.
+	ANKI_USE_RESULT Error loadAsync(MeshLoader& loader, FileIoQueue* ioQueue) const;
 };
 /// @}
 
@@ -36,9 +36,7 @@ void ModelPatch::getRenderingDataSub(
 	const Bool hasSkin = m_model->getSkeleton().isCreated();
 
 	// Get the resources
-	RenderingKey meshKey = key;
-	meshKey.setLod(min<U32>(key.getLod(), m_meshCount - 1));
-	const MeshResource& mesh = getMesh(meshKey);
+	const MeshResource& mesh = getMesh(key);
 
 	// Get program
 	{
@@ -53,6 +51,52 @@ void ModelPatch::getRenderingDataSub(
 		inf.m_boneTransformsBinding = m_mtl->getBoneTransformsBinding();
 	}
 
+	// Meshlets. The mesh shaders read the vertices from storage buffers
+	inf.m_meshletCount = 0;
+	if(m_mtl->usesMeshShaders())
+	{
+		ANKI_ASSERT(mesh.getMeshletCount() > 0 && "The material needs a mesh with meshlets");
+		inf.m_meshletCount = mesh.getMeshletCount();
+
+		const Array<MeshResource::MeshletBufferPart, 3> parts = {{MeshResource::MeshletBufferPart::MESHLETS,
+			MeshResource::MeshletBufferPart::VERTICES, MeshResource::MeshletBufferPart::PRIMITIVES}};
+		for(U32 i = 0; i < parts.getSize(); ++i)
+		{
+			StorageBufferBinding& binding = inf.m_meshletStorageBuffers[i];
+			mesh.getMeshletBufferInfo(parts[i], binding.m_buffer, binding.m_offset, binding.m_range);
+		}
+
+		// The first vertex buffer has the positions and the second the normals, tangents and UVs
+		U32 buffIdx;
+		Format fmt;
+		PtrSize relativeOffset;
+		mesh.getVertexAttributeInfo(VertexAttributeLocation::POSITION, buffIdx, fmt, relativeOffset);
+		ANKI_ASSERT(buffIdx == 0 && relativeOffset == 0);
+		inf.m_meshletPositionsF16 = fmt == Format::R16G16B16A16_SFLOAT;
+
+		mesh.getVertexAttributeInfo(VertexAttributeLocation::UV, buffIdx, fmt, relativeOffset);
+		ANKI_ASSERT(buffIdx == 1 && relativeOffset == sizeof(U32) * 2);
+		inf.m_meshletUvsUnorm = fmt == Format::R16G16_UNORM;
+
+		for(U32 i = 0; i < 2; ++i)
+		{
+			StorageBufferBinding& binding = inf.m_meshletStorageBuffers[U32(MeshletStorageBlock::POSITIONS) + i];
+			PtrSize stride;
+			mesh.getVertexBufferInfo(i, binding.m_buffer, binding.m_offset, stride);
+			binding.m_range = stride * mesh.getVertexCount();
+		}
+
+		for(MeshletStorageBlock b = MeshletStorageBlock::FIRST; b < MeshletStorageBlock::COUNT; ++b)
+		{
+			inf.m_meshletStorageBuffers[b].m_binding = m_mtl->getMeshletStorageBlockBinding(b);
+		}
+
+		inf.m_vertexAttributeCount = 0;
+		inf.m_vertexBufferBindingCount = 0;
+		inf.m_drawcallCount = 0;
+		return;
+	}
+
 	// Vertex attributes & bindings
 	{
 		U32 bufferBindingVisitedMask = 0;
@@ -103,11 +147,42 @@ void ModelPatch::getRenderingDataSub(
 	inf.m_indicesCountArray[0] = indexCount;
 }
 
+const MeshResource& ModelPatch::getMesh(const RenderingKey& key) const
+{
+	for(U32 lod = min<U32>(key.getLod(), m_meshCount - 1); lod < m_meshCount - 1u; ++lod)
+	{
+		if(m_meshes[lod].isCreated() && m_meshes[lod]->isUploaded())
+		{
+			return *m_meshes[lod];
+		}
+	}
+
+	return getCoarsestMesh();
+}
+
 U32 ModelPatch::getLodCount() const
 {
 	return max<U32>(m_meshCount, getMaterial()->getLodCount());
 }
 
+U64 ModelPatch::computeMergeKey() const
+{
+	if(!m_mtl->isBindless())
+	{
+		return 0;
+	}
+
+	// Same meshes and a material with the same variants. Use the filenames since the finer LODs come and go
+	U64 hash = m_mtl->getMergeKey();
+	for(U32 i = 0; i < m_meshCount; ++i)
+	{
+		const U64 fnameHash = m_meshFilenames[i].toCString().computeHash();
+		hash = appendHash(&fnameHash, sizeof(fnameHash), hash);
+	}
+
+	return hash;
+}
+
 Error ModelPatch::init(ModelResource* model,
 	ConstWeakArray<CString> meshFNames,
 	const CString& mtlFName,
@@ -120,25 +195,85 @@ Error ModelPatch::init(ModelResource* model,
 	// Load material
 	ANKI_CHECK(manager->loadResource(mtlFName, m_mtl, async));
 
-	// Load meshes
-	m_meshCount = 0;
-	for(U32 i = 0; i < meshFNames.getSize(); i++)
+	m_meshCount = U8(meshFNames.getSize());
+	for(U32 i = 0; i < m_meshCount; ++i)
 	{
+		m_meshFilenames[i].create(model->getAllocator(), meshFNames[i]);
+	}
+
+	// Load meshes, the coarsest first. With LOD streaming the finer are loaded when something asks for them
+	const U32 coarsestLod = m_meshCount - 1u;
+	const U32 finestLod = (manager->getMeshLodStreamingEnabled()) ? coarsestLod : 0;
+	for(U32 j = finestLod; j <= coarsestLod; ++j)
+	{
+		const U32 i = coarsestLod - (j - finestLod);
 		ANKI_CHECK(manager->loadResource(meshFNames[i], m_meshes[i], async));
 
 		// Sanity check
-		if(i > 0 && !m_meshes[i]->isCompatible(*m_meshes[i - 1]))
+		if(!m_meshes[i]->isCompatible(getCoarsestMesh()))
 		{
 			ANKI_RESOURCE_LOGE("Meshes not compatible");
 			return Error::USER_DATA;
 		}
-
-		++m_meshCount;
 	}
 
+	m_wantedLod = U8(finestLod);
 	return Error::NONE;
 }
 
+void ModelPatch::updateLodStreaming(U64 frame, U32& loadBudget)
+{
+	const U32 coarsestLod = m_meshCount - 1u;
+	if(coarsestLod == 0)
+	{
+		return;
+	}
+
+	// Finer LODs are wanted right away, coarser only after a while without requests for the finer. That stops the
+	// meshes from loading and freeing all the time
+	const U32 requestedLod = min(m_requestedLod.exchange(MAX_U32), coarsestLod);
+	if(requestedLod <= m_wantedLod || frame - m_wantedLodFrame > LOD_REQUEST_TIMEOUT_FRAMES)
+	{
+		m_wantedLod = U8(requestedLod);
+		m_wantedLodFrame = frame;
+	}
+
+	// Load the wanted LOD
+	MeshResourcePtr& wanted = m_meshes[m_wantedLod];
+	const Bool failed = !!(m_failedLodMask & (1u << m_wantedLod));
+	if(!wanted.isCreated() && !failed)
+	{
+		if(loadBudget == 0)
+		{
+			return;
+		}
+		--loadBudget;
+
+		ResourceManager& manager = m_model->getManager();
+		if(manager.loadResource(m_meshFilenames[m_wantedLod].toCString(), wanted)
+		   || !wanted->isCompatible(getCoarsestMesh()))
+		{
+			ANKI_RESOURCE_LOGE("Failed to stream LOD %u of model %s. It won't be used",
+				U32(m_wantedLod),
+				m_model->getFilename().cstr());
+			m_failedLodMask |= U8(1u << m_wantedLod);
+			wanted.reset(nullptr);
+		}
+	}
+
+	// Free the other LODs once the wanted one can replace them
+	if(failed || !wanted.isCreated() || wanted->isUploaded())
+	{
+		for(U32 lod = 0; lod < coarsestLod; ++lod)
+		{
+			if(lod != m_wantedLod)
+			{
+				m_meshes[lod].reset(nullptr);
+			}
+		}
+	}
+}
+
 ModelResource::ModelResource(ResourceManager* manager)
 	: ResourceObject(manager)
 {
@@ -147,9 +282,26 @@ ModelResource::ModelResource(ResourceManager* manager)
 ModelResource::~ModelResource()
 {
 	auto alloc = getAllocator();
+
+	for(ModelPatch& patch : m_modelPatches)
+	{
+		for(String& fname : patch.m_meshFilenames)
+		{
+			fname.destroy(alloc);
+		}
+	}
+
 	m_modelPatches.destroy(alloc);
 }
 
+void ModelResource::updateLodStreaming(U64 frame, U32& loadBudget)
+{
+	for(ModelPatch& patch : m_modelPatches)
+	{
+		patch.updateLodStreaming(frame, loadBudget);
+	}
+}
+
 Error ModelResource::load(const ResourceFilename& filename, Bool async)
 {
 	auto alloc = getAllocator();
@@ -195,7 +347,7 @@ Error ModelResource::load(const ResourceFilename& filename, Bool async)
 		XmlElement materialEl;
 		ANKI_CHECK(modelPatchEl.getChildElement("material", materialEl));
 
-		Array<CString, 3> meshesFnames;
+		Array<CString, MAX_LOD_COUNT> meshesFnames;
 		U32 meshesCount = 1;
 
 		// Get mesh
@@ -208,6 +360,9 @@ Error ModelResource::load(const ResourceFilename& filename, Bool async)
 		XmlElement meshEl2;
 		ANKI_CHECK(modelPatchEl.getChildElementOptional("mesh2", meshEl2));
 
+		XmlElement meshEl3;
+		ANKI_CHECK(modelPatchEl.getChildElementOptional("mesh3", meshEl3));
+
 		ANKI_CHECK(meshEl.getText(meshesFnames[0]));
 
 		if(meshEl1)
@@ -222,6 +377,12 @@ Error ModelResource::load(const ResourceFilename& filename, Bool async)
 			ANKI_CHECK(meshEl2.getText(meshesFnames[2]));
 		}
 
+		if(meshEl3)
+		{
+			++meshesCount;
+			ANKI_CHECK(meshEl3.getText(meshesFnames[3]));
+		}
+
 		CString cstr;
 		ANKI_CHECK(materialEl.getText(cstr));
 
@@ -232,6 +393,33 @@ Error ModelResource::load(const ResourceFilename& filename, Bool async)
 		ANKI_CHECK(modelPatchEl.getNextSiblingElement("modelPatch", modelPatchEl));
 	} while(modelPatchEl);
 
+	// <lodScreenSizes>
+	XmlElement lodScreenSizesEl;
+	ANKI_CHECK(rootEl.getChildElementOptional("lodScreenSizes", lodScreenSizesEl));
+	if(lodScreenSizesEl)
+	{
+		DynamicArrayAuto<F32> sizes(alloc);
+		ANKI_CHECK(lodScreenSizesEl.getNumbers(sizes));
+		if(sizes.getSize() == 0 || sizes.getSize() > m_lodScreenSizes.getSize())
+		{
+			ANKI_RESOURCE_LOGE("Wrong number of LOD screen sizes: %u", sizes.getSize());
+			return Error::USER_DATA;
+		}
+
+		for(U32 i = 0; i < sizes.getSize(); ++i)
+		{
+			if(sizes[i] <= 0.0f || sizes[i] > 1.0f || (i > 0 && sizes[i] > sizes[i - 1]))
+			{
+				ANKI_RESOURCE_LOGE("The LOD screen sizes should be in (0, 1] and they shouldn't increase");
+				return Error::USER_DATA;
+			}
+
+			m_lodScreenSizes[i] = sizes[i];
+		}
+
+		m_lodScreenSizeCount = sizes.getSize();
+	}
+
 	// <skeleton>
 	XmlElement skeletonEl;
 	ANKI_CHECK(rootEl.getChildElementOptional("skeleton", skeletonEl));
@@ -243,13 +431,11 @@ Error ModelResource::load(const ResourceFilename& filename, Bool async)
 	}
 
 	// Calculate compound bounding volume
-	RenderingKey key;
-	key.setLod(0);
-	m_visibilityShape = m_modelPatches[0].getMesh(key).getBoundingShape();
+	m_visibilityShape = m_modelPatches[0].getBoundingShape();
 
 	for(auto it = m_modelPatches.getBegin() + 1; it != m_modelPatches.getEnd(); ++it)
 	{
-		m_visibilityShape = m_visibilityShape.getCompoundShape((*it).getMesh(key).getBoundingShape());
+		m_visibilityShape = m_visibilityShape.getCompoundShape((*it).getBoundingShape());
 	}
 
 	return Error::NONE;
@@ -61,6 +61,15 @@ public:
 	}
 };
 
+class StorageBufferBinding
+{
+public:
+	BufferPtr m_buffer;
+	PtrSize m_offset;
+	PtrSize m_range;
+	U32 m_binding; ///< MAX_U32 if the program doesn't need it.
+};
+
 class ModelRenderingInfo
 {
 public:
@@ -80,6 +89,12 @@ public:
 	IndexType m_indexType;
 
 	U32 m_boneTransformsBinding;
+
+	/// Non-zero if the patch draws with task and mesh shaders. The vertex and index buffers are not used then.
+	U32 m_meshletCount;
+	Array<StorageBufferBinding, U32(MeshletStorageBlock::COUNT)> m_meshletStorageBuffers;
+	Bool m_meshletPositionsF16; ///< The positions are RGBA16F instead of RGB32F.
+	Bool m_meshletUvsUnorm; ///< The UVs are RG16 UNORM instead of RG16F.
 };
 
 /// Model patch interface class. Its very important class and it binds the material with the mesh
@@ -93,10 +108,8 @@ public:
 		return m_mtl;
 	}
 
-	const MeshResource& getMesh(const RenderingKey& key) const
-	{
-		return *m_meshes[key.getLod()];
-	}
+	/// Get the mesh of a LOD. If the LOD is not loaded or uploaded yet it returns the finest coarser LOD that is.
+	const MeshResource& getMesh(const RenderingKey& key) const;
 
 	const ModelResource& getModel() const
 	{
@@ -106,41 +119,73 @@ public:
 
 	const Obb& getBoundingShape() const
 	{
-		return m_meshes[0]->getBoundingShape();
+		return getCoarsestMesh().getBoundingShape();
 	}
 
 	const Obb& getBoundingShapeSub(U32 subMeshId) const
 	{
 		U32 firstIdx, idxCount;
 		const Obb* obb;
-		m_meshes[0]->getSubMeshInfo(subMeshId, firstIdx, idxCount, obb);
+		getCoarsestMesh().getSubMeshInfo(subMeshId, firstIdx, idxCount, obb);
 		return *obb;
 	}
 
 	U32 getSubMeshCount() const
 	{
-		return m_meshes[0]->getSubMeshCount();
+		return getCoarsestMesh().getSubMeshCount();
 	}
 
 	/// Get information for multiDraw rendering. Given an array of submeshes that are visible return the correct indices
 	/// offsets and counts.
 	void getRenderingDataSub(const RenderingKey& key, WeakArray<U8> subMeshIndicesArray, ModelRenderingInfo& inf) const;
 
+	/// Return the maximum number of LODs
+	U32 getLodCount() const;
+
+	/// Patches with the same merge key can be drawn with one instanced drawcall. Zero if the patch can't merge with
+	/// the patches of other models. It's non-zero when the material is bindless.
+	U64 computeMergeKey() const;
+
+	/// Ask for the mesh of a LOD. If rsrc_meshLodStreaming is enabled the LODs that are not requested for a while are
+	/// freed and the requested ones are loaded by ResourceManager::updateStreaming().
+	/// @note Thread-safe.
+	void requestLod(U32 lod) const
+	{
+		m_requestedLod.min(lod);
+	}
+
 private:
+	/// Frames without requests for a LOD before it's freed.
+	static constexpr U64 LOD_REQUEST_TIMEOUT_FRAMES = 60;
+
 	ModelResource* m_model ANKI_DEBUG_CODE(= nullptr);
 
-	Array<MeshResourcePtr, MAX_LOD_COUNT> m_meshes; ///< One for each LOD
+	Array<MeshResourcePtr, MAX_LOD_COUNT> m_meshes; ///< One for each LOD. Only the coarsest is always loaded.
+	Array<String, MAX_LOD_COUNT> m_meshFilenames;
 	U8 m_meshCount = 0;
 	MaterialResourcePtr m_mtl;
 
-	/// Return the maximum number of LODs
-	U32 getLodCount() const;
+	// LOD streaming
+	mutable Atomic<U32> m_requestedLod = {MAX_U32};
+	U8 m_wantedLod = 0;
+	U8 m_failedLodMask = 0; ///< The LODs that failed to load. They are not used.
+	U64 m_wantedLodFrame = 0;
+
+	const MeshResource& getCoarsestMesh() const
+	{
+		ANKI_ASSERT(m_meshCount > 0);
+		return *m_meshes[m_meshCount - 1];
+	}
 
 	ANKI_USE_RESULT Error init(ModelResource* model,
 		ConstWeakArray<CString> meshFNames,
 		const CString& mtlFName,
 		Bool async,
 		ResourceManager* resources);
+
+	/// Load the wanted LOD and free the ones that are not needed.
+	/// @param[in,out] loadBudget The meshes that can still start loading in this frame.
+	void updateLodStreaming(U64 frame, U32& loadBudget);
 };
 
 /// Model is an entity that acts as a container for other resources. Models are all the non static objects in a map.
@@ -153,11 +198,13 @@ private:
 /// 			<mesh>path/to/mesh.mesh</mesh>
 ///				[<mesh1>path/to/mesh_lod_1.mesh</mesh1>]
 ///				[<mesh2>path/to/mesh_lod_2.mesh</mesh2>]
+///				[<mesh3>path/to/mesh_lod_3.mesh</mesh3>]
 /// 			<material>path/to/material.mtl</material>
 /// 		</modelPatch>
 /// 		...
 /// 		<modelPatch>...</modelPatch>
 /// 	</modelPatches>
+/// 	[<lodScreenSizes>0.1 0.025 0.006</lodScreenSizes>]
 /// 	[<skeleton>path/to/skeleton.skel</skeleton>]
 /// 	[<skeletonAnimations>
 /// 		<animation>path/to/animation.anim</animation>
@@ -170,6 +217,8 @@ private:
 /// - If the materials need texture coords then mesh should have them
 /// - The skeleton and skelAnims are optional
 /// - Its an error to have skelAnims without skeleton
+/// - The lodScreenSizes are the screen sizes the LODs 1, 2... start at. They override the ones of the scene and they
+///   should decrease
 class ModelResource : public ResourceObject
 {
 public:
@@ -192,13 +241,24 @@ public:
 		return m_skeleton;
 	}
 
+	/// Get the screen sizes of the LODs. Empty if the model uses the ones of the scene.
+	ConstWeakArray<F32> getLodScreenSizes() const
+	{
+		return ConstWeakArray<F32>((m_lodScreenSizeCount) ? &m_lodScreenSizes[0] : nullptr, m_lodScreenSizeCount);
+	}
+
 	ANKI_USE_RESULT Error load(const ResourceFilename& filename, Bool async);
 
+	/// Stream the mesh LODs of the patches. Called by the ResourceManager once per frame when nothing renders.
+	ANKI_INTERNAL void updateLodStreaming(U64 frame, U32& loadBudget);
+
 private:
 	DynamicArray<ModelPatch> m_modelPatches;
 	Obb m_visibilityShape;
 	SkeletonResourcePtr m_skeleton;
 	DynamicArray<AnimationResourcePtr> m_animations;
+	Array<F32, MAX_LOD_COUNT - 1> m_lodScreenSizes = {{}};
+	U32 m_lodScreenSizeCount = 0;
 };
 /// @}
 
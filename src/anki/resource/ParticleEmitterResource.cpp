@@ -80,6 +80,38 @@ Error ParticleEmitterResource::load(const ResourceFilename& filename, Bool async
 		ANKI_CHECK(el.getAttributeNumber("value", m_usePhysicsEngine));
 	}
 
+	ANKI_CHECK(rootEl.getChildElementOptional("collision", el));
+	if(el)
+	{
+		CString response;
+		ANKI_CHECK(el.getAttributeText("response", response));
+		if(response == "bounce")
+		{
+			m_collisionResponse = ParticleCollisionResponse::BOUNCE;
+		}
+		else if(response == "kill")
+		{
+			m_collisionResponse = ParticleCollisionResponse::KILL;
+		}
+		else if(response == "none")
+		{
+			m_collisionResponse = ParticleCollisionResponse::NONE;
+		}
+		else
+		{
+			ANKI_RESOURCE_LOGE("Unknown collision response: %s", response.cstr());
+			return Error::USER_DATA;
+		}
+
+		Bool found;
+		ANKI_CHECK(el.getAttributeNumberOptional("restitution", m_restitution, found));
+		if(m_restitution < 0.0f)
+		{
+			ANKI_RESOURCE_LOGE("The restitution can't be negative");
+			return Error::USER_DATA;
+		}
+	}
+
 	CString cstr;
 	ANKI_CHECK(rootEl.getChildElement("material", el));
 	ANKI_CHECK(el.getAttributeText("value", cstr));
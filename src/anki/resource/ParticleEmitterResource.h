@@ -19,6 +19,14 @@ class XmlElement;
 /// @addtogroup resource
 /// @{
 
+/// What happens to a particle when it hits the static geometry (CPU emitters) or the depth buffer (GPU emitters).
+enum class ParticleCollisionResponse : U8
+{
+	NONE, ///< It goes through.
+	BOUNCE, ///< It's reflected and its velocity is scaled by the restitution.
+	KILL ///< It dies.
+};
+
 /// The particle emitter properties. Different class from ParticleEmitterResource so it can be inherited
 class ParticleEmitterProperties
 {
@@ -78,7 +86,11 @@ public:
 
 	U32 m_particlesPerEmission = 1; ///< How many particles are emitted every emission. Required
 
-	Bool m_usePhysicsEngine = false; ///< Use bullet for the simulation
+	Bool m_usePhysicsEngine = false; ///< Use bullet for the simulation. One rigid body per particle
+
+	/// Collide the particles with ray casts instead of rigid bodies. It takes precedence over m_usePhysicsEngine.
+	ParticleCollisionResponse m_collisionResponse = ParticleCollisionResponse::NONE;
+	F32 m_restitution = 1.0f; ///< How much of the velocity is kept after a bounce.
 	/// @}
 
 	Bool forceEnabled() const
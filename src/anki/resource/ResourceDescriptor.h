@@ -0,0 +1,271 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+// WARNING: This file is auto generated.
+
+#pragma once
+
+#include <anki/resource/ResourceDescriptorExtra.h>
+
+namespace anki
+{
+
+/// A bone of a SkeletonDescriptor.
+class SkeletonDescriptorBone
+{
+public:
+	U32 m_name = MAX_U32; ///< Offset in SkeletonDescriptor::m_strings.
+	U32 m_parent = MAX_U32; ///< Points to SkeletonDescriptor::m_bones. MAX_U32 if it's the root.
+	Array<F32, 16> m_transform = {};
+	Array<F32, 16> m_boneTransform = {};
+
+	template<typename TSerializer, typename TClass>
+	static void serializeCommon(TSerializer& s, TClass self)
+	{
+		s.doValue("m_name", offsetof(SkeletonDescriptorBone, m_name), self.m_name);
+		s.doValue("m_parent", offsetof(SkeletonDescriptorBone, m_parent), self.m_parent);
+		s.doArray("m_transform",
+			offsetof(SkeletonDescriptorBone, m_transform),
+			&self.m_transform[0],
+			self.m_transform.getSize());
+		s.doArray("m_boneTransform",
+			offsetof(SkeletonDescriptorBone, m_boneTransform),
+			&self.m_boneTransform[0],
+			self.m_boneTransform.getSize());
+	}
+
+	template<typename TDeserializer>
+	void deserialize(TDeserializer& deserializer)
+	{
+		serializeCommon<TDeserializer, SkeletonDescriptorBone&>(deserializer, *this);
+	}
+
+	template<typename TSerializer>
+	void serialize(TSerializer& serializer) const
+	{
+		serializeCommon<TSerializer, const SkeletonDescriptorBone&>(serializer, *this);
+	}
+};
+
+/// The cooked version of a skeleton XML.
+class SkeletonDescriptor
+{
+public:
+	Array<U8, 8> m_magic = {};
+	U64 m_sourceHash = 0; ///< The hash of the XML text.
+	WeakArray<SkeletonDescriptorBone> m_bones;
+	WeakArray<char> m_strings; ///< All the strings one after the other. Each one is null terminated.
+
+	template<typename TSerializer, typename TClass>
+	static void serializeCommon(TSerializer& s, TClass self)
+	{
+		s.doArray("m_magic", offsetof(SkeletonDescriptor, m_magic), &self.m_magic[0], self.m_magic.getSize());
+		s.doValue("m_sourceHash", offsetof(SkeletonDescriptor, m_sourceHash), self.m_sourceHash);
+		s.doValue("m_bones", offsetof(SkeletonDescriptor, m_bones), self.m_bones);
+		s.doValue("m_strings", offsetof(SkeletonDescriptor, m_strings), self.m_strings);
+	}
+
+	template<typename TDeserializer>
+	void deserialize(TDeserializer& deserializer)
+	{
+		serializeCommon<TDeserializer, SkeletonDescriptor&>(deserializer, *this);
+	}
+
+	template<typename TSerializer>
+	void serialize(TSerializer& serializer) const
+	{
+		serializeCommon<TSerializer, const SkeletonDescriptor&>(serializer, *this);
+	}
+};
+
+/// A keyframe of an AnimationDescriptorChannel.
+class AnimationDescriptorKey
+{
+public:
+	F64 m_time = 0.0;
+	Array<F32, 4> m_value = {}; ///< The position, the rotation or the scale.
+
+	template<typename TSerializer, typename TClass>
+	static void serializeCommon(TSerializer& s, TClass self)
+	{
+		s.doValue("m_time", offsetof(AnimationDescriptorKey, m_time), self.m_time);
+		s.doArray("m_value", offsetof(AnimationDescriptorKey, m_value), &self.m_value[0], self.m_value.getSize());
+	}
+
+	template<typename TDeserializer>
+	void deserialize(TDeserializer& deserializer)
+	{
+		serializeCommon<TDeserializer, AnimationDescriptorKey&>(deserializer, *this);
+	}
+
+	template<typename TSerializer>
+	void serialize(TSerializer& serializer) const
+	{
+		serializeCommon<TSerializer, const AnimationDescriptorKey&>(serializer, *this);
+	}
+};
+
+/// A channel of an AnimationDescriptor.
+class AnimationDescriptorChannel
+{
+public:
+	U32 m_name = MAX_U32; ///< Offset in AnimationDescriptor::m_strings.
+	WeakArray<AnimationDescriptorKey> m_positionKeys;
+	WeakArray<AnimationDescriptorKey> m_rotationKeys;
+	WeakArray<AnimationDescriptorKey> m_scaleKeys;
+
+	template<typename TSerializer, typename TClass>
+	static void serializeCommon(TSerializer& s, TClass self)
+	{
+		s.doValue("m_name", offsetof(AnimationDescriptorChannel, m_name), self.m_name);
+		s.doValue("m_positionKeys", offsetof(AnimationDescriptorChannel, m_positionKeys), self.m_positionKeys);
+		s.doValue("m_rotationKeys", offsetof(AnimationDescriptorChannel, m_rotationKeys), self.m_rotationKeys);
+		s.doValue("m_scaleKeys", offsetof(AnimationDescriptorChannel, m_scaleKeys), self.m_scaleKeys);
+	}
+
+	template<typename TDeserializer>
+	void deserialize(TDeserializer& deserializer)
+	{
+		serializeCommon<TDeserializer, AnimationDescriptorChannel&>(deserializer, *this);
+	}
+
+	template<typename TSerializer>
+	void serialize(TSerializer& serializer) const
+	{
+		serializeCommon<TSerializer, const AnimationDescriptorChannel&>(serializer, *this);
+	}
+};
+
+/// The cooked version of an animation XML.
+class AnimationDescriptor
+{
+public:
+	Array<U8, 8> m_magic = {};
+	U64 m_sourceHash = 0; ///< The hash of the XML text.
+	WeakArray<AnimationDescriptorChannel> m_channels;
+	WeakArray<char> m_strings; ///< All the strings one after the other. Each one is null terminated.
+
+	template<typename TSerializer, typename TClass>
+	static void serializeCommon(TSerializer& s, TClass self)
+	{
+		s.doArray("m_magic", offsetof(AnimationDescriptor, m_magic), &self.m_magic[0], self.m_magic.getSize());
+		s.doValue("m_sourceHash", offsetof(AnimationDescriptor, m_sourceHash), self.m_sourceHash);
+		s.doValue("m_channels", offsetof(AnimationDescriptor, m_channels), self.m_channels);
+		s.doValue("m_strings", offsetof(AnimationDescriptor, m_strings), self.m_strings);
+	}
+
+	template<typename TDeserializer>
+	void deserialize(TDeserializer& deserializer)
+	{
+		serializeCommon<TDeserializer, AnimationDescriptor&>(deserializer, *this);
+	}
+
+	template<typename TSerializer>
+	void serialize(TSerializer& serializer) const
+	{
+		serializeCommon<TSerializer, const AnimationDescriptor&>(serializer, *this);
+	}
+};
+
+/// A mutator of a MaterialDescriptor.
+class MaterialDescriptorMutator
+{
+public:
+	U32 m_name = MAX_U32; ///< Offset in MaterialDescriptor::m_strings.
+	I32 m_value = 0;
+
+	template<typename TSerializer, typename TClass>
+	static void serializeCommon(TSerializer& s, TClass self)
+	{
+		s.doValue("m_name", offsetof(MaterialDescriptorMutator, m_name), self.m_name);
+		s.doValue("m_value", offsetof(MaterialDescriptorMutator, m_value), self.m_value);
+	}
+
+	template<typename TDeserializer>
+	void deserialize(TDeserializer& deserializer)
+	{
+		serializeCommon<TDeserializer, MaterialDescriptorMutator&>(deserializer, *this);
+	}
+
+	template<typename TSerializer>
+	void serialize(TSerializer& serializer) const
+	{
+		serializeCommon<TSerializer, const MaterialDescriptorMutator&>(serializer, *this);
+	}
+};
+
+/// An input of a MaterialDescriptor.
+class MaterialDescriptorInput
+{
+public:
+	U32 m_name = MAX_U32; ///< Offset in MaterialDescriptor::m_strings.
+	U32 m_texture = MAX_U32; ///< Offset in MaterialDescriptor::m_strings. MAX_U32 if it's not a texture.
+	ShaderVariableDataType m_dataType = ShaderVariableDataType::NONE; ///< The type of the variable when it was cooked.
+	Array<U32, 16> m_value = {}; ///< The bits of the value as the MaterialVariable holds them.
+
+	template<typename TSerializer, typename TClass>
+	static void serializeCommon(TSerializer& s, TClass self)
+	{
+		s.doValue("m_name", offsetof(MaterialDescriptorInput, m_name), self.m_name);
+		s.doValue("m_texture", offsetof(MaterialDescriptorInput, m_texture), self.m_texture);
+		s.doValue("m_dataType", offsetof(MaterialDescriptorInput, m_dataType), self.m_dataType);
+		s.doArray("m_value", offsetof(MaterialDescriptorInput, m_value), &self.m_value[0], self.m_value.getSize());
+	}
+
+	template<typename TDeserializer>
+	void deserialize(TDeserializer& deserializer)
+	{
+		serializeCommon<TDeserializer, MaterialDescriptorInput&>(deserializer, *this);
+	}
+
+	template<typename TSerializer>
+	void serialize(TSerializer& serializer) const
+	{
+		serializeCommon<TSerializer, const MaterialDescriptorInput&>(serializer, *this);
+	}
+};
+
+/// The cooked version of a material XML.
+class MaterialDescriptor
+{
+public:
+	Array<U8, 8> m_magic = {};
+	U64 m_sourceHash = 0; ///< The hash of the XML text.
+	U32 m_shaderProgram = MAX_U32; ///< Offset in MaterialDescriptor::m_strings.
+	U8 m_shadow = 1;
+	U8 m_forwardShading = 0;
+	U8 m_bindless = 0;
+	WeakArray<MaterialDescriptorMutator> m_mutators;
+	WeakArray<MaterialDescriptorInput> m_inputs;
+	WeakArray<char> m_strings; ///< All the strings one after the other. Each one is null terminated.
+
+	template<typename TSerializer, typename TClass>
+	static void serializeCommon(TSerializer& s, TClass self)
+	{
+		s.doArray("m_magic", offsetof(MaterialDescriptor, m_magic), &self.m_magic[0], self.m_magic.getSize());
+		s.doValue("m_sourceHash", offsetof(MaterialDescriptor, m_sourceHash), self.m_sourceHash);
+		s.doValue("m_shaderProgram", offsetof(MaterialDescriptor, m_shaderProgram), self.m_shaderProgram);
+		s.doValue("m_shadow", offsetof(MaterialDescriptor, m_shadow), self.m_shadow);
+		s.doValue("m_forwardShading", offsetof(MaterialDescriptor, m_forwardShading), self.m_forwardShading);
+		s.doValue("m_bindless", offsetof(MaterialDescriptor, m_bindless), self.m_bindless);
+		s.doValue("m_mutators", offsetof(MaterialDescriptor, m_mutators), self.m_mutators);
+		s.doValue("m_inputs", offsetof(MaterialDescriptor, m_inputs), self.m_inputs);
+		s.doValue("m_strings", offsetof(MaterialDescriptor, m_strings), self.m_strings);
+	}
+
+	template<typename TDeserializer>
+	void deserialize(TDeserializer& deserializer)
+	{
+		serializeCommon<TDeserializer, MaterialDescriptor&>(deserializer, *this);
+	}
+
+	template<typename TSerializer>
+	void serialize(TSerializer& serializer) const
+	{
+		serializeCommon<TSerializer, const MaterialDescriptor&>(serializer, *this);
+	}
+};
+
+} // end namespace anki
@@ -0,0 +1,75 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/resource/Common.h>
+#include <anki/util/Serializer.h>
+
+namespace anki
+{
+
+/// @addtogroup resource
+/// @{
+
+/// The cooked descriptors are binary versions of the XML files of some resources. They are written in the cache
+/// directory the first time the XML is parsed and the next loads read them instead. They are rewritten when the XML
+/// changes. Bump the magic of a descriptor when its layout changes.
+constexpr const char* SKELETON_DESCRIPTOR_MAGIC = "ANKISKL1";
+constexpr const char* ANIMATION_DESCRIPTOR_MAGIC = "ANKIANM1";
+constexpr const char* MATERIAL_DESCRIPTOR_MAGIC = "ANKIMTL1";
+
+/// Append a string to the strings of a descriptor.
+/// @return The offset of the string.
+inline U32 pushBackDescriptorString(CString str, DynamicArrayAuto<char>& strings)
+{
+	const U32 offset = strings.getSize();
+	const U32 len = (str.isEmpty()) ? 0 : str.getLength();
+	strings.resize(offset + len + 1);
+	if(len > 0)
+	{
+		memcpy(&strings[offset], str.cstr(), len);
+	}
+	strings[offset + len] = '\0';
+	return offset;
+}
+
+/// Get a string of a descriptor.
+inline CString getDescriptorString(ConstWeakArray<char> strings, U32 offset)
+{
+	ANKI_ASSERT(offset < strings.getSize());
+	return CString(&strings[offset]);
+}
+
+/// Check a string offset of a descriptor that was read from a file.
+inline Bool isValidDescriptorString(ConstWeakArray<char> strings, U32 offset)
+{
+	return offset < strings.getSize() && strings[strings.getSize() - 1] == '\0';
+}
+
+/// Holds the contents of a cooked descriptor file.
+class CookedDescriptorData : public NonCopyable
+{
+public:
+	GenericMemoryPoolAllocator<U8> m_alloc;
+	U8* m_data = nullptr;
+	PtrSize m_size = 0;
+
+	CookedDescriptorData(GenericMemoryPoolAllocator<U8> alloc)
+		: m_alloc(alloc)
+	{
+	}
+
+	~CookedDescriptorData()
+	{
+		if(m_data)
+		{
+			m_alloc.getMemoryPool().free(m_data);
+		}
+	}
+};
+/// @}
+
+} // end namespace anki
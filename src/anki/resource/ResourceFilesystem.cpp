@@ -4,14 +4,31 @@
 // http://www.anki3d.org/LICENSE
 
 #include <anki/resource/ResourceFilesystem.h>
+#include <anki/resource/ResourcePack.h>
 #include <anki/util/Filesystem.h>
 #include <anki/core/ConfigSet.h>
 #include <anki/util/Tracer.h>
+#include <anki/util/HighRezTimer.h>
 #include <contrib/minizip/unzip.h>
 
 namespace anki
 {
 
+/// The time the thread spent in file I/O.
+static thread_local Second g_threadIoTime = 0.0;
+
+/// Adds the time of a scope to g_threadIoTime.
+class IoTimer
+{
+public:
+	Second m_begin = HighRezTimer::getCurrentTime();
+
+	~IoTimer()
+	{
+		g_threadIoTime += HighRezTimer::getCurrentTime() - m_begin;
+	}
+};
+
 /// C resource file
 class CResourceFile final : public ResourceFile
 {
@@ -26,24 +43,28 @@ public:
 	ANKI_USE_RESULT Error read(void* buff, PtrSize size) override
 	{
 		ANKI_TRACE_SCOPED_EVENT(RSRC_FILE_READ);
+		const IoTimer ioTimer;
 		return m_file.read(buff, size);
 	}
 
 	ANKI_USE_RESULT Error readAllText(StringAuto& out) override
 	{
 		ANKI_TRACE_SCOPED_EVENT(RSRC_FILE_READ);
+		const IoTimer ioTimer;
 		return m_file.readAllText(out);
 	}
 
 	ANKI_USE_RESULT Error readU32(U32& u) override
 	{
 		ANKI_TRACE_SCOPED_EVENT(RSRC_FILE_READ);
+		const IoTimer ioTimer;
 		return m_file.readU32(u);
 	}
 
 	ANKI_USE_RESULT Error readF32(F32& f) override
 	{
 		ANKI_TRACE_SCOPED_EVENT(RSRC_FILE_READ);
+		const IoTimer ioTimer;
 		return m_file.readF32(f);
 	}
 
@@ -56,6 +77,24 @@ public:
 	{
 		return m_file.getSize();
 	}
+
+	Bool isMapped() const override
+	{
+		return m_file.isMapped();
+	}
+
+	ANKI_USE_RESULT Error readMapped(PtrSize size, ConstWeakArray<U8>& view) override
+	{
+		ANKI_CHECK(m_file.getMappedRange(m_file.tell(), size, view));
+		return m_file.seek(size, FileSeekOrigin::CURRENT);
+	}
+
+	ANKI_USE_RESULT Error readAsync(
+		FileIoQueue& queue, void* buff, PtrSize size, FileReadAsyncCallback callback, void* userData) override
+	{
+		ANKI_CHECK(m_file.readAsync(queue, m_file.tell(), buff, size, callback, userData));
+		return m_file.seek(size, FileSeekOrigin::CURRENT);
+	}
 };
 
 /// ZIP file
@@ -129,6 +168,7 @@ public:
 	ANKI_USE_RESULT Error read(void* buff, PtrSize size) override
 	{
 		ANKI_TRACE_SCOPED_EVENT(RSRC_FILE_READ);
+		const IoTimer ioTimer;
 
 		I64 readSize = unzReadCurrentFile(m_archive, buff, U32(size));
 
@@ -193,12 +233,236 @@ public:
 	}
 };
 
+/// A file in a resource pack.
+class PackResourceFile final : public ResourceFile
+{
+public:
+	const ResourcePack* m_pack = nullptr;
+	const ResourcePackFileInfo* m_info = nullptr;
+	File m_file; ///< The pack.
+	PtrSize m_pos = 0;
+
+	// The chunks of compressed files are decompressed one at a time
+	DynamicArray<U8, PtrSize> m_chunk;
+	DynamicArray<U8, PtrSize> m_compressedChunk;
+	U32 m_chunkIdx = MAX_U32; ///< Relative to the first chunk of the file.
+
+	PackResourceFile(GenericMemoryPoolAllocator<U8> alloc)
+		: ResourceFile(alloc)
+	{
+	}
+
+	~PackResourceFile()
+	{
+		m_chunk.destroy(getAllocator());
+		m_compressedChunk.destroy(getAllocator());
+	}
+
+	ANKI_USE_RESULT Error open(const ResourcePack& pack, const ResourcePackFileInfo& info)
+	{
+		m_pack = &pack;
+		m_info = &info;
+
+		// Map the pack if the file is stored uncompressed, the reads will copy straight from it
+		FileOpenFlag flags = FileOpenFlag::READ | FileOpenFlag::BINARY;
+		if(isCompressed())
+		{
+			m_chunk.create(getAllocator(), pack.getChunkSize());
+		}
+		else
+		{
+			flags |= FileOpenFlag::MMAP | FileOpenFlag::ASYNC;
+		}
+
+		return m_file.open(pack.getPath(), flags);
+	}
+
+	Bool isCompressed() const
+	{
+		return m_info->m_compression != ResourcePackCompression::NONE;
+	}
+
+	ANKI_USE_RESULT Error read(void* buff, PtrSize size) override
+	{
+		ANKI_TRACE_SCOPED_EVENT(RSRC_FILE_READ);
+		const IoTimer ioTimer;
+
+		if(m_pos + size > m_info->m_size)
+		{
+			ANKI_RESOURCE_LOGE("Reading past the end of the file");
+			return Error::FILE_ACCESS;
+		}
+
+		if(!isCompressed())
+		{
+			ANKI_CHECK(m_file.seek(m_info->m_offset + m_pos, FileSeekOrigin::BEGINNING));
+			ANKI_CHECK(m_file.read(buff, size));
+			m_pos += size;
+			return Error::NONE;
+		}
+
+		U8* out = static_cast<U8*>(buff);
+		while(size > 0)
+		{
+			const U32 chunkIdx = U32(m_pos / m_pack->getChunkSize());
+			ANKI_CHECK(loadChunk(chunkIdx));
+
+			const PtrSize chunkOffset = m_pos - PtrSize(chunkIdx) * m_pack->getChunkSize();
+			const PtrSize toCopy = min(size, getChunkUncompressedSize(chunkIdx) - chunkOffset);
+			memcpy(out, &m_chunk[chunkOffset], toCopy);
+
+			out += toCopy;
+			size -= toCopy;
+			m_pos += toCopy;
+		}
+
+		return Error::NONE;
+	}
+
+	ANKI_USE_RESULT Error readAllText(StringAuto& out) override
+	{
+		const PtrSize size = m_info->m_size - m_pos;
+		if(size == 0)
+		{
+			ANKI_RESOURCE_LOGE("The file is empty or rewind it");
+			return Error::FILE_ACCESS;
+		}
+
+		out.create('?', size);
+		return read(&out[0], size);
+	}
+
+	ANKI_USE_RESULT Error readU32(U32& u) override
+	{
+		// Assume machine and file have same endianness
+		return read(&u, sizeof(u));
+	}
+
+	ANKI_USE_RESULT Error readF32(F32& f) override
+	{
+		// Assume machine and file have same endianness
+		return read(&f, sizeof(f));
+	}
+
+	ANKI_USE_RESULT Error seek(PtrSize offset, FileSeekOrigin origin) override
+	{
+		PtrSize pos;
+		switch(origin)
+		{
+		case FileSeekOrigin::BEGINNING:
+			pos = offset;
+			break;
+		case FileSeekOrigin::CURRENT:
+			pos = m_pos + offset;
+			break;
+		default:
+			ANKI_ASSERT(origin == FileSeekOrigin::END);
+			pos = m_info->m_size + offset;
+		}
+
+		if(pos > m_info->m_size)
+		{
+			ANKI_RESOURCE_LOGE("Seeking past the end of the file");
+			return Error::FILE_ACCESS;
+		}
+
+		m_pos = pos;
+		return Error::NONE;
+	}
+
+	PtrSize getSize() const override
+	{
+		return m_info->m_size;
+	}
+
+	Bool isMapped() const override
+	{
+		return !isCompressed() && m_file.isMapped();
+	}
+
+	ANKI_USE_RESULT Error readMapped(PtrSize size, ConstWeakArray<U8>& view) override
+	{
+		ANKI_ASSERT(isMapped());
+		if(m_pos + size > m_info->m_size)
+		{
+			ANKI_RESOURCE_LOGE("Reading past the end of the file");
+			return Error::FILE_ACCESS;
+		}
+
+		ANKI_CHECK(m_file.getMappedRange(m_info->m_offset + m_pos, size, view));
+		m_pos += size;
+		return Error::NONE;
+	}
+
+	ANKI_USE_RESULT Error readAsync(
+		FileIoQueue& queue, void* buff, PtrSize size, FileReadAsyncCallback callback, void* userData) override
+	{
+		if(isCompressed())
+		{
+			return ResourceFile::readAsync(queue, buff, size, callback, userData);
+		}
+
+		if(m_pos + size > m_info->m_size)
+		{
+			ANKI_RESOURCE_LOGE("Reading past the end of the file");
+			return Error::FILE_ACCESS;
+		}
+
+		ANKI_CHECK(m_file.readAsync(queue, m_info->m_offset + m_pos, buff, size, callback, userData));
+		m_pos += size;
+		return Error::NONE;
+	}
+
+private:
+	PtrSize getChunkUncompressedSize(U32 chunkIdx) const
+	{
+		const PtrSize chunkSize = m_pack->getChunkSize();
+		return min<PtrSize>(chunkSize, m_info->m_size - PtrSize(chunkIdx) * chunkSize);
+	}
+
+	ANKI_USE_RESULT Error loadChunk(U32 chunkIdx)
+	{
+		if(chunkIdx == m_chunkIdx)
+		{
+			return Error::NONE;
+		}
+
+		m_chunkIdx = MAX_U32;
+		const ResourcePackChunk& chunk = m_pack->getChunk(m_info->m_firstChunk + chunkIdx);
+		if(m_compressedChunk.getSize() < chunk.m_compressedSize)
+		{
+			m_compressedChunk.resize(getAllocator(), chunk.m_compressedSize);
+		}
+
+		ANKI_CHECK(m_file.seek(chunk.m_offset, FileSeekOrigin::BEGINNING));
+		ANKI_CHECK(m_file.read(&m_compressedChunk[0], chunk.m_compressedSize));
+		ANKI_CHECK(ResourcePack::decompress(ConstWeakArray<U8>(&m_compressedChunk[0], chunk.m_compressedSize),
+			WeakArray<U8>(&m_chunk[0], U32(getChunkUncompressedSize(chunkIdx)))));
+
+		m_chunkIdx = chunkIdx;
+		return Error::NONE;
+	}
+};
+
 ResourceFilesystem::~ResourceFilesystem()
 {
+	if(!m_ioTraceFilename.isEmpty())
+	{
+		if(endIoTraceRecording(m_ioTraceFilename.toCString()))
+		{
+			ANKI_RESOURCE_LOGE("Failed to write the I/O trace");
+		}
+
+		m_ioTraceFilename.destroy(m_alloc);
+	}
+
+	destroyIoTrace();
+
 	for(Path& p : m_paths)
 	{
 		p.m_files.destroy(m_alloc);
 		p.m_path.destroy(m_alloc);
+		m_alloc.deleteInstance(p.m_pack);
 	}
 
 	m_paths.destroy(m_alloc);
@@ -223,6 +487,13 @@ Error ResourceFilesystem::init(const ConfigSet& config, const CString& cacheDir)
 
 	addCachePath(cacheDir);
 
+	const CString ioTraceFilename = config.getString("rsrc_ioTraceFile");
+	if(!ioTraceFilename.isEmpty())
+	{
+		m_ioTraceFilename.create(m_alloc, ioTraceFilename);
+		beginIoTraceRecording();
+	}
+
 	return Error::NONE;
 }
 
@@ -239,9 +510,35 @@ Error ResourceFilesystem::addNewPath(const CString& path)
 {
 	U32 fileCount = 0;
 	static const CString extension(".ankizip");
+	static const CString packExtension(".ankipak");
 
 	auto pos = path.find(extension);
-	if(pos != CString::NPOS && pos == path.getLength() - extension.getLength())
+	auto packPos = path.find(packExtension);
+	if(packPos != CString::NPOS && packPos == path.getLength() - packExtension.getLength())
+	{
+		// It's a resource pack. Keep the table of contents, the files will be found with it
+
+		Path p;
+		p.m_isArchive = true;
+		p.m_path.create(m_alloc, path);
+		p.m_pack = m_alloc.newInstance<ResourcePack>(m_alloc);
+		const Error err = p.m_pack->load(path);
+		if(err)
+		{
+			p.m_path.destroy(m_alloc);
+			m_alloc.deleteInstance(p.m_pack);
+			return err;
+		}
+
+		for(const ResourcePackFileInfo& info : p.m_pack->getFiles())
+		{
+			p.m_files.pushBackSprintf(m_alloc, "%s", p.m_pack->getFilename(info).cstr());
+			++fileCount;
+		}
+
+		m_paths.emplaceFront(m_alloc, std::move(p));
+	}
+	else if(pos != CString::NPOS && pos == path.getLength() - extension.getLength())
 	{
 		// It's an archive
 
@@ -332,6 +629,7 @@ Error ResourceFilesystem::addNewPath(const CString& path)
 
 Error ResourceFilesystem::openFile(const ResourceFilename& filename, ResourceFilePtr& filePtr)
 {
+	const IoTimer ioTimer;
 	ResourceFile* rfile = nullptr;
 	Error err = Error::NONE;
 
@@ -351,7 +649,20 @@ Error ResourceFilesystem::openFile(const ResourceFilename& filename, ResourceFil
 				CResourceFile* file = m_alloc.newInstance<CResourceFile>(m_alloc);
 				rfile = file;
 
-				err = file->m_file.open(&newFname[0], FileOpenFlag::READ);
+				err = file->m_file.open(&newFname[0], FileOpenFlag::READ | FileOpenFlag::MMAP | FileOpenFlag::ASYNC);
+			}
+		}
+		else if(p.m_pack)
+		{
+			// In a resource pack. No need to walk the filenames
+
+			const ResourcePackFileInfo* info = p.m_pack->findFile(filename);
+			if(info)
+			{
+				PackResourceFile* file = m_alloc.newInstance<PackResourceFile>(m_alloc);
+				rfile = file;
+
+				err = file->open(*p.m_pack, *info);
 			}
 		}
 		else
@@ -381,7 +692,8 @@ Error ResourceFilesystem::openFile(const ResourceFilename& filename, ResourceFil
 					CResourceFile* file = m_alloc.newInstance<CResourceFile>(m_alloc);
 					rfile = file;
 
-					err = file->m_file.open(&newFname[0], FileOpenFlag::READ);
+					err = file->m_file.open(
+						&newFname[0], FileOpenFlag::READ | FileOpenFlag::MMAP | FileOpenFlag::ASYNC);
 
 #if 0
 					printf("Opening asset %s\n", &newFname[0]);
@@ -408,9 +720,73 @@ Error ResourceFilesystem::openFile(const ResourceFilename& filename, ResourceFil
 		return Error::USER_DATA;
 	}
 
+	recordIoTrace(filename, rfile->getSize());
+
 	// Done
 	filePtr.reset(rfile);
 	return Error::NONE;
 }
 
+Second ResourceFilesystem::getThreadIoTime()
+{
+	return g_threadIoTime;
+}
+
+void ResourceFilesystem::beginIoTraceRecording()
+{
+	LockGuard<Mutex> lock(m_ioTraceMtx);
+	destroyIoTrace();
+	m_ioTraceBeginTime = HighRezTimer::getCurrentTime();
+	m_recordingIoTrace = true;
+}
+
+void ResourceFilesystem::recordIoTrace(const ResourceFilename& filename, PtrSize size)
+{
+	const Second time = HighRezTimer::getCurrentTime();
+
+	LockGuard<Mutex> lock(m_ioTraceMtx);
+	if(!m_recordingIoTrace)
+	{
+		return;
+	}
+
+	IoTraceEntry& entry = *m_ioTrace.emplaceBack(m_alloc);
+	entry.m_time = time - m_ioTraceBeginTime;
+	entry.m_size = size;
+	entry.m_filename.create(m_alloc, filename);
+}
+
+Error ResourceFilesystem::endIoTraceRecording(CString filename)
+{
+	LockGuard<Mutex> lock(m_ioTraceMtx);
+	ANKI_ASSERT(m_recordingIoTrace);
+	m_recordingIoTrace = false;
+
+	File file;
+	Error err = file.open(filename, FileOpenFlag::WRITE);
+	for(U32 i = 0; i < m_ioTrace.getSize() && !err; ++i)
+	{
+		const IoTraceEntry& entry = m_ioTrace[i];
+		err = file.writeText("%f %lu %s\n", entry.m_time, entry.m_size, entry.m_filename.cstr());
+	}
+
+	if(!err)
+	{
+		ANKI_RESOURCE_LOGI("Wrote an I/O trace of %u file opens to %s", m_ioTrace.getSize(), filename.cstr());
+	}
+
+	destroyIoTrace();
+	return err;
+}
+
+void ResourceFilesystem::destroyIoTrace()
+{
+	for(IoTraceEntry& entry : m_ioTrace)
+	{
+		entry.m_filename.destroy(m_alloc);
+	}
+
+	m_ioTrace.destroy(m_alloc);
+}
+
 } // end namespace anki
@@ -10,12 +10,15 @@
 #include <anki/util/StringList.h>
 #include <anki/util/File.h>
 #include <anki/util/Ptr.h>
+#include <anki/util/Thread.h>
+#include <anki/util/DynamicArray.h>
 
 namespace anki
 {
 
 // Forward
 class ConfigSet;
+class ResourcePack;
 
 /// @addtogroup resource
 /// @{
@@ -53,6 +56,35 @@ public:
 	/// Get the size of the file.
 	virtual PtrSize getSize() const = 0;
 
+	/// Return true if the file is mapped to memory. If it is then readMapped() can be used.
+	virtual Bool isMapped() const
+	{
+		return false;
+	}
+
+	/// Get a view of the next bytes of a mapped file and move the position indicator past them. The view is valid for
+	/// as long as the file is alive.
+	virtual ANKI_USE_RESULT Error readMapped(PtrSize size, ConstWeakArray<U8>& view)
+	{
+		ANKI_ASSERT(!"Not supported");
+		return Error::FUNCTION_FAILED;
+	}
+
+	/// Read the next bytes asynchronously and move the position indicator past them. The files that can't do
+	/// asynchronous reads read immediately and call the callback before returning.
+	/// @see File::readAsync
+	virtual ANKI_USE_RESULT Error readAsync(
+		FileIoQueue& queue, void* buff, PtrSize size, FileReadAsyncCallback callback, void* userData)
+	{
+		const Error err = read(buff, size);
+		if(!err)
+		{
+			callback(userData, Error::NONE);
+		}
+
+		return err;
+	}
+
 	Atomic<I32>& getRefcount()
 	{
 		return m_refcount;
@@ -87,6 +119,18 @@ public:
 	/// Search the path list to find the file. Then open the file for reading. It's thread-safe.
 	ANKI_USE_RESULT Error openFile(const ResourceFilename& filename, ResourceFilePtr& file);
 
+	/// Start recording the files that openFile() opens. The "rsrc_ioTraceFile" config option records the whole run.
+	/// @see endIoTraceRecording
+	void beginIoTraceRecording();
+
+	/// Stop the recording and write the I/O trace to a text file. Every line is "<seconds since the begin> <size>
+	/// <filename>". Replay it with tools/resource_bench to reproduce the access pattern without the engine.
+	ANKI_USE_RESULT Error endIoTraceRecording(CString filename);
+
+	/// The time the calling thread spent opening and reading resource files. The reads of mapped files happen when
+	/// the memory is touched and they are not accounted.
+	static Second getThreadIoTime();
+
 	/// Iterate all the filenames from all paths provided.
 	template<typename TFunc>
 	ANKI_USE_RESULT Error iterateAllFilenames(TFunc func) const
@@ -101,6 +145,20 @@ public:
 		return Error::NONE;
 	}
 
+	/// Iterate the directories the resources are read from. It skips the archives and the cache directory.
+	template<typename TFunc>
+	ANKI_USE_RESULT Error iterateDirectories(TFunc func) const
+	{
+		for(const Path& path : m_paths)
+		{
+			if(!path.m_isArchive && !path.m_isCache)
+			{
+				ANKI_CHECK(func(path.m_path.toCString()));
+			}
+		}
+		return Error::NONE;
+	}
+
 #if !ANKI_TESTS
 private:
 #endif
@@ -109,6 +167,7 @@ private:
 	public:
 		StringList m_files; ///< Files inside the directory.
 		String m_path; ///< A directory or an archive.
+		ResourcePack* m_pack = nullptr; ///< The table of contents if it's a resource pack.
 		Bool m_isArchive = false;
 		Bool m_isCache = false;
 
@@ -117,29 +176,54 @@ private:
 		Path(Path&& b)
 			: m_files(std::move(b.m_files))
 			, m_path(std::move(b.m_path))
+			, m_pack(b.m_pack)
 			, m_isArchive(std::move(b.m_isArchive))
 			, m_isCache(std::move(b.m_isCache))
 		{
+			b.m_pack = nullptr;
 		}
 
 		Path& operator=(Path&& b)
 		{
 			m_files = std::move(b.m_files);
 			m_path = std::move(b.m_path);
+			m_pack = b.m_pack;
+			b.m_pack = nullptr;
 			m_isArchive = std::move(b.m_isArchive);
 			m_isCache = std::move(b.m_isCache);
 			return *this;
 		}
 	};
 
+	class IoTraceEntry
+	{
+	public:
+		Second m_time;
+		PtrSize m_size;
+		String m_filename;
+	};
+
 	GenericMemoryPoolAllocator<U8> m_alloc;
 	List<Path> m_paths;
 	String m_cacheDir;
 
-	/// Add a filesystem path or an archive. The path is read-only.
+	/// @name I/O trace
+	/// @{
+	Mutex m_ioTraceMtx;
+	DynamicArray<IoTraceEntry> m_ioTrace;
+	Second m_ioTraceBeginTime = 0.0;
+	Bool m_recordingIoTrace = false;
+	String m_ioTraceFilename; ///< Write the trace there at exit.
+	/// @}
+
+	/// Add a filesystem path, a zip archive (.ankizip) or a resource pack (.ankipak). The path is read-only.
 	ANKI_USE_RESULT Error addNewPath(const CString& path);
 
 	void addCachePath(const CString& path);
+
+	void recordIoTrace(const ResourceFilename& filename, PtrSize size);
+
+	void destroyIoTrace();
 };
 /// @}
 
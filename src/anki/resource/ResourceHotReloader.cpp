@@ -0,0 +1,264 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/resource/ResourceHotReloader.h>
+#include <anki/resource/AsyncLoader.h>
+#include <anki/Resource.h>
+#include <anki/util/StringList.h>
+#include <algorithm>
+
+namespace anki
+{
+
+namespace
+{
+
+/// A loaded resource that might need a reload.
+class ReloadCandidate
+{
+public:
+	using ReloadCallback = Error (*)(ResourceManager& manager, ResourceObject* rsrc);
+
+	ResourceObject* m_resource;
+	ReloadCallback m_reload;
+	U64 m_filenameHash;
+	U32 m_depth = 0; ///< It's bigger than the depths of the resources it loads.
+	Bool m_affected = false;
+
+	ReloadCandidate(ResourceObject* rsrc, ReloadCallback reload)
+		: m_resource(rsrc)
+		, m_reload(reload)
+		, m_filenameHash(rsrc->getFilename().computeHash())
+	{
+	}
+};
+
+template<typename T>
+Error reloadResourceCallback(ResourceManager& manager, ResourceObject* rsrc)
+{
+	return manager.reloadResource(static_cast<T*>(rsrc));
+}
+
+} // end anonymous namespace
+
+ResourceHotReloader::ResourceHotReloader(ResourceManager* manager)
+	: m_manager(manager)
+{
+	ANKI_ASSERT(manager);
+}
+
+ResourceHotReloader::~ResourceHotReloader()
+{
+	ResourceAllocator<U8>& alloc = m_manager->getAllocator();
+
+	for(INotify* watcher : m_watchers)
+	{
+		alloc.deleteInstance(watcher);
+	}
+	m_watchers.destroy(alloc);
+
+	for(String& fname : m_pendingFiles)
+	{
+		fname.destroy(alloc);
+	}
+	m_pendingFiles.destroy(alloc);
+}
+
+Error ResourceHotReloader::init(Second coalescingTime)
+{
+	ANKI_ASSERT(coalescingTime >= 0.0);
+	m_coalescingTime = coalescingTime;
+
+	ANKI_CHECK(m_manager->getFilesystem().iterateDirectories([&](CString dir) -> Error {
+		ResourceAllocator<U8>& alloc = m_manager->getAllocator();
+		INotify* watcher = alloc.newInstance<INotify>();
+		m_watchers.emplaceBack(alloc, watcher);
+		ANKI_CHECK(watcher->init(alloc, dir, true));
+
+		ANKI_RESOURCE_LOGI("Watching for changes: %s", dir.cstr());
+		return Error::NONE;
+	}));
+
+	return Error::NONE;
+}
+
+void ResourceHotReloader::addPendingFile(CString filename)
+{
+	const U64 hash = filename.computeHash();
+	if(m_pendingFiles.find(hash) == m_pendingFiles.getEnd())
+	{
+		String fname;
+		fname.create(m_manager->getAllocator(), filename);
+		m_pendingFiles.emplace(m_manager->getAllocator(), hash, std::move(fname));
+		++m_pendingFileCount;
+	}
+}
+
+Error ResourceHotReloader::update(Second crntTime)
+{
+	// Gather the changes
+	StringListAuto changedFiles(m_manager->getAllocator());
+	for(INotify* watcher : m_watchers)
+	{
+		ANKI_CHECK(watcher->pollEvents(changedFiles));
+
+		// Make them resource filenames
+		const PtrSize prefixLen = watcher->getPath().getLength() + 1;
+		for(const String& path : changedFiles)
+		{
+			if(path.getLength() > prefixLen)
+			{
+				addPendingFile(CString(path.cstr() + prefixLen));
+			}
+		}
+
+		if(!changedFiles.isEmpty())
+		{
+			m_lastChangeTime = crntTime;
+			changedFiles.destroy();
+		}
+	}
+
+	// Reload only when the files stopped changing. Editors and exporters tend to write many files or the same file
+	// many times
+	if(m_pendingFileCount > 0 && crntTime - m_lastChangeTime >= m_coalescingTime)
+	{
+		ANKI_CHECK(reload());
+	}
+
+	return Error::NONE;
+}
+
+Error ResourceHotReloader::reload()
+{
+	ResourceAllocator<U8>& alloc = m_manager->getAllocator();
+
+	// Gather all the loaded resources
+	DynamicArrayAuto<ReloadCandidate> candidates(alloc);
+
+#define ANKI_INSTANTIATE_RESOURCE(rsrc_, ptr_) \
+	m_manager->iterateLoadedResources<rsrc_>([&](rsrc_* rsrc) { \
+		candidates.emplaceBack(rsrc, reloadResourceCallback<rsrc_>); \
+	});
+#define ANKI_INSTANSIATE_RESOURCE_DELIMITER()
+#include <anki/resource/InstantiationMacros.h>
+#undef ANKI_INSTANTIATE_RESOURCE
+#undef ANKI_INSTANSIATE_RESOURCE_DELIMITER
+
+	// Find the resources that use the changed files. If a resource is affected the resources that loaded it are
+	// affected as well. The value is the depth of the resource in the dependency chain
+	HashMapAuto<U64, U32> affectedFiles(alloc);
+	for(auto it = m_pendingFiles.getBegin(); it != m_pendingFiles.getEnd(); ++it)
+	{
+		affectedFiles.emplace(it->toCString().computeHash(), 0);
+	}
+
+	U32 affectedCount = 0;
+	Bool changed = true;
+	while(changed)
+	{
+		changed = false;
+		for(ReloadCandidate& c : candidates)
+		{
+			if(c.m_affected)
+			{
+				continue;
+			}
+
+			c.m_affected = affectedFiles.find(c.m_filenameHash) != affectedFiles.getEnd();
+			for(U64 dep : c.m_resource->getDependencies())
+			{
+				c.m_affected = c.m_affected || affectedFiles.find(dep) != affectedFiles.getEnd();
+			}
+
+			if(c.m_affected)
+			{
+				++affectedCount;
+				changed = true;
+				if(affectedFiles.find(c.m_filenameHash) == affectedFiles.getEnd())
+				{
+					affectedFiles.emplace(c.m_filenameHash, 0);
+				}
+			}
+		}
+	}
+
+	// Compute the depths. A resource has to be reloaded after the resources it loads so it picks their new versions.
+	// The iteration count is bounded to break dependency cycles
+	for(U32 iteration = 0; iteration < affectedCount; ++iteration)
+	{
+		changed = false;
+		for(ReloadCandidate& c : candidates)
+		{
+			if(!c.m_affected)
+			{
+				continue;
+			}
+
+			for(U64 dep : c.m_resource->getDependencies())
+			{
+				auto it = affectedFiles.find(dep);
+				if(it != affectedFiles.getEnd() && *it + 1 > c.m_depth)
+				{
+					c.m_depth = *it + 1;
+					changed = true;
+				}
+			}
+
+			U32& depth = *affectedFiles.find(c.m_filenameHash);
+			depth = max(depth, c.m_depth);
+		}
+
+		if(!changed)
+		{
+			break;
+		}
+	}
+
+	std::sort(candidates.getBegin(), candidates.getEnd(), [](const ReloadCandidate& a, const ReloadCandidate& b) {
+		return a.m_depth < b.m_depth;
+	});
+
+	// Reload. The asynchronous work of all the resources goes to the loader at once and before anything else
+	m_manager->getAsyncLoader().beginBatch();
+
+	U32 reloadedCount = 0;
+	for(ReloadCandidate& c : candidates)
+	{
+		if(!c.m_affected)
+		{
+			continue;
+		}
+
+		const Error err = c.m_reload(*m_manager, c.m_resource);
+		if(err)
+		{
+			// Keep the old one. It was probably a file that is still being written
+			ANKI_RESOURCE_LOGW("Failed to reload resource, keeping the old version: %s",
+				c.m_resource->getFilename().cstr());
+		}
+		else
+		{
+			++reloadedCount;
+		}
+	}
+
+	m_manager->getAsyncLoader().endBatch(AsyncLoaderTaskPriority::HIGH);
+
+	ANKI_RESOURCE_LOGI("Reloaded %u resources because %u files changed", reloadedCount, m_pendingFileCount);
+	m_reloadedResourceCount += reloadedCount;
+
+	// Clear the pending files
+	for(String& fname : m_pendingFiles)
+	{
+		fname.destroy(alloc);
+	}
+	m_pendingFiles.destroy(alloc);
+	m_pendingFileCount = 0;
+
+	return Error::NONE;
+}
+
+} // end namespace anki
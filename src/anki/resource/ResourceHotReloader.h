@@ -0,0 +1,66 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/resource/Common.h>
+#include <anki/util/HashMap.h>
+#include <anki/util/INotify.h>
+
+namespace anki
+{
+
+/// @addtogroup resource
+/// @{
+
+/// Watches the data directories of the ResourceFilesystem and reloads the resources whose files change. The file
+/// events are coalesced: nothing is reloaded until the files stop changing for a while. Then all the resources that
+/// use the changed files, directly or through other resources, are reloaded together and the asynchronous work of
+/// the reload goes to the AsyncLoader as a single high priority batch.
+class ResourceHotReloader : public NonCopyable
+{
+public:
+	ResourceHotReloader(ResourceManager* manager);
+
+	~ResourceHotReloader();
+
+	/// @param coalescingTime The time without file changes before a reload starts.
+	ANKI_USE_RESULT Error init(Second coalescingTime);
+
+	/// Gather the file changes and reload if it's time.
+	ANKI_USE_RESULT Error update(Second crntTime);
+
+	/// Get the number of the changed files that wait for the next reload.
+	U32 getPendingFileCount() const
+	{
+		return m_pendingFileCount;
+	}
+
+	/// Get the number of the resources that got reloaded so far.
+	U64 getReloadedResourceCount() const
+	{
+		return m_reloadedResourceCount;
+	}
+
+private:
+	ResourceManager* m_manager;
+	Second m_coalescingTime = 0.0;
+	Second m_lastChangeTime = 0.0;
+
+	DynamicArray<INotify*> m_watchers;
+
+	/// The changed files. The key is the hash of the resource filename.
+	HashMap<U64, String> m_pendingFiles;
+	U32 m_pendingFileCount = 0;
+
+	U64 m_reloadedResourceCount = 0;
+
+	void addPendingFile(CString filename);
+
+	ANKI_USE_RESULT Error reload();
+};
+/// @}
+
+} // end namespace anki
@@ -5,8 +5,16 @@
 
 #include <anki/resource/ResourceManager.h>
 #include <anki/resource/AsyncLoader.h>
+#include <anki/resource/ResourceFilesystem.h>
+#include <anki/resource/ResourceHotReloader.h>
+#include <anki/resource/TextureStreamer.h>
+#include <anki/resource/GeometryMemoryPool.h>
+#include <anki/resource/MaterialVariantCache.h>
+#include <anki/resource/ShaderProgramVariantManifest.h>
 #include <anki/resource/AnimationResource.h>
 #include <anki/util/Logger.h>
+#include <anki/util/Tracer.h>
+#include <anki/util/HighRezTimer.h>
 #include <anki/core/ConfigSet.h>
 
 #include <anki/resource/MaterialResource.h>
@@ -24,15 +32,50 @@
 namespace anki
 {
 
+/// The resource that the thread is currently loading.
+static thread_local ResourceObject* g_loadingResource = nullptr;
+
+/// The load time and the I/O time of the resources that the resource the thread loads loaded. They are subtracted from
+/// its times so every type gets only its own.
+static thread_local Second g_nestedLoadTime = 0.0;
+static thread_local Second g_nestedIoTime = 0.0;
+
+/// The thread is in loadStreamedTexture().
+static thread_local Bool g_loadingStreamedTexture = false;
+
 ResourceManager::ResourceManager()
 {
 }
 
 ResourceManager::~ResourceManager()
 {
+	m_alloc.deleteInstance(m_hotReloader);
+	m_alloc.deleteInstance(m_textureStreamer);
 	m_cacheDir.destroy(m_alloc);
 	m_alloc.deleteInstance(m_asyncLoader);
+	m_alloc.deleteInstance(m_shaderCompilationQueue);
 	m_alloc.deleteInstance(m_transferGpuAlloc);
+	m_alloc.deleteInstance(m_geometryPool);
+
+	if(m_materialVariantCache)
+	{
+		if(m_materialVariantCache->save())
+		{
+			ANKI_RESOURCE_LOGE("Failed to write the material variant cache");
+		}
+
+		m_alloc.deleteInstance(m_materialVariantCache);
+	}
+
+	if(m_shaderVariantManifest)
+	{
+		if(m_shaderVariantManifest->save())
+		{
+			ANKI_RESOURCE_LOGE("Failed to write the shader variant manifest");
+		}
+
+		m_alloc.deleteInstance(m_shaderVariantManifest);
+	}
 }
 
 Error ResourceManager::init(ResourceManagerInitInfo& init)
@@ -49,6 +92,10 @@ Error ResourceManager::init(ResourceManagerInitInfo& init)
 	// Init some constants
 	m_maxTextureSize = init.m_config->getNumberU32("rsrc_maxTextureSize");
 	m_dumpShaderSource = init.m_config->getBool("rsrc_dumpShaderSources");
+	m_gpuSkinning = init.m_config->getBool("r_gpuSkinning");
+	m_meshLodStreaming = init.m_config->getBool("rsrc_meshLodStreaming");
+	m_collisionBvhCache = init.m_config->getBool("rsrc_collisionBvhCache");
+	m_cookedDescriptors = init.m_config->getBool("rsrc_cookedDescriptors");
 
 	// Init type resource managers
 #define ANKI_INSTANTIATE_RESOURCE(rsrc_, ptr_) TypeResourceManager<rsrc_>::init(m_alloc);
@@ -57,81 +104,222 @@ Error ResourceManager::init(ResourceManagerInitInfo& init)
 #undef ANKI_INSTANTIATE_RESOURCE
 #undef ANKI_INSTANSIATE_RESOURCE_DELIMITER
 
-	// Init the thread
+	// Init the threads
 	m_asyncLoader = m_alloc.newInstance<AsyncLoader>();
-	m_asyncLoader->init(m_alloc);
+	m_asyncLoader->init(m_alloc, init.m_config->getNumberU32("rsrc_asyncLoaderThreadCount"));
+
+	if(init.m_config->getBool("rsrc_asyncShaderCompilation"))
+	{
+		m_shaderCompilationQueue = m_alloc.newInstance<AsyncLoader>();
+		m_shaderCompilationQueue->init(m_alloc, init.m_config->getNumberU32("rsrc_shaderCompilationThreadCount"));
+	}
+
+	m_textureStreamer = m_alloc.newInstance<TextureStreamer>(this);
+	m_textureStreamer->init(*init.m_config);
 
 	m_transferGpuAlloc = m_alloc.newInstance<TransferGpuAllocator>();
-	ANKI_CHECK(m_transferGpuAlloc->init(init.m_config->getNumberU32("rsrc_transferScratchMemorySize"), m_gr, m_alloc));
+	ANKI_CHECK(m_transferGpuAlloc->init(init.m_config->getNumberU32("rsrc_transferScratchMemorySize"),
+		init.m_config->getNumberU64("rsrc_transferBudgetPerFrame"),
+		m_gr,
+		m_alloc));
+
+	if(m_gr)
+	{
+		// The storage buffer alignment is for the meshlets and the vertex buffers the mesh shaders read
+		const U32 alignment = max<U32>(
+			MeshResource::VERTEX_BUFFER_ALIGNMENT, m_gr->getDeviceCapabilities().m_storageBufferBindOffsetAlignment);
+		m_geometryPool = m_alloc.newInstance<GeometryMemoryPool>();
+		m_geometryPool->init(m_gr, m_alloc, init.m_config->getNumberU64("rsrc_geometryPoolChunkSize"), alignment);
+	}
+
+	const CString variantCacheFname = init.m_config->getString("rsrc_materialVariantCache");
+	if(!variantCacheFname.isEmpty())
+	{
+		m_materialVariantCache = m_alloc.newInstance<MaterialVariantCache>(m_alloc);
+		ANKI_CHECK(m_materialVariantCache->init(
+			variantCacheFname, init.m_config->getBool("rsrc_recordMaterialVariants")));
+	}
+
+	const CString variantManifestFname = init.m_config->getString("rsrc_shaderVariantManifest");
+	if(!variantManifestFname.isEmpty())
+	{
+		m_shaderVariantManifest = m_alloc.newInstance<ShaderProgramVariantManifest>(m_alloc);
+		ANKI_CHECK(m_shaderVariantManifest->init(
+			variantManifestFname, init.m_config->getBool("rsrc_recordShaderVariants")));
+	}
+
+	if(init.m_config->getBool("rsrc_hotReload"))
+	{
+		m_hotReloader = m_alloc.newInstance<ResourceHotReloader>(this);
+		ANKI_CHECK(m_hotReloader->init(init.m_config->getNumberF64("rsrc_hotReloadCoalescingTime")));
+	}
 
 	return Error::NONE;
 }
 
+Error ResourceManager::updateHotReloading(Second crntTime)
+{
+	return (m_hotReloader) ? m_hotReloader->update(crntTime) : Error(Error::NONE);
+}
+
+void ResourceManager::updateStreaming()
+{
+	m_textureStreamer->update();
+
+	if(m_meshLodStreaming)
+	{
+		ANKI_TRACE_SCOPED_EVENT(RSRC_MESH_LOD_STREAMING);
+		++m_streamingFrame;
+
+		// Loading a mesh opens its file so don't start too many in a frame
+		U32 loadBudget = MAX_MESH_LOD_LOADS_PER_FRAME;
+		iterateLoadedResources<ModelResource>(
+			[&](ModelResource* model) { model->updateLodStreaming(m_streamingFrame, loadBudget); });
+	}
+
+	if(m_geometryPool)
+	{
+		m_geometryPool->endFrame();
+	}
+
+	// The mutations that finished compiling become visible all at once so a frame doesn't see them change mid-way
+	if(m_compiledShaderMutationCount.exchange(0) > 0)
+	{
+		iterateLoadedResources<ShaderProgramResource>(
+			[&](ShaderProgramResource* prog) { prog->publishCompiledMutations(); });
+	}
+}
+
+Bool ResourceManager::isLoadingStreamedTexture() const
+{
+	return g_loadingStreamedTexture;
+}
+
+Error ResourceManager::loadStreamedTexture(const CString& filename, TextureResourcePtr& out, Bool async)
+{
+	const Bool prevLoadingStreamedTexture = g_loadingStreamedTexture;
+	g_loadingStreamedTexture = true;
+	const Error err = loadResource(filename, out, async);
+	g_loadingStreamedTexture = prevLoadingStreamedTexture;
+	return err;
+}
+
 U64 ResourceManager::getAsyncTaskCompletedCount() const
 {
 	return m_asyncLoader->getCompletedTaskCount();
 }
 
 template<typename T>
-Error ResourceManager::loadResource(const CString& filename, ResourcePtr<T>& out, Bool async)
+Error ResourceManager::loadResourceInternal(const CString& filename, Bool async, T*& out)
 {
-	ANKI_ASSERT(!out.isCreated() && "Already loaded");
+	// Allocate ptr
+	T* ptr = m_alloc.newInstance<T>(this);
+	ANKI_ASSERT(ptr->getRefcount().load() == 0);
 
-	Error err = Error::NONE;
-	++m_loadRequestCount;
+	// Populate the ptr. Use a block to cleanup temp_pool allocations
+	auto& pool = m_tmpAlloc.getMemoryPool();
 
-	T* const other = findLoadedResource<T>(filename);
+	{
+		U allocsCountBefore = pool.getAllocationsCount();
+		(void)allocsCountBefore;
 
-	if(other)
+		// Track the resources it loads
+		ResourceObject* const prevLoadingResource = g_loadingResource;
+		const Second prevNestedLoadTime = g_nestedLoadTime;
+		const Second prevNestedIoTime = g_nestedIoTime;
+		g_loadingResource = ptr;
+		g_nestedLoadTime = 0.0;
+		g_nestedIoTime = 0.0;
+		const Second ioTimeBegin = ResourceFilesystem::getThreadIoTime();
+		const Second loadBegin = HighRezTimer::getCurrentTime();
+
+		const Error err = ptr->load(filename, async);
+
+		const Second loadTime = HighRezTimer::getCurrentTime() - loadBegin;
+		const Second ioTime = ResourceFilesystem::getThreadIoTime() - ioTimeBegin;
+		TypeResourceManager<T>::recordLoad(loadTime - g_nestedLoadTime, ioTime - g_nestedIoTime);
+		g_loadingResource = prevLoadingResource;
+		g_nestedLoadTime = prevNestedLoadTime + loadTime;
+		g_nestedIoTime = prevNestedIoTime + ioTime;
+
+		if(err)
+		{
+			ANKI_RESOURCE_LOGE("Failed to load resource: %s", &filename[0]);
+			m_alloc.deleteInstance(ptr);
+			return err;
+		}
+
+		ANKI_ASSERT(pool.getAllocationsCount() == allocsCountBefore && "Forgot to deallocate");
+	}
+
+	ptr->setFilename(filename);
+	ptr->setUuid(m_uuid.fetchAdd(1) + 1);
+
+	// Reset the memory pool if no-one is using it.
+	// NOTE: Check because resources load other resources
+	if(pool.getAllocationsCount() == 0)
 	{
-		// Found
-		out.reset(other);
+		pool.reset();
 	}
-	else
+
+	out = ptr;
+	return Error::NONE;
+}
+
+template<typename T>
+Error ResourceManager::loadResource(const CString& filename, ResourcePtr<T>& out, Bool async)
+{
+	ANKI_ASSERT(!out.isCreated() && "Already loaded");
+
+	m_loadRequestCount.fetchAdd(1);
+
+	if(g_loadingResource)
 	{
-		// Allocate ptr
-		T* ptr = m_alloc.newInstance<T>(this);
-		ANKI_ASSERT(ptr->getRefcount().load() == 0);
+		g_loadingResource->addDependency(filename);
+	}
 
-		// Populate the ptr. Use a block to cleanup temp_pool allocations
-		auto& pool = m_tmpAlloc.getMemoryPool();
+	T* ptr = TypeResourceManager<T>::acquireLoadedResource(filename);
+	if(!ptr)
+	{
+		T* newPtr;
+		ANKI_CHECK(loadResourceInternal(filename, async, newPtr));
 
+		// Register it. If another thread loaded the same file in the meantime keep the one that got there first
+		ptr = TypeResourceManager<T>::registerResource(newPtr);
+		if(ptr != newPtr)
 		{
-			U allocsCountBefore = pool.getAllocationsCount();
-			(void)allocsCountBefore;
-
-			err = ptr->load(filename, async);
-			if(err)
-			{
-				ANKI_RESOURCE_LOGE("Failed to load resource: %s", &filename[0]);
-				m_alloc.deleteInstance(ptr);
-				return err;
-			}
-
-			ANKI_ASSERT(pool.getAllocationsCount() == allocsCountBefore && "Forgot to deallocate");
+			m_alloc.deleteInstance(newPtr);
 		}
+	}
 
-		ptr->setFilename(filename);
-		ptr->setUuid(++m_uuid);
+	// The ptr came with a reference, move it to the out
+	out.reset(ptr);
+	ptr->getRefcount().fetchSub(1);
 
-		// Reset the memory pool if no-one is using it.
-		// NOTE: Check because resources load other resources
-		if(pool.getAllocationsCount() == 0)
-		{
-			pool.reset();
-		}
+	return Error::NONE;
+}
 
-		// Register resource
-		registerResource(ptr);
-		out.reset(ptr);
-	}
+template<typename T>
+Error ResourceManager::reloadResource(T* oldPtr)
+{
+	ANKI_ASSERT(oldPtr && !oldPtr->getReplacement());
+	ANKI_ASSERT(findLoadedResource<T>(oldPtr->getFilename()) == oldPtr);
 
-	return err;
+	T* newPtr;
+	ANKI_CHECK(loadResourceInternal(oldPtr->getFilename(), true, newPtr));
+
+	// The old version holds a reference to the new until it dies
+	newPtr->getRefcount().fetchAdd(1);
+	oldPtr->m_replacement = newPtr;
+	TypeResourceManager<T>::replaceResource(oldPtr, newPtr);
+
+	return Error::NONE;
 }
 
-// Instansiate the ResourceManager::loadResource()
+// Instansiate the ResourceManager::loadResource() and ResourceManager::reloadResource()
 #define ANKI_INSTANTIATE_RESOURCE(rsrc_, ptr_) \
-	template Error ResourceManager::loadResource<rsrc_>(const CString& filename, ResourcePtr<rsrc_>& out, Bool async);
+	template Error ResourceManager::loadResource<rsrc_>(const CString& filename, ResourcePtr<rsrc_>& out, Bool async); \
+	template Error ResourceManager::reloadResource<rsrc_>(rsrc_* oldPtr);
 #define ANKI_INSTANSIATE_RESOURCE_DELIMITER()
 #include <anki/resource/InstantiationMacros.h>
 #undef ANKI_INSTANTIATE_RESOURCE
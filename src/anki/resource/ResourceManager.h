@@ -6,7 +6,10 @@
 #pragma once
 
 #include <anki/resource/TransferGpuAllocator.h>
-#include <anki/util/List.h>
+#include <anki/util/HashMap.h>
+#include <anki/util/DynamicArray.h>
+#include <anki/util/Thread.h>
+#include <anki/util/Atomic.h>
 #include <anki/util/Functions.h>
 #include <anki/util/String.h>
 
@@ -21,11 +24,28 @@ class ResourceManager;
 class AsyncLoader;
 class ResourceManagerModel;
 class ShaderCompilerCache;
+class ResourceHotReloader;
+class ResourceObject;
+class TextureStreamer;
+class GeometryMemoryPool;
+class MaterialVariantCache;
+class ShaderProgramVariantManifest;
 
 /// @addtogroup resource
 /// @{
 
-/// Manage resources of a certain type
+/// The loading statistics of a resource type.
+class ResourceLoadingStats
+{
+public:
+	U64 m_loadCount = 0;
+	Second m_loadTime = 0.0; ///< The synchronous part of the loads without the resources they load. Summed.
+	Second m_ioTime = 0.0; ///< The part of m_loadTime that was file I/O.
+};
+
+/// Manage resources of a certain type. The resources are indexed by the hash of their filename and the index can be
+/// used by many loading threads at the same time. The filenames are compared as well so resources with the same hash
+/// don't get mixed up.
 template<typename Type>
 class TypeResourceManager
 {
@@ -36,28 +56,126 @@ protected:
 
 	~TypeResourceManager()
 	{
-		ANKI_ASSERT(m_ptrs.isEmpty() && "Forgot to delete some resources");
+		ANKI_ASSERT(m_ptrs.isEmpty() && m_collisions.isEmpty() && "Forgot to delete some resources");
 		m_ptrs.destroy(m_alloc);
+		m_collisions.destroy(m_alloc);
 	}
 
+	/// Find a loaded resource.
+	/// @note Thread-safe. The resource may die right after, use acquireLoadedResource() to keep it alive.
 	Type* findLoadedResource(const CString& filename)
 	{
-		auto it = find(filename);
-		return (it != m_ptrs.end()) ? *it : nullptr;
+		const U64 hash = filename.computeHash();
+		RLockGuard<RWMutex> lock(m_mtx);
+		Type* const* slot = find(hash, filename);
+		return (slot) ? *slot : nullptr;
 	}
 
-	void registerResource(Type* ptr)
+	/// Find a loaded resource and take a reference to it. It skips the resources that are about to be deleted.
+	/// @note Thread-safe.
+	Type* acquireLoadedResource(const CString& filename)
+	{
+		const U64 hash = filename.computeHash();
+		RLockGuard<RWMutex> lock(m_mtx);
+		Type* const* slot = find(hash, filename);
+		return (slot && tryAcquire(*slot)) ? *slot : nullptr;
+	}
+
+	/// Register a newly loaded resource and take a reference to it. If another thread registered the same file in the
+	/// meantime the resource of the other thread is returned (with a reference) and the caller should delete its own.
+	/// @note Thread-safe.
+	Type* registerResource(Type* ptr)
 	{
 		ANKI_ASSERT(ptr->getRefcount().load() == 0);
-		ANKI_ASSERT(find(ptr->getFilename()) == m_ptrs.getEnd());
-		m_ptrs.pushBack(m_alloc, ptr);
+		WLockGuard<RWMutex> lock(m_mtx);
+
+		Type** slot = find(ptr->getFilenameHash(), ptr->getFilename());
+		if(slot)
+		{
+			if(tryAcquire(*slot))
+			{
+				return *slot;
+			}
+
+			// The registered one is about to be deleted. Take its place, its unregisterResource() won't remove this one
+			*slot = ptr;
+		}
+		else if(m_ptrs.find(ptr->getFilenameHash()) != m_ptrs.getEnd())
+		{
+			// Another file has the same hash
+			m_collisions.emplaceBack(m_alloc, ptr);
+		}
+		else
+		{
+			m_ptrs.emplace(m_alloc, ptr->getFilenameHash(), ptr);
+		}
+
+		ptr->getRefcount().fetchAdd(1);
+		return ptr;
 	}
 
+	/// @note Thread-safe.
 	void unregisterResource(Type* ptr)
 	{
-		auto it = find(ptr->getFilename());
-		ANKI_ASSERT(it != m_ptrs.end());
-		m_ptrs.erase(m_alloc, it);
+		WLockGuard<RWMutex> lock(m_mtx);
+
+		auto it = m_ptrs.find(ptr->getFilenameHash());
+		if(it != m_ptrs.getEnd() && *it == ptr)
+		{
+			// Put a resource with the same hash in its place or the lookups won't get to it
+			const U32 collisionIdx = findCollision(ptr->getFilenameHash());
+			if(collisionIdx != MAX_U32)
+			{
+				*it = m_collisions[collisionIdx];
+				eraseCollision(collisionIdx);
+			}
+			else
+			{
+				m_ptrs.erase(m_alloc, it);
+			}
+		}
+		else
+		{
+			for(U32 i = 0; i < m_collisions.getSize(); ++i)
+			{
+				if(m_collisions[i] == ptr)
+				{
+					eraseCollision(i);
+					break;
+				}
+			}
+
+			// Else it was replaced by a reload or by a resource of the same file that got registered while this one was
+			// dying
+		}
+	}
+
+	/// Replace a registered resource with a newer version of it.
+	/// @note Thread-safe.
+	void replaceResource(Type* oldPtr, Type* newPtr)
+	{
+		ANKI_ASSERT(oldPtr->getFilename() == newPtr->getFilename());
+		WLockGuard<RWMutex> lock(m_mtx);
+
+		Type** slot = find(oldPtr->getFilenameHash(), oldPtr->getFilename());
+		ANKI_ASSERT(slot && *slot == oldPtr);
+		*slot = newPtr;
+	}
+
+	/// @note Thread-safe. The func shouldn't register or unregister resources.
+	template<typename TFunc>
+	void iterateResources(TFunc func)
+	{
+		RLockGuard<RWMutex> lock(m_mtx);
+		for(Type* ptr : m_ptrs)
+		{
+			func(ptr);
+		}
+
+		for(Type* ptr : m_collisions)
+		{
+			func(ptr);
+		}
 	}
 
 	void init(ResourceAllocator<U8> alloc)
@@ -65,25 +183,86 @@ protected:
 		m_alloc = alloc;
 	}
 
+	/// @note Thread-safe.
+	void recordLoad(Second loadTime, Second ioTime)
+	{
+		LockGuard<Mutex> lock(m_statsMtx);
+		++m_stats.m_loadCount;
+		m_stats.m_loadTime += loadTime;
+		m_stats.m_ioTime += ioTime;
+	}
+
+	/// @note Thread-safe.
+	ResourceLoadingStats getLoadingStats()
+	{
+		LockGuard<Mutex> lock(m_statsMtx);
+		return m_stats;
+	}
+
 private:
-	using Container = List<Type*>;
+	using Container = HashMap<U64, Type*>; ///< The key is the hash of the filename.
 
 	ResourceAllocator<U8> m_alloc;
 	Container m_ptrs;
+	DynamicArray<Type*> m_collisions; ///< The resources whose hash is taken by another file in m_ptrs.
+	RWMutex m_mtx;
+	Mutex m_statsMtx;
+	ResourceLoadingStats m_stats;
 
-	typename Container::Iterator find(const CString& filename)
+	/// @return The place that holds the resource of the file or nullptr.
+	Type** find(U64 hash, const CString& filename)
 	{
-		typename Container::Iterator it;
+		auto it = m_ptrs.find(hash);
+		if(it == m_ptrs.getEnd())
+		{
+			return nullptr;
+		}
+
+		if((*it)->getFilename() == filename)
+		{
+			return &(*it);
+		}
+
+		// Filename hash collision, it's rare so walk the list
+		for(Type*& ptr : m_collisions)
+		{
+			if(ptr->getFilenameHash() == hash && ptr->getFilename() == filename)
+			{
+				return &ptr;
+			}
+		}
+
+		return nullptr;
+	}
 
-		for(it = m_ptrs.getBegin(); it != m_ptrs.getEnd(); ++it)
+	U32 findCollision(U64 hash) const
+	{
+		for(U32 i = 0; i < m_collisions.getSize(); ++i)
 		{
-			if((*it)->getFilename() == filename)
+			if(m_collisions[i]->getFilenameHash() == hash)
 			{
-				break;
+				return i;
 			}
 		}
 
-		return it;
+		return MAX_U32;
+	}
+
+	void eraseCollision(U32 idx)
+	{
+		m_collisions[idx] = m_collisions.getBack();
+		m_collisions.popBack(m_alloc);
+	}
+
+	/// Increase the refcount if the resource is not dying.
+	static Bool tryAcquire(Type* ptr)
+	{
+		I32 count = ptr->getRefcount().load();
+		while(count > 0 && !ptr->getRefcount().compareExchange(count, count + 1))
+		{
+		}
+
+		return count > 0;
 	}
 };
 
@@ -127,6 +306,19 @@ public:
 	template<typename T>
 	ANKI_USE_RESULT Error loadResource(const CString& filename, ResourcePtr<T>& out, Bool async = true);
 
+	/// Load a texture whose top mips are streamed depending on what the scene needs. If the texture streaming is off or
+	/// the texture is already loaded it's the same as loadResource().
+	ANKI_USE_RESULT Error loadStreamedTexture(const CString& filename, TextureResourcePtr& out, Bool async = true);
+
+	/// Load and evict the mips of the streamed textures and the LODs of the models. It also recycles the geometry
+	/// memory of the freed meshes and makes the shader mutations that finished compiling visible. Call it once per
+	/// frame when nothing renders.
+	void updateStreaming();
+
+	/// Reload the resources whose files changed on disk. It does something only if rsrc_hotReload is enabled. Call it
+	/// once every frame.
+	ANKI_USE_RESULT Error updateHotReloading(Second crntTime);
+
 	// Internals:
 
 	ANKI_INTERNAL U32 getMaxTextureSize() const
@@ -139,6 +331,12 @@ public:
 		return m_dumpShaderSource;
 	}
 
+	/// The skeletons and the animations will upload their data to the GPU.
+	ANKI_INTERNAL Bool getGpuSkinningEnabled() const
+	{
+		return m_gpuSkinning;
+	}
+
 	ANKI_INTERNAL ResourceAllocator<U8>& getAllocator()
 	{
 		return m_alloc;
@@ -184,32 +382,109 @@ public:
 	}
 
 	template<typename T>
-	ANKI_INTERNAL void registerResource(T* ptr)
+	ANKI_INTERNAL void unregisterResource(T* ptr)
 	{
-		TypeResourceManager<T>::registerResource(ptr);
+		TypeResourceManager<T>::unregisterResource(ptr);
 	}
 
-	template<typename T>
-	ANKI_INTERNAL void unregisterResource(T* ptr)
+	/// Iterate the loaded resources of a type. It doesn't visit the resources that got replaced by a reload.
+	template<typename T, typename TFunc>
+	ANKI_INTERNAL void iterateLoadedResources(TFunc func)
 	{
-		TypeResourceManager<T>::unregisterResource(ptr);
+		TypeResourceManager<T>::iterateResources(func);
 	}
 
+	/// Load the file of a resource again and make the new version the one loadResource() returns. The old version stays
+	/// alive for as long as someone holds it. If the loading fails the old version stays in place.
+	template<typename T>
+	ANKI_INTERNAL ANKI_USE_RESULT Error reloadResource(T* oldPtr);
+
 	ANKI_INTERNAL AsyncLoader& getAsyncLoader()
 	{
 		return *m_asyncLoader;
 	}
 
+	ANKI_INTERNAL const TextureStreamer& getTextureStreamer() const
+	{
+		return *m_textureStreamer;
+	}
+
+	ANKI_INTERNAL GeometryMemoryPool& getGeometryMemoryPool()
+	{
+		ANKI_ASSERT(m_geometryPool);
+		return *m_geometryPool;
+	}
+
+	/// nullptr if rsrc_materialVariantCache is empty.
+	ANKI_INTERNAL MaterialVariantCache* getMaterialVariantCache()
+	{
+		return m_materialVariantCache;
+	}
+
+	/// nullptr if rsrc_shaderVariantManifest is empty.
+	ANKI_INTERNAL ShaderProgramVariantManifest* getShaderVariantManifest()
+	{
+		return m_shaderVariantManifest;
+	}
+
+	/// The queue that compiles the shader program mutations in the background. Unlike the AsyncLoader it's never paused
+	/// so a long compilation won't stall the frame. nullptr if rsrc_asyncShaderCompilation is off.
+	ANKI_INTERNAL AsyncLoader* getShaderCompilationQueue()
+	{
+		return m_shaderCompilationQueue;
+	}
+
+	/// A shader program mutation finished compiling. It becomes visible in the next updateStreaming().
+	ANKI_INTERNAL void notifyShaderMutationCompiled()
+	{
+		m_compiledShaderMutationCount.fetchAdd(1);
+	}
+
+	/// The models load only their coarsest LOD and the finer are streamed.
+	ANKI_INTERNAL Bool getMeshLodStreamingEnabled() const
+	{
+		return m_meshLodStreaming;
+	}
+
+	/// The BVHs of the static collision meshes are stored in the cache dir.
+	ANKI_INTERNAL Bool getCookedDescriptorsEnabled() const
+	{
+		return m_cookedDescriptors;
+	}
+
+	ANKI_INTERNAL Bool getCollisionBvhCacheEnabled() const
+	{
+		return m_collisionBvhCache;
+	}
+
+	/// The current thread loads a texture with loadStreamedTexture().
+	ANKI_INTERNAL Bool isLoadingStreamedTexture() const;
+
 	/// Get the number of times loadResource() was called.
 	ANKI_INTERNAL U64 getLoadingRequestCount() const
 	{
-		return m_loadRequestCount;
+		return m_loadRequestCount.load();
 	}
 
 	/// Get the total number of completed async tasks.
 	ANKI_INTERNAL U64 getAsyncTaskCompletedCount() const;
 
+	/// Iterate the loading statistics of the resource types. The func is called as
+	/// func(CString typeName, const ResourceLoadingStats& stats) for every type.
+	template<typename TFunc>
+	ANKI_INTERNAL void iterateLoadingStats(TFunc func)
+	{
+#define ANKI_INSTANTIATE_RESOURCE(rsrc_, ptr_) func(CString(#rsrc_), TypeResourceManager<rsrc_>::getLoadingStats());
+#define ANKI_INSTANSIATE_RESOURCE_DELIMITER()
+#include <anki/resource/InstantiationMacros.h>
+#undef ANKI_INSTANTIATE_RESOURCE
+#undef ANKI_INSTANSIATE_RESOURCE_DELIMITER
+	}
+
 private:
+	/// The meshes of the model LODs that start loading in a frame.
+	static constexpr U32 MAX_MESH_LOD_LOADS_PER_FRAME = 8;
+
 	GrManager* m_gr = nullptr;
 	PhysicsWorld* m_physics = nullptr;
 	ResourceFilesystem* m_fs = nullptr;
@@ -218,10 +493,26 @@ private:
 	String m_cacheDir;
 	U32 m_maxTextureSize;
 	AsyncLoader* m_asyncLoader = nullptr; ///< Async loading thread
-	U64 m_uuid = 0;
-	U64 m_loadRequestCount = 0;
+	AsyncLoader* m_shaderCompilationQueue = nullptr;
+	ResourceHotReloader* m_hotReloader = nullptr;
+	TextureStreamer* m_textureStreamer = nullptr;
+	GeometryMemoryPool* m_geometryPool = nullptr;
+	MaterialVariantCache* m_materialVariantCache = nullptr;
+	ShaderProgramVariantManifest* m_shaderVariantManifest = nullptr;
+	Atomic<U64> m_uuid = {0};
+	Atomic<U64> m_loadRequestCount = {0};
+	Atomic<U32> m_compiledShaderMutationCount = {0};
 	TransferGpuAllocator* m_transferGpuAlloc = nullptr;
 	Bool m_dumpShaderSource = false;
+	Bool m_gpuSkinning = false;
+	Bool m_meshLodStreaming = false;
+	Bool m_collisionBvhCache = false;
+	Bool m_cookedDescriptors = false;
+	U64 m_streamingFrame = 0;
+
+	/// Allocate and load a resource without registering it.
+	template<typename T>
+	ANKI_USE_RESULT Error loadResourceInternal(const CString& filename, Bool async, T*& out);
 };
 /// @}
 
@@ -6,6 +6,7 @@
 #include <anki/resource/ResourceObject.h>
 #include <anki/resource/ResourceManager.h>
 #include <anki/util/Xml.h>
+#include <anki/util/Filesystem.h>
 
 namespace anki
 {
@@ -19,6 +20,7 @@ ResourceObject::ResourceObject(ResourceManager* manager)
 ResourceObject::~ResourceObject()
 {
 	m_fname.destroy(getAllocator());
+	m_dependencies.destroy(getAllocator());
 }
 
 ResourceAllocator<U8> ResourceObject::getAllocator() const
@@ -31,6 +33,20 @@ TempResourceAllocator<U8> ResourceObject::getTempAllocator() const
 	return m_manager->getTempAllocator();
 }
 
+void ResourceObject::addDependency(const CString& filename)
+{
+	const U64 hash = filename.computeHash();
+	for(U64 h : m_dependencies)
+	{
+		if(h == hash)
+		{
+			return;
+		}
+	}
+
+	m_dependencies.emplaceBack(getAllocator(), hash);
+}
+
 Error ResourceObject::openFile(const CString& filename, ResourceFilePtr& file)
 {
 	return m_manager->getFilesystem().openFile(filename, file);
@@ -59,4 +75,61 @@ Error ResourceObject::openFileParseXml(const CString& filename, XmlDocument& xml
 	return Error::NONE;
 }
 
+Bool ResourceObject::getCookedDescriptorsEnabled() const
+{
+	return m_manager->getCookedDescriptorsEnabled();
+}
+
+U64 ResourceObject::computeDescriptorSourceHash(CString text)
+{
+	return (text.isEmpty()) ? 0 : computeHash(text.cstr(), text.getLength());
+}
+
+void ResourceObject::getCookedDescriptorFilename(const ResourceFilename& filename, StringAuto& out) const
+{
+	out.sprintf("%s/%016" PRIx64 ".ankidesc",
+		m_manager->getCacheDirectory().cstr(),
+		computeHash(filename.cstr(), filename.getLength()));
+}
+
+Error ResourceObject::openFileReadCookedDescriptor(
+	const ResourceFilename& filename, StringAuto& text, CookedDescriptorData& data)
+{
+	ANKI_CHECK(openFileReadAllText(filename, text));
+
+	if(!getCookedDescriptorsEnabled())
+	{
+		return Error::NONE;
+	}
+
+	StringAuto cookedFilename(getTempAllocator());
+	getCookedDescriptorFilename(filename, cookedFilename);
+	if(!fileExists(cookedFilename.toCString()))
+	{
+		return Error::NONE;
+	}
+
+	File file;
+	ANKI_CHECK(file.open(cookedFilename.toCString(), FileOpenFlag::READ | FileOpenFlag::BINARY));
+	const PtrSize size = file.getSize();
+	if(size == 0)
+	{
+		return Error::NONE;
+	}
+
+	// Aligned because the descriptor is deserialized in place
+	data.m_data = static_cast<U8*>(data.m_alloc.getMemoryPool().allocate(size, ANKI_SAFE_ALIGNMENT));
+	data.m_size = size;
+	ANKI_CHECK(file.read(data.m_data, size));
+
+	return Error::NONE;
+}
+
+Error ResourceObject::openCookedDescriptorForWriting(const ResourceFilename& filename, File& file)
+{
+	StringAuto cookedFilename(getTempAllocator());
+	getCookedDescriptorFilename(filename, cookedFilename);
+	return file.open(cookedFilename.toCString(), FileOpenFlag::WRITE | FileOpenFlag::BINARY);
+}
+
 } // end namespace anki
@@ -7,8 +7,10 @@
 
 #include <anki/resource/Common.h>
 #include <anki/resource/ResourceFilesystem.h>
+#include <anki/resource/ResourceDescriptorExtra.h>
 #include <anki/util/Atomic.h>
 #include <anki/util/String.h>
+#include <anki/util/WeakArray.h>
 
 namespace anki
 {
@@ -54,12 +56,20 @@ public:
 		return m_fname.toCString();
 	}
 
+	/// Get the hash of the filename. It's computed once when the filename is set.
+	U64 getFilenameHash() const
+	{
+		ANKI_ASSERT(m_fnameHash != 0);
+		return m_fnameHash;
+	}
+
 	// Internals:
 
 	ANKI_INTERNAL void setFilename(const CString& fname)
 	{
 		ANKI_ASSERT(m_fname.isEmpty());
 		m_fname.create(getAllocator(), fname);
+		m_fnameHash = fname.computeHash();
 	}
 
 	ANKI_INTERNAL void setUuid(U64 uuid)
@@ -75,17 +85,109 @@ public:
 		return m_uuid;
 	}
 
+	/// Get the newer version of this resource if the resource was reloaded. The ResourceManager hands out the newer
+	/// version from then on and this one lives until the last ResourcePtr to it is gone.
+	ANKI_INTERNAL ResourceObject* getReplacement() const
+	{
+		return m_replacement;
+	}
+
+	/// Remember that this resource loaded another resource. Used to find what to reload when a file changes.
+	ANKI_INTERNAL void addDependency(const CString& filename);
+
+	/// Get the hashes of the filenames of the resources this one loaded.
+	ANKI_INTERNAL ConstWeakArray<U64> getDependencies() const
+	{
+		return m_dependencies;
+	}
+
 	ANKI_INTERNAL ANKI_USE_RESULT Error openFile(const ResourceFilename& filename, ResourceFilePtr& file);
 
 	ANKI_INTERNAL ANKI_USE_RESULT Error openFileReadAllText(const ResourceFilename& filename, StringAuto& file);
 
 	ANKI_INTERNAL ANKI_USE_RESULT Error openFileParseXml(const ResourceFilename& filename, XmlDocument& xml);
 
+	/// Read the text of an XML file and load its cooked descriptor from the cache directory if it's up to date. If it's
+	/// not the caller should parse the text and write the descriptor with saveCookedDescriptor().
+	/// @param[out] text The text of the XML.
+	/// @param[out] data Holds the memory of the cooked descriptor.
+	/// @param[out] cooked The cooked descriptor or nullptr. It points inside @a data.
+	template<typename T>
+	ANKI_INTERNAL ANKI_USE_RESULT Error openFileLoadCookedDescriptor(
+		const ResourceFilename& filename, CString magic, StringAuto& text, CookedDescriptorData& data, T*& cooked)
+	{
+		cooked = nullptr;
+		ANKI_CHECK(openFileReadCookedDescriptor(filename, text, data));
+		if(data.m_data == nullptr)
+		{
+			return Error::NONE;
+		}
+
+		// A corrupted or outdated descriptor is not an error, it's written again
+		T* desc;
+		if(BinaryDeserializer::validate<T>(ConstWeakArray<U8, PtrSize>(data.m_data, data.m_size))
+			|| BinaryDeserializer::deserializeInPlace(WeakArray<U8, PtrSize>(data.m_data, data.m_size), desc))
+		{
+			return Error::NONE;
+		}
+
+		if(memcmp(magic.cstr(), &desc->m_magic[0], sizeof(desc->m_magic)) == 0
+			&& desc->m_sourceHash == computeDescriptorSourceHash(text))
+		{
+			cooked = desc;
+		}
+
+		return Error::NONE;
+	}
+
+	/// Write the cooked descriptor of an XML file to the cache directory. A failure is not fatal, the XML will be
+	/// parsed again the next time.
+	/// @param text The text of the XML.
+	template<typename T>
+	ANKI_INTERNAL void saveCookedDescriptor(const ResourceFilename& filename, CString magic, CString text, T& desc)
+	{
+		if(!getCookedDescriptorsEnabled())
+		{
+			return;
+		}
+
+		memcpy(&desc.m_magic[0], magic.cstr(), sizeof(desc.m_magic));
+		desc.m_sourceHash = computeDescriptorSourceHash(text);
+
+		File file;
+		Error err = openCookedDescriptorForWriting(filename, file);
+		if(!err)
+		{
+			BinarySerializer serializer;
+			err = serializer.serialize(desc, getTempAllocator(), file);
+		}
+
+		if(err)
+		{
+			ANKI_RESOURCE_LOGW("Failed to write the cooked descriptor of: %s", filename.cstr());
+		}
+	}
+
 private:
 	ResourceManager* m_manager;
 	Atomic<I32> m_refcount;
 	String m_fname; ///< Unique resource name.
+	U64 m_fnameHash = 0;
 	U64 m_uuid = 0;
+	ResourceObject* m_replacement = nullptr; ///< It holds a reference to it.
+	DynamicArray<U64> m_dependencies;
+
+	Bool getCookedDescriptorsEnabled() const;
+
+	static U64 computeDescriptorSourceHash(CString text);
+
+	/// Read the XML text and the cooked descriptor file if there is one.
+	ANKI_USE_RESULT Error openFileReadCookedDescriptor(
+		const ResourceFilename& filename, StringAuto& text, CookedDescriptorData& data);
+
+	ANKI_USE_RESULT Error openCookedDescriptorForWriting(const ResourceFilename& filename, File& file);
+
+	void getCookedDescriptorFilename(const ResourceFilename& filename, StringAuto& out) const;
 };
 /// @}
 
@@ -0,0 +1,267 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/resource/ResourcePack.h>
+#include <anki/util/Functions.h>
+#include <zlib.h>
+#include <algorithm>
+
+namespace anki
+{
+
+static U64 computeFilenameHash(const CString& filename)
+{
+	return computeHash(RESOURCE_PACK_HASH_VERSION, filename.cstr(), filename.getLength());
+}
+
+ResourcePack::~ResourcePack()
+{
+	m_path.destroy(m_alloc);
+	m_files.destroy(m_alloc);
+	m_chunks.destroy(m_alloc);
+	m_filenames.destroy(m_alloc);
+}
+
+Error ResourcePack::load(const CString& filename)
+{
+	m_path.create(m_alloc, filename);
+
+	File file;
+	ANKI_CHECK(file.open(filename, FileOpenFlag::READ | FileOpenFlag::BINARY));
+
+	ResourcePackHeader header;
+	ANKI_CHECK(file.read(&header, sizeof(header)));
+	if(memcmp(&header.m_magic[0], RESOURCE_PACK_MAGIC, sizeof(header.m_magic)) != 0)
+	{
+		ANKI_RESOURCE_LOGE("Wrong magic of resource pack: %s", filename.cstr());
+		return Error::USER_DATA;
+	}
+
+	if(header.m_fileCount == 0 || header.m_chunkSize == 0 || header.m_filenamesSize == 0)
+	{
+		ANKI_RESOURCE_LOGE("Empty or corrupted resource pack: %s", filename.cstr());
+		return Error::USER_DATA;
+	}
+
+	m_chunkSize = header.m_chunkSize;
+
+	if(header.m_chunkCount > 0)
+	{
+		m_chunks.create(m_alloc, header.m_chunkCount);
+		ANKI_CHECK(file.seek(header.m_chunksOffset, FileSeekOrigin::BEGINNING));
+		ANKI_CHECK(file.read(&m_chunks[0], m_chunks.getSizeInBytes()));
+	}
+
+	m_files.create(m_alloc, header.m_fileCount);
+	ANKI_CHECK(file.seek(header.m_filesOffset, FileSeekOrigin::BEGINNING));
+	ANKI_CHECK(file.read(&m_files[0], m_files.getSizeInBytes()));
+
+	m_filenames.create(m_alloc, header.m_filenamesSize);
+	ANKI_CHECK(file.seek(header.m_filenamesOffset, FileSeekOrigin::BEGINNING));
+	ANKI_CHECK(file.read(&m_filenames[0], m_filenames.getSizeInBytes()));
+
+	// Validate the table of contents so the lookups don't need to
+	for(const ResourcePackFileInfo& f : m_files)
+	{
+		const U32 chunkCount = U32((f.m_size + m_chunkSize - 1) / m_chunkSize);
+		const Bool badName = f.m_filenameOffset + f.m_filenameLength >= header.m_filenamesSize
+							 || m_filenames[f.m_filenameOffset + f.m_filenameLength] != '\0';
+		const Bool badChunks =
+			f.m_compression == ResourcePackCompression::ZLIB && f.m_firstChunk + chunkCount > header.m_chunkCount;
+		const Bool badCompression = f.m_compression != ResourcePackCompression::NONE
+									&& f.m_compression != ResourcePackCompression::ZLIB;
+		if(badName || badChunks || badCompression)
+		{
+			ANKI_RESOURCE_LOGE("Corrupted table of contents of resource pack: %s", filename.cstr());
+			return Error::USER_DATA;
+		}
+	}
+
+	return Error::NONE;
+}
+
+const ResourcePackFileInfo* ResourcePack::findFile(const CString& filename) const
+{
+	const U64 hash = computeFilenameHash(filename);
+
+	const ResourcePackFileInfo* it = std::lower_bound(m_files.getBegin(),
+		m_files.getEnd(),
+		hash,
+		[](const ResourcePackFileInfo& f, U64 hash) { return f.m_filenameHash < hash; });
+
+	for(; it != m_files.getEnd() && it->m_filenameHash == hash; ++it)
+	{
+		if(getFilename(*it) == filename)
+		{
+			return it;
+		}
+	}
+
+	return nullptr;
+}
+
+Error ResourcePack::decompress(ConstWeakArray<U8> src, WeakArray<U8> dst)
+{
+	uLongf dstSize = dst.getSize();
+	const int res = uncompress(&dst[0], &dstSize, &src[0], src.getSize());
+	if(res != Z_OK || dstSize != dst.getSize())
+	{
+		ANKI_RESOURCE_LOGE("Failed to decompress a chunk of a resource pack");
+		return Error::FUNCTION_FAILED;
+	}
+
+	return Error::NONE;
+}
+
+ResourcePackWriter::~ResourcePackWriter()
+{
+	m_files.destroy(m_alloc);
+	m_chunks.destroy(m_alloc);
+	m_filenames.destroy(m_alloc);
+}
+
+Error ResourcePackWriter::begin(const CString& filename, U32 chunkSize)
+{
+	ANKI_ASSERT(chunkSize > 0);
+	m_chunkSize = chunkSize;
+	ANKI_CHECK(m_file.open(filename, FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+
+	// The header is written at the end
+	ResourcePackHeader header = {};
+	ANKI_CHECK(write(&header, sizeof(header)));
+
+	return Error::NONE;
+}
+
+Error ResourcePackWriter::write(const void* data, PtrSize size)
+{
+	ANKI_CHECK(m_file.write(data, size));
+	m_offset += size;
+	return Error::NONE;
+}
+
+Error ResourcePackWriter::pad(U32 alignment)
+{
+	static const Array<U8, 64> zeros = {};
+	PtrSize padding = getAlignedRoundUp(alignment, m_offset) - m_offset;
+	while(padding)
+	{
+		const PtrSize size = min<PtrSize>(padding, zeros.getSize());
+		ANKI_CHECK(write(&zeros[0], size));
+		padding -= size;
+	}
+
+	return Error::NONE;
+}
+
+Error ResourcePackWriter::addFile(const CString& filename, ConstWeakArray<U8, PtrSize> data, Bool compress)
+{
+	ResourcePackFileInfo& info = *m_files.emplaceBack(m_alloc);
+	info.m_filenameHash = computeFilenameHash(filename);
+	info.m_offset = 0;
+	info.m_size = data.getSize();
+	info.m_filenameOffset = m_filenames.getSize();
+	info.m_filenameLength = filename.getLength();
+	info.m_compression = ResourcePackCompression::NONE;
+	info.m_firstChunk = 0;
+
+	m_filenames.resize(m_alloc, info.m_filenameOffset + info.m_filenameLength + 1);
+	memcpy(&m_filenames[info.m_filenameOffset], filename.cstr(), info.m_filenameLength + 1);
+
+	// Compress all the chunks in memory first to see if it's worth it
+	DynamicArrayAuto<U8, PtrSize> compressed(m_alloc);
+	DynamicArrayAuto<ResourcePackChunk> chunks(m_alloc);
+	if(compress && data.getSize() > 0)
+	{
+		compressed.create(compressBound(uLong(m_chunkSize)) * ((data.getSize() + m_chunkSize - 1) / m_chunkSize));
+
+		PtrSize compressedSize = 0;
+		for(PtrSize offset = 0; offset < data.getSize(); offset += m_chunkSize)
+		{
+			const PtrSize size = min<PtrSize>(m_chunkSize, data.getSize() - offset);
+			uLongf chunkCompressedSize = uLongf(compressed.getSize() - compressedSize);
+			if(compress2(&compressed[compressedSize], &chunkCompressedSize, &data[offset], uLong(size), 9) != Z_OK)
+			{
+				ANKI_RESOURCE_LOGE("Failed to compress: %s", filename.cstr());
+				return Error::FUNCTION_FAILED;
+			}
+
+			ResourcePackChunk& chunk = *chunks.emplaceBack();
+			chunk.m_offset = compressedSize;
+			chunk.m_compressedSize = U32(chunkCompressedSize);
+			chunk.m_padding = 0;
+			compressedSize += chunkCompressedSize;
+		}
+
+		// Not worth the decompression if it saves less than 10%
+		if(compressedSize * 10 < data.getSize() * 9)
+		{
+			info.m_compression = ResourcePackCompression::ZLIB;
+			info.m_firstChunk = m_chunks.getSize();
+
+			for(ResourcePackChunk& chunk : chunks)
+			{
+				chunk.m_offset += m_offset;
+				m_chunks.emplaceBack(m_alloc, chunk);
+			}
+
+			ANKI_CHECK(write(&compressed[0], compressedSize));
+		}
+	}
+
+	if(info.m_compression == ResourcePackCompression::NONE)
+	{
+		ANKI_CHECK(pad(RESOURCE_PACK_FILE_ALIGNMENT));
+		info.m_offset = m_offset;
+		if(data.getSize() > 0)
+		{
+			ANKI_CHECK(write(&data[0], data.getSize()));
+		}
+	}
+
+	return Error::NONE;
+}
+
+Error ResourcePackWriter::end()
+{
+	if(m_files.getSize() == 0)
+	{
+		ANKI_RESOURCE_LOGE("Can't write an empty resource pack");
+		return Error::USER_DATA;
+	}
+
+	// Sort the files by hash for the binary search
+	std::sort(m_files.getBegin(), m_files.getEnd(), [](const ResourcePackFileInfo& a, const ResourcePackFileInfo& b) {
+		return a.m_filenameHash < b.m_filenameHash;
+	});
+
+	ResourcePackHeader header;
+	memcpy(&header.m_magic[0], RESOURCE_PACK_MAGIC, sizeof(header.m_magic));
+	header.m_fileCount = m_files.getSize();
+	header.m_chunkCount = m_chunks.getSize();
+	header.m_chunkSize = m_chunkSize;
+	header.m_filenamesSize = m_filenames.getSize();
+
+	ANKI_CHECK(pad(alignof(ResourcePackChunk)));
+	header.m_chunksOffset = m_offset;
+	if(m_chunks.getSize() > 0)
+	{
+		ANKI_CHECK(write(&m_chunks[0], m_chunks.getSizeInBytes()));
+	}
+
+	header.m_filesOffset = m_offset;
+	ANKI_CHECK(write(&m_files[0], m_files.getSizeInBytes()));
+
+	header.m_filenamesOffset = m_offset;
+	ANKI_CHECK(write(&m_filenames[0], m_filenames.getSizeInBytes()));
+
+	ANKI_CHECK(m_file.seek(0, FileSeekOrigin::BEGINNING));
+	ANKI_CHECK(m_file.write(&header, sizeof(header)));
+	m_file.close();
+
+	return Error::NONE;
+}
+
+} // end namespace anki
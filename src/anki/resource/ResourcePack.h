@@ -0,0 +1,178 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/resource/Common.h>
+#include <anki/util/File.h>
+#include <anki/util/DynamicArray.h>
+#include <anki/util/String.h>
+#include <anki/util/Hash.h>
+
+namespace anki
+{
+
+/// @addtogroup resource
+/// @{
+
+/// The first bytes of a resource pack.
+constexpr const char* RESOURCE_PACK_MAGIC = "ANKIPAK1";
+
+/// The hash of the filenames in the table of contents. It's fixed so the packs don't change when HashVersion::LATEST
+/// does.
+constexpr HashVersion RESOURCE_PACK_HASH_VERSION = HashVersion::XXH3;
+
+/// The uncompressed files start at multiples of that so they can be mapped and read straight from the pack.
+constexpr U32 RESOURCE_PACK_FILE_ALIGNMENT = 4_KB;
+
+/// The default size of the chunks that are compressed separately.
+constexpr U32 RESOURCE_PACK_DEFAULT_CHUNK_SIZE = 64_KB;
+
+/// How a file is stored in the pack.
+enum class ResourcePackCompression : U32
+{
+	NONE, ///< The file is in one piece.
+	ZLIB ///< The file is split in chunks that are compressed separately.
+};
+
+/// The header of the pack.
+///
+/// The layout of the file:
+/// - ResourcePackHeader
+/// - The files. The uncompressed start at RESOURCE_PACK_FILE_ALIGNMENT and the compressed are a list of chunks
+/// - ResourcePackChunk array
+/// - ResourcePackFileInfo array, sorted by the filename hash
+/// - The filenames
+class ResourcePackHeader
+{
+public:
+	Array<char, 8> m_magic;
+	U32 m_fileCount;
+	U32 m_chunkCount;
+	U32 m_chunkSize; ///< The uncompressed size of the chunks. The last chunk of a file can be smaller.
+	U32 m_filenamesSize;
+	U64 m_chunksOffset;
+	U64 m_filesOffset;
+	U64 m_filenamesOffset;
+};
+
+/// An entry of the table of contents.
+class ResourcePackFileInfo
+{
+public:
+	U64 m_filenameHash;
+	U64 m_offset; ///< Where an uncompressed file starts.
+	U64 m_size; ///< The uncompressed size.
+	U32 m_filenameOffset; ///< From the beginning of the filenames.
+	U32 m_filenameLength;
+	ResourcePackCompression m_compression;
+	U32 m_firstChunk; ///< The chunks of a compressed file are consecutive.
+};
+
+/// A compressed chunk of a file.
+class ResourcePackChunk
+{
+public:
+	U64 m_offset;
+	U32 m_compressedSize;
+	U32 m_padding;
+};
+
+/// The table of contents of a pack. It's loaded once and then it finds the files without touching the disk.
+class ResourcePack : public NonCopyable
+{
+public:
+	ResourcePack(GenericMemoryPoolAllocator<U8> alloc)
+		: m_alloc(alloc)
+	{
+	}
+
+	~ResourcePack();
+
+	ANKI_USE_RESULT Error load(const CString& filename);
+
+	/// Find a file. It's a binary search on the filename hashes.
+	/// @return nullptr if the file is not there.
+	const ResourcePackFileInfo* findFile(const CString& filename) const;
+
+	ConstWeakArray<ResourcePackFileInfo> getFiles() const
+	{
+		return ConstWeakArray<ResourcePackFileInfo>(m_files);
+	}
+
+	CString getFilename(const ResourcePackFileInfo& file) const
+	{
+		return CString(&m_filenames[file.m_filenameOffset]);
+	}
+
+	const ResourcePackChunk& getChunk(U32 idx) const
+	{
+		return m_chunks[idx];
+	}
+
+	U32 getChunkSize() const
+	{
+		return m_chunkSize;
+	}
+
+	/// The filename of the pack.
+	CString getPath() const
+	{
+		return m_path.toCString();
+	}
+
+	/// Decompress a chunk.
+	/// @param[in] src The compressed data.
+	/// @param[out] dst Where to write it. Its size is the uncompressed size.
+	static ANKI_USE_RESULT Error decompress(ConstWeakArray<U8> src, WeakArray<U8> dst);
+
+private:
+	GenericMemoryPoolAllocator<U8> m_alloc;
+	String m_path;
+	DynamicArray<ResourcePackFileInfo> m_files;
+	DynamicArray<ResourcePackChunk> m_chunks;
+	DynamicArray<char> m_filenames; ///< Null terminated strings.
+	U32 m_chunkSize = 0;
+};
+
+/// Writes resource packs.
+class ResourcePackWriter : public NonCopyable
+{
+public:
+	ResourcePackWriter(GenericMemoryPoolAllocator<U8> alloc)
+		: m_alloc(alloc)
+	{
+	}
+
+	~ResourcePackWriter();
+
+	/// Create the file.
+	ANKI_USE_RESULT Error begin(const CString& filename, U32 chunkSize = RESOURCE_PACK_DEFAULT_CHUNK_SIZE);
+
+	/// Append a file.
+	/// @param filename The name that the file has in the pack.
+	/// @param data The contents of the file.
+	/// @param compress Try to compress the file. It's stored uncompressed if the compression doesn't save enough.
+	ANKI_USE_RESULT Error addFile(const CString& filename, ConstWeakArray<U8, PtrSize> data, Bool compress);
+
+	/// Write the table of contents and close the file.
+	ANKI_USE_RESULT Error end();
+
+private:
+	GenericMemoryPoolAllocator<U8> m_alloc;
+	File m_file;
+	PtrSize m_offset = 0;
+	U32 m_chunkSize = 0;
+	DynamicArray<ResourcePackFileInfo> m_files;
+	DynamicArray<ResourcePackChunk> m_chunks;
+	DynamicArray<char> m_filenames;
+
+	ANKI_USE_RESULT Error write(const void* data, PtrSize size);
+
+	ANKI_USE_RESULT Error pad(U32 alignment);
+};
+/// @}
+
+} // end namespace anki
@@ -5,6 +5,9 @@
 
 #include <anki/resource/ShaderProgramResource.h>
 #include <anki/resource/ResourceManager.h>
+#include <anki/resource/ResourceFilesystem.h>
+#include <anki/resource/ShaderProgramVariantManifest.h>
+#include <anki/resource/AsyncLoader.h>
 #include <anki/gr/ShaderProgram.h>
 #include <anki/gr/GrManager.h>
 #include <anki/util/Filesystem.h>
@@ -21,6 +24,160 @@ ShaderProgramResourceVariant::~ShaderProgramResourceVariant()
 {
 }
 
+template<typename TArray>
+static U32 findByName(const TArray& arr, CString name)
+{
+	for(U32 i = 0; i < arr.getSize(); ++i)
+	{
+		if(name == &arr[i].m_name[0])
+		{
+			return i;
+		}
+	}
+
+	return MAX_U32;
+}
+
+static Error remapBlockInstance(const ShaderProgramBinaryBlock& from,
+	const ShaderProgramBinaryBlock& to,
+	ShaderProgramBinaryBlockInstance& instance)
+{
+	for(ShaderProgramBinaryVariableInstance& var : instance.m_variables)
+	{
+		const CString name = &from.m_variables[var.m_index].m_name[0];
+		var.m_index = findByName(to.m_variables, name);
+		if(var.m_index == MAX_U32)
+		{
+			ANKI_RESOURCE_LOGE("The variable %s of the block %s is not in the program", name.cstr(), &to.m_name[0]);
+			return Error::USER_DATA;
+		}
+	}
+
+	return Error::NONE;
+}
+
+static Error remapBlockInstances(ConstWeakArray<ShaderProgramBinaryBlock> from,
+	ConstWeakArray<ShaderProgramBinaryBlock> to,
+	WeakArray<ShaderProgramBinaryBlockInstance> instances)
+{
+	for(ShaderProgramBinaryBlockInstance& instance : instances)
+	{
+		const ShaderProgramBinaryBlock& fromBlock = from[instance.m_index];
+		instance.m_index = findByName(to, &fromBlock.m_name[0]);
+		if(instance.m_index == MAX_U32)
+		{
+			ANKI_RESOURCE_LOGE("The block %s is not in the program", &fromBlock.m_name[0]);
+			return Error::USER_DATA;
+		}
+
+		ANKI_CHECK(remapBlockInstance(fromBlock, to[instance.m_index], instance));
+	}
+
+	return Error::NONE;
+}
+
+/// A variant that was compiled on its own points to the blocks, opaques and constants of its own binary. Make it point
+/// to the ones of the program's binary that the users of the program know.
+static Error remapVariant(
+	const ShaderProgramBinary& from, const ShaderProgramBinary& to, ShaderProgramBinaryVariant& variant)
+{
+	ANKI_CHECK(remapBlockInstances(from.m_uniformBlocks, to.m_uniformBlocks, variant.m_uniformBlocks));
+	ANKI_CHECK(remapBlockInstances(from.m_storageBlocks, to.m_storageBlocks, variant.m_storageBlocks));
+
+	if(variant.m_pushConstantBlock)
+	{
+		if(!to.m_pushConstantBlock)
+		{
+			ANKI_RESOURCE_LOGE("The push constants are not in the program");
+			return Error::USER_DATA;
+		}
+
+		ANKI_CHECK(
+			remapBlockInstance(*from.m_pushConstantBlock, *to.m_pushConstantBlock, *variant.m_pushConstantBlock));
+	}
+
+	for(ShaderProgramBinaryOpaqueInstance& instance : variant.m_opaques)
+	{
+		const CString name = &from.m_opaques[instance.m_index].m_name[0];
+		instance.m_index = findByName(to.m_opaques, name);
+		if(instance.m_index == MAX_U32)
+		{
+			ANKI_RESOURCE_LOGE("The opaque %s is not in the program", name.cstr());
+			return Error::USER_DATA;
+		}
+	}
+
+	for(ShaderProgramBinaryConstantInstance& instance : variant.m_constants)
+	{
+		const CString name = &from.m_constants[instance.m_index].m_name[0];
+		instance.m_index = findByName(to.m_constants, name);
+		if(instance.m_index == MAX_U32)
+		{
+			ANKI_RESOURCE_LOGE("The constant %s is not in the program", name.cstr());
+			return Error::USER_DATA;
+		}
+	}
+
+	for(U32& constIdx : variant.m_workgroupSizesConstants)
+	{
+		if(constIdx != MAX_U32)
+		{
+			constIdx = findByName(to.m_constants, &from.m_constants[constIdx].m_name[0]);
+			ANKI_ASSERT(constIdx != MAX_U32 && "The constant would have been found above");
+		}
+	}
+
+	return Error::NONE;
+}
+
+static const ShaderProgramBinaryVariant* findMutation(const ShaderProgramBinary& binary, U64 mutationHash)
+{
+	// TODO optimize the search
+	for(const ShaderProgramBinaryMutation& mutation : binary.m_mutations)
+	{
+		if(mutation.m_hash == mutationHash)
+		{
+			return &binary.m_variants[mutation.m_variantIndex];
+		}
+	}
+
+	return nullptr;
+}
+
+/// Compiles a mutation in the background and hands it to the program.
+class ShaderProgramResource::CompileMutationTask : public AsyncLoaderTask
+{
+public:
+	const ShaderProgramResource* m_prog;
+	U64 m_mutationHash;
+
+	CompileMutationTask(const ShaderProgramResource* prog, U64 mutationHash)
+		: m_prog(prog)
+		, m_mutationHash(mutationHash)
+	{
+	}
+
+	Error operator()(AsyncLoaderTaskContext& ctx) final
+	{
+		ShaderProgramBinaryWrapper* binary;
+		const ShaderProgramBinaryVariant* variant;
+		if(m_prog->compileMutation(m_mutationHash, binary, variant))
+		{
+			ANKI_RESOURCE_LOGF("Failed to compile a mutation of %s", m_prog->getFilename().cstr());
+		}
+
+		{
+			WLockGuard<RWMutex> lock(m_prog->m_mtx);
+			CompiledMutation& compiled = *m_prog->m_compiledMutations.emplaceBack(m_prog->getAllocator());
+			compiled.m_hash = m_mutationHash;
+			compiled.m_binary = binary;
+		}
+
+		m_prog->getManager().notifyShaderMutationCompiled();
+		return Error::NONE;
+	}
+};
+
 ShaderProgramResource::ShaderProgramResource(ResourceManager* manager)
 	: ResourceObject(manager)
 	, m_binary(getAllocator())
@@ -29,6 +186,12 @@ ShaderProgramResource::ShaderProgramResource(ResourceManager* manager)
 
 ShaderProgramResource::~ShaderProgramResource()
 {
+	AsyncLoader* compilationQueue = getManager().getShaderCompilationQueue();
+	if(compilationQueue)
+	{
+		compilationQueue->cancelTasks(this);
+	}
+
 	m_mutators.destroy(getAllocator());
 
 	for(ShaderProgramResourceConstant& c : m_consts)
@@ -44,6 +207,22 @@ ShaderProgramResource::~ShaderProgramResource()
 		getAllocator().deleteInstance(variant);
 	}
 	m_variants.destroy(getAllocator());
+	m_shaders.destroy(getAllocator());
+
+	for(ShaderProgramBinaryWrapper* binary : m_onDemandBinaries)
+	{
+		if(binary)
+		{
+			getAllocator().deleteInstance(binary);
+		}
+	}
+	m_onDemandBinaries.destroy(getAllocator());
+
+	for(CompiledMutation& compiled : m_compiledMutations)
+	{
+		getAllocator().deleteInstance(compiled.m_binary);
+	}
+	m_compiledMutations.destroy(getAllocator());
 }
 
 Error ShaderProgramResource::load(const ResourceFilename& filename, Bool async)
@@ -195,6 +374,19 @@ Error ShaderProgramResource::parseConst(CString constName, U32& componentIdx, U3
 
 void ShaderProgramResource::getOrCreateVariant(
 	const ShaderProgramResourceVariantInitInfo& info, const ShaderProgramResourceVariant*& variant) const
+{
+	getOrCreateVariantInternal(info, false, variant);
+	ANKI_ASSERT(variant);
+}
+
+void ShaderProgramResource::tryGetOrCreateVariant(
+	const ShaderProgramResourceVariantInitInfo& info, const ShaderProgramResourceVariant*& variant) const
+{
+	getOrCreateVariantInternal(info, true, variant);
+}
+
+void ShaderProgramResource::getOrCreateVariantInternal(
+	const ShaderProgramResourceVariantInitInfo& info, Bool async, const ShaderProgramResourceVariant*& variant) const
 {
 	// Sanity checks
 	ANKI_ASSERT(info.m_setMutators.getEnabledBitCount() == m_mutators.getSize());
@@ -239,48 +431,108 @@ void ShaderProgramResource::getOrCreateVariant(
 		return;
 	}
 
+	const ShaderProgramBinary* codeBinary;
+	const ShaderProgramBinaryVariant* binaryVariant;
+	if(!getOrCompileBinaryVariant(info, async, codeBinary, binaryVariant))
+	{
+		// Compiles in the background
+		return;
+	}
+
 	// Create
 	ShaderProgramResourceVariant* v = getAllocator().newInstance<ShaderProgramResourceVariant>();
-	initVariant(info, *v);
+	initVariant(info, *codeBinary, *binaryVariant, *v);
 	m_variants.emplace(getAllocator(), hash, v);
 	variant = v;
 }
 
-void ShaderProgramResource::initVariant(
-	const ShaderProgramResourceVariantInitInfo& info, ShaderProgramResourceVariant& variant) const
+Bool ShaderProgramResource::getOrCompileBinaryVariant(const ShaderProgramResourceVariantInitInfo& info,
+	Bool async,
+	const ShaderProgramBinary*& codeBinary,
+	const ShaderProgramBinaryVariant*& binaryVariant) const
 {
 	const ShaderProgramBinary& binary = m_binary.getBinary();
+	codeBinary = &binary;
 
-	// Get the binary program variant
-	const ShaderProgramBinaryVariant* binaryVariant = nullptr;
-	if(m_mutators.getSize())
+	if(m_mutators.getSize() == 0)
 	{
-		// Create the mutation hash
-		const U64 hash = computeHash(info.m_mutation.getBegin(), m_mutators.getSize() * sizeof(info.m_mutation[0]));
+		ANKI_ASSERT(binary.m_variants.getSize() == 1);
+		binaryVariant = &binary.m_variants[0];
+		return true;
+	}
 
-		// Search for the mutation in the binary
-		// TODO optimize the search
-		for(const ShaderProgramBinaryMutation& mutation : binary.m_mutations)
+	// Create the mutation hash
+	const U64 hash = computeHash(
+		HashVersion::MURMUR2, info.m_mutation.getBegin(), m_mutators.getSize() * sizeof(info.m_mutation[0]));
+
+	// Search for the mutation in the binary and then in the ones that got compiled on demand
+	binaryVariant = findMutation(binary, hash);
+	if(binaryVariant == nullptr)
+	{
+		auto it = m_onDemandBinaries.find(hash);
+		AsyncLoader* compilationQueue = getManager().getShaderCompilationQueue();
+		if(it != m_onDemandBinaries.getEnd() && *it != nullptr)
+		{
+			codeBinary = &(*it)->getBinary();
+			binaryVariant = findMutation(*codeBinary, hash);
+		}
+		else if(async && compilationQueue)
 		{
-			if(mutation.m_hash == hash)
+			if(it == m_onDemandBinaries.getEnd())
 			{
-				binaryVariant = &binary.m_variants[mutation.m_variantIndex];
-				break;
+				m_onDemandBinaries.emplace(getAllocator(), hash, nullptr);
+
+				CompileMutationTask* task = compilationQueue->newTask<CompileMutationTask>(this, hash);
+				task->setOwner(this);
+				compilationQueue->submitTask(task);
 			}
+
+			return false;
+		}
+		else
+		{
+			// Compile it now. If it compiles in the background as well the result of the background is dropped
+			ShaderProgramBinaryWrapper* newBinary;
+			if(compileMutation(hash, newBinary, binaryVariant))
+			{
+				ANKI_RESOURCE_LOGF("Failed to compile a mutation of %s", getFilename().cstr());
+			}
+
+			if(it != m_onDemandBinaries.getEnd())
+			{
+				*it = newBinary;
+			}
+			else
+			{
+				m_onDemandBinaries.emplace(getAllocator(), hash, newBinary);
+			}
+
+			codeBinary = &newBinary->getBinary();
 		}
 	}
-	else
+	ANKI_ASSERT(binaryVariant);
+
+	ShaderProgramVariantManifest* manifest = getManager().getShaderVariantManifest();
+	if(manifest)
 	{
-		ANKI_ASSERT(binary.m_variants.getSize() == 1);
-		binaryVariant = &binary.m_variants[0];
+		manifest->addMutation(getFilenameHash(), hash);
 	}
-	ANKI_ASSERT(binaryVariant);
-	variant.m_binaryVariant = binaryVariant;
+
+	return true;
+}
+
+void ShaderProgramResource::initVariant(const ShaderProgramResourceVariantInitInfo& info,
+	const ShaderProgramBinary& codeBinary,
+	const ShaderProgramBinaryVariant& binaryVariant,
+	ShaderProgramResourceVariant& variant) const
+{
+	const ShaderProgramBinary& binary = m_binary.getBinary();
+	variant.m_binaryVariant = &binaryVariant;
 
 	// Set the constannt values
 	Array<ShaderSpecializationConstValue, 64> constValues;
 	U32 constValueCount = 0;
-	for(const ShaderProgramBinaryConstantInstance& instance : binaryVariant->m_constants)
+	for(const ShaderProgramBinaryConstantInstance& instance : binaryVariant.m_constants)
 	{
 		const ShaderProgramBinaryConstant& c = binary.m_constants[instance.m_index];
 		const U32 inputIdx = m_constBinaryMapping[instance.m_index].m_constsIdx;
@@ -309,18 +561,18 @@ void ShaderProgramResource::initVariant(
 	{
 		for(U32 i = 0; i < 3; ++i)
 		{
-			if(binaryVariant->m_workgroupSizes[i] != MAX_U32)
+			if(binaryVariant.m_workgroupSizes[i] != MAX_U32)
 			{
 				// Size didn't come from specialization const
-				variant.m_workgroupSizes[i] = binaryVariant->m_workgroupSizes[i];
+				variant.m_workgroupSizes[i] = binaryVariant.m_workgroupSizes[i];
 			}
 			else
 			{
 				// Size is specialization const
 
-				ANKI_ASSERT(binaryVariant->m_workgroupSizesConstants[i] != MAX_U32);
+				ANKI_ASSERT(binaryVariant.m_workgroupSizesConstants[i] != MAX_U32);
 
-				const U32 binaryConstIdx = binaryVariant->m_workgroupSizesConstants[i];
+				const U32 binaryConstIdx = binaryVariant.m_workgroupSizesConstants[i];
 				const U32 constIdx = m_constBinaryMapping[binaryConstIdx].m_constsIdx;
 				const U32 component = m_constBinaryMapping[binaryConstIdx].m_component;
 				const Const& c = m_consts[constIdx];
@@ -365,16 +617,132 @@ void ShaderProgramResource::initVariant(
 			continue;
 		}
 
+		// Many variants have the same code for some stages so reuse the shader if it's created
+		const ShaderProgramBinaryCodeBlock* codeBlock =
+			&codeBinary.m_codeBlocks[binaryVariant.m_codeBlockIndices[shaderType]];
+		U64 shaderHash = computeHash(&codeBlock, sizeof(codeBlock));
+		if(constValueCount)
+		{
+			shaderHash = appendHash(constValues.getBegin(), constValueCount * sizeof(constValues[0]), shaderHash);
+		}
+
+		auto it = m_shaders.find(shaderHash);
+		if(it != m_shaders.getEnd())
+		{
+			progInf.m_shaders[shaderType] = *it;
+			continue;
+		}
+
 		ShaderInitInfo inf(cprogName);
 		inf.m_shaderType = shaderType;
-		inf.m_binary = binary.m_codeBlocks[binaryVariant->m_codeBlockIndices[shaderType]].m_binary;
+		inf.m_binary = codeBlock->m_binary;
 		inf.m_constValues.setArray((constValueCount) ? constValues.getBegin() : nullptr, constValueCount);
 
 		progInf.m_shaders[shaderType] = getManager().getGrManager().newShader(inf);
+		m_shaders.emplace(getAllocator(), shaderHash, progInf.m_shaders[shaderType]);
 	}
 
 	// Create the program
 	variant.m_prog = getManager().getGrManager().newShaderProgram(progInf);
 }
 
+Error ShaderProgramResource::compileMutation(
+	U64 mutationHash, ShaderProgramBinaryWrapper*& binary, const ShaderProgramBinaryVariant*& variant) const
+{
+	ANKI_RESOURCE_LOGW("Compiling a mutation of %s that is not in the shader variant manifest", getFilename().cstr());
+
+	class FSystem : public ShaderProgramFilesystemInterface
+	{
+	public:
+		ResourceFilesystem* m_fsystem = nullptr;
+
+		Error readAllText(CString filename, StringAuto& txt) final
+		{
+			ResourceFilePtr file;
+			ANKI_CHECK(m_fsystem->openFile(filename, file));
+			ANKI_CHECK(file->readAllText(txt));
+			return Error::NONE;
+		}
+	} fsystem;
+	fsystem.m_fsystem = &getManager().getFilesystem();
+
+	class OneMutation : public ShaderProgramPostParseInterface
+	{
+	public:
+		U64 m_mutationHash = 0;
+
+		Bool skipCompilation(U64 programHash) final
+		{
+			return false;
+		}
+
+		Bool skipMutation(U64 mutationHash) final
+		{
+			return mutationHash != m_mutationHash;
+		}
+	} oneMutation;
+	oneMutation.m_mutationHash = mutationHash;
+
+	ShaderProgramBinaryWrapper* newBinaryW = getAllocator().newInstance<ShaderProgramBinaryWrapper>(getAllocator());
+
+	GrManager& gr = getManager().getGrManager();
+	Error err = compileShaderProgram(getFilename(),
+		fsystem,
+		&oneMutation,
+		nullptr,
+		nullptr,
+		getAllocator(),
+		gr.getDeviceCapabilities(),
+		gr.getBindlessLimits(),
+		*newBinaryW);
+
+	ShaderProgramBinaryVariant* newVariant = nullptr;
+	if(!err)
+	{
+		ShaderProgramBinary& newBinary = newBinaryW->getBinary();
+		newVariant = const_cast<ShaderProgramBinaryVariant*>(findMutation(newBinary, mutationHash));
+		if(newVariant == nullptr)
+		{
+			ANKI_RESOURCE_LOGE("The mutation is not in the compiled binary");
+			err = Error::USER_DATA;
+		}
+		else
+		{
+			err = remapVariant(newBinary, m_binary.getBinary(), *newVariant);
+		}
+	}
+
+	if(err)
+	{
+		getAllocator().deleteInstance(newBinaryW);
+		return err;
+	}
+
+	binary = newBinaryW;
+	variant = newVariant;
+	return Error::NONE;
+}
+
+void ShaderProgramResource::publishCompiledMutations()
+{
+	WLockGuard<RWMutex> lock(m_mtx);
+
+	for(CompiledMutation& compiled : m_compiledMutations)
+	{
+		auto it = m_onDemandBinaries.find(compiled.m_hash);
+		ANKI_ASSERT(it != m_onDemandBinaries.getEnd());
+		if(*it == nullptr)
+		{
+			*it = compiled.m_binary;
+		}
+		else
+		{
+			// Got compiled synchronously in the meantime
+			getAllocator().deleteInstance(compiled.m_binary);
+		}
+	}
+
+	m_compiledMutations.destroy(getAllocator());
+}
+
 } // end namespace anki
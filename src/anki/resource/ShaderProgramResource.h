@@ -11,7 +11,7 @@
 #include <anki/gr/ShaderProgram.h>
 #include <anki/util/BitSet.h>
 #include <anki/util/String.h>
-#include <anki/util/HashMap.h>
+#include <anki/util/FlatHashMap.h>
 #include <anki/util/WeakArray.h>
 #include <anki/Math.h>
 
@@ -235,10 +235,30 @@ public:
 		getOrCreateVariant(ShaderProgramResourceVariantInitInfo(), variant);
 	}
 
+	/// Same as getOrCreateVariant() but if the mutation is not in the binary it's compiled in the background and the
+	/// variant is nullptr until it's ready. Ask again in the next frames. It blocks like getOrCreateVariant() if
+	/// rsrc_asyncShaderCompilation is off.
+	/// @note It's thread-safe.
+	void tryGetOrCreateVariant(
+		const ShaderProgramResourceVariantInitInfo& info, const ShaderProgramResourceVariant*& variant) const;
+
+	/// Make the mutations that finished compiling in the background visible to tryGetOrCreateVariant().
+	ANKI_INTERNAL void publishCompiledMutations();
+
 private:
 	using Mutator = ShaderProgramResourceMutator;
 	using Const = ShaderProgramResourceConstant;
 
+	class CompileMutationTask;
+
+	/// A mutation that finished compiling in the background and it's not published yet.
+	class CompiledMutation
+	{
+	public:
+		U64 m_hash;
+		ShaderProgramBinaryWrapper* m_binary;
+	};
+
 	ShaderProgramBinaryWrapper m_binary;
 
 	DynamicArray<Const> m_consts;
@@ -253,12 +273,39 @@ private:
 
 	DynamicArray<ConstMapping> m_constBinaryMapping;
 
-	mutable HashMap<U64, ShaderProgramResourceVariant*> m_variants;
-	mutable RWMutex m_mtx;
+	mutable FlatHashMap<U64, ShaderProgramResourceVariant*> m_variants;
+	mutable FlatHashMap<U64, ShaderPtr> m_shaders; ///< The variants share the shaders of the same code and constants.
+	/// The mutations that weren't in m_binary. The key is the mutation hash. The value is nullptr while the mutation
+	/// compiles in the background.
+	mutable FlatHashMap<U64, ShaderProgramBinaryWrapper*> m_onDemandBinaries;
+	mutable DynamicArray<CompiledMutation> m_compiledMutations;
+	mutable RWMutex m_mtx; ///< Protect m_variants, m_shaders, m_onDemandBinaries and m_compiledMutations.
 
 	ShaderTypeBit m_shaderStages = ShaderTypeBit::NONE;
 
-	void initVariant(const ShaderProgramResourceVariantInitInfo& info, ShaderProgramResourceVariant& variant) const;
+	void getOrCreateVariantInternal(const ShaderProgramResourceVariantInitInfo& info,
+		Bool async,
+		const ShaderProgramResourceVariant*& variant) const;
+
+	/// Find the binary variant of a mutation. If the mutation is not in m_binary it's compiled.
+	/// @param async Compile it in the background if rsrc_asyncShaderCompilation is on.
+	/// @param[out] codeBinary The binary that has the code of the variant.
+	/// @return false if the mutation compiles in the background.
+	Bool getOrCompileBinaryVariant(const ShaderProgramResourceVariantInitInfo& info,
+		Bool async,
+		const ShaderProgramBinary*& codeBinary,
+		const ShaderProgramBinaryVariant*& binaryVariant) const;
+
+	void initVariant(const ShaderProgramResourceVariantInitInfo& info,
+		const ShaderProgramBinary& codeBinary,
+		const ShaderProgramBinaryVariant& binaryVariant,
+		ShaderProgramResourceVariant& variant) const;
+
+	/// Compile a mutation that is not in m_binary because the shader variant manifest doesn't have it.
+	/// @param[out] binary The new binary that has the code of the variant.
+	/// @note It doesn't touch the mutable members so it can run without the lock.
+	ANKI_USE_RESULT Error compileMutation(
+		U64 mutationHash, ShaderProgramBinaryWrapper*& binary, const ShaderProgramBinaryVariant*& variant) const;
 
 	static ANKI_USE_RESULT Error parseConst(CString constName, U32& componentIdx, U32& componentCount, CString& name);
 };
@@ -0,0 +1,129 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/resource/ShaderProgramVariantManifest.h>
+#include <anki/util/File.h>
+#include <anki/util/Filesystem.h>
+#include <algorithm>
+
+namespace anki
+{
+
+ShaderProgramVariantManifest::~ShaderProgramVariantManifest()
+{
+	m_mutations.destroy(m_alloc);
+	m_filename.destroy(m_alloc);
+}
+
+Error ShaderProgramVariantManifest::init(const CString& filename, Bool record)
+{
+	ANKI_ASSERT(!filename.isEmpty());
+	m_filename.create(m_alloc, filename);
+	m_record = record;
+
+	if(!fileExists(filename))
+	{
+		if(!record)
+		{
+			ANKI_RESOURCE_LOGW("The shader variant manifest is missing: %s", filename.cstr());
+		}
+
+		return Error::NONE;
+	}
+
+	File file;
+	ANKI_CHECK(file.open(filename, FileOpenFlag::READ | FileOpenFlag::BINARY));
+
+	Array<char, 8> magic;
+	U32 mutationCount;
+	ANKI_CHECK(file.read(&magic[0], sizeof(magic)));
+	ANKI_CHECK(file.read(&mutationCount, sizeof(mutationCount)));
+	if(memcmp(&magic[0], MAGIC, sizeof(magic)) != 0
+		|| file.getSize() != sizeof(magic) + sizeof(mutationCount) + mutationCount * sizeof(Mutation))
+	{
+		ANKI_RESOURCE_LOGE("Corrupted shader variant manifest: %s", filename.cstr());
+		return Error::USER_DATA;
+	}
+
+	for(U32 i = 0; i < mutationCount; ++i)
+	{
+		Mutation mutation;
+		ANKI_CHECK(file.read(&mutation, sizeof(mutation)));
+		m_mutations.emplace(m_alloc, computeKey(mutation), mutation);
+	}
+
+	ANKI_RESOURCE_LOGI("Loaded %u shader program mutations from %s", mutationCount, filename.cstr());
+	return Error::NONE;
+}
+
+void ShaderProgramVariantManifest::getMutations(U64 programHash, DynamicArrayAuto<U64>& mutationHashes) const
+{
+	mutationHashes.destroy();
+
+	{
+		LockGuard<Mutex> lock(m_mtx);
+		for(const Mutation& mutation : m_mutations)
+		{
+			if(mutation.m_programHash == programHash)
+			{
+				mutationHashes.emplaceBack(mutation.m_mutationHash);
+			}
+		}
+	}
+
+	std::sort(mutationHashes.getBegin(), mutationHashes.getEnd());
+}
+
+void ShaderProgramVariantManifest::addMutation(U64 programHash, U64 mutationHash)
+{
+	if(!m_record)
+	{
+		return;
+	}
+
+	Mutation mutation;
+	mutation.m_programHash = programHash;
+	mutation.m_mutationHash = mutationHash;
+	const U64 key = computeKey(mutation);
+
+	LockGuard<Mutex> lock(m_mtx);
+	if(m_mutations.find(key) == m_mutations.getEnd())
+	{
+		m_mutations.emplace(m_alloc, key, mutation);
+		m_dirty = true;
+	}
+}
+
+Error ShaderProgramVariantManifest::save()
+{
+	LockGuard<Mutex> lock(m_mtx);
+	if(!m_dirty)
+	{
+		return Error::NONE;
+	}
+
+	File file;
+	ANKI_CHECK(file.open(m_filename.toCString(), FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+
+	U32 mutationCount = 0;
+	for(const Mutation& mutation : m_mutations)
+	{
+		(void)mutation;
+		++mutationCount;
+	}
+
+	ANKI_CHECK(file.write(MAGIC, 8));
+	ANKI_CHECK(file.write(&mutationCount, sizeof(mutationCount)));
+	for(const Mutation& mutation : m_mutations)
+	{
+		ANKI_CHECK(file.write(&mutation, sizeof(mutation)));
+	}
+
+	m_dirty = false;
+	ANKI_RESOURCE_LOGI("Wrote %u shader program mutations to %s", mutationCount, m_filename.cstr());
+	return Error::NONE;
+}
+
+} // end namespace anki
@@ -0,0 +1,72 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/resource/Common.h>
+#include <anki/util/HashMap.h>
+#include <anki/util/Thread.h>
+
+namespace anki
+{
+
+/// @addtogroup resource
+/// @{
+
+/// The mutations of the shader programs that are in use. The shader compilation builds only those and the rest are
+/// compiled the first time something asks for them. The manifest is a file that the runs of the game write when they
+/// record the mutations the materials and the rest of the engine create.
+class ShaderProgramVariantManifest : public NonCopyable
+{
+public:
+	ShaderProgramVariantManifest(ResourceAllocator<U8> alloc)
+		: m_alloc(alloc)
+	{
+	}
+
+	~ShaderProgramVariantManifest();
+
+	/// @param filename The manifest file. If it's not there the manifest starts empty.
+	/// @param record Add the mutations that get created and write them to the file with save().
+	ANKI_USE_RESULT Error init(const CString& filename, Bool record);
+
+	/// Get the mutations of a program.
+	/// @param programHash The hash of the filename of the program.
+	/// @param[out] mutationHashes The hashes of the mutations, sorted. Empty if the program is not in the manifest.
+	/// @note Thread-safe.
+	void getMutations(U64 programHash, DynamicArrayAuto<U64>& mutationHashes) const;
+
+	/// Add a mutation that got created. It does nothing if it doesn't record.
+	/// @note Thread-safe.
+	void addMutation(U64 programHash, U64 mutationHash);
+
+	/// Write the file if it recorded new mutations.
+	ANKI_USE_RESULT Error save();
+
+private:
+	static constexpr const char* MAGIC = "ANKISVM1";
+
+	class Mutation
+	{
+	public:
+		U64 m_programHash;
+		U64 m_mutationHash;
+	};
+
+	ResourceAllocator<U8> m_alloc;
+	String m_filename;
+	HashMap<U64, Mutation> m_mutations; ///< The key is the hash of the Mutation.
+	mutable Mutex m_mtx; ///< Protect m_mutations.
+	Bool m_record = false;
+	Bool m_dirty = false;
+
+	static U64 computeKey(const Mutation& mutation)
+	{
+		return computeHash(&mutation, sizeof(mutation));
+	}
+};
+/// @}
+
+} // end namespace anki
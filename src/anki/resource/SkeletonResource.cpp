@@ -4,6 +4,8 @@
 // http://www.anki3d.org/LICENSE
 
 #include <anki/resource/SkeletonResource.h>
+#include <anki/resource/ResourceManager.h>
+#include <anki/resource/ResourceDescriptor.h>
 #include <anki/util/Xml.h>
 #include <anki/util/StringList.h>
 
@@ -21,9 +23,35 @@ SkeletonResource::~SkeletonResource()
 }
 
 Error SkeletonResource::load(const ResourceFilename& filename, Bool async)
+{
+	StringAuto text(getTempAllocator());
+	CookedDescriptorData cookedData(getTempAllocator());
+	SkeletonDescriptor* cooked;
+	ANKI_CHECK(openFileLoadCookedDescriptor(filename, SKELETON_DESCRIPTOR_MAGIC, text, cookedData, cooked));
+	if(cooked && validateDescriptor(*cooked))
+	{
+		return init(*cooked);
+	}
+
+	// Parse the XML and cook it for the next time
+	DynamicArrayAuto<SkeletonDescriptorBone> bones(getTempAllocator());
+	DynamicArrayAuto<char> strings(getTempAllocator());
+	ANKI_CHECK(parseXml(text.toCString(), bones, strings));
+
+	SkeletonDescriptor desc;
+	desc.m_bones = WeakArray<SkeletonDescriptorBone>(bones);
+	desc.m_strings = WeakArray<char>(strings);
+	ANKI_CHECK(init(desc));
+
+	saveCookedDescriptor(filename, SKELETON_DESCRIPTOR_MAGIC, text.toCString(), desc);
+	return Error::NONE;
+}
+
+Error SkeletonResource::parseXml(
+	CString text, DynamicArrayAuto<SkeletonDescriptorBone>& bones, DynamicArrayAuto<char>& strings) const
 {
 	XmlDocument doc;
-	ANKI_CHECK(openFileParseXml(filename, doc));
+	ANKI_CHECK(doc.parse(text, getTempAllocator()));
 
 	XmlElement rootEl;
 	ANKI_CHECK(doc.getChildElement("skeleton", rootEl));
@@ -38,23 +66,22 @@ Error SkeletonResource::load(const ResourceFilename& filename, Bool async)
 	ANKI_CHECK(boneEl.getSiblingElementsCount(boneCount));
 	++boneCount;
 
-	m_bones.create(getAllocator(), boneCount);
+	bones.create(boneCount);
 
-	StringListAuto boneParents(getAllocator());
+	StringListAuto boneParents(getTempAllocator());
 
 	// Load every bone
 	boneCount = 0;
 	do
 	{
-		Bone& bone = m_bones[boneCount];
-		bone.m_idx = boneCount;
+		SkeletonDescriptorBone& bone = bones[boneCount];
 
 		// <name>
 		XmlElement nameEl;
 		ANKI_CHECK(boneEl.getChildElement("name", nameEl));
 		CString tmp;
 		ANKI_CHECK(nameEl.getText(tmp));
-		bone.m_name.create(getAllocator(), tmp);
+		bone.m_name = pushBackDescriptorString(tmp, strings);
 
 		// <transform>
 		XmlElement trfEl;
@@ -64,7 +91,7 @@ Error SkeletonResource::load(const ResourceFilename& filename, Bool async)
 		// <boneTransform>
 		XmlElement btrfEl;
 		ANKI_CHECK(boneEl.getChildElement("boneTransform", btrfEl));
-		ANKI_CHECK(btrfEl.getNumbers(bone.m_vertTrf));
+		ANKI_CHECK(btrfEl.getNumbers(bone.m_boneTransform));
 
 		// <parent>
 		XmlElement parentEl;
@@ -78,14 +105,6 @@ Error SkeletonResource::load(const ResourceFilename& filename, Bool async)
 		else
 		{
 			boneParents.pushBack("");
-
-			if(m_rootBoneIdx != MAX_U32)
-			{
-				ANKI_RESOURCE_LOGE("Skeleton cannot have more than one root nodes");
-				return Error::USER_DATA;
-			}
-
-			m_rootBoneIdx = boneCount;
 		}
 
 		// Advance
@@ -93,44 +112,145 @@ Error SkeletonResource::load(const ResourceFilename& filename, Bool async)
 		++boneCount;
 	} while(boneEl);
 
-	// Resolve the parents
+	// Resolve the parents by name
 	auto it = boneParents.getBegin();
-	for(U32 i = 0; i < m_bones.getSize(); ++i)
+	for(U32 i = 0; i < bones.getSize(); ++i)
 	{
-		Bone& bone = m_bones[i];
-
 		if(!it->isEmpty())
 		{
-			for(U32 j = 0; j < m_bones.getSize(); ++j)
+			for(U32 j = 0; j < bones.getSize(); ++j)
 			{
-				if(m_bones[j].m_name == *it)
+				if(getDescriptorString(strings, bones[j].m_name) == *it)
 				{
-					bone.m_parent = &m_bones[j];
+					bones[i].m_parent = j;
 					break;
 				}
 			}
 
-			if(bone.m_parent == nullptr)
+			if(bones[i].m_parent == MAX_U32)
 			{
-				ANKI_RESOURCE_LOGE(
-					"Bone \"%s\" is referencing an unknown parent \"%s\"", &bone.m_name[0], &it->toCString()[0]);
+				ANKI_RESOURCE_LOGE("Bone \"%s\" is referencing an unknown parent \"%s\"",
+					getDescriptorString(strings, bones[i].m_name).cstr(),
+					&it->toCString()[0]);
 				return Error::USER_DATA;
 			}
+		}
 
-			if(bone.m_parent->m_childrenCount >= MAX_CHILDREN_PER_BONE)
+		++it;
+	}
+
+	return Error::NONE;
+}
+
+Bool SkeletonResource::validateDescriptor(const SkeletonDescriptor& desc)
+{
+	if(desc.m_bones.getSize() == 0)
+	{
+		return false;
+	}
+
+	for(const SkeletonDescriptorBone& bone : desc.m_bones)
+	{
+		if(!isValidDescriptorString(desc.m_strings, bone.m_name)
+			|| (bone.m_parent != MAX_U32 && bone.m_parent >= desc.m_bones.getSize()))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+Error SkeletonResource::init(const SkeletonDescriptor& desc)
+{
+	m_bones.create(getAllocator(), desc.m_bones.getSize());
+
+	for(U32 i = 0; i < m_bones.getSize(); ++i)
+	{
+		const SkeletonDescriptorBone& inBone = desc.m_bones[i];
+		Bone& bone = m_bones[i];
+		bone.m_idx = i;
+		bone.m_name.create(getAllocator(), getDescriptorString(desc.m_strings, inBone.m_name));
+		memcpy(&bone.m_transform, &inBone.m_transform[0], sizeof(bone.m_transform));
+		memcpy(&bone.m_vertTrf, &inBone.m_boneTransform[0], sizeof(bone.m_vertTrf));
+
+		if(inBone.m_parent == MAX_U32)
+		{
+			if(m_rootBoneIdx != MAX_U32)
 			{
-				ANKI_RESOURCE_LOGE(
-					"Bone \"%s\" cannot have more that %u children", &bone.m_parent->m_name[0], MAX_CHILDREN_PER_BONE);
+				ANKI_RESOURCE_LOGE("Skeleton cannot have more than one root nodes");
 				return Error::USER_DATA;
 			}
 
-			bone.m_parent->m_children[bone.m_parent->m_childrenCount++] = &bone;
+			m_rootBoneIdx = i;
 		}
+	}
 
-		++it;
+	// Connect the parents and the children
+	for(U32 i = 0; i < m_bones.getSize(); ++i)
+	{
+		if(desc.m_bones[i].m_parent == MAX_U32)
+		{
+			continue;
+		}
+
+		Bone& bone = m_bones[i];
+		bone.m_parent = &m_bones[desc.m_bones[i].m_parent];
+
+		if(bone.m_parent->m_childrenCount >= MAX_CHILDREN_PER_BONE)
+		{
+			ANKI_RESOURCE_LOGE(
+				"Bone \"%s\" cannot have more that %u children", &bone.m_parent->m_name[0], MAX_CHILDREN_PER_BONE);
+			return Error::USER_DATA;
+		}
+
+		bone.m_parent->m_children[bone.m_parent->m_childrenCount++] = &bone;
+	}
+
+	// Compute the depths
+	for(Bone& bone : m_bones)
+	{
+		for(const Bone* parent = bone.m_parent; parent; parent = parent->m_parent)
+		{
+			if(++bone.m_depth >= m_bones.getSize())
+			{
+				ANKI_RESOURCE_LOGE("The parents of bone \"%s\" form a cycle", &bone.m_name[0]);
+				return Error::USER_DATA;
+			}
+		}
+	}
+
+	if(getManager().getGpuSkinningEnabled())
+	{
+		createGpuBonesBuffer();
 	}
 
 	return Error::NONE;
 }
 
+void SkeletonResource::createGpuBonesBuffer()
+{
+	const PtrSize buffSize = m_bones.getSize() * 2 * sizeof(Mat4);
+	m_gpuBones = getManager().getGrManager().newBuffer(
+		BufferInitInfo(buffSize, BufferUsageBit::STORAGE_COMPUTE_READ, BufferMapAccessBit::WRITE, "SkeletonBones"));
+
+	Mat4* gpuBones = static_cast<Mat4*>(m_gpuBones->map(0, buffSize, BufferMapAccessBit::WRITE));
+	visitBones(getRootBone(), Mat4::getIdentity(), gpuBones);
+	m_gpuBones->unmap();
+}
+
+void SkeletonResource::visitBones(const Bone& bone, const Mat4& parentTrf, Mat4* gpuBones) const
+{
+	// Same as what the SkinComponent does on the CPU. The animation doesn't propagate to the children so the chain is
+	// constant
+	const Mat4 myTrf = parentTrf * bone.getTransform();
+	gpuBones[bone.getIndex() * 2] = myTrf;
+	gpuBones[bone.getIndex() * 2 + 1] = bone.getVertexTransform();
+
+	for(const Bone* child : bone.getChildren())
+	{
+		visitBones(*child, myTrf, gpuBones);
+	}
+}
+
 } // end namespace anki
@@ -7,11 +7,16 @@
 
 #include <anki/resource/ResourceObject.h>
 #include <anki/Math.h>
+#include <anki/Gr.h>
 #include <anki/util/WeakArray.h>
 
 namespace anki
 {
 
+// Forward
+class SkeletonDescriptor;
+class SkeletonDescriptorBone;
+
 /// @addtogroup resource
 /// @{
 
@@ -47,6 +52,12 @@ public:
 		return m_idx;
 	}
 
+	/// How many parents it has.
+	U32 getDepth() const
+	{
+		return m_depth;
+	}
+
 	ConstWeakArray<Bone*> getChildren() const
 	{
 		return ConstWeakArray<Bone*>((m_childrenCount) ? &m_children[0] : nullptr, m_childrenCount);
@@ -59,6 +70,7 @@ private:
 	Mat4 m_vertTrf;
 
 	U32 m_idx;
+	U32 m_depth = 0;
 
 	Bone* m_parent = nullptr;
 	Array<Bone*, MAX_CHILDREN_PER_BONE> m_children = {};
@@ -70,7 +82,8 @@ private:
 	}
 };
 
-/// It contains the bones with their position and hierarchy
+/// It contains the bones with their position and hierarchy. The XML is cooked to a SkeletonDescriptor the first time
+/// it's loaded, see rsrc_cookedDescriptors.
 ///
 /// XML file format:
 ///
@@ -124,9 +137,30 @@ public:
 		return m_bones[m_rootBoneIdx];
 	}
 
+	/// Get the bones for the GPU skinning. It holds 2 Mat4 per bone. The first is the product of the transforms of the
+	/// bone's parents and the bone itself and the second is the vertex transform. It's not created if the GPU skinning
+	/// is disabled.
+	const BufferPtr& getGpuBonesBuffer() const
+	{
+		return m_gpuBones;
+	}
+
 private:
 	DynamicArray<Bone> m_bones;
 	U32 m_rootBoneIdx = MAX_U32;
+	BufferPtr m_gpuBones;
+
+	ANKI_USE_RESULT Error parseXml(
+		CString text, DynamicArrayAuto<SkeletonDescriptorBone>& bones, DynamicArrayAuto<char>& strings) const;
+
+	/// Check a cooked descriptor that was read from the cache.
+	static Bool validateDescriptor(const SkeletonDescriptor& desc);
+
+	ANKI_USE_RESULT Error init(const SkeletonDescriptor& desc);
+
+	void createGpuBonesBuffer();
+
+	void visitBones(const Bone& bone, const Mat4& parentTrf, Mat4* gpuBones) const;
 };
 /// @}
 
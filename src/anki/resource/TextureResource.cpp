@@ -7,10 +7,35 @@
 #include <anki/resource/ImageLoader.h>
 #include <anki/resource/ResourceManager.h>
 #include <anki/resource/AsyncLoader.h>
+#include <anki/resource/TextureStreamer.h>
 
 namespace anki
 {
 
+/// The compressions of the AnKi textures that the GPU can sample.
+static ImageLoaderDataCompression getSupportedCompressions(const GrManager& gr)
+{
+	const GpuDeviceCapabilities& caps = gr.getDeviceCapabilities();
+
+	ImageLoaderDataCompression out = ImageLoaderDataCompression::RAW;
+	if(caps.m_bcTextureCompression)
+	{
+		out |= ImageLoaderDataCompression::S3TC | ImageLoaderDataCompression::BC7;
+	}
+
+	if(caps.m_etc2TextureCompression)
+	{
+		out |= ImageLoaderDataCompression::ETC;
+	}
+
+	if(caps.m_astcTextureCompression)
+	{
+		out |= ImageLoaderDataCompression::ASTC;
+	}
+
+	return out;
+}
+
 class TextureResource::LoadingContext
 {
 public:
@@ -21,10 +46,26 @@ public:
 	TransferGpuAllocator* m_trfAlloc ANKI_DEBUG_CODE(= nullptr);
 	TextureType m_texType;
 	TexturePtr m_tex;
+	FileIoQueue* m_ioQueue = nullptr; ///< If it's not nullptr the surfaces of a batch are read in parallel.
+	U32 m_nextCopy = 0; ///< The next surface or volume to upload.
+	FencePtr m_lastFence; ///< The fence of the last batch of copies. The upload is done on the GPU when it's signaled.
+	Bool m_spreadOverFrames = false; ///< Stop uploading when the frame's transfer budget is exhausted.
 
 	LoadingContext(GenericMemoryPoolAllocator<U8> alloc)
 		: m_loader(alloc)
 	{
+		// Read the data straight to the transfer memory
+		m_loader.setDeferDataReads(true);
+	}
+
+	U32 getCopyCount() const
+	{
+		return m_layerCount * m_faces * m_loader.getMipmapCount();
+	}
+
+	Bool uploadDone() const
+	{
+		return m_nextCopy == getCopyCount();
 	}
 };
 
@@ -37,16 +78,86 @@ public:
 	TexUploadTask(GenericMemoryPoolAllocator<U8> alloc)
 		: m_ctx(alloc)
 	{
+		m_ctx.m_spreadOverFrames = true;
+	}
+
+	Error operator()(AsyncLoaderTaskContext& ctx) final
+	{
+		// Spread the uploads over many frames
+		if(m_ctx.m_trfAlloc->frameBudgetExhausted())
+		{
+			ctx.m_resubmitTask = true;
+			ctx.m_pause = true;
+			return Error::NONE;
+		}
+
+		m_ctx.m_ioQueue = ctx.m_ioQueue;
+		ANKI_CHECK(TextureResource::load(m_ctx));
+
+		// Continue with the rest of the surfaces in the next frame
+		if(!m_ctx.uploadDone())
+		{
+			ctx.m_resubmitTask = true;
+			ctx.m_pause = true;
+		}
+
+		return Error::NONE;
+	}
+};
+
+/// Loads a different set of mips of a streamed texture.
+class TextureResource::StreamTask : public AsyncLoaderTask
+{
+public:
+	TextureResource* m_tex;
+	U32 m_topMip;
+	TextureResource::LoadingContext m_ctx;
+
+	StreamTask(TextureResource* tex, U32 topMip, GenericMemoryPoolAllocator<U8> alloc)
+		: m_tex(tex)
+		, m_topMip(topMip)
+		, m_ctx(alloc)
+	{
+		m_ctx.m_spreadOverFrames = true;
 	}
 
 	Error operator()(AsyncLoaderTaskContext& ctx) final
 	{
-		return TextureResource::load(m_ctx);
+		// Spread the uploads over many frames
+		if(m_tex->getManager().getTransferGpuAllocator().frameBudgetExhausted())
+		{
+			ctx.m_resubmitTask = true;
+			ctx.m_pause = true;
+			return Error::NONE;
+		}
+
+		m_ctx.m_ioQueue = ctx.m_ioQueue;
+		const Error err = m_tex->loadStreamedMips(m_topMip, m_ctx);
+		if(!err && !m_ctx.uploadDone())
+		{
+			// Continue with the rest of the mips in the next frame
+			ctx.m_resubmitTask = true;
+			ctx.m_pause = true;
+			return Error::NONE;
+		}
+
+		LockGuard<SpinLock> lock(m_tex->m_streaming.m_lock);
+		if(!err)
+		{
+			m_tex->m_streaming.m_pendingTex = m_ctx.m_tex;
+			m_tex->m_streaming.m_pendingTopMip = m_topMip;
+			m_tex->m_streaming.m_pendingFence = m_ctx.m_lastFence;
+		}
+		m_tex->m_streaming.m_inFlight = false;
+
+		return err;
 	}
 };
 
 TextureResource::~TextureResource()
 {
+	// Don't upload to a texture that no-one will use
+	getManager().getAsyncLoader().cancelTasks(this);
 }
 
 Error TextureResource::load(const ResourceFilename& filename, Bool async)
@@ -58,6 +169,7 @@ Error TextureResource::load(const ResourceFilename& filename, Bool async)
 	if(async)
 	{
 		task = getManager().getAsyncLoader().newTask<TexUploadTask>(getManager().getAsyncLoader().getAllocator());
+		task->setOwner(this);
 		ctx = &task->m_ctx;
 	}
 	else
@@ -67,15 +179,73 @@ Error TextureResource::load(const ResourceFilename& filename, Bool async)
 	}
 	ImageLoader& loader = ctx->m_loader;
 
-	TextureInitInfo init("RsrcTex");
-	init.m_usage = TextureUsageBit::SAMPLED_ALL | TextureUsageBit::TRANSFER_DESTINATION;
-	init.m_initialUsage = TextureUsageBit::SAMPLED_ALL;
-	U32 faces = 0;
+	// The streamed textures start with the tail mips
+	const TextureStreamer& streamer = getManager().getTextureStreamer();
+	const Bool streamed = streamer.isEnabled() && getManager().isLoadingStreamedTexture();
+	U32 maxSize = getManager().getMaxTextureSize();
+	if(streamed)
+	{
+		maxSize = min(maxSize, streamer.getTailSize());
+	}
 
 	ResourceFilePtr file;
 	ANKI_CHECK(openFile(filename, file));
 
-	ANKI_CHECK(loader.load(file, filename, getManager().getMaxTextureSize()));
+	ANKI_CHECK(loader.load(file, filename, maxSize, getSupportedCompressions(getManager().getGrManager())));
+
+	// Create the texture
+	createTexture(getManager(), *ctx);
+	m_tex = ctx->m_tex;
+
+	// Setup the streaming if there are mips to stream
+	if(streamed && loader.getSkippedMipmapCount() > 0 && ctx->m_texType != TextureType::_3D)
+	{
+		Streaming& s = m_streaming;
+		s.m_fileMipCount = loader.getSkippedMipmapCount() + loader.getMipmapCount();
+		s.m_fullSize = UVec2(loader.getWidth() << loader.getSkippedMipmapCount(),
+			loader.getHeight() << loader.getSkippedMipmapCount());
+		s.m_tailTopMip = loader.getSkippedMipmapCount();
+		s.m_topMip = s.m_tailTopMip;
+		s.m_wantedTopMip = s.m_tailTopMip;
+
+		s.m_minTopMip = 0;
+		while(max(s.m_fullSize.x() >> s.m_minTopMip, s.m_fullSize.y() >> s.m_minTopMip)
+			  > getManager().getMaxTextureSize())
+		{
+			++s.m_minTopMip;
+		}
+
+		s.m_enabled = s.m_minTopMip < s.m_tailTopMip;
+	}
+
+	// Upload the data
+	if(async)
+	{
+		getManager().getAsyncLoader().submitTask(task);
+	}
+	else
+	{
+		ANKI_CHECK(load(*ctx));
+	}
+
+	m_size = UVec3(m_tex->getWidth(), m_tex->getHeight(), m_tex->getDepth());
+	m_layerCount = ctx->m_layerCount;
+
+	// Create the texture view
+	TextureViewInitInfo viewInit(m_tex, "Rsrc");
+	m_texView = getManager().getGrManager().newTextureView(viewInit);
+
+	return Error::NONE;
+}
+
+void TextureResource::createTexture(ResourceManager& manager, LoadingContext& ctx)
+{
+	const ImageLoader& loader = ctx.m_loader;
+
+	TextureInitInfo init("RsrcTex");
+	init.m_usage = TextureUsageBit::SAMPLED_ALL | TextureUsageBit::TRANSFER_DESTINATION;
+	init.m_initialUsage = TextureUsageBit::SAMPLED_ALL;
+	U32 faces = 0;
 
 	// Various sizes
 	init.m_width = loader.getWidth();
@@ -112,36 +282,26 @@ Error TextureResource::load(const ResourceFilename& filename, Bool async)
 	}
 
 	// Internal format
-	if(loader.getColorFormat() == ImageLoaderColorFormat::RGB8)
-	{
-		switch(loader.getCompression())
-		{
-		case ImageLoaderDataCompression::RAW:
-			init.m_format = Format::R8G8B8_UNORM;
-			break;
-		case ImageLoaderDataCompression::S3TC:
-			init.m_format = Format::BC1_RGB_UNORM_BLOCK;
-			break;
-		default:
-			ANKI_ASSERT(0);
-		}
-	}
-	else if(loader.getColorFormat() == ImageLoaderColorFormat::RGBA8)
-	{
-		switch(loader.getCompression())
-		{
-		case ImageLoaderDataCompression::RAW:
-			init.m_format = Format::R8G8B8A8_UNORM;
-			break;
-		case ImageLoaderDataCompression::S3TC:
-			init.m_format = Format::BC3_UNORM_BLOCK;
-			break;
-		default:
-			ANKI_ASSERT(0);
-		}
-	}
-	else
+	const Bool alpha = loader.getColorFormat() == ImageLoaderColorFormat::RGBA8;
+	ANKI_ASSERT(alpha || loader.getColorFormat() == ImageLoaderColorFormat::RGB8);
+	switch(loader.getCompression())
 	{
+	case ImageLoaderDataCompression::RAW:
+		init.m_format = (alpha) ? Format::R8G8B8A8_UNORM : Format::R8G8B8_UNORM;
+		break;
+	case ImageLoaderDataCompression::S3TC:
+		init.m_format = (alpha) ? Format::BC3_UNORM_BLOCK : Format::BC1_RGB_UNORM_BLOCK;
+		break;
+	case ImageLoaderDataCompression::ETC:
+		init.m_format = (alpha) ? Format::ETC2_R8G8B8A1_UNORM_BLOCK : Format::ETC2_R8G8B8_UNORM_BLOCK;
+		break;
+	case ImageLoaderDataCompression::BC7:
+		init.m_format = Format::BC7_UNORM_BLOCK;
+		break;
+	case ImageLoaderDataCompression::ASTC:
+		init.m_format = Format::ASTC_4x4_UNORM_BLOCK;
+		break;
+	default:
 		ANKI_ASSERT(0);
 	}
 
@@ -149,47 +309,128 @@ Error TextureResource::load(const ResourceFilename& filename, Bool async)
 	init.m_mipmapCount = U8(loader.getMipmapCount());
 
 	// Create the texture
-	m_tex = getManager().getGrManager().newTexture(init);
+	ctx.m_tex = manager.getGrManager().newTexture(init);
 
 	// Set the context
-	ctx->m_faces = faces;
-	ctx->m_layerCount = init.m_layerCount;
-	ctx->m_gr = &getManager().getGrManager();
-	ctx->m_trfAlloc = &getManager().getTransferGpuAllocator();
-	ctx->m_texType = init.m_type;
-	ctx->m_tex = m_tex;
+	ctx.m_faces = faces;
+	ctx.m_layerCount = init.m_layerCount;
+	ctx.m_gr = &manager.getGrManager();
+	ctx.m_trfAlloc = &manager.getTransferGpuAllocator();
+	ctx.m_texType = init.m_type;
+}
 
-	// Upload the data
-	if(async)
+Error TextureResource::loadStreamedMips(U32 topMip, LoadingContext& ctx)
+{
+	const Streaming& s = m_streaming;
+	const U32 maxSize = max(max(s.m_fullSize.x() >> topMip, s.m_fullSize.y() >> topMip), 1u);
+
+	// The task might be resubmitted in the middle of the upload
+	if(!ctx.m_tex.isCreated())
 	{
-		getManager().getAsyncLoader().submitTask(task);
+		ResourceFilePtr file;
+		ANKI_CHECK(openFile(getFilename(), file));
+		ANKI_CHECK(ctx.m_loader.load(
+			file, getFilename(), maxSize, getSupportedCompressions(getManager().getGrManager())));
+		ANKI_ASSERT(ctx.m_loader.getSkippedMipmapCount() == topMip);
+
+		createTexture(getManager(), ctx);
 	}
-	else
+
+	ANKI_CHECK(load(ctx));
+
+	return Error::NONE;
+}
+
+void TextureResource::startStreaming(U32 topMip)
+{
+	ANKI_ASSERT(m_streaming.m_enabled && topMip != m_streaming.m_topMip);
+	ANKI_ASSERT(topMip >= m_streaming.m_minTopMip && topMip <= m_streaming.m_tailTopMip);
+
 	{
-		ANKI_CHECK(load(*ctx));
+		LockGuard<SpinLock> lock(m_streaming.m_lock);
+		ANKI_ASSERT(!m_streaming.m_inFlight);
+		m_streaming.m_inFlight = true;
 	}
+	m_streaming.m_inFlightTopMip = topMip;
 
-	m_size = UVec3(init.m_width, init.m_height, init.m_depth);
-	m_layerCount = init.m_layerCount;
+	AsyncLoader& loader = getManager().getAsyncLoader();
+	StreamTask* task = loader.newTask<StreamTask>(this, topMip, loader.getAllocator());
+	task->setOwner(this);
+
+	// Loading mips is more urgent than evicting
+	loader.submitTask(
+		task, (topMip < m_streaming.m_topMip) ? AsyncLoaderTaskPriority::HIGH : AsyncLoaderTaskPriority::NORMAL);
+}
+
+void TextureResource::applyStreamedMips()
+{
+	TexturePtr tex;
+	{
+		LockGuard<SpinLock> lock(m_streaming.m_lock);
+		if(!m_streaming.m_pendingTex.isCreated())
+		{
+			return;
+		}
+
+		// The copies run in the async transfer queue. Don't switch before they are done, try again next frame
+		if(m_streaming.m_pendingFence.isCreated() && !m_streaming.m_pendingFence->clientWait(0.0))
+		{
+			return;
+		}
+
+		tex = m_streaming.m_pendingTex;
+		m_streaming.m_pendingTex.reset(nullptr);
+		m_streaming.m_pendingFence.reset(nullptr);
+		m_streaming.m_topMip = m_streaming.m_pendingTopMip;
+	}
+
+	// The old texture lives until the GPU is done with it
+	m_tex = tex;
+	m_size = UVec3(m_tex->getWidth(), m_tex->getHeight(), m_tex->getDepth());
 
-	// Create the texture view
 	TextureViewInitInfo viewInit(m_tex, "Rsrc");
 	m_texView = getManager().getGrManager().newTextureView(viewInit);
+}
 
-	return Error::NONE;
+U32 TextureResource::computeTopMip(U32 size) const
+{
+	const Streaming& s = m_streaming;
+	U32 mip = s.m_minTopMip;
+	while(mip < s.m_tailTopMip && max(s.m_fullSize.x() >> (mip + 1), s.m_fullSize.y() >> (mip + 1)) >= size)
+	{
+		++mip;
+	}
+
+	return mip;
+}
+
+PtrSize TextureResource::computeStreamedMemory(U32 topMip) const
+{
+	const Streaming& s = m_streaming;
+	const U32 faces = (m_tex->getTextureType() == TextureType::CUBE) ? 6 : 1;
+
+	PtrSize size = 0;
+	for(U32 mip = topMip; mip < s.m_fileMipCount; ++mip)
+	{
+		size += computeSurfaceSize(
+			max(s.m_fullSize.x() >> mip, 1u), max(s.m_fullSize.y() >> mip, 1u), m_tex->getFormat());
+	}
+
+	return size * faces * m_layerCount;
 }
 
 Error TextureResource::load(LoadingContext& ctx)
 {
-	const U32 copyCount = ctx.m_layerCount * ctx.m_faces * ctx.m_loader.getMipmapCount();
+	const U32 copyCount = ctx.getCopyCount();
 
-	for(U32 b = 0; b < copyCount; b += MAX_COPIES_BEFORE_FLUSH)
+	for(U32 b = ctx.m_nextCopy; b < copyCount; b += MAX_COPIES_BEFORE_FLUSH)
 	{
 		const U32 begin = b;
 		const U32 end = min(copyCount, b + MAX_COPIES_BEFORE_FLUSH);
 
 		CommandBufferInitInfo ci;
-		ci.m_flags = CommandBufferFlag::TRANSFER_WORK | CommandBufferFlag::SMALL_BATCH;
+		ci.m_flags =
+			CommandBufferFlag::TRANSFER_WORK | CommandBufferFlag::ASYNC_TRANSFER_WORK | CommandBufferFlag::SMALL_BATCH;
 		CommandBufferPtr cmdb = ctx.m_gr->newCommandBuffer(ci);
 
 		// Set the barriers of the batch
@@ -220,15 +461,12 @@ Error TextureResource::load(LoadingContext& ctx)
 			U32 mip, layer, face;
 			unflatten3dArrayIndex(ctx.m_layerCount, ctx.m_faces, ctx.m_loader.getMipmapCount(), i, layer, face, mip);
 
-			PtrSize surfOrVolSize;
-			const void* surfOrVolData;
+			U32 surfOrVolSize;
 			PtrSize allocationSize;
 
 			if(ctx.m_texType == TextureType::_3D)
 			{
-				const auto& vol = ctx.m_loader.getVolume(mip);
-				surfOrVolSize = vol.m_data.getSize();
-				surfOrVolData = &vol.m_data[0];
+				surfOrVolSize = ctx.m_loader.getVolume(mip).m_dataSize;
 
 				allocationSize = computeVolumeSize(ctx.m_tex->getWidth() >> mip,
 					ctx.m_tex->getHeight() >> mip,
@@ -237,9 +475,7 @@ Error TextureResource::load(LoadingContext& ctx)
 			}
 			else
 			{
-				const auto& surf = ctx.m_loader.getSurface(mip, face, layer);
-				surfOrVolSize = surf.m_data.getSize();
-				surfOrVolData = &surf.m_data[0];
+				surfOrVolSize = ctx.m_loader.getSurface(mip, face, layer).m_dataSize;
 
 				allocationSize = computeSurfaceSize(
 					ctx.m_tex->getWidth() >> mip, ctx.m_tex->getHeight() >> mip, ctx.m_tex->getFormat());
@@ -248,10 +484,19 @@ Error TextureResource::load(LoadingContext& ctx)
 			ANKI_ASSERT(allocationSize >= surfOrVolSize);
 			TransferGpuAllocatorHandle& handle = handles[handleCount++];
 			ANKI_CHECK(ctx.m_trfAlloc->allocate(allocationSize, handle));
-			void* data = handle.getMappedMemory();
+			U8* data = static_cast<U8*>(handle.getMappedMemory());
 			ANKI_ASSERT(data);
 
-			memcpy(data, surfOrVolData, surfOrVolSize);
+			// Copy or read straight to the transfer memory. The reads of the batch can happen at the same time
+			const WeakArray<U8> dst(data, surfOrVolSize);
+			if(ctx.m_texType == TextureType::_3D)
+			{
+				ANKI_CHECK(ctx.m_loader.storeVolume(mip, dst, ctx.m_ioQueue));
+			}
+			else
+			{
+				ANKI_CHECK(ctx.m_loader.storeSurface(mip, face, layer, dst, ctx.m_ioQueue));
+			}
 
 			// Create temp tex view
 			TextureSubresourceInfo subresource;
@@ -293,6 +538,9 @@ Error TextureResource::load(LoadingContext& ctx)
 			}
 		}
 
+		// Wait for the reads of the batch. Flush anyway to give the transfer memory back
+		const Error readErr = (ctx.m_ioQueue) ? ctx.m_loader.waitAsyncReads(*ctx.m_ioQueue) : Error(Error::NONE);
+
 		// Flush batch
 		FencePtr fence;
 		cmdb->flush(&fence);
@@ -301,7 +549,16 @@ Error TextureResource::load(LoadingContext& ctx)
 		{
 			ctx.m_trfAlloc->release(handles[i], fence);
 		}
+		ctx.m_lastFence = fence;
 		cmdb.reset(nullptr);
+		ANKI_CHECK(readErr);
+
+		// Spread the big textures over many frames
+		ctx.m_nextCopy = end;
+		if(ctx.m_spreadOverFrames && ctx.m_trfAlloc->frameBudgetExhausted())
+		{
+			break;
+		}
 	}
 
 	return Error::NONE;
@@ -7,6 +7,7 @@
 
 #include <anki/resource/ResourceObject.h>
 #include <anki/Gr.h>
+#include <anki/util/Thread.h>
 
 namespace anki
 {
@@ -17,9 +18,12 @@ namespace anki
 /// Texture resource class.
 ///
 /// It loads or creates an image and then loads it in the GPU. It supports compressed and uncompressed TGAs and AnKi's
-/// texture format.
+/// texture format. The textures that are loaded with ResourceManager::loadStreamedTexture() start with the tail mips
+/// and the TextureStreamer changes their top mip depending on what the scene asks with requestResidency().
 class TextureResource : public ResourceObject
 {
+	friend class TextureStreamer;
+
 public:
 	TextureResource(ResourceManager* manager)
 		: ResourceObject(manager)
@@ -67,18 +71,87 @@ public:
 		return m_layerCount;
 	}
 
+	/// The mips are streamed.
+	Bool isStreamed() const
+	{
+		return m_streaming.m_enabled;
+	}
+
+	/// Ask for the mips that show the texture with that many texels along its biggest side. The biggest request of
+	/// the frame counts. It does nothing if the texture is not streamed.
+	/// @note Thread-safe.
+	void requestResidency(U32 size)
+	{
+		if(m_streaming.m_enabled)
+		{
+			m_streaming.m_requestedSize.max(size);
+		}
+	}
+
 private:
 	static constexpr U32 MAX_COPIES_BEFORE_FLUSH = 4;
 
 	class TexUploadTask;
+	class StreamTask;
 	class LoadingContext;
 
+	/// The state of the mip streaming. The mips are counted from the top mip of the file.
+	class Streaming
+	{
+	public:
+		Atomic<U32> m_requestedSize = {0};
+		UVec2 m_fullSize = UVec2(0u); ///< The size of the top mip of the file.
+		U32 m_fileMipCount = 0;
+		U32 m_minTopMip = 0; ///< The biggest mip that the rsrc_maxTextureSize allows.
+		U32 m_tailTopMip = 0; ///< The top mip of the tail that is always resident.
+		U32 m_topMip = 0; ///< The resident top mip.
+		U32 m_wantedTopMip = 0;
+		U64 m_wantedFrame = 0; ///< When the m_wantedTopMip was last requested.
+		U32 m_inFlightTopMip = 0; ///< The top mip of the last startStreaming().
+		Bool m_enabled = false;
+
+		SpinLock m_lock; ///< Protects the members below. The loading thread sets them.
+		TexturePtr m_pendingTex; ///< A texture with different mips that is ready.
+		FencePtr m_pendingFence; ///< Signaled when the GPU is done uploading m_pendingTex.
+		U32 m_pendingTopMip = 0;
+		Bool m_inFlight = false;
+	};
+
 	TexturePtr m_tex;
 	TextureViewPtr m_texView;
 	UVec3 m_size = UVec3(0u);
 	U32 m_layerCount = 0;
+	Streaming m_streaming;
 
+	/// Upload the surfaces from LoadingContext::m_nextCopy and on. With LoadingContext::m_spreadOverFrames it stops
+	/// when the transfer budget of the frame is exhausted and the rest can be uploaded later.
 	ANKI_USE_RESULT static Error load(LoadingContext& ctx);
+
+	/// Create the texture of the mips that the loader of the context holds.
+	static void createTexture(ResourceManager& manager, LoadingContext& ctx);
+
+	/// Load the mips from topMip and below into a new texture. Called by the loading thread. It can be called again
+	/// with the same context to continue an upload that load() stopped.
+	ANKI_USE_RESULT Error loadStreamedMips(U32 topMip, LoadingContext& ctx);
+
+	/// Start loading a different set of mips.
+	void startStreaming(U32 topMip);
+
+	/// Use the texture of the last startStreaming() if it's ready and its upload is done on the GPU. Call it when nothing
+	/// renders.
+	void applyStreamedMips();
+
+	Bool isStreamingInFlight()
+	{
+		LockGuard<SpinLock> lock(m_streaming.m_lock);
+		return m_streaming.m_inFlight;
+	}
+
+	/// Get the top mip that has at least that many texels along the biggest side.
+	U32 computeTopMip(U32 size) const;
+
+	/// The GPU memory of the mips from topMip and below.
+	PtrSize computeStreamedMemory(U32 topMip) const;
 };
 /// @}
 
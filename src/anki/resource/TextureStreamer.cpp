@@ -0,0 +1,117 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/resource/TextureStreamer.h>
+#include <anki/resource/TextureResource.h>
+#include <anki/resource/ResourceManager.h>
+#include <anki/core/ConfigSet.h>
+#include <anki/util/Tracer.h>
+
+namespace anki
+{
+
+TextureStreamer::TextureStreamer(ResourceManager* manager)
+	: m_manager(manager)
+{
+	ANKI_ASSERT(manager);
+}
+
+TextureStreamer::~TextureStreamer()
+{
+}
+
+void TextureStreamer::init(const ConfigSet& config)
+{
+	m_enabled = config.getBool("rsrc_textureStreaming");
+	m_budget = config.getNumberU64("rsrc_textureStreamingBudget");
+	m_tailSize = config.getNumberU32("rsrc_textureStreamingTailSize");
+	m_screenHeight = config.getNumberU32("height");
+}
+
+void TextureStreamer::update()
+{
+	if(!m_enabled)
+	{
+		return;
+	}
+
+	ANKI_TRACE_SCOPED_EVENT(RSRC_TEXTURE_STREAMING);
+	++m_frame;
+
+	PtrSize residentMemory = 0;
+	PtrSize projectedMemory = 0;
+	// The projected memory of the previous frame plus the decisions of this one
+	PtrSize prevProjectedMemory = m_projectedMemory;
+	U32 streamCount = 0;
+
+	m_manager->iterateLoadedResources<TextureResource>([&](TextureResource* tex) {
+		if(!tex->isStreamed())
+		{
+			return;
+		}
+
+		TextureResource::Streaming& s = tex->m_streaming;
+		tex->applyStreamedMips();
+
+		// Update the wanted mip. Bigger mips are wanted right away, smaller only after a while without requests for
+		// the bigger ones. That stops the mips from loading and evicting all the time
+		const U32 requestedSize = s.m_requestedSize.exchange(0);
+		if(requestedSize > 0)
+		{
+			const U32 mip = tex->computeTopMip(requestedSize);
+			if(mip <= s.m_wantedTopMip || m_frame - s.m_wantedFrame > REQUEST_TIMEOUT_FRAMES)
+			{
+				s.m_wantedTopMip = mip;
+				s.m_wantedFrame = m_frame;
+			}
+		}
+		else if(m_frame - s.m_wantedFrame > REQUEST_TIMEOUT_FRAMES)
+		{
+			s.m_wantedTopMip = s.m_tailTopMip;
+		}
+
+		const PtrSize memory = tex->computeStreamedMemory(s.m_topMip);
+		residentMemory += memory;
+
+		if(tex->isStreamingInFlight())
+		{
+			// Count it as if it's done
+			projectedMemory += tex->computeStreamedMemory(s.m_inFlightTopMip);
+			return;
+		}
+
+		if(s.m_wantedTopMip < s.m_topMip && streamCount < MAX_STREAMS_PER_FRAME)
+		{
+			// Load bigger mips if they fit in the budget
+			const PtrSize newMemory = tex->computeStreamedMemory(s.m_wantedTopMip);
+			if(prevProjectedMemory + newMemory - memory <= m_budget)
+			{
+				prevProjectedMemory += newMemory - memory;
+				projectedMemory += newMemory;
+				++streamCount;
+				tex->startStreaming(s.m_wantedTopMip);
+				return;
+			}
+		}
+		else if(s.m_wantedTopMip > s.m_topMip && prevProjectedMemory > m_budget
+				&& streamCount < MAX_STREAMS_PER_FRAME)
+		{
+			// Over the budget, evict the mips that are not wanted
+			const PtrSize newMemory = tex->computeStreamedMemory(s.m_wantedTopMip);
+			prevProjectedMemory -= memory - newMemory;
+			projectedMemory += newMemory;
+			++streamCount;
+			tex->startStreaming(s.m_wantedTopMip);
+			return;
+		}
+
+		projectedMemory += memory;
+	});
+
+	m_residentMemory = residentMemory;
+	m_projectedMemory = projectedMemory;
+}
+
+} // end namespace anki
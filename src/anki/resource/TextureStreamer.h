@@ -0,0 +1,78 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/resource/Common.h>
+
+namespace anki
+{
+
+// Forward
+class ConfigSet;
+
+/// @addtogroup resource
+/// @{
+
+/// Loads and evicts the top mips of the streamed textures. The streamed textures start with the tail mips. Once per
+/// frame the streamer looks at the sizes the scene asked with TextureResource::requestResidency() and loads the bigger
+/// mips in the AsyncLoader. When the streamed textures use more memory than the budget the mips that are not needed
+/// any more are evicted.
+class TextureStreamer : public NonCopyable
+{
+public:
+	TextureStreamer(ResourceManager* manager);
+
+	~TextureStreamer();
+
+	void init(const ConfigSet& config);
+
+	Bool isEnabled() const
+	{
+		return m_enabled;
+	}
+
+	/// The biggest size of the tail mips. The streamed textures start with them.
+	U32 getTailSize() const
+	{
+		return m_tailSize;
+	}
+
+	/// Convert the size of a renderable on the screen to the texels its textures need.
+	/// @param screenSize The diameter of the renderable as a fraction of the screen height.
+	U32 computeRequestedSize(F32 screenSize) const
+	{
+		return U32(max(screenSize, 0.0f) * F32(m_screenHeight));
+	}
+
+	/// Apply the mips that finished loading and start loading or evicting more. Call it once per frame when nothing
+	/// renders.
+	void update();
+
+	/// Get the GPU memory of the resident mips of the streamed textures. Updated by update().
+	PtrSize getResidentMemory() const
+	{
+		return m_residentMemory;
+	}
+
+private:
+	/// Frames without requests before the streamer lowers the wanted mips of a texture.
+	static constexpr U64 REQUEST_TIMEOUT_FRAMES = 60;
+
+	/// The textures that start loading or evicting mips in a frame.
+	static constexpr U32 MAX_STREAMS_PER_FRAME = 8;
+
+	ResourceManager* m_manager;
+	PtrSize m_budget = 0;
+	U32 m_tailSize = 0;
+	U32 m_screenHeight = 0;
+	U64 m_frame = 0;
+	PtrSize m_residentMemory = 0;
+	PtrSize m_projectedMemory = 0; ///< The memory when all the loads in flight finish.
+	Bool m_enabled = false;
+};
+/// @}
+
+} // end namespace anki
@@ -8,164 +8,146 @@
 #include <anki/gr/Buffer.h>
 #include <anki/gr/GrManager.h>
 #include <anki/util/Tracer.h>
+#include <anki/util/HighRezTimer.h>
 
 namespace anki
 {
 
-class TransferGpuAllocator::Memory : public StackGpuAllocatorMemory
+TransferGpuAllocator::TransferGpuAllocator()
 {
-public:
-	BufferPtr m_buffer;
-	void* m_mappedMemory;
-};
+}
 
-class TransferGpuAllocator::Interface : public StackGpuAllocatorInterface
+TransferGpuAllocator::~TransferGpuAllocator()
 {
-public:
-	GrManager* m_gr;
-	ResourceAllocator<U8> m_alloc;
-
-	ResourceAllocator<U8> getAllocator() const
+	for(const Allocation& allocation : m_allocations)
 	{
-		return m_alloc;
+		ANKI_ASSERT(allocation.m_released && "Forgot to release");
+		(void)allocation;
 	}
+	m_allocations.destroy(m_alloc);
 
-	ANKI_USE_RESULT Error allocate(PtrSize size, StackGpuAllocatorMemory*& mem) final
+	if(m_mappedMemory)
 	{
-		TransferGpuAllocator::Memory* mm = m_alloc.newInstance<TransferGpuAllocator::Memory>();
+		m_buffer->unmap();
+	}
+}
 
-		mm->m_buffer = m_gr->newBuffer(
-			BufferInitInfo(size, BufferUsageBit::BUFFER_UPLOAD_SOURCE, BufferMapAccessBit::WRITE, "Transfer"));
-		mm->m_mappedMemory = mm->m_buffer->map(0, size, BufferMapAccessBit::WRITE);
+Error TransferGpuAllocator::init(PtrSize maxSize, PtrSize frameBudget, GrManager* gr, ResourceAllocator<U8> alloc)
+{
+	m_alloc = alloc;
+	m_gr = gr;
+	m_frameBudget = frameBudget;
 
-		mem = mm;
-		return Error::NONE;
-	}
+	m_size = getAlignedRoundUp(ALIGNMENT, maxSize);
+	ANKI_RESOURCE_LOGI("Will use %luMB of memory for transfer scratch", m_size / 1024 / 1024);
 
-	void free(StackGpuAllocatorMemory* mem) final
-	{
-		ANKI_ASSERT(mem);
+	m_buffer = m_gr->newBuffer(
+		BufferInitInfo(m_size, BufferUsageBit::BUFFER_UPLOAD_SOURCE, BufferMapAccessBit::WRITE, "Transfer"));
+	m_mappedMemory = static_cast<U8*>(m_buffer->map(0, m_size, BufferMapAccessBit::WRITE));
 
-		TransferGpuAllocator::Memory* mm = static_cast<TransferGpuAllocator::Memory*>(mem);
-		if(mm->m_mappedMemory)
-		{
-			mm->m_buffer->unmap();
-		}
-		m_alloc.deleteInstance(mm);
-	}
+	return Error::NONE;
+}
 
-	void getChunkGrowInfo(F32& scale, PtrSize& bias, PtrSize& initialSize) final
+Bool TransferGpuAllocator::tryAllocate(PtrSize size, PtrSize& offset, PtrSize& consumed)
+{
+	if(m_used == 0)
 	{
-		scale = 1.5;
-		bias = 0;
-		initialSize = TransferGpuAllocator::CHUNK_INITIAL_SIZE;
+		// Empty, start from the beginning to have as much contiguous space as possible
+		m_head = 0;
+		m_tail = 0;
 	}
 
-	U32 getMaxAlignment() final
+	if(m_head >= m_tail && m_used < m_size)
 	{
-		return 16;
+		// The free space is [head, size) and [0, tail)
+		if(m_size - m_head >= size)
+		{
+			offset = m_head;
+			consumed = size;
+		}
+		else if(m_tail >= size)
+		{
+			// Wrap around and waste the end of the ring
+			offset = 0;
+			consumed = m_size - m_head + size;
+		}
+		else
+		{
+			return false;
+		}
 	}
-};
-
-BufferPtr TransferGpuAllocatorHandle::getBuffer() const
-{
-	ANKI_ASSERT(m_handle.m_memory);
-	const TransferGpuAllocator::Memory* mm = static_cast<const TransferGpuAllocator::Memory*>(m_handle.m_memory);
-	ANKI_ASSERT(mm->m_buffer);
-	return mm->m_buffer;
-}
-
-void* TransferGpuAllocatorHandle::getMappedMemory() const
-{
-	ANKI_ASSERT(m_handle.m_memory);
-	const TransferGpuAllocator::Memory* mm = static_cast<const TransferGpuAllocator::Memory*>(m_handle.m_memory);
-	ANKI_ASSERT(mm->m_mappedMemory);
-	return static_cast<U8*>(mm->m_mappedMemory) + m_handle.m_offset;
-}
-
-TransferGpuAllocator::TransferGpuAllocator()
-{
-}
-
-TransferGpuAllocator::~TransferGpuAllocator()
-{
-	for(Frame& frame : m_frames)
+	else if(m_head < m_tail && m_tail - m_head >= size)
 	{
-		ANKI_ASSERT(frame.m_pendingReleases == 0);
-		frame.m_fences.destroy(m_alloc);
+		offset = m_head;
+		consumed = size;
 	}
-}
-
-Error TransferGpuAllocator::init(PtrSize maxSize, GrManager* gr, ResourceAllocator<U8> alloc)
-{
-	m_alloc = alloc;
-	m_gr = gr;
-
-	m_maxAllocSize = getAlignedRoundUp(CHUNK_INITIAL_SIZE * FRAME_COUNT, maxSize);
-	ANKI_RESOURCE_LOGI("Will use %luMB of memory for transfer scratch", m_maxAllocSize / 1024 / 1024);
-
-	m_interface.reset(m_alloc.newInstance<Interface>());
-	m_interface->m_gr = gr;
-	m_interface->m_alloc = alloc;
-
-	for(Frame& frame : m_frames)
+	else
 	{
-		frame.m_stackAlloc.init(m_alloc, m_interface.get());
+		return false;
 	}
 
-	return Error::NONE;
+	m_head = (offset + size) % m_size;
+	m_used += consumed;
+	return true;
 }
 
 Error TransferGpuAllocator::allocate(PtrSize size, TransferGpuAllocatorHandle& handle)
 {
 	ANKI_TRACE_SCOPED_EVENT(RSRC_ALLOCATE_TRANSFER);
+	ANKI_ASSERT(size > 0);
 
-	const PtrSize frameSize = m_maxAllocSize / FRAME_COUNT;
+	size = getAlignedRoundUp(ALIGNMENT, size);
+	if(size > m_size)
+	{
+		ANKI_RESOURCE_LOGE("Transfer allocation bigger than the transfer scratch memory: %lu", size);
+		return Error::OUT_OF_MEMORY;
+	}
 
 	LockGuard<Mutex> lock(m_mtx);
 
-	Frame* frame;
-	if(m_crntFrameAllocatedSize + size <= frameSize)
-	{
-		// Have enough space in the frame
+	reclaim();
 
-		frame = &m_frames[m_frameCount];
-	}
-	else
+	PtrSize offset, consumed;
+	Second stallBegin = 0.0;
+	while(!tryAllocate(size, offset, consumed))
 	{
-		// Don't have enough space. Wait for next frame
-
-		m_frameCount = U8((m_frameCount + 1) % FRAME_COUNT);
-		Frame& nextFrame = m_frames[m_frameCount];
+		if(stallBegin == 0.0)
+		{
+			stallBegin = HighRezTimer::getCurrentTime();
+			++m_stats.m_stallCount;
+		}
 
-		// Wait for all memory to be released
-		while(nextFrame.m_pendingReleases != 0)
+		// Not enough space. Wait for the oldest allocation to be released and then for the GPU to finish with it
+		ANKI_ASSERT(!m_allocations.isEmpty());
+		const Allocation& oldest = m_allocations.getFront();
+		if(!oldest.m_released)
 		{
 			m_condVar.wait(m_mtx);
 		}
-
-		// Wait all fences
-		while(!nextFrame.m_fences.isEmpty())
+		else if(oldest.m_fence->clientWait(MAX_FENCE_WAIT_TIME))
 		{
-			FencePtr fence = nextFrame.m_fences.getFront();
-
-			const Bool done = fence->clientWait(MAX_FENCE_WAIT_TIME);
-			if(done)
-			{
-				nextFrame.m_fences.popFront(m_alloc);
-			}
+			reclaimOldest();
 		}
-
-		nextFrame.m_stackAlloc.reset();
-		m_crntFrameAllocatedSize = 0;
-		frame = &nextFrame;
 	}
 
-	ANKI_CHECK(frame->m_stackAlloc.allocate(size, handle.m_handle));
+	Allocation& allocation = *m_allocations.emplaceBack(m_alloc);
+	allocation.m_end = m_head;
+	allocation.m_consumed = consumed;
+
+	handle.m_buffer = m_buffer;
+	handle.m_mappedMemory = m_mappedMemory + offset;
+	handle.m_offset = offset;
 	handle.m_range = size;
-	handle.m_frame = U8(frame - &m_frames[0]);
-	m_crntFrameAllocatedSize += size;
-	++frame->m_pendingReleases;
+	handle.m_allocation = &allocation;
+
+	m_crntBudgetFrameAllocatedSize += size;
+
+	++m_stats.m_allocationCount;
+	m_stats.m_allocatedSize += size;
+	if(stallBegin != 0.0)
+	{
+		m_stats.m_stallTime += HighRezTimer::getCurrentTime() - stallBegin;
+	}
 
 	return Error::NONE;
 }
@@ -175,20 +157,54 @@ void TransferGpuAllocator::release(TransferGpuAllocatorHandle& handle, FencePtr
 	ANKI_ASSERT(fence);
 	ANKI_ASSERT(handle.valid());
 
-	Frame& frame = m_frames[handle.m_frame];
-
 	{
 		LockGuard<Mutex> lock(m_mtx);
 
-		frame.m_fences.pushBack(m_alloc, fence);
+		Allocation& allocation = *static_cast<Allocation*>(handle.m_allocation);
+		ANKI_ASSERT(!allocation.m_released);
+		allocation.m_fence = fence;
+		allocation.m_released = true;
 
-		ANKI_ASSERT(frame.m_pendingReleases > 0);
-		--frame.m_pendingReleases;
-
-		m_condVar.notifyOne();
+		m_condVar.notifyAll();
 	}
 
 	handle.invalidate();
 }
 
+void TransferGpuAllocator::reclaim()
+{
+	while(!m_allocations.isEmpty())
+	{
+		const Allocation& oldest = m_allocations.getFront();
+		if(!oldest.m_released || !oldest.m_fence->clientWait(0.0))
+		{
+			break;
+		}
+
+		reclaimOldest();
+	}
+}
+
+void TransferGpuAllocator::reclaimOldest()
+{
+	const Allocation& oldest = m_allocations.getFront();
+	ANKI_ASSERT(oldest.m_released && m_used >= oldest.m_consumed);
+	m_tail = oldest.m_end;
+	m_used -= oldest.m_consumed;
+	m_allocations.popFront(m_alloc);
+}
+
+Bool TransferGpuAllocator::frameBudgetExhausted() const
+{
+	LockGuard<Mutex> lock(m_mtx);
+	return m_frameBudget > 0 && m_crntBudgetFrameAllocatedSize >= m_frameBudget;
+}
+
+void TransferGpuAllocator::endFrame()
+{
+	LockGuard<Mutex> lock(m_mtx);
+	m_crntBudgetFrameAllocatedSize = 0;
+	reclaim();
+}
+
 } // end namespace anki
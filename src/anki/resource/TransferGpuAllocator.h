@@ -6,7 +6,8 @@
 #pragma once
 
 #include <anki/resource/Common.h>
-#include <anki/gr/utils/StackGpuAllocator.h>
+#include <anki/gr/Buffer.h>
+#include <anki/util/Thread.h>
 #include <anki/util/List.h>
 
 namespace anki
@@ -39,64 +40,89 @@ public:
 
 	TransferGpuAllocatorHandle& operator=(TransferGpuAllocatorHandle&& b)
 	{
-		m_handle = b.m_handle;
+		m_buffer = std::move(b.m_buffer);
+		m_mappedMemory = b.m_mappedMemory;
+		m_offset = b.m_offset;
 		m_range = b.m_range;
-		m_frame = b.m_frame;
+		m_allocation = b.m_allocation;
 		b.invalidate();
 		return *this;
 	}
 
-	BufferPtr getBuffer() const;
+	BufferPtr getBuffer() const
+	{
+		ANKI_ASSERT(valid());
+		return m_buffer;
+	}
 
-	void* getMappedMemory() const;
+	void* getMappedMemory() const
+	{
+		ANKI_ASSERT(valid());
+		return m_mappedMemory;
+	}
 
 	PtrSize getOffset() const
 	{
-		ANKI_ASSERT(m_handle);
-		return m_handle.m_offset;
+		ANKI_ASSERT(valid());
+		return m_offset;
 	}
 
 	PtrSize getRange() const
 	{
-		ANKI_ASSERT(m_handle);
+		ANKI_ASSERT(valid());
 		ANKI_ASSERT(m_range != 0);
 		return m_range;
 	}
 
 private:
-	StackGpuAllocatorHandle m_handle;
+	BufferPtr m_buffer;
+	void* m_mappedMemory = nullptr;
+	PtrSize m_offset = 0;
 	PtrSize m_range = 0;
-	U8 m_frame = MAX_U8;
+	void* m_allocation = nullptr; ///< The TransferGpuAllocator::Allocation.
 
 	Bool valid() const
 	{
-		return m_range != 0 && m_frame < MAX_U8;
+		return m_range != 0 && m_allocation != nullptr;
 	}
 
 	void invalidate()
 	{
-		m_handle.m_memory = nullptr;
-		m_handle.m_offset = 0;
+		m_buffer.reset(nullptr);
+		m_mappedMemory = nullptr;
+		m_offset = 0;
 		m_range = 0;
-		m_frame = MAX_U8;
+		m_allocation = nullptr;
 	}
 };
 
-/// GPU memory allocator for GPU buffers used in transfer operations.
-class TransferGpuAllocator
+/// The statistics of a TransferGpuAllocator. @memberof TransferGpuAllocator
+class TransferGpuAllocatorStats
 {
-	friend class TransferGpuAllocatorHandle;
+public:
+	U64 m_allocationCount = 0;
+	PtrSize m_allocatedSize = 0;
+	U64 m_stallCount = 0; ///< The allocations that had to wait for memory to be released.
+	Second m_stallTime = 0.0; ///< The time the allocations waited. Summed.
+};
 
+/// GPU memory allocator for GPU buffers used in transfer operations. It's a ring buffer on top of a single mapped
+/// buffer. The allocations are reclaimed in the order they were made, once they are released and the GPU is done with
+/// them. The big uploads should be split in a few allocations and spread over many frames with frameBudgetExhausted().
+class TransferGpuAllocator
+{
 public:
-	static const U32 FRAME_COUNT = 3;
-	static const PtrSize CHUNK_INITIAL_SIZE = 64_MB;
+	static constexpr U32 ALIGNMENT = 16;
 	static constexpr Second MAX_FENCE_WAIT_TIME = 500.0_ms;
 
 	TransferGpuAllocator();
 
 	~TransferGpuAllocator();
 
-	ANKI_USE_RESULT Error init(PtrSize maxSize, GrManager* gr, ResourceAllocator<U8> alloc);
+	/// @param maxSize The size of the ring buffer. It's also the biggest allocation.
+	/// @param frameBudget The bytes that can be allocated in a frame before frameBudgetExhausted() returns true. Zero
+	///                    means no limit.
+	ANKI_USE_RESULT Error init(PtrSize maxSize, PtrSize frameBudget, GrManager* gr, ResourceAllocator<U8> alloc);
 
 	/// Allocate some transfer memory. If there is not enough memory it will block until some is releaced. It's
 	/// threadsafe.
@@ -105,29 +131,57 @@ public:
 	/// Release the memory. It will not be recycled before the fence is signaled. It's threadsafe.
 	void release(TransferGpuAllocatorHandle& handle, FencePtr fence);
 
-private:
-	class Interface;
-	class Memory;
+	/// The uploads can check it and postpone their work to the next frame. It's threadsafe.
+	Bool frameBudgetExhausted() const;
 
-	ResourceAllocator<U8> m_alloc;
-	GrManager* m_gr = nullptr;
-	PtrSize m_maxAllocSize = 0;
+	/// Reset the budget and recycle the memory of the finished transfers. Call it once every frame.
+	void endFrame();
 
-	UniquePtr<Interface> m_interface;
+	/// The biggest allocation.
+	PtrSize getMaxAllocationSize() const
+	{
+		return m_size;
+	}
+
+	/// Get the statistics since the allocator was created. It's threadsafe.
+	TransferGpuAllocatorStats getStats() const
+	{
+		LockGuard<Mutex> lock(m_mtx);
+		return m_stats;
+	}
 
-	class Frame
+private:
+	class Allocation
 	{
 	public:
-		StackGpuAllocator m_stackAlloc;
-		List<FencePtr> m_fences;
-		U32 m_pendingReleases = 0;
+		FencePtr m_fence;
+		PtrSize m_end; ///< Where the tail of the ring goes after it's reclaimed.
+		PtrSize m_consumed; ///< The size plus the unused space at the end of the ring if it wrapped around.
+		Bool m_released = false;
 	};
 
-	Mutex m_mtx; ///< Protect all members bellow.
+	ResourceAllocator<U8> m_alloc;
+	GrManager* m_gr = nullptr;
+	BufferPtr m_buffer;
+	U8* m_mappedMemory = nullptr;
+	PtrSize m_size = 0;
+	PtrSize m_frameBudget = 0;
+
+	mutable Mutex m_mtx; ///< Protect all members bellow.
 	ConditionVariable m_condVar;
-	Array<Frame, FRAME_COUNT> m_frames;
-	U8 m_frameCount = 0;
-	PtrSize m_crntFrameAllocatedSize = 0;
+	List<Allocation> m_allocations; ///< In the order they were made.
+	PtrSize m_head = 0;
+	PtrSize m_tail = 0;
+	PtrSize m_used = 0;
+	PtrSize m_crntBudgetFrameAllocatedSize = 0; ///< What was allocated since the last endFrame().
+	TransferGpuAllocatorStats m_stats;
+
+	Bool tryAllocate(PtrSize size, PtrSize& offset, PtrSize& consumed);
+
+	/// Reclaim the oldest allocations that the GPU is done with.
+	void reclaim();
+
+	void reclaimOldest();
 };
 /// @}
 
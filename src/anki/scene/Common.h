@@ -7,6 +7,7 @@
 
 #include <anki/util/Allocator.h>
 #include <anki/util/String.h>
+#include <anki/util/ObjectAllocator.h>
 #include <anki/scene/Forward.h>
 
 namespace anki
@@ -35,6 +36,9 @@ using SceneAllocator = HeapAllocator<T>;
 /// The type of the scene's frame allocator
 template<typename T>
 using SceneFrameAllocator = StackAllocator<T>;
+
+/// The type of the allocator that packs the scene objects of the same type together.
+using SceneObjectAllocator = TypedObjectAllocator<64>;
 /// @}
 
 } // end namespace anki
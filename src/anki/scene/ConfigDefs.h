@@ -8,3 +8,81 @@ ANKI_CONFIG_OPTION(
 ANKI_CONFIG_OPTION(scene_reflectionProbeEffectiveDistance, 256.0, 1.0, MAX_F64, "How far reflection probes can look")
 ANKI_CONFIG_OPTION(
 	scene_reflectionProbeShadowEffectiveDistance, 32.0, 1.0, MAX_F64, "How far to render shadows for reflection probes")
+ANKI_CONFIG_OPTION(scene_looseOctree, 0, 0, 1, "Use a loose octree for the visibility tests")
+ANKI_CONFIG_OPTION(
+	scene_animationLodDistance0, 20.0, 0.0, MAX_F64, "Skins farther than that from the camera are animated every 2 frames")
+ANKI_CONFIG_OPTION(scene_animationLodDistance1,
+	50.0,
+	0.0,
+	MAX_F64,
+	"Skins farther than that from the camera are animated every 4 frames and only their top bones")
+ANKI_CONFIG_OPTION(scene_animationLodMaxBoneDepth,
+	3u,
+	0u,
+	U32(MAX_U8),
+	"The bones that are deeper than that in the hierarchy are not animated in the last animation LOD")
+ANKI_CONFIG_OPTION(scene_particleLodDistance0,
+	20.0,
+	0.0,
+	MAX_F64,
+	"GPU particle emitters farther than that from the camera emit at half the rate")
+ANKI_CONFIG_OPTION(scene_particleLodDistance1,
+	50.0,
+	0.0,
+	MAX_F64,
+	"GPU particle emitters farther than that from the camera emit at a quarter of the rate")
+ANKI_CONFIG_OPTION(scene_physicsLodDistance0,
+	30.0,
+	0.0,
+	MAX_F64,
+	"Player controllers farther than that from the camera are updated every 2 physics steps")
+ANKI_CONFIG_OPTION(scene_physicsLodDistance1,
+	80.0,
+	0.0,
+	MAX_F64,
+	"Dynamic bodies farther than that from the camera sleep and player controllers are updated every 4 steps")
+ANKI_CONFIG_OPTION(scene_lodScreenSize0,
+	0.1,
+	0.0,
+	1.0,
+	"Renderables that cover less than that fraction of the screen height switch to LOD 1")
+ANKI_CONFIG_OPTION(scene_lodScreenSize1,
+	0.05,
+	0.0,
+	1.0,
+	"Renderables that cover less than that fraction of the screen height switch to LOD 2")
+ANKI_CONFIG_OPTION(scene_lodScreenSize2,
+	0.025,
+	0.0,
+	1.0,
+	"Renderables that cover less than that fraction of the screen height switch to LOD 3")
+ANKI_CONFIG_OPTION(scene_lodHysteresis,
+	0.1,
+	0.0,
+	0.5,
+	"How much the screen size should overshoot a LOD threshold before switching. It's a fraction of the threshold")
+ANKI_CONFIG_OPTION(
+	scene_lodCrossFadeFrameCount, 16, 0, 256, "The number of frames it takes to cross-fade between LODs. 0 disables it")
+ANKI_CONFIG_OPTION(scene_transparencySortDistance,
+	0.0,
+	0.0,
+	MAX_F64,
+	"Sort the transparent renderables back to front in slices of that distance and merge the ones of the same material "
+	"in a slice. 0 sorts them exactly and merges nothing")
+ANKI_CONFIG_OPTION(scene_streamingLoadDistance,
+	200.0,
+	0.0,
+	MAX_F64,
+	"World sectors nearer than that to the camera are streamed in")
+ANKI_CONFIG_OPTION(scene_streamingUnloadDistance,
+	250.0,
+	0.0,
+	MAX_F64,
+	"World sectors farther than that from the camera are streamed out. Should be bigger than the load distance")
+ANKI_CONFIG_OPTION(
+	scene_streamingMemoryBudget, 512u, 1u, MAX_U32, "The memory in MB the streamed world sectors can use all together")
+ANKI_CONFIG_OPTION(scene_streamingFrameTimeBudget,
+	2.0,
+	0.0,
+	1000.0,
+	"The time in ms the world streaming can spend every frame to create and delete nodes")
@@ -13,9 +13,16 @@
 namespace anki
 {
 
+DebugDrawer::~DebugDrawer()
+{
+	m_retainedVerts.destroy(m_alloc);
+}
+
 Error DebugDrawer::init(ResourceManager* rsrcManager)
 {
 	ANKI_ASSERT(rsrcManager);
+	m_alloc = rsrcManager->getAllocator();
+	m_gr = &rsrcManager->getGrManager();
 
 	// Create the prog and shaders
 	ANKI_CHECK(rsrcManager->loadResource("shaders/SceneDebug.ankiprog", m_prog));
@@ -28,13 +35,33 @@ void DebugDrawer::prepareFrame(RenderQueueDrawContext* ctx)
 	m_ctx = ctx;
 }
 
+void DebugDrawer::setColor(const Vec4& col)
+{
+	m_crntCol = col;
+
+	const Vec4 c = col.clamp(0.0f, 1.0f) * 255.0f;
+	m_crntColPacked = U32(c.x()) | (U32(c.y()) << 8u) | (U32(c.z()) << 16u) | (U32(c.w()) << 24u);
+}
+
 void DebugDrawer::flush()
 {
-	if(m_cachedPositionCount == 0)
+	if(m_cachedVertCount == 0)
 	{
 		return;
 	}
 
+	const U32 size = m_cachedVertCount * sizeof(Vertex);
+	StagingGpuMemoryToken token;
+	void* mem = m_ctx->m_stagingGpuAllocator->allocateFrame(size, StagingGpuMemoryType::VERTEX, token);
+	memcpy(mem, &m_cachedVerts[0], size);
+
+	draw(token.m_buffer, token.m_offset, m_cachedVertCount, m_mvpMat);
+
+	m_cachedVertCount = 0;
+}
+
+void DebugDrawer::draw(BufferPtr vertBuff, PtrSize vertBuffOffset, U32 vertCount, const Mat4& mvp)
+{
 	CommandBufferPtr& cmdb = m_ctx->m_commandBuffer;
 
 	// Bind program
@@ -43,39 +70,32 @@ void DebugDrawer::flush()
 		variantInitInfo.addMutation("COLOR_TEXTURE", 0);
 		variantInitInfo.addMutation(
 			"DITHERED_DEPTH_TEST", m_ctx->m_debugDrawFlags.get(RenderQueueDebugDrawFlag::DITHERED_DEPTH_TEST_ON));
-		variantInitInfo.addConstant("INSTANCE_COUNT", 1u);
+		variantInitInfo.addMutation("VERTEX_COLOR", 1);
 		const ShaderProgramResourceVariant* variant;
 		m_prog->getOrCreateVariant(variantInitInfo, variant);
 		cmdb->bindShaderProgram(variant->getProgram());
 	}
 
 	// Set vertex state
-	{
-		const U32 size = m_cachedPositionCount * sizeof(Vec3);
-
-		StagingGpuMemoryToken token;
-		void* mem = m_ctx->m_stagingGpuAllocator->allocateFrame(size, StagingGpuMemoryType::VERTEX, token);
-		memcpy(mem, &m_cachedPositions[0], size);
-
-		cmdb->bindVertexBuffer(0, token.m_buffer, token.m_offset, sizeof(Vec3));
-		cmdb->setVertexAttribute(0, 0, Format::R32G32B32_SFLOAT, 0);
-	}
+	cmdb->bindVertexBuffer(0, vertBuff, vertBuffOffset, sizeof(Vertex));
+	cmdb->setVertexAttribute(0, 0, Format::R32G32B32_SFLOAT, 0);
+	cmdb->setVertexAttribute(1, 0, Format::R8G8B8A8_UNORM, sizeof(Vec3));
 
-	// Set uniform state
+	// Set the instance. The color is in the vertices
 	{
-		struct Uniforms
+		struct Instance
 		{
-			Mat4 m_mvp;
 			Vec4 m_color;
+			Mat4 m_mvp;
 		};
 
 		StagingGpuMemoryToken token;
-		Uniforms* uniforms = static_cast<Uniforms*>(
-			m_ctx->m_stagingGpuAllocator->allocateFrame(sizeof(Uniforms), StagingGpuMemoryType::UNIFORM, token));
-		uniforms->m_mvp = m_mvpMat;
-		uniforms->m_color = m_crntCol;
+		Instance* instance = static_cast<Instance*>(
+			m_ctx->m_stagingGpuAllocator->allocateFrame(sizeof(Instance), StagingGpuMemoryType::STORAGE, token));
+		instance->m_color = Vec4(1.0f);
+		instance->m_mvp = mvp;
 
-		cmdb->bindUniformBuffer(1, 0, token.m_buffer, token.m_offset, token.m_range);
+		cmdb->bindStorageBuffer(1, 0, token.m_buffer, token.m_offset, token.m_range);
 	}
 
 	const Bool enableDepthTest = m_ctx->m_debugDrawFlags.get(RenderQueueDebugDrawFlag::DEPTH_TEST_ON);
@@ -90,16 +110,58 @@ void DebugDrawer::flush()
 
 	// Draw
 	cmdb->setLineWidth(1.0f);
-	cmdb->drawArrays(m_topology, m_cachedPositionCount);
+	cmdb->drawArrays(m_topology, vertCount);
 
 	// Restore state
 	if(!enableDepthTest)
 	{
 		cmdb->setDepthCompareOperation(CompareOperation::LESS);
 	}
+}
 
-	// Other
-	m_cachedPositionCount = 0;
+void DebugDrawer::beginRetained()
+{
+	ANKI_ASSERT(!m_recording);
+	flush();
+	m_recording = true;
+	m_retainedVerts.destroy(m_alloc);
+}
+
+void DebugDrawer::endRetained()
+{
+	ANKI_ASSERT(m_recording);
+	m_recording = false;
+
+	m_retainedVertCount = m_retainedVerts.getSize();
+	if(m_retainedVertCount == 0)
+	{
+		m_retainedVertBuff.reset(nullptr);
+		return;
+	}
+
+	const PtrSize size = m_retainedVerts.getSizeInBytes();
+	m_retainedVertBuff =
+		m_gr->newBuffer(BufferInitInfo(size, BufferUsageBit::VERTEX, BufferMapAccessBit::WRITE, "DebugDrawerRetained"));
+
+	void* mem = m_retainedVertBuff->map(0, size, BufferMapAccessBit::WRITE);
+	memcpy(mem, &m_retainedVerts[0], size);
+	m_retainedVertBuff->unmap();
+
+	m_retainedVerts.destroy(m_alloc);
+}
+
+void DebugDrawer::drawRetained()
+{
+	ANKI_ASSERT(!m_recording && m_ctx);
+	if(m_retainedVertCount == 0)
+	{
+		return;
+	}
+
+	// The recorded vertices are in world space
+	setTopology(PrimitiveTopology::LINES);
+	flush();
+	draw(m_retainedVertBuff, 0, m_retainedVertCount, m_vpMat);
 }
 
 void DebugDrawer::drawLine(const Vec3& from, const Vec3& to, const Vec4& color)
@@ -353,21 +415,20 @@ void DebugDrawer2::drawCubes(ConstWeakArray<Mat4> mvps,
 	indices[indexCount++] = 3;
 	indices[indexCount++] = 7;
 
-	// Set the uniforms
-	StagingGpuMemoryToken unisToken;
-	Mat4* pmvps = static_cast<Mat4*>(stagingGpuAllocator.allocateFrame(
-		sizeof(Mat4) * mvps.getSize() + sizeof(Vec4), StagingGpuMemoryType::UNIFORM, unisToken));
+	// Set the instances
+	StagingGpuMemoryToken instancesToken;
+	Vec4* pcolor = static_cast<Vec4*>(stagingGpuAllocator.allocateFrame(
+		sizeof(Vec4) + sizeof(Mat4) * mvps.getSize(), StagingGpuMemoryType::STORAGE, instancesToken));
+	*pcolor = color;
 
+	Mat4* pmvps = reinterpret_cast<Mat4*>(pcolor + 1);
 	memcpy(pmvps, &mvps[0], mvps.getSizeInBytes());
 
-	Vec4* pcolor = reinterpret_cast<Vec4*>(pmvps + mvps.getSize());
-	*pcolor = color;
-
 	// Setup state
 	ShaderProgramResourceVariantInitInfo variantInitInfo(m_prog);
 	variantInitInfo.addMutation("COLOR_TEXTURE", 0);
 	variantInitInfo.addMutation("DITHERED_DEPTH_TEST", U32(ditherFailedDepth != 0));
-	variantInitInfo.addConstant("INSTANCE_COUNT", mvps.getSize());
+	variantInitInfo.addMutation("VERTEX_COLOR", 0);
 	const ShaderProgramResourceVariant* variant;
 	m_prog->getOrCreateVariant(variantInitInfo, variant);
 	cmdb->bindShaderProgram(variant->getProgram());
@@ -376,7 +437,7 @@ void DebugDrawer2::drawCubes(ConstWeakArray<Mat4> mvps,
 	cmdb->bindVertexBuffer(0, vertsToken.m_buffer, vertsToken.m_offset, sizeof(Vec3));
 	cmdb->bindIndexBuffer(indicesToken.m_buffer, indicesToken.m_offset, IndexType::U16);
 
-	cmdb->bindUniformBuffer(1, 0, unisToken.m_buffer, unisToken.m_offset, unisToken.m_range);
+	cmdb->bindStorageBuffer(1, 0, instancesToken.m_buffer, instancesToken.m_offset, instancesToken.m_range);
 
 	cmdb->setLineWidth(lineSize);
 	cmdb->drawElements(PrimitiveTopology::LINES, indexCount, mvps.getSize());
@@ -411,10 +472,13 @@ void DebugDrawer2::drawBillboardTextures(const Mat4& projMat,
 	uvs[2] = Vec2(0.0f, 1.0f);
 	uvs[3] = Vec2(1.0f, 1.0f);
 
-	// Set the uniforms
-	StagingGpuMemoryToken unisToken;
-	Mat4* pmvps = static_cast<Mat4*>(stagingGpuAllocator.allocateFrame(
-		sizeof(Mat4) * positions.getSize() + sizeof(Vec4), StagingGpuMemoryType::UNIFORM, unisToken));
+	// Set the instances
+	StagingGpuMemoryToken instancesToken;
+	Vec4* pcolor = static_cast<Vec4*>(stagingGpuAllocator.allocateFrame(
+		sizeof(Vec4) + sizeof(Mat4) * positions.getSize(), StagingGpuMemoryType::STORAGE, instancesToken));
+	*pcolor = color;
+
+	Mat4* pmvps = reinterpret_cast<Mat4*>(pcolor + 1);
 
 	const Mat4 camTrf = viewMat.getInverse();
 	const Vec3 zAxis = camTrf.getZAxis().xyz().getNormalized();
@@ -434,14 +498,11 @@ void DebugDrawer2::drawBillboardTextures(const Mat4& projMat,
 		++pmvps;
 	}
 
-	Vec4* pcolor = reinterpret_cast<Vec4*>(pmvps);
-	*pcolor = color;
-
 	// Setup state
 	ShaderProgramResourceVariantInitInfo variantInitInfo(m_prog);
 	variantInitInfo.addMutation("COLOR_TEXTURE", 1);
 	variantInitInfo.addMutation("DITHERED_DEPTH_TEST", U32(ditherFailedDepth != 0));
-	variantInitInfo.addConstant("INSTANCE_COUNT", positions.getSize());
+	variantInitInfo.addMutation("VERTEX_COLOR", 0);
 	const ShaderProgramResourceVariant* variant;
 	m_prog->getOrCreateVariant(variantInitInfo, variant);
 	cmdb->bindShaderProgram(variant->getProgram());
@@ -451,7 +512,7 @@ void DebugDrawer2::drawBillboardTextures(const Mat4& projMat,
 	cmdb->bindVertexBuffer(0, positionsToken.m_buffer, positionsToken.m_offset, sizeof(Vec3));
 	cmdb->bindVertexBuffer(1, uvsToken.m_buffer, uvsToken.m_offset, sizeof(Vec2));
 
-	cmdb->bindUniformBuffer(1, 0, unisToken.m_buffer, unisToken.m_offset, unisToken.m_range);
+	cmdb->bindStorageBuffer(1, 0, instancesToken.m_buffer, instancesToken.m_offset, instancesToken.m_range);
 	cmdb->bindSampler(1, 1, sampler);
 	cmdb->bindTexture(1, 2, tex, TextureUsageBit::SAMPLED_FRAGMENT);
 
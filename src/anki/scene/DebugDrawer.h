@@ -23,10 +23,14 @@ class StagingGpuMemoryToken;
 /// @addtogroup renderer
 /// @{
 
-/// Draws simple primitives
+/// Draws simple primitives. The primitives are batched and a drawcall is issued only when the topology or the model
+/// matrix changes or the batch is full. Lines that don't change can be recorded once in retained mode and then drawn
+/// with a single drawcall every frame.
 class DebugDrawer
 {
 public:
+	~DebugDrawer();
+
 	ANKI_USE_RESULT Error init(ResourceManager* rsrcManager);
 
 	void prepareFrame(RenderQueueDrawContext* ctx);
@@ -53,24 +57,24 @@ public:
 
 	void pushBackVertex(const Vec3& pos)
 	{
-		if((m_cachedPositionCount + 3) >= m_cachedPositions.getSize())
+		if(m_recording)
 		{
-			flush();
-			ANKI_ASSERT(m_cachedPositionCount == 0);
+			ANKI_ASSERT(m_topology == PrimitiveTopology::LINES);
+			m_retainedVerts.emplaceBack(m_alloc, (m_mMat * pos.xyz1()).xyz(), m_crntColPacked);
+			return;
 		}
-		m_cachedPositions[m_cachedPositionCount++] = pos;
-	}
 
-	/// Something like glColor
-	void setColor(const Vec4& col)
-	{
-		if(m_crntCol != col)
+		if((m_cachedVertCount + 3) >= m_cachedVerts.getSize())
 		{
 			flush();
+			ANKI_ASSERT(m_cachedVertCount == 0);
 		}
-		m_crntCol = col;
+		m_cachedVerts[m_cachedVertCount++] = Vertex(pos, m_crntColPacked);
 	}
 
+	/// Something like glColor. The color is per vertex so it doesn't break the batch.
+	void setColor(const Vec4& col);
+
 	void setModelMatrix(const Mat4& m)
 	{
 		flush();
@@ -85,7 +89,38 @@ public:
 		m_mvpMat = m_vpMat * m_mMat;
 	}
 
+	/// @name Retained mode
+	/// @{
+
+	/// Start recording. The lines pushed until endRetained() are stored in world space instead of drawn. It discards
+	/// the previous recording.
+	void beginRetained();
+
+	/// Stop recording and upload the recorded lines to a GPU buffer.
+	void endRetained();
+
+	/// Draw the recorded lines. Call it between prepareFrame() and finishFrame().
+	void drawRetained();
+	/// @}
+
 private:
+	class Vertex
+	{
+	public:
+		Vec3 m_position;
+		U32 m_color; ///< R8G8B8A8_UNORM.
+
+		Vertex() = default;
+
+		Vertex(const Vec3& pos, U32 color)
+			: m_position(pos)
+			, m_color(color)
+		{
+		}
+	};
+
+	ResourceAllocator<U8> m_alloc;
+	GrManager* m_gr = nullptr;
 	ShaderProgramResourcePtr m_prog;
 
 	RenderQueueDrawContext* m_ctx = nullptr;
@@ -95,15 +130,24 @@ private:
 	Mat4 m_vpMat = Mat4::getIdentity();
 	Mat4 m_mvpMat = Mat4::getIdentity(); ///< Optimization.
 	Vec4 m_crntCol = Vec4(1.0f, 0.0f, 0.0f, 1.0f);
+	U32 m_crntColPacked = 0xFF0000FF;
 	PrimitiveTopology m_topology = PrimitiveTopology::LINES;
 
-	static const U MAX_VERTS_BEFORE_FLUSH = 128;
-	Array<Vec3, MAX_VERTS_BEFORE_FLUSH> m_cachedPositions;
-	U32 m_cachedPositionCount = 0;
+	static const U MAX_VERTS_BEFORE_FLUSH = 4096;
+	Array<Vertex, MAX_VERTS_BEFORE_FLUSH> m_cachedVerts;
+	U32 m_cachedVertCount = 0;
+
+	// Retained mode
+	Bool m_recording = false;
+	DynamicArray<Vertex> m_retainedVerts;
+	BufferPtr m_retainedVertBuff;
+	U32 m_retainedVertCount = 0;
 
 	DynamicArray<Vec3> m_sphereVerts;
 
 	void flush();
+
+	void draw(BufferPtr vertBuff, PtrSize vertBuffOffset, U32 vertCount, const Mat4& mvp);
 };
 
 /// Implement physics debug drawer.
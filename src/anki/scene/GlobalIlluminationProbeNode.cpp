@@ -119,6 +119,7 @@ Error GlobalIlluminationProbeNode::init()
 		frc->setPerspective(zNear, tempEffectiveDistance, ang, ang);
 		frc->setTransform(m_cubeFaceTransforms[i]);
 		frc->setEnabledVisibilityTests(FrustumComponentVisibilityTestFlag::NONE);
+		frc->setVisibilityCacheEnabled(true);
 		frc->setEffectiveShadowDistance(getSceneGraph().getLimits().m_reflectionProbeShadowEffectiveDistance);
 	}
 
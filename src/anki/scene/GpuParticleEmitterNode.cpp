@@ -59,33 +59,35 @@ Error GpuParticleEmitterNode::init(const CString& filename)
 	// Load particle props
 	ANKI_CHECK(getResourceManager().loadResource(filename, m_emitterRsrc));
 
-	// Create a UBO with the props
-	BufferInitInfo buffInit;
-	buffInit.m_access = BufferMapAccessBit::WRITE;
-	buffInit.m_usage = BufferUsageBit::UNIFORM_COMPUTE;
-	buffInit.m_size = sizeof(GpuParticleEmitterProperties);
-	m_propsBuff = getSceneGraph().getGrManager().newBuffer(buffInit);
-	GpuParticleEmitterProperties* props =
-		static_cast<GpuParticleEmitterProperties*>(m_propsBuff->map(0, MAX_PTR_SIZE, BufferMapAccessBit::WRITE));
-
+	// Set the props
 	const ParticleEmitterProperties& inProps = m_emitterRsrc->getProperties();
-	props->m_minGravity = inProps.m_particle.m_minGravity;
-	props->m_minMass = inProps.m_particle.m_minMass;
-	props->m_maxGravity = inProps.m_particle.m_maxGravity;
-	props->m_maxMass = inProps.m_particle.m_maxMass;
-	props->m_minForce = inProps.m_particle.m_minForceDirection * inProps.m_particle.m_minForceMagnitude;
-	props->m_minLife = F32(inProps.m_particle.m_minLife);
-	props->m_maxForce = inProps.m_particle.m_maxForceDirection * inProps.m_particle.m_maxForceMagnitude;
-	props->m_maxLife = F32(inProps.m_particle.m_maxLife);
-	props->m_minStartingPosition = inProps.m_particle.m_minStartingPosition;
-	props->m_maxStartingPosition = inProps.m_particle.m_maxStartingPosition;
-	props->m_particleCount = inProps.m_maxNumOfParticles;
-
-	m_propsBuff->unmap();
+	m_props.m_minGravity = inProps.m_particle.m_minGravity;
+	m_props.m_minMass = inProps.m_particle.m_minMass;
+	m_props.m_maxGravity = inProps.m_particle.m_maxGravity;
+	m_props.m_maxMass = inProps.m_particle.m_maxMass;
+	m_props.m_minForce = inProps.m_particle.m_minForceDirection * inProps.m_particle.m_minForceMagnitude;
+	m_props.m_minLife = F32(inProps.m_particle.m_minLife);
+	m_props.m_maxForce = inProps.m_particle.m_maxForceDirection * inProps.m_particle.m_maxForceMagnitude;
+	m_props.m_maxLife = F32(inProps.m_particle.m_maxLife);
+	m_props.m_minStartingPosition = inProps.m_particle.m_minStartingPosition;
+	m_props.m_maxStartingPosition = inProps.m_particle.m_maxStartingPosition;
+	m_props.m_particleCount = inProps.m_maxNumOfParticles;
+	m_props.m_collisionResponse = U32(inProps.m_collisionResponse);
+	m_props.m_restitution = inProps.m_restitution;
 
 	m_particleCount = inProps.m_maxNumOfParticles;
 
+	// Set the random factors
+	for(Vec4& factors : m_randFactors)
+	{
+		factors = Vec4(getRandomRange(0.0f, 1.0f),
+			getRandomRange(0.0f, 1.0f),
+			getRandomRange(0.0f, 1.0f),
+			getRandomRange(0.0f, 1.0f));
+	}
+
 	// Create the particle buffer
+	BufferInitInfo buffInit;
 	buffInit.m_access = BufferMapAccessBit::WRITE;
 	buffInit.m_usage = BufferUsageBit::STORAGE_ALL;
 	buffInit.m_size = sizeof(GpuParticle) * inProps.m_maxNumOfParticles;
@@ -100,22 +102,12 @@ Error GpuParticleEmitterNode::init(const CString& filename)
 
 	m_particlesBuff->unmap();
 
-	// Create the rand buffer
-	buffInit.m_size = sizeof(U32) + MAX_RAND_FACTORS * sizeof(F32);
-	m_randFactorsBuff = getSceneGraph().getGrManager().newBuffer(buffInit);
-
-	F32* randFactors = static_cast<F32*>(m_randFactorsBuff->map(0, MAX_PTR_SIZE, BufferMapAccessBit::WRITE));
-
-	*reinterpret_cast<U32*>(randFactors) = MAX_RAND_FACTORS;
-	++randFactors;
-
-	const F32* randFactorsEnd = randFactors + MAX_RAND_FACTORS;
-	for(; randFactors < randFactorsEnd; ++randFactors)
-	{
-		*randFactors = getRandomRange(0.0f, 1.0f);
-	}
-
-	m_randFactorsBuff->unmap();
+	// Create the buffer of the indirect draw and the alive indices
+	buffInit.m_access = BufferMapAccessBit::NONE;
+	buffInit.m_usage = BufferUsageBit::INDIRECT_GRAPHICS | BufferUsageBit::STORAGE_COMPUTE_READ_WRITE
+					   | BufferUsageBit::STORAGE_VERTEX_READ | BufferUsageBit::FILL;
+	buffInit.m_size = sizeof(GpuParticleIndirectArgs) + sizeof(U32) * inProps.m_maxNumOfParticles;
+	m_aliveParticlesBuff = getSceneGraph().getGrManager().newBuffer(buffInit);
 
 	// Create the sampler
 	{
@@ -143,11 +135,11 @@ Error GpuParticleEmitterNode::init(const CString& filename)
 	newComponent<MoveFeedbackComponent>();
 	newComponent<SpatialComponent>(this, &m_spatialVolume);
 	GenericGpuComputeJobComponent* gpuComp = newComponent<GenericGpuComputeJobComponent>();
-	gpuComp->setCallback(
-		[](GenericGpuComputeJobQueueElementContext& ctx, const void* userData) {
-			static_cast<const GpuParticleEmitterNode*>(userData)->simulate(ctx);
-		},
-		this);
+	gpuComp->setCallback(simulate,
+		this,
+		m_grProg->getUuid(), // All the emitters share the program so they are merged
+		true // Async compute
+	);
 	MaterialRenderComponent* rcomp = newComponent<MaterialRenderComponent>(this, m_emitterRsrc->getMaterial());
 	rcomp->setup(
 		[](RenderQueueDrawContext& ctx, ConstWeakArray<void*> userData) {
@@ -161,6 +153,45 @@ Error GpuParticleEmitterNode::init(const CString& filename)
 	return Error::NONE;
 }
 
+Error GpuParticleEmitterNode::frameUpdate(Second prevUpdateTime, Second crntTime)
+{
+	m_dt = crntTime - prevUpdateTime;
+
+	// Emit at the rate of the resource. The far emitters emit less often
+	const ParticleEmitterProperties& props = m_emitterRsrc->getProperties();
+	m_timeLeftForNextEmission -= m_dt;
+	if(m_timeLeftForNextEmission <= 0.0)
+	{
+		m_emitCount = props.m_particlesPerEmission;
+		m_timeLeftForNextEmission = props.m_emissionPeriod * Second(1u << computeEmissionLod());
+	}
+	else
+	{
+		m_emitCount = 0;
+	}
+
+	return Error::NONE;
+}
+
+U32 GpuParticleEmitterNode::computeEmissionLod() const
+{
+	const SceneGraph& scene = getSceneGraph();
+	const F32 dist = (m_worldPosition - scene.getLodOrigin()).getLength();
+
+	if(dist > scene.getLimits().m_particleLodDistance1)
+	{
+		return EMISSION_LOD_COUNT - 1;
+	}
+	else if(dist > scene.getLimits().m_particleLodDistance0)
+	{
+		return 1;
+	}
+	else
+	{
+		return 0;
+	}
+}
+
 void GpuParticleEmitterNode::onMoveComponentUpdate(const MoveComponent& movec)
 {
 	const Vec4& pos = movec.getWorldTransform().getOrigin();
@@ -177,35 +208,104 @@ void GpuParticleEmitterNode::onMoveComponentUpdate(const MoveComponent& movec)
 	m_worldRotation = movec.getWorldTransform().getRotation();
 }
 
-void GpuParticleEmitterNode::simulate(GenericGpuComputeJobQueueElementContext& ctx) const
+void GpuParticleEmitterNode::simulate(GenericGpuComputeJobQueueElementContext& ctx, ConstWeakArray<void*> userData)
 {
+	ANKI_ASSERT(userData.getSize() > 0);
 	CommandBufferPtr& cmdb = ctx.m_commandBuffer;
+	const GpuParticleEmitterNode& firstEmitter = *static_cast<const GpuParticleEmitterNode*>(userData[0]);
 
-	cmdb->bindShaderProgram(m_grProg);
-
-	// Bind resources
-	cmdb->bindStorageBuffer(1, 0, m_particlesBuff, 0, MAX_PTR_SIZE);
-	cmdb->bindUniformBuffer(1, 1, m_propsBuff, 0, MAX_PTR_SIZE);
-	cmdb->bindStorageBuffer(1, 2, m_randFactorsBuff, 0, MAX_PTR_SIZE);
-	cmdb->bindSampler(1, 3, m_nearestAnyClampSampler);
+	cmdb->bindShaderProgram(firstEmitter.m_grProg);
+	cmdb->bindSampler(1, 0, firstEmitter.m_nearestAnyClampSampler);
 
 	StagingGpuMemoryToken token;
-	GpuParticleSimulationState* unis =
-		static_cast<GpuParticleSimulationState*>(ctx.m_stagingGpuAllocator->allocateFrame(
-			sizeof(GpuParticleSimulationState), StagingGpuMemoryType::UNIFORM, token));
-
+	GpuParticleSimulationUniforms* unis =
+		static_cast<GpuParticleSimulationUniforms*>(ctx.m_stagingGpuAllocator->allocateFrame(
+			sizeof(GpuParticleSimulationUniforms), StagingGpuMemoryType::UNIFORM, token));
 	unis->m_viewProjMat = ctx.m_viewProjectionMatrix;
 	unis->m_unprojectionParams = ctx.m_projectionMatrix.extractPerspectiveUnprojectionParams();
-	unis->m_randomIndex = rand();
-	unis->m_dt = F32(m_dt);
-	unis->m_emitterPosition = m_worldPosition;
-	unis->m_emitterRotation = m_worldRotation;
 	unis->m_invViewRotation = Mat3x4(ctx.m_cameraTransform.getRotationPart());
-	cmdb->bindUniformBuffer(1, 4, token.m_buffer, token.m_offset, token.m_range);
+	cmdb->bindUniformBuffer(1, 1, token.m_buffer, token.m_offset, token.m_range);
+
+	// The graphics stages can't be part of the barriers of the async compute queue. The render graph syncs the queues
+	const BufferUsageBit drawUsage = (ctx.m_asyncCompute)
+										 ? BufferUsageBit::NONE
+										 : (BufferUsageBit::INDIRECT_GRAPHICS | BufferUsageBit::STORAGE_VERTEX_READ);
+
+	for(U32 firstJob = 0; firstJob < userData.getSize(); firstJob += MAX_GPU_PARTICLE_EMITTERS_PER_SIMULATION)
+	{
+		const U32 jobCount = min(userData.getSize() - firstJob, MAX_GPU_PARTICLE_EMITTERS_PER_SIMULATION);
 
-	// Dispatch
-	const U32 workgroupCount = (m_particleCount + m_workgroupSizeX - 1) / m_workgroupSizeX;
-	cmdb->dispatchCompute(workgroupCount, 1, 1);
+		// Write the states of all the emitters of the dispatch in one buffer
+		GpuParticleSimulationState* states = static_cast<GpuParticleSimulationState*>(
+			ctx.m_stagingGpuAllocator->allocateFrame(
+				sizeof(GpuParticleSimulationState) * jobCount, StagingGpuMemoryType::STORAGE, token));
+		cmdb->bindStorageBuffer(1, 2, token.m_buffer, token.m_offset, token.m_range);
+
+		U32 maxParticleCount = 0;
+		for(U32 i = 0; i < MAX_GPU_PARTICLE_EMITTERS_PER_SIMULATION; ++i)
+		{
+			// The array elements past the job count are not accessed but they have to be bound
+			const GpuParticleEmitterNode& emitter =
+				*static_cast<const GpuParticleEmitterNode*>(userData[firstJob + min(i, jobCount - 1)]);
+
+			cmdb->bindStorageBuffer(1, 3, emitter.m_particlesBuff, 0, MAX_PTR_SIZE, i);
+			cmdb->bindStorageBuffer(1, 4, emitter.m_aliveParticlesBuff, 0, MAX_PTR_SIZE, i);
+
+			if(i >= jobCount)
+			{
+				continue;
+			}
+
+			GpuParticleSimulationState& state = states[i];
+			state.m_props = emitter.m_props;
+			state.m_emitCount = emitter.m_emitCount;
+			state.m_randomIndex = rand();
+			state.m_dt = F32(emitter.m_dt);
+			state.m_emitterPosition = emitter.m_worldPosition;
+			state.m_emitterRotation = emitter.m_worldRotation;
+			memcpy(&state.m_randomFactors[0], &emitter.m_randFactors[0], sizeof(state.m_randomFactors));
+
+			maxParticleCount = max(maxParticleCount, emitter.m_particleCount);
+
+			// Zero the counters. The previous frame might still draw with them
+			if(!!drawUsage)
+			{
+				cmdb->setBufferBarrier(emitter.m_aliveParticlesBuff, drawUsage, BufferUsageBit::FILL, 0, MAX_PTR_SIZE);
+			}
+			cmdb->fillBuffer(emitter.m_aliveParticlesBuff, 0, sizeof(GpuParticleIndirectArgs), 0);
+			cmdb->setBufferBarrier(emitter.m_aliveParticlesBuff,
+				BufferUsageBit::FILL,
+				BufferUsageBit::STORAGE_COMPUTE_READ_WRITE,
+				0,
+				MAX_PTR_SIZE);
+		}
+
+		// Dispatch. The Y is the emitter
+		const U32 workgroupSize = firstEmitter.m_workgroupSizeX;
+		const U32 workgroupCount = (maxParticleCount + workgroupSize - 1) / workgroupSize;
+		cmdb->dispatchCompute(workgroupCount, jobCount, 1);
+
+		// The draws of this frame will read them
+		if(!!drawUsage)
+		{
+			for(U32 i = 0; i < jobCount; ++i)
+			{
+				const GpuParticleEmitterNode& emitter =
+					*static_cast<const GpuParticleEmitterNode*>(userData[firstJob + i]);
+
+				cmdb->setBufferBarrier(emitter.m_aliveParticlesBuff,
+					BufferUsageBit::STORAGE_COMPUTE_READ_WRITE,
+					drawUsage,
+					0,
+					MAX_PTR_SIZE);
+				cmdb->setBufferBarrier(emitter.m_particlesBuff,
+					BufferUsageBit::STORAGE_COMPUTE_WRITE,
+					BufferUsageBit::STORAGE_VERTEX_READ,
+					0,
+					MAX_PTR_SIZE);
+			}
+		}
+	}
 }
 
 void GpuParticleEmitterNode::draw(RenderQueueDrawContext& ctx) const
@@ -235,9 +335,11 @@ void GpuParticleEmitterNode::draw(RenderQueueDrawContext& ctx) const
 		*extraUniforms = ctx.m_cameraTransform.getColumn(2);
 		cmdb->bindUniformBuffer(0, 2, token.m_buffer, token.m_offset, token.m_range);
 
-		// Draw
+		cmdb->bindStorageBuffer(0, 3, m_aliveParticlesBuff, 0, MAX_PTR_SIZE);
+
+		// Draw the alive particles only. The simulation wrote their count
 		cmdb->setLineWidth(8.0f);
-		cmdb->drawArrays(PrimitiveTopology::LINES, m_particleCount * 2);
+		cmdb->drawArraysIndirect(PrimitiveTopology::LINES, 1, 0, m_aliveParticlesBuff);
 	}
 	else
 	{
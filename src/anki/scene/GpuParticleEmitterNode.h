@@ -8,6 +8,7 @@
 #include <anki/scene/SceneNode.h>
 #include <anki/resource/ParticleEmitterResource.h>
 #include <anki/collision/Aabb.h>
+#include <shaders/glsl_cpp_common/GpuParticles.h>
 
 namespace anki
 {
@@ -21,6 +22,10 @@ class RenderQueueDrawContext;
 /// @{
 
 /// The particle emitter scene node. This scene node emitts
+///
+/// The particles are simulated on the GPU. The simulation compacts the alive ones and writes the args of an indirect
+/// draw so only those are drawn. The emission rate drops with the distance from the camera. The emitters are simulated
+/// in batches, one dispatch for up to MAX_GPU_PARTICLE_EMITTERS_PER_SIMULATION emitters.
 class GpuParticleEmitterNode : public SceneNode
 {
 public:
@@ -30,14 +35,11 @@ public:
 
 	ANKI_USE_RESULT Error init(const CString& filename);
 
-	ANKI_USE_RESULT Error frameUpdate(Second prevUpdateTime, Second crntTime) override
-	{
-		m_dt = crntTime - prevUpdateTime;
-		return Error::NONE;
-	}
+	ANKI_USE_RESULT Error frameUpdate(Second prevUpdateTime, Second crntTime) override;
 
 private:
-	static constexpr U32 MAX_RAND_FACTORS = 32;
+	/// Every LOD halves the emission rate.
+	static constexpr U32 EMISSION_LOD_COUNT = 3;
 
 	class MoveFeedbackComponent;
 
@@ -47,9 +49,13 @@ private:
 
 	ParticleEmitterResourcePtr m_emitterRsrc;
 
-	BufferPtr m_propsBuff; ///< Constant buffer with particle properties.
+	GpuParticleEmitterProperties m_props; ///< The properties that the simulation reads.
+	Array<Vec4, GPU_PARTICLE_RANDOM_FACTOR_COUNT / 4> m_randFactors; ///< Values in range [0.0, 1.0].
+
 	BufferPtr m_particlesBuff; ///< Particles buffer.
-	BufferPtr m_randFactorsBuff; ///< Contains flots with random values. Values in range [0.0, 1.0].
+
+	/// The args of the indirect draw followed by the indices of the alive particles. Written by the simulation.
+	BufferPtr m_aliveParticlesBuff;
 
 	SamplerPtr m_nearestAnyClampSampler;
 
@@ -57,12 +63,17 @@ private:
 	F32 m_maxDistanceAParticleCanGo = -1.0f;
 	U32 m_particleCount = 0;
 	Second m_dt = 0.0;
+	Second m_timeLeftForNextEmission = 0.0;
+	U32 m_emitCount = 0; ///< How many particles the next simulation can emit.
 	Vec3 m_worldPosition = Vec3(0.0f); //< Cache it.
 	Mat3x4 m_worldRotation = Mat3x4::getIdentity();
 
 	void onMoveComponentUpdate(const MoveComponent& movec);
 
-	void simulate(GenericGpuComputeJobQueueElementContext& ctx) const;
+	U32 computeEmissionLod() const;
+
+	/// Simulate some emitters. It's one dispatch for every MAX_GPU_PARTICLE_EMITTERS_PER_SIMULATION of them.
+	static void simulate(GenericGpuComputeJobQueueElementContext& ctx, ConstWeakArray<void*> userData);
 
 	void draw(RenderQueueDrawContext& ctx) const;
 };
@@ -284,6 +284,7 @@ Error PointLightNode::frameUpdate(Second prevUpdateTime, Second crntTime)
 			FrustumComponent* frc = newComponent<FrustumComponent>(this, FrustumType::PERSPECTIVE);
 			frc->setPerspective(zNear, dist, ang, ang);
 			frc->setTransform(trf);
+			frc->setVisibilityCacheEnabled(true);
 		}
 	}
 
@@ -317,6 +318,7 @@ Error SpotLightNode::init()
 	// Frustum component
 	FrustumComponent* fr = newComponent<FrustumComponent>(this, FrustumType::PERSPECTIVE);
 	fr->setEnabledVisibilityTests(FrustumComponentVisibilityTestFlag::NONE);
+	fr->setVisibilityCacheEnabled(true);
 
 	// Spatial component
 	newComponent<SpatialComponent>(this, &fr->getPerspectiveBoundingShape());
@@ -41,6 +41,29 @@ public:
 	}
 };
 
+/// Render component that also asks for the mesh LODs it draws.
+class ModelNode::MyRenderComponent : public MaterialRenderComponent
+{
+public:
+	MyRenderComponent(SceneNode* node, const ModelPatch* patch)
+		: MaterialRenderComponent(node, patch->getMaterial())
+		, m_patch(patch)
+	{
+	}
+
+	void requestResidency(F32 screenSize) const override
+	{
+		MaterialRenderComponent::requestResidency(screenSize);
+
+		// Keep the fading out LOD as well
+		const U32 lod = (isChangingLod()) ? min(getLod(), getPreviousLod()) : getLod();
+		m_patch->requestLod(lod);
+	}
+
+private:
+	const ModelPatch* m_patch;
+};
+
 ModelNode::ModelNode(SceneGraph* scene, CString name)
 	: SceneNode(scene, name)
 {
@@ -58,11 +81,19 @@ Error ModelNode::init(ModelResourcePtr resource, U32 modelPatchIdx)
 	m_model = resource;
 	m_modelPatchIdx = modelPatchIdx;
 
-	// Merge key
-	Array<U64, 2> toHash;
-	toHash[0] = modelPatchIdx;
-	toHash[1] = resource->getUuid();
-	m_mergeKey = computeHash(&toHash[0], sizeof(toHash));
+	// Merge key. The patches with bindless materials can merge with the patches of other models
+	const U64 patchMergeKey = m_model->getModelPatches()[m_modelPatchIdx].computeMergeKey();
+	if(patchMergeKey != 0 && !m_model->getSkeleton().isCreated())
+	{
+		m_mergeKey = patchMergeKey;
+	}
+	else
+	{
+		Array<U64, 2> toHash;
+		toHash[0] = modelPatchIdx;
+		toHash[1] = resource->getUuid();
+		m_mergeKey = computeHash(&toHash[0], sizeof(toHash));
+	}
 
 	// Components
 	if(m_model->getSkeleton().isCreated())
@@ -73,7 +104,7 @@ Error ModelNode::init(ModelResourcePtr resource, U32 modelPatchIdx)
 	newComponent<MoveFeedbackComponent>();
 	newComponent<SpatialComponent>(this, &m_obb);
 	MaterialRenderComponent* rcomp =
-		newComponent<MaterialRenderComponent>(this, m_model->getModelPatches()[m_modelPatchIdx].getMaterial());
+		newComponent<MyRenderComponent>(this, &m_model->getModelPatches()[m_modelPatchIdx]);
 	rcomp->setup(
 		[](RenderQueueDrawContext& ctx, ConstWeakArray<void*> userData) {
 			const ModelNode& self = *static_cast<const ModelNode*>(userData[0]);
@@ -81,6 +112,18 @@ Error ModelNode::init(ModelResourcePtr resource, U32 modelPatchIdx)
 		},
 		this,
 		m_mergeKey);
+	rcomp->setLodCount(m_model->getModelPatches()[m_modelPatchIdx].getLodCount());
+	rcomp->setLodScreenSizes(m_model->getLodScreenSizes());
+
+	// Cross-fade the LODs if the shaders can
+	for(const MaterialVariable& mvar : rcomp->getMaterial().getVariables())
+	{
+		if(mvar.getBuiltin() == BuiltinMaterialVariableId::LOD_FADE)
+		{
+			rcomp->setFlags(rcomp->getFlags() | RenderComponentFlag::LOD_CROSS_FADE);
+			break;
+		}
+	}
 
 	return Error::NONE;
 }
@@ -155,9 +198,17 @@ void ModelNode::draw(RenderQueueDrawContext& ctx, ConstWeakArray<void*> userData
 		{
 			const SkinComponent& skinc = getComponentAt<SkinComponent>(0);
 			StagingGpuMemoryToken token;
-			void* trfs = ctx.m_stagingGpuAllocator->allocateFrame(
-				skinc.getBoneTransforms().getSize() * sizeof(Mat4), StagingGpuMemoryType::STORAGE, token);
-			memcpy(trfs, &skinc.getBoneTransforms()[0], skinc.getBoneTransforms().getSize() * sizeof(Mat4));
+			if(skinc.isGpuSkinned())
+			{
+				// The renderer has written them already
+				token = skinc.getGpuBoneTransformsToken();
+			}
+			else
+			{
+				void* trfs = ctx.m_stagingGpuAllocator->allocateFrame(
+					skinc.getBoneTransforms().getSize() * sizeof(Mat4), StagingGpuMemoryType::STORAGE, token);
+				memcpy(trfs, &skinc.getBoneTransforms()[0], skinc.getBoneTransforms().getSize() * sizeof(Mat4));
+			}
 
 			ANKI_ASSERT(modelInf.m_boneTransformsBinding < MAX_U32);
 			cmdb->bindStorageBuffer(patch.getMaterial()->getDescriptorSetIndex(),
@@ -170,12 +221,67 @@ void ModelNode::draw(RenderQueueDrawContext& ctx, ConstWeakArray<void*> userData
 		// Program
 		cmdb->bindShaderProgram(modelInf.m_program);
 
+		// LOD cross-fade
+		Array<F32, MAX_INSTANCES> lodFades;
+		U32 lodFadeCount = 0;
+		if(ctx.m_lodCrossFade)
+		{
+			for(U32 i = 0; i < userData.getSize(); ++i)
+			{
+				const ModelNode& self2 = *static_cast<const ModelNode*>(userData[i]);
+				lodFades[i] = self2.getComponent<RenderComponent>().getLodFade(ctx.m_key.getLod());
+			}
+
+			lodFadeCount = userData.getSize();
+		}
+
+		// The instances might have different bindless materials
+		Array<const MaterialRenderComponent*, MAX_INSTANCES> instanceComponents;
+		U32 instanceComponentCount = 0;
+		if(patch.getMaterial()->isBindless())
+		{
+			for(U32 i = 0; i < userData.getSize(); ++i)
+			{
+				const ModelNode& self2 = *static_cast<const ModelNode*>(userData[i]);
+				instanceComponents[i] =
+					&static_cast<const MaterialRenderComponent&>(self2.getComponent<RenderComponent>());
+			}
+
+			instanceComponentCount = userData.getSize();
+		}
+
 		// Uniforms
 		static_cast<const MaterialRenderComponent&>(getComponent<RenderComponent>())
 			.allocateAndSetupUniforms(ctx,
 				ConstWeakArray<Mat4>(&trfs[0], userData.getSize()),
 				ConstWeakArray<Mat4>(&prevTrfs[0], userData.getSize()),
-				*ctx.m_stagingGpuAllocator);
+				*ctx.m_stagingGpuAllocator,
+				ConstWeakArray<F32>(&lodFades[0], lodFadeCount),
+				ConstWeakArray<const MaterialRenderComponent*>(&instanceComponents[0], instanceComponentCount));
+
+		// Mesh shaders. They fetch the vertices themselves and the task shaders cull the meshlets
+		if(modelInf.m_meshletCount > 0)
+		{
+			for(const StorageBufferBinding& binding : modelInf.m_meshletStorageBuffers)
+			{
+				if(binding.m_binding != MAX_U32)
+				{
+					cmdb->bindStorageBuffer(patch.getMaterial()->getDescriptorSetIndex(),
+						binding.m_binding,
+						binding.m_buffer,
+						binding.m_offset,
+						binding.m_range);
+				}
+			}
+
+			const UVec4 pc(modelInf.m_meshletCount, modelInf.m_meshletPositionsF16, modelInf.m_meshletUvsUnorm, 0);
+			cmdb->setPushConstants(&pc, sizeof(pc));
+
+			// One task workgroup culls 32 meshlets of an instance
+			const U32 taskCountPerInstance = (modelInf.m_meshletCount + 31) / 32;
+			cmdb->drawMeshTasks(taskCountPerInstance * userData.getSize());
+			return;
+		}
 
 		// Set attributes
 		for(U i = 0; i < modelInf.m_vertexAttributeCount; ++i)
@@ -197,14 +303,28 @@ void ModelNode::draw(RenderQueueDrawContext& ctx, ConstWeakArray<void*> userData
 		cmdb->bindIndexBuffer(modelInf.m_indexBuffer, 0, IndexType::U16);
 
 		// Draw
-		cmdb->drawElements(PrimitiveTopology::TRIANGLES,
-			modelInf.m_indicesCountArray[0],
+		const DrawElementsIndirectInfo drawInfo(modelInf.m_indicesCountArray[0],
 			userData.getSize(),
 			U32(modelInf.m_indicesOffsetArray[0] / sizeof(U16)),
 			0,
 			0);
+		if(ctx.m_indirectArgs)
+		{
+			*ctx.m_indirectArgs = drawInfo;
+			cmdb->drawElementsIndirect(
+				PrimitiveTopology::TRIANGLES, 1, ctx.m_indirectArgsBufferOffset, ctx.m_indirectArgsBuffer);
+		}
+		else
+		{
+			cmdb->drawElements(PrimitiveTopology::TRIANGLES,
+				drawInfo.m_count,
+				drawInfo.m_instanceCount,
+				drawInfo.m_firstIndex,
+				drawInfo.m_baseVertex,
+				drawInfo.m_baseInstance);
+		}
 	}
-	else
+	else if(ctx.m_debugDrawFlags.get(RenderQueueDebugDrawFlag::RENDERABLES))
 	{
 		// Draw the bounding volumes
 
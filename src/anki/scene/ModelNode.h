@@ -40,6 +40,7 @@ public:
 
 private:
 	class MoveFeedbackComponent;
+	class MyRenderComponent;
 
 	ModelResourcePtr m_model; ///< The resource
 
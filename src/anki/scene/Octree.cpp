@@ -36,6 +36,33 @@ static Vec3 heatmap(F32 factor)
 	}
 }
 
+/// Interleave the bits of 3 cell coordinates. The children of a cell are the 8 codes after the code of the cell
+/// multiplied by 8.
+static U32 encodeMorton(U32 x, U32 y, U32 z)
+{
+	U32 code = 0;
+	for(U32 bit = 0; bit < 10; ++bit)
+	{
+		code |= ((x >> bit) & 1u) << (bit * 3u);
+		code |= ((y >> bit) & 1u) << (bit * 3u + 1u);
+		code |= ((z >> bit) & 1u) << (bit * 3u + 2u);
+	}
+
+	return code;
+}
+
+/// The opposite of encodeMorton.
+static void decodeMorton(U32 code, U32& x, U32& y, U32& z)
+{
+	x = y = z = 0;
+	for(U32 bit = 0; bit < 10; ++bit)
+	{
+		x |= ((code >> (bit * 3u)) & 1u) << bit;
+		y |= ((code >> (bit * 3u + 1u)) & 1u) << bit;
+		z |= ((code >> (bit * 3u + 2u)) & 1u) << bit;
+	}
+}
+
 class Octree::GatherParallelCtx
 {
 public:
@@ -53,31 +80,174 @@ class Octree::GatherParallelTaskCtx
 public:
 	GatherParallelCtx* m_ctx = nullptr;
 	Leaf* m_leaf = nullptr;
+	U32 m_looseNode = MAX_U32;
+	U32 m_looseLevel = MAX_U32;
+	Bool m_insideFully = false; ///< The leaf is inside all the frustum planes.
 };
 
 Octree::~Octree()
 {
 	ANKI_ASSERT(m_placeableCount == 0);
+	ANKI_ASSERT(m_looseNodes.getSize() == 0 || m_looseNodes[0].m_subtreePlaceableCount.load() == 0);
 	cleanupInternal();
 	ANKI_ASSERT(m_rootLeaf == nullptr);
+
+	m_looseNodes.destroy(m_alloc);
+	m_looseNodeMins.destroy(m_alloc);
+	m_looseNodeMaxs.destroy(m_alloc);
 }
 
-void Octree::init(const Vec3& sceneAabbMin, const Vec3& sceneAabbMax, U32 maxDepth)
+void Octree::init(const Vec3& sceneAabbMin, const Vec3& sceneAabbMax, U32 maxDepth, OctreeType type)
 {
 	ANKI_ASSERT(sceneAabbMin < sceneAabbMax);
 	ANKI_ASSERT(maxDepth > 0);
+	ANKI_ASSERT(m_placeableCount == 0);
 
+	m_type = type;
 	m_maxDepth = maxDepth;
 	m_sceneAabbMin = sceneAabbMin;
 	m_sceneAabbMax = sceneAabbMax;
+
+	if(m_type == OctreeType::LOOSE)
+	{
+		initLoose();
+	}
+}
+
+void Octree::setSceneBounds(const Vec3& sceneAabbMin, const Vec3& sceneAabbMax)
+{
+	ANKI_ASSERT(sceneAabbMin < sceneAabbMax);
+	ANKI_ASSERT(m_placeableCount == 0 && m_rootLeaf == nullptr);
+	ANKI_ASSERT(m_looseNodes.getSize() == 0 || m_looseNodes[0].m_subtreePlaceableCount.load() == 0);
+
+	m_sceneAabbMin = sceneAabbMin;
+	m_sceneAabbMax = sceneAabbMax;
+	m_changeEpoch.fetchAdd(1);
+
+	if(m_type == OctreeType::LOOSE)
+	{
+		initLoose();
+	}
+}
+
+void Octree::initLoose()
+{
+	ANKI_ASSERT(m_maxDepth <= MAX_LOOSE_DEPTH);
+
+	// Level L has 8^L nodes
+	m_looseLevelOffsets[0] = 0;
+	for(U32 level = 0; level <= m_maxDepth; ++level)
+	{
+		m_looseLevelOffsets[level + 1] = m_looseLevelOffsets[level] + (1u << (level * 3u));
+	}
+
+	const U32 nodeCount = m_looseLevelOffsets[m_maxDepth + 1];
+	m_looseNodes.destroy(m_alloc);
+	m_looseNodeMins.destroy(m_alloc);
+	m_looseNodeMaxs.destroy(m_alloc);
+	m_looseNodes.create(m_alloc, nodeCount);
+	m_looseNodeMins.create(m_alloc, nodeCount);
+	m_looseNodeMaxs.create(m_alloc, nodeCount);
+
+	// The loose box is the cell grown by half its size on every side
+	const Vec3 sceneSize = m_sceneAabbMax - m_sceneAabbMin;
+	for(U32 level = 0; level <= m_maxDepth; ++level)
+	{
+		const Vec3 cellSize = sceneSize / F32(1u << level);
+		for(U32 code = 0; code < (1u << (level * 3u)); ++code)
+		{
+			U32 x, y, z;
+			decodeMorton(code, x, y, z);
+			const Vec3 cellMin = m_sceneAabbMin + cellSize * Vec3(F32(x), F32(y), F32(z));
+
+			const U32 node = m_looseLevelOffsets[level] + code;
+			m_looseNodeMins[node] = cellMin - cellSize * 0.5f;
+			m_looseNodeMaxs[node] = cellMin + cellSize * 1.5f;
+		}
+	}
 }
 
 void Octree::place(const Aabb& volume, OctreePlaceable* placeable, Bool updateActualSceneBounds)
 {
-	ANKI_ASSERT(placeable);
-	ANKI_ASSERT(testCollision(volume, Aabb(m_sceneAabbMin, m_sceneAabbMax)) && "volume is outside the scene");
+	OctreePlaceRequest request;
+	request.m_volume = volume;
+	request.m_placeable = placeable;
+	request.m_updateActualSceneBounds = updateActualSceneBounds;
+	placeBatch(ConstWeakArray<OctreePlaceRequest>(&request, 1));
+}
+
+void Octree::placeBatch(ConstWeakArray<OctreePlaceRequest> requests)
+{
+	if(requests.getSize() == 0)
+	{
+		return;
+	}
+
+	recordChanges(requests, m_changeEpoch.fetchAdd(1) + 1);
+
+	// Find the placeables that will move to other leafs. That only reads the placeables so it doesn't need the lock
+	Vec3 boundsMin(MAX_F32);
+	Vec3 boundsMax(MIN_F32);
+	U32 moveCount = 0;
+	for(const OctreePlaceRequest& request : requests)
+	{
+		ANKI_ASSERT(request.m_placeable);
+		ANKI_ASSERT(testCollision(request.m_volume, Aabb(m_sceneAabbMin, m_sceneAabbMax))
+					&& "volume is outside the scene");
+
+		if(request.m_updateActualSceneBounds)
+		{
+			boundsMin = boundsMin.min(request.m_volume.getMin().xyz());
+			boundsMax = boundsMax.max(request.m_volume.getMax().xyz());
+		}
 
-	LockGuard<Mutex> lock(m_globalMtx);
+		if(m_type == OctreeType::LOOSE)
+		{
+			// The loose nodes have their own locks so place it right away
+			placeLooseInternal(request.m_volume, *request.m_placeable);
+		}
+		else if(!staysInTheSameLeafs(request.m_volume, *request.m_placeable))
+		{
+			++moveCount;
+		}
+	}
+
+	// Re-place the ones that moved
+	if(moveCount > 0)
+	{
+		LockGuard<Mutex> lock(m_globalMtx);
+		for(const OctreePlaceRequest& request : requests)
+		{
+			if(!staysInTheSameLeafs(request.m_volume, *request.m_placeable))
+			{
+				placeInternal(request.m_volume, request.m_placeable);
+			}
+		}
+	}
+
+	// Update the actual scene bounds
+	if(boundsMin.x() < MAX_F32)
+	{
+		LockGuard<SpinLock> lock(m_actualSceneBoundsLock);
+		m_actualSceneAabbMin = m_actualSceneAabbMin.min(boundsMin);
+		m_actualSceneAabbMax = m_actualSceneAabbMax.max(boundsMax);
+	}
+}
+
+Bool Octree::staysInTheSameLeafs(const Aabb& volume, const OctreePlaceable& placeable) const
+{
+	ANKI_ASSERT(m_type == OctreeType::REGULAR);
+	const Vec3 volumeMin = volume.getMin().xyz();
+	const Vec3 volumeMax = volume.getMax().xyz();
+	return !placeable.m_leafs.isEmpty() && volumeMin > placeable.m_volumeMinRange[0]
+		   && volumeMin < placeable.m_volumeMinRange[1] && volumeMax > placeable.m_volumeMaxRange[0]
+		   && volumeMax < placeable.m_volumeMaxRange[1];
+}
+
+void Octree::placeInternal(const Aabb& volume, OctreePlaceable* placeable)
+{
+	ANKI_ASSERT(placeable);
+	ANKI_ASSERT(m_type == OctreeType::REGULAR);
 
 	// Remove the placeable from the Octree
 	removeInternal(*placeable);
@@ -90,31 +260,263 @@ void Octree::place(const Aabb& volume, OctreePlaceable* placeable, Bool updateAc
 		m_rootLeaf->m_aabbMax = m_sceneAabbMax;
 	}
 
-	// And re-place it
+	// And re-place it. Start with infinite ranges and every decision will narrow them
+	placeable->m_volumeMinRange = {Vec3(MIN_F32), Vec3(MAX_F32)};
+	placeable->m_volumeMaxRange = {Vec3(MIN_F32), Vec3(MAX_F32)};
 	placeRecursive(volume, placeable, m_rootLeaf, 0);
 	++m_placeableCount;
+}
 
-	// Update the actual scene bounds
-	if(updateActualSceneBounds)
+void Octree::remove(OctreePlaceable& placeable)
+{
+	// The placeable leaves its volume
+	const U64 epoch = m_changeEpoch.fetchAdd(1) + 1;
 	{
-		m_actualSceneAabbMin = m_actualSceneAabbMin.min(volume.getMin().xyz());
-		m_actualSceneAabbMax = m_actualSceneAabbMax.max(volume.getMax().xyz());
+		LockGuard<SpinLock> lock(m_changedVolumesLock);
+		recordChange(placeable, Vec3(MAX_F32), Vec3(MIN_F32), epoch);
+	}
+
+	if(m_type == OctreeType::LOOSE)
+	{
+		removeLooseInternal(placeable);
+	}
+	else
+	{
+		LockGuard<Mutex> lock(m_globalMtx);
+		removeInternal(placeable);
 	}
 }
 
-void Octree::remove(OctreePlaceable& placeable)
+void Octree::recordChanges(ConstWeakArray<OctreePlaceRequest> requests, U64 epoch)
+{
+	LockGuard<SpinLock> lock(m_changedVolumesLock);
+	for(const OctreePlaceRequest& request : requests)
+	{
+		recordChange(*request.m_placeable, request.m_volume.getMin().xyz(), request.m_volume.getMax().xyz(), epoch);
+	}
+}
+
+void Octree::recordChange(OctreePlaceable& placeable, const Vec3& newMin, const Vec3& newMax, U64 epoch)
+{
+	if(placeable.m_volumeMin > placeable.m_volumeMax && newMin > newMax)
+	{
+		// Removing something that was never placed
+		return;
+	}
+
+	ChangedVolume& change = m_changedVolumes[m_changedVolumeCount % MAX_CHANGED_VOLUMES];
+	if(m_changedVolumeCount >= MAX_CHANGED_VOLUMES)
+	{
+		m_lostChangeEpoch = max(m_lostChangeEpoch, change.m_epoch);
+	}
+	++m_changedVolumeCount;
+
+	// One of the volumes might be empty, the min and max will ignore it
+	change.m_min = placeable.m_volumeMin.min(newMin);
+	change.m_max = placeable.m_volumeMax.max(newMax);
+	change.m_epoch = epoch;
+
+	placeable.m_volumeMin = newMin;
+	placeable.m_volumeMax = newMax;
+}
+
+Bool Octree::volumeChangedSince(const Aabb& volume, U64 epoch) const
+{
+	const Vec3 volumeMin = volume.getMin().xyz();
+	const Vec3 volumeMax = volume.getMax().xyz();
+
+	LockGuard<SpinLock> lock(m_changedVolumesLock);
+
+	if(epoch < m_lostChangeEpoch)
+	{
+		// Some of the changes after that epoch were forgotten
+		return true;
+	}
+
+	// Walk from the newest to the oldest change. Concurrent places might record their changes out of order but the
+	// epochs of a frame are newer than the ones of the previous frames since nothing is placed while the visibility
+	// tests run
+	const U64 oldest = (m_changedVolumeCount > MAX_CHANGED_VOLUMES) ? m_changedVolumeCount - MAX_CHANGED_VOLUMES : 0;
+	for(U64 i = m_changedVolumeCount; i > oldest; --i)
+	{
+		const ChangedVolume& change = m_changedVolumes[(i - 1) % MAX_CHANGED_VOLUMES];
+		if(change.m_epoch <= epoch)
+		{
+			break;
+		}
+
+		if(change.m_min <= volumeMax && change.m_max >= volumeMin)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+U32 Octree::computeLooseNode(const Aabb& volume, U32& level) const
 {
-	LockGuard<Mutex> lock(m_globalMtx);
-	removeInternal(placeable);
+	const Vec3 volumeMin = volume.getMin().xyz();
+	const Vec3 volumeMax = volume.getMax().xyz();
+	const Vec3 volumeSize = volumeMax - volumeMin;
+	const Vec3 center = (volumeMin + volumeMax) * 0.5f;
+	const Vec3 sceneSize = m_sceneAabbMax - m_sceneAabbMin;
+
+	// The deepest level with cells that are not smaller than the volume. The loose boxes are twice the size of the
+	// cells so the volume fits in the loose box of the cell that contains its center
+	level = m_maxDepth;
+	for(U32 i = 0; i < 3; ++i)
+	{
+		if(volumeSize[i] > 0.0f)
+		{
+			const F32 ratio = sceneSize[i] / volumeSize[i];
+			level = (ratio >= 1.0f) ? min(level, U32(log2(ratio))) : 0;
+		}
+	}
+
+	// The volume might not fit because of the rounding or because its center is outside the scene so go up if needed
+	while(true)
+	{
+		const U32 cellsPerAxis = 1u << level;
+		const Vec3 cellSize = sceneSize / F32(cellsPerAxis);
+		Array<U32, 3> cell;
+		for(U32 i = 0; i < 3; ++i)
+		{
+			const F32 f = std::floor((center[i] - m_sceneAabbMin[i]) / cellSize[i]);
+			cell[i] = min(U32(max(f, 0.0f)), cellsPerAxis - 1);
+		}
+
+		const U32 node = m_looseLevelOffsets[level] + encodeMorton(cell[0], cell[1], cell[2]);
+		if(level == 0
+			|| (volumeMin >= m_looseNodeMins[node] && volumeMax <= m_looseNodeMaxs[node]))
+		{
+			return node;
+		}
+
+		--level;
+	}
 }
 
-Bool Octree::volumeTotallyInsideLeaf(const Aabb& volume, const Leaf& leaf)
+void Octree::placeLooseInternal(const Aabb& volume, OctreePlaceable& placeable)
+{
+	U32 level;
+	const U32 node = computeLooseNode(volume, level);
+	if(node == placeable.m_looseNode)
+	{
+		// Still in the same node, nothing to do
+		return;
+	}
+
+	removeLooseInternal(placeable);
+
+	// Add it to the list of the node
+	LooseNode& looseNode = m_looseNodes[node];
+	{
+		LockGuard<SpinLock> lock(looseNode.m_lock);
+		placeable.m_looseNode = node;
+		placeable.m_loosePrev = nullptr;
+		placeable.m_looseNext = looseNode.m_firstPlaceable;
+		if(looseNode.m_firstPlaceable)
+		{
+			looseNode.m_firstPlaceable->m_loosePrev = &placeable;
+		}
+		looseNode.m_firstPlaceable = &placeable;
+	}
+
+	// Update the counts up to the root
+	U32 crntNode = node;
+	for(I32 l = I32(level); l >= 0; --l)
+	{
+		m_looseNodes[crntNode].m_subtreePlaceableCount.fetchAdd(1);
+		if(l > 0)
+		{
+			crntNode = m_looseLevelOffsets[l - 1] + ((crntNode - m_looseLevelOffsets[l]) >> 3u);
+		}
+	}
+}
+
+void Octree::removeLooseInternal(OctreePlaceable& placeable)
+{
+	if(placeable.m_looseNode == MAX_U32)
+	{
+		return;
+	}
+
+	const U32 node = placeable.m_looseNode;
+	LooseNode& looseNode = m_looseNodes[node];
+
+	// Remove it from the list of the node
+	{
+		LockGuard<SpinLock> lock(looseNode.m_lock);
+		if(placeable.m_loosePrev)
+		{
+			placeable.m_loosePrev->m_looseNext = placeable.m_looseNext;
+		}
+		else
+		{
+			ANKI_ASSERT(looseNode.m_firstPlaceable == &placeable);
+			looseNode.m_firstPlaceable = placeable.m_looseNext;
+		}
+
+		if(placeable.m_looseNext)
+		{
+			placeable.m_looseNext->m_loosePrev = placeable.m_loosePrev;
+		}
+
+		placeable.m_looseNext = placeable.m_loosePrev = nullptr;
+		placeable.m_looseNode = MAX_U32;
+	}
+
+	// Update the counts up to the root
+	U32 level = 0;
+	while(node >= m_looseLevelOffsets[level + 1])
+	{
+		++level;
+	}
+
+	U32 crntNode = node;
+	for(I32 l = I32(level); l >= 0; --l)
+	{
+		const U32 prevCount = m_looseNodes[crntNode].m_subtreePlaceableCount.fetchSub(1);
+		ANKI_ASSERT(prevCount > 0);
+		(void)prevCount;
+		if(l > 0)
+		{
+			crntNode = m_looseLevelOffsets[l - 1] + ((crntNode - m_looseLevelOffsets[l]) >> 3u);
+		}
+	}
+}
+
+void Octree::narrowRange(F32 coord, F32 value, F32& rangeMin, F32& rangeMax)
+{
+	if(coord > value)
+	{
+		rangeMin = max(rangeMin, value);
+	}
+	else if(coord < value)
+	{
+		rangeMax = min(rangeMax, value);
+	}
+	else
+	{
+		// Any move might change the result of the comparison
+		rangeMin = rangeMax = value;
+	}
+}
+
+Bool Octree::volumeTotallyInsideLeaf(const Aabb& volume, const Leaf& leaf, OctreePlaceable& placeable)
 {
 	const Vec4& amin = volume.getMin();
 	const Vec4& amax = volume.getMax();
 	const Vec3& bmin = leaf.m_aabbMin;
 	const Vec3& bmax = leaf.m_aabbMax;
 
+	for(U32 i = 0; i < 3; ++i)
+	{
+		narrowRange(amin[i], bmin[i], placeable.m_volumeMinRange[0][i], placeable.m_volumeMinRange[1][i]);
+		narrowRange(amax[i], bmax[i], placeable.m_volumeMaxRange[0][i], placeable.m_volumeMaxRange[1][i]);
+	}
+
 	Bool superset = true;
 	superset = superset && amin.x() <= bmin.x();
 	superset = superset && amax.x() >= bmax.x();
@@ -132,7 +534,7 @@ void Octree::placeRecursive(const Aabb& volume, OctreePlaceable* placeable, Leaf
 	ANKI_ASSERT(parent);
 	ANKI_ASSERT(testCollision(volume, Aabb(parent->m_aabbMin, parent->m_aabbMax)) && "Should be inside");
 
-	if(depth == m_maxDepth || volumeTotallyInsideLeaf(volume, *parent))
+	if(depth == m_maxDepth || volumeTotallyInsideLeaf(volume, *parent, *placeable))
 	{
 		// Need to stop and bin the placeable to the leaf
 
@@ -160,6 +562,13 @@ void Octree::placeRecursive(const Aabb& volume, OctreePlaceable* placeable, Leaf
 	const Vec4& vMax = volume.getMax();
 	const Vec3 center = (parent->m_aabbMax + parent->m_aabbMin) / 2.0f;
 
+	// Remember the ranges of the volume that give the same children
+	for(U32 i = 0; i < 3; ++i)
+	{
+		narrowRange(vMin[i], center[i], placeable->m_volumeMinRange[0][i], placeable->m_volumeMinRange[1][i]);
+		narrowRange(vMax[i], center[i], placeable->m_volumeMaxRange[0][i], placeable->m_volumeMaxRange[1][i]);
+	}
+
 	LeafMask maskX;
 	if(vMin.x() > center.x())
 	{
@@ -293,6 +702,8 @@ void Octree::computeChildAabb(LeafMask child,
 
 void Octree::removeInternal(OctreePlaceable& placeable)
 {
+	ANKI_ASSERT(m_type == OctreeType::REGULAR);
+
 	const Bool isPlaced = !placeable.m_leafs.isEmpty();
 	if(isPlaced)
 	{
@@ -332,11 +743,116 @@ void Octree::removeInternal(OctreePlaceable& placeable)
 	}
 }
 
+U32 Octree::testChildren(ConstWeakArray<Plane> planes, const Leaf& leaf, Bool insideFully, U32& insideFullyMask)
+{
+	U32 childMask = 0;
+	Array<Vec3, 8> mins, maxs;
+	for(U32 i = 0; i < 8; ++i)
+	{
+		const Leaf* child = leaf.m_children[i];
+		if(child)
+		{
+			childMask |= 1u << i;
+			mins[i] = child->m_aabbMin;
+			maxs[i] = child->m_aabbMax;
+		}
+		else
+		{
+			mins[i] = maxs[i] = Vec3(0.0f);
+		}
+	}
+
+	if(insideFully || childMask == 0)
+	{
+		// No need to test the planes, the children are inside the parent
+		insideFullyMask = (insideFully) ? childMask : 0;
+		return childMask;
+	}
+
+	U32 visibleMask;
+	testPlanesAabbs(planes, Vec3x8::loadAos(&mins[0]), Vec3x8::loadAos(&maxs[0]), visibleMask, insideFullyMask);
+	insideFullyMask &= childMask;
+	return visibleMask & childMask;
+}
+
+U32 Octree::testLooseChildren(
+	ConstWeakArray<Plane> planes, U32 firstChild, Bool insideFully, U32& insideFullyMask) const
+{
+	U32 childMask = 0;
+	for(U32 i = 0; i < 8; ++i)
+	{
+		childMask |= (m_looseNodes[firstChild + i].m_subtreePlaceableCount.load() > 0) ? (1u << i) : 0u;
+	}
+
+	if(insideFully || childMask == 0)
+	{
+		insideFullyMask = (insideFully) ? childMask : 0;
+		return childMask;
+	}
+
+	// The children are contiguous so load them directly
+	U32 visibleMask;
+	testPlanesAabbs(planes,
+		Vec3x8::loadAos(&m_looseNodeMins[firstChild]),
+		Vec3x8::loadAos(&m_looseNodeMaxs[firstChild]),
+		visibleMask,
+		insideFullyMask);
+	insideFullyMask &= childMask;
+	return visibleMask & childMask;
+}
+
+void Octree::gatherVisibleLooseRecursive(const Plane frustumPlanes[6],
+	U32 testId,
+	OctreeNodeVisibilityTestCallback testCallback,
+	void* testCallbackUserData,
+	U32 node,
+	U32 level,
+	Bool insideFully,
+	DynamicArrayAuto<void*>& out)
+{
+	visitLoosePlaceables(node, testId, [&](void* userData) { out.emplaceBack(userData); });
+
+	if(level == m_maxDepth)
+	{
+		return;
+	}
+
+	const U32 firstChild = getLooseFirstChild(node, level);
+	U32 insideFullyMask;
+	const U32 visibleMask =
+		testLooseChildren(ConstWeakArray<Plane>(frustumPlanes, 6), firstChild, insideFully, insideFullyMask);
+
+	for(U32 i = 0; i < 8; ++i)
+	{
+		if(visibleMask & (1u << i))
+		{
+			Bool inside = true;
+			if(testCallback != nullptr)
+			{
+				inside = testCallback(testCallbackUserData, getLooseNodeAabb(firstChild + i));
+			}
+
+			if(inside)
+			{
+				gatherVisibleLooseRecursive(frustumPlanes,
+					testId,
+					testCallback,
+					testCallbackUserData,
+					firstChild + i,
+					level + 1,
+					!!(insideFullyMask & (1u << i)),
+					out);
+			}
+		}
+	}
+}
+
 void Octree::gatherVisibleRecursive(const Plane frustumPlanes[6],
 	U32 testId,
 	OctreeNodeVisibilityTestCallback testCallback,
 	void* testCallbackUserData,
 	Leaf* leaf,
+	Bool insideFully,
 	DynamicArrayAuto<void*>& out)
 {
 	ANKI_ASSERT(leaf);
@@ -352,32 +868,34 @@ void Octree::gatherVisibleRecursive(const Plane frustumPlanes[6],
 	}
 
 	// Move to children leafs
+	U32 insideFullyMask;
+	const U32 visibleMask =
+		testChildren(ConstWeakArray<Plane>(frustumPlanes, 6), *leaf, insideFully, insideFullyMask);
+
 	Aabb aabb;
-	for(Leaf* child : leaf->m_children)
+	for(U32 i = 0; i < 8; ++i)
 	{
-		if(child)
+		if(visibleMask & (1u << i))
 		{
+			Leaf* child = leaf->m_children[i];
 			aabb.setMin(child->m_aabbMin);
 			aabb.setMax(child->m_aabbMax);
 
 			Bool inside = true;
-			for(U i = 0; i < 6; ++i)
-			{
-				if(testPlane(frustumPlanes[i], aabb) < 0.0f)
-				{
-					inside = false;
-					break;
-				}
-			}
-
-			if(inside && testCallback != nullptr)
+			if(testCallback != nullptr)
 			{
 				inside = testCallback(testCallbackUserData, aabb);
 			}
 
 			if(inside)
 			{
-				gatherVisibleRecursive(frustumPlanes, testId, testCallback, testCallbackUserData, child, out);
+				gatherVisibleRecursive(frustumPlanes,
+					testId,
+					testCallback,
+					testCallbackUserData,
+					child,
+					!!(insideFullyMask & (1u << i)),
+					out);
 			}
 		}
 	}
@@ -443,6 +961,31 @@ void Octree::debugDrawRecursive(const Leaf& leaf, OctreeDebugDrawer& drawer) con
 	}
 }
 
+void Octree::debugDrawLooseRecursive(U32 node, U32 level, OctreeDebugDrawer& drawer) const
+{
+	U32 placeableCount = 0;
+	for(const OctreePlaceable* placeable = m_looseNodes[node].m_firstPlaceable; placeable;
+		placeable = placeable->m_looseNext)
+	{
+		++placeableCount;
+	}
+
+	const Vec3 color = (placeableCount > 0) ? heatmap(10.0f / F32(placeableCount)) : Vec3(0.25f);
+	drawer.drawCube(getLooseNodeAabb(node), Vec4(color, 1.0f));
+
+	if(level < m_maxDepth)
+	{
+		const U32 firstChild = getLooseFirstChild(node, level);
+		for(U32 child = firstChild; child < firstChild + 8; ++child)
+		{
+			if(m_looseNodes[child].m_subtreePlaceableCount.load() > 0)
+			{
+				debugDrawLooseRecursive(child, level + 1, drawer);
+			}
+		}
+	}
+}
+
 void Octree::gatherVisibleParallel(const Plane frustumPlanes[6],
 	U32 testId,
 	OctreeNodeVisibilityTestCallback testCallback,
@@ -469,6 +1012,9 @@ void Octree::gatherVisibleParallel(const Plane frustumPlanes[6],
 		hive.allocateScratchMemory(sizeof(GatherParallelTaskCtx), alignof(GatherParallelTaskCtx)));
 	taskCtx->m_ctx = ctx;
 	taskCtx->m_leaf = m_rootLeaf;
+	taskCtx->m_looseNode = 0;
+	taskCtx->m_looseLevel = 0;
+	taskCtx->m_insideFully = false;
 
 	// Create signal semaphore
 	signalSemaphore = hive.newSemaphore(1);
@@ -493,6 +1039,12 @@ void Octree::gatherVisibleTaskCallback(void* ud, U32 threadId, ThreadHive& hive,
 void Octree::gatherVisibleParallelTask(
 	U32 threadId, ThreadHive& hive, ThreadHiveSemaphore* sem, GatherParallelTaskCtx& taskCtx)
 {
+	if(m_type == OctreeType::LOOSE)
+	{
+		gatherVisibleLooseParallelTask(hive, sem, taskCtx);
+		return;
+	}
+
 	ANKI_ASSERT(taskCtx.m_ctx && taskCtx.m_leaf);
 	GatherParallelCtx& ctx = *taskCtx.m_ctx;
 
@@ -520,25 +1072,20 @@ void Octree::gatherVisibleParallelTask(
 	// Move to children leafs
 	Array<ThreadHiveTask, 8> tasks;
 	U32 taskCount = 0;
+	U32 insideFullyMask;
+	const U32 visibleMask = testChildren(ctx.m_frustumPlanes, *leaf, taskCtx.m_insideFully, insideFullyMask);
+
 	Aabb aabb;
-	for(Leaf* child : leaf->m_children)
+	for(U32 i = 0; i < 8; ++i)
 	{
-		if(child)
+		if(visibleMask & (1u << i))
 		{
+			Leaf* child = leaf->m_children[i];
 			aabb.setMin(child->m_aabbMin);
 			aabb.setMax(child->m_aabbMax);
 
 			Bool inside = true;
-			for(U i = 0; i < 6; ++i)
-			{
-				if(testPlane(taskCtx.m_ctx->m_frustumPlanes[i], aabb) < 0.0f)
-				{
-					inside = false;
-					break;
-				}
-			}
-
-			if(inside && testCallback != nullptr)
+			if(testCallback != nullptr)
 			{
 				inside = testCallback(testCallbackUserData, aabb);
 			}
@@ -550,6 +1097,7 @@ void Octree::gatherVisibleParallelTask(
 					hive.allocateScratchMemory(sizeof(GatherParallelTaskCtx), alignof(GatherParallelTaskCtx)));
 				newTaskCtx->m_ctx = taskCtx.m_ctx;
 				newTaskCtx->m_leaf = child;
+				newTaskCtx->m_insideFully = !!(insideFullyMask & (1u << i));
 
 				// Populate the task
 				ThreadHiveTask& task = tasks[taskCount++];
@@ -572,4 +1120,66 @@ void Octree::gatherVisibleParallelTask(
 	}
 }
 
+void Octree::gatherVisibleLooseParallelTask(ThreadHive& hive, ThreadHiveSemaphore* sem, GatherParallelTaskCtx& taskCtx)
+{
+	ANKI_ASSERT(taskCtx.m_ctx && taskCtx.m_looseNode < m_looseNodes.getSize());
+	GatherParallelCtx& ctx = *taskCtx.m_ctx;
+	const U32 node = taskCtx.m_looseNode;
+	const U32 level = taskCtx.m_looseLevel;
+
+	// Add the placeables that belong to that node
+	if(m_looseNodes[node].m_firstPlaceable)
+	{
+		LockGuard<SpinLock> lock(ctx.m_lock);
+		visitLoosePlaceables(node, ctx.m_testId, [&](void* userData) { ctx.m_out->emplaceBack(userData); });
+	}
+
+	if(level == m_maxDepth)
+	{
+		return;
+	}
+
+	// Move to the children
+	Array<ThreadHiveTask, 8> tasks;
+	U32 taskCount = 0;
+	const U32 firstChild = getLooseFirstChild(node, level);
+	U32 insideFullyMask;
+	const U32 visibleMask = testLooseChildren(ctx.m_frustumPlanes, firstChild, taskCtx.m_insideFully, insideFullyMask);
+
+	for(U32 i = 0; i < 8; ++i)
+	{
+		if(visibleMask & (1u << i))
+		{
+			Bool inside = true;
+			if(ctx.m_testCallback != nullptr)
+			{
+				inside = ctx.m_testCallback(ctx.m_testCallbackUserData, getLooseNodeAabb(firstChild + i));
+			}
+
+			if(inside)
+			{
+				GatherParallelTaskCtx* newTaskCtx = static_cast<GatherParallelTaskCtx*>(
+					hive.allocateScratchMemory(sizeof(GatherParallelTaskCtx), alignof(GatherParallelTaskCtx)));
+				newTaskCtx->m_ctx = taskCtx.m_ctx;
+				newTaskCtx->m_leaf = nullptr;
+				newTaskCtx->m_looseNode = firstChild + i;
+				newTaskCtx->m_looseLevel = level + 1;
+				newTaskCtx->m_insideFully = !!(insideFullyMask & (1u << i));
+
+				ThreadHiveTask& task = tasks[taskCount++];
+				task.m_callback = gatherVisibleTaskCallback;
+				task.m_argument = newTaskCtx;
+				task.m_signalSemaphore = sem;
+			}
+		}
+	}
+
+	if(taskCount)
+	{
+		// Same trick as in gatherVisibleParallelTask()
+		sem->increaseSemaphore(taskCount);
+		hive.submitTasks(&tasks[0], taskCount);
+	}
+}
+
 } // end namespace anki
@@ -35,6 +35,27 @@ public:
 	virtual void drawCube(const Aabb& box, const Vec4& color) = 0;
 };
 
+/// The type of an Octree.
+enum class OctreeType : U8
+{
+	/// The leafs are allocated on demand and a placeable is binned to all the leafs of the max depth it overlaps.
+	REGULAR,
+
+	/// All the nodes are allocated up front in breadth first order and their boxes are twice the size of the regular
+	/// ones. Each placeable goes to a single node that is picked from its size and center so placing is O(1) and
+	/// moving placeables rarely change nodes.
+	LOOSE
+};
+
+/// An element of Octree::placeBatch.
+class OctreePlaceRequest
+{
+public:
+	Aabb m_volume;
+	OctreePlaceable* m_placeable = nullptr;
+	Bool m_updateActualSceneBounds = true;
+};
+
 /// Octree for visibility tests.
 class Octree : public NonCopyable
 {
@@ -48,12 +69,20 @@ public:
 
 	~Octree();
 
-	void init(const Vec3& sceneAabbMin, const Vec3& sceneAabbMax, U32 maxDepth);
+	void init(const Vec3& sceneAabbMin, const Vec3& sceneAabbMax, U32 maxDepth, OctreeType type = OctreeType::REGULAR);
 
-	/// Place or re-place an element in the tree.
+	/// Change the bounds of the scene. The tree should be empty.
+	void setSceneBounds(const Vec3& sceneAabbMin, const Vec3& sceneAabbMax);
+
+	/// Place or re-place an element in the tree. If the placeable stays in the same leafs it's almost free.
 	/// @note It's thread-safe against place and remove methods.
 	void place(const Aabb& volume, OctreePlaceable* placeable, Bool updateActualSceneBounds);
 
+	/// Place or re-place many elements in the tree. It's the same as calling place() for each one of them but it locks
+	/// once and only if some placeables move to other leafs. The loose octree doesn't lock at all.
+	/// @note It's thread-safe against place and remove methods.
+	void placeBatch(ConstWeakArray<OctreePlaceRequest> requests);
+
 	/// Remove an element from the tree.
 	/// @note It's thread-safe against place and remove methods.
 	void remove(OctreePlaceable& placeable);
@@ -72,7 +101,14 @@ public:
 		void* testCallbackUserData,
 		DynamicArrayAuto<void*>& out)
 	{
-		gatherVisibleRecursive(frustumPlanes, testId, testCallback, testCallbackUserData, m_rootLeaf, out);
+		if(m_type == OctreeType::LOOSE)
+		{
+			gatherVisibleLooseRecursive(frustumPlanes, testId, testCallback, testCallbackUserData, 0, 0, false, out);
+		}
+		else
+		{
+			gatherVisibleRecursive(frustumPlanes, testId, testCallback, testCallbackUserData, m_rootLeaf, false, out);
+		}
 	}
 
 	/// Similar to gatherVisible but it spawns ThreadHive tasks.
@@ -95,21 +131,121 @@ public:
 	template<typename TTestAabbFunc, typename TNewPlaceableFunc>
 	void walkTree(U32 testId, TTestAabbFunc testFunc, TNewPlaceableFunc newPlaceableFunc)
 	{
-		ANKI_ASSERT(m_rootLeaf);
-		walkTreeInternal(*m_rootLeaf, testId, testFunc, newPlaceableFunc);
+		if(m_type == OctreeType::LOOSE)
+		{
+			walkTreeLooseInternal(0, 0, testId, testFunc, newPlaceableFunc);
+		}
+		else
+		{
+			ANKI_ASSERT(m_rootLeaf);
+			walkTreeInternal(*m_rootLeaf, testId, testFunc, newPlaceableFunc);
+		}
+	}
+
+	/// Walk the tree and cull the leafs against some planes. It's faster than doing the plane tests in the
+	/// TTestAabbFunc since it tests all the children of a leaf at once and it skips the tests of the leafs that are
+	/// inside a leaf that is fully inside the planes.
+	/// @tparam TTestAabbFunc The lambda that will do additional tests to an Aabb that passed the plane tests.
+	///                       Signature of lambda: Bool(*)(const Aabb& leafBox)
+	/// @tparam TNewPlaceableFunc The lambda to do something with a visible placeable.
+	///                           Signature: void(*)(void* placeableUserData).
+	/// @param planes The planes to test against. Typically the planes of a frustum.
+	/// @param testId The test index.
+	/// @param testFunc See TTestAabbFunc.
+	/// @param newPlaceableFunc See TNewPlaceableFunc.
+	template<typename TTestAabbFunc, typename TNewPlaceableFunc>
+	void walkTree(
+		ConstWeakArray<Plane> planes, U32 testId, TTestAabbFunc testFunc, TNewPlaceableFunc newPlaceableFunc)
+	{
+		if(m_type == OctreeType::LOOSE)
+		{
+			walkTreeLooseInternal(planes, 0, 0, false, testId, testFunc, newPlaceableFunc);
+		}
+		else
+		{
+			ANKI_ASSERT(m_rootLeaf);
+			walkTreeInternal(planes, *m_rootLeaf, false, testId, testFunc, newPlaceableFunc);
+		}
+	}
+
+	/// Walk the leafs that intersect a packet of rays or segments. Only the rays that intersect a leaf are tested
+	/// against its children.
+	/// @tparam TRayPacket RayPacket4 or RayPacket8.
+	/// @tparam TNewPlaceableFunc The lambda to do something with a placeable of a leaf that intersects with the rays.
+	///                           Signature: void(*)(void* placeableUserData).
+	/// @param rays The rays.
+	/// @param testId The test index.
+	/// @param newPlaceableFunc See TNewPlaceableFunc.
+	template<typename TRayPacket, typename TNewPlaceableFunc>
+	void walkTree(const TRayPacket& rays, U32 testId, TNewPlaceableFunc newPlaceableFunc)
+	{
+		Aabb aabb;
+		if(m_type == OctreeType::LOOSE)
+		{
+			aabb.setMin(m_looseNodeMins[0]);
+			aabb.setMax(m_looseNodeMaxs[0]);
+		}
+		else
+		{
+			ANKI_ASSERT(m_rootLeaf);
+			aabb.setMin(m_rootLeaf->m_aabbMin);
+			aabb.setMax(m_rootLeaf->m_aabbMax);
+		}
+
+		const U32 rayMask = rays.intersect(aabb);
+		if(rayMask == 0)
+		{
+			return;
+		}
+
+		if(m_type == OctreeType::LOOSE)
+		{
+			walkTreeLooseInternal(rays, rayMask, 0, 0, testId, newPlaceableFunc);
+		}
+		else
+		{
+			walkTreeInternal(rays, rayMask, *m_rootLeaf, testId, newPlaceableFunc);
+		}
 	}
 
 	/// Debug draw.
 	void debugDraw(OctreeDebugDrawer& drawer) const
 	{
-		ANKI_ASSERT(m_rootLeaf);
-		debugDrawRecursive(*m_rootLeaf, drawer);
+		if(m_type == OctreeType::LOOSE)
+		{
+			debugDrawLooseRecursive(0, 0, drawer);
+		}
+		else
+		{
+			ANKI_ASSERT(m_rootLeaf);
+			debugDrawRecursive(*m_rootLeaf, drawer);
+		}
+	}
+
+	OctreeType getType() const
+	{
+		return m_type;
 	}
 
+	/// Get a number that changes every time a placeable is placed, moved or removed. Useful to know if the results of
+	/// previous gathers are still valid.
+	U64 getChangeEpoch() const
+	{
+		return m_changeEpoch.load();
+	}
+
+	/// Check if a placeable was placed, moved or removed inside a volume after an epoch. It's a lot more fine grained
+	/// than comparing epochs. The tree remembers only the last few changes so it might say that the volume changed
+	/// when it didn't, never the opposite.
+	/// @param volume The volume to check.
+	/// @param epoch A value that getChangeEpoch() returned in the past.
+	/// @note It's thread-safe against place and remove methods.
+	Bool volumeChangedSince(const Aabb& volume, U64 epoch) const;
+
 	/// Get the bounds of the scene as calculated by the objects that were placed inside the Octree.
 	void getActualSceneBounds(Vec3& min, Vec3& max) const
 	{
-		LockGuard<Mutex> lock(m_globalMtx);
+		LockGuard<SpinLock> lock(m_actualSceneBoundsLock);
 		ANKI_ASSERT(m_actualSceneAabbMin.x() < MAX_F32);
 		ANKI_ASSERT(m_actualSceneAabbMax.x() > MIN_F32);
 		min = m_actualSceneAabbMin;
@@ -198,7 +334,29 @@ private:
 	};
 	ANKI_ENUM_ALLOW_NUMERIC_OPERATIONS(LeafMask, friend)
 
+	/// A node of the loose octree. The children of a node are contiguous so they can be tested at once.
+	class LooseNode
+	{
+	public:
+		SpinLock m_lock; ///< Protects the list of placeables.
+		OctreePlaceable* m_firstPlaceable = nullptr;
+		Atomic<U32> m_subtreePlaceableCount = {0}; ///< The placeables of the node and all of its descendants.
+	};
+
+	/// The union of the old and new volume of a placeable that changed.
+	class ChangedVolume
+	{
+	public:
+		Vec3 m_min;
+		Vec3 m_max;
+		U64 m_epoch;
+	};
+
+	static constexpr U32 MAX_LOOSE_DEPTH = 6;
+	static constexpr U32 MAX_CHANGED_VOLUMES = 512;
+
 	SceneAllocator<U8> m_alloc;
+	OctreeType m_type = OctreeType::REGULAR;
 	U32 m_maxDepth = 0;
 	Vec3 m_sceneAabbMin = Vec3(0.0f);
 	Vec3 m_sceneAabbMax = Vec3(0.0f);
@@ -211,9 +369,30 @@ private:
 	Leaf* m_rootLeaf = nullptr;
 	U32 m_placeableCount = 0;
 
+	DynamicArray<LooseNode> m_looseNodes;
+	DynamicArray<Vec3> m_looseNodeMins; ///< The loose boxes of the nodes. Separate for the SIMD tests.
+	DynamicArray<Vec3> m_looseNodeMaxs;
+	Array<U32, MAX_LOOSE_DEPTH + 2> m_looseLevelOffsets = {}; ///< The first node of each level.
+
 	/// Compute the min of the scene bounds based on what is placed inside the octree.
 	Vec3 m_actualSceneAabbMin = Vec3(MAX_F32);
 	Vec3 m_actualSceneAabbMax = Vec3(MIN_F32);
+	mutable SpinLock m_actualSceneBoundsLock;
+
+	Atomic<U64> m_changeEpoch = {1};
+
+	/// A ring buffer with the last changes.
+	Array<ChangedVolume, MAX_CHANGED_VOLUMES> m_changedVolumes;
+	U64 m_changedVolumeCount = 0; ///< All the changes ever recorded.
+	U64 m_lostChangeEpoch = 0; ///< The newest epoch of the changes that were overwritten in the ring buffer.
+	mutable SpinLock m_changedVolumesLock;
+
+	/// Remember that some volumes changed.
+	void recordChanges(ConstWeakArray<OctreePlaceRequest> requests, U64 epoch);
+
+	/// Remember the change of a single placeable. The new volume is empty if it's removed.
+	/// @note Call it with the m_changedVolumesLock locked.
+	void recordChange(OctreePlaceable& placeable, const Vec3& newMin, const Vec3& newMax, U64 epoch);
 
 	Leaf* newLeaf()
 	{
@@ -251,9 +430,42 @@ private:
 		m_leafNodeAlloc.deleteInstance(m_alloc, node);
 	}
 
+	void placeInternal(const Aabb& volume, OctreePlaceable* placeable);
+
 	void placeRecursive(const Aabb& volume, OctreePlaceable* placeable, Leaf* parent, U32 depth);
 
-	static Bool volumeTotallyInsideLeaf(const Aabb& volume, const Leaf& leaf);
+	/// Check if re-placing would give the same leafs. It only reads the placeable.
+	Bool staysInTheSameLeafs(const Aabb& volume, const OctreePlaceable& placeable) const;
+
+	/// Narrow the range of a coordinate of a volume so that its comparison with a value gives the same result.
+	static void narrowRange(F32 coord, F32 value, F32& rangeMin, F32& rangeMax);
+
+	void initLoose();
+
+	/// Find the node of the loose octree that should hold a volume.
+	/// @param[out] level The level of the node.
+	U32 computeLooseNode(const Aabb& volume, U32& level) const;
+
+	void placeLooseInternal(const Aabb& volume, OctreePlaceable& placeable);
+
+	void removeLooseInternal(OctreePlaceable& placeable);
+
+	U32 getLooseFirstChild(U32 node, U32 level) const
+	{
+		ANKI_ASSERT(level < m_maxDepth);
+		return m_looseLevelOffsets[level + 1] + (node - m_looseLevelOffsets[level]) * 8;
+	}
+
+	/// Same as testChildren() for the loose octree.
+	U32 testLooseChildren(ConstWeakArray<Plane> planes, U32 firstChild, Bool insideFully, U32& insideFullyMask) const;
+
+	Aabb getLooseNodeAabb(U32 node) const
+	{
+		return Aabb(m_looseNodeMins[node], m_looseNodeMaxs[node]);
+	}
+
+	/// @note It also narrows the ranges of the placeable.
+	static Bool volumeTotallyInsideLeaf(const Aabb& volume, const Leaf& leaf, OctreePlaceable& placeable);
 
 	static void computeChildAabb(LeafMask child,
 		const Vec3& parentAabbMin,
@@ -265,11 +477,29 @@ private:
 	/// Remove a placeable from the tree.
 	void removeInternal(OctreePlaceable& placeable);
 
+	/// Test the children of a leaf against the planes.
+	/// @param planes The planes.
+	/// @param leaf The parent leaf.
+	/// @param insideFully If true the parent is inside the planes and the tests will be skipped.
+	/// @param[out] insideFullyMask The children that are completely inside the planes.
+	/// @return The children that are visible.
+	static U32 testChildren(ConstWeakArray<Plane> planes, const Leaf& leaf, Bool insideFully, U32& insideFullyMask);
+
 	static void gatherVisibleRecursive(const Plane frustumPlanes[6],
 		U32 testId,
 		OctreeNodeVisibilityTestCallback testCallback,
 		void* testCallbackUserData,
 		Leaf* leaf,
+		Bool insideFully,
+		DynamicArrayAuto<void*>& out);
+
+	void gatherVisibleLooseRecursive(const Plane frustumPlanes[6],
+		U32 testId,
+		OctreeNodeVisibilityTestCallback testCallback,
+		void* testCallbackUserData,
+		U32 node,
+		U32 level,
+		Bool insideFully,
 		DynamicArrayAuto<void*>& out);
 
 	/// ThreadHive callback.
@@ -278,6 +508,8 @@ private:
 	void gatherVisibleParallelTask(
 		U32 threadId, ThreadHive& hive, ThreadHiveSemaphore* sem, GatherParallelTaskCtx& taskCtx);
 
+	void gatherVisibleLooseParallelTask(ThreadHive& hive, ThreadHiveSemaphore* sem, GatherParallelTaskCtx& taskCtx);
+
 	/// Remove a leaf.
 	void cleanupRecursive(Leaf* leaf, Bool& canDeleteLeafUponReturn);
 
@@ -287,8 +519,43 @@ private:
 	/// Debug draw.
 	void debugDrawRecursive(const Leaf& leaf, OctreeDebugDrawer& drawer) const;
 
+	void debugDrawLooseRecursive(U32 node, U32 level, OctreeDebugDrawer& drawer) const;
+
+	/// Visit the placeables of a loose node.
+	template<typename TNewPlaceableFunc>
+	void visitLoosePlaceables(U32 node, U32 testId, TNewPlaceableFunc newPlaceableFunc);
+
 	template<typename TTestAabbFunc, typename TNewPlaceableFunc>
 	void walkTreeInternal(Leaf& leaf, U32 testId, TTestAabbFunc testFunc, TNewPlaceableFunc newPlaceableFunc);
+
+	template<typename TTestAabbFunc, typename TNewPlaceableFunc>
+	void walkTreeInternal(ConstWeakArray<Plane> planes,
+		Leaf& leaf,
+		Bool insideFully,
+		U32 testId,
+		TTestAabbFunc testFunc,
+		TNewPlaceableFunc newPlaceableFunc);
+
+	template<typename TRayPacket, typename TNewPlaceableFunc>
+	void walkTreeInternal(
+		const TRayPacket& rays, U32 rayMask, Leaf& leaf, U32 testId, TNewPlaceableFunc newPlaceableFunc);
+
+	template<typename TTestAabbFunc, typename TNewPlaceableFunc>
+	void walkTreeLooseInternal(
+		U32 node, U32 level, U32 testId, TTestAabbFunc testFunc, TNewPlaceableFunc newPlaceableFunc);
+
+	template<typename TTestAabbFunc, typename TNewPlaceableFunc>
+	void walkTreeLooseInternal(ConstWeakArray<Plane> planes,
+		U32 node,
+		U32 level,
+		Bool insideFully,
+		U32 testId,
+		TTestAabbFunc testFunc,
+		TNewPlaceableFunc newPlaceableFunc);
+
+	template<typename TRayPacket, typename TNewPlaceableFunc>
+	void walkTreeLooseInternal(
+		const TRayPacket& rays, U32 rayMask, U32 node, U32 level, U32 testId, TNewPlaceableFunc newPlaceableFunc);
 };
 
 /// An entity that can be placed in octrees.
@@ -308,6 +575,21 @@ private:
 	Atomic<U64> m_visitedMask = {0u};
 	IntrusiveList<Octree::LeafNode> m_leafs; ///< A list of leafs this placeable belongs.
 
+	/// The ranges that the min and max of the volume can move to without changing leafs. The ranges are open.
+	Array<Vec3, 2> m_volumeMinRange;
+	Array<Vec3, 2> m_volumeMaxRange;
+
+	/// The volume it was placed with. An empty volume if it's not placed.
+	Vec3 m_volumeMin = Vec3(MAX_F32);
+	Vec3 m_volumeMax = Vec3(MIN_F32);
+
+	/// @name Loose octree
+	/// @{
+	OctreePlaceable* m_looseNext = nullptr;
+	OctreePlaceable* m_loosePrev = nullptr;
+	U32 m_looseNode = MAX_U32;
+	/// @}
+
 	/// Check if already visited.
 	/// @note It's thread-safe.
 	Bool alreadyVisited(U32 testId)
@@ -351,6 +633,195 @@ inline void Octree::walkTreeInternal(Leaf& leaf, U32 testId, TTestAabbFunc testF
 
 	ANKI_TRACE_INC_COUNTER(OCTREE_VISIBLE_LEAFS, visibleLeafs);
 }
+
+template<typename TTestAabbFunc, typename TNewPlaceableFunc>
+inline void Octree::walkTreeInternal(ConstWeakArray<Plane> planes,
+	Leaf& leaf,
+	Bool insideFully,
+	U32 testId,
+	TTestAabbFunc testFunc,
+	TNewPlaceableFunc newPlaceableFunc)
+{
+	// Visit the placeables that belong to that leaf
+	for(PlaceableNode& placeableNode : leaf.m_placeables)
+	{
+		if(!placeableNode.m_placeable->alreadyVisited(testId))
+		{
+			ANKI_ASSERT(placeableNode.m_placeable->m_userData);
+			newPlaceableFunc(placeableNode.m_placeable->m_userData);
+		}
+	}
+
+	U32 insideFullyMask;
+	const U32 visibleMask = testChildren(planes, leaf, insideFully, insideFullyMask);
+
+	Aabb aabb;
+	U visibleLeafs = 0;
+	(void)visibleLeafs;
+	for(U32 i = 0; i < 8; ++i)
+	{
+		if(visibleMask & (1u << i))
+		{
+			Leaf& child = *leaf.m_children[i];
+			aabb.setMin(child.m_aabbMin);
+			aabb.setMax(child.m_aabbMax);
+			if(testFunc(aabb))
+			{
+				++visibleLeafs;
+				walkTreeInternal(
+					planes, child, !!(insideFullyMask & (1u << i)), testId, testFunc, newPlaceableFunc);
+			}
+		}
+	}
+
+	ANKI_TRACE_INC_COUNTER(OCTREE_VISIBLE_LEAFS, visibleLeafs);
+}
+
+template<typename TRayPacket, typename TNewPlaceableFunc>
+inline void Octree::walkTreeInternal(
+	const TRayPacket& rays, U32 rayMask, Leaf& leaf, U32 testId, TNewPlaceableFunc newPlaceableFunc)
+{
+	// Visit the placeables that belong to that leaf
+	for(PlaceableNode& placeableNode : leaf.m_placeables)
+	{
+		if(!placeableNode.m_placeable->alreadyVisited(testId))
+		{
+			ANKI_ASSERT(placeableNode.m_placeable->m_userData);
+			newPlaceableFunc(placeableNode.m_placeable->m_userData);
+		}
+	}
+
+	Aabb aabb;
+	U visibleLeafs = 0;
+	(void)visibleLeafs;
+	for(Leaf* child : leaf.m_children)
+	{
+		if(child)
+		{
+			aabb.setMin(child->m_aabbMin);
+			aabb.setMax(child->m_aabbMax);
+			const U32 childRayMask = rays.intersect(aabb, rayMask);
+			if(childRayMask)
+			{
+				++visibleLeafs;
+				walkTreeInternal(rays, childRayMask, *child, testId, newPlaceableFunc);
+			}
+		}
+	}
+
+	ANKI_TRACE_INC_COUNTER(OCTREE_VISIBLE_LEAFS, visibleLeafs);
+}
+
+template<typename TNewPlaceableFunc>
+inline void Octree::visitLoosePlaceables(U32 node, U32 testId, TNewPlaceableFunc newPlaceableFunc)
+{
+	for(OctreePlaceable* placeable = m_looseNodes[node].m_firstPlaceable; placeable; placeable = placeable->m_looseNext)
+	{
+		if(!placeable->alreadyVisited(testId))
+		{
+			ANKI_ASSERT(placeable->m_userData);
+			newPlaceableFunc(placeable->m_userData);
+		}
+	}
+}
+
+template<typename TTestAabbFunc, typename TNewPlaceableFunc>
+inline void Octree::walkTreeLooseInternal(
+	U32 node, U32 level, U32 testId, TTestAabbFunc testFunc, TNewPlaceableFunc newPlaceableFunc)
+{
+	visitLoosePlaceables(node, testId, newPlaceableFunc);
+
+	if(level == m_maxDepth)
+	{
+		return;
+	}
+
+	U visibleLeafs = 0;
+	(void)visibleLeafs;
+	const U32 firstChild = getLooseFirstChild(node, level);
+	for(U32 child = firstChild; child < firstChild + 8; ++child)
+	{
+		if(m_looseNodes[child].m_subtreePlaceableCount.load() > 0 && testFunc(getLooseNodeAabb(child)))
+		{
+			++visibleLeafs;
+			walkTreeLooseInternal(child, level + 1, testId, testFunc, newPlaceableFunc);
+		}
+	}
+
+	ANKI_TRACE_INC_COUNTER(OCTREE_VISIBLE_LEAFS, visibleLeafs);
+}
+
+template<typename TTestAabbFunc, typename TNewPlaceableFunc>
+inline void Octree::walkTreeLooseInternal(ConstWeakArray<Plane> planes,
+	U32 node,
+	U32 level,
+	Bool insideFully,
+	U32 testId,
+	TTestAabbFunc testFunc,
+	TNewPlaceableFunc newPlaceableFunc)
+{
+	visitLoosePlaceables(node, testId, newPlaceableFunc);
+
+	if(level == m_maxDepth)
+	{
+		return;
+	}
+
+	const U32 firstChild = getLooseFirstChild(node, level);
+	U32 insideFullyMask;
+	const U32 visibleMask = testLooseChildren(planes, firstChild, insideFully, insideFullyMask);
+
+	U visibleLeafs = 0;
+	(void)visibleLeafs;
+	for(U32 i = 0; i < 8; ++i)
+	{
+		if((visibleMask & (1u << i)) && testFunc(getLooseNodeAabb(firstChild + i)))
+		{
+			++visibleLeafs;
+			walkTreeLooseInternal(planes,
+				firstChild + i,
+				level + 1,
+				!!(insideFullyMask & (1u << i)),
+				testId,
+				testFunc,
+				newPlaceableFunc);
+		}
+	}
+
+	ANKI_TRACE_INC_COUNTER(OCTREE_VISIBLE_LEAFS, visibleLeafs);
+}
+
+template<typename TRayPacket, typename TNewPlaceableFunc>
+inline void Octree::walkTreeLooseInternal(
+	const TRayPacket& rays, U32 rayMask, U32 node, U32 level, U32 testId, TNewPlaceableFunc newPlaceableFunc)
+{
+	visitLoosePlaceables(node, testId, newPlaceableFunc);
+
+	if(level == m_maxDepth)
+	{
+		return;
+	}
+
+	U visibleLeafs = 0;
+	(void)visibleLeafs;
+	const U32 firstChild = getLooseFirstChild(node, level);
+	for(U32 child = firstChild; child < firstChild + 8; ++child)
+	{
+		if(m_looseNodes[child].m_subtreePlaceableCount.load() == 0)
+		{
+			continue;
+		}
+
+		const U32 childRayMask = rays.intersect(getLooseNodeAabb(child), rayMask);
+		if(childRayMask)
+		{
+			++visibleLeafs;
+			walkTreeLooseInternal(rays, childRayMask, child, level + 1, testId, newPlaceableFunc);
+		}
+	}
+
+	ANKI_TRACE_INC_COUNTER(OCTREE_VISIBLE_LEAFS, visibleLeafs);
+}
 /// @}
 
 } // end namespace anki
@@ -11,6 +11,8 @@
 #include <anki/resource/ModelResource.h>
 #include <anki/resource/ResourceManager.h>
 #include <anki/util/Functions.h>
+#include <anki/util/ThreadHive.h>
+#include <anki/util/Tracer.h>
 #include <anki/physics/PhysicsBody.h>
 #include <anki/physics/PhysicsWorld.h>
 #include <anki/physics/PhysicsCollisionShape.h>
@@ -28,175 +30,14 @@ static Vec3 getRandom(const Vec3& min, const Vec3& max)
 	return out;
 }
 
-/// Particle base
-class ParticleEmitterNode::ParticleBase
+/// A range of the particles of an emitter that is simulated by a single thread.
+class ParticleEmitterNode::SimulationChunk
 {
 public:
-	Second m_timeOfBirth; ///< Keep the time of birth for nice effects
-	Second m_timeOfDeath = -1.0; ///< Time of death. If < 0.0 then dead
-
-	F32 m_initialSize;
-	F32 m_finalSize;
-	F32 m_crntSize;
-
-	F32 m_initialAlpha;
-	F32 m_finalAlpha;
-	F32 m_crntAlpha;
-
-	Vec4 m_crntPosition;
-
-	virtual ~ParticleBase()
-	{
-	}
-
-	Bool isDead() const
-	{
-		return m_timeOfDeath < 0.0;
-	}
-
-	/// Kill the particle
-	virtual void kill()
-	{
-		ANKI_ASSERT(m_timeOfDeath > 0.0);
-		m_timeOfDeath = -1.0;
-	}
-
-	/// Revive the particle
-	virtual void revive(
-		const ParticleEmitterProperties& props, const Transform& trf, Second prevUpdateTime, Second crntTime)
-	{
-		ANKI_ASSERT(isDead());
-
-		// life
-		m_timeOfDeath = crntTime + getRandomRange(props.m_particle.m_minLife, props.m_particle.m_maxLife);
-		m_timeOfBirth = crntTime;
-
-		// Size
-		m_initialSize = getRandomRange(props.m_particle.m_minInitialSize, props.m_particle.m_maxInitialSize);
-		m_finalSize = getRandomRange(props.m_particle.m_minFinalSize, props.m_particle.m_maxFinalSize);
-
-		// Alpha
-		m_initialAlpha = getRandomRange(props.m_particle.m_minInitialAlpha, props.m_particle.m_maxInitialAlpha);
-		m_finalAlpha = getRandomRange(props.m_particle.m_minFinalAlpha, props.m_particle.m_maxFinalAlpha);
-	}
-
-	/// Common sumulation code
-	virtual void simulate(Second prevUpdateTime, Second crntTime)
-	{
-		const F32 lifeFactor = F32((crntTime - m_timeOfBirth) / (m_timeOfDeath - m_timeOfBirth));
-
-		m_crntSize = mix(m_initialSize, m_finalSize, lifeFactor);
-		m_crntAlpha = mix(m_initialAlpha, m_finalAlpha, lifeFactor);
-	}
-};
-
-/// Simple particle for simple simulation
-class ParticleEmitterNode::ParticleSimple : public ParticleEmitterNode::ParticleBase
-{
-public:
-	Vec4 m_velocity = Vec4(0.0);
-	Vec4 m_acceleration = Vec4(0.0);
-
-	void revive(
-		const ParticleEmitterProperties& props, const Transform& trf, Second prevUpdateTime, Second crntTime) override
-	{
-		ParticleBase::revive(props, trf, prevUpdateTime, crntTime);
-		m_velocity = Vec4(0.0);
-
-		m_acceleration = getRandom(props.m_particle.m_minGravity, props.m_particle.m_maxGravity).xyz0();
-
-		// Set the initial position
-		m_crntPosition =
-			getRandom(props.m_particle.m_minStartingPosition, props.m_particle.m_maxStartingPosition).xyz0();
-
-		m_crntPosition += trf.getOrigin();
-	}
-
-	void simulate(Second prevUpdateTime, Second crntTime) override
-	{
-		ParticleBase::simulate(prevUpdateTime, crntTime);
-
-		F32 dt = F32(crntTime - prevUpdateTime);
-
-		Vec4 xp = m_crntPosition;
-		Vec4 xc = m_acceleration * (dt * dt) + m_velocity * dt + xp;
-
-		m_crntPosition = xc;
-
-		m_velocity += m_acceleration * dt;
-	}
-};
-
-/// Particle for bullet simulations
-class ParticleEmitterNode::PhysParticle : public ParticleEmitterNode::ParticleBase
-{
-public:
-	PhysicsBodyPtr m_body;
-
-	PhysParticle(const PhysicsBodyInitInfo& init, SceneNode* node)
-	{
-		m_body = node->getSceneGraph().getPhysicsWorld().newInstance<PhysicsBody>(init);
-		m_body->setUserData(node);
-		m_body->activate(false);
-		m_body->setMaterialGroup(PhysicsMaterialBit::PARTICLE);
-		m_body->setMaterialMask(PhysicsMaterialBit::STATIC_GEOMETRY);
-		m_body->setAngularFactor(Vec3(0.0f, 0.0f, 0.0f));
-	}
-
-	void kill() override
-	{
-		ParticleBase::kill();
-		m_body->activate(false);
-	}
-
-	void revive(
-		const ParticleEmitterProperties& props, const Transform& trf, Second prevUpdateTime, Second crntTime) override
-	{
-		ParticleBase::revive(props, trf, prevUpdateTime, crntTime);
-
-		// pre calculate
-		const Bool forceFlag = props.forceEnabled();
-		const Bool worldGravFlag = props.wordGravityEnabled();
-
-		// Activate it
-		m_body->activate(true);
-		m_body->setLinearVelocity(Vec3(0.0f));
-		m_body->setAngularVelocity(Vec3(0.0f));
-		m_body->clearForces();
-
-		// force
-		if(forceFlag)
-		{
-			Vec3 forceDir = getRandom(props.m_particle.m_minForceDirection, props.m_particle.m_maxForceDirection);
-			forceDir.normalize();
-
-			// the forceDir depends on the particle emitter rotation
-			forceDir = trf.getRotation().getRotationPart() * forceDir;
-
-			const F32 forceMag =
-				getRandomRange(props.m_particle.m_minForceMagnitude, props.m_particle.m_maxForceMagnitude);
-			m_body->applyForce(forceDir * forceMag, Vec3(0.0f));
-		}
-
-		// gravity
-		if(!worldGravFlag)
-		{
-			m_body->setGravity(getRandom(props.m_particle.m_minGravity, props.m_particle.m_maxGravity));
-		}
-
-		// Starting pos. In local space
-		Vec3 pos = getRandom(props.m_particle.m_minStartingPosition, props.m_particle.m_maxStartingPosition);
-		pos = trf.transform(pos);
-
-		m_body->setTransform(Transform(pos.xyz0(), trf.getRotation(), 1.0f));
-		m_crntPosition = pos.xyz0();
-	}
-
-	void simulate(Second prevUpdateTime, Second crntTime) override
-	{
-		ParticleBase::simulate(prevUpdateTime, crntTime);
-		m_crntPosition = m_body->getTransform().getOrigin();
-	}
+	ParticleEmitterNode* m_emitter;
+	U32 m_begin;
+	U32 m_end;
+	Bounds m_bounds;
 };
 
 /// Feedback component
@@ -229,13 +70,13 @@ ParticleEmitterNode::ParticleEmitterNode(SceneGraph* scene, CString name)
 
 ParticleEmitterNode::~ParticleEmitterNode()
 {
-	// Delete simple particles
-	for(ParticleBase* part : m_particles)
+	if(m_simulationType == SimulationType::SIMPLE)
 	{
-		getAllocator().deleteInstance(part);
+		getSceneGraph().removeParticleEmitter(*this);
 	}
 
-	m_particles.destroy(getAllocator());
+	m_streamStorage.destroy(getAllocator());
+	m_bodies.destroy(getAllocator());
 }
 
 Error ParticleEmitterNode::init(const CString& filename)
@@ -255,7 +96,9 @@ Error ParticleEmitterNode::init(const CString& filename)
 	// Render component
 	MaterialRenderComponent* rcomp =
 		newComponent<MaterialRenderComponent>(this, m_particleEmitterResource->getMaterial());
-	rcomp->setup(drawCallback, this, 0); // No merging
+	// The particles are in world space so the emitters of the same resource can be drawn together
+	const U64 uuid = m_particleEmitterResource->getUuid();
+	rcomp->setup(drawCallback, this, computeHash(&uuid, sizeof(uuid)));
 
 	// Other
 	m_obb.setCenter(Vec4(0.0));
@@ -267,44 +110,78 @@ Error ParticleEmitterNode::init(const CString& filename)
 	const ParticleEmitterProperties& other = m_particleEmitterResource->getProperties();
 	me = other;
 
-	if(m_usePhysicsEngine)
+	// Allocate the streams. Pad them so the last particles can be simulated with full SIMD loads and stores
+	const U32 streamSize = getAlignedRoundUp(F32x8::LANE_COUNT, m_maxNumOfParticles);
+	m_streamStorage.create(getAllocator(), streamSize * U32(ParticleStream::COUNT), 0.0f);
+	for(ParticleStream stream = ParticleStream::FIRST; stream < ParticleStream::COUNT; ++stream)
+	{
+		m_streams[stream] = &m_streamStorage[U32(stream) * streamSize];
+	}
+
+	if(m_usePhysicsEngine && m_collisionResponse == ParticleCollisionResponse::NONE)
 	{
 		createParticlesPhysicsSimulation(&getSceneGraph());
 		m_simulationType = SimulationType::PHYSICS_ENGINE;
 	}
 	else
 	{
-		createParticlesSimpleSimulation();
 		m_simulationType = SimulationType::SIMPLE;
+		getSceneGraph().addParticleEmitter(*this);
 	}
 
-	// Create the vertex buffer and object
-	m_vertBuffSize = m_maxNumOfParticles * VERTEX_SIZE;
-
 	return Error::NONE;
 }
 
 void ParticleEmitterNode::drawCallback(RenderQueueDrawContext& ctx, ConstWeakArray<void*> userData)
 {
-	ANKI_ASSERT(userData.getSize() == 1);
+	ANKI_ASSERT(userData.getSize() > 0);
 
 	const ParticleEmitterNode& self = *static_cast<const ParticleEmitterNode*>(userData[0]);
 
 	// Early exit
-	if(ANKI_UNLIKELY(self.m_aliveParticlesCount == 0))
+	U32 aliveParticleCount = 0;
+	for(const void* data : userData)
+	{
+		aliveParticleCount += static_cast<const ParticleEmitterNode*>(data)->m_aliveParticlesCount;
+	}
+
+	if(ANKI_UNLIKELY(aliveParticleCount == 0))
 	{
 		return;
 	}
 
 	CommandBufferPtr& cmdb = ctx.m_commandBuffer;
 
+	// The merged emitters are a single instance of the material, their particles are the instances of the drawcall
+	ctx.m_key.setInstanceCount(1);
+
 	if(!ctx.m_debugDraw)
 	{
-		// Load verts
+		// Write the verts of all the emitters straight from the streams
 		StagingGpuMemoryToken token;
-		void* gpuStorage = ctx.m_stagingGpuAllocator->allocateFrame(
-			self.m_aliveParticlesCount * VERTEX_SIZE, StagingGpuMemoryType::VERTEX, token);
-		memcpy(gpuStorage, self.m_verts, self.m_aliveParticlesCount * VERTEX_SIZE);
+		F32* verts = static_cast<F32*>(ctx.m_stagingGpuAllocator->allocateFrame(
+			aliveParticleCount * VERTEX_SIZE, StagingGpuMemoryType::VERTEX, token));
+
+		for(const void* data : userData)
+		{
+			const ParticleEmitterNode& emitter = *static_cast<const ParticleEmitterNode*>(data);
+			ANKI_ASSERT(emitter.m_particleEmitterResource == self.m_particleEmitterResource);
+
+			const F32* posX = emitter.getStream(ParticleStream::POSITION_X);
+			const F32* posY = emitter.getStream(ParticleStream::POSITION_Y);
+			const F32* posZ = emitter.getStream(ParticleStream::POSITION_Z);
+			const F32* sizes = emitter.getStream(ParticleStream::SIZE);
+			const F32* alphas = emitter.getStream(ParticleStream::ALPHA);
+			for(U32 i = 0; i < emitter.m_aliveParticlesCount; ++i)
+			{
+				verts[0] = posX[i];
+				verts[1] = posY[i];
+				verts[2] = posZ[i];
+				verts[3] = sizes[i];
+				verts[4] = alphas[i];
+				verts += 5;
+			}
+		}
 
 		// Program
 		ShaderProgramPtr prog;
@@ -325,7 +202,7 @@ void ParticleEmitterNode::drawCallback(RenderQueueDrawContext& ctx, ConstWeakArr
 			.allocateAndSetupUniforms(ctx, trf, trf, *ctx.m_stagingGpuAllocator);
 
 		// Draw
-		cmdb->drawArrays(PrimitiveTopology::TRIANGLE_STRIP, 4, self.m_aliveParticlesCount, 0, 0);
+		cmdb->drawArrays(PrimitiveTopology::TRIANGLE_STRIP, 4, aliveParticleCount, 0, 0);
 	}
 	else
 	{
@@ -350,136 +227,487 @@ void ParticleEmitterNode::createParticlesPhysicsSimulation(SceneGraph* scene)
 	PhysicsBodyInitInfo binit;
 	binit.m_shape = collisionShape;
 
-	m_particles.create(getAllocator(), m_maxNumOfParticles);
+	m_bodies.create(getAllocator(), m_maxNumOfParticles);
 
-	for(U32 i = 0; i < m_maxNumOfParticles; i++)
+	for(PhysicsBodyPtr& body : m_bodies)
 	{
 		binit.m_mass = getRandomRange(m_particle.m_minMass, m_particle.m_maxMass);
 
-		PhysParticle* part = getAllocator().newInstance<PhysParticle>(binit, this);
-
-		m_particles[i] = part;
+		body = getSceneGraph().getPhysicsWorld().newInstance<PhysicsBody>(binit);
+		body->setUserData(this);
+		body->activate(false);
+		body->setMaterialGroup(PhysicsMaterialBit::PARTICLE);
+		body->setMaterialMask(PhysicsMaterialBit::STATIC_GEOMETRY);
+		body->setAngularFactor(Vec3(0.0f, 0.0f, 0.0f));
 	}
 }
 
-void ParticleEmitterNode::createParticlesSimpleSimulation()
+void ParticleEmitterNode::simulateParticles(U32 begin, U32 end, F32 dt, Bounds& bounds)
 {
-	m_particles.create(getAllocator(), m_maxNumOfParticles);
-
-	for(U32 i = 0; i < m_maxNumOfParticles; i++)
+	ANKI_ASSERT(begin <= end && end <= m_aliveParticlesCount);
+	ANKI_ASSERT((begin % F32x8::LANE_COUNT) == 0);
+
+	const Bool integrate = m_simulationType == SimulationType::SIMPLE;
+	const F32x8 dtx(dt);
+	const F32x8 dt2 = dtx * dtx;
+	const F32x8 zero(0.0f);
+	const F32x8 one(1.0f);
+	static const Array<F32, F32x8::LANE_COUNT> LANE_INDICES = {{0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f}};
+	const F32x8 laneIndices = F32x8::load(&LANE_INDICES[0]);
+
+	F32* posX = getStream(ParticleStream::POSITION_X);
+	F32* posY = getStream(ParticleStream::POSITION_Y);
+	F32* posZ = getStream(ParticleStream::POSITION_Z);
+	F32* prevPosX = getStream(ParticleStream::PREVIOUS_POSITION_X);
+	F32* prevPosY = getStream(ParticleStream::PREVIOUS_POSITION_Y);
+	F32* prevPosZ = getStream(ParticleStream::PREVIOUS_POSITION_Z);
+	F32* velX = getStream(ParticleStream::VELOCITY_X);
+	F32* velY = getStream(ParticleStream::VELOCITY_Y);
+	F32* velZ = getStream(ParticleStream::VELOCITY_Z);
+	const F32* accX = getStream(ParticleStream::ACCELERATION_X);
+	const F32* accY = getStream(ParticleStream::ACCELERATION_Y);
+	const F32* accZ = getStream(ParticleStream::ACCELERATION_Z);
+	F32* ages = getStream(ParticleStream::AGE);
+	const F32* lifetimes = getStream(ParticleStream::LIFETIME);
+	const F32* initialSizes = getStream(ParticleStream::INITIAL_SIZE);
+	const F32* finalSizes = getStream(ParticleStream::FINAL_SIZE);
+	const F32* initialAlphas = getStream(ParticleStream::INITIAL_ALPHA);
+	const F32* finalAlphas = getStream(ParticleStream::FINAL_ALPHA);
+	F32* sizes = getStream(ParticleStream::SIZE);
+	F32* alphas = getStream(ParticleStream::ALPHA);
+
+	F32x8 minX(MAX_F32), minY(MAX_F32), minZ(MAX_F32);
+	F32x8 maxX(MIN_F32), maxY(MIN_F32), maxZ(MIN_F32);
+	F32x8 maxSize(0.0f);
+
+	// The streams are padded so the last batch can read and write past the end
+	for(U32 i = begin; i < end; i += F32x8::LANE_COUNT)
 	{
-		ParticleSimple* part = getAllocator().newInstance<ParticleSimple>();
+		F32x8 x = F32x8::load(posX + i);
+		F32x8 y = F32x8::load(posY + i);
+		F32x8 z = F32x8::load(posZ + i);
 
-		m_particles[i] = part;
+		if(integrate)
+		{
+			// Keep the old position for the collisions
+			x.store(prevPosX + i);
+			y.store(prevPosY + i);
+			z.store(prevPosZ + i);
+
+			// x = a * dt^2 + v * dt + x and then v = a * dt + v
+			const F32x8 vx = F32x8::load(velX + i);
+			const F32x8 vy = F32x8::load(velY + i);
+			const F32x8 vz = F32x8::load(velZ + i);
+			const F32x8 ax = F32x8::load(accX + i);
+			const F32x8 ay = F32x8::load(accY + i);
+			const F32x8 az = F32x8::load(accZ + i);
+
+			x = F32x8::mulAdd(ax, dt2, F32x8::mulAdd(vx, dtx, x));
+			y = F32x8::mulAdd(ay, dt2, F32x8::mulAdd(vy, dtx, y));
+			z = F32x8::mulAdd(az, dt2, F32x8::mulAdd(vz, dtx, z));
+			x.store(posX + i);
+			y.store(posY + i);
+			z.store(posZ + i);
+
+			F32x8::mulAdd(ax, dtx, vx).store(velX + i);
+			F32x8::mulAdd(ay, dtx, vy).store(velY + i);
+			F32x8::mulAdd(az, dtx, vz).store(velZ + i);
+		}
+
+		// Age
+		const F32x8 age = F32x8::load(ages + i) + dtx;
+		age.store(ages + i);
+		const F32x8 lifetime = F32x8::load(lifetimes + i);
+		const F32x8 lifeFactor = F32x8::min(age / lifetime, one);
+
+		// Size and alpha
+		const F32x8 initialSize = F32x8::load(initialSizes + i);
+		const F32x8 size = F32x8::mulAdd(F32x8::load(finalSizes + i) - initialSize, lifeFactor, initialSize);
+		size.store(sizes + i);
+
+		const F32x8 initialAlpha = F32x8::load(initialAlphas + i);
+		const F32x8 alpha = F32x8::mulAdd(F32x8::load(finalAlphas + i) - initialAlpha, lifeFactor, initialAlpha);
+		F32x8::min(F32x8::max(alpha, zero), one).store(alphas + i);
+
+		// Bounds of the ones that are still alive. Ignore the lanes past the end
+		const F32x8 alive = (age <= lifetime) & (laneIndices < F32x8(F32(end - i)));
+		minX = F32x8::select(alive, F32x8::min(minX, x), minX);
+		minY = F32x8::select(alive, F32x8::min(minY, y), minY);
+		minZ = F32x8::select(alive, F32x8::min(minZ, z), minZ);
+		maxX = F32x8::select(alive, F32x8::max(maxX, x), maxX);
+		maxY = F32x8::select(alive, F32x8::max(maxY, y), maxY);
+		maxZ = F32x8::select(alive, F32x8::max(maxZ, z), maxZ);
+		maxSize = F32x8::select(alive, F32x8::max(maxSize, size), maxSize);
+	}
+
+	for(U32 lane = 0; lane < F32x8::LANE_COUNT; ++lane)
+	{
+		bounds.m_min = bounds.m_min.min(Vec3(minX.getLane(lane), minY.getLane(lane), minZ.getLane(lane)));
+		bounds.m_max = bounds.m_max.max(Vec3(maxX.getLane(lane), maxY.getLane(lane), maxZ.getLane(lane)));
+		bounds.m_maxSize = max(bounds.m_maxSize, maxSize.getLane(lane));
 	}
 }
 
-Error ParticleEmitterNode::frameUpdate(Second prevUpdateTime, Second crntTime)
+void ParticleEmitterNode::collideParticles(Bounds& bounds)
 {
-	// - Deactivate the dead particles
-	// - Calc the AABB
-	// - Calc the instancing stuff
-	//
-	Vec4 aabbmin(MAX_F32, MAX_F32, MAX_F32, 0.0f);
-	Vec4 aabbmax(MIN_F32, MIN_F32, MIN_F32, 0.0f);
-	m_aliveParticlesCount = 0;
+	ANKI_ASSERT(m_simulationType == SimulationType::SIMPLE);
 
-	F32* verts = reinterpret_cast<F32*>(getFrameAllocator().allocate(m_vertBuffSize));
-	m_verts = verts;
+	class RayCast : public PhysicsWorldRayCastCallback
+	{
+	public:
+		Vec3 m_normal = Vec3(0.0f);
+		Vec3 m_position = Vec3(0.0f);
+		U32 m_particleIdx = 0;
+		Bool m_hit = false;
+
+		RayCast(const Vec3& from, const Vec3& to)
+			: PhysicsWorldRayCastCallback(from, to, PhysicsMaterialBit::STATIC_GEOMETRY)
+		{
+		}
 
-	const F32* verts_base = verts;
-	(void)verts_base;
+		void processResult(PhysicsFilteredObject& obj, const Vec3& worldNormal, const Vec3& worldPosition) final
+		{
+			// The later results are closer
+			m_normal = worldNormal;
+			m_position = worldPosition;
+			m_hit = true;
+		}
+	};
+
+	// Move the particles a bit away from the surfaces so they won't hit them again in the next frame
+	const F32 SURFACE_OFFSET = 0.01f;
+
+	F32* posX = getStream(ParticleStream::POSITION_X);
+	F32* posY = getStream(ParticleStream::POSITION_Y);
+	F32* posZ = getStream(ParticleStream::POSITION_Z);
+	const F32* prevPosX = getStream(ParticleStream::PREVIOUS_POSITION_X);
+	const F32* prevPosY = getStream(ParticleStream::PREVIOUS_POSITION_Y);
+	const F32* prevPosZ = getStream(ParticleStream::PREVIOUS_POSITION_Z);
+	F32* velX = getStream(ParticleStream::VELOCITY_X);
+	F32* velY = getStream(ParticleStream::VELOCITY_Y);
+	F32* velZ = getStream(ParticleStream::VELOCITY_Z);
+	F32* ages = getStream(ParticleStream::AGE);
+	const F32* lifetimes = getStream(ParticleStream::LIFETIME);
+
+	// Gather the ray casts of the particles that are alive and moved
+	auto moved = [&](U32 i) {
+		const Vec3 delta(posX[i] - prevPosX[i], posY[i] - prevPosY[i], posZ[i] - prevPosZ[i]);
+		return ages[i] <= lifetimes[i] && delta.getLengthSquared() > EPSILON * EPSILON;
+	};
+
+	U32 rayCastCount = 0;
+	for(U32 i = 0; i < m_aliveParticlesCount; ++i)
+	{
+		rayCastCount += moved(i);
+	}
 
-	F32 maxParticleSize = -1.0f;
+	if(rayCastCount == 0)
+	{
+		return;
+	}
 
-	for(ParticleBase* p : m_particles)
+	DynamicArrayAuto<RayCast> rayCasts(getFrameAllocator());
+	rayCasts.create(rayCastCount, RayCast(Vec3(0.0f), Vec3(0.0f)));
+	DynamicArrayAuto<PhysicsWorldRayCastCallback*> rayCastPtrs(getFrameAllocator());
+	rayCastPtrs.create(rayCastCount);
+
+	rayCastCount = 0;
+	for(U32 i = 0; i < m_aliveParticlesCount; ++i)
 	{
-		if(p->isDead())
+		if(moved(i))
 		{
-			// if its already dead so dont deactivate it again
+			RayCast& rayCast = rayCasts[rayCastCount];
+			rayCast.m_from = Vec3(prevPosX[i], prevPosY[i], prevPosZ[i]);
+			rayCast.m_to = Vec3(posX[i], posY[i], posZ[i]);
+			rayCast.m_particleIdx = i;
+			rayCastPtrs[rayCastCount] = &rayCast;
+			++rayCastCount;
+		}
+	}
+
+	// Do all of them with a single lock of the physics world
+	getSceneGraph().getPhysicsWorld().rayCast(
+		WeakArray<PhysicsWorldRayCastCallback*>(&rayCastPtrs[0], rayCastPtrs.getSize()));
+
+	// Respond
+	for(const RayCast& rayCast : rayCasts)
+	{
+		if(!rayCast.m_hit)
+		{
+			continue;
+		}
+
+		const U32 i = rayCast.m_particleIdx;
+		if(m_collisionResponse == ParticleCollisionResponse::KILL)
+		{
+			ages[i] = MAX_F32;
+			continue;
+		}
+
+		ANKI_ASSERT(m_collisionResponse == ParticleCollisionResponse::BOUNCE);
+		Vec3 velocity(velX[i], velY[i], velZ[i]);
+		velocity = (velocity - rayCast.m_normal * (2.0f * velocity.dot(rayCast.m_normal))) * m_restitution;
+		velX[i] = velocity.x();
+		velY[i] = velocity.y();
+		velZ[i] = velocity.z();
+
+		const Vec3 pos = rayCast.m_position + rayCast.m_normal * SURFACE_OFFSET;
+		posX[i] = pos.x();
+		posY[i] = pos.y();
+		posZ[i] = pos.z();
+
+		bounds.m_min = bounds.m_min.min(pos);
+		bounds.m_max = bounds.m_max.max(pos);
+	}
+}
+
+void ParticleEmitterNode::killDeadParticles()
+{
+	const F32* ages = getStream(ParticleStream::AGE);
+	const F32* lifetimes = getStream(ParticleStream::LIFETIME);
+
+	U32 i = 0;
+	while(i < m_aliveParticlesCount)
+	{
+		// Skip 8 at a time if none of them died
+		if(i + F32x8::LANE_COUNT <= m_aliveParticlesCount
+			&& (F32x8::load(ages + i) > F32x8::load(lifetimes + i)).getMask() == 0)
+		{
+			i += F32x8::LANE_COUNT;
 			continue;
 		}
 
-		if(p->m_timeOfDeath < crntTime)
+		if(ages[i] <= lifetimes[i])
+		{
+			++i;
+			continue;
+		}
+
+		// Dead. Move the last alive in its place. It's already simulated
+		const U32 last = --m_aliveParticlesCount;
+		for(ParticleStream stream = ParticleStream::FIRST; stream < ParticleStream::COUNT; ++stream)
+		{
+			m_streams[stream][i] = m_streams[stream][last];
+		}
+
+		if(m_simulationType == SimulationType::PHYSICS_ENGINE)
+		{
+			m_bodies[i]->activate(false);
+			const PhysicsBodyPtr body = m_bodies[i];
+			m_bodies[i] = m_bodies[last];
+			m_bodies[last] = body;
+		}
+	}
+}
+
+void ParticleEmitterNode::emitParticles(Second crntTime)
+{
+	const U32 count = min(m_particlesPerEmission, m_maxNumOfParticles - m_aliveParticlesCount);
+	if(count == 0)
+	{
+		return;
+	}
+
+	const Transform& trf = getComponent<MoveComponent>().getWorldTransform();
+	const ParticleEmitterProperties& props = *this;
+
+	for(U32 i = m_aliveParticlesCount; i < m_aliveParticlesCount + count; ++i)
+	{
+		// Life
+		getStream(ParticleStream::AGE)[i] = 0.0f;
+		getStream(ParticleStream::LIFETIME)[i] = F32(getRandomRange(props.m_particle.m_minLife, props.m_particle.m_maxLife));
+
+		// Size
+		const F32 initialSize = getRandomRange(props.m_particle.m_minInitialSize, props.m_particle.m_maxInitialSize);
+		getStream(ParticleStream::INITIAL_SIZE)[i] = initialSize;
+		getStream(ParticleStream::FINAL_SIZE)[i] =
+			getRandomRange(props.m_particle.m_minFinalSize, props.m_particle.m_maxFinalSize);
+		getStream(ParticleStream::SIZE)[i] = initialSize;
+
+		// Alpha
+		const F32 initialAlpha =
+			getRandomRange(props.m_particle.m_minInitialAlpha, props.m_particle.m_maxInitialAlpha);
+		getStream(ParticleStream::INITIAL_ALPHA)[i] = initialAlpha;
+		getStream(ParticleStream::FINAL_ALPHA)[i] =
+			getRandomRange(props.m_particle.m_minFinalAlpha, props.m_particle.m_maxFinalAlpha);
+		getStream(ParticleStream::ALPHA)[i] = clamp(initialAlpha, 0.0f, 1.0f);
+
+		Vec3 pos;
+		if(m_simulationType == SimulationType::SIMPLE)
 		{
-			// Just died
-			p->kill();
+			const Vec3 acceleration = getRandom(props.m_particle.m_minGravity, props.m_particle.m_maxGravity);
+			getStream(ParticleStream::VELOCITY_X)[i] = 0.0f;
+			getStream(ParticleStream::VELOCITY_Y)[i] = 0.0f;
+			getStream(ParticleStream::VELOCITY_Z)[i] = 0.0f;
+			getStream(ParticleStream::ACCELERATION_X)[i] = acceleration.x();
+			getStream(ParticleStream::ACCELERATION_Y)[i] = acceleration.y();
+			getStream(ParticleStream::ACCELERATION_Z)[i] = acceleration.z();
+
+			pos = getRandom(props.m_particle.m_minStartingPosition, props.m_particle.m_maxStartingPosition)
+				  + trf.getOrigin().xyz();
 		}
 		else
 		{
-			// It's alive
+			PhysicsBody& body = *m_bodies[i];
 
-			// Do checks
-			ANKI_ASSERT((PtrSize(verts) + VERTEX_SIZE - PtrSize(verts_base)) <= m_vertBuffSize);
+			// Activate it
+			body.activate(true);
+			body.setLinearVelocity(Vec3(0.0f));
+			body.setAngularVelocity(Vec3(0.0f));
+			body.clearForces();
 
-			// This will calculate a new world transformation
-			p->simulate(prevUpdateTime, crntTime);
+			// Force
+			if(props.forceEnabled())
+			{
+				Vec3 forceDir = getRandom(props.m_particle.m_minForceDirection, props.m_particle.m_maxForceDirection);
+				forceDir *= fastRsqrt(forceDir.getLengthSquared());
 
-			const Vec4& origin = p->m_crntPosition;
+				// the forceDir depends on the particle emitter rotation
+				forceDir = trf.getRotation().getRotationPart() * forceDir;
 
-			aabbmin = aabbmin.min(origin);
-			aabbmax = aabbmax.max(origin);
+				const F32 forceMag =
+					getRandomRange(props.m_particle.m_minForceMagnitude, props.m_particle.m_maxForceMagnitude);
+				body.applyForce(forceDir * forceMag, Vec3(0.0f));
+			}
 
-			verts[0] = origin.x();
-			verts[1] = origin.y();
-			verts[2] = origin.z();
+			// Gravity
+			if(!props.wordGravityEnabled())
+			{
+				body.setGravity(getRandom(props.m_particle.m_minGravity, props.m_particle.m_maxGravity));
+			}
+
+			// Starting pos. In local space
+			pos = getRandom(props.m_particle.m_minStartingPosition, props.m_particle.m_maxStartingPosition);
+			pos = trf.transform(pos);
+
+			body.setTransform(Transform(pos.xyz0(), trf.getRotation(), 1.0f));
+		}
 
-			verts[3] = p->m_crntSize;
-			maxParticleSize = max(maxParticleSize, p->m_crntSize);
+		getStream(ParticleStream::POSITION_X)[i] = pos.x();
+		getStream(ParticleStream::POSITION_Y)[i] = pos.y();
+		getStream(ParticleStream::POSITION_Z)[i] = pos.z();
+		getStream(ParticleStream::PREVIOUS_POSITION_X)[i] = pos.x();
+		getStream(ParticleStream::PREVIOUS_POSITION_Y)[i] = pos.y();
+		getStream(ParticleStream::PREVIOUS_POSITION_Z)[i] = pos.z();
+	}
 
-			verts[4] = clamp(p->m_crntAlpha, 0.0f, 1.0f);
+	m_aliveParticlesCount += count;
+}
 
-			++m_aliveParticlesCount;
-			verts += 5;
+void ParticleEmitterNode::simulateBatch(
+	ThreadHive& hive, WeakArray<ParticleEmitterNode*> emitters, Second prevUpdateTime, Second crntTime)
+{
+	// Split the big emitters to chunks
+	U32 chunkCount = 0;
+	for(const ParticleEmitterNode* emitter : emitters)
+	{
+		ANKI_ASSERT(emitter->m_simulationType == SimulationType::SIMPLE);
+		if(emitter->m_aliveParticlesCount >= PARTICLES_PER_SIMULATION_CHUNK * 2 && !emitter->isStatic())
+		{
+			chunkCount +=
+				(emitter->m_aliveParticlesCount + PARTICLES_PER_SIMULATION_CHUNK - 1) / PARTICLES_PER_SIMULATION_CHUNK;
+		}
+	}
+
+	if(chunkCount == 0)
+	{
+		return;
+	}
+
+	ANKI_TRACE_SCOPED_EVENT(SCENE_PARTICLES_SIMULATION);
+
+	DynamicArrayAuto<SimulationChunk> chunks(emitters[0]->getFrameAllocator());
+	chunks.create(chunkCount);
+	chunkCount = 0;
+	for(ParticleEmitterNode* emitter : emitters)
+	{
+		if(emitter->m_aliveParticlesCount < PARTICLES_PER_SIMULATION_CHUNK * 2 || emitter->isStatic())
+		{
+			continue;
+		}
+
+		for(U32 begin = 0; begin < emitter->m_aliveParticlesCount; begin += PARTICLES_PER_SIMULATION_CHUNK)
+		{
+			SimulationChunk& chunk = chunks[chunkCount++];
+			chunk.m_emitter = emitter;
+			chunk.m_begin = begin;
+			chunk.m_end = min(begin + PARTICLES_PER_SIMULATION_CHUNK, emitter->m_aliveParticlesCount);
 		}
 	}
 
+	const F32 dt = F32(crntTime - prevUpdateTime);
+	hive.parallelFor(chunkCount, 1, [&](U32 begin, U32 end, U32 threadId) {
+		for(U32 i = begin; i < end; ++i)
+		{
+			SimulationChunk& chunk = chunks[i];
+			chunk.m_emitter->simulateParticles(chunk.m_begin, chunk.m_end, dt, chunk.m_bounds);
+		}
+	});
+
+	// Combine the bounds. The chunks of an emitter are contiguous
+	for(const SimulationChunk& chunk : chunks)
+	{
+		ParticleEmitterNode& emitter = *chunk.m_emitter;
+		if(chunk.m_begin == 0)
+		{
+			emitter.m_bounds = Bounds();
+			emitter.m_simulationTimestamp = emitter.getGlobalTimestamp();
+		}
+
+		emitter.m_bounds.merge(chunk.m_bounds);
+	}
+}
+
+Error ParticleEmitterNode::frameUpdate(Second prevUpdateTime, Second crntTime)
+{
+	// Simulate if the SceneGraph hasn't done it already
+	if(m_simulationTimestamp != getGlobalTimestamp())
+	{
+		if(m_simulationType == SimulationType::PHYSICS_ENGINE)
+		{
+			for(U32 i = 0; i < m_aliveParticlesCount; ++i)
+			{
+				const Vec4& origin = m_bodies[i]->getTransform().getOrigin();
+				getStream(ParticleStream::POSITION_X)[i] = origin.x();
+				getStream(ParticleStream::POSITION_Y)[i] = origin.y();
+				getStream(ParticleStream::POSITION_Z)[i] = origin.z();
+			}
+		}
+
+		m_bounds = Bounds();
+		simulateParticles(0, m_aliveParticlesCount, F32(crntTime - prevUpdateTime), m_bounds);
+	}
+
+	if(m_collisionResponse != ParticleCollisionResponse::NONE && m_simulationType == SimulationType::SIMPLE)
+	{
+		collideParticles(m_bounds);
+	}
+
+	killDeadParticles();
+
+	// Calc the AABB
 	if(m_aliveParticlesCount != 0)
 	{
-		ANKI_ASSERT(maxParticleSize > 0.0f);
-		Vec4 min = aabbmin - maxParticleSize;
-		Vec4 max = aabbmax + maxParticleSize;
-		Vec4 center = (min + max) / 2.0;
+		ANKI_ASSERT(m_bounds.m_maxSize > 0.0f);
+		const Vec3 min = m_bounds.m_min - m_bounds.m_maxSize;
+		const Vec3 max = m_bounds.m_max + m_bounds.m_maxSize;
+		const Vec3 center = (min + max) / 2.0f;
 
 		m_obb = Obb(center.xyz0(), Mat3x4::getIdentity(), (max - center).xyz0());
 	}
 	else
 	{
 		m_obb = Obb(Vec4(0.0), Mat3x4::getIdentity(), Vec4(Vec3(0.001f), 0.0f));
-		m_verts = nullptr;
 	}
 
 	getComponent<SpatialComponent>().markForUpdate();
 
-	//
 	// Emit new particles
-	//
 	if(m_timeLeftForNextEmission <= 0.0)
 	{
-		MoveComponent& move = getComponent<MoveComponent>();
-
-		U particlesCount = 0; // How many particles I am allowed to emmit
-		for(ParticleBase* pp : m_particles)
-		{
-			ParticleBase& p = *pp;
-			if(!p.isDead())
-			{
-				// its alive so skip it
-				continue;
-			}
-
-			p.revive(*this, move.getWorldTransform(), prevUpdateTime, crntTime);
-
-			// do the rest
-			++particlesCount;
-			if(particlesCount >= m_particlesPerEmission)
-			{
-				break;
-			}
-		} // end for all particles
-
+		emitParticles(crntTime);
 		m_timeLeftForNextEmission = m_emissionPeriod;
-	} // end if can emit
+	}
 	else
 	{
 		m_timeLeftForNextEmission -= crntTime - prevUpdateTime;
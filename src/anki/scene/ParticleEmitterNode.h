@@ -18,8 +18,14 @@ namespace anki
 /// @{
 
 /// The particle emitter scene node. This scene node emitts
+///
+/// The particles are stored as structure of arrays and the alive ones are packed at the beginning of the arrays. They
+/// are simulated 8 at a time. The big emitters are simulated by the SceneGraph in parallel before the nodes are updated
+/// using simulateBatch().
 class ParticleEmitterNode : public SceneNode, private ParticleEmitterProperties
 {
+	friend class SceneGraph;
+
 public:
 	ParticleEmitterNode(SceneGraph* scene, CString name);
 
@@ -34,9 +40,52 @@ public:
 
 private:
 	class MoveFeedbackComponent;
-	class ParticleBase;
-	class ParticleSimple;
-	class PhysParticle;
+	class SimulationChunk;
+
+	/// The streams of the structure of arrays.
+	enum class ParticleStream : U8
+	{
+		POSITION_X,
+		POSITION_Y,
+		POSITION_Z,
+		PREVIOUS_POSITION_X,
+		PREVIOUS_POSITION_Y,
+		PREVIOUS_POSITION_Z,
+		VELOCITY_X,
+		VELOCITY_Y,
+		VELOCITY_Z,
+		ACCELERATION_X,
+		ACCELERATION_Y,
+		ACCELERATION_Z,
+		AGE,
+		LIFETIME,
+		INITIAL_SIZE,
+		FINAL_SIZE,
+		INITIAL_ALPHA,
+		FINAL_ALPHA,
+		SIZE,
+		ALPHA,
+
+		COUNT,
+		FIRST = 0
+	};
+	ANKI_ENUM_ALLOW_NUMERIC_OPERATIONS(ParticleStream, friend)
+
+	/// The world space bounds of the alive particles and their max size.
+	class Bounds
+	{
+	public:
+		Vec3 m_min = Vec3(MAX_F32);
+		Vec3 m_max = Vec3(MIN_F32);
+		F32 m_maxSize = 0.0f;
+
+		void merge(const Bounds& b)
+		{
+			m_min = m_min.min(b.m_min);
+			m_max = m_max.max(b.m_max);
+			m_maxSize = max(m_maxSize, b.m_maxSize);
+		}
+	};
 
 	enum class SimulationType : U8
 	{
@@ -48,8 +97,13 @@ private:
 	/// Size of a single vertex.
 	static const U32 VERTEX_SIZE = 5 * sizeof(F32);
 
+	/// Emitters with more alive particles than twice that are simulated in parallel in chunks of that size.
+	static const U32 PARTICLES_PER_SIMULATION_CHUNK = 2048;
+
 	ParticleEmitterResourcePtr m_particleEmitterResource;
-	DynamicArray<ParticleBase*> m_particles;
+	DynamicArray<F32> m_streamStorage; ///< The storage of all the streams.
+	Array<F32*, U32(ParticleStream::COUNT)> m_streams = {};
+	DynamicArray<PhysicsBodyPtr> m_bodies; ///< The bodies of the particles if they are simulated by the physics.
 	Second m_timeLeftForNextEmission = 0.0;
 	Obb m_obb;
 
@@ -58,16 +112,40 @@ private:
 
 	U32 m_aliveParticlesCount = 0;
 
-	/// @name Graphics
-	/// @{
-	U32 m_vertBuffSize = 0;
-	void* m_verts = nullptr;
-	/// @}
+	Bounds m_bounds; ///< The bounds of the last simulation.
+	Timestamp m_simulationTimestamp = 0; ///< When it was simulated by simulateBatch().
 
 	SimulationType m_simulationType = SimulationType::UNDEFINED;
 
+	F32* getStream(ParticleStream stream)
+	{
+		return m_streams[stream];
+	}
+
+	const F32* getStream(ParticleStream stream) const
+	{
+		return m_streams[stream];
+	}
+
 	void createParticlesPhysicsSimulation(SceneGraph* scene);
-	void createParticlesSimpleSimulation();
+
+	/// Age, integrate and compute the size and the alpha of the particles [begin, end) 8 at a time.
+	/// @param[out] bounds The bounds of the particles that are still alive.
+	void simulateParticles(U32 begin, U32 end, F32 dt, Bounds& bounds);
+
+	/// Ray cast the path of every particle in this frame against the static geometry and apply the collision response.
+	/// It's used instead of rigid bodies.
+	/// @param[in,out] bounds The bounds that will be extended with the collision points.
+	void collideParticles(Bounds& bounds);
+
+	/// Remove the dead particles and keep the alive ones packed.
+	void killDeadParticles();
+
+	void emitParticles(Second crntTime);
+
+	/// Simulate the big emitters of the SIMPLE type in parallel. Their frameUpdate() will skip the simulation.
+	static void simulateBatch(
+		ThreadHive& hive, WeakArray<ParticleEmitterNode*> emitters, Second prevUpdateTime, Second crntTime);
 
 	void onMoveComponentUpdate(MoveComponent& move);
 
@@ -20,6 +20,7 @@ public:
 	SceneNode* m_node;
 	DebugDrawer m_dbgDrawer;
 	PhysicsDebugDrawer m_physDbgDrawer;
+	U64 m_staticObjectsHash = 0; ///< The static objects are recorded in the retained mode of the DebugDrawer.
 
 	MyRenderComponent(SceneNode* node)
 		: m_node(node)
@@ -41,12 +42,26 @@ public:
 	/// Draw the world.
 	void draw(RenderQueueDrawContext& ctx)
 	{
-		if(ctx.m_debugDraw)
+		if(ctx.m_debugDraw && ctx.m_debugDrawFlags.get(RenderQueueDebugDrawFlag::PHYSICS))
 		{
+			const PhysicsWorld& world = m_node->getSceneGraph().getPhysicsWorld();
+
 			m_dbgDrawer.prepareFrame(&ctx);
 			m_dbgDrawer.setViewProjectionMatrix(ctx.m_viewProjectionMatrix);
 			m_dbgDrawer.setModelMatrix(Mat4::getIdentity());
-			m_physDbgDrawer.drawWorld(m_node->getSceneGraph().getPhysicsWorld());
+
+			// Re-record the static objects only when they change
+			const U64 staticObjectsHash = m_physDbgDrawer.computeStaticObjectsHash(world);
+			if(staticObjectsHash != m_staticObjectsHash)
+			{
+				m_staticObjectsHash = staticObjectsHash;
+				m_dbgDrawer.beginRetained();
+				m_physDbgDrawer.drawWorldObjects(world, true);
+				m_dbgDrawer.endRetained();
+			}
+
+			m_dbgDrawer.drawRetained();
+			m_physDbgDrawer.drawWorldObjects(world, false);
 			m_dbgDrawer.finishFrame();
 		}
 	}
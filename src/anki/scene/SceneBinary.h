@@ -0,0 +1,130 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+// WARNING: This file is auto generated.
+
+#pragma once
+
+#include <anki/scene/SceneBinaryExtra.h>
+
+namespace anki
+{
+
+/// A node of a scene binary.
+class SceneBinaryNode
+{
+public:
+	SceneBinaryNodeType m_type = SceneBinaryNodeType::COUNT;
+	SceneBinaryNodeProperty m_properties = SceneBinaryNodeProperty::NONE;
+	U32 m_name = MAX_U32; ///< Offset in SceneBinary::m_strings. MAX_U32 if it doesn't have a name.
+	U32 m_filename = MAX_U32; ///< Offset in SceneBinary::m_strings. The resource of the node.
+	Array<F32, 3> m_origin = {};
+	Array<F32, 12> m_rotation = {}; ///< A 3x4 matrix in row major.
+	F32 m_scale = 1.0f;
+	Array<F32, 7> m_params = {}; ///< Depend on the type. See SceneBinaryNodeProperty.
+
+	template<typename TSerializer, typename TClass>
+	static void serializeCommon(TSerializer& s, TClass self)
+	{
+		s.doValue("m_type", offsetof(SceneBinaryNode, m_type), self.m_type);
+		s.doValue("m_properties", offsetof(SceneBinaryNode, m_properties), self.m_properties);
+		s.doValue("m_name", offsetof(SceneBinaryNode, m_name), self.m_name);
+		s.doValue("m_filename", offsetof(SceneBinaryNode, m_filename), self.m_filename);
+		s.doArray("m_origin", offsetof(SceneBinaryNode, m_origin), &self.m_origin[0], self.m_origin.getSize());
+		s.doArray("m_rotation", offsetof(SceneBinaryNode, m_rotation), &self.m_rotation[0], self.m_rotation.getSize());
+		s.doValue("m_scale", offsetof(SceneBinaryNode, m_scale), self.m_scale);
+		s.doArray("m_params", offsetof(SceneBinaryNode, m_params), &self.m_params[0], self.m_params.getSize());
+	}
+
+	template<typename TDeserializer>
+	void deserialize(TDeserializer& deserializer)
+	{
+		serializeCommon<TDeserializer, SceneBinaryNode&>(deserializer, *this);
+	}
+
+	template<typename TSerializer>
+	void serialize(TSerializer& serializer) const
+	{
+		serializeCommon<TSerializer, const SceneBinaryNode&>(serializer, *this);
+	}
+};
+
+/// A LightEvent of a scene binary.
+class SceneBinaryLightEvent
+{
+public:
+	U32 m_node = MAX_U32; ///< Points to SceneBinary::m_nodes.
+	SceneBinaryLightEventProperty m_properties = SceneBinaryLightEventProperty::NONE;
+	F32 m_startTime = 0.0f;
+	F32 m_duration = 0.0f;
+	Array<F32, 4> m_intensityMultiplier = {};
+	F32 m_radiusMultiplier = 0.0f;
+	F32 m_frequency = 0.0f;
+	F32 m_frequencyDeviation = 0.0f;
+
+	template<typename TSerializer, typename TClass>
+	static void serializeCommon(TSerializer& s, TClass self)
+	{
+		s.doValue("m_node", offsetof(SceneBinaryLightEvent, m_node), self.m_node);
+		s.doValue("m_properties", offsetof(SceneBinaryLightEvent, m_properties), self.m_properties);
+		s.doValue("m_startTime", offsetof(SceneBinaryLightEvent, m_startTime), self.m_startTime);
+		s.doValue("m_duration", offsetof(SceneBinaryLightEvent, m_duration), self.m_duration);
+		s.doArray("m_intensityMultiplier",
+			offsetof(SceneBinaryLightEvent, m_intensityMultiplier),
+			&self.m_intensityMultiplier[0],
+			self.m_intensityMultiplier.getSize());
+		s.doValue("m_radiusMultiplier", offsetof(SceneBinaryLightEvent, m_radiusMultiplier), self.m_radiusMultiplier);
+		s.doValue("m_frequency", offsetof(SceneBinaryLightEvent, m_frequency), self.m_frequency);
+		s.doValue(
+			"m_frequencyDeviation", offsetof(SceneBinaryLightEvent, m_frequencyDeviation), self.m_frequencyDeviation);
+	}
+
+	template<typename TDeserializer>
+	void deserialize(TDeserializer& deserializer)
+	{
+		serializeCommon<TDeserializer, SceneBinaryLightEvent&>(deserializer, *this);
+	}
+
+	template<typename TSerializer>
+	void serialize(TSerializer& serializer) const
+	{
+		serializeCommon<TSerializer, const SceneBinaryLightEvent&>(serializer, *this);
+	}
+};
+
+/// The whole scene. The nodes are created in order.
+class SceneBinary
+{
+public:
+	Array<U8, 8> m_magic = {};
+	WeakArray<SceneBinaryNode> m_nodes;
+	WeakArray<SceneBinaryLightEvent> m_lightEvents;
+	WeakArray<char> m_strings; ///< All the strings one after the other. Each one is null terminated.
+	U32 m_activeCameraNode = MAX_U32; ///< Points to SceneBinary::m_nodes.
+
+	template<typename TSerializer, typename TClass>
+	static void serializeCommon(TSerializer& s, TClass self)
+	{
+		s.doArray("m_magic", offsetof(SceneBinary, m_magic), &self.m_magic[0], self.m_magic.getSize());
+		s.doValue("m_nodes", offsetof(SceneBinary, m_nodes), self.m_nodes);
+		s.doValue("m_lightEvents", offsetof(SceneBinary, m_lightEvents), self.m_lightEvents);
+		s.doValue("m_strings", offsetof(SceneBinary, m_strings), self.m_strings);
+		s.doValue("m_activeCameraNode", offsetof(SceneBinary, m_activeCameraNode), self.m_activeCameraNode);
+	}
+
+	template<typename TDeserializer>
+	void deserialize(TDeserializer& deserializer)
+	{
+		serializeCommon<TDeserializer, SceneBinary&>(deserializer, *this);
+	}
+
+	template<typename TSerializer>
+	void serialize(TSerializer& serializer) const
+	{
+		serializeCommon<TSerializer, const SceneBinary&>(serializer, *this);
+	}
+};
+
+} // end namespace anki
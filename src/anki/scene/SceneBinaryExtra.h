@@ -0,0 +1,69 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/scene/Common.h>
+#include <anki/util/Enum.h>
+#include <anki/util/Serializer.h>
+
+namespace anki
+{
+
+/// @addtogroup scene
+/// @{
+
+constexpr const char* SCENE_BINARY_MAGIC = "ANKISCN1";
+
+/// The type of a SceneBinaryNode.
+enum class SceneBinaryNodeType : U8
+{
+	MODEL,
+	STATIC_COLLISION,
+	PARTICLE_EMITTER,
+	GPU_PARTICLE_EMITTER,
+	POINT_LIGHT,
+	SPOT_LIGHT,
+	DIRECTIONAL_LIGHT,
+	REFLECTION_PROBE,
+	GLOBAL_ILLUMINATION_PROBE,
+	PERSPECTIVE_CAMERA,
+
+	COUNT
+};
+
+/// The properties of a SceneBinaryNode that are set. The rest keep the defaults of the node. The values are in
+/// SceneBinaryNode::m_params and their layout depends on the type of the node:
+/// - Lights: diffuse color (4), radius or distance (1), inner angle (1), outer angle (1).
+/// - Probes: box min (3), box max (3), cell size (1).
+/// - Cameras: near (1), far (1), horizontal FOV (1), vertical FOV (1).
+enum class SceneBinaryNodeProperty : U32
+{
+	NONE = 0,
+	TRANSFORM = 1 << 0,
+	DIFFUSE_COLOR = 1 << 1,
+	LIGHT_DISTANCE = 1 << 2, ///< The radius of point lights and the distance of spot lights.
+	INNER_ANGLE = 1 << 3,
+	OUTER_ANGLE = 1 << 4,
+	SHADOW = 1 << 5,
+	BOUNDING_BOX = 1 << 6,
+	CELL_SIZE = 1 << 7,
+	PERSPECTIVE = 1 << 8,
+	FOV_X_TIMES_ASPECT_RATIO = 1 << 9, ///< The horizontal FOV should be multiplied by the aspect ratio.
+};
+ANKI_ENUM_ALLOW_NUMERIC_OPERATIONS(SceneBinaryNodeProperty, inline)
+
+/// The properties of a SceneBinaryLightEvent that are set.
+enum class SceneBinaryLightEventProperty : U32
+{
+	NONE = 0,
+	INTENSITY_MULTIPLIER = 1 << 0,
+	RADIUS_MULTIPLIER = 1 << 1,
+	FREQUENCY = 1 << 2,
+};
+ANKI_ENUM_ALLOW_NUMERIC_OPERATIONS(SceneBinaryLightEventProperty, inline)
+/// @}
+
+} // end namespace anki
@@ -0,0 +1,353 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/scene/SceneBinaryLoader.h>
+#include <anki/scene/SceneGraph.h>
+#include <anki/scene/ModelNode.h>
+#include <anki/scene/StaticCollisionNode.h>
+#include <anki/scene/ParticleEmitterNode.h>
+#include <anki/scene/GpuParticleEmitterNode.h>
+#include <anki/scene/LightNode.h>
+#include <anki/scene/ReflectionProbeNode.h>
+#include <anki/scene/GlobalIlluminationProbeNode.h>
+#include <anki/scene/CameraNode.h>
+#include <anki/scene/components/MoveComponent.h>
+#include <anki/scene/components/LightComponent.h>
+#include <anki/scene/components/FrustumComponent.h>
+#include <anki/scene/components/GlobalIlluminationProbeComponent.h>
+#include <anki/scene/events/EventManager.h>
+#include <anki/scene/events/LightEvent.h>
+#include <anki/resource/ResourceManager.h>
+#include <anki/resource/ResourceFilesystem.h>
+#include <anki/resource/AsyncLoader.h>
+#include <anki/util/Serializer.h>
+#include <anki/util/Tracer.h>
+
+namespace anki
+{
+
+static CString getString(const SceneBinary& binary, U32 offset)
+{
+	return (offset == MAX_U32) ? CString() : CString(&binary.m_strings[offset]);
+}
+
+static Bool isLight(SceneBinaryNodeType type)
+{
+	return type == SceneBinaryNodeType::POINT_LIGHT || type == SceneBinaryNodeType::SPOT_LIGHT
+		   || type == SceneBinaryNodeType::DIRECTIONAL_LIGHT;
+}
+
+Error SceneBinaryLoader::load(CString filename, F32 aspectRatio)
+{
+	ANKI_TRACE_SCOPED_EVENT(SCENE_BINARY_LOAD);
+	ANKI_ASSERT(aspectRatio > 0.0f);
+
+	ResourceManager& resources = m_scene->getResourceManager();
+	HeapAllocator<U8> alloc = m_scene->getAllocator();
+
+	// Read the whole file at once. The pointers are patched in place so the nodes are read straight from there
+	ResourceFilePtr file;
+	ANKI_CHECK(resources.getFilesystem().openFile(filename, file));
+	const PtrSize size = file->getSize();
+
+	class DataDeleter
+	{
+	public:
+		HeapAllocator<U8> m_alloc;
+		U8* m_data;
+
+		~DataDeleter()
+		{
+			m_alloc.getMemoryPool().free(m_data);
+		}
+	} data = {alloc, static_cast<U8*>(alloc.getMemoryPool().allocate(size, ANKI_SAFE_ALIGNMENT))};
+
+	ANKI_CHECK(file->read(data.m_data, size));
+	file.reset(nullptr);
+
+	ANKI_CHECK(BinaryDeserializer::validate<SceneBinary>(ConstWeakArray<U8, PtrSize>(data.m_data, size)));
+
+	SceneBinary* binary;
+	ANKI_CHECK(BinaryDeserializer::deserializeInPlace(WeakArray<U8, PtrSize>(data.m_data, size), binary));
+
+	if(memcmp(SCENE_BINARY_MAGIC, &binary->m_magic[0], sizeof(binary->m_magic)) != 0)
+	{
+		ANKI_SCENE_LOGE("Corrupted or wrong version of scene binary: %s", filename.cstr());
+		return Error::USER_DATA;
+	}
+
+	ANKI_CHECK(validate(*binary));
+
+	// Create the nodes. The loads of their resources are held back and submitted at once at the end
+	m_scene->reserveNodes(binary->m_nodes.getSize());
+	DynamicArrayAuto<SceneNode*> nodes(alloc);
+	nodes.create(binary->m_nodes.getSize(), nullptr);
+
+	resources.getAsyncLoader().beginBatch();
+
+	Error err = Error::NONE;
+	for(U32 i = 0; i < binary->m_nodes.getSize() && !err; ++i)
+	{
+		err = newNode(*binary, binary->m_nodes[i], aspectRatio, nodes[i]);
+	}
+
+	resources.getAsyncLoader().endBatch();
+	ANKI_CHECK(err);
+
+	for(const SceneBinaryLightEvent& bevent : binary->m_lightEvents)
+	{
+		ANKI_CHECK(newLightEvent(bevent, *nodes[bevent.m_node]));
+	}
+
+	if(binary->m_activeCameraNode != MAX_U32)
+	{
+		m_scene->setActiveCameraNode(nodes[binary->m_activeCameraNode]);
+	}
+
+	ANKI_SCENE_LOGI("Loaded scene binary: %s (%u nodes)", filename.cstr(), binary->m_nodes.getSize());
+	return Error::NONE;
+}
+
+Error SceneBinaryLoader::validate(const SceneBinary& binary)
+{
+	const WeakArray<char>& strings = binary.m_strings;
+	if(strings.getSize() > 0 && strings[strings.getSize() - 1] != '\0')
+	{
+		ANKI_SCENE_LOGE("The strings of the scene binary are not terminated");
+		return Error::USER_DATA;
+	}
+
+	auto checkString = [&](U32 offset, Bool optional) -> Error {
+		if((offset == MAX_U32 && !optional) || (offset != MAX_U32 && offset >= strings.getSize()))
+		{
+			ANKI_SCENE_LOGE("Wrong string offset in the scene binary");
+			return Error::USER_DATA;
+		}
+
+		return Error::NONE;
+	};
+
+	for(const SceneBinaryNode& bnode : binary.m_nodes)
+	{
+		if(bnode.m_type >= SceneBinaryNodeType::COUNT)
+		{
+			ANKI_SCENE_LOGE("Wrong node type in the scene binary");
+			return Error::USER_DATA;
+		}
+
+		const Bool needsFile =
+			bnode.m_type == SceneBinaryNodeType::MODEL || bnode.m_type == SceneBinaryNodeType::STATIC_COLLISION
+			|| bnode.m_type == SceneBinaryNodeType::PARTICLE_EMITTER
+			|| bnode.m_type == SceneBinaryNodeType::GPU_PARTICLE_EMITTER;
+
+		ANKI_CHECK(checkString(bnode.m_name, true));
+		ANKI_CHECK(checkString(bnode.m_filename, !needsFile));
+
+		if(bnode.m_type == SceneBinaryNodeType::REFLECTION_PROBE
+			&& !(bnode.m_properties & SceneBinaryNodeProperty::BOUNDING_BOX))
+		{
+			ANKI_SCENE_LOGE("Reflection probes need a bounding box");
+			return Error::USER_DATA;
+		}
+	}
+
+	for(const SceneBinaryLightEvent& bevent : binary.m_lightEvents)
+	{
+		if(bevent.m_node >= binary.m_nodes.getSize() || !isLight(binary.m_nodes[bevent.m_node].m_type))
+		{
+			ANKI_SCENE_LOGE("Light event without a light in the scene binary");
+			return Error::USER_DATA;
+		}
+	}
+
+	if(binary.m_activeCameraNode != MAX_U32
+		&& (binary.m_activeCameraNode >= binary.m_nodes.getSize()
+			   || binary.m_nodes[binary.m_activeCameraNode].m_type != SceneBinaryNodeType::PERSPECTIVE_CAMERA))
+	{
+		ANKI_SCENE_LOGE("Wrong active camera in the scene binary");
+		return Error::USER_DATA;
+	}
+
+	return Error::NONE;
+}
+
+Error SceneBinaryLoader::newNode(
+	const SceneBinary& binary, const SceneBinaryNode& bnode, F32 aspectRatio, SceneNode*& node)
+{
+	const CString name = getString(binary, bnode.m_name);
+	const CString filename = getString(binary, bnode.m_filename);
+	const SceneBinaryNodeProperty props = bnode.m_properties;
+	const Array<F32, 7>& params = bnode.m_params;
+
+	const Transform trf(Vec4(bnode.m_origin[0], bnode.m_origin[1], bnode.m_origin[2], 0.0f),
+		Mat3x4(&bnode.m_rotation[0]),
+		bnode.m_scale);
+	const Vec4 boxMin(params[0], params[1], params[2], 0.0f);
+	const Vec4 boxMax(params[3], params[4], params[5], 0.0f);
+
+	switch(bnode.m_type)
+	{
+	case SceneBinaryNodeType::MODEL:
+	{
+		ModelNode* n;
+		ANKI_CHECK(m_scene->newSceneNode(name, n, filename));
+		node = n;
+		break;
+	}
+	case SceneBinaryNodeType::STATIC_COLLISION:
+	{
+		StaticCollisionNode* n;
+		ANKI_CHECK(m_scene->newSceneNode(name, n, filename, trf));
+		node = n;
+		break;
+	}
+	case SceneBinaryNodeType::PARTICLE_EMITTER:
+	{
+		ParticleEmitterNode* n;
+		ANKI_CHECK(m_scene->newSceneNode(name, n, filename));
+		node = n;
+		break;
+	}
+	case SceneBinaryNodeType::GPU_PARTICLE_EMITTER:
+	{
+		GpuParticleEmitterNode* n;
+		ANKI_CHECK(m_scene->newSceneNode(name, n, filename));
+		node = n;
+		break;
+	}
+	case SceneBinaryNodeType::POINT_LIGHT:
+	{
+		PointLightNode* n;
+		ANKI_CHECK(m_scene->newSceneNode(name, n));
+		node = n;
+		break;
+	}
+	case SceneBinaryNodeType::SPOT_LIGHT:
+	{
+		SpotLightNode* n;
+		ANKI_CHECK(m_scene->newSceneNode(name, n));
+		node = n;
+		break;
+	}
+	case SceneBinaryNodeType::DIRECTIONAL_LIGHT:
+	{
+		DirectionalLightNode* n;
+		ANKI_CHECK(m_scene->newSceneNode(name, n));
+		node = n;
+		break;
+	}
+	case SceneBinaryNodeType::REFLECTION_PROBE:
+	{
+		ReflectionProbeNode* n;
+		ANKI_CHECK(m_scene->newSceneNode(name, n, boxMin, boxMax));
+		node = n;
+		break;
+	}
+	case SceneBinaryNodeType::GLOBAL_ILLUMINATION_PROBE:
+	{
+		GlobalIlluminationProbeNode* n;
+		ANKI_CHECK(m_scene->newSceneNode(name, n));
+		node = n;
+
+		GlobalIlluminationProbeComponent& comp = n->getComponent<GlobalIlluminationProbeComponent>();
+		if(!!(props & SceneBinaryNodeProperty::BOUNDING_BOX))
+		{
+			comp.setBoundingBox(boxMin, boxMax);
+		}
+
+		if(!!(props & SceneBinaryNodeProperty::CELL_SIZE))
+		{
+			comp.setCellSize(params[6]);
+		}
+		break;
+	}
+	case SceneBinaryNodeType::PERSPECTIVE_CAMERA:
+	{
+		PerspectiveCameraNode* n;
+		ANKI_CHECK(m_scene->newSceneNode(name, n));
+		node = n;
+
+		if(!!(props & SceneBinaryNodeProperty::PERSPECTIVE))
+		{
+			const F32 fovX =
+				(!!(props & SceneBinaryNodeProperty::FOV_X_TIMES_ASPECT_RATIO)) ? params[2] * aspectRatio : params[2];
+			n->getComponent<FrustumComponent>().setPerspective(params[0], params[1], fovX, params[3]);
+		}
+		break;
+	}
+	default:
+		ANKI_ASSERT(0);
+	}
+
+	if(isLight(bnode.m_type))
+	{
+		LightComponent& light = node->getComponent<LightComponent>();
+
+		if(!!(props & SceneBinaryNodeProperty::DIFFUSE_COLOR))
+		{
+			light.setDiffuseColor(Vec4(params[0], params[1], params[2], params[3]));
+		}
+
+		if(!!(props & SceneBinaryNodeProperty::LIGHT_DISTANCE))
+		{
+			if(bnode.m_type == SceneBinaryNodeType::SPOT_LIGHT)
+			{
+				light.setDistance(params[4]);
+			}
+			else
+			{
+				light.setRadius(params[4]);
+			}
+		}
+
+		if(!!(props & SceneBinaryNodeProperty::INNER_ANGLE))
+		{
+			light.setInnerAngle(params[5]);
+		}
+
+		if(!!(props & SceneBinaryNodeProperty::OUTER_ANGLE))
+		{
+			light.setOuterAngle(params[6]);
+		}
+
+		light.setShadowEnabled(!!(props & SceneBinaryNodeProperty::SHADOW));
+	}
+
+	// The static collision nodes got it already
+	if(!!(props & SceneBinaryNodeProperty::TRANSFORM) && bnode.m_type != SceneBinaryNodeType::STATIC_COLLISION)
+	{
+		node->getComponent<MoveComponent>().setLocalTransform(trf);
+	}
+
+	return Error::NONE;
+}
+
+Error SceneBinaryLoader::newLightEvent(const SceneBinaryLightEvent& bevent, SceneNode& light)
+{
+	LightEvent* event;
+	ANKI_CHECK(m_scene->getEventManager().newEvent(event, bevent.m_startTime, bevent.m_duration, &light));
+
+	if(!!(bevent.m_properties & SceneBinaryLightEventProperty::INTENSITY_MULTIPLIER))
+	{
+		event->setIntensityMultiplier(Vec4(bevent.m_intensityMultiplier[0],
+			bevent.m_intensityMultiplier[1],
+			bevent.m_intensityMultiplier[2],
+			bevent.m_intensityMultiplier[3]));
+	}
+
+	if(!!(bevent.m_properties & SceneBinaryLightEventProperty::RADIUS_MULTIPLIER))
+	{
+		event->setRadiusMultiplier(bevent.m_radiusMultiplier);
+	}
+
+	if(!!(bevent.m_properties & SceneBinaryLightEventProperty::FREQUENCY))
+	{
+		event->setFrequency(bevent.m_frequency, bevent.m_frequencyDeviation);
+	}
+
+	return Error::NONE;
+}
+
+} // end namespace anki
@@ -0,0 +1,46 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/scene/SceneBinary.h>
+
+namespace anki
+{
+
+/// @addtogroup scene
+/// @{
+
+/// Creates the nodes of a scene binary. It's a lot faster than running the Lua script the binary was converted from
+/// (see the scene_converter tool). The file is read with a single read, the containers of the scene are sized once
+/// and the loads of the resources are submitted to the AsyncLoader all together after the nodes are created.
+class SceneBinaryLoader
+{
+public:
+	SceneBinaryLoader(SceneGraph* scene)
+		: m_scene(scene)
+	{
+		ANKI_ASSERT(scene);
+	}
+
+	/// Load a scene binary.
+	/// @param filename The resource filename of the binary.
+	/// @param aspectRatio The aspect ratio of the cameras that have their horizontal FOV relative to it.
+	ANKI_USE_RESULT Error load(CString filename, F32 aspectRatio);
+
+private:
+	SceneGraph* m_scene;
+
+	/// Check the indices and the offsets of the binary.
+	static ANKI_USE_RESULT Error validate(const SceneBinary& binary);
+
+	ANKI_USE_RESULT Error newNode(
+		const SceneBinary& binary, const SceneBinaryNode& bnode, F32 aspectRatio, SceneNode*& node);
+
+	ANKI_USE_RESULT Error newLightEvent(const SceneBinaryLightEvent& bevent, SceneNode& light);
+};
+/// @}
+
+} // end namespace anki
@@ -7,8 +7,12 @@
 #include <anki/scene/CameraNode.h>
 #include <anki/scene/PhysicsDebugNode.h>
 #include <anki/scene/ModelNode.h>
+#include <anki/scene/ParticleEmitterNode.h>
 #include <anki/scene/Octree.h>
 #include <anki/scene/components/FrustumComponent.h>
+#include <anki/scene/components/SpatialComponent.h>
+#include <anki/scene/components/MoveComponent.h>
+#include <anki/scene/components/SkinComponent.h>
 #include <anki/physics/PhysicsWorld.h>
 #include <anki/resource/ResourceManager.h>
 #include <anki/renderer/MainRenderer.h>
@@ -19,18 +23,22 @@
 namespace anki
 {
 
-const U NODE_UPDATE_BATCH = 10;
+/// The number of chunks every update thread should get to balance the load.
+const U32 NODE_UPDATE_CHUNKS_PER_THREAD = 4;
 
-class SceneGraph::UpdateSceneNodesCtx
+/// The cost of the nodes that were never updated or are practically free. Make sure that they count.
+const Second MIN_NODE_UPDATE_COST = 1.0e-7;
+
+/// The progress of the update of a node.
+class SceneGraph::NodeUpdateInfo
 {
 public:
-	SceneGraph* m_scene = nullptr;
-
-	IntrusiveList<SceneNode>::Iterator m_crntNode;
-	SpinLock m_crntNodeLock;
-
-	Second m_prevUpdateTime;
-	Second m_crntTime;
+	SceneNode* m_node = nullptr;
+	Timestamp m_componentTimestamp = 0;
+	Second m_cost = 0.0;
+	U32 m_nextComponent = 0; ///< The component to resume from.
+	U32 m_moveRequest = MAX_U32; ///< Index to the deferred MoveComponent update.
+	Bool m_done = false;
 };
 
 SceneGraph::SceneGraph()
@@ -39,6 +47,8 @@ SceneGraph::SceneGraph()
 
 SceneGraph::~SceneGraph()
 {
+	m_sectors.unloadAll();
+
 	Error err = iterateSceneNodes([&](SceneNode& s) -> Error {
 		s.setMarkedForDeletion();
 		return Error::NONE;
@@ -46,6 +56,15 @@ SceneGraph::~SceneGraph()
 	(void)err;
 
 	deleteNodesMarkedForDeletion();
+	ANKI_ASSERT(m_nodeHierarchy.getSize() == 0);
+	m_nodeHierarchy.destroy(m_alloc);
+	m_dynamicNodes.destroy(m_alloc);
+	m_dirtyNodes.destroy(m_alloc);
+	ANKI_ASSERT(m_gpuSkins.getSize() == 0);
+	m_gpuSkins.destroy(m_alloc);
+	ANKI_ASSERT(m_particleEmitters.getSize() == 0);
+	m_particleEmitters.destroy(m_alloc);
+	m_componentAlloc.destroy(m_alloc);
 
 	if(m_octree)
 	{
@@ -78,11 +97,30 @@ Error SceneGraph::init(AllocAlignedCallback allocCb,
 	m_limits.m_reflectionProbeEffectiveDistance = config.getNumberF32("scene_reflectionProbeEffectiveDistance");
 	m_limits.m_reflectionProbeShadowEffectiveDistance =
 		config.getNumberF32("scene_reflectionProbeShadowEffectiveDistance");
+	m_limits.m_gpuOcclusionCulling = config.getBool("r_gpuOcclusionCulling");
+	m_limits.m_gpuSkinning = config.getBool("r_gpuSkinning");
+	m_limits.m_animationLodDistance0 = config.getNumberF32("scene_animationLodDistance0");
+	m_limits.m_animationLodDistance1 = config.getNumberF32("scene_animationLodDistance1");
+	m_limits.m_animationLodMaxBoneDepth = config.getNumberU32("scene_animationLodMaxBoneDepth");
+	m_limits.m_physicsLodDistance0 = config.getNumberF32("scene_physicsLodDistance0");
+	m_limits.m_physicsLodDistance1 = config.getNumberF32("scene_physicsLodDistance1");
+	m_limits.m_particleLodDistance0 = config.getNumberF32("scene_particleLodDistance0");
+	m_limits.m_particleLodDistance1 = config.getNumberF32("scene_particleLodDistance1");
+	m_limits.m_lodScreenSizes[0] = config.getNumberF32("scene_lodScreenSize0");
+	m_limits.m_lodScreenSizes[1] = config.getNumberF32("scene_lodScreenSize1");
+	m_limits.m_lodScreenSizes[2] = config.getNumberF32("scene_lodScreenSize2");
+	m_limits.m_lodHysteresis = config.getNumberF32("scene_lodHysteresis");
+	m_limits.m_lodCrossFadeFrameCount = config.getNumberU32("scene_lodCrossFadeFrameCount");
+	m_limits.m_transparencySortDistance = config.getNumberF32("scene_transparencySortDistance");
 
 	ANKI_CHECK(m_events.init(this));
+	ANKI_CHECK(m_sectors.init(this, config));
 
 	m_octree = m_alloc.newInstance<Octree>(m_alloc);
-	m_octree->init(m_sceneMin, m_sceneMax, 5); // TODO
+	m_octree->init(m_sceneMin,
+		m_sceneMax,
+		5, // TODO
+		config.getBool("scene_looseOctree") ? OctreeType::LOOSE : OctreeType::REGULAR);
 
 	// Init the default main camera
 	ANKI_CHECK(newSceneNode<PerspectiveCameraNode>("mainCamera", m_defaultMainCam));
@@ -102,29 +140,73 @@ Error SceneGraph::registerNode(SceneNode* node)
 	ANKI_ASSERT(node);
 
 	// Add to dict if it has a name
-	if(node->getName())
+	if(!node->getNameId().isEmpty())
 	{
-		if(tryFindSceneNode(node->getName()))
+		if(tryFindSceneNode(node->getNameId()))
 		{
 			ANKI_SCENE_LOGE("Node with the same name already exists");
 			return Error::USER_DATA;
 		}
 
-		m_nodesDict.emplace(m_alloc, node->getName(), node);
+		m_nodesDict.emplace(m_alloc, node->getNameId(), node);
 	}
 
-	// Add to vector
-	m_nodes.pushBack(node);
-	++m_nodesCount;
+	// Add to the hierarchy. The children that were registered before the node are roots so far
+	SceneNode* parent = node->getParent();
+	m_nodeHierarchy.add(m_alloc, node, (parent && parent->m_registered) ? parent : nullptr);
+	const Error err = node->visitChildrenMaxDepth(0, [&](SceneNode& child) -> Error {
+		if(child.m_registered)
+		{
+			m_nodeHierarchy.setParent(&child, node);
+		}
+		return Error::NONE;
+	});
+	ANKI_ASSERT(!err && "The visitor can't fail");
+
+	// Dynamic nodes are updated every frame. The static ones need to be updated at least once
+	node->m_registered = true;
+	if(!node->isStatic())
+	{
+		node->m_dynamicNodeIdx = m_dynamicNodes.getSize();
+		m_dynamicNodes.emplaceBack(m_alloc, node);
+	}
+	else
+	{
+		// It might have been marked while it wasn't registered
+		node->m_dirty.store(0);
+		node->markDirty();
+	}
 
 	return Error::NONE;
 }
 
+void SceneGraph::reserveNodes(U32 count)
+{
+	m_nodeHierarchy.reserve(m_alloc, m_nodeHierarchy.getSize() + count);
+
+	// Most of the new nodes will be dynamic or dirty
+	m_dynamicNodes.resizeStorage(m_alloc, m_dynamicNodes.getSize() + count);
+
+	LockGuard<SpinLock> lock(m_dirtyNodesMtx);
+	m_dirtyNodes.resizeStorage(m_alloc, m_dirtyNodes.getSize() + count);
+}
+
 void SceneGraph::unregisterNode(SceneNode* node)
 {
-	// Remove from the graph
-	m_nodes.erase(node);
-	--m_nodesCount;
+	// Remove from the graph. Its registered children become roots
+	m_nodeHierarchy.remove(m_alloc, node);
+
+	if(node->m_dynamicNodeIdx != MAX_U32)
+	{
+		m_dynamicNodes[node->m_dynamicNodeIdx] = m_dynamicNodes.getBack();
+		m_dynamicNodes[node->m_dynamicNodeIdx]->m_dynamicNodeIdx = node->m_dynamicNodeIdx;
+		m_dynamicNodes.popBack(m_alloc);
+		node->m_dynamicNodeIdx = MAX_U32;
+	}
+
+	removeDirtyNode(*node);
+
+	node->m_registered = false;
 
 	if(m_mainCam != m_defaultMainCam && m_mainCam == node)
 	{
@@ -132,14 +214,155 @@ void SceneGraph::unregisterNode(SceneNode* node)
 	}
 
 	// Remove from dict
-	if(node->getName())
+	if(!node->getNameId().isEmpty())
 	{
-		auto it = m_nodesDict.find(node->getName());
+		auto it = m_nodesDict.find(node->getNameId());
 		ANKI_ASSERT(it != m_nodesDict.getEnd());
 		m_nodesDict.erase(m_alloc, it);
 	}
 }
 
+void SceneGraph::onNodeParentChanged(SceneNode& node)
+{
+	ANKI_ASSERT(node.m_registered);
+	SceneNode* parent = node.getParent();
+	ANKI_ASSERT(!parent || parent->m_registered);
+	m_nodeHierarchy.setParent(&node, parent);
+}
+
+void SceneGraph::addDirtyNode(SceneNode& node)
+{
+	if(!node.m_registered)
+	{
+		// Will be queued when it's registered
+		return;
+	}
+
+	LockGuard<SpinLock> lock(m_dirtyNodesMtx);
+	if(node.m_dirtyNodeIdx == MAX_U32)
+	{
+		node.m_dirtyNodeIdx = m_dirtyNodes.getSize();
+		m_dirtyNodes.emplaceBack(m_alloc, &node);
+	}
+	else
+	{
+		// A stale entry of a node that got updated after it was marked. Reuse it
+	}
+}
+
+void SceneGraph::removeDirtyNode(SceneNode& node)
+{
+	LockGuard<SpinLock> lock(m_dirtyNodesMtx);
+	if(node.m_dirtyNodeIdx != MAX_U32)
+	{
+		ANKI_ASSERT(m_dirtyNodes[node.m_dirtyNodeIdx] == &node);
+		m_dirtyNodes[node.m_dirtyNodeIdx] = m_dirtyNodes.getBack();
+		m_dirtyNodes[node.m_dirtyNodeIdx]->m_dirtyNodeIdx = node.m_dirtyNodeIdx;
+		m_dirtyNodes.popBack(m_alloc);
+		node.m_dirtyNodeIdx = MAX_U32;
+	}
+}
+
+void SceneGraph::onNodeStaticChanged(SceneNode& node)
+{
+	if(!node.m_registered)
+	{
+		// Will be placed in the right container when it's registered
+		return;
+	}
+
+	if(node.isStatic())
+	{
+		ANKI_ASSERT(node.m_dynamicNodeIdx != MAX_U32);
+		m_dynamicNodes[node.m_dynamicNodeIdx] = m_dynamicNodes.getBack();
+		m_dynamicNodes[node.m_dynamicNodeIdx]->m_dynamicNodeIdx = node.m_dynamicNodeIdx;
+		m_dynamicNodes.popBack(m_alloc);
+		node.m_dynamicNodeIdx = MAX_U32;
+	}
+	else
+	{
+		ANKI_ASSERT(node.m_dynamicNodeIdx == MAX_U32);
+		node.m_dynamicNodeIdx = m_dynamicNodes.getSize();
+		m_dynamicNodes.emplaceBack(m_alloc, &node);
+
+		// Clear the dirty flag or it will not be queued if it becomes static again
+		node.m_dirty.store(0);
+		removeDirtyNode(node);
+	}
+}
+
+void SceneGraph::tryQueueNodeForUpdate(SceneNode& node, DynamicArrayAuto<SceneNode*>& nodes)
+{
+	if(node.isDirty() && node.m_updateQueuedTimestamp != m_timestamp)
+	{
+		node.m_updateQueuedTimestamp = m_timestamp;
+		nodes.emplaceBack(&node);
+	}
+}
+
+void SceneGraph::gatherUpdateRoots(DynamicArrayAuto<SceneNode*>& nodes)
+{
+	// A node that will be updated is a root if its parent will not be updated. If the parent will be updated it will
+	// find the node when it gathers its children
+	auto isRoot = [](const SceneNode& node) {
+		return node.getParent() == nullptr || !node.getParent()->isDirty();
+	};
+
+	for(SceneNode* node : m_dynamicNodes)
+	{
+		if(isRoot(*node))
+		{
+			tryQueueNodeForUpdate(*node, nodes);
+		}
+	}
+
+	LockGuard<SpinLock> lock(m_dirtyNodesMtx);
+	for(SceneNode* node : m_dirtyNodes)
+	{
+		node->m_dirtyNodeIdx = MAX_U32;
+
+		// Skip the stale entries. Those nodes got updated after they were marked
+		if(node->isStatic() && node->isDirty() && isRoot(*node))
+		{
+			tryQueueNodeForUpdate(*node, nodes);
+		}
+	}
+
+	// The nodes that will be marked from now on will be updated in the next frame
+	m_dirtyNodes.resize(m_alloc, 0);
+}
+
+void SceneGraph::extendSceneBounds(const Vec3& min, const Vec3& max)
+{
+	const Vec3 newMin = m_sceneMin.min(min);
+	const Vec3 newMax = m_sceneMax.max(max);
+	if(newMin == m_sceneMin && newMax == m_sceneMax)
+	{
+		return;
+	}
+
+	// The octree can't change its bounds while it holds something
+	for(SceneNode* node : m_nodeHierarchy)
+	{
+		Bool hasSpatials = false;
+		const Error err = node->iterateComponentsOfType<SpatialComponent>([&](SpatialComponent& sp) -> Error {
+			sp.unplace();
+			hasSpatials = true;
+			return Error::NONE;
+		});
+		(void)err;
+
+		if(hasSpatials)
+		{
+			node->markDirty();
+		}
+	}
+
+	m_sceneMin = newMin;
+	m_sceneMax = newMax;
+	m_octree->setSceneBounds(m_sceneMin, m_sceneMax);
+}
+
 SceneNode& SceneGraph::findSceneNode(const CString& name)
 {
 	SceneNode* node = tryFindSceneNode(name);
@@ -149,37 +372,51 @@ SceneNode& SceneGraph::findSceneNode(const CString& name)
 
 SceneNode* SceneGraph::tryFindSceneNode(const CString& name)
 {
+	// The names of the nodes are interned so a name that is not can't be a node
+	const StringId nameId = StringId::tryFind(name);
+	return (nameId.isEmpty()) ? nullptr : tryFindSceneNode(nameId);
+}
+
+SceneNode& SceneGraph::findSceneNode(StringId name)
+{
+	SceneNode* node = tryFindSceneNode(name);
+	ANKI_ASSERT(node);
+	return *node;
+}
+
+SceneNode* SceneGraph::tryFindSceneNode(StringId name)
+{
+	ANKI_ASSERT(!name.isEmpty());
 	auto it = m_nodesDict.find(name);
-	return (it == m_nodesDict.getEnd()) ? nullptr : (*it);
+	return (it == m_nodesDict.getEnd() || (*it)->getNameId() != name) ? nullptr : (*it);
 }
 
 void SceneGraph::deleteNodesMarkedForDeletion()
 {
-	/// Delete all nodes pending deletion. At this point all scene threads
-	/// should have finished their tasks
-	while(m_objectsMarkedForDeletionCount.load() > 0)
-	{
-		Bool found = false;
-		auto it = m_nodes.begin();
-		auto end = m_nodes.end();
-		for(; it != end; ++it)
+	// Delete all nodes pending deletion. At this point all scene threads should have finished their tasks. Go backwards
+	// so the children are deleted before their parents and the nodes that are not visited yet don't move
+	U32 i = m_nodeHierarchy.getSize();
+	while(i-- > 0 && m_objectsMarkedForDeletionCount.load() > 0)
+	{
+		SceneNode& node = m_nodeHierarchy[i];
+		if(node.getMarkedForDeletion())
 		{
-			SceneNode& node = *it;
-
-			if(node.getMarkedForDeletion())
-			{
-				// Delete node
-				unregisterNode(&node);
-				m_alloc.deleteInstance(&node);
-				m_objectsMarkedForDeletionCount.fetchSub(1);
-				found = true;
-				break;
-			}
+			unregisterNode(&node);
+			m_alloc.deleteInstance(&node);
+			m_objectsMarkedForDeletionCount.fetchSub(1);
 		}
-
-		(void)found;
-		ANKI_ASSERT(found && "Something is wrong with marked for deletion");
 	}
+
+	ANKI_ASSERT(m_objectsMarkedForDeletionCount.load() == 0 && "Something is wrong with marked for deletion");
+}
+
+Error SceneGraph::updatePhysics(Second prevUpdateTime, Second crntTime)
+{
+	ANKI_TRACE_SCOPED_EVENT(SCENE_PHYSICS_UPDATE);
+	m_stats.m_physicsUpdate = HighRezTimer::getCurrentTime();
+	ANKI_CHECK(m_physics->update(crntTime - prevUpdateTime));
+	m_stats.m_physicsUpdate = HighRezTimer::getCurrentTime() - m_stats.m_physicsUpdate;
+	return Error::NONE;
 }
 
 Error SceneGraph::update(Second prevUpdateTime, Second crntTime)
@@ -193,7 +430,9 @@ Error SceneGraph::update(Second prevUpdateTime, Second crntTime)
 	ANKI_ASSERT(m_timestamp > 0);
 
 	// Reset the framepool
+	const U32 growFrameCount = m_frameAlloc.getMemoryPool().getGrowFrameCount();
 	m_frameAlloc.getMemoryPool().reset();
+	ANKI_TRACE_INC_COUNTER(SCENE_FRAME_ALLOC_GROWS, m_frameAlloc.getMemoryPool().getGrowFrameCount() - growFrameCount);
 
 	// Delete stuff
 	{
@@ -202,42 +441,75 @@ Error SceneGraph::update(Second prevUpdateTime, Second crntTime)
 		deleteNodesMarkedForDeletion();
 	}
 
-	// Update
+	// Stream the world. The new nodes are updated in this frame
+	{
+		const MoveComponent* camMove = m_mainCam->tryGetComponent<MoveComponent>();
+		if(camMove)
+		{
+			ANKI_CHECK(m_sectors.update(camMove->getWorldTransform().getOrigin().xyz()));
+		}
+	}
+
+	// Update. The async physics start after the nodes read the results of the previous frame
+	ANKI_CHECK(m_physics->waitUpdate());
+	if(!m_physics->getAsyncUpdateEnabled())
+	{
+		ANKI_CHECK(updatePhysics(prevUpdateTime, crntTime));
+	}
+
+	// Simulate the big particle emitters in parallel before the nodes. The node updates run in the hive and they can't
+	// spread the work of a single emitter. The particles are in world space so they don't depend on the node updates
+	if(m_particleEmitters.getSize() > 0)
 	{
-		ANKI_TRACE_SCOPED_EVENT(SCENE_PHYSICS_UPDATE);
-		m_stats.m_physicsUpdate = HighRezTimer::getCurrentTime();
-		m_physics->update(crntTime - prevUpdateTime);
-		m_stats.m_physicsUpdate = HighRezTimer::getCurrentTime() - m_stats.m_physicsUpdate;
+		ParticleEmitterNode::simulateBatch(*m_threadHive,
+			WeakArray<ParticleEmitterNode*>(&m_particleEmitters[0], m_particleEmitters.getSize()),
+			prevUpdateTime,
+			crntTime);
 	}
 
 	{
 		ANKI_TRACE_SCOPED_EVENT(SCENE_NODES_UPDATE);
 		ANKI_CHECK(m_events.updateAllEvents(prevUpdateTime, crntTime));
 
-		// Then the rest
-		Array<ThreadHiveTask, ThreadHive::MAX_THREADS> tasks;
-		UpdateSceneNodesCtx updateCtx;
-		updateCtx.m_scene = this;
-		updateCtx.m_crntNode = m_nodes.getBegin();
-		updateCtx.m_prevUpdateTime = prevUpdateTime;
-		updateCtx.m_crntTime = crntTime;
+		// The camera might be updated in parallel with the skins and the emitters so cache its position
+		const MoveComponent* camMove = m_mainCam->tryGetComponent<MoveComponent>();
+		if(camMove)
+		{
+			m_lodOrigin = camMove->getWorldTransform().getOrigin().xyz();
+		}
+
+		// Sort the nodes breadth first. The children depend on their parents so every level of the hierarchy can be
+		// updated in parallel after the previous levels are done. The static nodes that are not dirty and their
+		// subtrees are skipped
+		DynamicArrayAuto<SceneNode*> nodes(m_frameAlloc);
+		nodes.reserve(m_dynamicNodes.getSize());
+		gatherUpdateRoots(nodes);
 
-		for(U i = 0; i < m_threadHive->getThreadCount(); i++)
+		U32 levelBegin = 0;
+		while(levelBegin < nodes.getSize())
 		{
-			tasks[i] = ANKI_THREAD_HIVE_TASK(
-				{
-					if(self->m_scene->updateNodes(*self))
-					{
-						ANKI_SCENE_LOGF("Will not recover");
-					}
-				},
-				&updateCtx,
-				nullptr,
-				nullptr);
+			const U32 levelEnd = nodes.getSize();
+			updateHierarchyLevel(
+				prevUpdateTime, crntTime, WeakArray<SceneNode*>(&nodes[levelBegin], levelEnd - levelBegin));
+
+			// Gather the next level
+			for(U32 i = levelBegin; i < levelEnd; ++i)
+			{
+				m_nodeHierarchy.iterateChildren(m_nodeHierarchy.getIndex(*nodes[i]), [&](SceneNode& child) {
+					tryQueueNodeForUpdate(child, nodes);
+				});
+			}
+
+			levelBegin = levelEnd;
 		}
 
-		m_threadHive->submitTasks(&tasks[0], m_threadHive->getThreadCount());
-		m_threadHive->waitAllTasks();
+		m_stats.m_updatedNodeCount = nodes.getSize();
+	}
+
+	// Step the physics while the visibility and the rendering of this frame run
+	if(m_physics->getAsyncUpdateEnabled())
+	{
+		ANKI_CHECK(updatePhysics(prevUpdateTime, crntTime));
 	}
 
 	m_stats.m_updateTime = HighRezTimer::getCurrentTime() - m_stats.m_updateTime;
@@ -248,103 +520,236 @@ void SceneGraph::doVisibilityTests(RenderQueue& rqueue)
 {
 	m_stats.m_visibilityTestsTime = HighRezTimer::getCurrentTime();
 	doVisibilityTests(*m_mainCam, *this, rqueue);
+	gatherGpuSkinningJobs(rqueue);
 	m_stats.m_visibilityTestsTime = HighRezTimer::getCurrentTime() - m_stats.m_visibilityTestsTime;
 }
 
-Error SceneGraph::updateNode(Second prevTime, Second crntTime, SceneNode& node)
+void SceneGraph::addGpuSkin(SkinComponent& skin)
 {
-	ANKI_TRACE_INC_COUNTER(SCENE_NODES_UPDATED, 1);
+	LockGuard<SpinLock> lock(m_gpuSkinsMtx);
+	ANKI_ASSERT(skin.m_gpuSkinIdx == MAX_U32);
+	skin.m_gpuSkinIdx = m_gpuSkins.getSize();
+	m_gpuSkins.emplaceBack(m_alloc, &skin);
+}
 
-	Error err = Error::NONE;
+void SceneGraph::removeGpuSkin(SkinComponent& skin)
+{
+	LockGuard<SpinLock> lock(m_gpuSkinsMtx);
+	ANKI_ASSERT(skin.m_gpuSkinIdx != MAX_U32 && m_gpuSkins[skin.m_gpuSkinIdx] == &skin);
+	m_gpuSkins[skin.m_gpuSkinIdx] = m_gpuSkins.getBack();
+	m_gpuSkins[skin.m_gpuSkinIdx]->m_gpuSkinIdx = skin.m_gpuSkinIdx;
+	m_gpuSkins.popBack(m_alloc);
+	skin.m_gpuSkinIdx = MAX_U32;
+}
 
-	// Components update
-	Timestamp componentTimestamp = 0;
-	err = node.iterateComponents([&](SceneComponent& comp) -> Error {
-		Bool updated = false;
-		Error e = comp.update(node, prevTime, crntTime, updated);
+void SceneGraph::addParticleEmitter(ParticleEmitterNode& emitter)
+{
+	LockGuard<SpinLock> lock(m_particleEmittersMtx);
+	m_particleEmitters.emplaceBack(m_alloc, &emitter);
+}
 
-		if(updated)
+void SceneGraph::removeParticleEmitter(ParticleEmitterNode& emitter)
+{
+	LockGuard<SpinLock> lock(m_particleEmittersMtx);
+	for(ParticleEmitterNode*& e : m_particleEmitters)
+	{
+		if(e == &emitter)
 		{
-			comp.setTimestamp(node.getSceneGraph().m_timestamp);
-			componentTimestamp = max(componentTimestamp, node.getSceneGraph().m_timestamp);
-			ANKI_ASSERT(componentTimestamp > 0);
+			e = m_particleEmitters.getBack();
+			m_particleEmitters.popBack(m_alloc);
+			return;
 		}
+	}
 
-		return e;
-	});
+	ANKI_ASSERT(!"Not found");
+}
 
-	// Update children
-	if(!err)
+void SceneGraph::gatherGpuSkinningJobs(RenderQueue& rqueue)
+{
+	// Evaluate all of them, not only the visible. The shadow and the probe passes need them as well
+	if(m_gpuSkins.getSize() == 0)
 	{
-		err = node.visitChildrenMaxDepth(
-			0, [&](SceneNode& child) -> Error { return updateNode(prevTime, crntTime, child); });
+		rqueue.m_gpuSkinningJobs = WeakArray<GpuSkinningQueueElement>();
+		return;
 	}
 
-	// Frame update
-	if(!err)
+	GpuSkinningQueueElement* jobs = m_frameAlloc.newArray<GpuSkinningQueueElement>(m_gpuSkins.getSize());
+	for(U32 i = 0; i < m_gpuSkins.getSize(); ++i)
+	{
+		m_gpuSkins[i]->setupGpuSkinningQueueElement(jobs[i]);
+	}
+
+	rqueue.m_gpuSkinningJobs = WeakArray<GpuSkinningQueueElement>(jobs, m_gpuSkins.getSize());
+}
+
+void SceneGraph::updateHierarchyLevel(Second prevTime, Second crntTime, WeakArray<SceneNode*> nodes)
+{
+	ANKI_ASSERT(nodes.getSize() > 0);
+
+	// Split the nodes to chunks that cost about the same. Use the cost of the previous update
+	Second totalCost = 0.0;
+	for(const SceneNode* node : nodes)
+	{
+		totalCost += max(node->getUpdateCost(), MIN_NODE_UPDATE_COST);
+	}
+
+	const U32 maxChunkCount = min(nodes.getSize(), m_threadHive->getThreadCount() * NODE_UPDATE_CHUNKS_PER_THREAD);
+	const Second chunkCost = totalCost / Second(maxChunkCount);
+
+	DynamicArrayAuto<U32> chunkEnds(m_frameAlloc);
+	chunkEnds.create(maxChunkCount);
+	U32 chunkCount = 0;
+	Second cost = 0.0;
+	for(U32 i = 0; i < nodes.getSize() - 1; ++i)
 	{
-		if(componentTimestamp != 0)
+		cost += max(nodes[i]->getUpdateCost(), MIN_NODE_UPDATE_COST);
+		if(cost >= chunkCost * Second(chunkCount + 1) && chunkCount < maxChunkCount - 1)
 		{
-			node.setComponentMaxTimestamp(componentTimestamp);
+			chunkEnds[chunkCount++] = i + 1;
 		}
-		else
+	}
+	chunkEnds[chunkCount++] = nodes.getSize();
+
+	auto updateChunks = [&](U32 begin, U32 end, U32 threadId) {
+		ANKI_TRACE_SCOPED_EVENT(SCENE_NODES_UPDATE);
+
+		const U32 first = (begin > 0) ? chunkEnds[begin - 1] : 0;
+		const U32 count = chunkEnds[end - 1] - first;
+
+		DynamicArrayAuto<NodeUpdateInfo> infos(m_frameAlloc);
+		infos.create(count);
+		DynamicArrayAuto<MoveComponentUpdateRequest> moves(m_frameAlloc);
+		moves.reserve(count);
+		DynamicArrayAuto<SpatialComponent*> spatials(m_frameAlloc);
+		spatials.reserve(count);
+
+		// Update the components that come before the MoveComponents. They usually set the local transforms
+		for(U32 i = 0; i < count; ++i)
 		{
-			// No components or nothing updated, don't change the timestamp
+			infos[i].m_node = nodes[first + i];
+			if(updateNode(prevTime, crntTime, infos[i], moves, spatials))
+			{
+				ANKI_SCENE_LOGF("Will not recover");
+			}
 		}
 
-		err = node.frameUpdate(prevTime, crntTime);
-	}
+		// Update all the MoveComponents together. The parents are in the previous levels so they are up to date
+		MoveComponent::updateBatch(WeakArray<MoveComponentUpdateRequest>(moves));
 
-	return err;
+		// Update the rest
+		for(NodeUpdateInfo& info : infos)
+		{
+			if(!info.m_done && updateNode(prevTime, crntTime, info, moves, spatials))
+			{
+				ANKI_SCENE_LOGF("Will not recover");
+			}
+
+			info.m_node->setUpdateCost(info.m_cost);
+		}
+
+		SpatialComponent::updateBatch(WeakArray<SpatialComponent*>(spatials));
+	};
+
+	if(chunkCount == 1)
+	{
+		// Not worth waking the hive
+		updateChunks(0, 1, 0);
+	}
+	else
+	{
+		m_threadHive->parallelFor(chunkCount, 1, updateChunks);
+	}
 }
 
-Error SceneGraph::updateNodes(UpdateSceneNodesCtx& ctx) const
+Error SceneGraph::updateNode(Second prevTime,
+	Second crntTime,
+	NodeUpdateInfo& info,
+	DynamicArrayAuto<MoveComponentUpdateRequest>& moves,
+	DynamicArrayAuto<SpatialComponent*>& spatials)
 {
-	ANKI_TRACE_SCOPED_EVENT(SCENE_NODES_UPDATE);
+	ANKI_ASSERT(info.m_node && !info.m_done);
+	SceneNode& node = *info.m_node;
+	const Second startTime = HighRezTimer::getCurrentTime();
+	Error err = Error::NONE;
 
-	IntrusiveList<SceneNode>::ConstIterator end = m_nodes.getEnd();
+	auto markUpdated = [&](SceneComponent& comp) {
+		comp.setTimestamp(m_timestamp);
+		info.m_componentTimestamp = max(info.m_componentTimestamp, m_timestamp);
+		ANKI_ASSERT(info.m_componentTimestamp > 0);
+	};
 
-	Bool quit = false;
-	Error err = Error::NONE;
-	while(!quit && !err)
+	// Resuming after the MoveComponent got updated
+	if(info.m_moveRequest != MAX_U32 && moves[info.m_moveRequest].m_updated)
 	{
-		// Fetch a batch of scene nodes that don't have parent
-		Array<SceneNode*, NODE_UPDATE_BATCH> batch;
-		U batchSize = 0;
+		markUpdated(*moves[info.m_moveRequest].m_component);
+	}
 
+	// Components update
+	U32 compIdx = 0;
+	Bool stopped = false;
+	err = node.iterateComponents([&](SceneComponent& comp) -> Error {
+		if(stopped || compIdx++ < info.m_nextComponent)
 		{
-			LockGuard<SpinLock> lock(ctx.m_crntNodeLock);
+			return Error::NONE;
+		}
 
-			while(1)
-			{
-				if(batchSize == batch.getSize())
-				{
-					break;
-				}
-
-				if(ctx.m_crntNode == end)
-				{
-					quit = true;
-					break;
-				}
-
-				SceneNode& node = *ctx.m_crntNode;
-				if(node.getParent() == nullptr)
-				{
-					batch[batchSize++] = &node;
-				}
-
-				++ctx.m_crntNode;
-			}
+		Bool updated = false;
+		Error e = Error::NONE;
+		if(comp.getType() == SceneComponentType::MOVE && info.m_moveRequest == MAX_U32)
+		{
+			// Defer the update of the first MoveComponent and stop. The rest might depend on the world transform
+			info.m_moveRequest = moves.getSize();
+			MoveComponentUpdateRequest& request = *moves.emplaceBack();
+			request.m_node = &node;
+			request.m_component = static_cast<MoveComponent*>(&comp);
+
+			info.m_nextComponent = compIdx;
+			stopped = true;
+			return Error::NONE;
+		}
+		else if(comp.getType() == SceneComponentType::SPATIAL)
+		{
+			// Defer the update of the spatials and do them all together
+			SpatialComponent& sp = static_cast<SpatialComponent&>(comp);
+			updated = sp.isMarkedForUpdate();
+			spatials.emplaceBack(&sp);
+		}
+		else
+		{
+			e = comp.update(node, prevTime, crntTime, updated);
 		}
 
-		// Process nodes
-		for(U i = 0; i < batchSize && !err; ++i)
+		if(updated)
 		{
-			err = updateNode(ctx.m_prevUpdateTime, ctx.m_crntTime, *batch[i]);
+			markUpdated(comp);
 		}
+
+		return e;
+	});
+
+	// Frame update
+	if(!err && !stopped)
+	{
+		ANKI_TRACE_INC_COUNTER(SCENE_NODES_UPDATED, 1);
+		info.m_done = true;
+
+		// Clean it now and not before the update because the node itself might mark it
+		node.m_dirty.store(0);
+
+		if(info.m_componentTimestamp != 0)
+		{
+			node.setComponentMaxTimestamp(info.m_componentTimestamp);
+		}
+		else
+		{
+			// No components or nothing updated, don't change the timestamp
+		}
+
+		err = node.frameUpdate(prevTime, crntTime);
 	}
 
+	info.m_cost += HighRezTimer::getCurrentTime() - startTime;
+
 	return err;
 }
 
@@ -11,8 +11,12 @@
 #include <anki/util/Singleton.h>
 #include <anki/util/HighRezTimer.h>
 #include <anki/util/HashMap.h>
+#include <anki/util/WeakArray.h>
+#include <anki/util/Thread.h>
 #include <anki/core/App.h>
 #include <anki/scene/events/EventManager.h>
+#include <anki/scene/SectorStreamer.h>
+#include <anki/resource/Common.h>
 
 namespace anki
 {
@@ -24,8 +28,10 @@ class CameraNode;
 class Input;
 class ConfigSet;
 class PerspectiveCameraNode;
-class UpdateSceneNodesCtx;
 class Octree;
+class MoveComponentUpdateRequest;
+class SkinComponent;
+class ParticleEmitterNode;
 
 /// @addtogroup scene
 /// @{
@@ -37,6 +43,7 @@ public:
 	Second m_updateTime ANKI_DEBUG_CODE(= 0.0);
 	Second m_visibilityTestsTime ANKI_DEBUG_CODE(= 0.0);
 	Second m_physicsUpdate ANKI_DEBUG_CODE(= 0.0);
+	U32 m_updatedNodeCount ANKI_DEBUG_CODE(= 0); ///< The dynamic nodes and the static ones that were dirty.
 };
 
 /// SceneGraph limits.
@@ -46,6 +53,19 @@ public:
 	F32 m_earlyZDistance = -1.0f; ///< Objects with distance lower than that will be used in early Z.
 	F32 m_reflectionProbeEffectiveDistance = -1.0f; ///< How far reflection probes can look.
 	F32 m_reflectionProbeShadowEffectiveDistance = -1.0f; ///< How far to render shadows for reflection probes.
+	Bool m_gpuOcclusionCulling = false; ///< The renderer does the occlusion tests of the main camera's renderables.
+	Bool m_gpuSkinning = false; ///< The renderer evaluates the animations of the skins.
+	F32 m_animationLodDistance0 = -1.0f; ///< Skins farther than that are animated every 2 frames.
+	F32 m_animationLodDistance1 = -1.0f; ///< Skins farther than that are animated every 4 frames.
+	U32 m_animationLodMaxBoneDepth = MAX_U32; ///< How deep the bones of the last animation LOD are animated.
+	F32 m_physicsLodDistance0 = -1.0f; ///< Player controllers farther than that are updated every 2 physics steps.
+	F32 m_physicsLodDistance1 = -1.0f; ///< Dynamic bodies farther than that sleep. Controllers update every 4 steps.
+	F32 m_particleLodDistance0 = -1.0f; ///< GPU emitters farther than that emit at half the rate.
+	F32 m_particleLodDistance1 = -1.0f; ///< GPU emitters farther than that emit at a quarter of the rate.
+	Array<F32, MAX_LOD_COUNT - 1> m_lodScreenSizes = {}; ///< Renderables smaller than that switch to the next LOD.
+	F32 m_lodHysteresis = 0.0f; ///< The overshoot of the screen size, relative to the LOD thresholds.
+	U32 m_lodCrossFadeFrameCount = 0; ///< How many frames the LOD transitions last.
+	F32 m_transparencySortDistance = 0.0f; ///< The slices the transparent renderables are sorted in. 0 is exact.
 };
 
 /// The scene graph that  all the scene entities
@@ -53,6 +73,9 @@ class SceneGraph
 {
 	friend class SceneNode;
 	friend class UpdateSceneNodesTask;
+	friend class SkinComponent;
+	friend class ParticleEmitterNode;
+	friend class SectorStreamer;
 
 public:
 	SceneGraph();
@@ -106,7 +129,13 @@ public:
 
 	U32 getSceneNodesCount() const
 	{
-		return m_nodesCount;
+		return m_nodeHierarchy.getSize();
+	}
+
+	/// All the nodes in depth first order. The parents come before their children.
+	const FlatHierarchy<SceneNode>& getSceneNodeHierarchy() const
+	{
+		return m_nodeHierarchy;
 	}
 
 	EventManager& getEventManager()
@@ -118,6 +147,15 @@ public:
 		return m_events;
 	}
 
+	SectorStreamer& getSectorStreamer()
+	{
+		return m_sectors;
+	}
+	const SectorStreamer& getSectorStreamer() const
+	{
+		return m_sectors;
+	}
+
 	ThreadHive& getThreadHive()
 	{
 		return *m_threadHive;
@@ -130,13 +168,16 @@ public:
 	SceneNode& findSceneNode(const CString& name);
 	SceneNode* tryFindSceneNode(const CString& name);
 
-	/// Iterate the scene nodes using a lambda
+	SceneNode& findSceneNode(StringId name);
+	SceneNode* tryFindSceneNode(StringId name);
+
+	/// Iterate the scene nodes using a lambda. They are visited in depth first order.
 	template<typename Func>
 	ANKI_USE_RESULT Error iterateSceneNodes(Func func)
 	{
-		for(SceneNode& psn : m_nodes)
+		for(U32 i = 0; i < m_nodeHierarchy.getSize(); ++i)
 		{
-			Error err = func(psn);
+			Error err = func(m_nodeHierarchy[i]);
 			if(err)
 			{
 				return err;
@@ -154,6 +195,10 @@ public:
 	template<typename Node, typename... Args>
 	ANKI_USE_RESULT Error newSceneNode(const CString& name, Node*& node, Args&&... args);
 
+	/// Make room for many new nodes at once. Call it before creating lots of them to avoid growing the containers of the
+	/// scene many times.
+	void reserveNodes(U32 count);
+
 	/// Delete a scene node. It actualy marks it for deletion
 	void deleteSceneNode(SceneNode* node)
 	{
@@ -222,15 +267,31 @@ public:
 		return m_nodesUuid.fetchAdd(1);
 	}
 
+	/// The allocator of the scene components. Use it to get the per type statistics.
+	SceneObjectAllocator& getComponentAllocator()
+	{
+		return m_componentAlloc;
+	}
+
+	const SceneObjectAllocator& getComponentAllocator() const
+	{
+		return m_componentAlloc;
+	}
+
 	Octree& getOctree()
 	{
 		ANKI_ASSERT(m_octree);
 		return *m_octree;
 	}
 
-private:
-	class UpdateSceneNodesCtx;
+	/// The origin the distance of the animation, particle and physics LODs is measured from. It's the main camera's
+	/// position at the start of the update. It's safe to read it while updating.
+	const Vec3& getLodOrigin() const
+	{
+		return m_lodOrigin;
+	}
 
+private:
 	const Timestamp* m_globalTimestamp = nullptr;
 	Timestamp m_timestamp = 0; ///< Cached timestamp
 
@@ -244,10 +305,22 @@ private:
 
 	SceneAllocator<U8> m_alloc;
 	SceneFrameAllocator<U8> m_frameAlloc;
+	SceneObjectAllocator m_componentAlloc;
+
+	FlatHierarchy<SceneNode> m_nodeHierarchy; ///< All the registered nodes.
+	HashMap<StringId, SceneNode*> m_nodesDict;
 
-	IntrusiveList<SceneNode> m_nodes;
-	U32 m_nodesCount = 0;
-	HashMap<CString, SceneNode*> m_nodesDict;
+	DynamicArray<SceneNode*> m_dynamicNodes; ///< The nodes that are not static. They are updated every frame.
+	/// The static nodes that should be updated. A node is there once at most. It may have stale entries of nodes that
+	/// got updated after they were marked.
+	DynamicArray<SceneNode*> m_dirtyNodes;
+	SpinLock m_dirtyNodesMtx;
+
+	DynamicArray<SkinComponent*> m_gpuSkins; ///< The skins that are animated on the GPU.
+	SpinLock m_gpuSkinsMtx;
+
+	DynamicArray<ParticleEmitterNode*> m_particleEmitters; ///< The emitters that are simulated without physics.
+	SpinLock m_particleEmittersMtx;
 
 	SceneNode* m_mainCam = nullptr;
 	Timestamp m_activeCameraChangeTimestamp = 0;
@@ -255,11 +328,15 @@ private:
 
 	EventManager m_events;
 
+	SectorStreamer m_sectors;
+
 	Octree* m_octree = nullptr;
 
 	Vec3 m_sceneMin = {-1000.0f, -200.0f, -1000.0f};
 	Vec3 m_sceneMax = {1000.0f, 200.0f, 1000.0f};
 
+	Vec3 m_lodOrigin = Vec3(0.0f);
+
 	Atomic<U32> m_objectsMarkedForDeletionCount = {0};
 
 	Atomic<U64> m_nodesUuid = {1};
@@ -271,11 +348,66 @@ private:
 	ANKI_USE_RESULT Error registerNode(SceneNode* node);
 	void unregisterNode(SceneNode* node);
 
+	/// Called when a registered node gets a registered parent.
+	void onNodeParentChanged(SceneNode& node);
+
 	/// Delete the nodes that are marked for deletion
 	void deleteNodesMarkedForDeletion();
 
-	ANKI_USE_RESULT Error updateNodes(UpdateSceneNodesCtx& ctx) const;
-	ANKI_USE_RESULT static Error updateNode(Second prevTime, Second crntTime, SceneNode& node);
+	/// Called by SceneNode::markDirty.
+	void addDirtyNode(SceneNode& node);
+
+	/// Remove a node from the dirty nodes if it's there.
+	void removeDirtyNode(SceneNode& node);
+
+	/// Called by SceneNode::setStatic.
+	void onNodeStaticChanged(SceneNode& node);
+
+	/// Gather the nodes that will be updated this frame. Only the roots are gathered and the children are found while
+	/// updating.
+	void gatherUpdateRoots(DynamicArrayAuto<SceneNode*>& nodes);
+
+	/// Queue a node for update if it's dirty and it hasn't been queued already.
+	void tryQueueNodeForUpdate(SceneNode& node, DynamicArrayAuto<SceneNode*>& nodes);
+
+	/// Called by the SkinComponent.
+	void addGpuSkin(SkinComponent& skin);
+
+	/// Called by the SkinComponent.
+	void removeGpuSkin(SkinComponent& skin);
+
+	/// Grow the scene bounds to include a box. If they grow everything is taken out of the octree and it's placed again
+	/// in the next update. Called by the SectorStreamer.
+	void extendSceneBounds(const Vec3& min, const Vec3& max);
+
+	/// Called by the ParticleEmitterNode.
+	void addParticleEmitter(ParticleEmitterNode& emitter);
+
+	/// Called by the ParticleEmitterNode.
+	void removeParticleEmitter(ParticleEmitterNode& emitter);
+
+	/// Gather the GPU skinning jobs of all the GPU skins.
+	void gatherGpuSkinningJobs(RenderQueue& rqueue);
+
+	/// Update the nodes of a level of the hierarchy in parallel. The nodes of the previous levels should be updated.
+	void updateHierarchyLevel(Second prevTime, Second crntTime, WeakArray<SceneNode*> nodes);
+
+	ANKI_USE_RESULT Error updatePhysics(Second prevUpdateTime, Second crntTime);
+
+	class NodeUpdateInfo;
+
+	/// Update the components of a node but not its children. It stops at the first MoveComponent and then it should be
+	/// called again after the MoveComponent is updated to update the rest of the components and the node itself.
+	/// @param[in,out] info The progress of the update.
+	/// @param[in,out] moves The first MoveComponent is not updated in place. It's appended there and it should be
+	///                      updated with MoveComponent::updateBatch.
+	/// @param[in,out] spatials The spatial components are not updated in place. They are appended there and they should
+	///                         be updated with SpatialComponent::updateBatch.
+	ANKI_USE_RESULT Error updateNode(Second prevTime,
+		Second crntTime,
+		NodeUpdateInfo& info,
+		DynamicArrayAuto<MoveComponentUpdateRequest>& moves,
+		DynamicArrayAuto<SpatialComponent*>& spatials);
 
 	/// Do visibility tests.
 	static void doVisibilityTests(SceneNode& frustumable, SceneGraph& scene, RenderQueue& rqueue);
@@ -319,20 +451,15 @@ inline Error SceneGraph::newSceneNode(const CString& name, Node*& node, Args&&..
 template<typename Func>
 Error SceneGraph::iterateSceneNodes(PtrSize begin, PtrSize end, Func func)
 {
-	ANKI_ASSERT(begin < m_nodesCount && end <= m_nodesCount);
-	auto it = m_nodes.getBegin() + begin;
+	ANKI_ASSERT(begin < m_nodeHierarchy.getSize() && end <= m_nodeHierarchy.getSize());
 
-	PtrSize count = end - begin;
 	Error err = Error::NONE;
-	while(count-- != 0 && !err)
+	for(PtrSize i = begin; i < end && !err; ++i)
 	{
-		ANKI_ASSERT(it != m_nodes.getEnd());
-		err = func(*it);
-
-		++it;
+		err = func(m_nodeHierarchy[U32(i)]);
 	}
 
-	return Error::NONE;
+	return err;
 }
 /// @}
 
@@ -5,6 +5,7 @@
 
 #include <anki/scene/SceneNode.h>
 #include <anki/scene/SceneGraph.h>
+#include <anki/scene/components/MoveComponent.h>
 
 namespace anki
 {
@@ -12,11 +13,8 @@ namespace anki
 SceneNode::SceneNode(SceneGraph* scene, CString name)
 	: m_scene(scene)
 	, m_uuid(scene->getNewUuid())
+	, m_name(name)
 {
-	if(name)
-	{
-		m_name.create(getAllocator(), name);
-	}
 }
 
 SceneNode::~SceneNode()
@@ -28,14 +26,24 @@ SceneNode::~SceneNode()
 	for(; it != end; ++it)
 	{
 		SceneComponent* comp = *it;
-		alloc.deleteInstance(comp);
+		getComponentAllocator().deleteInstance(alloc, comp);
 	}
 
 	Base::destroy(alloc);
-	m_name.destroy(alloc);
 	m_components.destroy(alloc);
 }
 
+void SceneNode::addChild(SceneNode* obj)
+{
+	Base::addChild(getAllocator(), obj);
+
+	// If one of them isn't registered the registration will place them
+	if(m_registered && obj->m_registered)
+	{
+		m_scene->onNodeParentChanged(*obj);
+	}
+}
+
 void SceneNode::setMarkedForDeletion()
 {
 	// Mark for deletion only when it's not already marked because we don't want to increase the counter again
@@ -53,6 +61,31 @@ void SceneNode::setMarkedForDeletion()
 	(void)err;
 }
 
+void SceneNode::setStatic(Bool isStatic)
+{
+	if(isStatic != m_static)
+	{
+		m_static = isStatic;
+		m_scene->onNodeStaticChanged(*this);
+	}
+}
+
+void SceneNode::markDirty()
+{
+	if(m_static && m_dirty.exchange(1) == 0)
+	{
+		m_scene->addDirtyNode(*this);
+	}
+}
+
+void SceneNode::onComponentCreated(SceneComponent& comp)
+{
+	if(comp.getType() == SceneComponentType::MOVE)
+	{
+		static_cast<MoveComponent&>(comp).setSceneNode(this);
+	}
+}
+
 Timestamp SceneNode::getGlobalTimestamp() const
 {
 	return m_scene->getGlobalTimestamp();
@@ -64,6 +97,12 @@ SceneAllocator<U8> SceneNode::getAllocator() const
 	return m_scene->getAllocator();
 }
 
+SceneObjectAllocator& SceneNode::getComponentAllocator()
+{
+	ANKI_ASSERT(m_scene);
+	return m_scene->getComponentAllocator();
+}
+
 SceneFrameAllocator<U8> SceneNode::getFrameAllocator() const
 {
 	ANKI_ASSERT(m_scene);
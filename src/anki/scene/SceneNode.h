@@ -7,10 +7,13 @@
 
 #include <anki/scene/Common.h>
 #include <anki/util/Hierarchy.h>
+#include <anki/util/FlatHierarchy.h>
 #include <anki/util/BitMask.h>
 #include <anki/util/BitSet.h>
 #include <anki/util/List.h>
 #include <anki/util/Enum.h>
+#include <anki/util/StringId.h>
+#include <anki/util/Atomic.h>
 #include <anki/scene/components/SceneComponent.h>
 
 namespace anki
@@ -23,11 +26,16 @@ class ResourceManager;
 /// @{
 
 /// Interface class backbone of scene
-class SceneNode : public Hierarchy<SceneNode>, public IntrusiveListEnabled<SceneNode>
+class SceneNode : public Hierarchy<SceneNode>, public FlatHierarchyEnabled<SceneNode>
 {
+	friend class SceneGraph;
+
 public:
 	using Base = Hierarchy<SceneNode>;
 
+	/// A node whose components weren't updated for that many frames is resting. The shadows cache the resting casters.
+	static constexpr Timestamp COMPONENT_REST_FRAME_COUNT = 8;
+
 	/// The one and only constructor.
 	/// @param scene The owner scene.
 	/// @param name The unique name of the node. If it's empty the the node is not searchable.
@@ -49,7 +57,13 @@ public:
 	/// Return the name. It may be empty for nodes that we don't want to track
 	CString getName() const
 	{
-		return (!m_name.isEmpty()) ? m_name.toCString() : CString();
+		return m_name.toCString();
+	}
+
+	/// Return the interned name. It may be empty.
+	StringId getNameId() const
+	{
+		return m_name;
 	}
 
 	U64 getUuid() const
@@ -74,18 +88,58 @@ public:
 	void setComponentMaxTimestamp(Timestamp maxComponentTimestamp)
 	{
 		ANKI_ASSERT(maxComponentTimestamp > 0);
+		if(maxComponentTimestamp - m_maxComponentTimestamp >= COMPONENT_REST_FRAME_COUNT)
+		{
+			m_componentWakeTimestamp = maxComponentTimestamp;
+		}
 		m_maxComponentTimestamp = maxComponentTimestamp;
 	}
 
-	SceneAllocator<U8> getAllocator() const;
+	/// The timestamp of the first component update after the node had been resting for COMPONENT_REST_FRAME_COUNT
+	/// frames. The shadows use it to find when a caster they cached as static starts moving.
+	Timestamp getComponentWakeTimestamp() const
+	{
+		return m_componentWakeTimestamp;
+	}
 
-	SceneFrameAllocator<U8> getFrameAllocator() const;
+	/// The time it took to update the components of the node and call frameUpdate() the last time. The children are not
+	/// included. The SceneGraph uses it to balance the load of the update threads.
+	Second getUpdateCost() const
+	{
+		return m_updateCost;
+	}
+
+	void setUpdateCost(Second cost)
+	{
+		ANKI_ASSERT(cost >= 0.0);
+		m_updateCost = cost;
+	}
+
+	/// Make the node static or not. A static node is not updated every frame. It's updated only in the frames it's
+	/// marked dirty. Moving it through its MoveComponent marks it dirty. Anything else should call markDirty(). Don't
+	/// call it while the scene is updating.
+	void setStatic(Bool isStatic);
+
+	Bool isStatic() const
+	{
+		return m_static;
+	}
+
+	/// Update a static node in the next SceneGraph::update. It does nothing for dynamic nodes. It's thread-safe.
+	void markDirty();
 
-	void addChild(SceneNode* obj)
+	/// A dynamic node or a static one that is marked dirty will be updated in the next SceneGraph::update.
+	Bool isDirty() const
 	{
-		Base::addChild(getAllocator(), obj);
+		return !m_static || m_dirty.load() != 0;
 	}
 
+	SceneAllocator<U8> getAllocator() const;
+
+	SceneFrameAllocator<U8> getFrameAllocator() const;
+
+	void addChild(SceneNode* obj);
+
 	/// This is called by the scene every frame after logic and before rendering. By default it does nothing.
 	/// @param prevUpdateTime Timestamp of the previous update
 	/// @param crntTime Timestamp of this update
@@ -206,8 +260,10 @@ protected:
 	template<typename TComponent, typename... TArgs>
 	TComponent* newComponent(TArgs&&... args)
 	{
-		TComponent* comp = getAllocator().newInstance<TComponent>(std::forward<TArgs>(args)...);
-		m_components.emplaceBack(getAllocator(), comp);
+		SceneAllocator<U8> alloc = getAllocator();
+		TComponent* comp = getComponentAllocator().newInstance<TComponent>(alloc, std::forward<TArgs>(args)...);
+		m_components.emplaceBack(alloc, comp);
+		onComponentCreated(*comp);
 		return comp;
 	}
 
@@ -216,13 +272,28 @@ protected:
 private:
 	SceneGraph* m_scene = nullptr;
 	U64 m_uuid;
-	String m_name; ///< A unique name
+	StringId m_name; ///< A unique name
 
 	DynamicArray<SceneComponent*> m_components;
 
 	Timestamp m_maxComponentTimestamp = 0;
+	Timestamp m_componentWakeTimestamp = 0;
+
+	Second m_updateCost = 0.0;
 
 	Bool m_markedForDeletion = false;
+
+	Bool m_registered = false; ///< It's registered to the SceneGraph.
+	Bool m_static = false;
+	Atomic<U32> m_dirty = {0};
+	U32 m_dynamicNodeIdx = MAX_U32; ///< Index in the dynamic nodes of the SceneGraph.
+	U32 m_dirtyNodeIdx = MAX_U32; ///< Index in the dirty nodes of the SceneGraph.
+	Timestamp m_updateQueuedTimestamp = 0; ///< When it was last queued for update.
+
+	SceneObjectAllocator& getComponentAllocator();
+
+	/// Connect some components to the node.
+	void onComponentCreated(SceneComponent& comp);
 };
 /// @}
 
@@ -0,0 +1,442 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/scene/SectorStreamer.h>
+#include <anki/scene/SceneGraph.h>
+#include <anki/scene/ModelNode.h>
+#include <anki/scene/StaticCollisionNode.h>
+#include <anki/scene/components/MoveComponent.h>
+#include <anki/resource/ResourceManager.h>
+#include <anki/resource/ResourceFilesystem.h>
+#include <anki/resource/AsyncLoader.h>
+#include <anki/core/ConfigSet.h>
+#include <anki/util/Xml.h>
+#include <anki/util/HighRezTimer.h>
+#include <anki/util/Tracer.h>
+#include <algorithm>
+
+namespace anki
+{
+
+/// Reads and parses the file of a sector in the AsyncLoader thread.
+class SectorReadTask : public AsyncLoaderTask
+{
+public:
+	SectorStreamer::Sector* m_sector = nullptr;
+	ResourceFilePtr m_file;
+	SceneAllocator<U8> m_sceneAlloc;
+	HeapAllocator<U8> m_tmpAlloc;
+
+	Error operator()(AsyncLoaderTaskContext& ctx) final
+	{
+		SectorStreamer::Sector& sector = *m_sector;
+
+		const Error err = read();
+		m_file.reset(nullptr);
+
+		if(err)
+		{
+			ANKI_SCENE_LOGE("Failed to read sector: %s", &sector.m_filename[0]);
+
+			// It goes straight to the unloading so the main thread cleans it up and gives its memory back
+			sector.m_readFailed = true;
+			sector.m_state.store(U8(SectorState::UNLOADING));
+		}
+		else
+		{
+			sector.m_state.store(U8(SectorState::INSTANTIATING));
+		}
+
+		// Don't stop the loader for a broken sector
+		return Error::NONE;
+	}
+
+private:
+	Error read()
+	{
+		SectorStreamer::Sector& sector = *m_sector;
+
+		StringAuto txt(m_tmpAlloc);
+		ANKI_CHECK(m_file->readAllText(txt));
+
+		XmlDocument doc;
+		ANKI_CHECK(doc.parse(txt.toCString(), m_tmpAlloc));
+
+		XmlElement rootEl;
+		ANKI_CHECK(doc.getChildElement("sector", rootEl));
+
+		XmlElement nodesEl;
+		ANKI_CHECK(rootEl.getChildElementOptional("nodes", nodesEl));
+		if(!nodesEl)
+		{
+			return Error::NONE;
+		}
+
+		XmlElement nodeEl;
+		ANKI_CHECK(nodesEl.getChildElement("node", nodeEl));
+
+		U32 count = 0;
+		ANKI_CHECK(nodeEl.getSiblingElementsCount(count));
+		++count;
+		sector.m_nodeInfos.create(m_sceneAlloc, count);
+
+		count = 0;
+		do
+		{
+			SectorStreamer::NodeInfo& info = sector.m_nodeInfos[count++];
+
+			// type
+			CString type;
+			ANKI_CHECK(nodeEl.getAttributeText("type", type));
+			if(type == "model")
+			{
+				info.m_collision = false;
+			}
+			else if(type == "staticCollision")
+			{
+				info.m_collision = true;
+			}
+			else
+			{
+				ANKI_SCENE_LOGE("Unknown node type: %s", &type[0]);
+				return Error::USER_DATA;
+			}
+
+			// file
+			CString fname;
+			ANKI_CHECK(nodeEl.getAttributeText("file", fname));
+			info.m_filename.create(m_sceneAlloc, fname);
+
+			// name
+			CString name;
+			Bool present;
+			ANKI_CHECK(nodeEl.getAttributeTextOptional("name", name, present));
+			if(present && name)
+			{
+				info.m_name.create(m_sceneAlloc, name);
+			}
+
+			// position
+			Vec3 pos(0.0f);
+			ANKI_CHECK(nodeEl.getAttributeNumbersOptional("position", pos, present));
+
+			// rotation
+			Vec4 rot(0.0f, 0.0f, 0.0f, 1.0f);
+			ANKI_CHECK(nodeEl.getAttributeNumbersOptional("rotation", rot, present));
+
+			// scale
+			F32 scale = 1.0f;
+			ANKI_CHECK(nodeEl.getAttributeNumberOptional("scale", scale, present));
+
+			info.m_transform = Transform(pos.xyz0(), Mat3x4(Quat(rot.getNormalized())), scale);
+
+			ANKI_CHECK(nodeEl.getNextSiblingElement("node", nodeEl));
+		} while(nodeEl);
+
+		return Error::NONE;
+	}
+};
+
+SectorStreamer::SectorStreamer()
+{
+}
+
+SectorStreamer::~SectorStreamer()
+{
+	if(m_scene == nullptr)
+	{
+		return;
+	}
+
+	// The nodes belong to the scene and it deletes them
+	waitReads();
+
+	for(Sector* sector : m_sectors)
+	{
+		freeNodeInfos(*sector);
+		sector->m_nodes.destroy(getAllocator());
+		sector->m_filename.destroy(getAllocator());
+		getAllocator().deleteInstance(sector);
+	}
+
+	m_sectors.destroy(getAllocator());
+	m_sortedSectors.destroy(getAllocator());
+}
+
+Error SectorStreamer::init(SceneGraph* scene, const ConfigSet& config)
+{
+	ANKI_ASSERT(scene);
+	m_scene = scene;
+
+	m_loadDistance = config.getNumberF32("scene_streamingLoadDistance");
+	m_unloadDistance = max(m_loadDistance, config.getNumberF32("scene_streamingUnloadDistance"));
+	m_memoryBudget = PtrSize(config.getNumberU32("scene_streamingMemoryBudget")) * 1024 * 1024;
+	m_frameTimeBudget = config.getNumberF64("scene_streamingFrameTimeBudget") / 1000.0;
+
+	return Error::NONE;
+}
+
+SceneAllocator<U8> SectorStreamer::getAllocator() const
+{
+	return m_scene->getAllocator();
+}
+
+Error SectorStreamer::newSector(CString filename, const Aabb& bounds, PtrSize memorySize)
+{
+	ANKI_ASSERT(m_scene);
+	ANKI_ASSERT(filename);
+
+	if(memorySize > m_memoryBudget)
+	{
+		ANKI_SCENE_LOGW("Sector doesn't fit in the memory budget. It will never be loaded: %s", &filename[0]);
+	}
+
+	Sector* sector = getAllocator().newInstance<Sector>();
+	sector->m_filename.create(getAllocator(), filename);
+	sector->m_bounds = bounds;
+	sector->m_memorySize = memorySize;
+
+	m_sectors.emplaceBack(getAllocator(), sector);
+	m_sortedSectors.emplaceBack(getAllocator(), sector);
+
+	m_scene->extendSceneBounds(bounds.getMin().xyz(), bounds.getMax().xyz());
+
+	return Error::NONE;
+}
+
+Error SectorStreamer::startReading(Sector& sector)
+{
+	ANKI_ASSERT(SectorState(sector.m_state.load()) == SectorState::UNLOADED);
+
+	// The filesystem is not thread-safe so open the file here. The loader reads it
+	ResourceManager& resources = m_scene->getResourceManager();
+	AsyncLoader& loader = resources.getAsyncLoader();
+	SectorReadTask* task = loader.newTask<SectorReadTask>();
+
+	const Error err = resources.getFilesystem().openFile(sector.m_filename.toCString(), task->m_file);
+	if(err)
+	{
+		ANKI_SCENE_LOGE("Failed to open sector: %s", &sector.m_filename[0]);
+		loader.getAllocator().deleteInstance(task);
+		return err;
+	}
+
+	task->m_sector = &sector;
+	task->m_sceneAlloc = getAllocator();
+	task->m_tmpAlloc = loader.getAllocator();
+
+	sector.m_state.store(U8(SectorState::READING));
+	loader.submitTask(task);
+
+	return Error::NONE;
+}
+
+Error SectorStreamer::instantiateNode(Sector& sector)
+{
+	ANKI_ASSERT(sector.m_nodeCount < sector.m_nodeInfos.getSize());
+	const NodeInfo& info = sector.m_nodeInfos[sector.m_nodeCount];
+	const CString name = (info.m_name.isEmpty()) ? CString() : info.m_name.toCString();
+
+	SceneNode* node;
+	if(info.m_collision)
+	{
+		StaticCollisionNode* collision;
+		ANKI_CHECK(m_scene->newSceneNode(name, collision, info.m_filename.toCString(), info.m_transform));
+		node = collision;
+	}
+	else
+	{
+		// The resources load asynchronously so that part is cheap
+		ModelNode* model;
+		ANKI_CHECK(m_scene->newSceneNode(name, model, info.m_filename.toCString()));
+		model->getComponent<MoveComponent>().setLocalTransform(info.m_transform);
+		node = model;
+	}
+
+	// Nothing in the sectors moves so don't update them every frame
+	node->setStatic(true);
+	ANKI_CHECK(node->visitChildren([](SceneNode& child) -> Error {
+		child.setStatic(true);
+		return Error::NONE;
+	}));
+
+	sector.m_nodes[sector.m_nodeCount++] = node;
+
+	return Error::NONE;
+}
+
+void SectorStreamer::deleteNode(Sector& sector)
+{
+	ANKI_ASSERT(sector.m_nodeCount > 0);
+	SceneNode* node = sector.m_nodes[--sector.m_nodeCount];
+	sector.m_nodes[sector.m_nodeCount] = nullptr;
+
+	// It also deletes the children
+	m_scene->deleteSceneNode(node);
+}
+
+void SectorStreamer::freeNodeInfos(Sector& sector)
+{
+	for(NodeInfo& info : sector.m_nodeInfos)
+	{
+		info.m_name.destroy(getAllocator());
+		info.m_filename.destroy(getAllocator());
+	}
+
+	sector.m_nodeInfos.destroy(getAllocator());
+}
+
+void SectorStreamer::waitReads()
+{
+	for(Sector* sector : m_sectors)
+	{
+		while(SectorState(sector->m_state.load()) == SectorState::READING)
+		{
+			HighRezTimer::sleep(1.0 / 1000.0);
+		}
+	}
+}
+
+Error SectorStreamer::update(const Vec3& cameraPos)
+{
+	if(m_sectors.getSize() == 0)
+	{
+		return Error::NONE;
+	}
+
+	ANKI_TRACE_SCOPED_EVENT(SCENE_SECTOR_STREAMING);
+	const Second deadline = HighRezTimer::getCurrentTime() + m_frameTimeBudget;
+
+	// Sort the sectors by their distance to the camera
+	for(Sector* sector : m_sortedSectors)
+	{
+		const Vec3 closest = cameraPos.max(sector->m_bounds.getMin().xyz()).min(sector->m_bounds.getMax().xyz());
+		sector->m_distance = (closest - cameraPos).getLength();
+	}
+
+	std::sort(m_sortedSectors.getBegin(), m_sortedSectors.getEnd(), [](const Sector* a, const Sector* b) {
+		return a->m_distance < b->m_distance;
+	});
+
+	// Decide what should change. Between the load and unload distances the sectors stay as they are so the camera can't
+	// make them flicker
+	for(Sector* sector : m_sortedSectors)
+	{
+		const SectorState state = SectorState(sector->m_state.load());
+
+		if(sector->m_distance > m_unloadDistance
+			&& (state == SectorState::INSTANTIATING || state == SectorState::LOADED))
+		{
+			sector->m_state.store(U8(SectorState::UNLOADING));
+		}
+		else if(sector->m_distance <= m_loadDistance && state == SectorState::UNLOADING && !sector->m_readFailed)
+		{
+			// Came back before it was gone. Continue from the nodes that are still alive
+			sector->m_state.store(U8(SectorState::INSTANTIATING));
+		}
+	}
+
+	// Unload the farthest sectors first. That gives memory back to the ones that wait for loading. Always delete a node
+	// or the sectors might never unload if the budget is too tight
+	Bool workDone = false;
+	for(U32 i = m_sortedSectors.getSize(); i-- > 0;)
+	{
+		Sector& sector = *m_sortedSectors[i];
+		if(SectorState(sector.m_state.load()) != SectorState::UNLOADING)
+		{
+			continue;
+		}
+
+		while(sector.m_nodeCount > 0 && (!workDone || HighRezTimer::getCurrentTime() < deadline))
+		{
+			deleteNode(sector);
+			workDone = true;
+		}
+
+		if(sector.m_nodeCount == 0)
+		{
+			freeNodeInfos(sector);
+			sector.m_nodes.destroy(getAllocator());
+			sector.m_state.store(U8(SectorState::UNLOADED));
+
+			ANKI_ASSERT(m_stats.m_loadedMemory >= sector.m_memorySize && m_stats.m_loadedSectorCount > 0);
+			m_stats.m_loadedMemory -= sector.m_memorySize;
+			--m_stats.m_loadedSectorCount;
+		}
+	}
+
+	// Load the nearest sectors first
+	m_stats.m_sectorsWaitingForMemoryCount = 0;
+	workDone = false;
+	for(Sector* sector : m_sortedSectors)
+	{
+		if(sector->m_distance > m_loadDistance)
+		{
+			break;
+		}
+
+		const SectorState state = SectorState(sector->m_state.load());
+		if(state == SectorState::UNLOADED && !sector->m_readFailed)
+		{
+			if(m_stats.m_loadedMemory + sector->m_memorySize > m_memoryBudget)
+			{
+				++m_stats.m_sectorsWaitingForMemoryCount;
+				continue;
+			}
+
+			ANKI_CHECK(startReading(*sector));
+			m_stats.m_loadedMemory += sector->m_memorySize;
+			++m_stats.m_loadedSectorCount;
+		}
+		else if(state == SectorState::INSTANTIATING)
+		{
+			if(sector->m_nodes.getSize() != sector->m_nodeInfos.getSize())
+			{
+				sector->m_nodes.create(getAllocator(), sector->m_nodeInfos.getSize(), nullptr);
+			}
+
+			while(sector->m_nodeCount < sector->m_nodeInfos.getSize()
+				  && (!workDone || HighRezTimer::getCurrentTime() < deadline))
+			{
+				ANKI_CHECK(instantiateNode(*sector));
+				workDone = true;
+			}
+
+			if(sector->m_nodeCount == sector->m_nodeInfos.getSize())
+			{
+				sector->m_state.store(U8(SectorState::LOADED));
+			}
+		}
+	}
+
+	return Error::NONE;
+}
+
+void SectorStreamer::unloadAll()
+{
+	waitReads();
+
+	for(Sector* sector : m_sectors)
+	{
+		if(SectorState(sector->m_state.load()) == SectorState::UNLOADED)
+		{
+			continue;
+		}
+
+		while(sector->m_nodeCount > 0)
+		{
+			deleteNode(*sector);
+		}
+
+		freeNodeInfos(*sector);
+		sector->m_nodes.destroy(getAllocator());
+		sector->m_state.store(U8(SectorState::UNLOADED));
+	}
+
+	m_stats.m_loadedMemory = 0;
+	m_stats.m_loadedSectorCount = 0;
+}
+
+} // end namespace anki
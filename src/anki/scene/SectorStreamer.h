@@ -0,0 +1,156 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/scene/Common.h>
+#include <anki/collision/Aabb.h>
+#include <anki/Math.h>
+#include <anki/util/DynamicArray.h>
+#include <anki/util/String.h>
+#include <anki/util/Atomic.h>
+
+namespace anki
+{
+
+// Forward
+class ConfigSet;
+
+/// @addtogroup scene
+/// @{
+
+/// The state of a Sector.
+enum class SectorState : U8
+{
+	UNLOADED,
+	READING, ///< The AsyncLoader reads and parses the file of the sector.
+	INSTANTIATING, ///< The nodes are created a few at a time.
+	LOADED,
+	UNLOADING, ///< The nodes are deleted a few at a time.
+};
+
+/// The statistics of the SectorStreamer.
+class SectorStreamerStats
+{
+public:
+	PtrSize m_loadedMemory = 0; ///< The memory the sectors that are not unloaded claim they need.
+	U32 m_loadedSectorCount = 0;
+	U32 m_sectorsWaitingForMemoryCount = 0; ///< In load distance but they don't fit in the memory budget.
+};
+
+/// Streams parts of the world (sectors) in and out of the scene depending on where the main camera is. A sector is an
+/// XML file with the nodes that live in a box of the world. The AsyncLoader reads and parses the file and then the
+/// nodes and their resources are created a few at a time, within a time budget every frame. The sectors that are near
+/// the camera are loaded first and only if they fit in the memory budget.
+///
+/// XML file format:
+/// @code
+/// <sector>
+/// 	<nodes>
+/// 		<node type="model|staticCollision" file="path/to/resource" [name="name"]
+/// 			[position="x y z"] [rotation="x y z w"] [scale="1.0"]/>
+/// 		...
+/// 	</nodes>
+/// </sector>
+/// @endcode
+///
+/// @note The streamer owns the nodes of the sectors. Don't delete them by hand.
+class SectorStreamer
+{
+	friend class SectorReadTask;
+
+public:
+	SectorStreamer();
+
+	~SectorStreamer();
+
+	ANKI_USE_RESULT Error init(SceneGraph* scene, const ConfigSet& config);
+
+	/// Register a sector. Its nodes will be created when the camera comes near. The scene bounds grow to hold it.
+	/// @param filename The sector file.
+	/// @param bounds The box that holds all the nodes of the sector.
+	/// @param memorySize The memory the sector needs when it's loaded. Usually the exporter estimates it from the size
+	///                   of the assets.
+	ANKI_USE_RESULT Error newSector(CString filename, const Aabb& bounds, PtrSize memorySize);
+
+	/// Load and unload sectors. The SceneGraph calls it at the start of the update.
+	ANKI_USE_RESULT Error update(const Vec3& cameraPos);
+
+	/// Unload all the sectors at once.
+	void unloadAll();
+
+	const SectorStreamerStats& getStats() const
+	{
+		return m_stats;
+	}
+
+	U32 getSectorCount() const
+	{
+		return m_sectors.getSize();
+	}
+
+	SectorState getSectorState(U32 sector) const
+	{
+		return SectorState(m_sectors[sector]->m_state.load());
+	}
+
+private:
+	/// A node of a sector as it's described in the file.
+	class NodeInfo
+	{
+	public:
+		String m_name;
+		String m_filename;
+		Transform m_transform = Transform::getIdentity();
+		Bool m_collision = false; ///< It's a StaticCollisionNode, otherwise it's a ModelNode.
+	};
+
+	class Sector
+	{
+	public:
+		String m_filename;
+		Aabb m_bounds;
+		PtrSize m_memorySize = 0;
+
+		Atomic<U8> m_state = {U8(SectorState::UNLOADED)}; ///< The loader thread moves it out of READING.
+		Bool m_readFailed = false; ///< Written by the loader thread before it leaves the READING state. Never retried.
+
+		DynamicArray<NodeInfo> m_nodeInfos;
+		DynamicArray<SceneNode*> m_nodes;
+		U32 m_nodeCount = 0; ///< How many nodes are alive.
+
+		F32 m_distance = 0.0f; ///< From the camera. Cached.
+	};
+
+	SceneGraph* m_scene = nullptr;
+	DynamicArray<Sector*> m_sectors;
+	DynamicArray<Sector*> m_sortedSectors; ///< Sectors sorted by distance. Cached to avoid allocations.
+
+	F32 m_loadDistance = 0.0f;
+	F32 m_unloadDistance = 0.0f;
+	PtrSize m_memoryBudget = 0;
+	Second m_frameTimeBudget = 0.0;
+
+	SectorStreamerStats m_stats;
+
+	SceneAllocator<U8> getAllocator() const;
+
+	/// Start reading the file of a sector in the AsyncLoader.
+	ANKI_USE_RESULT Error startReading(Sector& sector);
+
+	/// Create the next node of a sector.
+	ANKI_USE_RESULT Error instantiateNode(Sector& sector);
+
+	/// Delete the last node of a sector.
+	void deleteNode(Sector& sector);
+
+	void freeNodeInfos(Sector& sector);
+
+	/// Wait for the sectors that the AsyncLoader reads.
+	void waitReads();
+};
+/// @}
+
+} // end namespace anki
@@ -11,6 +11,10 @@
 namespace anki
 {
 
+/// The x offsets of the pixel centers of a tile row.
+alignas(32) static const Array<F32, SoftwareRasterizer::TILE_SIZE> TILE_ROW_OFFSETS = {
+	{0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f}};
+
 void SoftwareRasterizer::prepare(const Mat4& mv, const Mat4& p, U32 width, U32 height)
 {
 	m_mv = mv;
@@ -22,15 +26,51 @@ void SoftwareRasterizer::prepare(const Mat4& mv, const Mat4& p, U32 width, U32 h
 
 	// Reset z buffer
 	ANKI_ASSERT(width > 0 && height > 0);
+	ANKI_ASSERT(width <= MAX_U16 && height <= MAX_U16);
 	m_width = width;
 	m_height = height;
-	U32 size = width * height;
+	m_tileCountX = (width + TILE_SIZE - 1) / TILE_SIZE;
+	m_tileCountY = (height + TILE_SIZE - 1) / TILE_SIZE;
+
+	const U32 pitch = getPitch();
+	const U32 size = pitch * m_tileCountY * TILE_SIZE;
 	if(m_zbuffer.getSize() < size)
 	{
 		m_zbuffer.destroy(m_alloc);
 		m_zbuffer.create(m_alloc, size);
 	}
-	memset(&m_zbuffer[0], 0xFF, sizeof(m_zbuffer[0]) * size);
+
+	for(U32 y = 0; y < m_tileCountY * TILE_SIZE; ++y)
+	{
+		F32* row = &m_zbuffer[y * pitch];
+		const U32 farCount = (y < height) ? width : 0;
+		std::fill(row, row + farCount, 1.0f);
+		std::fill(row + farCount, row + pitch, 0.0f);
+	}
+
+	const U32 tileCount = getTileCount();
+	if(m_tileMaxDepths.getSize() < tileCount)
+	{
+		m_tileMaxDepths.destroy(m_alloc);
+		m_tileMaxDepths.create(m_alloc, tileCount);
+
+		m_tileBinOffsets.destroy(m_alloc);
+		m_tileBinOffsets.create(m_alloc, tileCount + 1);
+	}
+	std::fill(m_tileMaxDepths.getBegin(), m_tileMaxDepths.getBegin() + tileCount, 1.0f);
+
+	// Forget the triangles
+	m_triangleCount = 0;
+}
+
+/// Find where an edge of a triangle that crosses a plane meets the plane.
+static Vec4 intersectEdge(const Plane& plane, const Vec4& inside, const Vec4& outside)
+{
+	const F32 insideDist = testPlane(plane, inside.xyz0());
+	const F32 outsideDist = testPlane(plane, outside.xyz0());
+	ANKI_ASSERT(insideDist > 0.0f && outsideDist <= insideDist);
+	const F32 t = insideDist / (insideDist - outsideDist);
+	return (inside.xyz() + (outside.xyz() - inside.xyz()) * t).xyz1();
 }
 
 void SoftwareRasterizer::clipTriangle(const Vec4* inVerts, Vec4* outVerts, U& outVertCount) const
@@ -84,27 +124,14 @@ void SoftwareRasterizer::clipTriangle(const Vec4* inVerts, Vec4* outVerts, U& ou
 			prev = 1;
 		}
 
-		// Find first intersection
-		Vec4 rayOrigin = inVerts[i].xyz0();
-		Vec4 rayDir = (inVerts[next].xyz0() - rayOrigin).getNormalized();
-
-		Vec4 intersection0;
-		Bool intersects = testCollision(plane, Ray(rayOrigin, rayDir), intersection0);
-		(void)intersects;
-		ANKI_ASSERT(intersects);
-
-		// Find second intersection
-		rayDir = (inVerts[prev].xyz0() - rayOrigin).getNormalized();
-
-		Vec4 intersection1;
-		intersects = testCollision(plane, Ray(rayOrigin, rayDir), intersection1);
-		(void)intersects;
-		ANKI_ASSERT(intersects);
+		// Find the intersections
+		const Vec4 intersection0 = intersectEdge(plane, inVerts[i], inVerts[next]);
+		const Vec4 intersection1 = intersectEdge(plane, inVerts[i], inVerts[prev]);
 
 		// Finalize
 		outVerts[0] = inVerts[i];
-		outVerts[1] = intersection0.xyz1();
-		outVerts[2] = intersection1.xyz1();
+		outVerts[1] = intersection0;
+		outVerts[2] = intersection1;
 		outVertCount = 3;
 
 		break;
@@ -132,23 +159,9 @@ void SoftwareRasterizer::clipTriangle(const Vec4* inVerts, Vec4* outVerts, U& ou
 			out = 1;
 		}
 
-		// Find first intersection
-		Vec4 rayOrigin = inVerts[in1].xyz0();
-		Vec4 rayDir = (inVerts[out].xyz0() - rayOrigin).getNormalized();
-
-		Vec4 intersection0;
-		Bool intersects = testCollision(plane, Ray(rayOrigin, rayDir), intersection0);
-		(void)intersects;
-		ANKI_ASSERT(intersects);
-
-		// Find second intersection
-		rayOrigin = inVerts[in0].xyz0();
-		rayDir = (inVerts[out].xyz0() - rayOrigin).getNormalized();
-
-		Vec4 intersection1;
-		intersects = testCollision(plane, Ray(rayOrigin, rayDir), intersection1);
-		(void)intersects;
-		ANKI_ASSERT(intersects);
+		// Find the intersections
+		const Vec4 intersection0 = intersectEdge(plane, inVerts[in1], inVerts[out]);
+		const Vec4 intersection1 = intersectEdge(plane, inVerts[in0], inVerts[out]);
 
 		// Two triangles
 		outVerts[0] = inVerts[in1];
@@ -169,6 +182,11 @@ void SoftwareRasterizer::draw(const F32* verts, U vertCount, U stride, Bool back
 	ANKI_ASSERT(verts && vertCount > 0 && (vertCount % 3) == 0);
 	ANKI_ASSERT(stride >= sizeof(F32) * 3 && (stride % sizeof(F32)) == 0);
 
+	// Keep the triangles locally and store them in batches to lock less
+	constexpr U32 BATCH_SIZE = 64;
+	Array<Triangle, BATCH_SIZE> batch;
+	U32 batchCount = 0;
+
 	U floatStride = stride / sizeof(F32);
 	const F32* vertsEnd = verts + vertCount * floatStride;
 	while(verts != vertsEnd)
@@ -204,7 +222,7 @@ void SoftwareRasterizer::draw(const F32* verts, U vertCount, U stride, Bool back
 			continue;
 		}
 
-		// Rasterize
+		// Setup for rasterization
 		Array<Vec4, 3> clip;
 		for(U j = 0; j < clippedCount; j += 3)
 		{
@@ -214,87 +232,277 @@ void SoftwareRasterizer::draw(const F32* verts, U vertCount, U stride, Bool back
 				ANKI_ASSERT(clip[k].w() > 0.0f);
 			}
 
-			rasterizeTriangle(&clip[0]);
+			if(setupTriangle(&clip[0], batch[batchCount]))
+			{
+				++batchCount;
+				if(batchCount == BATCH_SIZE)
+				{
+					storeTriangles(&batch[0], batchCount);
+					batchCount = 0;
+				}
+			}
 		}
 	}
+
+	storeTriangles(&batch[0], batchCount);
 }
 
-Bool SoftwareRasterizer::computeBarycetrinc(const Vec2& a, const Vec2& b, const Vec2& c, const Vec2& p, Vec3& uvw) const
+Bool SoftwareRasterizer::setupTriangle(const Vec4* tri, Triangle& out) const
 {
-	Vec2 dca = c - a;
-	Vec2 dba = b - a;
-	Vec2 dap = a - p;
+	ANKI_ASSERT(tri);
 
-	Vec3 n(dca.x(), dba.x(), dap.x());
-	Vec3 m(dca.y(), dba.y(), dap.y());
+	const Vec2 windowSize{F32(m_width), F32(m_height)};
+	Array<Vec2, 3> window;
+	Vec3 depth;
+	Vec2 bboxMin(MAX_F32), bboxMax(MIN_F32);
+	for(U i = 0; i < 3; i++)
+	{
+		const Vec3 ndc = tri[i].xyz() / tri[i].w();
+		window[i] = (ndc.xy() / 2.0f + 0.5f) * windowSize;
+		depth[i] = ndc.z();
 
-	Vec3 k = n.cross(m);
+		bboxMin = bboxMin.min(window[i]);
+		bboxMax = bboxMax.max(window[i]);
+	}
 
-	Bool skip = false;
-	if(!isZero(k.z()))
+	// The bounding rect of the pixels
+	for(U i = 0; i < 2; ++i)
 	{
-		uvw = Vec3(1.0f - (k.x() + k.y()) / k.z(), k.y() / k.z(), k.x() / k.z());
-
-		if(uvw.x() < 0.0f || uvw.y() < 0.0f || uvw.z() < 0.0f)
+		const F32 rectMin = min(max(std::floor(bboxMin[i]), 0.0f), windowSize[i]);
+		const F32 rectMax = min(max(std::ceil(bboxMax[i]), 0.0f), windowSize[i]);
+		if(rectMin >= rectMax)
 		{
-			skip = true;
+			return false;
 		}
+
+		out.m_min[i] = U16(rectMin);
+		out.m_max[i] = U16(rectMax);
+	}
+
+	// Make it counter clockwise
+	auto edge = [](const Vec2& a, const Vec2& b, const Vec2& p) {
+		return (b.x() - a.x()) * (p.y() - a.y()) - (b.y() - a.y()) * (p.x() - a.x());
+	};
+
+	F32 area = edge(window[0], window[1], window[2]);
+	if(isZero(area))
+	{
+		return false;
+	}
+
+	if(area < 0.0f)
+	{
+		std::swap(window[1], window[2]);
+		std::swap(depth[1], depth[2]);
+		area = -area;
 	}
-	else
+
+	// The edge that is opposite to the vertex i gives its barycentric coordinate
+	const F32 invArea = 1.0f / area;
+	for(U i = 0; i < 3; ++i)
 	{
-		skip = true;
+		const Vec2& a = window[(i + 1) % 3];
+		const Vec2& b = window[(i + 2) % 3];
+		out.m_edges[i] = Vec3(a.y() - b.y(), b.x() - a.x(), (b.y() - a.y()) * a.x() - (b.x() - a.x()) * a.y());
 	}
 
-	return skip;
+	out.m_depth = (out.m_edges[0] * depth[0] + out.m_edges[1] * depth[1] + out.m_edges[2] * depth[2]) * invArea;
+
+	return true;
 }
 
-void SoftwareRasterizer::rasterizeTriangle(const Vec4* tri)
+void SoftwareRasterizer::storeTriangles(const Triangle* triangles, U32 count)
 {
-	ANKI_ASSERT(tri);
+	if(count == 0)
+	{
+		return;
+	}
 
-	const Vec2 windowSize{F32(m_width), F32(m_height)};
-	Array<Vec3, 3> ndc;
-	Array<Vec2, 3> window;
-	Vec2 bboxMin(MAX_F32), bboxMax(MIN_F32);
-	for(U i = 0; i < 3; i++)
+	LockGuard<SpinLock> lock(m_trianglesLock);
+
+	if(m_triangleCount + count > m_triangles.getSize())
 	{
-		ndc[i] = tri[i].xyz() / tri[i].w();
-		window[i] = (ndc[i].xy() / 2.0f + 0.5f) * windowSize;
+		m_triangles.resize(m_alloc, max<U32>(64, max(m_triangleCount + count, m_triangles.getSize() * 2)));
+	}
+
+	memcpy(&m_triangles[m_triangleCount], triangles, sizeof(Triangle) * count);
+	m_triangleCount += count;
+}
+
+void SoftwareRasterizer::binTriangles()
+{
+	ANKI_TRACE_SCOPED_EVENT(SCENE_RASTERIZER_BIN);
+
+	const U32 tileCount = getTileCount();
+	memset(&m_tileBinOffsets[0], 0, sizeof(m_tileBinOffsets[0]) * (tileCount + 1));
 
-		for(U j = 0; j < 2; j++)
+	// Count the triangles of every tile
+	auto iterateTiles = [this](const Triangle& tri, auto func) {
+		for(U32 tileY = tri.m_min[1] / TILE_SIZE; tileY <= (tri.m_max[1] - 1u) / TILE_SIZE; ++tileY)
 		{
-			bboxMin[j] = std::floor(min(bboxMin[j], window[i][j]));
-			bboxMin[j] = clamp(bboxMin[j], 0.0f, windowSize[j]);
+			for(U32 tileX = tri.m_min[0] / TILE_SIZE; tileX <= (tri.m_max[0] - 1u) / TILE_SIZE; ++tileX)
+			{
+				func(tileY * m_tileCountX + tileX);
+			}
+		}
+	};
+
+	for(U32 i = 0; i < m_triangleCount; ++i)
+	{
+		iterateTiles(m_triangles[i], [this](U32 tileIdx) { ++m_tileBinOffsets[tileIdx + 1]; });
+	}
 
-			bboxMax[j] = std::ceil(max(bboxMax[j], window[i][j]));
-			bboxMax[j] = clamp(bboxMax[j], 0.0f, windowSize[j]);
+	// Compute the offsets
+	for(U32 i = 0; i < tileCount; ++i)
+	{
+		m_tileBinOffsets[i + 1] += m_tileBinOffsets[i];
+	}
+
+	const U32 binnedCount = m_tileBinOffsets[tileCount];
+	if(m_binnedTriangles.getSize() < binnedCount)
+	{
+		m_binnedTriangles.destroy(m_alloc);
+		m_binnedTriangles.create(m_alloc, max(binnedCount, m_triangleCount * 2));
+	}
+
+	// Fill the bins. That moves the offsets one tile forward
+	for(U32 i = 0; i < m_triangleCount; ++i)
+	{
+		iterateTiles(m_triangles[i], [this, i](U32 tileIdx) { m_binnedTriangles[m_tileBinOffsets[tileIdx]++] = i; });
+	}
+
+	for(U32 i = tileCount; i > 0; --i)
+	{
+		m_tileBinOffsets[i] = m_tileBinOffsets[i - 1];
+	}
+	m_tileBinOffsets[0] = 0;
+	ANKI_ASSERT(m_tileBinOffsets[tileCount] == binnedCount);
+}
+
+void SoftwareRasterizer::rasterizeParallel(
+	ThreadHive& hive, ThreadHiveTaskPriority priority, ThreadHiveSemaphore*& signalSemaphore)
+{
+	binTriangles();
+
+	// Split the tiles to a few tasks per thread for better balancing
+	const U32 tileCount = getTileCount();
+	const U32 taskCount = min(tileCount, hive.getThreadCount() * 4);
+	if(m_tileTasks.getSize() < taskCount)
+	{
+		m_tileTasks.destroy(m_alloc);
+		m_tileTasks.create(m_alloc, taskCount);
+	}
+
+	signalSemaphore = hive.newSemaphore(taskCount);
+
+	constexpr U32 MAX_TASKS_PER_SUBMIT = 64;
+	Array<ThreadHiveTask, MAX_TASKS_PER_SUBMIT> tasks;
+	U32 submitCount = 0;
+	for(U32 i = 0; i < taskCount; ++i)
+	{
+		TileTask& tileTask = m_tileTasks[i];
+		tileTask.m_r = this;
+		tileTask.m_firstTile = tileCount * i / taskCount;
+		tileTask.m_tileCount = tileCount * (i + 1) / taskCount - tileTask.m_firstTile;
+
+		TileTask* ptileTask = &tileTask; // MSVC workaround
+		tasks[submitCount] = ANKI_THREAD_HIVE_TASK(
+			{ self->m_r->rasterizeTiles(self->m_firstTile, self->m_tileCount); }, ptileTask, nullptr, signalSemaphore);
+		tasks[submitCount].m_priority = priority;
+		++submitCount;
+
+		if(submitCount == MAX_TASKS_PER_SUBMIT || i == taskCount - 1)
+		{
+			hive.submitTasks(&tasks[0], submitCount);
+			submitCount = 0;
 		}
 	}
+}
+
+void SoftwareRasterizer::rasterizeTiles(U32 firstTile, U32 tileCount)
+{
+	ANKI_TRACE_SCOPED_EVENT(SCENE_RASTERIZER_TILES);
+	ANKI_ASSERT(firstTile + tileCount <= getTileCount());
 
-	for(F32 y = bboxMin.y() + 0.5f; y < bboxMax.y() + 0.5f; y += 1.0f)
+	for(U32 tileIdx = firstTile; tileIdx < firstTile + tileCount; ++tileIdx)
 	{
-		for(F32 x = bboxMin.x() + 0.5f; x < bboxMax.x() + 0.5f; x += 1.0f)
+		const U32 binBegin = m_tileBinOffsets[tileIdx];
+		const U32 binEnd = m_tileBinOffsets[tileIdx + 1];
+		if(binBegin == binEnd)
 		{
-			Vec2 p(x, y);
-			Vec3 bc;
-			if(!computeBarycetrinc(window[0], window[1], window[2], p, bc))
-			{
-				const F32 z0 = ndc[0].z();
-				const F32 z1 = ndc[1].z();
-				const F32 z2 = ndc[2].z();
+			continue;
+		}
 
-				F32 depth = z0 * bc[0] + z1 * bc[1] + z2 * bc[2];
-				ANKI_ASSERT(depth >= 0.0 && depth <= 1.0);
+		const U32 tileX = tileIdx % m_tileCountX;
+		const U32 tileY = tileIdx / m_tileCountX;
+		for(U32 i = binBegin; i < binEnd; ++i)
+		{
+			rasterizeTriangleInTile(m_triangles[m_binnedTriangles[i]], tileX, tileY);
+		}
 
-				// Clamp it to a bit less that 1.0f because 1.0f will produce a 0 depthi
-				depth = min(depth, 1.0f - EPSILON);
+		computeTileMaxDepth(tileX, tileY);
+	}
+}
 
-				// Store the min of the current value and new one
-				const U32 depthi = U32(depth * F32(MAX_U32));
-				m_zbuffer[U32(y) * m_width + U32(x)].min(depthi);
-			}
+void SoftwareRasterizer::rasterizeTriangleInTile(const Triangle& tri, U32 tileX, U32 tileY)
+{
+	const U32 tileMinX = tileX * TILE_SIZE;
+	const U32 tileMinY = tileY * TILE_SIZE;
+	const U32 rowBegin = max<U32>(tileMinY, tri.m_min[1]);
+	const U32 rowEnd = min<U32>(tileMinY + TILE_SIZE, tri.m_max[1]);
+
+	// The pixel centers of the row and a mask of the pixels that are inside the bounding rect
+	const F32x8 x = F32x8::load(&TILE_ROW_OFFSETS[0]) + F32x8(F32(tileMinX));
+	const F32x8 rectMask = (x > F32x8(F32(tri.m_min[0]))) & (x < F32x8(F32(tri.m_max[0])));
+
+	// Evaluate the x part of the edge functions once
+	Array<F32x8, 3> edgeX;
+	Array<F32x8, 3> edgeY;
+	for(U32 i = 0; i < 3; ++i)
+	{
+		edgeX[i] = F32x8::mulAdd(F32x8(tri.m_edges[i].x()), x, F32x8(tri.m_edges[i].z()));
+		edgeY[i] = F32x8(tri.m_edges[i].y());
+	}
+	const F32x8 depthX = F32x8::mulAdd(F32x8(tri.m_depth.x()), x, F32x8(tri.m_depth.z()));
+	const F32x8 depthY(tri.m_depth.y());
+
+	const F32x8 zero(0.0f);
+	F32* row = &m_zbuffer[rowBegin * getPitch() + tileMinX];
+	for(U32 rowIdx = rowBegin; rowIdx < rowEnd; ++rowIdx, row += getPitch())
+	{
+		const F32x8 y(F32(rowIdx) + 0.5f);
+		const F32x8 inside = rectMask & (F32x8::mulAdd(edgeY[0], y, edgeX[0]) >= zero)
+							 & (F32x8::mulAdd(edgeY[1], y, edgeX[1]) >= zero)
+							 & (F32x8::mulAdd(edgeY[2], y, edgeX[2]) >= zero);
+		if(inside.getMask() == 0)
+		{
+			continue;
 		}
+
+		// Store the min of the current value and new one
+		const F32x8 depth = F32x8::mulAdd(depthY, y, depthX);
+		const F32x8 crntDepth = F32x8::load(row);
+		F32x8::select(inside, F32x8::min(crntDepth, depth), crntDepth).store(row);
+	}
+}
+
+void SoftwareRasterizer::computeTileMaxDepth(U32 tileX, U32 tileY)
+{
+	const F32* row = &m_zbuffer[tileY * TILE_SIZE * getPitch() + tileX * TILE_SIZE];
+	F32x8 maxDepth = F32x8::load(row);
+	for(U32 i = 1; i < TILE_SIZE; ++i)
+	{
+		row += getPitch();
+		maxDepth = F32x8::max(maxDepth, F32x8::load(row));
+	}
+
+	F32 out = 0.0f;
+	for(U32 i = 0; i < TILE_SIZE; ++i)
+	{
+		out = max(out, maxDepth.getLane(i));
 	}
+
+	m_tileMaxDepths[tileY * m_tileCountX + tileX] = out;
 }
 
 Bool SoftwareRasterizer::visibilityTest(const Aabb& aabb) const
@@ -371,18 +579,41 @@ Bool SoftwareRasterizer::visibilityTestInternal(const Aabb& aabb) const
 	bboxMax.y() = ceilf(bboxMax.y());
 	bboxMax.y() = clamp(bboxMax.y(), 0.0f, F32(m_height));
 
-	// Loop the tiles
-	F32 minZ = bboxMin.z();
-	for(F32 y = bboxMin.y(); y < bboxMax.y(); y += 1.0f)
+	// Loop the tiles. Skip the ones that have all their pixels in front of the box
+	const U32 minX = U32(bboxMin.x());
+	const U32 maxX = U32(bboxMax.x());
+	const U32 minY = U32(bboxMin.y());
+	const U32 maxY = U32(bboxMax.y());
+	if(minX >= maxX || minY >= maxY)
+	{
+		return false;
+	}
+
+	const F32 minZ = bboxMin.z();
+	const F32x8 minZx8(minZ);
+	for(U32 tileY = minY / TILE_SIZE; tileY <= (maxY - 1) / TILE_SIZE; ++tileY)
 	{
-		for(F32 x = bboxMin.x(); x < bboxMax.x(); x += 1.0f)
+		for(U32 tileX = minX / TILE_SIZE; tileX <= (maxX - 1) / TILE_SIZE; ++tileX)
 		{
-			const U32 idx = U32(y) * m_width + U32(x);
-			const U32 depthi = m_zbuffer[idx].getNonAtomically();
-			const F32 depthf = F32(depthi) / F32(MAX_U32);
-			if(minZ < depthf)
+			if(minZ >= m_tileMaxDepths[tileY * m_tileCountX + tileX])
+			{
+				continue;
+			}
+
+			// Need to check the pixels
+			const U32 tileMinX = tileX * TILE_SIZE;
+			const F32x8 x = F32x8::load(&TILE_ROW_OFFSETS[0]) + F32x8(F32(tileMinX));
+			const U32 rectMask = ((x > F32x8(F32(minX))) & (x < F32x8(F32(maxX)))).getMask();
+
+			const U32 rowBegin = max(tileY * TILE_SIZE, minY);
+			const U32 rowEnd = min((tileY + 1) * TILE_SIZE, maxY);
+			for(U32 y = rowBegin; y < rowEnd; ++y)
 			{
-				return true;
+				const F32x8 depth = F32x8::load(&m_zbuffer[y * getPitch() + tileMinX]);
+				if((minZx8 < depth).getMask() & rectMask)
+				{
+					return true;
+				}
 			}
 		}
 	}
@@ -392,18 +623,24 @@ Bool SoftwareRasterizer::visibilityTestInternal(const Aabb& aabb) const
 
 void SoftwareRasterizer::fillDepthBuffer(ConstWeakArray<F32> depthValues)
 {
-	ANKI_ASSERT(m_zbuffer.getSize() == depthValues.getSize());
+	ANKI_ASSERT(depthValues.getSize() == m_width * m_height);
 
-	U32 count = depthValues.getSize();
-	while(count--)
+	for(U32 y = 0; y < m_height; ++y)
 	{
-		F32 depth = depthValues[count];
-		ANKI_ASSERT(depth >= 0.0f && depth <= 1.0f);
-
-		depth = min(depth, 1.0f - EPSILON); // See a few lines above why is that
+		for(U32 x = 0; x < m_width; ++x)
+		{
+			const F32 depth = depthValues[y * m_width + x];
+			ANKI_ASSERT(depth >= 0.0f && depth <= 1.0f);
+			m_zbuffer[y * getPitch() + x] = depth;
+		}
+	}
 
-		const U32 depthi = U32(depth * F32(MAX_U32));
-		m_zbuffer[count].setNonAtomically(depthi);
+	for(U32 tileY = 0; tileY < m_tileCountY; ++tileY)
+	{
+		for(U32 tileX = 0; tileX < m_tileCountX; ++tileX)
+		{
+			computeTileMaxDepth(tileX, tileY);
+		}
 	}
 }
 
@@ -7,8 +7,11 @@
 
 #include <anki/scene/Common.h>
 #include <anki/Math.h>
+#include <anki/math/SimdWide.h>
 #include <anki/collision/Plane.h>
 #include <anki/util/WeakArray.h>
+#include <anki/util/Thread.h>
+#include <anki/util/ThreadHive.h>
 
 namespace anki
 {
@@ -16,10 +19,15 @@ namespace anki
 /// @addtogroup scene
 /// @{
 
-/// Software rasterizer for visibility tests.
+/// Software rasterizer for visibility tests. The depth buffer is split in tiles. The triangles are first binned to the
+/// tiles they touch and then every tile is rasterized on its own so different tiles can be rasterized by different
+/// threads. Every tile also keeps the max depth of its pixels to speed up the visibility tests.
 class SoftwareRasterizer
 {
 public:
+	/// The tiles are TILE_SIZE x TILE_SIZE pixels. A row of a tile is a single F32x8.
+	static constexpr U32 TILE_SIZE = F32x8::LANE_COUNT;
+
 	SoftwareRasterizer()
 	{
 	}
@@ -27,6 +35,11 @@ public:
 	~SoftwareRasterizer()
 	{
 		m_zbuffer.destroy(m_alloc);
+		m_tileMaxDepths.destroy(m_alloc);
+		m_triangles.destroy(m_alloc);
+		m_tileBinOffsets.destroy(m_alloc);
+		m_binnedTriangles.destroy(m_alloc);
+		m_tileTasks.destroy(m_alloc);
 	}
 
 	/// Initialize.
@@ -38,7 +51,8 @@ public:
 	/// Prepare for rendering. Call it before every draw.
 	void prepare(const Mat4& mv, const Mat4& p, U32 width, U32 height);
 
-	/// Render some verts.
+	/// Render some verts. The triangles are only binned. Call rasterize() or rasterizeParallel() when all the draws are
+	/// done.
 	/// @param[in] verts Pointer to the first vertex to draw.
 	/// @param vertCount The number of verts to draw.
 	/// @param stride The stride (in bytes) of the next vertex.
@@ -46,15 +60,54 @@ public:
 	/// @note It's thread-safe against other draw() invocations only.
 	void draw(const F32* verts, U vertCount, U stride, Bool backfaceCulling);
 
+	/// Rasterize the triangles of all the previous draw() calls in the current thread.
+	void rasterize()
+	{
+		binTriangles();
+		rasterizeTiles(0, getTileCount());
+	}
+
+	/// Same as rasterize() but the tiles will be rasterized by ThreadHive tasks.
+	/// @param hive The hive.
+	/// @param priority The priority of the tasks.
+	/// @param[out] signalSemaphore It will be signaled when all the tiles are rasterized. The visibility tests should
+	///                             wait for it.
+	void rasterizeParallel(ThreadHive& hive, ThreadHiveTaskPriority priority, ThreadHiveSemaphore*& signalSemaphore);
+
 	/// Fill the depth buffer with some values.
 	void fillDepthBuffer(ConstWeakArray<F32> depthValues);
 
 	/// Perform visibility tests.
 	/// @param aabb The Aabb in of the cs in world space.
 	/// @return Return true if it's visible and false otherwise.
+	/// @note Call it after the rasterization is done.
 	Bool visibilityTest(const Aabb& aabb) const;
 
+	U32 getTileCount() const
+	{
+		return m_tileCountX * m_tileCountY;
+	}
+
 private:
+	/// A triangle that is ready to be rasterized.
+	class Triangle
+	{
+	public:
+		Array<Vec3, 3> m_edges; ///< The edge functions. (a, b, c) give a * x + b * y + c. Positive is inside.
+		Vec3 m_depth; ///< The depth plane. Same as the edges.
+		Array<U16, 2> m_min; ///< The bounding rect in pixels.
+		Array<U16, 2> m_max; ///< The bounding rect in pixels. Not inclusive.
+	};
+
+	/// A range of tiles that will be rasterized by a ThreadHive task.
+	class TileTask
+	{
+	public:
+		SoftwareRasterizer* m_r;
+		U32 m_firstTile;
+		U32 m_tileCount;
+	};
+
 	GenericMemoryPoolAllocator<U8> m_alloc;
 	Mat4 m_mv; ///< ModelView.
 	Mat4 m_p; ///< Projection.
@@ -63,17 +116,49 @@ private:
 	Array<Plane, 6> m_planesW; ///< In world space.
 	U32 m_width;
 	U32 m_height;
-	DynamicArray<Atomic<U32>> m_zbuffer;
+	U32 m_tileCountX;
+	U32 m_tileCountY;
 
-	/// @param tri In clip space.
-	void rasterizeTriangle(const Vec4* tri);
+	/// The depth values. It's m_tileCountX * TILE_SIZE pixels wide and m_tileCountY * TILE_SIZE pixels tall. The extra
+	/// pixels that are out of the viewport are zero so they don't affect the max depth of the tiles.
+	DynamicArray<F32> m_zbuffer;
+	DynamicArray<F32> m_tileMaxDepths; ///< The max depth of every tile.
 
-	Bool computeBarycetrinc(const Vec2& a, const Vec2& b, const Vec2& c, const Vec2& p, Vec3& uvw) const;
+	DynamicArray<Triangle> m_triangles;
+	U32 m_triangleCount = 0;
+	SpinLock m_trianglesLock;
+
+	DynamicArray<U32> m_tileBinOffsets; ///< Where the triangles of a tile start in m_binnedTriangles.
+	DynamicArray<U32> m_binnedTriangles; ///< Indices to m_triangles.
+
+	DynamicArray<TileTask> m_tileTasks;
+
+	U32 getPitch() const
+	{
+		return m_tileCountX * TILE_SIZE;
+	}
+
+	/// @param tri In clip space.
+	/// @return False if the triangle doesn't cover any pixel.
+	Bool setupTriangle(const Vec4* tri, Triangle& out) const;
 
 	/// Clip triangle in the near plane.
 	/// @note Triangles in view space.
 	void clipTriangle(const Vec4* inTriangle, Vec4* outTriangles, U& outTriangleCount) const;
 
+	/// Store a few triangles to be binned later.
+	void storeTriangles(const Triangle* triangles, U32 count);
+
+	/// Put the triangles to the tiles they touch.
+	void binTriangles();
+
+	/// Rasterize some tiles. Different tiles can be rasterized in parallel.
+	void rasterizeTiles(U32 firstTile, U32 tileCount);
+
+	void rasterizeTriangleInTile(const Triangle& tri, U32 tileX, U32 tileY);
+
+	void computeTileMaxDepth(U32 tileX, U32 tileY);
+
 	Bool visibilityTestInternal(const Aabb& aabb) const;
 };
 /// @}
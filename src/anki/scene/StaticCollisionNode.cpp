@@ -27,11 +27,11 @@ Error StaticCollisionNode::init(const CString& resourceFname, const Transform& t
 	// Load resource
 	ANKI_CHECK(getResourceManager().loadResource(resourceFname, m_rsrc));
 
-	// Create body
+	// Create body. The instances with the same scale share the shape. Bullet wants the scale in the shape
 	PhysicsBodyInitInfo init;
-	init.m_shape = m_rsrc->getShape();
+	init.m_shape = m_rsrc->getShape(transform.getScale());
 	init.m_mass = 0.0f;
-	init.m_transform = transform;
+	init.m_transform = Transform(transform.getOrigin(), transform.getRotation(), 1.0f);
 
 	m_body = getSceneGraph().getPhysicsWorld().newInstance<PhysicsBody>(init);
 	m_body->setUserData(this);
@@ -46,14 +46,127 @@ static Bool spatialInsideFrustum(const FrustumComponent& frc, const SpatialCompo
 	}
 }
 
-void VisibilityContext::submitNewWork(const FrustumComponent& frc, RenderQueue& rqueue, ThreadHive& hive)
+static Aabb computeFrustumAabb(const FrustumComponent& frc)
+{
+	return (frc.getFrustumType() == FrustumType::PERSPECTIVE) ? computeAabb(frc.getPerspectiveBoundingShape())
+															   : computeAabb(frc.getOrthographicBoundingShape());
+}
+
+/// Submit a task that tests some spatials against a frustum.
+static void submitVisibilityTestTask(
+	FrustumVisibilityContext& frcCtx, ConstWeakArray<SpatialComponent*> spatials, ThreadHive& hive)
+{
+	ANKI_ASSERT(spatials.getSize() > 0 && spatials.getSize() <= MAX_SPATIALS_PER_VIS_TEST);
+
+	// Create the task
+	VisibilityTestTask* vis = frcCtx.m_visCtx->m_scene->getFrameAllocator().newInstance<VisibilityTestTask>(&frcCtx);
+	memcpy(&vis->m_spatialsToTest[0], &spatials[0], spatials.getSizeInBytes());
+	vis->m_spatialToTestCount = spatials.getSize();
+
+	// Increase the semaphore to block the CombineResultsTask
+	frcCtx.m_visTestsSignalSem->increaseSemaphore(1);
+
+	// Submit task
+	ThreadHiveTask task =
+		ANKI_THREAD_HIVE_TASK({ self->test(hive, threadId); }, vis, nullptr, frcCtx.m_visTestsSignalSem);
+	task.m_priority = frcCtx.m_priority;
+	hive.submitTasks(&task, 1);
+}
+
+/// Submit a dummy task to decrease the semaphore of the visibility tests of a frustum. The gather tasks call it once
+/// they are done.
+static void submitGatherDoneTask(FrustumVisibilityContext& frcCtx, void* taskArgument, ThreadHive& hive)
+{
+	ThreadHiveTask task = ANKI_THREAD_HIVE_TASK({}, taskArgument, nullptr, frcCtx.m_visTestsSignalSem);
+	task.m_priority = frcCtx.m_priority;
+	hive.submitTasks(&task, 1);
+}
+
+void VisibilityContext::submitNewWork(
+	const FrustumComponent& frc, RenderQueue& rqueue, ThreadHive& hive, ThreadHiveTaskPriority priority)
 {
 	ANKI_TRACE_SCOPED_EVENT(SCENE_VIS_SUBMIT_WORK);
 
+	FrustumVisibilityContext* frcCtx = newFrustumContext(frc, rqueue, hive, priority);
+	if(frcCtx)
+	{
+		submitGatherTasks(*frcCtx, hive);
+		submitCombineTask(*frcCtx, hive);
+	}
+}
+
+void VisibilityContext::submitNewOmniWork(ConstWeakArray<const FrustumComponent*> faces,
+	WeakArray<RenderQueue> results,
+	const Sphere& volume,
+	ThreadHive& hive,
+	ThreadHiveTaskPriority priority)
+{
+	ANKI_TRACE_SCOPED_EVENT(SCENE_VIS_SUBMIT_WORK);
+	ANKI_ASSERT(faces.getSize() <= 6 && faces.getSize() == results.getSize());
+
+	Array<FrustumVisibilityContext*, 6> frcCtxs;
+	U32 frcCtxCount = 0;
+
+	// The faces that can't use their caches will share the gather
+	Array<FrustumVisibilityContext*, 6> sharedCtxs;
+	U32 sharedCtxCount = 0;
+
+	for(U32 face = 0; face < faces.getSize(); ++face)
+	{
+		FrustumVisibilityContext* frcCtx = newFrustumContext(*faces[face], results[face], hive, priority);
+		if(frcCtx == nullptr)
+		{
+			continue;
+		}
+
+		frcCtxs[frcCtxCount++] = frcCtx;
+
+		const Bool usesRasterizer =
+			faces[face]->visibilityTestsEnabled(FrustumComponentVisibilityTestFlag::OCCLUDERS)
+			&& faces[face]->hasCoverageBuffer();
+		if(frcCtx->m_useVisCache || usesRasterizer)
+		{
+			submitGatherTasks(*frcCtx, hive);
+		}
+		else
+		{
+			sharedCtxs[sharedCtxCount++] = frcCtx;
+		}
+	}
+
+	if(sharedCtxCount == 1)
+	{
+		submitGatherTasks(*sharedCtxs[0], hive);
+	}
+	else if(sharedCtxCount > 1)
+	{
+		GatherOmniVisiblesFromOctreeTask* gather =
+			m_scene->getFrameAllocator().newInstance<GatherOmniVisiblesFromOctreeTask>(volume);
+		for(U32 i = 0; i < sharedCtxCount; ++i)
+		{
+			sharedCtxs[i]->m_spatialsInsideFrustum = true;
+			gather->m_frcCtxs[gather->m_frcCtxCount++] = sharedCtxs[i];
+		}
+
+		// No need to signal anything because it will spawn new tasks
+		ThreadHiveTask gatherTask = ANKI_THREAD_HIVE_TASK({ self->gather(hive); }, gather, nullptr, nullptr);
+		gatherTask.m_priority = priority;
+		hive.submitTasks(&gatherTask, 1);
+	}
+
+	for(U32 i = 0; i < frcCtxCount; ++i)
+	{
+		submitCombineTask(*frcCtxs[i], hive);
+	}
+}
+
+FrustumVisibilityContext* VisibilityContext::newFrustumContext(
+	const FrustumComponent& frc, RenderQueue& rqueue, ThreadHive& hive, ThreadHiveTaskPriority priority)
+{
 	// Check enabled and make sure that the results are null (this can happen on multiple on circular viewing)
 	if(ANKI_UNLIKELY(!frc.anyVisibilityTestEnabled()))
 	{
-		return;
+		return nullptr;
 	}
 
 	rqueue.m_cameraTransform = Mat4(frc.getTransform());
@@ -73,6 +186,9 @@ void VisibilityContext::submitNewWork(const FrustumComponent& frc, RenderQueue&
 		rqueue.m_cameraFovX = rqueue.m_cameraFovY = 0.0f;
 	}
 	rqueue.m_effectiveShadowDistance = frc.getEffectiveShadowDistance();
+	rqueue.m_frustumData.m_invViewProjectionMatrix = frc.getInverseViewProjectionMatrix();
+	rqueue.m_frustumData.m_unprojectionParameters = frc.getUnprojectionParameters();
+	rqueue.m_frustumData.m_nearPlane = frc.getViewPlanes()[FrustumPlaneType::NEAR];
 
 	auto alloc = m_scene->getFrameAllocator();
 
@@ -85,7 +201,7 @@ void VisibilityContext::submitNewWork(const FrustumComponent& frc, RenderQueue&
 		{
 			if(x == &frc)
 			{
-				return;
+				return nullptr;
 			}
 		}
 
@@ -97,12 +213,42 @@ void VisibilityContext::submitNewWork(const FrustumComponent& frc, RenderQueue&
 	FrustumVisibilityContext* frcCtx = alloc.newInstance<FrustumVisibilityContext>();
 	frcCtx->m_visCtx = this;
 	frcCtx->m_frc = &frc;
+	frcCtx->m_priority = priority;
+	frcCtx->m_skipRenderableOcclusionTests = &frc == m_gpuOcclusionCullingFrc;
 	frcCtx->m_queueViews.create(alloc, hive.getThreadCount());
 	frcCtx->m_visTestsSignalSem = hive.newSemaphore(1);
 	frcCtx->m_renderQueue = &rqueue;
 
-	// Submit new work
-	//
+	// Check the visibility cache. It can't be used if the results depend on the coverage buffer that changes every frame
+	const Bool usesRasterizer =
+		frc.visibilityTestsEnabled(FrustumComponentVisibilityTestFlag::OCCLUDERS) && frc.hasCoverageBuffer();
+	if(frc.m_visCache.m_enabled && !usesRasterizer)
+	{
+		const Octree& octree = m_scene->getOctree();
+		frcCtx->m_octreeEpoch = octree.getChangeEpoch();
+
+		// The cache is valid if nothing changed inside the volume of the frustum since it was populated
+		frcCtx->m_useVisCache =
+			frc.m_visCache.m_octreeEpoch != 0 && frc.getTimestamp() == frc.m_visCache.m_frustumTimestamp
+			&& (frcCtx->m_octreeEpoch == frc.m_visCache.m_octreeEpoch
+				   || !octree.volumeChangedSince(computeFrustumAabb(frc), frc.m_visCache.m_octreeEpoch));
+		frcCtx->m_populateVisCache = !frcCtx->m_useVisCache;
+
+		if(frcCtx->m_useVisCache)
+		{
+			// Still valid. Move it to the current epoch so the next check won't look at the same changes. A frustum is
+			// tested once per frame so nothing else touches its cache
+			const_cast<FrustumComponent&>(frc).m_visCache.m_octreeEpoch = frcCtx->m_octreeEpoch;
+		}
+	}
+
+	return frcCtx;
+}
+
+void VisibilityContext::submitGatherTasks(FrustumVisibilityContext& frcCtx, ThreadHive& hive)
+{
+	const FrustumComponent& frc = *frcCtx.m_frc;
+	auto alloc = m_scene->getFrameAllocator();
 
 	// Software rasterizer task
 	ThreadHiveSemaphore* prepareRasterizerSem = nullptr;
@@ -110,9 +256,10 @@ void VisibilityContext::submitNewWork(const FrustumComponent& frc, RenderQueue&
 	{
 		// Gather triangles task
 		ThreadHiveTask fillDepthTask = ANKI_THREAD_HIVE_TASK({ self->fill(); },
-			alloc.newInstance<FillRasterizerWithCoverageTask>(frcCtx),
+			alloc.newInstance<FillRasterizerWithCoverageTask>(&frcCtx),
 			nullptr,
 			hive.newSemaphore(1));
+		fillDepthTask.m_priority = frcCtx.m_priority;
 
 		hive.submitTasks(&fillDepthTask, 1);
 
@@ -121,21 +268,28 @@ void VisibilityContext::submitNewWork(const FrustumComponent& frc, RenderQueue&
 
 	if(frc.visibilityTestsEnabled(FrustumComponentVisibilityTestFlag::OCCLUDERS))
 	{
-		rqueue.m_fillCoverageBufferCallback = FrustumComponent::fillCoverageBufferCallback;
-		rqueue.m_fillCoverageBufferCallbackUserData = static_cast<void*>(const_cast<FrustumComponent*>(&frc));
+		frcCtx.m_renderQueue->m_fillCoverageBufferCallback = FrustumComponent::fillCoverageBufferCallback;
+		frcCtx.m_renderQueue->m_fillCoverageBufferCallbackUserData =
+			static_cast<void*>(const_cast<FrustumComponent*>(&frc));
 	}
 
 	// Gather visibles from the octree. No need to signal anything because it will spawn new tasks
 	ThreadHiveTask gatherTask = ANKI_THREAD_HIVE_TASK({ self->gather(hive); },
-		alloc.newInstance<GatherVisiblesFromOctreeTask>(frcCtx),
+		alloc.newInstance<GatherVisiblesFromOctreeTask>(&frcCtx),
 		prepareRasterizerSem,
 		nullptr);
+	gatherTask.m_priority = frcCtx.m_priority;
 	hive.submitTasks(&gatherTask, 1);
+}
 
-	// Combind results task
-	ANKI_ASSERT(frcCtx->m_visTestsSignalSem);
-	ThreadHiveTask combineTask = ANKI_THREAD_HIVE_TASK(
-		{ self->combine(); }, alloc.newInstance<CombineResultsTask>(frcCtx), frcCtx->m_visTestsSignalSem, nullptr);
+void VisibilityContext::submitCombineTask(FrustumVisibilityContext& frcCtx, ThreadHive& hive)
+{
+	ANKI_ASSERT(frcCtx.m_visTestsSignalSem);
+	ThreadHiveTask combineTask = ANKI_THREAD_HIVE_TASK({ self->combine(); },
+		m_scene->getFrameAllocator().newInstance<CombineResultsTask>(&frcCtx),
+		frcCtx.m_visTestsSignalSem,
+		nullptr);
+	combineTask.m_priority = frcCtx.m_priority;
 	hive.submitTasks(&combineTask, 1);
 }
 
@@ -165,65 +319,122 @@ void GatherVisiblesFromOctreeTask::gather(ThreadHive& hive)
 {
 	ANKI_TRACE_SCOPED_EVENT(SCENE_VIS_OCTREE);
 
-	U32 testIdx = m_frcCtx->m_visCtx->m_testsCount.fetchAdd(1);
+	auto addSpatial = [&](SpatialComponent* scomp) {
+		ANKI_ASSERT(m_spatialCount < m_spatials.getSize());
 
-	// Walk the tree
-	m_frcCtx->m_visCtx->m_scene->getOctree().walkTree(testIdx,
-		[&](const Aabb& box) {
-			Bool visible = m_frcCtx->m_frc->insideFrustum(box);
-			if(visible && m_frcCtx->m_r)
-			{
-				visible = m_frcCtx->m_r->visibilityTest(box);
-			}
+		m_spatials[m_spatialCount++] = scomp;
 
-			return visible;
-		},
-		[&](void* placeableUserData) {
-			ANKI_ASSERT(placeableUserData);
-			SpatialComponent* scomp = static_cast<SpatialComponent*>(placeableUserData);
-
-			ANKI_ASSERT(m_spatialCount < m_spatials.getSize());
+		if(m_spatialCount == m_spatials.getSize())
+		{
+			flush(hive);
+		}
+	};
 
-			m_spatials[m_spatialCount++] = scomp;
+	if(m_frcCtx->m_useVisCache)
+	{
+		// Nothing moved since the last time, no need to walk the tree
+		for(SpatialComponent* scomp : m_frcCtx->m_frc->m_visCache.m_spatials)
+		{
+			addSpatial(scomp);
+		}
+	}
+	else
+	{
+		U32 testIdx = m_frcCtx->m_visCtx->m_testsCount.fetchAdd(1);
+
+		// Walk the tree
+		m_frcCtx->m_visCtx->m_scene->getOctree().walkTree(m_frcCtx->m_frc->getViewPlanes(),
+			testIdx,
+			[&](const Aabb& box) {
+				Bool visible = true;
+				if(m_frcCtx->m_r)
+				{
+					visible = m_frcCtx->m_r->visibilityTest(box);
+				}
 
-			if(m_spatialCount == m_spatials.getSize())
-			{
-				flush(hive);
-			}
-		});
+				return visible;
+			},
+			[&](void* placeableUserData) {
+				ANKI_ASSERT(placeableUserData);
+				addSpatial(static_cast<SpatialComponent*>(placeableUserData));
+			});
+	}
 
 	// Flush the remaining
 	flush(hive);
 
 	// Fire an additional dummy task to decrease the semaphore to zero
-	GatherVisiblesFromOctreeTask* pself = this; // MSVC workaround
-	ThreadHiveTask task = ANKI_THREAD_HIVE_TASK({}, pself, nullptr, m_frcCtx->m_visTestsSignalSem);
-	hive.submitTasks(&task, 1);
+	submitGatherDoneTask(*m_frcCtx, this, hive);
 }
 
 void GatherVisiblesFromOctreeTask::flush(ThreadHive& hive)
 {
 	if(m_spatialCount)
 	{
-		// Create the task
-		VisibilityTestTask* vis =
-			m_frcCtx->m_visCtx->m_scene->getFrameAllocator().newInstance<VisibilityTestTask>(m_frcCtx);
-		memcpy(&vis->m_spatialsToTest[0], &m_spatials[0], sizeof(m_spatials[0]) * m_spatialCount);
-		vis->m_spatialToTestCount = m_spatialCount;
-
-		// Increase the semaphore to block the CombineResultsTask
-		m_frcCtx->m_visTestsSignalSem->increaseSemaphore(1);
-
-		// Submit task
-		ThreadHiveTask task =
-			ANKI_THREAD_HIVE_TASK({ self->test(hive, threadId); }, vis, nullptr, m_frcCtx->m_visTestsSignalSem);
-		hive.submitTasks(&task, 1);
+		submitVisibilityTestTask(*m_frcCtx, ConstWeakArray<SpatialComponent*>(&m_spatials[0], m_spatialCount), hive);
 
 		// Clear count
 		m_spatialCount = 0;
 	}
 }
 
+void GatherOmniVisiblesFromOctreeTask::gather(ThreadHive& hive)
+{
+	ANKI_TRACE_SCOPED_EVENT(SCENE_VIS_OCTREE);
+	ANKI_ASSERT(m_frcCtxCount > 1);
+
+	VisibilityContext& visCtx = *m_frcCtxs[0]->m_visCtx;
+	const U32 testIdx = visCtx.m_testsCount.fetchAdd(1);
+
+	// Walk the tree once for all the faces
+	visCtx.m_scene->getOctree().walkTree(testIdx,
+		[&](const Aabb& box) { return testCollision(box, m_volume); },
+		[&](void* placeableUserData) {
+			ANKI_ASSERT(placeableUserData);
+			SpatialComponent* scomp = static_cast<SpatialComponent*>(placeableUserData);
+
+			if(!testCollision(scomp->getAabb(), m_volume))
+			{
+				return;
+			}
+
+			// Sort it into the faces it's visible from
+			for(U32 face = 0; face < m_frcCtxCount; ++face)
+			{
+				if(spatialInsideFrustum(*m_frcCtxs[face]->m_frc, *scomp))
+				{
+					m_spatials[face][m_spatialCounts[face]++] = scomp;
+
+					if(m_spatialCounts[face] == MAX_SPATIALS_PER_VIS_TEST)
+					{
+						flush(face, hive);
+					}
+				}
+			}
+		});
+
+	for(U32 face = 0; face < m_frcCtxCount; ++face)
+	{
+		// Flush the remaining
+		flush(face, hive);
+
+		// Fire an additional dummy task to decrease the semaphore to zero
+		submitGatherDoneTask(*m_frcCtxs[face], this, hive);
+	}
+}
+
+void GatherOmniVisiblesFromOctreeTask::flush(U32 face, ThreadHive& hive)
+{
+	if(m_spatialCounts[face])
+	{
+		submitVisibilityTestTask(*m_frcCtxs[face],
+			ConstWeakArray<SpatialComponent*>(&m_spatials[face][0], m_spatialCounts[face]),
+			hive);
+
+		m_spatialCounts[face] = 0;
+	}
+}
+
 void VisibilityTestTask::test(ThreadHive& hive, U32 taskId)
 {
 	ANKI_TRACE_SCOPED_EVENT(SCENE_VIS_TEST);
@@ -236,6 +447,8 @@ void VisibilityTestTask::test(ThreadHive& hive, U32 taskId)
 
 	Timestamp& timestamp = m_frcCtx->m_queueViews[taskId].m_timestamp;
 	timestamp = testedNode.getComponentMaxTimestamp();
+	Timestamp& staticShadowCastersTimestamp = m_frcCtx->m_queueViews[taskId].m_staticShadowCastersTimestamp;
+	staticShadowCastersTimestamp = timestamp;
 
 	const Bool wantsRenderComponents =
 		testedFrc.visibilityTestsEnabled(FrustumComponentVisibilityTestFlag::RENDER_COMPONENTS);
@@ -266,6 +479,12 @@ void VisibilityTestTask::test(ThreadHive& hive, U32 taskId)
 	const Bool wantsGenericComputeJobCoponents =
 		testedFrc.visibilityTestsEnabled(FrustumComponentVisibilityTestFlag::GENERIC_COMPUTE_JOB_COMPONENTS);
 
+	const Bool wantsMainCameraLods = wantsRenderComponents && &testedFrc == m_frcCtx->m_visCtx->m_mainCameraFrc
+									 && testedFrc.getFrustumType() == FrustumType::PERSPECTIVE;
+	const F32 tanHalfFovY = (wantsMainCameraLods) ? tan(testedFrc.getFovY() / 2.0f) : 0.0f;
+	const SceneGraphLimits& limits = m_frcCtx->m_visCtx->m_scene->getLimits();
+	const Timestamp globalTimestamp = m_frcCtx->m_visCtx->m_scene->getGlobalTimestamp();
+
 	// Iterate
 	RenderQueueView& result = m_frcCtx->m_queueViews[taskId];
 	for(U i = 0; i < m_spatialToTestCount; ++i)
@@ -283,7 +502,7 @@ void VisibilityTestTask::test(ThreadHive& hive, U32 taskId)
 		// Check what components the frustum needs
 		Bool wantNode = false;
 
-		const RenderComponent* rc = nullptr;
+		RenderComponent* rc = nullptr;
 		wantNode |= wantsRenderComponents && (rc = node.tryGetComponent<RenderComponent>());
 
 		wantNode |= wantsShadowCasters && (rc = node.tryGetComponent<RenderComponent>())
@@ -313,10 +532,19 @@ void VisibilityTestTask::test(ThreadHive& hive, U32 taskId)
 
 		if(ANKI_UNLIKELY(!wantNode))
 		{
-			// Skip node
+			// Skip node. Cache it anyway because the test flags of the frustum might change
+			if(m_frcCtx->m_populateVisCache)
+			{
+				*result.m_visibleSpatials.newElement(alloc) = spatialC;
+			}
+
 			continue;
 		}
 
+		// The renderer culls the plain renderables against the HiZ, no need to test them here
+		const Bool skipRasterizer = m_frcCtx->m_skipRenderableOcclusionTests && rc && !lc && !lfc && !reflc && !decalc
+									&& !fogc && !giprobec && !computec;
+
 		// Test all spatial components of that node
 		struct SpatialTemp
 		{
@@ -329,7 +557,8 @@ void VisibilityTestTask::test(ThreadHive& hive, U32 taskId)
 		U32 spIdx = 0;
 		U32 count = 0;
 		Error err = node.iterateComponentsOfType<SpatialComponent>([&](SpatialComponent& sp) {
-			if(spatialInsideFrustum(testedFrc, sp) && testAgainstRasterizer(sp.getAabb()))
+			if(m_frcCtx->m_useVisCache || m_frcCtx->m_spatialsInsideFrustum
+				|| (spatialInsideFrustum(testedFrc, sp) && (skipRasterizer || testAgainstRasterizer(sp.getAabb()))))
 			{
 				// Inside
 				ANKI_ASSERT(spIdx < MAX_U8);
@@ -349,6 +578,11 @@ void VisibilityTestTask::test(ThreadHive& hive, U32 taskId)
 
 		ANKI_ASSERT(count == 1 && "TODO: Support sub-spatials");
 
+		if(m_frcCtx->m_populateVisCache)
+		{
+			*result.m_visibleSpatials.newElement(alloc) = spatialC;
+		}
+
 		// Sort sub-spatials
 		const Vec4 origin = testedFrc.getTransform().getOrigin();
 		std::sort(sps.begin(), sps.begin() + count, [origin](const SpatialTemp& a, const SpatialTemp& b) -> Bool {
@@ -363,6 +597,7 @@ void VisibilityTestTask::test(ThreadHive& hive, U32 taskId)
 
 		WeakArray<RenderQueue> nextQueues;
 		WeakArray<FrustumComponent> nextQueueFrustumComponents; // Optional
+		Bool nextQueuesAreOmniFaces = false; // The faces of a point light. They will share the octree gather
 
 		if(rc)
 		{
@@ -377,6 +612,8 @@ void VisibilityTestTask::test(ThreadHive& hive, U32 taskId)
 			}
 
 			rc->setupRenderableQueueElement(*el);
+			el->m_staticShadowCaster =
+				globalTimestamp - node.getComponentMaxTimestamp() >= SceneNode::COMPONENT_REST_FRAME_COUNT;
 
 			// Compute distance from the frustum
 			const Plane& nearPlane = testedFrc.getViewPlanes()[FrustumPlaneType::NEAR];
@@ -384,8 +621,37 @@ void VisibilityTestTask::test(ThreadHive& hive, U32 taskId)
 										   ? testedFrc.getFar()
 										   : max(0.0f, testPlane(nearPlane, sps[0].m_sp->getAabb()));
 
+			el->m_aabbMin = sps[0].m_sp->getAabb().getMin().xyz();
+			el->m_aabbMax = sps[0].m_sp->getAabb().getMax().xyz();
+
+			// The main camera picks the LODs from the projected size, the rest of the frustums leave it to the
+			// renderer
+			el->m_lod = MAX_U8;
+			if(wantsMainCameraLods && !(rc->getFlags() & RenderComponentFlag::SORT_LAST))
+			{
+				const Vec4 center = (sps[0].m_sp->getAabb().getMin() + sps[0].m_sp->getAabb().getMax()) * 0.5f;
+				const F32 radius = (sps[0].m_sp->getAabb().getMax() - center).xyz().getLength();
+				const F32 dist = (center - testedFrc.getTransform().getOrigin()).xyz().getLength();
+				const F32 screenSize = (dist > radius) ? radius / (dist * tanHalfFovY) : 1.0f;
+
+				rc->updateLod(screenSize, limits, globalTimestamp);
+				rc->requestResidency(screenSize);
+				el->m_lod = U8(rc->getLod());
+
+				if(rc->isChangingLod())
+				{
+					// Draw the previous LOD as well, the shaders will dither them
+					RenderableQueueElement* el2 = (!!(rc->getFlags() & RenderComponentFlag::FORWARD_SHADING))
+													  ? result.m_forwardShadingRenderables.newElement(alloc)
+													  : result.m_renderables.newElement(alloc);
+					*el2 = *el;
+					el2->m_lod = U8(rc->getPreviousLod());
+				}
+			}
+
+			// The early Z would write the depth of the missing pixels of the LODs that are fading
 			if(wantsEarlyZ && el->m_distanceFromCamera < m_frcCtx->m_visCtx->m_earlyZDist
-				&& !(rc->getFlags() & RenderComponentFlag::FORWARD_SHADING))
+				&& !(rc->getFlags() & RenderComponentFlag::FORWARD_SHADING) && !rc->isChangingLod())
 			{
 				RenderableQueueElement* el2 = result.m_earlyZRenderables.newElement(alloc);
 				*el2 = *el;
@@ -427,6 +693,7 @@ void VisibilityTestTask::test(ThreadHive& hive, U32 taskId)
 					el->m_shadowRenderQueues[3] = &nextQueues[3];
 					el->m_shadowRenderQueues[4] = &nextQueues[4];
 					el->m_shadowRenderQueues[5] = &nextQueues[5];
+					nextQueuesAreOmniFaces = true;
 
 					U32* p = result.m_shadowPointLights.newElement(alloc);
 					*p = result.m_pointLights.m_elementCount - 1;
@@ -603,10 +870,26 @@ void VisibilityTestTask::test(ThreadHive& hive, U32 taskId)
 		{
 			count = 0;
 
-			if(ANKI_LIKELY(nextQueueFrustumComponents.getSize() == 0))
+			if(nextQueuesAreOmniFaces)
+			{
+				Array<const FrustumComponent*, 6> faces;
+				err = node.iterateComponentsOfType<FrustumComponent>([&](FrustumComponent& frc) {
+					faces[count++] = &frc;
+					return Error::NONE;
+				});
+				(void)err;
+				ANKI_ASSERT(count == 6);
+
+				m_frcCtx->m_visCtx->submitNewOmniWork(ConstWeakArray<const FrustumComponent*>(&faces[0], count),
+					nextQueues,
+					Sphere(lc->getTransform().getOrigin(), lc->getRadius()),
+					hive,
+					ThreadHiveTaskPriority::NORMAL);
+			}
+			else if(ANKI_LIKELY(nextQueueFrustumComponents.getSize() == 0))
 			{
 				err = node.iterateComponentsOfType<FrustumComponent>([&](FrustumComponent& frc) {
-					m_frcCtx->m_visCtx->submitNewWork(frc, nextQueues[count++], hive);
+					m_frcCtx->m_visCtx->submitNewWork(frc, nextQueues[count++], hive, ThreadHiveTaskPriority::NORMAL);
 					return Error::NONE;
 				});
 				(void)err;
@@ -615,13 +898,22 @@ void VisibilityTestTask::test(ThreadHive& hive, U32 taskId)
 			{
 				for(FrustumComponent& frc : nextQueueFrustumComponents)
 				{
-					m_frcCtx->m_visCtx->submitNewWork(frc, nextQueues[count++], hive);
+					m_frcCtx->m_visCtx->submitNewWork(frc, nextQueues[count++], hive, ThreadHiveTaskPriority::NORMAL);
 				}
 			}
 		}
 
-		// Update timestamp
+		// Update timestamps
 		timestamp = max(timestamp, node.getComponentMaxTimestamp());
+		if(rc)
+		{
+			// A static caster that started moving is not part of the static casters anymore but it's still in their
+			// cached depth
+			const Bool resting =
+				globalTimestamp - node.getComponentMaxTimestamp() >= SceneNode::COMPONENT_REST_FRAME_COUNT;
+			staticShadowCastersTimestamp = max(staticShadowCastersTimestamp,
+				(resting) ? node.getComponentMaxTimestamp() : node.getComponentWakeTimestamp());
+		}
 	} // end for
 }
 
@@ -635,12 +927,25 @@ void CombineResultsTask::combine()
 	// Compute the timestamp
 	const U32 threadCount = m_frcCtx->m_queueViews.getSize();
 	results.m_shadowRenderablesLastUpdateTimestamp = 0;
+	results.m_staticShadowRenderablesLastUpdateTimestamp = 0;
 	for(U32 i = 0; i < threadCount; ++i)
 	{
 		results.m_shadowRenderablesLastUpdateTimestamp =
 			max(results.m_shadowRenderablesLastUpdateTimestamp, m_frcCtx->m_queueViews[i].m_timestamp);
+		results.m_staticShadowRenderablesLastUpdateTimestamp = max(results.m_staticShadowRenderablesLastUpdateTimestamp,
+			m_frcCtx->m_queueViews[i].m_staticShadowCastersTimestamp);
 	}
 	ANKI_ASSERT(results.m_shadowRenderablesLastUpdateTimestamp);
+	ANKI_ASSERT(results.m_staticShadowRenderablesLastUpdateTimestamp);
+
+	// A cache that is re-populated means that something entered or left the frustum. A caster that left doesn't change
+	// the timestamps of the rest so bump it to let the renderer know that the list of casters changed
+	if(m_frcCtx->m_populateVisCache)
+	{
+		results.m_shadowRenderablesLastUpdateTimestamp =
+			max(results.m_shadowRenderablesLastUpdateTimestamp, m_frcCtx->m_visCtx->m_scene->getGlobalTimestamp());
+		results.m_staticShadowRenderablesLastUpdateTimestamp = results.m_shadowRenderablesLastUpdateTimestamp;
+	}
 
 #define ANKI_VIS_COMBINE(t_, member_) \
 	{ \
@@ -650,7 +955,7 @@ void CombineResultsTask::combine()
 			subStorages[i] = m_frcCtx->m_queueViews[i].member_; \
 		} \
 		combineQueueElements<t_>(alloc, \
-			WeakArray<TRenderQueueElementStorage<t_>>(&subStorages[0], threadCount), \
+			ConstWeakArray<TRenderQueueElementStorage<t_>>(&subStorages[0], threadCount), \
 			nullptr, \
 			results.member_, \
 			nullptr); \
@@ -665,17 +970,14 @@ void CombineResultsTask::combine()
 			subStorages[i] = m_frcCtx->m_queueViews[i].member_; \
 			ptrSubStorages[i] = m_frcCtx->m_queueViews[i].ptrMember_; \
 		} \
-		WeakArray<TRenderQueueElementStorage<U32>> arr(&ptrSubStorages[0], threadCount); \
+		ConstWeakArray<TRenderQueueElementStorage<U32>> arr(&ptrSubStorages[0], threadCount); \
 		combineQueueElements<t_>(alloc, \
-			WeakArray<TRenderQueueElementStorage<t_>>(&subStorages[0], threadCount), \
+			ConstWeakArray<TRenderQueueElementStorage<t_>>(&subStorages[0], threadCount), \
 			&arr, \
 			results.member_, \
 			&results.ptrMember_); \
 	}
 
-	ANKI_VIS_COMBINE(RenderableQueueElement, m_renderables);
-	ANKI_VIS_COMBINE(RenderableQueueElement, m_earlyZRenderables);
-	ANKI_VIS_COMBINE(RenderableQueueElement, m_forwardShadingRenderables);
 	ANKI_VIS_COMBINE_AND_PTR(PointLightQueueElement, m_pointLights, m_shadowPointLights);
 	ANKI_VIS_COMBINE_AND_PTR(SpotLightQueueElement, m_spotLights, m_shadowSpotLights);
 	ANKI_VIS_COMBINE(ReflectionProbeQueueElement, m_reflectionProbes);
@@ -708,19 +1010,79 @@ void CombineResultsTask::combine()
 	}
 #endif
 
-	// Sort some of the arrays
-	std::sort(results.m_renderables.getBegin(), results.m_renderables.getEnd(), MaterialDistanceSortFunctor(20.0f));
+	// The renderables are combined by their sort. The shadow passes only draw depth so sort them for instancing and not
+	// for the overdraw
+	Array<TRenderQueueElementStorage<RenderableQueueElement>, 64> subStorages;
+	auto gatherRenderables = [&](TRenderQueueElementStorage<RenderableQueueElement> RenderQueueView::*member) {
+		for(U32 i = 0; i < threadCount; ++i)
+		{
+			subStorages[i] = m_frcCtx->m_queueViews[i].*member;
+		}
+
+		return ConstWeakArray<TRenderQueueElementStorage<RenderableQueueElement>>(&subStorages[0], threadCount);
+	};
+
+	const FrustumComponent& frc = *m_frcCtx->m_frc;
+	const Bool onlyShadowCasters = frc.visibilityTestsEnabled(FrustumComponentVisibilityTestFlag::SHADOW_CASTERS)
+								   && !frc.visibilityTestsEnabled(FrustumComponentVisibilityTestFlag::RENDER_COMPONENTS);
+	if(onlyShadowCasters)
+	{
+		combineAndSortRenderables(alloc,
+			gatherRenderables(&RenderQueueView::m_renderables),
+			results.m_renderables,
+			RenderableSortKey::computeShadowCasterKey);
+
+		results.m_staticShadowRenderableCount = 0;
+		while(results.m_staticShadowRenderableCount < results.m_renderables.getSize()
+			  && results.m_renderables[results.m_staticShadowRenderableCount].m_staticShadowCaster)
+		{
+			++results.m_staticShadowRenderableCount;
+		}
+	}
+	else
+	{
+		const F32 invDistanceGranularity = 1.0f / 20.0f;
+		combineAndSortRenderables(alloc,
+			gatherRenderables(&RenderQueueView::m_renderables),
+			results.m_renderables,
+			[invDistanceGranularity](const RenderableQueueElement& el) {
+				return RenderableSortKey::computeMaterialDistanceKey(el, invDistanceGranularity);
+			});
+	}
 
-	std::sort(results.m_earlyZRenderables.getBegin(),
-		results.m_earlyZRenderables.getEnd(),
-		DistanceSortFunctor<RenderableQueueElement>());
+	combineAndSortRenderables(alloc,
+		gatherRenderables(&RenderQueueView::m_earlyZRenderables),
+		results.m_earlyZRenderables,
+		RenderableSortKey::computeDistanceKey);
 
-	std::sort(results.m_forwardShadingRenderables.getBegin(),
-		results.m_forwardShadingRenderables.getEnd(),
-		RevDistanceSortFunctor<RenderableQueueElement>());
+	// The transparent renderables can be sorted in slices so the ones of the same material in a slice can be merged.
+	// It trades a bit of the ordering inside the slice for less drawcalls
+	const F32 transparencySortDistance = m_frcCtx->m_visCtx->m_scene->getLimits().m_transparencySortDistance;
+	if(transparencySortDistance > 0.0f)
+	{
+		const F32 invDistanceGranularity = 1.0f / transparencySortDistance;
+		combineAndSortRenderables(alloc,
+			gatherRenderables(&RenderQueueView::m_forwardShadingRenderables),
+			results.m_forwardShadingRenderables,
+			[invDistanceGranularity](const RenderableQueueElement& el) {
+				return RenderableSortKey::computeReverseMaterialDistanceKey(el, invDistanceGranularity);
+			});
+	}
+	else
+	{
+		combineAndSortRenderables(alloc,
+			gatherRenderables(&RenderQueueView::m_forwardShadingRenderables),
+			results.m_forwardShadingRenderables,
+			RenderableSortKey::computeReverseDistanceKey);
+	}
 
 	std::sort(results.m_giProbes.getBegin(), results.m_giProbes.getEnd());
 
+	if(m_frcCtx->m_populateVisCache)
+	{
+		populateVisibilityCache();
+	}
+
 	// Cleanup
 	if(m_frcCtx->m_r)
 	{
@@ -728,98 +1090,159 @@ void CombineResultsTask::combine()
 	}
 }
 
-template<typename T>
-void CombineResultsTask::combineQueueElements(SceneFrameAllocator<U8>& alloc,
-	WeakArray<TRenderQueueElementStorage<T>> subStorages,
-	WeakArray<TRenderQueueElementStorage<U32>>* ptrSubStorages,
-	WeakArray<T>& combined,
-	WeakArray<T*>* ptrCombined)
+void CombineResultsTask::populateVisibilityCache()
 {
-	U32 totalElCount = subStorages[0].m_elementCount;
-	U32 biggestSubStorageIdx = 0;
-	for(U32 i = 1; i < subStorages.getSize(); ++i)
+	// It's the only task that touches the cache of that frustum
+	FrustumComponent& frc = const_cast<FrustumComponent&>(*m_frcCtx->m_frc);
+	auto alloc = frc.getSceneNode().getAllocator();
+
+	U32 count = 0;
+	for(const RenderQueueView& view : m_frcCtx->m_queueViews)
+	{
+		count += view.m_visibleSpatials.m_elementCount;
+	}
+
+	frc.m_visCache.m_spatials.destroy(alloc);
+	if(count > 0)
 	{
-		totalElCount += subStorages[i].m_elementCount;
+		frc.m_visCache.m_spatials.create(alloc, count);
 
-		if(subStorages[i].m_elementStorage > subStorages[biggestSubStorageIdx].m_elementStorage)
+		count = 0;
+		for(const RenderQueueView& view : m_frcCtx->m_queueViews)
 		{
-			biggestSubStorageIdx = i;
+			view.m_visibleSpatials.copyTo(&frc.m_visCache.m_spatials[count]);
+			count += view.m_visibleSpatials.m_elementCount;
 		}
 	}
 
-	if(totalElCount == 0)
+	frc.m_visCache.m_frustumTimestamp = frc.getTimestamp();
+	frc.m_visCache.m_octreeEpoch = m_frcCtx->m_octreeEpoch;
+}
+
+template<typename TGetKey>
+void CombineResultsTask::combineAndSortRenderables(SceneFrameAllocator<U8>& alloc,
+	ConstWeakArray<TRenderQueueElementStorage<RenderableQueueElement>> subStorages,
+	WeakArray<RenderableQueueElement>& combined,
+	TGetKey getKey)
+{
+	U32 count = 0;
+	for(const TRenderQueueElementStorage<RenderableQueueElement>& storage : subStorages)
+	{
+		count += storage.m_elementCount;
+	}
+
+	if(count < 2)
 	{
+		combineQueueElements<RenderableQueueElement>(alloc, subStorages, nullptr, combined, nullptr);
 		return;
 	}
 
-	// Count ptrSubStorage elements
-	T** ptrIt = nullptr;
-	if(ptrSubStorages != nullptr)
+	// Sort the keys and not the elements that are much bigger. The keys point to the elements inside the chunks
+	class KeyElement
 	{
-		ANKI_ASSERT(ptrCombined);
-		U32 ptrTotalElCount = (*ptrSubStorages)[0].m_elementCount;
+	public:
+		U64 m_key;
+		const RenderableQueueElement* m_element;
+	};
+
+	KeyElement* keys = alloc.newArray<KeyElement>(count * 2);
+	U32 keyCount = 0;
+	for(const TRenderQueueElementStorage<RenderableQueueElement>& storage : subStorages)
+	{
+		storage.iterateElements([&](const RenderableQueueElement& el) {
+			keys[keyCount].m_key = getKey(el);
+			keys[keyCount].m_element = &el;
+			++keyCount;
+		});
+	}
+	ANKI_ASSERT(keyCount == count);
 
-		for(U32 i = 1; i < ptrSubStorages->getSize(); ++i)
-		{
-			ptrTotalElCount += (*ptrSubStorages)[i].m_elementCount;
-		}
+	const WeakArray<KeyElement> sorted = radixSort(WeakArray<KeyElement>(keys, count),
+		WeakArray<KeyElement>(keys + count, count),
+		[](const KeyElement& k) { return k.m_key; });
 
-		// Create the new storage
-		if(ptrTotalElCount > 0)
-		{
-			ptrIt = alloc.newArray<T*>(ptrTotalElCount);
-			*ptrCombined = WeakArray<T*>(ptrIt, ptrTotalElCount);
-		}
+	// Write the elements in their final place. It's frame memory so there is no need to free the chunks
+	RenderableQueueElement* elements = SceneFrameAllocator<RenderableQueueElement>(alloc).allocate(count);
+	for(U32 i = 0; i < count; ++i)
+	{
+		elements[i] = *sorted[i].m_element;
 	}
 
-	T* it;
-	if(totalElCount > subStorages[biggestSubStorageIdx].m_elementStorage)
-	{
-		// Can't reuse any of the existing storage, will allocate a brand new one
+	combined = WeakArray<RenderableQueueElement>(elements, count);
+}
 
-		it = alloc.newArray<T>(totalElCount);
-		biggestSubStorageIdx = MAX_U32;
+template<typename T>
+void CombineResultsTask::combineQueueElements(SceneFrameAllocator<U8>& alloc,
+	ConstWeakArray<TRenderQueueElementStorage<T>> subStorages,
+	ConstWeakArray<TRenderQueueElementStorage<U32>>* ptrSubStorages,
+	WeakArray<T>& combined,
+	WeakArray<T*>* ptrCombined)
+{
+	// Count first so the elements are copied once to a storage of the exact size
+	U32 totalElCount = 0;
+	for(const TRenderQueueElementStorage<T>& storage : subStorages)
+	{
+		totalElCount += storage.m_elementCount;
+	}
 
-		combined = WeakArray<T>(it, totalElCount);
+	if(totalElCount == 0)
+	{
+		return;
 	}
-	else
+
+	// If a single chunk holds all the elements use it as is
+	T* elements = nullptr;
+	for(const TRenderQueueElementStorage<T>& storage : subStorages)
 	{
-		// Will reuse existing storage
+		if(storage.m_elementCount == totalElCount)
+		{
+			elements = storage.tryGetContiguousElements();
+			break;
+		}
+	}
 
-		it = subStorages[biggestSubStorageIdx].m_elements + subStorages[biggestSubStorageIdx].m_elementCount;
+	if(elements == nullptr)
+	{
+		elements = SceneFrameAllocator<T>(alloc).allocate(totalElCount);
 
-		combined = WeakArray<T>(subStorages[biggestSubStorageIdx].m_elements, totalElCount);
+		T* it = elements;
+		for(const TRenderQueueElementStorage<T>& storage : subStorages)
+		{
+			storage.copyTo(it);
+			it += storage.m_elementCount;
+		}
 	}
 
-	for(U32 i = 0; i < subStorages.getSize(); ++i)
+	combined = WeakArray<T>(elements, totalElCount);
+
+	// The pointers are indices to the elements of the same thread
+	if(ptrSubStorages != nullptr)
 	{
-		if(subStorages[i].m_elementCount == 0)
+		ANKI_ASSERT(ptrCombined);
+		U32 ptrTotalElCount = 0;
+		for(const TRenderQueueElementStorage<U32>& storage : *ptrSubStorages)
 		{
-			continue;
+			ptrTotalElCount += storage.m_elementCount;
 		}
 
-		// Copy the pointers
-		if(ptrIt)
+		if(ptrTotalElCount > 0)
 		{
-			T* base = (i != biggestSubStorageIdx) ? it : subStorages[biggestSubStorageIdx].m_elements;
+			T** ptrIt = alloc.newArray<T*>(ptrTotalElCount);
+			*ptrCombined = WeakArray<T*>(ptrIt, ptrTotalElCount);
 
-			for(U32 x = 0; x < (*ptrSubStorages)[i].m_elementCount; ++x)
+			T* base = elements;
+			for(U32 i = 0; i < subStorages.getSize(); ++i)
 			{
-				ANKI_ASSERT((*ptrSubStorages)[i].m_elements[x] < subStorages[i].m_elementCount);
-
-				*ptrIt = base + (*ptrSubStorages)[i].m_elements[x];
+				(*ptrSubStorages)[i].iterateElements([&](U32 idx) {
+					ANKI_ASSERT(idx < subStorages[i].m_elementCount);
+					*ptrIt = base + idx;
+					++ptrIt;
+				});
 
-				++ptrIt;
+				base += subStorages[i].m_elementCount;
 			}
 
-			ANKI_ASSERT(ptrIt <= ptrCombined->getEnd());
-		}
-
-		// Copy the elements
-		if(i != biggestSubStorageIdx)
-		{
-			memcpy(it, subStorages[i].m_elements, sizeof(T) * subStorages[i].m_elementCount);
-			it += subStorages[i].m_elementCount;
+			ANKI_ASSERT(ptrIt == ptrCombined->getEnd());
 		}
 	}
 }
@@ -833,7 +1256,13 @@ void SceneGraph::doVisibilityTests(SceneNode& fsn, SceneGraph& scene, RenderQueu
 	VisibilityContext ctx;
 	ctx.m_scene = &scene;
 	ctx.m_earlyZDist = scene.getLimits().m_earlyZDistance;
-	ctx.submitNewWork(fsn.getComponent<FrustumComponent>(), rqueue, hive);
+	ctx.m_mainCameraFrc = &fsn.getComponent<FrustumComponent>();
+	if(scene.getLimits().m_gpuOcclusionCulling)
+	{
+		ctx.m_gpuOcclusionCullingFrc = &fsn.getComponent<FrustumComponent>();
+	}
+	// The main frustum is in the critical path, the rest (shadows, probes etc) are not
+	ctx.submitNewWork(fsn.getComponent<FrustumComponent>(), rqueue, hive, ThreadHiveTaskPriority::HIGH);
 
 	hive.waitAllTasks();
 	ctx.m_testedFrcs.destroy(scene.getFrameAllocator());
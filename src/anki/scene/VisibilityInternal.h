@@ -9,8 +9,11 @@
 #include <anki/scene/SoftwareRasterizer.h>
 #include <anki/scene/components/FrustumComponent.h>
 #include <anki/scene/Octree.h>
+#include <anki/collision/Sphere.h>
 #include <anki/util/Thread.h>
+#include <anki/util/ThreadHive.h>
 #include <anki/util/Tracer.h>
+#include <anki/util/RadixSort.h>
 #include <anki/renderer/RenderQueue.h>
 
 namespace anki
@@ -23,80 +26,133 @@ static const U32 MAX_SPATIALS_PER_VIS_TEST = 48; ///< Num of spatials to test in
 static const U32 SW_RASTERIZER_WIDTH = 80;
 static const U32 SW_RASTERIZER_HEIGHT = 50;
 
-/// Sort objects on distance
-template<typename T>
-class DistanceSortFunctor
+/// Computes the 64bit keys the render queues are radix sorted with.
+class RenderableSortKey
 {
 public:
-	Bool operator()(const T& a, const T& b)
+	/// Front to back.
+	static U64 computeDistanceKey(const RenderableQueueElement& el)
 	{
-		return a.m_distanceFromCamera < b.m_distanceFromCamera;
+		// The distance is positive so its bits are ordered like integers
+		return floatBits(el.m_distanceFromCamera);
 	}
-};
 
-template<typename T>
-class RevDistanceSortFunctor
-{
-public:
-	Bool operator()(const T& a, const T& b)
+	/// Back to front.
+	static U64 computeReverseDistanceKey(const RenderableQueueElement& el)
 	{
-		return a.m_distanceFromCamera > b.m_distanceFromCamera;
+		return MAX_U32 - floatBits(el.m_distanceFromCamera);
 	}
-};
 
-/// Material and distance sort.
-class MaterialDistanceSortFunctor
-{
-public:
-	MaterialDistanceSortFunctor(F32 distanceGranularity)
-		: m_distGranularity(1.0f / distanceGranularity)
+	/// Front to back in buckets of some distance. Inside the bucket the elements that can be merged are consecutive.
+	static U64 computeMaterialDistanceKey(const RenderableQueueElement& el, F32 invDistanceGranularity)
 	{
+		const U64 bucket = min<U64>(U64(el.m_distanceFromCamera * invDistanceGranularity), MAX_U16);
+		return (bucket << 48u) | (el.m_mergeKey >> 16u);
 	}
 
-	Bool operator()(const RenderableQueueElement& a, const RenderableQueueElement& b)
+	/// Back to front in buckets of some distance. Inside the bucket the elements that can be merged are consecutive.
+	static U64 computeReverseMaterialDistanceKey(const RenderableQueueElement& el, F32 invDistanceGranularity)
 	{
-		const U32 aClass = U32(a.m_distanceFromCamera * m_distGranularity);
-		const U32 bClass = U32(b.m_distanceFromCamera * m_distGranularity);
+		const U64 bucket = MAX_U16 - min<U64>(U64(el.m_distanceFromCamera * invDistanceGranularity), MAX_U16);
+		return (bucket << 48u) | (el.m_mergeKey >> 16u);
+	}
 
-		if(aClass == bClass && a.m_callback == b.m_callback)
-		{
-			return a.m_mergeKey < b.m_mergeKey;
-		}
-		else
-		{
-			return a.m_distanceFromCamera < b.m_distanceFromCamera;
-		}
+	/// The static casters first and then the dynamic. In each group only the elements that can be merged are
+	/// consecutive because the draw order of the shadows doesn't matter.
+	static U64 computeShadowCasterKey(const RenderableQueueElement& el)
+	{
+		const U64 dynamicBit = (el.m_staticShadowCaster) ? 0 : (1ull << 63u);
+		return dynamicBit | (el.m_mergeKey >> 1u);
 	}
 
 private:
-	F32 m_distGranularity;
+	static U32 floatBits(F32 f)
+	{
+		ANKI_ASSERT(f >= 0.0f);
+		U32 bits;
+		memcpy(&bits, &f, sizeof(bits));
+		return bits;
+	}
 };
 
-/// Storage for a single element type.
-template<typename T, U32 INITIAL_STORAGE_SIZE = 32, U32 STORAGE_GROW_RATE = 4>
+/// Storage for a single element type. It's a list of chunks so growing it never moves the elements that are already
+/// written. CombineResultsTask counts the elements of all the threads and copies them once to their final place, or it
+/// uses a chunk as is if it holds all of them.
+template<typename T, U32 INITIAL_CHUNK_SIZE = 32, U32 CHUNK_GROW_RATE = 4>
 class TRenderQueueElementStorage
 {
 public:
-	T* m_elements = nullptr;
-	U32 m_elementCount = 0;
-	U32 m_elementStorage = 0;
+	class Chunk
+	{
+	public:
+		T* m_elements;
+		Chunk* m_next;
+		U32 m_elementCount;
+		U32 m_capacity;
+	};
+
+	Chunk* m_firstChunk = nullptr;
+	Chunk* m_lastChunk = nullptr;
+	U32 m_elementCount = 0; ///< The elements of all the chunks.
 
 	T* newElement(SceneFrameAllocator<T> alloc)
 	{
-		if(ANKI_UNLIKELY(m_elementCount + 1 > m_elementStorage))
+		if(ANKI_UNLIKELY(m_lastChunk == nullptr || m_lastChunk->m_elementCount == m_lastChunk->m_capacity))
 		{
-			m_elementStorage = max(INITIAL_STORAGE_SIZE, m_elementStorage * STORAGE_GROW_RATE);
+			newChunk(alloc);
+		}
+
+		++m_elementCount;
+		return &m_lastChunk->m_elements[m_lastChunk->m_elementCount++];
+	}
 
-			const T* oldElements = m_elements;
-			m_elements = alloc.allocate(m_elementStorage);
+	/// Get the elements if they are all in a single chunk.
+	T* tryGetContiguousElements() const
+	{
+		return (m_firstChunk && m_firstChunk == m_lastChunk) ? m_firstChunk->m_elements : nullptr;
+	}
 
-			if(oldElements)
+	/// Copy the elements to a memory that has room for m_elementCount elements.
+	void copyTo(T* out) const
+	{
+		for(const Chunk* chunk = m_firstChunk; chunk; chunk = chunk->m_next)
+		{
+			memcpy(out, chunk->m_elements, sizeof(T) * chunk->m_elementCount);
+			out += chunk->m_elementCount;
+		}
+	}
+
+	template<typename TFunc>
+	void iterateElements(TFunc func) const
+	{
+		for(const Chunk* chunk = m_firstChunk; chunk; chunk = chunk->m_next)
+		{
+			for(U32 i = 0; i < chunk->m_elementCount; ++i)
 			{
-				memcpy(m_elements, oldElements, sizeof(T) * m_elementCount);
+				func(chunk->m_elements[i]);
 			}
 		}
+	}
+
+private:
+	void newChunk(SceneFrameAllocator<T> alloc)
+	{
+		Chunk* chunk = alloc.template newInstance<Chunk>();
+		chunk->m_capacity = (m_lastChunk) ? m_lastChunk->m_capacity * CHUNK_GROW_RATE : INITIAL_CHUNK_SIZE;
+		chunk->m_elements = alloc.allocate(chunk->m_capacity);
+		chunk->m_next = nullptr;
+		chunk->m_elementCount = 0;
+
+		if(m_lastChunk)
+		{
+			m_lastChunk->m_next = chunk;
+		}
+		else
+		{
+			m_firstChunk = chunk;
+		}
 
-		return &m_elements[m_elementCount++];
+		m_lastChunk = chunk;
 	}
 };
 
@@ -118,7 +174,10 @@ public:
 	TRenderQueueElementStorage<GlobalIlluminationProbeQueueElement> m_giProbes;
 	TRenderQueueElementStorage<GenericGpuComputeJobQueueElement> m_genericGpuComputeJobs;
 
+	TRenderQueueElementStorage<SpatialComponent*> m_visibleSpatials; ///< Will populate the visibility cache.
+
 	Timestamp m_timestamp = 0;
+	Timestamp m_staticShadowCastersTimestamp = 0;
 
 	RenderQueueView()
 	{
@@ -128,6 +187,9 @@ public:
 
 static_assert(std::is_trivially_destructible<RenderQueueView>::value == true, "Should be trivially destructible");
 
+// Forward
+class FrustumVisibilityContext;
+
 /// Data common for all tasks.
 class VisibilityContext
 {
@@ -136,11 +198,37 @@ public:
 	Atomic<U32> m_testsCount = {0};
 
 	F32 m_earlyZDist = -1.0f; ///< Cache this.
+	const FrustumComponent* m_gpuOcclusionCullingFrc = nullptr; ///< The renderer culls the renderables of this one.
+	const FrustumComponent* m_mainCameraFrc = nullptr; ///< The renderables of this one pick their LODs.
 
 	List<const FrustumComponent*> m_testedFrcs;
 	Mutex m_mtx;
 
-	void submitNewWork(const FrustumComponent& frc, RenderQueue& result, ThreadHive& hive);
+	void submitNewWork(
+		const FrustumComponent& frc, RenderQueue& result, ThreadHive& hive, ThreadHiveTaskPriority priority);
+
+	/// Same as submitNewWork() for the faces of an omni light. The faces that can't use their visibility cache share a
+	/// single gather from the octree.
+	/// @param faces The frustums of the faces.
+	/// @param results The render queues of the faces.
+	/// @param volume The volume of the light. Everything that matters to the faces is inside it.
+	void submitNewOmniWork(ConstWeakArray<const FrustumComponent*> faces,
+		WeakArray<RenderQueue> results,
+		const Sphere& volume,
+		ThreadHive& hive,
+		ThreadHiveTaskPriority priority);
+
+private:
+	/// Prepare the context of a frustum.
+	/// @return nullptr if the frustum doesn't need to be tested.
+	FrustumVisibilityContext* newFrustumContext(
+		const FrustumComponent& frc, RenderQueue& rqueue, ThreadHive& hive, ThreadHiveTaskPriority priority);
+
+	/// Submit the tasks that gather the visibles of a frustum from the octree.
+	void submitGatherTasks(FrustumVisibilityContext& frcCtx, ThreadHive& hive);
+
+	/// Submit the task that will run after the visibility tests of a frustum.
+	void submitCombineTask(FrustumVisibilityContext& frcCtx, ThreadHive& hive);
 };
 
 /// A context for a specific test of a frustum component.
@@ -150,6 +238,15 @@ class FrustumVisibilityContext
 public:
 	VisibilityContext* m_visCtx = nullptr;
 	const FrustumComponent* m_frc = nullptr;
+	ThreadHiveTaskPriority m_priority = ThreadHiveTaskPriority::NORMAL; ///< The priority of all the tasks.
+
+	// Visibility cache members
+	U64 m_octreeEpoch = 0;
+	Bool m_useVisCache = false; ///< Skip the octree and the frustum tests and use the cached spatials.
+	Bool m_populateVisCache = false; ///< Store the spatials that passed the tests to the cache.
+
+	Bool m_skipRenderableOcclusionTests = false; ///< The GPU will do the occlusion tests of the renderables.
+	Bool m_spatialsInsideFrustum = false; ///< The gather tested the spatials against the frustum already.
 
 	// S/W rasterizer members
 	SoftwareRasterizer* m_r = nullptr;
@@ -205,6 +302,32 @@ private:
 static_assert(
 	std::is_trivially_destructible<GatherVisiblesFromOctreeTask>::value == true, "Should be trivially destructible");
 
+/// ThreadHive task that gets the visible nodes of the faces of an omni light from the octree. It walks the octree once
+/// with the volume of the light and then it sorts the spatials into faces.
+class GatherOmniVisiblesFromOctreeTask
+{
+public:
+	Array<FrustumVisibilityContext*, 6> m_frcCtxs = {};
+	U32 m_frcCtxCount = 0;
+	Sphere m_volume;
+
+	GatherOmniVisiblesFromOctreeTask(const Sphere& volume)
+		: m_volume(volume)
+	{
+	}
+
+	void gather(ThreadHive& hive);
+
+private:
+	Array2d<SpatialComponent*, 6, MAX_SPATIALS_PER_VIS_TEST> m_spatials;
+	Array<U32, 6> m_spatialCounts = {};
+
+	/// Submit tasks to test the m_spatials of a face.
+	void flush(U32 face, ThreadHive& hive);
+};
+static_assert(std::is_trivially_destructible<GatherOmniVisiblesFromOctreeTask>::value == true,
+	"Should be trivially destructible");
+
 /// ThreadHive task that does the actual visibility tests.
 class VisibilityTestTask
 {
@@ -245,12 +368,22 @@ public:
 	void combine();
 
 private:
+	void populateVisibilityCache();
+
 	template<typename T>
 	static void combineQueueElements(SceneFrameAllocator<U8>& alloc,
-		WeakArray<TRenderQueueElementStorage<T>> subStorages,
-		WeakArray<TRenderQueueElementStorage<U32>>* ptrSubStorage,
+		ConstWeakArray<TRenderQueueElementStorage<T>> subStorages,
+		ConstWeakArray<TRenderQueueElementStorage<U32>>* ptrSubStorage,
 		WeakArray<T>& combined,
 		WeakArray<T*>* ptrCombined);
+
+	/// Combine the renderables of the threads in the order of the key returned by getKey. Only the keys are sorted and
+	/// every element is copied once, to its final place.
+	template<typename TGetKey>
+	static void combineAndSortRenderables(SceneFrameAllocator<U8>& alloc,
+		ConstWeakArray<TRenderQueueElementStorage<RenderableQueueElement>> subStorages,
+		WeakArray<RenderableQueueElement>& combined,
+		TGetKey getKey);
 };
 static_assert(std::is_trivially_destructible<CombineResultsTask>::value == true, "Should be trivially destructible");
 /// @}
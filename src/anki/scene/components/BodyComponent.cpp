@@ -4,6 +4,8 @@
 // http://www.anki3d.org/LICENSE
 
 #include <anki/scene/components/BodyComponent.h>
+#include <anki/scene/SceneNode.h>
+#include <anki/scene/SceneGraph.h>
 
 namespace anki
 {
@@ -12,4 +14,26 @@ BodyComponent::~BodyComponent()
 {
 }
 
+Error BodyComponent::update(SceneNode& node, Second prevTime, Second crntTime, Bool& updated)
+{
+	const Transform newTrf = m_body->getTransform();
+	updated = newTrf != m_trf;
+	m_trf = newTrf;
+
+	// The far dynamic bodies sleep till something hits them
+	if(m_body->getMass() > 0.0f)
+	{
+		const SceneGraph& scene = node.getSceneGraph();
+		const F32 dist = (m_trf.getOrigin().xyz() - scene.getLodOrigin()).getLength();
+		const Bool sleep = dist > scene.getLimits().m_physicsLodDistance1;
+		if(sleep != m_sleeping)
+		{
+			m_body->setSleeping(sleep);
+			m_sleeping = sleep;
+		}
+	}
+
+	return Error::NONE;
+}
+
 } // end namespace anki
@@ -43,17 +43,12 @@ public:
 		return m_body;
 	}
 
-	ANKI_USE_RESULT Error update(SceneNode& node, Second, Second, Bool& updated) override
-	{
-		Transform newTrf = m_body->getTransform();
-		updated = newTrf != m_trf;
-		m_trf = newTrf;
-		return Error::NONE;
-	}
+	ANKI_USE_RESULT Error update(SceneNode& node, Second prevTime, Second crntTime, Bool& updated) override;
 
 private:
 	PhysicsBodyPtr m_body;
 	Transform m_trf = Transform::getIdentity();
+	Bool m_sleeping = false; ///< The body is too far and it's put to sleep.
 };
 /// @}
 
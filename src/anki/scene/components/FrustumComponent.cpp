@@ -35,6 +35,17 @@ FrustumComponent::FrustumComponent(SceneNode* node, FrustumType frustumType)
 FrustumComponent::~FrustumComponent()
 {
 	m_coverageBuff.m_depthMap.destroy(m_node->getAllocator());
+	m_visCache.m_spatials.destroy(m_node->getAllocator());
+}
+
+void FrustumComponent::setVisibilityCacheEnabled(Bool enable)
+{
+	m_visCache.m_enabled = enable;
+	m_visCache.m_octreeEpoch = 0;
+	if(!enable)
+	{
+		m_visCache.m_spatials.destroy(m_node->getAllocator());
+	}
 }
 
 Bool FrustumComponent::updateInternal()
@@ -53,9 +64,19 @@ Bool FrustumComponent::updateInternal()
 		{
 			m_projMat = Mat4::calculatePerspectiveProjectionMatrix(
 				m_perspective.m_fovX, m_perspective.m_fovY, m_perspective.m_near, m_perspective.m_far);
-
-			computeEdgesOfFrustum(
-				m_perspective.m_far, m_perspective.m_fovY, m_perspective.m_fovY, &m_perspective.m_edgesL[0]);
+			m_unprojParams = m_projMat.extractPerspectiveUnprojectionParams();
+
+			// The cube map faces are common enough to skip the trigonometry
+			const F32 cubeFaceFov = toRad(90.0f);
+			if(m_perspective.m_fovX == cubeFaceFov && m_perspective.m_fovY == cubeFaceFov)
+			{
+				computeEdgesOfCubeFaceFrustum(m_perspective.m_far, &m_perspective.m_edgesL[0]);
+			}
+			else
+			{
+				computeEdgesOfFrustum(
+					m_perspective.m_far, m_perspective.m_fovY, m_perspective.m_fovY, &m_perspective.m_edgesL[0]);
+			}
 
 			// Planes
 			F32 c, s; // cos & sine
@@ -81,6 +102,7 @@ Bool FrustumComponent::updateInternal()
 		{
 			m_projMat = Mat4::calculateOrthographicProjectionMatrix(
 				m_ortho.m_right, m_ortho.m_left, m_ortho.m_top, m_ortho.m_bottom, m_ortho.m_near, m_ortho.m_far);
+			m_unprojParams = Vec4(0.0f);
 
 			// OBB
 			const Vec4 c((m_ortho.m_right + m_ortho.m_left) * 0.5f,
@@ -112,6 +134,7 @@ Bool FrustumComponent::updateInternal()
 	if(updated)
 	{
 		m_viewProjMat = m_projMat * m_viewMat;
+		m_invViewProjMat = m_viewProjMat.getInverse();
 		m_shapeMarkedForUpdate = false;
 		m_trfMarkedForUpdate = false;
 
@@ -134,6 +157,8 @@ Bool FrustumComponent::updateInternal()
 		{
 			m_viewPlanesW[planeId] = m_viewPlanesL[planeId].getTransformed(m_trf);
 		}
+
+		m_viewPlanesWideW.setPlanes(m_viewPlanesW);
 	}
 
 	return updated;
@@ -11,6 +11,7 @@
 #include <anki/collision/Obb.h>
 #include <anki/collision/ConvexHullShape.h>
 #include <anki/collision/Plane.h>
+#include <anki/collision/PlanesWide.h>
 
 namespace anki
 {
@@ -54,6 +55,10 @@ ANKI_ENUM_ALLOW_NUMERIC_OPERATIONS(FrustumComponentVisibilityTestFlag, inline)
 /// Frustum component. Useful for nodes that take part in visibility tests like cameras and lights.
 class FrustumComponent : public SceneComponent
 {
+	friend class VisibilityContext;
+	friend class GatherVisiblesFromOctreeTask;
+	friend class CombineResultsTask;
+
 public:
 	static const SceneComponentType CLASS_TYPE = SceneComponentType::FRUSTUM;
 
@@ -181,6 +186,18 @@ public:
 		return m_prevViewProjMat;
 	}
 
+	const Mat4& getInverseViewProjectionMatrix() const
+	{
+		return m_invViewProjMat;
+	}
+
+	/// Get the parameters that unproject a depth value to view space. See Mat4::extractPerspectiveUnprojectionParams.
+	/// It's zero for orthographic frustums.
+	const Vec4& getUnprojectionParameters() const
+	{
+		return m_unprojParams;
+	}
+
 	/// Check if a shape is inside the frustum.
 	template<typename T>
 	Bool insideFrustum(const T& t) const
@@ -196,6 +213,24 @@ public:
 		return true;
 	}
 
+	/// Check if a box is inside the frustum. It tests all the planes at once.
+	Bool insideFrustum(const Aabb& aabb) const
+	{
+		return m_viewPlanesWideW.insideAll(aabb);
+	}
+
+	/// Check if a sphere is inside the frustum. It tests all the planes at once.
+	Bool insideFrustum(const Sphere& sphere) const
+	{
+		return m_viewPlanesWideW.insideAll(sphere);
+	}
+
+	/// Check if an oriented box is inside the frustum. It tests all the planes at once.
+	Bool insideFrustum(const Obb& obb) const
+	{
+		return m_viewPlanesWideW.insideAll(obb);
+	}
+
 	ANKI_USE_RESULT Error update(SceneNode& node, Second prevTime, Second crntTime, Bool& updated) override
 	{
 		ANKI_ASSERT(&node == m_node);
@@ -215,6 +250,16 @@ public:
 		return !!(m_flags & FrustumComponentVisibilityTestFlag::ALL);
 	}
 
+	/// Keep the results of the visibility tests across frames. They will be re-used while the frustum and the octree
+	/// don't change. Good for frustums that rarely move like the ones of lights and probes.
+	/// @note Don't enable it for frustums that live only for a frame.
+	void setVisibilityCacheEnabled(Bool enable);
+
+	Bool getVisibilityCacheEnabled() const
+	{
+		return m_visCache.m_enabled;
+	}
+
 	/// The type is FillCoverageBufferCallback.
 	static void fillCoverageBufferCallback(void* userData, F32* depthValues, U32 width, U32 height);
 
@@ -311,12 +356,15 @@ private:
 	// View planes
 	Array<Plane, U(FrustumPlaneType::COUNT)> m_viewPlanesL;
 	Array<Plane, U(FrustumPlaneType::COUNT)> m_viewPlanesW;
+	PlanesWide m_viewPlanesWideW; ///< Same as m_viewPlanesW in SoA layout for faster culling.
 
 	Transform m_trf = Transform::getIdentity();
 	Mat4 m_projMat = Mat4::getIdentity(); ///< Projection matrix
 	Mat4 m_viewMat = Mat4::getIdentity(); ///< View matrix
 	Mat4 m_viewProjMat = Mat4::getIdentity(); ///< View projection matrix
 	Mat4 m_prevViewProjMat = Mat4::getIdentity();
+	Mat4 m_invViewProjMat = Mat4::getIdentity();
+	Vec4 m_unprojParams = Vec4(0.0f);
 
 	/// How far to render shadows for this frustum. If negative it's the m_frustum's far.
 	F32 m_effectiveShadowDist = -1.0f;
@@ -329,6 +377,15 @@ private:
 		U32 m_depthMapHeight = 0;
 	} m_coverageBuff; ///< Coverage buffer for extra visibility tests.
 
+	class
+	{
+	public:
+		DynamicArray<SpatialComponent*> m_spatials; ///< The spatials that passed the tests.
+		Timestamp m_frustumTimestamp = 0; ///< The timestamp of the frustum when the cache was populated.
+		U64 m_octreeEpoch = 0; ///< The Octree::getChangeEpoch() when the cache was populated. Zero is invalid.
+		Bool m_enabled = false;
+	} m_visCache; ///< Cached results of the visibility tests.
+
 	FrustumComponentVisibilityTestFlag m_flags = FrustumComponentVisibilityTestFlag::NONE;
 	Bool m_shapeMarkedForUpdate = true;
 	Bool m_trfMarkedForUpdate = true;
@@ -29,11 +29,19 @@ public:
 	{
 	}
 
-	void setCallback(GenericGpuComputeJobQueueElementCallback callback, const void* userData)
+	/// @param mergeKey The jobs with the same callback and merge key are merged. Zero means no merging. See
+	///                 GenericGpuComputeJobQueueElement::m_mergeKey.
+	/// @param asyncCompute The job can run on the async compute queue.
+	void setCallback(GenericGpuComputeJobQueueElementCallback callback,
+		const void* userData,
+		U64 mergeKey = 0,
+		Bool asyncCompute = false)
 	{
 		ANKI_ASSERT(callback && userData);
 		m_callback = callback;
 		m_userData = userData;
+		m_mergeKey = mergeKey;
+		m_asyncCompute = asyncCompute;
 	}
 
 	void setupGenericGpuComputeJobQueueElement(GenericGpuComputeJobQueueElement& el)
@@ -41,11 +49,15 @@ public:
 		ANKI_ASSERT(m_callback && m_userData);
 		el.m_callback = m_callback;
 		el.m_userData = m_userData;
+		el.m_mergeKey = m_mergeKey;
+		el.m_asyncCompute = m_asyncCompute;
 	}
 
 private:
 	GenericGpuComputeJobQueueElementCallback m_callback = nullptr;
 	const void* m_userData = nullptr;
+	U64 m_mergeKey = 0;
+	Bool m_asyncCompute = false;
 };
 /// @}
 
@@ -5,6 +5,7 @@
 
 #include <anki/scene/components/MoveComponent.h>
 #include <anki/scene/SceneNode.h>
+#include <anki/math/SimdWide.h>
 
 namespace anki
 {
@@ -20,58 +21,194 @@ MoveComponent::~MoveComponent()
 {
 }
 
+void MoveComponent::markForUpdate()
+{
+	m_flags.set(MoveComponentFlag::MARKED_FOR_UPDATE);
+
+	if(m_node)
+	{
+		m_node->markDirty();
+	}
+}
+
 Error MoveComponent::update(SceneNode& node, Second prevTime, Second crntTime, Bool& updated)
 {
-	updated = updateWorldTransform(node);
+	MoveComponentUpdateRequest request;
+	request.m_node = &node;
+	request.m_component = this;
+	updateBatch(WeakArray<MoveComponentUpdateRequest>(&request, 1));
+
+	updated = request.m_updated;
 	return Error::NONE;
 }
 
-Bool MoveComponent::updateWorldTransform(SceneNode& node)
+void MoveComponent::updateBatch(WeakArray<MoveComponentUpdateRequest> requests)
 {
-	m_prevWTrf = m_wtrf;
-	const Bool dirty = m_flags.get(MoveComponentFlag::MARKED_FOR_UPDATE);
-
-	// If dirty then update world transform
-	if(dirty)
+	// Update the trivial ones in place and gather the rest in chunks
+	constexpr U32 CHUNK_SIZE = 32;
+	Array<const MoveComponent*, CHUNK_SIZE> parents;
+	Array<MoveComponent*, CHUNK_SIZE> components;
+	U32 count = 0;
+	for(MoveComponentUpdateRequest& request : requests)
 	{
-		const SceneNode* parent = node.getParent();
+		ANKI_ASSERT(request.m_node && request.m_component);
 
-		if(parent)
+		const MoveComponent* parentMove = nullptr;
+		request.m_updated = request.m_component->updateWorldTransform(*request.m_node, parentMove);
+
+		if(parentMove)
 		{
-			const MoveComponent* parentMove = parent->tryGetComponent<MoveComponent>();
+			parents[count] = parentMove;
+			components[count] = request.m_component;
+			++count;
 
-			if(parentMove == nullptr)
+			if(count == CHUNK_SIZE)
 			{
-				// Parent not movable
-				m_wtrf = m_ltrf;
+				combineWorldTransforms(ConstWeakArray<const MoveComponent*>(&parents[0], count),
+					ConstWeakArray<MoveComponent*>(&components[0], count));
+				count = 0;
 			}
-			else if(m_flags.get(MoveComponentFlag::IGNORE_PARENT_TRANSFORM))
+		}
+	}
+
+	if(count)
+	{
+		combineWorldTransforms(ConstWeakArray<const MoveComponent*>(&parents[0], count),
+			ConstWeakArray<MoveComponent*>(&components[0], count));
+	}
+}
+
+void MoveComponent::combineWorldTransforms(
+	ConstWeakArray<const MoveComponent*> parents, ConstWeakArray<MoveComponent*> components)
+{
+	ANKI_ASSERT(parents.getSize() == components.getSize());
+
+	constexpr U32 LANE_COUNT = F32x4::LANE_COUNT;
+
+	for(U32 first = 0; first < components.getSize(); first += LANE_COUNT)
+	{
+		const U32 count = min(components.getSize() - first, LANE_COUNT);
+
+		// Gather to SoA. "a" is the parent's world transform and "b" the local one. Repeat the last pair in the unused
+		// lanes
+		Array<Array<F32, LANE_COUNT>, 12> aRot, bRot;
+		Array<Array<F32, LANE_COUNT>, 3> aOrigin, bOrigin;
+		Array<F32, LANE_COUNT> aScale, bScale;
+		for(U32 lane = 0; lane < LANE_COUNT; ++lane)
+		{
+			const U32 idx = first + min(lane, count - 1);
+			const Transform& a = parents[idx]->m_wtrf;
+			const Transform& b = components[idx]->m_ltrf;
+
+			for(U32 i = 0; i < 3; ++i)
 			{
-				m_wtrf = m_ltrf;
+				for(U32 j = 0; j < 4; ++j)
+				{
+					aRot[i * 4 + j][lane] = a.getRotation()(i, j);
+					bRot[i * 4 + j][lane] = b.getRotation()(i, j);
+				}
+
+				aOrigin[i][lane] = a.getOrigin()[i];
+				bOrigin[i][lane] = b.getOrigin()[i];
 			}
-			else if(m_flags.get(MoveComponentFlag::IGNORE_LOCAL_TRANSFORM))
+
+			aScale[lane] = a.getScale();
+			bScale[lane] = b.getScale();
+		}
+
+		Array<F32x4, 12> a, b;
+		for(U32 i = 0; i < 12; ++i)
+		{
+			a[i] = F32x4::load(&aRot[i][0]);
+			b[i] = F32x4::load(&bRot[i][0]);
+		}
+
+		const F32x4 as = F32x4::load(&aScale[0]);
+		const F32x4 bo0 = F32x4::load(&bOrigin[0][0]) * as;
+		const F32x4 bo1 = F32x4::load(&bOrigin[1][0]) * as;
+		const F32x4 bo2 = F32x4::load(&bOrigin[2][0]) * as;
+
+		// Same as Transform::combineTransformations
+		Array<Array<F32, LANE_COUNT>, 12> outRot;
+		Array<Array<F32, LANE_COUNT>, 3> outOrigin;
+		Array<F32, LANE_COUNT> outScale;
+		for(U32 i = 0; i < 3; ++i)
+		{
+			const F32x4& a0 = a[i * 4 + 0];
+			const F32x4& a1 = a[i * 4 + 1];
+			const F32x4& a2 = a[i * 4 + 2];
+
+			for(U32 j = 0; j < 4; ++j)
 			{
-				m_wtrf = parentMove->getWorldTransform();
+				F32x4 c = (j == 3) ? a[i * 4 + 3] : F32x4(0.0f);
+				c = F32x4::mulAdd(a0, b[0 * 4 + j], c);
+				c = F32x4::mulAdd(a1, b[1 * 4 + j], c);
+				c = F32x4::mulAdd(a2, b[2 * 4 + j], c);
+				c.store(&outRot[i * 4 + j][0]);
 			}
-			else
+
+			F32x4 o = F32x4::load(&aOrigin[i][0]);
+			o = F32x4::mulAdd(a0, bo0, o);
+			o = F32x4::mulAdd(a1, bo1, o);
+			o = F32x4::mulAdd(a2, bo2, o);
+			o.store(&outOrigin[i][0]);
+		}
+
+		(as * F32x4::load(&bScale[0])).store(&outScale[0]);
+
+		// Scatter
+		for(U32 lane = 0; lane < count; ++lane)
+		{
+			Mat3x4 rot;
+			for(U32 i = 0; i < 3; ++i)
 			{
-				m_wtrf = parentMove->getWorldTransform().combineTransformations(m_ltrf);
+				for(U32 j = 0; j < 4; ++j)
+				{
+					rot(i, j) = outRot[i * 4 + j][lane];
+				}
 			}
+
+			components[first + lane]->m_wtrf = Transform(
+				Vec4(outOrigin[0][lane], outOrigin[1][lane], outOrigin[2][lane], 0.0f), rot, outScale[lane]);
 		}
-		else
-		{
-			// No parent
+	}
+}
+
+Bool MoveComponent::updateWorldTransform(SceneNode& node, const MoveComponent*& parentMove)
+{
+	m_prevWTrf = m_wtrf;
+	const Bool dirty = m_flags.get(MoveComponentFlag::MARKED_FOR_UPDATE);
+	parentMove = nullptr;
 
+	// If dirty then update world transform
+	if(dirty)
+	{
+		const SceneNode* parent = node.getParent();
+		const MoveComponent* parentMove_ = (parent) ? parent->tryGetComponent<MoveComponent>() : nullptr;
+
+		if(parentMove_ == nullptr)
+		{
+			// No parent or parent not movable
+			m_wtrf = m_ltrf;
+		}
+		else if(m_flags.get(MoveComponentFlag::IGNORE_PARENT_TRANSFORM))
+		{
 			m_wtrf = m_ltrf;
 		}
+		else if(m_flags.get(MoveComponentFlag::IGNORE_LOCAL_TRANSFORM))
+		{
+			m_wtrf = parentMove_->getWorldTransform();
+		}
+		else
+		{
+			// The caller will combine the transforms
+			parentMove = parentMove_;
+		}
 
 		// Now it's a good time to cleanse parent
 		m_flags.unset(MoveComponentFlag::MARKED_FOR_UPDATE);
-	}
 
-	// If this is dirty then make children dirty as well. Don't walk the whole tree because you will re-walk it later
-	if(dirty)
-	{
+		// Make children dirty as well. Don't walk the whole tree because you will re-walk it later
 		Error err = node.visitChildrenMaxDepth(1, [](SceneNode& childNode) -> Error {
 			Error e = childNode.iterateComponentsOfType<MoveComponent>([](MoveComponent& mov) -> Error {
 				mov.markForUpdate();
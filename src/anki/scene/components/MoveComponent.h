@@ -9,6 +9,7 @@
 #include <anki/scene/components/SceneComponent.h>
 #include <anki/util/BitMask.h>
 #include <anki/util/Enum.h>
+#include <anki/util/WeakArray.h>
 #include <anki/Math.h>
 
 namespace anki
@@ -32,6 +33,18 @@ enum class MoveComponentFlag : U8
 };
 ANKI_ENUM_ALLOW_NUMERIC_OPERATIONS(MoveComponentFlag, inline)
 
+// Forward
+class MoveComponent;
+
+/// An argument to MoveComponent::updateBatch.
+class MoveComponentUpdateRequest
+{
+public:
+	SceneNode* m_node = nullptr;
+	MoveComponent* m_component = nullptr;
+	Bool m_updated = false; ///< [out] True if the world transform got updated.
+};
+
 /// Interface for movable scene nodes
 class MoveComponent : public SceneComponent
 {
@@ -100,6 +113,17 @@ public:
 
 	ANKI_USE_RESULT Error update(SceneNode& node, Second prevTime, Second crntTime, Bool& updated) override;
 
+	/// Don't call it. The SceneNode connects itself so that moving a static node marks it dirty.
+	void setSceneNode(SceneNode* node)
+	{
+		m_node = node;
+	}
+
+	/// Update many components at once. It's the same as calling update() on each one of them but the transforms that
+	/// need to be combined with the parent's are gathered and combined F32x4::LANE_COUNT at a time. The parents of the
+	/// nodes should have been updated already and no node should be the parent of another.
+	static void updateBatch(WeakArray<MoveComponentUpdateRequest> requests);
+
 	/// @name Mess with the local transform
 	/// @{
 	void rotateLocalX(F32 angDegrees)
@@ -167,13 +191,17 @@ private:
 
 	BitMask<MoveComponentFlag> m_flags;
 
-	void markForUpdate()
-	{
-		m_flags.set(MoveComponentFlag::MARKED_FOR_UPDATE);
-	}
+	SceneNode* m_node = nullptr;
+
+	void markForUpdate();
+
+	/// Called every frame. It updates the @a m_wtrf if it's marked for update. Then it marks the children. If the world
+	/// transform should be combined with the parent's it doesn't update it and it returns the parent's component.
+	Bool updateWorldTransform(SceneNode& node, const MoveComponent*& parentMove);
 
-	/// Called every frame. It updates the @a m_wtrf if @a shouldUpdateWTrf is true. Then it moves to the children.
-	Bool updateWorldTransform(SceneNode& node);
+	/// Combine the world transforms of the parents with the local transforms of the components.
+	static void combineWorldTransforms(
+		ConstWeakArray<const MoveComponent*> parents, ConstWeakArray<MoveComponent*> components);
 };
 /// @}
 
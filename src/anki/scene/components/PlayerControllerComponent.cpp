@@ -0,0 +1,36 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/scene/components/PlayerControllerComponent.h>
+#include <anki/scene/SceneNode.h>
+#include <anki/scene/SceneGraph.h>
+
+namespace anki
+{
+
+Error PlayerControllerComponent::update(SceneNode& node, Second prevTime, Second crntTime, Bool& updated)
+{
+	m_trf = m_player->getTransform(updated);
+
+	// The far controllers don't need every physics step
+	const SceneGraph& scene = node.getSceneGraph();
+	const F32 dist = (m_trf.getOrigin().xyz() - scene.getLodOrigin()).getLength();
+	if(dist > scene.getLimits().m_physicsLodDistance1)
+	{
+		m_player->setUpdateInterval(4);
+	}
+	else if(dist > scene.getLimits().m_physicsLodDistance0)
+	{
+		m_player->setUpdateInterval(2);
+	}
+	else
+	{
+		m_player->setUpdateInterval(1);
+	}
+
+	return Error::NONE;
+}
+
+} // end namespace anki
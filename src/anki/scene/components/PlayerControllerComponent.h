@@ -48,11 +48,7 @@ public:
 		m_player->moveToPosition(pos);
 	}
 
-	ANKI_USE_RESULT Error update(SceneNode& node, Second prevTime, Second crntTime, Bool& updated) override
-	{
-		m_trf = m_player->getTransform(updated);
-		return Error::NONE;
-	}
+	ANKI_USE_RESULT Error update(SceneNode& node, Second prevTime, Second crntTime, Bool& updated) override;
 
 	PhysicsPlayerControllerPtr getPhysicsPlayerController() const
 	{
@@ -5,6 +5,7 @@
 
 #include <anki/scene/components/RenderComponent.h>
 #include <anki/scene/SceneNode.h>
+#include <anki/scene/SceneGraph.h>
 #include <anki/resource/TextureResource.h>
 #include <anki/resource/ResourceManager.h>
 #include <anki/util/Logger.h>
@@ -12,6 +13,96 @@
 namespace anki
 {
 
+F32 RenderComponent::getLodScreenSize(U32 lod, const SceneGraphLimits& limits) const
+{
+	return (lod < m_lodScreenSizeCount) ? m_lodScreenSizes[lod] : limits.m_lodScreenSizes[lod];
+}
+
+void RenderComponent::updateLod(F32 screenSize, const SceneGraphLimits& limits, Timestamp timestamp)
+{
+	const U32 maxLod = m_lodCount - 1u;
+	U32 lod = m_lod;
+
+	if(m_lodTimestamp == 0 || m_lodTimestamp + 1 < timestamp)
+	{
+		// Wasn't visible in the previous frame, pick the LOD without hysteresis and don't fade
+		lod = 0;
+		while(lod < maxLod && screenSize < getLodScreenSize(lod, limits))
+		{
+			++lod;
+		}
+
+		m_lod = m_prevLod = U8(lod);
+		m_lodFade = 1.0f;
+	}
+	else
+	{
+		// The size has to overshoot the thresholds a bit to change LOD. That stops the popping back and forth
+		while(lod > 0 && screenSize > getLodScreenSize(lod - 1, limits) * (1.0f + limits.m_lodHysteresis))
+		{
+			--lod;
+		}
+
+		while(lod < maxLod && screenSize < getLodScreenSize(lod, limits) * (1.0f - limits.m_lodHysteresis))
+		{
+			++lod;
+		}
+
+		if(lod != m_lod)
+		{
+			const Bool crossFade =
+				!!(m_flags & RenderComponentFlag::LOD_CROSS_FADE) && limits.m_lodCrossFadeFrameCount > 0;
+
+			m_prevLod = m_lod;
+			m_lod = U8(lod);
+			m_lodChangeTimestamp = timestamp;
+			m_lodFade = (crossFade) ? 0.0f : 1.0f;
+		}
+
+		if(m_lodFade < 1.0f)
+		{
+			m_lodFade =
+				min(1.0f, F32(timestamp - m_lodChangeTimestamp + 1) / F32(limits.m_lodCrossFadeFrameCount));
+		}
+	}
+
+	m_lodTimestamp = timestamp;
+}
+
+/// Get the variable of the material of an instance. The instances of bindless materials might have different materials
+/// of the same program so the variables are in the same order.
+static const MaterialVariable& getInstanceVariable(
+	const MaterialVariable& mvar, ConstWeakArray<const MaterialRenderComponent*> instances, U32 instanceIdx)
+{
+	if(instances.getSize() == 0)
+	{
+		return mvar;
+	}
+
+	const ConstWeakArray<MaterialVariable> vars = instances[instanceIdx]->getMaterial().getVariables();
+	const MaterialVariable& out = vars[U32(&mvar - &instances[0]->getMaterial().getVariables()[0])];
+	ANKI_ASSERT(out.getName() == mvar.getName());
+	return out;
+}
+
+/// Write the values of a per instance variable of a bindless material.
+template<typename T>
+static void writeInstancedVariable(const MaterialVariable& mvar,
+	const MaterialVariant& variant,
+	ConstWeakArray<const MaterialRenderComponent*> instances,
+	U32 instanceCount,
+	void* uniformsBegin,
+	const void* uniformsEnd)
+{
+	Array<T, MAX_INSTANCES> vals;
+	for(U32 i = 0; i < instanceCount; ++i)
+	{
+		vals[i] = getInstanceVariable(mvar, instances, i).getValue<T>();
+	}
+
+	variant.writeShaderBlockMemory(mvar, &vals[0], instanceCount, uniformsBegin, uniformsEnd);
+}
+
 MaterialRenderComponent::MaterialRenderComponent(SceneNode* node, MaterialResourcePtr mtl)
 	: m_node(node)
 	, m_mtl(mtl)
@@ -37,13 +128,23 @@ MaterialRenderComponent::~MaterialRenderComponent()
 	m_vars.destroy(m_node->getAllocator());
 }
 
+void MaterialRenderComponent::requestResidency(F32 screenSize) const
+{
+	m_mtl->requestTextureResidency(screenSize);
+}
+
 void MaterialRenderComponent::allocateAndSetupUniforms(const RenderQueueDrawContext& ctx,
 	ConstWeakArray<Mat4> transforms,
 	ConstWeakArray<Mat4> prevTransforms,
-	StagingGpuMemoryManager& alloc) const
+	StagingGpuMemoryManager& alloc,
+	ConstWeakArray<F32> lodFades,
+	ConstWeakArray<const MaterialRenderComponent*> instances) const
 {
 	ANKI_ASSERT(transforms.getSize() <= MAX_INSTANCES);
 	ANKI_ASSERT(prevTransforms.getSize() == transforms.getSize());
+	ANKI_ASSERT(lodFades.getSize() == 0 || lodFades.getSize() == transforms.getSize());
+	ANKI_ASSERT(instances.getSize() == 0 || (instances.getSize() == transforms.getSize() && m_mtl->isBindless()));
+	ANKI_ASSERT(instances.getSize() == 0 || instances[0] == this);
 
 	const MaterialVariant& variant = m_mtl->getOrCreateVariant(ctx.m_key);
 	const U32 set = m_mtl->getDescriptorSetIndex();
@@ -56,41 +157,103 @@ void MaterialRenderComponent::allocateAndSetupUniforms(const RenderQueueDrawCont
 	ctx.m_commandBuffer->bindUniformBuffer(
 		set, m_mtl->getUniformsBinding(), token.m_buffer, token.m_offset, token.m_range);
 
+	if(m_mtl->getBindlessDescriptorSetIndex() != MAX_U32)
+	{
+		ctx.m_commandBuffer->bindAllBindless(m_mtl->getBindlessDescriptorSetIndex());
+	}
+
+	// The values of the material are the same in all draws, copy them first
+	variant.writeConstantShaderBlockMemory(uniformsBegin, uniformsEnd);
+
 	// Iterate variables
 	for(auto it = m_vars.getBegin(); it != m_vars.getEnd(); ++it)
 	{
 		const MaterialRenderComponentVariable& var = *it;
 		const MaterialVariable& mvar = var.getMaterialVariable();
 
-		if(!variant.isVariableActive(mvar))
+		if(!variant.isVariableActive(mvar) || (mvar.inBlock() && !mvar.isBuildin() && !mvar.isInstanced()))
 		{
 			continue;
 		}
 
+		// The per instance values of bindless materials
+		if(mvar.isInstanced() && !mvar.isBuildin())
+		{
+			ANKI_ASSERT(m_mtl->isBindless() && transforms.getSize() > 0);
+			const U32 instanceCount = transforms.getSize();
+
+			switch(mvar.getDataType())
+			{
+			case ShaderVariableDataType::UINT:
+			{
+				Array<U32, MAX_INSTANCES> vals;
+				for(U32 i = 0; i < instanceCount; ++i)
+				{
+					const MaterialVariable& instanceVar = getInstanceVariable(mvar, instances, i);
+					vals[i] = (instanceVar.isBindlessTexture())
+								  ? ctx.m_commandBuffer->bindBindlessTexture(
+									  instanceVar.getValue<TextureResourcePtr>()->getGrTextureView(),
+									  TextureUsageBit::SAMPLED_FRAGMENT)
+								  : instanceVar.getValue<U32>();
+				}
+
+				variant.writeShaderBlockMemory(mvar, &vals[0], instanceCount, uniformsBegin, uniformsEnd);
+				break;
+			}
+			case ShaderVariableDataType::FLOAT:
+				writeInstancedVariable<F32>(mvar, variant, instances, instanceCount, uniformsBegin, uniformsEnd);
+				break;
+			case ShaderVariableDataType::VEC2:
+				writeInstancedVariable<Vec2>(mvar, variant, instances, instanceCount, uniformsBegin, uniformsEnd);
+				break;
+			case ShaderVariableDataType::VEC3:
+				writeInstancedVariable<Vec3>(mvar, variant, instances, instanceCount, uniformsBegin, uniformsEnd);
+				break;
+			case ShaderVariableDataType::VEC4:
+				writeInstancedVariable<Vec4>(mvar, variant, instances, instanceCount, uniformsBegin, uniformsEnd);
+				break;
+			case ShaderVariableDataType::MAT3:
+				writeInstancedVariable<Mat3>(mvar, variant, instances, instanceCount, uniformsBegin, uniformsEnd);
+				break;
+			case ShaderVariableDataType::MAT4:
+				writeInstancedVariable<Mat4>(mvar, variant, instances, instanceCount, uniformsBegin, uniformsEnd);
+				break;
+			default:
+				ANKI_ASSERT(0);
+			}
+
+			continue;
+		}
+
 		switch(mvar.getDataType())
 		{
 		case ShaderVariableDataType::FLOAT:
 		{
-			const F32 val = mvar.getValue<F32>();
-			variant.writeShaderBlockMemory(mvar, &val, 1, uniformsBegin, uniformsEnd);
-			break;
-		}
-		case ShaderVariableDataType::VEC2:
-		{
-			const Vec2 val = mvar.getValue<Vec2>();
-			variant.writeShaderBlockMemory(mvar, &val, 1, uniformsBegin, uniformsEnd);
+			switch(mvar.getBuiltin())
+			{
+			case BuiltinMaterialVariableId::LOD_FADE:
+			{
+				ANKI_ASSERT(transforms.getSize() > 0);
+
+				Array<F32, MAX_INSTANCES> fades;
+				for(U32 i = 0; i < transforms.getSize(); i++)
+				{
+					fades[i] = (lodFades.getSize() > 0) ? lodFades[i] : 1.0f;
+				}
+
+				variant.writeShaderBlockMemory(mvar, &fades[0], transforms.getSize(), uniformsBegin, uniformsEnd);
+				break;
+			}
+			default:
+				ANKI_ASSERT(0);
+			}
+
 			break;
 		}
 		case ShaderVariableDataType::VEC3:
 		{
 			switch(mvar.getBuiltin())
 			{
-			case BuiltinMaterialVariableId::NONE:
-			{
-				const Vec3 val = mvar.getValue<Vec3>();
-				variant.writeShaderBlockMemory(mvar, &val, 1, uniformsBegin, uniformsEnd);
-				break;
-			}
 			case BuiltinMaterialVariableId::CAMERA_POSITION:
 			{
 				const Vec3 val = ctx.m_cameraTransform.getTranslationPart().xyz();
@@ -103,22 +266,10 @@ void MaterialRenderComponent::allocateAndSetupUniforms(const RenderQueueDrawCont
 
 			break;
 		}
-		case ShaderVariableDataType::VEC4:
-		{
-			const Vec4 val = mvar.getValue<Vec4>();
-			variant.writeShaderBlockMemory(mvar, &val, 1, uniformsBegin, uniformsEnd);
-			break;
-		}
 		case ShaderVariableDataType::MAT3:
 		{
 			switch(mvar.getBuiltin())
 			{
-			case BuiltinMaterialVariableId::NONE:
-			{
-				const Mat3 val = mvar.getValue<Mat3>();
-				variant.writeShaderBlockMemory(mvar, &val, 1, uniformsBegin, uniformsEnd);
-				break;
-			}
 			case BuiltinMaterialVariableId::NORMAL_MATRIX:
 			{
 				ANKI_ASSERT(transforms.getSize() > 0);
@@ -163,12 +314,6 @@ void MaterialRenderComponent::allocateAndSetupUniforms(const RenderQueueDrawCont
 		{
 			switch(mvar.getBuiltin())
 			{
-			case BuiltinMaterialVariableId::NONE:
-			{
-				const Mat4 val = mvar.getValue<Mat4>();
-				variant.writeShaderBlockMemory(mvar, &val, 1, uniformsBegin, uniformsEnd);
-				break;
-			}
 			case BuiltinMaterialVariableId::MODEL_VIEW_PROJECTION_MATRIX:
 			{
 				ANKI_ASSERT(transforms.getSize() > 0);
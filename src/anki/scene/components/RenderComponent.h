@@ -14,6 +14,9 @@
 namespace anki
 {
 
+// Forward
+class SceneGraphLimits;
+
 /// @addtogroup scene
 /// @{
 
@@ -23,6 +26,7 @@ enum class RenderComponentFlag : U8
 	CASTS_SHADOW = 1 << 0,
 	FORWARD_SHADING = 1 << 1,
 	SORT_LAST = 1 << 2, ///< Push it last when sorting the visibles.
+	LOD_CROSS_FADE = 1 << 3, ///< The draw callback can cross-fade the LODs so fade instead of popping.
 };
 ANKI_ENUM_ALLOW_NUMERIC_OPERATIONS(RenderComponentFlag, inline)
 
@@ -67,11 +71,86 @@ public:
 		el.m_mergeKey = m_mergeKey;
 	}
 
+	/// Set the number of LODs the renderable really has. No point in switching to LODs that look the same.
+	void setLodCount(U32 count)
+	{
+		ANKI_ASSERT(count > 0 && count <= MAX_LOD_COUNT);
+		m_lodCount = U8(count);
+	}
+
+	/// Set the screen sizes that the renderable switches LODs at. They override the ones of the SceneGraphLimits.
+	/// @param sizes The size of LOD i+1 is sizes[i]. It can have fewer sizes than LODs.
+	void setLodScreenSizes(ConstWeakArray<F32> sizes)
+	{
+		ANKI_ASSERT(sizes.getSize() < MAX_LOD_COUNT);
+		for(U32 i = 0; i < sizes.getSize(); ++i)
+		{
+			m_lodScreenSizes[i] = sizes[i];
+		}
+		m_lodScreenSizeCount = U8(sizes.getSize());
+	}
+
+	/// Pick the LOD from the projected size of the renderable. The visibility tests of the main camera call it once
+	/// per frame.
+	/// @param screenSize The diameter of the bounding sphere as a fraction of the screen height.
+	void updateLod(F32 screenSize, const SceneGraphLimits& limits, Timestamp timestamp);
+
+	/// Ask the resources for what a renderable of that size needs. The visibility tests of the main camera call it once
+	/// per frame.
+	/// @param screenSize The diameter of the bounding sphere as a fraction of the screen height.
+	virtual void requestResidency(F32 screenSize) const
+	{
+		(void)screenSize;
+	}
+
+	/// Get the LOD picked by the last updateLod().
+	U32 getLod() const
+	{
+		return m_lod;
+	}
+
+	/// Get the LOD that is fading out. Valid only if isChangingLod() returns true.
+	U32 getPreviousLod() const
+	{
+		ANKI_ASSERT(isChangingLod());
+		return m_prevLod;
+	}
+
+	/// Check if it's cross-fading between getPreviousLod() and getLod().
+	Bool isChangingLod() const
+	{
+		return m_lodFade < 1.0f;
+	}
+
+	/// Get the cross-fade factor the shaders expect for a LOD. It's in [0, 1) for the LOD that is fading in, in
+	/// [-2, -1) for the one that is fading out and 1 if it's not changing LOD.
+	F32 getLodFade(U32 lod) const
+	{
+		if(!isChangingLod())
+		{
+			return 1.0f;
+		}
+
+		return (lod == m_prevLod) ? m_lodFade - 2.0f : m_lodFade;
+	}
+
 private:
 	RenderQueueDrawCallback m_callback ANKI_DEBUG_CODE(= nullptr);
 	const void* m_userData ANKI_DEBUG_CODE(= nullptr);
 	U64 m_mergeKey ANKI_DEBUG_CODE(= MAX_U64);
+
+	Timestamp m_lodTimestamp = 0; ///< When updateLod() was last called.
+	Timestamp m_lodChangeTimestamp = 0;
+	F32 m_lodFade = 1.0f;
+	U8 m_lod = 0;
+	U8 m_prevLod = 0;
+	U8 m_lodCount = MAX_LOD_COUNT;
+	U8 m_lodScreenSizeCount = 0;
+	Array<F32, MAX_LOD_COUNT - 1> m_lodScreenSizes = {{}};
+
 	RenderComponentFlag m_flags = RenderComponentFlag::NONE;
+
+	F32 getLodScreenSize(U32 lod, const SceneGraphLimits& limits) const;
 };
 
 /// A wrapper on top of MaterialVariable
@@ -128,6 +207,8 @@ public:
 		return m_vars.end();
 	}
 
+	void requestResidency(F32 screenSize) const override;
+
 	/// Access the material
 	const MaterialResource& getMaterial() const
 	{
@@ -159,10 +240,16 @@ public:
 		return err;
 	}
 
+	/// @param lodFades The RenderComponent::getLodFade() of the instances. If it's empty the instances don't fade.
+	/// @param instances The components of the instances. Only for bindless materials where the instances might have
+	///                  different materials. If it's empty all instances have the material of this component.
 	void allocateAndSetupUniforms(const RenderQueueDrawContext& ctx,
 		ConstWeakArray<Mat4> transforms,
 		ConstWeakArray<Mat4> prevTransforms,
-		StagingGpuMemoryManager& alloc) const;
+		StagingGpuMemoryManager& alloc,
+		ConstWeakArray<F32> lodFades = ConstWeakArray<F32>(),
+		ConstWeakArray<const MaterialRenderComponent*> instances =
+			ConstWeakArray<const MaterialRenderComponent*>()) const;
 
 private:
 	SceneNode* m_node;
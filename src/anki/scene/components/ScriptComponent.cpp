@@ -35,6 +35,14 @@ Error ScriptComponent::load(CString fname)
 	// Exec the script
 	ANKI_CHECK(m_env.evalString(m_script->getSource()));
 
+	// Keep the update function and the node's userdata in the registry. That saves a global lookup and a userdata
+	// allocation every frame
+	lua_State* lua = &m_env.getLuaState();
+	lua_getglobal(lua, "update");
+	m_updateFuncRef = luaL_ref(lua, LUA_REGISTRYINDEX);
+	LuaBinder::pushVariableToTheStack(lua, m_node);
+	m_nodeRef = luaL_ref(lua, LUA_REGISTRYINDEX);
+
 	return Error::NONE;
 }
 
@@ -44,11 +52,11 @@ Error ScriptComponent::update(SceneNode& node, Second prevTime, Second crntTime,
 	updated = false;
 	lua_State* lua = &m_env.getLuaState();
 
-	// Push function name
-	lua_getglobal(lua, "update");
+	// Push function
+	lua_rawgeti(lua, LUA_REGISTRYINDEX, m_updateFuncRef);
 
 	// Push args
-	LuaBinder::pushVariableToTheStack(lua, &node);
+	lua_rawgeti(lua, LUA_REGISTRYINDEX, m_nodeRef);
 	lua_pushnumber(lua, prevTime);
 	lua_pushnumber(lua, crntTime);
 
@@ -56,6 +64,7 @@ Error ScriptComponent::update(SceneNode& node, Second prevTime, Second crntTime,
 	if(lua_pcall(lua, 3, 1, 0) != 0)
 	{
 		ANKI_SCENE_LOGE("Error running ScriptComponent's \"update\": %s", lua_tostring(lua, -1));
+		lua_pop(lua, 1);
 		return Error::USER_DATA;
 	}
 
@@ -33,6 +33,12 @@ private:
 	SceneNode* m_node;
 	ScriptResourcePtr m_script;
 	ScriptEnvironment m_env;
+
+	/// @name Registry references to what the update pushes every frame
+	/// @{
+	I32 m_updateFuncRef = LUA_NOREF;
+	I32 m_nodeRef = LUA_NOREF;
+	/// @}
 };
 /// @}
 
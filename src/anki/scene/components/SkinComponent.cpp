@@ -5,6 +5,9 @@
 
 #include <anki/scene/components/SkinComponent.h>
 #include <anki/scene/SceneNode.h>
+#include <anki/scene/SceneGraph.h>
+#include <anki/scene/components/MoveComponent.h>
+#include <anki/renderer/RenderQueue.h>
 #include <anki/resource/SkeletonResource.h>
 #include <anki/resource/AnimationResource.h>
 #include <anki/util/BitSet.h>
@@ -19,23 +22,94 @@ SkinComponent::SkinComponent(SceneNode* node, SkeletonResourcePtr skeleton)
 {
 	ANKI_ASSERT(node);
 
-	m_boneTrfs.create(m_node->getAllocator(), m_skeleton->getBones().getSize());
-	for(Mat4& trf : m_boneTrfs)
+	m_gpuSkinning = m_node->getSceneGraph().getLimits().m_gpuSkinning && m_skeleton->getGpuBonesBuffer().isCreated();
+	if(m_gpuSkinning)
 	{
-		trf.setIdentity();
+		m_boneChannels.create(m_node->getAllocator(), m_skeleton->getBones().getSize(), MAX_U32);
+		m_node->getSceneGraph().addGpuSkin(*this);
+	}
+	else
+	{
+		m_boneTrfs.create(m_node->getAllocator(), m_skeleton->getBones().getSize());
+		for(Mat4& trf : m_boneTrfs)
+		{
+			trf.setIdentity();
+		}
 	}
 }
 
 SkinComponent::~SkinComponent()
 {
+	if(m_gpuSkinning)
+	{
+		m_node->getSceneGraph().removeGpuSkin(*this);
+	}
+
 	m_boneTrfs.destroy(m_node->getAllocator());
+	m_boneChannels.destroy(m_node->getAllocator());
+
+	for(Track& track : m_tracks)
+	{
+		track.m_cursors.destroy(m_node->getAllocator());
+		track.m_channelBones.destroy(m_node->getAllocator());
+	}
 }
 
 void SkinComponent::playAnimation(U track, AnimationResourcePtr anim, Second startTime, Bool repeat)
 {
-	m_tracks[track].m_anim = anim;
-	m_tracks[track].m_time = startTime;
-	m_tracks[track].m_repeat = repeat;
+	Track& t = m_tracks[track];
+	t.m_anim = anim;
+	t.m_time = startTime;
+	t.m_repeat = repeat;
+
+	t.m_cursors.destroy(m_node->getAllocator());
+	t.m_channelBones.destroy(m_node->getAllocator());
+	if(!anim.isCreated() || m_gpuSkinning)
+	{
+		return;
+	}
+
+	// Find the bones once and not every frame
+	const U32 channelCount = anim->getChannels().getSize();
+	t.m_cursors.create(m_node->getAllocator(), channelCount);
+	t.m_channelBones.create(m_node->getAllocator(), channelCount);
+	for(U32 i = 0; i < channelCount; ++i)
+	{
+		const AnimationChannel& channel = anim->getChannels()[i];
+		const Bone* bone = m_skeleton->tryFindBone(channel.m_name.toCString());
+		if(!bone)
+		{
+			ANKI_SCENE_LOGW("Animation is referencing unknown bone \"%s\"", &channel.m_name[0]);
+		}
+
+		t.m_channelBones[i] = (bone) ? bone->getIndex() : MAX_U32;
+	}
+}
+
+U32 SkinComponent::computeAnimationLod() const
+{
+	const MoveComponent* move = m_node->tryGetComponent<MoveComponent>();
+	if(!move)
+	{
+		return 0;
+	}
+
+	// Use the position of the previous frame. The MoveComponent might not be updated yet
+	const SceneGraph& scene = m_node->getSceneGraph();
+	const F32 dist = (move->getWorldTransform().getOrigin().xyz() - scene.getLodOrigin()).getLength();
+
+	if(dist > scene.getLimits().m_animationLodDistance1)
+	{
+		return 2;
+	}
+	else if(dist > scene.getLimits().m_animationLodDistance0)
+	{
+		return 1;
+	}
+	else
+	{
+		return 0;
+	}
 }
 
 Error SkinComponent::update(SceneNode& node, Second prevTime, Second crntTime, Bool& updated)
@@ -45,6 +119,45 @@ Error SkinComponent::update(SceneNode& node, Second prevTime, Second crntTime, B
 	updated = false;
 	const Second timeDiff = crntTime - prevTime;
 
+	if(m_gpuSkinning)
+	{
+		// Only advance the time. Like the CPU path the last track wins
+		const Track* lastTrack = nullptr;
+		Second animTime = 0.0;
+		for(Track& track : m_tracks)
+		{
+			if(track.m_anim.isCreated())
+			{
+				lastTrack = &track;
+				animTime = track.m_time;
+				track.m_time += timeDiff;
+			}
+		}
+
+		if(lastTrack)
+		{
+			setGpuAnimation(lastTrack->m_anim);
+			m_gpuAnimTime = F32(m_gpuAnim->wrapTime(animTime));
+			updated = true;
+		}
+		else if(m_gpuAnim.isCreated())
+		{
+			m_gpuAnim.reset(nullptr);
+			updated = true;
+		}
+
+		return Error::NONE;
+	}
+
+	// The far skins are evaluated every 2 or 4 frames. Spread them to different frames using the UUID
+	m_lod = computeAnimationLod();
+	const U64 updateIntervalMask = (1u << m_lod) - 1;
+	const Bool evaluate = ((node.getGlobalTimestamp() + node.getUuid()) & updateIntervalMask) == 0;
+
+	// The last LOD animates the top bones only
+	const U32 maxBoneDepth =
+		(m_lod == ANIMATION_LOD_COUNT - 1) ? node.getSceneGraph().getLimits().m_animationLodMaxBoneDepth : MAX_U32;
+
 	for(Track& track : m_tracks)
 	{
 		if(!track.m_anim.isCreated())
@@ -52,20 +165,28 @@ Error SkinComponent::update(SceneNode& node, Second prevTime, Second crntTime, B
 			continue;
 		}
 
-		updated = true;
-
 		const Second animTime = track.m_time;
 		track.m_time += timeDiff;
 
+		if(!evaluate)
+		{
+			continue;
+		}
+
+		updated = true;
+
 		// Iterate the animation channels and interpolate
 		BitSet<128> bonesAnimated(false);
 		for(U32 i = 0; i < track.m_anim->getChannels().getSize(); ++i)
 		{
-			const AnimationChannel& channel = track.m_anim->getChannels()[i];
-			const Bone* bone = m_skeleton->tryFindBone(channel.m_name.toCString());
-			if(!bone)
+			if(track.m_channelBones[i] == MAX_U32)
+			{
+				continue;
+			}
+
+			const Bone& bone = m_skeleton->getBones()[track.m_channelBones[i]];
+			if(bone.getDepth() > maxBoneDepth)
 			{
-				ANKI_SCENE_LOGW("Animation is referencing unknown bone \"%s\"", &channel.m_name[0]);
 				continue;
 			}
 
@@ -73,11 +194,11 @@ Error SkinComponent::update(SceneNode& node, Second prevTime, Second crntTime, B
 			Vec3 position;
 			Quat rotation;
 			F32 scale;
-			track.m_anim->interpolate(i, animTime, position, rotation, scale);
+			track.m_anim->interpolate(i, animTime, position, rotation, scale, track.m_cursors[i]);
 
 			// Store
-			bonesAnimated.set(bone->getIndex());
-			m_boneTrfs[bone->getIndex()] = Mat4(position.xyz1(), Mat3(rotation), 1.0f) * bone->getVertexTransform();
+			bonesAnimated.set(bone.getIndex());
+			m_boneTrfs[bone.getIndex()] = Mat4(position.xyz1(), Mat3(rotation), 1.0f) * bone.getVertexTransform();
 		}
 
 		// Walk the bone hierarchy to add additional transforms
@@ -87,6 +208,46 @@ Error SkinComponent::update(SceneNode& node, Second prevTime, Second crntTime, B
 	return Error::NONE;
 }
 
+void SkinComponent::setGpuAnimation(const AnimationResourcePtr& anim)
+{
+	if(m_gpuAnim == anim)
+	{
+		return;
+	}
+
+	m_gpuAnim = anim;
+
+	// Map the bones to the channels once instead of searching the bones every frame
+	for(U32& channel : m_boneChannels)
+	{
+		channel = MAX_U32;
+	}
+
+	for(U32 i = 0; i < anim->getChannels().getSize(); ++i)
+	{
+		const AnimationChannel& channel = anim->getChannels()[i];
+		const Bone* bone = m_skeleton->tryFindBone(channel.m_name.toCString());
+		if(!bone)
+		{
+			ANKI_SCENE_LOGW("Animation is referencing unknown bone \"%s\"", &channel.m_name[0]);
+			continue;
+		}
+
+		m_boneChannels[bone->getIndex()] = i;
+	}
+}
+
+void SkinComponent::setupGpuSkinningQueueElement(GpuSkinningQueueElement& el)
+{
+	ANKI_ASSERT(m_gpuSkinning);
+	el.m_bonesBuffer = m_skeleton->getGpuBonesBuffer().get();
+	el.m_keyframes = (m_gpuAnim.isCreated()) ? &m_gpuAnim->getGpuKeyframes() : nullptr;
+	el.m_boneChannels = m_boneChannels.getBegin();
+	el.m_boneCount = m_boneChannels.getSize();
+	el.m_animationTime = m_gpuAnimTime;
+	el.m_boneTransformsToken = &m_gpuBoneTrfsToken;
+}
+
 void SkinComponent::visitBones(const Bone& bone, const Mat4& parentTrf, const BitSet<128>& bonesAnimated)
 {
 	Mat4 myTrf = parentTrf * bone.getTransform();
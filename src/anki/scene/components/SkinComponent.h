@@ -7,21 +7,30 @@
 
 #include <anki/scene/components/SceneComponent.h>
 #include <anki/resource/Forward.h>
+#include <anki/core/StagingGpuMemoryManager.h>
 #include <anki/util/Forward.h>
 #include <anki/Math.h>
 
 namespace anki
 {
 
+// Forward
+class GpuSkinningQueueElement;
+class AnimationChannelCursor;
+
 /// @addtogroup scene
 /// @{
 
-/// Skin component.
+/// Skin component. If the GPU skinning is enabled it only advances the animation time and the renderer evaluates the
+/// animation and the bone transforms.
 class SkinComponent : public SceneComponent
 {
+	friend class SceneGraph;
+
 public:
 	static const SceneComponentType CLASS_TYPE = SceneComponentType::SKIN;
 	static const U MAX_ANIMATION_TRACKS = 2;
+	static const U32 ANIMATION_LOD_COUNT = 3;
 
 	SkinComponent(SceneNode* node, SkeletonResourcePtr skeleton);
 
@@ -31,11 +40,35 @@ public:
 
 	void playAnimation(U track, AnimationResourcePtr anim, Second startTime, Bool repeat);
 
+	/// The animation LOD of the last update. It's 0 when it's near the camera.
+	U32 getAnimationLod() const
+	{
+		return m_lod;
+	}
+
+	/// Get the bone transforms. Valid only if the skin is not GPU skinned.
 	const DynamicArray<Mat4>& getBoneTransforms() const
 	{
+		ANKI_ASSERT(!m_gpuSkinning);
 		return m_boneTrfs;
 	}
 
+	/// The bone transforms are evaluated by the renderer.
+	Bool isGpuSkinned() const
+	{
+		return m_gpuSkinning;
+	}
+
+	/// Get the location of the bone transforms the renderer evaluated this frame. Valid only if it's GPU skinned.
+	const StagingGpuMemoryToken& getGpuBoneTransformsToken() const
+	{
+		ANKI_ASSERT(m_gpuSkinning && m_gpuBoneTrfsToken.m_buffer.isCreated());
+		return m_gpuBoneTrfsToken;
+	}
+
+	/// Fill the job of the renderer. Valid only if it's GPU skinned.
+	void setupGpuSkinningQueueElement(GpuSkinningQueueElement& el);
+
 private:
 	class Track
 	{
@@ -43,12 +76,26 @@ private:
 		AnimationResourcePtr m_anim;
 		F64 m_time;
 		Bool m_repeat;
+		DynamicArray<AnimationChannelCursor> m_cursors; ///< One per channel of the animation.
+		DynamicArray<U32> m_channelBones; ///< The bone of each channel of the animation or MAX_U32.
 	};
 
 	SceneNode* m_node;
 	SkeletonResourcePtr m_skeleton;
 	DynamicArray<Mat4> m_boneTrfs;
 	Array<Track, MAX_ANIMATION_TRACKS> m_tracks;
+	U32 m_lod = 0;
+
+	Bool m_gpuSkinning = false;
+	U32 m_gpuSkinIdx = MAX_U32; ///< Index in the list of the SceneGraph.
+	AnimationResourcePtr m_gpuAnim; ///< The animation the renderer will evaluate.
+	F32 m_gpuAnimTime = 0.0f;
+	DynamicArray<U32> m_boneChannels; ///< The channel of m_gpuAnim that animates each bone or MAX_U32.
+	StagingGpuMemoryToken m_gpuBoneTrfsToken; ///< Written by the renderer.
+
+	void setGpuAnimation(const AnimationResourcePtr& anim);
+
+	U32 computeAnimationLod() const;
 
 	void visitBones(const Bone& bone, const Mat4& parentTrf, const BitSet<128, U8>& bonesAnimated);
 };
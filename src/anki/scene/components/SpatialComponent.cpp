@@ -66,41 +66,128 @@ SpatialComponent::~SpatialComponent()
 	}
 }
 
+void SpatialComponent::unplace()
+{
+	if(m_placed)
+	{
+		m_node->getSceneGraph().getOctree().remove(m_octreeInfo);
+		m_placed = false;
+	}
+
+	markForUpdate();
+}
+
+void SpatialComponent::computeDerivedAabb()
+{
+	switch(m_collisionObjectType)
+	{
+	case CollisionShapeType::AABB:
+		m_derivedAabb = *m_aabb;
+		break;
+	case CollisionShapeType::OBB:
+		m_derivedAabb = computeAabb(*m_obb);
+		break;
+	case CollisionShapeType::SPHERE:
+		m_derivedAabb = computeAabb(*m_sphere);
+		break;
+	case CollisionShapeType::CONVEX_HULL:
+		m_derivedAabb = computeAabb(*m_hull);
+		break;
+	default:
+		ANKI_ASSERT(0);
+	}
+}
+
 Error SpatialComponent::update(SceneNode& node, Second prevTime, Second crntTime, Bool& updated)
 {
 	ANKI_ASSERT(&node == m_node);
 
 	updated = m_markedForUpdate;
-	if(updated)
+	SpatialComponent* self = this;
+	updateBatch(WeakArray<SpatialComponent*>(&self, 1));
+
+	return Error::NONE;
+}
+
+void SpatialComponent::updateBatch(WeakArray<SpatialComponent*> spatials)
+{
+	if(spatials.getSize() == 0)
 	{
-		// Compute the AABB
-		switch(m_collisionObjectType)
+		return;
+	}
+
+	Octree& octree = spatials[0]->m_node->getSceneGraph().getOctree();
+
+	// Gather the spatials that need update in chunks. Then compute their bounds and place them in the octree
+	constexpr U32 CHUNK_SIZE = 32;
+	Array<SpatialComponent*, CHUNK_SIZE> marked;
+	U32 markedCount = 0;
+
+	auto flush = [&]() {
+		// First the OBBs since they are the most common. They are computed in SoA batches
+		Array<const Obb*, CHUNK_SIZE> obbs;
+		Array<SpatialComponent*, CHUNK_SIZE> obbSpatials;
+		U32 obbCount = 0;
+		for(U32 i = 0; i < markedCount; ++i)
 		{
-		case CollisionShapeType::AABB:
-			m_derivedAabb = *m_aabb;
-			break;
-		case CollisionShapeType::OBB:
-			m_derivedAabb = computeAabb(*m_obb);
-			break;
-		case CollisionShapeType::SPHERE:
-			m_derivedAabb = computeAabb(*m_sphere);
-			break;
-		case CollisionShapeType::CONVEX_HULL:
-			m_derivedAabb = computeAabb(*m_hull);
-			break;
-		default:
-			ANKI_ASSERT(0);
+			SpatialComponent& sp = *marked[i];
+			if(sp.m_collisionObjectType == CollisionShapeType::OBB)
+			{
+				obbs[obbCount] = sp.m_obb;
+				obbSpatials[obbCount] = &sp;
+				++obbCount;
+			}
+			else
+			{
+				sp.computeDerivedAabb();
+			}
 		}
 
-		m_markedForUpdate = false;
+		Array<Aabb, CHUNK_SIZE> aabbs;
+		computeAabbs(ConstWeakArray<const Obb*>(&obbs[0], obbCount), WeakArray<Aabb>(&aabbs[0], obbCount));
+		for(U32 i = 0; i < obbCount; ++i)
+		{
+			obbSpatials[i]->m_derivedAabb = aabbs[i];
+		}
 
-		m_node->getSceneGraph().getOctree().place(m_derivedAabb, &m_octreeInfo, m_updateOctreeBounds);
-		m_placed = true;
-	}
+		// Place them
+		Array<OctreePlaceRequest, CHUNK_SIZE> requests;
+		for(U32 i = 0; i < markedCount; ++i)
+		{
+			SpatialComponent& sp = *marked[i];
+			OctreePlaceRequest& request = requests[i];
+			request.m_volume = sp.m_derivedAabb;
+			request.m_placeable = &sp.m_octreeInfo;
+			request.m_updateActualSceneBounds = sp.m_updateOctreeBounds;
+		}
 
-	m_octreeInfo.reset();
+		octree.placeBatch(ConstWeakArray<OctreePlaceRequest>(&requests[0], markedCount));
+		markedCount = 0;
+	};
 
-	return Error::NONE;
+	for(SpatialComponent* sp : spatials)
+	{
+		ANKI_ASSERT(sp && &sp->m_node->getSceneGraph().getOctree() == &octree);
+
+		if(sp->m_markedForUpdate)
+		{
+			sp->m_markedForUpdate = false;
+			sp->m_placed = true;
+
+			marked[markedCount++] = sp;
+			if(markedCount == CHUNK_SIZE)
+			{
+				flush();
+			}
+		}
+
+		sp->m_octreeInfo.reset();
+	}
+
+	if(markedCount)
+	{
+		flush();
+	}
 }
 
 } // end namespace anki
@@ -86,6 +86,18 @@ public:
 		m_updateOctreeBounds = update;
 	}
 
+	Bool isMarkedForUpdate() const
+	{
+		return m_markedForUpdate;
+	}
+
+	/// Remove it from the octree. It will be placed again in the next update of its node.
+	ANKI_INTERNAL void unplace();
+
+	/// Update many spatials at once. It's the same as calling update() on each one of them but the bounds are computed
+	/// in one go and the spatials are placed in the octree with a single lock. All should belong to the same scene.
+	static void updateBatch(WeakArray<SpatialComponent*> spatials);
+
 	/// @name SceneComponent overrides
 	/// @{
 	ANKI_USE_RESULT Error update(SceneNode& node, Second prevTime, Second crntTime, Bool& updated) override;
@@ -113,6 +125,8 @@ private:
 	Bool m_markedForUpdate = false;
 	Bool m_placed = false;
 	Bool m_updateOctreeBounds = true;
+
+	void computeDerivedAabb();
 };
 
 /// A class that holds spatial information and implements the SpatialComponent virtuals. You just need to update the
@@ -14,13 +14,20 @@ class TriggerComponent::MyPhysicsTriggerProcessContactCallback : public PhysicsT
 public:
 	TriggerComponent* m_comp = nullptr;
 
-	void processContact(PhysicsTrigger& trigger, PhysicsFilteredObject& obj) final
+	void processContacts(PhysicsTrigger& trigger,
+		ConstWeakArray<PhysicsFilteredObject*> contacts,
+		ConstWeakArray<PhysicsFilteredObject*> entered,
+		ConstWeakArray<PhysicsFilteredObject*> exited) final
 	{
-		void* ptr = obj.getUserData();
-		ANKI_ASSERT(ptr);
+		// It's called in the physics update so nothing else touches the component
+		m_comp->setNodes(contacts, m_comp->m_contacts);
+		m_comp->setNodes(entered, m_comp->m_entered);
+		m_comp->setNodes(exited, m_comp->m_exited);
+		m_comp->m_contactsTimestamp = m_comp->m_node->getGlobalTimestamp();
+		m_comp->m_contactsChanged = true;
 
-		SceneNode* node = static_cast<SceneNode*>(ptr);
-		m_comp->processContact(*node);
+		// A static trigger needs an update to run the callback
+		m_comp->m_node->markDirty();
 	}
 };
 
@@ -30,29 +37,67 @@ TriggerComponent::TriggerComponent(SceneNode* node, PhysicsTriggerPtr trigger)
 	, m_trigger(trigger)
 {
 	ANKI_ASSERT(node);
-	m_contactCb = m_node->getAllocator().newInstance<MyPhysicsTriggerProcessContactCallback>();
-	m_contactCb->m_comp = this;
-	m_trigger->setContactProcessCallback(m_contactCb);
+	m_physicsContactCb = m_node->getAllocator().newInstance<MyPhysicsTriggerProcessContactCallback>();
+	m_physicsContactCb->m_comp = this;
+	m_trigger->setContactProcessCallback(m_physicsContactCb);
 }
 
 TriggerComponent::~TriggerComponent()
 {
-	m_node->getAllocator().deleteInstance(m_contactCb);
-	m_contactNodes.destroy(m_node->getAllocator());
+	m_trigger->setContactProcessCallback(nullptr);
+	m_node->getAllocator().deleteInstance(m_physicsContactCb);
+	m_contacts.m_nodes.destroy(m_node->getAllocator());
+	m_entered.m_nodes.destroy(m_node->getAllocator());
+	m_exited.m_nodes.destroy(m_node->getAllocator());
 }
 
-void TriggerComponent::processContact(SceneNode& node)
+void TriggerComponent::setNodes(ConstWeakArray<PhysicsFilteredObject*> objects, NodeArray& arr)
 {
-	ANKI_ASSERT(&node != m_node);
+	if(objects.getSize() > arr.m_nodes.getSize())
+	{
+		const U32 newStorage = max(objects.getSize(), arr.m_nodes.getSize() * 2);
+		arr.m_nodes.destroy(m_node->getAllocator());
+		arr.m_nodes.create(m_node->getAllocator(), newStorage);
+	}
 
-	// Clear the list if it's a new frame
-	if(m_contactNodesArrayTimestamp != node.getGlobalTimestamp())
+	arr.m_count = 0;
+	for(PhysicsFilteredObject* obj : objects)
 	{
-		m_contactNodesArrayTimestamp = node.getGlobalTimestamp();
-		m_contactNodes.destroy(node.getAllocator());
+		void* ptr = obj->getUserData();
+		ANKI_ASSERT(ptr);
+
+		SceneNode* node = static_cast<SceneNode*>(ptr);
+		ANKI_ASSERT(node != m_node);
+		arr.m_nodes[arr.m_count++] = node;
+	}
+}
+
+WeakArray<SceneNode*> TriggerComponent::getChangedSceneNodes(NodeArray& arr)
+{
+	return (m_contactsTimestamp == m_node->getGlobalTimestamp() && arr.m_count)
+			   ? WeakArray<SceneNode*>(&arr.m_nodes[0], arr.m_count)
+			   : WeakArray<SceneNode*>();
+}
+
+Error TriggerComponent::update(SceneNode& node, Second prevTime, Second crntTime, Bool& updated)
+{
+	ANKI_ASSERT(&node == m_node);
+	updated = false;
+
+	if(m_contactsChanged)
+	{
+		m_contactsChanged = false;
+		updated = true;
+
+		const WeakArray<SceneNode*> entered = getEnteredSceneNodes();
+		const WeakArray<SceneNode*> exited = getExitedSceneNodes();
+		if(m_contactCallback && (entered.getSize() || exited.getSize()))
+		{
+			m_contactCallback->processContacts(*this, entered, exited);
+		}
 	}
 
-	m_contactNodes.emplaceBack(node.getAllocator(), &node);
+	return Error::NONE;
 }
 
-} // end namespace anki
\ No newline at end of file
+} // end namespace anki
@@ -11,10 +11,29 @@
 namespace anki
 {
 
+// Forward
+class TriggerComponent;
+
 /// @addtogroup scene
 /// @{
 
-/// Trigger component.
+/// An interface to process the contacts of a TriggerComponent.
+/// @memberof TriggerComponent
+class TriggerComponentCallback
+{
+public:
+	virtual ~TriggerComponentCallback()
+	{
+	}
+
+	/// Process the nodes that entered and exited the trigger. It's called in the update of the component and only in
+	/// the frames that the contacts changed.
+	virtual void processContacts(
+		TriggerComponent& trigger, WeakArray<SceneNode*> entered, WeakArray<SceneNode*> exited) = 0;
+};
+
+/// Trigger component. The physics collect the contacts of the trigger and the component keeps what changed since the
+/// previous frame. The nodes that stay inside the trigger don't cost anything.
 class TriggerComponent : public SceneComponent
 {
 public:
@@ -24,23 +43,59 @@ public:
 
 	~TriggerComponent();
 
-	/// Process a contact.
-	virtual void processContact(SceneNode& node);
+	/// Set a callback that will process the contacts once per frame.
+	void setContactCallback(TriggerComponentCallback* cb)
+	{
+		m_contactCallback = cb;
+	}
 
+	/// All the nodes that overlap with the trigger.
 	WeakArray<SceneNode*> getContactSceneNodes()
 	{
-		return WeakArray<SceneNode*>(m_contactNodes);
+		return WeakArray<SceneNode*>((m_contacts.m_count) ? &m_contacts.m_nodes[0] : nullptr, m_contacts.m_count);
+	}
+
+	/// The nodes that started overlapping with the trigger in this frame.
+	WeakArray<SceneNode*> getEnteredSceneNodes()
+	{
+		return getChangedSceneNodes(m_entered);
+	}
+
+	/// The nodes that stopped overlapping with the trigger in this frame.
+	WeakArray<SceneNode*> getExitedSceneNodes()
+	{
+		return getChangedSceneNodes(m_exited);
 	}
 
+	ANKI_USE_RESULT Error update(SceneNode& node, Second prevTime, Second crntTime, Bool& updated) override;
+
 private:
 	class MyPhysicsTriggerProcessContactCallback;
 
+	/// An array of nodes that keeps its storage across frames.
+	class NodeArray
+	{
+	public:
+		DynamicArray<SceneNode*> m_nodes; ///< Its size is the storage.
+		U32 m_count = 0;
+	};
+
 	SceneNode* m_node;
 	PhysicsTriggerPtr m_trigger;
-	DynamicArray<SceneNode*> m_contactNodes;
-	Timestamp m_contactNodesArrayTimestamp = 0;
-	MyPhysicsTriggerProcessContactCallback* m_contactCb = nullptr;
+	MyPhysicsTriggerProcessContactCallback* m_physicsContactCb = nullptr;
+	TriggerComponentCallback* m_contactCallback = nullptr;
+
+	NodeArray m_contacts;
+	NodeArray m_entered;
+	NodeArray m_exited;
+	Timestamp m_contactsTimestamp = 0; ///< The frame the m_entered and m_exited were set.
+	Bool m_contactsChanged = false; ///< The physics changed them and the m_contactCallback hasn't processed them.
+
+	/// Get the nodes of m_entered or m_exited if they were set in this frame.
+	WeakArray<SceneNode*> getChangedSceneNodes(NodeArray& arr);
+
+	void setNodes(ConstWeakArray<PhysicsFilteredObject*> objects, NodeArray& arr);
 };
 /// @}
 
-} // end namespace anki
\ No newline at end of file
+} // end namespace anki
@@ -12,7 +12,7 @@ namespace anki
 {
 
 AnimationEvent::AnimationEvent(EventManager* manager)
-	: Event(manager)
+	: Event(manager, EventType::ANIMATION)
 {
 }
 
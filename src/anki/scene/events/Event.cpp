@@ -11,8 +11,9 @@
 namespace anki
 {
 
-Event::Event(EventManager* manager)
+Event::Event(EventManager* manager, EventType type)
 	: m_manager(manager)
+	, m_type(type)
 {
 }
 
@@ -8,6 +8,7 @@
 #include <anki/scene/Common.h>
 #include <anki/util/List.h>
 #include <anki/util/WeakArray.h>
+#include <anki/util/Enum.h>
 
 namespace anki
 {
@@ -15,6 +16,19 @@ namespace anki
 /// @addtogroup scene
 /// @{
 
+/// The type of an event. The EventManager keeps the events of every type together.
+enum class EventType : U8
+{
+	ANIMATION,
+	LIGHT,
+	JITTER_MOVE,
+	SCRIPT, ///< Always updated serially. The script environment can't be shared between threads.
+
+	COUNT,
+	FIRST = 0
+};
+ANKI_ENUM_ALLOW_NUMERIC_OPERATIONS(EventType, inline)
+
 /// The base class for all events
 class Event : public IntrusiveListEnabled<Event>
 {
@@ -22,7 +36,7 @@ class Event : public IntrusiveListEnabled<Event>
 
 public:
 	/// Constructor
-	Event(EventManager* manager);
+	Event(EventManager* manager, EventType type);
 
 	virtual ~Event();
 
@@ -38,6 +52,18 @@ public:
 		return *m_manager;
 	}
 
+	EventType getType() const
+	{
+		return m_type;
+	}
+
+	/// The events that can be updated in parallel only touch the first of their associated nodes. The events of the
+	/// same node are updated by the same thread.
+	Bool canUpdateInParallel() const
+	{
+		return m_type != EventType::SCRIPT;
+	}
+
 	SceneGraph& getSceneGraph();
 
 	const SceneGraph& getSceneGraph() const;
@@ -109,6 +135,7 @@ protected:
 	Second m_startTime = 0.0;
 	Second m_duration = 0.0;
 
+	EventType m_type;
 	Bool m_markedForDeletion = false;
 	Bool m_reanimate = false;
 
@@ -6,6 +6,9 @@
 #include <anki/scene/events/EventManager.h>
 #include <anki/scene/events/Event.h>
 #include <anki/scene/SceneGraph.h>
+#include <anki/util/ThreadHive.h>
+#include <anki/util/Tracer.h>
+#include <algorithm>
 
 namespace anki
 {
@@ -16,13 +19,19 @@ EventManager::EventManager()
 
 EventManager::~EventManager()
 {
-	while(!m_events.isEmpty())
+	for(IntrusiveList<Event>& events : m_events)
 	{
-		Event* event = &m_events.getFront();
-		event->setMarkedForDeletion();
+		while(!events.isEmpty())
+		{
+			Event* event = &events.getFront();
+			event->setMarkedForDeletion();
+		}
 	}
 
-	deleteEventsMarkedForDeletion();
+	deleteEventsMarkedForDeletion(true);
+
+	SceneAllocator<U8> alloc = getAllocator();
+	m_objectAlloc.destroy(alloc);
 }
 
 Error EventManager::init(SceneGraph* scene)
@@ -44,66 +53,160 @@ SceneFrameAllocator<U8> EventManager::getFrameAllocator() const
 
 Error EventManager::updateAllEvents(Second prevUpdateTime, Second crntTime)
 {
+	// Gather the events first. The lists will change when events are marked for deletion
+	U32 parallelCount = 0;
+	U32 serialCount = 0;
+	for(EventType type = EventType::FIRST; type < EventType::COUNT; ++type)
+	{
+		const U32 count = U32(m_events[type].getSize());
+		if(type != EventType::SCRIPT)
+		{
+			parallelCount += count;
+		}
+		else
+		{
+			serialCount += count;
+		}
+	}
+
+	if(parallelCount + serialCount == 0)
+	{
+		return Error::NONE;
+	}
+
+	DynamicArrayAuto<Event*> events(getFrameAllocator());
+	events.create(parallelCount + serialCount);
+	U32 parallelIdx = 0;
+	U32 serialIdx = parallelCount;
+	for(IntrusiveList<Event>& list : m_events)
+	{
+		for(Event& event : list)
+		{
+			U32& idx = (event.canUpdateInParallel()) ? parallelIdx : serialIdx;
+			events[idx++] = &event;
+		}
+	}
+
+	ANKI_ASSERT(parallelIdx == parallelCount && serialIdx == events.getSize());
+
+	// Update the ones that don't run scripts
 	Error err = Error::NONE;
+	if(parallelCount >= MIN_EVENTS_FOR_PARALLEL_UPDATE)
+	{
+		err = updateEventsInParallel(WeakArray<Event*>(&events[0], parallelCount), prevUpdateTime, crntTime);
+	}
+	else
+	{
+		for(U32 i = 0; i < parallelCount && !err; ++i)
+		{
+			err = updateEvent(*events[i], prevUpdateTime, crntTime);
+		}
+	}
 
-	auto it = m_events.getBegin();
-	auto end = m_events.getEnd();
-	for(; it != end && !err; ++it)
+	// Update the rest in the main thread
+	for(U32 i = parallelCount; i < events.getSize() && !err; ++i)
 	{
-		Event& event = *it;
+		err = updateEvent(*events[i], prevUpdateTime, crntTime);
+	}
 
-		// If event or the node's event is marked for deletion then dont do anything else for that event
-		if(event.getMarkedForDeletion())
+	return err;
+}
+
+Error EventManager::updateEventsInParallel(WeakArray<Event*> events, Second prevUpdateTime, Second crntTime)
+{
+	ANKI_TRACE_SCOPED_EVENT(SCENE_EVENTS_UPDATE);
+
+	// Sort them by node. The events of the same node will be updated in order by the same thread
+	auto firstNode = [](const Event* event) -> const SceneNode* {
+		return (event->m_associatedNodes.getSize() > 0) ? event->m_associatedNodes[0] : nullptr;
+	};
+
+	std::stable_sort(events.getBegin(), events.getEnd(), [&](const Event* a, const Event* b) {
+		return firstNode(a) < firstNode(b);
+	});
+
+	// Find the ranges of the nodes
+	DynamicArrayAuto<U32> groupEnds(getFrameAllocator());
+	groupEnds.create(events.getSize());
+	U32 groupCount = 0;
+	for(U32 i = 1; i < events.getSize(); ++i)
+	{
+		if(firstNode(events[i]) != firstNode(events[i - 1]) || firstNode(events[i]) == nullptr)
 		{
-			continue;
+			groupEnds[groupCount++] = i;
 		}
+	}
+	groupEnds[groupCount++] = events.getSize();
 
-		// Check if the associated scene nodes are marked for deletion
-		for(SceneNode* node : event.m_associatedNodes)
+	SpinLock errMtx;
+	Error err = Error::NONE;
+	m_scene->getThreadHive().parallelFor(groupCount, 1, [&](U32 begin, U32 end, U32 threadId) {
+		const U32 first = (begin > 0) ? groupEnds[begin - 1] : 0;
+		for(U32 i = first; i < groupEnds[end - 1]; ++i)
 		{
-			if(node->getMarkedForDeletion())
+			const Error localErr = updateEvent(*events[i], prevUpdateTime, crntTime);
+			if(localErr)
 			{
-				event.setMarkedForDeletion();
+				LockGuard<SpinLock> lock(errMtx);
+				err = localErr;
 			}
 		}
+	});
+
+	return err;
+}
+
+Error EventManager::updateEvent(Event& event, Second prevUpdateTime, Second crntTime)
+{
+	Error err = Error::NONE;
 
-		if(event.getMarkedForDeletion())
+	// If event or the node's event is marked for deletion then dont do anything else for that event
+	if(event.getMarkedForDeletion())
+	{
+		return err;
+	}
+
+	// Check if the associated scene nodes are marked for deletion
+	for(SceneNode* node : event.m_associatedNodes)
+	{
+		if(node->getMarkedForDeletion())
 		{
-			continue;
+			event.setMarkedForDeletion();
+			return err;
 		}
+	}
+
+	// Audjust starting time
+	if(event.m_startTime < 0.0)
+	{
+		event.m_startTime = crntTime;
+	}
+
+	// Check if dead
+	if(!event.isDead(crntTime))
+	{
+		// If not dead update it
 
-		// Audjust starting time
-		if(event.m_startTime < 0.0)
+		if(event.getStartTime() <= crntTime)
 		{
-			event.m_startTime = crntTime;
+			err = event.update(prevUpdateTime, crntTime);
 		}
+	}
+	else
+	{
+		// Dead
 
-		// Check if dead
-		if(!event.isDead(crntTime))
+		if(event.getReanimate())
 		{
-			// If not dead update it
-
-			if(event.getStartTime() <= crntTime)
-			{
-				err = event.update(prevUpdateTime, crntTime);
-			}
+			event.m_startTime = prevUpdateTime;
+			err = event.update(prevUpdateTime, crntTime);
 		}
 		else
 		{
-			// Dead
-
-			if(event.getReanimate())
-			{
-				event.m_startTime = prevUpdateTime;
-				err = event.update(prevUpdateTime, crntTime);
-			}
-			else
+			err = event.onKilled(prevUpdateTime, crntTime);
+			if(err || !event.getReanimate())
 			{
-				err = event.onKilled(prevUpdateTime, crntTime);
-				if(err || !event.getReanimate())
-				{
-					event.setMarkedForDeletion();
-				}
+				event.setMarkedForDeletion();
 			}
 		}
 	}
@@ -114,29 +217,41 @@ Error EventManager::updateAllEvents(Second prevUpdateTime, Second crntTime)
 void EventManager::markEventForDeletion(Event* event)
 {
 	ANKI_ASSERT(event);
+
+	LockGuard<Mutex> lock(m_mtx);
 	if(event->m_markedForDeletion)
 	{
 		return;
 	}
 
-	LockGuard<Mutex> lock(m_mtx);
 	event->m_markedForDeletion = true;
-	m_events.erase(event);
+	m_events[event->m_type].erase(event);
 	m_eventsMarkedForDeletion.pushBack(event);
+	++m_eventsMarkedForDeletionCount;
 }
 
-void EventManager::deleteEventsMarkedForDeletion()
+void EventManager::deleteEventsMarkedForDeletion(Bool force)
 {
+	// The events marked for deletion are not touched again so there is no rush. Delete many of them together
+	++m_framesSinceLastDeletion;
+	if(!force && m_eventsMarkedForDeletionCount < MIN_EVENTS_FOR_DELETION
+		&& (m_eventsMarkedForDeletionCount == 0 || m_framesSinceLastDeletion < MAX_DELETION_DELAY_FRAMES))
+	{
+		return;
+	}
+
 	SceneAllocator<U8> alloc = getAllocator();
 
-	// Gather events for deletion
 	while(!m_eventsMarkedForDeletion.isEmpty())
 	{
 		Event* event = &m_eventsMarkedForDeletion.getFront();
 		m_eventsMarkedForDeletion.popFront();
 
-		alloc.deleteInstance(event);
+		m_objectAlloc.deleteInstance(alloc, event);
 	}
+
+	m_eventsMarkedForDeletionCount = 0;
+	m_framesSinceLastDeletion = 0;
 }
 
 } // end namespace anki
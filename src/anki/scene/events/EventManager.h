@@ -6,6 +6,7 @@
 #pragma once
 
 #include <anki/scene/Common.h>
+#include <anki/scene/events/Event.h>
 #include <anki/util/List.h>
 #include <anki/Math.h>
 
@@ -15,7 +16,8 @@ namespace anki
 /// @addtogroup scene
 /// @{
 
-/// This manager creates the events ands keeps track of them
+/// This manager creates the events ands keeps track of them. The events that don't run scripts are updated in parallel
+/// and the deletion of the events is batched.
 class EventManager
 {
 public:
@@ -42,16 +44,17 @@ public:
 	template<typename T, typename... Args>
 	ANKI_USE_RESULT Error newEvent(T*& event, Args... args)
 	{
-		event = getAllocator().template newInstance<T>(this);
+		SceneAllocator<U8> alloc = getAllocator();
+		event = m_objectAlloc.newInstance<T>(alloc, this);
 		Error err = event->init(std::forward<Args>(args)...);
 		if(err)
 		{
-			getAllocator().deleteInstance(event);
+			m_objectAlloc.deleteInstance(alloc, event);
 		}
 		else
 		{
 			LockGuard<Mutex> lock(m_mtx);
-			m_events.pushBack(event);
+			m_events[event->getType()].pushBack(event);
 		}
 		return err;
 	}
@@ -59,18 +62,35 @@ public:
 	/// Update
 	ANKI_USE_RESULT Error updateAllEvents(Second prevUpdateTime, Second crntTime);
 
-	/// Delete events that pending deletion
-	void deleteEventsMarkedForDeletion();
+	/// Delete the events that are pending deletion. They are deleted in batches so it may leave them for later.
+	/// @param force Delete them no matter how many they are.
+	void deleteEventsMarkedForDeletion(Bool force = false);
 
 	/// @note It's thread-safe against itself.
 	void markEventForDeletion(Event* event);
 
 private:
+	/// Below that count the events are updated serially.
+	static constexpr U32 MIN_EVENTS_FOR_PARALLEL_UPDATE = 64;
+
+	/// The events marked for deletion are deleted when they are that many or when they are older than
+	/// MAX_DELETION_DELAY_FRAMES.
+	static constexpr U32 MIN_EVENTS_FOR_DELETION = 32;
+	static constexpr U32 MAX_DELETION_DELAY_FRAMES = 60;
+
 	SceneGraph* m_scene = nullptr;
 
-	IntrusiveList<Event> m_events;
+	Array<IntrusiveList<Event>, U32(EventType::COUNT)> m_events;
 	IntrusiveList<Event> m_eventsMarkedForDeletion;
+	U32 m_eventsMarkedForDeletionCount = 0;
+	U32 m_framesSinceLastDeletion = 0;
 	Mutex m_mtx;
+	SceneObjectAllocator m_objectAlloc;
+
+	ANKI_USE_RESULT Error updateEvent(Event& event, Second prevUpdateTime, Second crntTime);
+
+	/// Update the events that can run in parallel. The events of the same node go to the same thread.
+	ANKI_USE_RESULT Error updateEventsInParallel(WeakArray<Event*> events, Second prevUpdateTime, Second crntTime);
 };
 /// @}
 
@@ -20,7 +20,7 @@ class JitterMoveEvent : public Event
 public:
 	/// Constructor
 	JitterMoveEvent(EventManager* manager)
-		: Event(manager)
+		: Event(manager, EventType::JITTER_MOVE)
 	{
 	}
 
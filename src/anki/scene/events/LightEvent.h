@@ -20,7 +20,7 @@ class LightEvent : public Event
 public:
 	/// Create
 	LightEvent(EventManager* manager)
-		: Event(manager)
+		: Event(manager, EventType::LIGHT)
 	{
 	}
 
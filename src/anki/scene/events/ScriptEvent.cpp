@@ -15,7 +15,7 @@ namespace anki
 {
 
 ScriptEvent::ScriptEvent(EventManager* manager)
-	: Event(manager)
+	: Event(manager, EventType::SCRIPT)
 {
 }
 
@@ -52,6 +52,14 @@ Error ScriptEvent::init(Second startTime, Second duration, CString script)
 		ANKI_CHECK(m_env.evalString(m_script.toCString()));
 	}
 
+	// Keep the update function and the event's userdata in the registry. That saves a global lookup and a userdata
+	// allocation every frame
+	lua_State* lua = &m_env.getLuaState();
+	lua_getglobal(lua, "update");
+	m_updateFuncRef = luaL_ref(lua, LUA_REGISTRYINDEX);
+	LuaBinder::pushVariableToTheStack(lua, static_cast<Event*>(this));
+	m_eventRef = luaL_ref(lua, LUA_REGISTRYINDEX);
+
 	return Error::NONE;
 }
 
@@ -59,11 +67,11 @@ Error ScriptEvent::update(Second prevUpdateTime, Second crntTime)
 {
 	lua_State* lua = &m_env.getLuaState();
 
-	// Push function name
-	lua_getglobal(lua, "update");
+	// Push function
+	lua_rawgeti(lua, LUA_REGISTRYINDEX, m_updateFuncRef);
 
 	// Push args
-	LuaBinder::pushVariableToTheStack(lua, static_cast<Event*>(this));
+	lua_rawgeti(lua, LUA_REGISTRYINDEX, m_eventRef);
 	lua_pushnumber(lua, prevUpdateTime);
 	lua_pushnumber(lua, crntTime);
 
@@ -71,6 +79,7 @@ Error ScriptEvent::update(Second prevUpdateTime, Second crntTime)
 	if(lua_pcall(lua, 3, 1, 0) != 0)
 	{
 		ANKI_SCENE_LOGE("Error running ScriptEvent's \"update\": %s", lua_tostring(lua, -1));
+		lua_pop(lua, 1);
 		return Error::USER_DATA;
 	}
 
@@ -102,7 +111,7 @@ Error ScriptEvent::onKilled(Second prevUpdateTime, Second crntTime)
 	lua_getglobal(lua, "onKilled");
 
 	// Push args
-	LuaBinder::pushVariableToTheStack(lua, static_cast<Event*>(this));
+	lua_rawgeti(lua, LUA_REGISTRYINDEX, m_eventRef);
 	lua_pushnumber(lua, prevUpdateTime);
 	lua_pushnumber(lua, crntTime);
 
@@ -110,6 +119,7 @@ Error ScriptEvent::onKilled(Second prevUpdateTime, Second crntTime)
 	if(lua_pcall(lua, 3, 1, 0) != 0)
 	{
 		ANKI_SCENE_LOGE("Error running ScriptEvent's \"onKilled\": %s", lua_tostring(lua, -1));
+		lua_pop(lua, 1);
 		return Error::USER_DATA;
 	}
 
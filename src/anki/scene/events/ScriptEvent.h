@@ -45,6 +45,12 @@ private:
 	ScriptResourcePtr m_scriptRsrc;
 	String m_script;
 	ScriptEnvironment m_env;
+
+	/// @name Registry references to what the update pushes every frame
+	/// @{
+	I32 m_updateFuncRef = LUA_NOREF;
+	I32 m_eventRef = LUA_NOREF;
+	/// @}
 };
 /// @}
 
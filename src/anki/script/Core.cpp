@@ -0,0 +1,386 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+// WARNING: This file is auto generated.
+
+#include <anki/script/LuaBinder.h>
+#include <anki/script/ScriptManager.h>
+#include <anki/core/PerformanceHud.h>
+
+namespace anki
+{
+
+static PerformanceHud* getPerformanceHud(lua_State* l)
+{
+	LuaBinder* binder = nullptr;
+	lua_getallocf(l, reinterpret_cast<void**>(&binder));
+
+	PerformanceHud* hud = binder->getOtherSystems().m_performanceHud;
+	ANKI_ASSERT(hud);
+	return hud;
+}
+
+LuaUserDataTypeInfo luaUserDataTypeInfoPerformanceHud = {6222492245570045519,
+	"PerformanceHud",
+	LuaUserData::computeSizeForGarbageCollected<PerformanceHud>(),
+	nullptr,
+	nullptr};
+
+template<>
+const LuaUserDataTypeInfo& LuaUserData::getDataTypeInfoFor<PerformanceHud>()
+{
+	return luaUserDataTypeInfoPerformanceHud;
+}
+
+/// Pre-wrap method PerformanceHud::getEnabled.
+static inline int pwrapPerformanceHudgetEnabled(lua_State* l)
+{
+	LuaUserData* ud;
+	(void)ud;
+	void* voidp;
+	(void)voidp;
+	PtrSize size;
+	(void)size;
+
+	if(ANKI_UNLIKELY(LuaBinder::checkArgsCount(l, 1)))
+	{
+		return -1;
+	}
+
+	// Get "this" as "self"
+	if(LuaBinder::checkUserData(l, 1, luaUserDataTypeInfoPerformanceHud, ud))
+	{
+		return -1;
+	}
+
+	PerformanceHud* self = ud->getData<PerformanceHud>();
+
+	// Call the method
+	Bool ret = self->getEnabled();
+
+	// Push return value
+	lua_pushboolean(l, ret);
+
+	return 1;
+}
+
+/// Wrap method PerformanceHud::getEnabled.
+static int wrapPerformanceHudgetEnabled(lua_State* l)
+{
+	int res = pwrapPerformanceHudgetEnabled(l);
+	if(res >= 0)
+	{
+		return res;
+	}
+
+	lua_error(l);
+	return 0;
+}
+
+/// Pre-wrap method PerformanceHud::setEnabled.
+static inline int pwrapPerformanceHudsetEnabled(lua_State* l)
+{
+	LuaUserData* ud;
+	(void)ud;
+	void* voidp;
+	(void)voidp;
+	PtrSize size;
+	(void)size;
+
+	if(ANKI_UNLIKELY(LuaBinder::checkArgsCount(l, 2)))
+	{
+		return -1;
+	}
+
+	// Get "this" as "self"
+	if(LuaBinder::checkUserData(l, 1, luaUserDataTypeInfoPerformanceHud, ud))
+	{
+		return -1;
+	}
+
+	PerformanceHud* self = ud->getData<PerformanceHud>();
+
+	// Pop arguments
+	Bool arg0;
+	if(ANKI_UNLIKELY(LuaBinder::checkNumber(l, 2, arg0)))
+	{
+		return -1;
+	}
+
+	// Call the method
+	self->setEnabled(arg0);
+
+	return 0;
+}
+
+/// Wrap method PerformanceHud::setEnabled.
+static int wrapPerformanceHudsetEnabled(lua_State* l)
+{
+	int res = pwrapPerformanceHudsetEnabled(l);
+	if(res >= 0)
+	{
+		return res;
+	}
+
+	lua_error(l);
+	return 0;
+}
+
+/// Pre-wrap method PerformanceHud::getGraphsEnabled.
+static inline int pwrapPerformanceHudgetGraphsEnabled(lua_State* l)
+{
+	LuaUserData* ud;
+	(void)ud;
+	void* voidp;
+	(void)voidp;
+	PtrSize size;
+	(void)size;
+
+	if(ANKI_UNLIKELY(LuaBinder::checkArgsCount(l, 1)))
+	{
+		return -1;
+	}
+
+	// Get "this" as "self"
+	if(LuaBinder::checkUserData(l, 1, luaUserDataTypeInfoPerformanceHud, ud))
+	{
+		return -1;
+	}
+
+	PerformanceHud* self = ud->getData<PerformanceHud>();
+
+	// Call the method
+	Bool ret = self->getGraphsEnabled();
+
+	// Push return value
+	lua_pushboolean(l, ret);
+
+	return 1;
+}
+
+/// Wrap method PerformanceHud::getGraphsEnabled.
+static int wrapPerformanceHudgetGraphsEnabled(lua_State* l)
+{
+	int res = pwrapPerformanceHudgetGraphsEnabled(l);
+	if(res >= 0)
+	{
+		return res;
+	}
+
+	lua_error(l);
+	return 0;
+}
+
+/// Pre-wrap method PerformanceHud::setGraphsEnabled.
+static inline int pwrapPerformanceHudsetGraphsEnabled(lua_State* l)
+{
+	LuaUserData* ud;
+	(void)ud;
+	void* voidp;
+	(void)voidp;
+	PtrSize size;
+	(void)size;
+
+	if(ANKI_UNLIKELY(LuaBinder::checkArgsCount(l, 2)))
+	{
+		return -1;
+	}
+
+	// Get "this" as "self"
+	if(LuaBinder::checkUserData(l, 1, luaUserDataTypeInfoPerformanceHud, ud))
+	{
+		return -1;
+	}
+
+	PerformanceHud* self = ud->getData<PerformanceHud>();
+
+	// Pop arguments
+	Bool arg0;
+	if(ANKI_UNLIKELY(LuaBinder::checkNumber(l, 2, arg0)))
+	{
+		return -1;
+	}
+
+	// Call the method
+	self->setGraphsEnabled(arg0);
+
+	return 0;
+}
+
+/// Wrap method PerformanceHud::setGraphsEnabled.
+static int wrapPerformanceHudsetGraphsEnabled(lua_State* l)
+{
+	int res = pwrapPerformanceHudsetGraphsEnabled(l);
+	if(res >= 0)
+	{
+		return res;
+	}
+
+	lua_error(l);
+	return 0;
+}
+
+/// Pre-wrap method PerformanceHud::getPassesEnabled.
+static inline int pwrapPerformanceHudgetPassesEnabled(lua_State* l)
+{
+	LuaUserData* ud;
+	(void)ud;
+	void* voidp;
+	(void)voidp;
+	PtrSize size;
+	(void)size;
+
+	if(ANKI_UNLIKELY(LuaBinder::checkArgsCount(l, 1)))
+	{
+		return -1;
+	}
+
+	// Get "this" as "self"
+	if(LuaBinder::checkUserData(l, 1, luaUserDataTypeInfoPerformanceHud, ud))
+	{
+		return -1;
+	}
+
+	PerformanceHud* self = ud->getData<PerformanceHud>();
+
+	// Call the method
+	Bool ret = self->getPassesEnabled();
+
+	// Push return value
+	lua_pushboolean(l, ret);
+
+	return 1;
+}
+
+/// Wrap method PerformanceHud::getPassesEnabled.
+static int wrapPerformanceHudgetPassesEnabled(lua_State* l)
+{
+	int res = pwrapPerformanceHudgetPassesEnabled(l);
+	if(res >= 0)
+	{
+		return res;
+	}
+
+	lua_error(l);
+	return 0;
+}
+
+/// Pre-wrap method PerformanceHud::setPassesEnabled.
+static inline int pwrapPerformanceHudsetPassesEnabled(lua_State* l)
+{
+	LuaUserData* ud;
+	(void)ud;
+	void* voidp;
+	(void)voidp;
+	PtrSize size;
+	(void)size;
+
+	if(ANKI_UNLIKELY(LuaBinder::checkArgsCount(l, 2)))
+	{
+		return -1;
+	}
+
+	// Get "this" as "self"
+	if(LuaBinder::checkUserData(l, 1, luaUserDataTypeInfoPerformanceHud, ud))
+	{
+		return -1;
+	}
+
+	PerformanceHud* self = ud->getData<PerformanceHud>();
+
+	// Pop arguments
+	Bool arg0;
+	if(ANKI_UNLIKELY(LuaBinder::checkNumber(l, 2, arg0)))
+	{
+		return -1;
+	}
+
+	// Call the method
+	self->setPassesEnabled(arg0);
+
+	return 0;
+}
+
+/// Wrap method PerformanceHud::setPassesEnabled.
+static int wrapPerformanceHudsetPassesEnabled(lua_State* l)
+{
+	int res = pwrapPerformanceHudsetPassesEnabled(l);
+	if(res >= 0)
+	{
+		return res;
+	}
+
+	lua_error(l);
+	return 0;
+}
+
+/// Wrap class PerformanceHud.
+static inline void wrapPerformanceHud(lua_State* l)
+{
+	LuaBinder::createClass(l, &luaUserDataTypeInfoPerformanceHud);
+	LuaBinder::pushLuaCFuncMethod(l, "getEnabled", wrapPerformanceHudgetEnabled);
+	LuaBinder::pushLuaCFuncMethod(l, "setEnabled", wrapPerformanceHudsetEnabled);
+	LuaBinder::pushLuaCFuncMethod(l, "getGraphsEnabled", wrapPerformanceHudgetGraphsEnabled);
+	LuaBinder::pushLuaCFuncMethod(l, "setGraphsEnabled", wrapPerformanceHudsetGraphsEnabled);
+	LuaBinder::pushLuaCFuncMethod(l, "getPassesEnabled", wrapPerformanceHudgetPassesEnabled);
+	LuaBinder::pushLuaCFuncMethod(l, "setPassesEnabled", wrapPerformanceHudsetPassesEnabled);
+	lua_settop(l, 0);
+}
+
+/// Pre-wrap function getPerformanceHud.
+static inline int pwrapgetPerformanceHud(lua_State* l)
+{
+	LuaUserData* ud;
+	(void)ud;
+	void* voidp;
+	(void)voidp;
+	PtrSize size;
+	(void)size;
+
+	if(ANKI_UNLIKELY(LuaBinder::checkArgsCount(l, 0)))
+	{
+		return -1;
+	}
+
+	// Call the function
+	PerformanceHud* ret = getPerformanceHud(l);
+
+	// Push return value
+	if(ANKI_UNLIKELY(ret == nullptr))
+	{
+		lua_pushstring(l, "Glue code returned nullptr");
+		return -1;
+	}
+
+	voidp = lua_newuserdata(l, sizeof(LuaUserData));
+	ud = static_cast<LuaUserData*>(voidp);
+	luaL_setmetatable(l, "PerformanceHud");
+	extern LuaUserDataTypeInfo luaUserDataTypeInfoPerformanceHud;
+	ud->initPointed(&luaUserDataTypeInfoPerformanceHud, const_cast<PerformanceHud*>(ret));
+
+	return 1;
+}
+
+/// Wrap function getPerformanceHud.
+static int wrapgetPerformanceHud(lua_State* l)
+{
+	int res = pwrapgetPerformanceHud(l);
+	if(res >= 0)
+	{
+		return res;
+	}
+
+	lua_error(l);
+	return 0;
+}
+
+/// Wrap the module.
+void wrapModuleCore(lua_State* l)
+{
+	wrapPerformanceHud(l);
+	LuaBinder::pushLuaCFunc(l, "getPerformanceHud", wrapgetPerformanceHud);
+}
+
+} // end namespace anki
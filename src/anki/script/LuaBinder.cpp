@@ -12,6 +12,7 @@ namespace anki
 
 // Forward
 #define ANKI_SCRIPT_CALL_WRAP(x_) void wrapModule##x_(lua_State*)
+ANKI_SCRIPT_CALL_WRAP(Core);
 ANKI_SCRIPT_CALL_WRAP(Logger);
 ANKI_SCRIPT_CALL_WRAP(Math);
 ANKI_SCRIPT_CALL_WRAP(Renderer);
@@ -21,6 +22,7 @@ ANKI_SCRIPT_CALL_WRAP(Scene);
 static void wrapModules(lua_State* l)
 {
 #define ANKI_SCRIPT_CALL_WRAP(x_) wrapModule##x_(l)
+	ANKI_SCRIPT_CALL_WRAP(Core);
 	ANKI_SCRIPT_CALL_WRAP(Logger);
 	ANKI_SCRIPT_CALL_WRAP(Math);
 	ANKI_SCRIPT_CALL_WRAP(Renderer);
@@ -45,6 +47,23 @@ LuaBinder::~LuaBinder()
 		lua_close(m_l);
 	}
 	m_userDataSigToDataInfo.destroy(m_alloc);
+
+	for(LuaBinderProfileEntry& entry : m_profile)
+	{
+		entry.m_name.destroy(m_alloc);
+	}
+	m_profile.destroy(m_alloc);
+
+	// LUA has given everything back by now, release the cached blocks
+	for(void*& head : m_smallBlockFreeLists)
+	{
+		while(head)
+		{
+			void* next = *static_cast<void**>(head);
+			m_alloc.getMemoryPool().free(head);
+			head = next;
+		}
+	}
 }
 
 Error LuaBinder::init(ScriptAllocator alloc, LuaBinderOtherSystems* otherSystems)
@@ -57,6 +76,12 @@ Error LuaBinder::init(ScriptAllocator alloc, LuaBinderOtherSystems* otherSystems
 	luaL_openlibs(m_l);
 	lua_atpanic(m_l, &luaPanic);
 
+	// Most of the garbage is short lived userdata so let the generational collector deal with it where available. In
+	// older versions the collector stays incremental. In both cases the ScriptManager steps it every frame
+#if LUA_VERSION_NUM >= 504
+	lua_gc(m_l, LUA_GCGEN, 0, 0);
+#endif
+
 	wrapModules(m_l);
 
 	return Error::NONE;
@@ -74,7 +99,7 @@ void* LuaBinder::luaAllocCallback(void* userData, void* ptr, PtrSize osize, PtrS
 	{
 		if(ptr != nullptr)
 		{
-			binder.m_alloc.getMemoryPool().free(ptr);
+			binder.freeBlock(ptr, osize);
 		}
 	}
 	else
@@ -83,7 +108,7 @@ void* LuaBinder::luaAllocCallback(void* userData, void* ptr, PtrSize osize, PtrS
 
 		if(ptr == nullptr)
 		{
-			out = binder.m_alloc.getMemoryPool().allocate(nsize, 16);
+			out = binder.allocateBlock(nsize);
 		}
 		else if(nsize <= osize)
 		{
@@ -93,9 +118,9 @@ void* LuaBinder::luaAllocCallback(void* userData, void* ptr, PtrSize osize, PtrS
 		{
 			// realloc
 
-			out = binder.m_alloc.getMemoryPool().allocate(nsize, 16);
+			out = binder.allocateBlock(nsize);
 			memcpy(out, ptr, osize);
-			binder.m_alloc.getMemoryPool().free(ptr);
+			binder.freeBlock(ptr, osize);
 		}
 	}
 #else
@@ -113,6 +138,44 @@ void* LuaBinder::luaAllocCallback(void* userData, void* ptr, PtrSize osize, PtrS
 	return out;
 }
 
+void* LuaBinder::allocateBlock(PtrSize size)
+{
+	ANKI_ASSERT(size > 0);
+	if(size > MAX_SMALL_BLOCK_SIZE)
+	{
+		return m_alloc.getMemoryPool().allocate(size, 16);
+	}
+
+	const U32 sizeClass = U32((size - 1) / SMALL_BLOCK_GRANULARITY);
+	void* out = m_smallBlockFreeLists[sizeClass];
+	if(out)
+	{
+		m_smallBlockFreeLists[sizeClass] = *static_cast<void**>(out);
+	}
+	else
+	{
+		out = m_alloc.getMemoryPool().allocate((sizeClass + 1) * SMALL_BLOCK_GRANULARITY, 16);
+	}
+
+	return out;
+}
+
+void LuaBinder::freeBlock(void* ptr, PtrSize size)
+{
+	ANKI_ASSERT(ptr);
+	if(size > MAX_SMALL_BLOCK_SIZE)
+	{
+		m_alloc.getMemoryPool().free(ptr);
+		return;
+	}
+
+	// The block might have been shrunk in place so it can be bigger than its size class. That's fine, it will only
+	// be handed out for smaller requests
+	const U32 sizeClass = U32((size - 1) / SMALL_BLOCK_GRANULARITY);
+	*static_cast<void**>(ptr) = m_smallBlockFreeLists[sizeClass];
+	m_smallBlockFreeLists[sizeClass] = ptr;
+}
+
 Error LuaBinder::evalString(lua_State* state, const CString& str)
 {
 	ANKI_TRACE_SCOPED_EVENT(LUA_EXEC);
@@ -126,10 +189,54 @@ Error LuaBinder::evalString(lua_State* state, const CString& str)
 		err = Error::USER_DATA;
 	}
 
-	garbageCollect(state);
 	return err;
 }
 
+void LuaBinder::setProfiling(U32 sampleInstructionCount)
+{
+	ANKI_ASSERT(m_l);
+	m_profileSampleInstructionCount = sampleInstructionCount;
+	if(sampleInstructionCount > 0)
+	{
+		lua_sethook(m_l, profilerHook, LUA_MASKCOUNT, I32(sampleInstructionCount));
+	}
+	else
+	{
+		lua_sethook(m_l, nullptr, 0, 0);
+	}
+}
+
+void LuaBinder::profilerHook(lua_State* l, lua_Debug* ar)
+{
+	void* ud;
+	lua_getallocf(l, &ud);
+	ANKI_ASSERT(ud);
+	LuaBinder& binder = *static_cast<LuaBinder*>(ud);
+
+	if(!lua_getinfo(l, "S", ar))
+	{
+		return;
+	}
+
+	// The source string lives as long as the chunk so its address and the line identify the function
+	const U64 key = ptrToNumber(ar->source) ^ (U64(ar->linedefined) << U64(48));
+	auto it = binder.m_profile.find(key);
+	if(it == binder.m_profile.getEnd())
+	{
+		// First time, build the name
+		lua_getinfo(l, "n", ar);
+		LuaBinderProfileEntry entry;
+		entry.m_name.sprintf(binder.m_alloc,
+			"LUA %s (%s:%d)",
+			(ar->name) ? ar->name : "?",
+			ar->short_src,
+			ar->linedefined);
+		it = binder.m_profile.emplace(binder.m_alloc, key, std::move(entry));
+	}
+
+	++it->m_sampleCount;
+}
+
 void LuaBinder::createClass(lua_State* l, const LuaUserDataTypeInfo* typeInfo)
 {
 	ANKI_ASSERT(typeInfo);
@@ -207,38 +314,10 @@ Error LuaBinder::checkString(lua_State* l, I32 stackIdx, const char*& out)
 	return err;
 }
 
-Error LuaBinder::checkUserData(lua_State* l, I32 stackIdx, const LuaUserDataTypeInfo& typeInfo, LuaUserData*& out)
+Error LuaBinder::userDataTypeMismatch(lua_State* l, I32 stackIdx, const LuaUserDataTypeInfo& typeInfo)
 {
-	Error err = Error::NONE;
-
-	void* p = lua_touserdata(l, stackIdx);
-	if(p != nullptr)
-	{
-		out = reinterpret_cast<LuaUserData*>(p);
-		if(out->getSig() == typeInfo.m_signature)
-		{
-			// Check using a LUA method again
-			ANKI_ASSERT(luaL_testudata(l, stackIdx, typeInfo.m_typeName) != nullptr
-						&& "ANKI type check passes but LUA's type check failed");
-		}
-		else
-		{
-			// It's not the correct user data
-			err = Error::USER_DATA;
-		}
-	}
-	else
-	{
-		// It's not user data
-		err = Error::USER_DATA;
-	}
-
-	if(err)
-	{
-		lua_pushfstring(l, "Userdata of %s expected. Got %s", typeInfo.m_typeName, luaL_typename(l, stackIdx));
-	}
-
-	return err;
+	lua_pushfstring(l, "Userdata of %s expected. Got %s", typeInfo.m_typeName, luaL_typename(l, stackIdx));
+	return Error::USER_DATA;
 }
 
 Error LuaBinder::checkArgsCount(lua_State* l, I argsCount)
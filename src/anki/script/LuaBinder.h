@@ -12,6 +12,8 @@
 #include <anki/util/String.h>
 #include <anki/util/Functions.h>
 #include <anki/util/HashMap.h>
+#include <anki/util/Array.h>
+#include <anki/util/List.h>
 #include <lua.hpp>
 #ifndef ANKI_LUA_HPP
 #	error "Wrong LUA header included"
@@ -24,6 +26,7 @@ namespace anki
 class LuaUserData;
 class SceneGraph;
 class MainRenderer;
+class PerformanceHud;
 
 /// @addtogroup script
 /// @{
@@ -143,12 +146,22 @@ public:
 class LuaBinderOtherSystems
 {
 public:
-	SceneGraph* m_sceneGraph;
-	MainRenderer* m_renderer;
+	SceneGraph* m_sceneGraph = nullptr;
+	MainRenderer* m_renderer = nullptr;
+	PerformanceHud* m_performanceHud = nullptr;
+};
+
+/// The samples of a LUA function that the profiler of the LuaBinder gathered.
+/// @memberof LuaBinder
+class LuaBinderProfileEntry
+{
+public:
+	String m_name;
+	U64 m_sampleCount = 0;
 };
 
 /// Lua binder class. A wrapper on top of LUA
-class LuaBinder : public NonCopyable
+class LuaBinder : public NonCopyable, public IntrusiveListEnabled<LuaBinder>
 {
 public:
 	LuaBinder();
@@ -201,6 +214,41 @@ public:
 		lua_gc(state, LUA_GCCOLLECT, 0);
 	}
 
+	/// Do a basic incremental step of the garbage collector.
+	/// @return True if the step finished a collection cycle.
+	Bool stepGarbageCollection()
+	{
+		ANKI_ASSERT(m_l);
+		return lua_gc(m_l, LUA_GCSTEP, 0) != 0;
+	}
+
+	/// Get the memory in KB that the LUA state is using.
+	U32 getMemoryUsage() const
+	{
+		ANKI_ASSERT(m_l);
+		return U32(lua_gc(m_l, LUA_GCCOUNT, 0));
+	}
+
+	/// Start or stop sampling the running LUA functions.
+	/// @param sampleInstructionCount The function that runs gets a sample every that many VM instructions. Zero
+	///                               stops the sampling.
+	void setProfiling(U32 sampleInstructionCount);
+
+	/// Call a functor for every function that got samples since the last call and reset the samples.
+	/// @note Don't call it while the state is running.
+	template<typename TFunc>
+	void flushProfile(TFunc func)
+	{
+		for(LuaBinderProfileEntry& entry : m_profile)
+		{
+			if(entry.m_sampleCount > 0)
+			{
+				func(entry.m_name.toCString(), entry.m_sampleCount * m_profileSampleInstructionCount);
+				entry.m_sampleCount = 0;
+			}
+		}
+	}
+
 	/// For debugging purposes
 	static void stackDump(lua_State* l);
 
@@ -245,7 +293,20 @@ public:
 	/// The function uses the type signature to validate the type and not the
 	/// typeName. That is supposed to be faster.
 	static ANKI_USE_RESULT Error checkUserData(
-		lua_State* l, I32 stackIdx, const LuaUserDataTypeInfo& typeInfo, LuaUserData*& out);
+		lua_State* l, I32 stackIdx, const LuaUserDataTypeInfo& typeInfo, LuaUserData*& out)
+	{
+		LuaUserData* ud = static_cast<LuaUserData*>(lua_touserdata(l, stackIdx));
+		if(ANKI_LIKELY(ud != nullptr && ud->getSig() == typeInfo.m_signature))
+		{
+			// Check using a LUA method again
+			ANKI_ASSERT(luaL_testudata(l, stackIdx, typeInfo.m_typeName) != nullptr
+						&& "ANKI type check passes but LUA's type check failed");
+			out = ud;
+			return Error::NONE;
+		}
+
+		return userDataTypeMismatch(l, stackIdx, typeInfo);
+	}
 
 	/// Allocate memory.
 	static void* luaAlloc(lua_State* l, size_t size, U32 alignment);
@@ -254,13 +315,34 @@ public:
 	static void luaFree(lua_State* l, void* ptr);
 
 private:
+	static constexpr PtrSize SMALL_BLOCK_GRANULARITY = 16;
+	static constexpr U32 SMALL_BLOCK_CLASS_COUNT = 16;
+	static constexpr PtrSize MAX_SMALL_BLOCK_SIZE = SMALL_BLOCK_GRANULARITY * SMALL_BLOCK_CLASS_COUNT;
+
 	LuaBinderOtherSystems* m_otherSystems;
 	ScriptAllocator m_alloc;
 	lua_State* m_l = nullptr;
 	HashMap<I64, const LuaUserDataTypeInfo*> m_userDataSigToDataInfo;
 
+	/// Free lists of small blocks. Most of what LUA allocates per frame (userdata of the math types, small tables and
+	/// strings) is tiny and short lived so recycle those blocks instead of going to the allocator every time.
+	Array<void*, SMALL_BLOCK_CLASS_COUNT> m_smallBlockFreeLists = {};
+
+	/// The sampled functions. The key is the source of the function and the line it's defined.
+	HashMap<U64, LuaBinderProfileEntry> m_profile;
+	U32 m_profileSampleInstructionCount = 0;
+
+	static void profilerHook(lua_State* l, lua_Debug* ar);
+
 	static void* luaAllocCallback(void* userData, void* ptr, PtrSize osize, PtrSize nsize);
 
+	void* allocateBlock(PtrSize size);
+
+	void freeBlock(void* ptr, PtrSize size);
+
+	static ANKI_USE_RESULT Error userDataTypeMismatch(
+		lua_State* l, I32 stackIdx, const LuaUserDataTypeInfo& typeInfo);
+
 	static ANKI_USE_RESULT Error checkNumberInternal(lua_State* l, I32 stackIdx, lua_Number& number);
 };
 /// @}
@@ -131,34 +131,7 @@ static int wrapVec2Ctor(lua_State* l)
 	return 0;
 }
 
-/// Wrap destructor for Vec2.
-static int wrapVec2Dtor(lua_State* l)
-{
-	LuaUserData* ud;
-	(void)ud;
-	void* voidp;
-	(void)voidp;
-	PtrSize size;
-	(void)size;
-
-	if(ANKI_UNLIKELY(LuaBinder::checkArgsCount(l, 1)))
-	{
-		return -1;
-	}
-
-	if(ANKI_UNLIKELY(LuaBinder::checkUserData(l, 1, luaUserDataTypeInfoVec2, ud)))
-	{
-		return -1;
-	}
-
-	if(ud->isGarbageCollected())
-	{
-		Vec2* inst = ud->getData<Vec2>();
-		inst->~Vec2();
-	}
-
-	return 0;
-}
+static_assert(std::is_trivially_destructible<Vec2>::value, "Vec2 is not POD");
 
 /// Pre-wrap method Vec2::getX.
 static inline int pwrapVec2getX(lua_State* l)
@@ -861,6 +834,263 @@ static int wrapVec2__eq(lua_State* l)
 	return 0;
 }
 
+/// Pre-wrap method Vec2::operator+=.
+static inline int pwrapVec2addAssign(lua_State* l)
+{
+	LuaUserData* ud;
+	(void)ud;
+	void* voidp;
+	(void)voidp;
+	PtrSize size;
+	(void)size;
+
+	if(ANKI_UNLIKELY(LuaBinder::checkArgsCount(l, 2)))
+	{
+		return -1;
+	}
+
+	// Get "this" as "self"
+	if(LuaBinder::checkUserData(l, 1, luaUserDataTypeInfoVec2, ud))
+	{
+		return -1;
+	}
+
+	Vec2* self = ud->getData<Vec2>();
+
+	// Pop arguments
+	extern LuaUserDataTypeInfo luaUserDataTypeInfoVec2;
+	if(ANKI_UNLIKELY(LuaBinder::checkUserData(l, 2, luaUserDataTypeInfoVec2, ud)))
+	{
+		return -1;
+	}
+
+	Vec2* iarg0 = ud->getData<Vec2>();
+	const Vec2& arg0(*iarg0);
+
+	// Call the method
+	self->operator+=(arg0);
+
+	return 0;
+}
+
+/// Wrap method Vec2::operator+=.
+static int wrapVec2addAssign(lua_State* l)
+{
+	int res = pwrapVec2addAssign(l);
+	if(res >= 0)
+	{
+		return res;
+	}
+
+	lua_error(l);
+	return 0;
+}
+
+/// Pre-wrap method Vec2::operator-=.
+static inline int pwrapVec2subAssign(lua_State* l)
+{
+	LuaUserData* ud;
+	(void)ud;
+	void* voidp;
+	(void)voidp;
+	PtrSize size;
+	(void)size;
+
+	if(ANKI_UNLIKELY(LuaBinder::checkArgsCount(l, 2)))
+	{
+		return -1;
+	}
+
+	// Get "this" as "self"
+	if(LuaBinder::checkUserData(l, 1, luaUserDataTypeInfoVec2, ud))
+	{
+		return -1;
+	}
+
+	Vec2* self = ud->getData<Vec2>();
+
+	// Pop arguments
+	extern LuaUserDataTypeInfo luaUserDataTypeInfoVec2;
+	if(ANKI_UNLIKELY(LuaBinder::checkUserData(l, 2, luaUserDataTypeInfoVec2, ud)))
+	{
+		return -1;
+	}
+
+	Vec2* iarg0 = ud->getData<Vec2>();
+	const Vec2& arg0(*iarg0);
+
+	// Call the method
+	self->operator-=(arg0);
+
+	return 0;
+}
+
+/// Wrap method Vec2::operator-=.
+static int wrapVec2subAssign(lua_State* l)
+{
+	int res = pwrapVec2subAssign(l);
+	if(res >= 0)
+	{
+		return res;
+	}
+
+	lua_error(l);
+	return 0;
+}
+
+/// Pre-wrap method Vec2::operator*=.
+static inline int pwrapVec2mulAssign(lua_State* l)
+{
+	LuaUserData* ud;
+	(void)ud;
+	void* voidp;
+	(void)voidp;
+	PtrSize size;
+	(void)size;
+
+	if(ANKI_UNLIKELY(LuaBinder::checkArgsCount(l, 2)))
+	{
+		return -1;
+	}
+
+	// Get "this" as "self"
+	if(LuaBinder::checkUserData(l, 1, luaUserDataTypeInfoVec2, ud))
+	{
+		return -1;
+	}
+
+	Vec2* self = ud->getData<Vec2>();
+
+	// Pop arguments
+	extern LuaUserDataTypeInfo luaUserDataTypeInfoVec2;
+	if(ANKI_UNLIKELY(LuaBinder::checkUserData(l, 2, luaUserDataTypeInfoVec2, ud)))
+	{
+		return -1;
+	}
+
+	Vec2* iarg0 = ud->getData<Vec2>();
+	const Vec2& arg0(*iarg0);
+
+	// Call the method
+	self->operator*=(arg0);
+
+	return 0;
+}
+
+/// Wrap method Vec2::operator*=.
+static int wrapVec2mulAssign(lua_State* l)
+{
+	int res = pwrapVec2mulAssign(l);
+	if(res >= 0)
+	{
+		return res;
+	}
+
+	lua_error(l);
+	return 0;
+}
+
+/// Pre-wrap method Vec2::operator/=.
+static inline int pwrapVec2divAssign(lua_State* l)
+{
+	LuaUserData* ud;
+	(void)ud;
+	void* voidp;
+	(void)voidp;
+	PtrSize size;
+	(void)size;
+
+	if(ANKI_UNLIKELY(LuaBinder::checkArgsCount(l, 2)))
+	{
+		return -1;
+	}
+
+	// Get "this" as "self"
+	if(LuaBinder::checkUserData(l, 1, luaUserDataTypeInfoVec2, ud))
+	{
+		return -1;
+	}
+
+	Vec2* self = ud->getData<Vec2>();
+
+	// Pop arguments
+	extern LuaUserDataTypeInfo luaUserDataTypeInfoVec2;
+	if(ANKI_UNLIKELY(LuaBinder::checkUserData(l, 2, luaUserDataTypeInfoVec2, ud)))
+	{
+		return -1;
+	}
+
+	Vec2* iarg0 = ud->getData<Vec2>();
+	const Vec2& arg0(*iarg0);
+
+	// Call the method
+	self->operator/=(arg0);
+
+	return 0;
+}
+
+/// Wrap method Vec2::operator/=.
+static int wrapVec2divAssign(lua_State* l)
+{
+	int res = pwrapVec2divAssign(l);
+	if(res >= 0)
+	{
+		return res;
+	}
+
+	lua_error(l);
+	return 0;
+}
+
+/// Pre-wrap method Vec2::scale.
+static inline int pwrapVec2scale(lua_State* l)
+{
+	LuaUserData* ud;
+	(void)ud;
+	void* voidp;
+	(void)voidp;
+	PtrSize size;
+	(void)size;
+
+	if(ANKI_UNLIKELY(LuaBinder::checkArgsCount(l, 2)))
+	{
+		return -1;
+	}
+
+	// Get "this" as "self"
+	if(LuaBinder::checkUserData(l, 1, luaUserDataTypeInfoVec2, ud))
+	{
+		return -1;
+	}
+
+	Vec2* self = ud->getData<Vec2>();
+
+	// Pop arguments
+	F32 arg0;
+	if(ANKI_UNLIKELY(LuaBinder::checkNumber(l, 2, arg0)))
+	{
+		return -1;
+	}
+
+	// Call the method
+	(*self) *= arg0;
+
+	return 0;
+}
+
+/// Wrap method Vec2::scale.
+static int wrapVec2scale(lua_State* l)
+{
+	int res = pwrapVec2scale(l);
+	if(res >= 0)
+	{
+		return res;
+	}
+
+	lua_error(l);
+	return 0;
+}
+
 /// Pre-wrap method Vec2::getLength.
 static inline int pwrapVec2getLength(lua_State* l)
 {
@@ -1059,7 +1289,6 @@ static inline void wrapVec2(lua_State* l)
 {
 	LuaBinder::createClass(l, &luaUserDataTypeInfoVec2);
 	LuaBinder::pushLuaCFuncStaticMethod(l, luaUserDataTypeInfoVec2.m_typeName, "new", wrapVec2Ctor);
-	LuaBinder::pushLuaCFuncMethod(l, "__gc", wrapVec2Dtor);
 	LuaBinder::pushLuaCFuncMethod(l, "getX", wrapVec2getX);
 	LuaBinder::pushLuaCFuncMethod(l, "getY", wrapVec2getY);
 	LuaBinder::pushLuaCFuncMethod(l, "setX", wrapVec2setX);
@@ -1073,6 +1302,11 @@ static inline void wrapVec2(lua_State* l)
 	LuaBinder::pushLuaCFuncMethod(l, "__mul", wrapVec2__mul);
 	LuaBinder::pushLuaCFuncMethod(l, "__div", wrapVec2__div);
 	LuaBinder::pushLuaCFuncMethod(l, "__eq", wrapVec2__eq);
+	LuaBinder::pushLuaCFuncMethod(l, "addAssign", wrapVec2addAssign);
+	LuaBinder::pushLuaCFuncMethod(l, "subAssign", wrapVec2subAssign);
+	LuaBinder::pushLuaCFuncMethod(l, "mulAssign", wrapVec2mulAssign);
+	LuaBinder::pushLuaCFuncMethod(l, "divAssign", wrapVec2divAssign);
+	LuaBinder::pushLuaCFuncMethod(l, "scale", wrapVec2scale);
 	LuaBinder::pushLuaCFuncMethod(l, "getLength", wrapVec2getLength);
 	LuaBinder::pushLuaCFuncMethod(l, "getNormalized", wrapVec2getNormalized);
 	LuaBinder::pushLuaCFuncMethod(l, "normalize", wrapVec2normalize);
@@ -1243,8 +1477,10 @@ static int wrapVec3Ctor(lua_State* l)
 	return 0;
 }
 
-/// Wrap destructor for Vec3.
-static int wrapVec3Dtor(lua_State* l)
+static_assert(std::is_trivially_destructible<Vec3>::value, "Vec3 is not POD");
+
+/// Pre-wrap method Vec3::getX.
+static inline int pwrapVec3getX(lua_State* l)
 {
 	LuaUserData* ud;
 	(void)ud;
@@ -1258,37 +1494,8 @@ static int wrapVec3Dtor(lua_State* l)
 		return -1;
 	}
 
-	if(ANKI_UNLIKELY(LuaBinder::checkUserData(l, 1, luaUserDataTypeInfoVec3, ud)))
-	{
-		return -1;
-	}
-
-	if(ud->isGarbageCollected())
-	{
-		Vec3* inst = ud->getData<Vec3>();
-		inst->~Vec3();
-	}
-
-	return 0;
-}
-
-/// Pre-wrap method Vec3::getX.
-static inline int pwrapVec3getX(lua_State* l)
-{
-	LuaUserData* ud;
-	(void)ud;
-	void* voidp;
-	(void)voidp;
-	PtrSize size;
-	(void)size;
-
-	if(ANKI_UNLIKELY(LuaBinder::checkArgsCount(l, 1)))
-	{
-		return -1;
-	}
-
-	// Get "this" as "self"
-	if(LuaBinder::checkUserData(l, 1, luaUserDataTypeInfoVec3, ud))
+	// Get "this" as "self"
+	if(LuaBinder::checkUserData(l, 1, luaUserDataTypeInfoVec3, ud))
 	{
 		return -1;
 	}
@@ -2073,6 +2280,263 @@ static int wrapVec3__eq(lua_State* l)
 	return 0;
 }
 
+/// Pre-wrap method Vec3::operator+=.
+static inline int pwrapVec3addAssign(lua_State* l)
+{
+	LuaUserData* ud;
+	(void)ud;
+	void* voidp;
+	(void)voidp;
+	PtrSize size;
+	(void)size;
+
+	if(ANKI_UNLIKELY(LuaBinder::checkArgsCount(l, 2)))
+	{
+		return -1;
+	}
+
+	// Get "this" as "self"
+	if(LuaBinder::checkUserData(l, 1, luaUserDataTypeInfoVec3, ud))
+	{
+		return -1;
+	}
+
+	Vec3* self = ud->getData<Vec3>();
+
+	// Pop arguments
+	extern LuaUserDataTypeInfo luaUserDataTypeInfoVec3;
+	if(ANKI_UNLIKELY(LuaBinder::checkUserData(l, 2, luaUserDataTypeInfoVec3, ud)))
+	{
+		return -1;
+	}
+
+	Vec3* iarg0 = ud->getData<Vec3>();
+	const Vec3& arg0(*iarg0);
+
+	// Call the method
+	self->operator+=(arg0);
+
+	return 0;
+}
+
+/// Wrap method Vec3::operator+=.
+static int wrapVec3addAssign(lua_State* l)
+{
+	int res = pwrapVec3addAssign(l);
+	if(res >= 0)
+	{
+		return res;
+	}
+
+	lua_error(l);
+	return 0;
+}
+
+/// Pre-wrap method Vec3::operator-=.
+static inline int pwrapVec3subAssign(lua_State* l)
+{
+	LuaUserData* ud;
+	(void)ud;
+	void* voidp;
+	(void)voidp;
+	PtrSize size;
+	(void)size;
+
+	if(ANKI_UNLIKELY(LuaBinder::checkArgsCount(l, 2)))
+	{
+		return -1;
+	}
+
+	// Get "this" as "self"
+	if(LuaBinder::checkUserData(l, 1, luaUserDataTypeInfoVec3, ud))
+	{
+		return -1;
+	}
+
+	Vec3* self = ud->getData<Vec3>();
+
+	// Pop arguments
+	extern LuaUserDataTypeInfo luaUserDataTypeInfoVec3;
+	if(ANKI_UNLIKELY(LuaBinder::checkUserData(l, 2, luaUserDataTypeInfoVec3, ud)))
+	{
+		return -1;
+	}
+
+	Vec3* iarg0 = ud->getData<Vec3>();
+	const Vec3& arg0(*iarg0);
+
+	// Call the method
+	self->operator-=(arg0);
+
+	return 0;
+}
+
+/// Wrap method Vec3::operator-=.
+static int wrapVec3subAssign(lua_State* l)
+{
+	int res = pwrapVec3subAssign(l);
+	if(res >= 0)
+	{
+		return res;
+	}
+
+	lua_error(l);
+	return 0;
+}
+
+/// Pre-wrap method Vec3::operator*=.
+static inline int pwrapVec3mulAssign(lua_State* l)
+{
+	LuaUserData* ud;
+	(void)ud;
+	void* voidp;
+	(void)voidp;
+	PtrSize size;
+	(void)size;
+
+	if(ANKI_UNLIKELY(LuaBinder::checkArgsCount(l, 2)))
+	{
+		return -1;
+	}
+
+	// Get "this" as "self"
+	if(LuaBinder::checkUserData(l, 1, luaUserDataTypeInfoVec3, ud))
+	{
+		return -1;
+	}
+
+	Vec3* self = ud->getData<Vec3>();
+
+	// Pop arguments
+	extern LuaUserDataTypeInfo luaUserDataTypeInfoVec3;
+	if(ANKI_UNLIKELY(LuaBinder::checkUserData(l, 2, luaUserDataTypeInfoVec3, ud)))
+	{
+		return -1;
+	}
+
+	Vec3* iarg0 = ud->getData<Vec3>();
+	const Vec3& arg0(*iarg0);
+
+	// Call the method
+	self->operator*=(arg0);
+
+	return 0;
+}
+
+/// Wrap method Vec3::operator*=.
+static int wrapVec3mulAssign(lua_State* l)
+{
+	int res = pwrapVec3mulAssign(l);
+	if(res >= 0)
+	{
+		return res;
+	}
+
+	lua_error(l);
+	return 0;
+}
+
+/// Pre-wrap method Vec3::operator/=.
+static inline int pwrapVec3divAssign(lua_State* l)
+{
+	LuaUserData* ud;
+	(void)ud;
+	void* voidp;
+	(void)voidp;
+	PtrSize size;
+	(void)size;
+
+	if(ANKI_UNLIKELY(LuaBinder::checkArgsCount(l, 2)))
+	{
+		return -1;
+	}
+
+	// Get "this" as "self"
+	if(LuaBinder::checkUserData(l, 1, luaUserDataTypeInfoVec3, ud))
+	{
+		return -1;
+	}
+
+	Vec3* self = ud->getData<Vec3>();
+
+	// Pop arguments
+	extern LuaUserDataTypeInfo luaUserDataTypeInfoVec3;
+	if(ANKI_UNLIKELY(LuaBinder::checkUserData(l, 2, luaUserDataTypeInfoVec3, ud)))
+	{
+		return -1;
+	}
+
+	Vec3* iarg0 = ud->getData<Vec3>();
+	const Vec3& arg0(*iarg0);
+
+	// Call the method
+	self->operator/=(arg0);
+
+	return 0;
+}
+
+/// Wrap method Vec3::operator/=.
+static int wrapVec3divAssign(lua_State* l)
+{
+	int res = pwrapVec3divAssign(l);
+	if(res >= 0)
+	{
+		return res;
+	}
+
+	lua_error(l);
+	return 0;
+}
+
+/// Pre-wrap method Vec3::scale.
+static inline int pwrapVec3scale(lua_State* l)
+{
+	LuaUserData* ud;
+	(void)ud;
+	void* voidp;
+	(void)voidp;
+	PtrSize size;
+	(void)size;
+
+	if(ANKI_UNLIKELY(LuaBinder::checkArgsCount(l, 2)))
+	{
+		return -1;
+	}
+
+	// Get "this" as "self"
+	if(LuaBinder::checkUserData(l, 1, luaUserDataTypeInfoVec3, ud))
+	{
+		return -1;
+	}
+
+	Vec3* self = ud->getData<Vec3>();
+
+	// Pop arguments
+	F32 arg0;
+	if(ANKI_UNLIKELY(LuaBinder::checkNumber(l, 2, arg0)))
+	{
+		return -1;
+	}
+
+	// Call the method
+	(*self) *= arg0;
+
+	return 0;
+}
+
+/// Wrap method Vec3::scale.
+static int wrapVec3scale(lua_State* l)
+{
+	int res = pwrapVec3scale(l);
+	if(res >= 0)
+	{
+		return res;
+	}
+
+	lua_error(l);
+	return 0;
+}
+
 /// Pre-wrap method Vec3::getLength.
 static inline int pwrapVec3getLength(lua_State* l)
 {
@@ -2271,7 +2735,6 @@ static inline void wrapVec3(lua_State* l)
 {
 	LuaBinder::createClass(l, &luaUserDataTypeInfoVec3);
 	LuaBinder::pushLuaCFuncStaticMethod(l, luaUserDataTypeInfoVec3.m_typeName, "new", wrapVec3Ctor);
-	LuaBinder::pushLuaCFuncMethod(l, "__gc", wrapVec3Dtor);
 	LuaBinder::pushLuaCFuncMethod(l, "getX", wrapVec3getX);
 	LuaBinder::pushLuaCFuncMethod(l, "getY", wrapVec3getY);
 	LuaBinder::pushLuaCFuncMethod(l, "getZ", wrapVec3getZ);
@@ -2287,6 +2750,11 @@ static inline void wrapVec3(lua_State* l)
 	LuaBinder::pushLuaCFuncMethod(l, "__mul", wrapVec3__mul);
 	LuaBinder::pushLuaCFuncMethod(l, "__div", wrapVec3__div);
 	LuaBinder::pushLuaCFuncMethod(l, "__eq", wrapVec3__eq);
+	LuaBinder::pushLuaCFuncMethod(l, "addAssign", wrapVec3addAssign);
+	LuaBinder::pushLuaCFuncMethod(l, "subAssign", wrapVec3subAssign);
+	LuaBinder::pushLuaCFuncMethod(l, "mulAssign", wrapVec3mulAssign);
+	LuaBinder::pushLuaCFuncMethod(l, "divAssign", wrapVec3divAssign);
+	LuaBinder::pushLuaCFuncMethod(l, "scale", wrapVec3scale);
 	LuaBinder::pushLuaCFuncMethod(l, "getLength", wrapVec3getLength);
 	LuaBinder::pushLuaCFuncMethod(l, "getNormalized", wrapVec3getNormalized);
 	LuaBinder::pushLuaCFuncMethod(l, "normalize", wrapVec3normalize);
@@ -2463,37 +2931,10 @@ static int wrapVec4Ctor(lua_State* l)
 	return 0;
 }
 
-/// Wrap destructor for Vec4.
-static int wrapVec4Dtor(lua_State* l)
-{
-	LuaUserData* ud;
-	(void)ud;
-	void* voidp;
-	(void)voidp;
-	PtrSize size;
-	(void)size;
-
-	if(ANKI_UNLIKELY(LuaBinder::checkArgsCount(l, 1)))
-	{
-		return -1;
-	}
-
-	if(ANKI_UNLIKELY(LuaBinder::checkUserData(l, 1, luaUserDataTypeInfoVec4, ud)))
-	{
-		return -1;
-	}
-
-	if(ud->isGarbageCollected())
-	{
-		Vec4* inst = ud->getData<Vec4>();
-		inst->~Vec4();
-	}
-
-	return 0;
-}
-
-/// Pre-wrap method Vec4::getX.
-static inline int pwrapVec4getX(lua_State* l)
+static_assert(std::is_trivially_destructible<Vec4>::value, "Vec4 is not POD");
+
+/// Pre-wrap method Vec4::getX.
+static inline int pwrapVec4getX(lua_State* l)
 {
 	LuaUserData* ud;
 	(void)ud;
@@ -2917,15 +3358,296 @@ static inline int pwrapVec4setAll(lua_State* l)
 	}
 
 	// Call the method
-	(*self) = Vec4(arg0, arg1, arg2, arg3);
+	(*self) = Vec4(arg0, arg1, arg2, arg3);
+
+	return 0;
+}
+
+/// Wrap method Vec4::setAll.
+static int wrapVec4setAll(lua_State* l)
+{
+	int res = pwrapVec4setAll(l);
+	if(res >= 0)
+	{
+		return res;
+	}
+
+	lua_error(l);
+	return 0;
+}
+
+/// Pre-wrap method Vec4::getAt.
+static inline int pwrapVec4getAt(lua_State* l)
+{
+	LuaUserData* ud;
+	(void)ud;
+	void* voidp;
+	(void)voidp;
+	PtrSize size;
+	(void)size;
+
+	if(ANKI_UNLIKELY(LuaBinder::checkArgsCount(l, 2)))
+	{
+		return -1;
+	}
+
+	// Get "this" as "self"
+	if(LuaBinder::checkUserData(l, 1, luaUserDataTypeInfoVec4, ud))
+	{
+		return -1;
+	}
+
+	Vec4* self = ud->getData<Vec4>();
+
+	// Pop arguments
+	U arg0;
+	if(ANKI_UNLIKELY(LuaBinder::checkNumber(l, 2, arg0)))
+	{
+		return -1;
+	}
+
+	// Call the method
+	F32 ret = (*self)[arg0];
+
+	// Push return value
+	lua_pushnumber(l, ret);
+
+	return 1;
+}
+
+/// Wrap method Vec4::getAt.
+static int wrapVec4getAt(lua_State* l)
+{
+	int res = pwrapVec4getAt(l);
+	if(res >= 0)
+	{
+		return res;
+	}
+
+	lua_error(l);
+	return 0;
+}
+
+/// Pre-wrap method Vec4::setAt.
+static inline int pwrapVec4setAt(lua_State* l)
+{
+	LuaUserData* ud;
+	(void)ud;
+	void* voidp;
+	(void)voidp;
+	PtrSize size;
+	(void)size;
+
+	if(ANKI_UNLIKELY(LuaBinder::checkArgsCount(l, 3)))
+	{
+		return -1;
+	}
+
+	// Get "this" as "self"
+	if(LuaBinder::checkUserData(l, 1, luaUserDataTypeInfoVec4, ud))
+	{
+		return -1;
+	}
+
+	Vec4* self = ud->getData<Vec4>();
+
+	// Pop arguments
+	U arg0;
+	if(ANKI_UNLIKELY(LuaBinder::checkNumber(l, 2, arg0)))
+	{
+		return -1;
+	}
+
+	F32 arg1;
+	if(ANKI_UNLIKELY(LuaBinder::checkNumber(l, 3, arg1)))
+	{
+		return -1;
+	}
+
+	// Call the method
+	(*self)[arg0] = arg1;
+
+	return 0;
+}
+
+/// Wrap method Vec4::setAt.
+static int wrapVec4setAt(lua_State* l)
+{
+	int res = pwrapVec4setAt(l);
+	if(res >= 0)
+	{
+		return res;
+	}
+
+	lua_error(l);
+	return 0;
+}
+
+/// Pre-wrap method Vec4::operator=.
+static inline int pwrapVec4copy(lua_State* l)
+{
+	LuaUserData* ud;
+	(void)ud;
+	void* voidp;
+	(void)voidp;
+	PtrSize size;
+	(void)size;
+
+	if(ANKI_UNLIKELY(LuaBinder::checkArgsCount(l, 2)))
+	{
+		return -1;
+	}
+
+	// Get "this" as "self"
+	if(LuaBinder::checkUserData(l, 1, luaUserDataTypeInfoVec4, ud))
+	{
+		return -1;
+	}
+
+	Vec4* self = ud->getData<Vec4>();
+
+	// Pop arguments
+	extern LuaUserDataTypeInfo luaUserDataTypeInfoVec4;
+	if(ANKI_UNLIKELY(LuaBinder::checkUserData(l, 2, luaUserDataTypeInfoVec4, ud)))
+	{
+		return -1;
+	}
+
+	Vec4* iarg0 = ud->getData<Vec4>();
+	const Vec4& arg0(*iarg0);
+
+	// Call the method
+	self->operator=(arg0);
+
+	return 0;
+}
+
+/// Wrap method Vec4::operator=.
+static int wrapVec4copy(lua_State* l)
+{
+	int res = pwrapVec4copy(l);
+	if(res >= 0)
+	{
+		return res;
+	}
+
+	lua_error(l);
+	return 0;
+}
+
+/// Pre-wrap method Vec4::operator+.
+static inline int pwrapVec4__add(lua_State* l)
+{
+	LuaUserData* ud;
+	(void)ud;
+	void* voidp;
+	(void)voidp;
+	PtrSize size;
+	(void)size;
+
+	if(ANKI_UNLIKELY(LuaBinder::checkArgsCount(l, 2)))
+	{
+		return -1;
+	}
+
+	// Get "this" as "self"
+	if(LuaBinder::checkUserData(l, 1, luaUserDataTypeInfoVec4, ud))
+	{
+		return -1;
+	}
+
+	Vec4* self = ud->getData<Vec4>();
+
+	// Pop arguments
+	extern LuaUserDataTypeInfo luaUserDataTypeInfoVec4;
+	if(ANKI_UNLIKELY(LuaBinder::checkUserData(l, 2, luaUserDataTypeInfoVec4, ud)))
+	{
+		return -1;
+	}
+
+	Vec4* iarg0 = ud->getData<Vec4>();
+	const Vec4& arg0(*iarg0);
+
+	// Call the method
+	Vec4 ret = self->operator+(arg0);
+
+	// Push return value
+	size = LuaUserData::computeSizeForGarbageCollected<Vec4>();
+	voidp = lua_newuserdata(l, size);
+	luaL_setmetatable(l, "Vec4");
+	ud = static_cast<LuaUserData*>(voidp);
+	extern LuaUserDataTypeInfo luaUserDataTypeInfoVec4;
+	ud->initGarbageCollected(&luaUserDataTypeInfoVec4);
+	::new(ud->getData<Vec4>()) Vec4(std::move(ret));
+
+	return 1;
+}
+
+/// Wrap method Vec4::operator+.
+static int wrapVec4__add(lua_State* l)
+{
+	int res = pwrapVec4__add(l);
+	if(res >= 0)
+	{
+		return res;
+	}
+
+	lua_error(l);
+	return 0;
+}
+
+/// Pre-wrap method Vec4::operator-.
+static inline int pwrapVec4__sub(lua_State* l)
+{
+	LuaUserData* ud;
+	(void)ud;
+	void* voidp;
+	(void)voidp;
+	PtrSize size;
+	(void)size;
+
+	if(ANKI_UNLIKELY(LuaBinder::checkArgsCount(l, 2)))
+	{
+		return -1;
+	}
+
+	// Get "this" as "self"
+	if(LuaBinder::checkUserData(l, 1, luaUserDataTypeInfoVec4, ud))
+	{
+		return -1;
+	}
+
+	Vec4* self = ud->getData<Vec4>();
+
+	// Pop arguments
+	extern LuaUserDataTypeInfo luaUserDataTypeInfoVec4;
+	if(ANKI_UNLIKELY(LuaBinder::checkUserData(l, 2, luaUserDataTypeInfoVec4, ud)))
+	{
+		return -1;
+	}
+
+	Vec4* iarg0 = ud->getData<Vec4>();
+	const Vec4& arg0(*iarg0);
+
+	// Call the method
+	Vec4 ret = self->operator-(arg0);
 
-	return 0;
+	// Push return value
+	size = LuaUserData::computeSizeForGarbageCollected<Vec4>();
+	voidp = lua_newuserdata(l, size);
+	luaL_setmetatable(l, "Vec4");
+	ud = static_cast<LuaUserData*>(voidp);
+	extern LuaUserDataTypeInfo luaUserDataTypeInfoVec4;
+	ud->initGarbageCollected(&luaUserDataTypeInfoVec4);
+	::new(ud->getData<Vec4>()) Vec4(std::move(ret));
+
+	return 1;
 }
 
-/// Wrap method Vec4::setAll.
-static int wrapVec4setAll(lua_State* l)
+/// Wrap method Vec4::operator-.
+static int wrapVec4__sub(lua_State* l)
 {
-	int res = pwrapVec4setAll(l);
+	int res = pwrapVec4__sub(l);
 	if(res >= 0)
 	{
 		return res;
@@ -2935,8 +3657,8 @@ static int wrapVec4setAll(lua_State* l)
 	return 0;
 }
 
-/// Pre-wrap method Vec4::getAt.
-static inline int pwrapVec4getAt(lua_State* l)
+/// Pre-wrap method Vec4::operator*.
+static inline int pwrapVec4__mul(lua_State* l)
 {
 	LuaUserData* ud;
 	(void)ud;
@@ -2959,25 +3681,34 @@ static inline int pwrapVec4getAt(lua_State* l)
 	Vec4* self = ud->getData<Vec4>();
 
 	// Pop arguments
-	U arg0;
-	if(ANKI_UNLIKELY(LuaBinder::checkNumber(l, 2, arg0)))
+	extern LuaUserDataTypeInfo luaUserDataTypeInfoVec4;
+	if(ANKI_UNLIKELY(LuaBinder::checkUserData(l, 2, luaUserDataTypeInfoVec4, ud)))
 	{
 		return -1;
 	}
 
+	Vec4* iarg0 = ud->getData<Vec4>();
+	const Vec4& arg0(*iarg0);
+
 	// Call the method
-	F32 ret = (*self)[arg0];
+	Vec4 ret = self->operator*(arg0);
 
 	// Push return value
-	lua_pushnumber(l, ret);
+	size = LuaUserData::computeSizeForGarbageCollected<Vec4>();
+	voidp = lua_newuserdata(l, size);
+	luaL_setmetatable(l, "Vec4");
+	ud = static_cast<LuaUserData*>(voidp);
+	extern LuaUserDataTypeInfo luaUserDataTypeInfoVec4;
+	ud->initGarbageCollected(&luaUserDataTypeInfoVec4);
+	::new(ud->getData<Vec4>()) Vec4(std::move(ret));
 
 	return 1;
 }
 
-/// Wrap method Vec4::getAt.
-static int wrapVec4getAt(lua_State* l)
+/// Wrap method Vec4::operator*.
+static int wrapVec4__mul(lua_State* l)
 {
-	int res = pwrapVec4getAt(l);
+	int res = pwrapVec4__mul(l);
 	if(res >= 0)
 	{
 		return res;
@@ -2987,8 +3718,8 @@ static int wrapVec4getAt(lua_State* l)
 	return 0;
 }
 
-/// Pre-wrap method Vec4::setAt.
-static inline int pwrapVec4setAt(lua_State* l)
+/// Pre-wrap method Vec4::operator/.
+static inline int pwrapVec4__div(lua_State* l)
 {
 	LuaUserData* ud;
 	(void)ud;
@@ -2997,7 +3728,7 @@ static inline int pwrapVec4setAt(lua_State* l)
 	PtrSize size;
 	(void)size;
 
-	if(ANKI_UNLIKELY(LuaBinder::checkArgsCount(l, 3)))
+	if(ANKI_UNLIKELY(LuaBinder::checkArgsCount(l, 2)))
 	{
 		return -1;
 	}
@@ -3011,28 +3742,34 @@ static inline int pwrapVec4setAt(lua_State* l)
 	Vec4* self = ud->getData<Vec4>();
 
 	// Pop arguments
-	U arg0;
-	if(ANKI_UNLIKELY(LuaBinder::checkNumber(l, 2, arg0)))
+	extern LuaUserDataTypeInfo luaUserDataTypeInfoVec4;
+	if(ANKI_UNLIKELY(LuaBinder::checkUserData(l, 2, luaUserDataTypeInfoVec4, ud)))
 	{
 		return -1;
 	}
 
-	F32 arg1;
-	if(ANKI_UNLIKELY(LuaBinder::checkNumber(l, 3, arg1)))
-	{
-		return -1;
-	}
+	Vec4* iarg0 = ud->getData<Vec4>();
+	const Vec4& arg0(*iarg0);
 
 	// Call the method
-	(*self)[arg0] = arg1;
+	Vec4 ret = self->operator/(arg0);
 
-	return 0;
+	// Push return value
+	size = LuaUserData::computeSizeForGarbageCollected<Vec4>();
+	voidp = lua_newuserdata(l, size);
+	luaL_setmetatable(l, "Vec4");
+	ud = static_cast<LuaUserData*>(voidp);
+	extern LuaUserDataTypeInfo luaUserDataTypeInfoVec4;
+	ud->initGarbageCollected(&luaUserDataTypeInfoVec4);
+	::new(ud->getData<Vec4>()) Vec4(std::move(ret));
+
+	return 1;
 }
 
-/// Wrap method Vec4::setAt.
-static int wrapVec4setAt(lua_State* l)
+/// Wrap method Vec4::operator/.
+static int wrapVec4__div(lua_State* l)
 {
-	int res = pwrapVec4setAt(l);
+	int res = pwrapVec4__div(l);
 	if(res >= 0)
 	{
 		return res;
@@ -3042,8 +3779,8 @@ static int wrapVec4setAt(lua_State* l)
 	return 0;
 }
 
-/// Pre-wrap method Vec4::operator=.
-static inline int pwrapVec4copy(lua_State* l)
+/// Pre-wrap method Vec4::operator==.
+static inline int pwrapVec4__eq(lua_State* l)
 {
 	LuaUserData* ud;
 	(void)ud;
@@ -3076,15 +3813,18 @@ static inline int pwrapVec4copy(lua_State* l)
 	const Vec4& arg0(*iarg0);
 
 	// Call the method
-	self->operator=(arg0);
+	Bool ret = self->operator==(arg0);
 
-	return 0;
+	// Push return value
+	lua_pushboolean(l, ret);
+
+	return 1;
 }
 
-/// Wrap method Vec4::operator=.
-static int wrapVec4copy(lua_State* l)
+/// Wrap method Vec4::operator==.
+static int wrapVec4__eq(lua_State* l)
 {
-	int res = pwrapVec4copy(l);
+	int res = pwrapVec4__eq(l);
 	if(res >= 0)
 	{
 		return res;
@@ -3094,8 +3834,8 @@ static int wrapVec4copy(lua_State* l)
 	return 0;
 }
 
-/// Pre-wrap method Vec4::operator+.
-static inline int pwrapVec4__add(lua_State* l)
+/// Pre-wrap method Vec4::operator+=.
+static inline int pwrapVec4addAssign(lua_State* l)
 {
 	LuaUserData* ud;
 	(void)ud;
@@ -3128,24 +3868,15 @@ static inline int pwrapVec4__add(lua_State* l)
 	const Vec4& arg0(*iarg0);
 
 	// Call the method
-	Vec4 ret = self->operator+(arg0);
-
-	// Push return value
-	size = LuaUserData::computeSizeForGarbageCollected<Vec4>();
-	voidp = lua_newuserdata(l, size);
-	luaL_setmetatable(l, "Vec4");
-	ud = static_cast<LuaUserData*>(voidp);
-	extern LuaUserDataTypeInfo luaUserDataTypeInfoVec4;
-	ud->initGarbageCollected(&luaUserDataTypeInfoVec4);
-	::new(ud->getData<Vec4>()) Vec4(std::move(ret));
+	self->operator+=(arg0);
 
-	return 1;
+	return 0;
 }
 
-/// Wrap method Vec4::operator+.
-static int wrapVec4__add(lua_State* l)
+/// Wrap method Vec4::operator+=.
+static int wrapVec4addAssign(lua_State* l)
 {
-	int res = pwrapVec4__add(l);
+	int res = pwrapVec4addAssign(l);
 	if(res >= 0)
 	{
 		return res;
@@ -3155,8 +3886,8 @@ static int wrapVec4__add(lua_State* l)
 	return 0;
 }
 
-/// Pre-wrap method Vec4::operator-.
-static inline int pwrapVec4__sub(lua_State* l)
+/// Pre-wrap method Vec4::operator-=.
+static inline int pwrapVec4subAssign(lua_State* l)
 {
 	LuaUserData* ud;
 	(void)ud;
@@ -3189,24 +3920,15 @@ static inline int pwrapVec4__sub(lua_State* l)
 	const Vec4& arg0(*iarg0);
 
 	// Call the method
-	Vec4 ret = self->operator-(arg0);
-
-	// Push return value
-	size = LuaUserData::computeSizeForGarbageCollected<Vec4>();
-	voidp = lua_newuserdata(l, size);
-	luaL_setmetatable(l, "Vec4");
-	ud = static_cast<LuaUserData*>(voidp);
-	extern LuaUserDataTypeInfo luaUserDataTypeInfoVec4;
-	ud->initGarbageCollected(&luaUserDataTypeInfoVec4);
-	::new(ud->getData<Vec4>()) Vec4(std::move(ret));
+	self->operator-=(arg0);
 
-	return 1;
+	return 0;
 }
 
-/// Wrap method Vec4::operator-.
-static int wrapVec4__sub(lua_State* l)
+/// Wrap method Vec4::operator-=.
+static int wrapVec4subAssign(lua_State* l)
 {
-	int res = pwrapVec4__sub(l);
+	int res = pwrapVec4subAssign(l);
 	if(res >= 0)
 	{
 		return res;
@@ -3216,8 +3938,8 @@ static int wrapVec4__sub(lua_State* l)
 	return 0;
 }
 
-/// Pre-wrap method Vec4::operator*.
-static inline int pwrapVec4__mul(lua_State* l)
+/// Pre-wrap method Vec4::operator*=.
+static inline int pwrapVec4mulAssign(lua_State* l)
 {
 	LuaUserData* ud;
 	(void)ud;
@@ -3250,24 +3972,15 @@ static inline int pwrapVec4__mul(lua_State* l)
 	const Vec4& arg0(*iarg0);
 
 	// Call the method
-	Vec4 ret = self->operator*(arg0);
-
-	// Push return value
-	size = LuaUserData::computeSizeForGarbageCollected<Vec4>();
-	voidp = lua_newuserdata(l, size);
-	luaL_setmetatable(l, "Vec4");
-	ud = static_cast<LuaUserData*>(voidp);
-	extern LuaUserDataTypeInfo luaUserDataTypeInfoVec4;
-	ud->initGarbageCollected(&luaUserDataTypeInfoVec4);
-	::new(ud->getData<Vec4>()) Vec4(std::move(ret));
+	self->operator*=(arg0);
 
-	return 1;
+	return 0;
 }
 
-/// Wrap method Vec4::operator*.
-static int wrapVec4__mul(lua_State* l)
+/// Wrap method Vec4::operator*=.
+static int wrapVec4mulAssign(lua_State* l)
 {
-	int res = pwrapVec4__mul(l);
+	int res = pwrapVec4mulAssign(l);
 	if(res >= 0)
 	{
 		return res;
@@ -3277,8 +3990,8 @@ static int wrapVec4__mul(lua_State* l)
 	return 0;
 }
 
-/// Pre-wrap method Vec4::operator/.
-static inline int pwrapVec4__div(lua_State* l)
+/// Pre-wrap method Vec4::operator/=.
+static inline int pwrapVec4divAssign(lua_State* l)
 {
 	LuaUserData* ud;
 	(void)ud;
@@ -3311,24 +4024,15 @@ static inline int pwrapVec4__div(lua_State* l)
 	const Vec4& arg0(*iarg0);
 
 	// Call the method
-	Vec4 ret = self->operator/(arg0);
-
-	// Push return value
-	size = LuaUserData::computeSizeForGarbageCollected<Vec4>();
-	voidp = lua_newuserdata(l, size);
-	luaL_setmetatable(l, "Vec4");
-	ud = static_cast<LuaUserData*>(voidp);
-	extern LuaUserDataTypeInfo luaUserDataTypeInfoVec4;
-	ud->initGarbageCollected(&luaUserDataTypeInfoVec4);
-	::new(ud->getData<Vec4>()) Vec4(std::move(ret));
+	self->operator/=(arg0);
 
-	return 1;
+	return 0;
 }
 
-/// Wrap method Vec4::operator/.
-static int wrapVec4__div(lua_State* l)
+/// Wrap method Vec4::operator/=.
+static int wrapVec4divAssign(lua_State* l)
 {
-	int res = pwrapVec4__div(l);
+	int res = pwrapVec4divAssign(l);
 	if(res >= 0)
 	{
 		return res;
@@ -3338,8 +4042,8 @@ static int wrapVec4__div(lua_State* l)
 	return 0;
 }
 
-/// Pre-wrap method Vec4::operator==.
-static inline int pwrapVec4__eq(lua_State* l)
+/// Pre-wrap method Vec4::scale.
+static inline int pwrapVec4scale(lua_State* l)
 {
 	LuaUserData* ud;
 	(void)ud;
@@ -3362,28 +4066,22 @@ static inline int pwrapVec4__eq(lua_State* l)
 	Vec4* self = ud->getData<Vec4>();
 
 	// Pop arguments
-	extern LuaUserDataTypeInfo luaUserDataTypeInfoVec4;
-	if(ANKI_UNLIKELY(LuaBinder::checkUserData(l, 2, luaUserDataTypeInfoVec4, ud)))
+	F32 arg0;
+	if(ANKI_UNLIKELY(LuaBinder::checkNumber(l, 2, arg0)))
 	{
 		return -1;
 	}
 
-	Vec4* iarg0 = ud->getData<Vec4>();
-	const Vec4& arg0(*iarg0);
-
 	// Call the method
-	Bool ret = self->operator==(arg0);
-
-	// Push return value
-	lua_pushboolean(l, ret);
+	(*self) *= arg0;
 
-	return 1;
+	return 0;
 }
 
-/// Wrap method Vec4::operator==.
-static int wrapVec4__eq(lua_State* l)
+/// Wrap method Vec4::scale.
+static int wrapVec4scale(lua_State* l)
 {
-	int res = pwrapVec4__eq(l);
+	int res = pwrapVec4scale(l);
 	if(res >= 0)
 	{
 		return res;
@@ -3591,7 +4289,6 @@ static inline void wrapVec4(lua_State* l)
 {
 	LuaBinder::createClass(l, &luaUserDataTypeInfoVec4);
 	LuaBinder::pushLuaCFuncStaticMethod(l, luaUserDataTypeInfoVec4.m_typeName, "new", wrapVec4Ctor);
-	LuaBinder::pushLuaCFuncMethod(l, "__gc", wrapVec4Dtor);
 	LuaBinder::pushLuaCFuncMethod(l, "getX", wrapVec4getX);
 	LuaBinder::pushLuaCFuncMethod(l, "getY", wrapVec4getY);
 	LuaBinder::pushLuaCFuncMethod(l, "getZ", wrapVec4getZ);
@@ -3609,6 +4306,11 @@ static inline void wrapVec4(lua_State* l)
 	LuaBinder::pushLuaCFuncMethod(l, "__mul", wrapVec4__mul);
 	LuaBinder::pushLuaCFuncMethod(l, "__div", wrapVec4__div);
 	LuaBinder::pushLuaCFuncMethod(l, "__eq", wrapVec4__eq);
+	LuaBinder::pushLuaCFuncMethod(l, "addAssign", wrapVec4addAssign);
+	LuaBinder::pushLuaCFuncMethod(l, "subAssign", wrapVec4subAssign);
+	LuaBinder::pushLuaCFuncMethod(l, "mulAssign", wrapVec4mulAssign);
+	LuaBinder::pushLuaCFuncMethod(l, "divAssign", wrapVec4divAssign);
+	LuaBinder::pushLuaCFuncMethod(l, "scale", wrapVec4scale);
 	LuaBinder::pushLuaCFuncMethod(l, "getLength", wrapVec4getLength);
 	LuaBinder::pushLuaCFuncMethod(l, "getNormalized", wrapVec4getNormalized);
 	LuaBinder::pushLuaCFuncMethod(l, "normalize", wrapVec4normalize);
@@ -3714,34 +4416,7 @@ static int wrapMat3Ctor(lua_State* l)
 	return 0;
 }
 
-/// Wrap destructor for Mat3.
-static int wrapMat3Dtor(lua_State* l)
-{
-	LuaUserData* ud;
-	(void)ud;
-	void* voidp;
-	(void)voidp;
-	PtrSize size;
-	(void)size;
-
-	if(ANKI_UNLIKELY(LuaBinder::checkArgsCount(l, 1)))
-	{
-		return -1;
-	}
-
-	if(ANKI_UNLIKELY(LuaBinder::checkUserData(l, 1, luaUserDataTypeInfoMat3, ud)))
-	{
-		return -1;
-	}
-
-	if(ud->isGarbageCollected())
-	{
-		Mat3* inst = ud->getData<Mat3>();
-		inst->~Mat3();
-	}
-
-	return 0;
-}
+static_assert(std::is_trivially_destructible<Mat3>::value, "Mat3 is not POD");
 
 /// Pre-wrap method Mat3::operator=.
 static inline int pwrapMat3copy(lua_State* l)
@@ -4016,7 +4691,6 @@ static inline void wrapMat3(lua_State* l)
 {
 	LuaBinder::createClass(l, &luaUserDataTypeInfoMat3);
 	LuaBinder::pushLuaCFuncStaticMethod(l, luaUserDataTypeInfoMat3.m_typeName, "new", wrapMat3Ctor);
-	LuaBinder::pushLuaCFuncMethod(l, "__gc", wrapMat3Dtor);
 	LuaBinder::pushLuaCFuncMethod(l, "copy", wrapMat3copy);
 	LuaBinder::pushLuaCFuncMethod(l, "getAt", wrapMat3getAt);
 	LuaBinder::pushLuaCFuncMethod(l, "setAt", wrapMat3setAt);
@@ -4122,34 +4796,7 @@ static int wrapMat3x4Ctor(lua_State* l)
 	return 0;
 }
 
-/// Wrap destructor for Mat3x4.
-static int wrapMat3x4Dtor(lua_State* l)
-{
-	LuaUserData* ud;
-	(void)ud;
-	void* voidp;
-	(void)voidp;
-	PtrSize size;
-	(void)size;
-
-	if(ANKI_UNLIKELY(LuaBinder::checkArgsCount(l, 1)))
-	{
-		return -1;
-	}
-
-	if(ANKI_UNLIKELY(LuaBinder::checkUserData(l, 1, luaUserDataTypeInfoMat3x4, ud)))
-	{
-		return -1;
-	}
-
-	if(ud->isGarbageCollected())
-	{
-		Mat3x4* inst = ud->getData<Mat3x4>();
-		inst->~Mat3x4();
-	}
-
-	return 0;
-}
+static_assert(std::is_trivially_destructible<Mat3x4>::value, "Mat3x4 is not POD");
 
 /// Pre-wrap method Mat3x4::operator=.
 static inline int pwrapMat3x4copy(lua_State* l)
@@ -4442,7 +5089,6 @@ static inline void wrapMat3x4(lua_State* l)
 {
 	LuaBinder::createClass(l, &luaUserDataTypeInfoMat3x4);
 	LuaBinder::pushLuaCFuncStaticMethod(l, luaUserDataTypeInfoMat3x4.m_typeName, "new", wrapMat3x4Ctor);
-	LuaBinder::pushLuaCFuncMethod(l, "__gc", wrapMat3x4Dtor);
 	LuaBinder::pushLuaCFuncMethod(l, "copy", wrapMat3x4copy);
 	LuaBinder::pushLuaCFuncMethod(l, "getAt", wrapMat3x4getAt);
 	LuaBinder::pushLuaCFuncMethod(l, "setAt", wrapMat3x4setAt);
@@ -4566,34 +5212,7 @@ static int wrapTransformCtor(lua_State* l)
 	return 0;
 }
 
-/// Wrap destructor for Transform.
-static int wrapTransformDtor(lua_State* l)
-{
-	LuaUserData* ud;
-	(void)ud;
-	void* voidp;
-	(void)voidp;
-	PtrSize size;
-	(void)size;
-
-	if(ANKI_UNLIKELY(LuaBinder::checkArgsCount(l, 1)))
-	{
-		return -1;
-	}
-
-	if(ANKI_UNLIKELY(LuaBinder::checkUserData(l, 1, luaUserDataTypeInfoTransform, ud)))
-	{
-		return -1;
-	}
-
-	if(ud->isGarbageCollected())
-	{
-		Transform* inst = ud->getData<Transform>();
-		inst->~Transform();
-	}
-
-	return 0;
-}
+static_assert(std::is_trivially_destructible<Transform>::value, "Transform is not POD");
 
 /// Pre-wrap method Transform::operator=.
 static inline int pwrapTransformcopy(lua_State* l)
@@ -4952,7 +5571,6 @@ static inline void wrapTransform(lua_State* l)
 {
 	LuaBinder::createClass(l, &luaUserDataTypeInfoTransform);
 	LuaBinder::pushLuaCFuncStaticMethod(l, luaUserDataTypeInfoTransform.m_typeName, "new", wrapTransformCtor);
-	LuaBinder::pushLuaCFuncMethod(l, "__gc", wrapTransformDtor);
 	LuaBinder::pushLuaCFuncMethod(l, "copy", wrapTransformcopy);
 	LuaBinder::pushLuaCFuncMethod(l, "getOrigin", wrapTransformgetOrigin);
 	LuaBinder::pushLuaCFuncMethod(l, "setOrigin", wrapTransformsetOrigin);
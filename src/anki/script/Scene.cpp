@@ -1626,11 +1626,115 @@ static int wrapTriggerComponentgetContactSceneNodes(lua_State* l)
 	return 0;
 }
 
+/// Pre-wrap method TriggerComponent::getEnteredSceneNodes.
+static inline int pwrapTriggerComponentgetEnteredSceneNodes(lua_State* l)
+{
+	LuaUserData* ud;
+	(void)ud;
+	void* voidp;
+	(void)voidp;
+	PtrSize size;
+	(void)size;
+
+	if(ANKI_UNLIKELY(LuaBinder::checkArgsCount(l, 1)))
+	{
+		return -1;
+	}
+
+	// Get "this" as "self"
+	if(LuaBinder::checkUserData(l, 1, luaUserDataTypeInfoTriggerComponent, ud))
+	{
+		return -1;
+	}
+
+	TriggerComponent* self = ud->getData<TriggerComponent>();
+
+	// Call the method
+	WeakArraySceneNodePtr ret = self->getEnteredSceneNodes();
+
+	// Push return value
+	size = LuaUserData::computeSizeForGarbageCollected<WeakArraySceneNodePtr>();
+	voidp = lua_newuserdata(l, size);
+	luaL_setmetatable(l, "WeakArraySceneNodePtr");
+	ud = static_cast<LuaUserData*>(voidp);
+	extern LuaUserDataTypeInfo luaUserDataTypeInfoWeakArraySceneNodePtr;
+	ud->initGarbageCollected(&luaUserDataTypeInfoWeakArraySceneNodePtr);
+	::new(ud->getData<WeakArraySceneNodePtr>()) WeakArraySceneNodePtr(std::move(ret));
+
+	return 1;
+}
+
+/// Wrap method TriggerComponent::getEnteredSceneNodes.
+static int wrapTriggerComponentgetEnteredSceneNodes(lua_State* l)
+{
+	int res = pwrapTriggerComponentgetEnteredSceneNodes(l);
+	if(res >= 0)
+	{
+		return res;
+	}
+
+	lua_error(l);
+	return 0;
+}
+
+/// Pre-wrap method TriggerComponent::getExitedSceneNodes.
+static inline int pwrapTriggerComponentgetExitedSceneNodes(lua_State* l)
+{
+	LuaUserData* ud;
+	(void)ud;
+	void* voidp;
+	(void)voidp;
+	PtrSize size;
+	(void)size;
+
+	if(ANKI_UNLIKELY(LuaBinder::checkArgsCount(l, 1)))
+	{
+		return -1;
+	}
+
+	// Get "this" as "self"
+	if(LuaBinder::checkUserData(l, 1, luaUserDataTypeInfoTriggerComponent, ud))
+	{
+		return -1;
+	}
+
+	TriggerComponent* self = ud->getData<TriggerComponent>();
+
+	// Call the method
+	WeakArraySceneNodePtr ret = self->getExitedSceneNodes();
+
+	// Push return value
+	size = LuaUserData::computeSizeForGarbageCollected<WeakArraySceneNodePtr>();
+	voidp = lua_newuserdata(l, size);
+	luaL_setmetatable(l, "WeakArraySceneNodePtr");
+	ud = static_cast<LuaUserData*>(voidp);
+	extern LuaUserDataTypeInfo luaUserDataTypeInfoWeakArraySceneNodePtr;
+	ud->initGarbageCollected(&luaUserDataTypeInfoWeakArraySceneNodePtr);
+	::new(ud->getData<WeakArraySceneNodePtr>()) WeakArraySceneNodePtr(std::move(ret));
+
+	return 1;
+}
+
+/// Wrap method TriggerComponent::getExitedSceneNodes.
+static int wrapTriggerComponentgetExitedSceneNodes(lua_State* l)
+{
+	int res = pwrapTriggerComponentgetExitedSceneNodes(l);
+	if(res >= 0)
+	{
+		return res;
+	}
+
+	lua_error(l);
+	return 0;
+}
+
 /// Wrap class TriggerComponent.
 static inline void wrapTriggerComponent(lua_State* l)
 {
 	LuaBinder::createClass(l, &luaUserDataTypeInfoTriggerComponent);
 	LuaBinder::pushLuaCFuncMethod(l, "getContactSceneNodes", wrapTriggerComponentgetContactSceneNodes);
+	LuaBinder::pushLuaCFuncMethod(l, "getEnteredSceneNodes", wrapTriggerComponentgetEnteredSceneNodes);
+	LuaBinder::pushLuaCFuncMethod(l, "getExitedSceneNodes", wrapTriggerComponentgetExitedSceneNodes);
 	lua_settop(l, 0);
 }
 
@@ -2475,6 +2579,142 @@ static int wrapSceneNodesetMarkedForDeletion(lua_State* l)
 	return 0;
 }
 
+/// Pre-wrap method SceneNode::setStatic.
+static inline int pwrapSceneNodesetStatic(lua_State* l)
+{
+	LuaUserData* ud;
+	(void)ud;
+	void* voidp;
+	(void)voidp;
+	PtrSize size;
+	(void)size;
+
+	if(ANKI_UNLIKELY(LuaBinder::checkArgsCount(l, 2)))
+	{
+		return -1;
+	}
+
+	// Get "this" as "self"
+	if(LuaBinder::checkUserData(l, 1, luaUserDataTypeInfoSceneNode, ud))
+	{
+		return -1;
+	}
+
+	SceneNode* self = ud->getData<SceneNode>();
+
+	// Pop arguments
+	Bool arg0;
+	if(ANKI_UNLIKELY(LuaBinder::checkNumber(l, 2, arg0)))
+	{
+		return -1;
+	}
+
+	// Call the method
+	self->setStatic(arg0);
+
+	return 0;
+}
+
+/// Wrap method SceneNode::setStatic.
+static int wrapSceneNodesetStatic(lua_State* l)
+{
+	int res = pwrapSceneNodesetStatic(l);
+	if(res >= 0)
+	{
+		return res;
+	}
+
+	lua_error(l);
+	return 0;
+}
+
+/// Pre-wrap method SceneNode::isStatic.
+static inline int pwrapSceneNodeisStatic(lua_State* l)
+{
+	LuaUserData* ud;
+	(void)ud;
+	void* voidp;
+	(void)voidp;
+	PtrSize size;
+	(void)size;
+
+	if(ANKI_UNLIKELY(LuaBinder::checkArgsCount(l, 1)))
+	{
+		return -1;
+	}
+
+	// Get "this" as "self"
+	if(LuaBinder::checkUserData(l, 1, luaUserDataTypeInfoSceneNode, ud))
+	{
+		return -1;
+	}
+
+	SceneNode* self = ud->getData<SceneNode>();
+
+	// Call the method
+	Bool ret = self->isStatic();
+
+	// Push return value
+	lua_pushboolean(l, ret);
+
+	return 1;
+}
+
+/// Wrap method SceneNode::isStatic.
+static int wrapSceneNodeisStatic(lua_State* l)
+{
+	int res = pwrapSceneNodeisStatic(l);
+	if(res >= 0)
+	{
+		return res;
+	}
+
+	lua_error(l);
+	return 0;
+}
+
+/// Pre-wrap method SceneNode::markDirty.
+static inline int pwrapSceneNodemarkDirty(lua_State* l)
+{
+	LuaUserData* ud;
+	(void)ud;
+	void* voidp;
+	(void)voidp;
+	PtrSize size;
+	(void)size;
+
+	if(ANKI_UNLIKELY(LuaBinder::checkArgsCount(l, 1)))
+	{
+		return -1;
+	}
+
+	// Get "this" as "self"
+	if(LuaBinder::checkUserData(l, 1, luaUserDataTypeInfoSceneNode, ud))
+	{
+		return -1;
+	}
+
+	SceneNode* self = ud->getData<SceneNode>();
+
+	// Call the method
+	self->markDirty();
+
+	return 0;
+}
+
+/// Wrap method SceneNode::markDirty.
+static int wrapSceneNodemarkDirty(lua_State* l)
+{
+	int res = pwrapSceneNodemarkDirty(l);
+	if(res >= 0)
+	{
+		return res;
+	}
+
+	lua_error(l);
+	return 0;
+}
+
 /// Pre-wrap method SceneNode::tryGetComponent<MoveComponent>.
 static inline int pwrapSceneNodegetMoveComponent(lua_State* l)
 {
@@ -2923,6 +3163,9 @@ static inline void wrapSceneNode(lua_State* l)
 	LuaBinder::pushLuaCFuncMethod(l, "getName", wrapSceneNodegetName);
 	LuaBinder::pushLuaCFuncMethod(l, "addChild", wrapSceneNodeaddChild);
 	LuaBinder::pushLuaCFuncMethod(l, "setMarkedForDeletion", wrapSceneNodesetMarkedForDeletion);
+	LuaBinder::pushLuaCFuncMethod(l, "setStatic", wrapSceneNodesetStatic);
+	LuaBinder::pushLuaCFuncMethod(l, "isStatic", wrapSceneNodeisStatic);
+	LuaBinder::pushLuaCFuncMethod(l, "markDirty", wrapSceneNodemarkDirty);
 	LuaBinder::pushLuaCFuncMethod(l, "getMoveComponent", wrapSceneNodegetMoveComponent);
 	LuaBinder::pushLuaCFuncMethod(l, "getLightComponent", wrapSceneNodegetLightComponent);
 	LuaBinder::pushLuaCFuncMethod(l, "getLensFlareComponent", wrapSceneNodegetLensFlareComponent);
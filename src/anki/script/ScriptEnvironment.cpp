@@ -9,12 +9,22 @@
 namespace anki
 {
 
+ScriptEnvironment::~ScriptEnvironment()
+{
+	if(isCreated())
+	{
+		m_manager->unregisterLuaBinder(m_thread);
+	}
+}
+
 Error ScriptEnvironment::init(ScriptManager* manager)
 {
 	ANKI_ASSERT(!isCreated());
 	ANKI_ASSERT(manager);
+	ANKI_CHECK(m_thread.init(manager->getAllocator(), &manager->getOtherSystems()));
 	m_manager = manager;
-	return m_thread.init(m_manager->getAllocator(), &m_manager->getOtherSystems());
+	m_manager->registerLuaBinder(m_thread);
+	return Error::NONE;
 }
 
 } // end namespace anki
\ No newline at end of file
@@ -21,9 +21,7 @@ public:
 	{
 	}
 
-	~ScriptEnvironment()
-	{
-	}
+	~ScriptEnvironment();
 
 	Error init(ScriptManager* manager);
 
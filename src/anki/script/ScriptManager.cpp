@@ -6,6 +6,9 @@
 #include <anki/script/ScriptManager.h>
 #include <anki/script/ScriptEnvironment.h>
 #include <anki/util/Logger.h>
+#include <anki/util/Tracer.h>
+#include <anki/util/HighRezTimer.h>
+#include <anki/util/Hash.h>
 
 namespace anki
 {
@@ -17,6 +20,18 @@ ScriptManager::ScriptManager()
 ScriptManager::~ScriptManager()
 {
 	ANKI_SCRIPT_LOGI("Destroying scripting engine...");
+
+	if(m_binderCount > 0)
+	{
+		unregisterLuaBinder(m_lua);
+	}
+	ANKI_ASSERT(m_binders.isEmpty() && "Some ScriptEnvironments are still alive");
+
+	for(String& name : m_profileCounterNames)
+	{
+		name.destroy(m_alloc);
+	}
+	m_profileCounterNames.destroy(m_alloc);
 }
 
 Error ScriptManager::init(AllocAlignedCallback allocCb, void* allocCbData)
@@ -26,8 +41,112 @@ Error ScriptManager::init(AllocAlignedCallback allocCb, void* allocCbData)
 	m_alloc = ScriptAllocator(allocCb, allocCbData);
 
 	ANKI_CHECK(m_lua.init(m_alloc, &m_otherSystems));
+	registerLuaBinder(m_lua);
 
 	return Error::NONE;
 }
 
+void ScriptManager::registerLuaBinder(LuaBinder& binder)
+{
+	LockGuard<Mutex> lock(m_bindersMtx);
+	m_binders.pushBack(&binder);
+	++m_binderCount;
+
+	if(m_profileSampleInstructionCount > 0)
+	{
+		binder.setProfiling(m_profileSampleInstructionCount);
+	}
+}
+
+void ScriptManager::unregisterLuaBinder(LuaBinder& binder)
+{
+	LockGuard<Mutex> lock(m_bindersMtx);
+	ANKI_ASSERT(m_binderCount > 0);
+	m_binders.erase(&binder);
+	--m_binderCount;
+}
+
+void ScriptManager::stepGarbageCollection(Second budget)
+{
+	ANKI_TRACE_SCOPED_EVENT(SCRIPT_GC);
+	LockGuard<Mutex> lock(m_bindersMtx);
+
+	const Second endTime = HighRezTimer::getCurrentTime() + budget;
+	U32 stepCount = 0;
+	U32 cycleCount = 0;
+
+	// Visit every state at most once per frame. The ones that were stepped go to the back of the list so the next frame
+	// starts from the ones that didn't get a chance
+	for(U32 i = 0; i < m_binderCount && HighRezTimer::getCurrentTime() < endTime; ++i)
+	{
+		LuaBinder& binder = *m_binders.popFront();
+		m_binders.pushBack(&binder);
+
+		// The main state can be used by other threads. Don't wait for them
+		const Bool isMain = &binder == &m_lua;
+		if(isMain && !n_luaMtx.tryLock())
+		{
+			continue;
+		}
+
+		cycleCount += binder.stepGarbageCollection();
+		++stepCount;
+
+		if(isMain)
+		{
+			n_luaMtx.unlock();
+		}
+	}
+
+	ANKI_TRACE_INC_COUNTER(SCRIPT_GC_STEPS, stepCount);
+	ANKI_TRACE_INC_COUNTER(SCRIPT_GC_CYCLES, cycleCount);
+
+#if ANKI_ENABLE_TRACE
+	U64 memory = 0;
+	for(const LuaBinder& binder : m_binders)
+	{
+		memory += binder.getMemoryUsage();
+	}
+	ANKI_TRACE_INC_COUNTER(SCRIPT_MEMORY_KB, memory);
+#endif
+}
+
+void ScriptManager::setProfiling(U32 sampleInstructionCount)
+{
+	LockGuard<Mutex> lock(m_bindersMtx);
+	m_profileSampleInstructionCount = sampleInstructionCount;
+	for(LuaBinder& binder : m_binders)
+	{
+		binder.setProfiling(sampleInstructionCount);
+	}
+}
+
+void ScriptManager::flushProfiling()
+{
+#if ANKI_ENABLE_TRACE
+	LockGuard<Mutex> lock(m_bindersMtx);
+	if(m_profileSampleInstructionCount == 0)
+	{
+		return;
+	}
+
+	ANKI_TRACE_SCOPED_EVENT(SCRIPT_PROFILE_FLUSH);
+	for(LuaBinder& binder : m_binders)
+	{
+		binder.flushProfile([&](CString name, U64 instructionCount) {
+			const U64 hash = computeHash(name.cstr(), name.getLength());
+			auto it = m_profileCounterNames.find(hash);
+			if(it == m_profileCounterNames.getEnd())
+			{
+				String newName;
+				newName.create(m_alloc, name);
+				it = m_profileCounterNames.emplace(m_alloc, hash, std::move(newName));
+			}
+
+			TracerSingleton::get().incrementCounter(it->cstr(), instructionCount);
+		});
+	}
+#endif
+}
+
 } // end namespace anki
@@ -37,6 +37,11 @@ public:
 		m_otherSystems.m_sceneGraph = scene;
 	}
 
+	void setPerformanceHud(PerformanceHud* hud)
+	{
+		m_otherSystems.m_performanceHud = hud;
+	}
+
 	LuaBinderOtherSystems& getOtherSystems()
 	{
 		return m_otherSystems;
@@ -57,6 +62,23 @@ public:
 		return LuaBinder::evalString(m_lua.getLuaState(), str);
 	}
 
+	/// Run the garbage collectors of all the LUA states incrementally. Call it once per frame at a point where no script
+	/// is running.
+	/// @param budget The max time to spend.
+	void stepGarbageCollection(Second budget);
+
+	/// Sample the LUA functions that run in all the LUA states. The samples are reported as tracer counters with the
+	/// approximate number of VM instructions every function executed.
+	/// @param sampleInstructionCount Take a sample every that many VM instructions. Zero disables the profiler.
+	void setProfiling(U32 sampleInstructionCount);
+
+	/// Send the profiler samples to the tracer. Call it once per frame at a point where no script is running.
+	void flushProfiling();
+
+	ANKI_INTERNAL void registerLuaBinder(LuaBinder& binder);
+
+	ANKI_INTERNAL void unregisterLuaBinder(LuaBinder& binder);
+
 	ANKI_INTERNAL LuaBinder& getLuaBinder()
 	{
 		return m_lua;
@@ -72,6 +94,14 @@ private:
 	ScriptAllocator m_alloc;
 	LuaBinder m_lua;
 	Mutex n_luaMtx;
+
+	/// All the LUA states, the main one and the ones of the ScriptEnvironments. The GC steps go round-robin over it.
+	IntrusiveList<LuaBinder> m_binders;
+	U32 m_binderCount = 0;
+	Mutex m_bindersMtx;
+
+	U32 m_profileSampleInstructionCount = 0;
+	HashMap<U64, String> m_profileCounterNames; ///< The tracer wants names that outlive it. Keep them here.
 };
 /// @}
 
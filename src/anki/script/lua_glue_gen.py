@@ -628,8 +628,16 @@ def class_(class_el):
         has_constructor = True
         constructors(constructors_el, class_name)
 
+    # Plain old data classes don't need a finalizer. Userdata without a __gc is freed in a single GC cycle instead of
+    # being resurrected for another one
+    is_pod = class_el.get("pod") is not None and class_el.get("pod") == "true"
+    if is_pod:
+        wglue("static_assert(std::is_trivially_destructible<%s>::value, \"%s is not POD\");" % (class_name, class_name))
+        wglue("")
+
     # Destructor declarations
-    if has_constructor:
+    has_destructor = has_constructor and not is_pod
+    if has_destructor:
         destructor(class_name)
 
     # Methods LUA C functions declarations
@@ -662,7 +670,7 @@ def class_(class_el):
               (class_name, class_name))
 
     # Register destructor
-    if has_constructor:
+    if has_destructor:
         wglue("LuaBinder::pushLuaCFuncMethod(l, \"__gc\", wrap%sDtor);" % class_name)
 
     # Register methods
@@ -8,6 +8,7 @@
 #include <anki/util/Logger.h>
 #include <anki/util/String.h>
 #include <anki/util/BitSet.h>
+#include <anki/util/WeakArray.h>
 
 namespace anki
 {
@@ -36,6 +37,14 @@ class ShaderProgramPostParseInterface
 {
 public:
 	virtual Bool skipCompilation(U64 programHash) = 0;
+
+	/// Called for every mutation of the program. The skipped mutations are not in the binary unless some other
+	/// mutation is rewritten to them.
+	/// @param mutationHash The same hash as ShaderProgramBinaryMutation::m_hash.
+	virtual Bool skipMutation(U64 mutationHash)
+	{
+		return false;
+	}
 };
 
 /// An interface for asynchronous shader compilation.
@@ -46,6 +55,17 @@ public:
 
 	virtual ANKI_USE_RESULT Error joinTasks() = 0;
 };
+
+/// A cache of the SPIR-V of the shader stages of the variants. The key is a hash of everything that affects the
+/// compilation so only the variants that changed are compiled again. It's called from many threads.
+class ShaderProgramSpirvCacheInterface
+{
+public:
+	/// @return false if the key is not in the cache.
+	virtual Bool load(U64 key, DynamicArrayAuto<U8>& spirv) = 0;
+
+	virtual ANKI_USE_RESULT Error store(U64 key, ConstWeakArray<U8> spirv) = 0;
+};
 /// @}
 
 } // end namespace anki
@@ -125,6 +125,15 @@ static TBuiltInResource setGlslangLimits()
 	c.maxCullDistances = 8;
 	c.maxCombinedClipAndCullDistances = 8;
 	c.maxSamples = 4;
+	c.maxMeshOutputVerticesNV = 256;
+	c.maxMeshOutputPrimitivesNV = 512;
+	c.maxMeshWorkGroupSizeX_NV = 32;
+	c.maxMeshWorkGroupSizeY_NV = 1;
+	c.maxMeshWorkGroupSizeZ_NV = 1;
+	c.maxTaskWorkGroupSizeX_NV = 32;
+	c.maxTaskWorkGroupSizeY_NV = 1;
+	c.maxTaskWorkGroupSizeZ_NV = 1;
+	c.maxMeshViewCountNV = 4;
 
 	c.limits.nonInductiveForLoops = 1;
 	c.limits.whileLoops = 1;
@@ -164,6 +173,12 @@ static EShLanguage ankiToGlslangShaderType(ShaderType shaderType)
 	case ShaderType::COMPUTE:
 		gslangShader = EShLangCompute;
 		break;
+	case ShaderType::TASK:
+		gslangShader = EShLangTaskNV;
+		break;
+	case ShaderType::MESH:
+		gslangShader = EShLangMeshNV;
+		break;
 	default:
 		ANKI_ASSERT(0);
 		gslangShader = EShLangCount;
@@ -228,6 +243,17 @@ Error preprocessGlsl(CString in, StringAuto& out)
 	return Error::NONE;
 }
 
+U64 computeGlslangVersionHash()
+{
+	// Change it when the options of compilerGlslToSpirv or the GLSLANG_LIMITS change
+	constexpr U32 OPTIONS_VERSION = 2;
+
+	const CString glslVersion = glslang::GetGlslVersionString();
+	U64 hash = computeHash(HashVersion::XXH3, &OPTIONS_VERSION, sizeof(OPTIONS_VERSION));
+	hash = appendHash(HashVersion::XXH3, glslVersion.cstr(), glslVersion.getLength(), hash);
+	return hash;
+}
+
 Error compilerGlslToSpirv(
 	CString src, ShaderType shaderType, GenericMemoryPoolAllocator<U8> tmpAlloc, DynamicArrayAuto<U8>& spirv)
 {
@@ -256,8 +282,9 @@ Error compilerGlslToSpirv(
 	}
 
 	// Gen SPIRV
+	// Run the performance passes of spirv-opt. The size passes make smaller binaries but the drivers get slower code
 	glslang::SpvOptions spvOptions;
-	spvOptions.optimizeSize = true;
+	spvOptions.optimizeSize = false;
 	spvOptions.disableOptimizer = false;
 	std::vector<unsigned int> glslangSpirv;
 	glslang::GlslangToSpv(*program.getIntermediate(stage), glslangSpirv, &spvOptions);
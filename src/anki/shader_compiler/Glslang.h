@@ -22,6 +22,9 @@ ANKI_USE_RESULT Error preprocessGlsl(CString in, StringAuto& out);
 /// Compile glsl to SPIR-V.
 ANKI_USE_RESULT Error compilerGlslToSpirv(
 	CString src, ShaderType shaderType, GenericMemoryPoolAllocator<U8> tmpAlloc, DynamicArrayAuto<U8>& spirv);
+
+/// A hash of the glslang version and the options of compilerGlslToSpirv. It's the same on all machines.
+U64 computeGlslangVersionHash();
 /// @}
 
 } // end namespace anki
@@ -13,9 +13,12 @@
 namespace anki
 {
 
-static const char* SHADER_BINARY_MAGIC = "ANKISDR1";
+static const char* SHADER_BINARY_MAGIC = "ANKISDR2";
 const U32 SHADER_BINARY_VERSION = 1;
 
+/// The hash of the SPIR-V cache keys. It's fixed so the caches don't change when HashVersion::LATEST does.
+constexpr HashVersion SPIRV_CACHE_HASH_VERSION = HashVersion::XXH3;
+
 Error ShaderProgramBinaryWrapper::serializeToFile(CString fname) const
 {
 	ANKI_ASSERT(m_binary);
@@ -169,6 +172,7 @@ static Bool spinDials(DynamicArrayAuto<U32>& dials, ConstWeakArray<ShaderProgram
 
 static Error compileSpirv(ConstWeakArray<MutatorValue> mutation,
 	const ShaderProgramParser& parser,
+	ShaderProgramSpirvCacheInterface* spirvCache,
 	GenericMemoryPoolAllocator<U8>& tmpAlloc,
 	Array<DynamicArrayAuto<U8>, U32(ShaderType::COUNT)>& spirv)
 {
@@ -184,9 +188,31 @@ static Error compileSpirv(ConstWeakArray<MutatorValue> mutation,
 			continue;
 		}
 
+		const CString source = parserVariant.getSource(shaderType);
+
+		// The source has the includes and the mutation so it's all the cache key needs besides the compiler
+		U64 cacheKey = 0;
+		if(spirvCache)
+		{
+			const U64 compilerHash = computeGlslangVersionHash();
+			cacheKey = computeHash(SPIRV_CACHE_HASH_VERSION, source.cstr(), source.getLength());
+			cacheKey = appendHash(SPIRV_CACHE_HASH_VERSION, &shaderType, sizeof(shaderType), cacheKey);
+			cacheKey = appendHash(SPIRV_CACHE_HASH_VERSION, &compilerHash, sizeof(compilerHash), cacheKey);
+
+			if(spirvCache->load(cacheKey, spirv[shaderType]))
+			{
+				continue;
+			}
+		}
+
 		// Compile
-		ANKI_CHECK(compilerGlslToSpirv(parserVariant.getSource(shaderType), shaderType, tmpAlloc, spirv[shaderType]));
+		ANKI_CHECK(compilerGlslToSpirv(source, shaderType, tmpAlloc, spirv[shaderType]));
 		ANKI_ASSERT(spirv[shaderType].getSize() > 0);
+
+		if(spirvCache)
+		{
+			ANKI_CHECK(spirvCache->store(cacheKey, ConstWeakArray<U8>(spirv[shaderType])));
+		}
 	}
 
 	return Error::NONE;
@@ -196,10 +222,11 @@ static void compileVariantAsync(ConstWeakArray<MutatorValue> mutation,
 	const ShaderProgramParser& parser,
 	ShaderProgramBinaryVariant& variant,
 	DynamicArrayAuto<ShaderProgramBinaryCodeBlock>& codeBlocks,
-	DynamicArrayAuto<U64>& codeBlockHashes,
+	HashMapAuto<U64, U32>& codeBlockHashes,
 	GenericMemoryPoolAllocator<U8>& tmpAlloc,
 	GenericMemoryPoolAllocator<U8>& binaryAlloc,
 	ShaderProgramAsyncTaskInterface& taskManager,
+	ShaderProgramSpirvCacheInterface* spirvCache,
 	Mutex& mtx,
 	Atomic<I32>& error)
 {
@@ -212,9 +239,10 @@ static void compileVariantAsync(ConstWeakArray<MutatorValue> mutation,
 		GenericMemoryPoolAllocator<U8> m_binaryAlloc;
 		DynamicArrayAuto<MutatorValue> m_mutation{m_tmpAlloc};
 		const ShaderProgramParser* m_parser;
+		ShaderProgramSpirvCacheInterface* m_spirvCache;
 		ShaderProgramBinaryVariant* m_variant;
 		DynamicArrayAuto<ShaderProgramBinaryCodeBlock>* m_codeBlocks;
-		DynamicArrayAuto<U64>* m_codeBlockHashes;
+		HashMapAuto<U64, U32>* m_codeBlockHashes; ///< Hash of the SPIR-V to index in m_codeBlocks.
 		Mutex* m_mtx;
 		Atomic<I32>* m_err;
 
@@ -229,6 +257,7 @@ static void compileVariantAsync(ConstWeakArray<MutatorValue> mutation,
 	ctx->m_mutation.create(mutation.getSize());
 	memcpy(ctx->m_mutation.getBegin(), mutation.getBegin(), mutation.getSizeInBytes());
 	ctx->m_parser = &parser;
+	ctx->m_spirvCache = spirvCache;
 	ctx->m_variant = &variant;
 	ctx->m_codeBlocks = &codeBlocks;
 	ctx->m_codeBlockHashes = &codeBlockHashes;
@@ -248,8 +277,8 @@ static void compileVariantAsync(ConstWeakArray<MutatorValue> mutation,
 
 		// All good, compile the variant
 		Array<DynamicArrayAuto<U8>, U32(ShaderType::COUNT)> spirvs = {
-			{{tmpAlloc}, {tmpAlloc}, {tmpAlloc}, {tmpAlloc}, {tmpAlloc}, {tmpAlloc}}};
-		const Error err = compileSpirv(ctx.m_mutation, *ctx.m_parser, tmpAlloc, spirvs);
+			{{tmpAlloc}, {tmpAlloc}, {tmpAlloc}, {tmpAlloc}, {tmpAlloc}, {tmpAlloc}, {tmpAlloc}, {tmpAlloc}}};
+		const Error err = compileSpirv(ctx.m_mutation, *ctx.m_parser, ctx.m_spirvCache, tmpAlloc, spirvs);
 
 		if(!err)
 		{
@@ -267,33 +296,34 @@ static void compileVariantAsync(ConstWeakArray<MutatorValue> mutation,
 					continue;
 				}
 
-				// Check if the spirv is already generated
+				// Check if the spirv is already generated. Many mutators don't affect all stages so it's common
 				const U64 newHash = computeHash(&spirv[0], spirv.getSize());
-				Bool found = false;
-				for(U32 i = 0; i < ctx.m_codeBlockHashes->getSize(); ++i)
+				auto it = ctx.m_codeBlockHashes->find(newHash);
+				if(it != ctx.m_codeBlockHashes->getEnd())
 				{
-					if((*ctx.m_codeBlockHashes)[i] == newHash)
+					// Compare the bytes as well, a hash collision would be a very hard to find bug
+					const ConstWeakArray<U8> existing = (*ctx.m_codeBlocks)[*it].m_binary;
+					if(existing.getSize() == spirv.getSizeInBytes()
+						&& memcmp(&existing[0], &spirv[0], spirv.getSizeInBytes()) == 0)
 					{
-						// Found it
-						ctx.m_variant->m_codeBlockIndices[shaderType] = i;
-						found = true;
-						break;
+						ctx.m_variant->m_codeBlockIndices[shaderType] = *it;
+						continue;
 					}
 				}
 
-				// Create it if not found
-				if(!found)
-				{
-					U8* code = ctx.m_binaryAlloc.allocate(spirv.getSizeInBytes());
-					memcpy(code, &spirv[0], spirv.getSizeInBytes());
+				// Not found, create it
+				U8* code = ctx.m_binaryAlloc.allocate(spirv.getSizeInBytes());
+				memcpy(code, &spirv[0], spirv.getSizeInBytes());
 
-					ShaderProgramBinaryCodeBlock block;
-					block.m_binary.setArray(code, U32(spirv.getSizeInBytes()));
+				ShaderProgramBinaryCodeBlock block;
+				block.m_binary.setArray(code, U32(spirv.getSizeInBytes()));
 
-					ctx.m_codeBlocks->emplaceBack(block);
-					ctx.m_codeBlockHashes->emplaceBack(newHash);
+				ctx.m_codeBlocks->emplaceBack(block);
+				ctx.m_variant->m_codeBlockIndices[shaderType] = ctx.m_codeBlocks->getSize() - 1;
 
-					ctx.m_variant->m_codeBlockIndices[shaderType] = ctx.m_codeBlocks->getSize() - 1;
+				if(it == ctx.m_codeBlockHashes->getEnd())
+				{
+					ctx.m_codeBlockHashes->emplace(newHash, ctx.m_codeBlocks->getSize() - 1);
 				}
 			}
 		}
@@ -771,6 +801,7 @@ Error compileShaderProgramInternal(CString fname,
 	ShaderProgramFilesystemInterface& fsystem,
 	ShaderProgramPostParseInterface* postParseCallback,
 	ShaderProgramAsyncTaskInterface* taskManager_,
+	ShaderProgramSpirvCacheInterface* spirvCache,
 	GenericMemoryPoolAllocator<U8> tempAllocator,
 	const GpuDeviceCapabilities& gpuCapabilities,
 	const BindlessLimits& bindlessLimits,
@@ -848,16 +879,15 @@ Error compileShaderProgramInternal(CString fname,
 		DynamicArrayAuto<U32> dials(tempAllocator, parser.getMutators().getSize(), 0);
 		DynamicArrayAuto<ShaderProgramBinaryVariant> variants(binaryAllocator);
 		DynamicArrayAuto<ShaderProgramBinaryCodeBlock> codeBlocks(binaryAllocator);
-		DynamicArrayAuto<ShaderProgramBinaryMutation> mutations(binaryAllocator, mutationCount);
-		DynamicArrayAuto<U64> codeBlockHashes(tempAllocator);
+		DynamicArrayAuto<ShaderProgramBinaryMutation> mutations(binaryAllocator);
+		HashMapAuto<U64, U32> codeBlockHashes(tempAllocator);
 		HashMapAuto<U64, U32> mutationHashToIdx(tempAllocator);
 
 		// Grow the storage of the variants array. Can't have it resize, threads will work on stale data
 		variants.resizeStorage(mutationCount);
+		mutations.resizeStorage(mutationCount);
 		const ShaderProgramBinaryVariant* baseVariant = nullptr;
 
-		mutationCount = 0;
-
 		// Spin for all possible combinations of mutators and
 		// - Create the spirv
 		// - Populate the binary variant
@@ -870,15 +900,22 @@ Error compileShaderProgramInternal(CString fname,
 				rewrittenMutationValues[i] = originalMutationValues[i];
 			}
 
-			ShaderProgramBinaryMutation& mutation = mutations[mutationCount++];
+			const U64 mutationHash = computeHash(
+				HashVersion::MURMUR2, originalMutationValues.getBegin(), originalMutationValues.getSizeInBytes());
+			ANKI_ASSERT(mutationHash > 0);
+
+			if(postParseCallback && postParseCallback->skipMutation(mutationHash))
+			{
+				continue;
+			}
+
+			ShaderProgramBinaryMutation& mutation = *mutations.emplaceBack();
 			mutation.m_values.setArray(binaryAllocator.newArray<MutatorValue>(originalMutationValues.getSize()),
 				originalMutationValues.getSize());
 			memcpy(mutation.m_values.getBegin(),
 				originalMutationValues.getBegin(),
 				originalMutationValues.getSizeInBytes());
-
-			mutation.m_hash = computeHash(originalMutationValues.getBegin(), originalMutationValues.getSizeInBytes());
-			ANKI_ASSERT(mutation.m_hash > 0);
+			mutation.m_hash = mutationHash;
 
 			const Bool rewritten = parser.rewriteMutation(
 				WeakArray<MutatorValue>(rewrittenMutationValues.getBegin(), rewrittenMutationValues.getSize()));
@@ -899,19 +936,21 @@ Error compileShaderProgramInternal(CString fname,
 					tempAllocator,
 					binaryAllocator,
 					taskManager,
+					spirvCache,
 					mtx,
 					errorAtomic);
 
 				mutation.m_variantIndex = variants.getSize() - 1;
 
 				ANKI_ASSERT(mutationHashToIdx.find(mutation.m_hash) == mutationHashToIdx.getEnd());
-				mutationHashToIdx.emplace(mutation.m_hash, mutationCount - 1);
+				mutationHashToIdx.emplace(mutation.m_hash, mutations.getSize() - 1);
 			}
 			else
 			{
 				// Check if the rewritten mutation exists
-				const U64 otherMutationHash =
-					computeHash(rewrittenMutationValues.getBegin(), rewrittenMutationValues.getSizeInBytes());
+				const U64 otherMutationHash = computeHash(HashVersion::MURMUR2,
+					rewrittenMutationValues.getBegin(),
+					rewrittenMutationValues.getSizeInBytes());
 				auto it = mutationHashToIdx.find(otherMutationHash);
 
 				ShaderProgramBinaryVariant* variant = nullptr;
@@ -930,10 +969,11 @@ Error compileShaderProgramInternal(CString fname,
 						tempAllocator,
 						binaryAllocator,
 						taskManager,
+						spirvCache,
 						mtx,
 						errorAtomic);
 
-					ShaderProgramBinaryMutation& otherMutation = mutations[mutationCount++];
+					ShaderProgramBinaryMutation& otherMutation = *mutations.emplaceBack();
 					otherMutation.m_values.setArray(
 						binaryAllocator.newArray<MutatorValue>(rewrittenMutationValues.getSize()),
 						rewrittenMutationValues.getSize());
@@ -944,7 +984,7 @@ Error compileShaderProgramInternal(CString fname,
 					mutation.m_hash = otherMutationHash;
 					mutation.m_variantIndex = variants.getSize() - 1;
 
-					it = mutationHashToIdx.emplace(otherMutationHash, mutationCount - 1);
+					it = mutationHashToIdx.emplace(otherMutationHash, mutations.getSize() - 1);
 				}
 
 				// Setup the new mutation
@@ -954,7 +994,7 @@ Error compileShaderProgramInternal(CString fname,
 			}
 		} while(!spinDials(dials, parser.getMutators()));
 
-		ANKI_ASSERT(mutationCount == mutations.getSize());
+		ANKI_ASSERT(mutations.getSize() <= mutationCount);
 		ANKI_ASSERT(baseVariant == variants.getBegin() && "Can't have the variants array grow");
 
 		// Done, wait the threads
@@ -979,7 +1019,7 @@ Error compileShaderProgramInternal(CString fname,
 	{
 		DynamicArrayAuto<MutatorValue> mutation(tempAllocator);
 		DynamicArrayAuto<ShaderProgramBinaryCodeBlock> codeBlocks(binaryAllocator);
-		DynamicArrayAuto<U64> codeBlockHashes(tempAllocator);
+		HashMapAuto<U64, U32> codeBlockHashes(tempAllocator);
 
 		binary.m_variants.setArray(binaryAllocator.newInstance<ShaderProgramBinaryVariant>(), 1);
 
@@ -991,6 +1031,7 @@ Error compileShaderProgramInternal(CString fname,
 			tempAllocator,
 			binaryAllocator,
 			taskManager,
+			spirvCache,
 			mtx,
 			errorAtomic);
 
@@ -1027,13 +1068,21 @@ Error compileShaderProgram(CString fname,
 	ShaderProgramFilesystemInterface& fsystem,
 	ShaderProgramPostParseInterface* postParseCallback,
 	ShaderProgramAsyncTaskInterface* taskManager,
+	ShaderProgramSpirvCacheInterface* spirvCache,
 	GenericMemoryPoolAllocator<U8> tempAllocator,
 	const GpuDeviceCapabilities& gpuCapabilities,
 	const BindlessLimits& bindlessLimits,
 	ShaderProgramBinaryWrapper& binaryW)
 {
-	const Error err = compileShaderProgramInternal(
-		fname, fsystem, postParseCallback, taskManager, tempAllocator, gpuCapabilities, bindlessLimits, binaryW);
+	const Error err = compileShaderProgramInternal(fname,
+		fsystem,
+		postParseCallback,
+		taskManager,
+		spirvCache,
+		tempAllocator,
+		gpuCapabilities,
+		bindlessLimits,
+		binaryW);
 	if(err)
 	{
 		ANKI_SHADER_COMPILER_LOGE("Failed to compile: %s", fname.cstr());
@@ -25,6 +25,7 @@ class ShaderProgramBinaryWrapper : public NonCopyable
 		ShaderProgramFilesystemInterface& fsystem,
 		ShaderProgramPostParseInterface* postParseCallback,
 		ShaderProgramAsyncTaskInterface* taskManager,
+		ShaderProgramSpirvCacheInterface* spirvCache,
 		GenericMemoryPoolAllocator<U8> tempAllocator,
 		const GpuDeviceCapabilities& gpuCapabilities,
 		const BindlessLimits& bindlessLimits,
@@ -51,6 +52,12 @@ public:
 		return *m_binary;
 	}
 
+	ShaderProgramBinary& getBinary()
+	{
+		ANKI_ASSERT(m_binary);
+		return *m_binary;
+	}
+
 private:
 	GenericMemoryPoolAllocator<U8> m_alloc;
 	ShaderProgramBinary* m_binary = nullptr;
@@ -60,10 +67,12 @@ private:
 };
 
 /// Takes an AnKi special shader program and spits a binary.
+/// @param spirvCache Optional. The variants whose SPIR-V is in the cache are not compiled.
 ANKI_USE_RESULT Error compileShaderProgram(CString fname,
 	ShaderProgramFilesystemInterface& fsystem,
 	ShaderProgramPostParseInterface* postParseCallback,
 	ShaderProgramAsyncTaskInterface* taskManager,
+	ShaderProgramSpirvCacheInterface* spirvCache,
 	GenericMemoryPoolAllocator<U8> tempAllocator,
 	const GpuDeviceCapabilities& gpuCapabilities,
 	const BindlessLimits& bindlessLimits,
@@ -17,7 +17,7 @@ namespace anki
 	return Error::USER_DATA
 
 static const Array<CString, U32(ShaderType::COUNT)> SHADER_STAGE_NAMES = {
-	{"VERTEX", "TESSELLATION_CONTROL", "TESSELLATION_EVALUATION", "GEOMETRY", "FRAGMENT", "COMPUTE"}};
+	{"VERTEX", "TESSELLATION_CONTROL", "TESSELLATION_EVALUATION", "GEOMETRY", "FRAGMENT", "COMPUTE", "TASK", "MESH"}};
 
 static const char* SHADER_HEADER = R"(#version 450 core
 #define ANKI_BACKEND_MINOR %u
@@ -42,8 +42,14 @@ static const char* SHADER_HEADER = R"(#version 450 core
 #extension GL_EXT_shader_image_load_formatted : require
 #extension GL_EXT_nonuniform_qualifier : enable
 
+#define ANKI_F16 %u
+#if ANKI_F16
+#extension GL_EXT_shader_explicit_arithmetic_types_float16 : require
+#endif
+
 #define ANKI_MAX_BINDLESS_TEXTURES %u
 #define ANKI_MAX_BINDLESS_IMAGES %u
+#define ANKI_MAX_BINDLESS_BUFFERS %u
 
 #define ANKI_BINDLESS_SET(set_) \
 	layout(set = set_, binding = 0) uniform utexture2D u_bindlessTextures2dU32[ANKI_MAX_BINDLESS_TEXTURES]; \
@@ -51,7 +57,11 @@ static const char* SHADER_HEADER = R"(#version 450 core
 	layout(set = set_, binding = 0) uniform texture2D u_bindlessTextures2dF32[ANKI_MAX_BINDLESS_TEXTURES]; \
 	layout(set = set_, binding = 1) uniform readonly uimage2D u_bindlessImages2dU32[ANKI_MAX_BINDLESS_IMAGES]; \
 	layout(set = set_, binding = 1) uniform readonly iimage2D u_bindlessImages2dI32[ANKI_MAX_BINDLESS_IMAGES]; \
-	layout(set = set_, binding = 1) uniform readonly image2D u_bindlessImages2dF32[ANKI_MAX_BINDLESS_IMAGES];
+	layout(set = set_, binding = 1) uniform readonly image2D u_bindlessImages2dF32[ANKI_MAX_BINDLESS_IMAGES]; \
+	layout(set = set_, binding = 2, std430) readonly buffer b_bindlessBuffers \
+	{ \
+		uint m_u32[]; \
+	} u_bindlessBuffers[ANKI_MAX_BINDLESS_BUFFERS];
 
 #define F32 float
 #define Vec2 vec2
@@ -128,7 +138,7 @@ static const char* SHADER_HEADER = R"(#version 450 core
 #define ANKI_SPECIALIZATION_CONSTANT_VEC4(n, id, defltVal) _ANKI_SCONST_X4(Vec4, F32, n, id, defltVal,)
 )";
 
-static const U64 SHADER_HEADER_HASH = computeHash(SHADER_HEADER, sizeof(SHADER_HEADER));
+static const U64 SHADER_HEADER_HASH = computeHash(HashVersion::MURMUR2, SHADER_HEADER, sizeof(SHADER_HEADER));
 
 ShaderProgramParser::ShaderProgramParser(CString fname,
 	ShaderProgramFilesystemInterface* fsystem,
@@ -206,6 +216,14 @@ Error ShaderProgramParser::parsePragmaStart(const StringAuto* begin, const Strin
 	{
 		shaderType = ShaderType::COMPUTE;
 	}
+	else if(*begin == "task")
+	{
+		shaderType = ShaderType::TASK;
+	}
+	else if(*begin == "mesh")
+	{
+		shaderType = ShaderType::MESH;
+	}
 	else
 	{
 		ANKI_PP_ERROR_MALFORMED();
@@ -681,6 +699,22 @@ Error ShaderProgramParser::parse()
 				return Error::USER_DATA;
 			}
 		}
+		else if(!!(m_shaderTypes & ShaderTypeBit::MESH))
+		{
+			if(!!(m_shaderTypes
+				   & (ShaderTypeBit::VERTEX | ShaderTypeBit::TESSELLATION_CONTROL
+						 | ShaderTypeBit::TESSELLATION_EVALUATION | ShaderTypeBit::GEOMETRY)))
+			{
+				ANKI_SHADER_COMPILER_LOGE("Can't combine mesh shader with the vertex pipeline shaders");
+				return Error::USER_DATA;
+			}
+
+			if(!(m_shaderTypes & ShaderTypeBit::FRAGMENT))
+			{
+				ANKI_SHADER_COMPILER_LOGE("Missing fragment shader");
+				return Error::USER_DATA;
+			}
+		}
 		else
 		{
 			if(!(m_shaderTypes & ShaderTypeBit::VERTEX))
@@ -689,6 +723,12 @@ Error ShaderProgramParser::parse()
 				return Error::USER_DATA;
 			}
 
+			if(!!(m_shaderTypes & ShaderTypeBit::TASK))
+			{
+				ANKI_SHADER_COMPILER_LOGE("Task shader without a mesh shader");
+				return Error::USER_DATA;
+			}
+
 			if(!(m_shaderTypes & ShaderTypeBit::FRAGMENT))
 			{
 				ANKI_SHADER_COMPILER_LOGE("Missing fragment shader");
@@ -709,7 +749,8 @@ Error ShaderProgramParser::parse()
 		m_codeLines.join("\n", m_codeSource);
 		m_codeLines.destroy();
 
-		m_codeSourceHash = appendHash(m_codeSource.getBegin(), m_codeSource.getLength(), SHADER_HEADER_HASH);
+		m_codeSourceHash =
+			appendHash(HashVersion::MURMUR2, m_codeSource.getBegin(), m_codeSource.getLength(), SHADER_HEADER_HASH);
 	}
 
 	return Error::NONE;
@@ -722,8 +763,10 @@ void ShaderProgramParser::generateAnkiShaderHeader(
 		caps.m_minorApiVersion,
 		caps.m_majorApiVersion,
 		GPU_VENDOR_STR[caps.m_gpuVendor].cstr(),
+		U32(caps.m_shaderFloat16),
 		limits.m_bindlessTextureCount,
-		limits.m_bindlessImageCount);
+		limits.m_bindlessImageCount,
+		limits.m_bindlessBufferCount);
 }
 
 Error ShaderProgramParser::generateVariant(
@@ -0,0 +1,95 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/shader_compiler/ShaderProgramSpirvCache.h>
+#include <anki/util/File.h>
+#include <anki/util/Filesystem.h>
+#include <anki/util/Functions.h>
+
+namespace anki
+{
+
+/// The first word of a SPIR-V module.
+constexpr U32 SPIRV_MAGIC = 0x07230203;
+
+Error ShaderProgramSpirvFileCache::init(CString dir)
+{
+	ANKI_ASSERT(!dir.isEmpty());
+	m_dir.create(dir);
+
+	if(!directoryExists(dir))
+	{
+		ANKI_CHECK(createDirectory(dir));
+	}
+
+	return Error::NONE;
+}
+
+Bool ShaderProgramSpirvFileCache::load(U64 key, DynamicArrayAuto<U8>& spirv)
+{
+	StringAuto fname(m_dir.getAllocator());
+	fname.sprintf("%s/%016" PRIx64 ".spv", m_dir.cstr(), key);
+
+	File file;
+	Bool found = fileExists(fname) && !file.open(fname, FileOpenFlag::READ | FileOpenFlag::BINARY);
+	if(found)
+	{
+		const PtrSize size = file.getSize();
+		found = size >= sizeof(U32) && (size % sizeof(U32)) == 0;
+		if(found)
+		{
+			spirv.resize(U32(size));
+			found = !file.read(&spirv[0], size) && *reinterpret_cast<const U32*>(&spirv[0]) == SPIRV_MAGIC;
+		}
+
+		if(!found)
+		{
+			ANKI_SHADER_COMPILER_LOGW("Ignoring corrupted SPIR-V in the cache: %s", fname.cstr());
+		}
+	}
+
+	if(found)
+	{
+		m_hitCount.fetchAdd(1);
+	}
+	else
+	{
+		m_missCount.fetchAdd(1);
+	}
+
+	return found;
+}
+
+Error ShaderProgramSpirvFileCache::store(U64 key, ConstWeakArray<U8> spirv)
+{
+	ANKI_ASSERT(spirv.getSize() > 0);
+
+	StringAuto fname(m_dir.getAllocator());
+	fname.sprintf("%s/%016" PRIx64 ".spv", m_dir.cstr(), key);
+
+	// Write to a unique file and rename it so the others never see a half written file
+	StringAuto tmpFname(m_dir.getAllocator());
+	tmpFname.sprintf("%s.%016" PRIx64 ".tmp", fname.cstr(), getRandom());
+	{
+		File file;
+		ANKI_CHECK(file.open(tmpFname, FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+		ANKI_CHECK(file.write(&spirv[0], spirv.getSizeInBytes()));
+	}
+
+	if(std::rename(tmpFname.cstr(), fname.cstr()) != 0)
+	{
+		// Someone else might have stored the same key in the meantime and the platform can't replace it
+		std::remove(tmpFname.cstr());
+		if(!fileExists(fname))
+		{
+			ANKI_SHADER_COMPILER_LOGE("Failed to store SPIR-V to the cache: %s", fname.cstr());
+			return Error::FILE_ACCESS;
+		}
+	}
+
+	return Error::NONE;
+}
+
+} // end namespace anki
@@ -0,0 +1,51 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/shader_compiler/Common.h>
+#include <anki/util/Atomic.h>
+
+namespace anki
+{
+
+/// @addtogroup shader_compiler
+/// @{
+
+/// A ShaderProgramSpirvCacheInterface that keeps the SPIR-V in a directory. The files are named after their key and
+/// they are never modified so the directory can be shared between builds and machines.
+class ShaderProgramSpirvFileCache final : public ShaderProgramSpirvCacheInterface
+{
+public:
+	ShaderProgramSpirvFileCache(GenericMemoryPoolAllocator<U8> alloc)
+		: m_dir(alloc)
+	{
+	}
+
+	/// Create the directory if it's not there.
+	ANKI_USE_RESULT Error init(CString dir);
+
+	Bool load(U64 key, DynamicArrayAuto<U8>& spirv) final;
+
+	ANKI_USE_RESULT Error store(U64 key, ConstWeakArray<U8> spirv) final;
+
+	U32 getHitCount() const
+	{
+		return m_hitCount.load();
+	}
+
+	U32 getMissCount() const
+	{
+		return m_missCount.load();
+	}
+
+private:
+	StringAuto m_dir;
+	Atomic<U32> m_hitCount = {0};
+	Atomic<U32> m_missCount = {0};
+};
+/// @}
+
+} // end namespace anki
@@ -7,10 +7,11 @@
 #include <anki/ui/Font.h>
 #include <anki/ui/UiManager.h>
 #include <anki/resource/ResourceManager.h>
-#include <anki/core/StagingGpuMemoryManager.h>
 #include <anki/input/Input.h>
 #include <anki/gr/Sampler.h>
+#include <anki/gr/Buffer.h>
 #include <anki/gr/GrManager.h>
+#include <anki/util/Hash.h>
 
 namespace anki
 {
@@ -177,11 +178,13 @@ void Canvas::beginBuilding()
 
 	ImGui::NewFrame();
 	ImGui::PushFont(&m_font->getImFont(m_dfltFontHeight));
+	m_fontAtlases.pushBack(m_stackAlloc, m_font->getTextureView().get());
 }
 
 void Canvas::pushFont(const FontPtr& font, U32 fontHeight)
 {
 	m_references.pushBack(m_stackAlloc, IntrusivePtr<UiObject>(const_cast<Font*>(font.get())));
+	m_fontAtlases.pushBack(m_stackAlloc, font->getTextureView().get());
 	ImGui::PushFont(&font->getImFont(fontHeight));
 }
 
@@ -193,6 +196,7 @@ void Canvas::appendToCommandBuffer(CommandBufferPtr cmdb)
 	ImGui::SetCurrentContext(nullptr);
 
 	m_references.destroy(m_stackAlloc);
+	m_fontAtlases.destroy(m_stackAlloc);
 	m_stackAlloc.getMemoryPool().reset();
 }
 
@@ -201,33 +205,29 @@ void Canvas::appendToCommandBufferInternal(CommandBufferPtr& cmdb)
 	ImGui::PopFont();
 	ImGui::Render();
 	ImDrawData& drawData = *ImGui::GetDrawData();
+	m_stats = CanvasStatistics();
 
-	// Allocate index and vertex buffers
-	StagingGpuMemoryToken vertsToken, indicesToken;
+	const PtrSize verticesSize = U32(drawData.TotalVtxCount) * sizeof(ImDrawVert);
+	const PtrSize indicesSize = U32(drawData.TotalIdxCount) * sizeof(ImDrawIdx);
+	if(verticesSize == 0 || indicesSize == 0)
 	{
-		const U32 verticesSize = U32(drawData.TotalVtxCount) * sizeof(ImDrawVert);
-		const U32 indicesSize = U32(drawData.TotalIdxCount) * sizeof(ImDrawIdx);
-
-		if(verticesSize == 0 || indicesSize == 0)
-		{
-			return;
-		}
-
-		ImDrawVert* verts = static_cast<ImDrawVert*>(m_manager->getStagingGpuMemoryManager().allocateFrame(
-			verticesSize, StagingGpuMemoryType::VERTEX, vertsToken));
-		ImDrawIdx* indices = static_cast<ImDrawIdx*>(m_manager->getStagingGpuMemoryManager().allocateFrame(
-			indicesSize, StagingGpuMemoryType::VERTEX, indicesToken));
+		return;
+	}
 
-		for(I n = 0; n < drawData.CmdListsCount; ++n)
-		{
-			const ImDrawList& cmdList = *drawData.CmdLists[n];
-			memcpy(verts, cmdList.VtxBuffer.Data, cmdList.VtxBuffer.Size * sizeof(ImDrawVert));
-			memcpy(indices, cmdList.IdxBuffer.Data, cmdList.IdxBuffer.Size * sizeof(ImDrawIdx));
-			verts += cmdList.VtxBuffer.Size;
-			indices += cmdList.IdxBuffer.Size;
-		}
+	// Upload the geometry only if it's different than the previous frame's. The buffers are persistent so the old one
+	// can be drawn again
+	const PtrSize indicesOffset = getAlignedRoundUp(alignof(ImDrawIdx), verticesSize);
+	const U64 geometryHash = computeGeometryHash(drawData);
+	if(geometryHash != m_geometry.m_hash)
+	{
+		m_geometry.m_hash = geometryHash;
+		m_geometry.m_crntBuffer = (m_geometry.m_crntBuffer + 1) % m_geometry.m_buffers.getSize();
+		uploadGeometry(drawData, m_geometry.m_buffers[m_geometry.m_crntBuffer], indicesOffset, indicesSize);
+		m_stats.m_geometryUploaded = true;
 	}
 
+	const BufferPtr& buff = m_geometry.m_buffers[m_geometry.m_crntBuffer].m_buffer;
+
 	cmdb->setBlendFactors(0, BlendFactor::SRC_ALPHA, BlendFactor::ONE_MINUS_SRC_ALPHA);
 	cmdb->setCullMode(FaceSelectionBit::NONE);
 
@@ -235,12 +235,12 @@ void Canvas::appendToCommandBufferInternal(CommandBufferPtr& cmdb)
 	const F32 fbHeight = drawData.DisplaySize.y * drawData.FramebufferScale.y;
 	cmdb->setViewport(0, 0, U32(fbWidth), U32(fbHeight));
 
-	cmdb->bindVertexBuffer(0, vertsToken.m_buffer, vertsToken.m_offset, sizeof(ImDrawVert));
+	cmdb->bindVertexBuffer(0, buff, 0, sizeof(ImDrawVert));
 	cmdb->setVertexAttribute(0, 0, Format::R32G32_SFLOAT, 0);
 	cmdb->setVertexAttribute(1, 0, Format::R8G8B8A8_UNORM, sizeof(Vec2) * 2);
 	cmdb->setVertexAttribute(2, 0, Format::R32G32_SFLOAT, sizeof(Vec2));
 
-	cmdb->bindIndexBuffer(indicesToken.m_buffer, indicesToken.m_offset, IndexType::U16);
+	cmdb->bindIndexBuffer(buff, indicesOffset, IndexType::U16);
 
 	cmdb->bindSampler(0, 0, m_sampler);
 
@@ -248,6 +248,78 @@ void Canvas::appendToCommandBufferInternal(CommandBufferPtr& cmdb)
 	const Vec2 clipOff = drawData.DisplayPos; // (0,0) unless using multi-viewports
 	const Vec2 clipScale = drawData.FramebufferScale; // (1,1) unless using retina display which are often (2,2)
 
+	// The state of the last draw. Don't set it again if it's the same
+	U32 boundProg = MAX_U32;
+	void* boundTex = nullptr;
+	UVec4 boundScissor(MAX_U32);
+	Bool pushConstantsSet = false;
+
+	// Consecutive commands with the same texture and scissor are merged into one drawcall
+	class
+	{
+	public:
+		void* m_tex = nullptr;
+		UVec4 m_scissor;
+		U32 m_idxOffset = 0;
+		U32 m_elemCount = 0;
+	} pending;
+
+	auto flush = [&](U32 vertOffset) {
+		if(pending.m_elemCount == 0)
+		{
+			return;
+		}
+
+		if(pending.m_scissor != boundScissor)
+		{
+			boundScissor = pending.m_scissor;
+			cmdb->setScissor(boundScissor.x(), boundScissor.y(), boundScissor.z(), boundScissor.w());
+		}
+
+		U32 prog = NO_TEX;
+		if(pending.m_tex)
+		{
+			prog = RGBA_TEX;
+			for(const TextureView* atlas : m_fontAtlases)
+			{
+				if(atlas == pending.m_tex)
+				{
+					prog = SDF_FONT_TEX;
+					break;
+				}
+			}
+		}
+
+		if(prog != boundProg)
+		{
+			boundProg = prog;
+			cmdb->bindShaderProgram(m_grProgs[prog]);
+			pushConstantsSet = false;
+		}
+
+		if(pending.m_tex && pending.m_tex != boundTex)
+		{
+			boundTex = pending.m_tex;
+			TextureView* view = static_cast<TextureView*>(pending.m_tex);
+			cmdb->bindTexture(0, 1, TextureViewPtr(view), TextureUsageBit::SAMPLED_FRAGMENT);
+		}
+
+		if(!pushConstantsSet)
+		{
+			pushConstantsSet = true;
+			Vec4 transform;
+			transform.x() = 2.0f / drawData.DisplaySize.x;
+			transform.y() = -2.0f / drawData.DisplaySize.y;
+			transform.z() = (drawData.DisplayPos.x / drawData.DisplaySize.x) * 2.0f - 1.0f;
+			transform.w() = -((drawData.DisplayPos.y / drawData.DisplaySize.y) * 2.0f - 1.0f);
+			cmdb->setPushConstants(&transform, sizeof(transform));
+		}
+
+		cmdb->drawElements(PrimitiveTopology::TRIANGLES, pending.m_elemCount, 1, pending.m_idxOffset, vertOffset);
+		++m_stats.m_drawcallCount;
+		pending.m_elemCount = 0;
+	};
+
 	// Render
 	U32 vertOffset = 0;
 	U32 idxOffset = 0;
@@ -257,10 +329,15 @@ void Canvas::appendToCommandBufferInternal(CommandBufferPtr& cmdb)
 		for(I32 i = 0; i < cmdList.CmdBuffer.Size; i++)
 		{
 			const ImDrawCmd& pcmd = cmdList.CmdBuffer[i];
+			++m_stats.m_commandCount;
 			if(pcmd.UserCallback)
 			{
-				// User callback (registered via ImDrawList::AddCallback)
+				// User callback (registered via ImDrawList::AddCallback). It might change the state
+				flush(vertOffset);
 				pcmd.UserCallback(&cmdList, &pcmd);
+				boundProg = MAX_U32;
+				boundTex = nullptr;
+				boundScissor = UVec4(MAX_U32);
 			}
 			else
 			{
@@ -283,38 +360,33 @@ void Canvas::appendToCommandBufferInternal(CommandBufferPtr& cmdb)
 						clipRect.y() = 0.0f;
 					}
 
-					// Apply scissor/clipping rectangle
-					cmdb->setScissor(U32(clipRect.x()),
+					const UVec4 scissor(U32(clipRect.x()),
 						U32(clipRect.y()),
 						U32(clipRect.z() - clipRect.x()),
 						U32(clipRect.w() - clipRect.y()));
 
-					if(pcmd.TextureId)
+					const Bool canMerge = pending.m_elemCount > 0 && pending.m_tex == pcmd.TextureId
+										  && pending.m_scissor == scissor
+										  && pending.m_idxOffset + pending.m_elemCount == idxOffset;
+					if(canMerge)
 					{
-						cmdb->bindShaderProgram(m_grProgs[RGBA_TEX]);
-
-						TextureView* view = static_cast<TextureView*>(pcmd.TextureId);
-						cmdb->bindTexture(0, 1, TextureViewPtr(view), TextureUsageBit::SAMPLED_FRAGMENT);
+						pending.m_elemCount += pcmd.ElemCount;
 					}
 					else
 					{
-						cmdb->bindShaderProgram(m_grProgs[NO_TEX]);
+						flush(vertOffset);
+						pending.m_tex = pcmd.TextureId;
+						pending.m_scissor = scissor;
+						pending.m_idxOffset = idxOffset;
+						pending.m_elemCount = pcmd.ElemCount;
 					}
-
-					// Push constants. TODO: Set them once
-					Vec4 transform;
-					transform.x() = 2.0f / drawData.DisplaySize.x;
-					transform.y() = -2.0f / drawData.DisplaySize.y;
-					transform.z() = (drawData.DisplayPos.x / drawData.DisplaySize.x) * 2.0f - 1.0f;
-					transform.w() = -((drawData.DisplayPos.y / drawData.DisplaySize.y) * 2.0f - 1.0f);
-					cmdb->setPushConstants(&transform, sizeof(transform));
-
-					// Draw
-					cmdb->drawElements(PrimitiveTopology::TRIANGLES, pcmd.ElemCount, 1, idxOffset, vertOffset);
 				}
 			}
 			idxOffset += pcmd.ElemCount;
 		}
+
+		// The next list has another vertex offset
+		flush(vertOffset);
 		vertOffset += cmdList.VtxBuffer.Size;
 	}
 
@@ -323,4 +395,52 @@ void Canvas::appendToCommandBufferInternal(CommandBufferPtr& cmdb)
 	cmdb->setCullMode(FaceSelectionBit::BACK);
 }
 
+U64 Canvas::computeGeometryHash(const ImDrawData& drawData)
+{
+	U64 hash = computeHash(&drawData.DisplaySize, sizeof(drawData.DisplaySize));
+	for(I32 n = 0; n < drawData.CmdListsCount; ++n)
+	{
+		const ImDrawList& cmdList = *drawData.CmdLists[n];
+		hash = appendHash(cmdList.VtxBuffer.Data, cmdList.VtxBuffer.Size * sizeof(ImDrawVert), hash);
+		hash = appendHash(cmdList.IdxBuffer.Data, cmdList.IdxBuffer.Size * sizeof(ImDrawIdx), hash);
+
+		// Hash the members one by one, the commands have padding
+		for(const ImDrawCmd& pcmd : cmdList.CmdBuffer)
+		{
+			hash = appendHash(&pcmd.ClipRect, sizeof(pcmd.ClipRect), hash);
+			hash = appendHash(&pcmd.TextureId, sizeof(pcmd.TextureId), hash);
+			hash = appendHash(&pcmd.ElemCount, sizeof(pcmd.ElemCount), hash);
+		}
+	}
+
+	return hash;
+}
+
+void Canvas::uploadGeometry(
+	const ImDrawData& drawData, GeometryBuffer& geomBuff, PtrSize indicesOffset, PtrSize indicesSize)
+{
+	// Grow the buffer. The old one will live as long as the command buffers that use it
+	const PtrSize size = indicesOffset + indicesSize;
+	if(size > geomBuff.m_size)
+	{
+		geomBuff.m_size = max<PtrSize>(nextPowerOfTwo(size), 64_KB);
+		const BufferInitInfo buffInit(
+			geomBuff.m_size, BufferUsageBit::VERTEX | BufferUsageBit::INDEX, BufferMapAccessBit::WRITE, "UiGeometry");
+		geomBuff.m_buffer = m_manager->getGrManager().newBuffer(buffInit);
+	}
+
+	U8* mapped = static_cast<U8*>(geomBuff.m_buffer->map(0, size, BufferMapAccessBit::WRITE));
+	ImDrawVert* verts = reinterpret_cast<ImDrawVert*>(mapped);
+	ImDrawIdx* indices = reinterpret_cast<ImDrawIdx*>(mapped + indicesOffset);
+	for(I32 n = 0; n < drawData.CmdListsCount; ++n)
+	{
+		const ImDrawList& cmdList = *drawData.CmdLists[n];
+		memcpy(verts, cmdList.VtxBuffer.Data, cmdList.VtxBuffer.Size * sizeof(ImDrawVert));
+		memcpy(indices, cmdList.IdxBuffer.Data, cmdList.IdxBuffer.Size * sizeof(ImDrawIdx));
+		verts += cmdList.VtxBuffer.Size;
+		indices += cmdList.IdxBuffer.Size;
+	}
+	geomBuff.m_buffer->unmap();
+}
+
 } // end namespace anki
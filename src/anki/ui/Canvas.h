@@ -15,6 +15,15 @@ namespace anki
 /// @addtogroup ui
 /// @{
 
+/// The statistics of the last Canvas::appendToCommandBuffer(). @memberof Canvas
+class CanvasStatistics
+{
+public:
+	U32 m_commandCount = 0; ///< The draw commands of ImGui.
+	U32 m_drawcallCount = 0; ///< The drawcalls after merging the commands.
+	Bool m_geometryUploaded = false; ///< False if the geometry of the previous frame was drawn again.
+};
+
 /// UI canvas.
 class Canvas : public UiObject
 {
@@ -67,6 +76,11 @@ public:
 	void appendToCommandBuffer(CommandBufferPtr cmdb);
 	/// @}
 
+	const CanvasStatistics& getStatistics() const
+	{
+		return m_stats;
+	}
+
 private:
 	FontPtr m_font;
 	U32 m_dfltFontHeight = 0;
@@ -78,6 +92,7 @@ private:
 	{
 		NO_TEX,
 		RGBA_TEX,
+		SDF_FONT_TEX,
 		SHADER_COUNT
 	};
 
@@ -88,6 +103,34 @@ private:
 	StackAllocator<U8> m_stackAlloc;
 
 	List<IntrusivePtr<UiObject>> m_references;
+	List<const TextureView*> m_fontAtlases; ///< The atlases of the fonts of this frame. They need SDF_FONT_TEX.
+
+	/// @name Retained geometry
+	/// The vertices and indices live in persistent buffers. A frame that produces the same geometry as the previous
+	/// one draws the old buffer again. A different geometry goes to the next buffer of the ring so the buffers of the
+	/// frames in flight are not touched.
+	/// @{
+	class GeometryBuffer
+	{
+	public:
+		BufferPtr m_buffer;
+		PtrSize m_size = 0;
+	};
+
+	class
+	{
+	public:
+		Array<GeometryBuffer, MAX_FRAMES_IN_FLIGHT> m_buffers;
+		U32 m_crntBuffer = 0;
+		U64 m_hash = 0;
+	} m_geometry;
+
+	static U64 computeGeometryHash(const ImDrawData& drawData);
+
+	void uploadGeometry(const ImDrawData& drawData, GeometryBuffer& geomBuff, PtrSize indicesOffset, PtrSize indicesSize);
+	/// @}
+
+	CanvasStatistics m_stats;
 
 	void appendToCommandBufferInternal(CommandBufferPtr& cmdb);
 };
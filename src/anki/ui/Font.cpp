@@ -12,12 +12,32 @@
 #include <anki/gr/Texture.h>
 #include <anki/gr/CommandBuffer.h>
 
+#define STB_TRUETYPE_IMPLEMENTATION
+#define STBTT_STATIC
+#define STBTT_malloc(x, u) ((void)(u), ImGui::MemAlloc(x))
+#define STBTT_free(x, u) ((void)(u), ImGui::MemFree(x))
+#define STBTT_assert(x) ANKI_ASSERT(x)
+#if ANKI_COMPILER_GCC_COMPATIBLE
+#	pragma GCC diagnostic push
+#	pragma GCC diagnostic ignored "-Wunused-function"
+#	pragma GCC diagnostic ignored "-Wconversion"
+#	pragma GCC diagnostic ignored "-Wfloat-conversion"
+#endif
+#include <imgui/imstb_truetype.h>
+#if ANKI_COMPILER_GCC_COMPATIBLE
+#	pragma GCC diagnostic pop
+#endif
+
 namespace anki
 {
 
 Font::~Font()
 {
 	setImAllocator();
+	for(U32 i = 1; i < m_fonts.getSize(); ++i)
+	{
+		IM_DELETE(m_fonts[i].m_imFont);
+	}
 	m_imFontAtlas.destroy();
 	unsetImAllocator();
 
@@ -29,6 +49,7 @@ Error Font::init(const CString& filename, const std::initializer_list<U32>& font
 {
 	setImAllocator();
 	m_imFontAtlas.init();
+	m_imFontAtlas->Flags |= ImFontAtlasFlags_NoMouseCursors;
 
 	// Load font in memory
 	ResourceFilePtr file;
@@ -36,42 +57,144 @@ Error Font::init(const CString& filename, const std::initializer_list<U32>& font
 	m_fontData.create(getAllocator(), U32(file->getSize()));
 	ANKI_CHECK(file->read(&m_fontData[0], file->getSize()));
 
-	m_fonts.create(getAllocator(), U32(fontHeights.size()));
+	stbtt_fontinfo fontInfo;
+	if(!stbtt_InitFont(&fontInfo, &m_fontData[0], stbtt_GetFontOffsetForIndex(&m_fontData[0], 0)))
+	{
+		ANKI_UI_LOGE("Failed to parse font: %s", filename.cstr());
+		unsetImAllocator();
+		return Error::USER_DATA;
+	}
 
-	// Bake font
+	// Add the base font. ImGui bakes only the space, it has no pixels. The rest of the glyphs are custom rects
+	static const ImWchar spaceRange[] = {0x20, 0x20, 0};
 	ImFontConfig cfg;
 	cfg.FontDataOwnedByAtlas = false;
-	U32 count = 0;
-	for(U32 height : fontHeights)
-	{
-		cfg.SizePixels = F32(height);
+	ImFont* baseFont = m_imFontAtlas->AddFontFromMemoryTTF(
+		&m_fontData[0], I32(m_fontData.getSize()), F32(SDF_FONT_HEIGHT), &cfg, spaceRange);
+
+	m_fonts.create(getAllocator(), 1);
+	m_fonts[0].m_imFont = baseFont;
+	m_fonts[0].m_height = SDF_FONT_HEIGHT;
 
-		m_fonts[count].m_imFont =
-			m_imFontAtlas->AddFontFromMemoryTTF(&m_fontData[0], I32(m_fontData.getSize()), F32(height), &cfg);
-		m_fonts[count].m_height = height;
-		++count;
+	// Rasterize the distance fields of the glyphs. The offsets are relative to the baseline and ImGui expects them
+	// relative to the top, use the same ascent as ImGui
+	const F32 scale = stbtt_ScaleForPixelHeight(&fontInfo, F32(SDF_FONT_HEIGHT));
+	I32 ascent, descent, lineGap;
+	stbtt_GetFontVMetrics(&fontInfo, &ascent, &descent, &lineGap);
+	const F32 baselineY = std::floor(F32(ascent) * scale + 1.0f);
+
+	class SdfGlyph
+	{
+	public:
+		U8* m_pixels;
+		I32 m_rectIdx;
+		I32 m_width;
+		I32 m_height;
+	};
+	DynamicArrayAuto<SdfGlyph> glyphs(getAllocator());
+
+	constexpr U8 onEdgeValue = 128;
+	for(const ImWchar* range = m_imFontAtlas->GetGlyphRangesDefault(); range[0]; range += 2)
+	{
+		for(U32 c = range[0]; c <= range[1]; ++c)
+		{
+			if(c == 0x20 || stbtt_FindGlyphIndex(&fontInfo, I32(c)) == 0)
+			{
+				continue;
+			}
+
+			SdfGlyph glyph;
+			I32 xoff, yoff;
+			glyph.m_pixels = stbtt_GetCodepointSDF(&fontInfo,
+				scale,
+				I32(c),
+				I32(SDF_PADDING),
+				onEdgeValue,
+				F32(onEdgeValue) / F32(SDF_PADDING),
+				&glyph.m_width,
+				&glyph.m_height,
+				&xoff,
+				&yoff);
+			if(glyph.m_pixels == nullptr)
+			{
+				// Glyph without a shape
+				continue;
+			}
+
+			I32 advance, leftSideBearing;
+			stbtt_GetCodepointHMetrics(&fontInfo, I32(c), &advance, &leftSideBearing);
+
+			glyph.m_rectIdx = m_imFontAtlas->AddCustomRectFontGlyph(baseFont,
+				ImWchar(c),
+				glyph.m_width,
+				glyph.m_height,
+				F32(advance) * scale,
+				Vec2(F32(xoff), baselineY + F32(yoff)));
+			glyphs.emplaceBack(glyph);
+		}
 	}
 
+	// Bake
 	const Bool ok = m_imFontAtlas->Build();
 	ANKI_ASSERT(ok);
 	(void)ok;
 
-	// Create the texture
+	// Copy the distance fields to the atlas. The white pixel of the atlas is fully inside so it's not affected
 	U8* img;
 	int width, height;
-	m_imFontAtlas->GetTexDataAsRGBA32(&img, &width, &height);
+	m_imFontAtlas->GetTexDataAsAlpha8(&img, &width, &height);
+	for(const SdfGlyph& glyph : glyphs)
+	{
+		const ImFontAtlasCustomRect& rect = *m_imFontAtlas->GetCustomRectByIndex(glyph.m_rectIdx);
+		for(I32 y = 0; y < glyph.m_height; ++y)
+		{
+			memcpy(img + (rect.Y + y) * width + rect.X, glyph.m_pixels + y * glyph.m_width, glyph.m_width);
+		}
+
+		stbtt_FreeSDF(glyph.m_pixels, nullptr);
+	}
+
+	// Create the texture
 	createTexture(img, width, height);
 
+	// Create the requested heights
+	for(U32 fontHeight : fontHeights)
+	{
+		getImFont(fontHeight);
+	}
+
 	unsetImAllocator();
 	return Error::NONE;
 }
 
+ImFont& Font::getImFont(U32 fontHeight)
+{
+	LockGuard<Mutex> lock(m_fontsMtx);
+
+	for(const FontEntry& f : m_fonts)
+	{
+		if(f.m_height == fontHeight)
+		{
+			return *f.m_imFont;
+		}
+	}
+
+	// The glyphs are distance fields so a scaled copy of the base font has sharp edges at any height
+	ANKI_ASSERT(fontHeight > 0);
+	FontEntry& entry = *m_fonts.emplaceBack(getAllocator());
+	entry.m_imFont = IM_NEW(ImFont)(*m_fonts[0].m_imFont);
+	entry.m_imFont->Scale = F32(fontHeight) / F32(SDF_FONT_HEIGHT);
+	entry.m_height = fontHeight;
+
+	return *entry.m_imFont;
+}
+
 void Font::createTexture(const void* data, U32 width, U32 height)
 {
 	ANKI_ASSERT(data && width > 0 && height > 0);
 
 	// Create and populate the buffer
-	PtrSize buffSize = width * height * 4;
+	PtrSize buffSize = width * height;
 	BufferPtr buff = m_manager->getGrManager().newBuffer(
 		BufferInitInfo(buffSize, BufferUsageBit::BUFFER_UPLOAD_SOURCE, BufferMapAccessBit::WRITE, "UI"));
 	void* mapped = buff->map(0, buffSize, BufferMapAccessBit::WRITE);
@@ -82,7 +205,7 @@ void Font::createTexture(const void* data, U32 width, U32 height)
 	TextureInitInfo texInit("Font");
 	texInit.m_width = width;
 	texInit.m_height = height;
-	texInit.m_format = Format::R8G8B8A8_UNORM;
+	texInit.m_format = Format::R8_UNORM;
 	texInit.m_usage =
 		TextureUsageBit::TRANSFER_DESTINATION | TextureUsageBit::SAMPLED_FRAGMENT | TextureUsageBit::GENERATE_MIPMAPS;
 	texInit.m_mipmapCount = 1; // No mips because it creates will appear blurry with trilinear filtering
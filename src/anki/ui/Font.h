@@ -8,6 +8,7 @@
 #include <anki/ui/UiObject.h>
 #include <anki/gr/Texture.h>
 #include <anki/util/ClassWrapper.h>
+#include <anki/util/Thread.h>
 #include <initializer_list>
 
 namespace anki
@@ -16,10 +17,17 @@ namespace anki
 /// @addtogroup ui
 /// @{
 
-/// Font class.
+/// Font class. The glyphs are signed distance fields that are baked once at SDF_FONT_HEIGHT. All the font heights
+/// sample the same atlas.
 class Font : public UiObject
 {
 public:
+	/// The height in pixels that the distance fields are baked.
+	static constexpr U32 SDF_FONT_HEIGHT = 32;
+
+	/// The distance in pixels that the fields extend outside the glyphs.
+	static constexpr U32 SDF_PADDING = 4;
+
 	Font(UiManager* manager)
 		: UiObject(manager)
 	{
@@ -28,6 +36,7 @@ public:
 	~Font();
 
 	/// Initialize the font.
+	/// @param fontHeights The heights to create up front. The rest will be created the first time they are used.
 	ANKI_USE_RESULT Error init(const CString& filename, const std::initializer_list<U32>& fontHeights);
 
 	/// Get font image atlas.
@@ -36,19 +45,8 @@ public:
 		return m_texView;
 	}
 
-	ANKI_INTERNAL const ImFont& getImFont(U32 fontHeight) const
-	{
-		for(const FontEntry& f : m_fonts)
-		{
-			if(f.m_height == fontHeight)
-			{
-				return *f.m_imFont;
-			}
-		}
-
-		ANKI_ASSERT(0);
-		return *m_fonts[0].m_imFont;
-	}
+	/// Get the font of a height. If it doesn't exist it creates it. The ImGui allocator should be set.
+	ANKI_INTERNAL ImFont& getImFont(U32 fontHeight);
 
 	ANKI_INTERNAL const ImFont& getFirstImFont() const
 	{
@@ -71,7 +69,8 @@ private:
 		U32 m_height;
 	};
 
-	DynamicArray<FontEntry> m_fonts;
+	DynamicArray<FontEntry> m_fonts; ///< The 1st is the one the atlas owns, the rest are scaled copies of it.
+	Mutex m_fontsMtx;
 
 	TexturePtr m_tex;
 	TextureViewPtr m_texView; ///< Whole texture view
@@ -224,7 +224,7 @@ public:
 		U32 count = 0;
 		for(U i = 0; i < CHUNK_COUNT; ++i)
 		{
-			count += __builtin_popcount(m_chunks[i]);
+			count += U32(__builtin_popcountll(m_chunks[i]));
 		}
 		return count;
 	}
@@ -246,6 +246,39 @@ public:
 		return MAX_U32;
 	}
 
+	/// Get the least significant bit that is enabled. Or MAX_U32 if all is zero.
+	U32 getLeastSignificantBit() const
+	{
+		for(U32 i = 0; i < CHUNK_COUNT; ++i)
+		{
+			const U64 bits = m_chunks[i];
+			if(bits != 0)
+			{
+				return U32(__builtin_ctzll(bits)) + (i * CHUNK_BIT_COUNT);
+			}
+		}
+
+		return MAX_U32;
+	}
+
+	/// Call a functor for every enabled bit in ascending order. It skips the zero chunks.
+	/// @code
+	/// bitset.iterateSetBits([&](U32 bit) { ... });
+	/// @endcode
+	template<typename TFunc>
+	void iterateSetBits(TFunc func) const
+	{
+		for(U32 i = 0; i < CHUNK_COUNT; ++i)
+		{
+			U64 bits = m_chunks[i];
+			while(bits != 0)
+			{
+				func(U32(__builtin_ctzll(bits)) + (i * CHUNK_BIT_COUNT));
+				bits &= bits - 1;
+			}
+		}
+	}
+
 	Array<TChunkType, CHUNK_COUNT> getData() const
 	{
 		return m_chunks;
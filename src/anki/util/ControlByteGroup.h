@@ -0,0 +1,105 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/util/StdTypes.h>
+#include <anki/util/Assert.h>
+#include <anki/util/Array.h>
+#include <cstring>
+#if ANKI_SIMD_SSE
+#	include <emmintrin.h>
+#elif ANKI_SIMD_NEON
+#	include <arm_neon.h>
+#endif
+
+namespace anki
+{
+
+/// @addtogroup util_containers
+/// @{
+
+/// A group of control bytes of an open addressing container. It's loaded once and then it's matched 16 bytes at a
+/// time using SIMD. The matches are returned as bit masks where bit N is the Nth byte.
+class ControlByteGroup
+{
+public:
+	static constexpr U32 SIZE = 16;
+
+	/// Load the control bytes. No alignment is required.
+	explicit ControlByteGroup(const U8* ctrl)
+	{
+		ANKI_ASSERT(ctrl);
+#if ANKI_SIMD_SSE
+		m_ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+#elif ANKI_SIMD_NEON
+		m_ctrl = vld1q_u8(ctrl);
+#else
+		memcpy(&m_ctrl[0], ctrl, SIZE);
+#endif
+	}
+
+	/// Get a bit mask of the bytes that are equal to a value.
+	U32 match(U8 value) const
+	{
+#if ANKI_SIMD_SSE
+		return U32(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(I8(value)), m_ctrl)));
+#elif ANKI_SIMD_NEON
+		return toBitMask(vceqq_u8(vdupq_n_u8(value), m_ctrl));
+#else
+		U32 mask = 0;
+		for(U32 i = 0; i < SIZE; ++i)
+		{
+			mask |= U32(m_ctrl[i] == value) << i;
+		}
+		return mask;
+#endif
+	}
+
+	/// Get a bit mask of the bytes that have their high bit set.
+	U32 matchHighBit() const
+	{
+#if ANKI_SIMD_SSE
+		return U32(_mm_movemask_epi8(m_ctrl));
+#elif ANKI_SIMD_NEON
+		return toBitMask(vcgeq_u8(m_ctrl, vdupq_n_u8(0x80)));
+#else
+		U32 mask = 0;
+		for(U32 i = 0; i < SIZE; ++i)
+		{
+			mask |= U32(m_ctrl[i] >= 0x80) << i;
+		}
+		return mask;
+#endif
+	}
+
+	/// Get the index of the lowest bit of a non-zero mask.
+	static U32 getLowestBit(U32 mask)
+	{
+		ANKI_ASSERT(mask != 0);
+		return U32(__builtin_ctz(mask));
+	}
+
+private:
+#if ANKI_SIMD_SSE
+	__m128i m_ctrl;
+#elif ANKI_SIMD_NEON
+	uint8x16_t m_ctrl;
+
+	/// Emulate movemask. Every byte of v is either 0x00 or 0xFF.
+	static U32 toBitMask(uint8x16_t v)
+	{
+		const uint64x2_t v64 = vreinterpretq_u64_u8(v);
+		const U64 lo = vgetq_lane_u64(v64, 0) & 0x0101010101010101ull;
+		const U64 hi = vgetq_lane_u64(v64, 1) & 0x0101010101010101ull;
+		return U32((lo * 0x0102040810204080ull) >> 56) | (U32((hi * 0x0102040810204080ull) >> 56) << 8);
+	}
+#else
+	Array<U8, SIZE> m_ctrl;
+#endif
+};
+/// @}
+
+} // end namespace anki
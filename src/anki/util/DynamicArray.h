@@ -7,22 +7,50 @@
 
 #include <anki/util/Allocator.h>
 #include <anki/util/Functions.h>
+#include <anki/util/NonCopyable.h>
 
 namespace anki
 {
 
-// Forward
-template<typename T, typename TSize>
-class DynamicArrayAuto;
-
 /// @addtogroup util_containers
 /// @{
 
+/// The default growth policy of the dynamic arrays. The capacity grows geometrically and the first allocation holds a
+/// few elements to skip the reallocations of the first pushes. The storage shrinks only when a small part of it is in
+/// use so an array that goes up and down around some size doesn't reallocate all the time.
+class DynamicArrayGrowthPolicy
+{
+public:
+	static constexpr F32 GROW_SCALE = 2.0f;
+	static constexpr F32 SHRINK_SCALE = 4.0f;
+	static constexpr U32 MIN_CAPACITY = 4;
+
+	/// The capacity of a storage that needs to grow to hold @a newSize elements.
+	template<typename TSize>
+	static TSize computeGrowCapacity(TSize capacity, TSize newSize)
+	{
+		const TSize scaled = max(TSize(F32(capacity) * GROW_SCALE), TSize(MIN_CAPACITY));
+		return max(newSize, scaled);
+	}
+
+	/// Check if the storage needs to shrink when its elements are reduced to @a newSize.
+	template<typename TSize>
+	static Bool shouldShrink(TSize capacity, TSize newSize)
+	{
+		return newSize == 0 || newSize < TSize(F32(capacity) / SHRINK_SCALE);
+	}
+};
+
+// Forward
+template<typename T, typename TSize, typename TGrowthPolicy>
+class DynamicArrayAuto;
+
 /// Dynamic array with manual destruction. It doesn't hold the allocator and that makes it compact. At the same time
 /// that requires manual destruction. Used in permanent classes.
 /// @tparam T The type this array will hold.
 /// @tparam TSize The type that denotes the maximum number of elements of the array.
-template<typename T, typename TSize = U32>
+/// @tparam TGrowthPolicy How the storage grows and shrinks. See DynamicArrayGrowthPolicy for the interface.
+template<typename T, typename TSize = U32, typename TGrowthPolicy = DynamicArrayGrowthPolicy>
 class DynamicArray
 {
 public:
@@ -32,9 +60,7 @@ public:
 	using Reference = Value&;
 	using ConstReference = const Value&;
 	using Size = TSize;
-
-	static constexpr F32 GROW_SCALE = 2.0f;
-	static constexpr F32 SHRINK_SCALE = 2.0f;
+	using GrowthPolicy = TGrowthPolicy;
 
 	DynamicArray()
 		: m_data(nullptr)
@@ -72,7 +98,7 @@ public:
 	}
 
 	/// Move DynamicArrayAuto to this.
-	DynamicArray& operator=(DynamicArrayAuto<T, TSize>&& b);
+	DynamicArray& operator=(DynamicArrayAuto<T, TSize, TGrowthPolicy>&& b);
 
 	// Non-copyable
 	DynamicArray& operator=(const DynamicArray& b) = delete;
@@ -176,6 +202,12 @@ public:
 		return m_size * sizeof(Value);
 	}
 
+	/// The number of elements the storage can hold before it needs to grow.
+	Size getCapacity() const
+	{
+		return m_capacity;
+	}
+
 	/// Only create the array. Useful if @a T is non-copyable or movable .
 	template<typename TAllocator>
 	void create(TAllocator alloc, Size size)
@@ -210,6 +242,17 @@ public:
 	template<typename TAllocator>
 	void resize(TAllocator alloc, Size size);
 
+	/// Grow the storage to hold at least @a capacity elements. It doesn't construct any elements and it doesn't change
+	/// the size. The emplaceBack() calls that fit in the new capacity will not allocate.
+	template<typename TAllocator>
+	void reserve(TAllocator alloc, Size capacity)
+	{
+		if(capacity > m_capacity)
+		{
+			reallocate(alloc, capacity);
+		}
+	}
+
 	/// Push back value.
 	template<typename TAllocator, typename... TArgs>
 	Iterator emplaceBack(TAllocator alloc, TArgs&&... args)
@@ -243,7 +286,6 @@ public:
 	{
 		if(m_data)
 		{
-			ANKI_ASSERT(m_size > 0);
 			ANKI_ASSERT(m_capacity > 0);
 			alloc.deleteArray(m_data, m_size);
 
@@ -260,7 +302,7 @@ public:
 	{
 		if(m_data)
 		{
-			ANKI_ASSERT(m_size > 0 && m_capacity > 0);
+			ANKI_ASSERT(m_capacity > 0);
 			ANKI_ASSERT(m_size <= m_capacity);
 		}
 		else
@@ -289,15 +331,19 @@ protected:
 	Value* m_data;
 	Size m_size;
 	Size m_capacity = 0;
+
+	/// Move the elements to a new storage of @a newCapacity elements.
+	template<typename TAllocator>
+	void reallocate(TAllocator alloc, Size newCapacity);
 };
 
 /// Dynamic array with automatic destruction. It's the same as DynamicArray but it holds the allocator in order to
 /// perform automatic destruction. Use it for temp operations and on transient classes.
-template<typename T, typename TSize = U32>
-class DynamicArrayAuto : public DynamicArray<T, TSize>
+template<typename T, typename TSize = U32, typename TGrowthPolicy = DynamicArrayGrowthPolicy>
+class DynamicArrayAuto : public DynamicArray<T, TSize, TGrowthPolicy>
 {
 public:
-	using Base = DynamicArray<T, TSize>;
+	using Base = DynamicArray<T, TSize, TGrowthPolicy>;
 	using Base::m_capacity;
 	using Base::m_data;
 	using Base::m_size;
@@ -413,6 +459,12 @@ public:
 		Base::resize(m_alloc, size, v);
 	}
 
+	/// @copydoc DynamicArray::reserve
+	void reserve(Size capacity)
+	{
+		Base::reserve(m_alloc, capacity);
+	}
+
 	/// @copydoc DynamicArray::emplaceBack
 	template<typename... TArgs>
 	Iterator emplaceBack(TArgs&&... args)
@@ -420,6 +472,12 @@ public:
 		return Base::emplaceBack(m_alloc, std::forward<TArgs>(args)...);
 	}
 
+	/// @copydoc DynamicArray::popBack
+	void popBack()
+	{
+		Base::popBack(m_alloc);
+	}
+
 	/// @copydoc DynamicArray::emplaceAt
 	template<typename... TArgs>
 	Iterator emplaceAt(ConstIterator where, TArgs&&... args)
@@ -455,6 +513,219 @@ public:
 private:
 	GenericMemoryPoolAllocator<T> m_alloc;
 };
+
+/// Dynamic array with automatic destruction that holds its first @a N elements inside it. It allocates only when it
+/// grows past them. Use it for temporaries that are small most of the time, like the per-frame arrays. It can't be
+/// moved so the pointers to its elements stay valid until it grows.
+/// @tparam T The type this array will hold.
+/// @tparam N The number of elements that don't need an allocation.
+/// @tparam TSize The type that denotes the maximum number of elements of the array.
+/// @tparam TGrowthPolicy How the storage grows after the inline elements. It never shrinks.
+template<typename T, U32 N, typename TSize = U32, typename TGrowthPolicy = DynamicArrayGrowthPolicy>
+class DynamicArrayInline : public NonCopyable
+{
+public:
+	using Value = T;
+	using Iterator = Value*;
+	using ConstIterator = const Value*;
+	using Reference = Value&;
+	using ConstReference = const Value&;
+	using Size = TSize;
+	using GrowthPolicy = TGrowthPolicy;
+
+	static_assert(N > 0, "Use DynamicArrayAuto instead");
+
+	template<typename TAllocator>
+	DynamicArrayInline(TAllocator alloc)
+		: m_alloc(alloc)
+		, m_data(getInlineStorage())
+	{
+	}
+
+	~DynamicArrayInline()
+	{
+		destroy();
+	}
+
+	Reference operator[](const Size n)
+	{
+		ANKI_ASSERT(n < m_size);
+		return m_data[n];
+	}
+
+	ConstReference operator[](const Size n) const
+	{
+		ANKI_ASSERT(n < m_size);
+		return m_data[n];
+	}
+
+	Iterator getBegin()
+	{
+		return m_data;
+	}
+
+	ConstIterator getBegin() const
+	{
+		return m_data;
+	}
+
+	Iterator getEnd()
+	{
+		return m_data + m_size;
+	}
+
+	ConstIterator getEnd() const
+	{
+		return m_data + m_size;
+	}
+
+	/// Make it compatible with the C++11 range based for loop.
+	Iterator begin()
+	{
+		return getBegin();
+	}
+
+	/// Make it compatible with the C++11 range based for loop.
+	ConstIterator begin() const
+	{
+		return getBegin();
+	}
+
+	/// Make it compatible with the C++11 range based for loop.
+	Iterator end()
+	{
+		return getEnd();
+	}
+
+	/// Make it compatible with the C++11 range based for loop.
+	ConstIterator end() const
+	{
+		return getEnd();
+	}
+
+	/// Get first element.
+	Reference getFront()
+	{
+		ANKI_ASSERT(!isEmpty());
+		return m_data[0];
+	}
+
+	/// Get first element.
+	ConstReference getFront() const
+	{
+		ANKI_ASSERT(!isEmpty());
+		return m_data[0];
+	}
+
+	/// Get last element.
+	Reference getBack()
+	{
+		ANKI_ASSERT(!isEmpty());
+		return m_data[m_size - 1];
+	}
+
+	/// Get last element.
+	ConstReference getBack() const
+	{
+		ANKI_ASSERT(!isEmpty());
+		return m_data[m_size - 1];
+	}
+
+	Size getSize() const
+	{
+		return m_size;
+	}
+
+	Bool isEmpty() const
+	{
+		return m_size == 0;
+	}
+
+	PtrSize getSizeInBytes() const
+	{
+		return m_size * sizeof(Value);
+	}
+
+	/// @copydoc DynamicArray::getCapacity
+	Size getCapacity() const
+	{
+		return m_capacity;
+	}
+
+	/// Check if the elements are still inside the array.
+	Bool isInline() const
+	{
+		return m_data == getInlineStorage();
+	}
+
+	/// Grow or shrink the array. @a T needs to be copyable and moveable.
+	void resize(Size size, const Value& v);
+
+	/// Grow or shrink the array. @a T needs to be moveable and default constructible.
+	void resize(Size size);
+
+	/// @copydoc DynamicArray::reserve
+	void reserve(Size capacity)
+	{
+		if(capacity > m_capacity)
+		{
+			reallocate(capacity);
+		}
+	}
+
+	/// Push back value.
+	template<typename... TArgs>
+	Iterator emplaceBack(TArgs&&... args)
+	{
+		if(m_size + 1 > m_capacity)
+		{
+			reallocate(TGrowthPolicy::computeGrowCapacity(m_capacity, Size(m_size + 1)));
+		}
+
+		m_alloc.construct(&m_data[m_size], std::forward<TArgs>(args)...);
+		++m_size;
+		return &m_data[m_size - 1];
+	}
+
+	/// Remove the last value.
+	void popBack()
+	{
+		if(m_size > 0)
+		{
+			--m_size;
+			m_data[m_size].~T();
+		}
+	}
+
+	/// Destroy the elements and go back to the inline storage.
+	void destroy();
+
+	/// Get the allocator.
+	const GenericMemoryPoolAllocator<T>& getAllocator() const
+	{
+		return m_alloc;
+	}
+
+private:
+	GenericMemoryPoolAllocator<T> m_alloc;
+	Value* m_data;
+	Size m_size = 0;
+	Size m_capacity = N;
+	alignas(alignof(T)) U8 m_inlineStorage[N * sizeof(T)];
+
+	Value* getInlineStorage()
+	{
+		return reinterpret_cast<Value*>(&m_inlineStorage[0]);
+	}
+
+	const Value* getInlineStorage() const
+	{
+		return reinterpret_cast<const Value*>(&m_inlineStorage[0]);
+	}
+
+	/// Move the elements to a new heap storage of @a newCapacity elements.
+	void reallocate(Size newCapacity);
+};
 /// @}
 
 } // end namespace anki
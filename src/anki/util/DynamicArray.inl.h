@@ -8,8 +8,9 @@
 namespace anki
 {
 
-template<typename T, typename TSize>
-DynamicArray<T, TSize>& DynamicArray<T, TSize>::operator=(DynamicArrayAuto<T, TSize>&& b)
+template<typename T, typename TSize, typename TGrowthPolicy>
+DynamicArray<T, TSize, TGrowthPolicy>& DynamicArray<T, TSize, TGrowthPolicy>::operator=(
+	DynamicArrayAuto<T, TSize, TGrowthPolicy>&& b)
 {
 	ANKI_ASSERT(m_data == nullptr && m_size == 0 && "Cannot move before destroying");
 	T* data;
@@ -21,31 +22,42 @@ DynamicArray<T, TSize>& DynamicArray<T, TSize>::operator=(DynamicArrayAuto<T, TS
 	return *this;
 }
 
-template<typename T, typename TSize>
+template<typename T, typename TSize, typename TGrowthPolicy>
 template<typename TAllocator>
-void DynamicArray<T, TSize>::resizeStorage(TAllocator alloc, Size newSize)
+void DynamicArray<T, TSize, TGrowthPolicy>::reallocate(TAllocator alloc, Size newCapacity)
 {
-	if(newSize > m_capacity)
-	{
-		// Need to grow
+	ANKI_ASSERT(newCapacity >= m_size);
 
-		m_capacity = (newSize > Size(F32(m_capacity) * GROW_SCALE)) ? newSize : Size(F32(m_capacity) * GROW_SCALE);
-		Value* newStorage =
-			static_cast<Value*>(alloc.getMemoryPool().allocate(m_capacity * sizeof(Value), alignof(Value)));
+	Value* newStorage = nullptr;
+	if(newCapacity)
+	{
+		newStorage = static_cast<Value*>(alloc.getMemoryPool().allocate(newCapacity * sizeof(Value), alignof(Value)));
+	}
 
-		// Move old elements to the new storage
-		if(m_data)
+	// Move old elements to the new storage
+	if(m_data)
+	{
+		for(Size i = 0; i < m_size; ++i)
 		{
-			for(Size i = 0; i < m_size; ++i)
-			{
-				alloc.construct(&newStorage[i], std::move(m_data[i]));
-				m_data[i].~T();
-			}
-
-			alloc.getMemoryPool().free(m_data);
+			alloc.construct(&newStorage[i], std::move(m_data[i]));
+			m_data[i].~T();
 		}
 
-		m_data = newStorage;
+		alloc.getMemoryPool().free(m_data);
+	}
+
+	m_data = newStorage;
+	m_capacity = newCapacity;
+}
+
+template<typename T, typename TSize, typename TGrowthPolicy>
+template<typename TAllocator>
+void DynamicArray<T, TSize, TGrowthPolicy>::resizeStorage(TAllocator alloc, Size newSize)
+{
+	if(newSize > m_capacity)
+	{
+		// Need to grow
+		reallocate(alloc, TGrowthPolicy::computeGrowCapacity(m_capacity, newSize));
 	}
 	else if(newSize < m_size)
 	{
@@ -61,37 +73,17 @@ void DynamicArray<T, TSize>::resizeStorage(TAllocator alloc, Size newSize)
 
 		m_size = newSize;
 
-		if(newSize < Size(F32(m_capacity) / SHRINK_SCALE) || newSize == 0)
+		if(TGrowthPolicy::shouldShrink(m_capacity, newSize))
 		{
 			// Need to shrink
-
-			m_capacity = newSize;
-			if(newSize)
-			{
-				Value* newStorage =
-					static_cast<Value*>(alloc.getMemoryPool().allocate(m_capacity * sizeof(Value), alignof(Value)));
-
-				for(Size i = 0; i < m_size; ++i)
-				{
-					alloc.construct(&newStorage[i], std::move(m_data[i]));
-					m_data[i].~T();
-				}
-
-				alloc.getMemoryPool().free(m_data);
-				m_data = newStorage;
-			}
-			else
-			{
-				alloc.getMemoryPool().free(m_data);
-				m_data = nullptr;
-			}
+			reallocate(alloc, newSize);
 		}
 	}
 }
 
-template<typename T, typename TSize>
+template<typename T, typename TSize, typename TGrowthPolicy>
 template<typename TAllocator>
-void DynamicArray<T, TSize>::resize(TAllocator alloc, Size newSize, const Value& v)
+void DynamicArray<T, TSize, TGrowthPolicy>::resize(TAllocator alloc, Size newSize, const Value& v)
 {
 	const Bool willGrow = newSize > m_size;
 	resizeStorage(alloc, newSize);
@@ -111,9 +103,9 @@ void DynamicArray<T, TSize>::resize(TAllocator alloc, Size newSize, const Value&
 	ANKI_ASSERT(m_size == newSize);
 }
 
-template<typename T, typename TSize>
+template<typename T, typename TSize, typename TGrowthPolicy>
 template<typename TAllocator>
-void DynamicArray<T, TSize>::resize(TAllocator alloc, Size newSize)
+void DynamicArray<T, TSize, TGrowthPolicy>::resize(TAllocator alloc, Size newSize)
 {
 	const Bool willGrow = newSize > m_size;
 	resizeStorage(alloc, newSize);
@@ -133,22 +125,21 @@ void DynamicArray<T, TSize>::resize(TAllocator alloc, Size newSize)
 	ANKI_ASSERT(m_size == newSize);
 }
 
-template<typename T, typename TSize>
+template<typename T, typename TSize, typename TGrowthPolicy>
 template<typename TAllocator, typename... TArgs>
-typename DynamicArray<T, TSize>::Iterator DynamicArray<T, TSize>::emplaceAt(
+typename DynamicArray<T, TSize, TGrowthPolicy>::Iterator DynamicArray<T, TSize, TGrowthPolicy>::emplaceAt(
 	TAllocator alloc, ConstIterator where, TArgs&&... args)
 {
 	const Value* wherePtr = where;
 	Size outIdx = getMaxNumericLimit<Size>();
 
-	if(wherePtr != nullptr)
+	if(!isEmpty())
 	{
 		// The "where" arg points to an element inside the array or the end.
 
 		// Preconditions
 		ANKI_ASSERT(wherePtr >= m_data);
 		ANKI_ASSERT(wherePtr <= m_data + m_size);
-		ANKI_ASSERT(!isEmpty());
 
 		const Size oldSize = m_size;
 
@@ -187,9 +178,9 @@ typename DynamicArray<T, TSize>::Iterator DynamicArray<T, TSize>::emplaceAt(
 	}
 	else
 	{
-		// The "where" arg points to an empty array. Easy to handle
+		// The "where" arg points to an empty array. Easy to handle. The storage might be reserved
 
-		ANKI_ASSERT(isEmpty());
+		ANKI_ASSERT(wherePtr == m_data);
 
 		resizeStorage(alloc, 1);
 		outIdx = 0;
@@ -205,4 +196,87 @@ typename DynamicArray<T, TSize>::Iterator DynamicArray<T, TSize>::emplaceAt(
 	return &m_data[outIdx];
 }
 
+template<typename T, U32 N, typename TSize, typename TGrowthPolicy>
+void DynamicArrayInline<T, N, TSize, TGrowthPolicy>::reallocate(Size newCapacity)
+{
+	ANKI_ASSERT(newCapacity > N && newCapacity >= m_size);
+
+	Value* newStorage =
+		static_cast<Value*>(m_alloc.getMemoryPool().allocate(newCapacity * sizeof(Value), alignof(Value)));
+
+	for(Size i = 0; i < m_size; ++i)
+	{
+		m_alloc.construct(&newStorage[i], std::move(m_data[i]));
+		m_data[i].~T();
+	}
+
+	if(!isInline())
+	{
+		m_alloc.getMemoryPool().free(m_data);
+	}
+
+	m_data = newStorage;
+	m_capacity = newCapacity;
+}
+
+template<typename T, U32 N, typename TSize, typename TGrowthPolicy>
+void DynamicArrayInline<T, N, TSize, TGrowthPolicy>::resize(Size newSize, const Value& v)
+{
+	if(newSize > m_capacity)
+	{
+		reallocate(TGrowthPolicy::computeGrowCapacity(m_capacity, newSize));
+	}
+
+	for(Size i = m_size; i < newSize; ++i)
+	{
+		m_alloc.construct(&m_data[i], v);
+	}
+
+	for(Size i = newSize; i < m_size; ++i)
+	{
+		m_data[i].~T();
+	}
+
+	m_size = newSize;
+}
+
+template<typename T, U32 N, typename TSize, typename TGrowthPolicy>
+void DynamicArrayInline<T, N, TSize, TGrowthPolicy>::resize(Size newSize)
+{
+	if(newSize > m_capacity)
+	{
+		reallocate(TGrowthPolicy::computeGrowCapacity(m_capacity, newSize));
+	}
+
+	for(Size i = m_size; i < newSize; ++i)
+	{
+		m_alloc.construct(&m_data[i]);
+	}
+
+	for(Size i = newSize; i < m_size; ++i)
+	{
+		m_data[i].~T();
+	}
+
+	m_size = newSize;
+}
+
+template<typename T, U32 N, typename TSize, typename TGrowthPolicy>
+void DynamicArrayInline<T, N, TSize, TGrowthPolicy>::destroy()
+{
+	for(Size i = 0; i < m_size; ++i)
+	{
+		m_data[i].~T();
+	}
+
+	if(!isInline())
+	{
+		m_alloc.getMemoryPool().free(m_data);
+		m_data = getInlineStorage();
+	}
+
+	m_size = 0;
+	m_capacity = N;
+}
+
 } // end namespace anki
@@ -9,6 +9,13 @@
 #include <anki/util/Assert.h>
 #include <cstring>
 #include <cstdarg>
+#if ANKI_POSIX
+#	include <sys/mman.h>
+#	include <unistd.h>
+#elif ANKI_OS_WINDOWS
+#	include <anki/util/Win32Minimal.h>
+#	include <io.h>
+#endif
 
 namespace anki
 {
@@ -31,6 +38,13 @@ File& File::operator=(File&& b)
 		m_type = b.m_type;
 		m_flags = b.m_flags;
 		m_size = b.m_size;
+		m_mappedData = b.m_mappedData;
+		m_mappedPos = b.m_mappedPos;
+#if ANKI_OS_WINDOWS
+		m_mapping = b.m_mapping;
+		m_overlappedHandle = b.m_overlappedHandle;
+		m_overlappedPort = b.m_overlappedPort;
+#endif
 	}
 
 	b.zero();
@@ -50,12 +64,21 @@ Error File::open(const CString& filename, FileOpenFlag flags)
 	// Only these flags are accepted
 	ANKI_ASSERT((flags
 					& (FileOpenFlag::READ | FileOpenFlag::WRITE | FileOpenFlag::APPEND | FileOpenFlag::BINARY
-						  | FileOpenFlag::ENDIAN_LITTLE | FileOpenFlag::ENDIAN_BIG))
+						  | FileOpenFlag::ENDIAN_LITTLE | FileOpenFlag::ENDIAN_BIG | FileOpenFlag::MMAP
+						  | FileOpenFlag::ASYNC))
 				!= FileOpenFlag::NONE);
 
 	// Cannot be both
 	ANKI_ASSERT((flags & FileOpenFlag::READ) != (flags & FileOpenFlag::WRITE));
 
+	// Can only map for reading
+	ANKI_ASSERT((flags & FileOpenFlag::MMAP) == FileOpenFlag::NONE
+				|| (flags & FileOpenFlag::READ) != FileOpenFlag::NONE);
+
+	// Only async reads
+	ANKI_ASSERT((flags & FileOpenFlag::ASYNC) == FileOpenFlag::NONE
+				|| (flags & FileOpenFlag::READ) != FileOpenFlag::NONE);
+
 	//
 	// Determine the file type and open it
 	//
@@ -144,7 +167,7 @@ Error File::openCFile(const CString& filename, FileOpenFlag flags)
 	{
 		fseek(ANKI_CFILE, 0, SEEK_END);
 		I64 size = ftell(ANKI_CFILE);
-		if(size < 1)
+		if(size < 0)
 		{
 			ANKI_UTIL_LOGE("ftell() failed");
 			err = Error::FUNCTION_FAILED;
@@ -156,9 +179,91 @@ Error File::openCFile(const CString& filename, FileOpenFlag flags)
 		}
 	}
 
+	// Map it. Empty files can't be mapped so they use the regular reads
+	if((flags & FileOpenFlag::MMAP) != FileOpenFlag::NONE && !err && m_size > 0)
+	{
+		err = mapCFile();
+	}
+
+#if ANKI_OS_WINDOWS
+	// The overlapped reads need a handle that was opened for them
+	if((flags & FileOpenFlag::ASYNC) != FileOpenFlag::NONE && !err)
+	{
+		m_overlappedHandle = CreateFileA(filename.cstr(),
+			GENERIC_READ,
+			FILE_SHARE_READ,
+			nullptr,
+			OPEN_EXISTING,
+			FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED,
+			nullptr);
+		if(m_overlappedHandle == INVALID_HANDLE_VALUE)
+		{
+			ANKI_UTIL_LOGW("CreateFileA() failed. The async reads of \"%s\" will be synchronous", filename.cstr());
+			m_overlappedHandle = nullptr;
+		}
+	}
+#endif
+
 	return err;
 }
 
+Error File::mapCFile()
+{
+	ANKI_ASSERT(m_type == Type::C && m_file && m_size > 0 && m_mappedData == nullptr);
+
+#if ANKI_POSIX
+	void* mem = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fileno(ANKI_CFILE), 0);
+	if(mem == MAP_FAILED)
+	{
+		ANKI_UTIL_LOGE("mmap() failed");
+		return Error::FUNCTION_FAILED;
+	}
+
+	// The readers usually go forward
+	madvise(mem, m_size, MADV_SEQUENTIAL);
+#elif ANKI_OS_WINDOWS
+	HANDLE fileHandle = reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(ANKI_CFILE)));
+	m_mapping = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if(m_mapping == nullptr)
+	{
+		ANKI_UTIL_LOGE("CreateFileMappingA() failed");
+		return Error::FUNCTION_FAILED;
+	}
+
+	void* mem = MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+	if(mem == nullptr)
+	{
+		ANKI_UTIL_LOGE("MapViewOfFile() failed");
+		CloseHandle(m_mapping);
+		m_mapping = nullptr;
+		return Error::FUNCTION_FAILED;
+	}
+#else
+	void* mem = nullptr;
+	ANKI_UTIL_LOGE("Memory mapped files are not supported on this platform");
+	return Error::FUNCTION_FAILED;
+#endif
+
+	m_mappedData = static_cast<const U8*>(mem);
+	m_mappedPos = 0;
+	return Error::NONE;
+}
+
+void File::unmapCFile()
+{
+	ANKI_ASSERT(m_mappedData);
+
+#if ANKI_POSIX
+	munmap(const_cast<U8*>(m_mappedData), m_size);
+#elif ANKI_OS_WINDOWS
+	UnmapViewOfFile(m_mappedData);
+	CloseHandle(m_mapping);
+	m_mapping = nullptr;
+#endif
+
+	m_mappedData = nullptr;
+}
+
 #if ANKI_OS_ANDROID
 Error File::openAndroidFile(const CString& filename, FileOpenFlag flags)
 {
@@ -177,7 +282,9 @@ Error File::openAndroidFile(const CString& filename, FileOpenFlag flags)
 	// Open file
 	ANKI_ASSERT(gAndroidApp != nullptr && gAndroidApp->activity && gAndroidApp->activity->assetManager);
 
-	m_file = AAssetManager_open(gAndroidApp->activity->assetManager, &filename[0] + 1, AASSET_MODE_STREAMING);
+	const I32 mode =
+		((flags & FileOpenFlag::MMAP) != FileOpenFlag::NONE) ? AASSET_MODE_BUFFER : AASSET_MODE_STREAMING;
+	m_file = AAssetManager_open(gAndroidApp->activity->assetManager, &filename[0] + 1, mode);
 
 	if(m_file == nullptr)
 	{
@@ -185,6 +292,19 @@ Error File::openAndroidFile(const CString& filename, FileOpenFlag flags)
 		return Error::FILE_ACCESS;
 	}
 
+	// The asset manager already has the whole file in memory
+	if((flags & FileOpenFlag::MMAP) != FileOpenFlag::NONE)
+	{
+		m_mappedData = static_cast<const U8*>(AAsset_getBuffer(ANKI_AFILE));
+		if(m_mappedData == nullptr)
+		{
+			ANKI_UTIL_LOGE("AAsset_getBuffer() failed");
+			AAsset_close(ANKI_AFILE);
+			m_file = nullptr;
+			return Error::FILE_ACCESS;
+		}
+	}
+
 	m_flags = flags;
 	m_type = Type::SPECIAL;
 
@@ -198,6 +318,18 @@ void File::close()
 	{
 		if(m_type == Type::C)
 		{
+			if(m_mappedData)
+			{
+				unmapCFile();
+			}
+
+#if ANKI_OS_WINDOWS
+			if(m_overlappedHandle)
+			{
+				CloseHandle(m_overlappedHandle);
+			}
+#endif
+
 			fclose(ANKI_CFILE);
 		}
 #if ANKI_OS_ANDROID
@@ -255,7 +387,13 @@ Error File::read(void* buff, PtrSize size)
 
 	I64 readSize = 0;
 
-	if(m_type == Type::C)
+	if(m_mappedData)
+	{
+		readSize = I64(min(size, getSize() - min(m_mappedPos, getSize())));
+		memcpy(buff, m_mappedData + m_mappedPos, PtrSize(readSize));
+		m_mappedPos += PtrSize(readSize);
+	}
+	else if(m_type == Type::C)
 	{
 		readSize = fread(buff, 1, size, ANKI_CFILE);
 	}
@@ -280,6 +418,84 @@ Error File::read(void* buff, PtrSize size)
 	return err;
 }
 
+Error File::readAsync(
+	FileIoQueue& queue, PtrSize offset, void* buff, PtrSize size, FileReadAsyncCallback callback, void* userData)
+{
+	ANKI_ASSERT(buff);
+	ANKI_ASSERT(size > 0);
+	ANKI_ASSERT(callback);
+	ANKI_ASSERT(m_file);
+	ANKI_ASSERT((m_flags & FileOpenFlag::READ) != FileOpenFlag::NONE);
+
+	if(offset > getSize() || size > getSize() - offset)
+	{
+		ANKI_UTIL_LOGE("Range is out of the file's bounds");
+		return Error::FUNCTION_FAILED;
+	}
+
+	return queue.newRead(*this, offset, buff, size, callback, userData);
+}
+
+Bool File::canReadNativelyAsync() const
+{
+#if ANKI_OS_WINDOWS
+	return m_type == Type::C && m_overlappedHandle != nullptr;
+#else
+	return m_type == Type::C;
+#endif
+}
+
+Error File::readAt(PtrSize offset, void* buff, PtrSize size)
+{
+	ANKI_ASSERT(offset <= getSize() && size <= getSize() - offset);
+
+	if(m_mappedData)
+	{
+		memcpy(buff, m_mappedData + offset, size);
+		return Error::NONE;
+	}
+
+#if ANKI_POSIX
+	if(m_type == Type::C)
+	{
+		U8* out = static_cast<U8*>(buff);
+		while(size > 0)
+		{
+			const ssize_t readSize = pread(fileno(ANKI_CFILE), out, size, off_t(offset));
+			if(readSize <= 0)
+			{
+				ANKI_UTIL_LOGE("pread() failed");
+				return Error::FILE_ACCESS;
+			}
+
+			out += readSize;
+			offset += PtrSize(readSize);
+			size -= PtrSize(readSize);
+		}
+
+		return Error::NONE;
+	}
+#endif
+
+	// Go to the offset and then return to where it was
+	PtrSize prevPos;
+#if ANKI_OS_ANDROID
+	if(m_type == Type::SPECIAL)
+	{
+		prevPos = getSize() - PtrSize(AAsset_getRemainingLength(ANKI_AFILE));
+	}
+	else
+#endif
+	{
+		prevPos = tell();
+	}
+
+	ANKI_CHECK(seek(offset, FileSeekOrigin::BEGINNING));
+	const Error err = read(buff, size);
+	ANKI_CHECK(seek(prevPos, FileSeekOrigin::BEGINNING));
+	return err;
+}
+
 PtrSize File::getSize() const
 {
 	ANKI_ASSERT(m_file);
@@ -288,7 +504,7 @@ PtrSize File::getSize() const
 
 	if(m_type == Type::C)
 	{
-		ANKI_ASSERT(m_size != 0);
+		ANKI_ASSERT((m_flags & FileOpenFlag::READ) != FileOpenFlag::NONE);
 		out = m_size;
 	}
 #if ANKI_OS_ANDROID
@@ -426,7 +642,33 @@ Error File::seek(PtrSize offset, FileSeekOrigin origin)
 	ANKI_ASSERT(m_flags != FileOpenFlag::NONE);
 	Error err = Error::NONE;
 
-	if(m_type == Type::C)
+	if(m_mappedData)
+	{
+		PtrSize newPos;
+		switch(origin)
+		{
+		case FileSeekOrigin::BEGINNING:
+			newPos = offset;
+			break;
+		case FileSeekOrigin::CURRENT:
+			newPos = m_mappedPos + offset;
+			break;
+		default:
+			ANKI_ASSERT(origin == FileSeekOrigin::END);
+			newPos = getSize() + offset;
+		}
+
+		if(newPos > getSize())
+		{
+			ANKI_UTIL_LOGE("Seeking past the end of a mapped file");
+			err = Error::FUNCTION_FAILED;
+		}
+		else
+		{
+			m_mappedPos = newPos;
+		}
+	}
+	else if(m_type == Type::C)
 	{
 		if(fseek(ANKI_CFILE, offset, I32(origin)) != 0)
 		{
@@ -457,7 +699,11 @@ PtrSize File::tell()
 	ANKI_ASSERT(m_file);
 	ANKI_ASSERT(m_flags != FileOpenFlag::NONE);
 
-	if(m_type == Type::C)
+	if(m_mappedData)
+	{
+		return m_mappedPos;
+	}
+	else if(m_type == Type::C)
 	{
 		return ftell(ANKI_CFILE);
 	}
@@ -475,6 +721,26 @@ PtrSize File::tell()
 	return 0;
 }
 
+Error File::getMappedRange(PtrSize offset, PtrSize size, ConstWeakArray<U8>& view) const
+{
+	ANKI_ASSERT(m_file);
+
+	if(!m_mappedData)
+	{
+		ANKI_UTIL_LOGE("The file is not mapped");
+		return Error::FUNCTION_FAILED;
+	}
+
+	if(offset > getSize() || size > getSize() - offset)
+	{
+		ANKI_UTIL_LOGE("Range is out of the file's bounds");
+		return Error::FUNCTION_FAILED;
+	}
+
+	view = ConstWeakArray<U8>(m_mappedData + offset, U32(size));
+	return Error::NONE;
+}
+
 Error File::identifyFile(const CString& filename,
 	char* archiveFilename,
 	PtrSize archiveFilenameLength,
@@ -547,4 +813,164 @@ Error File::readAllText(StringAuto& out)
 	return err;
 }
 
+Error FileIoQueue::init(GenericMemoryPoolAllocator<U8> alloc, U32 maxInFlight)
+{
+	ANKI_ASSERT(m_requests.getSize() == 0 && "Already initialized");
+	ANKI_ASSERT(maxInFlight > 0);
+	m_alloc = alloc;
+
+	m_requests.create(m_alloc, maxInFlight);
+	for(U32 i = 0; i < maxInFlight; ++i)
+	{
+		m_requests[i].m_next = (i + 1 < maxInFlight) ? i + 1 : MAX_U32;
+	}
+	m_freeHead = 0;
+
+	return initBackend();
+}
+
+void FileIoQueue::destroy()
+{
+	if(m_inFlightCount)
+	{
+		if(waitAll())
+		{
+			ANKI_UTIL_LOGE("Some of the async reads failed");
+		}
+	}
+
+	if(m_backend)
+	{
+		destroyBackend();
+	}
+
+	m_requests.destroy(m_alloc);
+	m_freeHead = MAX_U32;
+	m_completedHead = MAX_U32;
+	m_completedTail = MAX_U32;
+}
+
+Error FileIoQueue::newRead(
+	File& file, PtrSize offset, void* buff, PtrSize size, FileReadAsyncCallback callback, void* userData)
+{
+	ANKI_ASSERT(m_requests.getSize() > 0 && "Not initialized");
+
+	// Make room
+	while(m_freeHead == MAX_U32)
+	{
+		U32 completedCount;
+		ANKI_CHECK(processCompletions(true, completedCount));
+	}
+
+	const U32 idx = m_freeHead;
+	Request& req = m_requests[idx];
+	m_freeHead = req.m_next;
+	++m_inFlightCount;
+
+	req.m_buffer = buff;
+	req.m_size = size;
+	req.m_callback = callback;
+	req.m_userData = userData;
+	req.m_result = -1;
+	req.m_next = MAX_U32;
+
+	if(m_backend && file.canReadNativelyAsync())
+	{
+		ANKI_CHECK(startRead(file, offset, idx));
+	}
+	else
+	{
+		readSync(file, offset, idx);
+	}
+
+	return Error::NONE;
+}
+
+void FileIoQueue::readSync(File& file, PtrSize offset, U32 requestIdx)
+{
+	Request& req = m_requests[requestIdx];
+	const Error err = file.readAt(offset, req.m_buffer, req.m_size);
+	markCompleted(requestIdx, (err) ? -1 : I64(req.m_size));
+}
+
+void FileIoQueue::markCompleted(U32 requestIdx, I64 result)
+{
+	Request& req = m_requests[requestIdx];
+	req.m_result = result;
+	req.m_next = MAX_U32;
+
+	if(m_completedTail == MAX_U32)
+	{
+		m_completedHead = requestIdx;
+	}
+	else
+	{
+		m_requests[m_completedTail].m_next = requestIdx;
+	}
+	m_completedTail = requestIdx;
+}
+
+Error FileIoQueue::submit()
+{
+	if(m_backend)
+	{
+		ANKI_CHECK(submitBackend());
+	}
+
+	return Error::NONE;
+}
+
+Error FileIoQueue::processCompletions(Bool wait, U32& completedCount)
+{
+	completedCount = 0;
+
+	if(m_backend && m_inFlightCount > 0)
+	{
+		ANKI_CHECK(submitBackend());
+		ANKI_CHECK(pollBackend(wait && m_completedHead == MAX_U32));
+	}
+
+	while(m_completedHead != MAX_U32)
+	{
+		// Release the request before the callback because the callback might issue new reads
+		const U32 idx = m_completedHead;
+		Request& req = m_requests[idx];
+		m_completedHead = req.m_next;
+		if(m_completedHead == MAX_U32)
+		{
+			m_completedTail = MAX_U32;
+		}
+
+		const FileReadAsyncCallback callback = req.m_callback;
+		void* const userData = req.m_userData;
+		const Bool ok = req.m_result == I64(req.m_size);
+
+		req.m_next = m_freeHead;
+		m_freeHead = idx;
+		ANKI_ASSERT(m_inFlightCount > 0);
+		--m_inFlightCount;
+		++completedCount;
+
+		if(!ok)
+		{
+			ANKI_UTIL_LOGE("Async file read failed");
+		}
+
+		callback(userData, (ok) ? Error::NONE : Error::FILE_ACCESS);
+	}
+
+	return Error::NONE;
+}
+
+Error FileIoQueue::waitAll()
+{
+	while(m_inFlightCount > 0)
+	{
+		U32 completedCount;
+		ANKI_CHECK(processCompletions(true, completedCount));
+	}
+
+	return Error::NONE;
+}
+
 } // end namespace anki
@@ -8,11 +8,16 @@
 #include <anki/util/String.h>
 #include <anki/util/Enum.h>
 #include <anki/util/NonCopyable.h>
+#include <anki/util/WeakArray.h>
+#include <anki/util/DynamicArray.h>
 #include <cstdio>
 
 namespace anki
 {
 
+// Forward
+class FileIoQueue;
+
 /// @addtogroup util_file
 /// @{
 
@@ -23,13 +28,18 @@ enum class FileOpenFlag : U8
 	NONE = 0,
 	READ = 1 << 0,
 	WRITE = 1 << 1,
+	ASYNC = 1 << 2, ///< Allow File::readAsync() to do real asynchronous reads. Only for reading
 	APPEND = WRITE | (1 << 3),
 	BINARY = 1 << 4,
 	ENDIAN_LITTLE = 1 << 5, ///< The default
-	ENDIAN_BIG = 1 << 6
+	ENDIAN_BIG = 1 << 6,
+	MMAP = 1 << 7 ///< Map the whole file to memory. Only for reading
 };
 ANKI_ENUM_ALLOW_NUMERIC_OPERATIONS(FileOpenFlag, inline)
 
+/// The callback of File::readAsync(). The error is Error::NONE if the whole range was read.
+using FileReadAsyncCallback = void (*)(void* userData, Error err);
+
 /// Passed to seek function
 /// @memberof File
 enum class FileSeekOrigin
@@ -44,8 +54,12 @@ enum class FileSeekOrigin
 /// To identify the file:
 /// - If the filename starts with '$' it will try to load a system specific file. For Android this is a file in the .apk
 /// - If the above are false then try to load a regular C file
+/// If the file is opened with FileOpenFlag::MMAP the reads copy straight from the mapped memory and getMappedRange()
+/// gives access to the memory without any copies.
 class File : public NonCopyable
 {
+	friend class FileIoQueue;
+
 public:
 	/// Default constructor
 	File() = default;
@@ -82,6 +96,21 @@ public:
 	/// Read data from the file
 	ANKI_USE_RESULT Error read(void* buff, PtrSize size);
 
+	/// Read a part of the file asynchronously. It doesn't use or change the position indicator so many reads of the
+	/// same file can be in flight. The callback is called by one of FileIoQueue's methods once the read is done.
+	/// @param queue The queue that will do the read.
+	/// @param offset The offset of the range from the beginning of the file.
+	/// @param[out] buff Where to read. It should be valid until the callback is called.
+	/// @param size The size of the range.
+	/// @param callback Called after the read completes.
+	/// @param userData Passed to the callback.
+	ANKI_USE_RESULT Error readAsync(FileIoQueue& queue,
+		PtrSize offset,
+		void* buff,
+		PtrSize size,
+		FileReadAsyncCallback callback,
+		void* userData);
+
 	/// Read all the contents of a text file
 	/// If the file is not rewined it will probably fail
 	ANKI_USE_RESULT Error readAllText(GenericMemoryPoolAllocator<U8> alloc, String& out);
@@ -112,6 +141,19 @@ public:
 	/// The the size of the file.
 	PtrSize getSize() const;
 
+	/// Return true if the file is mapped to memory.
+	Bool isMapped() const
+	{
+		return m_mappedData != nullptr;
+	}
+
+	/// Get a view of a part of a file that was opened with FileOpenFlag::MMAP. The view is valid for as long as the
+	/// file remains open.
+	/// @param offset The offset from the beginning of the file.
+	/// @param size The size of the range.
+	/// @param[out] view The memory of the range.
+	ANKI_USE_RESULT Error getMappedRange(PtrSize offset, PtrSize size, ConstWeakArray<U8>& view) const;
+
 private:
 	/// Internal filetype
 	enum class Type : U8
@@ -125,6 +167,13 @@ private:
 	Type m_type = Type::NONE;
 	FileOpenFlag m_flags = FileOpenFlag::NONE; ///< All the flags. Set on open
 	U32 m_size = 0;
+	const U8* m_mappedData = nullptr;
+	PtrSize m_mappedPos = 0; ///< The position indicator of a mapped file.
+#if ANKI_OS_WINDOWS
+	void* m_mapping = nullptr;
+	void* m_overlappedHandle = nullptr; ///< A second handle for the overlapped reads.
+	void* m_overlappedPort = nullptr; ///< The completion port m_overlappedHandle is associated with.
+#endif
 
 	/// Get the current machine's endianness
 	static FileOpenFlag getMachineEndianness();
@@ -139,6 +188,17 @@ private:
 	/// Open a C file
 	ANKI_USE_RESULT Error openCFile(const CString& filename, FileOpenFlag flags);
 
+	/// Map an open C file to memory.
+	ANKI_USE_RESULT Error mapCFile();
+
+	void unmapCFile();
+
+	/// Return true if FileIoQueue can read this file without blocking.
+	Bool canReadNativelyAsync() const;
+
+	/// Read a range without using the position indicator.
+	ANKI_USE_RESULT Error readAt(PtrSize offset, void* buff, PtrSize size);
+
 #if ANKI_OS_ANDROID
 	/// Open an Android file
 	ANKI_USE_RESULT Error openAndroidFile(const CString& filename, FileOpenFlag flags);
@@ -150,7 +210,110 @@ private:
 		m_type = Type::NONE;
 		m_flags = FileOpenFlag::NONE;
 		m_size = 0;
+		m_mappedData = nullptr;
+		m_mappedPos = 0;
+#if ANKI_OS_WINDOWS
+		m_mapping = nullptr;
+		m_overlappedHandle = nullptr;
+		m_overlappedPort = nullptr;
+#endif
+	}
+};
+
+/// A queue of asynchronous file reads. The reads are added with File::readAsync() and their callbacks are called from
+/// processCompletions() or waitAll(). Many reads can be in flight at the same time. On Linux it's backed by io_uring
+/// and on Windows by overlapped I/O and a completion port. On the other platforms, or if the OS doesn't support it,
+/// the reads happen synchronously but the callbacks are still deferred. It's not thread safe.
+class FileIoQueue : public NonCopyable
+{
+	friend class File;
+
+public:
+	FileIoQueue() = default;
+
+	~FileIoQueue()
+	{
+		destroy();
+	}
+
+	/// Initialize.
+	/// @param alloc The allocator.
+	/// @param maxInFlight The max number of reads that can be in flight. If it's reached File::readAsync() blocks.
+	ANKI_USE_RESULT Error init(GenericMemoryPoolAllocator<U8> alloc, U32 maxInFlight);
+
+	/// Wait for the reads in flight and destroy the queue.
+	void destroy();
+
+	/// Send the reads to the OS. The other methods do that as well.
+	ANKI_USE_RESULT Error submit();
+
+	/// Call the callbacks of the reads that completed.
+	/// @param wait If true block until at least one read completes (if there are any in flight).
+	/// @param[out] completedCount The number of callbacks that were called.
+	ANKI_USE_RESULT Error processCompletions(Bool wait, U32& completedCount);
+
+	/// Wait for all the reads to complete and call their callbacks.
+	ANKI_USE_RESULT Error waitAll();
+
+	/// Return the number of reads that their callbacks haven't been called yet.
+	U32 getInFlightCount() const
+	{
+		return m_inFlightCount;
 	}
+
+	/// Return true if the OS does the reads asynchronously.
+	Bool isNativelyAsync() const
+	{
+		return m_backend != nullptr;
+	}
+
+private:
+	class Request
+	{
+	public:
+		void* m_buffer;
+		PtrSize m_size;
+		FileReadAsyncCallback m_callback;
+		void* m_userData;
+		I64 m_result; ///< The bytes read or a negative number on failure.
+		U32 m_next; ///< The next in the free or the completed list.
+	};
+
+	/// The OS specific part.
+	class Backend;
+
+	GenericMemoryPoolAllocator<U8> m_alloc;
+	DynamicArray<Request> m_requests;
+	Backend* m_backend = nullptr;
+	U32 m_freeHead = MAX_U32;
+	U32 m_completedHead = MAX_U32;
+	U32 m_completedTail = MAX_U32;
+	U32 m_inFlightCount = 0;
+
+	ANKI_USE_RESULT Error newRead(
+		File& file, PtrSize offset, void* buff, PtrSize size, FileReadAsyncCallback callback, void* userData);
+
+	/// Read without the OS's help.
+	void readSync(File& file, PtrSize offset, U32 requestIdx);
+
+	void markCompleted(U32 requestIdx, I64 result);
+
+	/// @name OS specific
+	/// @{
+
+	/// Create the m_backend. If the OS doesn't support asynchronous reads leave it nullptr.
+	ANKI_USE_RESULT Error initBackend();
+
+	void destroyBackend();
+
+	/// Start a read. If it fails it should call markCompleted().
+	ANKI_USE_RESULT Error startRead(File& file, PtrSize offset, U32 requestIdx);
+
+	ANKI_USE_RESULT Error submitBackend();
+
+	/// Get the completions from the OS and call markCompleted() for them.
+	ANKI_USE_RESULT Error pollBackend(Bool wait);
+	/// @}
 };
 /// @}
 
@@ -9,6 +9,7 @@
 #define _FILE_OFFSET_BITS 64
 
 #include <anki/util/Filesystem.h>
+#include <anki/util/File.h>
 #include <anki/util/Assert.h>
 #include <anki/util/Thread.h>
 #include <cstring>
@@ -19,6 +20,16 @@
 #include <ftw.h> // For walkDirectoryTree
 #include <cstdlib>
 #include <time.h>
+#if ANKI_OS_LINUX && __has_include(<linux/io_uring.h>)
+#	include <linux/io_uring.h>
+#	include <sys/mman.h>
+#	include <sys/syscall.h>
+#	include <sys/uio.h>
+#	include <unistd.h>
+#	define ANKI_IO_URING 1
+#else
+#	define ANKI_IO_URING 0
+#endif
 
 #ifndef USE_FDS
 #	define USE_FDS 15
@@ -228,4 +239,291 @@ Error getFileModificationTime(CString filename, U32& year, U32& month, U32& day,
 	return Error::NONE;
 }
 
+#if ANKI_IO_URING
+/// An io_uring without liburing. The submission and the completion rings are shared with the kernel.
+class FileIoQueue::Backend
+{
+public:
+	int m_ringFd = -1;
+
+	void* m_sqRing = nullptr;
+	PtrSize m_sqRingSize = 0;
+	void* m_cqRing = nullptr;
+	PtrSize m_cqRingSize = 0;
+	io_uring_sqe* m_sqes = nullptr;
+	PtrSize m_sqesSize = 0;
+
+	U32* m_sqHead = nullptr;
+	U32* m_sqTail = nullptr;
+	U32* m_sqArray = nullptr;
+	U32 m_sqMask = 0;
+	U32 m_sqEntryCount = 0;
+
+	U32* m_cqHead = nullptr;
+	U32* m_cqTail = nullptr;
+	io_uring_cqe* m_cqes = nullptr;
+	U32 m_cqMask = 0;
+
+	DynamicArray<iovec> m_iovecs; ///< One per request.
+	U32 m_pendingSubmitCount = 0;
+
+	U32* ringPtr(void* ring, U32 offset)
+	{
+		return reinterpret_cast<U32*>(static_cast<U8*>(ring) + offset);
+	}
+
+	void unmap()
+	{
+		if(m_sqes)
+		{
+			munmap(m_sqes, m_sqesSize);
+		}
+
+		if(m_cqRing && m_cqRing != m_sqRing)
+		{
+			munmap(m_cqRing, m_cqRingSize);
+		}
+
+		if(m_sqRing)
+		{
+			munmap(m_sqRing, m_sqRingSize);
+		}
+
+		if(m_ringFd >= 0)
+		{
+			close(m_ringFd);
+		}
+	}
+
+	Error map(const io_uring_params& params)
+	{
+		m_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(U32);
+		m_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+		const Bool singleMmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+		if(singleMmap)
+		{
+			m_sqRingSize = m_cqRingSize = max(m_sqRingSize, m_cqRingSize);
+		}
+
+		void* mem = mmap(
+			nullptr, m_sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_SQ_RING);
+		if(mem == MAP_FAILED)
+		{
+			return Error::FUNCTION_FAILED;
+		}
+		m_sqRing = mem;
+
+		if(singleMmap)
+		{
+			m_cqRing = m_sqRing;
+		}
+		else
+		{
+			mem = mmap(nullptr,
+				m_cqRingSize,
+				PROT_READ | PROT_WRITE,
+				MAP_SHARED | MAP_POPULATE,
+				m_ringFd,
+				IORING_OFF_CQ_RING);
+			if(mem == MAP_FAILED)
+			{
+				return Error::FUNCTION_FAILED;
+			}
+			m_cqRing = mem;
+		}
+
+		m_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+		mem = mmap(nullptr, m_sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_SQES);
+		if(mem == MAP_FAILED)
+		{
+			return Error::FUNCTION_FAILED;
+		}
+		m_sqes = static_cast<io_uring_sqe*>(mem);
+
+		m_sqHead = ringPtr(m_sqRing, params.sq_off.head);
+		m_sqTail = ringPtr(m_sqRing, params.sq_off.tail);
+		m_sqArray = ringPtr(m_sqRing, params.sq_off.array);
+		m_sqMask = *ringPtr(m_sqRing, params.sq_off.ring_mask);
+		m_sqEntryCount = params.sq_entries;
+
+		m_cqHead = ringPtr(m_cqRing, params.cq_off.head);
+		m_cqTail = ringPtr(m_cqRing, params.cq_off.tail);
+		m_cqes = reinterpret_cast<io_uring_cqe*>(ringPtr(m_cqRing, params.cq_off.cqes));
+		m_cqMask = *ringPtr(m_cqRing, params.cq_off.ring_mask);
+
+		return Error::NONE;
+	}
+};
+
+Error FileIoQueue::initBackend()
+{
+	ANKI_ASSERT(m_backend == nullptr);
+
+	io_uring_params params;
+	memset(&params, 0, sizeof(params));
+	const int fd = int(syscall(__NR_io_uring_setup, m_requests.getSize(), &params));
+	if(fd < 0)
+	{
+		ANKI_UTIL_LOGI("io_uring is not available (%s). The async reads will be synchronous", strerror(errno));
+		return Error::NONE;
+	}
+
+	Backend* backend = m_alloc.newInstance<Backend>();
+	backend->m_ringFd = fd;
+	if(backend->map(params))
+	{
+		ANKI_UTIL_LOGW("Failed to map the io_uring. The async reads will be synchronous");
+		backend->unmap();
+		m_alloc.deleteInstance(backend);
+		return Error::NONE;
+	}
+
+	// There are never more reads in flight than requests so the rings can't overflow
+	ANKI_ASSERT(backend->m_sqEntryCount >= m_requests.getSize());
+	backend->m_iovecs.create(m_alloc, m_requests.getSize());
+
+	m_backend = backend;
+	return Error::NONE;
+}
+
+void FileIoQueue::destroyBackend()
+{
+	m_backend->unmap();
+	m_backend->m_iovecs.destroy(m_alloc);
+	m_alloc.deleteInstance(m_backend);
+	m_backend = nullptr;
+}
+
+Error FileIoQueue::startRead(File& file, PtrSize offset, U32 requestIdx)
+{
+	Backend& b = *m_backend;
+	const Request& req = m_requests[requestIdx];
+
+	iovec& vec = b.m_iovecs[requestIdx];
+	vec.iov_base = req.m_buffer;
+	vec.iov_len = req.m_size;
+
+	// Only this thread writes the tail
+	const U32 tail = *b.m_sqTail;
+	ANKI_ASSERT(tail - __atomic_load_n(b.m_sqHead, __ATOMIC_ACQUIRE) < b.m_sqEntryCount);
+	const U32 sqeIdx = tail & b.m_sqMask;
+
+	io_uring_sqe& sqe = b.m_sqes[sqeIdx];
+	memset(&sqe, 0, sizeof(sqe));
+	sqe.opcode = IORING_OP_READV;
+	sqe.fd = fileno(static_cast<FILE*>(file.m_file));
+	sqe.off = offset;
+	sqe.addr = ptrToNumber(&vec);
+	sqe.len = 1;
+	sqe.user_data = requestIdx;
+
+	b.m_sqArray[sqeIdx] = sqeIdx;
+	__atomic_store_n(b.m_sqTail, tail + 1, __ATOMIC_RELEASE);
+	++b.m_pendingSubmitCount;
+
+	return Error::NONE;
+}
+
+Error FileIoQueue::submitBackend()
+{
+	Backend& b = *m_backend;
+
+	while(b.m_pendingSubmitCount > 0)
+	{
+		const int ret = int(syscall(__NR_io_uring_enter, b.m_ringFd, b.m_pendingSubmitCount, 0, 0, nullptr, 0));
+		if(ret < 0)
+		{
+			if(errno == EINTR)
+			{
+				continue;
+			}
+			else if(errno == EAGAIN || errno == EBUSY)
+			{
+				// The kernel is out of resources, try later
+				break;
+			}
+
+			ANKI_UTIL_LOGE("io_uring_enter() failed: %s", strerror(errno));
+			return Error::FUNCTION_FAILED;
+		}
+
+		b.m_pendingSubmitCount -= U32(ret);
+	}
+
+	return Error::NONE;
+}
+
+Error FileIoQueue::pollBackend(Bool wait)
+{
+	Backend& b = *m_backend;
+
+	auto reap = [&]() -> U32 {
+		U32 head = *b.m_cqHead;
+		const U32 tail = __atomic_load_n(b.m_cqTail, __ATOMIC_ACQUIRE);
+		const U32 count = tail - head;
+		while(head != tail)
+		{
+			const io_uring_cqe& cqe = b.m_cqes[head & b.m_cqMask];
+			markCompleted(U32(cqe.user_data), cqe.res);
+			++head;
+		}
+
+		__atomic_store_n(b.m_cqHead, head, __ATOMIC_RELEASE);
+		return count;
+	};
+
+	if(reap() == 0 && wait)
+	{
+		while(true)
+		{
+			const int ret = int(syscall(
+				__NR_io_uring_enter, b.m_ringFd, b.m_pendingSubmitCount, 1, IORING_ENTER_GETEVENTS, nullptr, 0));
+			if(ret >= 0)
+			{
+				b.m_pendingSubmitCount -= U32(ret);
+				break;
+			}
+			else if(errno != EINTR)
+			{
+				ANKI_UTIL_LOGE("io_uring_enter() failed: %s", strerror(errno));
+				return Error::FUNCTION_FAILED;
+			}
+		}
+
+		reap();
+	}
+
+	return Error::NONE;
+}
+#else
+Error FileIoQueue::initBackend()
+{
+	// Not supported, the reads will be synchronous
+	return Error::NONE;
+}
+
+void FileIoQueue::destroyBackend()
+{
+	ANKI_ASSERT(0);
+}
+
+Error FileIoQueue::startRead(File& file, PtrSize offset, U32 requestIdx)
+{
+	ANKI_ASSERT(0);
+	return Error::NONE;
+}
+
+Error FileIoQueue::submitBackend()
+{
+	ANKI_ASSERT(0);
+	return Error::NONE;
+}
+
+Error FileIoQueue::pollBackend(Bool wait)
+{
+	ANKI_ASSERT(0);
+	return Error::NONE;
+}
+#endif
+
 } // end namespace anki
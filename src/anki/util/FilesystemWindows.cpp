@@ -4,6 +4,7 @@
 // http://www.anki3d.org/LICENSE
 
 #include <anki/util/Filesystem.h>
+#include <anki/util/File.h>
 #include <anki/util/Assert.h>
 #include <anki/util/Logger.h>
 #include <anki/util/Win32Minimal.h>
@@ -183,4 +184,118 @@ Error walkDirectoryTree(const CString& dir, void* userData, WalkDirectoryTreeCal
 	return walkDirectoryTreeInternal(dir, userData, callback, baseDirLen);
 }
 
+/// Overlapped reads that complete to a completion port.
+class FileIoQueue::Backend
+{
+public:
+	HANDLE m_port = nullptr;
+	DynamicArray<OVERLAPPED> m_overlapped; ///< One per request.
+};
+
+Error FileIoQueue::initBackend()
+{
+	ANKI_ASSERT(m_backend == nullptr);
+
+	HANDLE port = CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1);
+	if(port == nullptr)
+	{
+		ANKI_UTIL_LOGW("CreateIoCompletionPort() failed. The async reads will be synchronous");
+		return Error::NONE;
+	}
+
+	m_backend = m_alloc.newInstance<Backend>();
+	m_backend->m_port = port;
+	m_backend->m_overlapped.create(m_alloc, m_requests.getSize());
+
+	return Error::NONE;
+}
+
+void FileIoQueue::destroyBackend()
+{
+	CloseHandle(m_backend->m_port);
+	m_backend->m_overlapped.destroy(m_alloc);
+	m_alloc.deleteInstance(m_backend);
+	m_backend = nullptr;
+}
+
+Error FileIoQueue::startRead(File& file, PtrSize offset, U32 requestIdx)
+{
+	Backend& b = *m_backend;
+	const Request& req = m_requests[requestIdx];
+	ANKI_ASSERT(req.m_size <= MAX_U32 && "ReadFile() can't read that much");
+
+	// A handle can be associated with one port only
+	if(file.m_overlappedPort != b.m_port)
+	{
+		if(file.m_overlappedPort != nullptr)
+		{
+			ANKI_UTIL_LOGE("The file is already used by another FileIoQueue");
+			return Error::FUNCTION_FAILED;
+		}
+
+		if(CreateIoCompletionPort(file.m_overlappedHandle, b.m_port, 0, 0) == nullptr)
+		{
+			ANKI_UTIL_LOGE("CreateIoCompletionPort() failed");
+			return Error::FUNCTION_FAILED;
+		}
+
+		file.m_overlappedPort = b.m_port;
+	}
+
+	OVERLAPPED& overlapped = b.m_overlapped[requestIdx];
+	memset(&overlapped, 0, sizeof(overlapped));
+	overlapped.Offset = DWORD(offset);
+	overlapped.OffsetHigh = DWORD(U64(offset) >> 32u);
+
+	// Even if it completes immediately a completion packet is queued
+	if(!ReadFile(file.m_overlappedHandle, req.m_buffer, DWORD(req.m_size), nullptr, &overlapped)
+		&& GetLastError() != ERROR_IO_PENDING)
+	{
+		ANKI_UTIL_LOGE("ReadFile() failed");
+		markCompleted(requestIdx, -1);
+	}
+
+	return Error::NONE;
+}
+
+Error FileIoQueue::submitBackend()
+{
+	// The reads start in ReadFile()
+	return Error::NONE;
+}
+
+Error FileIoQueue::pollBackend(Bool wait)
+{
+	Backend& b = *m_backend;
+	DWORD timeout = (wait) ? INFINITE : 0;
+
+	while(true)
+	{
+		DWORD bytes = 0;
+		ULONG_PTR key;
+		OVERLAPPED* overlapped = nullptr;
+		const BOOL ok = GetQueuedCompletionStatus(b.m_port, &bytes, &key, &overlapped, timeout);
+
+		if(overlapped == nullptr)
+		{
+			if(!ok && GetLastError() != WAIT_TIMEOUT)
+			{
+				ANKI_UTIL_LOGE("GetQueuedCompletionStatus() failed");
+				return Error::FUNCTION_FAILED;
+			}
+
+			// No more completions
+			break;
+		}
+
+		const U32 requestIdx = U32(overlapped - &b.m_overlapped[0]);
+		markCompleted(requestIdx, (ok) ? I64(bytes) : -1);
+
+		// Got at least one, don't block for the rest
+		timeout = 0;
+	}
+
+	return Error::NONE;
+}
+
 } // end namespace anki
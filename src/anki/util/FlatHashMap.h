@@ -0,0 +1,376 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/util/HashMap.h>
+#include <anki/util/ControlByteGroup.h>
+
+namespace anki
+{
+
+/// @addtogroup util_containers
+/// @{
+
+/// A group of FlatHashMap control bytes.
+class FlatHashMapGroup : public ControlByteGroup
+{
+public:
+	/// Control byte of an empty slot.
+	static constexpr U8 EMPTY = 0x80;
+
+	/// Control byte of an erased slot (tombstone).
+	static constexpr U8 DELETED = 0xFE;
+
+	/// Load the control bytes. They should be aligned to SIZE.
+	explicit FlatHashMapGroup(const U8* ctrl)
+		: ControlByteGroup(ctrl)
+	{
+		ANKI_ASSERT(isAligned(SIZE, ctrl));
+	}
+
+	/// Get a bit mask of the empty slots.
+	U32 matchEmpty() const
+	{
+		return match(EMPTY);
+	}
+
+	/// Get a bit mask of the empty or deleted slots. Both have their high bit set.
+	U32 matchEmptyOrDeleted() const
+	{
+		return matchHighBit();
+	}
+};
+
+/// FlatHashMap iterator.
+template<typename TValuePointer, typename TValueReference, typename TMapPtr>
+class FlatHashMapIterator
+{
+	template<typename, typename, typename>
+	friend class FlatHashMap;
+
+	template<typename, typename, typename>
+	friend class FlatHashMapIterator;
+
+public:
+	/// Default constructor.
+	FlatHashMapIterator()
+		: m_map(nullptr)
+		, m_slotIdx(MAX_U32)
+	{
+	}
+
+	/// Copy.
+	FlatHashMapIterator(const FlatHashMapIterator& b)
+		: m_map(b.m_map)
+		, m_slotIdx(b.m_slotIdx)
+	{
+	}
+
+	/// Allow conversion from iterator to const iterator.
+	template<typename YValuePointer, typename YValueReference, typename YMapPtr>
+	FlatHashMapIterator(const FlatHashMapIterator<YValuePointer, YValueReference, YMapPtr>& b)
+		: m_map(b.m_map)
+		, m_slotIdx(b.m_slotIdx)
+	{
+	}
+
+	FlatHashMapIterator(TMapPtr map, U32 slotIdx)
+		: m_map(map)
+		, m_slotIdx(slotIdx)
+	{
+		ANKI_ASSERT(map);
+	}
+
+	FlatHashMapIterator& operator=(const FlatHashMapIterator& b)
+	{
+		m_map = b.m_map;
+		m_slotIdx = b.m_slotIdx;
+		return *this;
+	}
+
+	TValueReference operator*() const
+	{
+		check();
+		return m_map->m_slots[m_slotIdx].getValue();
+	}
+
+	TValuePointer operator->() const
+	{
+		check();
+		return &m_map->m_slots[m_slotIdx].getValue();
+	}
+
+	FlatHashMapIterator& operator++()
+	{
+		check();
+		m_slotIdx = m_map->findNextFull(m_slotIdx + 1);
+		return *this;
+	}
+
+	FlatHashMapIterator operator++(int)
+	{
+		check();
+		FlatHashMapIterator out = *this;
+		++(*this);
+		return out;
+	}
+
+	Bool operator==(const FlatHashMapIterator& b) const
+	{
+		ANKI_ASSERT(m_map == b.m_map);
+		return m_slotIdx == b.m_slotIdx;
+	}
+
+	Bool operator!=(const FlatHashMapIterator& b) const
+	{
+		return !(*this == b);
+	}
+
+private:
+	TMapPtr m_map;
+	U32 m_slotIdx;
+
+	void check() const
+	{
+		ANKI_ASSERT(m_map);
+		ANKI_ASSERT(m_slotIdx < m_map->m_capacity);
+		ANKI_ASSERT(m_map->m_ctrl[m_slotIdx] < FlatHashMapGroup::EMPTY);
+	}
+};
+
+/// Open addressing hash map. It has the same interface and the same allocator conventions as HashMap but it keeps
+/// everything in flat arrays. Every slot has a control byte that holds 7 bits of the hash. Lookups scan groups of
+/// FlatHashMapGroup::SIZE control bytes using SIMD and only touch the hashes and values of slots that match.
+/// @note Like HashMap it identifies the keys by their 64bit hash.
+template<typename TKey, typename TValue, typename THasher = DefaultHasher<TKey>>
+class FlatHashMap
+{
+	template<typename, typename, typename>
+	friend class FlatHashMapIterator;
+
+public:
+	// Typedefs
+	using Value = TValue;
+	using Key = TKey;
+	using Hasher = THasher;
+	using Iterator = FlatHashMapIterator<TValue*, TValue&, FlatHashMap*>;
+	using ConstIterator = FlatHashMapIterator<const TValue*, const TValue&, const FlatHashMap*>;
+
+	// Consts
+	static constexpr U32 INITIAL_STORAGE_SIZE = 64; ///< The initial slot count.
+	static constexpr U32 MAX_LOAD_FACTOR_NUMERATOR = 7; ///< Grow when more than 7/8 of the slots are used.
+	static constexpr U32 MAX_LOAD_FACTOR_DENOMINATOR = 8;
+
+	/// Default constructor.
+	/// @param initialStorageSize The slot count of the first allocation. Power of two and at least a group.
+	FlatHashMap(U32 initialStorageSize = INITIAL_STORAGE_SIZE)
+		: m_initialStorageSize(initialStorageSize)
+	{
+		ANKI_ASSERT(isPowerOfTwo(initialStorageSize) && initialStorageSize >= FlatHashMapGroup::SIZE);
+	}
+
+	/// Non-copyable.
+	FlatHashMap(const FlatHashMap&) = delete;
+
+	/// Move.
+	FlatHashMap(FlatHashMap&& b)
+	{
+		*this = std::move(b);
+	}
+
+	/// You need to manually destroy the map.
+	/// @see FlatHashMap::destroy
+	~FlatHashMap()
+	{
+		ANKI_ASSERT(m_ctrl == nullptr && "Forgot to call destroy");
+	}
+
+	/// Non-copyable.
+	FlatHashMap& operator=(const FlatHashMap&) = delete;
+
+	/// Move.
+	FlatHashMap& operator=(FlatHashMap&& b)
+	{
+		ANKI_ASSERT(m_ctrl == nullptr && "Forgot to call destroy");
+		m_ctrl = b.m_ctrl;
+		m_slots = b.m_slots;
+		m_capacity = b.m_capacity;
+		m_elementCount = b.m_elementCount;
+		m_growthLeft = b.m_growthLeft;
+		m_initialStorageSize = b.m_initialStorageSize;
+		b.resetMembers();
+		return *this;
+	}
+
+	/// Get begin.
+	Iterator getBegin()
+	{
+		return Iterator(this, findNextFull(0));
+	}
+
+	/// Get begin.
+	ConstIterator getBegin() const
+	{
+		return ConstIterator(this, findNextFull(0));
+	}
+
+	/// Get end.
+	Iterator getEnd()
+	{
+		return Iterator(this, MAX_U32);
+	}
+
+	/// Get end.
+	ConstIterator getEnd() const
+	{
+		return ConstIterator(this, MAX_U32);
+	}
+
+	/// Get begin.
+	Iterator begin()
+	{
+		return getBegin();
+	}
+
+	/// Get begin.
+	ConstIterator begin() const
+	{
+		return getBegin();
+	}
+
+	/// Get end.
+	Iterator end()
+	{
+		return getEnd();
+	}
+
+	/// Get end.
+	ConstIterator end() const
+	{
+		return getEnd();
+	}
+
+	/// Get the number of elements.
+	U32 getSize() const
+	{
+		return m_elementCount;
+	}
+
+	/// Return true if map is empty.
+	Bool isEmpty() const
+	{
+		return m_elementCount == 0;
+	}
+
+	/// Destroy the map.
+	template<typename TAllocator>
+	void destroy(TAllocator alloc);
+
+	/// Construct an element inside the map. If the key exists its value will be replaced.
+	template<typename TAllocator, typename... TArgs>
+	Iterator emplace(TAllocator alloc, const TKey& key, TArgs&&... args);
+
+	/// Erase element.
+	template<typename TAllocator>
+	void erase(TAllocator alloc, Iterator it);
+
+	/// Find a value using a key.
+	Iterator find(const Key& key)
+	{
+		return Iterator(this, findInternal(THasher()(key)));
+	}
+
+	/// Find a value using a key.
+	ConstIterator find(const Key& key) const
+	{
+		return ConstIterator(this, findInternal(THasher()(key)));
+	}
+
+private:
+	/// The hash is next to the value so a successful lookup touches one cache line after the control bytes.
+	class Slot
+	{
+	public:
+		U64 m_hash; ///< The full hash. Compared only if the control byte matched.
+		alignas(Value) U8 m_valueStorage[sizeof(Value)];
+
+		Value& getValue()
+		{
+			return *reinterpret_cast<Value*>(&m_valueStorage[0]);
+		}
+
+		const Value& getValue() const
+		{
+			return *reinterpret_cast<const Value*>(&m_valueStorage[0]);
+		}
+	};
+
+	U8* m_ctrl = nullptr; ///< One control byte per slot. Full slots hold the H2 part of the hash.
+	Slot* m_slots = nullptr;
+	U32 m_capacity = 0;
+	U32 m_elementCount = 0;
+	U32 m_growthLeft = 0; ///< Inserts that can happen before rehashing. Tombstones also consume it.
+	U32 m_initialStorageSize = 0;
+
+	U32 getGroupMask() const
+	{
+		ANKI_ASSERT(m_capacity > 0);
+		return (m_capacity / FlatHashMapGroup::SIZE) - 1;
+	}
+
+	/// Remix the hash because many of the DefaultHasher specializations are the identity and they don't spread the
+	/// bits.
+	static U64 mixHash(U64 hash)
+	{
+		hash ^= hash >> 33;
+		hash *= 0xFF51AFD7ED558CCDull;
+		hash ^= hash >> 33;
+		return hash;
+	}
+
+	/// The group where probing starts.
+	static U32 getH1(U64 mixedHash)
+	{
+		return U32(mixedHash >> 7);
+	}
+
+	/// The 7 bits that go to the control byte.
+	static U8 getH2(U64 mixedHash)
+	{
+		return U8(mixedHash & 0x7F);
+	}
+
+	static U32 computeMaxGrowth(U32 capacity)
+	{
+		return capacity / MAX_LOAD_FACTOR_DENOMINATOR * MAX_LOAD_FACTOR_NUMERATOR;
+	}
+
+	U32 findInternal(U64 hash) const;
+
+	/// Find the first empty or deleted slot in the probe sequence of a hash.
+	U32 findInsertSlot(U64 mixedHash) const;
+
+	/// Find the first full slot that is at or after a slot.
+	U32 findNextFull(U32 slotIdx) const;
+
+	/// Allocate new storage and re-insert everything.
+	template<typename TAllocator>
+	void rehash(TAllocator& alloc, U32 newCapacity);
+
+	void resetMembers()
+	{
+		m_ctrl = nullptr;
+		m_slots = nullptr;
+		m_capacity = 0;
+		m_elementCount = 0;
+		m_growthLeft = 0;
+	}
+};
+/// @}
+
+} // end namespace anki
+
+#include <anki/util/FlatHashMap.inl.h>
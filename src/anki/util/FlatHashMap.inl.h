@@ -0,0 +1,228 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/util/FlatHashMap.h>
+
+namespace anki
+{
+
+template<typename TKey, typename TValue, typename THasher>
+template<typename TAllocator>
+void FlatHashMap<TKey, TValue, THasher>::destroy(TAllocator alloc)
+{
+	if(m_ctrl)
+	{
+		for(U32 i = 0; i < m_capacity; ++i)
+		{
+			if(m_ctrl[i] < FlatHashMapGroup::EMPTY)
+			{
+				m_slots[i].getValue().~Value();
+			}
+		}
+
+		alloc.getMemoryPool().free(m_ctrl);
+		alloc.getMemoryPool().free(m_slots);
+	}
+
+	resetMembers();
+}
+
+template<typename TKey, typename TValue, typename THasher>
+U32 FlatHashMap<TKey, TValue, THasher>::findInternal(U64 hash) const
+{
+	if(ANKI_UNLIKELY(m_capacity == 0))
+	{
+		return MAX_U32;
+	}
+
+	const U64 mixedHash = mixHash(hash);
+	const U8 h2 = getH2(mixedHash);
+	const U32 groupMask = getGroupMask();
+	U32 groupIdx = getH1(mixedHash) & groupMask;
+	U32 stride = 0;
+
+	while(true)
+	{
+		const U32 firstSlot = groupIdx * FlatHashMapGroup::SIZE;
+		const FlatHashMapGroup group(m_ctrl + firstSlot);
+
+		U32 mask = group.match(h2);
+		while(mask)
+		{
+			const U32 slotIdx = firstSlot + FlatHashMapGroup::getLowestBit(mask);
+			if(ANKI_LIKELY(m_slots[slotIdx].m_hash == hash))
+			{
+				return slotIdx;
+			}
+
+			mask &= mask - 1;
+		}
+
+		// An empty slot terminates the probe sequence
+		if(group.matchEmpty())
+		{
+			return MAX_U32;
+		}
+
+		// Triangular probing over the groups. It visits all of them since the group count is a power of two
+		++stride;
+		ANKI_ASSERT(stride <= groupMask && "Table is full, shouldn't happen");
+		groupIdx = (groupIdx + stride) & groupMask;
+	}
+}
+
+template<typename TKey, typename TValue, typename THasher>
+U32 FlatHashMap<TKey, TValue, THasher>::findInsertSlot(U64 mixedHash) const
+{
+	ANKI_ASSERT(m_capacity > 0);
+	const U32 groupMask = getGroupMask();
+	U32 groupIdx = getH1(mixedHash) & groupMask;
+	U32 stride = 0;
+
+	while(true)
+	{
+		const U32 firstSlot = groupIdx * FlatHashMapGroup::SIZE;
+		const U32 mask = FlatHashMapGroup(m_ctrl + firstSlot).matchEmptyOrDeleted();
+		if(mask)
+		{
+			return firstSlot + FlatHashMapGroup::getLowestBit(mask);
+		}
+
+		++stride;
+		ANKI_ASSERT(stride <= groupMask && "Table is full, shouldn't happen");
+		groupIdx = (groupIdx + stride) & groupMask;
+	}
+}
+
+template<typename TKey, typename TValue, typename THasher>
+U32 FlatHashMap<TKey, TValue, THasher>::findNextFull(U32 slotIdx) const
+{
+	for(; slotIdx < m_capacity; ++slotIdx)
+	{
+		if(m_ctrl[slotIdx] < FlatHashMapGroup::EMPTY)
+		{
+			return slotIdx;
+		}
+	}
+
+	return MAX_U32;
+}
+
+template<typename TKey, typename TValue, typename THasher>
+template<typename TAllocator>
+void FlatHashMap<TKey, TValue, THasher>::rehash(TAllocator& alloc, U32 newCapacity)
+{
+	ANKI_ASSERT(isPowerOfTwo(newCapacity) && newCapacity >= FlatHashMapGroup::SIZE);
+	ANKI_ASSERT(computeMaxGrowth(newCapacity) > m_elementCount);
+
+	U8* const oldCtrl = m_ctrl;
+	Slot* const oldSlots = m_slots;
+	const U32 oldCapacity = m_capacity;
+
+	m_ctrl = static_cast<U8*>(alloc.getMemoryPool().allocate(newCapacity, FlatHashMapGroup::SIZE));
+	m_slots = static_cast<Slot*>(alloc.getMemoryPool().allocate(newCapacity * sizeof(Slot), alignof(Slot)));
+	memset(m_ctrl, FlatHashMapGroup::EMPTY, newCapacity);
+	m_capacity = newCapacity;
+	m_growthLeft = computeMaxGrowth(newCapacity) - m_elementCount;
+
+	for(U32 i = 0; i < oldCapacity; ++i)
+	{
+		if(oldCtrl[i] < FlatHashMapGroup::EMPTY)
+		{
+			Slot& oldSlot = oldSlots[i];
+			const U64 mixedHash = mixHash(oldSlot.m_hash);
+			const U32 slotIdx = findInsertSlot(mixedHash);
+
+			m_ctrl[slotIdx] = getH2(mixedHash);
+			m_slots[slotIdx].m_hash = oldSlot.m_hash;
+			::new(&m_slots[slotIdx].getValue()) Value(std::move(oldSlot.getValue()));
+			oldSlot.getValue().~Value();
+		}
+	}
+
+	if(oldCtrl)
+	{
+		alloc.getMemoryPool().free(oldCtrl);
+		alloc.getMemoryPool().free(oldSlots);
+	}
+}
+
+template<typename TKey, typename TValue, typename THasher>
+template<typename TAllocator, typename... TArgs>
+typename FlatHashMap<TKey, TValue, THasher>::Iterator FlatHashMap<TKey, TValue, THasher>::emplace(
+	TAllocator alloc, const TKey& key, TArgs&&... args)
+{
+	const U64 hash = THasher()(key);
+
+	// Replace if it exists
+	U32 slotIdx = findInternal(hash);
+	if(slotIdx != MAX_U32)
+	{
+		m_slots[slotIdx].getValue().~Value();
+		::new(&m_slots[slotIdx].getValue()) Value(std::forward<TArgs>(args)...);
+		return Iterator(this, slotIdx);
+	}
+
+	if(m_growthLeft == 0)
+	{
+		if(m_capacity == 0)
+		{
+			rehash(alloc, m_initialStorageSize);
+		}
+		else if(m_elementCount < computeMaxGrowth(m_capacity) / 2)
+		{
+			// Mostly tombstones, clean them up without growing
+			rehash(alloc, m_capacity);
+		}
+		else
+		{
+			rehash(alloc, m_capacity * 2);
+		}
+	}
+
+	const U64 mixedHash = mixHash(hash);
+	slotIdx = findInsertSlot(mixedHash);
+
+	// Tombstones have already consumed growth
+	if(m_ctrl[slotIdx] == FlatHashMapGroup::EMPTY)
+	{
+		ANKI_ASSERT(m_growthLeft > 0);
+		--m_growthLeft;
+	}
+
+	m_ctrl[slotIdx] = getH2(mixedHash);
+	m_slots[slotIdx].m_hash = hash;
+	::new(&m_slots[slotIdx].getValue()) Value(std::forward<TArgs>(args)...);
+	++m_elementCount;
+
+	return Iterator(this, slotIdx);
+}
+
+template<typename TKey, typename TValue, typename THasher>
+template<typename TAllocator>
+void FlatHashMap<TKey, TValue, THasher>::erase(TAllocator alloc, Iterator it)
+{
+	ANKI_ASSERT(it.m_map == this);
+	it.check();
+	const U32 slotIdx = it.m_slotIdx;
+
+	m_slots[slotIdx].getValue().~Value();
+	--m_elementCount;
+
+	// If the group already has an empty slot then no probe sequence ever went past it. The slot can become empty
+	// again instead of a tombstone
+	const U32 firstSlot = slotIdx & ~(FlatHashMapGroup::SIZE - 1);
+	if(FlatHashMapGroup(m_ctrl + firstSlot).matchEmpty())
+	{
+		m_ctrl[slotIdx] = FlatHashMapGroup::EMPTY;
+		++m_growthLeft;
+	}
+	else
+	{
+		m_ctrl[slotIdx] = FlatHashMapGroup::DELETED;
+	}
+}
+
+} // end namespace anki
@@ -0,0 +1,162 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/util/DynamicArray.h>
+#include <anki/util/NonCopyable.h>
+
+namespace anki
+{
+
+/// @addtogroup util_patterns
+/// @{
+
+/// The objects of a FlatHierarchy should derive from this. It holds the index of the object in the hierarchy.
+template<typename TClass>
+class FlatHierarchyEnabled
+{
+	template<typename>
+	friend class FlatHierarchy;
+
+	friend TClass;
+
+private:
+	U32 m_flatHierarchyIdx = MAX_U32;
+
+	FlatHierarchyEnabled() = default;
+};
+
+/// A forest of objects that lives in one array in depth first order. Every object is followed by its subtree so the
+/// parents come before their children and a traversal of the whole forest is a linear scan. The parents are indices in
+/// the same array. Reparenting moves the subtree in the array and updates the indices after it.
+/// @tparam T The type of the objects. It should derive from FlatHierarchyEnabled.
+template<typename T>
+class FlatHierarchy : public NonCopyable
+{
+public:
+	using Value = T;
+
+	/// The parent index of the roots.
+	static constexpr U32 NO_PARENT = MAX_U32;
+
+	FlatHierarchy() = default;
+
+	~FlatHierarchy()
+	{
+		ANKI_ASSERT(m_nodes.getSize() == 0 && "Requires manual destruction");
+	}
+
+	/// Remove all the objects.
+	template<typename TAllocator>
+	void destroy(TAllocator alloc);
+
+	/// Make room for more objects.
+	template<typename TAllocator>
+	void reserve(TAllocator alloc, U32 count)
+	{
+		m_nodes.resizeStorage(alloc, count);
+		m_parents.resizeStorage(alloc, count);
+		m_subtreeSizes.resizeStorage(alloc, count);
+	}
+
+	/// Add an object without children.
+	/// @param parent The object will be the last child of the parent. If it's nullptr the object will be a root.
+	template<typename TAllocator>
+	void add(TAllocator alloc, Value* node, Value* parent = nullptr);
+
+	/// Remove an object. Its children become roots.
+	template<typename TAllocator>
+	void remove(TAllocator alloc, Value* node);
+
+	/// Move an object and its subtree under a new parent.
+	/// @param parent The object will be the last child of the parent. If it's nullptr the object will be a root.
+	void setParent(Value* node, Value* parent);
+
+	U32 getSize() const
+	{
+		return m_nodes.getSize();
+	}
+
+	Value& operator[](U32 idx)
+	{
+		return *m_nodes[idx];
+	}
+
+	const Value& operator[](U32 idx) const
+	{
+		return *m_nodes[idx];
+	}
+
+	/// Get the index of an object in the depth first order.
+	U32 getIndex(const Value& node) const
+	{
+		const U32 idx = node.m_flatHierarchyIdx;
+		ANKI_ASSERT(idx < m_nodes.getSize() && m_nodes[idx] == &node);
+		return idx;
+	}
+
+	/// @return The index of the parent or NO_PARENT.
+	U32 getParentIndex(U32 idx) const
+	{
+		return m_parents[idx];
+	}
+
+	/// The object at idx and its subtree are the getSubtreeSize(idx) objects that start from idx.
+	U32 getSubtreeSize(U32 idx) const
+	{
+		return m_subtreeSizes[idx];
+	}
+
+	/// Iterate the children of the object at idx. It skips their subtrees.
+	template<typename TFunc>
+	void iterateChildren(U32 idx, TFunc func) const
+	{
+		const U32 end = idx + m_subtreeSizes[idx];
+		for(U32 child = idx + 1; child < end; child += m_subtreeSizes[child])
+		{
+			func(*m_nodes[child]);
+		}
+	}
+
+	Value* const* getBegin() const
+	{
+		return m_nodes.getBegin();
+	}
+
+	Value* const* getEnd() const
+	{
+		return m_nodes.getEnd();
+	}
+
+	/// Make it compatible with the C++11 range based for loop.
+	Value* const* begin() const
+	{
+		return getBegin();
+	}
+
+	/// Make it compatible with the C++11 range based for loop.
+	Value* const* end() const
+	{
+		return getEnd();
+	}
+
+private:
+	DynamicArray<Value*> m_nodes;
+	DynamicArray<U32> m_parents;
+	DynamicArray<U32> m_subtreeSizes;
+
+	/// Move the count objects that start from src before the object at before. It fixes the indices that change.
+	/// @return The new index of the first object.
+	U32 moveRange(U32 src, U32 count, U32 before);
+
+	/// Add to the subtree sizes of an object and its ancestors.
+	void addToSubtreeSizes(U32 idx, I32 count);
+};
+/// @}
+
+} // end namespace anki
+
+#include <anki/util/FlatHierarchy.inl.h>
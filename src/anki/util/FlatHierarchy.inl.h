@@ -0,0 +1,181 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <algorithm>
+
+namespace anki
+{
+
+template<typename T>
+constexpr U32 FlatHierarchy<T>::NO_PARENT;
+
+template<typename T>
+template<typename TAllocator>
+void FlatHierarchy<T>::destroy(TAllocator alloc)
+{
+	for(Value* node : m_nodes)
+	{
+		node->m_flatHierarchyIdx = MAX_U32;
+	}
+
+	m_nodes.destroy(alloc);
+	m_parents.destroy(alloc);
+	m_subtreeSizes.destroy(alloc);
+}
+
+template<typename T>
+template<typename TAllocator>
+void FlatHierarchy<T>::add(TAllocator alloc, Value* node, Value* parent)
+{
+	ANKI_ASSERT(node && node->m_flatHierarchyIdx == MAX_U32 && "Already added");
+
+	// Add it as a root and then move it
+	node->m_flatHierarchyIdx = m_nodes.getSize();
+	m_nodes.emplaceBack(alloc, node);
+	m_parents.emplaceBack(alloc, NO_PARENT);
+	m_subtreeSizes.emplaceBack(alloc, 1);
+
+	if(parent)
+	{
+		setParent(node, parent);
+	}
+}
+
+template<typename T>
+template<typename TAllocator>
+void FlatHierarchy<T>::remove(TAllocator alloc, Value* node)
+{
+	U32 idx = getIndex(*node);
+
+	// The first child is always right after the node
+	while(m_subtreeSizes[idx] > 1)
+	{
+		setParent(m_nodes[idx + 1], nullptr);
+		idx = getIndex(*node);
+	}
+
+	// Detach it and move it to the end
+	if(m_parents[idx] != NO_PARENT)
+	{
+		addToSubtreeSizes(m_parents[idx], -1);
+	}
+
+	moveRange(idx, 1, m_nodes.getSize());
+
+	m_nodes.popBack(alloc);
+	m_parents.popBack(alloc);
+	m_subtreeSizes.popBack(alloc);
+	node->m_flatHierarchyIdx = MAX_U32;
+}
+
+template<typename T>
+void FlatHierarchy<T>::setParent(Value* node, Value* parent)
+{
+	U32 idx = getIndex(*node);
+	const U32 count = m_subtreeSizes[idx];
+	ANKI_ASSERT((!parent || getIndex(*parent) < idx || getIndex(*parent) >= idx + count) && "Cyclic hierarchy");
+
+	// Detach the subtree and make it the last root
+	if(m_parents[idx] != NO_PARENT)
+	{
+		addToSubtreeSizes(m_parents[idx], -I32(count));
+		m_parents[idx] = NO_PARENT;
+	}
+
+	idx = moveRange(idx, count, m_nodes.getSize());
+
+	// Put it after the subtree of the parent
+	if(parent)
+	{
+		const U32 parentIdx = getIndex(*parent);
+		idx = moveRange(idx, count, parentIdx + m_subtreeSizes[parentIdx]);
+		m_parents[idx] = parentIdx;
+		addToSubtreeSizes(parentIdx, I32(count));
+	}
+}
+
+template<typename T>
+U32 FlatHierarchy<T>::moveRange(U32 src, U32 count, U32 before)
+{
+	ANKI_ASSERT(count > 0 && src + count <= m_nodes.getSize() && before <= m_nodes.getSize());
+	ANKI_ASSERT((before <= src || before >= src + count) && "Can't move inside itself");
+
+	if(before == src || before == src + count)
+	{
+		return src;
+	}
+
+	auto rotate = [&](U32 first, U32 middle, U32 last) {
+		std::rotate(m_nodes.getBegin() + first, m_nodes.getBegin() + middle, m_nodes.getBegin() + last);
+		std::rotate(m_parents.getBegin() + first, m_parents.getBegin() + middle, m_parents.getBegin() + last);
+		std::rotate(
+			m_subtreeSizes.getBegin() + first, m_subtreeSizes.getBegin() + middle, m_subtreeSizes.getBegin() + last);
+	};
+
+	// Rotate the part of the arrays that changes. The objects between the range and before shift by count
+	U32 first, last, newSrc;
+	if(before > src)
+	{
+		first = src;
+		last = before;
+		newSrc = before - count;
+		rotate(src, src + count, before);
+	}
+	else
+	{
+		first = before;
+		last = src + count;
+		newSrc = before;
+		rotate(before, src, src + count);
+	}
+
+	auto remap = [&](U32 idx) -> U32 {
+		if(idx >= src && idx < src + count)
+		{
+			return idx - src + newSrc;
+		}
+		else if(before > src && idx >= src + count && idx < before)
+		{
+			return idx - count;
+		}
+		else if(before < src && idx >= before && idx < src)
+		{
+			return idx + count;
+		}
+		else
+		{
+			return idx;
+		}
+	};
+
+	for(U32 i = first; i < last; ++i)
+	{
+		m_nodes[i]->m_flatHierarchyIdx = i;
+	}
+
+	// The parents come before their children so only the objects after the first changed one can point to the changed
+	// ones
+	for(U32 i = first; i < m_nodes.getSize(); ++i)
+	{
+		if(m_parents[i] != NO_PARENT)
+		{
+			m_parents[i] = remap(m_parents[i]);
+		}
+	}
+
+	return newSrc;
+}
+
+template<typename T>
+void FlatHierarchy<T>::addToSubtreeSizes(U32 idx, I32 count)
+{
+	for(; idx != NO_PARENT; idx = m_parents[idx])
+	{
+		ANKI_ASSERT(I32(m_subtreeSizes[idx]) + count > 0);
+		m_subtreeSizes[idx] = U32(I32(m_subtreeSizes[idx]) + count);
+	}
+}
+
+} // end namespace anki
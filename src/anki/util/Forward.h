@@ -18,6 +18,9 @@ class BitSet;
 template<typename T>
 class BitMask;
 
+template<typename T>
+class FlatHierarchy;
+
 template<typename, typename, typename>
 class HashMap;
 
@@ -5,6 +5,12 @@
 
 #include <anki/util/Hash.h>
 #include <anki/util/Assert.h>
+#include <anki/util/Array.h>
+#if ANKI_SIMD_SSE
+#	include <emmintrin.h>
+#elif ANKI_SIMD_NEON
+#	include <arm_neon.h>
+#endif
 
 namespace anki
 {
@@ -12,7 +18,296 @@ namespace anki
 constexpr U64 HASH_M = 0xc6a4a7935bd1e995;
 constexpr U64 HASH_R = 47;
 
-U64 appendHash(const void* buffer, PtrSize bufferSize, U64 h)
+constexpr U32 PRIME32_1 = 0x9E3779B1u;
+constexpr U32 PRIME32_2 = 0x85EBCA77u;
+constexpr U32 PRIME32_3 = 0xC2B2AE3Du;
+constexpr U64 PRIME64_1 = 0x9E3779B185EBCA87ull;
+constexpr U64 PRIME64_2 = 0xC2B2AE3D27D4EB4Full;
+constexpr U64 PRIME64_3 = 0x165667B19E3779F9ull;
+constexpr U64 PRIME64_4 = 0x85EBCA77C2B2AE63ull;
+constexpr U64 PRIME64_5 = 0x27D4EB2F165667C5ull;
+
+constexpr PtrSize SECRET_SIZE = 192;
+constexpr PtrSize STRIPE_SIZE = 64;
+constexpr PtrSize STRIPES_PER_BLOCK = (SECRET_SIZE - STRIPE_SIZE) / 8;
+constexpr PtrSize BLOCK_SIZE = STRIPE_SIZE * STRIPES_PER_BLOCK;
+constexpr PtrSize MID_SIZE_MAX = 240;
+
+/// The XXH3 secret. It's generated with splitmix64 so it's not the one of the reference implementation.
+alignas(16) static const Array<U64, SECRET_SIZE / sizeof(U64)> SECRET = {
+	{0x7D4E803DB3F3EF3Aull, detail::HASH_SECRET_1, detail::HASH_SECRET_2, detail::HASH_SECRET_3,
+		detail::HASH_SECRET_4, detail::HASH_SECRET_5, detail::HASH_SECRET_6, 0xBF2E437FBCE8DADEull,
+		0xF8E7B12CC9519CEFull, 0x4DD3F7615B75DC8Cull, 0x25B9225E9F4A79ECull, 0x34F5F1CEE4E3268Eull,
+		0xB11F04763A4F07FAull, 0x7C77E9A4C44187E6ull, 0x72ACDC8C1DFCF709ull, 0xBC9CB955CC82CD32ull,
+		0x2FA79DC1367DE662ull, 0x4EF9909F815CD33Full, 0xE394D62DA82F3404ull, 0x6EE1132EB691D0BDull,
+		0x25416C0C47FA110Cull, 0x0C5D756297A93DE3ull, 0x508FA73AD5BD00FCull, 0xCC047DDE49E549EEull}};
+
+static const U8* getSecret()
+{
+	return reinterpret_cast<const U8*>(&SECRET[0]);
+}
+
+static U64 xxh64Avalanche(U64 h)
+{
+	h ^= h >> 33;
+	h *= PRIME64_2;
+	h ^= h >> 29;
+	h *= PRIME64_3;
+	h ^= h >> 32;
+	return h;
+}
+
+static U64 hash1To3(const U8* in, PtrSize len, U64 seed)
+{
+	ANKI_ASSERT(len >= 1 && len <= 3);
+	const U32 c1 = in[0];
+	const U32 c2 = in[len >> 1];
+	const U32 c3 = in[len - 1];
+	const U32 combined = (c1 << 16) | (c2 << 24) | c3 | (U32(len) << 8);
+	const U64 bitflip = (detail::hashRead32(getSecret()) ^ detail::hashRead32(getSecret() + 4)) + seed;
+	return xxh64Avalanche(U64(combined) ^ bitflip);
+}
+
+static U64 mix16B(const U8* in, const U8* secret, U64 seed)
+{
+	const U64 lo = detail::hashRead64(in);
+	const U64 hi = detail::hashRead64(in + 8);
+	return detail::hashMul128Fold64(
+		lo ^ (detail::hashRead64(secret) + seed), hi ^ (detail::hashRead64(secret + 8) - seed));
+}
+
+static U64 hash17To128(const U8* in, PtrSize len, U64 seed)
+{
+	ANKI_ASSERT(len >= 17 && len <= 128);
+	const U8* secret = getSecret();
+	U64 acc = len * PRIME64_1;
+
+	if(len > 32)
+	{
+		if(len > 64)
+		{
+			if(len > 96)
+			{
+				acc += mix16B(in + 48, secret + 96, seed);
+				acc += mix16B(in + len - 64, secret + 112, seed);
+			}
+			acc += mix16B(in + 32, secret + 64, seed);
+			acc += mix16B(in + len - 48, secret + 80, seed);
+		}
+		acc += mix16B(in + 16, secret + 32, seed);
+		acc += mix16B(in + len - 32, secret + 48, seed);
+	}
+	acc += mix16B(in, secret, seed);
+	acc += mix16B(in + len - 16, secret + 16, seed);
+
+	return detail::hashAvalanche(acc);
+}
+
+static U64 hash129To240(const U8* in, PtrSize len, U64 seed)
+{
+	ANKI_ASSERT(len >= 129 && len <= MID_SIZE_MAX);
+	const U8* secret = getSecret();
+	U64 acc = len * PRIME64_1;
+	const U32 roundCount = U32(len / 16);
+
+	for(U32 i = 0; i < 8; ++i)
+	{
+		acc += mix16B(in + 16 * i, secret + 16 * i, seed);
+	}
+	acc = detail::hashAvalanche(acc);
+
+	for(U32 i = 8; i < roundCount; ++i)
+	{
+		acc += mix16B(in + 16 * i, secret + 16 * (i - 8) + 3, seed);
+	}
+
+	// Last 16 bytes
+	acc += mix16B(in + len - 16, secret + SECRET_SIZE - 16 - 7, seed);
+
+	return detail::hashAvalanche(acc);
+}
+
+/// Accumulate a 64 byte stripe.
+static void accumulate512(U64* ANKI_RESTRICT acc, const U8* ANKI_RESTRICT in, const U8* ANKI_RESTRICT secret)
+{
+#if ANKI_SIMD_SSE
+	__m128i* const xacc = reinterpret_cast<__m128i*>(acc);
+	for(U32 i = 0; i < STRIPE_SIZE / 16; ++i)
+	{
+		const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in) + i);
+		const __m128i key = _mm_loadu_si128(reinterpret_cast<const __m128i*>(secret) + i);
+		const __m128i dataKey = _mm_xor_si128(data, key);
+		const __m128i dataKeyHi = _mm_shuffle_epi32(dataKey, _MM_SHUFFLE(0, 3, 0, 1));
+		const __m128i product = _mm_mul_epu32(dataKey, dataKeyHi);
+		const __m128i dataSwap = _mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+		xacc[i] = _mm_add_epi64(product, _mm_add_epi64(xacc[i], dataSwap));
+	}
+#elif ANKI_SIMD_NEON
+	for(U32 i = 0; i < STRIPE_SIZE / 16; ++i)
+	{
+		const uint64x2_t data = vreinterpretq_u64_u8(vld1q_u8(in + 16 * i));
+		const uint64x2_t key = vreinterpretq_u64_u8(vld1q_u8(secret + 16 * i));
+		const uint64x2_t dataKey = veorq_u64(data, key);
+		const uint32x2_t dataKeyLo = vmovn_u64(dataKey);
+		const uint32x2_t dataKeyHi = vshrn_n_u64(dataKey, 32);
+		const uint64x2_t dataSwap = vextq_u64(data, data, 1);
+		uint64x2_t a = vld1q_u64(acc + 2 * i);
+		a = vaddq_u64(a, dataSwap);
+		a = vmlal_u32(a, dataKeyLo, dataKeyHi);
+		vst1q_u64(acc + 2 * i, a);
+	}
+#else
+	for(U32 i = 0; i < 8; ++i)
+	{
+		const U64 data = detail::hashRead64(in + 8 * i);
+		const U64 dataKey = data ^ detail::hashRead64(secret + 8 * i);
+		acc[i ^ 1] += data;
+		acc[i] += U64(U32(dataKey)) * (dataKey >> 32);
+	}
+#endif
+}
+
+/// Scramble the accumulators at the end of every block.
+static void scramble(U64* ANKI_RESTRICT acc, const U8* ANKI_RESTRICT secret)
+{
+#if ANKI_SIMD_SSE
+	__m128i* const xacc = reinterpret_cast<__m128i*>(acc);
+	const __m128i prime = _mm_set1_epi32(I32(PRIME32_1));
+	for(U32 i = 0; i < STRIPE_SIZE / 16; ++i)
+	{
+		__m128i a = xacc[i];
+		a = _mm_xor_si128(a, _mm_srli_epi64(a, 47));
+		a = _mm_xor_si128(a, _mm_loadu_si128(reinterpret_cast<const __m128i*>(secret) + i));
+
+		// 64bit x 32bit multiplication
+		const __m128i aHi = _mm_shuffle_epi32(a, _MM_SHUFFLE(0, 3, 0, 1));
+		const __m128i productLo = _mm_mul_epu32(a, prime);
+		const __m128i productHi = _mm_mul_epu32(aHi, prime);
+		xacc[i] = _mm_add_epi64(productLo, _mm_slli_epi64(productHi, 32));
+	}
+#elif ANKI_SIMD_NEON
+	const uint32x2_t prime = vdup_n_u32(PRIME32_1);
+	for(U32 i = 0; i < STRIPE_SIZE / 16; ++i)
+	{
+		uint64x2_t a = vld1q_u64(acc + 2 * i);
+		a = veorq_u64(a, vshrq_n_u64(a, 47));
+		a = veorq_u64(a, vreinterpretq_u64_u8(vld1q_u8(secret + 16 * i)));
+
+		// 64bit x 32bit multiplication
+		const uint32x2_t aLo = vmovn_u64(a);
+		const uint32x2_t aHi = vshrn_n_u64(a, 32);
+		const uint64x2_t productHi = vshlq_n_u64(vmull_u32(aHi, prime), 32);
+		vst1q_u64(acc + 2 * i, vmlal_u32(productHi, aLo, prime));
+	}
+#else
+	for(U32 i = 0; i < 8; ++i)
+	{
+		U64 a = acc[i];
+		a ^= a >> 47;
+		a ^= detail::hashRead64(secret + 8 * i);
+		a *= PRIME32_1;
+		acc[i] = a;
+	}
+#endif
+}
+
+static U64 hashLong(const U8* in, PtrSize len, U64 seed)
+{
+	ANKI_ASSERT(len > MID_SIZE_MAX);
+
+	// Derive a secret from the seed
+	alignas(16) Array<U64, SECRET_SIZE / sizeof(U64)> customSecret;
+	const U8* secret;
+	if(seed == 0)
+	{
+		secret = getSecret();
+	}
+	else
+	{
+		for(U32 i = 0; i < customSecret.getSize(); i += 2)
+		{
+			customSecret[i] = SECRET[i] + seed;
+			customSecret[i + 1] = SECRET[i + 1] - seed;
+		}
+		secret = reinterpret_cast<const U8*>(&customSecret[0]);
+	}
+
+	alignas(16) Array<U64, 8> acc = {
+		{PRIME32_3, PRIME64_1, PRIME64_2, PRIME64_3, PRIME64_4, PRIME32_2, PRIME64_5, PRIME32_1}};
+
+	// Full blocks
+	const PtrSize blockCount = (len - 1) / BLOCK_SIZE;
+	for(PtrSize b = 0; b < blockCount; ++b)
+	{
+		const U8* block = in + b * BLOCK_SIZE;
+		for(PtrSize s = 0; s < STRIPES_PER_BLOCK; ++s)
+		{
+			accumulate512(&acc[0], block + s * STRIPE_SIZE, secret + s * 8);
+		}
+		scramble(&acc[0], secret + SECRET_SIZE - STRIPE_SIZE);
+	}
+
+	// Last partial block
+	const PtrSize stripeCount = ((len - 1) - BLOCK_SIZE * blockCount) / STRIPE_SIZE;
+	const U8* block = in + blockCount * BLOCK_SIZE;
+	for(PtrSize s = 0; s < stripeCount; ++s)
+	{
+		accumulate512(&acc[0], block + s * STRIPE_SIZE, secret + s * 8);
+	}
+
+	// Last stripe
+	accumulate512(&acc[0], in + len - STRIPE_SIZE, secret + SECRET_SIZE - STRIPE_SIZE - 7);
+
+	// Merge the accumulators
+	U64 result = len * PRIME64_1;
+	for(U32 i = 0; i < 4; ++i)
+	{
+		const U8* key = secret + 11 + 16 * i;
+		result += detail::hashMul128Fold64(
+			acc[2 * i] ^ detail::hashRead64(key), acc[2 * i + 1] ^ detail::hashRead64(key + 8));
+	}
+
+	return detail::hashAvalanche(result);
+}
+
+U64 detail::computeHashXxh3(const void* buffer, PtrSize bufferSize, U64 seed)
+{
+	const U8* in = static_cast<const U8*>(buffer);
+
+	if(bufferSize <= 16)
+	{
+		if(bufferSize > 8)
+		{
+			return hash9To16(in, bufferSize, seed);
+		}
+		else if(bufferSize >= 4)
+		{
+			return hash4To8(in, bufferSize, seed);
+		}
+		else if(bufferSize > 0)
+		{
+			return hash1To3(in, bufferSize, seed);
+		}
+		else
+		{
+			return xxh64Avalanche(seed ^ (SECRET[7] ^ SECRET[8]));
+		}
+	}
+	else if(bufferSize <= 128)
+	{
+		return hash17To128(in, bufferSize, seed);
+	}
+	else if(bufferSize <= MID_SIZE_MAX)
+	{
+		return hash129To240(in, bufferSize, seed);
+	}
+	else
+	{
+		return hashLong(in, bufferSize, seed);
+	}
+}
+
+U64 detail::appendHashMurmur2(const void* buffer, PtrSize bufferSize, U64 h)
 {
 	const U64* data = static_cast<const U64*>(buffer);
 	const U64* const end = data + (bufferSize / sizeof(U64));
@@ -58,10 +353,32 @@ U64 appendHash(const void* buffer, PtrSize bufferSize, U64 h)
 	return h;
 }
 
-U64 computeHash(const void* buffer, PtrSize bufferSize, U64 seed)
+U64 computeHash(HashVersion version, const void* buffer, PtrSize bufferSize, U64 seed)
 {
-	const U64 h = seed ^ (bufferSize * HASH_M);
-	return appendHash(buffer, bufferSize, h);
+	switch(version)
+	{
+	case HashVersion::MURMUR2:
+		return detail::appendHashMurmur2(buffer, bufferSize, seed ^ (bufferSize * HASH_M));
+	case HashVersion::XXH3:
+		return computeHash(buffer, bufferSize, seed);
+	default:
+		ANKI_ASSERT(0);
+		return 0;
+	}
+}
+
+U64 appendHash(HashVersion version, const void* buffer, PtrSize bufferSize, U64 prevHash)
+{
+	switch(version)
+	{
+	case HashVersion::MURMUR2:
+		return detail::appendHashMurmur2(buffer, bufferSize, prevHash);
+	case HashVersion::XXH3:
+		return appendHash(buffer, bufferSize, prevHash);
+	default:
+		ANKI_ASSERT(0);
+		return 0;
+	}
 }
 
 } // end namespace anki
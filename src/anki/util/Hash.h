@@ -6,6 +6,11 @@
 #pragma once
 
 #include <anki/util/StdTypes.h>
+#include <anki/util/Assert.h>
+#include <cstring>
+#if ANKI_COMPILER_MSVC
+#	include <intrin.h>
+#endif
 
 namespace anki
 {
@@ -13,19 +18,171 @@ namespace anki
 /// @addtogroup util_other
 /// @{
 
-/// Computes a hash of a buffer. This function implements the MurmurHash2 algorithm by Austin Appleby.
+/// The hash algorithms. The hashes that are stored on disk should use a fixed version so they don't change when
+/// LATEST does.
+enum class HashVersion : U8
+{
+	MURMUR2, ///< MurmurHash2 by Austin Appleby. What the old computeHash() used to be.
+	XXH3, ///< A hash with the structure of xxHash3. It has its own secret so it's not compatible with other XXH3s.
+
+	LATEST = XXH3
+};
+
+namespace detail
+{
+
+/// The first words of the XXH3 secret that the small key paths need. The rest is in Hash.cpp.
+constexpr U64 HASH_SECRET_1 = 0x4D31DF86CEA0F158ull;
+constexpr U64 HASH_SECRET_2 = 0x0032A6CF4AA7FDADull;
+constexpr U64 HASH_SECRET_3 = 0xAAEE394B96B3938Dull;
+constexpr U64 HASH_SECRET_4 = 0x2A28C094C2236F2Full;
+constexpr U64 HASH_SECRET_5 = 0x5958122706CDEA24ull;
+constexpr U64 HASH_SECRET_6 = 0x05290BA6EC2415B4ull;
+
+inline U64 hashRead64(const void* p)
+{
+	U64 v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+inline U32 hashRead32(const void* p)
+{
+	U32 v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+inline U32 hashSwap32(U32 x)
+{
+#if ANKI_COMPILER_MSVC
+	return _byteswap_ulong(x);
+#else
+	return __builtin_bswap32(x);
+#endif
+}
+
+inline U64 hashSwap64(U64 x)
+{
+#if ANKI_COMPILER_MSVC
+	return _byteswap_uint64(x);
+#else
+	return __builtin_bswap64(x);
+#endif
+}
+
+inline U64 hashRotl64(U64 x, U32 r)
+{
+	return (x << r) | (x >> (64 - r));
+}
+
+/// Multiply two 64bit numbers into 128bits and fold the halves.
+inline U64 hashMul128Fold64(U64 a, U64 b)
+{
+#if ANKI_COMPILER_MSVC
+	U64 hi;
+	const U64 lo = _umul128(a, b, &hi);
+	return lo ^ hi;
+#else
+	// __extension__ keeps -pedantic quiet about __int128
+	__extension__ typedef unsigned __int128 U128;
+	const U128 product = U128(a) * b;
+	return U64(product) ^ U64(product >> 64);
+#endif
+}
+
+inline U64 hashAvalanche(U64 h)
+{
+	h ^= h >> 37;
+	h *= 0x165667919E3779F9ull;
+	h ^= h >> 32;
+	return h;
+}
+
+/// Hash 4 to 8 bytes.
+inline U64 hash4To8(const U8* in, PtrSize len, U64 seed)
+{
+	ANKI_ASSERT(len >= 4 && len <= 8);
+	seed ^= U64(hashSwap32(U32(seed))) << 32;
+	const U64 input64 = U64(hashRead32(in + len - 4)) + (U64(hashRead32(in)) << 32);
+	U64 h = input64 ^ ((HASH_SECRET_1 ^ HASH_SECRET_2) - seed);
+	h ^= hashRotl64(h, 49) ^ hashRotl64(h, 24);
+	h *= 0x9FB21C651E98DF25ull;
+	h ^= (h >> 35) + len;
+	h *= 0x9FB21C651E98DF25ull;
+	h ^= h >> 28;
+	return h;
+}
+
+/// Hash 9 to 16 bytes.
+inline U64 hash9To16(const U8* in, PtrSize len, U64 seed)
+{
+	ANKI_ASSERT(len >= 9 && len <= 16);
+	const U64 lo = hashRead64(in) ^ ((HASH_SECRET_3 ^ HASH_SECRET_4) + seed);
+	const U64 hi = hashRead64(in + len - 8) ^ ((HASH_SECRET_5 ^ HASH_SECRET_6) - seed);
+	const U64 acc = len + hashSwap64(lo) + hi + hashMul128Fold64(lo, hi);
+	return hashAvalanche(acc);
+}
+
+/// The generic XXH3 path.
+ANKI_USE_RESULT U64 computeHashXxh3(const void* buffer, PtrSize bufferSize, U64 seed);
+
+/// The MurmurHash2 path.
+ANKI_USE_RESULT U64 appendHashMurmur2(const void* buffer, PtrSize bufferSize, U64 prevHash);
+
+} // end namespace detail
+
+/// Computes a hash of a buffer using HashVersion::LATEST. Keys of 8 and 16 bytes have a cheaper path that gets
+/// inlined when the size is known at compile time.
+/// @param[in] buffer The buffer to hash.
+/// @param bufferSize The size of the buffer.
+/// @param seed A unique seed.
+/// @return The hash.
+ANKI_USE_RESULT inline U64 computeHash(const void* buffer, PtrSize bufferSize, U64 seed = 123)
+{
+	U64 h;
+	if(bufferSize == 8)
+	{
+		h = detail::hash4To8(static_cast<const U8*>(buffer), 8, seed);
+	}
+	else if(bufferSize == 16)
+	{
+		h = detail::hash9To16(static_cast<const U8*>(buffer), 16, seed);
+	}
+	else
+	{
+		h = detail::computeHashXxh3(buffer, bufferSize, seed);
+	}
+
+	ANKI_ASSERT(h != 0);
+	return h;
+}
+
+/// Computes a hash of a buffer and combine it with a previous hash. Uses HashVersion::LATEST.
+/// @param[in] buffer The buffer to hash.
+/// @param bufferSize The size of the buffer.
+/// @param prevHash The hash to append to.
+/// @return The new hash.
+ANKI_USE_RESULT inline U64 appendHash(const void* buffer, PtrSize bufferSize, U64 prevHash)
+{
+	return computeHash(buffer, bufferSize, prevHash);
+}
+
+/// Computes a hash of a buffer using a specific algorithm.
+/// @param version The algorithm.
 /// @param[in] buffer The buffer to hash.
 /// @param bufferSize The size of the buffer.
 /// @param seed A unique seed.
 /// @return The hash.
-ANKI_USE_RESULT U64 computeHash(const void* buffer, PtrSize bufferSize, U64 seed = 123);
+ANKI_USE_RESULT U64 computeHash(HashVersion version, const void* buffer, PtrSize bufferSize, U64 seed = 123);
 
-/// Computes a hash of a buffer. This function implements the MurmurHash2 algorithm by Austin Appleby.
+/// Computes a hash of a buffer and combine it with a previous hash using a specific algorithm.
+/// @param version The algorithm.
 /// @param[in] buffer The buffer to hash.
 /// @param bufferSize The size of the buffer.
 /// @param prevHash The hash to append to.
 /// @return The new hash.
-ANKI_USE_RESULT U64 appendHash(const void* buffer, PtrSize bufferSize, U64 prevHash);
+ANKI_USE_RESULT U64 appendHash(HashVersion version, const void* buffer, PtrSize bufferSize, U64 prevHash);
 /// @}
 
 } // end namespace anki
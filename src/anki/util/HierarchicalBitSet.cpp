@@ -0,0 +1,186 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/util/HierarchicalBitSet.h>
+#include <anki/util/Functions.h>
+#if ANKI_SIMD_SSE
+#	include <emmintrin.h>
+#elif ANKI_SIMD_NEON
+#	include <arm_neon.h>
+#endif
+
+namespace anki
+{
+
+namespace
+{
+
+enum class BitOp : U8
+{
+	AND,
+	OR
+};
+
+/// Combine 2 words (128 bits) at a time. The pointers are 16 bytes aligned.
+template<BitOp OP>
+void combineWords(HierarchicalBitSet::Word* a, const HierarchicalBitSet::Word* b, U32 count)
+{
+	ANKI_ASSERT(isAligned(16, a) && isAligned(16, b) && (count % 2) == 0);
+
+	for(U32 i = 0; i < count; i += 2)
+	{
+#if ANKI_SIMD_SSE
+		const __m128i va = _mm_load_si128(reinterpret_cast<const __m128i*>(a + i));
+		const __m128i vb = _mm_load_si128(reinterpret_cast<const __m128i*>(b + i));
+		const __m128i r = (OP == BitOp::AND) ? _mm_and_si128(va, vb) : _mm_or_si128(va, vb);
+		_mm_store_si128(reinterpret_cast<__m128i*>(a + i), r);
+#elif ANKI_SIMD_NEON
+		const uint64x2_t va = vld1q_u64(a + i);
+		const uint64x2_t vb = vld1q_u64(b + i);
+		vst1q_u64(a + i, (OP == BitOp::AND) ? vandq_u64(va, vb) : vorrq_u64(va, vb));
+#else
+		a[i] = (OP == BitOp::AND) ? (a[i] & b[i]) : (a[i] | b[i]);
+		a[i + 1] = (OP == BitOp::AND) ? (a[i + 1] & b[i + 1]) : (a[i + 1] | b[i + 1]);
+#endif
+	}
+}
+
+} // end anonymous namespace
+
+void HierarchicalBitSet::unsetAll()
+{
+	memset(m_words, 0, (m_wordCount + m_summaryWordCount) * sizeof(Word));
+}
+
+Bool HierarchicalBitSet::getAny() const
+{
+	for(U32 s = 0; s < m_summaryWordCount; ++s)
+	{
+		if(m_summary[s] != 0)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+U32 HierarchicalBitSet::getEnabledBitCount() const
+{
+	U32 count = 0;
+	for(U32 s = 0; s < m_summaryWordCount; ++s)
+	{
+		Word summary = m_summary[s];
+		while(summary != 0)
+		{
+			const U32 w = s * WORD_BIT_COUNT + U32(__builtin_ctzll(summary));
+			count += U32(__builtin_popcountll(m_words[w]));
+			summary &= summary - 1;
+		}
+	}
+
+	return count;
+}
+
+U32 HierarchicalBitSet::findFirstSet(U32 from) const
+{
+	if(from >= m_bitCount)
+	{
+		return MAX_U32;
+	}
+
+	// Look at the word of the bit first
+	U32 w = from / WORD_BIT_COUNT;
+	const Word bits = m_words[w] & (~Word(0) << Word(from % WORD_BIT_COUNT));
+	if(bits != 0)
+	{
+		return w * WORD_BIT_COUNT + U32(__builtin_ctzll(bits));
+	}
+
+	// Then use the summary to find the next non-zero word
+	++w;
+	if(w >= m_wordCount)
+	{
+		return MAX_U32;
+	}
+
+	U32 s = w / WORD_BIT_COUNT;
+	Word summary = m_summary[s] & (~Word(0) << Word(w % WORD_BIT_COUNT));
+	while(summary == 0)
+	{
+		if(++s >= m_summaryWordCount)
+		{
+			return MAX_U32;
+		}
+
+		summary = m_summary[s];
+	}
+
+	w = s * WORD_BIT_COUNT + U32(__builtin_ctzll(summary));
+	ANKI_ASSERT(m_words[w] != 0);
+	return w * WORD_BIT_COUNT + U32(__builtin_ctzll(m_words[w]));
+}
+
+void HierarchicalBitSet::rebuildSummary(U32 s)
+{
+	const U32 begin = s * WORD_BIT_COUNT;
+	const U32 end = min(begin + WORD_BIT_COUNT, m_wordCount);
+
+	Word summary = 0;
+	for(U32 w = begin; w < end; ++w)
+	{
+		summary |= Word(m_words[w] != 0) << Word(w - begin);
+	}
+
+	m_summary[s] = summary;
+}
+
+void HierarchicalBitSet::andWith(const HierarchicalBitSet& b)
+{
+	ANKI_ASSERT(m_bitCount == b.m_bitCount);
+
+	for(U32 s = 0; s < m_summaryWordCount; ++s)
+	{
+		if(m_summary[s] == 0)
+		{
+			// Nothing to do, all are zero
+			continue;
+		}
+
+		const U32 begin = s * WORD_BIT_COUNT;
+		const U32 count = min(WORD_BIT_COUNT, m_wordCount - begin);
+		if((m_summary[s] & b.m_summary[s]) == 0)
+		{
+			// No common bits
+			memset(m_words + begin, 0, count * sizeof(Word));
+			m_summary[s] = 0;
+			continue;
+		}
+
+		combineWords<BitOp::AND>(m_words + begin, b.m_words + begin, count);
+		rebuildSummary(s);
+	}
+}
+
+void HierarchicalBitSet::orWith(const HierarchicalBitSet& b)
+{
+	ANKI_ASSERT(m_bitCount == b.m_bitCount);
+
+	for(U32 s = 0; s < m_summaryWordCount; ++s)
+	{
+		if(b.m_summary[s] == 0)
+		{
+			// Nothing to add
+			continue;
+		}
+
+		const U32 begin = s * WORD_BIT_COUNT;
+		const U32 count = min(WORD_BIT_COUNT, m_wordCount - begin);
+		combineWords<BitOp::OR>(m_words + begin, b.m_words + begin, count);
+		m_summary[s] |= b.m_summary[s];
+	}
+}
+
+} // end namespace anki
@@ -0,0 +1,190 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/util/Allocator.h>
+#include <utility>
+
+namespace anki
+{
+
+/// @addtogroup util_containers
+/// @{
+
+/// A dynamically sized bitset with a summary level on top of it. Every bit of the summary tells if a 64bit word of the
+/// bitset is non-zero. Finding and iterating the set bits skips whole empty ranges so it's meant for big and sparse
+/// masks, like the visibility results of many objects. The bulk operations use SIMD.
+class HierarchicalBitSet
+{
+public:
+	using Word = U64;
+
+	static constexpr U32 WORD_BIT_COUNT = sizeof(Word) * 8;
+
+	HierarchicalBitSet() = default;
+
+	// Non-copyable
+	HierarchicalBitSet(const HierarchicalBitSet&) = delete;
+
+	/// Move.
+	HierarchicalBitSet(HierarchicalBitSet&& b)
+	{
+		*this = std::move(b);
+	}
+
+	~HierarchicalBitSet()
+	{
+		ANKI_ASSERT(m_words == nullptr && "Requires manual destruction");
+	}
+
+	// Non-copyable
+	HierarchicalBitSet& operator=(const HierarchicalBitSet&) = delete;
+
+	/// Move.
+	HierarchicalBitSet& operator=(HierarchicalBitSet&& b)
+	{
+		ANKI_ASSERT(m_words == nullptr && "Requires manual destruction");
+		m_words = b.m_words;
+		m_summary = b.m_summary;
+		m_bitCount = b.m_bitCount;
+		m_wordCount = b.m_wordCount;
+		m_summaryWordCount = b.m_summaryWordCount;
+		b.m_words = nullptr;
+		b.m_summary = nullptr;
+		b.m_bitCount = b.m_wordCount = b.m_summaryWordCount = 0;
+		return *this;
+	}
+
+	/// Allocate the bits. They are all unset.
+	template<typename TAllocator>
+	void create(TAllocator alloc, U32 bitCount);
+
+	template<typename TAllocator>
+	void destroy(TAllocator alloc);
+
+	/// Get the number of bits.
+	U32 getSize() const
+	{
+		return m_bitCount;
+	}
+
+	/// Set or unset a bit.
+	void set(U32 bit, Bool setBit = true)
+	{
+		ANKI_ASSERT(bit < m_bitCount);
+		const U32 w = bit / WORD_BIT_COUNT;
+		const Word mask = Word(1) << Word(bit % WORD_BIT_COUNT);
+		m_words[w] = (setBit) ? (m_words[w] | mask) : (m_words[w] & ~mask);
+		updateSummary(w);
+	}
+
+	/// Unset a bit.
+	void unset(U32 bit)
+	{
+		set(bit, false);
+	}
+
+	/// Return true if the bit is set.
+	Bool get(U32 bit) const
+	{
+		ANKI_ASSERT(bit < m_bitCount);
+		return (m_words[bit / WORD_BIT_COUNT] & (Word(1) << Word(bit % WORD_BIT_COUNT))) != 0;
+	}
+
+	/// Unset all bits.
+	void unsetAll();
+
+	/// Return true if any bit is set. It only looks at the summary.
+	Bool getAny() const;
+
+	/// Count the set bits.
+	U32 getEnabledBitCount() const;
+
+	/// Find the first set bit that is equal or after @a from. Return MAX_U32 if there is none.
+	U32 findFirstSet(U32 from = 0) const;
+
+	/// Call a functor for every set bit in ascending order.
+	/// @code
+	/// bitset.iterateSetBits([&](U32 bit) { ... });
+	/// @endcode
+	template<typename TFunc>
+	void iterateSetBits(TFunc func) const
+	{
+		for(U32 s = 0; s < m_summaryWordCount; ++s)
+		{
+			Word summary = m_summary[s];
+			while(summary != 0)
+			{
+				const U32 w = s * WORD_BIT_COUNT + U32(__builtin_ctzll(summary));
+				Word bits = m_words[w];
+				ANKI_ASSERT(bits != 0 && "Summary is out of sync");
+				while(bits != 0)
+				{
+					func(w * WORD_BIT_COUNT + U32(__builtin_ctzll(bits)));
+					bits &= bits - 1;
+				}
+
+				summary &= summary - 1;
+			}
+		}
+	}
+
+	/// Bitwise and with a bitset of the same size.
+	void andWith(const HierarchicalBitSet& b);
+
+	/// Bitwise or with a bitset of the same size.
+	void orWith(const HierarchicalBitSet& b);
+
+private:
+	Word* m_words = nullptr;
+	Word* m_summary = nullptr; ///< It's in the same allocation as the m_words.
+	U32 m_bitCount = 0;
+	U32 m_wordCount = 0; ///< It's rounded up to what a SIMD register holds.
+	U32 m_summaryWordCount = 0;
+
+	void updateSummary(U32 w)
+	{
+		const Word mask = Word(1) << Word(w % WORD_BIT_COUNT);
+		Word& summary = m_summary[w / WORD_BIT_COUNT];
+		summary = (m_words[w] != 0) ? (summary | mask) : (summary & ~mask);
+	}
+
+	/// Re-compute the summary of WORD_BIT_COUNT words.
+	void rebuildSummary(U32 s);
+
+	static constexpr U32 SIMD_WORD_COUNT = 2;
+};
+
+template<typename TAllocator>
+inline void HierarchicalBitSet::create(TAllocator alloc, U32 bitCount)
+{
+	ANKI_ASSERT(m_words == nullptr && bitCount > 0);
+
+	m_bitCount = bitCount;
+	m_wordCount = (bitCount + WORD_BIT_COUNT - 1) / WORD_BIT_COUNT;
+	m_wordCount = (m_wordCount + SIMD_WORD_COUNT - 1) / SIMD_WORD_COUNT * SIMD_WORD_COUNT;
+	m_summaryWordCount = (m_wordCount + WORD_BIT_COUNT - 1) / WORD_BIT_COUNT;
+
+	const PtrSize size = (m_wordCount + m_summaryWordCount) * sizeof(Word);
+	m_words = static_cast<Word*>(alloc.getMemoryPool().allocate(size, SIMD_WORD_COUNT * sizeof(Word)));
+	memset(m_words, 0, size);
+	m_summary = m_words + m_wordCount;
+}
+
+template<typename TAllocator>
+inline void HierarchicalBitSet::destroy(TAllocator alloc)
+{
+	if(m_words)
+	{
+		alloc.getMemoryPool().free(m_words);
+		m_words = nullptr;
+		m_summary = nullptr;
+		m_bitCount = m_wordCount = m_summaryWordCount = 0;
+	}
+}
+/// @}
+
+} // end namespace anki
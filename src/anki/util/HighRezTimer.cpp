@@ -5,6 +5,10 @@
 
 #include <anki/util/HighRezTimer.h>
 #include <anki/util/Assert.h>
+#include <thread>
+#if ANKI_SIMD_SSE
+#	include <xmmintrin.h>
+#endif
 
 namespace anki
 {
@@ -34,4 +38,41 @@ Second HighRezTimer::getElapsedTime() const
 	}
 }
 
+void HighRezTimer::preciseSleep(Second seconds, Second spinTime)
+{
+	ANKI_ASSERT(seconds >= 0.0 && spinTime >= 0.0);
+	sleepUntil(getCurrentTime() + seconds, spinTime);
+}
+
+void HighRezTimer::sleepUntil(Second time, Second spinTime)
+{
+	ANKI_ASSERT(spinTime >= 0.0);
+
+	// Coarse sleep. The OS may oversleep so leave some time to spin
+	Second now = getCurrentTime();
+	if(time - now > spinTime)
+	{
+		sleep(time - now - spinTime);
+		now = getCurrentTime();
+	}
+
+	// Spin for the rest
+	for(U32 spinCount = 0; now < time; ++spinCount)
+	{
+		if(spinCount < 16)
+		{
+#if ANKI_SIMD_SSE
+			_mm_pause();
+#endif
+		}
+		else
+		{
+			std::this_thread::yield();
+			spinCount = 0;
+		}
+
+		now = getCurrentTime();
+	}
+}
+
 } // end namespace anki
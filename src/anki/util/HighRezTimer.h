@@ -32,6 +32,15 @@ public:
 	/// Micro sleep. The resolution is in nanoseconds.
 	static void sleep(Second seconds);
 
+	/// Sleep with high accuracy. It sleeps using sleep() for most of the time and it spins for the last @a spinTime
+	/// seconds to hide the granularity of the OS scheduler.
+	static void preciseSleep(Second seconds, Second spinTime = DEFAULT_SPIN_TIME);
+
+	/// Same as preciseSleep() but it sleeps until an absolute time returned by getCurrentTime().
+	static void sleepUntil(Second time, Second spinTime = DEFAULT_SPIN_TIME);
+
+	static constexpr Second DEFAULT_SPIN_TIME = 2.0_ms;
+
 private:
 	Second m_startTime = 0.0;
 	Second m_stopTime = 0.0;
@@ -37,16 +37,17 @@ DummyInitTimer init;
 
 } // end namespace anonymous
 
-static U64 getMs()
+static U64 getUs()
 {
 	LARGE_INTEGER now;
 	QueryPerformanceCounter(&now);
 
 	now.QuadPart -= init.m_start.QuadPart;
-	now.QuadPart *= 1000;
-	now.QuadPart /= init.m_ticksPerSec.QuadPart;
 
-	return now.QuadPart;
+	// Split the division to avoid overflowing the multiplication
+	const U64 sec = now.QuadPart / init.m_ticksPerSec.QuadPart;
+	const U64 rem = now.QuadPart % init.m_ticksPerSec.QuadPart;
+	return sec * 1000000 + rem * 1000000 / init.m_ticksPerSec.QuadPart;
 }
 
 void HighRezTimer::sleep(Second sec)
@@ -56,8 +57,7 @@ void HighRezTimer::sleep(Second sec)
 
 Second HighRezTimer::getCurrentTime()
 {
-	// Second(ticks) / 1000.0
-	return Second(getMs()) * 0.001;
+	return Second(getUs()) * 1e-6;
 }
 
 } // end namespace anki
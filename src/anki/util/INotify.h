@@ -6,6 +6,8 @@
 #pragma once
 
 #include <anki/util/String.h>
+#include <anki/util/StringList.h>
+#include <anki/util/DynamicArray.h>
 
 namespace anki
 {
@@ -32,26 +34,55 @@ public:
 	INotify& operator=(const INotify&) = delete;
 
 	/// @param path Path to file or directory.
-	ANKI_USE_RESULT Error init(GenericMemoryPoolAllocator<U8> alloc, CString path)
+	/// @param recursive If true and @a path is a directory watch its subdirectories as well.
+	ANKI_USE_RESULT Error init(GenericMemoryPoolAllocator<U8> alloc, CString path, Bool recursive = false)
 	{
 		m_alloc = alloc;
 		m_path.create(alloc, path);
+		m_recursive = recursive;
 		return initInternal();
 	}
 
 	/// Check if the file was modified in any way.
-	ANKI_USE_RESULT Error pollEvents(Bool& modified);
+	ANKI_USE_RESULT Error pollEvents(Bool& modified)
+	{
+		return pollEventsInternal(modified, nullptr);
+	}
+
+	/// Gather the files that were modified, created or deleted since the last poll. The paths are appended to
+	/// @a changedFiles and they are prefixed by the path given in init(). A file may appear more than once.
+	ANKI_USE_RESULT Error pollEvents(StringListAuto& changedFiles)
+	{
+		Bool modified;
+		return pollEventsInternal(modified, &changedFiles);
+	}
+
+	CString getPath() const
+	{
+		return m_path.toCString();
+	}
 
 private:
 	GenericMemoryPoolAllocator<U8> m_alloc;
 	String m_path;
+	Bool m_recursive = false;
 #if ANKI_OS_LINUX
+	class Watch
+	{
+	public:
+		String m_path; ///< Empty if it's the root.
+		int m_watch = -1;
+	};
+
 	int m_fd = -1;
-	int m_watch = -1;
+	DynamicArray<Watch> m_watches;
+
+	ANKI_USE_RESULT Error addWatch(CString relativePath);
 #endif
 
 	void destroyInternal();
 	ANKI_USE_RESULT Error initInternal();
+	ANKI_USE_RESULT Error pollEventsInternal(Bool& modified, StringListAuto* changedFiles);
 };
 /// @}
 
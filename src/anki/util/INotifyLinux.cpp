@@ -4,6 +4,7 @@
 // http://www.anki3d.org/LICENSE
 
 #include <anki/util/INotify.h>
+#include <anki/util/Filesystem.h>
 #include <anki/util/Logger.h>
 #include <sys/inotify.h>
 #include <poll.h>
@@ -14,7 +15,7 @@ namespace anki
 
 Error INotify::initInternal()
 {
-	ANKI_ASSERT(m_fd < 0 && m_watch < 0);
+	ANKI_ASSERT(m_fd < 0 && m_watches.isEmpty());
 
 	Error err = Error::NONE;
 
@@ -27,12 +28,14 @@ Error INotify::initInternal()
 
 	if(!err)
 	{
-		m_watch = inotify_add_watch(m_fd, &m_path[0], IN_MODIFY | IN_CREATE | IN_DELETE | IN_IGNORED | IN_DELETE_SELF);
-		if(m_watch < 0)
-		{
-			ANKI_UTIL_LOGE("inotify_add_watch() failed: %s", strerror(errno));
-			err = Error::FUNCTION_FAILED;
-		}
+		err = addWatch(CString());
+	}
+
+	if(!err && m_recursive && directoryExists(m_path.toCString()))
+	{
+		err = walkDirectoryTree(m_path.toCString(), this, [](const CString& fname, void* ud, Bool isDir) -> Error {
+			return (isDir) ? static_cast<INotify*>(ud)->addWatch(fname) : Error(Error::NONE);
+		});
 	}
 
 	if(err)
@@ -43,17 +46,53 @@ Error INotify::initInternal()
 	return err;
 }
 
+Error INotify::addWatch(CString relativePath)
+{
+	StringAuto path(m_alloc);
+	if(relativePath.isEmpty())
+	{
+		path.create(m_path.toCString());
+	}
+	else
+	{
+		path.sprintf("%s/%s", m_path.cstr(), relativePath.cstr());
+	}
+
+	const int watch = inotify_add_watch(m_fd,
+		path.cstr(),
+		IN_MODIFY | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_IGNORED | IN_DELETE_SELF);
+	if(watch < 0)
+	{
+		ANKI_UTIL_LOGE("inotify_add_watch() failed: %s", strerror(errno));
+		return Error::FUNCTION_FAILED;
+	}
+
+	Watch& w = *m_watches.emplaceBack(m_alloc);
+	w.m_watch = watch;
+	if(!relativePath.isEmpty())
+	{
+		w.m_path.create(m_alloc, relativePath);
+	}
+
+	return Error::NONE;
+}
+
 void INotify::destroyInternal()
 {
-	if(m_watch >= 0)
+	for(Watch& w : m_watches)
 	{
-		int err = inotify_rm_watch(m_fd, m_watch);
-		if(err < 0)
+		if(w.m_watch >= 0)
 		{
-			ANKI_UTIL_LOGE("inotify_rm_watch() failed: %s\n", strerror(errno));
+			int err = inotify_rm_watch(m_fd, w.m_watch);
+			if(err < 0)
+			{
+				ANKI_UTIL_LOGE("inotify_rm_watch() failed: %s\n", strerror(errno));
+			}
 		}
-		m_watch = -1;
+
+		w.m_path.destroy(m_alloc);
 	}
+	m_watches.destroy(m_alloc);
 
 	if(m_fd >= 0)
 	{
@@ -66,9 +105,9 @@ void INotify::destroyInternal()
 	}
 }
 
-Error INotify::pollEvents(Bool& modified)
+Error INotify::pollEventsInternal(Bool& modified, StringListAuto* changedFiles)
 {
-	ANKI_ASSERT(m_fd >= 0 && m_watch >= 0);
+	ANKI_ASSERT(m_fd >= 0 && !m_watches.isEmpty());
 
 	Error err = Error::NONE;
 	modified = false;
@@ -89,41 +128,105 @@ Error INotify::pollEvents(Bool& modified)
 			// No events, move on
 			break;
 		}
-		else
+
+		// Read a number of events
+		alignas(inotify_event) Array<U8, 2_KB> readBuff;
+		const ssize_t nbytes = read(m_fd, &readBuff[0], sizeof(readBuff));
+		if(nbytes <= 0)
+		{
+			ANKI_UTIL_LOGE("read() failed to read the expected size of data: %s", strerror(errno));
+			err = Error::FUNCTION_FAILED;
+			break;
+		}
+
+		// Process all of them
+		Bool recreate = false;
+		for(PtrSize offset = 0; offset < PtrSize(nbytes);)
 		{
-			// Process the new event
+			const inotify_event* event = reinterpret_cast<const inotify_event*>(&readBuff[offset]);
+			offset += sizeof(inotify_event) + event->len;
 
-			Array<U8, 2_KB> readBuff;
-			PtrSize nbytes = read(m_fd, &readBuff[0], sizeof(readBuff));
-			if(nbytes > 0)
+			if(event->mask & IN_IGNORED)
 			{
-				inotify_event* event = reinterpret_cast<inotify_event*>(&readBuff[0]);
+				// File was moved or deleted. Some editors on save they delete the file and move another file to its
+				// place. In that case the m_fd and the watches need to be re-created.
+				for(Watch& w : m_watches)
+				{
+					if(w.m_watch == event->wd)
+					{
+						w.m_watch = -1; // Watch descriptor was removed implicitly
+					}
+				}
+
+				recreate = true;
+				continue;
+			}
 
-				if(event->mask & IN_IGNORED)
+			modified = true;
+
+			const Watch* watch = nullptr;
+			for(const Watch& w : m_watches)
+			{
+				if(w.m_watch == event->wd)
 				{
-					// File was moved or deleted. Some editors on save they delete the file and move another file to
-					// its place. In that case the m_fd and the m_watch need to be re-created.
+					watch = &w;
+					break;
+				}
+			}
 
-					m_watch = -1; // Watch descriptor was removed implicitly
-					destroyInternal();
-					err = initInternal();
+			if(watch == nullptr)
+			{
+				continue;
+			}
+
+			// Build the path relative to the root
+			const Bool hasName = event->len > 0 && event->name[0] != '\0';
+			StringAuto relativePath(m_alloc);
+			if(!watch->m_path.isEmpty() && hasName)
+			{
+				relativePath.sprintf("%s/%s", watch->m_path.cstr(), event->name);
+			}
+			else if(hasName)
+			{
+				relativePath.create(event->name);
+			}
+			else if(!watch->m_path.isEmpty())
+			{
+				relativePath.create(watch->m_path.toCString());
+			}
+
+			if(event->mask & IN_ISDIR)
+			{
+				if(m_recursive && (event->mask & (IN_CREATE | IN_MOVED_TO)) && !relativePath.isEmpty())
+				{
+					err = addWatch(relativePath.toCString());
 					if(err)
 					{
 						break;
 					}
 				}
-				else
-				{
-					modified = true;
-				}
 			}
-			else
+			else if(changedFiles && hasName)
+			{
+				changedFiles->pushBackSprintf("%s/%s", m_path.cstr(), relativePath.cstr());
+			}
+			else if(changedFiles && !hasName && watch->m_path.isEmpty())
 			{
-				ANKI_UTIL_LOGE("read() failed to read the expected size of data: %s", strerror(errno));
-				err = Error::FUNCTION_FAILED;
-				break;
+				// The path itself is a file
+				changedFiles->pushBack(m_path.toCString());
 			}
 		}
+
+		if(!err && recreate)
+		{
+			destroyInternal();
+			err = initInternal();
+		}
+
+		if(err)
+		{
+			break;
+		}
 	}
 
 	return err;
@@ -19,9 +19,10 @@ void INotify::destroyInternal()
 	// TODO
 }
 
-Error INotify::pollEvents(Bool& modified)
+Error INotify::pollEventsInternal(Bool& modified, StringListAuto* changedFiles)
 {
 	// TODO
+	(void)changedFiles;
 	modified = false;
 	return Error::NONE;
 }
@@ -22,13 +22,28 @@ namespace anki
 
 static const Array<const char*, static_cast<U>(LoggerMessageType::COUNT)> MSG_TEXT = {{"I", "E", "W", "F"}};
 
+/// A message that waits to be written by the async thread.
+class Logger::AsyncRecord
+{
+public:
+	AsyncRecord* m_next;
+	LoggerMessageInfo m_info;
+
+	char* getMessage()
+	{
+		return reinterpret_cast<char*>(this + 1);
+	}
+};
+
 Logger::Logger()
+	: m_asyncThread("AnKiLogger")
 {
 	addMessageHandler(this, &defaultSystemMessageHandler);
 }
 
 Logger::~Logger()
 {
+	enableAsync(false);
 }
 
 void Logger::addMessageHandler(void* data, LoggerMessageHandlerCallback callback)
@@ -60,6 +75,49 @@ void Logger::removeMessageHandler(void* data, LoggerMessageHandlerCallback callb
 	}
 }
 
+void Logger::addFileMessageHandler(File* file)
+{
+	addMessageHandler(file, &fileMessageHandler);
+}
+
+void Logger::enableAsync(Bool enable)
+{
+	if(enable == m_asyncEnabled.load())
+	{
+		return;
+	}
+
+	if(enable)
+	{
+		m_asyncQuit = false;
+		m_asyncThread.start(this, asyncThreadCallback);
+		m_asyncEnabled.store(true);
+	}
+	else
+	{
+		m_asyncEnabled.store(false);
+
+		{
+			LockGuard<Mutex> lock(m_asyncMtx);
+			m_asyncQuit = true;
+			m_asyncCondVar.notifyOne();
+		}
+
+		const Error err = m_asyncThread.join();
+		(void)err;
+
+		// Someone might have pushed after the thread exited
+		flush();
+	}
+}
+
+void Logger::flush()
+{
+	LockGuard<Mutex> lock(m_mutex);
+	dispatchAsyncRecords();
+	flushHandlers();
+}
+
 void Logger::write(const char* file,
 	int line,
 	const char* func,
@@ -68,16 +126,29 @@ void Logger::write(const char* file,
 	ThreadId tid,
 	const char* msg)
 {
-	m_mutex.lock();
-
 	LoggerMessageInfo inf = {file, line, func, type, msg, subsystem, tid};
 
-	U count = m_handlersCount;
-	while(count-- != 0)
+	if(type != LoggerMessageType::FATAL && m_asyncEnabled.load())
 	{
-		m_handlers[count].m_callback(m_handlers[count].m_data, inf);
+		pushAsyncRecord(inf);
+
+		// The async mode got disabled in the meantime, don't leave the record behind
+		if(ANKI_UNLIKELY(!m_asyncEnabled.load()))
+		{
+			flush();
+		}
+
+		return;
 	}
 
+	m_mutex.lock();
+
+	// Keep the order of the messages
+	dispatchAsyncRecords();
+
+	dispatch(inf);
+	flushHandlers();
+
 	m_mutex.unlock();
 
 	if(type == LoggerMessageType::FATAL)
@@ -86,6 +157,113 @@ void Logger::write(const char* file,
 	}
 }
 
+void Logger::dispatch(const LoggerMessageInfo& info)
+{
+	U count = m_handlersCount;
+	while(count-- != 0)
+	{
+		m_handlers[count].m_callback(m_handlers[count].m_data, info);
+	}
+}
+
+void Logger::pushAsyncRecord(const LoggerMessageInfo& info)
+{
+	// The logger can't use the engine's allocators
+	const PtrSize msgLen = strlen(info.m_msg);
+	AsyncRecord* record = static_cast<AsyncRecord*>(malloc(sizeof(AsyncRecord) + msgLen + 1));
+	if(ANKI_UNLIKELY(record == nullptr))
+	{
+		fprintf(stderr, "Logger::pushAsyncRecord() out of memory. Will not recover");
+		abort();
+	}
+
+	record->m_info = info;
+	memcpy(record->getMessage(), info.m_msg, msgLen + 1);
+	record->m_info.m_msg = record->getMessage();
+
+	AsyncRecord* head = m_asyncHead.load();
+	do
+	{
+		record->m_next = head;
+	} while(!m_asyncHead.compareExchange(head, record, AtomicMemoryOrder::RELEASE, AtomicMemoryOrder::RELAXED));
+
+	// Only the first record of a batch needs to wake the thread
+	if(head == nullptr)
+	{
+		LockGuard<Mutex> lock(m_asyncMtx);
+		m_asyncCondVar.notifyOne();
+	}
+}
+
+void Logger::dispatchAsyncRecords()
+{
+	if(m_asyncHead.load() == nullptr)
+	{
+		return;
+	}
+
+	// Take the whole batch and reverse it to get the order of submission
+	AsyncRecord* record = m_asyncHead.exchange(nullptr, AtomicMemoryOrder::ACQUIRE);
+	AsyncRecord* first = nullptr;
+	while(record)
+	{
+		AsyncRecord* next = record->m_next;
+		record->m_next = first;
+		first = record;
+		record = next;
+	}
+
+	while(first)
+	{
+		dispatch(first->m_info);
+
+		AsyncRecord* next = first->m_next;
+		free(first);
+		first = next;
+	}
+}
+
+void Logger::flushHandlers()
+{
+	for(U32 i = 0; i < m_handlersCount; ++i)
+	{
+		if(m_handlers[i].m_callback == &fileMessageHandler)
+		{
+			const Error err = static_cast<File*>(m_handlers[i].m_data)->flush();
+			(void)err;
+		}
+	}
+
+	fflush(stdout);
+	fflush(stderr);
+}
+
+Error Logger::asyncThreadCallback(ThreadCallbackInfo& info)
+{
+	Logger& self = *static_cast<Logger*>(info.m_userData);
+
+	Bool quit = false;
+	while(!quit)
+	{
+		{
+			LockGuard<Mutex> lock(self.m_asyncMtx);
+			while(self.m_asyncHead.load() == nullptr && !self.m_asyncQuit)
+			{
+				self.m_asyncCondVar.wait(self.m_asyncMtx);
+			}
+
+			quit = self.m_asyncQuit;
+		}
+
+		// Write the whole batch and flush once
+		LockGuard<Mutex> lock(self.m_mutex);
+		self.dispatchAsyncRecords();
+		self.flushHandlers();
+	}
+
+	return Error::NONE;
+}
+
 void Logger::writeFormated(const char* file,
 	int line,
 	const char* func,
@@ -288,8 +466,6 @@ void Logger::defaultSystemMessageHandler(void*, const LoggerMessageInfo& info)
 		info.m_file,
 		info.m_line,
 		info.m_func);
-
-	fflush(out);
 #endif
 }
 
@@ -297,18 +473,13 @@ void Logger::fileMessageHandler(void* pfile, const LoggerMessageInfo& info)
 {
 	File* file = reinterpret_cast<File*>(pfile);
 
-	Error err = file->writeText("[%s] %s (%s:%d %s)\n",
+	const Error err = file->writeText("[%s] %s (%s:%d %s)\n",
 		MSG_TEXT[static_cast<U>(info.m_type)],
 		info.m_msg,
 		info.m_file,
 		info.m_line,
 		info.m_func);
-
-	if(!err)
-	{
-		err = file->flush();
-		(void)err;
-	}
+	(void)err;
 }
 
 } // end namespace anki
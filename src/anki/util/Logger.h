@@ -8,6 +8,7 @@
 #include <anki/Config.h>
 #include <anki/util/Singleton.h>
 #include <anki/util/Thread.h>
+#include <anki/util/Atomic.h>
 
 namespace anki
 {
@@ -51,6 +52,8 @@ using LoggerMessageHandlerCallback = void (*)(void*, const LoggerMessageInfo& in
 /// thread safe.
 /// To add a new signal:
 /// @code logger.addMessageHandler((void*)obj, &function) @endcode
+/// In async mode the messages are pushed to a lock-free queue and a background thread calls the handlers in batches.
+/// Fatal messages are always written synchronously.
 class Logger
 {
 public:
@@ -59,6 +62,12 @@ public:
 
 	~Logger();
 
+	/// Enable or disable the async mode. Disabling it writes all the pending messages. It's not thread safe.
+	void enableAsync(Bool enable);
+
+	/// Write the pending messages of the async mode to the handlers.
+	void flush();
+
 	/// Add a new message handler
 	void addMessageHandler(void* data, LoggerMessageHandlerCallback callback);
 
@@ -106,10 +115,34 @@ private:
 		}
 	};
 
+	class AsyncRecord;
+
 	Mutex m_mutex; ///< For thread safety
 	Array<Handler, 4> m_handlers;
 	U32 m_handlersCount = 0;
 
+	/// @name Async mode
+	/// @{
+	Atomic<Bool> m_asyncEnabled = {false};
+	Atomic<AsyncRecord*> m_asyncHead = {nullptr}; ///< The records in reverse order.
+	Thread m_asyncThread;
+	Mutex m_asyncMtx;
+	ConditionVariable m_asyncCondVar;
+	Bool m_asyncQuit = false;
+	/// @}
+
+	void dispatch(const LoggerMessageInfo& info);
+
+	void pushAsyncRecord(const LoggerMessageInfo& info);
+
+	/// Call the handlers for the pending async records. Needs m_mutex to be locked.
+	void dispatchAsyncRecords();
+
+	/// Flush the files and the console. Needs m_mutex to be locked.
+	void flushHandlers();
+
+	static Error asyncThreadCallback(ThreadCallbackInfo& info);
+
 	static void defaultSystemMessageHandler(void*, const LoggerMessageInfo& info);
 	static void fileMessageHandler(void* file, const LoggerMessageInfo& info);
 };
@@ -137,6 +137,177 @@ void* allocAligned(void* userData, void* ptr, PtrSize size, PtrSize alignment)
 	return out;
 }
 
+/// The header of the allocations of MemoryTagTracker. It's as big as the max alignment to keep the user's alignment.
+class alignas(64) MemoryTagTrackerHeader
+{
+public:
+	PtrSize m_size;
+	MemoryTag m_tag;
+};
+
+static_assert(sizeof(MemoryTagTrackerHeader) == 64, "See file");
+
+void MemoryTagTracker::init(AllocAlignedCallback allocCb, void* allocCbUserData)
+{
+	ANKI_ASSERT(allocCb);
+	m_allocCb = allocCb;
+	m_allocCbUserData = allocCbUserData;
+
+	for(U32 i = 0; i < U32(MemoryTag::COUNT); ++i)
+	{
+		m_tags[i].m_tracker = this;
+		m_tags[i].m_tag = MemoryTag(i);
+	}
+}
+
+void* MemoryTagTracker::allocCallback(void* userData, void* ptr, PtrSize size, PtrSize alignment)
+{
+	ANKI_ASSERT(userData);
+	Tag& userTag = *static_cast<Tag*>(userData);
+	MemoryTagTracker& self = *userTag.m_tracker;
+	void* out = nullptr;
+
+	if(ptr == nullptr)
+	{
+		ANKI_ASSERT(size > 0);
+		ANKI_ASSERT(alignment > 0 && alignment <= alignof(MemoryTagTrackerHeader));
+
+		MemoryTagTrackerHeader* header = static_cast<MemoryTagTrackerHeader*>(self.m_allocCb(self.m_allocCbUserData,
+			nullptr,
+			sizeof(MemoryTagTrackerHeader) + size,
+			alignof(MemoryTagTrackerHeader)));
+		if(ANKI_UNLIKELY(header == nullptr))
+		{
+			return nullptr;
+		}
+
+		header->m_size = size;
+		header->m_tag = userTag.m_tag;
+		out = header + 1;
+
+		const PtrSize live = userTag.m_liveBytes.fetchAdd(size) + size;
+		userTag.m_peakBytes.max(live);
+		userTag.m_allocationCount.fetchAdd(1);
+	}
+	else
+	{
+		MemoryTagTrackerHeader* header = static_cast<MemoryTagTrackerHeader*>(ptr) - 1;
+		ANKI_ASSERT(header->m_size > 0 && header->m_tag < MemoryTag::COUNT);
+
+		// The tag of the allocation and not of the caller, they might differ if the memory changed hands
+		Tag& tag = self.m_tags[U32(header->m_tag)];
+		tag.m_liveBytes.fetchSub(header->m_size);
+		tag.m_freeCount.fetchAdd(1);
+
+		self.m_allocCb(self.m_allocCbUserData, header, 0, 0);
+	}
+
+	return out;
+}
+
+void MemoryTagTracker::getSnapshot(Array<MemoryTagStats, U32(MemoryTag::COUNT)>& stats) const
+{
+	for(U32 i = 0; i < U32(MemoryTag::COUNT); ++i)
+	{
+		stats[i].m_liveBytes = m_tags[i].m_liveBytes.load();
+		stats[i].m_peakBytes = m_tags[i].m_peakBytes.load();
+		stats[i].m_allocationCount = m_tags[i].m_allocationCount.load();
+		stats[i].m_freeCount = m_tags[i].m_freeCount.load();
+	}
+}
+
+MemoryTagStats MemoryTagTracker::getTotal() const
+{
+	Array<MemoryTagStats, U32(MemoryTag::COUNT)> stats;
+	getSnapshot(stats);
+
+	MemoryTagStats total;
+	for(const MemoryTagStats& s : stats)
+	{
+		total.m_liveBytes += s.m_liveBytes;
+		total.m_peakBytes += s.m_peakBytes;
+		total.m_allocationCount += s.m_allocationCount;
+		total.m_freeCount += s.m_freeCount;
+	}
+
+	return total;
+}
+
+const char* MemoryTagTracker::getTagName(MemoryTag tag)
+{
+	static const Array<const char*, U32(MemoryTag::COUNT)> names = {
+		{"Core", "Gr", "Resource", "Renderer", "Scene", "Physics", "Script", "Ui"}};
+	ANKI_ASSERT(tag < MemoryTag::COUNT);
+	return names[U32(tag)];
+}
+
+/// The block sizes of the size classes of HeapMemoryPool. They include the BlockHeader.
+static constexpr Array<U32, HeapMemoryPool::SIZE_CLASS_COUNT> HEAP_POOL_BLOCK_SIZES = {
+	{32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048, 4096}};
+
+/// The size of the slabs of HeapMemoryPool.
+static constexpr U32 HEAP_POOL_SLAB_SIZE = 64 * 1024;
+
+/// The number of blocks that a thread gathers before it returns them to the thread that allocated them.
+static constexpr U32 HEAP_POOL_REMOTE_FREE_BATCH_SIZE = 32;
+
+static constexpr U32 HEAP_POOL_LARGE_SIZE_CLASS = MAX_U32;
+static constexpr U32 HEAP_POOL_BLOCK_MAGIC = 0xA5C3A5C3;
+
+/// Used to create unique IDs for the HeapMemoryPool.
+static Atomic<U64> g_heapPoolUuid = {1};
+
+/// The thread caches of the calling thread. A thread can have caches from a few pools.
+class HeapPoolThreadCacheSlot
+{
+public:
+	U64 m_poolUuid = 0;
+	void* m_cache = nullptr;
+};
+
+static constexpr U32 MAX_HEAP_POOL_THREAD_CACHE_SLOTS = 8;
+static thread_local Array<HeapPoolThreadCacheSlot, MAX_HEAP_POOL_THREAD_CACHE_SLOTS> g_heapPoolThreadCacheSlots;
+static thread_local U32 g_nextHeapPoolThreadCacheSlot = 0;
+
+/// Gives the thread caches of a thread back to their pools when the thread exits. It's separate from the slots so the
+/// lookups of the slots don't pay for the initialization checks of a thread_local with a destructor.
+class HeapPoolThreadExitHook
+{
+public:
+	Bool m_armed = false;
+
+	~HeapPoolThreadExitHook()
+	{
+		for(HeapPoolThreadCacheSlot& slot : g_heapPoolThreadCacheSlots)
+		{
+			if(slot.m_cache)
+			{
+				HeapMemoryPool::releaseThreadCache(slot.m_poolUuid, slot.m_cache);
+				slot = HeapPoolThreadCacheSlot();
+			}
+		}
+	}
+};
+
+static thread_local HeapPoolThreadExitHook g_heapPoolThreadExitHook;
+
+/// The thread caching pools that are alive. The threads check it before they touch the caches of a pool that might be
+/// destroyed.
+class HeapPoolRegistry
+{
+public:
+	Mutex m_mtx;
+	HeapMemoryPool* m_head = nullptr;
+};
+
+/// It's never destroyed because threads might exit after the static objects are gone.
+static HeapPoolRegistry& getHeapPoolRegistry()
+{
+	alignas(HeapPoolRegistry) static U8 storage[sizeof(HeapPoolRegistry)];
+	static HeapPoolRegistry* registry = ::new(storage) HeapPoolRegistry();
+	return *registry;
+}
+
 BaseMemoryPool::~BaseMemoryPool()
 {
 	ANKI_ASSERT(m_refcount.load() == 0 && "Refcount should be zero");
@@ -147,6 +318,96 @@ Bool BaseMemoryPool::isCreated() const
 	return m_allocCb != nullptr;
 }
 
+/// Sits before every allocation of HeapMemoryPool in thread caching mode.
+class alignas(16) HeapMemoryPool::BlockHeader
+{
+public:
+	union
+	{
+		ThreadCache* m_owner; ///< The ThreadCache that allocated a small block.
+		void* m_largeAllocation; ///< What the allocation callback returned for a large allocation.
+	};
+
+	U32 m_sizeClass;
+	U32 m_magic;
+};
+
+/// A big chunk of memory that is split in blocks of the same size class.
+class HeapMemoryPool::Slab
+{
+public:
+	Slab* m_next;
+};
+
+static constexpr U32 HEAP_POOL_SLAB_HEADER_SIZE = 64;
+
+/// The per thread state of a HeapMemoryPool.
+class alignas(ANKI_CACHE_LINE_SIZE) HeapMemoryPool::ThreadCache
+{
+public:
+	ThreadCache* m_next = nullptr; ///< Next in HeapMemoryPool::m_threadCaches.
+
+	/// The free blocks of every size class. Only the owner thread touches them.
+	Array<void*, SIZE_CLASS_COUNT> m_freeBlocks = {};
+
+	/// Blocks of other threads that wait to be returned to their owner.
+	class RemoteFreeBatch
+	{
+	public:
+		ThreadCache* m_owner = nullptr;
+		void* m_first = nullptr;
+		void* m_last = nullptr;
+		U32 m_count = 0;
+	};
+
+	Array<RemoteFreeBatch, SIZE_CLASS_COUNT> m_remoteFreeBatches;
+
+	/// @name Statistics. Only the owner thread writes them.
+	/// @{
+	Array<Atomic<U64>, SIZE_CLASS_COUNT> m_allocationCounts;
+	Array<Atomic<U64>, SIZE_CLASS_COUNT> m_freeCounts;
+	Array<Atomic<U64>, SIZE_CLASS_COUNT> m_remoteFreeCounts;
+	Array<Atomic<U32>, SIZE_CLASS_COUNT> m_slabCounts;
+	/// @}
+
+	/// Blocks that other threads freed. Keep them in a separate cache line because other threads write to them.
+	alignas(ANKI_CACHE_LINE_SIZE) Array<Atomic<void*>, SIZE_CLASS_COUNT> m_remoteFreeBlocks;
+
+	/// No thread uses it and another thread can adopt it.
+	Atomic<Bool> m_orphaned = {false};
+
+	ThreadCache()
+	{
+		for(U32 i = 0; i < SIZE_CLASS_COUNT; ++i)
+		{
+			m_allocationCounts[i].setNonAtomically(0);
+			m_freeCounts[i].setNonAtomically(0);
+			m_remoteFreeCounts[i].setNonAtomically(0);
+			m_slabCounts[i].setNonAtomically(0);
+			m_remoteFreeBlocks[i].setNonAtomically(nullptr);
+		}
+	}
+};
+
+/// The blocks are linked using their first bytes after the BlockHeader.
+static void*& heapPoolNextBlock(void* block)
+{
+	return *static_cast<void**>(block);
+}
+
+static U32 heapPoolSizeClass(PtrSize allocSize)
+{
+	for(U32 i = 0; i < HeapMemoryPool::SIZE_CLASS_COUNT; ++i)
+	{
+		if(allocSize <= HEAP_POOL_BLOCK_SIZES[i])
+		{
+			return i;
+		}
+	}
+
+	return HEAP_POOL_LARGE_SIZE_CLASS;
+}
+
 HeapMemoryPool::HeapMemoryPool()
 	: BaseMemoryPool(Type::HEAP)
 {
@@ -154,7 +415,49 @@ HeapMemoryPool::HeapMemoryPool()
 
 HeapMemoryPool::~HeapMemoryPool()
 {
-	const U32 count = m_allocationsCount.load();
+	U32 count = m_allocationsCount.load();
+
+	if(m_threadCaching)
+	{
+		// Remove it from the live pools so the threads that exit won't touch its caches
+		{
+			HeapPoolRegistry& registry = getHeapPoolRegistry();
+			LockGuard<Mutex> lock(registry.m_mtx);
+			HeapMemoryPool** prev = &registry.m_head;
+			while(*prev != this)
+			{
+				ANKI_ASSERT(*prev);
+				prev = &(*prev)->m_nextThreadCachingPool;
+			}
+
+			*prev = m_nextThreadCachingPool;
+		}
+
+		Array<HeapMemoryPoolSizeClassStats, SIZE_CLASS_COUNT> stats;
+		getSizeClassStatistics(stats);
+		for(const HeapMemoryPoolSizeClassStats& stat : stats)
+		{
+			count += U32(stat.m_allocationCount - stat.m_freeCount);
+		}
+
+		Slab* slab = m_slabs.load();
+		while(slab)
+		{
+			Slab* next = slab->m_next;
+			m_allocCb(m_allocCbUserData, slab, 0, 0);
+			slab = next;
+		}
+
+		ThreadCache* cache = m_threadCaches.load();
+		while(cache)
+		{
+			ThreadCache* next = cache->m_next;
+			cache->~ThreadCache();
+			m_allocCb(m_allocCbUserData, cache, 0, 0);
+			cache = next;
+		}
+	}
+
 	if(count != 0)
 	{
 		ANKI_UTIL_LOGW("Memory pool destroyed before all memory being released "
@@ -163,7 +466,7 @@ HeapMemoryPool::~HeapMemoryPool()
 	}
 }
 
-void HeapMemoryPool::create(AllocAlignedCallback allocCb, void* allocCbUserData)
+void HeapMemoryPool::create(AllocAlignedCallback allocCb, void* allocCbUserData, Bool threadCaching)
 {
 	ANKI_ASSERT(!isCreated());
 	ANKI_ASSERT(m_allocCb == nullptr);
@@ -171,6 +474,17 @@ void HeapMemoryPool::create(AllocAlignedCallback allocCb, void* allocCbUserData)
 
 	m_allocCb = allocCb;
 	m_allocCbUserData = allocCbUserData;
+	m_threadCaching = threadCaching;
+	m_uuid = g_heapPoolUuid.fetchAdd(1);
+
+	if(m_threadCaching)
+	{
+		HeapPoolRegistry& registry = getHeapPoolRegistry();
+		LockGuard<Mutex> lock(registry.m_mtx);
+		m_nextThreadCachingPool = registry.m_head;
+		registry.m_head = this;
+	}
+
 #if ANKI_MEM_SIGNATURES
 	m_signature = computeSignature(this);
 	m_headerSize = getAlignedRoundUp(MAX_ALIGNMENT, sizeof(Signature));
@@ -180,6 +494,12 @@ void HeapMemoryPool::create(AllocAlignedCallback allocCb, void* allocCbUserData)
 void* HeapMemoryPool::allocate(PtrSize size, PtrSize alignment)
 {
 	ANKI_ASSERT(isCreated());
+
+	if(m_threadCaching)
+	{
+		return allocateCached(size, alignment);
+	}
+
 #if ANKI_MEM_SIGNATURES
 	ANKI_ASSERT(alignment <= MAX_ALIGNMENT && "Wrong assumption");
 	size += m_headerSize;
@@ -216,6 +536,12 @@ void HeapMemoryPool::free(void* ptr)
 		return;
 	}
 
+	if(m_threadCaching)
+	{
+		freeCached(ptr);
+		return;
+	}
+
 #if ANKI_MEM_SIGNATURES
 	U8* memU8 = static_cast<U8*>(ptr);
 	memU8 -= m_headerSize;
@@ -230,6 +556,284 @@ void HeapMemoryPool::free(void* ptr)
 	m_allocCb(m_allocCbUserData, ptr, 0, 0);
 }
 
+HeapMemoryPool::ThreadCache& HeapMemoryPool::getThreadCache()
+{
+	for(const HeapPoolThreadCacheSlot& slot : g_heapPoolThreadCacheSlots)
+	{
+		if(slot.m_poolUuid == m_uuid)
+		{
+			return *static_cast<ThreadCache*>(slot.m_cache);
+		}
+	}
+
+	// Not found. Adopt a cache that another thread gave back, it has free blocks and the blocks that were freed to it
+	ThreadCache* cache = m_threadCaches.load(AtomicMemoryOrder::ACQUIRE);
+	while(cache)
+	{
+		Bool orphaned = true;
+		if(cache->m_orphaned.load(AtomicMemoryOrder::RELAXED)
+			&& cache->m_orphaned.compareExchange(
+				   orphaned, false, AtomicMemoryOrder::ACQUIRE, AtomicMemoryOrder::RELAXED))
+		{
+			break;
+		}
+
+		cache = cache->m_next;
+	}
+
+	// None, create a new cache
+	if(cache == nullptr)
+	{
+		void* mem = m_allocCb(m_allocCbUserData, nullptr, sizeof(ThreadCache), alignof(ThreadCache));
+		if(ANKI_UNLIKELY(mem == nullptr))
+		{
+			ANKI_CREATION_OOM_ACTION();
+		}
+
+		cache = ::new(mem) ThreadCache();
+
+		// Add it to the list of the pool
+		ThreadCache* head = m_threadCaches.load();
+		do
+		{
+			cache->m_next = head;
+		} while(!m_threadCaches.compareExchange(head, cache, AtomicMemoryOrder::RELEASE, AtomicMemoryOrder::RELAXED));
+	}
+
+	// Store it to the thread. If all slots are used evict one and give it back to its pool
+	HeapPoolThreadCacheSlot& slot = g_heapPoolThreadCacheSlots[g_nextHeapPoolThreadCacheSlot];
+	g_nextHeapPoolThreadCacheSlot = (g_nextHeapPoolThreadCacheSlot + 1) % MAX_HEAP_POOL_THREAD_CACHE_SLOTS;
+	if(slot.m_cache)
+	{
+		releaseThreadCache(slot.m_poolUuid, slot.m_cache);
+	}
+
+	slot.m_poolUuid = m_uuid;
+	slot.m_cache = cache;
+	g_heapPoolThreadExitHook.m_armed = true;
+
+	return *cache;
+}
+
+void HeapMemoryPool::releaseThreadCache(U64 poolUuid, void* cachePtr)
+{
+	HeapPoolRegistry& registry = getHeapPoolRegistry();
+	LockGuard<Mutex> lock(registry.m_mtx);
+
+	const HeapMemoryPool* pool = registry.m_head;
+	while(pool && pool->m_uuid != poolUuid)
+	{
+		pool = pool->m_nextThreadCachingPool;
+	}
+
+	if(pool == nullptr)
+	{
+		// The pool is destroyed and the cache along with it
+		return;
+	}
+
+	ThreadCache& cache = *static_cast<ThreadCache*>(cachePtr);
+	ANKI_ASSERT(!cache.m_orphaned.load());
+
+	// Nobody would fill the remote free batches of the cache anymore, return them to their owners
+	for(U32 sizeClass = 0; sizeClass < SIZE_CLASS_COUNT; ++sizeClass)
+	{
+		flushRemoteFreeBatch(cache, sizeClass);
+	}
+
+	cache.m_orphaned.store(true, AtomicMemoryOrder::RELEASE);
+}
+
+void HeapMemoryPool::newSlab(ThreadCache& cache, U32 sizeClass)
+{
+	U8* mem = static_cast<U8*>(m_allocCb(m_allocCbUserData, nullptr, HEAP_POOL_SLAB_SIZE, HEAP_POOL_SLAB_HEADER_SIZE));
+	if(ANKI_UNLIKELY(mem == nullptr))
+	{
+		ANKI_OOM_ACTION();
+		return;
+	}
+
+	// Add it to the list of the pool
+	Slab* slab = reinterpret_cast<Slab*>(mem);
+	Slab* head = m_slabs.load();
+	do
+	{
+		slab->m_next = head;
+	} while(!m_slabs.compareExchange(head, slab, AtomicMemoryOrder::RELEASE, AtomicMemoryOrder::RELAXED));
+
+	// Split it to blocks
+	const U32 blockSize = HEAP_POOL_BLOCK_SIZES[sizeClass];
+	const U32 blockCount = (HEAP_POOL_SLAB_SIZE - HEAP_POOL_SLAB_HEADER_SIZE) / blockSize;
+	ANKI_ASSERT(blockCount > 0);
+	void* first = nullptr;
+	for(U32 i = blockCount; i-- > 0;)
+	{
+		BlockHeader* header = reinterpret_cast<BlockHeader*>(mem + HEAP_POOL_SLAB_HEADER_SIZE + i * blockSize);
+		header->m_owner = &cache;
+		header->m_sizeClass = sizeClass;
+		header->m_magic = HEAP_POOL_BLOCK_MAGIC;
+
+		void* block = header + 1;
+		heapPoolNextBlock(block) = first;
+		first = block;
+	}
+
+	ANKI_ASSERT(cache.m_freeBlocks[sizeClass] == nullptr);
+	cache.m_freeBlocks[sizeClass] = first;
+	cache.m_slabCounts[sizeClass].store(cache.m_slabCounts[sizeClass].load() + 1);
+}
+
+void* HeapMemoryPool::allocateCached(PtrSize size, PtrSize alignment)
+{
+	static_assert(sizeof(BlockHeader) == 16, "The blocks should be 16 byte aligned");
+	const U32 sizeClass = (alignment <= sizeof(BlockHeader)) ? heapPoolSizeClass(size + sizeof(BlockHeader))
+															   : HEAP_POOL_LARGE_SIZE_CLASS;
+
+	if(ANKI_UNLIKELY(sizeClass == HEAP_POOL_LARGE_SIZE_CLASS))
+	{
+		// Too big, use the callback. Keep some space for the header before the returned memory
+		const PtrSize headerSpace = max<PtrSize>(alignment, sizeof(BlockHeader));
+		U8* mem = static_cast<U8*>(m_allocCb(m_allocCbUserData, nullptr, size + headerSpace, headerSpace));
+		if(ANKI_UNLIKELY(mem == nullptr))
+		{
+			ANKI_OOM_ACTION();
+			return nullptr;
+		}
+
+		BlockHeader* header = reinterpret_cast<BlockHeader*>(mem + headerSpace) - 1;
+		header->m_largeAllocation = mem;
+		header->m_sizeClass = HEAP_POOL_LARGE_SIZE_CLASS;
+		header->m_magic = HEAP_POOL_BLOCK_MAGIC;
+
+		m_allocationsCount.fetchAdd(1);
+		return mem + headerSpace;
+	}
+
+	ThreadCache& cache = getThreadCache();
+	void* block = cache.m_freeBlocks[sizeClass];
+	if(ANKI_UNLIKELY(block == nullptr))
+	{
+		// Get the blocks other threads have returned and if there are none get a new slab
+		block = cache.m_remoteFreeBlocks[sizeClass].exchange(nullptr, AtomicMemoryOrder::ACQUIRE);
+		if(block == nullptr)
+		{
+			newSlab(cache, sizeClass);
+			block = cache.m_freeBlocks[sizeClass];
+			if(ANKI_UNLIKELY(block == nullptr))
+			{
+				return nullptr;
+			}
+		}
+	}
+
+	cache.m_freeBlocks[sizeClass] = heapPoolNextBlock(block);
+	cache.m_allocationCounts[sizeClass].store(cache.m_allocationCounts[sizeClass].load() + 1);
+
+	ANKI_ASSERT((static_cast<BlockHeader*>(block) - 1)->m_magic == HEAP_POOL_BLOCK_MAGIC);
+	ANKI_ASSERT((static_cast<BlockHeader*>(block) - 1)->m_owner == &cache);
+	return block;
+}
+
+void HeapMemoryPool::freeCached(void* ptr)
+{
+	BlockHeader* header = static_cast<BlockHeader*>(ptr) - 1;
+	if(ANKI_UNLIKELY(header->m_magic != HEAP_POOL_BLOCK_MAGIC))
+	{
+		ANKI_UTIL_LOGE("Signature missmatch on free");
+		return;
+	}
+
+	const U32 sizeClass = header->m_sizeClass;
+	if(ANKI_UNLIKELY(sizeClass == HEAP_POOL_LARGE_SIZE_CLASS))
+	{
+		m_allocationsCount.fetchSub(1);
+		m_allocCb(m_allocCbUserData, header->m_largeAllocation, 0, 0);
+		return;
+	}
+
+	ANKI_ASSERT(sizeClass < SIZE_CLASS_COUNT);
+	invalidateMemory(ptr, HEAP_POOL_BLOCK_SIZES[sizeClass] - sizeof(BlockHeader));
+
+	ThreadCache& cache = getThreadCache();
+	cache.m_freeCounts[sizeClass].store(cache.m_freeCounts[sizeClass].load() + 1);
+
+	ThreadCache& owner = *header->m_owner;
+	if(&owner == &cache)
+	{
+		// Fast path, it's ours
+		heapPoolNextBlock(ptr) = cache.m_freeBlocks[sizeClass];
+		cache.m_freeBlocks[sizeClass] = ptr;
+		return;
+	}
+
+	// Belongs to another thread. Gather a few blocks of the same owner before returning them
+	cache.m_remoteFreeCounts[sizeClass].store(cache.m_remoteFreeCounts[sizeClass].load() + 1);
+
+	ThreadCache::RemoteFreeBatch& batch = cache.m_remoteFreeBatches[sizeClass];
+	if(batch.m_owner != &owner)
+	{
+		flushRemoteFreeBatch(cache, sizeClass);
+		batch.m_owner = &owner;
+	}
+
+	heapPoolNextBlock(ptr) = batch.m_first;
+	batch.m_first = ptr;
+	if(batch.m_last == nullptr)
+	{
+		batch.m_last = ptr;
+	}
+
+	if(++batch.m_count == HEAP_POOL_REMOTE_FREE_BATCH_SIZE)
+	{
+		flushRemoteFreeBatch(cache, sizeClass);
+	}
+}
+
+void HeapMemoryPool::pushRemoteFrees(ThreadCache& owner, U32 sizeClass, void* first, void* last)
+{
+	ANKI_ASSERT(first && last);
+	Atomic<void*>& head = owner.m_remoteFreeBlocks[sizeClass];
+	void* crntHead = head.load();
+	do
+	{
+		heapPoolNextBlock(last) = crntHead;
+	} while(!head.compareExchange(crntHead, first, AtomicMemoryOrder::RELEASE, AtomicMemoryOrder::RELAXED));
+}
+
+void HeapMemoryPool::flushRemoteFreeBatch(ThreadCache& cache, U32 sizeClass)
+{
+	ThreadCache::RemoteFreeBatch& batch = cache.m_remoteFreeBatches[sizeClass];
+	if(batch.m_count > 0)
+	{
+		pushRemoteFrees(*batch.m_owner, sizeClass, batch.m_first, batch.m_last);
+	}
+
+	batch = ThreadCache::RemoteFreeBatch();
+}
+
+void HeapMemoryPool::getSizeClassStatistics(Array<HeapMemoryPoolSizeClassStats, SIZE_CLASS_COUNT>& stats) const
+{
+	for(U32 i = 0; i < SIZE_CLASS_COUNT; ++i)
+	{
+		stats[i] = HeapMemoryPoolSizeClassStats();
+		stats[i].m_maxAllocationSize = HEAP_POOL_BLOCK_SIZES[i] - sizeof(BlockHeader);
+	}
+
+	const ThreadCache* cache = m_threadCaches.load(AtomicMemoryOrder::ACQUIRE);
+	while(cache)
+	{
+		for(U32 i = 0; i < SIZE_CLASS_COUNT; ++i)
+		{
+			stats[i].m_allocationCount += cache->m_allocationCounts[i].load();
+			stats[i].m_freeCount += cache->m_freeCounts[i].load();
+			stats[i].m_remoteFreeCount += cache->m_remoteFreeCounts[i].load();
+			stats[i].m_slabCount += cache->m_slabCounts[i].load();
+		}
+
+		cache = cache->m_next;
+	}
+}
+
 StackMemoryPool::StackMemoryPool()
 	: BaseMemoryPool(Type::STACK)
 {
@@ -240,7 +844,7 @@ StackMemoryPool::~StackMemoryPool()
 	// Iterate all until you find an unused
 	for(Chunk& ch : m_chunks)
 	{
-		if(ch.m_baseMem != nullptr)
+		if(ch.m_state.load() == ChunkState::READY)
 		{
 			ch.check();
 
@@ -293,6 +897,10 @@ void StackMemoryPool::create(AllocAlignedCallback allocCb,
 		m_chunks[0].m_baseMem = static_cast<U8*>(mem);
 		m_chunks[0].m_mem.store(m_chunks[0].m_baseMem);
 		m_chunks[0].m_size = initialChunkSize;
+		m_chunks[0].m_state.store(ChunkState::READY);
+
+		m_chunkCount.store(1);
+		m_chunkCountAtLastReset = 1;
 
 		ANKI_ASSERT(m_crntChunkIdx.load() == 0);
 	}
@@ -312,87 +920,102 @@ void* StackMemoryPool::allocate(PtrSize size, PtrSize alignment)
 	ANKI_ASSERT(size > 0);
 	ANKI_ASSERT(size <= m_initialChunkSize && "The chunks should have enough space to hold at least one allocation");
 
-	Chunk* crntChunk = nullptr;
-	Bool retry = true;
-	U8* out = nullptr;
-
-	do
+	while(true)
 	{
-		crntChunk = &m_chunks[m_crntChunkIdx.load()];
-		crntChunk->check();
+		const U32 crntChunkIdx = m_crntChunkIdx.load();
+		Chunk& crntChunk = m_chunks[crntChunkIdx];
+		crntChunk.check();
 
-		out = crntChunk->m_mem.fetchAdd(size);
-		ANKI_ASSERT(out >= crntChunk->m_baseMem);
+		U8* out = crntChunk.m_mem.fetchAdd(size);
+		ANKI_ASSERT(out >= crntChunk.m_baseMem);
 
-		if(PtrSize(out + size - crntChunk->m_baseMem) <= crntChunk->m_size)
+		if(PtrSize(out + size - crntChunk.m_baseMem) <= crntChunk.m_size)
 		{
 			// All is fine, there is enough space in the chunk
-
-			retry = false;
 			m_allocationsCount.fetchAdd(1);
+			return static_cast<void*>(out);
 		}
-		else
+
+		// Need new chunk
+		if(!acquireNextChunk(crntChunkIdx))
+		{
+			return nullptr;
+		}
+	}
+}
+
+Bool StackMemoryPool::acquireNextChunk(U32 fullChunkIdx)
+{
+	const U32 nextChunkIdx = fullChunkIdx + 1;
+	if(nextChunkIdx >= MAX_CHUNKS)
+	{
+		ANKI_UTIL_LOGE("Number of chunks is not enough");
+		ANKI_OOM_ACTION();
+		return false;
+	}
+
+	Chunk& nextChunk = m_chunks[nextChunkIdx];
+
+	while(true)
+	{
+		// Another thread already moved to the next chunk, nothing to do
+		if(m_crntChunkIdx.load() != fullChunkIdx)
+		{
+			return true;
+		}
+
+		ChunkState state = nextChunk.m_state.load(AtomicMemoryOrder::ACQUIRE);
+
+		if(state == ChunkState::READY)
 		{
-			// Need new chunk
+			// Recycle a cached chunk. reset() has already rewound it. Only one thread will win the exchange, the rest
+			// will see the new index and retry the allocation
+			nextChunk.check();
+			U32 expected = fullChunkIdx;
+			m_crntChunkIdx.compareExchange(expected, nextChunkIdx);
+			return true;
+		}
+		else if(state == ChunkState::EMPTY)
+		{
+			// Try to become the thread that creates the chunk
+			if(!nextChunk.m_state.compareExchange(
+				   state, ChunkState::CREATING, AtomicMemoryOrder::ACQUIRE, AtomicMemoryOrder::RELAXED))
+			{
+				continue;
+			}
 
-			LockGuard<Mutex> lock(m_lock);
+			const PtrSize oldChunkSize = m_chunks[fullChunkIdx].m_size;
+			PtrSize newChunkSize = PtrSize(F32(oldChunkSize) * m_nextChunkScale) + m_nextChunkBias;
+			alignRoundUp(m_alignmentBytes, newChunkSize);
 
-			// Make sure that only one thread will create a new chunk
-			if(&m_chunks[m_crntChunkIdx.load()] == crntChunk)
+			void* mem = m_allocCb(m_allocCbUserData, nullptr, newChunkSize, m_alignmentBytes);
+			if(mem == nullptr)
 			{
-				// We can create a new chunk
-
-				PtrSize oldChunkSize = crntChunk->m_size;
-				++crntChunk;
-				if(crntChunk >= m_chunks.getEnd())
-				{
-					ANKI_UTIL_LOGE("Number of chunks is not enough. Expect a crash");
-				}
-
-				if(crntChunk->m_baseMem == nullptr)
-				{
-					// Need to create a new chunk
-
-					PtrSize newChunkSize = PtrSize(F32(oldChunkSize) * m_nextChunkScale) + m_nextChunkBias;
-					alignRoundUp(m_alignmentBytes, newChunkSize);
-
-					void* mem = m_allocCb(m_allocCbUserData, nullptr, newChunkSize, m_alignmentBytes);
-
-					if(mem != nullptr)
-					{
-						invalidateMemory(mem, newChunkSize);
-
-						crntChunk->m_baseMem = static_cast<U8*>(mem);
-						crntChunk->m_mem.store(crntChunk->m_baseMem);
-						crntChunk->m_size = newChunkSize;
-
-						U idx = m_crntChunkIdx.fetchAdd(1);
-						ANKI_ASSERT(&m_chunks[idx] == crntChunk - 1);
-						(void)idx;
-					}
-					else
-					{
-						out = nullptr;
-						retry = false;
-						ANKI_OOM_ACTION();
-					}
-				}
-				else
-				{
-					// Need to recycle one
-
-					crntChunk->checkReset();
-					invalidateMemory(crntChunk->m_baseMem, crntChunk->m_size);
-
-					U idx = m_crntChunkIdx.fetchAdd(1);
-					ANKI_ASSERT(&m_chunks[idx] == crntChunk - 1);
-					(void)idx;
-				}
+				nextChunk.m_state.store(ChunkState::EMPTY, AtomicMemoryOrder::RELEASE);
+				ANKI_OOM_ACTION();
+				return false;
 			}
-		}
-	} while(retry);
 
-	return static_cast<void*>(out);
+			invalidateMemory(mem, newChunkSize);
+
+			nextChunk.m_baseMem = static_cast<U8*>(mem);
+			nextChunk.m_mem.store(nextChunk.m_baseMem);
+			nextChunk.m_size = newChunkSize;
+			nextChunk.m_state.store(ChunkState::READY, AtomicMemoryOrder::RELEASE);
+			m_chunkCount.fetchAdd(1);
+
+			// Other threads may have seen the READY state and advanced already. That's fine
+			U32 expected = fullChunkIdx;
+			m_crntChunkIdx.compareExchange(expected, nextChunkIdx);
+			return true;
+		}
+		else
+		{
+			// Some other thread allocates memory for the chunk. Wait for it
+			ANKI_ASSERT(state == ChunkState::CREATING);
+			std::this_thread::yield();
+		}
+	}
 }
 
 void StackMemoryPool::free(void* ptr)
@@ -417,10 +1040,10 @@ void StackMemoryPool::reset()
 {
 	ANKI_ASSERT(isCreated());
 
-	// Iterate all until you find an unused
+	// Rewind all chunks but keep their memory around for the next frames
 	for(Chunk& ch : m_chunks)
 	{
-		if(ch.m_baseMem != nullptr)
+		if(ch.m_state.load() == ChunkState::READY)
 		{
 			ch.check();
 			ch.m_mem.store(ch.m_baseMem);
@@ -437,6 +1060,14 @@ void StackMemoryPool::reset()
 	m_chunks[0].checkReset();
 	m_crntChunkIdx.store(0);
 
+	// Track the frames that went beyond the high-water mark
+	const U32 chunkCount = m_chunkCount.load();
+	if(chunkCount > m_chunkCountAtLastReset)
+	{
+		++m_growFrameCount;
+		m_chunkCountAtLastReset = chunkCount;
+	}
+
 	// Reset allocation count and do some error checks
 	auto allocCount = m_allocationsCount.exchange(0);
 	if(!m_ignoreDeallocationErrors && allocCount != 0)
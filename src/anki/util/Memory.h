@@ -49,6 +49,81 @@ using AllocationSignature = U32;
 ///         returns nullptr
 void* allocAligned(void* userData, void* ptr, PtrSize size, PtrSize alignment);
 
+/// The subsystems that the memory is attributed to. See MemoryTagTracker.
+enum class MemoryTag : U8
+{
+	CORE,
+	GR,
+	RESOURCE,
+	RENDERER,
+	SCENE,
+	PHYSICS,
+	SCRIPT,
+	UI,
+
+	COUNT
+};
+
+/// The memory statistics of a MemoryTag. @memberof MemoryTagTracker
+class MemoryTagStats
+{
+public:
+	PtrSize m_liveBytes = 0;
+	PtrSize m_peakBytes = 0;
+	U64 m_allocationCount = 0;
+	U64 m_freeCount = 0;
+};
+
+/// Attributes the memory to subsystems. It wraps an allocation callback and every subsystem is given the same wrapper
+/// with the user data of its MemoryTag. That way all the pools and allocators of a subsystem are tagged without
+/// knowing it. Every allocation gets a small header that remembers its size and tag.
+class MemoryTagTracker : public NonCopyable
+{
+public:
+	/// @param allocCb The callback that does the actual allocations.
+	/// @param allocCbUserData The user data of allocCb.
+	void init(AllocAlignedCallback allocCb, void* allocCbUserData);
+
+	/// The callback that the subsystems should use. Pair it with getAllocationCallbackUserData().
+	static AllocAlignedCallback getAllocationCallback()
+	{
+		return allocCallback;
+	}
+
+	/// The user data for the callback of a subsystem.
+	void* getAllocationCallbackUserData(MemoryTag tag)
+	{
+		ANKI_ASSERT(m_allocCb && tag < MemoryTag::COUNT);
+		return &m_tags[U32(tag)];
+	}
+
+	/// Get the stats of all the tags. It's thread-safe but the values of different tags are not read atomically.
+	void getSnapshot(Array<MemoryTagStats, U32(MemoryTag::COUNT)>& stats) const;
+
+	/// Get the stats of all the tags summed. The peak is the sum of the peaks of the tags.
+	MemoryTagStats getTotal() const;
+
+	static const char* getTagName(MemoryTag tag);
+
+private:
+	class alignas(ANKI_CACHE_LINE_SIZE) Tag
+	{
+	public:
+		MemoryTagTracker* m_tracker = nullptr;
+		MemoryTag m_tag = MemoryTag::COUNT;
+		Atomic<PtrSize> m_liveBytes = {0};
+		Atomic<PtrSize> m_peakBytes = {0};
+		Atomic<U64> m_allocationCount = {0};
+		Atomic<U64> m_freeCount = {0};
+	};
+
+	AllocAlignedCallback m_allocCb = nullptr;
+	void* m_allocCbUserData = nullptr;
+	Array<Tag, U32(MemoryTag::COUNT)> m_tags;
+
+	static void* allocCallback(void* userData, void* ptr, PtrSize size, PtrSize alignment);
+};
+
 /// Generic memory pool. The base of HeapMemoryPool or StackMemoryPool or ChainMemoryPool.
 class BaseMemoryPool : public NonCopyable
 {
@@ -130,11 +205,32 @@ private:
 	Type m_type = Type::NONE;
 };
 
+/// Statistics of a size class of HeapMemoryPool. @memberof HeapMemoryPool
+class HeapMemoryPoolSizeClassStats
+{
+public:
+	PtrSize m_maxAllocationSize = 0; ///< The allocations up to that size use this class.
+	U64 m_allocationCount = 0; ///< Number of allocations.
+	U64 m_freeCount = 0; ///< Number of frees.
+	U64 m_remoteFreeCount = 0; ///< Number of frees from threads other than the one that allocated.
+	U32 m_slabCount = 0; ///< Number of slabs allocated using the allocation callback.
+};
+
 /// A dummy interface to match the StackMemoryPool and ChainMemoryPool interfaces in order to be used by the same
 /// allocator template.
+///
+/// In thread caching mode the small allocations are served from blocks of a few size classes. Every thread caches
+/// free blocks and allocates from them without locking. The blocks are carved from big slabs that are allocated with
+/// the allocation callback. Blocks freed by other threads are returned to the thread that allocated them in batches.
+/// When a thread exits, or has caches from too many pools, it gives its caches back to the pools and new threads adopt
+/// them along with their free blocks. The slabs are released when the pool is destroyed.
 class HeapMemoryPool : public BaseMemoryPool
 {
+	friend class HeapPoolThreadExitHook;
+
 public:
+	static constexpr U32 SIZE_CLASS_COUNT = 14;
+
 	/// Default constructor.
 	HeapMemoryPool();
 
@@ -144,7 +240,8 @@ public:
 	/// The real constructor.
 	/// @param allocCb The allocation function callback
 	/// @param allocCbUserData The user data to pass to the allocation function
-	void create(AllocAlignedCallback allocCb, void* allocCbUserData);
+	/// @param threadCaching Enable the thread caching mode.
+	void create(AllocAlignedCallback allocCb, void* allocCbUserData, Bool threadCaching = false);
 
 	/// Allocate memory
 	void* allocate(PtrSize size, PtrSize alignment);
@@ -153,12 +250,53 @@ public:
 	/// @param[in, out] ptr Memory block to deallocate.
 	void free(void* ptr);
 
+	Bool getThreadCaching() const
+	{
+		return m_threadCaching;
+	}
+
+	/// Get the statistics of all size classes. Works only in thread caching mode.
+	/// @note It's thread-safe but the statistics might be a bit out of date.
+	void getSizeClassStatistics(Array<HeapMemoryPoolSizeClassStats, SIZE_CLASS_COUNT>& stats) const;
+
 private:
+	class ThreadCache;
+	class BlockHeader;
+	class Slab;
+
 #if ANKI_MEM_USE_SIGNATURES
 	AllocationSignature m_signature = 0;
 	static const U32 MAX_ALIGNMENT = 64;
 	U32 m_headerSize = 0;
 #endif
+
+	/// @name Thread caching mode
+	/// @{
+	Bool m_threadCaching = false;
+	U64 m_uuid = 0; ///< Used to find the ThreadCache of the calling thread.
+	Atomic<ThreadCache*> m_threadCaches = {nullptr}; ///< A list of all ThreadCache.
+	Atomic<Slab*> m_slabs = {nullptr}; ///< A list of all slabs.
+	HeapMemoryPool* m_nextThreadCachingPool = nullptr; ///< Next in the list of the live thread caching pools.
+	/// @}
+
+	void* allocateCached(PtrSize size, PtrSize alignment);
+	void freeCached(void* ptr);
+
+	/// Get, adopt or create the ThreadCache of the calling thread.
+	ThreadCache& getThreadCache();
+
+	/// Give a ThreadCache that the calling thread doesn't use anymore back to its pool. It does nothing if the pool is
+	/// destroyed.
+	static void releaseThreadCache(U64 poolUuid, void* cache);
+
+	/// Allocate a new slab and give its blocks to a ThreadCache.
+	void newSlab(ThreadCache& cache, U32 sizeClass);
+
+	/// Give some blocks to the ThreadCache that allocated them.
+	static void pushRemoteFrees(ThreadCache& owner, U32 sizeClass, void* first, void* last);
+
+	/// Push the remote free batch of a size class of a ThreadCache back to its owner.
+	static void flushRemoteFreeBatch(ThreadCache& cache, U32 sizeClass);
 };
 
 /// Thread safe memory pool. It's a preallocated memory pool that is used for memory allocations on top of that
@@ -208,7 +346,28 @@ public:
 	/// Get the current capacity of the pool. It's not thread safe.
 	PtrSize getMemoryCapacity() const;
 
+	/// Get the number of chunks the pool owns. Chunks survive reset() and they are only freed on destruction.
+	U32 getChunkCount() const
+	{
+		return m_chunkCount.load();
+	}
+
+	/// Get how many times a frame (the period between two reset() calls) had to allocate new chunks because the
+	/// cached ones were not enough. In steady state this should stop increasing.
+	U32 getGrowFrameCount() const
+	{
+		return m_growFrameCount;
+	}
+
 private:
+	/// The state of a Chunk.
+	enum class ChunkState : U32
+	{
+		EMPTY, ///< No memory.
+		CREATING, ///< A thread is allocating the chunk's memory.
+		READY ///< It has memory and it can be used.
+	};
+
 	/// The memory chunk.
 	class Chunk
 	{
@@ -222,6 +381,9 @@ private:
 		/// The chunk size.
 		PtrSize m_size = 0;
 
+		/// Guards the creation of the chunk. m_baseMem and m_size are valid only if it's READY.
+		Atomic<ChunkState> m_state = {ChunkState::EMPTY};
+
 		/// Check that it's initialized.
 		void check() const
 		{
@@ -264,8 +426,18 @@ private:
 	/// The chunks.
 	Array<Chunk, MAX_CHUNKS> m_chunks;
 
-	/// Protect the m_crntChunkIdx.
-	Mutex m_lock;
+	/// The number of chunks with memory.
+	Atomic<U32> m_chunkCount = {0};
+
+	/// The chunk count at the time of the last reset().
+	U32 m_chunkCountAtLastReset = 0;
+
+	/// @see getGrowFrameCount
+	U32 m_growFrameCount = 0;
+
+	/// Advance m_crntChunkIdx past a full chunk. Recycles a cached chunk or creates a new one.
+	/// @return false on OOM.
+	Bool acquireNextChunk(U32 fullChunkIdx);
 };
 
 /// Chain memory pool. Almost similar to StackMemoryPool but more flexible and at the same time a bit slower.
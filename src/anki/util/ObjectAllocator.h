@@ -6,6 +6,9 @@
 #pragma once
 
 #include <anki/util/Array.h>
+#include <anki/util/NonCopyable.h>
+#include <anki/util/DynamicArray.h>
+#include <anki/util/Thread.h>
 
 namespace anki
 {
@@ -13,6 +16,24 @@ namespace anki
 /// @addtogroup util_containers
 /// @{
 
+/// The counters of an ObjectAllocator or of a single type of a TypedObjectAllocator.
+class ObjectAllocatorStatistics
+{
+public:
+	PtrSize m_objectSize = 0; ///< The size of a slot.
+	U32 m_objectsPerChunk = 0;
+	U32 m_liveCount = 0; ///< The objects that are allocated now.
+	U32 m_peakCount = 0; ///< The maximum m_liveCount.
+	U32 m_chunkCount = 0; ///< The chunks that are allocated now.
+
+	/// The fraction of the allocated slots that are unused. Zero means that the chunks are full.
+	F32 getFragmentation() const
+	{
+		const U32 slotCount = m_chunkCount * m_objectsPerChunk;
+		return (slotCount > 0) ? 1.0f - F32(m_liveCount) / F32(slotCount) : 0.0f;
+	}
+};
+
 /// A simple allocator for objects of similar types.
 /// @tparam T_OBJECT_SIZE       The maximum size of the objects.
 /// @tparam T_OBJECT_ALIGNMENT  The maximum alignment of the objects.
@@ -45,6 +66,15 @@ public:
 	template<typename T, typename TAlloc>
 	void deleteInstance(TAlloc& alloc, T* obj);
 
+	/// Get the counters.
+	ObjectAllocatorStatistics getStatistics() const
+	{
+		ObjectAllocatorStatistics stats = m_stats;
+		stats.m_objectSize = sizeof(Object);
+		stats.m_objectsPerChunk = OBJECTS_PER_CHUNK;
+		return stats;
+	}
+
 private:
 	/// Storage with equal properties as the object.
 	struct alignas(OBJECT_ALIGNMENT) Object
@@ -57,7 +87,7 @@ private:
 	{
 	public:
 		Array<Object, OBJECTS_PER_CHUNK> m_objects;
-		Array<U32, OBJECTS_PER_CHUNK> m_unusedStack;
+		Array<TIndexType, OBJECTS_PER_CHUNK> m_unusedStack;
 		U32 m_unusedCount;
 
 		Chunk* m_next = nullptr;
@@ -66,6 +96,9 @@ private:
 
 	Chunk* m_chunksHead = nullptr;
 	Chunk* m_chunksTail = nullptr;
+	ObjectAllocatorStatistics m_stats;
+
+	static_assert(OBJECTS_PER_CHUNK - 1 <= TIndexType(~TIndexType(0)), "TIndexType is too small");
 };
 
 /// Convenience wrapper for ObjectAllocator.
@@ -80,7 +113,7 @@ public:
 	template<typename TAlloc, typename... TArgs>
 	T* newInstance(TAlloc& alloc, TArgs&&... args)
 	{
-		return Base::template newInstance<T>(alloc, std::forward(args)...);
+		return Base::template newInstance<T>(alloc, std::forward<TArgs>(args)...);
 	}
 
 	/// Delete an object.
@@ -91,6 +124,120 @@ public:
 		Base::deleteInstance(alloc, obj);
 	}
 };
+
+/// An allocator that keeps a pool for each type that is allocated through it. Objects of the same type are packed in
+/// the same chunks so iterating them has good cache locality, and each type has its own ObjectAllocatorStatistics.
+/// Objects can be deleted through a pointer to a base class.
+/// @note It's thread-safe.
+/// @tparam T_OBJECTS_PER_CHUNK How many objects of a type will be allocated at once.
+template<U32 T_OBJECTS_PER_CHUNK = 64>
+class TypedObjectAllocator : public NonCopyable
+{
+public:
+	static constexpr U32 OBJECTS_PER_CHUNK = T_OBJECTS_PER_CHUNK;
+
+	TypedObjectAllocator()
+	{
+	}
+
+	~TypedObjectAllocator()
+	{
+		ANKI_ASSERT(m_pools.isEmpty() && "Forgot to destroy");
+	}
+
+	/// Free the memory of all pools. All objects should have been deleted.
+	template<typename TAlloc>
+	void destroy(TAlloc& alloc);
+
+	/// Allocate and construct a new object instance.
+	template<typename T, typename TAlloc, typename... TArgs>
+	T* newInstance(TAlloc& alloc, TArgs&&... args);
+
+	/// Delete an object. T can be a base class of the type the object was created with if the destructor is virtual
+	/// and the base is placed at the start of the object.
+	template<typename T, typename TAlloc>
+	void deleteInstance(TAlloc& alloc, T* obj);
+
+	/// Get the counters of a type.
+	template<typename T>
+	ObjectAllocatorStatistics getStatistics() const
+	{
+		LockGuard<Mutex> lock(m_mtx);
+		const Pool* pool = tryFindPool(getTypeKey<T>());
+		return (pool) ? pool->m_stats : ObjectAllocatorStatistics();
+	}
+
+	/// Iterate the counters of all the types that have been allocated.
+	/// @param func A functor with the signature void(const ObjectAllocatorStatistics&).
+	template<typename TFunc>
+	void iterateStatistics(TFunc func) const
+	{
+		LockGuard<Mutex> lock(m_mtx);
+		for(const Pool* pool : m_pools)
+		{
+			func(pool->m_stats);
+		}
+	}
+
+private:
+	class Chunk;
+
+	/// The objects of a single type.
+	class Pool
+	{
+	public:
+		const void* m_typeKey = nullptr;
+		PtrSize m_headerSize = 0; ///< The space before the object that holds the Chunk pointer.
+		U32 m_alignment = 0;
+		Chunk* m_freeChunksHead = nullptr; ///< The chunks with unused slots.
+		ObjectAllocatorStatistics m_stats;
+	};
+
+	/// A single allocation. The slots follow it in memory.
+	class Chunk
+	{
+	public:
+		Pool* m_pool = nullptr;
+		Chunk* m_prev = nullptr; ///< In the Pool::m_freeChunksHead list.
+		Chunk* m_next = nullptr; ///< In the Pool::m_freeChunksHead list.
+		U8* m_slots = nullptr;
+		void* m_freeSlots = nullptr; ///< A list of the deleted slots. The next pointer is stored in the slot.
+		U32 m_unusedCount = OBJECTS_PER_CHUNK;
+		U32 m_untouchedCount = OBJECTS_PER_CHUNK; ///< The slots at the end that were never used.
+	};
+
+	DynamicArray<Pool*> m_pools;
+	mutable Mutex m_mtx;
+
+	/// Get an address that is unique for each type.
+	template<typename T>
+	static const void* getTypeKey()
+	{
+		static const U8 key = 0;
+		return &key;
+	}
+
+	const Pool* tryFindPool(const void* typeKey) const
+	{
+		for(const Pool* pool : m_pools)
+		{
+			if(pool->m_typeKey == typeKey)
+			{
+				return pool;
+			}
+		}
+
+		return nullptr;
+	}
+
+	Pool* tryFindPool(const void* typeKey)
+	{
+		return const_cast<Pool*>(static_cast<const TypedObjectAllocator&>(*this).tryFindPool(typeKey));
+	}
+
+	static void linkFreeChunk(Pool& pool, Chunk& chunk);
+	static void unlinkFreeChunk(Pool& pool, Chunk& chunk);
+};
 /// @}
 
 } // end namespace anki
@@ -43,9 +43,11 @@ T* ObjectAllocator<T_OBJECT_SIZE, T_OBJECT_ALIGNMENT, T_OBJECTS_PER_CHUNK, TInde
 
 		for(U32 i = 0; i < OBJECTS_PER_CHUNK; ++i)
 		{
-			chunk->m_unusedStack[i] = OBJECTS_PER_CHUNK - (i + 1);
+			chunk->m_unusedStack[i] = TIndexType(OBJECTS_PER_CHUNK - (i + 1));
 		}
 
+		++m_stats.m_chunkCount;
+
 		if(m_chunksTail)
 		{
 			ANKI_ASSERT(m_chunksHead);
@@ -65,6 +67,9 @@ T* ObjectAllocator<T_OBJECT_SIZE, T_OBJECT_ALIGNMENT, T_OBJECTS_PER_CHUNK, TInde
 
 	ANKI_ASSERT(out);
 
+	++m_stats.m_liveCount;
+	m_stats.m_peakCount = max(m_stats.m_peakCount, m_stats.m_liveCount);
+
 	// Construct it
 	alloc.construct(out, std::forward<TArgs>(args)...);
 
@@ -99,8 +104,10 @@ void ObjectAllocator<T_OBJECT_SIZE, T_OBJECT_ALIGNMENT, T_OBJECTS_PER_CHUNK, TIn
 			obj->~T();
 
 			// Remove from the chunk
-			chunk->m_unusedStack[chunk->m_unusedCount] = idx;
+			chunk->m_unusedStack[chunk->m_unusedCount] = TIndexType(idx);
 			++chunk->m_unusedCount;
+			ANKI_ASSERT(m_stats.m_liveCount > 0);
+			--m_stats.m_liveCount;
 
 			// Delete the chunk if it's empty
 			if(chunk->m_unusedCount == OBJECTS_PER_CHUNK)
@@ -128,6 +135,7 @@ void ObjectAllocator<T_OBJECT_SIZE, T_OBJECT_ALIGNMENT, T_OBJECTS_PER_CHUNK, TIn
 				}
 
 				alloc.deleteInstance(chunk);
+				--m_stats.m_chunkCount;
 			}
 
 			break;
@@ -139,4 +147,179 @@ void ObjectAllocator<T_OBJECT_SIZE, T_OBJECT_ALIGNMENT, T_OBJECTS_PER_CHUNK, TIn
 	ANKI_ASSERT(chunk != nullptr);
 }
 
+template<U32 T_OBJECTS_PER_CHUNK>
+template<typename TAlloc>
+void TypedObjectAllocator<T_OBJECTS_PER_CHUNK>::destroy(TAlloc& alloc)
+{
+	LockGuard<Mutex> lock(m_mtx);
+
+	for(Pool* pool : m_pools)
+	{
+		ANKI_ASSERT(pool->m_stats.m_liveCount == 0 && "Forgot to delete some objects");
+
+		// Only empty chunks are left and they are all in the free list
+		Chunk* chunk = pool->m_freeChunksHead;
+		while(chunk)
+		{
+			Chunk* next = chunk->m_next;
+			alloc.getMemoryPool().free(chunk);
+			--pool->m_stats.m_chunkCount;
+			chunk = next;
+		}
+
+		ANKI_ASSERT(pool->m_stats.m_chunkCount == 0);
+		alloc.deleteInstance(pool);
+	}
+
+	m_pools.destroy(alloc);
+}
+
+template<U32 T_OBJECTS_PER_CHUNK>
+template<typename T, typename TAlloc, typename... TArgs>
+T* TypedObjectAllocator<T_OBJECTS_PER_CHUNK>::newInstance(TAlloc& alloc, TArgs&&... args)
+{
+	void* mem;
+
+	{
+		LockGuard<Mutex> lock(m_mtx);
+
+		// Get the pool of the type
+		Pool* pool = tryFindPool(getTypeKey<T>());
+		if(ANKI_UNLIKELY(pool == nullptr))
+		{
+			pool = alloc.template newInstance<Pool>();
+			pool->m_typeKey = getTypeKey<T>();
+			pool->m_alignment = max(U32(alignof(T)), U32(alignof(Chunk*)));
+			pool->m_headerSize = getAlignedRoundUp(pool->m_alignment, sizeof(Chunk*));
+			pool->m_stats.m_objectSize = pool->m_headerSize + getAlignedRoundUp(pool->m_alignment, sizeof(T));
+			pool->m_stats.m_objectsPerChunk = OBJECTS_PER_CHUNK;
+			m_pools.emplaceBack(alloc, pool);
+		}
+
+		// Get a chunk with free slots
+		Chunk* chunk = pool->m_freeChunksHead;
+		if(chunk == nullptr)
+		{
+			const PtrSize slotsOffset = getAlignedRoundUp(pool->m_alignment, sizeof(Chunk));
+			const PtrSize chunkSize = slotsOffset + pool->m_stats.m_objectSize * OBJECTS_PER_CHUNK;
+			U8* chunkMem = static_cast<U8*>(
+				alloc.getMemoryPool().allocate(chunkSize, max<PtrSize>(pool->m_alignment, alignof(Chunk))));
+
+			chunk = ::new(chunkMem) Chunk();
+			chunk->m_pool = pool;
+			chunk->m_slots = chunkMem + slotsOffset;
+
+			linkFreeChunk(*pool, *chunk);
+			++pool->m_stats.m_chunkCount;
+		}
+
+		// Get a slot. Prefer the deleted ones since they are warm in the cache
+		U8* slot;
+		if(chunk->m_freeSlots)
+		{
+			slot = static_cast<U8*>(chunk->m_freeSlots);
+			memcpy(&chunk->m_freeSlots, slot + pool->m_headerSize, sizeof(void*));
+		}
+		else
+		{
+			ANKI_ASSERT(chunk->m_untouchedCount > 0);
+			slot = chunk->m_slots + pool->m_stats.m_objectSize * (OBJECTS_PER_CHUNK - chunk->m_untouchedCount);
+			--chunk->m_untouchedCount;
+		}
+
+		--chunk->m_unusedCount;
+		if(chunk->m_unusedCount == 0)
+		{
+			unlinkFreeChunk(*pool, *chunk);
+		}
+
+		++pool->m_stats.m_liveCount;
+		pool->m_stats.m_peakCount = max(pool->m_stats.m_peakCount, pool->m_stats.m_liveCount);
+
+		// Store the chunk right before the object
+		mem = slot + pool->m_headerSize;
+		memcpy(static_cast<U8*>(mem) - sizeof(Chunk*), &chunk, sizeof(Chunk*));
+	}
+
+	return ::new(mem) T(std::forward<TArgs>(args)...);
+}
+
+template<U32 T_OBJECTS_PER_CHUNK>
+template<typename T, typename TAlloc>
+void TypedObjectAllocator<T_OBJECTS_PER_CHUNK>::deleteInstance(TAlloc& alloc, T* obj)
+{
+	ANKI_ASSERT(obj);
+
+	obj->~T();
+
+	U8* mem = reinterpret_cast<U8*>(obj);
+	Chunk* chunk;
+	memcpy(&chunk, mem - sizeof(Chunk*), sizeof(Chunk*));
+
+	LockGuard<Mutex> lock(m_mtx);
+
+	Pool& pool = *chunk->m_pool;
+	U8* slot = mem - pool.m_headerSize;
+	ANKI_ASSERT(slot >= chunk->m_slots && slot < chunk->m_slots + pool.m_stats.m_objectSize * OBJECTS_PER_CHUNK);
+	ANKI_ASSERT(PtrSize(slot - chunk->m_slots) % pool.m_stats.m_objectSize == 0
+				&& "The object doesn't start where it was allocated");
+	ANKI_ASSERT(chunk->m_unusedCount < OBJECTS_PER_CHUNK);
+
+	// Put the slot to the free list of the chunk
+	memcpy(mem, &chunk->m_freeSlots, sizeof(void*));
+	chunk->m_freeSlots = slot;
+
+	if(chunk->m_unusedCount == 0)
+	{
+		linkFreeChunk(pool, *chunk);
+	}
+	++chunk->m_unusedCount;
+
+	ANKI_ASSERT(pool.m_stats.m_liveCount > 0);
+	--pool.m_stats.m_liveCount;
+
+	// Free the chunk when it's empty but keep the last one to avoid thrashing
+	if(chunk->m_unusedCount == OBJECTS_PER_CHUNK && pool.m_stats.m_chunkCount > 1)
+	{
+		unlinkFreeChunk(pool, *chunk);
+		alloc.getMemoryPool().free(chunk);
+		--pool.m_stats.m_chunkCount;
+	}
+}
+
+template<U32 T_OBJECTS_PER_CHUNK>
+void TypedObjectAllocator<T_OBJECTS_PER_CHUNK>::linkFreeChunk(Pool& pool, Chunk& chunk)
+{
+	ANKI_ASSERT(chunk.m_prev == nullptr && chunk.m_next == nullptr && pool.m_freeChunksHead != &chunk);
+	chunk.m_next = pool.m_freeChunksHead;
+	if(pool.m_freeChunksHead)
+	{
+		pool.m_freeChunksHead->m_prev = &chunk;
+	}
+	pool.m_freeChunksHead = &chunk;
+}
+
+template<U32 T_OBJECTS_PER_CHUNK>
+void TypedObjectAllocator<T_OBJECTS_PER_CHUNK>::unlinkFreeChunk(Pool& pool, Chunk& chunk)
+{
+	if(chunk.m_prev)
+	{
+		ANKI_ASSERT(chunk.m_prev->m_next == &chunk);
+		chunk.m_prev->m_next = chunk.m_next;
+	}
+	else
+	{
+		ANKI_ASSERT(pool.m_freeChunksHead == &chunk);
+		pool.m_freeChunksHead = chunk.m_next;
+	}
+
+	if(chunk.m_next)
+	{
+		ANKI_ASSERT(chunk.m_next->m_prev == &chunk);
+		chunk.m_next->m_prev = chunk.m_prev;
+	}
+
+	chunk.m_prev = chunk.m_next = nullptr;
+}
+
 } // end namespace anki
@@ -0,0 +1,89 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/util/StdTypes.h>
+#include <anki/util/Array.h>
+#include <anki/util/WeakArray.h>
+#include <anki/util/Assert.h>
+#include <anki/util/Functions.h>
+#include <cstring>
+
+namespace anki
+{
+
+/// @addtogroup util_other
+/// @{
+
+/// Stable LSD radix sort on a 64bit key. It sorts 8 bits per pass and skips the passes where all the keys have the
+/// same byte (usually the high bytes), so small keys cost only a few passes.
+/// @param[in,out] arr The array to sort.
+/// @param[in,out] tmp Scratch memory with the same size as the arr.
+/// @param getKey Functor that returns the U64 key of an element.
+/// @return The array that holds the sorted elements. Depending on the number of passes it's either arr or tmp.
+template<typename T, typename TGetKey>
+WeakArray<T> radixSort(WeakArray<T> arr, WeakArray<T> tmp, TGetKey getKey)
+{
+	ANKI_ASSERT(arr.getSize() == tmp.getSize());
+	const PtrSize count = arr.getSize();
+	if(count < 2)
+	{
+		return arr;
+	}
+
+	constexpr U32 BITS_PER_PASS = 8;
+	constexpr U32 BUCKET_COUNT = 1 << BITS_PER_PASS;
+	constexpr U32 PASS_COUNT = 64 / BITS_PER_PASS;
+
+	// Count the bytes of all the passes at once
+	Array2d<PtrSize, PASS_COUNT, BUCKET_COUNT> histograms;
+	memset(&histograms[0][0], 0, sizeof(histograms));
+	for(const T& el : arr)
+	{
+		const U64 key = getKey(el);
+		for(U32 pass = 0; pass < PASS_COUNT; ++pass)
+		{
+			++histograms[pass][(key >> (pass * BITS_PER_PASS)) & (BUCKET_COUNT - 1)];
+		}
+	}
+
+	T* in = arr.getBegin();
+	T* out = tmp.getBegin();
+	for(U32 pass = 0; pass < PASS_COUNT; ++pass)
+	{
+		Array<PtrSize, BUCKET_COUNT>& histogram = histograms[pass];
+
+		// All the keys in the same bucket, nothing to do
+		const U32 firstBucket = U32((getKey(in[0]) >> (pass * BITS_PER_PASS)) & (BUCKET_COUNT - 1));
+		if(histogram[firstBucket] == count)
+		{
+			continue;
+		}
+
+		// Prefix sum
+		PtrSize offset = 0;
+		for(PtrSize& c : histogram)
+		{
+			const PtrSize bucketCount = c;
+			c = offset;
+			offset += bucketCount;
+		}
+
+		// Scatter
+		for(PtrSize i = 0; i < count; ++i)
+		{
+			const U32 bucket = U32((getKey(in[i]) >> (pass * BITS_PER_PASS)) & (BUCKET_COUNT - 1));
+			out[histogram[bucket]++] = in[i];
+		}
+
+		swapValues(in, out);
+	}
+
+	return (in == arr.getBegin()) ? arr : tmp;
+}
+/// @}
+
+} // end namespace anki
@@ -41,4 +41,57 @@ Error BinarySerializer::doDynamicArrayBasicType(const void* arr, PtrSize size, U
 	return Error::NONE;
 }
 
+Error BinaryDeserializer::checkHeader(
+	const detail::BinarySerializerHeader& header, PtrSize sizeAfterHeader, PtrSize rootStructSize)
+{
+	if(memcmp(&header.m_magic[0], detail::BINARY_SERIALIZER_MAGIC, 8) != 0)
+	{
+		ANKI_UTIL_LOGE("Wrong magic work in header");
+		return Error::USER_DATA;
+	}
+
+	if(header.m_dataSize < rootStructSize)
+	{
+		ANKI_UTIL_LOGE("Wrong data size");
+		return Error::USER_DATA;
+	}
+
+	// The pointer offsets come right after the data
+	if(header.m_dataSize > sizeAfterHeader
+		|| header.m_pointerCount > (sizeAfterHeader - header.m_dataSize) / sizeof(PtrSize)
+		|| (header.m_pointerCount
+			   && header.m_pointerArrayFilePosition != sizeof(detail::BinarySerializerHeader) + header.m_dataSize))
+	{
+		ANKI_UTIL_LOGE("File size doesn't match expectations");
+		return Error::USER_DATA;
+	}
+
+	return Error::NONE;
+}
+
+Error BinaryDeserializer::relocate(U8* data, PtrSize dataSize, const U8* pointerOffsets, PtrSize pointerCount)
+{
+	for(PtrSize i = 0; i < pointerCount; ++i)
+	{
+		const PtrSize offset = readUnaligned(pointerOffsets, i);
+		if(offset > dataSize || dataSize - offset < sizeof(PtrSize) || !isAligned(alignof(PtrSize), offset))
+		{
+			ANKI_UTIL_LOGE("Corrupt pointer");
+			return Error::USER_DATA;
+		}
+
+		// Add to the location the actual base address
+		PtrSize& ptrValue = *reinterpret_cast<PtrSize*>(data + offset);
+		if(ptrValue >= dataSize)
+		{
+			ANKI_UTIL_LOGE("Corrupt pointer");
+			return Error::USER_DATA;
+		}
+
+		ptrValue += ptrToNumber(data);
+	}
+
+	return Error::NONE;
+}
+
 } // end namespace anki
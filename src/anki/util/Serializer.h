@@ -11,6 +11,12 @@
 namespace anki
 {
 
+// Forward
+namespace detail
+{
+class BinarySerializerHeader;
+}
+
 /// @addtogroup util_file
 /// @{
 
@@ -188,13 +194,28 @@ private:
 class BinaryDeserializer : public NonCopyable
 {
 public:
-	/// Serialize a class.
-	/// @param x The struct to read.
+	/// Serialize a class. The file is read with a single read into a single allocation and the pointers are patched
+	/// in place.
+	/// @param x The struct to read. Free it with the allocator's memory pool.
 	/// @param allocator The allocator to use to allocate the new structures.
 	/// @param file The file to read from.
 	template<typename T>
 	static ANKI_USE_RESULT Error deserialize(T*& x, GenericMemoryPoolAllocator<U8> allocator, File& file);
 
+	/// Deserialize a class that is already in memory. The pointers are patched in place so there are no allocations
+	/// or copies. After that the data can't be deserialized again.
+	/// @param data The contents of the whole file. They should be aligned to ANKI_SAFE_ALIGNMENT.
+	/// @param[out] x The struct. It points inside @a data.
+	template<typename T>
+	static ANKI_USE_RESULT Error deserializeInPlace(WeakArray<U8, PtrSize> data, T*& x);
+
+	/// Check serialized data without changing them. It walks the whole class and checks that all its pointers are
+	/// known and that the arrays they point to are inside the data. Use it on untrusted data before
+	/// deserializeInPlace().
+	/// @param data The contents of the whole file. They should be aligned to ANKI_SAFE_ALIGNMENT.
+	template<typename T>
+	static ANKI_USE_RESULT Error validate(ConstWeakArray<U8, PtrSize> data);
+
 	/// Read a single value. Can't call this directly.
 	template<typename T>
 	void doValue(CString varName, PtrSize memberOffset, T& x)
@@ -222,6 +243,33 @@ public:
 	{
 		// Do nothing
 	}
+
+private:
+	class Validator;
+
+	/// Check the header against the size of the rest of the file.
+	static ANKI_USE_RESULT Error checkHeader(
+		const detail::BinarySerializerHeader& header, PtrSize sizeAfterHeader, PtrSize rootStructSize);
+
+	/// Add the address of the data to all pointers.
+	/// @param data The data.
+	/// @param dataSize The size of the data.
+	/// @param pointerOffsets The locations of the pointers. It might not be aligned.
+	/// @param pointerCount The number of the pointers.
+	static ANKI_USE_RESULT Error relocate(U8* data, PtrSize dataSize, const U8* pointerOffsets, PtrSize pointerCount);
+
+	/// Read an item of an array that might not be aligned.
+	static PtrSize readUnaligned(const U8* arr, PtrSize idx)
+	{
+		PtrSize out;
+		memcpy(&out, arr + idx * sizeof(PtrSize), sizeof(out));
+		return out;
+	}
+
+	/// Get the header and the data from the contents of a file.
+	template<typename T>
+	static ANKI_USE_RESULT Error getData(
+		ConstWeakArray<U8, PtrSize> file, detail::BinarySerializerHeader& header, const U8*& data);
 };
 /// @}
 
@@ -68,6 +68,9 @@ Error BinarySerializer::serializeInternal(const T& x, GenericMemoryPoolAllocator
 		pointerFilePositions.emplaceBack(offsetAfterHeader);
 	}
 
+	// Sorted so the validation can search them
+	std::sort(pointerFilePositions.getBegin(), pointerFilePositions.getEnd());
+
 	// Write the pointer offsets
 	if(pointerFilePositions.getSize() > 0)
 	{
@@ -163,74 +166,277 @@ Error BinarySerializer::doDynamicArrayComplexType(const T* arr, PtrSize size, Pt
 	return Error::NONE;
 }
 
-template<typename T>
-Error BinaryDeserializer::deserialize(T*& x, GenericMemoryPoolAllocator<U8> allocator, File& file)
+#define _ANKI_SIMPLE_TYPE (std::is_integral<T>::value || std::is_floating_point<T>::value || std::is_enum<T>::value)
+
+/// Walks a serialized class and checks its pointers. Has the interface of a deserializer. The data are not relocated
+/// so the pointers are offsets from the beginning of the data.
+class BinaryDeserializer::Validator
 {
-	x = nullptr;
+public:
+	static constexpr U32 MAX_DEPTH = 32;
+
+	const U8* m_data = nullptr;
+	PtrSize m_dataSize = 0;
+	const U8* m_pointerOffsets = nullptr; ///< Sorted. It might not be aligned.
+	PtrSize m_pointerCount = 0;
+	PtrSize m_visitedPointerCount = 0;
+	PtrSize m_budget = 0; ///< How many bytes the arrays can still have. Catches overlapping and cyclic arrays.
+	Array<PtrSize, MAX_DEPTH> m_structOffsets;
+	U32 m_depth = 0;
+	Error m_err = Error::NONE;
+
+	template<typename T>
+	void visitStruct(PtrSize offset)
+	{
+		if(m_depth == MAX_DEPTH)
+		{
+			ANKI_UTIL_LOGE("Serialized data are nested too deep");
+			m_err = Error::USER_DATA;
+			return;
+		}
 
-	detail::BinarySerializerHeader header;
-	ANKI_CHECK(file.read(&header, sizeof(header)));
-	const PtrSize dataFilePos = file.tell();
+		// Work on a copy because the deserialize functors write to the struct
+		alignas(T) Array<U8, sizeof(T)> storage;
+		memcpy(&storage[0], m_data + offset, sizeof(T));
+
+		m_structOffsets[m_depth++] = offset;
+		DeserializeFunctor<T>()(*reinterpret_cast<T*>(&storage[0]), *this);
+		--m_depth;
+	}
+
+	template<typename T>
+	void doValue(CString varName, PtrSize memberOffset, T& x)
+	{
+		doArray(varName, memberOffset, &x, 1);
+	}
 
-	// Sanity checks
+	template<typename T, ANKI_ENABLE(!_ANKI_SIMPLE_TYPE)>
+	void doArray(CString varName, PtrSize memberOffset, T* arr, PtrSize size)
 	{
-		if(memcmp(&header.m_magic[0], detail::BINARY_SERIALIZER_MAGIC, 8) != 0)
+		const PtrSize structOffset = m_structOffsets[m_depth - 1];
+		for(PtrSize i = 0; i < size && !m_err; ++i)
 		{
-			ANKI_UTIL_LOGE("Wrong magic work in header");
-			return Error::USER_DATA;
+			visitStruct<T>(structOffset + memberOffset + i * sizeof(T));
 		}
+	}
+
+	template<typename T, ANKI_ENABLE(_ANKI_SIMPLE_TYPE)>
+	void doArray(CString varName, PtrSize memberOffset, T* arr, PtrSize size)
+	{
+		// Read the values since the deserialize functors might use them
+		const PtrSize offset = m_structOffsets[m_depth - 1] + memberOffset;
+		ANKI_ASSERT(offset + sizeof(T) * size <= m_dataSize);
+		memcpy(arr, m_data + offset, sizeof(T) * size);
+	}
+
+	template<typename T>
+	void doPointer(CString varName, PtrSize memberOffset, T* ptr)
+	{
+		doDynamicArray(varName, memberOffset, ptr, (ptr) ? 1 : 0);
+	}
 
-		if(header.m_dataSize < sizeof(T))
+	/// @param[out] arr Points inside the data. The deserialize functors use it but it shouldn't be dereferenced.
+	template<typename T>
+	void doDynamicArray(CString varName, PtrSize memberOffset, T*& arr, PtrSize size)
+	{
+		if(size == 0)
 		{
-			ANKI_UTIL_LOGE("Wrong data size");
-			return Error::USER_DATA;
+			return;
 		}
 
-		const PtrSize expectedSizeAfterHeader = header.m_dataSize + header.m_pointerCount * sizeof(void*);
-		const PtrSize actualSizeAfterHeader = file.getSize() - dataFilePos;
-		if(expectedSizeAfterHeader > actualSizeAfterHeader)
+		// Never null because the functors might check it against the size
+		arr = reinterpret_cast<T*>(const_cast<U8*>(m_data));
+		if(m_err)
 		{
-			ANKI_UTIL_LOGE("File size doesn't match expectations");
-			return Error::USER_DATA;
+			return;
 		}
-	}
 
-	// Allocate & read data
-	U8* const baseAddress =
-		static_cast<U8*>(allocator.getMemoryPool().allocate(header.m_dataSize, ANKI_SAFE_ALIGNMENT));
-	ANKI_CHECK(file.read(baseAddress, header.m_dataSize));
+		const PtrSize location = m_structOffsets[m_depth - 1] + memberOffset;
+		PtrSize value;
+		memcpy(&value, m_data + location, sizeof(value));
 
-	// Fix pointers
-	if(header.m_pointerCount)
+		if(!isKnownPointer(location))
+		{
+			ANKI_UTIL_LOGE("Pointer not in the pointer list: %s", varName.cstr());
+			m_err = Error::USER_DATA;
+		}
+		else if(value == 0 || !isAligned(alignof(T), value) || value > m_dataSize
+				|| size > (m_dataSize - value) / sizeof(T))
+		{
+			ANKI_UTIL_LOGE("Array out of bounds: %s", varName.cstr());
+			m_err = Error::USER_DATA;
+		}
+		else if(size * sizeof(T) > m_budget)
+		{
+			ANKI_UTIL_LOGE("Arrays overlap: %s", varName.cstr());
+			m_err = Error::USER_DATA;
+		}
+		else
+		{
+			m_budget -= size * sizeof(T);
+			++m_visitedPointerCount;
+			arr = reinterpret_cast<T*>(const_cast<U8*>(m_data + value));
+			visitArrayElements(static_cast<T*>(nullptr), value, size);
+		}
+	}
+
+private:
+	Bool isKnownPointer(PtrSize location) const
 	{
-		ANKI_CHECK(file.seek(header.m_pointerArrayFilePosition, FileSeekOrigin::BEGINNING));
-		for(PtrSize i = 0; i < header.m_pointerCount; ++i)
+		PtrSize first = 0;
+		PtrSize last = m_pointerCount;
+		while(first < last)
 		{
-			// Read the location of the pointer
-			PtrSize offsetFromBeginOfData;
-			ANKI_CHECK(file.read(&offsetFromBeginOfData, sizeof(offsetFromBeginOfData)));
-			if(offsetFromBeginOfData >= header.m_dataSize)
+			const PtrSize mid = first + (last - first) / 2;
+			const PtrSize offset = readUnaligned(m_pointerOffsets, mid);
+			if(offset == location)
 			{
-				ANKI_UTIL_LOGE("Corrupt pointer");
-				return Error::USER_DATA;
+				return true;
 			}
-
-			// Add to the location the actual base address
-			U8* ptrLocation = baseAddress + offsetFromBeginOfData;
-			PtrSize& ptrValue = *reinterpret_cast<PtrSize*>(ptrLocation);
-			if(ptrValue >= header.m_dataSize)
+			else if(offset < location)
+			{
+				first = mid + 1;
+			}
+			else
 			{
-				ANKI_UTIL_LOGE("Corrupt pointer");
-				return Error::USER_DATA;
+				last = mid;
 			}
+		}
+
+		return false;
+	}
 
-			ptrValue += ptrToNumber(baseAddress);
+	template<typename T, ANKI_ENABLE(!_ANKI_SIMPLE_TYPE)>
+	void visitArrayElements(T*, PtrSize offset, PtrSize size)
+	{
+		for(PtrSize i = 0; i < size && !m_err; ++i)
+		{
+			visitStruct<T>(offset + i * sizeof(T));
 		}
 	}
 
+	template<typename T, ANKI_ENABLE(_ANKI_SIMPLE_TYPE)>
+	void visitArrayElements(T*, PtrSize offset, PtrSize size)
+	{
+		// Nothing to check
+	}
+};
+
+#undef _ANKI_SIMPLE_TYPE
+
+template<typename T>
+Error BinaryDeserializer::getData(
+	ConstWeakArray<U8, PtrSize> file, detail::BinarySerializerHeader& header, const U8*& data)
+{
+	if(file.getSize() < sizeof(header))
+	{
+		ANKI_UTIL_LOGE("Serialized data are too small");
+		return Error::USER_DATA;
+	}
+
+	if(!isAligned(ANKI_SAFE_ALIGNMENT, file.getBegin()))
+	{
+		ANKI_UTIL_LOGE("Serialized data are not aligned");
+		return Error::USER_DATA;
+	}
+
+	memcpy(&header, file.getBegin(), sizeof(header));
+	ANKI_CHECK(checkHeader(header, file.getSize() - sizeof(header), sizeof(T)));
+	data = file.getBegin() + sizeof(header);
+	return Error::NONE;
+}
+
+template<typename T>
+Error BinaryDeserializer::deserialize(T*& x, GenericMemoryPoolAllocator<U8> allocator, File& file)
+{
+	x = nullptr;
+
+	detail::BinarySerializerHeader header;
+	ANKI_CHECK(file.read(&header, sizeof(header)));
+	ANKI_CHECK(checkHeader(header, file.getSize() - file.tell(), sizeof(T)));
+
+	// Read the data and the pointer offsets that follow them in one go
+	const PtrSize pointerArraySize = header.m_pointerCount * sizeof(PtrSize);
+	U8* const baseAddress = static_cast<U8*>(
+		allocator.getMemoryPool().allocate(header.m_dataSize + pointerArraySize, ANKI_SAFE_ALIGNMENT));
+	Error err = file.read(baseAddress, header.m_dataSize + pointerArraySize);
+
+	// Fix pointers
+	if(!err)
+	{
+		err = relocate(baseAddress, header.m_dataSize, baseAddress + header.m_dataSize, header.m_pointerCount);
+	}
+
+	if(err)
+	{
+		allocator.getMemoryPool().free(baseAddress);
+		return err;
+	}
+
 	// Done
 	x = reinterpret_cast<T*>(baseAddress);
 	return Error::NONE;
 }
 
+template<typename T>
+Error BinaryDeserializer::deserializeInPlace(WeakArray<U8, PtrSize> data, T*& x)
+{
+	x = nullptr;
+
+	detail::BinarySerializerHeader header;
+	const U8* dataBegin;
+	ANKI_CHECK(getData<T>(data, header, dataBegin));
+
+	U8* const baseAddress = const_cast<U8*>(dataBegin);
+	ANKI_CHECK(relocate(baseAddress, header.m_dataSize, baseAddress + header.m_dataSize, header.m_pointerCount));
+
+	x = reinterpret_cast<T*>(baseAddress);
+	return Error::NONE;
+}
+
+template<typename T>
+Error BinaryDeserializer::validate(ConstWeakArray<U8, PtrSize> data)
+{
+	detail::BinarySerializerHeader header;
+	const U8* dataBegin;
+	ANKI_CHECK(getData<T>(data, header, dataBegin));
+
+	// Check the pointer list
+	const U8* pointerOffsets = dataBegin + header.m_dataSize;
+	for(PtrSize i = 0; i < header.m_pointerCount; ++i)
+	{
+		const PtrSize offset = readUnaligned(pointerOffsets, i);
+		if(i > 0 && offset <= readUnaligned(pointerOffsets, i - 1))
+		{
+			ANKI_UTIL_LOGE("The pointer list is not sorted");
+			return Error::USER_DATA;
+		}
+
+		if(offset > header.m_dataSize || header.m_dataSize - offset < sizeof(PtrSize)
+			|| !isAligned(alignof(PtrSize), offset))
+		{
+			ANKI_UTIL_LOGE("Corrupt pointer");
+			return Error::USER_DATA;
+		}
+	}
+
+	// Walk the class
+	Validator validator;
+	validator.m_data = dataBegin;
+	validator.m_dataSize = header.m_dataSize;
+	validator.m_pointerOffsets = pointerOffsets;
+	validator.m_pointerCount = header.m_pointerCount;
+	validator.m_budget = header.m_dataSize - sizeof(T);
+	validator.visitStruct<T>(0);
+	ANKI_CHECK(validator.m_err);
+
+	if(validator.m_visitedPointerCount != header.m_pointerCount)
+	{
+		ANKI_UTIL_LOGE("Some pointers don't belong to the class");
+		return Error::USER_DATA;
+	}
+
+	return Error::NONE;
+}
+
 } // end namespace anki
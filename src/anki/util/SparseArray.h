@@ -9,6 +9,7 @@
 #include <anki/util/Assert.h>
 #include <anki/util/Array.h>
 #include <anki/util/Allocator.h>
+#include <anki/util/ControlByteGroup.h>
 #include <utility>
 
 namespace anki
@@ -155,7 +156,7 @@ private:
 	{
 		ANKI_ASSERT(m_array);
 		ANKI_ASSERT(m_elementIdx != getMaxNumericLimit<Index>());
-		ANKI_ASSERT(m_array->m_metadata[m_elementIdx].m_alive);
+		ANKI_ASSERT(m_array->isAlive(m_elementIdx));
 		ANKI_ASSERT(m_array->m_iteratorVer == m_iteratorVer);
 	}
 };
@@ -178,7 +179,7 @@ public:
 
 	// Consts
 	static constexpr Index INITIAL_STORAGE_SIZE = 64; ///< The initial storage size of the array.
-	static constexpr U32 LINEAR_PROBING_COUNT = 8; ///< The number of linear probes.
+	static constexpr U32 LINEAR_PROBING_COUNT = ControlByteGroup::SIZE; ///< The number of linear probes.
 	static constexpr F32 MAX_LOAD_FACTOR = 0.8f; ///< Load factor.
 
 	/// Constructor.
@@ -209,7 +210,7 @@ public:
 	/// Destroy.
 	~SparseArray()
 	{
-		ANKI_ASSERT(m_elements == nullptr && m_metadata == nullptr && "Forgot to call destroy");
+		ANKI_ASSERT(m_elements == nullptr && m_ctrl == nullptr && "Forgot to call destroy");
 	}
 
 	/// Non-copyable.
@@ -218,10 +219,11 @@ public:
 	/// Move operator.
 	SparseArray& operator=(SparseArray&& b)
 	{
-		ANKI_ASSERT(m_elements == nullptr && m_metadata == nullptr && "Forgot to call destroy");
+		ANKI_ASSERT(m_elements == nullptr && m_ctrl == nullptr && "Forgot to call destroy");
 
 		m_elements = b.m_elements;
-		m_metadata = b.m_metadata;
+		m_ctrl = b.m_ctrl;
+		m_indices = b.m_indices;
 		m_elementCount = b.m_elementCount;
 		m_capacity = b.m_capacity;
 		m_initialStorageSize = b.m_initialStorageSize;
@@ -364,16 +366,16 @@ public:
 	void clone(TAlloc& alloc, SparseArray& b) const;
 
 protected:
-	/// Element metadata.
-	class Metadata
-	{
-	public:
-		Index m_idx;
-		Bool m_alive;
-	};
+	/// Control byte of an empty slot. Alive slots have the high bit set and 7 bits of the index's hash.
+	static constexpr U8 CTRL_EMPTY = 0;
 
 	Value* m_elements = nullptr;
-	Metadata* m_metadata = nullptr;
+
+	/// One control byte per slot. The first ControlByteGroup::SIZE-1 bytes are mirrored after the end so a group can
+	/// be loaded from any position without wrapping.
+	U8* m_ctrl = nullptr;
+
+	Index* m_indices = nullptr; ///< The sparse index of every alive slot.
 	Index m_elementCount = 0;
 	Index m_capacity = 0;
 
@@ -425,6 +427,34 @@ protected:
 		return mod(crntPos + m_capacity - desiredPos);
 	}
 
+	Bool isAlive(Index pos) const
+	{
+		ANKI_ASSERT(pos < m_capacity);
+		return m_ctrl[pos] != CTRL_EMPTY;
+	}
+
+	/// Compute the control byte of an alive slot.
+	static U8 computeCtrl(Index idx)
+	{
+		return U8(0x80 | ((U64(idx) * 0x9E3779B97F4A7C15ull) >> 57));
+	}
+
+	/// Set the control byte of a slot and its mirror.
+	void setCtrl(Index pos, U8 ctrl)
+	{
+		ANKI_ASSERT(pos < m_capacity);
+		m_ctrl[pos] = ctrl;
+		for(Index mirror = pos; mirror < ControlByteGroup::SIZE - 1; mirror += m_capacity)
+		{
+			m_ctrl[m_capacity + mirror] = ctrl;
+		}
+	}
+
+	static PtrSize computeCtrlSize(Index capacity)
+	{
+		return PtrSize(capacity) + ControlByteGroup::SIZE - 1;
+	}
+
 	/// Find the first alive element.
 	Index findFirstAlive() const
 	{
@@ -435,7 +465,7 @@ protected:
 
 		for(Index i = 0; i < m_capacity; ++i)
 		{
-			if(m_metadata[i].m_alive)
+			if(isAlive(i))
 			{
 				return i;
 			}
@@ -452,7 +482,8 @@ protected:
 	void resetMembers()
 	{
 		m_elements = nullptr;
-		m_metadata = nullptr;
+		m_ctrl = nullptr;
+		m_indices = nullptr;
 		m_elementCount = 0;
 		m_capacity = 0;
 		invalidateIterators();
@@ -463,12 +494,11 @@ protected:
 	{
 		ANKI_ASSERT(pos < m_capacity);
 		ANKI_ASSERT(n > 0);
-		ANKI_ASSERT(m_metadata[pos].m_alive);
+		ANKI_ASSERT(isAlive(pos));
 
 		while(n > 0 && ++pos < m_capacity)
 		{
-			ANKI_ASSERT(m_metadata[pos].m_alive == 1 || m_metadata[pos].m_alive == 0);
-			n -= Index(m_metadata[pos].m_alive);
+			n -= Index(isAlive(pos));
 		}
 
 		return (pos >= m_capacity) ? getMaxNumericLimit<Index>() : pos;
@@ -16,7 +16,7 @@ void SparseArray<T, TIndex>::destroy(TAlloc& alloc)
 	{
 		for(Index i = 0; i < m_capacity; ++i)
 		{
-			if(m_metadata[i].m_alive)
+			if(isAlive(i))
 			{
 				destroyElement(m_elements[i]);
 			}
@@ -24,8 +24,9 @@ void SparseArray<T, TIndex>::destroy(TAlloc& alloc)
 
 		alloc.deallocate(m_elements, m_capacity);
 
-		ANKI_ASSERT(m_metadata);
-		alloc.deallocate(m_metadata, m_capacity);
+		ANKI_ASSERT(m_ctrl && m_indices);
+		alloc.getMemoryPool().free(m_ctrl);
+		alloc.getMemoryPool().free(m_indices);
 	}
 
 	resetMembers();
@@ -72,24 +73,22 @@ start:
 
 	while(pos != endPos)
 	{
-		Metadata& meta = m_metadata[pos];
 		Value& crntVal = m_elements[pos];
 
-		if(!meta.m_alive)
+		if(!isAlive(pos))
 		{
 			// Empty slot was found, construct in-place
 
-			meta.m_alive = true;
-			meta.m_idx = idx;
+			setCtrl(pos, computeCtrl(idx));
+			m_indices[pos] = idx;
 			alloc.construct(&crntVal, std::move(val));
 
 			return 1;
 		}
-		else if(meta.m_idx == idx)
+		else if(m_indices[pos] == idx)
 		{
 			// Same index was found, replace
 
-			meta.m_idx = idx;
 			destroyElement(crntVal);
 			alloc.construct(&crntVal, std::move(val));
 
@@ -97,12 +96,13 @@ start:
 		}
 
 		// Do the robin-hood
-		const Index otherDesiredPos = mod(meta.m_idx);
+		const Index otherDesiredPos = mod(m_indices[pos]);
 		if(distanceFromDesired(pos, otherDesiredPos) < distanceFromDesired(pos, desiredPos))
 		{
 			// Swap
 			std::swap(val, crntVal);
-			std::swap(idx, meta.m_idx);
+			std::swap(idx, m_indices[pos]);
+			setCtrl(pos, computeCtrl(m_indices[pos]));
 			goto start;
 		}
 
@@ -126,36 +126,36 @@ void SparseArray<T, TIndex>::grow(TAlloc& alloc)
 		ANKI_ASSERT(m_elementCount == 0);
 		m_capacity = m_initialStorageSize;
 		m_elements = static_cast<Value*>(alloc.getMemoryPool().allocate(m_capacity * sizeof(Value), alignof(Value)));
+		m_ctrl = static_cast<U8*>(alloc.getMemoryPool().allocate(computeCtrlSize(m_capacity), 1));
+		m_indices = static_cast<Index*>(alloc.getMemoryPool().allocate(m_capacity * sizeof(Index), alignof(Index)));
 
-		m_metadata =
-			static_cast<Metadata*>(alloc.getMemoryPool().allocate(m_capacity * sizeof(Metadata), alignof(Metadata)));
-
-		memset(m_metadata, 0, m_capacity * sizeof(Metadata));
+		memset(m_ctrl, CTRL_EMPTY, computeCtrlSize(m_capacity));
 
 		return;
 	}
 
 	// Allocate new storage
 	Value* const oldElements = m_elements;
-	Metadata* const oldMetadata = m_metadata;
+	U8* const oldCtrl = m_ctrl;
+	Index* const oldIndices = m_indices;
 	const Index oldCapacity = m_capacity;
 	const Index oldElementCount = m_elementCount;
 	(void)oldElementCount;
 
 	m_capacity *= 2;
 	m_elements = static_cast<Value*>(alloc.getMemoryPool().allocate(m_capacity * sizeof(Value), alignof(Value)));
-	m_metadata =
-		static_cast<Metadata*>(alloc.getMemoryPool().allocate(m_capacity * sizeof(Metadata), alignof(Metadata)));
-	memset(m_metadata, 0, m_capacity * sizeof(Metadata));
+	m_ctrl = static_cast<U8*>(alloc.getMemoryPool().allocate(computeCtrlSize(m_capacity), 1));
+	m_indices = static_cast<Index*>(alloc.getMemoryPool().allocate(m_capacity * sizeof(Index), alignof(Index)));
+	memset(m_ctrl, CTRL_EMPTY, computeCtrlSize(m_capacity));
 	m_elementCount = 0;
 
 	// Find from where we start
 	Index startPos = ~Index(0);
 	for(Index i = 0; i < oldCapacity; ++i)
 	{
-		if(oldMetadata[i].m_alive)
+		if(oldCtrl[i] != CTRL_EMPTY)
 		{
-			const Index desiredPos = mod(oldMetadata[i].m_idx, oldCapacity);
+			const Index desiredPos = mod(oldIndices[i], oldCapacity);
 			if(desiredPos <= i)
 			{
 				startPos = i;
@@ -170,9 +170,9 @@ void SparseArray<T, TIndex>::grow(TAlloc& alloc)
 	Index pos = startPos;
 	while(count--)
 	{
-		if(oldMetadata[pos].m_alive)
+		if(oldCtrl[pos] != CTRL_EMPTY)
 		{
-			Index c = insert(alloc, oldMetadata[pos].m_idx, oldElements[pos]);
+			Index c = insert(alloc, oldIndices[pos], oldElements[pos]);
 			ANKI_ASSERT(c > 0);
 			m_elementCount += c;
 
@@ -187,7 +187,8 @@ void SparseArray<T, TIndex>::grow(TAlloc& alloc)
 
 	// Finalize
 	alloc.getMemoryPool().free(oldElements);
-	alloc.getMemoryPool().free(oldMetadata);
+	alloc.getMemoryPool().free(oldCtrl);
+	alloc.getMemoryPool().free(oldIndices);
 }
 
 template<typename T, typename TIndex>
@@ -201,9 +202,10 @@ void SparseArray<T, TIndex>::erase(TAlloc& alloc, Iterator it)
 
 	const Index pos = it.m_elementIdx;
 	ANKI_ASSERT(pos < m_capacity);
-	ANKI_ASSERT(m_metadata[pos].m_alive);
+	ANKI_ASSERT(isAlive(pos));
 
-	// Shift elements
+	// Backward shift deletion. Pull back the elements that are not in their desired position so no tombstones are
+	// needed
 	Index crntPos; // Also the one that will get deleted
 	Index nextPos = pos;
 	while(true)
@@ -211,18 +213,16 @@ void SparseArray<T, TIndex>::erase(TAlloc& alloc, Iterator it)
 		crntPos = nextPos;
 		nextPos = mod(nextPos + 1);
 
-		Metadata& crntMeta = m_metadata[crntPos];
-		Metadata& nextMeta = m_metadata[nextPos];
 		Value& crntEl = m_elements[crntPos];
 		Value& nextEl = m_elements[nextPos];
 
-		if(!nextMeta.m_alive)
+		if(!isAlive(nextPos))
 		{
 			// On gaps, stop
 			break;
 		}
 
-		const Index nextDesiredPos = mod(nextMeta.m_idx);
+		const Index nextDesiredPos = mod(m_indices[nextPos]);
 		if(nextDesiredPos == nextPos)
 		{
 			// The element is where it want's to be, stop
@@ -231,12 +231,13 @@ void SparseArray<T, TIndex>::erase(TAlloc& alloc, Iterator it)
 
 		// Shift left
 		std::swap(crntEl, nextEl);
-		crntMeta.m_idx = nextMeta.m_idx;
+		m_indices[crntPos] = m_indices[nextPos];
+		setCtrl(crntPos, m_ctrl[nextPos]);
 	}
 
 	// Delete the element in the given pos
 	destroyElement(m_elements[crntPos]);
-	m_metadata[crntPos].m_alive = false;
+	setCtrl(crntPos, CTRL_EMPTY);
 	--m_elementCount;
 
 	// If you erased everything destroy the storage
@@ -253,7 +254,7 @@ void SparseArray<T, TIndex>::validate() const
 {
 	if(m_capacity == 0)
 	{
-		ANKI_ASSERT(m_elementCount == 0 && m_elements == nullptr && m_metadata == nullptr);
+		ANKI_ASSERT(m_elementCount == 0 && m_elements == nullptr && m_ctrl == nullptr && m_indices == nullptr);
 		return;
 	}
 
@@ -263,9 +264,9 @@ void SparseArray<T, TIndex>::validate() const
 	Index startPos = ~Index(0);
 	for(Index i = 0; i < m_capacity; ++i)
 	{
-		if(m_metadata[i].m_alive)
+		if(isAlive(i))
 		{
-			const Index desiredPos = mod(m_metadata[i].m_idx);
+			const Index desiredPos = mod(m_indices[i]);
 			if(desiredPos <= i)
 			{
 				startPos = i;
@@ -274,6 +275,12 @@ void SparseArray<T, TIndex>::validate() const
 		}
 	}
 
+	// Check the mirrored control bytes
+	for(Index i = 0; i < ControlByteGroup::SIZE - 1; ++i)
+	{
+		ANKI_ASSERT(m_ctrl[m_capacity + i] == m_ctrl[mod(i)]);
+	}
+
 	// Start iterating
 	U elementCount = 0;
 	U count = m_capacity;
@@ -281,15 +288,16 @@ void SparseArray<T, TIndex>::validate() const
 	Index prevPos = ~Index(0);
 	while(count--)
 	{
-		if(m_metadata[pos].m_alive)
+		if(isAlive(pos))
 		{
-			const Index myDesiredPos = mod(m_metadata[pos].m_idx);
+			const Index myDesiredPos = mod(m_indices[pos]);
 			(void)myDesiredPos;
 			ANKI_ASSERT(distanceFromDesired(pos, myDesiredPos) < m_probeCount);
+			ANKI_ASSERT(m_ctrl[pos] == computeCtrl(m_indices[pos]));
 
 			if(prevPos != ~Index(0))
 			{
-				Index prevDesiredPos = mod(m_metadata[prevPos].m_idx);
+				Index prevDesiredPos = mod(m_indices[prevPos]);
 				(void)prevDesiredPos;
 				ANKI_ASSERT(myDesiredPos >= prevDesiredPos);
 			}
@@ -316,27 +324,59 @@ TIndex SparseArray<T, TIndex>::findInternal(Index idx) const
 		return getMaxNumericLimit<Index>();
 	}
 
-	const Index desiredPos = mod(idx);
-	const Index endPos = mod(desiredPos + m_probeCount);
-	Index pos = desiredPos;
-	while(pos != endPos)
+	Index pos = mod(idx);
+
+	// Robin hood keeps most of the elements in their desired position. Check it first, the two loads don't depend on
+	// each other so their cache misses overlap
+	if(isAlive(pos) && m_indices[pos] == idx)
 	{
-		if(m_metadata[pos].m_alive && m_metadata[pos].m_idx == idx)
+		return pos;
+	}
+
+	const U8 ctrl = computeCtrl(idx);
+	U32 probesLeft = m_probeCount;
+
+	while(true)
+	{
+		// Scan a whole group of control bytes at once
+		const ControlByteGroup group(m_ctrl + pos);
+		U32 window = (probesLeft >= ControlByteGroup::SIZE) ? 0xFFFFu : ((1u << probesLeft) - 1u);
+
+		// Linear probing without tombstones means that there are no gaps between an element and its desired
+		// position. Stop on the first gap
+		const U32 emptyMask = group.match(CTRL_EMPTY) & window;
+		if(emptyMask)
 		{
-			return pos;
+			window &= (1u << ControlByteGroup::getLowestBit(emptyMask)) - 1u;
 		}
 
-		pos = mod(pos + 1);
-	}
+		U32 mask = group.match(ctrl) & window;
+		while(mask)
+		{
+			const Index candidatePos = mod(pos + ControlByteGroup::getLowestBit(mask));
+			if(ANKI_LIKELY(m_indices[candidatePos] == idx))
+			{
+				return candidatePos;
+			}
 
-	return getMaxNumericLimit<Index>();
+			mask &= mask - 1u;
+		}
+
+		if(emptyMask || probesLeft <= ControlByteGroup::SIZE)
+		{
+			return getMaxNumericLimit<Index>();
+		}
+
+		probesLeft -= ControlByteGroup::SIZE;
+		pos = mod(pos + ControlByteGroup::SIZE);
+	}
 }
 
 template<typename T, typename TIndex>
 template<typename TAlloc>
 void SparseArray<T, TIndex>::clone(TAlloc& alloc, SparseArray& b) const
 {
-	ANKI_ASSERT(b.m_elements == nullptr && b.m_metadata == nullptr);
+	ANKI_ASSERT(b.m_elements == nullptr && b.m_ctrl == nullptr);
 	if(m_capacity == 0)
 	{
 		return;
@@ -344,13 +384,14 @@ void SparseArray<T, TIndex>::clone(TAlloc& alloc, SparseArray& b) const
 
 	// Allocate memory
 	b.m_elements = static_cast<Value*>(alloc.getMemoryPool().allocate(m_capacity * sizeof(Value), alignof(Value)));
-	b.m_metadata =
-		static_cast<Metadata*>(alloc.getMemoryPool().allocate(m_capacity * sizeof(Metadata), alignof(Metadata)));
-	memcpy(b.m_metadata, m_metadata, m_capacity * sizeof(Metadata));
+	b.m_ctrl = static_cast<U8*>(alloc.getMemoryPool().allocate(computeCtrlSize(m_capacity), 1));
+	memcpy(b.m_ctrl, m_ctrl, computeCtrlSize(m_capacity));
+	b.m_indices = static_cast<Index*>(alloc.getMemoryPool().allocate(m_capacity * sizeof(Index), alignof(Index)));
+	memcpy(b.m_indices, m_indices, m_capacity * sizeof(Index));
 
 	for(U i = 0; i < m_capacity; ++i)
 	{
-		if(m_metadata[i].m_alive)
+		if(isAlive(i))
 		{
 			::new(&b.m_elements[i]) Value(m_elements[i]);
 		}
@@ -143,35 +143,47 @@ Error CString::toNumber(Bool& out) const
 
 String& String::operator=(StringAuto&& b)
 {
-	m_data = std::move(b.m_data);
+	move(b);
 	return *this;
 }
 
+String::Char* String::createStorage(Allocator& alloc, PtrSize size)
+{
+	ANKI_ASSERT(isEmpty() && "Cannot create before destroying");
+	ANKI_ASSERT(size > 0);
+	m_size = size;
+	if(!isInline())
+	{
+		m_ptr = alloc.allocate(size);
+	}
+
+	return getData();
+}
+
 void String::create(Allocator alloc, const CStringType& cstr)
 {
-	auto len = cstr.getLength();
-	auto size = len + 1;
-	m_data.create(alloc, size);
-	memcpy(&m_data[0], &cstr[0], sizeof(Char) * size);
+	const PtrSize size = cstr.getLength() + 1;
+	Char* data = createStorage(alloc, size);
+	memcpy(data, &cstr[0], sizeof(Char) * size);
 }
 
 void String::create(Allocator alloc, ConstIterator first, ConstIterator last)
 {
 	ANKI_ASSERT(first != 0 && last != 0);
-	auto length = last - first;
-	m_data.create(alloc, length + 1);
+	const PtrSize length = last - first;
+	Char* data = createStorage(alloc, length + 1);
 
-	memcpy(&m_data[0], first, length);
-	m_data[length] = '\0';
+	memcpy(data, first, length);
+	data[length] = '\0';
 }
 
 void String::create(Allocator alloc, Char c, PtrSize length)
 {
 	ANKI_ASSERT(c != '\0');
-	m_data.create(alloc, length + 1);
+	Char* data = createStorage(alloc, length + 1);
 
-	memset(&m_data[0], c, length);
-	m_data[length] = '\0';
+	memset(data, c, length);
+	data[length] = '\0';
 }
 
 void String::appendInternal(Allocator& alloc, const Char* str, PtrSize strLen)
@@ -179,28 +191,32 @@ void String::appendInternal(Allocator& alloc, const Char* str, PtrSize strLen)
 	ANKI_ASSERT(str != nullptr);
 	ANKI_ASSERT(strLen > 0);
 
-	auto size = m_data.getSize();
+	const PtrSize oldLength = getLength();
+	const PtrSize newSize = oldLength + strLen + 1;
 
-	// Fix empty string
-	if(size == 0)
+	if(newSize <= INLINE_SIZE)
 	{
-		size = 1;
+		// The old string is inline as well, append in place
+		memcpy(&m_inline[oldLength], str, sizeof(Char) * strLen);
+		m_inline[newSize - 1] = '\0';
+		m_size = newSize;
+		return;
 	}
 
-	DynamicArray<Char, PtrSize> newData;
-	newData.create(alloc, size + strLen);
+	Char* newData = alloc.allocate(newSize);
 
-	if(!m_data.isEmpty())
+	if(oldLength > 0)
 	{
-		memcpy(&newData[0], &m_data[0], sizeof(Char) * size);
+		memcpy(newData, getData(), sizeof(Char) * oldLength);
 	}
 
-	memcpy(&newData[size - 1], str, sizeof(Char) * strLen);
+	memcpy(newData + oldLength, str, sizeof(Char) * strLen);
 
-	newData[newData.getSize() - 1] = '\0';
+	newData[newSize - 1] = '\0';
 
-	m_data.destroy(alloc);
-	m_data = std::move(newData);
+	destroy(alloc);
+	m_ptr = newData;
+	m_size = newSize;
 }
 
 void String::sprintf(Allocator alloc, CString fmt, ...)
@@ -219,10 +235,10 @@ void String::sprintf(Allocator alloc, CString fmt, ...)
 	else if(static_cast<PtrSize>(len) >= sizeof(buffer))
 	{
 		I size = len + 1;
-		m_data.create(alloc, size);
+		Char* data = createStorage(alloc, size);
 
 		va_start(args, fmt);
-		len = std::vsnprintf(&m_data[0], size, &fmt[0], args);
+		len = std::vsnprintf(data, size, &fmt[0], args);
 		va_end(args);
 
 		(void)len;
@@ -266,7 +266,8 @@ public:
 	}
 };
 
-/// The base class for strings.
+/// The base class for strings. Short strings are stored inline so moving a String invalidates the CStrings that point
+/// to it.
 class String : public NonCopyable
 {
 public:
@@ -318,14 +319,14 @@ public:
 	const Char& operator[](U pos) const
 	{
 		checkInit();
-		return m_data[pos];
+		return getData()[pos];
 	}
 
 	/// Return char at the specified position as a modifiable reference.
 	Char& operator[](U pos)
 	{
 		checkInit();
-		return m_data[pos];
+		return getData()[pos];
 	}
 
 	operator Bool() const
@@ -338,7 +339,7 @@ public:
 	{
 		checkInit();
 		b.checkInit();
-		return std::strcmp(&m_data[0], &b.m_data[0]) == 0;
+		return std::strcmp(getData(), b.getData()) == 0;
 	}
 
 	/// Return true if strings are not equal
@@ -352,7 +353,7 @@ public:
 	{
 		checkInit();
 		b.checkInit();
-		return std::strcmp(&m_data[0], &b.m_data[0]) < 0;
+		return std::strcmp(getData(), b.getData()) < 0;
 	}
 
 	/// Return true if this is less or equal to b
@@ -360,7 +361,7 @@ public:
 	{
 		checkInit();
 		b.checkInit();
-		return std::strcmp(&m_data[0], &b.m_data[0]) <= 0;
+		return std::strcmp(getData(), b.getData()) <= 0;
 	}
 
 	/// Return true if this is greater than b
@@ -368,7 +369,7 @@ public:
 	{
 		checkInit();
 		b.checkInit();
-		return std::strcmp(&m_data[0], &b.m_data[0]) > 0;
+		return std::strcmp(getData(), b.getData()) > 0;
 	}
 
 	/// Return true if this is greater or equal to b
@@ -376,14 +377,14 @@ public:
 	{
 		checkInit();
 		b.checkInit();
-		return std::strcmp(&m_data[0], &b.m_data[0]) >= 0;
+		return std::strcmp(getData(), b.getData()) >= 0;
 	}
 
 	/// Get a C string.
 	const Char* cstr() const
 	{
 		checkInit();
-		return &m_data[0];
+		return getData();
 	}
 
 	operator CString() const
@@ -411,7 +412,7 @@ public:
 	{
 		if(!b.isEmpty())
 		{
-			appendInternal(alloc, &b.m_data[0], b.m_data.getSize() - 1);
+			appendInternal(alloc, b.getData(), b.m_size - 1);
 		}
 	}
 
@@ -437,31 +438,35 @@ public:
 	/// Destroy the string.
 	void destroy(Allocator alloc)
 	{
-		m_data.destroy(alloc);
+		if(!isInline())
+		{
+			alloc.deallocate(m_ptr, m_size);
+		}
+		m_size = 0;
 	}
 
 	Iterator getBegin()
 	{
 		checkInit();
-		return &m_data[0];
+		return getData();
 	}
 
 	ConstIterator getBegin() const
 	{
 		checkInit();
-		return &m_data[0];
+		return getData();
 	}
 
 	Iterator getEnd()
 	{
 		checkInit();
-		return &m_data[m_data.getSize() - 1];
+		return getData() + m_size - 1;
 	}
 
 	ConstIterator getEnd() const
 	{
 		checkInit();
-		return &m_data[m_data.getSize() - 1];
+		return getData() + m_size - 1;
 	}
 
 	Iterator begin()
@@ -487,9 +492,8 @@ public:
 	/// Return the string's length. It doesn't count the terminating character.
 	PtrSize getLength() const
 	{
-		auto size = m_data.getSize();
-		auto out = (size != 0) ? (size - 1) : 0;
-		ANKI_ASSERT(size == 0 || std::strlen(&m_data[0]) == out);
+		const PtrSize out = (m_size != 0) ? (m_size - 1) : 0;
+		ANKI_ASSERT(m_size == 0 || std::strlen(getData()) == out);
 		return out;
 	}
 
@@ -497,13 +501,13 @@ public:
 	CStringType toCString() const
 	{
 		checkInit();
-		return CStringType(&m_data[0]);
+		return CStringType(getData());
 	}
 
 	/// Return true if it's empty.
 	Bool isEmpty() const
 	{
-		return m_data.isEmpty();
+		return m_size == 0;
 	}
 
 	/// Find a substring of this string.
@@ -588,27 +592,64 @@ public:
 	U64 computeHash() const
 	{
 		checkInit();
-		return anki::computeHash(&m_data[0], m_data.getSize());
+		return anki::computeHash(getData(), m_size);
 	}
 
 	/// Replace all occurrences of "from" with "to".
 	String& replaceAll(Allocator alloc, CString from, CString to);
 
 protected:
-	DynamicArray<Char, PtrSize> m_data;
+	/// Strings that fit here (including the terminating character) don't allocate.
+	static constexpr PtrSize INLINE_SIZE = 16;
+
+	union
+	{
+		Char* m_ptr = nullptr;
+		Array<Char, INLINE_SIZE> m_inline;
+	};
+
+	PtrSize m_size = 0; ///< Including the terminating character. Zero if the string is empty.
 
 	void checkInit() const
 	{
-		ANKI_ASSERT(m_data.getSize() > 0);
+		ANKI_ASSERT(m_size > 0);
+	}
+
+	Bool isInline() const
+	{
+		return m_size <= INLINE_SIZE;
+	}
+
+	Char* getData()
+	{
+		return (isInline()) ? &m_inline[0] : m_ptr;
 	}
 
+	const Char* getData() const
+	{
+		return (isInline()) ? &m_inline[0] : m_ptr;
+	}
+
+	/// Allocate the storage of an empty string. Size includes the terminating character.
+	Char* createStorage(Allocator& alloc, PtrSize size);
+
 	/// Append to this string.
 	void appendInternal(Allocator& alloc, const Char* str, PtrSize strLen);
 
 	void move(String& b)
 	{
 		ANKI_ASSERT(this != &b);
-		m_data = std::move(b.m_data);
+		ANKI_ASSERT(isEmpty() && "Cannot move before destroying");
+		if(b.isInline())
+		{
+			memcpy(&m_inline[0], &b.m_inline[0], b.m_size);
+		}
+		else
+		{
+			m_ptr = b.m_ptr;
+		}
+		m_size = b.m_size;
+		b.m_size = 0;
 	}
 };
 
@@ -651,7 +692,7 @@ public:
 	{
 		if(!b.isEmpty())
 		{
-			create(b.m_data.getBegin(), b.m_data.getEnd());
+			create(b.getBegin(), b.getEnd());
 		}
 	}
 
@@ -683,7 +724,7 @@ public:
 		m_alloc = b.m_alloc;
 		if(!b.isEmpty())
 		{
-			create(b.m_data.getBegin(), b.m_data.getEnd());
+			create(b.getBegin(), b.getEnd());
 		}
 		return *this;
 	}
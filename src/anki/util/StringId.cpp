@@ -0,0 +1,159 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/util/StringId.h>
+#include <anki/util/HashMap.h>
+#include <anki/util/Thread.h>
+
+namespace anki
+{
+
+namespace
+{
+
+/// An interned string. The text follows the entry in memory.
+class StringIdEntry
+{
+public:
+	StringIdEntry* m_next; ///< The next entry with the same hash.
+
+	const char* getText() const
+	{
+		return reinterpret_cast<const char*>(this + 1);
+	}
+};
+
+/// The global table of the interned strings.
+class StringIdTable
+{
+public:
+	HeapAllocator<U8> m_alloc;
+	RWMutex m_mtx;
+	HashMap<U64, StringIdEntry*> m_entries;
+
+	StringIdTable()
+		: m_alloc(allocAligned, nullptr)
+	{
+	}
+
+	~StringIdTable()
+	{
+		for(StringIdEntry* entry : m_entries)
+		{
+			while(entry)
+			{
+				StringIdEntry* next = entry->m_next;
+				m_alloc.getMemoryPool().free(entry);
+				entry = next;
+			}
+		}
+
+		m_entries.destroy(m_alloc);
+	}
+
+	const char* find(CString str, U64 hash)
+	{
+		RLockGuard<RWMutex> lock(m_mtx);
+		return findInternal(str, hash);
+	}
+
+	const char* intern(CString str, U64 hash)
+	{
+		// Most strings are already interned so try with the read lock first
+		const char* text = find(str, hash);
+		if(text)
+		{
+			return text;
+		}
+
+		WLockGuard<RWMutex> lock(m_mtx);
+
+		// Another thread might have interned it in the meantime
+		text = findInternal(str, hash);
+		if(text)
+		{
+			return text;
+		}
+
+		auto it = m_entries.find(hash);
+		if(it != m_entries.getEnd())
+		{
+			// Append it to the entries with the same hash
+			StringIdEntry* last = *it;
+			while(last->m_next)
+			{
+				last = last->m_next;
+			}
+
+			last->m_next = newEntry(str);
+			return last->m_next->getText();
+		}
+
+		StringIdEntry* entry = newEntry(str);
+		m_entries.emplace(m_alloc, hash, entry);
+		return entry->getText();
+	}
+
+private:
+	const char* findInternal(CString str, U64 hash)
+	{
+		auto it = m_entries.find(hash);
+		if(it != m_entries.getEnd())
+		{
+			// Walk the entries with the same hash
+			for(const StringIdEntry* entry = *it; entry; entry = entry->m_next)
+			{
+				if(str == entry->getText())
+				{
+					return entry->getText();
+				}
+			}
+		}
+
+		return nullptr;
+	}
+
+	StringIdEntry* newEntry(CString str)
+	{
+		const PtrSize size = str.getLength() + 1;
+		void* mem = m_alloc.getMemoryPool().allocate(sizeof(StringIdEntry) + size, alignof(StringIdEntry));
+		StringIdEntry* entry = static_cast<StringIdEntry*>(mem);
+		entry->m_next = nullptr;
+		memcpy(entry + 1, str.cstr(), size);
+		return entry;
+	}
+};
+
+StringIdTable& getStringIdTable()
+{
+	static StringIdTable table;
+	return table;
+}
+
+} // end anonymous namespace
+
+StringId::StringId(CString str)
+{
+	if(!str.isEmpty())
+	{
+		m_hash = str.computeHash();
+		m_str = getStringIdTable().intern(str, m_hash);
+	}
+}
+
+StringId StringId::tryFind(CString str)
+{
+	StringId out;
+	if(!str.isEmpty())
+	{
+		const U64 hash = str.computeHash();
+		out.m_str = getStringIdTable().find(str, hash);
+		out.m_hash = (out.m_str) ? hash : 0;
+	}
+
+	return out;
+}
+
+} // end namespace anki
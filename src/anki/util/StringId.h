@@ -0,0 +1,85 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/util/String.h>
+
+namespace anki
+{
+
+/// @addtogroup util_other
+/// @{
+
+/// An interned string. All StringIds with the same text point to the same global copy of it so comparing them is a
+/// pointer comparison. The hash is cached so StringIds make cheap HashMap keys. The global copies live until the
+/// program exits so the CStrings returned by a StringId never dangle.
+class StringId
+{
+public:
+	/// Create an empty StringId.
+	StringId() = default;
+
+	/// Intern a string. It's thread-safe. An empty string gives an empty StringId.
+	explicit StringId(CString str);
+
+	/// Get the StringId of a string without interning it. Use it for lookups, it doesn't grow the global table with
+	/// strings that were never interned and it only takes a read lock. It's thread-safe.
+	/// @return The StringId or an empty StringId if the string was never interned.
+	static StringId tryFind(CString str);
+
+	StringId(const StringId& b) = default;
+
+	StringId& operator=(const StringId& b) = default;
+
+	Bool operator==(const StringId& b) const
+	{
+		ANKI_ASSERT((m_str == b.m_str) == (m_hash == b.m_hash && toCString() == b.toCString()));
+		return m_str == b.m_str;
+	}
+
+	Bool operator!=(const StringId& b) const
+	{
+		return m_str != b.m_str;
+	}
+
+	operator CString() const
+	{
+		return toCString();
+	}
+
+	/// Get a C string.
+	const char* cstr() const
+	{
+		ANKI_ASSERT(!isEmpty());
+		return m_str;
+	}
+
+	/// Return the CString. It's empty if the StringId is empty.
+	CString toCString() const
+	{
+		return (m_str) ? CString(m_str) : CString();
+	}
+
+	/// Return true if it's empty.
+	Bool isEmpty() const
+	{
+		return m_str == nullptr;
+	}
+
+	/// Get the hash. It's the same as CString::computeHash() of the text.
+	U64 computeHash() const
+	{
+		ANKI_ASSERT(!isEmpty());
+		return m_hash;
+	}
+
+private:
+	const char* m_str = nullptr;
+	U64 m_hash = 0;
+};
+/// @}
+
+} // end namespace anki
@@ -5,11 +5,16 @@
 
 #include <anki/util/System.h>
 #include <anki/util/Logger.h>
+#include <anki/util/Functions.h>
 #include <cstdio>
+#include <cstdlib>
+#include <algorithm>
 
 #if ANKI_POSIX
 #	include <unistd.h>
 #	include <signal.h>
+#	include <dirent.h>
+#	include <sched.h>
 #elif ANKI_OS_WINDOWS
 #	include <anki/util/Win32Minimal.h>
 #else
@@ -38,6 +43,170 @@ U32 getCpuCoresCount()
 #endif
 }
 
+#if ANKI_OS_LINUX || ANKI_OS_ANDROID
+/// Read a single integer from a sysfs file.
+static Bool readSysfsNumber(const char* path, U32& out)
+{
+	FILE* file = fopen(path, "r");
+	if(!file)
+	{
+		return false;
+	}
+
+	unsigned int val;
+	const Bool ok = fscanf(file, "%u", &val) == 1;
+	fclose(file);
+	out = val;
+	return ok;
+}
+
+/// Find the NUMA node of a CPU by looking for the nodeX entry in the CPU's sysfs directory.
+static U32 getCpuNumaNode(U32 cpu)
+{
+	char path[128];
+	snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u", cpu);
+
+	U32 node = 0;
+	DIR* dir = opendir(path);
+	if(dir)
+	{
+		dirent* entry;
+		while((entry = readdir(dir)) != nullptr)
+		{
+			unsigned int n;
+			if(sscanf(entry->d_name, "node%u", &n) == 1)
+			{
+				node = n;
+				break;
+			}
+		}
+
+		closedir(dir);
+	}
+
+	return node;
+}
+#endif
+
+U32 getCpuTopology(CpuCoreInfo* cores, U32 maxCoreCount)
+{
+	ANKI_ASSERT(cores == nullptr || maxCoreCount > 0);
+
+	class Core
+	{
+	public:
+		CpuCoreInfo m_info;
+		U32 m_package;
+		U32 m_coreId;
+		U32 m_siblingIdx; ///< The order of this logical core among its SMT siblings.
+	};
+
+	U32 coreCount = 0;
+	Core* allCores = nullptr;
+
+#if ANKI_OS_LINUX || ANKI_OS_ANDROID
+	cpu_set_t cpus;
+	CPU_ZERO(&cpus);
+	if(sched_getaffinity(0, sizeof(cpus), &cpus) == 0)
+	{
+		const U32 count = U32(CPU_COUNT(&cpus));
+		allCores = static_cast<Core*>(malloc(sizeof(Core) * count));
+
+		for(U32 cpu = 0; cpu < CPU_SETSIZE && coreCount < count; ++cpu)
+		{
+			if(!CPU_ISSET(cpu, &cpus))
+			{
+				continue;
+			}
+
+			Core& core = allCores[coreCount++];
+			core.m_info.m_logicalCoreIdx = cpu;
+			core.m_info.m_numaNodeIdx = getCpuNumaNode(cpu);
+
+			char path[128];
+			snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/topology/physical_package_id", cpu);
+			if(!readSysfsNumber(path, core.m_package))
+			{
+				core.m_package = 0;
+			}
+
+			snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/topology/core_id", cpu);
+			if(!readSysfsNumber(path, core.m_coreId))
+			{
+				// Unknown, treat it as a physical core
+				core.m_coreId = cpu;
+				core.m_package = MAX_U32;
+			}
+		}
+	}
+#endif
+
+	if(allCores == nullptr)
+	{
+		// Fallback: Assume that every logical core is a physical core and that there is a single NUMA node
+		coreCount = getCpuCoresCount();
+		allCores = static_cast<Core*>(malloc(sizeof(Core) * coreCount));
+		for(U32 i = 0; i < coreCount; ++i)
+		{
+			allCores[i].m_info.m_logicalCoreIdx = i;
+			allCores[i].m_info.m_numaNodeIdx = 0;
+			allCores[i].m_package = MAX_U32;
+			allCores[i].m_coreId = i;
+		}
+	}
+
+	// Compute the physical core indices and the SMT sibling order
+	U32 physicalCoreCount = 0;
+	for(U32 i = 0; i < coreCount; ++i)
+	{
+		Core& core = allCores[i];
+		core.m_siblingIdx = 0;
+		core.m_info.m_physicalCoreIdx = MAX_U32;
+
+		for(U32 j = 0; j < i; ++j)
+		{
+			const Core& other = allCores[j];
+			if(other.m_package == core.m_package && other.m_coreId == core.m_coreId)
+			{
+				core.m_info.m_physicalCoreIdx = other.m_info.m_physicalCoreIdx;
+				++core.m_siblingIdx;
+			}
+		}
+
+		if(core.m_info.m_physicalCoreIdx == MAX_U32)
+		{
+			core.m_info.m_physicalCoreIdx = physicalCoreCount++;
+		}
+	}
+
+	// Sort in pinning order
+	std::sort(allCores, allCores + coreCount, [](const Core& a, const Core& b) {
+		if(a.m_siblingIdx != b.m_siblingIdx)
+		{
+			return a.m_siblingIdx < b.m_siblingIdx;
+		}
+		else if(a.m_info.m_numaNodeIdx != b.m_info.m_numaNodeIdx)
+		{
+			return a.m_info.m_numaNodeIdx < b.m_info.m_numaNodeIdx;
+		}
+		else
+		{
+			return a.m_info.m_logicalCoreIdx < b.m_info.m_logicalCoreIdx;
+		}
+	});
+
+	if(cores)
+	{
+		for(U32 i = 0; i < min(coreCount, maxCoreCount); ++i)
+		{
+			cores[i] = allCores[i].m_info;
+		}
+	}
+
+	free(allCores);
+	return coreCount;
+}
+
 void BackTraceWalker::exec()
 {
 #if ANKI_POSIX && !ANKI_OS_ANDROID
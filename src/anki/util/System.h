@@ -16,6 +16,23 @@ namespace anki
 /// Get the number of CPU cores
 U32 getCpuCoresCount();
 
+/// Information about a logical CPU core. @memberof getCpuTopology
+class CpuCoreInfo
+{
+public:
+	U32 m_logicalCoreIdx = 0; ///< The index the OS uses for the core. Use that to pin threads.
+	U32 m_physicalCoreIdx = 0; ///< Logical cores of the same physical core (SMT siblings) have the same index.
+	U32 m_numaNodeIdx = 0; ///< The NUMA node of the core.
+};
+
+/// Get the topology of the logical CPU cores the process can run on. The cores are sorted in the order threads should
+/// be pinned to them: First the first logical core of every physical core, grouped by NUMA node, and then the rest of
+/// the SMT siblings.
+/// @param[out] cores Where to write the info. Can be nullptr.
+/// @param maxCoreCount The size of the @a cores array.
+/// @return The number of logical cores.
+U32 getCpuTopology(CpuCoreInfo* cores, U32 maxCoreCount);
+
 /// Visit the program stack.
 class BackTraceWalker
 {
@@ -563,8 +563,19 @@ public:
 
 	RWLockGuard(const RWLockGuard& b) = delete;
 
+	RWLockGuard(RWLockGuard&& b)
+	{
+		m_mtx = b.m_mtx;
+		b.m_mtx = nullptr;
+	}
+
 	~RWLockGuard()
 	{
+		if(!m_mtx)
+		{
+			return;
+		}
+
 		if(READER)
 		{
 			m_mtx->unlockRead();
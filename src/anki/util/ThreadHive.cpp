@@ -4,6 +4,8 @@
 // http://www.anki3d.org/LICENSE
 
 #include <anki/util/ThreadHive.h>
+#include <anki/util/HighRezTimer.h>
+#include <anki/util/System.h>
 #include <cstring>
 #include <cstdio>
 
@@ -18,21 +20,27 @@ namespace anki
 #	define ANKI_HIVE_DEBUG_PRINT(...) ((void)0)
 #endif
 
-class ThreadHive::Thread
+class alignas(ANKI_CACHE_LINE_SIZE) ThreadHive::Thread
 {
 public:
 	U32 m_id; ///< An ID
 	anki::Thread m_thread; ///< Runs the workingFunc
 	ThreadHive* m_hive;
+	U32 m_numaNode; ///< Index to ThreadHive::m_scratchAllocs.
+
+	SpinLock m_queueLock; ///< Protects the queues.
+	Array<Task*, U32(ThreadHiveTaskPriority::COUNT)> m_heads = {}; ///< Head of the task queue of each priority.
+	Array<Task*, U32(ThreadHiveTaskPriority::COUNT)> m_tails = {}; ///< Tail of the task queue of each priority.
 
 	/// Constructor
-	Thread(U32 id, ThreadHive* hive, Bool pinToCores)
+	Thread(U32 id, ThreadHive* hive, I32 pinToCore, U32 numaNode)
 		: m_id(id)
 		, m_thread("anki_threadhive")
 		, m_hive(hive)
+		, m_numaNode(numaNode)
 	{
 		ANKI_ASSERT(hive);
-		m_thread.start(this, threadCallback, (pinToCores) ? I32(m_id) : -1);
+		m_thread.start(this, threadCallback, pinToCore);
 	}
 
 private:
@@ -41,7 +49,9 @@ private:
 	{
 		Thread& self = *static_cast<Thread*>(info.m_userData);
 
+		m_crntThread = &self;
 		self.m_hive->threadRun(self.m_id);
+		m_crntThread = nullptr;
 		return Error::NONE;
 	}
 };
@@ -56,19 +66,67 @@ public:
 
 	ThreadHiveSemaphore* m_waitSemaphore;
 	ThreadHiveSemaphore* m_signalSemaphore;
+
+	ThreadHiveTaskPriority m_priority;
 };
 
+thread_local ThreadHive::Thread* ThreadHive::m_crntThread = nullptr;
+
+constexpr U32 ThreadHive::MAX_TASKS_PER_SUBMIT;
+
 ThreadHive::ThreadHive(U32 threadCount, GenericMemoryPoolAllocator<U8> alloc, Bool pinToCores)
 	: m_slowAlloc(alloc)
-	, m_alloc(alloc.getMemoryPool().getAllocationCallback(),
-		  alloc.getMemoryPool().getAllocationCallbackUserData(),
-		  1024 * 4)
 	, m_threadCount(threadCount)
 {
-	m_threads = reinterpret_cast<Thread*>(m_slowAlloc.allocate(sizeof(Thread) * threadCount));
+	ANKI_ASSERT(threadCount > 0);
+
+	for(ThreadHiveTaskPriority priority : EnumIterable<ThreadHiveTaskPriority>())
+	{
+		m_queuedTaskCounts[priority].setNonAtomically(0);
+		m_taskTimeNs[priority].setNonAtomically(0);
+	}
+
+	// Get the topology. It's sorted in the order the threads should be pinned
+	DynamicArrayAuto<CpuCoreInfo> cores(m_slowAlloc);
+	U32 numaNodeCount = 1;
+	if(pinToCores)
+	{
+		cores.create(getCpuTopology(nullptr, 0));
+		const U32 coreCount = getCpuTopology(&cores[0], cores.getSize());
+		ANKI_ASSERT(coreCount == cores.getSize());
+		(void)coreCount;
+
+		for(const CpuCoreInfo& core : cores)
+		{
+			numaNodeCount = max(numaNodeCount, core.m_numaNodeIdx + 1);
+		}
+	}
+
+	// One scratch pool per NUMA node. The memory of the pools is first touched by the threads of the node so the OS
+	// will place it to that node. The chunks should fit the tasks of the biggest submitTasks()
+	m_scratchAllocs.create(m_slowAlloc, numaNodeCount);
+	for(StackAllocator<U8>& scratchAlloc : m_scratchAllocs)
+	{
+		scratchAlloc = StackAllocator<U8>(alloc.getMemoryPool().getAllocationCallback(),
+			alloc.getMemoryPool().getAllocationCallbackUserData(),
+			max<PtrSize>(1024 * 4, sizeof(Task) * MAX_TASKS_PER_SUBMIT));
+	}
+
+	PtrSize alignment = alignof(Thread);
+	m_threads = reinterpret_cast<Thread*>(m_slowAlloc.allocate(sizeof(Thread) * threadCount, &alignment));
 	for(U32 i = 0; i < threadCount; ++i)
 	{
-		::new(&m_threads[i]) Thread(i, this, pinToCores);
+		I32 pinToCore = -1;
+		U32 numaNode = 0;
+		if(pinToCores)
+		{
+			// If there are more threads than cores wrap around
+			const CpuCoreInfo& core = cores[i % cores.getSize()];
+			pinToCore = I32(core.m_logicalCoreIdx);
+			numaNode = core.m_numaNodeIdx;
+		}
+
+		::new(&m_threads[i]) Thread(i, this, pinToCore, numaNode);
 	}
 }
 
@@ -95,60 +153,156 @@ ThreadHive::~ThreadHive()
 
 		m_slowAlloc.deallocate(static_cast<void*>(m_threads), m_threadCount * sizeof(Thread));
 	}
+
+	m_scratchAllocs.destroy(m_slowAlloc);
 }
 
 void ThreadHive::submitTasks(ThreadHiveTask* tasks, const U32 taskCount)
 {
 	ANKI_ASSERT(tasks && taskCount > 0);
+	ANKI_ASSERT(taskCount <= MAX_TASKS_PER_SUBMIT && "Too many tasks. Split them to more submitTasks() calls");
 
 	// Allocate tasks
-	Task* const htasks = m_alloc.newArray<Task>(taskCount);
+	Task* const htasks = getScratchAllocator().newArray<Task>(taskCount);
 
-	// Initialize tasks
-	Task* prevTask = nullptr;
-	for(U32 i = 0; i < taskCount; ++i)
+	// Initialize tasks and sort them by priority. Keep the submission order for tasks of the same priority
+	Task* prioTasks[U32(ThreadHiveTaskPriority::COUNT)] = {};
+	U32 outIdx = 0;
+	for(ThreadHiveTaskPriority priority : EnumIterable<ThreadHiveTaskPriority>())
 	{
-		const ThreadHiveTask& inTask = tasks[i];
-		Task& outTask = htasks[i];
-
-		outTask.m_next = nullptr;
-		outTask.m_cb = inTask.m_callback;
-		outTask.m_arg = inTask.m_argument;
-		outTask.m_waitSemaphore = inTask.m_waitSemaphore;
-		outTask.m_signalSemaphore = inTask.m_signalSemaphore;
+		prioTasks[U32(priority)] = &htasks[outIdx];
 
-		// Connect tasks
-		if(prevTask)
+		for(U32 i = 0; i < taskCount; ++i)
 		{
-			prevTask->m_next = &outTask;
+			const ThreadHiveTask& inTask = tasks[i];
+			ANKI_ASSERT(inTask.m_priority < ThreadHiveTaskPriority::COUNT);
+			if(inTask.m_priority != priority)
+			{
+				continue;
+			}
+
+			Task& outTask = htasks[outIdx++];
+			outTask.m_next = nullptr;
+			outTask.m_cb = inTask.m_callback;
+			outTask.m_arg = inTask.m_argument;
+			outTask.m_waitSemaphore = inTask.m_waitSemaphore;
+			outTask.m_signalSemaphore = inTask.m_signalSemaphore;
+			outTask.m_priority = inTask.m_priority;
 		}
-		prevTask = &outTask;
 	}
+	ANKI_ASSERT(outIdx == taskCount);
+
+	m_pendingTasks.fetchAdd(taskCount);
 
 	// Push work
+	Thread* const crntThread = m_crntThread;
+	const Bool localSubmit = isHiveThread();
+	for(ThreadHiveTaskPriority priority : EnumIterable<ThreadHiveTaskPriority>())
 	{
-		LockGuard<Mutex> lock(m_mtx);
+		Task* const first = prioTasks[U32(priority)];
+		Task* const end =
+			(priority + 1 < ThreadHiveTaskPriority::COUNT) ? prioTasks[U32(priority) + 1] : &htasks[taskCount - 1] + 1;
+		const U32 prioTaskCount = U32(end - first);
+		if(prioTaskCount == 0)
+		{
+			continue;
+		}
 
-		if(m_head != nullptr)
+		if(localSubmit)
 		{
-			ANKI_ASSERT(m_tail && m_head);
-			m_tail->m_next = &htasks[0];
-			m_tail = &htasks[taskCount - 1];
+			// Submitted from a task, keep the work local. Push it to the front since it's probably hot in the cache
+			for(U32 i = 0; i < prioTaskCount - 1; ++i)
+			{
+				first[i].m_next = &first[i + 1];
+			}
+
+			pushTasks(*crntThread, first, first + prioTaskCount - 1, prioTaskCount, true);
 		}
 		else
 		{
-			ANKI_ASSERT(m_tail == nullptr);
-			m_head = &htasks[0];
-			m_tail = &htasks[taskCount - 1];
+			// Submitted from the outside, spread the tasks to the queues in contiguous batches
+			const U32 queueCount = min(m_threadCount, prioTaskCount);
+			const U32 firstQueue = m_nextQueue.fetchAdd(queueCount) % m_threadCount;
+			U32 firstTask = 0;
+			for(U32 i = 0; i < queueCount; ++i)
+			{
+				const U32 endTask = (prioTaskCount * (i + 1)) / queueCount;
+				ANKI_ASSERT(endTask > firstTask);
+
+				for(U32 j = firstTask; j < endTask - 1; ++j)
+				{
+					first[j].m_next = &first[j + 1];
+				}
+
+				pushTasks(m_threads[(firstQueue + i) % m_threadCount],
+					first + firstTask,
+					first + endTask - 1,
+					endTask - firstTask,
+					false);
+
+				firstTask = endTask;
+			}
 		}
+	}
+
+	ANKI_HIVE_DEBUG_PRINT("submit tasks\n");
+
+	notifyNewWork();
+}
 
-		m_pendingTasks += taskCount;
+void ThreadHive::pushTasks(Thread& thread, Task* first, Task* last, U32 taskCount, Bool toFront)
+{
+	ANKI_ASSERT(first && last && last->m_next == nullptr && taskCount > 0);
+	ANKI_ASSERT(first->m_priority == last->m_priority);
+	const ThreadHiveTaskPriority priority = first->m_priority;
+
+	{
+		LockGuard<SpinLock> lock(thread.m_queueLock);
 
-		ANKI_HIVE_DEBUG_PRINT("submit tasks\n");
+		Task*& head = thread.m_heads[priority];
+		Task*& tail = thread.m_tails[priority];
+		if(head == nullptr)
+		{
+			ANKI_ASSERT(tail == nullptr);
+			head = first;
+			tail = last;
+		}
+		else if(toFront)
+		{
+			last->m_next = head;
+			head = first;
+		}
+		else
+		{
+			tail->m_next = first;
+			tail = last;
+		}
+
+		m_queuedTaskCounts[priority].fetchAdd(taskCount);
 	}
+}
 
-	// Notify all threads
-	m_cvar.notifyAll();
+Bool ThreadHive::isHiveThread() const
+{
+	return m_crntThread && m_crntThread->m_hive == this;
+}
+
+StackAllocator<U8>& ThreadHive::getScratchAllocator()
+{
+	// Threads outside the hive use the pool of the 1st node
+	const U32 numaNode = (isHiveThread()) ? m_crntThread->m_numaNode : 0;
+	return m_scratchAllocs[numaNode];
+}
+
+void ThreadHive::notifyNewWork()
+{
+	m_workGeneration.fetchAdd(1);
+
+	if(m_sleepingThreadCount.load() > 0)
+	{
+		LockGuard<Mutex> lock(m_mtx);
+		m_cvar.notifyAll();
+	}
 }
 
 void ThreadHive::threadRun(U32 threadId)
@@ -161,7 +315,10 @@ void ThreadHive::threadRun(U32 threadId)
 		ANKI_ASSERT(task && task->m_cb);
 		ANKI_HIVE_DEBUG_PRINT(
 			"tid: %lu will exec %p (udata: %p)\n", threadId, static_cast<void*>(task), static_cast<void*>(task->m_arg));
+		const Second startTime = HighRezTimer::getCurrentTime();
 		task->m_cb(task->m_arg, threadId, *this, task->m_signalSemaphore);
+		const Second taskTime = HighRezTimer::getCurrentTime() - startTime;
+		m_taskTimeNs[task->m_priority].fetchAdd(U64(taskTime * 1000000000.0));
 
 #if ANKI_EXTRA_CHECKS
 		task->m_cb = nullptr;
@@ -170,10 +327,24 @@ void ThreadHive::threadRun(U32 threadId)
 		// Signal the semaphore as early as possible
 		if(task->m_signalSemaphore)
 		{
-			const U32 out = task->m_signalSemaphore->m_atomic.fetchSub(1);
-			(void)out;
+			const U32 out = task->m_signalSemaphore->m_atomic.fetchSub(1, AtomicMemoryOrder::SEQ_CST);
 			ANKI_ASSERT(out > 0u);
 			ANKI_HIVE_DEBUG_PRINT("\tsem is %u\n", out - 1u);
+
+			if(out == 1)
+			{
+				// A dependency got resolved, some tasks might be unblocked
+				notifyNewWork();
+			}
+		}
+
+		// Complete the task
+		if(m_pendingTasks.fetchSub(1) == 1)
+		{
+			// Out of tasks, wake the waitAllTasks()
+			ANKI_HIVE_DEBUG_PRINT("tid: %lu wake all\n", threadId);
+			LockGuard<Mutex> lock(m_mtx);
+			m_cvar.notifyAll();
 		}
 	}
 
@@ -182,42 +353,91 @@ void ThreadHive::threadRun(U32 threadId)
 
 Bool ThreadHive::waitForWork(U32 threadId, Task*& task)
 {
-	LockGuard<Mutex> lock(m_mtx);
+	while(true)
+	{
+		const U64 generation = m_workGeneration.load();
 
-	ANKI_HIVE_DEBUG_PRINT("tid: %lu locking\n", threadId);
+		task = getNewTask(threadId);
+		if(task)
+		{
+			return false;
+		}
 
-	// Complete the previous task
-	if(task)
-	{
-		--m_pendingTasks;
+		LockGuard<Mutex> lock(m_mtx);
 
-		if(task->m_signalSemaphore || m_pendingTasks == 0)
+		if(m_quit)
 		{
-			// A dependency maybe got resolved or we are out of tasks. Wake them all
-			ANKI_HIVE_DEBUG_PRINT("tid: %lu wake all\n", threadId);
-			m_cvar.notifyAll();
+			return true;
+		}
+
+		// Sleep only if no work was submitted since the queues were checked
+		m_sleepingThreadCount.fetchAdd(1);
+		if(m_workGeneration.load() == generation)
+		{
+			ANKI_HIVE_DEBUG_PRINT("tid: %lu waiting\n", threadId);
+			m_cvar.wait(m_mtx);
+		}
+		m_sleepingThreadCount.fetchSub(1);
+	}
+}
+
+void ThreadHive::waitSemaphore(ThreadHiveSemaphore& sem)
+{
+	ANKI_ASSERT(!isHiveThread());
+
+	LockGuard<Mutex> lock(m_mtx);
+	while(sem.m_atomic.load(AtomicMemoryOrder::SEQ_CST) != 0)
+	{
+		// Count as a sleeping thread so the thread that zeroes the semaphore will notify. Check again after that to
+		// avoid missing the wakeup
+		m_sleepingThreadCount.fetchAdd(1);
+		if(sem.m_atomic.load(AtomicMemoryOrder::SEQ_CST) != 0)
+		{
+			m_cvar.wait(m_mtx);
 		}
+		m_sleepingThreadCount.fetchSub(1);
 	}
+}
 
-	while(!m_quit && (task = getNewTask()) == nullptr)
+ThreadHive::Task* ThreadHive::getNewTask(U32 threadId)
+{
+	for(ThreadHiveTaskPriority priority : EnumIterable<ThreadHiveTaskPriority>())
 	{
-		ANKI_HIVE_DEBUG_PRINT("tid: %lu waiting\n", threadId);
+		if(m_queuedTaskCounts[priority].load() == 0)
+		{
+			continue;
+		}
 
-		// Wait if there is no work.
-		m_cvar.wait(m_mtx);
+		// Try the local queue first and then steal from the others
+		for(U32 i = 0; i < m_threadCount; ++i)
+		{
+			Thread& thread = m_threads[(threadId + i) % m_threadCount];
+			Task* task = popTask(thread, priority);
+			if(task)
+			{
+				ANKI_HIVE_DEBUG_PRINT("tid: %lu got task from queue %lu\n", threadId, thread.m_id);
+				return task;
+			}
+		}
 	}
 
-	return m_quit;
+	return nullptr;
 }
 
-ThreadHive::Task* ThreadHive::getNewTask()
+ThreadHive::Task* ThreadHive::popTask(Thread& thread, ThreadHiveTaskPriority priority)
 {
+	LockGuard<SpinLock> lock(thread.m_queueLock);
+
+	Task*& head = thread.m_heads[priority];
+	Task*& tail = thread.m_tails[priority];
+
 	Task* prevTask = nullptr;
-	Task* task = m_head;
+	Task* task = head;
 	while(task)
 	{
 		// Check if there are dependencies
-		const Bool allDepsCompleted = task->m_waitSemaphore == nullptr || task->m_waitSemaphore->m_atomic.load() == 0;
+		const Bool allDepsCompleted = task->m_waitSemaphore == nullptr
+									  || task->m_waitSemaphore->m_atomic.load(AtomicMemoryOrder::SEQ_CST) == 0;
 
 		if(allDepsCompleted)
 		{
@@ -227,19 +447,20 @@ ThreadHive::Task* ThreadHive::getNewTask()
 				prevTask->m_next = task->m_next;
 			}
 
-			if(m_head == task)
+			if(head == task)
 			{
-				m_head = task->m_next;
+				head = task->m_next;
 			}
 
-			if(m_tail == task)
+			if(tail == task)
 			{
-				m_tail = prevTask;
+				tail = prevTask;
 			}
 
 #if ANKI_EXTRA_CHECKS
 			task->m_next = nullptr;
 #endif
+			m_queuedTaskCounts[priority].fetchSub(1);
 			break;
 		}
 
@@ -254,15 +475,28 @@ void ThreadHive::waitAllTasks()
 {
 	ANKI_HIVE_DEBUG_PRINT("mt: waiting all\n");
 
-	LockGuard<Mutex> lock(m_mtx);
-	while(m_pendingTasks > 0)
 	{
-		m_cvar.wait(m_mtx);
+		LockGuard<Mutex> lock(m_mtx);
+		while(m_pendingTasks.load() > 0)
+		{
+			m_cvar.wait(m_mtx);
+		}
+	}
+
+#if ANKI_EXTRA_CHECKS
+	for(U32 i = 0; i < m_threadCount; ++i)
+	{
+		for(ThreadHiveTaskPriority priority : EnumIterable<ThreadHiveTaskPriority>())
+		{
+			ANKI_ASSERT(m_threads[i].m_heads[priority] == nullptr && m_threads[i].m_tails[priority] == nullptr);
+		}
 	}
+#endif
 
-	m_head = nullptr;
-	m_tail = nullptr;
-	m_alloc.getMemoryPool().reset();
+	for(StackAllocator<U8>& scratchAlloc : m_scratchAllocs)
+	{
+		scratchAlloc.getMemoryPool().reset();
+	}
 
 	ANKI_HIVE_DEBUG_PRINT("mt: done waiting all\n");
 }
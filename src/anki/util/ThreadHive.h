@@ -8,6 +8,9 @@
 #include <anki/util/Thread.h>
 #include <anki/util/WeakArray.h>
 #include <anki/util/Allocator.h>
+#include <anki/util/DynamicArray.h>
+#include <anki/util/Array.h>
+#include <anki/util/Enum.h>
 
 namespace anki
 {
@@ -44,6 +47,19 @@ private:
 using ThreadHiveTaskCallback = void (*)(
 	void* userData, U32 threadId, ThreadHive& hive, ThreadHiveSemaphore* signalSemaphore);
 
+/// The priority of a ThreadHiveTask. Tasks with higher priority are scheduled first.
+/// @memberof ThreadHive
+enum class ThreadHiveTaskPriority : U8
+{
+	HIGH, ///< Work in the critical path of the frame.
+	NORMAL,
+	LOW, ///< Work that can wait, like long running or asynchronous jobs.
+
+	COUNT,
+	FIRST = 0
+};
+ANKI_ENUM_ALLOW_NUMERIC_OPERATIONS(ThreadHiveTaskPriority, inline)
+
 /// Task for the ThreadHive. @memberof ThreadHive
 class ThreadHiveTask
 {
@@ -60,6 +76,9 @@ public:
 	/// When the task is completed that semaphore will be decremented by one. Can be used to set dependencies to future
 	/// tasks.
 	ThreadHiveSemaphore* m_signalSemaphore = nullptr;
+
+	/// The priority of the task.
+	ThreadHiveTaskPriority m_priority = ThreadHiveTaskPriority::NORMAL;
 };
 
 /// Initialize a ThreadHiveTask.
@@ -75,12 +94,21 @@ public:
 
 /// A scheduler of small tasks. It takes a number of tasks and schedules them in one of the threads. The tasks can
 /// depend on previously submitted tasks or be completely independent.
+/// Every thread owns a queue of tasks. Tasks submitted from inside a task callback are pushed to the queue of the
+/// thread that submits them and the rest are distributed to all queues. Threads that run out of work steal from the
+/// others. Tasks with higher ThreadHiveTaskPriority run first.
+/// When the threads are pinned they are spread to the physical cores first and then to the SMT siblings. The scratch
+/// memory is allocated from pools that are local to the NUMA node of the calling thread.
 class ThreadHive : public NonCopyable
 {
 public:
-	static const U32 MAX_THREADS = 32;
+	/// The maximum number of tasks of a single submitTasks() call. The scratch memory is sized to hold them.
+	static constexpr U32 MAX_TASKS_PER_SUBMIT = 1024;
 
 	/// Create the hive.
+	/// @param threadCount The number of threads. It can be more than the CPU cores.
+	/// @param alloc The allocator.
+	/// @param pinToCores Pin the threads to the CPU cores using the topology returned by getCpuTopology().
 	ThreadHive(U32 threadCount, GenericMemoryPoolAllocator<U8> alloc, Bool pinToCores = false);
 
 	~ThreadHive();
@@ -96,8 +124,8 @@ public:
 	{
 		ANKI_ASSERT(initialValue > 0);
 		PtrSize alignment = alignof(ThreadHiveSemaphore);
-		ThreadHiveSemaphore* sem =
-			reinterpret_cast<ThreadHiveSemaphore*>(m_alloc.allocate(sizeof(ThreadHiveSemaphore), &alignment));
+		ThreadHiveSemaphore* sem = reinterpret_cast<ThreadHiveSemaphore*>(
+			getScratchAllocator().allocate(sizeof(ThreadHiveSemaphore), &alignment));
 		sem->m_atomic.setNonAtomically(initialValue);
 		return sem;
 	}
@@ -107,7 +135,7 @@ public:
 	{
 		ANKI_ASSERT(size > 0 && alignment > 0);
 		PtrSize align = alignment;
-		void* out = m_alloc.allocate(size, &align);
+		void* out = getScratchAllocator().allocate(size, &align);
 #if ANKI_ASSERTS_ENABLED
 		memset(out, 0, size);
 #endif
@@ -115,20 +143,66 @@ public:
 	}
 
 	/// Submit tasks. The ThreadHiveTaskCallback callbacks can also call this.
+	/// @param tasks The tasks.
+	/// @param taskCount The number of tasks. It can't be more than MAX_TASKS_PER_SUBMIT.
 	void submitTasks(ThreadHiveTask* tasks, const U32 taskCount);
 
 	/// Submit a single task without dependencies. The ThreadHiveTaskCallback callbacks can also call this.
-	void submitTask(ThreadHiveTaskCallback callback, void* arg)
+	void submitTask(ThreadHiveTaskCallback callback,
+		void* arg,
+		ThreadHiveTaskPriority priority = ThreadHiveTaskPriority::NORMAL)
 	{
 		ThreadHiveTask task;
 		task.m_callback = callback;
 		task.m_argument = arg;
+		task.m_priority = priority;
 		submitTasks(&task, 1);
 	}
 
-	/// Wait for all tasks to finish. Will block.
+	/// Wait for all tasks to finish. Will block. It also frees the scratch memory so it's usually called once per frame.
 	void waitAllTasks();
 
+	/// Run a functor over the range [0, elementCount) using the hive threads. The range is split in chunks of at least
+	/// grainSize elements. The chunks start big and they get smaller as the range gets consumed to balance the load.
+	/// At most one task per thread is submitted. It waits only for its own tasks so it can run next to other work and
+	/// many threads can call it at the same time, but not the tasks since they would block a hive thread. The scratch
+	/// memory it uses is freed by the next waitAllTasks().
+	/// @param elementCount The number of elements.
+	/// @param grainSize The minimum number of elements to process in a single invocation of the functor.
+	/// @param func A functor with signature void(U32 begin, U32 end, U32 threadId).
+	template<typename TFunc>
+	void parallelFor(U32 elementCount, U32 grainSize, TFunc func);
+
+	/// Same as parallelFor() but every thread also accumulates a value of type T. The values of all threads are then
+	/// combined and returned.
+	/// @param elementCount The number of elements.
+	/// @param grainSize The minimum number of elements to process in a single invocation of the functor.
+	/// @param identity The initial value of every thread.
+	/// @param func A functor with signature void(U32 begin, U32 end, U32 threadId, T& threadValue).
+	/// @param combineFunc A functor with signature T(const T& a, const T& b).
+	template<typename T, typename TFunc, typename TCombineFunc>
+	T parallelReduce(U32 elementCount, U32 grainSize, const T& identity, TFunc func, TCombineFunc combineFunc);
+
+	/// Return true if the caller is one of the hive's threads.
+	Bool isHiveThread() const;
+
+	/// Get the time the hive threads spent running tasks of some priority since the last resetTaskTimes().
+	/// @note It's thread-safe.
+	Second getTaskTime(ThreadHiveTaskPriority priority) const
+	{
+		return Second(m_taskTimeNs[priority].load()) / 1000000000.0;
+	}
+
+	/// Reset the counters returned by getTaskTime(). Usually called once per frame.
+	/// @note It's thread-safe.
+	void resetTaskTimes()
+	{
+		for(Atomic<U64>& t : m_taskTimeNs)
+		{
+			t.store(0);
+		}
+	}
+
 private:
 	class Thread;
 
@@ -136,29 +210,63 @@ private:
 	class Task;
 
 	GenericMemoryPoolAllocator<U8> m_slowAlloc;
-	StackAllocator<U8> m_alloc;
+	DynamicArray<StackAllocator<U8>> m_scratchAllocs; ///< The allocators of the scratch memory. One per NUMA node.
 	Thread* m_threads = nullptr;
 	U32 m_threadCount = 0;
 
-	Task* m_head = nullptr; ///< Head of the task list.
-	Task* m_tail = nullptr; ///< Tail of the task list.
+	Atomic<U32, AtomicMemoryOrder::SEQ_CST> m_pendingTasks = {0};
+	Atomic<U32> m_nextQueue = {0}; ///< The queue that will get the next batch of tasks submitted from outside the hive.
+
+	/// It changes every time new work becomes available. Used to avoid missing wakeups.
+	Atomic<U64, AtomicMemoryOrder::SEQ_CST> m_workGeneration = {0};
+	Atomic<U32, AtomicMemoryOrder::SEQ_CST> m_sleepingThreadCount = {0};
+
+	/// The number of tasks waiting in the queues of each priority. Helps skipping the empty queues.
+	Array<Atomic<U32>, U32(ThreadHiveTaskPriority::COUNT)> m_queuedTaskCounts;
+
+	Array<Atomic<U64>, U32(ThreadHiveTaskPriority::COUNT)> m_taskTimeNs; ///< See getTaskTime().
+
 	Bool m_quit = false;
-	U32 m_pendingTasks = 0;
 
-	Mutex m_mtx;
+	Mutex m_mtx; ///< Protects the sleeping of the threads and the waitAllTasks().
 	ConditionVariable m_cvar;
 
+	/// The hive thread that is running in this OS thread.
+	static thread_local Thread* m_crntThread;
+
 	void threadRun(U32 threadId);
 
 	/// Wait for more tasks.
 	Bool waitForWork(U32 threadId, Task*& task);
 
-	/// Get new work from the queue.
-	Task* getNewTask();
+	/// Get new work. Higher priorities first. For each priority check first the local queue and then steal from the
+	/// others.
+	Task* getNewTask(U32 threadId);
+
+	/// Block until a semaphore reaches zero. The hive threads wake the caller like they wake each other.
+	void waitSemaphore(ThreadHiveSemaphore& sem);
 
-	/// Complete a task.
-	void completeTask(U32 taskId);
+	/// Pop the first task with resolved dependencies from a queue.
+	Task* popTask(Thread& thread, ThreadHiveTaskPriority priority);
+
+	/// Push a list of tasks of the same priority to a thread's queue.
+	void pushTasks(Thread& thread, Task* first, Task* last, U32 taskCount, Bool toFront);
+
+	/// Let the sleeping threads know that there is new work.
+	void notifyNewWork();
+
+	/// Get the scratch allocator of the NUMA node of the calling thread.
+	StackAllocator<U8>& getScratchAllocator();
+
+	template<typename TFunc>
+	class ParallelForCtx;
+
+	/// Get the next chunk of a parallelFor() range.
+	static Bool getNextParallelForChunk(
+		Atomic<U32>& nextElement, U32 elementCount, U32 grainSize, U32 taskCount, U32& begin, U32& end);
 };
 /// @}
 
 } // end namespace anki
+
+#include <anki/util/ThreadHive.inl.h>
@@ -0,0 +1,128 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+namespace anki
+{
+
+template<typename TFunc>
+class ThreadHive::ParallelForCtx
+{
+public:
+	TFunc* m_func;
+	Atomic<U32> m_nextElement = {0};
+	U32 m_elementCount;
+	U32 m_grainSize;
+	U32 m_taskCount;
+
+	static void callback(void* userData, U32 threadId, ThreadHive& hive, ThreadHiveSemaphore* signalSemaphore)
+	{
+		ParallelForCtx& self = *static_cast<ParallelForCtx*>(userData);
+
+		U32 begin, end;
+		while(getNextParallelForChunk(
+			self.m_nextElement, self.m_elementCount, self.m_grainSize, self.m_taskCount, begin, end))
+		{
+			(*self.m_func)(begin, end, threadId);
+		}
+	}
+};
+
+inline Bool ThreadHive::getNextParallelForChunk(
+	Atomic<U32>& nextElement, U32 elementCount, U32 grainSize, U32 taskCount, U32& begin, U32& end)
+{
+	begin = nextElement.load();
+	do
+	{
+		if(begin >= elementCount)
+		{
+			return false;
+		}
+
+		// Guided scheduling: split the remaining work in chunks that get smaller as the range gets consumed
+		const U32 remaining = elementCount - begin;
+		const U32 chunkSize = min(remaining, max(grainSize, remaining / (taskCount * 2)));
+		end = begin + chunkSize;
+	} while(!nextElement.compareExchange(begin, end));
+
+	return true;
+}
+
+template<typename TFunc>
+inline void ThreadHive::parallelFor(U32 elementCount, U32 grainSize, TFunc func)
+{
+	ANKI_ASSERT(grainSize > 0);
+	ANKI_ASSERT(!isHiveThread() && "Can't be called from inside a task");
+
+	if(elementCount == 0)
+	{
+		return;
+	}
+
+	// Don't submit more tasks than chunks
+	const U32 maxChunkCount = (elementCount + grainSize - 1) / grainSize;
+
+	ParallelForCtx<TFunc> ctx;
+	ctx.m_func = &func;
+	ctx.m_elementCount = elementCount;
+	ctx.m_grainSize = grainSize;
+	ctx.m_taskCount = min(m_threadCount, maxChunkCount);
+
+	// Wait on a semaphore of our own. waitAllTasks() would also wait for the tasks of others
+	ThreadHiveSemaphore* sem = newSemaphore(ctx.m_taskCount);
+
+	ThreadHiveTask* tasks = static_cast<ThreadHiveTask*>(
+		allocateScratchMemory(sizeof(ThreadHiveTask) * ctx.m_taskCount, alignof(ThreadHiveTask)));
+	for(U32 i = 0; i < ctx.m_taskCount; ++i)
+	{
+		::new(&tasks[i]) ThreadHiveTask();
+		tasks[i].m_callback = ParallelForCtx<TFunc>::callback;
+		tasks[i].m_argument = &ctx;
+		tasks[i].m_signalSemaphore = sem;
+	}
+
+	submitTasks(&tasks[0], ctx.m_taskCount);
+	waitSemaphore(*sem);
+}
+
+template<typename T, typename TFunc, typename TCombineFunc>
+inline T ThreadHive::parallelReduce(
+	U32 elementCount, U32 grainSize, const T& identity, TFunc func, TCombineFunc combineFunc)
+{
+	// One value per thread. Pad them to avoid false sharing
+	class alignas(ANKI_CACHE_LINE_SIZE) ThreadValue
+	{
+	public:
+		T m_value;
+		Bool m_used;
+	};
+
+	// Not scratch memory since it's only freed by waitAllTasks()
+	DynamicArrayAuto<ThreadValue> values(m_slowAlloc);
+	values.create(m_threadCount);
+	for(U32 i = 0; i < m_threadCount; ++i)
+	{
+		values[i].m_value = identity;
+		values[i].m_used = false;
+	}
+
+	parallelFor(elementCount, grainSize, [&](U32 begin, U32 end, U32 threadId) {
+		ThreadValue& val = values[threadId];
+		val.m_used = true;
+		func(begin, end, threadId, val.m_value);
+	});
+
+	T out = identity;
+	for(U32 i = 0; i < m_threadCount; ++i)
+	{
+		if(values[i].m_used)
+		{
+			out = combineFunc(out, values[i].m_value);
+		}
+	}
+
+	return out;
+}
+
+} // end namespace anki
@@ -7,6 +7,8 @@
 #include <anki/util/HighRezTimer.h>
 #include <anki/util/HashMap.h>
 #include <anki/util/List.h>
+#include <anki/util/Functions.h>
+#include <atomic>
 
 namespace anki
 {
@@ -29,15 +31,25 @@ public:
 	Chunk* m_currentChunk = nullptr;
 	IntrusiveList<Chunk> m_allChunks;
 	SpinLock m_currentChunkLock;
+
+	/// @name Ring buffer mode
+	/// @{
+	TracerEvent* m_ringEvents = nullptr;
+	U32 m_ringMask = 0;
+	Atomic<U64> m_ringWritePos = {0}; ///< The number of events ever written. Only the owner thread writes it.
+	/// @}
 };
 
 thread_local Tracer::ThreadLocal* Tracer::m_threadLocal = nullptr;
+thread_local U64 Tracer::m_threadLocalTracerUuid = 0;
+Atomic<U64> Tracer::m_nextUuid = {0};
 
 Tracer::~Tracer()
 {
 	LockGuard<Mutex> lock(m_allThreadLocalMtx);
 	for(ThreadLocal* tlocal : m_allThreadLocal)
 	{
+		destroyRingBuffer(*tlocal);
 		m_alloc.deleteInstance(tlocal);
 	}
 	m_allThreadLocal.destroy(m_alloc);
@@ -45,12 +57,18 @@ Tracer::~Tracer()
 
 Tracer::ThreadLocal& Tracer::getThreadLocal()
 {
-	ThreadLocal* out = m_threadLocal;
+	// The ThreadLocal might belong to a Tracer that got destroyed
+	ThreadLocal* out = (m_threadLocalTracerUuid == m_uuid) ? m_threadLocal : nullptr;
 	if(ANKI_UNLIKELY(out == nullptr))
 	{
 		out = m_alloc.newInstance<ThreadLocal>();
 		out->m_tid = Thread::getCurrentThreadId();
+		if(m_ringBufferSize)
+		{
+			createRingBuffer(*out);
+		}
 		m_threadLocal = out;
+		m_threadLocalTracerUuid = m_uuid;
 
 		// Store it
 		LockGuard<Mutex> lock(m_allThreadLocalMtx);
@@ -60,6 +78,25 @@ Tracer::ThreadLocal& Tracer::getThreadLocal()
 	return *out;
 }
 
+Tracer::ThreadLocal& Tracer::getGpuThreadLocal()
+{
+	LockGuard<Mutex> lock(m_allThreadLocalMtx);
+
+	if(ANKI_UNLIKELY(m_gpuThreadLocal == nullptr))
+	{
+		m_gpuThreadLocal = m_alloc.newInstance<ThreadLocal>();
+		m_gpuThreadLocal->m_tid = TRACER_GPU_THREAD_ID;
+		if(m_ringBufferSize)
+		{
+			createRingBuffer(*m_gpuThreadLocal);
+		}
+
+		m_allThreadLocal.emplaceBack(m_alloc, m_gpuThreadLocal);
+	}
+
+	return *m_gpuThreadLocal;
+}
+
 Tracer::Chunk& Tracer::getOrCreateChunk(ThreadLocal& tlocal)
 {
 	Chunk* out;
@@ -111,24 +148,21 @@ void Tracer::endEvent(const char* eventName, TracerEventHandle event)
 		return;
 	}
 
-	ThreadLocal& tlocal = getThreadLocal();
-
-	// Write the event
-	LockGuard<SpinLock> lock(tlocal.m_currentChunkLock);
-	Chunk& chunk = getOrCreateChunk(tlocal);
+	writeEvent(getThreadLocal(), eventName, event.m_start, duration);
+}
 
-	TracerEvent& writeEvent = chunk.m_events[chunk.m_eventCount++];
-	writeEvent.m_name = eventName;
-	writeEvent.m_start = event.m_start;
-	writeEvent.m_duration = duration;
+void Tracer::addCustomEvent(const char* eventName, Second start, Second duration)
+{
+	ANKI_ASSERT(eventName && start >= 0.0 && duration >= 0.0);
+	if(!m_enabled || duration == 0.0)
+	{
+		return;
+	}
 
-	// Write counter as well. In ns
-	TracerCounter& writeCounter = chunk.m_counters[chunk.m_counterCount++];
-	writeCounter.m_name = eventName;
-	writeCounter.m_value = U64(writeEvent.m_duration * 1000000000.0);
+	writeEvent(getThreadLocal(), eventName, start, duration);
 }
 
-void Tracer::addCustomEvent(const char* eventName, Second start, Second duration)
+void Tracer::addGpuEvent(const char* eventName, Second start, Second duration)
 {
 	ANKI_ASSERT(eventName && start >= 0.0 && duration >= 0.0);
 	if(!m_enabled || duration == 0.0)
@@ -136,7 +170,16 @@ void Tracer::addCustomEvent(const char* eventName, Second start, Second duration
 		return;
 	}
 
-	ThreadLocal& tlocal = getThreadLocal();
+	writeEvent(getGpuThreadLocal(), eventName, start, duration);
+}
+
+void Tracer::writeEvent(ThreadLocal& tlocal, const char* eventName, Second start, Second duration)
+{
+	if(m_ringBufferSize)
+	{
+		writeRingBufferEvent(tlocal, eventName, start, duration);
+		return;
+	}
 
 	// Write the event
 	LockGuard<SpinLock> lock(tlocal.m_currentChunkLock);
@@ -155,7 +198,7 @@ void Tracer::addCustomEvent(const char* eventName, Second start, Second duration
 
 void Tracer::incrementCounter(const char* counterName, U64 value)
 {
-	if(!m_enabled)
+	if(!m_enabled || m_ringBufferSize)
 	{
 		return;
 	}
@@ -195,4 +238,132 @@ void Tracer::flush(TracerFlushCallback callback, void* callbackUserData)
 	}
 }
 
+void Tracer::createRingBuffer(ThreadLocal& tlocal)
+{
+	ANKI_ASSERT(m_ringBufferSize > 0 && tlocal.m_ringEvents == nullptr);
+	tlocal.m_ringEvents = m_alloc.newArray<TracerEvent>(m_ringBufferSize);
+	tlocal.m_ringMask = m_ringBufferSize - 1;
+	tlocal.m_ringWritePos.setNonAtomically(0);
+}
+
+void Tracer::destroyRingBuffer(ThreadLocal& tlocal)
+{
+	if(tlocal.m_ringEvents)
+	{
+		m_alloc.deleteArray(tlocal.m_ringEvents, tlocal.m_ringMask + 1);
+		tlocal.m_ringEvents = nullptr;
+		tlocal.m_ringMask = 0;
+	}
+}
+
+void Tracer::setRingBufferMode(U32 eventsPerThread)
+{
+	LockGuard<Mutex> lock(m_allThreadLocalMtx);
+
+	for(ThreadLocal* tlocal : m_allThreadLocal)
+	{
+		destroyRingBuffer(*tlocal);
+	}
+
+	m_ringBufferSize = (eventsPerThread) ? nextPowerOfTwo(eventsPerThread) : 0;
+	m_frameCount.setNonAtomically(0);
+
+	if(m_ringBufferSize)
+	{
+		for(ThreadLocal* tlocal : m_allThreadLocal)
+		{
+			createRingBuffer(*tlocal);
+		}
+	}
+}
+
+void Tracer::writeRingBufferEvent(ThreadLocal& tlocal, const char* eventName, Second start, Second duration)
+{
+	ANKI_ASSERT(tlocal.m_ringEvents);
+
+	// Only this thread writes the position so there is no contention
+	const U64 pos = tlocal.m_ringWritePos.load();
+
+	// The readers might be copying the slot. Make sure that if they see the new data they will also see the position
+	// of the previous event and they will know that the slot is being written
+	std::atomic_thread_fence(std::memory_order_release);
+
+	TracerEvent& writeEvent = tlocal.m_ringEvents[pos & tlocal.m_ringMask];
+	writeEvent.m_name = eventName;
+	writeEvent.m_start = start;
+	writeEvent.m_duration = duration;
+
+	tlocal.m_ringWritePos.store(pos + 1, AtomicMemoryOrder::RELEASE);
+}
+
+void Tracer::beginFrame()
+{
+	if(!m_ringBufferSize)
+	{
+		return;
+	}
+
+	const U64 frame = m_frameCount.load();
+	m_frameStartTimes[frame % MAX_RING_BUFFER_FRAMES] = HighRezTimer::getCurrentTime();
+	m_frameCount.store(frame + 1, AtomicMemoryOrder::RELEASE);
+}
+
+void Tracer::snapshotRingBuffers(U32 lastFrameCount, TracerFlushCallback callback, void* callbackUserData)
+{
+	ANKI_ASSERT(callback && lastFrameCount > 0);
+	if(!m_ringBufferSize)
+	{
+		return;
+	}
+
+	// Find the start time of the first frame. Leave one frame of slack because beginFrame() might be overwriting it
+	Second minStartTime = 0.0;
+	const U64 frameCount = m_frameCount.load(AtomicMemoryOrder::ACQUIRE);
+	if(frameCount >= lastFrameCount)
+	{
+		const U64 framesBack = min<U64>(lastFrameCount, MAX_RING_BUFFER_FRAMES - 1);
+		minStartTime = m_frameStartTimes[(frameCount - framesBack) % MAX_RING_BUFFER_FRAMES];
+	}
+
+	DynamicArrayAuto<TracerEvent> events(m_alloc);
+	events.create(m_ringBufferSize);
+
+	LockGuard<Mutex> lock(m_allThreadLocalMtx);
+	for(ThreadLocal* tlocal : m_allThreadLocal)
+	{
+		// Copy the events optimistically. The owner thread might be overwriting some of them at the same time
+		const U64 writePos = tlocal->m_ringWritePos.load(AtomicMemoryOrder::ACQUIRE);
+		const U64 firstPos = (writePos > m_ringBufferSize) ? writePos - m_ringBufferSize : 0;
+		for(U64 pos = firstPos; pos < writePos; ++pos)
+		{
+			events[U32(pos - firstPos)] = tlocal->m_ringEvents[pos & tlocal->m_ringMask];
+		}
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+
+		// Drop the events that might have been overwritten. The one that is currently being written included
+		const U64 newWritePos = tlocal->m_ringWritePos.load(AtomicMemoryOrder::ACQUIRE);
+		const U64 firstValidPos = (newWritePos + 1 > m_ringBufferSize) ? newWritePos + 1 - m_ringBufferSize : 0;
+
+		// Keep the events of the last frames only
+		U32 eventCount = 0;
+		for(U64 pos = max(firstPos, firstValidPos); pos < writePos; ++pos)
+		{
+			const TracerEvent& event = events[U32(pos - firstPos)];
+			if(event.m_start >= minStartTime)
+			{
+				events[eventCount++] = event;
+			}
+		}
+
+		if(eventCount > 0)
+		{
+			callback(callbackUserData,
+				tlocal->m_tid,
+				WeakArray<TracerEvent>(&events[0], eventCount),
+				WeakArray<TracerCounter>());
+		}
+	}
+}
+
 } // end namespace anki
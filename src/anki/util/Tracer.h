@@ -8,6 +8,7 @@
 #include <anki/util/Thread.h>
 #include <anki/util/WeakArray.h>
 #include <anki/util/DynamicArray.h>
+#include <anki/util/Array.h>
 #include <anki/util/Singleton.h>
 #include <anki/util/String.h>
 
@@ -53,6 +54,10 @@ public:
 	}
 };
 
+/// The ThreadId of the events added with Tracer::addGpuEvent().
+/// @memberof Tracer
+constexpr ThreadId TRACER_GPU_THREAD_ID = 1;
+
 /// Tracer flush callback.
 /// @memberof Tracer
 using TracerFlushCallback = void (*)(
@@ -64,6 +69,7 @@ class Tracer : public NonCopyable
 public:
 	Tracer(GenericMemoryPoolAllocator<U8> alloc)
 		: m_alloc(alloc)
+		, m_uuid(m_nextUuid.fetchAdd(1) + 1)
 	{
 	}
 
@@ -81,6 +87,13 @@ public:
 	/// @note It's thread-safe.
 	void addCustomEvent(const char* eventName, Second start, Second duration);
 
+	/// Add an event that happened in the GPU. These events are reported with the TRACER_GPU_THREAD_ID thread ID.
+	/// @param eventName The name of the event. It should outlive the tracer.
+	/// @param start The time the event started. It should be in CPU time.
+	/// @param duration The duration of the event.
+	/// @note It's thread-safe but in the ring buffer mode it should be called by a single thread.
+	void addGpuEvent(const char* eventName, Second start, Second duration);
+
 	/// Increment a counter.
 	/// @note It's thread-safe.
 	void incrementCounter(const char* counterName, U64 value);
@@ -89,6 +102,30 @@ public:
 	/// @note It's thread-safe.
 	void flush(TracerFlushCallback callback, void* callbackUserData);
 
+	/// Switch to the ring buffer mode. In that mode every thread writes its events to a fixed-size ring buffer that
+	/// overwrites the oldest events. Writing is lock-free and it doesn't allocate memory. The counters are not recorded
+	/// and flush() won't return any events. Use snapshotRingBuffers() to get the latest events.
+	/// @param eventsPerThread The size of the ring buffer of every thread. It's rounded to the next power of two. Zero
+	///                        disables the ring buffer mode.
+	/// @note It's not thread-safe. Call it when no other thread is using the tracer.
+	void setRingBufferMode(U32 eventsPerThread);
+
+	Bool getRingBufferMode() const
+	{
+		return m_ringBufferSize > 0;
+	}
+
+	/// Mark the start of a new frame. snapshotRingBuffers() uses that to find the events of the last frames.
+	/// @note It should be called by a single thread.
+	void beginFrame();
+
+	/// Call the callback with the events of the last frames that are still in the ring buffers. The events are not
+	/// removed from the ring buffers. Useful to capture hitches after they happen. The callback will be called once per
+	/// thread and the counters will be empty.
+	/// @param lastFrameCount The number of frames to get, the current one included.
+	/// @note It's thread-safe.
+	void snapshotRingBuffers(U32 lastFrameCount, TracerFlushCallback callback, void* callbackUserData);
+
 	Bool getEnabled() const
 	{
 		return m_enabled;
@@ -102,6 +139,7 @@ public:
 private:
 	static constexpr U32 EVENTS_PER_CHUNK = 256;
 	static constexpr U32 COUNTERS_PER_CHUNK = 512;
+	static constexpr U32 MAX_RING_BUFFER_FRAMES = 128;
 
 	class ThreadLocal;
 	class Chunk;
@@ -109,17 +147,38 @@ private:
 	GenericMemoryPoolAllocator<U8> m_alloc;
 
 	static thread_local ThreadLocal* m_threadLocal;
+	static thread_local U64 m_threadLocalTracerUuid; ///< The Tracer that owns m_threadLocal.
+	static Atomic<U64> m_nextUuid;
+	U64 m_uuid; ///< Used to know if m_threadLocal belongs to this Tracer.
 	DynamicArray<ThreadLocal*> m_allThreadLocal; ///< The Tracer should know about all the ThreadLocal.
+	ThreadLocal* m_gpuThreadLocal = nullptr; ///< Holds the GPU events. It's also in m_allThreadLocal.
 	Mutex m_allThreadLocalMtx;
 
 	Bool m_enabled = false;
 
+	U32 m_ringBufferSize = 0; ///< The size of the ring buffers. Zero if not in ring buffer mode.
+	Array<Second, MAX_RING_BUFFER_FRAMES> m_frameStartTimes; ///< The start times of the last frames. See beginFrame().
+	Atomic<U64> m_frameCount = {0};
+
 	/// Get the thread local ThreadLocal structure.
 	/// @note Thread-safe.
 	ThreadLocal& getThreadLocal();
 
+	/// Get the ThreadLocal of the GPU events.
+	/// @note Thread-safe.
+	ThreadLocal& getGpuThreadLocal();
+
+	/// Write an event and its counter.
+	void writeEvent(ThreadLocal& tlocal, const char* eventName, Second start, Second duration);
+
 	/// Get or create a new chunk.
 	Chunk& getOrCreateChunk(ThreadLocal& tlocal);
+
+	/// Write an event to the ring buffer of the thread.
+	void writeRingBufferEvent(ThreadLocal& tlocal, const char* eventName, Second start, Second duration);
+
+	void createRingBuffer(ThreadLocal& tlocal);
+	void destroyRingBuffer(ThreadLocal& tlocal);
 };
 
 /// The global tracer.
@@ -151,10 +210,12 @@ private:
 #	define ANKI_TRACE_SCOPED_EVENT(name_) TracerScopedEvent _tse##name_(#	name_)
 #	define ANKI_TRACE_CUSTOM_EVENT(name_, start_, duration_) \
 		TracerSingleton::get().addCustomEvent(#name_, start_, duration_)
+#	define ANKI_TRACE_GPU_EVENT(name_, start_, duration_) TracerSingleton::get().addGpuEvent(#name_, start_, duration_)
 #	define ANKI_TRACE_INC_COUNTER(name_, val_) TracerSingleton::get().incrementCounter(#	name_, val_)
 #else
 #	define ANKI_TRACE_SCOPED_EVENT(name_) ((void)0)
 #	define ANKI_TRACE_CUSTOM_EVENT(name_, start_, duration_) ((void)0)
+#	define ANKI_TRACE_GPU_EVENT(name_, start_, duration_) ((void)0)
 #	define ANKI_TRACE_INC_COUNTER(name_, val_) ((void)0)
 #endif
 /// @}
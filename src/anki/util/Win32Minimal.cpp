@@ -29,4 +29,7 @@ ANKI_T_STRUCT(COORD)
 ANKI_T_STRUCT(CONSOLE_SCREEN_BUFFER_INFO)
 ANKI_T_STRUCT(SYSTEM_INFO)
 ANKI_T_STRUCT(FILETIME)
-ANKI_T_STRUCT(SMALL_RECT)
\ No newline at end of file
+ANKI_T_STRUCT(SMALL_RECT)
+ANKI_T_STRUCT(OVERLAPPED)
+ANKI_T_OFFSETOF(OVERLAPPED, Offset)
+ANKI_T_OFFSETOF(OVERLAPPED, hEvent)
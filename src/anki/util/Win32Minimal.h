@@ -31,7 +31,7 @@ typedef unsigned long ULONG;
 typedef unsigned char BYTE;
 typedef unsigned short WORD;
 typedef unsigned long DWORD;
-typedef unsigned __int64 ULONG_PTR;
+typedef unsigned __int64 ULONG_PTR, *PULONG_PTR;
 typedef __int64 LONG_PTR;
 typedef __int64 LONGLONG;
 typedef ULONG_PTR SIZE_T;
@@ -42,6 +42,7 @@ typedef DWORD* LPDWORD;
 typedef void* HANDLE;
 typedef void* PVOID;
 typedef void* LPVOID;
+typedef const void* LPCVOID;
 typedef const CHAR *LPCSTR, *PCSTR;
 typedef const CHAR* PCZZSTR;
 typedef CHAR* LPSTR;
@@ -63,6 +64,8 @@ typedef struct _CONSOLE_SCREEN_BUFFER_INFO CONSOLE_SCREEN_BUFFER_INFO, *PCONSOLE
 
 typedef struct _SYSTEM_INFO SYSTEM_INFO, *LPSYSTEM_INFO;
 
+typedef struct _OVERLAPPED OVERLAPPED, *LPOVERLAPPED;
+
 // Thread & locks
 ANKI_WINBASEAPI HANDLE ANKI_WINAPI CreateThread(LPSECURITY_ATTRIBUTES lpThreadAttributes,
 	SIZE_T dwStackSize,
@@ -103,6 +106,34 @@ ANKI_WINBASEAPI HRESULT ANKI_WINAPI SHGetFolderPathA(HWND hwnd, int csidl, HANDL
 ANKI_WINBASEAPI HANDLE ANKI_WINAPI FindFirstFileA(LPCSTR lpFileName, LPWIN32_FIND_DATAA lpFindFileData);
 ANKI_WINBASEAPI BOOL ANKI_WINAPI FindClose(HANDLE hFindFile);
 ANKI_WINBASEAPI BOOL ANKI_WINAPI FindNextFileA(HANDLE hFindFile, LPWIN32_FIND_DATAA lpFindFileData);
+ANKI_WINBASEAPI HANDLE ANKI_WINAPI CreateFileMappingA(HANDLE hFile,
+	LPSECURITY_ATTRIBUTES lpFileMappingAttributes,
+	DWORD flProtect,
+	DWORD dwMaximumSizeHigh,
+	DWORD dwMaximumSizeLow,
+	LPCSTR lpName);
+ANKI_WINBASEAPI LPVOID ANKI_WINAPI MapViewOfFile(HANDLE hFileMappingObject,
+	DWORD dwDesiredAccess,
+	DWORD dwFileOffsetHigh,
+	DWORD dwFileOffsetLow,
+	SIZE_T dwNumberOfBytesToMap);
+ANKI_WINBASEAPI BOOL ANKI_WINAPI UnmapViewOfFile(LPCVOID lpBaseAddress);
+ANKI_WINBASEAPI HANDLE ANKI_WINAPI CreateFileA(LPCSTR lpFileName,
+	DWORD dwDesiredAccess,
+	DWORD dwShareMode,
+	LPSECURITY_ATTRIBUTES lpSecurityAttributes,
+	DWORD dwCreationDisposition,
+	DWORD dwFlagsAndAttributes,
+	HANDLE hTemplateFile);
+ANKI_WINBASEAPI BOOL ANKI_WINAPI ReadFile(
+	HANDLE hFile, LPVOID lpBuffer, DWORD nNumberOfBytesToRead, LPDWORD lpNumberOfBytesRead, LPOVERLAPPED lpOverlapped);
+ANKI_WINBASEAPI HANDLE ANKI_WINAPI CreateIoCompletionPort(
+	HANDLE FileHandle, HANDLE ExistingCompletionPort, ULONG_PTR CompletionKey, DWORD NumberOfConcurrentThreads);
+ANKI_WINBASEAPI BOOL ANKI_WINAPI GetQueuedCompletionStatus(HANDLE CompletionPort,
+	LPDWORD lpNumberOfBytesTransferred,
+	PULONG_PTR lpCompletionKey,
+	LPOVERLAPPED* lpOverlapped,
+	DWORD dwMilliseconds);
 
 // Other
 ANKI_WINBASEAPI DWORD ANKI_WINAPI GetLastError(VOID);
@@ -139,6 +170,15 @@ constexpr WORD CSIDL_PROFILE = 0x0028;
 constexpr DWORD STD_OUTPUT_HANDLE = (DWORD)-11;
 constexpr HRESULT S_OK = 0;
 constexpr DWORD INFINITE = 0xFFFFFFFF;
+constexpr DWORD PAGE_READONLY = 0x02;
+constexpr DWORD FILE_MAP_READ = 0x0004;
+constexpr DWORD GENERIC_READ = 0x80000000;
+constexpr DWORD FILE_SHARE_READ = 0x00000001;
+constexpr DWORD OPEN_EXISTING = 3;
+constexpr DWORD FILE_ATTRIBUTE_NORMAL = 0x00000080;
+constexpr DWORD FILE_FLAG_OVERLAPPED = 0x40000000;
+constexpr DWORD ERROR_IO_PENDING = 997L;
+constexpr DWORD WAIT_TIMEOUT = 258L;
 
 constexpr WORD FOREGROUND_BLUE = 0x0001;
 constexpr WORD FOREGROUND_GREEN = 0x0002;
@@ -291,6 +331,22 @@ typedef struct _SYSTEM_INFO
 	WORD wProcessorRevision;
 } SYSTEM_INFO, *LPSYSTEM_INFO;
 
+typedef struct _OVERLAPPED
+{
+	ULONG_PTR Internal;
+	ULONG_PTR InternalHigh;
+	union
+	{
+		struct
+		{
+			DWORD Offset;
+			DWORD OffsetHigh;
+		};
+		PVOID Pointer;
+	};
+	HANDLE hEvent;
+} OVERLAPPED, *LPOVERLAPPED;
+
 // Critical section
 inline void InitializeCriticalSection(LPCRITICAL_SECTION lpCriticalSection)
 {
@@ -413,6 +469,73 @@ inline BOOL FindNextFileA(HANDLE hFindFile, LPWIN32_FIND_DATAA lpFindFileData)
 	return ::FindNextFileA(hFindFile, reinterpret_cast<::LPWIN32_FIND_DATAA>(lpFindFileData));
 }
 
+inline HANDLE CreateFileMappingA(HANDLE hFile,
+	LPSECURITY_ATTRIBUTES lpFileMappingAttributes,
+	DWORD flProtect,
+	DWORD dwMaximumSizeHigh,
+	DWORD dwMaximumSizeLow,
+	LPCSTR lpName)
+{
+	return ::CreateFileMappingA(hFile,
+		reinterpret_cast<::LPSECURITY_ATTRIBUTES>(lpFileMappingAttributes),
+		flProtect,
+		dwMaximumSizeHigh,
+		dwMaximumSizeLow,
+		lpName);
+}
+
+inline LPVOID MapViewOfFile(HANDLE hFileMappingObject,
+	DWORD dwDesiredAccess,
+	DWORD dwFileOffsetHigh,
+	DWORD dwFileOffsetLow,
+	SIZE_T dwNumberOfBytesToMap)
+{
+	return ::MapViewOfFile(
+		hFileMappingObject, dwDesiredAccess, dwFileOffsetHigh, dwFileOffsetLow, dwNumberOfBytesToMap);
+}
+
+inline BOOL UnmapViewOfFile(LPCVOID lpBaseAddress)
+{
+	return ::UnmapViewOfFile(lpBaseAddress);
+}
+
+inline HANDLE CreateFileA(LPCSTR lpFileName,
+	DWORD dwDesiredAccess,
+	DWORD dwShareMode,
+	LPSECURITY_ATTRIBUTES lpSecurityAttributes,
+	DWORD dwCreationDisposition,
+	DWORD dwFlagsAndAttributes,
+	HANDLE hTemplateFile)
+{
+	return ::CreateFileA(lpFileName,
+		dwDesiredAccess,
+		dwShareMode,
+		reinterpret_cast<::LPSECURITY_ATTRIBUTES>(lpSecurityAttributes),
+		dwCreationDisposition,
+		dwFlagsAndAttributes,
+		hTemplateFile);
+}
+
+inline BOOL ReadFile(
+	HANDLE hFile, LPVOID lpBuffer, DWORD nNumberOfBytesToRead, LPDWORD lpNumberOfBytesRead, LPOVERLAPPED lpOverlapped)
+{
+	return ::ReadFile(
+		hFile, lpBuffer, nNumberOfBytesToRead, lpNumberOfBytesRead, reinterpret_cast<::LPOVERLAPPED>(lpOverlapped));
+}
+
+inline BOOL GetQueuedCompletionStatus(HANDLE CompletionPort,
+	LPDWORD lpNumberOfBytesTransferred,
+	PULONG_PTR lpCompletionKey,
+	LPOVERLAPPED* lpOverlapped,
+	DWORD dwMilliseconds)
+{
+	return ::GetQueuedCompletionStatus(CompletionPort,
+		lpNumberOfBytesTransferred,
+		lpCompletionKey,
+		reinterpret_cast<::LPOVERLAPPED*>(lpOverlapped),
+		dwMilliseconds);
+}
+
 // Other
 inline BOOL QueryPerformanceFrequency(LARGE_INTEGER* lpFrequency)
 {
@@ -0,0 +1,148 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/Collision.h>
+#include <anki/util/Functions.h>
+
+using namespace anki;
+
+/// Brute force closest hit.
+static BvhHit castRayBruteForce(
+	ConstWeakArray<Vec3> positions, ConstWeakArray<U32> indices, const Ray& ray, F32 maxT, Bool& anyHit)
+{
+	BvhHit best;
+	best.m_t = maxT;
+	anyHit = false;
+
+	const Vec3 o = ray.getOrigin().xyz();
+	const Vec3 d = ray.getDirection().xyz();
+	for(U32 i = 0; i < indices.getSize() / 3; ++i)
+	{
+		const Vec3 v0 = positions[indices[i * 3 + 0]];
+		const Vec3 e1 = positions[indices[i * 3 + 1]] - v0;
+		const Vec3 e2 = positions[indices[i * 3 + 2]] - v0;
+
+		const Vec3 p = d.cross(e2);
+		const F32 det = e1.dot(p);
+		if(absolute(det) < 1.0e-8f)
+		{
+			continue;
+		}
+
+		const Vec3 s = o - v0;
+		const F32 u = s.dot(p) / det;
+		const Vec3 q = s.cross(e1);
+		const F32 v = d.dot(q) / det;
+		const F32 t = e2.dot(q) / det;
+		if(u >= 0.0f && v >= 0.0f && u + v <= 1.0f && t >= 0.0f && t < best.m_t)
+		{
+			best.m_t = t;
+			best.m_u = u;
+			best.m_v = v;
+			best.m_triangleIndex = i;
+			anyHit = true;
+		}
+	}
+
+	return best;
+}
+
+ANKI_TEST(Collision, Bvh)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	// Empty
+	{
+		Bvh bvh;
+		bvh.build(alloc, ConstWeakArray<Vec3>(), ConstWeakArray<U32>());
+		ANKI_TEST_EXPECT_EQ(bvh.isEmpty(), true);
+
+		BvhHit hit;
+		ANKI_TEST_EXPECT_EQ(
+			bvh.castRay(Ray(Vec4(0.0f), Vec4(0.0f, 0.0f, 1.0f, 0.0f)), MAX_F32, BvhRayQuery::CLOSEST_HIT, hit), false);
+	}
+
+	// Random triangle soup
+	constexpr U32 TRIANGLE_COUNT = 1000;
+	DynamicArrayAuto<Vec3> positions(alloc);
+	DynamicArrayAuto<U32> indices(alloc);
+	positions.create(TRIANGLE_COUNT * 3);
+	indices.create(TRIANGLE_COUNT * 3);
+	for(U32 i = 0; i < TRIANGLE_COUNT; ++i)
+	{
+		const Vec3 center(getRandomRange(-20.0f, 20.0f), getRandomRange(-20.0f, 20.0f), getRandomRange(-20.0f, 20.0f));
+		for(U32 j = 0; j < 3; ++j)
+		{
+			positions[i * 3 + j] =
+				center + Vec3(getRandomRange(-2.0f, 2.0f), getRandomRange(-2.0f, 2.0f), getRandomRange(-2.0f, 2.0f));
+			indices[i * 3 + j] = i * 3 + j;
+		}
+	}
+
+	Bvh bvh;
+	bvh.build(alloc, positions, indices);
+	ANKI_TEST_EXPECT_EQ(bvh.isEmpty(), false);
+	ANKI_TEST_EXPECT_EQ(bvh.getTriangleCount(), TRIANGLE_COUNT);
+
+	// Random rays
+	constexpr U32 RAY_COUNT = 103;
+	DynamicArrayAuto<Ray> rays(alloc);
+	rays.create(RAY_COUNT);
+	for(Ray& ray : rays)
+	{
+		const Vec3 origin(getRandomRange(-30.0f, 30.0f), getRandomRange(-30.0f, 30.0f), getRandomRange(-30.0f, 30.0f));
+		const Vec3 target(getRandomRange(-10.0f, 10.0f), getRandomRange(-10.0f, 10.0f), getRandomRange(-10.0f, 10.0f));
+		ray = Ray(origin, (target - origin).getNormalized());
+	}
+
+	// Axis aligned directions are a corner case
+	rays[0] = Ray(Vec4(0.0f, 0.0f, -40.0f, 0.0f), Vec4(0.0f, 0.0f, 1.0f, 0.0f));
+	rays[1] = Ray(Vec4(1.0f, 40.0f, 0.5f, 0.0f), Vec4(0.0f, -1.0f, 0.0f, 0.0f));
+
+	for(F32 maxT : {MAX_F32, 20.0f})
+	{
+		DynamicArrayAuto<BvhHit> closestHits(alloc);
+		DynamicArrayAuto<BvhHit> anyHits(alloc);
+		closestHits.create(RAY_COUNT);
+		anyHits.create(RAY_COUNT);
+		bvh.castRays(rays, maxT, BvhRayQuery::CLOSEST_HIT, WeakArray<BvhHit>(closestHits));
+		bvh.castRays(rays, maxT, BvhRayQuery::ANY_HIT, WeakArray<BvhHit>(anyHits));
+
+		for(U32 i = 0; i < RAY_COUNT; ++i)
+		{
+			Bool expectHit;
+			const BvhHit expected = castRayBruteForce(positions, indices, rays[i], maxT, expectHit);
+
+			// Single ray closest hit
+			BvhHit hit;
+			ANKI_TEST_EXPECT_EQ(bvh.castRay(rays[i], maxT, BvhRayQuery::CLOSEST_HIT, hit), expectHit);
+			if(expectHit)
+			{
+				ANKI_TEST_EXPECT_EQ(hit.m_triangleIndex, expected.m_triangleIndex);
+				ANKI_TEST_EXPECT_NEAR(hit.m_t, expected.m_t, 1.0e-3f);
+				ANKI_TEST_EXPECT_NEAR(hit.m_u, expected.m_u, 1.0e-3f);
+				ANKI_TEST_EXPECT_NEAR(hit.m_v, expected.m_v, 1.0e-3f);
+			}
+
+			// Single ray any hit
+			BvhHit hitAny;
+			ANKI_TEST_EXPECT_EQ(bvh.castRay(rays[i], maxT, BvhRayQuery::ANY_HIT, hitAny), expectHit);
+			if(expectHit)
+			{
+				ANKI_TEST_EXPECT_LEQ(hitAny.m_t, maxT);
+			}
+
+			// Packets
+			ANKI_TEST_EXPECT_EQ(closestHits[i].isHit(), expectHit);
+			ANKI_TEST_EXPECT_EQ(anyHits[i].isHit(), expectHit);
+			if(expectHit)
+			{
+				ANKI_TEST_EXPECT_EQ(closestHits[i].m_triangleIndex, expected.m_triangleIndex);
+				ANKI_TEST_EXPECT_NEAR(closestHits[i].m_t, expected.m_t, 1.0e-3f);
+			}
+		}
+	}
+}
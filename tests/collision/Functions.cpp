@@ -0,0 +1,348 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/Collision.h>
+#include <anki/util/Functions.h>
+#include <anki/util/HighRezTimer.h>
+#include <vector>
+
+using namespace anki;
+
+ANKI_TEST(Collision, TestPlanesBatch)
+{
+	constexpr U32 COUNT = 77;
+
+	for(U32 iteration = 0; iteration < 50; ++iteration)
+	{
+		Array<Plane, 6> planes;
+		for(Plane& plane : planes)
+		{
+			const Vec4 n = Vec4(getRandomRange(-1.0f, 1.0f), getRandomRange(-1.0f, 1.0f), 1.0f, 0.0f).getNormalized();
+			plane = Plane(n, getRandomRange(-5.0f, 5.0f));
+		}
+
+		Array<Aabb, COUNT> boxes;
+		Array<Sphere, COUNT> spheres;
+		for(U32 i = 0; i < COUNT; ++i)
+		{
+			const Vec4 center(
+				getRandomRange(-10.0f, 10.0f), getRandomRange(-10.0f, 10.0f), getRandomRange(-10.0f, 10.0f), 0.0f);
+			const Vec4 extend(getRandomRange(0.1f, 3.0f), getRandomRange(0.1f, 3.0f), getRandomRange(0.1f, 3.0f), 0.0f);
+			boxes[i] = Aabb(center - extend, center + extend);
+			spheres[i] = Sphere(center, extend.x());
+		}
+
+		Array<U64, (COUNT + 63) / 64> visible, insideFully;
+		testPlanesAabbs(planes, boxes, &visible[0], &insideFully[0]);
+
+		for(U32 i = 0; i < COUNT; ++i)
+		{
+			Bool expectedVisible = true;
+			Bool expectedInsideFully = true;
+			for(const Plane& plane : planes)
+			{
+				const F32 test = testPlane(plane, boxes[i]);
+				expectedVisible = expectedVisible && test >= 0.0f;
+				expectedInsideFully = expectedInsideFully && test > 0.0f;
+			}
+
+			ANKI_TEST_EXPECT_EQ(!!(visible[i / 64] & (U64(1) << (i % 64))), expectedVisible);
+			ANKI_TEST_EXPECT_EQ(!!(insideFully[i / 64] & (U64(1) << (i % 64))), expectedInsideFully);
+		}
+
+		testPlanesSpheres(planes, spheres, &visible[0], &insideFully[0]);
+
+		for(U32 i = 0; i < COUNT; ++i)
+		{
+			Bool expectedVisible = true;
+			Bool expectedInsideFully = true;
+			for(const Plane& plane : planes)
+			{
+				const F32 test = testPlane(plane, spheres[i]);
+				expectedVisible = expectedVisible && test >= 0.0f;
+				expectedInsideFully = expectedInsideFully && test > 0.0f;
+			}
+
+			ANKI_TEST_EXPECT_EQ(!!(visible[i / 64] & (U64(1) << (i % 64))), expectedVisible);
+			ANKI_TEST_EXPECT_EQ(!!(insideFully[i / 64] & (U64(1) << (i % 64))), expectedInsideFully);
+		}
+	}
+}
+
+ANKI_TEST(Collision, ComputeAabb)
+{
+	for(U32 iteration = 0; iteration < 50; ++iteration)
+	{
+		// Point clouds. Use odd counts to hit the remainders
+		const U32 count = 1 + (iteration * 7) % 37;
+		Array<Vec4, 64> points4;
+		Array<Vec3, 64> points3;
+		if(count == 1)
+		{
+			continue;
+		}
+
+		for(U32 i = 0; i < count; ++i)
+		{
+			points3[i] = Vec3(getRandomRange(-10.0f, 10.0f), getRandomRange(-10.0f, 10.0f), getRandomRange(-10.0f, 10.0f));
+		}
+
+		// Make sure the box is never flat
+		points3[count - 1] = points3[0] + Vec3(0.01f);
+
+		Vec4 expectedMin(MAX_F32);
+		Vec4 expectedMax(MIN_F32);
+		for(U32 i = 0; i < count; ++i)
+		{
+			points4[i] = Vec4(points3[i], 0.0f);
+			expectedMin = expectedMin.min(points4[i]);
+			expectedMax = expectedMax.max(points4[i]);
+		}
+
+		const Aabb aabb4 = computeAabb(ConstWeakArray<Vec4>(&points4[0], count));
+		const Aabb aabb3 = computeAabb(ConstWeakArray<Vec3>(&points3[0], count));
+		ANKI_TEST_EXPECT_EQ(aabb4.getMin(), expectedMin.xyz0());
+		ANKI_TEST_EXPECT_EQ(aabb4.getMax(), expectedMax.xyz0());
+		ANKI_TEST_EXPECT_EQ(aabb3.getMin(), expectedMin.xyz0());
+		ANKI_TEST_EXPECT_EQ(aabb3.getMax(), expectedMax.xyz0());
+
+		// Transformed hull against the scalar transform of the points
+		const Transform trf(Vec4(getRandomRange(-5.0f, 5.0f), getRandomRange(-5.0f, 5.0f), 1.0f, 0.0f),
+			Mat3x4(Euler(getRandomRange(0.0f, PI), getRandomRange(0.0f, PI), 0.0f)), getRandomRange(0.5f, 2.0f));
+		const ConvexHullShape hull = ConvexHullShape(&points4[0], count).getTransformed(trf);
+		Vec4 hullMin(MAX_F32);
+		Vec4 hullMax(MIN_F32);
+		for(U32 i = 0; i < count; ++i)
+		{
+			hullMin = hullMin.min(trf.transform(points4[i]));
+			hullMax = hullMax.max(trf.transform(points4[i]));
+		}
+
+		const Aabb hullAabb = computeAabb(hull);
+		for(U32 i = 0; i < 3; ++i)
+		{
+			ANKI_TEST_EXPECT_NEAR(hullAabb.getMin()[i], hullMin[i], 1.0e-3f);
+			ANKI_TEST_EXPECT_NEAR(hullAabb.getMax()[i], hullMax[i], 1.0e-3f);
+		}
+
+		// Transformed OBB against the transformed OBB
+		const Obb obb(Vec4(getRandomRange(-5.0f, 5.0f), 0.0f, 2.0f, 0.0f),
+			Mat3x4(Euler(0.0f, getRandomRange(0.0f, PI), getRandomRange(0.0f, PI))),
+			Vec4(getRandomRange(0.1f, 3.0f), getRandomRange(0.1f, 3.0f), getRandomRange(0.1f, 3.0f), 0.0f));
+		const Aabb expectedObbAabb = computeAabb(obb.getTransformed(trf));
+		const Aabb obbAabb = computeAabb(obb, trf);
+		for(U32 i = 0; i < 3; ++i)
+		{
+			ANKI_TEST_EXPECT_NEAR(obbAabb.getMin()[i], expectedObbAabb.getMin()[i], 1.0e-3f);
+			ANKI_TEST_EXPECT_NEAR(obbAabb.getMax()[i], expectedObbAabb.getMax()[i], 1.0e-3f);
+		}
+
+		// Many OBBs against the scalar version
+		Array<Obb, 7> obbs;
+		Array<const Obb*, 7> obbPtrs;
+		for(U32 i = 0; i < obbs.getSize(); ++i)
+		{
+			obbs[i] = Obb(Vec4(getRandomRange(-5.0f, 5.0f), getRandomRange(-5.0f, 5.0f), 2.0f, 0.0f),
+				Mat3x4(Euler(getRandomRange(0.0f, PI), getRandomRange(0.0f, PI), getRandomRange(0.0f, PI))),
+				Vec4(getRandomRange(0.1f, 3.0f), getRandomRange(0.1f, 3.0f), getRandomRange(0.1f, 3.0f), 0.0f));
+			obbPtrs[i] = &obbs[i];
+		}
+
+		Array<Aabb, 7> obbAabbs;
+		computeAabbs(ConstWeakArray<const Obb*>(obbPtrs), WeakArray<Aabb>(obbAabbs));
+		for(U32 o = 0; o < obbs.getSize(); ++o)
+		{
+			const Aabb expected = computeAabb(obbs[o]);
+			for(U32 i = 0; i < 3; ++i)
+			{
+				ANKI_TEST_EXPECT_NEAR(obbAabbs[o].getMin()[i], expected.getMin()[i], 1.0e-4f);
+				ANKI_TEST_EXPECT_NEAR(obbAabbs[o].getMax()[i], expected.getMax()[i], 1.0e-4f);
+			}
+		}
+
+		// Transformed boxes against the transformed corners
+		const Array<Aabb, 2> boxes = {{aabb4, Aabb(Vec4(-1.0f, -1.0f, -1.0f, 0.0f), Vec4(1.0f, 2.0f, 3.0f, 0.0f))}};
+		const Array<Mat3x4, 2> trfs = {{Mat3x4(trf), Mat3x4(Vec3(1.0f, 2.0f, 3.0f), Mat3(Euler(1.0f, 0.5f, 0.0f)))}};
+		Vec4 cornersMin(MAX_F32);
+		Vec4 cornersMax(MIN_F32);
+		for(U32 b = 0; b < 2; ++b)
+		{
+			for(U32 c = 0; c < 8; ++c)
+			{
+				const Vec4 corner((c & 1) ? boxes[b].getMax().x() : boxes[b].getMin().x(),
+					(c & 2) ? boxes[b].getMax().y() : boxes[b].getMin().y(),
+					(c & 4) ? boxes[b].getMax().z() : boxes[b].getMin().z(), 1.0f);
+				const Vec4 p(trfs[b] * corner, 0.0f);
+				cornersMin = cornersMin.min(p);
+				cornersMax = cornersMax.max(p);
+			}
+		}
+
+		const Aabb boxesAabb = computeAabb(boxes, trfs);
+		for(U32 i = 0; i < 3; ++i)
+		{
+			ANKI_TEST_EXPECT_NEAR(boxesAabb.getMin()[i], cornersMin[i], 1.0e-3f);
+			ANKI_TEST_EXPECT_NEAR(boxesAabb.getMax()[i], cornersMax[i], 1.0e-3f);
+		}
+	}
+}
+
+ANKI_TEST(Collision, ExtractClipPlanes)
+{
+	const Mat4 proj = Mat4::calculatePerspectiveProjectionMatrix(toRad(90.0f), toRad(90.0f), 0.1f, 50.0f);
+
+	Array<Transform, 6> trfs;
+	for(Transform& trf : trfs)
+	{
+		trf = Transform(Vec4(getRandomRange(-10.0f, 10.0f), getRandomRange(-10.0f, 10.0f), 0.0f, 0.0f),
+			Mat3x4(Euler(getRandomRange(-PI, PI), getRandomRange(-PI, PI), getRandomRange(-PI, PI))), 1.0f);
+	}
+
+	Array<Array<Plane, 6>, 6> batchPlanes;
+	extractClipPlanes(proj, trfs, batchPlanes);
+
+	for(U32 i = 0; i < trfs.getSize(); ++i)
+	{
+		const Mat4 mvp = proj * Mat4(trfs[i].getInverse());
+		Array<Plane, 6> planes;
+		extractClipPlanes(mvp, planes);
+
+		for(FrustumPlaneType p = FrustumPlaneType::FIRST; p < FrustumPlaneType::COUNT; ++p)
+		{
+			Plane plane;
+			extractClipPlane(mvp, p, plane);
+			ANKI_TEST_EXPECT_EQ(plane.getNormal(), planes[p].getNormal());
+			ANKI_TEST_EXPECT_EQ(plane.getOffset(), planes[p].getOffset());
+
+			for(U32 c = 0; c < 3; ++c)
+			{
+				ANKI_TEST_EXPECT_NEAR(batchPlanes[i][p].getNormal()[c], planes[p].getNormal()[c], 1.0e-3f);
+			}
+			ANKI_TEST_EXPECT_NEAR(batchPlanes[i][p].getOffset(), planes[p].getOffset(), 1.0e-2f);
+		}
+	}
+
+	// The cube face edges
+	Array<Vec4, 4> edges, cubeEdges;
+	computeEdgesOfFrustum(10.0f, toRad(90.0f), toRad(90.0f), &edges[0]);
+	computeEdgesOfCubeFaceFrustum(10.0f, &cubeEdges[0]);
+	for(U32 i = 0; i < 4; ++i)
+	{
+		for(U32 c = 0; c < 4; ++c)
+		{
+			ANKI_TEST_EXPECT_NEAR(edges[i][c], cubeEdges[i][c], 1.0e-4f);
+		}
+	}
+}
+
+ANKI_TEST(Collision, LightBinBench)
+{
+	// Test lights against the clusters of a tile like the ClusterBin does: one by one vs 8 clusters at a time
+	constexpr U32 CLUSTER_COUNT = 64;
+	constexpr U32 LIGHT_COUNT = 512;
+	constexpr U32 GROUP_COUNT = CLUSTER_COUNT / F32x8::LANE_COUNT;
+
+	Array<Aabb, CLUSTER_COUNT> boxes;
+	Array<Sphere, CLUSTER_COUNT> spheres;
+	Array<Vec3x8, GROUP_COUNT> boxMins, boxMaxs, sphereCenters;
+	Array<F32x8, GROUP_COUNT> sphereRadii;
+	for(U32 group = 0; group < GROUP_COUNT; ++group)
+	{
+		Array<Vec3, F32x8::LANE_COUNT> mins, maxs, centers;
+		Array<F32, F32x8::LANE_COUNT> radii;
+		for(U32 i = 0; i < F32x8::LANE_COUNT; ++i)
+		{
+			// Froxels that grow with the distance
+			const U32 idx = group * F32x8::LANE_COUNT + i;
+			const F32 near = F32(idx * idx) * 0.05f;
+			const F32 far = F32((idx + 1) * (idx + 1)) * 0.05f;
+			const Vec4 min(-near - 1.0f, -near - 1.0f, -far, 0.0f);
+			const Vec4 max(far + 1.0f, far + 1.0f, -near, 0.0f);
+			boxes[idx] = Aabb(min, max);
+			const Vec4 center = (min + max) / 2.0f;
+			spheres[idx] = Sphere(center, (max - center).getLength());
+
+			mins[i] = min.xyz();
+			maxs[i] = max.xyz();
+			centers[i] = center.xyz();
+			radii[i] = spheres[idx].getRadius();
+		}
+
+		boxMins[group] = Vec3x8::loadAos(&mins[0]);
+		boxMaxs[group] = Vec3x8::loadAos(&maxs[0]);
+		sphereCenters[group] = Vec3x8::loadAos(&centers[0]);
+		sphereRadii[group] = F32x8::load(&radii[0]);
+	}
+
+	std::vector<Sphere> pointLights;
+	std::vector<Cone> spotLights;
+	for(U32 i = 0; i < LIGHT_COUNT; ++i)
+	{
+		const Vec4 pos(getRandomRange(-50.0f, 50.0f), getRandomRange(-50.0f, 50.0f), getRandomRange(-200.0f, 0.0f), 0.0f);
+		pointLights.emplace_back(pos, getRandomRange(1.0f, 20.0f));
+
+		const Vec4 dir =
+			Vec4(getRandomRange(-1.0f, 1.0f), getRandomRange(-1.0f, 1.0f), getRandomRange(-1.0f, 1.0f), 0.0f)
+				.getNormalized();
+		spotLights.emplace_back(pos, dir, getRandomRange(1.0f, 30.0f), getRandomRange(0.1f, PI / 2.0f));
+	}
+
+	// Scalar
+	HighRezTimer timer;
+	U32 scalarHits = 0;
+	std::vector<U32> scalarMasks(LIGHT_COUNT * GROUP_COUNT * 2, 0);
+	timer.start();
+	for(U32 l = 0; l < LIGHT_COUNT; ++l)
+	{
+		for(U32 c = 0; c < CLUSTER_COUNT; ++c)
+		{
+			const U32 bit = 1u << (c % F32x8::LANE_COUNT);
+			if(testCollision(pointLights[l], boxes[c]))
+			{
+				scalarMasks[(l * GROUP_COUNT + c / F32x8::LANE_COUNT) * 2 + 0] |= bit;
+				++scalarHits;
+			}
+
+			if(testCollision(spheres[c], spotLights[l]))
+			{
+				scalarMasks[(l * GROUP_COUNT + c / F32x8::LANE_COUNT) * 2 + 1] |= bit;
+				++scalarHits;
+			}
+		}
+	}
+	timer.stop();
+	const Second scalarTime = timer.getElapsedTime();
+
+	// Wide
+	U32 wideHits = 0;
+	std::vector<U32> wideMasks(LIGHT_COUNT * GROUP_COUNT * 2, 0);
+	timer.start();
+	for(U32 l = 0; l < LIGHT_COUNT; ++l)
+	{
+		const Cone& cone = spotLights[l];
+		const F32 cosHalfAngle = cos(cone.getAngle() / 2.0f);
+		const F32 sinHalfAngle = sin(cone.getAngle() / 2.0f);
+		for(U32 g = 0; g < GROUP_COUNT; ++g)
+		{
+			const U32 pointMask = testCollisionAabbsSphere(boxMins[g], boxMaxs[g], pointLights[l]);
+			const U32 spotMask =
+				testCollisionSpheresCone(sphereCenters[g], sphereRadii[g], cone, cosHalfAngle, sinHalfAngle);
+			wideMasks[(l * GROUP_COUNT + g) * 2 + 0] = pointMask;
+			wideMasks[(l * GROUP_COUNT + g) * 2 + 1] = spotMask;
+			wideHits += __builtin_popcount(pointMask) + __builtin_popcount(spotMask);
+		}
+	}
+	timer.stop();
+	const Second wideTime = timer.getElapsedTime();
+
+	ANKI_TEST_EXPECT_EQ(scalarHits, wideHits);
+	for(U32 i = 0; i < U32(scalarMasks.size()); ++i)
+	{
+		ANKI_TEST_EXPECT_EQ(scalarMasks[i], wideMasks[i]);
+	}
+
+	ANKI_TEST_LOGI("Light bin bench: scalar %f, x8 %f (hits %u)", scalarTime, wideTime, wideHits);
+}
@@ -0,0 +1,83 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/Collision.h>
+#include <anki/util/Functions.h>
+
+using namespace anki;
+
+/// The exact distance of 2 axis aligned cubes with half size of 1.
+static F32 cubeDistance(const Vec4& offset)
+{
+	const Vec4 d = (offset.abs() - Vec4(2.0f)).max(Vec4(0.0f)).xyz0();
+	return d.getLength();
+}
+
+ANKI_TEST(Collision, GjkDistance)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	Array<Vec4, 8> points;
+	for(U32 i = 0; i < 8; ++i)
+	{
+		points[i] = Vec4((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f, (i & 4) ? 1.0f : -1.0f, 0.0f);
+	}
+
+	const ConvexHullShape a(&points[0], points.getSize());
+
+	constexpr U32 HULL_COUNT = 64;
+	Array<Vec4, HULL_COUNT> offsets;
+	Array<ConvexHullShape, HULL_COUNT> hulls;
+	Array<const ConvexHullShape*, HULL_COUNT> hullPtrs;
+	for(U32 i = 0; i < HULL_COUNT; ++i)
+	{
+		offsets[i] = Vec4(getRandomRange(-6.0f, 6.0f), getRandomRange(-6.0f, 6.0f), getRandomRange(-6.0f, 6.0f), 0.0f);
+		hulls[i] = ConvexHullShape(&points[0], points.getSize()).getTransformed(Transform(offsets[i]));
+		hullPtrs[i] = &hulls[i];
+	}
+
+	GjkQueryCache cache(alloc);
+	for(U32 frame = 0; frame < 4; ++frame)
+	{
+		Array<F32, HULL_COUNT> distances;
+		computeDistances(a, hullPtrs, MAX_F32, distances, (frame > 0) ? &cache : nullptr);
+
+		Array<F32, HULL_COUNT> earlyOutDistances;
+		computeDistances(a, hullPtrs, 1.0f, earlyOutDistances, &cache);
+
+		for(U32 i = 0; i < HULL_COUNT; ++i)
+		{
+			const F32 expected = cubeDistance(offsets[i]);
+			ANKI_TEST_EXPECT_NEAR(distances[i], expected, 1.0e-3f);
+
+			if(expected > 1.0f + 1.0e-3f)
+			{
+				ANKI_TEST_EXPECT_GT(earlyOutDistances[i], 1.0f);
+			}
+			else if(expected < 1.0f - 1.0e-3f)
+			{
+				ANKI_TEST_EXPECT_NEAR(earlyOutDistances[i], expected, 1.0e-3f);
+			}
+
+			// The cached intersection test should give the same result
+			ANKI_TEST_EXPECT_EQ(testCollision(a, hulls[i], cache), testCollision(a, hulls[i]));
+		}
+
+		// Move the hulls a bit like in a new frame
+		for(U32 i = 0; i < HULL_COUNT; ++i)
+		{
+			offsets[i] += Vec4(getRandomRange(-0.1f, 0.1f), getRandomRange(-0.1f, 0.1f), 0.0f, 0.0f);
+			hulls[i] = ConvexHullShape(&points[0], points.getSize()).getTransformed(Transform(offsets[i]));
+		}
+
+		cache.endFrame();
+		ANKI_TEST_EXPECT_EQ(cache.getEntryCount(), HULL_COUNT);
+	}
+
+	// The pairs that are not used any more get evicted
+	cache.endFrame();
+	ANKI_TEST_EXPECT_EQ(cache.getEntryCount(), 0);
+}
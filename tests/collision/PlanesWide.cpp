@@ -0,0 +1,62 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/Collision.h>
+#include <anki/util/Functions.h>
+
+using namespace anki;
+
+template<typename T>
+static Bool insideAllPlanes(ConstWeakArray<Plane> planes, const T& shape)
+{
+	for(const Plane& plane : planes)
+	{
+		if(testPlane(plane, shape) < 0.0f)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+ANKI_TEST(Collision, PlanesWide)
+{
+	// Empty set
+	{
+		PlanesWide planes;
+		ANKI_TEST_EXPECT_EQ(planes.getPlaneCount(), 0);
+		ANKI_TEST_EXPECT_EQ(planes.insideAll(Sphere(Vec4(100.0f, 0.0f, 0.0f, 0.0f), 1.0f)), true);
+	}
+
+	// Compare with testPlane() using random shapes and planes
+	for(U32 iteration = 0; iteration < 200; ++iteration)
+	{
+		Array<Plane, 6> planeArr;
+		for(Plane& plane : planeArr)
+		{
+			const Vec4 n = Vec4(getRandomRange(-1.0f, 1.0f), getRandomRange(-1.0f, 1.0f), 1.0f, 0.0f).getNormalized();
+			plane = Plane(n, getRandomRange(-5.0f, 5.0f));
+		}
+
+		PlanesWide planes;
+		planes.setPlanes(planeArr);
+		ANKI_TEST_EXPECT_EQ(planes.getPlaneCount(), 6);
+
+		const Vec4 center(getRandomRange(-10.0f, 10.0f), getRandomRange(-10.0f, 10.0f), getRandomRange(-10.0f, 10.0f), 0.0f);
+		const Vec4 extend(getRandomRange(0.1f, 3.0f), getRandomRange(0.1f, 3.0f), getRandomRange(0.1f, 3.0f), 0.0f);
+
+		const Aabb aabb(center - extend, center + extend);
+		ANKI_TEST_EXPECT_EQ(planes.insideAll(aabb), insideAllPlanes(planeArr, aabb));
+
+		const Sphere sphere(center, extend.x());
+		ANKI_TEST_EXPECT_EQ(planes.insideAll(sphere), insideAllPlanes(planeArr, sphere));
+
+		const Mat3x4 rot(Euler(getRandomRange(0.0f, PI), getRandomRange(0.0f, PI), 0.0f));
+		const Obb obb(center, rot, extend);
+		ANKI_TEST_EXPECT_EQ(planes.insideAll(obb), insideAllPlanes(planeArr, obb));
+	}
+}
@@ -0,0 +1,145 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/Collision.h>
+#include <anki/util/Functions.h>
+
+using namespace anki;
+
+/// Scalar slab test in double precision.
+static Bool intersectBox(const Vec3& origin, const Vec3& dir, F64 maxT, const Vec3& boxMin, const Vec3& boxMax)
+{
+	F64 tNear = 0.0;
+	F64 tFar = maxT;
+	for(U32 i = 0; i < 3; ++i)
+	{
+		if(dir[i] == 0.0f)
+		{
+			if(origin[i] < boxMin[i] || origin[i] > boxMax[i])
+			{
+				return false;
+			}
+			continue;
+		}
+
+		F64 t1 = (F64(boxMin[i]) - origin[i]) / dir[i];
+		F64 t2 = (F64(boxMax[i]) - origin[i]) / dir[i];
+		if(t1 > t2)
+		{
+			std::swap(t1, t2);
+		}
+		tNear = max(tNear, t1);
+		tFar = min(tFar, t2);
+	}
+
+	return tNear <= tFar;
+}
+
+/// Scalar ray sphere test in double precision.
+static Bool intersectSphere(const Vec3& origin, const Vec3& dir, F64 maxT, const Sphere& sphere)
+{
+	const Vec3 m = origin - sphere.getCenter().xyz();
+	const F64 c = F64(m.dot(m)) - F64(sphere.getRadius()) * sphere.getRadius();
+	if(c <= 0.0)
+	{
+		return true;
+	}
+
+	const F64 a = dir.dot(dir);
+	const F64 b = m.dot(dir);
+	const F64 discr = b * b - a * c;
+	if(discr < 0.0 || b >= 0.0)
+	{
+		return false;
+	}
+
+	return (-b - std::sqrt(discr)) / a <= maxT;
+}
+
+template<typename TRayPacket>
+static void testRayPacket()
+{
+	constexpr U32 LANE_COUNT = TRayPacket::LANE_COUNT;
+
+	for(U32 iteration = 0; iteration < 200; ++iteration)
+	{
+		// Some rays and segments, one less than the lanes to test the unused lanes
+		const U32 count = LANE_COUNT - (iteration & 1);
+		Array<Ray, LANE_COUNT> rays;
+		Array<LineSegment, LANE_COUNT> segments;
+		for(U32 i = 0; i < count; ++i)
+		{
+			const Vec3 origin(getRandomRange(-10.0f, 10.0f), getRandomRange(-10.0f, 10.0f), getRandomRange(-10.0f, 10.0f));
+			Vec3 dir(getRandomRange(-1.0f, 1.0f), getRandomRange(-1.0f, 1.0f), getRandomRange(-1.0f, 1.0f));
+			if(i == 0)
+			{
+				// Axis aligned
+				dir = Vec3(0.0f, 1.0f, 0.0f);
+			}
+
+			rays[i] = Ray(origin, dir.getNormalized());
+			segments[i] = LineSegment(Vec4(origin, 0.0f), Vec4(dir * getRandomRange(1.0f, 10.0f), 0.0f));
+		}
+
+		TRayPacket rayPacket;
+		rayPacket.setRays(ConstWeakArray<Ray>(&rays[0], count));
+		ANKI_TEST_EXPECT_EQ(rayPacket.getActiveMask(), (1u << count) - 1u);
+
+		TRayPacket segmentPacket;
+		segmentPacket.setSegments(ConstWeakArray<LineSegment>(&segments[0], count));
+
+		// Shapes
+		const Vec4 center(getRandomRange(-5.0f, 5.0f), getRandomRange(-5.0f, 5.0f), getRandomRange(-5.0f, 5.0f), 0.0f);
+		const Vec4 extend(getRandomRange(0.5f, 4.0f), getRandomRange(0.5f, 4.0f), getRandomRange(0.5f, 4.0f), 0.0f);
+		const Aabb aabb(center - extend, center + extend);
+		const Sphere sphere(center, extend.x());
+		const Obb obb(center, Mat3x4(Euler(getRandomRange(0.0f, PI), getRandomRange(0.0f, PI), 0.0f)), extend);
+
+		const U32 aabbMask = rayPacket.intersect(aabb);
+		const U32 sphereMask = rayPacket.intersect(sphere);
+		const U32 obbMask = rayPacket.intersect(obb);
+		const U32 segAabbMask = segmentPacket.intersect(aabb);
+		const U32 segSphereMask = segmentPacket.intersect(sphere);
+		const U32 segObbMask = segmentPacket.intersect(obb);
+
+		for(U32 i = 0; i < LANE_COUNT; ++i)
+		{
+			const U32 bit = 1u << i;
+			if(i >= count)
+			{
+				ANKI_TEST_EXPECT_EQ(aabbMask & bit, 0);
+				ANKI_TEST_EXPECT_EQ(sphereMask & bit, 0);
+				ANKI_TEST_EXPECT_EQ(obbMask & bit, 0);
+				continue;
+			}
+
+			const Vec3 o = rays[i].getOrigin().xyz();
+			const Vec3 d = rays[i].getDirection().xyz();
+			ANKI_TEST_EXPECT_EQ(!!(aabbMask & bit), intersectBox(o, d, MAX_F64, aabb.getMin().xyz(), aabb.getMax().xyz()));
+			ANKI_TEST_EXPECT_EQ(!!(sphereMask & bit), intersectSphere(o, d, MAX_F64, sphere));
+
+			const Vec3 sd = segments[i].getDirection().xyz();
+			ANKI_TEST_EXPECT_EQ(!!(segAabbMask & bit), intersectBox(o, sd, 1.0, aabb.getMin().xyz(), aabb.getMax().xyz()));
+			ANKI_TEST_EXPECT_EQ(!!(segSphereMask & bit), intersectSphere(o, sd, 1.0, sphere));
+
+			// For the OBB move the ray to the space of the box
+			const Mat3 invRot = obb.getRotation().getRotationPart().getTransposed();
+			const Vec3 localO = invRot * (o - center.xyz());
+			ANKI_TEST_EXPECT_EQ(!!(obbMask & bit), intersectBox(localO, invRot * d, MAX_F64, -extend.xyz(), extend.xyz()));
+			ANKI_TEST_EXPECT_EQ(
+				!!(segObbMask & bit), intersectBox(localO, invRot * sd, 1.0, -extend.xyz(), extend.xyz()));
+		}
+
+		// The mask argument
+		ANKI_TEST_EXPECT_EQ(rayPacket.intersect(aabb, 0b101), aabbMask & 0b101);
+	}
+}
+
+ANKI_TEST(Collision, RayPacket)
+{
+	testRayPacket<RayPacket4>();
+	testRayPacket<RayPacket8>();
+}
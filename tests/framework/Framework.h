@@ -8,6 +8,7 @@
 #include <anki/util/Singleton.h>
 #include <anki/Math.h>
 #include <anki/util/Logger.h>
+#include <anki/util/HighRezTimer.h>
 #include <anki/Core.h>
 #include <anki/Gr.h>
 #include <anki/Resource.h>
@@ -230,4 +231,48 @@ GrManager* createGrManager(const ConfigSet& cfg, NativeWindow* win);
 ResourceManager* createResourceManager(
 	const ConfigSet& cfg, GrManager* gr, PhysicsWorld*& physics, ResourceFilesystem*& resourceFs);
 
+/// Accumulates the timings of a benchmark and logs them when it's destroyed. The log line looks like:
+/// BENCH,<name>,<thread count>,<iteration count>,<average ms>,<min ms>
+/// so the results of two runs can be diffed or fed into a script to catch regressions.
+class BenchTimer
+{
+public:
+	BenchTimer(CString name, U32 threadCount)
+		: m_name(name)
+		, m_threadCount(threadCount)
+	{
+	}
+
+	~BenchTimer()
+	{
+		ANKI_TEST_LOGI("BENCH,%s,%u,%u,%f,%f",
+			m_name.cstr(),
+			m_threadCount,
+			m_iterationCount,
+			(m_iterationCount) ? m_totalTime / Second(m_iterationCount) * 1000.0 : 0.0,
+			(m_iterationCount) ? m_minTime * 1000.0 : 0.0);
+	}
+
+	void begin()
+	{
+		m_begin = HighRezTimer::getCurrentTime();
+	}
+
+	void end()
+	{
+		const Second time = HighRezTimer::getCurrentTime() - m_begin;
+		m_totalTime += time;
+		m_minTime = min(m_minTime, time);
+		++m_iterationCount;
+	}
+
+private:
+	CString m_name;
+	U32 m_threadCount;
+	U32 m_iterationCount = 0;
+	Second m_begin = 0.0;
+	Second m_totalTime = 0.0;
+	Second m_minTime = MAX_SECOND;
+};
+
 } // end namespace anki
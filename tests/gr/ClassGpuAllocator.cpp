@@ -202,4 +202,58 @@ ANKI_TEST(Gr, ClassGpuAllocator)
 	}
 }
 
+ANKI_TEST(Gr, ClassGpuAllocatorStats)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	Interface iface;
+
+	ClassGpuAllocator calloc;
+	calloc.init(alloc, &iface);
+
+	// Fill one chunk of the first class and spill to a second one
+	const U32 slotsPerChunk = 16 * 1024 / 256;
+	std::vector<ClassGpuAllocatorHandle> handles;
+	for(U32 i = 0; i < slotsPerChunk + 1; ++i)
+	{
+		ClassGpuAllocatorHandle handle;
+		ANKI_TEST_EXPECT_NO_ERR(calloc.allocate(200, 1, handle));
+		handles.push_back(handle);
+	}
+
+	ClassGpuAllocatorClassStats stats;
+	calloc.getClassStats(0, stats);
+	ANKI_TEST_EXPECT_EQ(stats.m_slotSize, 256);
+	ANKI_TEST_EXPECT_EQ(stats.m_chunkCount, 2);
+	ANKI_TEST_EXPECT_EQ(stats.m_allocatedMemory, 2 * 16 * 1024);
+	ANKI_TEST_EXPECT_EQ(stats.m_usedMemory, (slotsPerChunk + 1) * 256);
+	ANKI_TEST_EXPECT_EQ(stats.m_requestedMemory, (slotsPerChunk + 1) * 200);
+
+	// Free two slots of the first chunk. The next allocation should go to the fullest chunk
+	calloc.free(handles[0]);
+	calloc.free(handles[1]);
+
+	ClassGpuAllocatorHandle handle;
+	ANKI_TEST_EXPECT_NO_ERR(calloc.allocate(100, 1, handle));
+	ANKI_TEST_EXPECT_EQ(handle.m_memory, handles[2].m_memory);
+	handles[0] = handle;
+
+	calloc.getClassStats(0, stats);
+	ANKI_TEST_EXPECT_EQ(stats.m_chunkCount, 2);
+	ANKI_TEST_EXPECT_EQ(stats.m_usedMemory, slotsPerChunk * 256);
+	ANKI_TEST_EXPECT_EQ(stats.m_requestedMemory, (slotsPerChunk - 2) * 200 + 100);
+
+	// Cleanup
+	for(U32 i = 0; i < handles.size(); ++i)
+	{
+		if(i != 1)
+		{
+			calloc.free(handles[i]);
+		}
+	}
+
+	calloc.getClassStats(0, stats);
+	ANKI_TEST_EXPECT_EQ(stats.m_chunkCount, 0);
+	ANKI_TEST_EXPECT_EQ(stats.m_requestedMemory, 0);
+}
+
 } // end namespace anki
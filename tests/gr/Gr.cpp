@@ -297,7 +297,7 @@ static StagingGpuMemoryManager* stagingMem = nullptr;
 	gr = createGrManager(cfg, win); \
 	ANKI_TEST_EXPECT_NO_ERR(stagingMem->init(gr, cfg)); \
 	TransferGpuAllocator* transfAlloc = new TransferGpuAllocator(); \
-	ANKI_TEST_EXPECT_NO_ERR(transfAlloc->init(128_MB, gr, gr->getAllocator())); \
+	ANKI_TEST_EXPECT_NO_ERR(transfAlloc->init(128_MB, 0, gr, gr->getAllocator())); \
 	{
 
 #define COMMON_END() \
@@ -1614,22 +1614,11 @@ static RenderTargetDescription newRTDescr(CString name)
 	return texInf;
 }
 
-ANKI_TEST(Gr, RenderGraph)
+/// Populate a graph with the passes of the renderer. Their dependencies are close to the real ones.
+static void populateRendererGraph(RenderGraphDescription& descr, TexturePtr dummyTex, StackAllocator<U8>& alloc)
 {
-	COMMON_BEGIN()
-
-	StackAllocator<U8> alloc(allocAligned, nullptr, 2_MB);
-	RenderGraphDescription descr(alloc);
-	RenderGraphPtr rgraph = gr->newRenderGraph();
-
 	const U GI_MIP_COUNT = 4;
 
-	TextureInitInfo texI("dummy");
-	texI.m_width = texI.m_height = 16;
-	texI.m_usage = TextureUsageBit::FRAMEBUFFER_ATTACHMENT_WRITE | TextureUsageBit::SAMPLED_FRAGMENT;
-	texI.m_format = Format::R8G8B8A8_UNORM;
-	TexturePtr dummyTex = gr->newTexture(texI);
-
 	// SM
 	RenderTargetHandle smScratchRt = descr.newRenderTarget(newRTDescr("SM scratch"));
 	{
@@ -1785,6 +1774,23 @@ ANKI_TEST(Gr, RenderGraph)
 		pass.newDependency({taaRt, TextureUsageBit::FRAMEBUFFER_ATTACHMENT_WRITE});
 		pass.newDependency({taaHistoryRt, TextureUsageBit::SAMPLED_FRAGMENT});
 	}
+}
+
+ANKI_TEST(Gr, RenderGraph)
+{
+	COMMON_BEGIN()
+
+	StackAllocator<U8> alloc(allocAligned, nullptr, 2_MB);
+	RenderGraphDescription descr(alloc);
+	RenderGraphPtr rgraph = gr->newRenderGraph();
+
+	TextureInitInfo texI("dummy");
+	texI.m_width = texI.m_height = 16;
+	texI.m_usage = TextureUsageBit::FRAMEBUFFER_ATTACHMENT_WRITE | TextureUsageBit::SAMPLED_FRAGMENT;
+	texI.m_format = Format::R8G8B8A8_UNORM;
+	TexturePtr dummyTex = gr->newTexture(texI);
+
+	populateRendererGraph(descr, dummyTex, alloc);
 
 	rgraph->compileNewGraph(descr, alloc);
 	COMMON_END()
@@ -2380,4 +2386,291 @@ void main()
 	COMMON_END()
 }
 
+const U32 BENCH_WARMUP_ITERATION_COUNT = 5;
+const U32 BENCH_ITERATION_COUNT = 30;
+const U32 BENCH_DRAW_COUNT = 10000;
+const U32 BENCH_RT_SIZE = 256;
+
+/// The state that changes between the drawcalls of the drawcall benchmark.
+enum class BenchDrawChurn : U8
+{
+	NONE, ///< Same state for all drawcalls.
+	UNIFORM_UPLOAD, ///< New uniforms from the staging memory every drawcall.
+	DESCRIPTOR_SET, ///< Alternate between 2 uniform buffers. It makes the descriptor sets dirty every drawcall.
+	PROGRAM, ///< Alternate between 2 programs.
+	PIPELINE_STATE, ///< Alternate some state that is part of the pipelines.
+	COUNT
+};
+
+static TexturePtr createBenchRenderTarget(GrManager& gr)
+{
+	TextureInitInfo init("BenchRt");
+	init.m_width = init.m_height = BENCH_RT_SIZE;
+	init.m_format = Format::R8G8B8A8_UNORM;
+	init.m_usage = TextureUsageBit::FRAMEBUFFER_ATTACHMENT_WRITE;
+	init.m_initialUsage = TextureUsageBit::FRAMEBUFFER_ATTACHMENT_WRITE;
+	return gr.newTexture(init);
+}
+
+/// The CPU cost of recording and submitting drawElements with different amounts of state churn.
+ANKI_TEST(Gr, DrawcallBench)
+{
+	COMMON_BEGIN()
+
+	ShaderProgramPtr progA = createProgram(VERT_MRT_SRC, FRAG_SRC, *gr);
+	ShaderProgramPtr progB = createProgram(VERT_MRT_SRC, FRAG_SRC, *gr);
+
+	BufferPtr verts, indices;
+	createCube(*gr, verts, indices);
+
+	Array<BufferPtr, 2> ubos;
+	for(BufferPtr& ubo : ubos)
+	{
+		ubo = gr->newBuffer(BufferInitInfo(sizeof(Mat4), BufferUsageBit::UNIFORM_ALL, BufferMapAccessBit::WRITE));
+		*static_cast<Mat4*>(ubo->map(0, sizeof(Mat4), BufferMapAccessBit::WRITE)) = Mat4::getIdentity();
+		ubo->unmap();
+	}
+
+	TexturePtr rt = createBenchRenderTarget(*gr);
+	FramebufferPtr fb = createColorFb(*gr, rt);
+
+	static const Array<const char*, U32(BenchDrawChurn::COUNT)> names = {
+		{"Gr_draw_noChurn", "Gr_draw_uniformUpload", "Gr_draw_descriptorSet", "Gr_draw_program", "Gr_draw_state"}};
+
+	ANKI_TEST_LOGI("Every iteration records and submits %u drawcalls", BENCH_DRAW_COUNT);
+	for(U32 c = 0; c < U32(BenchDrawChurn::COUNT); ++c)
+	{
+		const BenchDrawChurn churn = BenchDrawChurn(c);
+		BenchTimer timer(names[c], 1);
+
+		for(U32 it = 0; it < BENCH_WARMUP_ITERATION_COUNT + BENCH_ITERATION_COUNT; ++it)
+		{
+			const Bool measure = it >= BENCH_WARMUP_ITERATION_COUNT;
+			if(measure)
+			{
+				timer.begin();
+			}
+
+			CommandBufferInitInfo cinit;
+			cinit.m_flags = CommandBufferFlag::GRAPHICS_WORK;
+			CommandBufferPtr cmdb = gr->newCommandBuffer(cinit);
+
+			cmdb->setViewport(0, 0, BENCH_RT_SIZE, BENCH_RT_SIZE);
+			cmdb->bindShaderProgram(progA);
+			cmdb->bindVertexBuffer(0, verts, 0, sizeof(Vec3));
+			cmdb->setVertexAttribute(0, 0, Format::R32G32B32_SFLOAT, 0);
+			cmdb->bindIndexBuffer(indices, 0, IndexType::U16);
+			cmdb->bindUniformBuffer(0, 0, ubos[0], 0, MAX_PTR_SIZE);
+			cmdb->beginRenderPass(fb, {TextureUsageBit::FRAMEBUFFER_ATTACHMENT_WRITE}, {});
+
+			for(U32 i = 0; i < BENCH_DRAW_COUNT; ++i)
+			{
+				switch(churn)
+				{
+				case BenchDrawChurn::UNIFORM_UPLOAD:
+					*SET_UNIFORMS(Mat4*, sizeof(Mat4), cmdb, 0, 0) = Mat4::getIdentity();
+					break;
+				case BenchDrawChurn::DESCRIPTOR_SET:
+					cmdb->bindUniformBuffer(0, 0, ubos[i & 1], 0, MAX_PTR_SIZE);
+					break;
+				case BenchDrawChurn::PROGRAM:
+					cmdb->bindShaderProgram((i & 1) ? progB : progA);
+					break;
+				case BenchDrawChurn::PIPELINE_STATE:
+					cmdb->setCullMode((i & 1) ? FaceSelectionBit::FRONT : FaceSelectionBit::BACK);
+					cmdb->setDepthCompareOperation((i & 2) ? CompareOperation::LESS : CompareOperation::ALWAYS);
+					break;
+				default:
+					break;
+				}
+
+				cmdb->drawElements(PrimitiveTopology::TRIANGLES, 36);
+			}
+
+			cmdb->endRenderPass();
+			cmdb->flush();
+
+			if(measure)
+			{
+				timer.end();
+			}
+
+			gr->finish();
+			stagingMem->endFrame();
+		}
+	}
+
+	COMMON_END()
+}
+
+/// The time to create the graphics pipelines of new state combinations and the time to find them again.
+ANKI_TEST(Gr, PipelineBench)
+{
+	COMMON_BEGIN()
+
+	BufferPtr verts, indices;
+	createCube(*gr, verts, indices);
+
+	BufferPtr ubo = gr->newBuffer(BufferInitInfo(sizeof(Mat4), BufferUsageBit::UNIFORM_ALL, BufferMapAccessBit::WRITE));
+	*static_cast<Mat4*>(ubo->map(0, sizeof(Mat4), BufferMapAccessBit::WRITE)) = Mat4::getIdentity();
+	ubo->unmap();
+
+	TexturePtr rt = createBenchRenderTarget(*gr);
+	FramebufferPtr fb = createColorFb(*gr, rt);
+
+	// The combinations of the state. Every one is a different pipeline
+	static const Array<FaceSelectionBit, 2> cullModes = {{FaceSelectionBit::FRONT, FaceSelectionBit::BACK}};
+	static const Array<BlendFactor, 2> blendFactors = {{BlendFactor::ONE, BlendFactor::SRC_ALPHA}};
+	const U32 pipelineCount = U32(CompareOperation::COUNT) * cullModes.getSize() * blendFactors.getSize();
+	ANKI_TEST_LOGI("Every iteration creates and then looks up %u pipelines", pipelineCount);
+
+	BenchTimer creationTimer("Gr_pipeline_create", 1);
+	BenchTimer lookupTimer("Gr_pipeline_lookup", 1);
+
+	for(U32 it = 0; it < BENCH_WARMUP_ITERATION_COUNT + BENCH_ITERATION_COUNT; ++it)
+	{
+		const Bool measure = it >= BENCH_WARMUP_ITERATION_COUNT;
+
+		// A new program has no pipelines
+		ShaderProgramPtr prog = createProgram(VERT_MRT_SRC, FRAG_SRC, *gr);
+
+		CommandBufferInitInfo cinit;
+		cinit.m_flags = CommandBufferFlag::GRAPHICS_WORK;
+		CommandBufferPtr cmdb = gr->newCommandBuffer(cinit);
+
+		cmdb->setViewport(0, 0, BENCH_RT_SIZE, BENCH_RT_SIZE);
+		cmdb->bindShaderProgram(prog);
+		cmdb->bindVertexBuffer(0, verts, 0, sizeof(Vec3));
+		cmdb->setVertexAttribute(0, 0, Format::R32G32B32_SFLOAT, 0);
+		cmdb->bindIndexBuffer(indices, 0, IndexType::U16);
+		cmdb->bindUniformBuffer(0, 0, ubo, 0, MAX_PTR_SIZE);
+		cmdb->beginRenderPass(fb, {TextureUsageBit::FRAMEBUFFER_ATTACHMENT_WRITE}, {});
+
+		for(U32 pass = 0; pass < 2; ++pass)
+		{
+			BenchTimer& timer = (pass == 0) ? creationTimer : lookupTimer;
+			if(measure)
+			{
+				timer.begin();
+			}
+
+			for(U32 op = 0; op < U32(CompareOperation::COUNT); ++op)
+			{
+				for(FaceSelectionBit cullMode : cullModes)
+				{
+					for(BlendFactor blendFactor : blendFactors)
+					{
+						cmdb->setDepthCompareOperation(CompareOperation(op));
+						cmdb->setCullMode(cullMode);
+						cmdb->setBlendFactors(0, blendFactor, BlendFactor::ZERO);
+						cmdb->drawElements(PrimitiveTopology::TRIANGLES, 36);
+					}
+				}
+			}
+
+			if(measure)
+			{
+				timer.end();
+			}
+		}
+
+		cmdb->endRenderPass();
+		cmdb->flush();
+		gr->finish();
+	}
+
+	COMMON_END()
+}
+
+/// The bandwidth of copyBufferToTextureView. It includes the time to wait for the GPU.
+ANKI_TEST(Gr, TextureUploadBench)
+{
+	COMMON_BEGIN()
+
+	const U32 size = 2048;
+	const PtrSize byteCount = size * size * 4;
+
+	TextureInitInfo init("BenchUpload");
+	init.m_width = init.m_height = size;
+	init.m_format = Format::R8G8B8A8_UNORM;
+	init.m_usage = TextureUsageBit::TRANSFER_DESTINATION;
+	init.m_initialUsage = TextureUsageBit::TRANSFER_DESTINATION;
+	TexturePtr tex = gr->newTexture(init);
+	TextureViewPtr view = gr->newTextureView(TextureViewInitInfo(tex, TextureSurfaceInfo(0, 0, 0, 0)));
+
+	BufferPtr staging =
+		gr->newBuffer(BufferInitInfo(byteCount, BufferUsageBit::TEXTURE_UPLOAD_SOURCE, BufferMapAccessBit::WRITE));
+	memset(staging->map(0, byteCount, BufferMapAccessBit::WRITE), 0x7F, byteCount);
+	staging->unmap();
+
+	BenchTimer timer("Gr_upload_16MB", 1);
+	Second totalTime = 0.0;
+	for(U32 it = 0; it < BENCH_WARMUP_ITERATION_COUNT + BENCH_ITERATION_COUNT; ++it)
+	{
+		const Bool measure = it >= BENCH_WARMUP_ITERATION_COUNT;
+		const Second begin = HighRezTimer::getCurrentTime();
+		if(measure)
+		{
+			timer.begin();
+		}
+
+		CommandBufferInitInfo cinit;
+		cinit.m_flags = CommandBufferFlag::TRANSFER_WORK;
+		CommandBufferPtr cmdb = gr->newCommandBuffer(cinit);
+		cmdb->copyBufferToTextureView(staging, 0, byteCount, view);
+		cmdb->flush();
+		gr->finish();
+
+		if(measure)
+		{
+			timer.end();
+			totalTime += HighRezTimer::getCurrentTime() - begin;
+		}
+	}
+
+	ANKI_TEST_LOGI("Upload bandwidth %fMB/s", F64(byteCount * BENCH_ITERATION_COUNT) / F64(1_MB) / totalTime);
+
+	COMMON_END()
+}
+
+/// The time of RenderGraph::compileNewGraph for a graph like the one of the renderer.
+ANKI_TEST(Gr, RenderGraphBench)
+{
+	COMMON_BEGIN()
+
+	RenderGraphPtr rgraph = gr->newRenderGraph();
+
+	TextureInitInfo texI("dummy");
+	texI.m_width = texI.m_height = 16;
+	texI.m_usage = TextureUsageBit::FRAMEBUFFER_ATTACHMENT_WRITE | TextureUsageBit::SAMPLED_FRAGMENT;
+	texI.m_format = Format::R8G8B8A8_UNORM;
+	TexturePtr dummyTex = gr->newTexture(texI);
+
+	BenchTimer timer("Gr_renderGraph_compile", 1);
+	for(U32 it = 0; it < BENCH_WARMUP_ITERATION_COUNT + BENCH_ITERATION_COUNT; ++it)
+	{
+		const Bool measure = it >= BENCH_WARMUP_ITERATION_COUNT;
+
+		StackAllocator<U8> alloc(allocAligned, nullptr, 2_MB);
+		RenderGraphDescription descr(alloc);
+		populateRendererGraph(descr, dummyTex, alloc);
+
+		if(measure)
+		{
+			timer.begin();
+		}
+
+		rgraph->compileNewGraph(descr, alloc);
+
+		if(measure)
+		{
+			timer.end();
+		}
+
+		rgraph->reset();
+	}
+
+	COMMON_END()
+}
+
 } // end namespace anki
@@ -0,0 +1,82 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/Math.h>
+
+using namespace anki;
+
+template<MathPrecision PRECISION>
+static void testFastFunctions(F64 rsqrtMaxError, F64 sinCosMaxError, F64 expMaxError)
+{
+	F64 rsqrtError = 0.0;
+	F64 sinCosError = 0.0;
+	F64 expError = 0.0;
+
+	constexpr U32 SAMPLE_COUNT = 100000;
+	for(U32 i = 0; i < SAMPLE_COUNT; ++i)
+	{
+		const F32 u = F32(i) / F32(SAMPLE_COUNT - 1);
+
+		// Relative error of rsqrt over many orders of magnitude
+		const F32 x = std::pow(10.0f, mix(-10.0f, 10.0f, u));
+		const F64 rsqrtExpected = 1.0 / std::sqrt(F64(x));
+		rsqrtError = max(rsqrtError, absolute(F64(fastRsqrt<PRECISION>(x)) - rsqrtExpected) / rsqrtExpected);
+
+		// Absolute error of sin and cos
+		const F32 rad = mix(-100.0f, 100.0f, u);
+		F32 s, c;
+		fastSinCos<PRECISION>(rad, s, c);
+		sinCosError = max(sinCosError, absolute(F64(s) - std::sin(F64(rad))));
+		sinCosError = max(sinCosError, absolute(F64(c) - std::cos(F64(rad))));
+		ANKI_TEST_EXPECT_EQ(fastSin<PRECISION>(rad), s);
+		ANKI_TEST_EXPECT_EQ(fastCos<PRECISION>(rad), c);
+
+		// Relative error of exp
+		const F32 e = mix(-87.0f, 88.0f, u);
+		const F64 expExpected = std::exp(F64(e));
+		expError = max(expError, absolute(F64(fastExp<PRECISION>(e)) - expExpected) / expExpected);
+	}
+
+	ANKI_TEST_EXPECT_LEQ(rsqrtError, rsqrtMaxError);
+	ANKI_TEST_EXPECT_LEQ(sinCosError, sinCosMaxError);
+	ANKI_TEST_EXPECT_LEQ(expError, expMaxError);
+}
+
+ANKI_TEST(Math, FastFunctions)
+{
+	testFastFunctions<MathPrecision::FAST>(2.0e-3, 4.0e-4, 1.0e-4);
+	testFastFunctions<MathPrecision::MEDIUM>(5.0e-6, 2.0e-6, 1.0e-6);
+	testFastFunctions<MathPrecision::EXACT>(1.0e-6, 1.0e-6, 1.0e-6);
+
+	// The special values
+	ANKI_TEST_EXPECT_EQ(fastSin(0.0f), 0.0f);
+	ANKI_TEST_EXPECT_EQ(fastCos(0.0f), 1.0f);
+	ANKI_TEST_EXPECT_EQ(fastExp(0.0f), 1.0f);
+	ANKI_TEST_EXPECT_GT(fastExp(-1000.0f), 0.0f);
+	ANKI_TEST_EXPECT_LEQ(fastExp(1000.0f), MAX_F32);
+}
+
+ANKI_TEST(Math, QuatNlerp)
+{
+	for(U32 i = 0; i < 1000; ++i)
+	{
+		const Quat q0(Euler(getRandomRange(-PI, PI), getRandomRange(-PI, PI), getRandomRange(-PI, PI)));
+		const Quat q1(Euler(getRandomRange(-PI, PI), getRandomRange(-PI, PI), getRandomRange(-PI, PI)));
+		const F32 t = getRandomRange(0.0f, 1.0f);
+
+		const Quat n = q0.nlerp(q1, t);
+		ANKI_TEST_EXPECT_NEAR(n.getLength(), 1.0f, 1.0e-3f);
+
+		// Same as slerp at the edges. The sign doesn't matter. The tolerance is big because Quat::normalize() is
+		// approximate
+		ANKI_TEST_EXPECT_NEAR(absolute(q0.nlerp(q1, 0.0f).dot(q0)), 1.0f, 1.0e-3f);
+		ANKI_TEST_EXPECT_NEAR(absolute(q0.nlerp(q1, 1.0f).dot(q1)), 1.0f, 1.0e-3f);
+
+		// Close to slerp when the quaternions are close
+		const Quat q2 = q0.slerp(q1, 0.05f);
+		ANKI_TEST_EXPECT_NEAR(absolute(q0.nlerp(q2, t).dot(q0.slerp(q2, t))), 1.0f, 1.0e-3f);
+	}
+}
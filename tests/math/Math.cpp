@@ -366,6 +366,23 @@ ANKI_TEST(Math, Mat4)
 
 		ANKI_TEST_EXPECT_EQ(m * v, Vec4(20, 44, 68, 92));
 	}
+
+	// inverse
+	{
+		const Mat4 m(Vec4(1.0, -2.0, 3.0, 1.0), Mat3(Euler(0.3, 1.1, -0.7)), 2.0);
+		Mat4 m2 = m;
+		m2(3, 0) = 0.5;
+		m2(3, 2) = -0.25;
+
+		for(const Mat4& a : {m, m2})
+		{
+			const Mat4 i = a * a.getInverse();
+			for(U j = 0; j < 16; j++)
+			{
+				ANKI_TEST_EXPECT_NEAR(i[j], Mat4::getIdentity()[j], 0.0001);
+			}
+		}
+	}
 }
 
 ANKI_TEST(Math, Mat3x4)
@@ -389,4 +406,55 @@ ANKI_TEST(Math, Mat3x4)
 
 		ANKI_TEST_EXPECT_EQ(m * v, Vec3(20, 44, 68));
 	}
+
+	// batched combine transforms
+	{
+		Array<Mat3x4, 5> a, b, c;
+		for(U i = 0; i < a.getSize(); ++i)
+		{
+			a[i] = getNonEmptyMat<Mat3x4>(F32(i));
+			b[i] = getNonEmptyMat<Mat3x4>(F32(i) * 0.5f);
+		}
+
+		Mat3x4::combineTransformations(&a[0], &b[0], &c[0], a.getSize());
+		for(U i = 0; i < a.getSize(); ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(c[i], a[i].combineTransformations(b[i]));
+		}
+
+		Mat3x4::combineTransformations(a[1], &b[0], &c[0], b.getSize());
+		for(U i = 0; i < b.getSize(); ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(c[i], a[1].combineTransformations(b[i]));
+		}
+	}
+}
+
+ANKI_TEST(Math, F16)
+{
+	// Round to nearest even. 2049 and 2051 are exactly between 2 halfs
+	ANKI_TEST_EXPECT_EQ(F16(2049.0f).toF32(), 2048.0f);
+	ANKI_TEST_EXPECT_EQ(F16(2051.0f).toF32(), 2052.0f);
+	ANKI_TEST_EXPECT_EQ(F16(-0.0f).toU16(), 0x8000);
+	ANKI_TEST_EXPECT_EQ(F16(1.0e-10f).toU16(), 0);
+	ANKI_TEST_EXPECT_EQ(F16(1.0e10f).toU16(), 0x7c00);
+	ANKI_TEST_EXPECT_EQ(F16(5.9604645e-8f).toU16(), 1); // Smallest denormal
+
+	// Arrays with lengths that are not multiples of the SIMD width
+	Array<F32, 21> in;
+	for(U32 i = 0; i < in.getSize(); ++i)
+	{
+		in[i] = F32(i) * 0.37f - 3.0f;
+	}
+
+	Array<F16, 21> h;
+	F16::convertArray(&in[0], &h[0], in.getSize());
+	Array<F32, 21> out;
+	F16::convertArray(&h[0], &out[0], h.getSize());
+
+	for(U32 i = 0; i < in.getSize(); ++i)
+	{
+		ANKI_TEST_EXPECT_EQ(h[i], F16(in[i]));
+		ANKI_TEST_EXPECT_EQ(out[i], h[i].toF32());
+	}
 }
@@ -0,0 +1,182 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/Math.h>
+#include <anki/util/HighRezTimer.h>
+#include <vector>
+
+using namespace anki;
+
+static F32 distance(const Vec3& a, const Vec3& b)
+{
+	return (a - b).getLength();
+}
+
+static F32 distance(const Quat& a, const Quat& b)
+{
+	return (Vec4(a.x(), a.y(), a.z(), a.w()) - Vec4(b.x(), b.y(), b.z(), b.w())).getLength();
+}
+
+template<typename TLane>
+static void testLanes()
+{
+	constexpr U32 N = TLane::LANE_COUNT;
+	Array<F32, N> a, b;
+	for(U32 i = 0; i < N; ++i)
+	{
+		a[i] = F32(i) * 1.5f - 3.0f;
+		b[i] = F32(N - i) * 0.5f;
+	}
+
+	const TLane la = TLane::load(&a[0]);
+	const TLane lb = TLane::load(&b[0]);
+
+	const TLane add = la + lb;
+	const TLane sub = la - lb;
+	const TLane mul = la * lb;
+	const TLane div = la / lb;
+	const TLane mad = TLane::mulAdd(la, lb, la);
+	const TLane mn = TLane::min(la, lb);
+	const TLane mx = TLane::max(la, lb);
+	const TLane abs = la.getAbs();
+	const TLane sqrt = lb.getSqrt();
+	const TLane less = la < lb;
+	const TLane sel = TLane::select(less, la, lb);
+
+	U32 expectedMask = 0;
+	for(U32 i = 0; i < N; ++i)
+	{
+		ANKI_TEST_EXPECT_EQ(add.getLane(i), a[i] + b[i]);
+		ANKI_TEST_EXPECT_EQ(sub.getLane(i), a[i] - b[i]);
+		ANKI_TEST_EXPECT_EQ(mul.getLane(i), a[i] * b[i]);
+		ANKI_TEST_EXPECT_NEAR(div.getLane(i), a[i] / b[i], EPSILON);
+		ANKI_TEST_EXPECT_NEAR(mad.getLane(i), a[i] * b[i] + a[i], EPSILON);
+		ANKI_TEST_EXPECT_EQ(mn.getLane(i), min(a[i], b[i]));
+		ANKI_TEST_EXPECT_EQ(mx.getLane(i), max(a[i], b[i]));
+		ANKI_TEST_EXPECT_EQ(abs.getLane(i), absolute(a[i]));
+		ANKI_TEST_EXPECT_NEAR(sqrt.getLane(i), std::sqrt(b[i]), EPSILON);
+		ANKI_TEST_EXPECT_EQ(sel.getLane(i), min(a[i], b[i]));
+
+		if(a[i] < b[i])
+		{
+			expectedMask |= 1u << i;
+		}
+	}
+
+	ANKI_TEST_EXPECT_EQ(less.getMask(), expectedMask);
+	ANKI_TEST_EXPECT_EQ((la == la).getMask(), TLane::ALL_LANES_MASK);
+	ANKI_TEST_EXPECT_EQ((la < la).getMask(), 0);
+	ANKI_TEST_EXPECT_EQ(((la < lb) | (la >= lb)).getMask(), TLane::ALL_LANES_MASK);
+	ANKI_TEST_EXPECT_EQ(((la < lb) & (la >= lb)).getMask(), 0);
+
+	TLane c(1.0f);
+	c.setLane(N - 1, 2.0f);
+	ANKI_TEST_EXPECT_EQ(c.getLane(0), 1.0f);
+	ANKI_TEST_EXPECT_EQ(c.getLane(N - 1), 2.0f);
+}
+
+template<typename TLane>
+static void testVectors()
+{
+	constexpr U32 N = TLane::LANE_COUNT;
+	Array<Vec3, N> a, b, out;
+	Array<Quat, N> quats;
+	for(U32 i = 0; i < N; ++i)
+	{
+		a[i] = Vec3(F32(i), 1.0f - F32(i) * 0.5f, 2.0f);
+		b[i] = Vec3(0.5f, F32(i) * 2.0f, -1.0f);
+		quats[i] = Quat(Axisang(F32(i) * 0.3f + 0.1f, b[i].getNormalized()));
+	}
+
+	using Vec3W = TVec3Wide<TLane>;
+	const Vec3W wa = Vec3W::loadAos(&a[0]);
+	const Vec3W wb = Vec3W::loadAos(&b[0]);
+
+	TQuatWide<TLane> wq;
+	for(U32 i = 0; i < N; ++i)
+	{
+		wq.setLane(i, quats[i]);
+	}
+
+	const TLane dot = wa.dot(wb);
+	const Vec3W cross = wa.cross(wb);
+	const Vec3W rotated = wq.rotate(wa);
+	const TQuatWide<TLane> combined = wq.combineRotations(wq);
+	(wa + wb).getNormalized().storeAos(&out[0]);
+
+	for(U32 i = 0; i < N; ++i)
+	{
+		ANKI_TEST_EXPECT_NEAR(dot.getLane(i), a[i].dot(b[i]), EPSILON);
+		ANKI_TEST_EXPECT_LT(distance(cross.getLane(i), a[i].cross(b[i])), EPSILON);
+		ANKI_TEST_EXPECT_LT(distance(rotated.getLane(i), quats[i].rotate(a[i])), EPSILON * 10.0f);
+		ANKI_TEST_EXPECT_LT(distance(combined.getLane(i), quats[i].combineRotations(quats[i])), EPSILON);
+		ANKI_TEST_EXPECT_LT(distance(out[i], (a[i] + b[i]).getNormalized()), EPSILON);
+	}
+
+	// Partial loads zero the rest
+	const Vec3W partial = Vec3W::loadAos(&a[1], N / 2);
+	ANKI_TEST_EXPECT_EQ(partial.getLane(0), a[1]);
+	ANKI_TEST_EXPECT_EQ(partial.getLane(N - 1), Vec3(0.0f));
+
+	using Vec4W = TVec4Wide<TLane>;
+	const Vec4W w4(wa, TLane(1.0f));
+	ANKI_TEST_EXPECT_NEAR(w4.dot(w4).getLane(1), a[1].dot(a[1]) + 1.0f, EPSILON);
+	ANKI_TEST_EXPECT_EQ(w4.getLane(2), Vec4(a[2], 1.0f));
+}
+
+ANKI_TEST(Math, SimdWide)
+{
+	testLanes<F32x4>();
+	testLanes<F32x8>();
+	testVectors<F32x4>();
+	testVectors<F32x8>();
+}
+
+ANKI_TEST(Math, SimdWideBench)
+{
+	// Integrate particles like the simple particle emitter: AoS one by one vs SoA 8 at a time
+	const U32 count = 1024 * 16;
+	const U32 iterationCount = 100;
+	const F32 dt = 1.0f / 60.0f;
+
+	std::vector<Vec4> posAos(count, Vec4(0.0f)), velAos(count, Vec4(0.0f)), accAos(count, Vec4(0.0f, -9.8f, 0.0f, 0.0f));
+	std::vector<F32> px(count, 0.0f), py(count, 0.0f), pz(count, 0.0f);
+	std::vector<F32> vx(count, 0.0f), vy(count, 0.0f), vz(count, 0.0f);
+
+	HighRezTimer timer;
+
+	timer.start();
+	for(U32 it = 0; it < iterationCount; ++it)
+	{
+		for(U32 i = 0; i < count; ++i)
+		{
+			posAos[i] = accAos[i] * (dt * dt) + velAos[i] * dt + posAos[i];
+			velAos[i] += accAos[i] * dt;
+		}
+	}
+	timer.stop();
+	const Second aosTime = timer.getElapsedTime();
+
+	const F32x8 dtw(dt);
+	const F32x8 dt2w(dt * dt);
+	const Vec3x8 acc(Vec3(0.0f, -9.8f, 0.0f));
+	timer.start();
+	for(U32 it = 0; it < iterationCount; ++it)
+	{
+		for(U32 i = 0; i < count; i += F32x8::LANE_COUNT)
+		{
+			const Vec3x8 x = Vec3x8::load(&px[i], &py[i], &pz[i]);
+			const Vec3x8 v = Vec3x8::load(&vx[i], &vy[i], &vz[i]);
+			Vec3x8::mulAdd(acc, dt2w, Vec3x8::mulAdd(v, dtw, x)).store(&px[i], &py[i], &pz[i]);
+			Vec3x8::mulAdd(acc, dtw, v).store(&vx[i], &vy[i], &vz[i]);
+		}
+	}
+	timer.stop();
+	const Second soaTime = timer.getElapsedTime();
+
+	ANKI_TEST_EXPECT_NEAR(posAos[count - 1].y(), py[count - 1], 0.01f);
+	ANKI_TEST_LOGI("SimdWide bench: AoS %f, SoA x8 %f (AVX2 %u)", aosTime, soaTime, ANKI_SIMD_AVX2);
+}
@@ -0,0 +1,159 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/Physics.h>
+#include <anki/util/ThreadHive.h>
+
+using namespace anki;
+
+namespace
+{
+
+class QueryTestContext
+{
+public:
+	PhysicsWorld* m_world = nullptr;
+	ThreadHive* m_hive = nullptr;
+	ConstWeakArray<PhysicsWorldQuery> m_queries;
+	WeakArray<PhysicsWorldQueryResult> m_results;
+};
+
+} // namespace
+
+/// 5 kinds of queries. The floor is a box under y=0 and the sphere has radius 1 and center (0, 5, 0).
+static void initQuery(U32 i, PhysicsWorldQuery& q)
+{
+	const F32 offset = F32(i % 7) * 0.1f;
+
+	switch(i % 5)
+	{
+	case 0:
+		// Ray to the floor next to the sphere
+		q.m_type = PhysicsWorldQueryType::RAY_CAST;
+		q.m_from = Vec3(3.0f + offset, 10.0f, 0.0f);
+		q.m_to = Vec3(3.0f + offset, -10.0f, 0.0f);
+		break;
+	case 1:
+		// Ray to the top of the sphere
+		q.m_type = PhysicsWorldQueryType::RAY_CAST;
+		q.m_from = Vec3(0.0f, 10.0f, 0.0f);
+		q.m_to = Vec3(0.0f, -10.0f, 0.0f);
+		break;
+	case 2:
+		// Same ray but it ignores the dynamic objects so it goes through the sphere
+		q.m_type = PhysicsWorldQueryType::RAY_CAST;
+		q.m_from = Vec3(0.0f, 10.0f, 0.0f);
+		q.m_to = Vec3(0.0f, -10.0f, 0.0f);
+		q.m_materialMask = PhysicsMaterialBit::STATIC_GEOMETRY;
+		break;
+	case 3:
+		// Contact with the sphere
+		q.m_type = PhysicsWorldQueryType::SPHERE_OVERLAP;
+		q.m_from = Vec3(0.0f, 5.0f + offset, 0.0f);
+		q.m_radius = 0.5f;
+		break;
+	default:
+		// Ray that misses everything
+		q.m_type = PhysicsWorldQueryType::RAY_CAST;
+		q.m_from = Vec3(30.0f, 10.0f, offset);
+		q.m_to = Vec3(30.0f, -10.0f, offset);
+	}
+}
+
+static void checkResult(
+	U32 i, const PhysicsWorldQueryResult& r, const PhysicsBodyPtr& floor, const PhysicsBodyPtr& sphere)
+{
+	switch(i % 5)
+	{
+	case 0:
+	case 2:
+		ANKI_TEST_EXPECT_EQ(r.m_object == floor.get(), true);
+		ANKI_TEST_EXPECT_NEAR(r.m_worldPosition.y(), 0.0f, 0.05f);
+		ANKI_TEST_EXPECT_NEAR(r.m_worldNormal.y(), 1.0f, 0.01f);
+		ANKI_TEST_EXPECT_NEAR(r.m_hitFraction, 0.5f, 0.01f);
+		break;
+	case 1:
+		ANKI_TEST_EXPECT_EQ(r.m_object == sphere.get(), true);
+		ANKI_TEST_EXPECT_NEAR(r.m_worldPosition.y(), 6.0f, 0.05f);
+		ANKI_TEST_EXPECT_NEAR(r.m_worldNormal.y(), 1.0f, 0.01f);
+		ANKI_TEST_EXPECT_NEAR(r.m_hitFraction, 0.2f, 0.01f);
+		break;
+	case 3:
+		ANKI_TEST_EXPECT_EQ(r.m_object == sphere.get(), true);
+		break;
+	default:
+		ANKI_TEST_EXPECT_EQ(r.m_object == nullptr, true);
+		ANKI_TEST_EXPECT_EQ(r.m_hitFraction, 1.0f);
+	}
+}
+
+ANKI_TEST(Physics, PhysicsWorldQuery)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	ThreadHive hive(4, alloc);
+
+	PhysicsWorld* world = alloc.newInstance<PhysicsWorld>();
+	ANKI_TEST_EXPECT_NO_ERR(world->create(allocAligned, nullptr));
+
+	{
+		PhysicsBodyInitInfo init;
+		init.m_shape = world->newInstance<PhysicsBox>(Vec3(20.0f, 1.0f, 20.0f));
+		init.m_transform.setOrigin(Vec4(0.0f, -1.0f, 0.0f, 0.0f));
+		PhysicsBodyPtr floor = world->newInstance<PhysicsBody>(init);
+		floor->setMaterialGroup(PhysicsMaterialBit::STATIC_GEOMETRY);
+
+		init.m_shape = world->newInstance<PhysicsSphere>(1.0f);
+		init.m_transform.setOrigin(Vec4(0.0f, 5.0f, 0.0f, 0.0f));
+		PhysicsBodyPtr sphere = world->newInstance<PhysicsBody>(init);
+		sphere->setMaterialGroup(PhysicsMaterialBit::DYNAMIC_GEOMETRY);
+
+		// Enough queries to be spread to the hive
+		const U32 queryCount = 1000;
+		DynamicArrayAuto<PhysicsWorldQuery> queries(alloc);
+		queries.create(queryCount);
+		for(U32 i = 0; i < queryCount; ++i)
+		{
+			initQuery(i, queries[i]);
+		}
+
+		DynamicArrayAuto<PhysicsWorldQueryResult> results(alloc);
+		results.create(queryCount);
+		const WeakArray<PhysicsWorldQueryResult> resultsArr(results);
+
+		auto checkResults = [&]() {
+			for(U32 i = 0; i < queryCount; ++i)
+			{
+				checkResult(i, results[i], floor, sphere);
+				results[i] = PhysicsWorldQueryResult();
+			}
+		};
+
+		// Serial
+		world->query(queries, resultsArr);
+		checkResults();
+
+		// In the hive
+		world->query(queries, resultsArr, &hive);
+		checkResults();
+
+		// From a task of the hive. It can't wait on the hive so it runs serially
+		QueryTestContext ctx;
+		ctx.m_world = world;
+		ctx.m_hive = &hive;
+		ctx.m_queries = queries;
+		ctx.m_results = resultsArr;
+		hive.submitTask(
+			[](void* arg, U32, ThreadHive& hive, ThreadHiveSemaphore* sem) {
+				QueryTestContext& ctx = *static_cast<QueryTestContext*>(arg);
+				ctx.m_world->query(ctx.m_queries, ctx.m_results, ctx.m_hive);
+			},
+			&ctx);
+		hive.waitAllTasks();
+		checkResults();
+	}
+
+	alloc.deleteInstance(world);
+}
@@ -5,6 +5,7 @@
 
 #include <tests/framework/Framework.h>
 #include <anki/renderer/TileAllocator.h>
+#include <anki/util/HighRezTimer.h>
 
 namespace anki
 {
@@ -69,6 +70,54 @@ ANKI_TEST(Renderer, TileAllocator)
 		res = talloc.allocate(crntTimestamp, lightTimestamp, lightUuid + 6 + i, 0, dcCount, 0, viewport);
 		ANKI_TEST_EXPECT_EQ(res, TileAllocatorResult::ALLOCATION_SUCCEEDED);
 	}
+
+	// New frame. Only the big tile with the small ones of the last frame can be evicted
+	++crntTimestamp;
+	res = talloc.allocate(crntTimestamp, lightTimestamp, lightUuid + 2, 0, dcCount + 1, 2, viewport);
+	ANKI_TEST_EXPECT_EQ(res, TileAllocatorResult::CACHED);
+	res = talloc.allocate(crntTimestamp, lightTimestamp, lightUuid + 4, 0, dcCount + 1, 2, viewport);
+	ANKI_TEST_EXPECT_EQ(res, TileAllocatorResult::CACHED);
+	res = talloc.allocate(crntTimestamp, lightTimestamp, lightUuid + 3, 0, dcCount, 2, viewport);
+	ANKI_TEST_EXPECT_EQ(res, TileAllocatorResult::CACHED);
+
+	res = talloc.allocate(crntTimestamp, lightTimestamp, lightUuid + 100, 0, dcCount, 2, viewport);
+	ANKI_TEST_EXPECT_EQ(res, TileAllocatorResult::ALLOCATION_SUCCEEDED);
+	ANKI_TEST_EXPECT_EQ(viewport[0], 0);
+	ANKI_TEST_EXPECT_EQ(viewport[1], 0);
+	res = talloc.allocate(crntTimestamp, lightTimestamp, lightUuid + 101, 0, dcCount, 2, viewport);
+	ANKI_TEST_EXPECT_EQ(res, TileAllocatorResult::ALLOCATION_FAILED);
+}
+
+ANKI_TEST(Renderer, TileAllocatorBench)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	// A dense atlas. Allocate more tiles than the atlas can hold every frame so the eviction runs all the time
+	TileAllocator talloc;
+	talloc.init(alloc, 64, 64, 3, true);
+
+	constexpr U32 FRAME_COUNT = 100;
+	constexpr U32 LIGHT_COUNT = 2048;
+	HighRezTimer timer;
+	timer.start();
+	U32 failedCount = 0;
+	for(Timestamp crntTimestamp = 1; crntTimestamp <= FRAME_COUNT; ++crntTimestamp)
+	{
+		for(U32 i = 0; i < LIGHT_COUNT; ++i)
+		{
+			// Every frame a different set of lights is visible
+			const U64 lightUuid = (crntTimestamp * 7 + i * 13) % (LIGHT_COUNT * 2) + 1;
+			Array<U32, 4> viewport;
+			const TileAllocatorResult res =
+				talloc.allocate(crntTimestamp, 1, lightUuid, 0, 10, U32(lightUuid % 3), viewport);
+			failedCount += res == TileAllocatorResult::ALLOCATION_FAILED;
+		}
+	}
+	timer.stop();
+
+	ANKI_TEST_LOGI("TileAllocator bench: %f ms per frame (%u failed allocations)",
+		timer.getElapsedTime() / F64(FRAME_COUNT) * 1000.0,
+		failedCount);
 }
 
 } // end namespace anki
\ No newline at end of file
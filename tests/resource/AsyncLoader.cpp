@@ -246,6 +246,84 @@ ANKI_TEST(Resource, AsyncLoader)
 		ANKI_TEST_EXPECT_EQ(counter.load(), 4);
 	}
 
+	// Batches and priorities
+	{
+		AsyncLoader a;
+		a.init(alloc);
+		Atomic<U32> counter(0);
+		Barrier barrier(2);
+
+		// Queue everything while paused. The batch runs first because of its priority
+		a.pause();
+		a.submitNewTask<Task>(0.0f, nullptr, &counter, 2);
+		a.beginBatch();
+		a.submitNewTask<Task>(0.0f, nullptr, &counter, 0);
+		a.submitNewTask<Task>(0.0f, nullptr, &counter, 1);
+		a.endBatch(AsyncLoaderTaskPriority::HIGH);
+		a.submitNewTask<Task>(0.0f, &barrier, &counter, 3);
+		a.resume();
+
+		barrier.wait();
+		ANKI_TEST_EXPECT_EQ(counter.load(), 4);
+	}
+
+	// Many threads
+	{
+		AsyncLoader a;
+		a.init(alloc, 4);
+		Atomic<U32> counter = {0};
+		const U32 COUNT = 100;
+
+		for(U32 i = 0; i < COUNT; i++)
+		{
+			a.submitNewTask<Task>(0.01f, nullptr, &counter);
+		}
+
+		// The tasks run in parallel so it shouldn't take long
+		HighRezTimer::sleep(0.6);
+		ANKI_TEST_EXPECT_EQ(counter.load(), COUNT);
+
+		// Pause waits for all the threads
+		a.submitNewTask<Task>(0.2f, nullptr, &counter);
+		a.submitNewTask<Task>(0.2f, nullptr, &counter);
+		HighRezTimer::sleep(0.1);
+		a.pause();
+		ANKI_TEST_EXPECT_EQ(counter.load(), COUNT + 2);
+		a.resume();
+	}
+
+	// Cancel
+	{
+		AsyncLoader a;
+		a.init(alloc);
+		Atomic<U32> counter = {0};
+		Barrier barrier(2);
+		const U32 owner = 0;
+
+		a.pause();
+		for(U32 i = 0; i < 10; ++i)
+		{
+			Task* task = a.newTask<Task>(0.0f, (i == 8) ? &barrier : nullptr, &counter);
+			task->setOwner((i & 1) ? &owner : nullptr);
+			a.submitTask(task);
+		}
+
+		a.cancelTasks(&owner);
+		a.resume();
+		barrier.wait();
+		ANKI_TEST_EXPECT_EQ(counter.load(), 5);
+
+		// Cancel a running task waits for it
+		Task* task = a.newTask<Task>(0.5f, nullptr, &counter);
+		task->setOwner(&owner);
+		a.submitTask(task);
+		HighRezTimer::sleep(0.1);
+		const Second begin = HighRezTimer::getCurrentTime();
+		a.cancelTasks(&owner);
+		ANKI_TEST_EXPECT_GT(HighRezTimer::getCurrentTime() - begin, 0.2);
+		ANKI_TEST_EXPECT_EQ(counter.load(), 6);
+	}
+
 	// Fuzzy test
 	{
 		AsyncLoader a;
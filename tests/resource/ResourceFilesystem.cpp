@@ -5,6 +5,7 @@
 
 #include "tests/framework/Framework.h"
 #include "anki/resource/ResourceFilesystem.h"
+#include "anki/resource/ResourcePack.h"
 
 namespace anki
 {
@@ -35,4 +36,72 @@ ANKI_TEST(Resource, ResourceFilesystem)
 	}
 }
 
+ANKI_TEST(Resource, ResourcePack)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	const CString packFname = "./resource_pack_test.ankipak";
+
+	// Something compressible that spans a few chunks and something that isn't
+	const U32 chunkSize = 1_KB;
+	DynamicArrayAuto<U8, PtrSize> big(alloc);
+	big.create(chunkSize * 3 + 100);
+	for(PtrSize i = 0; i < big.getSize(); ++i)
+	{
+		big[i] = U8(i % 7);
+	}
+
+	const CString hello = "hello pack\n";
+
+	{
+		ResourcePackWriter writer(alloc);
+		ANKI_TEST_EXPECT_NO_ERR(writer.begin(packFname, chunkSize));
+		const ConstWeakArray<U8, PtrSize> bigView(&big[0], big.getSize());
+		ANKI_TEST_EXPECT_NO_ERR(writer.addFile("dir/big.bin", bigView, true));
+		const ConstWeakArray<U8, PtrSize> helloView(reinterpret_cast<const U8*>(hello.cstr()), hello.getLength());
+		ANKI_TEST_EXPECT_NO_ERR(writer.addFile("hello.txt", helloView, false));
+		ANKI_TEST_EXPECT_NO_ERR(writer.end());
+	}
+
+	ResourceFilesystem fs(alloc);
+	ANKI_TEST_EXPECT_NO_ERR(fs.addNewPath(packFname));
+
+	// Uncompressed
+	{
+		ResourceFilePtr file;
+		ANKI_TEST_EXPECT_NO_ERR(fs.openFile("hello.txt", file));
+		ANKI_TEST_EXPECT_EQ(file->getSize(), hello.getLength());
+		StringAuto txt(alloc);
+		ANKI_TEST_EXPECT_NO_ERR(file->readAllText(txt));
+		ANKI_TEST_EXPECT_EQ(txt, hello);
+	}
+
+	// Compressed with random access
+	{
+		ResourceFilePtr file;
+		ANKI_TEST_EXPECT_NO_ERR(fs.openFile("dir/big.bin", file));
+		ANKI_TEST_EXPECT_EQ(file->getSize(), big.getSize());
+		ANKI_TEST_EXPECT_EQ(file->isMapped(), false);
+
+		DynamicArrayAuto<U8, PtrSize> data(alloc);
+		data.create(big.getSize());
+		ANKI_TEST_EXPECT_NO_ERR(file->read(&data[0], data.getSize()));
+		ANKI_TEST_EXPECT_EQ(memcmp(&data[0], &big[0], big.getSize()), 0);
+
+		// Read across a chunk boundary
+		const PtrSize offset = chunkSize * 2 - 10;
+		ANKI_TEST_EXPECT_NO_ERR(file->seek(offset, FileSeekOrigin::BEGINNING));
+		Array<U8, 20> part;
+		ANKI_TEST_EXPECT_NO_ERR(file->read(&part[0], part.getSize()));
+		ANKI_TEST_EXPECT_EQ(memcmp(&part[0], &big[offset], part.getSize()), 0);
+
+		// Past the end
+		ANKI_TEST_EXPECT_NEQ(file->read(&part[0], big.getSize()), Error::NONE);
+	}
+
+	{
+		ResourceFilePtr file;
+		ANKI_TEST_EXPECT_NEQ(fs.openFile("missing.txt", file), Error::NONE);
+	}
+}
+
 } // end namespace anki
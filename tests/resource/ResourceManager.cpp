@@ -7,6 +7,7 @@
 #include "anki/resource/DummyResource.h"
 #include "anki/resource/ResourceManager.h"
 #include "anki/core/ConfigSet.h"
+#include "anki/util/Thread.h"
 
 namespace anki
 {
@@ -83,6 +84,71 @@ ANKI_TEST(Resource, ResourceManager)
 		}
 	}
 
+	// Reload
+	{
+		DummyResourcePtr a;
+		ANKI_TEST_EXPECT_NO_ERR(resources->loadResource("blah", a));
+		ANKI_TEST_EXPECT_NO_ERR(resources->reloadResource(a.get()));
+
+		// New loads get the new version and the old stays alive
+		DummyResourcePtr b;
+		ANKI_TEST_EXPECT_NO_ERR(resources->loadResource("blah", b));
+		ANKI_TEST_EXPECT_NEQ(b->getUuid(), a->getUuid());
+		ANKI_TEST_EXPECT_EQ(a->getReplacement(), b.get());
+
+		// Drop the old first, the new one is held by the old
+		a.reset(nullptr);
+		ANKI_TEST_EXPECT_EQ(b->getRefcount().load(), 1);
+	}
+
+	// Load from many threads
+	{
+		class Ctx
+		{
+		public:
+			ResourceManager* m_resources;
+			Array<DummyResourcePtr, 4> m_ptrs;
+			Atomic<U32> m_threadIdx = {0};
+		} ctx;
+		ctx.m_resources = resources;
+
+		Array<Thread*, 4> threads;
+		for(Thread*& thread : threads)
+		{
+			thread = alloc.newInstance<Thread>("loader");
+			thread->start(&ctx, [](ThreadCallbackInfo& info) -> Error {
+				Ctx& ctx = *static_cast<Ctx*>(info.m_userData);
+				DummyResourcePtr& first = ctx.m_ptrs[ctx.m_threadIdx.fetchAdd(1)];
+				ANKI_CHECK(ctx.m_resources->loadResource("many", first));
+
+				for(U32 i = 0; i < 100; ++i)
+				{
+					DummyResourcePtr a;
+					ANKI_CHECK(ctx.m_resources->loadResource((i & 1) ? "many" : "many2", a));
+					if((i & 1) && a.get() != first.get())
+					{
+						return Error::FUNCTION_FAILED;
+					}
+				}
+
+				return Error::NONE;
+			});
+		}
+
+		for(Thread* thread : threads)
+		{
+			ANKI_TEST_EXPECT_NO_ERR(thread->join());
+			alloc.deleteInstance(thread);
+		}
+
+		// All got the same resource
+		for(const DummyResourcePtr& ptr : ctx.m_ptrs)
+		{
+			ANKI_TEST_EXPECT_EQ(ptr.get(), ctx.m_ptrs[0].get());
+		}
+		ANKI_TEST_EXPECT_EQ(ctx.m_ptrs[0]->getRefcount().load(), 4);
+	}
+
 	// Delete
 	alloc.deleteInstance(resources);
 }
@@ -5,6 +5,7 @@
 
 #include <tests/framework/Framework.h>
 #include <anki/scene/Octree.h>
+#include <anki/Collision.h>
 
 namespace anki
 {
@@ -86,4 +87,298 @@ ANKI_TEST(Scene, Octree)
 #endif
 }
 
+ANKI_TEST(Scene, LooseOctree)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	Array<Octree*, 2> octrees;
+	octrees[0] = alloc.newInstance<Octree>(alloc);
+	octrees[0]->init(Vec3(-100.0f), Vec3(100.0f), 4, OctreeType::REGULAR);
+	octrees[1] = alloc.newInstance<Octree>(alloc);
+	octrees[1]->init(Vec3(-100.0f), Vec3(100.0f), 4, OctreeType::LOOSE);
+
+	constexpr U32 PLACEABLE_COUNT = 500;
+	Array<Array<OctreePlaceable, PLACEABLE_COUNT>, 2> placeables;
+	Array<Aabb, PLACEABLE_COUNT> volumes;
+
+	for(U32 iteration = 0; iteration < 10; ++iteration)
+	{
+		// Place or move everything
+		for(U32 i = 0; i < PLACEABLE_COUNT; ++i)
+		{
+			// Small and big volumes that are inside the scene
+			const F32 size = (i % 10 == 0) ? getRandomRange(10.0f, 50.0f) : getRandomRange(0.1f, 2.0f);
+			const F32 range = 100.0f - size;
+			const Vec3 center(getRandomRange(-range, range), getRandomRange(-range, range), getRandomRange(-range, range));
+			volumes[i] = Aabb(center - Vec3(size), center + Vec3(size));
+
+			for(U32 t = 0; t < 2; ++t)
+			{
+				placeables[t][i].m_userData = &volumes[i];
+				octrees[t]->place(volumes[i], &placeables[t][i], true);
+			}
+		}
+
+		// Random frustum
+		const Mat4 proj = Mat4::calculatePerspectiveProjectionMatrix(toRad(60.0f), toRad(45.0f), 0.1f, 150.0f);
+		const Transform trf(Vec4(getRandomRange(-50.0f, 50.0f), 0.0f, getRandomRange(-50.0f, 50.0f), 0.0f),
+			Mat3x4(Euler(0.0f, getRandomRange(-PI, PI), 0.0f)),
+			1.0f);
+		Array<Plane, 6> planes;
+		extractClipPlanes(proj * Mat4(trf.getInverse()), planes);
+
+		for(U32 t = 0; t < 2; ++t)
+		{
+			for(OctreePlaceable& placeable : placeables[t])
+			{
+				placeable.reset();
+			}
+
+			DynamicArrayAuto<void*> visible(alloc);
+			octrees[t]->gatherVisible(&planes[0], 0, nullptr, nullptr, visible);
+
+			Array<U32, PLACEABLE_COUNT> visibleCount = {};
+			for(void* ud : visible)
+			{
+				++visibleCount[static_cast<Aabb*>(ud) - &volumes[0]];
+			}
+
+			// Every volume with its center inside the frustum should be there and only once. The rest might be there
+			// since the tests are conservative
+			for(U32 i = 0; i < PLACEABLE_COUNT; ++i)
+			{
+				const Vec4 center = (volumes[i].getMin() + volumes[i].getMax()) * 0.5f;
+				Bool inside = true;
+				for(const Plane& plane : planes)
+				{
+					inside = inside && testPlane(plane, center) >= 0.0f;
+				}
+
+				if(inside)
+				{
+					ANKI_TEST_EXPECT_EQ(visibleCount[i], 1);
+				}
+				else
+				{
+					ANKI_TEST_EXPECT_LEQ(visibleCount[i], 1);
+				}
+			}
+
+			// The walk should visit the same
+			for(OctreePlaceable& placeable : placeables[t])
+			{
+				placeable.reset();
+			}
+
+			U32 walkCount = 0;
+			octrees[t]->walkTree(planes, 1, [](const Aabb&) { return true; }, [&](void*) { ++walkCount; });
+			ANKI_TEST_EXPECT_EQ(walkCount, visible.getSize());
+		}
+	}
+
+	// Remove all
+	for(U32 t = 0; t < 2; ++t)
+	{
+		for(OctreePlaceable& placeable : placeables[t])
+		{
+			octrees[t]->remove(placeable);
+		}
+
+		alloc.deleteInstance(octrees[t]);
+	}
+}
+
+ANKI_TEST(Scene, OctreeIncrementalPlace)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	// One octree is updated incrementally and the other is rebuilt every time
+	Array<Octree*, 2> octrees;
+	for(U32 t = 0; t < 2; ++t)
+	{
+		octrees[t] = alloc.newInstance<Octree>(alloc);
+		octrees[t]->init(Vec3(-100.0f), Vec3(100.0f), 5);
+	}
+
+	constexpr U32 PLACEABLE_COUNT = 500;
+	Array<Array<OctreePlaceable, PLACEABLE_COUNT>, 2> placeables;
+	Array<Aabb, PLACEABLE_COUNT> volumes;
+	Array<OctreePlaceRequest, PLACEABLE_COUNT> requests;
+
+	for(U32 i = 0; i < PLACEABLE_COUNT; ++i)
+	{
+		const F32 size = (i % 10 == 0) ? getRandomRange(10.0f, 50.0f) : getRandomRange(0.1f, 2.0f);
+		const F32 range = 99.0f - size;
+		const Vec3 center(getRandomRange(-range, range), getRandomRange(-range, range), getRandomRange(-range, range));
+		volumes[i] = Aabb(center - Vec3(size), center + Vec3(size));
+
+		for(U32 t = 0; t < 2; ++t)
+		{
+			placeables[t][i].m_userData = &volumes[i];
+		}
+	}
+
+	for(U32 iteration = 0; iteration < 20; ++iteration)
+	{
+		// Move everything a little. Most will stay in the same leafs
+		if(iteration > 0)
+		{
+			for(Aabb& volume : volumes)
+			{
+				const Vec4 offset(
+					getRandomRange(-0.05f, 0.05f), getRandomRange(-0.05f, 0.05f), getRandomRange(-0.05f, 0.05f), 0.0f);
+				volume = Aabb(volume.getMin() + offset, volume.getMax() + offset);
+			}
+		}
+
+		for(U32 i = 0; i < PLACEABLE_COUNT; ++i)
+		{
+			requests[i].m_volume = volumes[i];
+			requests[i].m_placeable = &placeables[0][i];
+
+			octrees[1]->remove(placeables[1][i]);
+			octrees[1]->place(volumes[i], &placeables[1][i], true);
+		}
+
+		const U64 epoch = octrees[0]->getChangeEpoch();
+		octrees[0]->placeBatch(requests);
+		ANKI_TEST_EXPECT_GT(octrees[0]->getChangeEpoch(), epoch);
+
+		// Placing the same volume again changes nothing
+		octrees[0]->place(volumes[0], &placeables[0][0], true);
+
+		// Both should see the same
+		const Mat4 proj = Mat4::calculatePerspectiveProjectionMatrix(toRad(60.0f), toRad(45.0f), 0.1f, 150.0f);
+		const Transform trf(Vec4(getRandomRange(-50.0f, 50.0f), 0.0f, getRandomRange(-50.0f, 50.0f), 0.0f),
+			Mat3x4(Euler(0.0f, getRandomRange(-PI, PI), 0.0f)),
+			1.0f);
+		Array<Plane, 6> planes;
+		extractClipPlanes(proj * Mat4(trf.getInverse()), planes);
+
+		Array<Array<U32, PLACEABLE_COUNT>, 2> visibleCount = {};
+		for(U32 t = 0; t < 2; ++t)
+		{
+			for(OctreePlaceable& placeable : placeables[t])
+			{
+				placeable.reset();
+			}
+
+			DynamicArrayAuto<void*> visible(alloc);
+			octrees[t]->gatherVisible(&planes[0], 0, nullptr, nullptr, visible);
+			for(void* ud : visible)
+			{
+				++visibleCount[t][static_cast<Aabb*>(ud) - &volumes[0]];
+			}
+		}
+
+		for(U32 i = 0; i < PLACEABLE_COUNT; ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(visibleCount[0][i], visibleCount[1][i]);
+		}
+	}
+
+	for(U32 t = 0; t < 2; ++t)
+	{
+		for(OctreePlaceable& placeable : placeables[t])
+		{
+			octrees[t]->remove(placeable);
+		}
+
+		alloc.deleteInstance(octrees[t]);
+	}
+}
+
+ANKI_TEST(Scene, OctreeSetSceneBounds)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	for(OctreeType type : {OctreeType::REGULAR, OctreeType::LOOSE})
+	{
+		Octree octree(alloc);
+		octree.init(Vec3(-100.0f), Vec3(100.0f), 4, type);
+
+		// Empty the tree and grow it to hold a volume that was outside
+		Array<OctreePlaceable, 2> placeables;
+		Array<Aabb, 2> volumes = {{Aabb(Vec3(-10.0f), Vec3(10.0f)), Aabb(Vec3(290.0f), Vec3(310.0f))}};
+
+		placeables[0].m_userData = &volumes[0];
+		octree.place(volumes[0], &placeables[0], true);
+		octree.remove(placeables[0]);
+
+		octree.setSceneBounds(Vec3(-100.0f), Vec3(400.0f));
+
+		for(U32 i = 0; i < 2; ++i)
+		{
+			placeables[i].m_userData = &volumes[i];
+			octree.place(volumes[i], &placeables[i], true);
+		}
+
+		// A box that holds everything
+		Array<Plane, 6> planes;
+		for(U32 i = 0; i < 3; ++i)
+		{
+			Vec4 normal(0.0f);
+			normal[i] = 1.0f;
+			planes[i * 2] = Plane(normal, -500.0f);
+			planes[i * 2 + 1] = Plane(-normal, -500.0f);
+		}
+
+		for(OctreePlaceable& placeable : placeables)
+		{
+			placeable.reset();
+		}
+
+		DynamicArrayAuto<void*> visible(alloc);
+		octree.gatherVisible(&planes[0], 0, nullptr, nullptr, visible);
+		ANKI_TEST_EXPECT_EQ(visible.getSize(), 2);
+
+		for(OctreePlaceable& placeable : placeables)
+		{
+			octree.remove(placeable);
+		}
+	}
+}
+
 } // end namespace anki
+
+ANKI_TEST(Scene, OctreeVolumeChangedSince)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	for(OctreeType type : {OctreeType::REGULAR, OctreeType::LOOSE})
+	{
+		Octree octree(alloc);
+		octree.init(Vec3(-100.0f), Vec3(100.0f), 4, type);
+
+		const Aabb left(Vec3(-90.0f), Vec3(-50.0f));
+		const Aabb right(Vec3(50.0f), Vec3(90.0f));
+
+		OctreePlaceable placeable;
+		Aabb volume(Vec3(-80.0f), Vec3(-70.0f));
+		placeable.m_userData = &volume;
+		octree.place(volume, &placeable, true);
+
+		U64 epoch = octree.getChangeEpoch();
+		ANKI_TEST_EXPECT_EQ(octree.volumeChangedSince(left, epoch), false);
+		ANKI_TEST_EXPECT_EQ(octree.volumeChangedSince(right, epoch), false);
+
+		// Move it from the left to the right. Both volumes see it
+		volume = Aabb(Vec3(70.0f), Vec3(80.0f));
+		octree.place(volume, &placeable, true);
+		ANKI_TEST_EXPECT_EQ(octree.volumeChangedSince(left, epoch), true);
+		ANKI_TEST_EXPECT_EQ(octree.volumeChangedSince(right, epoch), true);
+
+		// Move it inside the right volume
+		epoch = octree.getChangeEpoch();
+		volume = Aabb(Vec3(60.0f), Vec3(70.0f));
+		octree.place(volume, &placeable, true);
+		ANKI_TEST_EXPECT_EQ(octree.volumeChangedSince(left, epoch), false);
+		ANKI_TEST_EXPECT_EQ(octree.volumeChangedSince(right, epoch), true);
+
+		// Removing is a change as well
+		epoch = octree.getChangeEpoch();
+		octree.remove(placeable);
+		ANKI_TEST_EXPECT_EQ(octree.volumeChangedSince(left, epoch), false);
+		ANKI_TEST_EXPECT_EQ(octree.volumeChangedSince(right, epoch), true);
+	}
+}
@@ -0,0 +1,455 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+// Benchmarks of the scene update and the visibility tests. Every result is a line of the log that looks like:
+// BENCH,<name>,<thread count>,<iteration count>,<average ms>,<min ms>
+// so the results of two runs can be diffed or fed into a script to catch regressions.
+
+#include <tests/framework/Framework.h>
+#include <anki/scene/SceneGraph.h>
+#include <anki/scene/LightNode.h>
+#include <anki/scene/ReflectionProbeNode.h>
+#include <anki/scene/GlobalIlluminationProbeNode.h>
+#include <anki/scene/components/MoveComponent.h>
+#include <anki/scene/components/SpatialComponent.h>
+#include <anki/scene/components/RenderComponent.h>
+#include <anki/scene/components/LightComponent.h>
+#include <anki/scene/components/GlobalIlluminationProbeComponent.h>
+#include <anki/Collision.h>
+#include <anki/renderer/ClusterBin.h>
+#include <anki/renderer/RenderQueue.h>
+#include <anki/core/StagingGpuMemoryManager.h>
+#include <anki/util/ThreadHive.h>
+#include <anki/util/HighRezTimer.h>
+#include <anki/util/System.h>
+
+namespace anki
+{
+
+namespace
+{
+
+/// The size of the synthetic scenes.
+constexpr U32 STATIC_NODE_COUNT = 10000;
+constexpr U32 DYNAMIC_NODE_COUNT = 1000;
+constexpr U32 POINT_LIGHT_COUNT = 100;
+constexpr U32 SPOT_LIGHT_COUNT = 50;
+constexpr U32 SHADOW_LIGHT_EVERY = 10; ///< Every Nth light casts shadows.
+constexpr U32 REFLECTION_PROBE_COUNT = 20;
+constexpr U32 GI_PROBE_COUNT = 4;
+
+constexpr U32 WARMUP_ITERATION_COUNT = 5;
+constexpr U32 ITERATION_COUNT = 30;
+
+constexpr F32 SCENE_EXTEND = 500.0f;
+
+/// The thread counts to run the benchmarks with. Powers of two up to the core count.
+void getThreadCounts(DynamicArrayAuto<U32>& counts)
+{
+	const U32 coreCount = getCpuCoresCount();
+	for(U32 count = 1; count < coreCount; count *= 2)
+	{
+		counts.emplaceBack(count);
+	}
+	counts.emplaceBack(coreCount);
+}
+
+Aabb getRandomVolume(F32 minSize, F32 maxSize)
+{
+	const F32 size = getRandomRange(minSize, maxSize);
+	const F32 range = SCENE_EXTEND - size - 1.0f;
+	const Vec3 center(getRandomRange(-range, range), getRandomRange(-10.0f, 50.0f), getRandomRange(-range, range));
+	return Aabb(center - Vec3(size), center + Vec3(size));
+}
+
+Vec4 getRandomOffset(F32 range)
+{
+	return Vec4(getRandomRange(-range, range), 0.0f, getRandomRange(-range, range), 0.0f);
+}
+
+/// A renderable that stands in for a ModelNode. It doesn't need any resources.
+class BenchRenderableNode : public SceneNode
+{
+public:
+	BenchRenderableNode(SceneGraph* scene, CString name)
+		: SceneNode(scene, name)
+	{
+	}
+
+	ANKI_USE_RESULT Error init(F32 size, Bool castsShadow)
+	{
+		m_size = size;
+		m_aabb = Aabb(Vec3(-size), Vec3(size));
+
+		newComponent<MoveComponent>();
+		newComponent<FeedbackComponent>();
+		newComponent<SpatialComponent>(this, &m_aabb);
+
+		RenderComponent* rc = newComponent<RenderComponent>();
+		rc->setup([](RenderQueueDrawContext&, ConstWeakArray<void*>) {}, this, 1);
+		rc->setFlags((castsShadow) ? RenderComponentFlag::CASTS_SHADOW : RenderComponentFlag::NONE);
+
+		return Error::NONE;
+	}
+
+private:
+	class FeedbackComponent : public SceneComponent
+	{
+	public:
+		FeedbackComponent()
+			: SceneComponent(SceneComponentType::NONE)
+		{
+		}
+
+		ANKI_USE_RESULT Error update(SceneNode& node, Second prevTime, Second crntTime, Bool& updated) override
+		{
+			updated = false;
+
+			const MoveComponent& movec = node.getComponent<MoveComponent>();
+			if(movec.getTimestamp() == node.getGlobalTimestamp())
+			{
+				BenchRenderableNode& self = static_cast<BenchRenderableNode&>(node);
+				const Vec4 origin = movec.getWorldTransform().getOrigin();
+				self.m_aabb = Aabb(origin - Vec4(Vec3(self.m_size), 0.0f), origin + Vec4(Vec3(self.m_size), 0.0f));
+
+				SpatialComponent& spatialc = node.getComponent<SpatialComponent>();
+				spatialc.setSpatialOrigin(origin);
+				spatialc.markForUpdate();
+			}
+
+			return Error::NONE;
+		}
+	};
+
+	Aabb m_aabb;
+	F32 m_size = 1.0f;
+};
+
+/// Populate the scene with the synthetic nodes.
+ANKI_USE_RESULT Error populateScene(SceneGraph& scene, DynamicArrayAuto<SceneNode*>& dynamicNodes)
+{
+	scene.reserveNodes(STATIC_NODE_COUNT + DYNAMIC_NODE_COUNT + POINT_LIGHT_COUNT + SPOT_LIGHT_COUNT
+					   + REFLECTION_PROBE_COUNT + GI_PROBE_COUNT);
+
+	for(U32 i = 0; i < STATIC_NODE_COUNT + DYNAMIC_NODE_COUNT; ++i)
+	{
+		const Bool isStatic = i < STATIC_NODE_COUNT;
+		const Aabb volume = getRandomVolume(0.5f, (i % 50 == 0) ? 20.0f : 3.0f);
+
+		BenchRenderableNode* node;
+		ANKI_CHECK(scene.newSceneNode<BenchRenderableNode>(
+			StringAuto(scene.getAllocator()).sprintf("renderable%u", i).toCString(),
+			node,
+			(volume.getMax().x() - volume.getMin().x()) / 2.0f,
+			i % 4 != 0));
+
+		node->setStatic(isStatic);
+		node->getComponent<MoveComponent>().setLocalOrigin((volume.getMin() + volume.getMax()) / 2.0f);
+
+		if(!isStatic)
+		{
+			dynamicNodes.emplaceBack(node);
+		}
+	}
+
+	for(U32 i = 0; i < POINT_LIGHT_COUNT + SPOT_LIGHT_COUNT; ++i)
+	{
+		const Aabb volume = getRandomVolume(5.0f, 20.0f);
+		const F32 size = volume.getMax().x() - volume.getMin().x();
+
+		SceneNode* node;
+		if(i < POINT_LIGHT_COUNT)
+		{
+			PointLightNode* light;
+			ANKI_CHECK(scene.newSceneNode<PointLightNode>(
+				StringAuto(scene.getAllocator()).sprintf("plight%u", i).toCString(), light));
+			light->getComponent<LightComponent>().setRadius(size);
+			node = light;
+		}
+		else
+		{
+			SpotLightNode* light;
+			ANKI_CHECK(scene.newSceneNode<SpotLightNode>(
+				StringAuto(scene.getAllocator()).sprintf("slight%u", i).toCString(), light));
+			light->getComponent<LightComponent>().setDistance(size * 2.0f);
+			light->getComponent<LightComponent>().setOuterAngle(toRad(45.0f));
+			light->getComponent<LightComponent>().setInnerAngle(toRad(15.0f));
+			node = light;
+		}
+
+		node->getComponent<LightComponent>().setShadowEnabled(i % SHADOW_LIGHT_EVERY == 0);
+		node->setStatic(true);
+		node->getComponent<MoveComponent>().setLocalOrigin((volume.getMin() + volume.getMax()) / 2.0f);
+	}
+
+	for(U32 i = 0; i < REFLECTION_PROBE_COUNT; ++i)
+	{
+		const Aabb volume = getRandomVolume(10.0f, 40.0f);
+		const Vec4 halfSize = (volume.getMax() - volume.getMin()) / 2.0f;
+
+		ReflectionProbeNode* probe;
+		ANKI_CHECK(scene.newSceneNode<ReflectionProbeNode>(
+			StringAuto(scene.getAllocator()).sprintf("reflprobe%u", i).toCString(), probe, -halfSize, halfSize));
+		probe->setStatic(true);
+		probe->getComponent<MoveComponent>().setLocalOrigin(volume.getMin() + halfSize);
+	}
+
+	for(U32 i = 0; i < GI_PROBE_COUNT; ++i)
+	{
+		const Aabb volume = getRandomVolume(40.0f, 100.0f);
+
+		GlobalIlluminationProbeNode* probe;
+		ANKI_CHECK(scene.newSceneNode<GlobalIlluminationProbeNode>(
+			StringAuto(scene.getAllocator()).sprintf("giprobe%u", i).toCString(), probe));
+		probe->getComponent<GlobalIlluminationProbeComponent>().setBoundingBox(volume.getMin(), volume.getMax());
+		probe->setStatic(true);
+	}
+
+	return Error::NONE;
+}
+
+} // end namespace
+
+ANKI_TEST(Scene, OctreeBench)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	DynamicArrayAuto<Aabb> volumes(alloc);
+	volumes.create(STATIC_NODE_COUNT + DYNAMIC_NODE_COUNT);
+	for(U32 i = 0; i < volumes.getSize(); ++i)
+	{
+		volumes[i] = getRandomVolume(0.5f, (i % 50 == 0) ? 20.0f : 3.0f);
+	}
+
+	const Mat4 proj = Mat4::calculatePerspectiveProjectionMatrix(toRad(60.0f), toRad(45.0f), 0.1f, 300.0f);
+
+	DynamicArrayAuto<U32> threadCounts(alloc);
+	getThreadCounts(threadCounts);
+
+	for(OctreeType type : {OctreeType::REGULAR, OctreeType::LOOSE})
+	{
+		const CString typeName = (type == OctreeType::REGULAR) ? "Regular" : "Loose";
+
+		for(U32 threadCount : threadCounts)
+		{
+			ThreadHive hive(threadCount, alloc, true);
+
+			Octree octree(alloc);
+			octree.init(Vec3(-SCENE_EXTEND), Vec3(SCENE_EXTEND), 5, type);
+
+			DynamicArrayAuto<OctreePlaceable> placeables(alloc);
+			placeables.create(volumes.getSize());
+			for(U32 i = 0; i < volumes.getSize(); ++i)
+			{
+				placeables[i].m_userData = &volumes[i];
+				octree.place(volumes[i], &placeables[i], true);
+			}
+
+			DynamicArrayAuto<OctreePlaceRequest> requests(alloc);
+			requests.create(DYNAMIC_NODE_COUNT);
+
+			StringAuto placeName(alloc), placeBatchName(alloc), gatherName(alloc), gatherParallelName(alloc);
+			placeName.sprintf("Octree%sPlace", typeName.cstr());
+			placeBatchName.sprintf("Octree%sPlaceBatch", typeName.cstr());
+			gatherName.sprintf("Octree%sGatherVisible", typeName.cstr());
+			gatherParallelName.sprintf("Octree%sGatherVisibleParallel", typeName.cstr());
+
+			BenchTimer placeTimer(placeName.toCString(), threadCount);
+			BenchTimer placeBatchTimer(placeBatchName.toCString(), threadCount);
+			BenchTimer gatherTimer(gatherName.toCString(), 1);
+			BenchTimer gatherParallelTimer(gatherParallelName.toCString(), threadCount);
+
+			for(U32 iteration = 0; iteration < ITERATION_COUNT; ++iteration)
+			{
+				// Move the dynamic placeables a little. Most of them stay in the same leafs
+				for(U32 i = STATIC_NODE_COUNT; i < volumes.getSize(); ++i)
+				{
+					const Vec4 offset = getRandomOffset(0.5f);
+					volumes[i] = Aabb(volumes[i].getMin() + offset, volumes[i].getMax() + offset);
+				}
+
+				// Place them from all the threads
+				placeTimer.begin();
+				hive.parallelFor(DYNAMIC_NODE_COUNT, 64, [&](U32 begin, U32 end, U32 threadId) {
+					for(U32 i = begin; i < end; ++i)
+					{
+						const U32 idx = STATIC_NODE_COUNT + i;
+						octree.place(volumes[idx], &placeables[idx], true);
+					}
+				});
+				placeTimer.end();
+
+				// Move them back and place them with a single batch
+				for(U32 i = 0; i < DYNAMIC_NODE_COUNT; ++i)
+				{
+					const U32 idx = STATIC_NODE_COUNT + i;
+					const Vec4 offset = getRandomOffset(0.5f);
+					volumes[idx] = Aabb(volumes[idx].getMin() + offset, volumes[idx].getMax() + offset);
+
+					requests[i].m_volume = volumes[idx];
+					requests[i].m_placeable = &placeables[idx];
+				}
+
+				placeBatchTimer.begin();
+				octree.placeBatch(requests);
+				placeBatchTimer.end();
+
+				// Gather from a random frustum
+				const Transform trf(getRandomOffset(SCENE_EXTEND / 2.0f),
+					Mat3x4(Euler(0.0f, getRandomRange(-PI, PI), 0.0f)),
+					1.0f);
+				Array<Plane, 6> planes;
+				extractClipPlanes(proj * Mat4(trf.getInverse()), planes);
+
+				for(OctreePlaceable& placeable : placeables)
+				{
+					placeable.reset();
+				}
+
+				DynamicArrayAuto<void*> visible(alloc);
+				gatherTimer.begin();
+				octree.gatherVisible(&planes[0], 0, nullptr, nullptr, visible);
+				gatherTimer.end();
+
+				DynamicArrayAuto<void*> visibleParallel(alloc);
+				gatherParallelTimer.begin();
+				ThreadHiveSemaphore* sem;
+				octree.gatherVisibleParallel(&planes[0], 1, nullptr, nullptr, &visibleParallel, hive, nullptr, sem);
+				hive.waitAllTasks();
+				gatherParallelTimer.end();
+
+				ANKI_TEST_EXPECT_EQ(visible.getSize(), visibleParallel.getSize());
+			}
+
+			for(OctreePlaceable& placeable : placeables)
+			{
+				octree.remove(placeable);
+			}
+		}
+	}
+}
+
+ANKI_TEST(Scene, SceneGraphBench)
+{
+	ConfigSet cfg = DefaultConfigSet::get();
+	initConfig(cfg);
+	cfg.set("rsrc_dataPaths", "engine_data");
+
+	NativeWindow* win = createWindow(cfg);
+	GrManager* gr = createGrManager(cfg, win);
+	PhysicsWorld* physics;
+	ResourceFilesystem* fs;
+	ResourceManager* resources = createResourceManager(cfg, gr, physics, fs);
+
+	StagingGpuMemoryManager* stagingMem = new StagingGpuMemoryManager();
+	ANKI_TEST_EXPECT_NO_ERR(stagingMem->init(gr, cfg));
+
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	ClusterBin clusterBin;
+	clusterBin.init(alloc,
+		cfg.getNumberU32("r_clusterSizeX"),
+		cfg.getNumberU32("r_clusterSizeY"),
+		cfg.getNumberU32("r_clusterSizeZ"),
+		cfg);
+
+	DynamicArrayAuto<U32> threadCounts(alloc);
+	getThreadCounts(threadCounts);
+
+	for(U32 threadCount : threadCounts)
+	{
+		ThreadHive* hive = new ThreadHive(threadCount, alloc, true);
+		Timestamp timestamp = 1;
+
+		SceneGraph* scene = new SceneGraph();
+		ANKI_TEST_EXPECT_NO_ERR(scene->init(allocAligned, nullptr, hive, resources, nullptr, nullptr, &timestamp, cfg));
+
+		DynamicArrayAuto<SceneNode*> dynamicNodes(alloc);
+		ANKI_TEST_EXPECT_NO_ERR(populateScene(*scene, dynamicNodes));
+
+		BenchTimer updateTimer("SceneGraphUpdate", threadCount);
+		BenchTimer visibilityTimer("SceneGraphDoVisibilityTests", threadCount);
+		BenchTimer binTimer("ClusterBinBin", threadCount);
+
+		Second crntTime = HighRezTimer::getCurrentTime();
+		for(U32 iteration = 0; iteration < WARMUP_ITERATION_COUNT + ITERATION_COUNT; ++iteration)
+		{
+			const Bool measure = iteration >= WARMUP_ITERATION_COUNT;
+			const Second prevTime = crntTime;
+			crntTime += 1.0 / 60.0;
+
+			// Move the camera and the dynamic nodes
+			const Transform camTrf(getRandomOffset(SCENE_EXTEND / 2.0f),
+				Mat3x4(Euler(0.0f, getRandomRange(-PI, PI), 0.0f)),
+				1.0f);
+			scene->getActiveCameraNode().getComponent<MoveComponent>().setLocalTransform(camTrf);
+
+			for(SceneNode* node : dynamicNodes)
+			{
+				MoveComponent& movec = node->getComponent<MoveComponent>();
+				movec.setLocalOrigin(movec.getLocalTransform().getOrigin() + getRandomOffset(0.5f));
+			}
+
+			// Update
+			if(measure)
+			{
+				updateTimer.begin();
+			}
+			ANKI_TEST_EXPECT_NO_ERR(scene->update(prevTime, crntTime));
+			if(measure)
+			{
+				updateTimer.end();
+			}
+
+			// Visibility
+			RenderQueue rqueue;
+			if(measure)
+			{
+				visibilityTimer.begin();
+			}
+			scene->doVisibilityTests(rqueue);
+			if(measure)
+			{
+				visibilityTimer.end();
+			}
+
+			// Binning
+			StackAllocator<U8> tempAlloc(allocAligned, nullptr, 1 * 1024 * 1024);
+
+			ClusterBinIn cin;
+			cin.m_renderQueue = &rqueue;
+			cin.m_tempAlloc = tempAlloc;
+			cin.m_shadowsEnabled = false;
+			cin.m_stagingMem = stagingMem;
+			cin.m_threadHive = hive;
+
+			ClusterBinOut binOut;
+			if(measure)
+			{
+				binTimer.begin();
+			}
+			clusterBin.bin(cin, binOut);
+			if(measure)
+			{
+				binTimer.end();
+			}
+
+			stagingMem->endFrame();
+			++timestamp;
+		}
+
+		delete scene;
+		delete hive;
+	}
+
+	delete stagingMem;
+	delete resources;
+	delete physics;
+	delete fs;
+	GrManager::deleteInstance(gr);
+	delete win;
+}
+
+} // end namespace anki
@@ -0,0 +1,160 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/scene/SoftwareRasterizer.h>
+#include <anki/Collision.h>
+
+namespace anki
+{
+
+static const U32 WIDTH = 80;
+static const U32 HEIGHT = 50;
+static const F32 FOV_X = toRad(60.0f);
+static const F32 FOV_Y = toRad(40.0f);
+
+static void prepareRasterizer(SoftwareRasterizer& r)
+{
+	r.prepare(Mat4::getIdentity(), Mat4::calculatePerspectiveProjectionMatrix(FOV_X, FOV_Y, 0.1f, 100.0f), WIDTH, HEIGHT);
+}
+
+/// Draw a quad that faces the camera.
+static void drawQuad(SoftwareRasterizer& r, F32 minX, F32 maxX, F32 minY, F32 maxY, F32 z)
+{
+	const Array<Vec3, 6> verts = {{Vec3(minX, minY, z),
+		Vec3(maxX, minY, z),
+		Vec3(maxX, maxY, z),
+		Vec3(minX, minY, z),
+		Vec3(maxX, maxY, z),
+		Vec3(minX, maxY, z)}};
+	r.draw(&verts[0][0], verts.getSize(), sizeof(Vec3), true);
+}
+
+/// A box that is inside the frustum.
+static Aabb randomBox(F32 minZ, F32 maxZ, F32 minX = -1.0f, F32 maxX = 1.0f)
+{
+	const F32 z = getRandomRange(minZ, maxZ);
+	const F32 size = getRandomRange(0.1f, 0.5f);
+	const F32 x = -z * tan(FOV_X / 2.0f) * getRandomRange(minX, maxX) * 0.8f;
+	const F32 y = -z * tan(FOV_Y / 2.0f) * getRandomRange(-0.8f, 0.8f);
+	return Aabb(Vec3(x, y, z) - Vec3(size), Vec3(x, y, z) + Vec3(size));
+}
+
+ANKI_TEST(Scene, SoftwareRasterizer)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	SoftwareRasterizer r;
+	r.init(alloc);
+
+	// A quad that covers the whole view
+	{
+		prepareRasterizer(r);
+		drawQuad(r, -50.0f, 50.0f, -50.0f, 50.0f, -10.0f);
+		r.rasterize();
+
+		for(U32 i = 0; i < 100; ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(r.visibilityTest(randomBox(-60.0f, -12.0f)), false);
+			ANKI_TEST_EXPECT_EQ(r.visibilityTest(randomBox(-8.0f, -2.0f)), true);
+		}
+
+		// Nothing is visible if it's back facing
+		prepareRasterizer(r);
+		drawQuad(r, 50.0f, -50.0f, -50.0f, 50.0f, -10.0f);
+		r.rasterize();
+		ANKI_TEST_EXPECT_EQ(r.visibilityTest(randomBox(-60.0f, -12.0f)), true);
+	}
+
+	// A quad that covers the left half of the view
+	{
+		prepareRasterizer(r);
+		drawQuad(r, -50.0f, 0.0f, -50.0f, 50.0f, -10.0f);
+		r.rasterize();
+
+		for(U32 i = 0; i < 100; ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(r.visibilityTest(randomBox(-60.0f, -12.0f, -1.0f, -0.2f)), false);
+			ANKI_TEST_EXPECT_EQ(r.visibilityTest(randomBox(-60.0f, -12.0f, 0.2f, 1.0f)), true);
+		}
+	}
+
+	// Fill the depth with zeros and make a single pixel far
+	{
+		prepareRasterizer(r);
+
+		const U32 pixelX = 45;
+		const U32 pixelY = 20;
+		Array<F32, WIDTH * HEIGHT> depths;
+		std::fill(depths.getBegin(), depths.getEnd(), 0.0f);
+		depths[pixelY * WIDTH + pixelX] = 1.0f;
+		r.fillDepthBuffer(depths);
+
+		// Find the direction that goes through the center of the pixel
+		const F32 ndcX = (F32(pixelX) + 0.5f) / F32(WIDTH) * 2.0f - 1.0f;
+		const F32 ndcY = (F32(pixelY) + 0.5f) / F32(HEIGHT) * 2.0f - 1.0f;
+		const Vec3 dir(ndcX * tan(FOV_X / 2.0f), ndcY * tan(FOV_Y / 2.0f), -1.0f);
+
+		const Vec3 point = dir * 10.0f;
+		ANKI_TEST_EXPECT_EQ(r.visibilityTest(Aabb(point - Vec3(0.01f), point + Vec3(0.01f))), true);
+
+		const Vec3 otherPoint = point + Vec3(2.0f, 0.0f, 0.0f);
+		ANKI_TEST_EXPECT_EQ(r.visibilityTest(Aabb(otherPoint - Vec3(0.01f), otherPoint + Vec3(0.01f))), false);
+	}
+
+	// The parallel rasterization should give the same results
+	{
+		ThreadHive hive(4, alloc);
+
+		Array<Vec3, 3 * 500> verts;
+		for(Vec3& v : verts)
+		{
+			v = Vec3(getRandomRange(-20.0f, 20.0f), getRandomRange(-20.0f, 20.0f), getRandomRange(-40.0f, 1.0f));
+		}
+
+		SoftwareRasterizer r2;
+		r2.init(alloc);
+
+		prepareRasterizer(r);
+		prepareRasterizer(r2);
+		r.draw(&verts[0][0], verts.getSize(), sizeof(Vec3), false);
+		r.rasterize();
+
+		// Draw from a few threads
+		constexpr U32 drawCount = 10;
+		constexpr U32 vertsPerDraw = verts.getSize() / drawCount;
+		Array<ThreadHiveTask, drawCount> drawTasks;
+		Array<std::pair<SoftwareRasterizer*, const Vec3*>, drawCount> drawArgs;
+		for(U32 i = 0; i < drawCount; ++i)
+		{
+			drawArgs[i] = {&r2, &verts[i * vertsPerDraw]};
+			drawTasks[i] = ANKI_THREAD_HIVE_TASK(
+				{ self->first->draw(&self->second[0][0], vertsPerDraw, sizeof(Vec3), false); },
+				&drawArgs[i],
+				nullptr,
+				nullptr);
+		}
+		hive.submitTasks(&drawTasks[0], drawCount);
+		hive.waitAllTasks();
+
+		ThreadHiveSemaphore* sem;
+		r2.rasterizeParallel(hive, ThreadHiveTaskPriority::NORMAL, sem);
+		hive.waitAllTasks();
+
+		U32 visibleCount = 0;
+		for(U32 i = 0; i < 1000; ++i)
+		{
+			const Aabb box = randomBox(-50.0f, -1.0f);
+			const Bool visible = r.visibilityTest(box);
+			ANKI_TEST_EXPECT_EQ(r2.visibilityTest(box), visible);
+			visibleCount += visible;
+		}
+
+		// Some should be visible and some not
+		ANKI_TEST_EXPECT_GT(visibleCount, 0);
+		ANKI_TEST_EXPECT_LT(visibleCount, 1000);
+	}
+}
+
+} // end namespace anki
@@ -110,3 +110,94 @@ print(vec:getX(), vec:getY(), vec:getZ())
 
 	ANKI_TEST_EXPECT_NO_ERR(env2.evalString(script2));
 }
+
+ANKI_TEST(Script, LuaBinderInPlaceMath)
+{
+	ScriptManager sm;
+	ANKI_TEST_EXPECT_NO_ERR(sm.init(allocAligned, nullptr));
+
+	Vec3 v3(1.0f, 2.0f, 3.0f);
+	sm.exposeVariable("v3", &v3);
+
+	static const char* script = R"(
+local tmp = Vec3.new(1, 1, 1)
+for i = 1, 1000 do
+	tmp:setAll(i, i, i)
+	tmp:subAssign(Vec3.new(i - 1))
+end
+
+v3:addAssign(tmp)
+v3:mulAssign(Vec3.new(2, 2, 2))
+v3:subAssign(Vec3.new(1))
+v3:divAssign(Vec3.new(1, 1, 3))
+v3:scale(2)
+)";
+
+	ANKI_TEST_EXPECT_NO_ERR(sm.evalString(script));
+	ANKI_TEST_EXPECT_EQ(v3, Vec3(6.0f, 10.0f, 14.0f / 3.0f));
+}
+
+ANKI_TEST(Script, LuaBinderGcSteps)
+{
+	ScriptManager sm;
+	ANKI_TEST_EXPECT_NO_ERR(sm.init(allocAligned, nullptr));
+
+	ScriptEnvironment env;
+	ANKI_TEST_EXPECT_NO_ERR(env.init(&sm));
+
+	static const char* script = R"(
+for i = 1, 10000 do
+	local v = Vec4.new(i, i, i, i)
+end
+)";
+
+	ANKI_TEST_EXPECT_NO_ERR(env.evalString(script));
+
+	const U32 memBefore = U32(lua_gc(&env.getLuaState(), LUA_GCCOUNT, 0));
+	for(U32 i = 0; i < 1000; ++i)
+	{
+		sm.stepGarbageCollection(1.0);
+	}
+	const U32 memAfter = U32(lua_gc(&env.getLuaState(), LUA_GCCOUNT, 0));
+
+	ANKI_TEST_EXPECT_LT(memAfter, memBefore);
+}
+
+ANKI_TEST(Script, LuaBinderProfiling)
+{
+	ScriptManager sm;
+	ANKI_TEST_EXPECT_NO_ERR(sm.init(allocAligned, nullptr));
+
+	LuaBinder& binder = sm.getLuaBinder();
+	binder.setProfiling(16);
+
+	static const char* script = R"(
+function busyFunc()
+	local sum = 0
+	for i = 1, 10000 do
+		sum = sum + i
+	end
+	return sum
+end
+
+busyFunc()
+)";
+
+	ANKI_TEST_EXPECT_NO_ERR(sm.evalString(script));
+
+	U64 busyFuncInstructions = 0;
+	binder.flushProfile([&](CString name, U64 instructionCount) {
+		if(name.find("busyFunc") != CString::NPOS)
+		{
+			busyFuncInstructions += instructionCount;
+		}
+	});
+	ANKI_TEST_EXPECT_GT(busyFuncInstructions, 0u);
+
+	// Flushing resets the samples
+	busyFuncInstructions = 0;
+	binder.flushProfile([&](CString name, U64 instructionCount) { busyFuncInstructions += instructionCount; });
+	ANKI_TEST_EXPECT_EQ(busyFuncInstructions, 0u);
+
+	binder.setProfiling(0);
+}
@@ -140,7 +140,7 @@ void main()
 	BindlessLimits bindlessLimits;
 	GpuDeviceCapabilities gpuCapabilities;
 	ANKI_TEST_EXPECT_NO_ERR(compileShaderProgram(
-		"test.glslp", fsystem, nullptr, &taskManager, alloc, gpuCapabilities, bindlessLimits, binary));
+		"test.glslp", fsystem, nullptr, &taskManager, nullptr, alloc, gpuCapabilities, bindlessLimits, binary));
 
 #if 1
 	StringAuto dis(alloc);
@@ -337,7 +337,7 @@ void main()
 	BindlessLimits bindlessLimits;
 	GpuDeviceCapabilities gpuCapabilities;
 	ANKI_TEST_EXPECT_NO_ERR(compileShaderProgram(
-		"test.glslp", fsystem, nullptr, &taskManager, alloc, gpuCapabilities, bindlessLimits, binary));
+		"test.glslp", fsystem, nullptr, &taskManager, nullptr, alloc, gpuCapabilities, bindlessLimits, binary));
 
 #if 1
 	StringAuto dis(alloc);
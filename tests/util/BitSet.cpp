@@ -120,4 +120,29 @@ ANKI_TEST(Util, BitSet)
 		a.set(255);
 		ANKI_TEST_EXPECT_EQ(a.getMostSignificantBit(), 255);
 	}
+
+	{
+		BitSet<100, U8> a = {false};
+		ANKI_TEST_EXPECT_EQ(a.getLeastSignificantBit(), MAX_U32);
+
+		a.set({99, 3, 64, 8});
+		ANKI_TEST_EXPECT_EQ(a.getLeastSignificantBit(), 3);
+		ANKI_TEST_EXPECT_EQ(a.getEnabledBitCount(), 4);
+
+		U32 count = 0;
+		U32 sum = 0;
+		U32 prev = 0;
+		a.iterateSetBits([&](U32 bit) {
+			ANKI_TEST_EXPECT_EQ(a.get(bit), true);
+			ANKI_TEST_EXPECT_GEQ(bit, prev);
+			prev = bit;
+			sum += bit;
+			++count;
+		});
+		ANKI_TEST_EXPECT_EQ(count, 4);
+		ANKI_TEST_EXPECT_EQ(sum, 99 + 3 + 64 + 8);
+
+		BitSet<128, U64> b = {true};
+		ANKI_TEST_EXPECT_EQ(b.getEnabledBitCount(), 128);
+	}
 }
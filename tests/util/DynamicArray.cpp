@@ -255,3 +255,93 @@ ANKI_TEST(Util, DynamicArrayEmplaceAt)
 			constructor0Count + constructor1Count + constructor2Count + constructor3Count, destructorCount);
 	}
 }
+
+ANKI_TEST(Util, DynamicArrayReserve)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	{
+		DynamicArrayAuto<DynamicArrayFoo> arr(alloc);
+		arr.reserve(10);
+		ANKI_TEST_EXPECT_EQ(arr.getSize(), 0);
+		ANKI_TEST_EXPECT_EQ(arr.getCapacity(), 10);
+
+		// The pushes that fit don't move the elements
+		arr.emplaceAt(arr.getEnd(), 0);
+		const DynamicArrayFoo* first = &arr[0];
+		for(I32 i = 1; i < 10; ++i)
+		{
+			arr.emplaceBack(i);
+		}
+
+		ANKI_TEST_EXPECT_EQ(first, &arr[0]);
+		ANKI_TEST_EXPECT_EQ(arr.getCapacity(), 10);
+
+		// Grow
+		arr.emplaceBack(10);
+		ANKI_TEST_EXPECT_GEQ(arr.getCapacity(), 20);
+
+		// Popping a few doesn't shrink
+		const U32 capacity = arr.getCapacity();
+		arr.popBack();
+		arr.popBack();
+		ANKI_TEST_EXPECT_EQ(arr.getCapacity(), capacity);
+
+		for(I32 i = 0; i < I32(arr.getSize()); ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(arr[i].m_x, i);
+		}
+	}
+
+	ANKI_TEST_EXPECT_EQ(constructor0Count + constructor1Count + constructor2Count + constructor3Count, destructorCount);
+}
+
+ANKI_TEST(Util, DynamicArrayInline)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	{
+		DynamicArrayInline<DynamicArrayFoo, 4> arr(alloc);
+		ANKI_TEST_EXPECT_EQ(arr.getCapacity(), 4);
+
+		// Fits
+		for(I32 i = 0; i < 4; ++i)
+		{
+			arr.emplaceBack(i);
+		}
+
+		ANKI_TEST_EXPECT_EQ(arr.isInline(), true);
+
+		// Spills
+		for(I32 i = 4; i < 100; ++i)
+		{
+			arr.emplaceBack(i);
+		}
+
+		ANKI_TEST_EXPECT_EQ(arr.isInline(), false);
+		ANKI_TEST_EXPECT_EQ(arr.getSize(), 100);
+		for(I32 i = 0; i < 100; ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(arr[i].m_x, i);
+		}
+
+		// Shrink the elements
+		arr.resize(50);
+		ANKI_TEST_EXPECT_EQ(arr.getSize(), 50);
+		ANKI_TEST_EXPECT_EQ(arr.getBack().m_x, 49);
+
+		// Back to the inline storage
+		arr.destroy();
+		ANKI_TEST_EXPECT_EQ(arr.isInline(), true);
+		ANKI_TEST_EXPECT_EQ(arr.getSize(), 0);
+
+		arr.resize(3, DynamicArrayFoo(123));
+		ANKI_TEST_EXPECT_EQ(arr.isInline(), true);
+		for(const DynamicArrayFoo& foo : arr)
+		{
+			ANKI_TEST_EXPECT_EQ(foo.m_x, 123);
+		}
+	}
+
+	ANKI_TEST_EXPECT_EQ(constructor0Count + constructor1Count + constructor2Count + constructor3Count, destructorCount);
+}
@@ -132,3 +132,131 @@ ANKI_TEST(Util, WalkDir)
 
 	ANKI_TEST_EXPECT_EQ(count, 1);
 }
+
+ANKI_TEST(Util, FileMmap)
+{
+	// Create file
+	{
+		File file;
+		ANKI_TEST_EXPECT_NO_ERR(file.open("./tmp_mmap", FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+		for(U32 i = 0; i < 1024; ++i)
+		{
+			ANKI_TEST_EXPECT_NO_ERR(file.write(&i, sizeof(i)));
+		}
+	}
+
+	File file;
+	ANKI_TEST_EXPECT_NO_ERR(file.open("./tmp_mmap", FileOpenFlag::READ | FileOpenFlag::BINARY | FileOpenFlag::MMAP));
+	ANKI_TEST_EXPECT_EQ(file.isMapped(), true);
+	ANKI_TEST_EXPECT_EQ(file.getSize(), 1024 * sizeof(U32));
+
+	// View
+	ConstWeakArray<U8> view;
+	ANKI_TEST_EXPECT_NO_ERR(file.getMappedRange(10 * sizeof(U32), 2 * sizeof(U32), view));
+	ANKI_TEST_EXPECT_EQ(view.getSize(), 2 * sizeof(U32));
+	ANKI_TEST_EXPECT_EQ(*reinterpret_cast<const U32*>(&view[sizeof(U32)]), 11);
+	ANKI_TEST_EXPECT_ERR(file.getMappedRange(1023 * sizeof(U32), 2 * sizeof(U32), view), Error::FUNCTION_FAILED);
+
+	// Reads and seeks
+	U32 u;
+	ANKI_TEST_EXPECT_NO_ERR(file.readU32(u));
+	ANKI_TEST_EXPECT_EQ(u, 0);
+	ANKI_TEST_EXPECT_NO_ERR(file.seek(sizeof(U32) * 99, FileSeekOrigin::CURRENT));
+	ANKI_TEST_EXPECT_NO_ERR(file.readU32(u));
+	ANKI_TEST_EXPECT_EQ(u, 100);
+	ANKI_TEST_EXPECT_EQ(file.tell(), 101 * sizeof(U32));
+	ANKI_TEST_EXPECT_NO_ERR(file.seek(0, FileSeekOrigin::END));
+	ANKI_TEST_EXPECT_ERR(file.read(&u, sizeof(u)), Error::FILE_ACCESS);
+
+	// Empty files are not mapped but they can be opened
+	{
+		File emptyFile;
+		ANKI_TEST_EXPECT_NO_ERR(emptyFile.open("./tmp_mmap_empty", FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+	}
+
+	File emptyFile;
+	ANKI_TEST_EXPECT_NO_ERR(
+		emptyFile.open("./tmp_mmap_empty", FileOpenFlag::READ | FileOpenFlag::BINARY | FileOpenFlag::MMAP));
+	ANKI_TEST_EXPECT_EQ(emptyFile.isMapped(), false);
+	ANKI_TEST_EXPECT_EQ(emptyFile.getSize(), 0);
+	ANKI_TEST_EXPECT_ERR(emptyFile.read(&u, sizeof(u)), Error::FILE_ACCESS);
+}
+
+ANKI_TEST(Util, FileReadAsync)
+{
+	const U32 CHUNK_SIZE = 4096;
+	const U32 CHUNK_COUNT = 64;
+
+	// Create file
+	{
+		File file;
+		ANKI_TEST_EXPECT_NO_ERR(file.open("./tmp_async", FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+		for(U32 i = 0; i < CHUNK_SIZE * CHUNK_COUNT / sizeof(U32); ++i)
+		{
+			ANKI_TEST_EXPECT_NO_ERR(file.write(&i, sizeof(i)));
+		}
+	}
+
+	class Chunk
+	{
+	public:
+		Array<U32, CHUNK_SIZE / sizeof(U32)> m_data;
+		U32 m_callbackCount = 0;
+		Error m_err = Error::NONE;
+	};
+
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	FileIoQueue queue;
+	ANKI_TEST_EXPECT_NO_ERR(queue.init(alloc, 8));
+
+	const Array<FileOpenFlag, 2> flags = {{FileOpenFlag::READ | FileOpenFlag::BINARY | FileOpenFlag::ASYNC,
+		FileOpenFlag::READ | FileOpenFlag::BINARY | FileOpenFlag::MMAP}};
+	for(FileOpenFlag flag : flags)
+	{
+		File file;
+		ANKI_TEST_EXPECT_NO_ERR(file.open("./tmp_async", flag));
+
+		// Read the chunks backwards, more than the queue can have in flight
+		DynamicArrayAuto<Chunk> chunks(alloc);
+		chunks.create(CHUNK_COUNT);
+		for(U32 i = CHUNK_COUNT; i-- > 0;)
+		{
+			ANKI_TEST_EXPECT_NO_ERR(file.readAsync(queue,
+				i * CHUNK_SIZE,
+				&chunks[i].m_data[0],
+				CHUNK_SIZE,
+				[](void* ud, Error err) {
+					Chunk& chunk = *static_cast<Chunk*>(ud);
+					++chunk.m_callbackCount;
+					chunk.m_err = err;
+				},
+				&chunks[i]));
+			ANKI_TEST_EXPECT_LEQ(queue.getInFlightCount(), 8);
+		}
+
+		ANKI_TEST_EXPECT_NO_ERR(queue.waitAll());
+		ANKI_TEST_EXPECT_EQ(queue.getInFlightCount(), 0);
+
+		for(U32 i = 0; i < CHUNK_COUNT; ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(chunks[i].m_callbackCount, 1);
+			ANKI_TEST_EXPECT_NO_ERR(chunks[i].m_err);
+			for(U32 j = 0; j < chunks[i].m_data.getSize(); ++j)
+			{
+				ANKI_TEST_EXPECT_EQ(chunks[i].m_data[j], i * chunks[i].m_data.getSize() + j);
+			}
+		}
+
+		// The position indicator is untouched
+		ANKI_TEST_EXPECT_EQ(file.tell(), 0);
+
+		// Out of bounds
+		ANKI_TEST_EXPECT_ERR(file.readAsync(queue,
+								 CHUNK_COUNT * CHUNK_SIZE - 1,
+								 &chunks[0].m_data[0],
+								 2,
+								 [](void*, Error) {},
+								 nullptr),
+			Error::FUNCTION_FAILED);
+	}
+}
@@ -0,0 +1,270 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include "tests/framework/Framework.h"
+#include "tests/util/Foo.h"
+#include "anki/util/FlatHashMap.h"
+#include "anki/util/DynamicArray.h"
+#include "anki/util/HighRezTimer.h"
+#include <unordered_map>
+#include <algorithm>
+
+using namespace anki;
+
+namespace
+{
+
+class Hasher
+{
+public:
+	U64 operator()(int x)
+	{
+		return U64(x);
+	}
+};
+
+} // end anonymous namespace
+
+ANKI_TEST(Util, FlatHashMap)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	int vals[] = {20, 15, 5, 1, 10, 0, 18, 6, 7, 11, 13, 3};
+	const U valsSize = sizeof(vals) / sizeof(vals[0]);
+
+	// Simple
+	{
+		FlatHashMap<int, int, Hasher> map;
+		map.emplace(alloc, 20, 1);
+		map.emplace(alloc, 21, 1);
+		ANKI_TEST_EXPECT_EQ(map.getSize(), 2);
+		map.destroy(alloc);
+	}
+
+	// Add more and iterate
+	{
+		FlatHashMap<int, int, Hasher> map;
+
+		for(U i = 0; i < valsSize; ++i)
+		{
+			map.emplace(alloc, vals[i], vals[i] * 10);
+		}
+
+		U count = 0;
+		for(int v : map)
+		{
+			ANKI_TEST_EXPECT_EQ(v % 10, 0);
+			++count;
+		}
+		ANKI_TEST_EXPECT_EQ(count, valsSize);
+
+		// Replace
+		map.emplace(alloc, vals[0], 123);
+		ANKI_TEST_EXPECT_EQ(map.getSize(), valsSize);
+		ANKI_TEST_EXPECT_EQ(*map.find(vals[0]), 123);
+
+		map.destroy(alloc);
+	}
+
+	// Erase and find
+	{
+		FlatHashMap<int, int, Hasher> map;
+
+		for(U i = 0; i < valsSize; ++i)
+		{
+			map.emplace(alloc, vals[i], vals[i] * 10);
+		}
+
+		for(U i = valsSize - 1; i != 0; --i)
+		{
+			auto it = map.find(vals[i]);
+			ANKI_TEST_EXPECT_NEQ(it, map.getEnd());
+			ANKI_TEST_EXPECT_EQ(*it, vals[i] * 10);
+
+			map.erase(alloc, it);
+			ANKI_TEST_EXPECT_EQ(map.find(vals[i]), map.getEnd());
+		}
+
+		ANKI_TEST_EXPECT_EQ(map.getSize(), 1);
+		map.destroy(alloc);
+	}
+
+	// Non-trivial values
+	{
+		FlatHashMap<U64, Foo> map;
+		for(U64 i = 0; i < 1000; ++i)
+		{
+			map.emplace(alloc, i, I32(i));
+		}
+
+		for(U64 i = 0; i < 1000; i += 2)
+		{
+			map.erase(alloc, map.find(i));
+		}
+
+		for(U64 i = 0; i < 1000; ++i)
+		{
+			auto it = map.find(i);
+			if(i & 1)
+			{
+				ANKI_TEST_EXPECT_NEQ(it, map.getEnd());
+				ANKI_TEST_EXPECT_EQ(it->x, I32(i));
+			}
+			else
+			{
+				ANKI_TEST_EXPECT_EQ(it, map.getEnd());
+			}
+		}
+
+		map.destroy(alloc);
+		ANKI_TEST_EXPECT_EQ(Foo::constructorCallCount, Foo::destructorCallCount);
+		Foo::reset();
+	}
+
+	// Fuzzy test
+	{
+		const U MAX = 10000;
+		FlatHashMap<int, int, Hasher> akMap;
+		std::unordered_map<int, int> stdMap;
+
+		for(U i = 0; i < MAX * 4; ++i)
+		{
+			const int num = rand() % int(MAX);
+			const Bool insert = (rand() % 3) != 0;
+
+			auto it = akMap.find(num);
+			auto stdIt = stdMap.find(num);
+			ANKI_TEST_EXPECT_EQ(it != akMap.getEnd(), stdIt != stdMap.end());
+
+			if(insert)
+			{
+				akMap.emplace(alloc, num, int(i));
+				stdMap[num] = int(i);
+			}
+			else if(stdIt != stdMap.end())
+			{
+				ANKI_TEST_EXPECT_EQ(*it, stdIt->second);
+				akMap.erase(alloc, it);
+				stdMap.erase(stdIt);
+			}
+
+			ANKI_TEST_EXPECT_EQ(akMap.getSize(), stdMap.size());
+		}
+
+		U count = 0;
+		for(auto it = akMap.getBegin(); it != akMap.getEnd(); ++it)
+		{
+			++count;
+		}
+		ANKI_TEST_EXPECT_EQ(count, stdMap.size());
+
+		akMap.destroy(alloc);
+	}
+}
+
+ANKI_TEST(Util, FlatHashMapBench)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	HashMap<U64, U64> hashMap;
+	FlatHashMap<U64, U64> flatMap;
+	HighRezTimer timer;
+
+	// Random unique keys
+	const U32 COUNT = 1024 * 1024;
+	std::unordered_map<U64, U64> tmpMap;
+	DynamicArrayAuto<U64> vals(alloc);
+	vals.create(COUNT);
+	for(U32 i = 0; i < COUNT; ++i)
+	{
+		U64 v;
+		do
+		{
+			v = (U64(rand()) << 32) | U64(rand());
+		} while(tmpMap.find(v) != tmpMap.end());
+		tmpMap[v] = 1;
+		vals[i] = v;
+	}
+
+	// Insertion
+	{
+		timer.start();
+		for(U32 i = 0; i < COUNT; ++i)
+		{
+			hashMap.emplace(alloc, vals[i], vals[i]);
+		}
+		timer.stop();
+		const Second hashMapTime = timer.getElapsedTime();
+
+		timer.start();
+		for(U32 i = 0; i < COUNT; ++i)
+		{
+			flatMap.emplace(alloc, vals[i], vals[i]);
+		}
+		timer.stop();
+		const Second flatMapTime = timer.getElapsedTime();
+
+		ANKI_TEST_LOGI("Inserting bench: HashMap %f FlatHashMap %f | %f%%",
+			hashMapTime,
+			flatMapTime,
+			hashMapTime / flatMapTime * 100.0);
+	}
+
+	// Search
+	{
+		std::random_shuffle(vals.begin(), vals.end());
+		U64 count = 0; // To avoid compiler opts
+
+		timer.start();
+		for(U32 i = 0; i < COUNT; ++i)
+		{
+			count += *hashMap.find(vals[i]);
+		}
+		timer.stop();
+		const Second hashMapTime = timer.getElapsedTime();
+
+		timer.start();
+		for(U32 i = 0; i < COUNT; ++i)
+		{
+			count += *flatMap.find(vals[i]);
+		}
+		timer.stop();
+		const Second flatMapTime = timer.getElapsedTime();
+
+		ANKI_TEST_LOGI("Find bench: HashMap %f FlatHashMap %f | %f%% (%lu)",
+			hashMapTime,
+			flatMapTime,
+			hashMapTime / flatMapTime * 100.0,
+			count);
+	}
+
+	// Delete
+	{
+		std::random_shuffle(vals.begin(), vals.end());
+
+		timer.start();
+		for(U32 i = 0; i < COUNT; ++i)
+		{
+			hashMap.erase(alloc, hashMap.find(vals[i]));
+		}
+		timer.stop();
+		const Second hashMapTime = timer.getElapsedTime();
+
+		timer.start();
+		for(U32 i = 0; i < COUNT; ++i)
+		{
+			flatMap.erase(alloc, flatMap.find(vals[i]));
+		}
+		timer.stop();
+		const Second flatMapTime = timer.getElapsedTime();
+
+		ANKI_TEST_LOGI("Deleting bench: HashMap %f FlatHashMap %f | %f%%",
+			hashMapTime,
+			flatMapTime,
+			hashMapTime / flatMapTime * 100.0);
+	}
+
+	ANKI_TEST_EXPECT_EQ(flatMap.isEmpty(), true);
+	hashMap.destroy(alloc);
+	flatMap.destroy(alloc);
+}
@@ -0,0 +1,182 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/util/FlatHierarchy.h>
+#include <vector>
+
+using namespace anki;
+
+namespace
+{
+
+class FlatNode : public FlatHierarchyEnabled<FlatNode>
+{
+public:
+	U32 m_id = 0;
+	FlatNode* m_parent = nullptr; ///< The reference.
+	Bool m_added = false;
+};
+
+} // namespace
+
+static Bool isAncestor(const FlatNode& ancestor, const FlatNode& node)
+{
+	for(const FlatNode* n = node.m_parent; n; n = n->m_parent)
+	{
+		if(n == &ancestor)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static void validate(const FlatHierarchy<FlatNode>& hierarchy, const std::vector<FlatNode>& nodes)
+{
+	U32 addedCount = 0;
+	for(const FlatNode& node : nodes)
+	{
+		if(!node.m_added)
+		{
+			continue;
+		}
+
+		++addedCount;
+		const U32 idx = hierarchy.getIndex(node);
+		ANKI_TEST_EXPECT_EQ(&hierarchy[idx], &node);
+
+		// The parent comes before the node
+		const U32 parentIdx = hierarchy.getParentIndex(idx);
+		if(node.m_parent)
+		{
+			ANKI_TEST_EXPECT_EQ(parentIdx, hierarchy.getIndex(*node.m_parent));
+			ANKI_TEST_EXPECT_EQ(parentIdx < idx, true);
+		}
+		else
+		{
+			ANKI_TEST_EXPECT_EQ(parentIdx, FlatHierarchy<FlatNode>::NO_PARENT);
+		}
+
+		// The subtree follows the node
+		U32 descendantCount = 0;
+		for(const FlatNode& other : nodes)
+		{
+			if(other.m_added && isAncestor(node, other))
+			{
+				++descendantCount;
+				const U32 otherIdx = hierarchy.getIndex(other);
+				ANKI_TEST_EXPECT_EQ(otherIdx > idx && otherIdx < idx + hierarchy.getSubtreeSize(idx), true);
+			}
+		}
+
+		ANKI_TEST_EXPECT_EQ(hierarchy.getSubtreeSize(idx), descendantCount + 1);
+	}
+
+	ANKI_TEST_EXPECT_EQ(hierarchy.getSize(), addedCount);
+}
+
+ANKI_TEST(Util, FlatHierarchy)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	// Simple
+	{
+		FlatHierarchy<FlatNode> hierarchy;
+		std::vector<FlatNode> nodes(4);
+
+		// a -> b, c -> d
+		for(FlatNode& node : nodes)
+		{
+			hierarchy.add(alloc, &node);
+			node.m_added = true;
+		}
+
+		hierarchy.setParent(&nodes[1], &nodes[0]);
+		nodes[1].m_parent = &nodes[0];
+		hierarchy.setParent(&nodes[3], &nodes[2]);
+		nodes[3].m_parent = &nodes[2];
+		validate(hierarchy, nodes);
+
+		// Move the c tree under b. It's the depth first order
+		hierarchy.setParent(&nodes[2], &nodes[1]);
+		nodes[2].m_parent = &nodes[1];
+		validate(hierarchy, nodes);
+		for(U32 i = 0; i < 4; ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(&hierarchy[i], &nodes[i]);
+		}
+
+		// Remove b. The c tree becomes a root
+		hierarchy.remove(alloc, &nodes[1]);
+		nodes[1].m_added = false;
+		nodes[2].m_parent = nullptr;
+		validate(hierarchy, nodes);
+
+		hierarchy.destroy(alloc);
+	}
+
+	// Random
+	{
+		const U32 NODE_COUNT = 200;
+		const U32 OP_COUNT = 2000;
+
+		FlatHierarchy<FlatNode> hierarchy;
+		std::vector<FlatNode> nodes(NODE_COUNT);
+		for(U32 i = 0; i < NODE_COUNT; ++i)
+		{
+			nodes[i].m_id = i;
+		}
+
+		hierarchy.reserve(alloc, NODE_COUNT);
+
+		for(U32 op = 0; op < OP_COUNT; ++op)
+		{
+			FlatNode& node = nodes[U32(rand()) % NODE_COUNT];
+			FlatNode* parent = &nodes[U32(rand()) % NODE_COUNT];
+			if(!parent->m_added || parent == &node || isAncestor(node, *parent) || (rand() % 4) == 0)
+			{
+				parent = nullptr;
+			}
+
+			if(!node.m_added)
+			{
+				// Add a leaf
+				hierarchy.add(alloc, &node, parent);
+				node.m_added = true;
+				node.m_parent = parent;
+			}
+			else if((rand() % 3) == 0)
+			{
+				// Remove it. The children become roots
+				hierarchy.remove(alloc, &node);
+				node.m_added = false;
+				node.m_parent = nullptr;
+				for(FlatNode& child : nodes)
+				{
+					if(child.m_parent == &node)
+					{
+						child.m_parent = nullptr;
+					}
+				}
+			}
+			else
+			{
+				// Reparent it
+				hierarchy.setParent(&node, parent);
+				node.m_parent = parent;
+			}
+
+			if((op % 50) == 0)
+			{
+				validate(hierarchy, nodes);
+			}
+		}
+
+		validate(hierarchy, nodes);
+		hierarchy.destroy(alloc);
+	}
+}
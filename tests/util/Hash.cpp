@@ -0,0 +1,126 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include "tests/framework/Framework.h"
+#include "anki/util/Hash.h"
+#include "anki/util/DynamicArray.h"
+#include "anki/util/HighRezTimer.h"
+#include <unordered_set>
+
+using namespace anki;
+
+ANKI_TEST(Util, Hash)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	DynamicArrayAuto<U8> buff(alloc);
+	buff.create(2048);
+	for(U32 i = 0; i < buff.getSize(); ++i)
+	{
+		buff[i] = U8(i * 31 + 7);
+	}
+
+	// The old hashes are stored on disk, they shouldn't change
+	{
+		const U64 HASH_MURMUR2_13 = 0x8F9B4FD5C1A6B00Eull;
+		const U64 HASH_MURMUR2_1024 = 0x64AFEFDCD252501Aull;
+		const U64 HASH_MURMUR2_APPEND = 0xBBA33C5775A7E547ull;
+		ANKI_TEST_EXPECT_EQ(computeHash(HashVersion::MURMUR2, &buff[0], 13), HASH_MURMUR2_13);
+		ANKI_TEST_EXPECT_EQ(computeHash(HashVersion::MURMUR2, &buff[0], 1024, 666), HASH_MURMUR2_1024);
+		ANKI_TEST_EXPECT_EQ(appendHash(HashVersion::MURMUR2, &buff[0], 13, HASH_MURMUR2_13), HASH_MURMUR2_APPEND);
+	}
+
+	// The same on all SIMD backends
+	{
+		const U64 HASH_XXH3_0 = 0x00A10C1499F5515Bull;
+		const U64 HASH_XXH3_3 = 0xDDE474D6E45B2CB5ull;
+		const U64 HASH_XXH3_100 = 0x9F87D2FA6544F56Cull;
+		const U64 HASH_XXH3_200 = 0x0C601185E4A4A589ull;
+		const U64 HASH_XXH3_2000 = 0x78C05A26621194E3ull;
+		const U64 HASH_XXH3_2000_NO_SEED = 0x3207F94243487FCDull;
+		ANKI_TEST_EXPECT_EQ(computeHash(HashVersion::XXH3, &buff[0], 0), HASH_XXH3_0);
+		ANKI_TEST_EXPECT_EQ(computeHash(HashVersion::XXH3, &buff[0], 3), HASH_XXH3_3);
+		ANKI_TEST_EXPECT_EQ(computeHash(HashVersion::XXH3, &buff[0], 100), HASH_XXH3_100);
+		ANKI_TEST_EXPECT_EQ(computeHash(HashVersion::XXH3, &buff[0], 200), HASH_XXH3_200);
+		ANKI_TEST_EXPECT_EQ(computeHash(HashVersion::XXH3, &buff[0], 2000), HASH_XXH3_2000);
+		ANKI_TEST_EXPECT_EQ(computeHash(HashVersion::XXH3, &buff[0], 2000, 0), HASH_XXH3_2000_NO_SEED);
+	}
+
+	// The inlined paths match the generic
+	{
+		ANKI_TEST_EXPECT_EQ(computeHash(&buff[0], 8), detail::computeHashXxh3(&buff[0], 8, 123));
+		ANKI_TEST_EXPECT_EQ(computeHash(&buff[0], 16), detail::computeHashXxh3(&buff[0], 16, 123));
+		ANKI_TEST_EXPECT_EQ(computeHash(&buff[0], 8, 1), computeHash(HashVersion::LATEST, &buff[0], 8, 1));
+	}
+
+	// No collisions between the sizes and the seeds
+	{
+		std::unordered_set<U64> hashes;
+		for(U32 size = 0; size <= 2000; ++size)
+		{
+			const U64 a = computeHash(&buff[0], size);
+			const U64 b = computeHash(&buff[0], size, 0);
+			ANKI_TEST_EXPECT_EQ(a, computeHash(&buff[0], size));
+			ANKI_TEST_EXPECT_NEQ(a, b);
+			ANKI_TEST_EXPECT_EQ(hashes.find(a), hashes.end());
+			hashes.insert(a);
+			ANKI_TEST_EXPECT_EQ(hashes.find(b), hashes.end());
+			hashes.insert(b);
+		}
+	}
+
+	// Every byte counts
+	{
+		const U64 h = computeHash(&buff[0], 1500);
+		for(U32 i = 0; i < 1500; ++i)
+		{
+			buff[i] ^= 1;
+			ANKI_TEST_EXPECT_NEQ(computeHash(&buff[0], 1500), h);
+			buff[i] ^= 1;
+		}
+	}
+}
+
+ANKI_TEST(Util, HashBench)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	HighRezTimer timer;
+	const Array<U32, 4> sizes = {{8, 64, 256, 4096}};
+
+	DynamicArrayAuto<U8> buff(alloc);
+	buff.create(4096);
+	for(U32 i = 0; i < buff.getSize(); ++i)
+	{
+		buff[i] = U8(rand());
+	}
+
+	for(U32 size : sizes)
+	{
+		const U32 iterationCount = (64 * 1024 * 1024) / size;
+		U64 h = 0; // To avoid compiler opts
+
+		timer.start();
+		for(U32 i = 0; i < iterationCount; ++i)
+		{
+			h += computeHash(HashVersion::MURMUR2, &buff[0], size, i);
+		}
+		timer.stop();
+		const Second murmurTime = timer.getElapsedTime();
+
+		timer.start();
+		for(U32 i = 0; i < iterationCount; ++i)
+		{
+			h += computeHash(HashVersion::XXH3, &buff[0], size, i);
+		}
+		timer.stop();
+		const Second xxh3Time = timer.getElapsedTime();
+
+		ANKI_TEST_LOGI("Hash bench (size %u): MURMUR2 %f XXH3 %f | %f%% (%lu)",
+			size,
+			murmurTime,
+			xxh3Time,
+			murmurTime / xxh3Time * 100.0,
+			h);
+	}
+}
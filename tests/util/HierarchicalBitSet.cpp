@@ -0,0 +1,176 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/util/HierarchicalBitSet.h>
+#include <anki/util/HighRezTimer.h>
+#include <vector>
+
+using namespace anki;
+
+static void randomBits(HierarchicalBitSet& bitset, std::vector<Bool>& ref, U32 oneIn)
+{
+	for(U32 bit = 0; bit < bitset.getSize(); ++bit)
+	{
+		const Bool set = (rand() % oneIn) == 0;
+		bitset.set(bit, set);
+		ref[bit] = set;
+	}
+}
+
+static void checkBits(const HierarchicalBitSet& bitset, const std::vector<Bool>& ref)
+{
+	U32 count = 0;
+	U32 first = MAX_U32;
+	for(U32 bit = 0; bit < bitset.getSize(); ++bit)
+	{
+		ANKI_TEST_EXPECT_EQ(bitset.get(bit), ref[bit]);
+		if(ref[bit])
+		{
+			first = min(first, bit);
+			++count;
+		}
+	}
+
+	ANKI_TEST_EXPECT_EQ(bitset.getEnabledBitCount(), count);
+	ANKI_TEST_EXPECT_EQ(bitset.getAny(), count > 0);
+	ANKI_TEST_EXPECT_EQ(bitset.findFirstSet(), first);
+
+	// Iterate both ways
+	U32 prev = MAX_U32;
+	U32 iterated = 0;
+	for(U32 bit = bitset.findFirstSet(); bit != MAX_U32; bit = bitset.findFirstSet(bit + 1))
+	{
+		ANKI_TEST_EXPECT_EQ(ref[bit], true);
+		ANKI_TEST_EXPECT_EQ(prev == MAX_U32 || prev < bit, true);
+		prev = bit;
+		++iterated;
+	}
+	ANKI_TEST_EXPECT_EQ(iterated, count);
+
+	iterated = 0;
+	bitset.iterateSetBits([&](U32 bit) {
+		ANKI_TEST_EXPECT_EQ(ref[bit], true);
+		++iterated;
+	});
+	ANKI_TEST_EXPECT_EQ(iterated, count);
+}
+
+ANKI_TEST(Util, HierarchicalBitSet)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	for(U32 size : {1u, 63u, 64u, 65u, 130u, 4096u, 4097u, 100000u})
+	{
+		HierarchicalBitSet a;
+		HierarchicalBitSet b;
+		a.create(alloc, size);
+		b.create(alloc, size);
+		std::vector<Bool> refA(size, false);
+		std::vector<Bool> refB(size, false);
+
+		checkBits(a, refA);
+
+		// Single bits
+		a.set(size - 1);
+		refA[size - 1] = true;
+		checkBits(a, refA);
+		a.unset(size - 1);
+		refA[size - 1] = false;
+		checkBits(a, refA);
+
+		for(U32 oneIn : {1u, 2u, 50u, 5000u})
+		{
+			randomBits(a, refA, oneIn);
+			randomBits(b, refB, oneIn * 2);
+			checkBits(a, refA);
+
+			a.orWith(b);
+			for(U32 i = 0; i < size; ++i)
+			{
+				refA[i] = refA[i] || refB[i];
+			}
+			checkBits(a, refA);
+
+			randomBits(b, refB, 3);
+			a.andWith(b);
+			for(U32 i = 0; i < size; ++i)
+			{
+				refA[i] = refA[i] && refB[i];
+			}
+			checkBits(a, refA);
+		}
+
+		a.unsetAll();
+		std::fill(refA.begin(), refA.end(), false);
+		checkBits(a, refA);
+
+		a.destroy(alloc);
+		b.destroy(alloc);
+	}
+}
+
+ANKI_TEST(Util, HierarchicalBitSetBench)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	const U32 size = 128 * 1024;
+	const U32 iterationCount = 200;
+
+	HierarchicalBitSet a;
+	HierarchicalBitSet b;
+	a.create(alloc, size);
+	b.create(alloc, size);
+	std::vector<Bool> flat(size, false);
+
+	// Sparse, like the visibility results of a big scene
+	for(U32 i = 0; i < size; i += 97)
+	{
+		a.set(i);
+		b.set(i);
+		flat[i] = true;
+	}
+
+	HighRezTimer timer;
+	U64 sum = 0; // To avoid compiler opts
+
+	timer.start();
+	for(U32 i = 0; i < iterationCount; ++i)
+	{
+		for(U32 bit = 0; bit < size; ++bit)
+		{
+			sum += (flat[bit]) ? bit : 0;
+		}
+	}
+	timer.stop();
+	const Second flatTime = timer.getElapsedTime();
+
+	timer.start();
+	for(U32 i = 0; i < iterationCount; ++i)
+	{
+		a.iterateSetBits([&](U32 bit) {
+			sum += bit;
+		});
+	}
+	timer.stop();
+	const Second iterateTime = timer.getElapsedTime();
+
+	timer.start();
+	for(U32 i = 0; i < iterationCount; ++i)
+	{
+		a.andWith(b);
+		a.orWith(b);
+	}
+	timer.stop();
+	const Second combineTime = timer.getElapsedTime();
+
+	ANKI_TEST_LOGI("HierarchicalBitSet bench: flat iterate %f, iterate %f, and+or %f (%lu)",
+		flatTime,
+		iterateTime,
+		combineTime,
+		sum);
+
+	a.destroy(alloc);
+	b.destroy(alloc);
+}
@@ -27,3 +27,17 @@ ANKI_TEST(Util, Test)
 
 	ANKI_TEST_EXPECT_NEAR(t.getElapsedTime(), 4.0, 0.2);
 }
+
+ANKI_TEST(Util, PreciseSleep)
+{
+	for(U32 i = 0; i < 10; ++i)
+	{
+		const Second start = HighRezTimer::getCurrentTime();
+		HighRezTimer::preciseSleep(0.005);
+		ANKI_TEST_EXPECT_NEAR(HighRezTimer::getCurrentTime() - start, 0.005, 0.002);
+	}
+
+	const Second deadline = HighRezTimer::getCurrentTime() + 0.01;
+	HighRezTimer::sleepUntil(deadline);
+	ANKI_TEST_EXPECT_GEQ(HighRezTimer::getCurrentTime(), deadline);
+}
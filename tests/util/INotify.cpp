@@ -36,4 +36,49 @@ ANKI_TEST(Util, INotify)
 
 		ANKI_TEST_EXPECT_NO_ERR(removeDirectory(dir, alloc));
 	}
+
+	// Get the changed files of a directory tree
+	{
+		CString dir = "in_test_dir2";
+
+		ANKI_TEST_EXPECT_NO_ERR(createDirectory(dir));
+		ANKI_TEST_EXPECT_NO_ERR(createDirectory("in_test_dir2/sub"));
+
+		{
+			INotify in;
+			ANKI_TEST_EXPECT_NO_ERR(in.init(alloc, dir, true));
+
+			StringListAuto changed(alloc);
+			ANKI_TEST_EXPECT_NO_ERR(in.pollEvents(changed));
+			ANKI_TEST_EXPECT_EQ(changed.isEmpty(), true);
+
+			for(CString fname : {CString("in_test_dir2/a.txt"), CString("in_test_dir2/sub/b.txt")})
+			{
+				File file;
+				ANKI_TEST_EXPECT_NO_ERR(file.open(fname, FileOpenFlag::WRITE));
+				ANKI_TEST_EXPECT_NO_ERR(file.writeText("%s", "blah"));
+			}
+
+			// Many events in one read
+			ANKI_TEST_EXPECT_NO_ERR(in.pollEvents(changed));
+			ANKI_TEST_EXPECT_GEQ(changed.getIndexOf("in_test_dir2/a.txt"), 0);
+			ANKI_TEST_EXPECT_GEQ(changed.getIndexOf("in_test_dir2/sub/b.txt"), 0);
+
+			// New directories are watched as well
+			changed.destroy();
+			ANKI_TEST_EXPECT_NO_ERR(createDirectory("in_test_dir2/sub2"));
+			ANKI_TEST_EXPECT_NO_ERR(in.pollEvents(changed));
+			ANKI_TEST_EXPECT_EQ(changed.isEmpty(), true);
+
+			{
+				File file;
+				ANKI_TEST_EXPECT_NO_ERR(file.open("in_test_dir2/sub2/c.txt", FileOpenFlag::WRITE));
+			}
+
+			ANKI_TEST_EXPECT_NO_ERR(in.pollEvents(changed));
+			ANKI_TEST_EXPECT_GEQ(changed.getIndexOf("in_test_dir2/sub2/c.txt"), 0);
+		}
+
+		ANKI_TEST_EXPECT_NO_ERR(removeDirectory(dir, alloc));
+	}
 }
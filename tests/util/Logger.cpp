@@ -0,0 +1,102 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include "tests/framework/Framework.h"
+#include "anki/util/Logger.h"
+#include "anki/util/Thread.h"
+#include <cstdlib>
+
+using namespace anki;
+
+namespace
+{
+
+class LogCounter
+{
+public:
+	static const U32 THREAD_COUNT = 4;
+	static const U32 MESSAGE_COUNT = 256;
+
+	Array<U32, THREAD_COUNT> m_nextMessage = {};
+	U32 m_count = 0;
+	Bool m_inOrder = true;
+	ThreadId m_handlerThread = 0;
+
+	static void callback(void* ud, const LoggerMessageInfo& info)
+	{
+		if(info.m_subsystem == nullptr || CString(info.m_subsystem) != "LOGTEST")
+		{
+			return;
+		}
+
+		LogCounter& self = *static_cast<LogCounter*>(ud);
+
+		// The messages are "<thread> <message>"
+		char* end;
+		const U32 threadIdx = U32(strtoul(info.m_msg, &end, 10));
+		const U32 msgIdx = U32(strtoul(end, nullptr, 10));
+
+		self.m_inOrder = self.m_inOrder && threadIdx < THREAD_COUNT && self.m_nextMessage[threadIdx] == msgIdx;
+		if(threadIdx < THREAD_COUNT)
+		{
+			self.m_nextMessage[threadIdx] = msgIdx + 1;
+		}
+
+		self.m_handlerThread = Thread::getCurrentThreadId();
+		++self.m_count;
+	}
+};
+
+class LogThreadContext
+{
+public:
+	U32 m_threadIdx;
+};
+
+} // end anonymous namespace
+
+ANKI_TEST(Util, LoggerAsync)
+{
+	Logger& logger = LoggerSingleton::get();
+	LogCounter counter;
+
+	logger.addMessageHandler(&counter, &LogCounter::callback);
+	logger.enableAsync(true);
+
+	Array<LogThreadContext, LogCounter::THREAD_COUNT> ctxs;
+	Array<Thread*, LogCounter::THREAD_COUNT> threads;
+	for(U32 i = 0; i < LogCounter::THREAD_COUNT; ++i)
+	{
+		ctxs[i].m_threadIdx = i;
+		threads[i] = new Thread("LogTest");
+		threads[i]->start(&ctxs[i], [](ThreadCallbackInfo& info) -> Error {
+			const U32 threadIdx = static_cast<LogThreadContext*>(info.m_userData)->m_threadIdx;
+			for(U32 m = 0; m < LogCounter::MESSAGE_COUNT; ++m)
+			{
+				ANKI_LOG("LOGTEST", NORMAL, "%u %u", threadIdx, m);
+			}
+			return Error::NONE;
+		});
+	}
+
+	for(Thread* thread : threads)
+	{
+		ANKI_TEST_EXPECT_NO_ERR(thread->join());
+		delete thread;
+	}
+
+	// Write the rest and stop the thread
+	logger.enableAsync(false);
+
+	ANKI_TEST_EXPECT_EQ(counter.m_count, LogCounter::THREAD_COUNT * LogCounter::MESSAGE_COUNT);
+	ANKI_TEST_EXPECT_EQ(counter.m_inOrder, true);
+	ANKI_TEST_EXPECT_NEQ(counter.m_handlerThread, Thread::getCurrentThreadId());
+
+	// Sync mode calls the handlers from the caller
+	ANKI_LOG("LOGTEST", NORMAL, "0 %u", LogCounter::MESSAGE_COUNT);
+	ANKI_TEST_EXPECT_EQ(counter.m_handlerThread, Thread::getCurrentThreadId());
+
+	logger.removeMessageHandler(&counter, &LogCounter::callback);
+}
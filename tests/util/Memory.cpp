@@ -7,6 +7,7 @@
 #include "tests/util/Foo.h"
 #include "anki/util/Memory.h"
 #include "anki/util/ThreadPool.h"
+#include "anki/util/DynamicArray.h"
 #include <type_traits>
 #include <cstring>
 
@@ -33,6 +34,243 @@ ANKI_TEST(Util, HeapMemoryPool)
 
 		pool.free(ptr);
 	}
+
+	// Thread caching
+	{
+		HeapMemoryPool pool;
+		pool.create(allocAligned, nullptr, true);
+		ANKI_TEST_EXPECT_EQ(pool.getThreadCaching(), true);
+
+		Array<PtrSize, 6> sizes = {{1, 16, 100, 1000, 4000, 100000}};
+		Array<void*, 6> ptrs;
+		for(U32 i = 0; i < sizes.getSize(); ++i)
+		{
+			ptrs[i] = pool.allocate(sizes[i], 16);
+			ANKI_TEST_EXPECT_NEQ(ptrs[i], nullptr);
+			ANKI_TEST_EXPECT_EQ(isAligned(16, ptrs[i]), true);
+			memset(ptrs[i], 0xAB, sizes[i]);
+		}
+
+		// Big alignment
+		void* aligned = pool.allocate(32, 256);
+		ANKI_TEST_EXPECT_EQ(isAligned(256, aligned), true);
+		pool.free(aligned);
+
+		for(void* ptr : ptrs)
+		{
+			pool.free(ptr);
+		}
+
+		// Freed blocks are reused
+		void* a = pool.allocate(100, 8);
+		pool.free(a);
+		void* b = pool.allocate(100, 8);
+		ANKI_TEST_EXPECT_EQ(a, b);
+		pool.free(b);
+
+		Array<HeapMemoryPoolSizeClassStats, HeapMemoryPool::SIZE_CLASS_COUNT> stats;
+		pool.getSizeClassStatistics(stats);
+		U64 allocCount = 0;
+		U64 freeCount = 0;
+		for(const HeapMemoryPoolSizeClassStats& stat : stats)
+		{
+			allocCount += stat.m_allocationCount;
+			freeCount += stat.m_freeCount;
+			ANKI_TEST_EXPECT_EQ(stat.m_remoteFreeCount, 0);
+		}
+
+		ANKI_TEST_EXPECT_EQ(allocCount, 7); // The 100000 and the aligned one bypass the caches
+		ANKI_TEST_EXPECT_EQ(freeCount, 7);
+	}
+
+	// Thread caching with frees from other threads
+	{
+		HeapMemoryPool pool;
+		pool.create(allocAligned, nullptr, true);
+
+		const U32 THREAD_COUNT = 4;
+		const U32 ALLOC_COUNT = 1000;
+		ThreadPool threadPool(THREAD_COUNT);
+
+		class Task : public ThreadPoolTask
+		{
+		public:
+			HeapMemoryPool* m_pool = nullptr;
+			Array<void*, ALLOC_COUNT> m_allocations;
+			Task* m_freeTask = nullptr; ///< Free the allocations of that task.
+			U32 m_magic = 0;
+
+			Error operator()(U32 taskId, PtrSize threadsCount)
+			{
+				if(m_freeTask == nullptr)
+				{
+					for(U32 i = 0; i < ALLOC_COUNT; ++i)
+					{
+						const PtrSize size = 4 + (i % 300);
+						U32* ptr = static_cast<U32*>(m_pool->allocate(size, 4));
+						*ptr = m_magic;
+						m_allocations[i] = ptr;
+					}
+				}
+				else
+				{
+					for(void* ptr : m_freeTask->m_allocations)
+					{
+						ANKI_TEST_EXPECT_EQ(*static_cast<U32*>(ptr), m_freeTask->m_magic);
+						m_pool->free(ptr);
+					}
+				}
+
+				return Error::NONE;
+			}
+		};
+
+		Array<Task, THREAD_COUNT> allocTasks;
+		Array<Task, THREAD_COUNT> freeTasks;
+		for(U32 i = 0; i < THREAD_COUNT; ++i)
+		{
+			allocTasks[i].m_pool = &pool;
+			allocTasks[i].m_magic = 0xF00 + i;
+			freeTasks[i].m_pool = &pool;
+			freeTasks[i].m_freeTask = &allocTasks[(i + 1) % THREAD_COUNT];
+		}
+
+		for(U32 iteration = 0; iteration < 3; ++iteration)
+		{
+			for(U32 i = 0; i < THREAD_COUNT; ++i)
+			{
+				threadPool.assignNewTask(i, &allocTasks[i]);
+			}
+			ANKI_TEST_EXPECT_NO_ERR(threadPool.waitForAllThreadsToFinish());
+
+			for(U32 i = 0; i < THREAD_COUNT; ++i)
+			{
+				threadPool.assignNewTask(i, &freeTasks[i]);
+			}
+			ANKI_TEST_EXPECT_NO_ERR(threadPool.waitForAllThreadsToFinish());
+		}
+
+		Array<HeapMemoryPoolSizeClassStats, HeapMemoryPool::SIZE_CLASS_COUNT> stats;
+		pool.getSizeClassStatistics(stats);
+		U64 allocCount = 0;
+		U64 freeCount = 0;
+		U64 remoteFreeCount = 0;
+		for(const HeapMemoryPoolSizeClassStats& stat : stats)
+		{
+			allocCount += stat.m_allocationCount;
+			freeCount += stat.m_freeCount;
+			remoteFreeCount += stat.m_remoteFreeCount;
+		}
+
+		ANKI_TEST_EXPECT_EQ(allocCount, THREAD_COUNT * ALLOC_COUNT * 3);
+		ANKI_TEST_EXPECT_EQ(freeCount, allocCount);
+		ANKI_TEST_EXPECT_EQ(remoteFreeCount, freeCount);
+	}
+
+	// Thread caching with threads that exit
+	{
+		HeapMemoryPool pool;
+		pool.create(allocAligned, nullptr, true);
+
+		const PtrSize SIZE = 100;
+		auto getSlabCount = [&]() {
+			Array<HeapMemoryPoolSizeClassStats, HeapMemoryPool::SIZE_CLASS_COUNT> stats;
+			pool.getSizeClassStatistics(stats);
+			for(const HeapMemoryPoolSizeClassStats& stat : stats)
+			{
+				if(SIZE <= stat.m_maxAllocationSize)
+				{
+					return stat.m_slabCount;
+				}
+			}
+
+			return 0u;
+		};
+
+		class Ctx
+		{
+		public:
+			HeapMemoryPool* m_pool;
+			void* m_ptr = nullptr;
+			DynamicArrayAuto<void*>* m_ptrsToFree = nullptr;
+		};
+
+		auto allocAndFree = [](ThreadCallbackInfo& info) -> Error {
+			Ctx& ctx = *static_cast<Ctx*>(info.m_userData);
+			ctx.m_ptr = ctx.m_pool->allocate(SIZE, 8);
+			ctx.m_pool->free(ctx.m_ptr);
+			return Error::NONE;
+		};
+
+		// A new thread adopts the cache of a thread that exited along with its free blocks
+		Ctx ctxA;
+		ctxA.m_pool = &pool;
+		Thread threadA("HeapPoolA");
+		threadA.start(&ctxA, allocAndFree);
+		ANKI_TEST_EXPECT_NO_ERR(threadA.join());
+
+		Ctx ctxB;
+		ctxB.m_pool = &pool;
+		Thread threadB("HeapPoolB");
+		threadB.start(&ctxB, allocAndFree);
+		ANKI_TEST_EXPECT_NO_ERR(threadB.join());
+
+		ANKI_TEST_EXPECT_EQ(ctxB.m_ptr, ctxA.m_ptr);
+		ANKI_TEST_EXPECT_EQ(getSlabCount(), 1);
+
+		// Use all the blocks of this thread. Allocate until a new slab is needed and then the rest of the new slab
+		HeapAllocator<U8> alloc(allocAligned, nullptr);
+		DynamicArrayAuto<void*> ptrs(alloc);
+		U32 blocksPerSlab = 0;
+		const U32 firstSlabCount = getSlabCount();
+		while(getSlabCount() == firstSlabCount)
+		{
+			ptrs.emplaceBack(pool.allocate(SIZE, 8));
+			++blocksPerSlab;
+		}
+
+		--blocksPerSlab;
+		for(U32 i = 1; i < blocksPerSlab; ++i)
+		{
+			ptrs.emplaceBack(pool.allocate(SIZE, 8));
+		}
+
+		// A thread frees fewer blocks than a batch and exits. The blocks should come back
+		const U32 REMOTE_FREE_COUNT = 8;
+		DynamicArrayAuto<void*> ptrsToFree(alloc);
+		for(U32 i = 0; i < REMOTE_FREE_COUNT; ++i)
+		{
+			ptrsToFree.emplaceBack(ptrs.getBack());
+			ptrs.popBack();
+		}
+
+		Ctx ctxC;
+		ctxC.m_pool = &pool;
+		ctxC.m_ptrsToFree = &ptrsToFree;
+		Thread threadC("HeapPoolC");
+		threadC.start(&ctxC, [](ThreadCallbackInfo& info) -> Error {
+			Ctx& ctx = *static_cast<Ctx*>(info.m_userData);
+			for(void* ptr : *ctx.m_ptrsToFree)
+			{
+				ctx.m_pool->free(ptr);
+			}
+			return Error::NONE;
+		});
+		ANKI_TEST_EXPECT_NO_ERR(threadC.join());
+
+		const U32 slabCount = getSlabCount();
+		for(U32 i = 0; i < REMOTE_FREE_COUNT; ++i)
+		{
+			ptrs.emplaceBack(pool.allocate(SIZE, 8));
+		}
+
+		ANKI_TEST_EXPECT_EQ(getSlabCount(), slabCount);
+
+		for(void* ptr : ptrs)
+		{
+			pool.free(ptr);
+		}
+	}
 }
 
 ANKI_TEST(Util, StackMemoryPool)
@@ -90,6 +328,45 @@ ANKI_TEST(Util, StackMemoryPool)
 		ANKI_TEST_EXPECT_EQ(pool.getAllocationsCount(), 4);
 	}
 
+	// Chunk cache
+	{
+		StackMemoryPool pool;
+		pool.create(allocAligned, nullptr, 64, 2.0, 0, true, 16);
+		ANKI_TEST_EXPECT_EQ(pool.getChunkCount(), 1);
+		ANKI_TEST_EXPECT_EQ(pool.getGrowFrameCount(), 0);
+
+		// A heavy frame
+		for(U i = 0; i < 10; ++i)
+		{
+			ANKI_TEST_EXPECT_NEQ(pool.allocate(32, 16), nullptr);
+		}
+		const U32 chunkCount = pool.getChunkCount();
+		ANKI_TEST_EXPECT_GT(chunkCount, 1);
+		pool.reset();
+		ANKI_TEST_EXPECT_EQ(pool.getGrowFrameCount(), 1);
+
+		// Same frame again shouldn't grow
+		for(U f = 0; f < 3; ++f)
+		{
+			for(U i = 0; i < 10; ++i)
+			{
+				ANKI_TEST_EXPECT_NEQ(pool.allocate(32, 16), nullptr);
+			}
+			pool.reset();
+		}
+		ANKI_TEST_EXPECT_EQ(pool.getChunkCount(), chunkCount);
+		ANKI_TEST_EXPECT_EQ(pool.getGrowFrameCount(), 1);
+
+		// A heavier one
+		for(U i = 0; i < 100; ++i)
+		{
+			ANKI_TEST_EXPECT_NEQ(pool.allocate(32, 16), nullptr);
+		}
+		pool.reset();
+		ANKI_TEST_EXPECT_GT(pool.getChunkCount(), chunkCount);
+		ANKI_TEST_EXPECT_EQ(pool.getGrowFrameCount(), 2);
+	}
+
 	// Parallel
 	{
 		StackMemoryPool pool;
@@ -218,3 +495,37 @@ ANKI_TEST(Util, ChainMemoryPool)
 		ANKI_TEST_EXPECT_EQ(pool.getChunksCount(), 0);
 	}
 }
+
+ANKI_TEST(Util, MemoryTagTracker)
+{
+	MemoryTagTracker tracker;
+	tracker.init(allocAligned, nullptr);
+
+	HeapMemoryPool scenePool;
+	scenePool.create(
+		MemoryTagTracker::getAllocationCallback(), tracker.getAllocationCallbackUserData(MemoryTag::SCENE));
+	HeapMemoryPool grPool;
+	grPool.create(MemoryTagTracker::getAllocationCallback(), tracker.getAllocationCallbackUserData(MemoryTag::GR));
+
+	void* a = scenePool.allocate(100, 16);
+	void* b = scenePool.allocate(200, 64);
+	void* c = grPool.allocate(1000, 8);
+	ANKI_TEST_EXPECT_EQ(isAligned(64, b), true);
+
+	Array<MemoryTagStats, U32(MemoryTag::COUNT)> stats;
+	tracker.getSnapshot(stats);
+	ANKI_TEST_EXPECT_GEQ(stats[U32(MemoryTag::SCENE)].m_liveBytes, 300);
+	ANKI_TEST_EXPECT_EQ(stats[U32(MemoryTag::SCENE)].m_allocationCount, 2);
+	ANKI_TEST_EXPECT_GEQ(stats[U32(MemoryTag::GR)].m_liveBytes, 1000);
+	ANKI_TEST_EXPECT_EQ(stats[U32(MemoryTag::RENDERER)].m_liveBytes, 0);
+
+	scenePool.free(a);
+	scenePool.free(b);
+	grPool.free(c);
+
+	tracker.getSnapshot(stats);
+	ANKI_TEST_EXPECT_EQ(stats[U32(MemoryTag::SCENE)].m_liveBytes, 0);
+	ANKI_TEST_EXPECT_GEQ(stats[U32(MemoryTag::SCENE)].m_peakBytes, 300);
+	ANKI_TEST_EXPECT_EQ(stats[U32(MemoryTag::SCENE)].m_freeCount, 2);
+	ANKI_TEST_EXPECT_EQ(tracker.getTotal().m_liveBytes, 0);
+}
@@ -0,0 +1,170 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/util/ObjectAllocator.h>
+#include <anki/util/Functions.h>
+#include <vector>
+
+namespace anki
+{
+namespace
+{
+
+static I32 liveObjects = 0;
+
+class OABase
+{
+public:
+	U32 m_value;
+
+	OABase(U32 value)
+		: m_value(value)
+	{
+		++liveObjects;
+	}
+
+	virtual ~OABase()
+	{
+		--liveObjects;
+	}
+};
+
+class OASmall : public OABase
+{
+public:
+	using OABase::OABase;
+};
+
+class alignas(64) OALarge : public OABase
+{
+public:
+	Array<U8, 200> m_payload;
+
+	OALarge(U32 value)
+		: OABase(value)
+	{
+		m_payload[0] = U8(value);
+	}
+};
+
+} // end anonymous namespace
+
+ANKI_TEST(Util, ObjectAllocator)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	// Same type
+	{
+		ObjectAllocatorSameType<OASmall, 8> oa;
+		std::vector<OASmall*> objs;
+		for(U32 i = 0; i < 20; ++i)
+		{
+			objs.push_back(oa.newInstance(alloc, i));
+		}
+
+		ObjectAllocatorStatistics stats = oa.getStatistics();
+		ANKI_TEST_EXPECT_EQ(stats.m_liveCount, 20);
+		ANKI_TEST_EXPECT_EQ(stats.m_peakCount, 20);
+		ANKI_TEST_EXPECT_EQ(stats.m_chunkCount, 3);
+
+		for(U32 i = 0; i < 10; ++i)
+		{
+			oa.deleteInstance(alloc, objs[i]);
+		}
+
+		stats = oa.getStatistics();
+		ANKI_TEST_EXPECT_EQ(stats.m_liveCount, 10);
+		ANKI_TEST_EXPECT_EQ(stats.m_peakCount, 20);
+		ANKI_TEST_EXPECT_EQ(stats.m_chunkCount, 2);
+
+		for(U32 i = 10; i < 20; ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(objs[i]->m_value, i);
+			oa.deleteInstance(alloc, objs[i]);
+		}
+
+		ANKI_TEST_EXPECT_EQ(oa.getStatistics().m_chunkCount, 0);
+		ANKI_TEST_EXPECT_EQ(liveObjects, 0);
+	}
+
+	// Typed
+	{
+		TypedObjectAllocator<16> oa;
+		std::vector<OABase*> objs;
+		for(U32 i = 0; i < 100; ++i)
+		{
+			if(i % 3)
+			{
+				objs.push_back(oa.newInstance<OASmall>(alloc, i));
+			}
+			else
+			{
+				OALarge* large = oa.newInstance<OALarge>(alloc, i);
+				ANKI_TEST_EXPECT_EQ(isAligned(64, large), true);
+				objs.push_back(large);
+			}
+		}
+
+		ObjectAllocatorStatistics small = oa.getStatistics<OASmall>();
+		ObjectAllocatorStatistics large = oa.getStatistics<OALarge>();
+		ANKI_TEST_EXPECT_EQ(small.m_liveCount, 66);
+		ANKI_TEST_EXPECT_EQ(small.m_chunkCount, 5);
+		ANKI_TEST_EXPECT_EQ(large.m_liveCount, 34);
+		ANKI_TEST_EXPECT_EQ(large.m_chunkCount, 3);
+		ANKI_TEST_EXPECT_GEQ(large.m_objectSize, sizeof(OALarge));
+		ANKI_TEST_EXPECT_EQ(liveObjects, 100);
+
+		// The same type is packed together
+		for(U32 i = 1; i < 16; ++i)
+		{
+			const PtrSize dist = ptrToNumber(objs[i + 1]) - ptrToNumber(objs[i]);
+			if(i % 3 == 1)
+			{
+				ANKI_TEST_EXPECT_EQ(dist, small.m_objectSize);
+			}
+		}
+
+		// Delete through the base class
+		for(U32 i = 0; i < U32(objs.size()); i += 2)
+		{
+			oa.deleteInstance(alloc, objs[i]);
+			objs[i] = nullptr;
+		}
+
+		small = oa.getStatistics<OASmall>();
+		ANKI_TEST_EXPECT_EQ(small.m_liveCount, 33);
+		ANKI_TEST_EXPECT_EQ(small.m_peakCount, 66);
+		ANKI_TEST_EXPECT_GT(small.getFragmentation(), 0.0f);
+
+		// Reuse the deleted slots
+		for(U32 i = 0; i < U32(objs.size()); i += 2)
+		{
+			objs[i] = oa.newInstance<OASmall>(alloc, i);
+		}
+
+		small = oa.getStatistics<OASmall>();
+		ANKI_TEST_EXPECT_EQ(small.m_liveCount, 83);
+		ANKI_TEST_EXPECT_EQ(small.m_peakCount, 83);
+
+		U32 typeCount = 0;
+		oa.iterateStatistics([&](const ObjectAllocatorStatistics&) {
+			++typeCount;
+		});
+		ANKI_TEST_EXPECT_EQ(typeCount, 2);
+
+		for(U32 i = 0; i < U32(objs.size()); ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(objs[i]->m_value, i);
+			oa.deleteInstance(alloc, objs[i]);
+		}
+
+		ANKI_TEST_EXPECT_EQ(liveObjects, 0);
+		ANKI_TEST_EXPECT_EQ(oa.getStatistics<OASmall>().m_chunkCount, 1);
+		oa.destroy(alloc);
+	}
+}
+
+} // end namespace anki
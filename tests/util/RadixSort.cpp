@@ -0,0 +1,84 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/util/RadixSort.h>
+#include <anki/util/DynamicArray.h>
+#include <algorithm>
+#include <vector>
+
+using namespace anki;
+
+namespace
+{
+
+class KeyValue
+{
+public:
+	U64 m_key;
+	U32 m_value;
+};
+
+} // end namespace
+
+ANKI_TEST(Util, RadixSort)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	// Empty and single element
+	{
+		WeakArray<KeyValue> empty;
+		WeakArray<KeyValue> sorted = radixSort(empty, empty, [](const KeyValue& kv) { return kv.m_key; });
+		ANKI_TEST_EXPECT_EQ(sorted.getSize(), 0);
+	}
+
+	// Fuzzy against the stable sort of the STL. Use small and big keys to test the skipped passes
+	for(U32 mode = 0; mode < 3; ++mode)
+	{
+		const U32 count = 1000 + rand() % 1000;
+
+		DynamicArrayAuto<KeyValue> arr(alloc);
+		DynamicArrayAuto<KeyValue> tmp(alloc);
+		arr.create(count);
+		tmp.create(count);
+
+		std::vector<KeyValue> stlArr;
+		for(U32 i = 0; i < count; ++i)
+		{
+			U64 key;
+			if(mode == 0)
+			{
+				key = rand() % 16;
+			}
+			else if(mode == 1)
+			{
+				key = U64(rand()) << 40u;
+			}
+			else
+			{
+				key = (U64(rand()) << 32u) | U64(rand());
+			}
+
+			arr[i].m_key = key;
+			arr[i].m_value = i;
+			stlArr.push_back(arr[i]);
+		}
+
+		std::stable_sort(stlArr.begin(), stlArr.end(), [](const KeyValue& a, const KeyValue& b) {
+			return a.m_key < b.m_key;
+		});
+
+		const WeakArray<KeyValue> sorted = radixSort(WeakArray<KeyValue>(&arr[0], count),
+			WeakArray<KeyValue>(&tmp[0], count),
+			[](const KeyValue& kv) { return kv.m_key; });
+
+		ANKI_TEST_EXPECT_EQ(sorted.getSize(), count);
+		for(U32 i = 0; i < count; ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(sorted[i].m_key, stlArr[i].m_key);
+			ANKI_TEST_EXPECT_EQ(sorted[i].m_value, stlArr[i].m_value);
+		}
+	}
+}
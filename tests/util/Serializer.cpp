@@ -67,3 +67,69 @@ ANKI_TEST(Util, BinarySerializer)
 		alloc.deleteInstance(pa);
 	}
 }
+
+ANKI_TEST(Util, BinarySerializerInPlace)
+{
+	Array<U32, 3> bDarr = {{1, 2, 3}};
+	Array<ClassB, 2> b = {};
+	b[0].m_array[2] = 42;
+	b[1].m_darray = bDarr;
+
+	ClassA a = {};
+	a.m_u32 = 321;
+	a.m_darray = b;
+
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	// Serialize
+	{
+		File file;
+		ANKI_TEST_EXPECT_NO_ERR(file.open("serialized_in_place.bin", FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+		BinarySerializer serializer;
+		ANKI_TEST_EXPECT_NO_ERR(serializer.serialize(a, alloc, file));
+	}
+
+	// Read the whole file
+	File file;
+	ANKI_TEST_EXPECT_NO_ERR(file.open("serialized_in_place.bin", FileOpenFlag::READ | FileOpenFlag::BINARY));
+	const PtrSize size = file.getSize();
+	U8* data = static_cast<U8*>(alloc.getMemoryPool().allocate(size, ANKI_SAFE_ALIGNMENT));
+	U8* corrupt = static_cast<U8*>(alloc.getMemoryPool().allocate(size, ANKI_SAFE_ALIGNMENT));
+	ANKI_TEST_EXPECT_NO_ERR(file.read(data, size));
+
+	// Validate
+	ANKI_TEST_EXPECT_NO_ERR(BinaryDeserializer::validate<ClassA>(ConstWeakArray<U8, PtrSize>(data, size)));
+	ANKI_TEST_EXPECT_ERR(
+		BinaryDeserializer::validate<ClassA>(ConstWeakArray<U8, PtrSize>(data, size - 1)), Error::USER_DATA);
+
+	// Corrupt every byte of the data and the pointers. It shouldn't crash when validating
+	const PtrSize headerSize = sizeof(detail::BinarySerializerHeader);
+	for(PtrSize i = headerSize; i < size; ++i)
+	{
+		memcpy(corrupt, data, size);
+		corrupt[i] ^= 0xF0;
+		const Error err = BinaryDeserializer::validate<ClassA>(ConstWeakArray<U8, PtrSize>(corrupt, size));
+		(void)err;
+	}
+
+	// Make the pointer of ClassA::m_darray point to the root
+	memcpy(corrupt, data, size);
+	const PtrSize zero = 0;
+	memcpy(corrupt + headerSize + offsetof(ClassA, m_darray), &zero, sizeof(zero));
+	ANKI_TEST_EXPECT_ERR(
+		BinaryDeserializer::validate<ClassA>(ConstWeakArray<U8, PtrSize>(corrupt, size)), Error::USER_DATA);
+
+	// Deserialize in place
+	ClassA* pa;
+	ANKI_TEST_EXPECT_NO_ERR(BinaryDeserializer::deserializeInPlace(WeakArray<U8, PtrSize>(data, size), pa));
+	ANKI_TEST_EXPECT_EQ(PtrSize(reinterpret_cast<U8*>(pa) - data), headerSize);
+	ANKI_TEST_EXPECT_EQ(pa->m_u32, 321);
+	ANKI_TEST_EXPECT_EQ(pa->m_darray.getSize(), 2);
+	ANKI_TEST_EXPECT_EQ(pa->m_darray[0].m_array[2], 42);
+	ANKI_TEST_EXPECT_EQ(pa->m_darray[0].m_darray.getSize(), 0);
+	ANKI_TEST_EXPECT_EQ(pa->m_darray[1].m_darray.getSize(), 3);
+	ANKI_TEST_EXPECT_EQ(pa->m_darray[1].m_darray[2], 3);
+
+	alloc.getMemoryPool().free(corrupt);
+	alloc.getMemoryPool().free(data);
+}
@@ -143,6 +143,34 @@ ANKI_TEST(Util, SparseArray)
 		SAFoo::checkCalls();
 	}
 
+	// Probe chains that wrap around the end of the storage
+	{
+		SparseArray<SAFoo, U32> arr(16, 8);
+
+		for(U32 i = 0; i < 6; ++i)
+		{
+			arr.emplace(alloc, 16 * i + 14, I32(i));
+		}
+		arr.validate();
+
+		for(U32 i = 0; i < 6; ++i)
+		{
+			auto it = arr.find(16 * i + 14);
+			ANKI_TEST_EXPECT_NEQ(it, arr.getEnd());
+			ANKI_TEST_EXPECT_EQ(it->m_x, I32(i));
+		}
+		ANKI_TEST_EXPECT_EQ(arr.find(16 * 6 + 14), arr.getEnd());
+
+		// Erase from the middle of the chain and check that the rest got shifted back
+		arr.erase(alloc, arr.find(16 * 1 + 14));
+		arr.validate();
+		ANKI_TEST_EXPECT_EQ(arr.find(16 * 1 + 14), arr.getEnd());
+		ANKI_TEST_EXPECT_EQ(arr.find(16 * 5 + 14)->m_x, 5);
+
+		arr.destroy(alloc);
+		SAFoo::checkCalls();
+	}
+
 	// Fuzzy test
 	{
 		const U MAX = 10000;
@@ -5,6 +5,8 @@
 
 #include "tests/framework/Framework.h"
 #include "anki/util/String.h"
+#include "anki/util/StringId.h"
+#include "anki/util/Thread.h"
 #include <string>
 
 namespace anki
@@ -230,6 +232,95 @@ ANKI_TEST(Util, String)
 		ANKI_TEST_EXPECT_EQ(a, "ajlkadsf");
 		a.destroy(alloc);
 	}
+
+	// Inline and heap storage
+	{
+		String a;
+		a.create(alloc, "0123456789abcd");
+		a.append(alloc, "e");
+		ANKI_TEST_EXPECT_EQ(a, "0123456789abcde");
+		a.append(alloc, "f");
+		ANKI_TEST_EXPECT_EQ(a, "0123456789abcdef");
+		a.append(alloc, a);
+		ANKI_TEST_EXPECT_EQ(a, "0123456789abcdef0123456789abcdef");
+		ANKI_TEST_EXPECT_EQ(a.getLength(), 32);
+
+		String b(std::move(a));
+		ANKI_TEST_EXPECT_EQ(a.isEmpty(), true);
+		ANKI_TEST_EXPECT_EQ(b, "0123456789abcdef0123456789abcdef");
+
+		a.create(alloc, 'x', 15);
+		String c(std::move(a));
+		ANKI_TEST_EXPECT_EQ(c, "xxxxxxxxxxxxxxx");
+		ANKI_TEST_EXPECT_EQ(c.computeHash(), anki::computeHash("xxxxxxxxxxxxxxx", 16));
+
+		b.destroy(alloc);
+		c.destroy(alloc);
+	}
+}
+
+ANKI_TEST(Util, StringId)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	const StringId a("foo");
+	StringAuto str(alloc);
+	str.sprintf("f%s", "oo");
+	const StringId b(str.toCString());
+	const StringId c("bar");
+
+	ANKI_TEST_EXPECT_EQ(a == b, true);
+	ANKI_TEST_EXPECT_EQ(a.toCString().cstr(), b.toCString().cstr());
+	ANKI_TEST_EXPECT_EQ(a != c, true);
+	ANKI_TEST_EXPECT_EQ(a.computeHash(), CString("foo").computeHash());
+	ANKI_TEST_EXPECT_EQ(c.toCString(), "bar");
+
+	ANKI_TEST_EXPECT_EQ(StringId().isEmpty(), true);
+	ANKI_TEST_EXPECT_EQ(StringId("").isEmpty(), true);
+	ANKI_TEST_EXPECT_EQ(StringId() == StringId(""), true);
+
+	// Lookups don't intern
+	ANKI_TEST_EXPECT_EQ(StringId::tryFind(str.toCString()) == a, true);
+	ANKI_TEST_EXPECT_EQ(StringId::tryFind("stringid_test_never_interned").isEmpty(), true);
+	ANKI_TEST_EXPECT_EQ(StringId::tryFind("stringid_test_never_interned").isEmpty(), true);
+	ANKI_TEST_EXPECT_EQ(StringId::tryFind("").isEmpty(), true);
+
+	// Intern from many threads
+	Array<Thread*, 4> threads;
+	Array<Array<StringId, 64>, 4> ids;
+	for(U32 i = 0; i < threads.getSize(); ++i)
+	{
+		threads[i] = new Thread("StringId");
+		threads[i]->start(&ids[i], [](ThreadCallbackInfo& info) -> Error {
+			Array<StringId, 64>& out = *static_cast<Array<StringId, 64>*>(info.m_userData);
+			for(U32 j = 0; j < out.getSize(); ++j)
+			{
+				Array<char, 32> name;
+				std::snprintf(&name[0], name.getSize(), "stringid_test_%u", j);
+				out[j] = StringId(&name[0]);
+			}
+			return Error::NONE;
+		});
+	}
+
+	for(Thread* thread : threads)
+	{
+		ANKI_TEST_EXPECT_NO_ERR(thread->join());
+		delete thread;
+	}
+
+	for(U32 j = 0; j < ids[0].getSize(); ++j)
+	{
+		for(U32 i = 1; i < threads.getSize(); ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(ids[i][j] == ids[0][j], true);
+		}
+
+		for(U32 k = 0; k < j; ++k)
+		{
+			ANKI_TEST_EXPECT_EQ(ids[0][j] != ids[0][k], true);
+		}
+	}
 }
 
 } // end namespace anki
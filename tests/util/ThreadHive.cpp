@@ -169,6 +169,271 @@ ANKI_TEST(Util, ThreadHive)
 	}
 }
 
+class ThreadHiveStealTestContext
+{
+public:
+	Atomic<U32> m_taskCount = {0};
+	Atomic<U32> m_threadMask = {0};
+	U32 m_spawningThread = MAX_U32;
+};
+
+static void stolenTask(void* arg, U32 threadId, ThreadHive& hive, ThreadHiveSemaphore* sem)
+{
+	ThreadHiveStealTestContext* ctx = static_cast<ThreadHiveStealTestContext*>(arg);
+	ctx->m_threadMask.fetchOr(1u << threadId);
+	ctx->m_taskCount.fetchAdd(1);
+}
+
+static void spawningTask(void* arg, U32 threadId, ThreadHive& hive, ThreadHiveSemaphore* sem)
+{
+	ThreadHiveStealTestContext* ctx = static_cast<ThreadHiveStealTestContext*>(arg);
+	ctx->m_spawningThread = threadId;
+
+	// The tasks go to the local queue. Block this thread so the other threads have to steal them
+	Array<ThreadHiveTask, 64> tasks;
+	for(ThreadHiveTask& task : tasks)
+	{
+		task.m_callback = stolenTask;
+		task.m_argument = ctx;
+	}
+	hive.submitTasks(&tasks[0], tasks.getSize());
+
+	while(ctx->m_taskCount.load() < tasks.getSize())
+	{
+		HighRezTimer::sleep(0.001);
+	}
+}
+
+ANKI_TEST(Util, ThreadHiveWorkStealing)
+{
+	const U32 threadCount = 4;
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	ThreadHive hive(threadCount, alloc);
+
+	ThreadHiveStealTestContext ctx;
+	hive.submitTask(spawningTask, &ctx);
+	hive.waitAllTasks();
+
+	ANKI_TEST_EXPECT_EQ(ctx.m_taskCount.load(), 64);
+	ANKI_TEST_EXPECT_NEQ(ctx.m_threadMask.load(), 0);
+	ANKI_TEST_EXPECT_EQ(ctx.m_threadMask.load() & (1u << ctx.m_spawningThread), 0);
+}
+
+class ThreadHivePriorityTestContext
+{
+public:
+	Atomic<U32> m_go = {0};
+	Atomic<U32> m_order = {0};
+	Array<U32, 32> m_executionOrder;
+};
+
+class ThreadHivePriorityTestTask
+{
+public:
+	ThreadHivePriorityTestContext* m_ctx;
+	U32 m_taskIdx;
+};
+
+static void blockingTask(void* arg, U32 threadId, ThreadHive& hive, ThreadHiveSemaphore* sem)
+{
+	ThreadHivePriorityTestContext* ctx = static_cast<ThreadHivePriorityTestContext*>(arg);
+	while(ctx->m_go.load() == 0)
+	{
+		HighRezTimer::sleep(0.001);
+	}
+}
+
+static void recordOrderTask(void* arg, U32 threadId, ThreadHive& hive, ThreadHiveSemaphore* sem)
+{
+	ThreadHivePriorityTestTask* task = static_cast<ThreadHivePriorityTestTask*>(arg);
+	task->m_ctx->m_executionOrder[task->m_taskIdx] = task->m_ctx->m_order.fetchAdd(1);
+}
+
+ANKI_TEST(Util, ThreadHivePriorities)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	ThreadHive hive(1, alloc);
+
+	// Keep the only thread busy until all the tasks are submitted
+	ThreadHivePriorityTestContext ctx;
+	hive.submitTask(blockingTask, &ctx);
+
+	// The first half are low priority and the second high
+	const U32 taskCount = ctx.m_executionOrder.getSize();
+	Array<ThreadHivePriorityTestTask, 32> testTasks;
+	Array<ThreadHiveTask, 32> tasks;
+	for(U32 i = 0; i < taskCount; ++i)
+	{
+		testTasks[i].m_ctx = &ctx;
+		testTasks[i].m_taskIdx = i;
+
+		tasks[i].m_callback = recordOrderTask;
+		tasks[i].m_argument = &testTasks[i];
+		tasks[i].m_priority = (i < taskCount / 2) ? ThreadHiveTaskPriority::LOW : ThreadHiveTaskPriority::HIGH;
+	}
+
+	hive.submitTasks(&tasks[0], taskCount);
+	ctx.m_go.store(1);
+	hive.waitAllTasks();
+
+	for(U32 i = 0; i < taskCount; ++i)
+	{
+		if(i < taskCount / 2)
+		{
+			ANKI_TEST_EXPECT_GEQ(ctx.m_executionOrder[i], taskCount / 2);
+		}
+		else
+		{
+			ANKI_TEST_EXPECT_LT(ctx.m_executionOrder[i], taskCount / 2);
+		}
+	}
+
+	ANKI_TEST_EXPECT_GT(hive.getTaskTime(ThreadHiveTaskPriority::NORMAL), 0.0);
+	hive.resetTaskTimes();
+	ANKI_TEST_EXPECT_EQ(hive.getTaskTime(ThreadHiveTaskPriority::NORMAL), 0.0);
+}
+
+ANKI_TEST(Util, ThreadHiveParallelFor)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	ThreadHive hive(4, alloc);
+
+	const U32 elementCount = 10007;
+	DynamicArrayAuto<U32> counts(alloc);
+	counts.create(elementCount, 0);
+
+	hive.parallelFor(elementCount, 16, [&](U32 begin, U32 end, U32 threadId) {
+		ANKI_TEST_EXPECT_LT(begin, end);
+		ANKI_TEST_EXPECT_LEQ(end, elementCount);
+		ANKI_TEST_EXPECT_LT(threadId, hive.getThreadCount());
+
+		for(U32 i = begin; i < end; ++i)
+		{
+			++counts[i];
+		}
+	});
+
+	for(U32 count : counts)
+	{
+		ANKI_TEST_EXPECT_EQ(count, 1);
+	}
+
+	// Reduce
+	const U64 sum = hive.parallelReduce(elementCount,
+		100,
+		U64(0),
+		[&](U32 begin, U32 end, U32 threadId, U64& threadSum) {
+			for(U32 i = begin; i < end; ++i)
+			{
+				threadSum += i;
+			}
+		},
+		[](U64 a, U64 b) { return a + b; });
+
+	ANKI_TEST_EXPECT_EQ(sum, U64(elementCount) * (elementCount - 1) / 2);
+
+	// Empty range
+	hive.parallelFor(0, 1, [&](U32 begin, U32 end, U32 threadId) { ANKI_TEST_EXPECT_EQ(0, 1); });
+
+	// It doesn't wait for unrelated tasks and more than one thread can call it
+	{
+		Atomic<U32> unrelatedTaskDone = {0};
+		hive.submitTask(
+			[](void* arg, U32, ThreadHive& hive, ThreadHiveSemaphore* sem) {
+				HighRezTimer::sleep(1.0);
+				static_cast<Atomic<U32>*>(arg)->store(1);
+			},
+			&unrelatedTaskDone);
+
+		class Ctx
+		{
+		public:
+			ThreadHive* m_hive;
+			Atomic<U32> m_count = {0};
+		} ctx;
+		ctx.m_hive = &hive;
+
+		Thread thread("ParallelFor");
+		thread.start(&ctx, [](ThreadCallbackInfo& info) -> Error {
+			Ctx& ctx = *static_cast<Ctx*>(info.m_userData);
+			ctx.m_hive->parallelFor(
+				elementCount, 16, [&](U32 begin, U32 end, U32 threadId) { ctx.m_count.fetchAdd(end - begin); });
+			return Error::NONE;
+		});
+		hive.parallelFor(
+			elementCount, 16, [&](U32 begin, U32 end, U32 threadId) { ctx.m_count.fetchAdd(end - begin); });
+		ANKI_TEST_EXPECT_NO_ERR(thread.join());
+
+		ANKI_TEST_EXPECT_EQ(ctx.m_count.load(), elementCount * 2);
+		ANKI_TEST_EXPECT_EQ(unrelatedTaskDone.load(), 0);
+
+		hive.waitAllTasks();
+		ANKI_TEST_EXPECT_EQ(unrelatedTaskDone.load(), 1);
+	}
+}
+
+ANKI_TEST(Util, ThreadHiveBigSubmit)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	ThreadHive hive(4, alloc);
+
+	Atomic<U32> count = {0};
+	DynamicArrayAuto<ThreadHiveTask> tasks(alloc);
+	tasks.create(ThreadHive::MAX_TASKS_PER_SUBMIT);
+	for(ThreadHiveTask& task : tasks)
+	{
+		task.m_callback = [](void* arg, U32, ThreadHive& hive, ThreadHiveSemaphore* sem) {
+			static_cast<Atomic<U32>*>(arg)->fetchAdd(1);
+		};
+		task.m_argument = &count;
+	}
+
+	// The biggest batch. Submit more than one to use more than one scratch chunk
+	for(U32 i = 0; i < 3; ++i)
+	{
+		hive.submitTasks(&tasks[0], tasks.getSize());
+	}
+	hive.waitAllTasks();
+
+	ANKI_TEST_EXPECT_EQ(count.load(), ThreadHive::MAX_TASKS_PER_SUBMIT * 3);
+}
+
+ANKI_TEST(Util, ThreadHiveManyPinnedThreads)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	// Topology
+	const U32 coreCount = getCpuTopology(nullptr, 0);
+	ANKI_TEST_EXPECT_GT(coreCount, 0);
+	DynamicArrayAuto<CpuCoreInfo> cores(alloc);
+	cores.create(coreCount);
+	ANKI_TEST_EXPECT_EQ(getCpuTopology(&cores[0], coreCount), coreCount);
+	for(U32 i = 1; i < coreCount; ++i)
+	{
+		ANKI_TEST_EXPECT_NEQ(cores[i].m_logicalCoreIdx, cores[i - 1].m_logicalCoreIdx);
+	}
+
+	// More threads than cores and more than the old limit of 32
+	const U32 threadCount = 40;
+	ThreadHive hive(threadCount, alloc, true);
+
+	Atomic<U32> threadMask[2] = {{0}, {0}};
+	hive.parallelFor(threadCount * 64, 1, [&](U32 begin, U32 end, U32 threadId) {
+		ANKI_TEST_EXPECT_LT(threadId, threadCount);
+		threadMask[threadId / 32].fetchOr(1u << (threadId % 32));
+		HighRezTimer::sleep(0.0001);
+	});
+
+	ANKI_TEST_EXPECT_NEQ(threadMask[0].load() | threadMask[1].load(), 0);
+
+	const U64 sum = hive.parallelReduce(threadCount * 10,
+		1,
+		U64(0),
+		[&](U32 begin, U32 end, U32 threadId, U64& threadSum) { threadSum += end - begin; },
+		[](U64 a, U64 b) { return a + b; });
+	ANKI_TEST_EXPECT_EQ(sum, threadCount * 10);
+}
+
 class FibTask
 {
 public:
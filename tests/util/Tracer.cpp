@@ -7,6 +7,7 @@
 #include <anki/util/Tracer.h>
 #include <anki/core/CoreTracer.h>
 #include <anki/util/HighRezTimer.h>
+#include <anki/util/Filesystem.h>
 
 #if ANKI_ENABLE_TRACE
 ANKI_TEST(Util, Tracer)
@@ -53,4 +54,189 @@ ANKI_TEST(Util, Tracer)
 	ANKI_TRACE_INC_COUNTER(COUNTER, 150);
 	tracer.flushFrame(4);
 }
+
+#	if ANKI_POSIX
+ANKI_TEST(Util, TracerBinary)
+{
+	setenv("ANKI_CORE_TRACER_BINARY", "1", 1);
+
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	const CString dir = "./tracer_binary";
+	if(directoryExists(dir))
+	{
+		ANKI_TEST_EXPECT_NO_ERR(removeDirectory(dir, alloc));
+	}
+	ANKI_TEST_EXPECT_NO_ERR(createDirectory(dir));
+
+	const U32 frameCount = 4;
+	const U32 eventCount = 20000;
+	const Second startTime = HighRezTimer::getCurrentTime();
+	{
+		CoreTracer tracer;
+		ANKI_TEST_EXPECT_NO_ERR(tracer.init(alloc, dir));
+		TracerSingleton::get().setEnabled(true);
+
+		// Enough events to fill more than one chunk
+		for(U32 frame = 0; frame < frameCount; ++frame)
+		{
+			for(U32 i = 0; i < eventCount; ++i)
+			{
+				ANKI_TRACE_CUSTOM_EVENT(EVENT, HighRezTimer::getCurrentTime(), 0.001);
+				ANKI_TRACE_CUSTOM_EVENT(EVENT2, HighRezTimer::getCurrentTime(), 0.002);
+			}
+
+			tracer.flushFrame(frame);
+		}
+	}
+	const Second endTime = HighRezTimer::getCurrentTime();
+
+	unsetenv("ANKI_CORE_TRACER_BINARY");
+
+	// Find the trace. Its name starts with the date
+	StringAuto traceFname(alloc);
+	ANKI_TEST_EXPECT_NO_ERR(walkDirectoryTree(dir, &traceFname, [](const CString& fname, void* ud, Bool isDir) -> Error {
+		if(!isDir && fname.find("trace.ankitrace") != CString::NPOS)
+		{
+			static_cast<StringAuto*>(ud)->sprintf("./tracer_binary/%s", fname.cstr());
+		}
+
+		return Error::NONE;
+	}));
+	ANKI_TEST_EXPECT_EQ(traceFname.isEmpty(), false);
+
+	// Decode it and check that it has what the tracer got
+	CoreTracerBinaryReader reader(alloc);
+	ANKI_TEST_EXPECT_NO_ERR(reader.open(traceFname));
+
+	Array<U32, 2> counts = {};
+	Array<U64, 2> durations = {{U64(0.001 * 1000000000.0), U64(0.002 * 1000000000.0)}};
+	while(true)
+	{
+		CoreTracerBinaryEvent event;
+		Bool done;
+		ANKI_TEST_EXPECT_NO_ERR(reader.readEvent(event, done));
+		if(done)
+		{
+			break;
+		}
+
+		const CString name = reader.getString(event.m_nameId);
+		ANKI_TEST_EXPECT_EQ(name == "EVENT" || name == "EVENT2", true);
+		const U32 idx = (name == "EVENT") ? 0 : 1;
+		++counts[idx];
+
+		ANKI_TEST_EXPECT_EQ(event.m_durationNs, durations[idx]);
+		ANKI_TEST_EXPECT_GEQ(event.m_startNs, U64(startTime * 1000000000.0));
+		ANKI_TEST_EXPECT_LEQ(event.m_startNs, U64(endTime * 1000000000.0));
+	}
+
+	ANKI_TEST_EXPECT_EQ(counts[0], frameCount * eventCount);
+	ANKI_TEST_EXPECT_EQ(counts[1], frameCount * eventCount);
+}
+#	endif
 #endif
+
+ANKI_TEST(Util, TracerRingBuffer)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	Tracer tracer(alloc);
+	tracer.setEnabled(true);
+	tracer.setRingBufferMode(100);
+	ANKI_TEST_EXPECT_EQ(tracer.getRingBufferMode(), true);
+
+	struct Ctx
+	{
+		U32 m_eventCount = 0;
+		Second m_minStart = MAX_SECOND;
+	};
+
+	auto callback = [](void* ud,
+						ThreadId tid,
+						ConstWeakArray<TracerEvent> events,
+						ConstWeakArray<TracerCounter> counters) {
+		Ctx& ctx = *static_cast<Ctx*>(ud);
+		ctx.m_eventCount += events.getSize();
+		ANKI_TEST_EXPECT_EQ(counters.getSize(), 0);
+		for(const TracerEvent& event : events)
+		{
+			ctx.m_minStart = min(ctx.m_minStart, event.m_start);
+		}
+	};
+
+	// 1st frame. Overflow the ring buffer
+	tracer.beginFrame();
+	for(U32 i = 0; i < 1000; ++i)
+	{
+		tracer.addCustomEvent("EVENT", HighRezTimer::getCurrentTime(), 0.5);
+	}
+	tracer.incrementCounter("COUNTER", 1);
+
+	Ctx ctx;
+	tracer.snapshotRingBuffers(1, callback, &ctx);
+	ANKI_TEST_EXPECT_EQ(ctx.m_eventCount, 127); // The size is 128 minus the one that might be being written
+
+	// Nothing to flush
+	ctx = Ctx();
+	tracer.flush(callback, &ctx);
+	ANKI_TEST_EXPECT_EQ(ctx.m_eventCount, 0);
+
+	// 2nd frame
+	tracer.beginFrame();
+	const Second frameStart = HighRezTimer::getCurrentTime();
+	for(U32 i = 0; i < 10; ++i)
+	{
+		tracer.addCustomEvent("EVENT2", HighRezTimer::getCurrentTime(), 0.5);
+	}
+
+	// Only the events of the last frame
+	ctx = Ctx();
+	tracer.snapshotRingBuffers(1, callback, &ctx);
+	ANKI_TEST_EXPECT_EQ(ctx.m_eventCount, 10);
+	ANKI_TEST_EXPECT_GEQ(ctx.m_minStart, frameStart);
+
+	// The snapshot doesn't consume the events
+	ctx = Ctx();
+	tracer.snapshotRingBuffers(2, callback, &ctx);
+	ANKI_TEST_EXPECT_EQ(ctx.m_eventCount, 127);
+
+	tracer.setRingBufferMode(0);
+	ANKI_TEST_EXPECT_EQ(tracer.getRingBufferMode(), false);
+}
+
+ANKI_TEST(Util, TracerGpuEvents)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	Tracer tracer(alloc);
+	tracer.setEnabled(true);
+
+	tracer.addGpuEvent("GPU_PASS", HighRezTimer::getCurrentTime(), 0.001);
+	tracer.addCustomEvent("CPU_EVENT", HighRezTimer::getCurrentTime(), 0.001);
+
+	struct Ctx
+	{
+		U32 m_gpuEventCount = 0;
+		U32 m_cpuEventCount = 0;
+	} ctx;
+
+	tracer.flush(
+		[](void* ud, ThreadId tid, ConstWeakArray<TracerEvent> events, ConstWeakArray<TracerCounter> counters) {
+			Ctx& ctx = *static_cast<Ctx*>(ud);
+			for(const TracerEvent& event : events)
+			{
+				if(tid == TRACER_GPU_THREAD_ID)
+				{
+					ANKI_TEST_EXPECT_EQ(event.m_name, "GPU_PASS");
+					++ctx.m_gpuEventCount;
+				}
+				else
+				{
+					ANKI_TEST_EXPECT_EQ(event.m_name, "CPU_EVENT");
+					++ctx.m_cpuEventCount;
+				}
+			}
+		},
+		&ctx);
+
+	ANKI_TEST_EXPECT_EQ(ctx.m_gpuEventCount, 1);
+	ANKI_TEST_EXPECT_EQ(ctx.m_cpuEventCount, 1);
+}
@@ -0,0 +1,494 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+// Benchmarks of the util containers, the memory pools, the ThreadHive and the Tracer. Every result is a line of the log
+// that looks like:
+// BENCH,<name>,<thread count>,<iteration count>,<average ms>,<min ms>
+// so the results of two runs can be diffed or fed into a script to catch regressions. Same as the scene benchmarks.
+
+#include <tests/framework/Framework.h>
+#include <anki/util/DynamicArray.h>
+#include <anki/util/HashMap.h>
+#include <anki/util/FlatHashMap.h>
+#include <anki/util/SparseArray.h>
+#include <anki/util/Memory.h>
+#include <anki/util/ThreadHive.h>
+#include <anki/util/Tracer.h>
+#include <anki/util/HighRezTimer.h>
+#include <anki/util/System.h>
+
+namespace anki
+{
+
+namespace
+{
+
+constexpr U32 CONTAINER_ELEMENT_COUNT = 256 * 1024;
+constexpr U32 ALLOCATION_COUNT = 256 * 1024;
+constexpr U32 TASK_COUNT = 64 * 1024;
+constexpr U32 TRACER_EVENT_COUNT = 256 * 1024;
+
+constexpr U32 WARMUP_ITERATION_COUNT = 2;
+constexpr U32 ITERATION_COUNT = 10;
+
+/// The thread counts to run the benchmarks with. Powers of two up to the core count.
+void getThreadCounts(DynamicArrayAuto<U32>& counts)
+{
+	const U32 coreCount = getCpuCoresCount();
+	for(U32 count = 1; count < coreCount; count *= 2)
+	{
+		counts.emplaceBack(count);
+	}
+	counts.emplaceBack(coreCount);
+}
+
+/// Unique keys that are scattered over the whole range. Multiplying with an odd number is a bijection.
+U64 getKey(U32 i)
+{
+	return U64(i) * 0x9E3779B97F4A7C15;
+}
+
+U32 getIndex(U32 i)
+{
+	return i * 2654435761u;
+}
+
+/// Run the insert, lookup, iterate and erase benchmarks of HashMap or FlatHashMap. They have the same interface.
+template<typename TMap>
+void benchMap(HeapAllocator<U8>& alloc, CString prefix)
+{
+	StringAuto insertName(alloc);
+	insertName.sprintf("%s_insert", prefix.cstr());
+	StringAuto findName(alloc);
+	findName.sprintf("%s_find", prefix.cstr());
+	StringAuto iterateName(alloc);
+	iterateName.sprintf("%s_iterate", prefix.cstr());
+	StringAuto eraseName(alloc);
+	eraseName.sprintf("%s_erase", prefix.cstr());
+
+	BenchTimer insertTimer(insertName.toCString(), 1);
+	BenchTimer findTimer(findName.toCString(), 1);
+	BenchTimer iterateTimer(iterateName.toCString(), 1);
+	BenchTimer eraseTimer(eraseName.toCString(), 1);
+
+	U64 sum = 0;
+	for(U32 it = 0; it < WARMUP_ITERATION_COUNT + ITERATION_COUNT; ++it)
+	{
+		const Bool measure = it >= WARMUP_ITERATION_COUNT;
+		TMap map;
+
+		if(measure)
+		{
+			insertTimer.begin();
+		}
+		for(U32 i = 0; i < CONTAINER_ELEMENT_COUNT; ++i)
+		{
+			map.emplace(alloc, getKey(i), U64(i));
+		}
+		if(measure)
+		{
+			insertTimer.end();
+		}
+
+		if(measure)
+		{
+			findTimer.begin();
+		}
+		for(U32 i = 0; i < CONTAINER_ELEMENT_COUNT; ++i)
+		{
+			// Half of the lookups miss
+			auto found = map.find(getKey(i ^ ((i & 1) << 31)));
+			sum += (found != map.getEnd()) ? *found : 0;
+		}
+		if(measure)
+		{
+			findTimer.end();
+		}
+
+		if(measure)
+		{
+			iterateTimer.begin();
+		}
+		for(U64 v : map)
+		{
+			sum += v;
+		}
+		if(measure)
+		{
+			iterateTimer.end();
+		}
+
+		if(measure)
+		{
+			eraseTimer.begin();
+		}
+		for(U32 i = 0; i < CONTAINER_ELEMENT_COUNT; ++i)
+		{
+			map.erase(alloc, map.find(getKey(i)));
+		}
+		if(measure)
+		{
+			eraseTimer.end();
+		}
+
+		ANKI_TEST_EXPECT_EQ(map.isEmpty(), true);
+		map.destroy(alloc);
+	}
+
+	ANKI_TEST_EXPECT_GT(sum, 0);
+}
+
+} // end anonymous namespace
+
+ANKI_TEST(Util, ContainersBench)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	// DynamicArray
+	{
+		BenchTimer pushTimer("DynamicArray_pushBack", 1);
+		BenchTimer iterateTimer("DynamicArray_iterate", 1);
+
+		U64 sum = 0;
+		for(U32 it = 0; it < WARMUP_ITERATION_COUNT + ITERATION_COUNT; ++it)
+		{
+			const Bool measure = it >= WARMUP_ITERATION_COUNT;
+			DynamicArrayAuto<U64> arr(alloc);
+
+			if(measure)
+			{
+				pushTimer.begin();
+			}
+			for(U32 i = 0; i < CONTAINER_ELEMENT_COUNT; ++i)
+			{
+				arr.emplaceBack(U64(i));
+			}
+			if(measure)
+			{
+				pushTimer.end();
+			}
+
+			if(measure)
+			{
+				iterateTimer.begin();
+			}
+			for(U64 v : arr)
+			{
+				sum += v;
+			}
+			if(measure)
+			{
+				iterateTimer.end();
+			}
+		}
+
+		ANKI_TEST_EXPECT_GT(sum, 0);
+	}
+
+	// Hash maps
+	benchMap<HashMap<U64, U64>>(alloc, "HashMap");
+	benchMap<FlatHashMap<U64, U64>>(alloc, "FlatHashMap");
+
+	// SparseArray
+	{
+		BenchTimer insertTimer("SparseArray_insert", 1);
+		BenchTimer findTimer("SparseArray_find", 1);
+		BenchTimer iterateTimer("SparseArray_iterate", 1);
+		BenchTimer eraseTimer("SparseArray_erase", 1);
+
+		U64 sum = 0;
+		for(U32 it = 0; it < WARMUP_ITERATION_COUNT + ITERATION_COUNT; ++it)
+		{
+			const Bool measure = it >= WARMUP_ITERATION_COUNT;
+			SparseArray<U64> arr;
+
+			if(measure)
+			{
+				insertTimer.begin();
+			}
+			for(U32 i = 0; i < CONTAINER_ELEMENT_COUNT; ++i)
+			{
+				arr.emplace(alloc, getIndex(i), U64(i));
+			}
+			if(measure)
+			{
+				insertTimer.end();
+			}
+
+			if(measure)
+			{
+				findTimer.begin();
+			}
+			for(U32 i = 0; i < CONTAINER_ELEMENT_COUNT; ++i)
+			{
+				auto found = arr.find(getIndex(i ^ ((i & 1) << 31)));
+				sum += (found != arr.getEnd()) ? *found : 0;
+			}
+			if(measure)
+			{
+				findTimer.end();
+			}
+
+			if(measure)
+			{
+				iterateTimer.begin();
+			}
+			for(U64 v : arr)
+			{
+				sum += v;
+			}
+			if(measure)
+			{
+				iterateTimer.end();
+			}
+
+			if(measure)
+			{
+				eraseTimer.begin();
+			}
+			for(U32 i = 0; i < CONTAINER_ELEMENT_COUNT; ++i)
+			{
+				arr.erase(alloc, arr.find(getIndex(i)));
+			}
+			if(measure)
+			{
+				eraseTimer.end();
+			}
+
+			ANKI_TEST_EXPECT_EQ(arr.getSize(), 0);
+			arr.destroy(alloc);
+		}
+
+		ANKI_TEST_EXPECT_GT(sum, 0);
+	}
+}
+
+ANKI_TEST(Util, MemoryPoolsBench)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	DynamicArrayAuto<U32> threadCounts(alloc);
+	getThreadCounts(threadCounts);
+
+	for(U32 threadCount : threadCounts)
+	{
+		ThreadHive hive(threadCount, alloc, true);
+
+		// Every thread allocates a batch and frees it in reverse, the same pool is shared by all threads
+		auto allocFree = [&](auto& pool, U32 threadId) {
+			constexpr U32 BATCH_SIZE = 64;
+			Array<void*, BATCH_SIZE> ptrs;
+			const U32 batchCount = ALLOCATION_COUNT / threadCount / BATCH_SIZE;
+			for(U32 b = 0; b < batchCount; ++b)
+			{
+				for(U32 i = 0; i < BATCH_SIZE; ++i)
+				{
+					ptrs[i] = pool.allocate(16 + ((i * 7 + threadId) % 16) * 16, 16);
+				}
+
+				for(U32 i = BATCH_SIZE; i > 0; --i)
+				{
+					pool.free(ptrs[i - 1]);
+				}
+			}
+		};
+
+		auto run = [&](auto& pool, BenchTimer& timer, auto endIteration) {
+			for(U32 it = 0; it < WARMUP_ITERATION_COUNT + ITERATION_COUNT; ++it)
+			{
+				const Bool measure = it >= WARMUP_ITERATION_COUNT;
+				if(measure)
+				{
+					timer.begin();
+				}
+				hive.parallelFor(threadCount, 1, [&](U32 begin, U32 end, U32 threadId) {
+					for(U32 i = begin; i < end; ++i)
+					{
+						allocFree(pool, i);
+					}
+				});
+				if(measure)
+				{
+					timer.end();
+				}
+
+				endIteration(pool);
+			}
+		};
+
+		{
+			HeapMemoryPool pool;
+			pool.create(allocAligned, nullptr);
+			BenchTimer timer("HeapMemoryPool", threadCount);
+			run(pool, timer, [](HeapMemoryPool&) {});
+		}
+
+		{
+			HeapMemoryPool pool;
+			pool.create(allocAligned, nullptr, true);
+			BenchTimer timer("HeapMemoryPool_threadCaching", threadCount);
+			run(pool, timer, [](HeapMemoryPool&) {});
+		}
+
+		{
+			StackMemoryPool pool;
+			pool.create(allocAligned, nullptr, 1_MB);
+			BenchTimer timer("StackMemoryPool", threadCount);
+			run(pool, timer, [](StackMemoryPool& pool) { pool.reset(); });
+		}
+	}
+}
+
+ANKI_TEST(Util, ThreadHiveThroughputBench)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	DynamicArrayAuto<U32> threadCounts(alloc);
+	getThreadCounts(threadCounts);
+
+	for(U32 threadCount : threadCounts)
+	{
+		ThreadHive hive(threadCount, alloc, true);
+		Atomic<U32> count = {0};
+
+		DynamicArrayAuto<ThreadHiveTask> tasks(alloc);
+		tasks.create(TASK_COUNT);
+		for(ThreadHiveTask& task : tasks)
+		{
+			task.m_callback = [](void* arg, U32, ThreadHive&, ThreadHiveSemaphore*) {
+				static_cast<Atomic<U32>*>(arg)->fetchAdd(1);
+			};
+			task.m_argument = &count;
+		}
+
+		// Throughput of small tasks. Submit them in batches like the renderer does
+		{
+			BenchTimer timer("ThreadHive_throughput", threadCount);
+			for(U32 it = 0; it < WARMUP_ITERATION_COUNT + ITERATION_COUNT; ++it)
+			{
+				const Bool measure = it >= WARMUP_ITERATION_COUNT;
+				count.setNonAtomically(0);
+
+				if(measure)
+				{
+					timer.begin();
+				}
+				constexpr U32 BATCH_SIZE = 256;
+				for(U32 i = 0; i < TASK_COUNT; i += BATCH_SIZE)
+				{
+					hive.submitTasks(&tasks[i], BATCH_SIZE);
+				}
+				hive.waitAllTasks();
+				if(measure)
+				{
+					timer.end();
+				}
+
+				ANKI_TEST_EXPECT_EQ(count.load(), TASK_COUNT);
+			}
+		}
+
+		// Latency of a single task from the submit to the end of the wait. One iteration is 1000 round trips
+		{
+			BenchTimer timer("ThreadHive_latency_x1000", threadCount);
+			for(U32 it = 0; it < WARMUP_ITERATION_COUNT + ITERATION_COUNT; ++it)
+			{
+				const Bool measure = it >= WARMUP_ITERATION_COUNT;
+
+				if(measure)
+				{
+					timer.begin();
+				}
+				for(U32 i = 0; i < 1000; ++i)
+				{
+					hive.submitTasks(&tasks[0], 1);
+					hive.waitAllTasks();
+				}
+				if(measure)
+				{
+					timer.end();
+				}
+			}
+		}
+	}
+}
+
+ANKI_TEST(Util, TracerBench)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	auto flushCallback = [](void*, ThreadId, ConstWeakArray<TracerEvent>, ConstWeakArray<TracerCounter>) {};
+
+	auto run = [&](Tracer& tracer, BenchTimer& timer) {
+		for(U32 it = 0; it < WARMUP_ITERATION_COUNT + ITERATION_COUNT; ++it)
+		{
+			const Bool measure = it >= WARMUP_ITERATION_COUNT;
+			tracer.beginFrame();
+
+			if(measure)
+			{
+				timer.begin();
+			}
+			for(U32 i = 0; i < TRACER_EVENT_COUNT; ++i)
+			{
+				const TracerEventHandle handle = tracer.beginEvent();
+				tracer.endEvent("EVENT", handle);
+			}
+			if(measure)
+			{
+				timer.end();
+			}
+
+			tracer.flush(flushCallback, nullptr);
+		}
+	};
+
+	{
+		Tracer tracer(alloc);
+		BenchTimer timer("Tracer_disabled", 1);
+		run(tracer, timer);
+	}
+
+	{
+		Tracer tracer(alloc);
+		tracer.setEnabled(true);
+		BenchTimer timer("Tracer_enabled", 1);
+		run(tracer, timer);
+	}
+
+	{
+		Tracer tracer(alloc);
+		tracer.setEnabled(true);
+		tracer.setRingBufferMode(4096);
+		BenchTimer timer("Tracer_ringBuffer", 1);
+		run(tracer, timer);
+	}
+
+	// The counters
+	{
+		Tracer tracer(alloc);
+		tracer.setEnabled(true);
+		BenchTimer timer("Tracer_counter", 1);
+		for(U32 it = 0; it < WARMUP_ITERATION_COUNT + ITERATION_COUNT; ++it)
+		{
+			const Bool measure = it >= WARMUP_ITERATION_COUNT;
+
+			if(measure)
+			{
+				timer.begin();
+			}
+			for(U32 i = 0; i < TRACER_EVENT_COUNT; ++i)
+			{
+				tracer.incrementCounter("COUNTER", 1);
+			}
+			if(measure)
+			{
+				timer.end();
+			}
+
+			tracer.flush(flushCallback, nullptr);
+		}
+	}
+}
+
+} // end namespace anki
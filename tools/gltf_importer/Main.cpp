@@ -13,8 +13,16 @@ Options:
 -texrpath <string>     : Same as rpath but for textures
 -optimize-meshes <0|1> : Optimize meshes. Default is 1
 -j <thread_count>      : Number of threads. Defaults to system's max
--lod-count <1|2|3>     : The number of geometry LODs to generate. Default: 1
+-lod-count <1|2|3|4>   : The number of geometry LODs to generate. Default: 1
 -lod-factor            : The decimate factor for each LOD. Default 0.25
+-lod-error <fraction>  : Simplify the LODs up to a screen space error instead of -lod-factor. It's the fraction of
+                         the screen height the surface can move, eg 0.001. The models get the LOD screen sizes
+-incremental <0|1>     : Skip the meshes and materials whose inputs didn't change since the last import. Default is 1
+-collision-hulls <n>   : Approximate the collision meshes with up to n convex hulls instead of their triangles.
+                         Default is 0 (triangles)
+-hull-vertices <n>     : The max vertices of each of the collision convex hulls. Default is 32
+-textures <0|1>        : Convert the textures to mipmapped S3TC .ankitex files in out_dir instead of expecting them
+                         converted in texrpath. Default is 0
 )";
 
 class CmdLineArgs
@@ -26,9 +34,14 @@ public:
 	StringAuto m_rpath = {m_alloc};
 	StringAuto m_texRpath = {m_alloc};
 	Bool m_optimizeMeshes = true;
+	Bool m_incremental = true;
+	Bool m_processTextures = false;
+	U32 m_collisionHullCount = 0;
+	U32 m_collisionHullVertexCount = 32;
 	U32 m_threadCount = MAX_U32;
 	U32 m_lodCount = 1;
 	F32 m_lodFactor = 0.25f;
+	F32 m_lodError = 0.0f;
 	F32 m_lightIntensityScale = 1.0f;
 };
 
@@ -105,6 +118,62 @@ static Error parseCommandLineArgs(int argc, char** argv, CmdLineArgs& info)
 				return Error::USER_DATA;
 			}
 		}
+		else if(strcmp(argv[i], "-incremental") == 0)
+		{
+			++i;
+
+			if(i < argc)
+			{
+				I incremental = 1;
+				ANKI_CHECK(CString(argv[i]).toNumber(incremental));
+				info.m_incremental = incremental != 0;
+			}
+			else
+			{
+				return Error::USER_DATA;
+			}
+		}
+		else if(strcmp(argv[i], "-textures") == 0)
+		{
+			++i;
+
+			if(i < argc)
+			{
+				I processTextures = 0;
+				ANKI_CHECK(CString(argv[i]).toNumber(processTextures));
+				info.m_processTextures = processTextures != 0;
+			}
+			else
+			{
+				return Error::USER_DATA;
+			}
+		}
+		else if(strcmp(argv[i], "-collision-hulls") == 0)
+		{
+			++i;
+
+			if(i < argc)
+			{
+				ANKI_CHECK(CString(argv[i]).toNumber(info.m_collisionHullCount));
+			}
+			else
+			{
+				return Error::USER_DATA;
+			}
+		}
+		else if(strcmp(argv[i], "-hull-vertices") == 0)
+		{
+			++i;
+
+			if(i < argc)
+			{
+				ANKI_CHECK(CString(argv[i]).toNumber(info.m_collisionHullVertexCount));
+			}
+			else
+			{
+				return Error::USER_DATA;
+			}
+		}
 		else if(strcmp(argv[i], "-j") == 0)
 		{
 			++i;
@@ -146,6 +215,19 @@ static Error parseCommandLineArgs(int argc, char** argv, CmdLineArgs& info)
 				return Error::USER_DATA;
 			}
 		}
+		else if(strcmp(argv[i], "-lod-error") == 0)
+		{
+			++i;
+
+			if(i < argc)
+			{
+				ANKI_CHECK(CString(argv[i]).toNumber(info.m_lodError));
+			}
+			else
+			{
+				return Error::USER_DATA;
+			}
+		}
 		else if(strcmp(argv[i], "-light-scale") == 0)
 		{
 			++i;
@@ -206,9 +288,14 @@ int main(int argc, char** argv)
 		   info.m_texRpath.toCString(),
 		   info.m_optimizeMeshes,
 		   info.m_lodFactor,
+		   info.m_lodError,
 		   info.m_lodCount,
 		   info.m_lightIntensityScale,
 		   info.m_threadCount,
+		   info.m_incremental,
+		   info.m_processTextures,
+		   info.m_collisionHullCount,
+		   info.m_collisionHullVertexCount,
 		   comment))
 	{
 		return 1;
@@ -0,0 +1,517 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/Core.h>
+#include <anki/Gr.h>
+#include <anki/Resource.h>
+#include <anki/resource/AsyncLoader.h>
+#include <anki/Physics.h>
+#include <anki/util/Filesystem.h>
+#include <anki/util/StringList.h>
+#include <anki/util/HighRezTimer.h>
+#include <cstdio>
+
+using namespace anki;
+
+static const char* USAGE = R"(Measure the loading of resources or replay the I/O of a recorded session
+Usage: %s [options] [manifest]
+The manifest is a text file with a resource filename per line. The extension picks the resource type
+Options:
+-passes <count>      : Load the manifest that many times. The first pass is cold, the rest warm. Default is 2
+-record-io <file>    : Record the files the first pass opens to an I/O trace
+-replay-io <file>    : Don't load resources. Replay the file reads of an I/O trace. See rsrc_ioTraceFile
+-realtime            : Replay with the timing of the trace instead of back to back
+-cfg <option> <value>: Set an engine config option, like rsrc_dataPaths
+For a really cold first pass drop the OS file cache before running it
+)";
+
+class CmdLineArgs
+{
+public:
+	HeapAllocator<U8> m_alloc;
+	StringAuto m_manifest;
+	StringAuto m_recordIoFname;
+	StringAuto m_replayIoFname;
+	U32 m_passCount = 2;
+	Bool m_realtime = false;
+
+	CmdLineArgs()
+		: m_alloc(allocAligned, nullptr)
+		, m_manifest(m_alloc)
+		, m_recordIoFname(m_alloc)
+		, m_replayIoFname(m_alloc)
+	{
+	}
+};
+
+static Error parseCommandLineArgs(int argc, char** argv, CmdLineArgs& info)
+{
+	for(I i = 1; i < argc; i++)
+	{
+		if(CString(argv[i]) == "-passes")
+		{
+			++i;
+			if(i >= argc)
+			{
+				return Error::USER_DATA;
+			}
+
+			ANKI_CHECK(CString(argv[i]).toNumber(info.m_passCount));
+			if(info.m_passCount == 0)
+			{
+				return Error::USER_DATA;
+			}
+		}
+		else if(CString(argv[i]) == "-record-io")
+		{
+			++i;
+			if(i >= argc)
+			{
+				return Error::USER_DATA;
+			}
+
+			info.m_recordIoFname.sprintf("%s", argv[i]);
+		}
+		else if(CString(argv[i]) == "-replay-io")
+		{
+			++i;
+			if(i >= argc)
+			{
+				return Error::USER_DATA;
+			}
+
+			info.m_replayIoFname.sprintf("%s", argv[i]);
+		}
+		else if(CString(argv[i]) == "-realtime")
+		{
+			info.m_realtime = true;
+		}
+		else if(CString(argv[i]) == "-cfg")
+		{
+			// ConfigSet::setFromCommandLineArguments() takes care of it
+			i += 2;
+			if(i >= argc)
+			{
+				return Error::USER_DATA;
+			}
+		}
+		else if(i == argc - 1 && argv[i][0] != '-')
+		{
+			info.m_manifest.sprintf("%s", argv[i]);
+		}
+		else
+		{
+			return Error::USER_DATA;
+		}
+	}
+
+	if(info.m_manifest.isEmpty() == info.m_replayIoFname.isEmpty())
+	{
+		// Either load a manifest or replay a trace
+		return Error::USER_DATA;
+	}
+
+	return Error::NONE;
+}
+
+/// Holds a loaded resource of any type.
+class LoadedResourceBase
+{
+public:
+	virtual ~LoadedResourceBase()
+	{
+	}
+};
+
+template<typename T>
+class LoadedResource : public LoadedResourceBase
+{
+public:
+	ResourcePtr<T> m_rsrc;
+};
+
+/// The subsystems the resources need.
+class Engine
+{
+public:
+	HeapAllocator<U8> m_alloc{allocAligned, nullptr};
+	ConfigSet m_config = DefaultConfigSet::get();
+	NativeWindow* m_window = nullptr;
+	GrManager* m_gr = nullptr;
+	PhysicsWorld* m_physics = nullptr;
+	ResourceFilesystem* m_resourceFs = nullptr;
+	ResourceManager* m_resources = nullptr;
+
+	~Engine()
+	{
+		m_alloc.deleteInstance(m_resources);
+		m_alloc.deleteInstance(m_resourceFs);
+		m_alloc.deleteInstance(m_physics);
+		GrManager::deleteInstance(m_gr);
+		m_alloc.deleteInstance(m_window);
+	}
+
+	Error initFilesystem()
+	{
+		m_resourceFs = m_alloc.newInstance<ResourceFilesystem>(m_alloc);
+		return m_resourceFs->init(m_config, "./");
+	}
+
+	Error initAll()
+	{
+		NativeWindowInitInfo windowInit;
+		windowInit.m_width = m_config.getNumberU32("width");
+		windowInit.m_height = m_config.getNumberU32("height");
+		windowInit.m_title = "AnKi resource bench";
+		m_window = m_alloc.newInstance<NativeWindow>();
+		ANKI_CHECK(m_window->init(windowInit, m_alloc));
+
+		GrManagerInitInfo grInit;
+		grInit.m_allocCallback = allocAligned;
+		grInit.m_cacheDirectory = "./";
+		grInit.m_config = &m_config;
+		grInit.m_window = m_window;
+		ANKI_CHECK(GrManager::newInstance(grInit, m_gr));
+
+		m_physics = m_alloc.newInstance<PhysicsWorld>();
+		ANKI_CHECK(m_physics->create(allocAligned, nullptr));
+
+		ANKI_CHECK(initFilesystem());
+
+		ResourceManagerInitInfo rsrcInit;
+		rsrcInit.m_gr = m_gr;
+		rsrcInit.m_physics = m_physics;
+		rsrcInit.m_resourceFs = m_resourceFs;
+		rsrcInit.m_config = &m_config;
+		rsrcInit.m_cacheDir = "./";
+		rsrcInit.m_allocCallback = allocAligned;
+		m_resources = m_alloc.newInstance<ResourceManager>();
+		ANKI_CHECK(m_resources->init(rsrcInit));
+
+		return Error::NONE;
+	}
+};
+
+/// The counters of the resource subsystem at some point. The difference of two snapshots is what a pass did.
+class Snapshot
+{
+public:
+	static constexpr U32 MAX_TYPES = 32;
+
+	Array<CString, MAX_TYPES> m_typeNames;
+	Array<ResourceLoadingStats, MAX_TYPES> m_types;
+	U32 m_typeCount = 0;
+	AsyncLoaderStats m_asyncLoader;
+	TransferGpuAllocatorStats m_transfer;
+	Second m_time = 0.0;
+
+	void take(ResourceManager& resources)
+	{
+		m_typeCount = 0;
+		resources.iterateLoadingStats([this](CString typeName, const ResourceLoadingStats& stats) {
+			ANKI_ASSERT(m_typeCount < MAX_TYPES);
+			m_typeNames[m_typeCount] = typeName;
+			m_types[m_typeCount] = stats;
+			++m_typeCount;
+		});
+
+		m_asyncLoader = resources.getAsyncLoader().getStats();
+		m_transfer = resources.getTransferGpuAllocator().getStats();
+		m_time = HighRezTimer::getCurrentTime();
+	}
+};
+
+static void printReport(U32 pass, const Snapshot& begin, const Snapshot& end)
+{
+	printf("Pass %u (%s): %.3fms\n", pass, (pass == 0) ? "cold" : "warm", (end.m_time - begin.m_time) * 1000.0);
+
+	printf("  %-24s %8s %12s %12s %12s\n", "Type", "Loads", "Total ms", "I/O ms", "Decode ms");
+	for(U32 i = 0; i < end.m_typeCount; ++i)
+	{
+		const U64 loadCount = end.m_types[i].m_loadCount - begin.m_types[i].m_loadCount;
+		if(loadCount == 0)
+		{
+			continue;
+		}
+
+		const Second loadTime = end.m_types[i].m_loadTime - begin.m_types[i].m_loadTime;
+		const Second ioTime = end.m_types[i].m_ioTime - begin.m_types[i].m_ioTime;
+		printf("  %-24s %8lu %12.3f %12.3f %12.3f\n",
+			end.m_typeNames[i].cstr(),
+			loadCount,
+			loadTime * 1000.0,
+			ioTime * 1000.0,
+			(loadTime - ioTime) * 1000.0);
+	}
+
+	// The async tasks do the GPU uploads
+	const U64 taskCount = end.m_asyncLoader.m_taskCount - begin.m_asyncLoader.m_taskCount;
+	const Second queueWaitTime = end.m_asyncLoader.m_queueWaitTime - begin.m_asyncLoader.m_queueWaitTime;
+	printf("  Async tasks (uploads): %lu, run %.3fms, queue wait %.3fms (avg %.3fms, max since start %.3fms)\n",
+		taskCount,
+		(end.m_asyncLoader.m_runTime - begin.m_asyncLoader.m_runTime) * 1000.0,
+		queueWaitTime * 1000.0,
+		(taskCount) ? queueWaitTime / F64(taskCount) * 1000.0 : 0.0,
+		end.m_asyncLoader.m_maxQueueWaitTime * 1000.0);
+
+	printf("  Transfer memory: %lu allocations, %luMB, %lu stalls, stalled %.3fms\n",
+		end.m_transfer.m_allocationCount - begin.m_transfer.m_allocationCount,
+		(end.m_transfer.m_allocatedSize - begin.m_transfer.m_allocatedSize) / (1024 * 1024),
+		end.m_transfer.m_stallCount - begin.m_transfer.m_stallCount,
+		(end.m_transfer.m_stallTime - begin.m_transfer.m_stallTime) * 1000.0);
+}
+
+template<typename T>
+static Error loadResource(ResourceManager& resources, CString filename, LoadedResourceBase*& out)
+{
+	LoadedResource<T>* rsrc = resources.getAllocator().newInstance<LoadedResource<T>>();
+	out = rsrc;
+	return resources.loadResource(filename, rsrc->m_rsrc);
+}
+
+static Error loadResourceByExtension(ResourceManager& resources, CString filename, LoadedResourceBase*& out)
+{
+	StringAuto extStr(resources.getAllocator());
+	getFilepathExtension(filename, extStr);
+	const CString ext = (extStr.isEmpty()) ? CString("") : extStr.toCString();
+
+	if(ext == "ankitex")
+	{
+		ANKI_CHECK(loadResource<TextureResource>(resources, filename, out));
+	}
+	else if(ext == "ankimesh")
+	{
+		ANKI_CHECK(loadResource<MeshResource>(resources, filename, out));
+	}
+	else if(ext == "ankimdl")
+	{
+		ANKI_CHECK(loadResource<ModelResource>(resources, filename, out));
+	}
+	else if(ext == "ankimtl")
+	{
+		ANKI_CHECK(loadResource<MaterialResource>(resources, filename, out));
+	}
+	else if(ext == "ankiprog")
+	{
+		ANKI_CHECK(loadResource<ShaderProgramResource>(resources, filename, out));
+	}
+	else if(ext == "ankipart")
+	{
+		ANKI_CHECK(loadResource<ParticleEmitterResource>(resources, filename, out));
+	}
+	else if(ext == "ankicl")
+	{
+		ANKI_CHECK(loadResource<CollisionResource>(resources, filename, out));
+	}
+	else if(ext == "ankiskel")
+	{
+		ANKI_CHECK(loadResource<SkeletonResource>(resources, filename, out));
+	}
+	else if(ext == "ankianim")
+	{
+		ANKI_CHECK(loadResource<AnimationResource>(resources, filename, out));
+	}
+	else if(ext == "lua")
+	{
+		ANKI_CHECK(loadResource<ScriptResource>(resources, filename, out));
+	}
+	else
+	{
+		ANKI_CHECK(loadResource<GenericResource>(resources, filename, out));
+	}
+
+	return Error::NONE;
+}
+
+/// Wait for the async tasks of the loaded resources and for the GPU to finish their uploads.
+static void waitLoading(Engine& engine)
+{
+	AsyncLoader& loader = engine.m_resources->getAsyncLoader();
+	while(loader.getQueuedTaskCount() > 0)
+	{
+		engine.m_resources->updateStreaming();
+		engine.m_resources->getTransferGpuAllocator().endFrame();
+		HighRezTimer::sleep(1.0_ms);
+	}
+
+	// Wait for the running tasks
+	loader.pause();
+	loader.resume();
+
+	engine.m_gr->finish();
+	engine.m_resources->getTransferGpuAllocator().endFrame();
+}
+
+static Error benchManifest(const CmdLineArgs& info, Engine& engine)
+{
+	ANKI_CHECK(engine.initAll());
+	ResourceManager& resources = *engine.m_resources;
+
+	StringListAuto filenames(info.m_alloc);
+	{
+		File file;
+		ANKI_CHECK(file.open(info.m_manifest.toCString(), FileOpenFlag::READ));
+		StringAuto txt(info.m_alloc);
+		ANKI_CHECK(file.readAllText(txt));
+		filenames.splitString(txt.toCString(), '\n');
+	}
+
+	if(filenames.isEmpty())
+	{
+		ANKI_LOGE("The manifest is empty: %s", info.m_manifest.cstr());
+		return Error::USER_DATA;
+	}
+
+	DynamicArrayAuto<LoadedResourceBase*> loaded(info.m_alloc);
+	Error err = Error::NONE;
+	for(U32 pass = 0; pass < info.m_passCount && !err; ++pass)
+	{
+		if(pass == 0 && !info.m_recordIoFname.isEmpty())
+		{
+			engine.m_resourceFs->beginIoTraceRecording();
+		}
+
+		Snapshot begin;
+		begin.take(resources);
+
+		for(const String& fname : filenames)
+		{
+			LoadedResourceBase* rsrc = nullptr;
+			err = loadResourceByExtension(resources, fname.toCString(), rsrc);
+			loaded.emplaceBack(rsrc);
+			if(err)
+			{
+				break;
+			}
+		}
+
+		waitLoading(engine);
+
+		Snapshot end;
+		end.take(resources);
+		printReport(pass, begin, end);
+
+		if(pass == 0 && !info.m_recordIoFname.isEmpty() && !err)
+		{
+			err = engine.m_resourceFs->endIoTraceRecording(info.m_recordIoFname.toCString());
+		}
+
+		// Unload everything so the next pass loads again. The files stay in the OS cache so it's warm
+		for(LoadedResourceBase* rsrc : loaded)
+		{
+			resources.getAllocator().deleteInstance(rsrc);
+		}
+		loaded.destroy();
+		resources.updateStreaming();
+	}
+
+	return err;
+}
+
+static Error replayIoTrace(const CmdLineArgs& info, Engine& engine)
+{
+	ANKI_CHECK(engine.initFilesystem());
+
+	StringListAuto lines(info.m_alloc);
+	{
+		File file;
+		ANKI_CHECK(file.open(info.m_replayIoFname.toCString(), FileOpenFlag::READ));
+		StringAuto txt(info.m_alloc);
+		ANKI_CHECK(file.readAllText(txt));
+		lines.splitString(txt.toCString(), '\n');
+	}
+
+	DynamicArrayAuto<U8, PtrSize> buffer(info.m_alloc);
+	PtrSize totalSize = 0;
+	U32 fileCount = 0;
+	U64 checksum = 0; // Touch the mapped memory so it's read
+	const Second begin = HighRezTimer::getCurrentTime();
+	for(const String& line : lines)
+	{
+		F64 time;
+		PtrSize size;
+		int filenameOffset = 0;
+		if(sscanf(line.cstr(), "%lf %lu %n", &time, &size, &filenameOffset) != 2 || filenameOffset == 0)
+		{
+			ANKI_LOGE("Wrong line in the I/O trace: %s", line.cstr());
+			return Error::USER_DATA;
+		}
+
+		if(info.m_realtime)
+		{
+			const Second sleepTime = begin + time - HighRezTimer::getCurrentTime();
+			if(sleepTime > 0.0)
+			{
+				HighRezTimer::preciseSleep(sleepTime);
+			}
+		}
+
+		ResourceFilePtr file;
+		ANKI_CHECK(engine.m_resourceFs->openFile(line.cstr() + filenameOffset, file));
+		const PtrSize fileSize = file->getSize();
+		if(fileSize == 0)
+		{
+			continue;
+		}
+
+		if(file->isMapped())
+		{
+			ConstWeakArray<U8> view;
+			ANKI_CHECK(file->readMapped(fileSize, view));
+			for(PtrSize i = 0; i < fileSize; i += 4096)
+			{
+				checksum += view[i];
+			}
+		}
+		else
+		{
+			if(buffer.getSize() < fileSize)
+			{
+				buffer.resize(fileSize);
+			}
+
+			ANKI_CHECK(file->read(&buffer[0], fileSize));
+			checksum += buffer[0];
+		}
+
+		totalSize += fileSize;
+		++fileCount;
+	}
+
+	const Second replayTime = HighRezTimer::getCurrentTime() - begin;
+	printf("Replayed %u files, %luMB in %.3fms (%.1fMB/s, checksum %lu)\n",
+		fileCount,
+		totalSize / (1024 * 1024),
+		replayTime * 1000.0,
+		(replayTime > 0.0) ? F64(totalSize) / (1024.0 * 1024.0) / replayTime : 0.0,
+		checksum);
+
+	return Error::NONE;
+}
+
+int main(int argc, char** argv)
+{
+	CmdLineArgs info;
+	if(parseCommandLineArgs(argc, argv, info))
+	{
+		ANKI_LOGE(USAGE, argv[0]);
+		return 1;
+	}
+
+	Engine engine;
+	if(engine.m_config.setFromCommandLineArguments(argc, argv))
+	{
+		return 1;
+	}
+
+	const Error err = (info.m_replayIoFname.isEmpty()) ? benchManifest(info, engine) : replayIoTrace(info, engine);
+	if(err)
+	{
+		ANKI_LOGE("Resource bench failed");
+		return 1;
+	}
+
+	return 0;
+}
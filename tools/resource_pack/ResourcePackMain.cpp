@@ -0,0 +1,172 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/resource/ResourcePack.h>
+#include <anki/util/Filesystem.h>
+#include <anki/util/StringList.h>
+
+using namespace anki;
+
+static const char* USAGE = R"(Pack a data directory to a resource pack (.ankipak) that rsrc_dataPaths can point to
+Usage: %s [options] in_dir out_file
+Options:
+-store <extension> : Never compress the files with that extension. They can be mapped. Can be repeated
+-nocompress        : Don't compress anything
+-chunk <size>      : The size of the chunks that are compressed separately. Default is 64K
+)";
+
+class CmdLineArgs
+{
+public:
+	HeapAllocator<U8> m_alloc;
+	StringAuto m_inDir;
+	StringAuto m_outFname;
+	StringListAuto m_storeExtensions;
+	Bool m_compress = true;
+	U32 m_chunkSize = RESOURCE_PACK_DEFAULT_CHUNK_SIZE;
+
+	CmdLineArgs()
+		: m_alloc(allocAligned, nullptr)
+		, m_inDir(m_alloc)
+		, m_outFname(m_alloc)
+		, m_storeExtensions(m_alloc)
+	{
+	}
+};
+
+static Error parseCommandLineArgs(int argc, char** argv, CmdLineArgs& info)
+{
+	if(argc < 3)
+	{
+		return Error::USER_DATA;
+	}
+
+	for(I i = 1; i < argc - 2; i++)
+	{
+		if(CString(argv[i]) == "-store")
+		{
+			++i;
+			if(i >= argc - 2)
+			{
+				return Error::USER_DATA;
+			}
+
+			info.m_storeExtensions.pushBackSprintf("%s", argv[i]);
+		}
+		else if(CString(argv[i]) == "-nocompress")
+		{
+			info.m_compress = false;
+		}
+		else if(CString(argv[i]) == "-chunk")
+		{
+			++i;
+			if(i >= argc - 2)
+			{
+				return Error::USER_DATA;
+			}
+
+			ANKI_CHECK(CString(argv[i]).toNumber(info.m_chunkSize));
+			if(info.m_chunkSize == 0)
+			{
+				return Error::USER_DATA;
+			}
+		}
+		else
+		{
+			return Error::USER_DATA;
+		}
+	}
+
+	info.m_inDir.sprintf("%s", argv[argc - 2]);
+	info.m_outFname.sprintf("%s", argv[argc - 1]);
+	return Error::NONE;
+}
+
+static Error pack(const CmdLineArgs& info)
+{
+	// Gather the files first so they can be added in a stable order
+	class UserData
+	{
+	public:
+		StringListAuto m_files;
+
+		UserData(HeapAllocator<U8> alloc)
+			: m_files(alloc)
+		{
+		}
+	} ud(info.m_alloc);
+
+	auto callback = [](const CString& fname, void* ud, Bool isDir) -> Error {
+		if(!isDir)
+		{
+			static_cast<UserData*>(ud)->m_files.pushBackSprintf("%s", fname.cstr());
+		}
+		return Error::NONE;
+	};
+	ANKI_CHECK(walkDirectoryTree(info.m_inDir.toCString(), &ud, callback));
+
+	if(ud.m_files.isEmpty())
+	{
+		ANKI_LOGE("The directory is empty: %s", info.m_inDir.cstr());
+		return Error::USER_DATA;
+	}
+
+	ud.m_files.sortAll();
+
+	ResourcePackWriter writer(info.m_alloc);
+	ANKI_CHECK(writer.begin(info.m_outFname.toCString(), info.m_chunkSize));
+
+	for(const String& fname : ud.m_files)
+	{
+		StringAuto fullFname(info.m_alloc);
+		fullFname.sprintf("%s/%s", info.m_inDir.cstr(), fname.cstr());
+
+		File file;
+		ANKI_CHECK(file.open(fullFname.toCString(), FileOpenFlag::READ | FileOpenFlag::BINARY));
+		DynamicArrayAuto<U8, PtrSize> data(info.m_alloc);
+		data.create(file.getSize());
+		if(data.getSize() > 0)
+		{
+			ANKI_CHECK(file.read(&data[0], data.getSize()));
+		}
+
+		StringAuto ext(info.m_alloc);
+		getFilepathExtension(fname.toCString(), ext);
+		Bool compress = info.m_compress;
+		for(const String& storeExt : info.m_storeExtensions)
+		{
+			if(!ext.isEmpty() && storeExt == ext)
+			{
+				compress = false;
+			}
+		}
+
+		const ConstWeakArray<U8, PtrSize> dataView(data.getBegin(), data.getSize());
+		ANKI_CHECK(writer.addFile(fname.toCString(), dataView, compress));
+	}
+
+	ANKI_CHECK(writer.end());
+
+	printf("Packed %u files to %s\n", U32(ud.m_files.getSize()), info.m_outFname.cstr());
+	return Error::NONE;
+}
+
+int main(int argc, char** argv)
+{
+	CmdLineArgs info;
+	if(parseCommandLineArgs(argc, argv, info))
+	{
+		ANKI_LOGE(USAGE, argv[0]);
+		return 1;
+	}
+
+	if(pack(info))
+	{
+		ANKI_LOGE("Packing failed");
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,869 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/scene/SceneBinary.h>
+#include <anki/util/File.h>
+#include <anki/util/DynamicArray.h>
+#include <anki/util/String.h>
+#include <anki/util/Serializer.h>
+#include <anki/Math.h>
+#include <cctype>
+#include <cstring>
+
+using namespace anki;
+
+static const char* USAGE = R"(Convert a Lua scene that the Blender exporter wrote to a scene binary
+Usage: %s in_file out_file
+)";
+
+/// An argument of a call.
+class Argument
+{
+public:
+	StringAuto m_text; ///< The whole argument. Strings don't have the quotes.
+	Array<F32, 4> m_numbers = {}; ///< A number or the components of a Vec4.new().
+	U32 m_numberCount = 0;
+	Bool m_string = false;
+	Bool m_timesAspectRatio = false; ///< It's a number multiplied by getAspectRatio().
+
+	Argument(GenericMemoryPoolAllocator<U8> alloc)
+		: m_text(alloc)
+	{
+	}
+
+	/// The first identifier of the argument. For "node:getSceneNodeBase()" it's "node".
+	CString getRootIdentifier(StringAuto& out) const
+	{
+		const char* end = m_text.getBegin();
+		while(end != m_text.getEnd() && (isalnum(*end) || *end == '_'))
+		{
+			++end;
+		}
+
+		out.create(m_text.getBegin(), end);
+		return out.toCString();
+	}
+};
+
+/// A Lua statement. It's always one call with an optional assignment of its result.
+class Statement
+{
+public:
+	StringAuto m_variable; ///< The variable the result is assigned to. Might be empty.
+	StringAuto m_object; ///< The first identifier of the call chain. For "node:getSceneNodeBase():f()" it's "node".
+	StringAuto m_method; ///< The last call of the chain.
+	DynamicArrayAuto<Argument> m_args;
+
+	Statement(HeapAllocator<U8> alloc)
+		: m_variable(alloc)
+		, m_object(alloc)
+		, m_method(alloc)
+		, m_args(alloc)
+	{
+	}
+};
+
+/// What a Lua variable holds.
+enum class VariableType : U8
+{
+	NODE,
+	LIGHT_COMPONENT,
+	FRUSTUM_COMPONENT,
+	GLOBAL_ILLUMINATION_PROBE_COMPONENT,
+	TRANSFORM,
+	MAT3X4,
+	LIGHT_EVENT
+};
+
+class Variable
+{
+public:
+	StringAuto m_name;
+	VariableType m_type = VariableType::NODE;
+	U32 m_index = MAX_U32; ///< Points to the nodes or the events.
+	Transform m_trf = Transform::getIdentity();
+	Mat3x4 m_rot = Mat3x4::getIdentity();
+
+	Variable(HeapAllocator<U8> alloc)
+		: m_name(alloc)
+	{
+	}
+};
+
+static const char* skipSpaces(const char* it, const char* end)
+{
+	while(it != end && isspace(*it))
+	{
+		++it;
+	}
+
+	return it;
+}
+
+static void trim(const char*& begin, const char*& end)
+{
+	begin = skipSpaces(begin, end);
+	while(end != begin && isspace(*(end - 1)))
+	{
+		--end;
+	}
+}
+
+static Error parseNumber(const char* begin, const char* end, GenericMemoryPoolAllocator<U8> alloc, F32& out)
+{
+	trim(begin, end);
+	StringAuto txt(alloc);
+	txt.create(begin, end);
+	return txt.toNumber(out);
+}
+
+static Error parseArgument(const char* begin, const char* end, Argument& arg)
+{
+	trim(begin, end);
+	GenericMemoryPoolAllocator<U8> alloc = arg.m_text.getAllocator();
+
+	if(begin != end && *begin == '"')
+	{
+		if(end - begin < 2 || *(end - 1) != '"')
+		{
+			ANKI_LOGE("Wrong string");
+			return Error::USER_DATA;
+		}
+
+		arg.m_string = true;
+		arg.m_text.create(begin + 1, end - 1);
+		return Error::NONE;
+	}
+
+	arg.m_text.create(begin, end);
+	const CString txt = arg.m_text.toCString();
+
+	const PtrSize vecPos = txt.find("Vec4.new(");
+	const PtrSize aspectPos = txt.find("getAspectRatio()");
+	if(vecPos != CString::NPOS)
+	{
+		// The components of a Vec4
+		const char* it = begin + vecPos + strlen("Vec4.new(");
+		const char* vecEnd = end - 1;
+		while(arg.m_numberCount < 4 && it < vecEnd)
+		{
+			const char* comma = it;
+			while(comma != vecEnd && *comma != ',')
+			{
+				++comma;
+			}
+
+			ANKI_CHECK(parseNumber(it, comma, alloc, arg.m_numbers[arg.m_numberCount++]));
+			it = comma + 1;
+		}
+	}
+	else if(aspectPos != CString::NPOS)
+	{
+		// Something like "getMainRenderer():getAspectRatio() * 0.5"
+		const PtrSize mulPos = txt.find("*");
+		if(mulPos == CString::NPOS)
+		{
+			ANKI_LOGE("Expected getAspectRatio() * number");
+			return Error::USER_DATA;
+		}
+
+		const char* numBegin = (mulPos > aspectPos) ? begin + mulPos + 1 : begin;
+		const char* numEnd = (mulPos > aspectPos) ? end : begin + mulPos;
+		ANKI_CHECK(parseNumber(numBegin, numEnd, alloc, arg.m_numbers[0]));
+		arg.m_numberCount = 1;
+		arg.m_timesAspectRatio = true;
+	}
+	else if(begin != end && (isdigit(*begin) || *begin == '-' || *begin == '.'))
+	{
+		ANKI_CHECK(parseNumber(begin, end, alloc, arg.m_numbers[0]));
+		arg.m_numberCount = 1;
+	}
+
+	return Error::NONE;
+}
+
+/// Parse a line like "a = b:c():d(1, "x", Vec4.new(1, 2, 3, 4))".
+static Error parseStatement(const char* begin, const char* end, Statement& st)
+{
+	// Assignment
+	const char* it = begin;
+	if(strncmp(it, "local ", 6) == 0)
+	{
+		it += 6;
+	}
+
+	const char* identBegin = skipSpaces(it, end);
+	const char* identEnd = identBegin;
+	while(identEnd != end && (isalnum(*identEnd) || *identEnd == '_'))
+	{
+		++identEnd;
+	}
+
+	const char* afterIdent = skipSpaces(identEnd, end);
+	if(afterIdent != end && *afterIdent == '=' && (afterIdent + 1 == end || afterIdent[1] != '='))
+	{
+		st.m_variable.create(identBegin, identEnd);
+		it = skipSpaces(afterIdent + 1, end);
+	}
+	else
+	{
+		it = identBegin;
+	}
+
+	// The root of the chain
+	const char* rootEnd = it;
+	while(rootEnd != end && (isalnum(*rootEnd) || *rootEnd == '_'))
+	{
+		++rootEnd;
+	}
+	st.m_object.create(it, rootEnd);
+
+	// Find the last call of the chain
+	const char* methodBegin = nullptr;
+	const char* methodEnd = nullptr;
+	const char* argsBegin = nullptr;
+	const char* argsEnd = nullptr;
+	U32 depth = 0;
+	Bool inString = false;
+	for(const char* c = it; c != end; ++c)
+	{
+		if(*c == '"')
+		{
+			inString = !inString;
+		}
+		else if(inString)
+		{
+			continue;
+		}
+		else if(*c == '(')
+		{
+			if(depth == 0)
+			{
+				methodEnd = c;
+				methodBegin = c;
+				while(methodBegin != it && (isalnum(*(methodBegin - 1)) || *(methodBegin - 1) == '_'))
+				{
+					--methodBegin;
+				}
+				argsBegin = c + 1;
+			}
+			++depth;
+		}
+		else if(*c == ')')
+		{
+			if(depth == 0)
+			{
+				ANKI_LOGE("Unbalanced parentheses");
+				return Error::USER_DATA;
+			}
+
+			--depth;
+			if(depth == 0)
+			{
+				argsEnd = c;
+			}
+		}
+	}
+
+	if(methodBegin == nullptr || argsEnd == nullptr || depth != 0 || inString)
+	{
+		ANKI_LOGE("Expected a call");
+		return Error::USER_DATA;
+	}
+
+	st.m_method.create(methodBegin, methodEnd);
+
+	// Split the arguments
+	const char* argBegin = argsBegin;
+	depth = 0;
+	inString = false;
+	for(const char* c = argsBegin; c <= argsEnd; ++c)
+	{
+		if(c != argsEnd && *c == '"')
+		{
+			inString = !inString;
+		}
+		else if(c != argsEnd && inString)
+		{
+			continue;
+		}
+		else if(c != argsEnd && *c == '(')
+		{
+			++depth;
+		}
+		else if(c != argsEnd && *c == ')')
+		{
+			--depth;
+		}
+		else if(c == argsEnd || (*c == ',' && depth == 0))
+		{
+			if(skipSpaces(argBegin, c) != c)
+			{
+				Argument& arg = *st.m_args.emplaceBack(st.m_args.getAllocator());
+				ANKI_CHECK(parseArgument(argBegin, c, arg));
+			}
+			argBegin = c + 1;
+		}
+	}
+
+	return Error::NONE;
+}
+
+/// Runs the statements of the Lua scene and records what they do.
+class SceneRecorder
+{
+public:
+	DynamicArrayAuto<SceneBinaryNode> m_nodes;
+	DynamicArrayAuto<SceneBinaryLightEvent> m_lightEvents;
+	DynamicArrayAuto<char> m_strings;
+	U32 m_activeCameraNode = MAX_U32;
+	U32 m_ignoredStatementCount = 0;
+
+	SceneRecorder(HeapAllocator<U8> alloc)
+		: m_nodes(alloc)
+		, m_lightEvents(alloc)
+		, m_strings(alloc)
+		, m_variables(alloc)
+		, m_alloc(alloc)
+	{
+	}
+
+	Error record(const Statement& st);
+
+private:
+	DynamicArrayAuto<Variable> m_variables;
+	HeapAllocator<U8> m_alloc;
+
+	/// Add a string. The nodes of the exporters share a few resources so reuse the strings.
+	U32 addString(CString str)
+	{
+		const U32 len = str.getLength();
+		for(U32 offset = 0; offset < m_strings.getSize(); offset += U32(strlen(&m_strings[offset])) + 1)
+		{
+			if(str == CString(&m_strings[offset]))
+			{
+				return offset;
+			}
+		}
+
+		const U32 offset = m_strings.getSize();
+		m_strings.resize(offset + len + 1);
+		memcpy(&m_strings[offset], str.cstr(), len + 1);
+		return offset;
+	}
+
+	Variable* findVariable(CString name, VariableType type)
+	{
+		for(Variable& var : m_variables)
+		{
+			if(var.m_name.toCString() == name)
+			{
+				return (var.m_type == type) ? &var : nullptr;
+			}
+		}
+
+		return nullptr;
+	}
+
+	Variable& newVariable(CString name, VariableType type)
+	{
+		Variable* var = nullptr;
+		for(Variable& v : m_variables)
+		{
+			if(v.m_name.toCString() == name)
+			{
+				var = &v;
+				break;
+			}
+		}
+
+		if(var == nullptr)
+		{
+			var = m_variables.emplaceBack(m_alloc);
+			var->m_name.create(name);
+		}
+
+		var->m_type = type;
+		var->m_index = MAX_U32;
+		var->m_trf = Transform::getIdentity();
+		var->m_rot = Mat3x4::getIdentity();
+		return *var;
+	}
+
+	Error getNode(const Argument& arg, U32& node)
+	{
+		StringAuto name(m_alloc);
+		const Variable* var = findVariable(arg.getRootIdentifier(name), VariableType::NODE);
+		if(var == nullptr)
+		{
+			ANKI_LOGE("Expected a node: %s", arg.m_text.cstr());
+			return Error::USER_DATA;
+		}
+
+		node = var->m_index;
+		return Error::NONE;
+	}
+
+	Error newNode(const Statement& st, SceneBinaryNodeType type, Bool hasFile);
+
+	static Error checkArgs(const Statement& st, U32 count)
+	{
+		if(st.m_args.getSize() != count)
+		{
+			ANKI_LOGE("%s() expects %u arguments", st.m_method.cstr(), count);
+			return Error::USER_DATA;
+		}
+
+		return Error::NONE;
+	}
+
+	static Error checkNumbers(const Argument& arg, U32 count)
+	{
+		if(arg.m_numberCount != count)
+		{
+			ANKI_LOGE("Expected %u numbers: %s", count, arg.m_text.cstr());
+			return Error::USER_DATA;
+		}
+
+		return Error::NONE;
+	}
+
+	static void storeTransform(const Transform& trf, SceneBinaryNode& node)
+	{
+		node.m_properties |= SceneBinaryNodeProperty::TRANSFORM;
+		for(U32 i = 0; i < 3; ++i)
+		{
+			node.m_origin[i] = trf.getOrigin()[i];
+		}
+
+		for(U32 i = 0; i < 12; ++i)
+		{
+			node.m_rotation[i] = trf.getRotation()[i];
+		}
+
+		node.m_scale = trf.getScale();
+	}
+};
+
+Error SceneRecorder::newNode(const Statement& st, SceneBinaryNodeType type, Bool hasFile)
+{
+	if(st.m_args.getSize() == 0 || !st.m_args[0].m_string
+		|| (hasFile && (st.m_args.getSize() < 2 || !st.m_args[1].m_string)))
+	{
+		ANKI_LOGE("Wrong arguments of %s()", st.m_method.cstr());
+		return Error::USER_DATA;
+	}
+
+	SceneBinaryNode& node = *m_nodes.emplaceBack();
+	node.m_type = type;
+
+	if(!st.m_args[0].m_text.isEmpty())
+	{
+		node.m_name = addString(st.m_args[0].m_text.toCString());
+	}
+
+	if(hasFile)
+	{
+		node.m_filename = addString(st.m_args[1].m_text.toCString());
+	}
+
+	if(!st.m_variable.isEmpty())
+	{
+		newVariable(st.m_variable.toCString(), VariableType::NODE).m_index = m_nodes.getSize() - 1;
+	}
+
+	return Error::NONE;
+}
+
+Error SceneRecorder::record(const Statement& st)
+{
+	const CString method = st.m_method.toCString();
+	const CString object = st.m_object.toCString();
+	const CString variable = st.m_variable.toCString();
+
+	// Creation of nodes
+	if(method == "newModelNode")
+	{
+		ANKI_CHECK(checkArgs(st, 2));
+		ANKI_CHECK(newNode(st, SceneBinaryNodeType::MODEL, true));
+	}
+	else if(method == "newStaticCollisionNode")
+	{
+		ANKI_CHECK(checkArgs(st, 3));
+		ANKI_CHECK(newNode(st, SceneBinaryNodeType::STATIC_COLLISION, true));
+
+		StringAuto name(m_alloc);
+		const Variable* trf = findVariable(st.m_args[2].getRootIdentifier(name), VariableType::TRANSFORM);
+		if(trf == nullptr)
+		{
+			ANKI_LOGE("Expected a transform: %s", st.m_args[2].m_text.cstr());
+			return Error::USER_DATA;
+		}
+
+		storeTransform(trf->m_trf, m_nodes.getBack());
+	}
+	else if(method == "newParticleEmitterNode")
+	{
+		ANKI_CHECK(checkArgs(st, 2));
+		ANKI_CHECK(newNode(st, SceneBinaryNodeType::PARTICLE_EMITTER, true));
+	}
+	else if(method == "newGpuParticleEmitterNode")
+	{
+		ANKI_CHECK(checkArgs(st, 2));
+		ANKI_CHECK(newNode(st, SceneBinaryNodeType::GPU_PARTICLE_EMITTER, true));
+	}
+	else if(method == "newPointLightNode")
+	{
+		ANKI_CHECK(checkArgs(st, 1));
+		ANKI_CHECK(newNode(st, SceneBinaryNodeType::POINT_LIGHT, false));
+	}
+	else if(method == "newSpotLightNode")
+	{
+		ANKI_CHECK(checkArgs(st, 1));
+		ANKI_CHECK(newNode(st, SceneBinaryNodeType::SPOT_LIGHT, false));
+	}
+	else if(method == "newDirectionalLightNode")
+	{
+		ANKI_CHECK(checkArgs(st, 1));
+		ANKI_CHECK(newNode(st, SceneBinaryNodeType::DIRECTIONAL_LIGHT, false));
+	}
+	else if(method == "newReflectionProbeNode")
+	{
+		ANKI_CHECK(checkArgs(st, 3));
+		ANKI_CHECK(checkNumbers(st.m_args[1], 4));
+		ANKI_CHECK(checkNumbers(st.m_args[2], 4));
+		ANKI_CHECK(newNode(st, SceneBinaryNodeType::REFLECTION_PROBE, false));
+
+		SceneBinaryNode& node = m_nodes.getBack();
+		node.m_properties |= SceneBinaryNodeProperty::BOUNDING_BOX;
+		for(U32 i = 0; i < 3; ++i)
+		{
+			node.m_params[i] = st.m_args[1].m_numbers[i];
+			node.m_params[i + 3] = st.m_args[2].m_numbers[i];
+		}
+	}
+	else if(method == "newGlobalIlluminationProbeNode")
+	{
+		ANKI_CHECK(checkArgs(st, 1));
+		ANKI_CHECK(newNode(st, SceneBinaryNodeType::GLOBAL_ILLUMINATION_PROBE, false));
+	}
+	else if(method == "newPerspectiveCameraNode")
+	{
+		ANKI_CHECK(checkArgs(st, 1));
+		ANKI_CHECK(newNode(st, SceneBinaryNodeType::PERSPECTIVE_CAMERA, false));
+	}
+	// Transforms
+	else if(method == "new" && object == "Transform")
+	{
+		newVariable(variable, VariableType::TRANSFORM);
+	}
+	else if(method == "new" && object == "Mat3x4")
+	{
+		newVariable(variable, VariableType::MAT3X4);
+	}
+	else if(method == "setAll" && findVariable(object, VariableType::MAT3X4))
+	{
+		ANKI_CHECK(checkArgs(st, 12));
+		Variable& rot = *findVariable(object, VariableType::MAT3X4);
+		for(U32 i = 0; i < 12; ++i)
+		{
+			ANKI_CHECK(checkNumbers(st.m_args[i], 1));
+			rot.m_rot[i] = st.m_args[i].m_numbers[0];
+		}
+	}
+	else if(method == "setOrigin" && findVariable(object, VariableType::TRANSFORM))
+	{
+		ANKI_CHECK(checkArgs(st, 1));
+		ANKI_CHECK(checkNumbers(st.m_args[0], 4));
+		const Array<F32, 4>& n = st.m_args[0].m_numbers;
+		findVariable(object, VariableType::TRANSFORM)->m_trf.setOrigin(Vec4(n[0], n[1], n[2], 0.0f));
+	}
+	else if(method == "setRotation" && findVariable(object, VariableType::TRANSFORM))
+	{
+		ANKI_CHECK(checkArgs(st, 1));
+		StringAuto name(m_alloc);
+		const Variable* rot = findVariable(st.m_args[0].getRootIdentifier(name), VariableType::MAT3X4);
+		if(rot == nullptr)
+		{
+			ANKI_LOGE("Expected a Mat3x4: %s", st.m_args[0].m_text.cstr());
+			return Error::USER_DATA;
+		}
+
+		findVariable(object, VariableType::TRANSFORM)->m_trf.setRotation(rot->m_rot);
+	}
+	else if(method == "setScale" && findVariable(object, VariableType::TRANSFORM))
+	{
+		ANKI_CHECK(checkArgs(st, 1));
+		ANKI_CHECK(checkNumbers(st.m_args[0], 1));
+		findVariable(object, VariableType::TRANSFORM)->m_trf.setScale(st.m_args[0].m_numbers[0]);
+	}
+	else if(method == "setLocalTransform" && findVariable(object, VariableType::NODE))
+	{
+		ANKI_CHECK(checkArgs(st, 1));
+		StringAuto name(m_alloc);
+		const Variable* trf = findVariable(st.m_args[0].getRootIdentifier(name), VariableType::TRANSFORM);
+		if(trf == nullptr)
+		{
+			ANKI_LOGE("Expected a transform: %s", st.m_args[0].m_text.cstr());
+			return Error::USER_DATA;
+		}
+
+		storeTransform(trf->m_trf, m_nodes[findVariable(object, VariableType::NODE)->m_index]);
+	}
+	// Components
+	else if((method == "getLightComponent" || method == "getFrustumComponent"
+				|| method == "getGlobalIlluminationProbeComponent")
+			&& findVariable(object, VariableType::NODE) && !st.m_variable.isEmpty())
+	{
+		const VariableType type = (method == "getLightComponent")
+									  ? VariableType::LIGHT_COMPONENT
+									  : ((method == "getFrustumComponent")
+											  ? VariableType::FRUSTUM_COMPONENT
+											  : VariableType::GLOBAL_ILLUMINATION_PROBE_COMPONENT);
+		const U32 node = findVariable(object, VariableType::NODE)->m_index;
+		newVariable(variable, type).m_index = node;
+	}
+	else if(findVariable(object, VariableType::LIGHT_COMPONENT)
+			&& (method == "setDiffuseColor" || method == "setRadius" || method == "setDistance"
+				|| method == "setInnerAngle" || method == "setOuterAngle" || method == "setShadowEnabled"))
+	{
+		ANKI_CHECK(checkArgs(st, 1));
+		SceneBinaryNode& node = m_nodes[findVariable(object, VariableType::LIGHT_COMPONENT)->m_index];
+		const Array<F32, 4>& n = st.m_args[0].m_numbers;
+
+		if(method == "setDiffuseColor")
+		{
+			ANKI_CHECK(checkNumbers(st.m_args[0], 4));
+			node.m_properties |= SceneBinaryNodeProperty::DIFFUSE_COLOR;
+			memcpy(&node.m_params[0], &n[0], sizeof(n));
+		}
+		else if(method == "setShadowEnabled")
+		{
+			ANKI_CHECK(checkNumbers(st.m_args[0], 1));
+			node.m_properties &= ~SceneBinaryNodeProperty::SHADOW;
+			if(n[0] != 0.0f)
+			{
+				node.m_properties |= SceneBinaryNodeProperty::SHADOW;
+			}
+		}
+		else
+		{
+			ANKI_CHECK(checkNumbers(st.m_args[0], 1));
+			const U32 param = (method == "setInnerAngle") ? 5 : ((method == "setOuterAngle") ? 6 : 4);
+			node.m_properties |= (param == 5) ? SceneBinaryNodeProperty::INNER_ANGLE
+											  : ((param == 6) ? SceneBinaryNodeProperty::OUTER_ANGLE
+															  : SceneBinaryNodeProperty::LIGHT_DISTANCE);
+			node.m_params[param] = n[0];
+		}
+	}
+	else if(method == "setPerspective" && findVariable(object, VariableType::FRUSTUM_COMPONENT))
+	{
+		ANKI_CHECK(checkArgs(st, 4));
+		SceneBinaryNode& node = m_nodes[findVariable(object, VariableType::FRUSTUM_COMPONENT)->m_index];
+		node.m_properties |= SceneBinaryNodeProperty::PERSPECTIVE;
+		node.m_properties &= ~SceneBinaryNodeProperty::FOV_X_TIMES_ASPECT_RATIO;
+		for(U32 i = 0; i < 4; ++i)
+		{
+			ANKI_CHECK(checkNumbers(st.m_args[i], 1));
+			node.m_params[i] = st.m_args[i].m_numbers[0];
+
+			if(st.m_args[i].m_timesAspectRatio)
+			{
+				if(i != 2)
+				{
+					ANKI_LOGE("Only the horizontal FOV can depend on the aspect ratio");
+					return Error::USER_DATA;
+				}
+
+				node.m_properties |= SceneBinaryNodeProperty::FOV_X_TIMES_ASPECT_RATIO;
+			}
+		}
+	}
+	else if((method == "setBoundingBox" || method == "setCellSize")
+			&& findVariable(object, VariableType::GLOBAL_ILLUMINATION_PROBE_COMPONENT))
+	{
+		SceneBinaryNode& node =
+			m_nodes[findVariable(object, VariableType::GLOBAL_ILLUMINATION_PROBE_COMPONENT)->m_index];
+		if(method == "setBoundingBox")
+		{
+			ANKI_CHECK(checkArgs(st, 2));
+			ANKI_CHECK(checkNumbers(st.m_args[0], 4));
+			ANKI_CHECK(checkNumbers(st.m_args[1], 4));
+			node.m_properties |= SceneBinaryNodeProperty::BOUNDING_BOX;
+			for(U32 i = 0; i < 3; ++i)
+			{
+				node.m_params[i] = st.m_args[0].m_numbers[i];
+				node.m_params[i + 3] = st.m_args[1].m_numbers[i];
+			}
+		}
+		else
+		{
+			ANKI_CHECK(checkArgs(st, 1));
+			ANKI_CHECK(checkNumbers(st.m_args[0], 1));
+			node.m_properties |= SceneBinaryNodeProperty::CELL_SIZE;
+			node.m_params[6] = st.m_args[0].m_numbers[0];
+		}
+	}
+	else if(method == "setActiveCameraNode")
+	{
+		ANKI_CHECK(checkArgs(st, 1));
+		ANKI_CHECK(getNode(st.m_args[0], m_activeCameraNode));
+		if(m_nodes[m_activeCameraNode].m_type != SceneBinaryNodeType::PERSPECTIVE_CAMERA)
+		{
+			ANKI_LOGE("Only perspective cameras are supported");
+			return Error::USER_DATA;
+		}
+	}
+	// Events
+	else if(method == "newLightEvent")
+	{
+		ANKI_CHECK(checkArgs(st, 3));
+		ANKI_CHECK(checkNumbers(st.m_args[0], 1));
+		ANKI_CHECK(checkNumbers(st.m_args[1], 1));
+
+		SceneBinaryLightEvent& event = *m_lightEvents.emplaceBack();
+		event.m_startTime = st.m_args[0].m_numbers[0];
+		event.m_duration = st.m_args[1].m_numbers[0];
+		ANKI_CHECK(getNode(st.m_args[2], event.m_node));
+
+		if(!st.m_variable.isEmpty())
+		{
+			newVariable(variable, VariableType::LIGHT_EVENT).m_index = m_lightEvents.getSize() - 1;
+		}
+	}
+	else if((method == "setIntensityMultiplier" || method == "setRadiusMultiplier" || method == "setFrequency")
+			&& findVariable(object, VariableType::LIGHT_EVENT))
+	{
+		SceneBinaryLightEvent& event = m_lightEvents[findVariable(object, VariableType::LIGHT_EVENT)->m_index];
+		if(method == "setIntensityMultiplier")
+		{
+			ANKI_CHECK(checkArgs(st, 1));
+			ANKI_CHECK(checkNumbers(st.m_args[0], 4));
+			event.m_properties |= SceneBinaryLightEventProperty::INTENSITY_MULTIPLIER;
+			event.m_intensityMultiplier = st.m_args[0].m_numbers;
+		}
+		else if(method == "setRadiusMultiplier")
+		{
+			ANKI_CHECK(checkArgs(st, 1));
+			ANKI_CHECK(checkNumbers(st.m_args[0], 1));
+			event.m_properties |= SceneBinaryLightEventProperty::RADIUS_MULTIPLIER;
+			event.m_radiusMultiplier = st.m_args[0].m_numbers[0];
+		}
+		else
+		{
+			ANKI_CHECK(checkArgs(st, 2));
+			ANKI_CHECK(checkNumbers(st.m_args[0], 1));
+			ANKI_CHECK(checkNumbers(st.m_args[1], 1));
+			event.m_properties |= SceneBinaryLightEventProperty::FREQUENCY;
+			event.m_frequency = st.m_args[0].m_numbers[0];
+			event.m_frequencyDeviation = st.m_args[1].m_numbers[0];
+		}
+	}
+	// The globals
+	else if(method == "getSceneGraph" || method == "getEventManager")
+	{
+	}
+	else
+	{
+		return Error::FUNCTION_FAILED;
+	}
+
+	return Error::NONE;
+}
+
+static Error convert(CString inFname, CString outFname)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	File inFile;
+	ANKI_CHECK(inFile.open(inFname, FileOpenFlag::READ));
+	StringAuto txt(alloc);
+	ANKI_CHECK(inFile.readAllText(txt));
+
+	// Run the statements one by one
+	SceneRecorder recorder(alloc);
+	const char* lineBegin = txt.getBegin();
+	U32 lineNo = 0;
+	while(lineBegin < txt.getEnd())
+	{
+		const char* lineEnd = lineBegin;
+		while(lineEnd != txt.getEnd() && *lineEnd != '\n')
+		{
+			++lineEnd;
+		}
+
+		++lineNo;
+		const char* begin = lineBegin;
+		const char* end = lineEnd;
+		lineBegin = lineEnd + 1;
+
+		trim(begin, end);
+		if(begin == end || strncmp(begin, "--", 2) == 0)
+		{
+			continue;
+		}
+
+		Statement st(alloc);
+		Error err = parseStatement(begin, end, st);
+		if(!err)
+		{
+			err = recorder.record(st);
+		}
+
+		if(err == Error::FUNCTION_FAILED)
+		{
+			StringAuto line(alloc);
+			line.create(begin, end);
+			ANKI_LOGW("Ignoring unsupported statement at line %u: %s", lineNo, line.cstr());
+			++recorder.m_ignoredStatementCount;
+		}
+		else if(err)
+		{
+			ANKI_LOGE("Failed to convert line %u", lineNo);
+			return err;
+		}
+	}
+
+	// Write the binary
+	SceneBinary binary;
+	memcpy(&binary.m_magic[0], SCENE_BINARY_MAGIC, sizeof(binary.m_magic));
+	binary.m_nodes = WeakArray<SceneBinaryNode>(
+		(recorder.m_nodes.getSize()) ? &recorder.m_nodes[0] : nullptr, recorder.m_nodes.getSize());
+	binary.m_lightEvents = WeakArray<SceneBinaryLightEvent>(
+		(recorder.m_lightEvents.getSize()) ? &recorder.m_lightEvents[0] : nullptr, recorder.m_lightEvents.getSize());
+	binary.m_strings = WeakArray<char>(
+		(recorder.m_strings.getSize()) ? &recorder.m_strings[0] : nullptr, recorder.m_strings.getSize());
+	binary.m_activeCameraNode = recorder.m_activeCameraNode;
+
+	File outFile;
+	ANKI_CHECK(outFile.open(outFname, FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+	BinarySerializer serializer;
+	ANKI_CHECK(serializer.serialize(binary, alloc, outFile));
+
+	printf("Wrote %u nodes and %u light events. Ignored %u statements\n",
+		recorder.m_nodes.getSize(),
+		recorder.m_lightEvents.getSize(),
+		recorder.m_ignoredStatementCount);
+	return Error::NONE;
+}
+
+int main(int argc, char** argv)
+{
+	if(argc != 3)
+	{
+		ANKI_LOGE(USAGE, argv[0]);
+		return 1;
+	}
+
+	const Error err = convert(argv[1], argv[2]);
+	if(err)
+	{
+		ANKI_LOGE("Can't convert due to an error. Bye");
+		return 1;
+	}
+
+	printf("Converted %s to %s\n", argv[1], argv[2]);
+	return 0;
+}
@@ -4,6 +4,7 @@
 // http://www.anki3d.org/LICENSE
 
 #include <anki/shader_compiler/ShaderProgramCompiler.h>
+#include <anki/shader_compiler/ShaderProgramSpirvCache.h>
 #include <anki/Util.h>
 using namespace anki;
 
@@ -12,6 +13,7 @@ Options:
 -o <name of output>    : The name of the output binary
 -j <thread count>      : Number of threads. Defaults to system's max
 -I <include path>      : The path of the #include files
+-spirv-cache <dir>     : Reuse the SPIR-V of the variants that are in that dir and add the rest
 )";
 
 class CmdLineArgs
@@ -21,6 +23,7 @@ public:
 	StringAuto m_inputFname = {m_alloc};
 	StringAuto m_outFname = {m_alloc};
 	StringAuto m_includePath = {m_alloc};
+	StringAuto m_spirvCacheDir = {m_alloc};
 	U32 m_threadCount = getCpuCoresCount();
 };
 
@@ -89,6 +92,19 @@ static Error parseCommandLineArgs(int argc, char** argv, CmdLineArgs& info)
 				return Error::USER_DATA;
 			}
 		}
+		else if(strcmp(argv[i], "-spirv-cache") == 0)
+		{
+			++i;
+
+			if(i < argc && std::strlen(argv[i]) > 0)
+			{
+				info.m_spirvCacheDir.sprintf("%s", argv[i]);
+			}
+			else
+			{
+				return Error::USER_DATA;
+			}
+		}
 		else
 		{
 			return Error::USER_DATA;
@@ -171,12 +187,20 @@ static Error work(const CmdLineArgs& info)
 	limits.m_bindlessImageCount = 16;
 	limits.m_bindlessTextureCount = 16;
 
+	// SPIR-V cache
+	ShaderProgramSpirvFileCache spirvCache(alloc);
+	if(!info.m_spirvCacheDir.isEmpty())
+	{
+		ANKI_CHECK(spirvCache.init(info.m_spirvCacheDir));
+	}
+
 	// Compile
 	ShaderProgramBinaryWrapper binary(alloc);
 	ANKI_CHECK(compileShaderProgram(info.m_inputFname,
 		fsystem,
 		nullptr,
 		(info.m_threadCount) ? &taskManager : nullptr,
+		(info.m_spirvCacheDir.isEmpty()) ? nullptr : &spirvCache,
 		alloc,
 		caps,
 		limits,
@@ -69,6 +69,8 @@ DC_NONE = 0
 DC_RAW = 1 << 0
 DC_S3TC = 1 << 1
 DC_ETC2 = 1 << 2
+DC_BC7 = 1 << 3
+DC_ASTC = 1 << 4
 
 # Texture filtering
 TF_DEFAULT = 0
@@ -139,6 +141,15 @@ class DdsHeader(CStruct):
         ('dwReserved2', c_int))
 
 
+# The size of the extended header of the DDS files with a DX10 FourCC
+DDS_DX10_HEADER_SIZE = 20
+
+#
+# ASTC
+#
+ASTC_MAGIC = 0x5CA1AB13
+ASTC_HEADER_SIZE = 16
+
 #
 # ETC2
 #
@@ -188,8 +199,8 @@ def parse_commandline():
 
     parser = argparse.ArgumentParser(description = "This program converts a single image or a number " \
       "of images (for 3D and 2DArray textures) to AnKi texture format. " \
-      "It requires 4 different applications/executables to " \
-      "operate: convert, identify, nvcompress and etcpack. These " \
+      "It requires a few different applications/executables to " \
+      "operate: convert, identify, CompressonatorCLI, etcpack and astcenc. These " \
       "applications should be in PATH except the convert where you " \
       "need to define the executable explicitly",
       formatter_class = argparse.ArgumentDefaultsHelpFormatter)
@@ -224,6 +235,10 @@ def parse_commandline():
 
     parser.add_argument("--store-s3tc", type=int, default=1, help="store or not S3TC compressed data")
 
+    parser.add_argument("--store-bc7", type=int, default=0, help="store or not BC7 compressed data")
+
+    parser.add_argument("--store-astc", type=int, default=0, help="store or not ASTC 4x4 compressed data")
+
     parser.add_argument(
         "--to-linear-rgb",
         type=int,
@@ -282,6 +297,12 @@ def parse_commandline():
     if args.store_s3tc:
         config.compressed_formats = config.compressed_formats | DC_S3TC
 
+    if args.store_bc7:
+        config.compressed_formats = config.compressed_formats | DC_BC7
+
+    if args.store_astc:
+        config.compressed_formats = config.compressed_formats | DC_ASTC
+
     return config
 
 
@@ -395,10 +416,11 @@ def create_etc_images(mips_fnames, tmp_dir, fast, color_format, convert_path):
         subprocess.check_call(args, stdout=subprocess.PIPE, cwd=tmp_dir)
 
 
-def create_dds_images(mips_fnames, tmp_dir, fast, color_format, normal):
+def create_dds_images(mips_fnames, tmp_dir, fast, color_format, normal, bc7=False):
     """ Create the dds files """
 
     printi("Creating DDS images")
+    suffix = "_bc7.dds" if bc7 else ".dds"
 
     for fname in mips_fnames:
         # Unfortunately we need to flip the image. Use convert again
@@ -411,11 +433,14 @@ def create_dds_images(mips_fnames, tmp_dir, fast, color_format, normal):
         """
 
         # Continue
-        out_fname = os.path.join(tmp_dir, os.path.basename(fname) + ".dds")
+        out_fname = os.path.join(tmp_dir, os.path.basename(fname) + suffix)
 
         args = ["CompressonatorCLI", "-nomipmap"]
 
-        if color_format == CF_RGB8:
+        if bc7:
+            args.append("-fd")
+            args.append("BC7")
+        elif color_format == CF_RGB8:
             args.append("-fd")
             args.append("BC1")
         elif color_format == CF_RGBA8:
@@ -429,6 +454,21 @@ def create_dds_images(mips_fnames, tmp_dir, fast, color_format, normal):
         subprocess.check_call(args, stdout=subprocess.PIPE)
 
 
+def create_astc_images(mips_fnames, tmp_dir, fast):
+    """ Create the astc files """
+
+    printi("Creating ASTC images")
+
+    for fname in mips_fnames:
+        in_fname = fname + ".png"
+        out_fname = os.path.join(tmp_dir, os.path.basename(fname) + ".astc")
+
+        args = ["astcenc", "-cl", in_fname, out_fname, "4x4", "-fast" if fast else "-medium"]
+
+        printi("  " + " ".join(args))
+        subprocess.check_call(args, stdout=subprocess.PIPE)
+
+
 def write_raw(tex_file, fname, width, height, color_format):
     """ Append raw data to the AnKi texture file """
 
@@ -510,6 +550,73 @@ def write_s3tc(out_file, fname, width, height, color_format):
     out_file.write(data)
 
 
+def write_bc7(out_file, fname, width, height):
+    """ Append BC7 data to the AnKi texture file """
+
+    printi("  Appending %s" % fname)
+    in_file = open(fname, "rb")
+
+    header_bin = in_file.read(sizeof(DdsHeader()))
+
+    if len(header_bin) != sizeof(DdsHeader()):
+        raise Exception("Failed to read DDS header")
+
+    dds_header = DdsHeader()
+    dds_header.from_bytearray(header_bin)
+
+    if dds_header.dwWidth != width or dds_header.dwHeight != height:
+        raise Exception("Incorrect width")
+
+    if dds_header.dwFourCC != b"DX10":
+        raise Exception("Incorrect format. Expecting DX10")
+
+    # Skip the extended header. Assume the format is BC7
+    if len(in_file.read(DDS_DX10_HEADER_SIZE)) != DDS_DX10_HEADER_SIZE:
+        raise Exception("Failed to read DDS DX10 header")
+
+    data_size = int((width / 4) * (height / 4) * 16)
+
+    data = in_file.read(data_size)
+
+    if len(data) != data_size:
+        raise Exception("Failed to read DDS data")
+
+    out_file.write(data)
+
+
+def write_astc(out_file, fname, width, height):
+    """ Append ASTC data to the AnKi texture file """
+
+    printi("  Appending %s" % fname)
+    in_file = open(fname, "rb")
+
+    header = in_file.read(ASTC_HEADER_SIZE)
+
+    if len(header) != ASTC_HEADER_SIZE:
+        raise Exception("Failed to read ASTC header")
+
+    magic = struct.unpack("<I", header[0:4])[0]
+    if magic != ASTC_MAGIC:
+        raise Exception("Incorrect ASTC header")
+
+    if header[4] != 4 or header[5] != 4:
+        raise Exception("Incorrect ASTC block size. Expecting 4x4")
+
+    astc_width = header[7] | (header[8] << 8) | (header[9] << 16)
+    astc_height = header[10] | (header[11] << 8) | (header[12] << 16)
+    if astc_width != width or astc_height != height:
+        raise Exception("Incorrect ASTC width or height")
+
+    data_size = int((width / 4) * (height / 4) * 16)
+
+    data = in_file.read(data_size)
+
+    if len(data) != data_size:
+        raise Exception("Failed to read ASTC data")
+
+    out_file.write(data)
+
+
 def write_etc(out_file, fname, width, height, color_format):
     """ Append etc2 data to the AnKi texture file """
 
@@ -582,6 +689,14 @@ def convert(config):
         if config.compressed_formats & DC_S3TC:
             create_dds_images(mips_fnames, config.tmp_dir, config.fast, color_format, config.normal)
 
+        # Create bc7 images
+        if config.compressed_formats & DC_BC7:
+            create_dds_images(mips_fnames, config.tmp_dir, config.fast, color_format, config.normal, True)
+
+        # Create astc images
+        if config.compressed_formats & DC_ASTC:
+            create_astc_images(mips_fnames, config.tmp_dir, config.fast)
+
     # Open file
     fname = config.out_file
     printi("Writing %s" % fname)
@@ -611,8 +726,8 @@ def convert(config):
         padding.append(0)
     tex_file.write(padding)
 
-    # For each compression
-    for compression in range(0, 3):
+    # For each compression. They are in the order of the bits
+    for compression in range(0, 5):
 
         tmp_width = width
         tmp_height = height
@@ -634,6 +749,12 @@ def convert(config):
                 # Write ETC
                 elif compression == 2 and (config.compressed_formats & DC_ETC2):
                     write_etc(tex_file, in_base_fname + "_flip.pkm", tmp_width, tmp_height, color_format)
+                # Write BC7
+                elif compression == 3 and (config.compressed_formats & DC_BC7):
+                    write_bc7(tex_file, in_base_fname + "_bc7.dds", tmp_width, tmp_height)
+                # Write ASTC
+                elif compression == 4 and (config.compressed_formats & DC_ASTC):
+                    write_astc(tex_file, in_base_fname + ".astc", tmp_width, tmp_height)
 
             tmp_width = tmp_width / 2
             tmp_height = tmp_height / 2
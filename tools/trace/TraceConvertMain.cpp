@@ -0,0 +1,103 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/core/CoreTracer.h>
+#include <anki/util/File.h>
+#include <anki/util/DynamicArray.h>
+#include <anki/util/WeakArray.h>
+#include <algorithm>
+
+using namespace anki;
+
+static const char* USAGE = R"(Convert a binary trace to Chrome trace JSON. Perfetto can also read it
+Usage: %s in_file out_file
+)";
+
+/// The events are sorted and written in batches of that many so the memory doesn't grow with the length of the trace.
+/// The tracer writes the events of a thread and a frame together so a batch rarely splits the ones that need sorting.
+static constexpr U32 EVENT_BATCH_SIZE = 256 * 1024;
+
+static Error writeEvents(File& outFile, const CoreTracerBinaryReader& reader, WeakArray<CoreTracerBinaryEvent> events)
+{
+	// Sort them to fix overlaping in chrome. Same as CoreTracer
+	std::sort(events.getBegin(), events.getEnd(), [](const CoreTracerBinaryEvent& a, const CoreTracerBinaryEvent& b) {
+		if(a.m_tid != b.m_tid)
+		{
+			return a.m_tid < b.m_tid;
+		}
+
+		return (a.m_startNs != b.m_startNs) ? a.m_startNs < b.m_startNs : a.m_durationNs > b.m_durationNs;
+	});
+
+	for(const CoreTracerBinaryEvent& event : events)
+	{
+		ANKI_CHECK(outFile.writeText("{\"name\": \"%s\", \"cat\": \"PERF\", \"ph\": \"X\", "
+									 "\"pid\": 1, \"tid\": %llu, \"ts\": %lld, \"dur\": %lld},\n",
+			reader.getString(event.m_nameId).cstr(),
+			event.m_tid,
+			I64(event.m_startNs / 1000),
+			I64(event.m_durationNs / 1000)));
+	}
+
+	return Error::NONE;
+}
+
+static Error convert(CString inFname, CString outFname)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	CoreTracerBinaryReader reader(alloc);
+	ANKI_CHECK(reader.open(inFname));
+
+	File outFile;
+	ANKI_CHECK(outFile.open(outFname, FileOpenFlag::WRITE));
+	ANKI_CHECK(outFile.writeText("[\n"));
+	ANKI_CHECK(outFile.writeText("{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %llu, "
+								 "\"args\": {\"name\": \"GPU\"}},\n",
+		TRACER_GPU_THREAD_ID));
+
+	// Decode and write batch by batch
+	DynamicArrayAuto<CoreTracerBinaryEvent> events(alloc);
+	events.create(EVENT_BATCH_SIZE);
+	U32 eventCount = 0;
+	Bool done = false;
+	while(!done)
+	{
+		ANKI_CHECK(reader.readEvent(events[eventCount], done));
+		if(!done)
+		{
+			++eventCount;
+		}
+
+		if(eventCount == EVENT_BATCH_SIZE || (done && eventCount > 0))
+		{
+			ANKI_CHECK(writeEvents(outFile, reader, WeakArray<CoreTracerBinaryEvent>(&events[0], eventCount)));
+			eventCount = 0;
+		}
+	}
+
+	ANKI_CHECK(outFile.writeText("{}\n]\n"));
+
+	return Error::NONE;
+}
+
+int main(int argc, char** argv)
+{
+	if(argc != 3)
+	{
+		ANKI_LOGE(USAGE, argv[0]);
+		return 1;
+	}
+
+	const Error err = convert(argv[1], argv[2]);
+	if(err)
+	{
+		ANKI_LOGE("Can't convert due to an error. Bye");
+		return 1;
+	}
+
+	printf("Converted %s to %s\n", argv[1], argv[2]);
+	return 0;
+}